@@ -0,0 +1,407 @@
+/**
+ *  @file
+ *  @copyright defined in evt/LICENSE.txt
+ */
+
+#include <benchmark/benchmark.h>
+#include <functional>
+#include <map>
+#include <fc/io/json.hpp>
+#include <evt/chain/block.hpp>
+#include <evt/chain/execution_context_mock.hpp>
+#include <evt/chain/contracts/abi_serializer.hpp>
+#include <evt/chain/contracts/evt_contract_abi.hpp>
+#include <evt/chain/contracts/evt_link.hpp>
+#include <evt/chain/contracts/types.hpp>
+
+/*
+ * Benchmarks of abi_serializer converting between binary and variant / json for each action type
+ * with growing payloads, and of rendering whole blocks like `get_block` does
+ */
+
+using namespace evt::chain;
+using namespace evt::chain::contracts;
+
+namespace {
+
+const auto kKey1 = public_key_type(std::string("EVT6MRyAjQq8ud7hVNYcfnVPJqcVpscN5So8BhtHuGYqET5GDW5CV"));
+const auto kKey2 = public_key_type(std::string("EVT8MGU4aKiVzqMtWi9zLpu8KuTHZWjQQrX475ycSxEkLd6aBpraX"));
+
+const auto kLink = std::string("03XBY4E/KTS:PNHVA3JP9QG258F08JHYOYR5SLJGN0EA-C3J6S:2G:T1SX7WA14KH9ETLZ97TUX9R9JJA6+06$E/_PYNX-/152P4CTC:WKXLK$/7G-K:89+::2K4C-KZ2**HI-P8CYJ**XGFO1K5:$E*SOY8MFYWMNHP*BHX2U8$$FTFI81YDP1HT");
+
+auto&
+get_abis() {
+    static auto abis = abi_serializer(evt_contract_abi(), std::chrono::hours(1));
+    return abis;
+}
+
+auto&
+get_exec_ctx() {
+    static auto exec_ctx = evt_execution_context_mock();
+    return exec_ctx;
+}
+
+permission_def
+make_perm(const char* name, int n) {
+    auto perm      = permission_def();
+    perm.name      = name;
+    perm.threshold = 1;
+    for(auto i = 0; i < n; i++) {
+        perm.authorizers.emplace_back(authorizer_ref(i % 2 ? kKey2 : kKey1), 1);
+    }
+    return perm;
+}
+
+address_list
+make_addrs(int n) {
+    auto addrs = address_list();
+    for(auto i = 0; i < n; i++) {
+        addrs.emplace_back(i % 2 ? kKey2 : kKey1);
+    }
+    return addrs;
+}
+
+fc::variant
+make_group(int n) {
+    auto nodes = fc::variants();
+    for(auto i = 0; i < n; i++) {
+        nodes.emplace_back(fc::mutable_variant_object("key", i % 2 ? kKey2 : kKey1)("weight", 1));
+    }
+    auto root  = fc::mutable_variant_object("threshold", n)("nodes", std::move(nodes));
+    auto group = fc::mutable_variant_object("name", "bmgroup")("key", kKey1)("root", std::move(root));
+    return fc::mutable_variant_object("name", "bmgroup")("group", std::move(group));
+}
+
+transaction
+make_trx(int n) {
+    auto trx       = transaction();
+    trx.expiration = time_point_sec(1'600'000'000);
+    trx.payer      = address(kKey1);
+    for(auto i = 0; i < n; i++) {
+        auto tf = transferft{ address(kKey1), address(kKey2), asset(i + 1, evt_sym()), "memo" };
+        trx.actions.emplace_back(N128(.fungible), name128::from_number(1), tf);
+    }
+    return trx;
+}
+
+asset
+evt_asset(int64_t amount) {
+    return asset(amount, evt_sym());
+}
+
+// one action type, `scalable` samples get `n` items in their largest field, others ignore `n`
+struct sample {
+    action_name                     act;
+    type_name                       type;
+    bool                            scalable;
+    std::function<fc::variant(int)> make;
+};
+
+template<typename T>
+fc::variant
+to_abi_variant(const type_name& type, const T& v) {
+    return get_abis().binary_to_variant(type, fc::raw::pack(v), get_exec_ctx());
+}
+
+const std::vector<sample>&
+get_samples() {
+    static auto samples = std::vector<sample>{
+        { N(newdomain), "newdomain", true, [](int n) {
+            auto nd = newdomain{ N128(bmdomain), kKey1, make_perm("issue", n), make_perm("transfer", n), make_perm("manage", n) };
+            return to_abi_variant("newdomain", nd);
+        }},
+        { N(issuetoken), "issuetoken", true, [](int n) {
+            auto it = issuetoken{ N128(bmdomain), {}, make_addrs(1) };
+            for(auto i = 0; i < n; i++) {
+                it.names.emplace_back(name128::from_number(i));
+            }
+            return to_abi_variant("issuetoken", it);
+        }},
+        { N(transfer), "transfer", true, [](int n) {
+            return to_abi_variant("transfer", transfer{ N128(bmdomain), N128(t1), make_addrs(n), "memo" });
+        }},
+        { N(destroytoken), "destroytoken", false, [](int) {
+            return to_abi_variant("destroytoken", destroytoken{ N128(bmdomain), N128(t1) });
+        }},
+        { N(newgroup), "newgroup", true, [](int n) {
+            return make_group(n);
+        }},
+        { N(updategroup), "updategroup", true, [](int n) {
+            return make_group(n);
+        }},
+        { N(updatedomain), "updatedomain", true, [](int n) {
+            return to_abi_variant("updatedomain", updatedomain{ N128(bmdomain), make_perm("issue", n), {}, make_perm("manage", n) });
+        }},
+        { N(newfungible), "newfungible", true, [](int n) {
+            auto nf = newfungible{ N128(bmft), N128(BMFT), symbol(5, 3), kKey1, make_perm("issue", n), make_perm("manage", n), asset(1'000'000, symbol(5, 3)) };
+            return to_abi_variant("newfungible", nf);
+        }},
+        { N(newfungible), "newfungible_v2", true, [](int n) {
+            auto nf = newfungible_v2{ N128(bmft), N128(BMFT), symbol(5, 3), kKey1, make_perm("issue", n), make_perm("transfer", n), make_perm("manage", n), asset(1'000'000, symbol(5, 3)) };
+            return to_abi_variant("newfungible_v2", nf);
+        }},
+        { N(updfungible), "updfungible", true, [](int n) {
+            return to_abi_variant("updfungible", updfungible{ 3, make_perm("issue", n), make_perm("manage", n) });
+        }},
+        { N(updfungible), "updfungible_v2", true, [](int n) {
+            return to_abi_variant("updfungible_v2", updfungible_v2{ 3, make_perm("issue", n), make_perm("transfer", n), make_perm("manage", n) });
+        }},
+        { N(issuefungible), "issuefungible", false, [](int) {
+            return to_abi_variant("issuefungible", issuefungible{ address(kKey1), evt_asset(100), "memo" });
+        }},
+        { N(transferft), "transferft", false, [](int) {
+            return to_abi_variant("transferft", transferft{ address(kKey1), address(kKey2), evt_asset(100), "memo" });
+        }},
+        { N(recycleft), "recycleft", false, [](int) {
+            return to_abi_variant("recycleft", recycleft{ address(kKey1), evt_asset(100), "memo" });
+        }},
+        { N(destroyft), "destroyft", false, [](int) {
+            return to_abi_variant("destroyft", destroyft{ address(kKey1), evt_asset(100), "memo" });
+        }},
+        { N(evt2pevt), "evt2pevt", false, [](int) {
+            return to_abi_variant("evt2pevt", evt2pevt{ address(kKey1), address(kKey2), evt_asset(100), "memo" });
+        }},
+        { N(addmeta), "addmeta", false, [](int) {
+            return to_abi_variant("addmeta", addmeta{ N128(key), "value", authorizer_ref(kKey1) });
+        }},
+        { N(newsuspend), "newsuspend", true, [](int n) {
+            return to_abi_variant("newsuspend", newsuspend{ N128(bmsuspend), kKey1, make_trx(n) });
+        }},
+        { N(cancelsuspend), "cancelsuspend", false, [](int) {
+            return to_abi_variant("cancelsuspend", cancelsuspend{ N128(bmsuspend) });
+        }},
+        { N(aprvsuspend), "aprvsuspend", true, [](int n) {
+            auto as  = aprvsuspend{ N128(bmsuspend), {} };
+            auto key = private_key_type::regenerate<fc::ecc::private_key_shim>(fc::sha256::hash(std::string("bmkey")));
+            for(auto i = 0; i < n; i++) {
+                as.signatures.emplace_back(key.sign(fc::sha256::hash(std::to_string(i))));
+            }
+            return to_abi_variant("aprvsuspend", as);
+        }},
+        { N(execsuspend), "execsuspend", false, [](int) {
+            return to_abi_variant("execsuspend", execsuspend{ N128(bmsuspend), kKey1 });
+        }},
+        { N(paycharge), "paycharge", false, [](int) {
+            return to_abi_variant("paycharge", paycharge{ address(kKey1), 100 });
+        }},
+        { N(paybonus), "paybonus", false, [](int) {
+            return to_abi_variant("paybonus", paybonus{ address(kKey1), evt_asset(100) });
+        }},
+        { N(everipass), "everipass", false, [](int) {
+            return to_abi_variant("everipass", everipass{ evt_link::parse_from_evtli(kLink) });
+        }},
+        { N(everipass), "everipass_v2", false, [](int) {
+            return to_abi_variant("everipass_v2", everipass_v2{ evt_link::parse_from_evtli(kLink), std::string("memo") });
+        }},
+        { N(everipay), "everipay", false, [](int) {
+            return to_abi_variant("everipay", everipay{ evt_link::parse_from_evtli(kLink), address(kKey2), evt_asset(100) });
+        }},
+        { N(everipay), "everipay_v2", false, [](int) {
+            return to_abi_variant("everipay_v2", everipay_v2{ evt_link::parse_from_evtli(kLink), address(kKey2), evt_asset(100), std::string("memo") });
+        }},
+        { N(prodvote), "prodvote", false, [](int) {
+            return to_abi_variant("prodvote", prodvote{ N(producer), N128(network-charge-factor), 1 });
+        }},
+        { N(updsched), "updsched", true, [](int n) {
+            auto us = updsched();
+            for(auto i = 0; i < n; i++) {
+                us.producers.emplace_back(producer_key{ N(producer), i % 2 ? kKey2 : kKey1 });
+            }
+            return to_abi_variant("updsched", us);
+        }},
+        { N(newlock), "newlock", true, [](int n) {
+            auto nl        = newlock();
+            nl.name        = N128(bmlock);
+            nl.proposer    = kKey1;
+            nl.unlock_time = time_point_sec(1'600'000'000);
+            nl.deadline    = time_point_sec(1'600'001'000);
+
+            auto nft = locknft_def{ N128(bmdomain), {} };
+            for(auto i = 0; i < n; i++) {
+                nft.names.emplace_back(name128::from_number(i));
+            }
+            nl.assets.emplace_back(std::move(nft));
+            nl.assets.emplace_back(lockft_def{ address(kKey1), evt_asset(100) });
+
+            auto cond      = lock_condkeys();
+            cond.threshold = 1;
+            cond.cond_keys = { kKey1, kKey2 };
+            nl.condition   = lock_condition(std::move(cond));
+            nl.succeed     = make_addrs(1);
+            nl.failed      = make_addrs(1);
+            return to_abi_variant("newlock", nl);
+        }},
+        { N(aprvlock), "aprvlock", false, [](int) {
+            return to_abi_variant("aprvlock", aprvlock{ N128(bmlock), kKey1, lock_aprvdata(void_t()) });
+        }},
+        { N(tryunlock), "tryunlock", false, [](int) {
+            return to_abi_variant("tryunlock", tryunlock{ N128(bmlock), kKey1 });
+        }},
+        { N(setpsvbonus), "setpsvbonus", true, [](int n) {
+            auto sp           = setpsvbonus();
+            sp.sym            = symbol(5, 3);
+            sp.rate           = percent_type("0.15");
+            sp.base_charge    = asset(10, symbol(5, 3));
+            sp.dist_threshold = asset(1'000, symbol(5, 3));
+            for(auto i = 0; i < n; i++) {
+                sp.rules.emplace_back(dist_fixed_rule{ dist_receiver(address(kKey1)), asset(1, symbol(5, 3)) });
+            }
+            sp.methods.emplace_back(N(transferft), passive_method_type::within_amount);
+            return to_abi_variant("setpsvbonus", sp);
+        }},
+        { N(setpsvbonus), "setpsvbonus_v2", true, [](int n) {
+            auto sp           = setpsvbonus_v2();
+            sp.sym_id         = 3;
+            sp.rate           = percent_slim(15'000);
+            sp.base_charge    = asset(10, symbol(5, 3));
+            sp.dist_threshold = asset(1'000, symbol(5, 3));
+            for(auto i = 0; i < n; i++) {
+                sp.rules.emplace_back(dist_fixed_rule{ dist_receiver(address(kKey1)), asset(1, symbol(5, 3)) });
+            }
+            sp.methods.emplace_back(N(transferft), passive_method_type::within_amount);
+            return to_abi_variant("setpsvbonus_v2", sp);
+        }},
+        { N(distpsvbonus), "distpsvbonus", false, [](int) {
+            return to_abi_variant("distpsvbonus", distpsvbonus{ 3, time_point(), address(kKey2) });
+        }}
+    };
+    return samples;
+}
+
+struct sample_data {
+    fc::variant var;
+    bytes       bin;
+};
+
+// samples are built once for each (type, n)
+const sample_data&
+get_sample_data(int index, int n) {
+    static auto cache = std::map<std::pair<int, int>, sample_data>();
+
+    auto it = cache.find(std::make_pair(index, n));
+    if(it != cache.end()) {
+        return it->second;
+    }
+
+    auto& s   = get_samples()[index];
+    auto  var = s.make(n);
+    auto  bin = get_abis().variant_to_binary(s.type, var, get_exec_ctx());
+    return cache.emplace(std::make_pair(index, n), sample_data{ std::move(var), std::move(bin) }).first->second;
+}
+
+void
+action_args(benchmark::internal::Benchmark* b) {
+    auto& samples = get_samples();
+    for(auto i = 0u; i < samples.size(); i++) {
+        if(!samples[i].scalable) {
+            b->Args({ (int)i, 1 });
+            continue;
+        }
+        for(auto n : { 1, 64, 1024, 8192 }) {
+            b->Args({ (int)i, n });
+        }
+    }
+}
+
+void
+set_label(benchmark::State& state, const sample_data& data) {
+    auto& s = get_samples()[state.range(0)];
+    state.SetLabel(s.scalable ? (s.type + "/" + std::to_string(state.range(1))) : s.type);
+    state.SetBytesProcessed(state.iterations() * data.bin.size());
+}
+
+// a block with `n` transactions, each with one action of every sample type
+signed_block
+make_block(int n) {
+    auto  block   = signed_block();
+    auto& samples = get_samples();
+    auto  key     = private_key_type::regenerate<fc::ecc::private_key_shim>(fc::sha256::hash(std::string("bmkey")));
+
+    for(auto i = 0; i < n; i++) {
+        auto trx       = signed_transaction();
+        trx.expiration = time_point_sec(1'600'000'000);
+        trx.payer      = address(kKey1);
+        for(auto& s : samples) {
+            if(&s != &samples.back() && (&s + 1)->act == s.act) {
+                continue;  // actions are rendered by their latest versions, skips the old ones
+            }
+            auto& data = get_sample_data(&s - &samples[0], 1);
+            trx.actions.emplace_back(s.act, N128(bmdomain), name128::from_number(i), data.bin);
+        }
+        trx.sign(key, chain_id_type(fc::sha256()));
+        block.transactions.emplace_back(packed_transaction(trx));
+    }
+    return block;
+}
+
+}  // namespace
+
+static void
+BM_Abi_binary_to_variant(benchmark::State& state) {
+    auto& type = get_samples()[state.range(0)].type;
+    auto& data = get_sample_data(state.range(0), state.range(1));
+
+    for(auto _ : state) {
+        auto var = get_abis().binary_to_variant(type, data.bin, get_exec_ctx());
+        benchmark::DoNotOptimize(var);
+    }
+    set_label(state, data);
+}
+BENCHMARK(BM_Abi_binary_to_variant)->Apply(action_args);
+
+static void
+BM_Abi_variant_to_binary(benchmark::State& state) {
+    auto& type = get_samples()[state.range(0)].type;
+    auto& data = get_sample_data(state.range(0), state.range(1));
+
+    for(auto _ : state) {
+        auto bin = get_abis().variant_to_binary(type, data.var, get_exec_ctx());
+        benchmark::DoNotOptimize(bin);
+    }
+    set_label(state, data);
+}
+BENCHMARK(BM_Abi_variant_to_binary)->Apply(action_args);
+
+static void
+BM_Abi_binary_to_json(benchmark::State& state) {
+    auto& type = get_samples()[state.range(0)].type;
+    auto& data = get_sample_data(state.range(0), state.range(1));
+
+    for(auto _ : state) {
+        auto json = get_abis().binary_to_json(type, data.bin, get_exec_ctx());
+        benchmark::DoNotOptimize(json);
+    }
+    set_label(state, data);
+}
+BENCHMARK(BM_Abi_binary_to_json)->Apply(action_args);
+
+// variant and json parsed back to binary, the round trip of a request body
+static void
+BM_Abi_json_round_trip(benchmark::State& state) {
+    auto& type = get_samples()[state.range(0)].type;
+    auto& data = get_sample_data(state.range(0), state.range(1));
+    auto  json = fc::json::to_string(data.var);
+
+    for(auto _ : state) {
+        auto var = fc::json::from_string(json);
+        auto bin = get_abis().variant_to_binary(type, var, get_exec_ctx());
+        benchmark::DoNotOptimize(bin);
+    }
+    set_label(state, data);
+}
+BENCHMARK(BM_Abi_json_round_trip)->Apply(action_args);
+
+// renders a block like `get_block` of chain api
+static void
+BM_Abi_get_block(benchmark::State& state) {
+    auto block = make_block(state.range(0));
+
+    for(auto _ : state) {
+        auto var = fc::variant();
+        get_abis().to_variant(block, var, get_exec_ctx());
+        auto json = fc::json::to_string(var);
+        benchmark::DoNotOptimize(json);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Abi_get_block)->Arg(1)->Arg(100)->Arg(1000);
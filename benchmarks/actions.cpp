@@ -5,6 +5,8 @@
 
 #include <benchmark/benchmark.h>
 #include <chrono>
+#include <cmath>
+#include <evt/chain/authority_checker.hpp>
 #include <evt/chain/token_database.hpp>
 #include <evt/chain/transaction_context.hpp>
 #include <evt/chain/execution_context_mock.hpp>
@@ -325,7 +327,8 @@ BM_Action_issuetoken(benchmark::State& state) {
         trx_ctx.exec();
         trx_ctx.squash();
     }
-    state.SetItemsProcessed(state.iterations());
+    // counted by tokens so that throughput of different list sizes are comparable
+    state.SetItemsProcessed(state.iterations() * state.range(0));
 
     state.SetLabel(std::string("total: ") + std::to_string(state.iterations() * state.range(0)));
 }
@@ -1229,3 +1232,120 @@ BM_Action_trx_sig_digest(benchmark::State& state) {
     state.SetItemsProcessed(state.iterations());
 }
 BENCHMARK(BM_Action_trx_sig_digest)->Range(1, 8 << 10);
+
+
+// children of each non-leaf node so that `keys` leaves are `depth` levels below root
+static int
+get_group_fanout(int keys, int depth) {
+    return (int)std::ceil(std::pow(keys, 1.0 / depth) - 1e-9);
+}
+
+// splits keys in [begin, end) evenly into children of the node, root has zero weight
+static fc::mutable_variant_object
+make_group_node(const std::vector<public_key_type>& keys, int begin, int end, int depth, int fanout, int threshold, int weight) {
+    auto nodes = fc::variants();
+    if(depth == 1) {
+        for(auto i = begin; i < end; i++) {
+            nodes.emplace_back(fc::mutable_variant_object("key", keys[i])("weight", 1));
+        }
+    }
+    else {
+        auto chunk = (end - begin + fanout - 1) / fanout;
+        for(auto i = begin; i < end; i += chunk) {
+            nodes.emplace_back(make_group_node(keys, i, std::min(i + chunk, end), depth - 1, fanout, 1, 1));
+        }
+    }
+    return fc::mutable_variant_object("threshold", threshold)("weight", weight)("nodes", std::move(nodes));
+}
+
+// args are number of keys in group, depth of group tree and number of signatures
+static void
+auth_group_args(benchmark::internal::Benchmark* b) {
+    for(auto keys : {10, 100, 1000}) {
+        for(auto depth : {1, 2, 3}) {
+            auto fanout = get_group_fanout(keys, depth);
+            auto chunk  = (keys + fanout - 1) / fanout;
+            auto roots  = (keys + chunk - 1) / chunk;  // children of root
+            for(auto sigs : {1, 4, 16}) {
+                if(sigs <= roots) {
+                    b->Args({keys, depth, sigs});
+                }
+            }
+        }
+    }
+}
+
+// Checks authorization of `Act` in a domain whose permissions all refer to a group, root of group
+// requires one signature from each of the last `sigs` subtrees and the signed key is the last one
+// of each subtree, so all the nodes of group are visited before it's satisfied.
+template<uint64_t Act>
+static void
+BM_Auth_group(benchmark::State& state) {
+    auto tester = create_tester();
+    auto auths  = std::vector<name>{N(evt)};
+
+    auto nkeys = (int)state.range(0);
+    auto depth = (int)state.range(1);
+    auto nsigs = (int)state.range(2);
+
+    auto keys = std::vector<public_key_type>();
+    keys.reserve(nkeys);
+    for(auto i = 0; i < nkeys; i++) {
+        keys.emplace_back(private_key_type::generate().get_public_key());
+    }
+
+    auto fanout = get_group_fanout(nkeys, depth);
+    auto root   = make_group_node(keys, 0, nkeys, depth, fanout, nsigs, 0);
+
+    auto ng = newgroup();
+    ng.name = get_nonce_name("group");
+    fc::from_variant(fc::mutable_variant_object("name", ng.name)("key", evt::testing::tester::get_public_key("evt"))("root", std::move(root)), ng.group);
+    tester->push_action(action(N128(.group), ng.name, ng), auths, address());
+
+    auto nd    = fc::json::from_string(ndjson).as<newdomain>();
+    nd.name    = get_nonce_name("domain");
+    nd.creator = evt::testing::tester::get_public_key("evt");
+    nd.issue.authorizers[0].ref.set_group(ng.name);
+    nd.transfer.authorizers[0].ref.set_group(ng.name);
+    nd.manage.authorizers[0].ref.set_account(nd.creator);
+    tester->push_action(action(nd.name, N128(.create), nd), auths, address());
+
+    // last key of each of the last `nsigs` children of root
+    auto signing_keys = public_keys_set();
+    auto chunk        = (nkeys + fanout - 1) / fanout;
+    auto roots        = (nkeys + chunk - 1) / chunk;
+    for(auto i = roots - nsigs; i < roots; i++) {
+        signing_keys.emplace(keys[std::min((i + 1) * chunk, nkeys) - 1]);
+    }
+
+    auto act = action();
+    if constexpr(Act == N(transfer)) {
+        auto tt   = transfer();
+        tt.domain = nd.name;
+        tt.name   = get_nonce_name("token");
+        tt.to     = {address(nd.creator)};
+        act       = action(tt.domain, tt.name, tt);
+    }
+    else {
+        auto it   = issuetoken();
+        it.domain = nd.name;
+        it.names  = {get_nonce_name("token")};
+        it.owner  = {address(nd.creator)};
+        act       = action(it.domain, N128(.issue), it);
+    }
+
+    auto& control  = *tester->control;
+    auto& exec_ctx = static_cast<const evt_execution_context&>(control.get_execution_context());
+    auto  max_depth = control.get_global_properties().configuration.max_authority_depth;
+
+    for(auto _ : state) {
+        auto checker = authority_checker(control, exec_ctx, signing_keys, max_depth);
+        if(!checker.satisfied(act)) {
+            state.SkipWithError("authorization is not satisfied");
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_Auth_group, N(transfer))->Apply(auth_group_args);
+BENCHMARK_TEMPLATE(BM_Auth_group, N(issuetoken))->Apply(auth_group_args);
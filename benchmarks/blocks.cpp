@@ -0,0 +1,373 @@
+/**
+ *  @file
+ *  @copyright defined in evt/LICENSE.txt
+ */
+
+#include <benchmark/benchmark.h>
+#include <map>
+#include <evt/chain/contracts/evt_link.hpp>
+#include <evt/testing/tester.hpp>
+#include <fc/io/json.hpp>
+
+/*
+ * Benchmarks of applying whole blocks with mixes of transactions,
+ * blocks are generated once by a producing tester and then pushed to fresh validating ones
+ */
+
+using namespace evt::chain;
+using namespace evt::chain::contracts;
+using evt::testing::tester;
+
+namespace {
+
+enum trx_mix {
+    transferft_heavy = 0,
+    nft_issuance,
+    everipay_heavy,
+    suspend_proposals,
+    mixed,
+    mix_count
+};
+
+const char* mix_names[] = { "transferft", "issuetoken", "everipay", "newsuspend", "mixed" };
+
+const int kBlocksNum = 10;
+
+const char* domain_json = R"=====(
+{
+  "name" : "bmdomain",
+  "creator" : "EVT546WaW3zFAxEEEkYKjDiMvg3CHRjmWX2XdNxEhi69RpdKuQRSK",
+  "issue" : {
+    "name" : "issue",
+    "threshold" : 1,
+    "authorizers": [{ "ref": "[A] EVT546WaW3zFAxEEEkYKjDiMvg3CHRjmWX2XdNxEhi69RpdKuQRSK", "weight": 1 }]
+  },
+  "transfer": {
+    "name": "transfer",
+    "threshold": 1,
+    "authorizers": [{ "ref": "[G] .OWNER", "weight": 1 }]
+  },
+  "manage": {
+    "name": "manage",
+    "threshold": 1,
+    "authorizers": [{ "ref": "[A] EVT546WaW3zFAxEEEkYKjDiMvg3CHRjmWX2XdNxEhi69RpdKuQRSK", "weight": 1 }]
+  }
+}
+)=====";
+
+const char* fungible_json = R"=====(
+{
+  "name": "BMFT",
+  "sym_name": "BMFT",
+  "sym": "5,S#4242",
+  "creator": "EVT546WaW3zFAxEEEkYKjDiMvg3CHRjmWX2XdNxEhi69RpdKuQRSK",
+  "issue" : {
+    "name" : "issue",
+    "threshold" : 1,
+    "authorizers": [{ "ref": "[A] EVT546WaW3zFAxEEEkYKjDiMvg3CHRjmWX2XdNxEhi69RpdKuQRSK", "weight": 1 }]
+  },
+  "manage": {
+    "name" : "manage",
+    "threshold" : 1,
+    "authorizers": [{ "ref": "[A] EVT546WaW3zFAxEEEkYKjDiMvg3CHRjmWX2XdNxEhi69RpdKuQRSK", "weight": 1 }]
+  },
+  "total_supply":"100000000.00000 S#4242"
+}
+)=====";
+
+fc::path
+bench_dir() {
+    return fc::path("/tmp/evt_benchmarks_blocks");
+}
+
+// cleans the directory of node, block log in blocks_log_dir is copied in if provided
+void
+reset_node_dir(const fc::path& dir, const fc::path& blocks_log_dir = fc::path()) {
+    if(fc::exists(dir)) {
+        fc::remove_all(dir);
+    }
+    fc::create_directories(dir);
+
+    if(!blocks_log_dir.empty()) {
+        fc::create_directories(dir / "blocks");
+        fc::copy(blocks_log_dir / "blocks.log", dir / "blocks" / "blocks.log");
+        fc::copy(blocks_log_dir / "blocks.index", dir / "blocks" / "blocks.index");
+    }
+}
+
+std::unique_ptr<tester>
+open_block_tester(const fc::path& dir, validation_mode mode = validation_mode::FULL) {
+    fc::logger::get().set_log_level(fc::log_level(fc::log_level::error));
+
+    auto cfg = controller::config();
+
+    cfg.blocks_dir            = dir / "blocks";
+    cfg.state_dir             = dir / "state";
+    cfg.db_config.db_path     = dir / "tokendb";
+    cfg.state_size            = 1024 * 1024 * 64;
+    cfg.reversible_cache_size = 1024 * 1024 * 64;
+    cfg.contracts_console     = false;
+    cfg.charge_free_mode      = true;
+    cfg.loadtest_mode         = true;
+    cfg.block_validation_mode = mode;
+
+    cfg.genesis.initial_timestamp = fc::time_point::from_iso_string("2020-01-01T00:00:00.000");
+    cfg.genesis.initial_key       = tester::get_public_key("evt");
+
+    auto t = std::make_unique<tester>(cfg);
+    t->block_signing_private_keys.insert(std::make_pair(cfg.genesis.initial_key, tester::get_private_key("evt")));
+
+    return t;
+}
+
+std::unique_ptr<tester>
+create_block_tester(const fc::path& dir, validation_mode mode = validation_mode::FULL) {
+    reset_node_dir(dir);
+    return open_block_tester(dir, mode);
+}
+
+// names of keys only have letters
+std::string
+letters(uint64_t n) {
+    auto str = std::string("k");
+    do {
+        str.push_back('a' + n % 26);
+        n /= 26;
+    } while(n > 0);
+    return str;
+}
+
+// generates blocks of transactions in the given mix
+class block_generator {
+public:
+    block_generator(trx_mix mix, int trxs_per_block)
+        : mix_(mix)
+        , trxs_per_block_(trxs_per_block)
+        , key_(tester::get_public_key("evt"))
+        , payee_(tester::get_public_key("payee")) {}
+
+public:
+    std::vector<signed_block_ptr>
+    generate(const fc::path& dir) {
+        tester_ = create_block_tester(dir);
+
+        auto blocks = std::vector<signed_block_ptr>();
+        setup();
+        blocks.emplace_back(tester_->produce_block());
+
+        for(auto i = 0; i < kBlocksNum; i++) {
+            for(auto j = 0; j < trxs_per_block_; j++) {
+                auto trx = next_trx(j);
+                tester_->push_transaction(trx);
+            }
+            blocks.emplace_back(tester_->produce_block());
+        }
+        // makes all the blocks above irreversible, so they're written into block log
+        for(auto i = 0; i < 3; i++) {
+            blocks.emplace_back(tester_->produce_empty_block());
+        }
+
+        tester_.reset();
+        return blocks;
+    }
+
+private:
+    void
+    setup() {
+        auto nd    = fc::json::from_string(domain_json).as<newdomain>();
+        nd.creator = key_;
+        nd.issue.authorizers[0].ref.set_account(key_);
+        nd.manage.authorizers[0].ref.set_account(key_);
+        push(action(nd.name, N128(.create), nd));
+        domain_ = nd.name;
+
+        auto nf    = fc::json::from_string(fungible_json).as<newfungible>();
+        nf.creator = key_;
+        nf.issue.authorizers[0].ref.set_account(key_);
+        nf.manage.authorizers[0].ref.set_account(key_);
+        push(action(N128(.fungible), name128::from_number(nf.sym.id()), nf));
+        sym_ = nf.sym;
+
+        auto isf    = issuefungible();
+        isf.address = key_;
+        isf.number  = nf.total_supply;
+        push(action(N128(.fungible), name128::from_number(sym_.id()), isf));
+    }
+
+    void
+    push(action&& act) {
+        tester_->push_action(std::move(act), { N(evt) }, address());
+    }
+
+    name128
+    next_name(const char* prefix) {
+        return name128(std::string(prefix) + std::to_string(nonce_++));
+    }
+
+    action
+    next_action(trx_mix mix) {
+        switch(mix) {
+        case transferft_heavy: {
+            auto tf   = transferft();
+            tf.from   = key_;
+            tf.to     = tester::get_public_key(name(letters(nonce_++ % 1000)));
+            tf.number = asset(1, sym_);
+            return action(N128(.fungible), name128::from_number(sym_.id()), tf);
+        }
+        case nft_issuance: {
+            auto it   = issuetoken();
+            it.domain = domain_;
+            it.owner  = { key_ };
+            it.names.emplace_back(next_name("t"));
+            return action(domain_, N128(.issue), it);
+        }
+        case everipay_heavy: {
+            auto id = std::string(16, '\0');
+            auto n  = nonce_++;
+            memcpy(&id[0], &n, sizeof(n));
+
+            auto ep = everipay();
+            ep.link.set_header(evt_link::version1 | evt_link::everiPay);
+            ep.link.add_segment(evt_link::segment(evt_link::timestamp, tester_->control->head_block_time().sec_since_epoch()));
+            ep.link.add_segment(evt_link::segment(evt_link::max_pay, 1'000'000));
+            ep.link.add_segment(evt_link::segment(evt_link::symbol_id, sym_.id()));
+            ep.link.add_segment(evt_link::segment(evt_link::link_id, id));
+            ep.link.sign(tester::get_private_key("evt"));
+            ep.payee  = payee_;
+            ep.number = asset(1, sym_);
+            return action(N128(.fungible), name128::from_number(sym_.id()), ep);
+        }
+        case suspend_proposals:
+        default: {
+            auto nd    = fc::json::from_string(domain_json).as<newdomain>();
+            nd.name    = next_name("d");
+            nd.creator = key_;
+
+            auto ns           = newsuspend();
+            ns.name           = next_name("s");
+            ns.proposer       = key_;
+            ns.trx.expiration = tester_->control->head_block_time() + fc::hours(1);
+            ns.trx.set_reference_block(tester_->control->head_block_id());
+            ns.trx.actions.emplace_back(action(nd.name, N128(.create), nd));
+            return action(N128(.suspend), ns.name, ns);
+        }
+        }  // switch
+    }
+
+    signed_transaction
+    next_trx(int index) {
+        auto mix = (mix_ == mixed) ? (trx_mix)(index % mixed) : mix_;
+
+        auto trx = signed_transaction();
+        trx.actions.emplace_back(next_action(mix));
+        tester_->set_transaction_headers(trx, address(), 1'000'000, 60);
+        trx.sign(tester::get_private_key("evt"), tester_->control->get_chain_id());
+        return trx;
+    }
+
+private:
+    trx_mix mix_;
+    int     trxs_per_block_;
+
+    std::unique_ptr<tester> tester_;
+    public_key_type         key_;
+    public_key_type         payee_;
+    domain_name             domain_;
+    symbol                  sym_;
+    uint64_t                nonce_ = 0;
+};
+
+struct generated_blocks {
+    std::vector<signed_block_ptr> blocks;
+    fc::path                      blocks_dir;  // has block log of the blocks
+};
+
+// blocks are generated once for each mix and size, then shared by the benchmarks
+const generated_blocks&
+get_blocks(trx_mix mix, int trxs_per_block) {
+    static auto cache = std::map<std::pair<int, int>, generated_blocks>();
+
+    auto it = cache.find(std::make_pair(mix, trxs_per_block));
+    if(it != cache.end()) {
+        return it->second;
+    }
+
+    auto dir = bench_dir() / (std::string("gen-") + mix_names[mix] + "-" + std::to_string(trxs_per_block));
+    auto gb  = generated_blocks();
+
+    gb.blocks     = block_generator(mix, trxs_per_block).generate(dir);
+    gb.blocks_dir = dir / "blocks";
+
+    return cache.emplace(std::make_pair(mix, trxs_per_block), std::move(gb)).first->second;
+}
+
+void
+block_args(benchmark::internal::Benchmark* b) {
+    for(auto mix = 0; mix < mix_count; mix++) {
+        for(auto n : { 100, 1000 }) {
+            b->Args({ mix, n });
+        }
+    }
+}
+
+void
+push_blocks(benchmark::State& state, validation_mode mode) {
+    auto  mix = (trx_mix)state.range(0);
+    auto& gb  = get_blocks(mix, state.range(1));
+    auto  dir = bench_dir() / "validator";
+
+    for(auto _ : state) {
+        state.PauseTiming();
+        auto validator = create_block_tester(dir, mode);
+        state.ResumeTiming();
+
+        for(auto& b : gb.blocks) {
+            validator->push_block(b);
+        }
+
+        state.PauseTiming();
+        validator.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * kBlocksNum * state.range(1));
+    state.SetLabel(mix_names[mix]);
+}
+
+}  // namespace
+
+// full validation, keys of signatures are recovered and authorizations are checked
+static void
+BM_Block_push(benchmark::State& state) {
+    push_blocks(state, validation_mode::FULL);
+}
+BENCHMARK(BM_Block_push)->Apply(block_args)->Unit(benchmark::kMillisecond);
+
+// light validation, authorizations are skipped so no key is recovered
+static void
+BM_Block_push_light(benchmark::State& state) {
+    push_blocks(state, validation_mode::LIGHT);
+}
+BENCHMARK(BM_Block_push_light)->Apply(block_args)->Unit(benchmark::kMillisecond);
+
+// replays the pre-generated block log on startup of a fresh node
+static void
+BM_Block_replay(benchmark::State& state) {
+    auto  mix = (trx_mix)state.range(0);
+    auto& gb  = get_blocks(mix, state.range(1));
+    auto  dir = bench_dir() / "replay";
+
+    for(auto _ : state) {
+        state.PauseTiming();
+        reset_node_dir(dir, gb.blocks_dir);
+        state.ResumeTiming();
+
+        auto node = open_block_tester(dir);
+
+        state.PauseTiming();
+        node.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * kBlocksNum * state.range(1));
+    state.SetLabel(mix_names[mix]);
+}
+BENCHMARK(BM_Block_replay)->Apply(block_args)->Unit(benchmark::kMillisecond);
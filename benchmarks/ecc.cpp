@@ -68,3 +68,22 @@ BM_ECC_VerifySignature(benchmark::State& state) {
     state.SetItemsProcessed(state.iterations());
 }
 BENCHMARK(BM_ECC_VerifySignature);
+
+static void
+BM_ECC_RecoverBatch(benchmark::State& state) {
+    const auto kBatchSize = 256u;
+
+    auto items = recovery_items();
+    for(auto i = 0u; i < kBatchSize; i++) {
+        auto pkey   = private_key::generate();
+        auto digest = sha256::hash(std::to_string(i));
+        items.emplace_back(pkey.sign(digest), digest);
+    }
+
+    for(auto _ : state) {
+        auto keys = recover_public_keys(items, state.range(0));
+        benchmark::DoNotOptimize(keys);
+    }
+    state.SetItemsProcessed(state.iterations() * kBatchSize);
+}
+BENCHMARK(BM_ECC_RecoverBatch)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
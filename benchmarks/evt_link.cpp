@@ -0,0 +1,36 @@
+/**
+ *  @file
+ *  @copyright defined in evt/LICENSE.txt
+ */
+
+#include <benchmark/benchmark.h>
+#include <evt/chain/contracts/evt_link.hpp>
+
+/*
+ * Benchmarks for parsing and formatting EVT-Links
+ */
+
+using namespace evt::chain::contracts;
+
+static const auto kEveriPassLink = std::string("03XBY4E/KTS:PNHVA3JP9QG258F08JHYOYR5SLJGN0EA-C3J6S:2G:T1SX7WA14KH9ETLZ97TUX9R9JJA6+06$E/_PYNX-/152P4CTC:WKXLK$/7G-K:89+::2K4C-KZ2**HI-P8CYJ**XGFO1K5:$E*SOY8MFYWMNHP*BHX2U8$$FTFI81YDP1HT");
+
+static void
+BM_EvtLink_Parse(benchmark::State& state) {
+    for(auto _ : state) {
+        auto link = evt_link::parse_from_evtli(kEveriPassLink);
+        benchmark::DoNotOptimize(link);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_EvtLink_Parse);
+
+static void
+BM_EvtLink_ToString(benchmark::State& state) {
+    auto link = evt_link::parse_from_evtli(kEveriPassLink);
+    for(auto _ : state) {
+        auto str = link.to_string();
+        benchmark::DoNotOptimize(str);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_EvtLink_ToString);
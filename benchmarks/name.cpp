@@ -0,0 +1,61 @@
+/**
+ *  @file
+ *  @copyright defined in evt/LICENSE.txt
+ */
+
+#include <benchmark/benchmark.h>
+#include <evt/chain/name.hpp>
+#include <evt/chain/name128.hpp>
+
+/*
+ * Benchmarks for parsing and formatting names
+ */
+
+using namespace evt::chain;
+
+static const auto kName128s = std::vector<std::string>{ "t1", "token12345", "domain.123-abc", "1234567890ABCDEFGHIJK" };
+static const auto kNames    = std::vector<std::string>{ "a", "transfer", "issuetoken", "everipay1234a" };
+
+static void
+BM_Name128_Parse(benchmark::State& state) {
+    auto& str = kName128s[state.range(0)];
+    for(auto _ : state) {
+        auto n = name128(str);
+        benchmark::DoNotOptimize(n);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Name128_Parse)->DenseRange(0, 3);
+
+static void
+BM_Name128_ToString(benchmark::State& state) {
+    auto n = name128(kName128s[state.range(0)]);
+    for(auto _ : state) {
+        auto str = n.to_string();
+        benchmark::DoNotOptimize(str);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Name128_ToString)->DenseRange(0, 3);
+
+static void
+BM_Name_Parse(benchmark::State& state) {
+    auto& str = kNames[state.range(0)];
+    for(auto _ : state) {
+        auto n = name(str);
+        benchmark::DoNotOptimize(n);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Name_Parse)->DenseRange(0, 3);
+
+static void
+BM_Name_ToString(benchmark::State& state) {
+    auto n = name(kNames[state.range(0)]);
+    for(auto _ : state) {
+        auto str = n.to_string();
+        benchmark::DoNotOptimize(str);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Name_ToString)->DenseRange(0, 3);
@@ -0,0 +1,412 @@
+/**
+ *  @file
+ *  @copyright defined in evt/LICENSE.txt
+ */
+
+#include <benchmark/benchmark.h>
+#include <thread>
+#include <boost/asio.hpp>
+#include <zstd.h>
+#include <fc/network/message_buffer.hpp>
+#include <evt/chain/contracts/types.hpp>
+#include <evt/net_plugin/protocol.hpp>
+
+/*
+ * Benchmarks of packing and unpacking the messages of net_plugin, and of receiving them from a socket
+ */
+
+using namespace evt;
+using namespace evt::chain::contracts;
+
+namespace {
+
+constexpr auto message_header_size = 4;
+
+enum class msg_kind {
+    handshake = 0,
+    chain_size,
+    go_away,
+    time,
+    notice,
+    request,
+    sync_request,
+    block,
+    trx,
+    trx_batch,
+    compact_block,
+    compressed_block,
+    max_value = compressed_block
+};
+
+const char* kind_names[] = { "handshake", "chain_size", "go_away", "time", "notice", "request", "sync_request",
+                             "block", "trx", "trx_batch", "compact_block", "compressed_block" };
+
+const auto kKey1 = public_key_type(std::string("EVT6MRyAjQq8ud7hVNYcfnVPJqcVpscN5So8BhtHuGYqET5GDW5CV"));
+const auto kKey2 = public_key_type(std::string("EVT8MGU4aKiVzqMtWi9zLpu8KuTHZWjQQrX475ycSxEkLd6aBpraX"));
+
+auto&
+get_private_key() {
+    static auto key = private_key_type::regenerate<fc::ecc::private_key_shim>(fc::sha256::hash(std::string("bmkey")));
+    return key;
+}
+
+// a transaction with `n` transferft actions, signed by one key
+packed_transaction
+make_trx(int n, int seq) {
+    auto trx       = signed_transaction();
+    trx.expiration = time_point_sec(1'600'000'000);
+    trx.payer      = address(kKey1);
+    for(auto i = 0; i < n; i++) {
+        auto tf = transferft{ address(kKey1), address(kKey2), asset(seq + i + 1, evt_sym()), "memo" };
+        trx.actions.emplace_back(N128(.fungible), name128::from_number(1), tf);
+    }
+    trx.sign(get_private_key(), chain_id_type(fc::sha256()));
+    return packed_transaction(trx);
+}
+
+// a block with `n` transactions of one action each
+signed_block
+make_block(int n) {
+    auto block      = signed_block();
+    block.timestamp = block_timestamp_type(fc::time_point_sec(1'600'000'000));
+    block.producer  = N(evt);
+    for(auto i = 0; i < n; i++) {
+        block.transactions.emplace_back(make_trx(1, i));
+    }
+    block.producer_signature = get_private_key().sign(block.digest());
+    return block;
+}
+
+template<typename T>
+std::vector<T>
+make_ids(int n) {
+    auto ids = std::vector<T>();
+    for(auto i = 0; i < n; i++) {
+        ids.emplace_back(fc::sha256::hash(std::to_string(i)));
+    }
+    return ids;
+}
+
+// packs the message with its length header, in the same way as `create_send_buffer` of net_plugin
+std::vector<char>
+make_send_buffer(const net_message& msg) {
+    auto payload_size = (uint32_t)fc::raw::pack_size(msg);
+    auto buffer       = std::vector<char>(message_header_size + payload_size);
+    auto ds           = fc::datastream<char*>(buffer.data(), buffer.size());
+    ds.write((const char*)&payload_size, message_header_size);
+    fc::raw::pack(ds, msg);
+    return buffer;
+}
+
+// net message of `kind`, `n` is the number of ids, transactions or actions depending on the kind
+net_message
+make_message(msg_kind kind, int n) {
+    switch(kind) {
+    case msg_kind::handshake: {
+        auto hs            = handshake_message();
+        hs.network_version = 4;
+        hs.chain_id        = chain_id_type(fc::sha256::hash(std::string("chain")));
+        hs.node_id         = fc::sha256::hash(std::string("node"));
+        hs.key             = kKey1;
+        hs.time            = fc::time_point::now().time_since_epoch().count();
+        hs.token           = fc::sha256::hash(hs.time);
+        hs.sig             = get_private_key().sign(hs.token);
+        hs.p2p_address     = "127.0.0.1:7272 - 0123456";
+        hs.head_num        = 1'000'000;
+        hs.head_id         = fc::sha256::hash(std::string("head"));
+        hs.os              = "linux";
+        hs.agent           = "\"EVT Test Agent\"";
+        hs.generation      = 1;
+        return hs;
+    }
+    case msg_kind::chain_size: {
+        return chain_size_message{ 999'000, fc::sha256::hash(std::string("lib")), 1'000'000, fc::sha256::hash(std::string("head")) };
+    }
+    case msg_kind::go_away: {
+        return go_away_message(benign_other);
+    }
+    case msg_kind::time: {
+        auto now = fc::time_point::now().time_since_epoch().count();
+        return time_message{ now, now, now, 0 };
+    }
+    case msg_kind::notice: {
+        auto nm                 = notice_message();
+        nm.known_trx.mode       = normal;
+        nm.known_trx.ids        = make_ids<transaction_id_type>(n);
+        nm.known_blocks.mode    = normal;
+        nm.known_blocks.pending = n;
+        nm.known_blocks.ids     = make_ids<block_id_type>(n);
+        return nm;
+    }
+    case msg_kind::request: {
+        auto rm            = request_message();
+        rm.req_trx.mode    = normal;
+        rm.req_trx.ids     = make_ids<transaction_id_type>(n);
+        rm.req_blocks.mode = normal;
+        rm.req_blocks.ids  = make_ids<block_id_type>(n);
+        return rm;
+    }
+    case msg_kind::sync_request: {
+        return sync_request_message{ 1, 1'000 };
+    }
+    case msg_kind::block: {
+        return make_block(n);
+    }
+    case msg_kind::trx: {
+        return make_trx(n, 0);
+    }
+    case msg_kind::trx_batch: {
+        auto tb = transaction_batch_message();
+        for(auto i = 0; i < n; i++) {
+            tb.trxs.emplace_back(make_trx(1, i));
+        }
+        return tb;
+    }
+    case msg_kind::compact_block: {
+        auto sb   = make_block(n);
+        auto cb   = compact_block_message();
+        cb.header = sb;
+        for(auto& r : sb.transactions) {
+            auto cr   = compact_receipt();
+            cr.status = r.status;
+            cr.type   = r.type;
+            cr.id     = r.trx.id();
+            cb.trxs.emplace_back(std::move(cr));
+        }
+        return cb;
+    }
+    case msg_kind::compressed_block: {
+        auto raw = make_send_buffer(make_block(n));
+        auto cm  = compressed_message();
+        cm.data.resize(ZSTD_compressBound(raw.size() - message_header_size));
+
+        auto sz = ZSTD_compress(cm.data.data(), cm.data.size(), raw.data() + message_header_size, raw.size() - message_header_size, 3);
+        FC_ASSERT(!ZSTD_isError(sz));
+        cm.data.resize(sz);
+        return cm;
+    }
+    default: {
+        FC_ASSERT(false);
+    }
+    }  // switch
+}
+
+bool
+is_scalable(msg_kind kind) {
+    switch(kind) {
+    case msg_kind::notice:
+    case msg_kind::request:
+    case msg_kind::block:
+    case msg_kind::trx:
+    case msg_kind::trx_batch:
+    case msg_kind::compact_block:
+    case msg_kind::compressed_block:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void
+message_args(benchmark::internal::Benchmark* b) {
+    for(auto kind = 0; kind <= (int)msg_kind::max_value; kind++) {
+        if(!is_scalable((msg_kind)kind)) {
+            b->Args({ kind, 1 });
+            continue;
+        }
+        for(auto n : { 1, 100, 1000 }) {
+            b->Args({ kind, n });
+        }
+    }
+}
+
+void
+receive_args(benchmark::internal::Benchmark* b) {
+    for(auto kind : { msg_kind::notice, msg_kind::block, msg_kind::trx, msg_kind::trx_batch, msg_kind::compact_block, msg_kind::compressed_block }) {
+        for(auto n : { 1, 100, 1000 }) {
+            b->Args({ (int)kind, n });
+        }
+    }
+}
+
+void
+set_label(benchmark::State& state, size_t bytes) {
+    auto kind = (msg_kind)state.range(0);
+    auto name = kind_names[state.range(0)];
+    state.SetLabel(is_scalable(kind) ? (std::string(name) + "/" + std::to_string(state.range(1))) : name);
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * bytes);
+}
+
+// handles messages like `msg_handler` of net_plugin does before they reach the chain,
+// compressed ones are decompressed and the inner messages are handled
+struct bench_msg_handler : public fc::visitor<void> {
+    template<typename T>
+    void
+    operator()(const T& msg) const {
+        benchmark::DoNotOptimize(&msg);
+    }
+
+    void
+    operator()(const packed_transaction& msg) const {
+        benchmark::DoNotOptimize(msg.id());
+    }
+
+    void
+    operator()(const transaction_batch_message& msg) const {
+        for(auto& t : msg.trxs) {
+            benchmark::DoNotOptimize(t.id());
+        }
+    }
+
+    void
+    operator()(const compressed_message& msg) const {
+        auto size = ZSTD_getFrameContentSize(msg.data.data(), msg.data.size());
+        auto raw  = std::vector<char>(size);
+        auto sz   = ZSTD_decompress(raw.data(), raw.size(), msg.data.data(), msg.data.size());
+        FC_ASSERT(!ZSTD_isError(sz) && sz == size);
+
+        auto ds    = fc::datastream<const char*>(raw.data(), raw.size());
+        auto inner = net_message();
+        fc::raw::unpack(ds, inner);
+        inner.visit(*this);
+    }
+};
+
+// reading end of a loopback connection, splits the received bytes into messages
+// with the same buffer and framing as the read loop of `connection` in net_plugin
+class receiver {
+public:
+    receiver(boost::asio::ip::tcp::socket& socket)
+        : socket_(socket) {}
+
+public:
+    // reads until `count` messages are handled, the bytes of following ones are kept
+    void
+    receive(int count) {
+        auto handled = 0;
+        while(handled < count) {
+            auto bytes_in_buffer = buffer_.bytes_to_read();
+            if(bytes_in_buffer >= message_header_size) {
+                auto message_length = uint32_t();
+                auto index          = buffer_.read_index();
+                buffer_.peek(&message_length, sizeof(message_length), index);
+
+                auto total_message_bytes = message_length + message_header_size;
+                if(bytes_in_buffer >= total_message_bytes) {
+                    buffer_.advance_read_ptr(message_header_size);
+
+                    auto ds  = buffer_.create_datastream();
+                    auto msg = net_message();
+                    fc::raw::unpack(ds, msg);
+                    msg.visit(handler_);
+
+                    handled++;
+                    continue;
+                }
+
+                auto outstanding_message_bytes = total_message_bytes - bytes_in_buffer;
+                auto available_buffer_bytes    = buffer_.bytes_to_write();
+                if(outstanding_message_bytes > available_buffer_bytes) {
+                    buffer_.add_space(outstanding_message_bytes - available_buffer_bytes);
+                }
+                read(outstanding_message_bytes);
+            }
+            else {
+                read(message_header_size - bytes_in_buffer);
+            }
+        }
+    }
+
+private:
+    void
+    read(size_t minimum_read) {
+        auto completion_handler = [minimum_read](boost::system::error_code ec, std::size_t bytes_transferred) -> std::size_t {
+            if(ec || bytes_transferred >= minimum_read) {
+                return 0;
+            }
+            else {
+                return minimum_read - bytes_transferred;
+            }
+        };
+
+        auto bytes_transferred = boost::asio::read(socket_, buffer_.get_buffer_sequence_for_boost_async_read(), completion_handler);
+        buffer_.advance_write_ptr(bytes_transferred);
+    }
+
+private:
+    boost::asio::ip::tcp::socket&   socket_;
+    fc::message_buffer<1024 * 1024> buffer_;
+    bench_msg_handler               handler_;
+};
+
+}  // namespace
+
+static void
+BM_Net_pack(benchmark::State& state) {
+    auto msg  = make_message((msg_kind)state.range(0), state.range(1));
+    auto size = size_t(0);
+
+    for(auto _ : state) {
+        auto buffer = make_send_buffer(msg);
+        size        = buffer.size();
+        benchmark::DoNotOptimize(buffer);
+    }
+    set_label(state, size);
+}
+BENCHMARK(BM_Net_pack)->Apply(message_args);
+
+static void
+BM_Net_unpack(benchmark::State& state) {
+    auto buffer = make_send_buffer(make_message((msg_kind)state.range(0), state.range(1)));
+
+    for(auto _ : state) {
+        auto ds  = fc::datastream<const char*>(buffer.data() + message_header_size, buffer.size() - message_header_size);
+        auto msg = net_message();
+        fc::raw::unpack(ds, msg);
+        benchmark::DoNotOptimize(msg);
+    }
+    set_label(state, buffer.size());
+}
+BENCHMARK(BM_Net_unpack)->Apply(message_args);
+
+// one peer keeps sending the message over a loopback tcp connection, each iteration
+// reads, unpacks and handles one of them
+static void
+BM_Net_receive(benchmark::State& state) {
+    using boost::asio::ip::tcp;
+
+    auto buffer = make_send_buffer(make_message((msg_kind)state.range(0), state.range(1)));
+
+    // sends a few messages in each write, like the write queue of connection does
+    auto stream = std::vector<char>();
+    while(stream.size() < 64 * 1024 || stream.empty()) {
+        stream.insert(stream.end(), buffer.begin(), buffer.end());
+    }
+
+    auto ios      = boost::asio::io_service();
+    auto acceptor = tcp::acceptor(ios, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+    auto sender   = tcp::socket(ios);
+    auto socket   = tcp::socket(ios);
+    sender.connect(acceptor.local_endpoint());
+    acceptor.accept(socket);
+
+    auto writer = std::thread([&] {
+        auto ec = boost::system::error_code();
+        while(!ec) {
+            boost::asio::write(sender, boost::asio::buffer(stream), ec);
+        }
+    });
+
+    auto r = receiver(socket);
+    for(auto _ : state) {
+        r.receive(1);
+    }
+
+    // writer stops once its writes fail
+    socket.close();
+    writer.join();
+
+    set_label(state, buffer.size());
+}
+BENCHMARK(BM_Net_receive)->Apply(receive_args);
@@ -0,0 +1,217 @@
+#!/usr/bin/env python3
+
+# Runs evt_benchmarks and tracks their results against stored baselines.
+#
+#   runner.py run <evt_benchmarks> -o result.json    runs benchmarks and writes json results
+#   runner.py save result.json                        stores the results as baselines of this machine class
+#   runner.py compare result.json                     compares the results with the baselines
+#
+# Baselines are kept in `baselines/<machine class>.json`, one entry per benchmark, so saving
+# a partial run only updates the benchmarks in it. Machine class defaults to the cpu model
+# and number of cpus, results of different machines are never compared.
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+
+TIME_UNITS = {'ns': 1, 'us': 1e3, 'ms': 1e6, 's': 1e9}
+AGGREGATES = ('mean', 'median', 'stddev', 'cv')
+
+
+def machine_class(context):
+    model = ''
+    try:
+        with open('/proc/cpuinfo') as f:
+            for line in f:
+                if line.startswith('model name'):
+                    model = line.split(':', 1)[1]
+                    break
+    except OSError:
+        pass
+    if not model:
+        model = '{}mhz'.format(context.get('mhz_per_cpu', 0))
+    model = re.sub(r'[^a-z0-9]+', '-', model.lower()).strip('-')
+    return '{}-{}c'.format(model, context.get('num_cpus', 0))
+
+
+def load_results(path):
+    """returns the context and {benchmark: {'time': ns, 'stddev': ns}} using medians of repetitions"""
+    with open(path) as f:
+        doc = json.load(f)
+
+    results = {}
+    for b in doc['benchmarks']:
+        if b.get('error_occurred'):
+            continue
+        name = b.get('run_name', b['name'])
+        aggregate = b.get('aggregate_name')
+        if aggregate is None and b.get('run_type', 'iteration') == 'iteration':
+            # older versions only mark aggregates by the suffix of name
+            m = re.match(r'^(.*)_({})$'.format('|'.join(AGGREGATES)), name)
+            if m:
+                name, aggregate = m.groups()
+
+        t = b['cpu_time'] * TIME_UNITS[b.get('time_unit', 'ns')]
+        r = results.setdefault(name, {'samples': []})
+        if aggregate is None:
+            r['samples'].append(t)
+        elif aggregate in ('median', 'stddev'):
+            r[aggregate] = t
+
+    for r in results.values():
+        samples = sorted(r.pop('samples'))
+        if 'median' not in r:
+            r['median'] = samples[len(samples) // 2]
+        if 'stddev' not in r:
+            if len(samples) > 1:
+                mean = sum(samples) / len(samples)
+                r['stddev'] = (sum((s - mean) ** 2 for s in samples) / (len(samples) - 1)) ** 0.5
+            else:
+                r['stddev'] = 0.0
+        r['time'] = r.pop('median')
+    return doc.get('context', {}), results
+
+
+def baseline_path(args, context):
+    return os.path.join(args.baselines, (args.machine or machine_class(context)) + '.json')
+
+
+def format_time(ns):
+    for unit in ('s', 'ms', 'us'):
+        if ns >= TIME_UNITS[unit]:
+            return '{:.2f} {}'.format(ns / TIME_UNITS[unit], unit)
+    return '{:.1f} ns'.format(ns)
+
+
+def cmd_run(args):
+    cmd = [args.binary,
+           '--benchmark_out=' + args.output,
+           '--benchmark_out_format=json',
+           '--benchmark_repetitions={}'.format(args.repetitions),
+           '--benchmark_report_aggregates_only=true']
+    if args.filter:
+        cmd.append('--benchmark_filter=' + args.filter)
+    return subprocess.call(cmd + args.extra)
+
+
+def cmd_save(args):
+    context, results = load_results(args.result)
+    path = baseline_path(args, context)
+
+    baselines = {}
+    if os.path.exists(path):
+        with open(path) as f:
+            baselines = json.load(f)
+    baselines.update(results)
+
+    os.makedirs(os.path.dirname(os.path.abspath(path)), exist_ok=True)
+    with open(path, 'w') as f:
+        json.dump(baselines, f, indent=2, sort_keys=True)
+    print('saved {} baselines into {}'.format(len(results), path))
+    return 0
+
+
+def threshold_of(args, name):
+    for pattern, threshold in args.threshold_for:
+        if re.search(pattern, name):
+            return threshold
+    return args.threshold
+
+
+def cmd_compare(args):
+    context, results = load_results(args.result)
+    path = baseline_path(args, context)
+    if not os.path.exists(path):
+        print('no baselines for this machine at {}, run `save` first'.format(path))
+        return 0 if args.allow_missing else 2
+
+    with open(path) as f:
+        baselines = json.load(f)
+
+    rows = []
+    regressions = 0
+    for name in sorted(set(results) | set(baselines)):
+        cur, base = results.get(name), baselines.get(name)
+        if cur is None:
+            if not args.hide_missing:
+                rows.append((name, format_time(base['time']), '-', '-', 'missing'))
+            continue
+        if base is None:
+            rows.append((name, '-', format_time(cur['time']), '-', 'new'))
+            continue
+
+        change = (cur['time'] - base['time']) / base['time'] * 100
+        # changes within the noise of both runs are not counted either
+        noise = (cur['stddev'] + base['stddev']) / base['time'] * 100 * args.noise_factor
+        limit = max(threshold_of(args, name), noise)
+        if change > limit:
+            status = 'REGRESSION'
+            regressions += 1
+        elif change < -limit:
+            status = 'improved'
+        else:
+            status = ''
+        if status or not args.changes_only:
+            rows.append((name, format_time(base['time']), format_time(cur['time']), '{:+.1f}%'.format(change), status))
+
+    header = ('Benchmark', 'Baseline', 'Current', 'Change', 'Status')
+    widths = [max(len(r[i]) for r in rows + [header]) for i in range(len(header))]
+    line = '  '.join('{{:{}{}}}'.format('<' if i == 0 else '>', w) for i, w in enumerate(widths))
+    print(line.format(*header))
+    print('  '.join('-' * w for w in widths))
+    for r in rows:
+        print(line.format(*r))
+
+    improved = sum(1 for r in rows if r[4] == 'improved')
+    print('\n{} regressions, {} improvements in {} benchmarks compared with {}'.format(
+        regressions, improved, len(set(results) & set(baselines)), path))
+    return 1 if regressions > 0 else 0
+
+
+def parse_threshold_for(s):
+    pattern, _, threshold = s.rpartition('=')
+    if not pattern:
+        raise argparse.ArgumentTypeError('expect REGEX=PERCENT')
+    return pattern, float(threshold)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Runs evt_benchmarks and compares results with baselines')
+    parser.add_argument('--baselines', default=os.path.join(os.path.dirname(os.path.abspath(__file__)), 'baselines'),
+                        help='dir of baseline files')
+    parser.add_argument('--machine', help='machine class of the baselines, defaults to cpu model and number of cpus')
+    sub = parser.add_subparsers(dest='command')
+    sub.required = True
+
+    run = sub.add_parser('run', help='runs benchmarks and writes json results')
+    run.add_argument('binary', help='path of evt_benchmarks')
+    run.add_argument('-o', '--output', default='benchmarks.json')
+    run.add_argument('-f', '--filter', help='regex of benchmarks to run')
+    run.add_argument('-r', '--repetitions', type=int, default=3)
+    run.add_argument('extra', nargs=argparse.REMAINDER, help='more arguments of evt_benchmarks')
+    run.set_defaults(func=cmd_run)
+
+    save = sub.add_parser('save', help='stores results as baselines')
+    save.add_argument('result')
+    save.set_defaults(func=cmd_save)
+
+    compare = sub.add_parser('compare', help='compares results with baselines, exits with 1 on regressions')
+    compare.add_argument('result')
+    compare.add_argument('-t', '--threshold', type=float, default=5.0, help='percent of cpu time change regarded as significant')
+    compare.add_argument('--threshold-for', type=parse_threshold_for, action='append', default=[], metavar='REGEX=PERCENT',
+                         help='threshold of the benchmarks matching regex, the first match wins')
+    compare.add_argument('--noise-factor', type=float, default=2.0, help='changes within this many stddevs are ignored')
+    compare.add_argument('--changes-only', action='store_true', help='only lists regressions and improvements')
+    compare.add_argument('--hide-missing', action='store_true', help="doesn't list baselines missing in results")
+    compare.add_argument('--allow-missing', action='store_true', help="succeeds if there are no baselines for the machine")
+    compare.set_defaults(func=cmd_compare)
+
+    args = parser.parse_args()
+    sys.exit(args.func(args))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,306 @@
+/**
+ *  @file
+ *  @copyright defined in evt/LICENSE.txt
+ */
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <evt/chain/token_database.hpp>
+#include <evt/chain/token_database_cache.hpp>
+#include <fc/filesystem.hpp>
+
+/*
+ * Benchmarks of token database and its cache under storage profiles, value sizes and key distributions
+ */
+
+using namespace evt::chain;
+
+struct bench_value {
+    std::string data;
+};
+FC_REFLECT(bench_value, (data));
+
+namespace {
+
+const int kKeysNum = 100'000;
+
+enum key_dist {
+    uniform = 0,
+    zipf
+};
+
+const auto bench_domain = name128("bmdomain");
+
+// samples indexes in [0, n) with zipf distribution (s = 1) by searching precomputed cdf
+class zipf_distribution {
+public:
+    zipf_distribution(int n) : cdf_(n) {
+        auto sum = 0.0;
+        for(auto i = 0; i < n; i++) {
+            sum += 1.0 / (i + 1);
+            cdf_[i] = sum;
+        }
+        for(auto& c : cdf_) {
+            c /= sum;
+        }
+    }
+
+public:
+    template<typename E>
+    int
+    operator()(E& engine) {
+        auto p = std::uniform_real_distribution<double>(0, 1)(engine);
+        return std::min<int>(std::lower_bound(cdf_.begin(), cdf_.end(), p) - cdf_.begin(), cdf_.size() - 1);
+    }
+
+private:
+    std::vector<double> cdf_;
+};
+
+// generates the indexes of keys to look up
+class key_generator {
+public:
+    key_generator(key_dist dist, int n)
+        : dist_(dist)
+        , uniform_(0, n - 1)
+        , zipf_(dist == zipf ? n : 1) {}
+
+public:
+    uint64_t
+    next() {
+        return (dist_ == uniform) ? uniform_(engine_) : zipf_(engine_);
+    }
+
+private:
+    key_dist                           dist_;
+    std::default_random_engine         engine_;
+    std::uniform_int_distribution<int> uniform_;
+    zipf_distribution                  zipf_;
+};
+
+const char*
+profile_name(storage_profile profile) {
+    return profile == storage_profile::disk ? "disk" : "memory";
+}
+
+// opens an empty database and loads `keys` tokens with values of `value_size` bytes
+std::unique_ptr<token_database>
+open_db(storage_profile profile, int value_size, int keys = kKeysNum) {
+    auto dir = fc::path("/tmp/evt_benchmarks_tokendb");
+    if(fc::exists(dir)) {
+        fc::remove_all(dir);
+    }
+    fc::create_directories(dir);
+
+    auto cfg    = token_database::config();
+    cfg.profile = profile;
+    cfg.db_path = dir / "tokendb";
+
+    auto db = std::make_unique<token_database>(cfg);
+    db->open();
+
+    auto v = make_db_value(bench_value{ std::string(value_size, 'v') });
+    for(auto i = 0; i < keys; i++) {
+        db->put_token(token_type::token, action_op::add, bench_domain, name128::from_number(i), v.as_string_view());
+    }
+    return db;
+}
+
+void
+profile_args(benchmark::internal::Benchmark* b) {
+    for(auto profile : { 0, 1 }) {
+        for(auto size : { 64, 1024 }) {
+            b->Args({ profile, size });
+        }
+    }
+}
+
+void
+dist_args(benchmark::internal::Benchmark* b) {
+    for(auto profile : { 0, 1 }) {
+        for(auto size : { 64, 1024 }) {
+            for(auto dist : { uniform, zipf }) {
+                b->Args({ profile, size, dist });
+            }
+        }
+    }
+}
+
+void
+cache_args(benchmark::internal::Benchmark* b) {
+    for(auto profile : { 0, 1 }) {
+        for(auto dist : { uniform, zipf }) {
+            for(auto cache_size : { 1 << 20, 64 << 20 }) {
+                b->Args({ profile, dist, cache_size });
+            }
+        }
+    }
+}
+
+void
+savepoint_args(benchmark::internal::Benchmark* b) {
+    for(auto profile : { 0, 1 }) {
+        for(auto op : { 0, 1, 2 }) {
+            b->Args({ profile, op });
+        }
+    }
+}
+
+void
+set_label(benchmark::State& state, storage_profile profile) {
+    state.SetLabel(profile_name(profile));
+}
+
+}  // namespace
+
+static void
+BM_TokenDB_put_token(benchmark::State& state) {
+    auto profile = (storage_profile)state.range(0);
+    auto db      = open_db(profile, state.range(1), 0);
+    auto v       = make_db_value(bench_value{ std::string(state.range(1), 'v') });
+
+    auto i = 0;
+    for(auto _ : state) {
+        db->put_token(token_type::token, action_op::put, bench_domain, name128::from_number(i++ % kKeysNum), v.as_string_view());
+    }
+    state.SetItemsProcessed(state.iterations());
+    set_label(state, profile);
+}
+BENCHMARK(BM_TokenDB_put_token)->Apply(profile_args);
+
+static void
+BM_TokenDB_put_tokens(benchmark::State& state) {
+    const int kBatchSize = 16;
+
+    auto profile = (storage_profile)state.range(0);
+    auto db      = open_db(profile, state.range(1), 0);
+    auto v       = make_db_value(bench_value{ std::string(state.range(1), 'v') });
+    auto data    = small_vector<std::string_view, 4>(kBatchSize, v.as_string_view());
+
+    auto i = 0;
+    for(auto _ : state) {
+        auto keys = token_keys_t();
+        for(auto j = 0; j < kBatchSize; j++) {
+            keys.emplace_back(name128::from_number(i++ % kKeysNum));
+        }
+        db->put_tokens(token_type::token, action_op::put, bench_domain, std::move(keys), data);
+    }
+    state.SetItemsProcessed(state.iterations() * kBatchSize);
+    set_label(state, profile);
+}
+BENCHMARK(BM_TokenDB_put_tokens)->Apply(profile_args);
+
+static void
+BM_TokenDB_read_token(benchmark::State& state) {
+    auto profile = (storage_profile)state.range(0);
+    auto db      = open_db(profile, state.range(1));
+    auto gen     = key_generator((key_dist)state.range(2), kKeysNum);
+    auto str     = std::string();
+
+    for(auto _ : state) {
+        db->read_token(token_type::token, bench_domain, name128::from_number(gen.next()), str);
+        benchmark::DoNotOptimize(str);
+    }
+    state.SetItemsProcessed(state.iterations());
+    set_label(state, profile);
+}
+BENCHMARK(BM_TokenDB_read_token)->Apply(dist_args);
+
+// half of the keys looked up don't exist
+static void
+BM_TokenDB_exists_token(benchmark::State& state) {
+    auto profile = (storage_profile)state.range(0);
+    auto db      = open_db(profile, state.range(1));
+    auto gen     = key_generator((key_dist)state.range(2), kKeysNum * 2);
+
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(db->exists_token(token_type::token, bench_domain, name128::from_number(gen.next())));
+    }
+    state.SetItemsProcessed(state.iterations());
+    set_label(state, profile);
+}
+BENCHMARK(BM_TokenDB_exists_token)->Apply(dist_args);
+
+static void
+BM_TokenDB_read_tokens_range(benchmark::State& state) {
+    auto profile = (storage_profile)state.range(0);
+    auto db      = open_db(profile, state.range(1));
+    auto dre     = std::default_random_engine();
+    auto dist    = std::uniform_int_distribution<int>(0, kKeysNum - 100);
+
+    for(auto _ : state) {
+        auto n = 0;
+        db->read_tokens_range(token_type::token, bench_domain, name128::from_number(dist(dre)), [&n](auto& k, auto&& v) {
+            benchmark::DoNotOptimize(v);
+            return ++n < 100;
+        });
+    }
+    state.SetItemsProcessed(state.iterations() * 100);
+    set_label(state, profile);
+}
+BENCHMARK(BM_TokenDB_read_tokens_range)->Apply(profile_args);
+
+// one savepoint with 100 puts, then it's finished by rollback(0), squash(1) or pop(2)
+static void
+BM_TokenDB_savepoint(benchmark::State& state) {
+    auto profile = (storage_profile)state.range(0);
+    auto db      = open_db(profile, 64);
+    auto v       = make_db_value(bench_value{ std::string(64, 'v') });
+    auto op      = state.range(1);
+
+    auto seq = (int64_t)1;
+    auto i   = 0;
+    if(op == 1) {
+        db->add_savepoint(seq++);
+    }
+    for(auto _ : state) {
+        db->add_savepoint(seq++);
+        for(auto j = 0; j < 100; j++) {
+            db->put_token(token_type::token, action_op::put, bench_domain, name128::from_number(i++ % kKeysNum), v.as_string_view());
+        }
+        switch(op) {
+        case 0: db->rollback_to_latest_savepoint(); break;
+        case 1: db->squash(); break;
+        case 2: db->pop_savepoints(seq); break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(std::string(profile_name(profile)) + (op == 0 ? " rollback" : (op == 1 ? " squash" : " pop")));
+}
+BENCHMARK(BM_TokenDB_savepoint)->Apply(savepoint_args);
+
+// lookups are hits unless the keys are evicted from the cache of given size
+static void
+BM_TokenDB_cache_read(benchmark::State& state) {
+    auto profile = (storage_profile)state.range(0);
+    auto db      = open_db(profile, 256);
+    auto cache   = token_database_cache(*db, state.range(2));
+    auto gen     = key_generator((key_dist)state.range(1), kKeysNum);
+
+    for(auto _ : state) {
+        auto ptr = cache.read_token<bench_value>(token_type::token, bench_domain, name128::from_number(gen.next()));
+        benchmark::DoNotOptimize(ptr);
+    }
+    state.SetItemsProcessed(state.iterations());
+    set_label(state, profile);
+}
+BENCHMARK(BM_TokenDB_cache_read)->Apply(cache_args);
+
+// keys don't exist, they're answered by the cache of misses after first lookups
+static void
+BM_TokenDB_cache_miss(benchmark::State& state) {
+    auto profile = (storage_profile)state.range(0);
+    auto db      = open_db(profile, 256);
+    auto cache   = token_database_cache(*db, state.range(2));
+    auto gen     = key_generator((key_dist)state.range(1), kKeysNum);
+
+    for(auto _ : state) {
+        auto key = name128::from_number(kKeysNum + gen.next());
+        benchmark::DoNotOptimize(cache.exists_token(token_type::token, bench_domain, key));
+    }
+    state.SetItemsProcessed(state.iterations());
+    set_label(state, profile);
+}
+BENCHMARK(BM_TokenDB_cache_miss)->Apply(cache_args);
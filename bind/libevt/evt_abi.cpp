@@ -44,18 +44,69 @@ extract_data<bytes>(evt_data_t* data, bytes& val) {
     return EVT_OK; 
 } 
 
+// serializer and versions of actions are never changed here, so all the handles share the same ones
 struct abi_context {
-    std::unique_ptr<abi_serializer>             abi;
-    std::unique_ptr<evt_execution_context_mock> exec_ctx;
+    std::shared_ptr<const abi_serializer>             abi;
+    std::shared_ptr<const evt_execution_context_mock> exec_ctx;
 };
 
+namespace {
+
+const abi_context&
+shared_abi_context() {
+    static auto abic = [] {
+        auto exec_ctx = std::make_shared<evt_execution_context_mock>();
+        auto abi      = std::make_shared<abi_serializer>(evt::chain::contracts::evt_contract_abi(), std::chrono::hours(1));
+        abi->bind_actions(*exec_ctx);
+
+        return abi_context { .abi = abi, .exec_ctx = exec_ctx };
+    }();
+    return abic;
+}
+
+int
+json_to_bin(abi_context& abic, const std::string& type, const char* json, bytes& bin) {
+    auto var = fc::variant();
+    try {
+        var = fc::json::from_string(json);
+        if(!var.is_object()) {
+            return EVT_INVALID_JSON;
+        }
+    }
+    CATCH_AND_RETURN(EVT_INVALID_JSON)
+
+    try {
+        bin = abic.abi->variant_to_binary(type, var, *abic.exec_ctx);
+        if(bin.empty()) {
+            return EVT_INVALID_JSON;
+        }
+    }
+    CATCH_AND_RETURN(EVT_INTERNAL_ERROR)
+
+    return EVT_OK;
+}
+
+int
+trx_json_to_digest(abi_context& abic, const char* json, const chain_id_type& chain_id, sha256& digest) {
+    auto trx = transaction();
+    try {
+        auto var = fc::json::from_string(json);
+        abic.abi->from_variant(var, trx, *abic.exec_ctx);
+
+        digest = trx.sig_digest(chain_id);
+    }
+    CATCH_AND_RETURN(EVT_INTERNAL_ERROR)
+
+    return EVT_OK;
+}
+
+}  // namespace
+
 extern "C" {
 
 void*
 evt_abi() {
-    auto abic      = new abi_context();
-    abic->abi      = std::make_unique<abi_serializer>(evt::chain::contracts::evt_contract_abi(), std::chrono::hours(1));
-    abic->exec_ctx = std::make_unique<evt_execution_context_mock>();
+    auto abic = new abi_context(shared_abi_context());
 
     return (void*)abic;
 }
@@ -80,29 +131,68 @@ evt_abi_json_to_bin(void* evt_abi, const char* action, const char* json, evt_bin
         return EVT_INVALID_ARGUMENT;
     }
     auto& abic = *(abi_context*)evt_abi;
-    auto  var  = fc::variant();
-    try {
-        var = fc::json::from_string(json);
-        if(!var.is_object()) {
-            return EVT_INVALID_JSON;
-        }
+    auto  type = abic.exec_ctx->get_acttype_name(action);
+    if(type.empty()) {
+        return EVT_INVALID_ACTION;
     }
-    CATCH_AND_RETURN(EVT_INVALID_JSON)
 
-    auto type = abic.exec_ctx->get_acttype_name(action);
+    auto b = bytes();
+    auto r = json_to_bin(abic, type, json, b);
+    if(r != EVT_OK) {
+        return r;
+    }
+    *bin = get_evt_data(b);
+
+    return EVT_OK;
+}
+
+int
+evt_abi_json_to_bin_batch(void* evt_abi, const char* action, const char** jsons, size_t count, char* bins /* out */, size_t capacity, size_t* sizes /* out */, uint32_t threads) {
+    if(evt_abi == nullptr) {
+        return EVT_INVALID_ARGUMENT;
+    }
+    if(action == nullptr) {
+        return EVT_INVALID_ARGUMENT;
+    }
+    if(jsons == nullptr) {
+        return EVT_INVALID_ARGUMENT;
+    }
+    if(bins == nullptr && capacity > 0) {
+        return EVT_INVALID_ARGUMENT;
+    }
+    if(sizes == nullptr) {
+        return EVT_INVALID_ARGUMENT;
+    }
+    auto& abic = *(abi_context*)evt_abi;
+    auto  type = abic.exec_ctx->get_acttype_name(action);
     if(type.empty()) {
         return EVT_INVALID_ACTION;
     }
-    try {
-        auto b = abic.abi->variant_to_binary(type, var, *abic.exec_ctx);
-        if(b.empty()) {
-            return EVT_INVALID_JSON;
+
+    auto bs = std::vector<bytes>(count);
+    auto r  = parallel_run(count, threads, [&](size_t i) {
+        if(jsons[i] == nullptr) {
+            return EVT_INVALID_ARGUMENT;
         }
-        auto data = get_evt_data(b);
-        *bin = data;
+        return json_to_bin(abic, type, jsons[i], bs[i]);
+    });
+    if(r != EVT_OK) {
+        return r;
     }
-    CATCH_AND_RETURN(EVT_INTERNAL_ERROR)
-    
+
+    auto total = size_t(0);
+    for(auto i = 0u; i < count; i++) {
+        sizes[i] = bs[i].size();
+        total += bs[i].size();
+    }
+    if(total > capacity) {
+        return EVT_BUFFER_TOO_SMALL;
+    }
+    for(auto& b : bs) {
+        memcpy(bins, b.data(), b.size());
+        bins += b.size();
+    }
+
     return EVT_OK;
 }
 
@@ -156,19 +246,50 @@ evt_trx_json_to_digest(void* evt_abi, const char* json,  evt_chain_id_t* chain_i
     }
 
     auto& abic = *(abi_context*)evt_abi;
-    auto  trx  = transaction();
-    try {
-        auto var = fc::json::from_string(json);
-        abic.abi->from_variant(var, trx, *abic.exec_ctx);
-
-        auto d  = trx.sig_digest(chain_id_type(idhash));
-        *digest = get_evt_data(d);
+    auto  d    = sha256();
+    auto  r    = trx_json_to_digest(abic, json, chain_id_type(idhash), d);
+    if(r != EVT_OK) {
+        return r;
     }
-    CATCH_AND_RETURN(EVT_INTERNAL_ERROR)
+    *digest = get_evt_data(d);
 
     return EVT_OK;
 }
 
+int
+evt_trx_json_to_digests(void* evt_abi, const char** jsons, size_t count, evt_chain_id_t* chain_id, char* digests /* out */, uint32_t threads) {
+    if(evt_abi == nullptr) {
+        return EVT_INVALID_ARGUMENT;
+    }
+    if(jsons == nullptr) {
+        return EVT_INVALID_ARGUMENT;
+    }
+    if(digests == nullptr) {
+        return EVT_INVALID_ARGUMENT;
+    }
+    if(chain_id == nullptr) {
+        return EVT_INVALID_ARGUMENT;
+    }
+    sha256 idhash;
+    if(extract_data(chain_id, idhash) != EVT_OK) {
+        return EVT_INVALID_HASH;
+    }
+
+    auto& abic = *(abi_context*)evt_abi;
+    auto  cid  = chain_id_type(idhash);
+    return parallel_run(count, threads, [&](size_t i) {
+        if(jsons[i] == nullptr) {
+            return EVT_INVALID_ARGUMENT;
+        }
+        auto d = sha256();
+        auto r = trx_json_to_digest(abic, jsons[i], cid, d);
+        if(r == EVT_OK) {
+            memcpy(digests + i * EVT_CHECKSUM_SIZE, d.data(), EVT_CHECKSUM_SIZE);
+        }
+        return r;
+    });
+}
+
 int
 evt_chain_id_from_string(const char* str, evt_chain_id_t** chain_id /* out */) {
     return evt_checksum_from_string(str, chain_id);
@@ -118,6 +118,67 @@ evt_recover(evt_signature_t* sign, evt_checksum_t* hash, evt_public_key_t** pub_
     return EVT_OK;
 }
 
+int
+evt_sign_hashes(evt_private_key_t* priv_key, const char* hashes, size_t count, char* signs /* out */, uint32_t threads) {
+    if(priv_key == nullptr) {
+        return EVT_INVALID_ARGUMENT;
+    }
+    if(hashes == nullptr) {
+        return EVT_INVALID_ARGUMENT;
+    }
+    if(signs == nullptr) {
+        return EVT_INVALID_ARGUMENT;
+    }
+    auto pk = private_key();
+    if(extract_data(priv_key, pk) != EVT_OK) {
+        return EVT_INVALID_PRIVATE_KEY;
+    }
+
+    return parallel_run(count, threads, [&](size_t i) {
+        try {
+            auto h   = sha256(hashes + i * EVT_CHECKSUM_SIZE, EVT_CHECKSUM_SIZE);
+            auto sig = pk.sign(h);
+            auto ds  = fc::datastream<char*>(signs + i * EVT_SIGNATURE_SIZE, EVT_SIGNATURE_SIZE);
+            fc::raw::pack(ds, sig);
+        }
+        CATCH_AND_RETURN(EVT_INTERNAL_ERROR)
+
+        return EVT_OK;
+    });
+}
+
+int
+evt_recover_hashes(const char* signs, const char* hashes, size_t count, char* pub_keys /* out */, uint32_t threads) {
+    if(signs == nullptr) {
+        return EVT_INVALID_ARGUMENT;
+    }
+    if(hashes == nullptr) {
+        return EVT_INVALID_ARGUMENT;
+    }
+    if(pub_keys == nullptr) {
+        return EVT_INVALID_ARGUMENT;
+    }
+
+    return parallel_run(count, threads, [&](size_t i) {
+        auto sig = signature();
+        try {
+            auto ds = fc::datastream<const char*>(signs + i * EVT_SIGNATURE_SIZE, EVT_SIGNATURE_SIZE);
+            fc::raw::unpack(ds, sig);
+        }
+        CATCH_AND_RETURN(EVT_INVALID_SIGNATURE)
+
+        try {
+            auto h    = sha256(hashes + i * EVT_CHECKSUM_SIZE, EVT_CHECKSUM_SIZE);
+            auto pkey = public_key(sig, h);
+            auto ds   = fc::datastream<char*>(pub_keys + i * EVT_PUBLIC_KEY_SIZE, EVT_PUBLIC_KEY_SIZE);
+            fc::raw::pack(ds, pkey);
+        }
+        CATCH_AND_RETURN(EVT_INTERNAL_ERROR)
+
+        return EVT_OK;
+    });
+}
+
 int
 evt_hash(const char* buf, size_t sz, evt_checksum_t** hash /* out */) {
     if(buf == nullptr) {
@@ -6,7 +6,11 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
+#include <algorithm>
+#include <atomic>
 #include <string>
+#include <thread>
+#include <vector>
 #include <libevt/evt.h>
 #include <fc/io/raw.hpp>
 
@@ -47,6 +51,41 @@ extract_data(evt_data_t* data, T& val) {
     return EVT_OK;
 }
 
+// runs fn(i) for each of items over threads (0 for all cores), stops on failure and returns its code
+template <typename Fn>
+int
+parallel_run(size_t count, uint32_t threads, Fn&& fn) {
+    const size_t kMinLaneSize = 16;
+
+    if(threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    auto n = std::max<size_t>(1, std::min<size_t>(threads, count / kMinLaneSize));
+
+    auto result = std::atomic<int>(EVT_OK);
+    auto run    = [&](size_t begin, size_t end) {
+        for(auto i = begin; i < end && result.load(std::memory_order_relaxed) == EVT_OK; i++) {
+            auto r = fn(i);
+            if(r != EVT_OK) {
+                auto expected = EVT_OK;
+                result.compare_exchange_strong(expected, r);
+            }
+        }
+    };
+
+    // first range is run in current thread
+    auto step    = (count + n - 1) / n;
+    auto workers = std::vector<std::thread>();
+    for(auto begin = step; begin < count; begin += step) {
+        workers.emplace_back(run, begin, std::min(begin + step, count));
+    }
+    run(0, std::min(step, count));
+    for(auto& w : workers) {
+        w.join();
+    }
+    return result.load();
+}
+
 inline char*
 strdup(const std::string& str) {
     auto s = (char*)malloc(str.size() + 1); // add '\0'
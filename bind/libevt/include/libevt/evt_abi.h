@@ -21,6 +21,9 @@ void  evt_free_abi(void* abi);
 int evt_abi_json_to_bin(void* evt_abi, const char* action, const char* json, evt_bin_t** bin /* out */);
 int evt_abi_bin_to_json(void* evt_abi, const char* action, evt_bin_t* bin, char** json /* out */);
 int evt_trx_json_to_digest(void* evt_abi, const char* json, evt_chain_id_t* chain_id, evt_checksum_t** digest /* out */);
+/* bins are packed into caller's buffer with sizes of each, EVT_BUFFER_TOO_SMALL is returned with sizes filled if capacity is not enough */
+int evt_abi_json_to_bin_batch(void* evt_abi, const char* action, const char** jsons, size_t count, char* bins /* out */, size_t capacity, size_t* sizes /* out */, uint32_t threads);
+int evt_trx_json_to_digests(void* evt_abi, const char** jsons, size_t count, evt_chain_id_t* chain_id, char* digests /* out */, uint32_t threads);
 int evt_chain_id_from_string(const char* str, evt_chain_id_t** chain_id /* out */);
 int evt_block_id_from_string(const char* str, evt_block_id_t** block_id /* out */);
 int evt_ref_block_num(evt_block_id_t* block_id, uint16_t* ref_block_num);
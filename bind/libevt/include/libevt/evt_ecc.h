@@ -3,6 +3,7 @@
  *  @copyright defined in evt/LICENSE.txt
  */
 #pragma once
+#include <stdint.h>
 #include "evt.h"
 
 #ifdef __cplusplus
@@ -14,12 +15,21 @@ typedef evt_data_t evt_private_key_t;
 typedef evt_data_t evt_signature_t;
 typedef evt_data_t evt_checksum_t;
 
+/* sizes of items in the buffers of batch functions, same as bytes in buf of evt_data_t */
+#define EVT_CHECKSUM_SIZE   32
+#define EVT_SIGNATURE_SIZE  66
+#define EVT_PUBLIC_KEY_SIZE 34
+
 int evt_generate_new_pair(evt_public_key_t** pub_key /* out */, evt_private_key_t** priv_key /* out */);
 int evt_get_public_key(evt_private_key_t* priv_key, evt_public_key_t** pub_key /* out */);
 int evt_sign_hash(evt_private_key_t* priv_key, evt_checksum_t* hash, evt_signature_t** sign /* out */);
 int evt_recover(evt_signature_t* sign, evt_checksum_t* hash, evt_public_key_t** pub_key /* out */);
 int evt_hash(const char* buf, size_t sz, evt_checksum_t** hash /* out */);
 
+/* batch functions: items are packed one after another in caller's buffers, threads is 0 for all cores */
+int evt_sign_hashes(evt_private_key_t* priv_key, const char* hashes, size_t count, char* signs /* out */, uint32_t threads);
+int evt_recover_hashes(const char* signs, const char* hashes, size_t count, char* pub_keys /* out */, uint32_t threads);
+
 int evt_public_key_string(evt_public_key_t* pub_key, char** str /* out */);
 int evt_private_key_string(evt_private_key_t* priv_key, char** str /* out */);
 int evt_signature_string(evt_signature_t* sign, char** str /* out */);
@@ -1,4 +1,6 @@
 #include <iostream>
+#include <string>
+#include <vector>
 
 #define CATCH_CONFIG_MAIN
 #include <catch/catch.hpp>
@@ -208,6 +210,62 @@ TEST_CASE("evtecc") {
     evt_free(pubkey3);
 }
 
+TEST_CASE("evtbatch") {
+    evt_public_key_t*  pubkey  = nullptr;
+    evt_private_key_t* privkey = nullptr;
+    REQUIRE(evt_generate_new_pair(&pubkey, &privkey) == EVT_OK);
+    REQUIRE(pubkey->sz == EVT_PUBLIC_KEY_SIZE);
+
+    const size_t count = 100;
+    auto hashes = std::vector<char>(count * EVT_CHECKSUM_SIZE);
+    for(auto i = 0u; i < count; i++) {
+        auto str = std::to_string(i);
+        evt_checksum_t* hash = nullptr;
+        REQUIRE(evt_hash(str.data(), str.size(), &hash) == EVT_OK);
+        REQUIRE(hash->sz == EVT_CHECKSUM_SIZE);
+        memcpy(&hashes[i * EVT_CHECKSUM_SIZE], hash->buf, EVT_CHECKSUM_SIZE);
+        evt_free(hash);
+    }
+
+    auto signs = std::vector<char>(count * EVT_SIGNATURE_SIZE);
+    auto r1 = evt_sign_hashes(privkey, hashes.data(), count, signs.data(), 4);
+    REQUIRE(r1 == EVT_OK);
+
+    auto pubkeys = std::vector<char>(count * EVT_PUBLIC_KEY_SIZE);
+    auto r2 = evt_recover_hashes(signs.data(), hashes.data(), count, pubkeys.data(), 0);
+    REQUIRE(r2 == EVT_OK);
+    for(auto i = 0u; i < count; i++) {
+        CHECK(memcmp(&pubkeys[i * EVT_PUBLIC_KEY_SIZE], pubkey->buf, EVT_PUBLIC_KEY_SIZE) == 0);
+    }
+
+    auto abi = evt_abi();
+    REQUIRE(abi != nullptr);
+
+    auto j1 = R"({"name":"test1530718665","signatures":["SIG_K1_KXjtmeihJi1qnSs7vmqJDRJoZ1nSEPeeRjsKJRpm24g8yhFtAepkRDR4nVFbXjvoaQvT4QrzuNWCbuEhceYpGmAvsG47Fj"]})";
+    evt_bin_t* bin = nullptr;
+    REQUIRE(evt_abi_json_to_bin(abi, "aprvsuspend", j1, &bin) == EVT_OK);
+
+    const char* jsons[] = { j1, j1, j1 };
+    size_t sizes[3];
+    auto r3 = evt_abi_json_to_bin_batch(abi, "aprvsuspend", jsons, 3, nullptr, 0, sizes, 0);
+    REQUIRE(r3 == EVT_BUFFER_TOO_SMALL);
+    CHECK(sizes[0] == bin->sz);
+
+    auto bins = std::vector<char>(sizes[0] + sizes[1] + sizes[2]);
+    auto r4 = evt_abi_json_to_bin_batch(abi, "aprvsuspend", jsons, 3, bins.data(), bins.size(), sizes, 0);
+    REQUIRE(r4 == EVT_OK);
+    CHECK(memcmp(&bins[sizes[0] + sizes[1]], bin->buf, bin->sz) == 0);
+
+    const char* invalids[] = { j1, "aprvsuspend" };
+    auto r5 = evt_abi_json_to_bin_batch(abi, "aprvsuspend", invalids, 2, bins.data(), bins.size(), sizes, 0);
+    CHECK(r5 == EVT_INVALID_JSON);
+
+    evt_free(bin);
+    evt_free_abi(abi);
+    evt_free(pubkey);
+    evt_free(privkey);
+}
+
 TEST_CASE("evtabi") {
     auto abi = evt_abi();
     REQUIRE(abi != nullptr);
@@ -42,6 +42,48 @@ def trx_json_to_digest(json, chain_id):
     return EvtData(digest_c[0])
 
 
+def json_to_bin_batch(action, jsons, threads=0):
+    evt = libevt.check_lib_init()
+    action_c = bytes(action, encoding='utf-8')
+    jsons_b = [bytes(j, encoding='utf-8') for j in jsons]
+    jsons_s = [evt.ffi.new('char[]', j) for j in jsons_b]
+    jsons_c = evt.ffi.new('const char*[]', jsons_s)
+    sizes_c = evt.ffi.new('size_t[]', len(jsons))
+
+    # guess capacity by size of jsons, binaries are smaller mostly, retry with exact size otherwise
+    capacity = sum(len(j) for j in jsons_b)
+    while True:
+        bins_c = evt.ffi.new('char[]', max(capacity, 1))
+        ret = evt.lib.evt_abi_json_to_bin_batch(
+            evt.abi, action_c, jsons_c, len(jsons), bins_c, capacity, sizes_c, threads)
+        if ret != evt_exception.EVTErrCode.EVT_BUFFER_TOO_SMALL:
+            break
+        capacity = sum(sizes_c)
+    evt_exception.evt_exception_raiser(ret)
+
+    bins = evt.ffi.buffer(bins_c)
+    result, offset = [], 0
+    for i in range(len(jsons)):
+        result.append(EvtData.from_bytes(bins[offset:offset + sizes_c[i]]))
+        offset += sizes_c[i]
+    return result
+
+
+def trx_json_to_digests(jsons, chain_id, threads=0):
+    evt = libevt.check_lib_init()
+    jsons_b = [bytes(j, encoding='utf-8') for j in jsons]
+    jsons_s = [evt.ffi.new('char[]', j) for j in jsons_b]
+    jsons_c = evt.ffi.new('const char*[]', jsons_s)
+    digests_c = evt.ffi.new('char[]', len(jsons) * evt.lib.EVT_CHECKSUM_SIZE)
+    ret = evt.lib.evt_trx_json_to_digests(
+        evt.abi, jsons_c, len(jsons), chain_id.data, digests_c, threads)
+    evt_exception.evt_exception_raiser(ret)
+
+    digests = evt.ffi.buffer(digests_c)
+    size = evt.lib.EVT_CHECKSUM_SIZE
+    return [EvtData.from_bytes(digests[i * size:(i + 1) * size]) for i in range(len(jsons))]
+
+
 class ChainId(EvtData):
     def __init__(self, data):
         super().__init__(data)
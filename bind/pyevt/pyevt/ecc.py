@@ -126,3 +126,32 @@ def generate_new_pair():
     ret = evt.lib.evt_generate_new_pair(public_key_c, private_key_c)
     evt_exception.evt_exception_raiser(ret)
     return PublicKey(public_key_c[0]), PrivateKey(private_key_c[0])
+
+
+def sign_hashes(priv_key, hashes, threads=0):
+    # signs in one call into libevt on multiple threads, GIL is released by cffi meanwhile
+    evt = libevt.check_lib_init()
+    hashes_c = b''.join(h.to_bytes() for h in hashes)
+    signs_c = evt.ffi.new('char[]', len(hashes) * evt.lib.EVT_SIGNATURE_SIZE)
+    ret = evt.lib.evt_sign_hashes(
+        priv_key.data, hashes_c, len(hashes), signs_c, threads)
+    evt_exception.evt_exception_raiser(ret)
+
+    signs = evt.ffi.buffer(signs_c)
+    size = evt.lib.EVT_SIGNATURE_SIZE
+    return [Signature.from_bytes(signs[i * size:(i + 1) * size]) for i in range(len(hashes))]
+
+
+def recover_hashes(signs, hashes, threads=0):
+    evt = libevt.check_lib_init()
+    assert len(signs) == len(hashes)
+    signs_c = b''.join(s.to_bytes() for s in signs)
+    hashes_c = b''.join(h.to_bytes() for h in hashes)
+    pub_keys_c = evt.ffi.new('char[]', len(hashes) * evt.lib.EVT_PUBLIC_KEY_SIZE)
+    ret = evt.lib.evt_recover_hashes(
+        signs_c, hashes_c, len(hashes), pub_keys_c, threads)
+    evt_exception.evt_exception_raiser(ret)
+
+    pub_keys = evt.ffi.buffer(pub_keys_c)
+    size = evt.lib.EVT_PUBLIC_KEY_SIZE
+    return [PublicKey.from_bytes(pub_keys[i * size:(i + 1) * size]) for i in range(len(hashes))]
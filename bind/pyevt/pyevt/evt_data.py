@@ -4,14 +4,34 @@ from . import evt_exception, libevt
 
 
 class EvtData:
-    def __init__(self, data):
+    def __init__(self, data, owned_by_python=False):
         self.data = data
+        self.owned_by_python = owned_by_python
         self.evt = libevt.check_lib_init()
 
     def __del__(self):
+        if self.owned_by_python:
+            return
         ret = self.evt.lib.evt_free(self.data)
         evt_exception.evt_exception_raiser(ret)
 
+    def to_bytes(self):
+        return bytes(self.evt.ffi.buffer(self.data.buf, self.data.sz))
+
+    @classmethod
+    def from_bytes(cls, buf):
+        # data of outputs of batch functions, allocated by cffi instead of libevt
+        evt = libevt.check_lib_init()
+        data = evt.ffi.new('char[]', evt.ffi.sizeof('evt_data_t') + len(buf))
+        data_c = evt.ffi.cast('evt_data_t*', data)
+        data_c.sz = len(buf)
+        evt.ffi.memmove(data_c.buf, buf, len(buf))
+
+        obj = cls.__new__(cls)
+        EvtData.__init__(obj, data_c, owned_by_python=True)
+        obj.memory = data  # keeps it alive
+        return obj
+
     def to_hex_string(self):
         hstr = StringIO()
         for i in range(self.data.sz):
@@ -16,6 +16,7 @@ class EVTErrCode:
     EVT_SIZE_NOT_EQUALS = -11
     EVT_DATA_NOT_EQUALS = -12
     EVT_INVALID_LINK = -13
+    EVT_BUFFER_TOO_SMALL = -14
     EVT_NOT_INIT = -15
 
 
@@ -109,6 +110,12 @@ class EVTInvalidLinkException(Exception):
         super().__init__(self, err)
 
 
+class EVTBufferTooSmallException(Exception):
+    def __init__(self):
+        err = 'EVT_BUFFER_TOO_SMALL'
+        super().__init__(self, err)
+
+
 class EVTNotInitException(Exception):
     def __init__(self):
         err = 'EVT_NOT_INIT'
@@ -129,6 +136,7 @@ ex_map = {
     EVTErrCode.EVT_INVALID_LINK: EVTInvalidLinkException,
     EVTErrCode.EVT_SIZE_NOT_EQUALS: EVTSizeNotEqualsException,
     EVTErrCode.EVT_DATA_NOT_EQUALS: EVTDataNotEqualsException,
+    EVTErrCode.EVT_BUFFER_TOO_SMALL: EVTBufferTooSmallException,
     EVTErrCode.EVT_NOT_INIT: EVTNotInitException
 }
 
@@ -42,6 +42,11 @@ def init_evt_lib():
             #define EVT_SIZE_NOT_EQUALS         -11
             #define EVT_DATA_NOT_EQUALS         -12
             #define EVT_INVALID_LINK            -13
+            #define EVT_BUFFER_TOO_SMALL        -14
+
+            #define EVT_CHECKSUM_SIZE   32
+            #define EVT_SIGNATURE_SIZE  66
+            #define EVT_PUBLIC_KEY_SIZE 34
 
             int evt_free(void*);
             int evt_equals(evt_data_t* rhs, evt_data_t* lhs);
@@ -65,6 +70,8 @@ def init_evt_lib():
             int evt_abi_json_to_bin(void* evt_abi, const char* action, const char* json, evt_bin_t** bin /* out */);
             int evt_abi_bin_to_json(void* evt_abi, const char* action, evt_bin_t* bin, char** json /* out */);
             int evt_trx_json_to_digest(void* evt_abi, const char* json, evt_chain_id_t* chain_id, evt_checksum_t** digest /* out */);
+            int evt_abi_json_to_bin_batch(void* evt_abi, const char* action, const char** jsons, size_t count, char* bins /* out */, size_t capacity, size_t* sizes /* out */, uint32_t threads);
+            int evt_trx_json_to_digests(void* evt_abi, const char** jsons, size_t count, evt_chain_id_t* chain_id, char* digests /* out */, uint32_t threads);
             int evt_chain_id_from_string(const char* str, evt_chain_id_t** chain_id /* out */);
 
 
@@ -73,6 +80,8 @@ def init_evt_lib():
             int evt_sign_hash(evt_private_key_t* priv_key, evt_checksum_t* hash, evt_signature_t** sign /* out */);
             int evt_recover(evt_signature_t* sign, evt_checksum_t* hash, evt_public_key_t** pub_key /* out */);
             int evt_hash(const char* buf, size_t sz, evt_checksum_t** hash /* out */);
+            int evt_sign_hashes(evt_private_key_t* priv_key, const char* hashes, size_t count, char* signs /* out */, uint32_t threads);
+            int evt_recover_hashes(const char* signs, const char* hashes, size_t count, char* pub_keys /* out */, uint32_t threads);
 
             int evt_public_key_string(evt_public_key_t* pub_key, char** str /* out */);
             int evt_private_key_string(evt_private_key_t* priv_key, char** str /* out */);
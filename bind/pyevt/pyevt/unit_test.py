@@ -38,6 +38,21 @@ class TestPyEVT(unittest.TestCase):
         pub_key_string3 = pub_key3.to_string()
         self.assertTrue(pub_key_string3 == pub_key_string)
 
+    def test_evtbatch(self):
+        pub_key, priv_key = generate_new_pair()
+        hashes = [Checksum.from_string(str(i)) for i in range(100)]
+        signs = sign_hashes(priv_key, hashes, 4)
+        self.assertEqual(len(signs), 100)
+
+        pub_keys = recover_hashes(signs, hashes)
+        for key in pub_keys:
+            self.assertEqual(key.to_string(), pub_key.to_string())
+
+        j = '{"name":"test1530718665","signatures":["SIG_K1_KXjtmeihJi1qnSs7vmqJDRJoZ1nSEPeeRjsKJRpm24g8yhFtAepkRDR4nVFbXjvoaQvT4QrzuNWCbuEhceYpGmAvsG47Fj"]}'
+        bins = json_to_bin_batch('aprvsuspend', [j, j, j])
+        self.assertEqual(len(bins), 3)
+        self.assertEqual(bins[2].to_hex_string(), json_to_bin('aprvsuspend', j).to_hex_string())
+
     def test_evtabi(self):
         j = r'''
         {
@@ -5,11 +5,13 @@
 #include <evt/chain/apply_context.hpp>
 
 #include <algorithm>
+#include <evt/chain/action_profiler.hpp>
 #include <evt/chain/controller.hpp>
 #include <evt/chain/execution_context_impl.hpp>
 #include <evt/chain/transaction_context.hpp>
 #include <evt/chain/global_property_object.hpp>
 #include <evt/chain/contracts/evt_contract.hpp>
+#include <evt/utilities/trace.hpp>
 
 namespace evt { namespace chain {
 
@@ -38,11 +40,25 @@ apply_context::exec_one(action_trace& trace) {
     r.act_digest      = digest_type::hash(act);
     r.global_sequence = next_global_sequence();
 
-    trace.trx_id            = trx_context.trx_meta->id;
-    trace.block_num         = control.pending_block_state()->block_num;
-    trace.block_time        = control.pending_block_time();
-    trace.producer_block_id = control.pending_producer_block_id();
-    trace.act               = act;
+    if(!trx_context.lite_trace) {
+        trace.trx_id            = trx_context.trx_meta->id;
+        trace.block_num         = control.pending_block_state()->block_num;
+        trace.block_time        = control.pending_block_time();
+        trace.producer_block_id = control.pending_producer_block_id();
+        trace.act               = act;
+    }
+
+    auto& profiler = control.get_action_profiler();
+    auto  counters = db_op_counters();
+    auto  scope    = optional<db_op_counters::scope>();
+    if(profiler.enabled()) {
+        scope.emplace(counters);
+    }
+    auto record = [&](bool failed) {
+        if(profiler.enabled() && act.index_ >= 0) {
+            profiler.record_exec(act.index_, act.name, exec_ctx.get_current_version(act.name), trace.elapsed.count(), counters, failed);
+        }
+    };
 
     try {
         try {
@@ -60,6 +76,7 @@ apply_context::exec_one(action_trace& trace) {
         trace.receipt = r; // fill with known data
         trace.except  = e;
         finalize_trace(trace, start);
+        record(true);
         throw;
     }
 
@@ -68,6 +85,7 @@ next:
     trx_context.executed.emplace_back(move(r));
 
     finalize_trace(trace, start);
+    record(false);
 
     if(control.contracts_console()) {
         print_debug(trace);
@@ -78,15 +96,19 @@ void
 apply_context::finalize_trace(action_trace& trace, const std::chrono::steady_clock::time_point& start) {
     using namespace std::chrono;
 
-    trace.console = fmt::to_string(_pending_console_output);
+    if(!trx_context.lite_trace) {
+        trace.console = fmt::to_string(_pending_console_output);
+    }
     trace.elapsed = fc::microseconds(duration_cast<microseconds>(steady_clock::now() - start).count());
     
     trace.generated_actions = std::move(_generated_actions);
     trace.new_ft_holders    = std::move(_new_ft_holders);
+    trace.ft_balances       = std::move(_ft_balances);
 }
 
 void
 apply_context::exec(action_trace& trace) {
+    EVT_TRACE_SPAN("apply_context::exec", act.name.value);
     exec_one(trace);
 }
 
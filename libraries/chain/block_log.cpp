@@ -4,8 +4,26 @@
  */
 #include <evt/chain/block_log.hpp>
 #include <evt/chain/exceptions.hpp>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
+#include <deque>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <boost/noncopyable.hpp>
 #include <fc/io/raw.hpp>
+#include <fmt/format.h>
+#include <evt/utilities/thread_affinity.hpp>
+#include <zstd.h>
 
 #define LOG_READ  (std::ios::in | std::ios::binary)
 #define LOG_WRITE (std::ios::out | std::ios::binary | std::ios::app)
@@ -23,7 +41,444 @@ const uint32_t block_log::min_supported_version = 1;
  */
 const uint32_t block_log::max_supported_version = 2;
 
+
 namespace detail {
+
+// read-only shared mapping of file, capacity can be larger than the file
+// so that it's not remapped on every append, pages beyond the end of file are never touched
+class mapped_file : boost::noncopyable {
+public:
+    mapped_file(const fc::path& path, size_t capacity)
+        : capacity(capacity) {
+        auto fd = ::open(path.generic_string().c_str(), O_RDONLY);
+        EVT_ASSERT(fd >= 0, block_log_exception, "Cannot open ${f} to map", ("f",path.generic_string()));
+
+        auto addr = ::mmap(nullptr, capacity, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        EVT_ASSERT(addr != MAP_FAILED, block_log_exception, "Cannot map ${f}, errno: ${e}", ("f",path.generic_string())("e",errno));
+        data = (const char*)addr;
+    }
+
+    ~mapped_file() {
+        ::munmap((void*)data, capacity);
+    }
+
+public:
+    const char* data;
+    size_t      capacity;
+};
+
+using mapped_file_ptr = std::shared_ptr<const mapped_file>;
+
+// blocks of one log file and its index, current one keeps growing and retained ones are fixed
+// compressed ones have one zstd frame per block, and the index has one more entry for the end of last frame
+struct log_segment {
+    uint32_t        first_num  = 0;
+    uint32_t        last_num   = 0;  // only for retained ones, head of current one is published by `head_num`
+    uint64_t        block_size = 0;  // same as above
+    bool            compressed = false;
+    fc::path        block_file;
+    fc::path        index_file;
+    mapped_file_ptr block_map;
+    mapped_file_ptr index_map;
+};
+
+using segment_ptr = std::shared_ptr<const log_segment>;
+using catalog_ptr = std::shared_ptr<const std::vector<segment_ptr>>;  // retained segments ordered by block num
+
+uint64_t
+read_index(const log_segment& seg, uint32_t block_num) {
+    uint64_t pos;
+    memcpy(&pos, seg.index_map->data + sizeof(uint64_t) * (block_num - seg.first_num), sizeof(pos));
+    return pos;
+}
+
+std::pair<signed_block_ptr, uint64_t>
+unpack_block(const log_segment& seg, uint64_t size, uint64_t pos) {
+    EVT_ASSERT(pos < size, block_log_exception, "Position ${p} is out of block log, size: ${s}", ("p",pos)("s",size));
+
+    auto ds = fc::datastream<const char*>(seg.block_map->data + pos, size - pos);
+    auto b  = std::make_shared<signed_block>();
+    fc::raw::unpack(ds, *b);
+    return std::make_pair(b, pos + ds.tellp() + sizeof(uint64_t));
+}
+
+// unpacks the header and only the receipt at `index` of the block, receipts before it are skipped
+// without unpacking their transactions, which is the most expensive part of unpacking a block
+std::optional<block_log::transaction_location>
+unpack_receipt(const char* data, uint64_t size, uint32_t index) {
+    auto ds  = fc::datastream<const char*>(data, size);
+    auto loc = block_log::transaction_location();
+    fc::raw::unpack(ds, loc.header);
+
+    auto n = fc::unsigned_int();
+    fc::raw::unpack(ds, n);
+    if(index >= n.value) {
+        return std::nullopt;
+    }
+
+    for(auto i = 0u; i < index; i++) {
+        auto header = transaction_receipt_header();
+        auto sigs   = signatures_type();
+        auto comp   = uint8_t();
+        auto len    = fc::unsigned_int();
+        fc::raw::unpack(ds, header);
+        fc::raw::unpack(ds, sigs);
+        fc::raw::unpack(ds, comp);
+        fc::raw::unpack(ds, len);
+        ds.skip(len.value);
+    }
+    fc::raw::unpack(ds, loc.receipt);
+    return loc;
+}
+
+signed_block_ptr
+unpack_compressed_block(const log_segment& seg, uint32_t block_num) {
+    auto begin = read_index(seg, block_num);
+    auto end   = read_index(seg, block_num + 1);
+    EVT_ASSERT(begin < end && end <= seg.block_size, block_log_exception, "Invalid frame of block ${n} in ${f}",
+        ("n",block_num)("f",seg.block_file.generic_string()));
+
+    auto src  = seg.block_map->data + begin;
+    auto size = ZSTD_getFrameContentSize(src, end - begin);
+    EVT_ASSERT(size != ZSTD_CONTENTSIZE_ERROR && size != ZSTD_CONTENTSIZE_UNKNOWN, block_log_exception,
+        "Invalid frame of block ${n} in ${f}", ("n",block_num)("f",seg.block_file.generic_string()));
+
+    auto buf = std::vector<char>(size);
+    auto sz  = ZSTD_decompress(buf.data(), buf.size(), src, end - begin);
+    EVT_ASSERT(!ZSTD_isError(sz) && sz == size, block_log_exception, "Decompress block ${n} in ${f} failed",
+        ("n",block_num)("f",seg.block_file.generic_string()));
+
+    auto ds = fc::datastream<const char*>(buf.data(), buf.size());
+    auto b  = std::make_shared<signed_block>();
+    fc::raw::unpack(ds, *b);
+    return b;
+}
+
+// stream is left at the first block
+void
+read_log_header(std::istream& stream, uint32_t& first_block_num, genesis_state& gs) {
+    uint32_t version = 0;
+    stream.read((char*)&version, sizeof(version));
+    EVT_ASSERT(version > 0, block_log_exception, "Block log was not setup properly");
+    EVT_ASSERT(version >= block_log::min_supported_version && version <= block_log::max_supported_version, block_log_unsupported_version,
+               "Unsupported version of block log. Block log version is ${version} while code supports version(s) [${min},${max}]",
+               ("version", version)("min", block_log::min_supported_version)("max", block_log::max_supported_version));
+
+    first_block_num = 1;
+    if(version > 1) {
+        stream.read((char*)&first_block_num, sizeof(first_block_num));
+    }
+    fc::raw::unpack(stream, gs);
+
+    // skip the totem
+    if(version > 1) {
+        uint64_t totem;
+        stream.read((char*)&totem, sizeof(totem));
+    }
+}
+
+genesis_state
+read_genesis(const fc::path& block_file) {
+    std::ifstream block_stream;
+    block_stream.exceptions(std::fstream::failbit | std::fstream::badbit);
+    block_stream.open(block_file.generic_string().c_str(), LOG_READ);
+
+    auto first = 0u;
+    auto gs    = genesis_state();
+    read_log_header(block_stream, first, gs);
+    return gs;
+}
+
+// positions of blocks are found by following the trailing position of each block back from `end`
+// returns false if they're broken, blocks are not unpacked here
+bool
+walk_positions(const char* data, uint64_t header_end, uint64_t end, std::vector<uint64_t>& positions) {
+    positions.clear();
+    auto next = end;  // end of the block after the one being walked
+    while(next > header_end) {
+        if(next < header_end + sizeof(uint64_t)) {
+            return false;
+        }
+        uint64_t pos;
+        memcpy(&pos, data + next - sizeof(pos), sizeof(pos));
+        if(pos < header_end || pos >= next - sizeof(pos)) {
+            return false;
+        }
+        positions.emplace_back(pos);
+        next = pos;
+    }
+    std::reverse(positions.begin(), positions.end());
+    return true;
+}
+
+// blocks are unpacked in chunks by `threads` workers, returns the number of leading blocks which are valid
+// a valid one is unpacked exactly up to its trailing position, and its number follows the previous one
+size_t
+verify_blocks(const char* data, const std::vector<uint64_t>& positions, uint64_t end, uint32_t first_num, uint32_t threads, std::string& error) {
+    struct chunk {
+        size_t        begin, end;
+        size_t        bad = 0;  // index of first invalid block, `end` if there's none
+        std::string   error;
+        block_id_type first_prev, last_id;
+    };
+
+    auto n      = positions.size();
+    auto size   = (n + threads - 1) / threads;
+    auto chunks = std::vector<chunk>();
+    for(auto i = size_t(0); i < n; i += size) {
+        chunks.emplace_back(chunk { .begin = i, .end = std::min(i + size, n) });
+    }
+
+    auto tasks = std::vector<std::future<void>>();
+    for(auto& c : chunks) {
+        tasks.emplace_back(std::async(std::launch::async, [&c, &positions, data, n, end, first_num] {
+            for(c.bad = c.begin; c.bad < c.end; c.bad++) {
+                auto i     = c.bad;
+                auto begin = positions[i];
+                auto limit = (i + 1 < n ? positions[i + 1] : end) - sizeof(uint64_t);
+
+                auto b = signed_block();
+                try {
+                    auto ds = fc::datastream<const char*>(data + begin, limit - begin);
+                    fc::raw::unpack(ds, b);
+                    EVT_ASSERT(ds.tellp() == limit - begin, block_log_exception, "Block doesn't end at its trailing position");
+                    EVT_ASSERT(b.block_num() == first_num + i, block_log_exception, "Block number is ${n}, but ${e} is expected",
+                        ("n",b.block_num())("e",first_num + i));
+                }
+                catch(const fc::exception& e) {
+                    c.error = e.to_string();
+                    break;
+                }
+                catch(const std::exception& e) {
+                    c.error = e.what();
+                    break;
+                }
+
+                auto id = b.id();
+                if(i == c.begin) {
+                    c.first_prev = b.previous;
+                }
+                else if(b.previous != c.last_id) {
+                    elog("Block ${num} (${id}) does not link back to previous block. Expected previous: ${expected}. Actual previous: ${actual}.",
+                         ("num", b.block_num())("id", id)("expected", c.last_id)("actual", b.previous));
+                }
+                c.last_id = id;
+            }
+        }));
+    }
+    for(auto& t : tasks) {
+        t.get();
+    }
+
+    for(auto i = 0u; i < chunks.size(); i++) {
+        auto& c = chunks[i];
+        if(i > 0 && c.bad > c.begin && c.first_prev != chunks[i - 1].last_id) {
+            elog("Block ${num} does not link back to previous block. Expected previous: ${expected}. Actual previous: ${actual}.",
+                 ("num", first_num + c.begin)("expected", chunks[i - 1].last_id)("actual", c.first_prev));
+        }
+        if(c.bad < c.end) {
+            error = c.error;
+            return c.bad;
+        }
+    }
+    return n;
+}
+
+void
+build_index_parallel(const fc::path& block_file, const fc::path& index_file, uint32_t threads) {
+    std::ifstream block_stream;
+    block_stream.exceptions(std::fstream::failbit | std::fstream::badbit);
+    block_stream.open(block_file.generic_string().c_str(), LOG_READ);
+
+    auto first = 0u;
+    auto gs    = genesis_state();
+    read_log_header(block_stream, first, gs);
+    auto header_end = (uint64_t)block_stream.tellg();
+    block_stream.close();
+
+    auto size = (uint64_t)fc::file_size(block_file);
+    auto map  = mapped_file(block_file, size);
+
+    auto positions = std::vector<uint64_t>();
+    EVT_ASSERT(walk_positions(map.data, header_end, size, positions), block_log_exception,
+        "Positions of blocks in ${f} are broken", ("f",block_file.generic_string()));
+
+    auto error = std::string();
+    auto good  = verify_blocks(map.data, positions, size, first, threads, error);
+    EVT_ASSERT(good == positions.size(), block_log_exception, "Block ${n} in ${f} is invalid: ${e}",
+        ("n",first + good)("f",block_file.generic_string())("e",error));
+
+    std::ofstream index_stream;
+    index_stream.exceptions(std::fstream::failbit | std::fstream::badbit);
+    index_stream.open(index_file.generic_string().c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    index_stream.write((char*)positions.data(), positions.size() * sizeof(uint64_t));
+    ilog("Block log index reconstructed for ${n} blocks with ${t} threads", ("n",positions.size())("t",threads));
+}
+
+// valid leading blocks after `header_end` are copied as they are
+// returns false if positions of blocks are broken, nothing is written then
+bool
+repair_parallel(const fc::path& old_file, std::fstream& new_block_stream, uint64_t header_end, uint64_t end,
+                uint32_t first_num, uint32_t truncate_at_block, uint32_t threads) {
+    auto map       = mapped_file(old_file, end);
+    auto positions = std::vector<uint64_t>();
+    if(!walk_positions(map.data, header_end, end, positions)) {
+        return false;
+    }
+
+    auto error = std::string();
+    auto good  = verify_blocks(map.data, positions, end, first_num, threads, error);
+    auto total = good;
+    if(truncate_at_block >= first_num && truncate_at_block - first_num + 1 < good) {
+        good = truncate_at_block - first_num + 1;
+    }
+
+    auto good_end = good < positions.size() ? positions[good] : end;
+    new_block_stream.write(map.data + header_end, good_end - header_end);
+
+    auto block_num = good > 0 ? first_num + good - 1 : 0;
+    if(total < positions.size() && good == total) {
+        ilog("Recovered only up to block number ${num}. The block ${next_num} is invalid:\n${error_msg}",
+             ("num", block_num)("next_num", block_num + 1)("error_msg", error));
+    }
+    else if(good < total) {
+        ilog("Stopped recovery of block log early at specified block number: ${stop}.", ("stop", truncate_at_block));
+    }
+    else {
+        ilog("Existing block log was undamaged. Recovered all irreversible blocks up to block number ${num}.", ("num", block_num));
+    }
+    return true;
+}
+
+void
+build_index(const fc::path& block_file, const fc::path& index_file, uint32_t threads = 1) {
+    if(threads > 1) {
+        build_index_parallel(block_file, index_file, threads);
+        return;
+    }
+
+    std::ifstream block_stream;
+    std::ofstream index_stream;
+    block_stream.exceptions(std::fstream::failbit | std::fstream::badbit);
+    index_stream.exceptions(std::fstream::failbit | std::fstream::badbit);
+    block_stream.open(block_file.generic_string().c_str(), LOG_READ);
+    index_stream.open(index_file.generic_string().c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+
+    uint64_t end_pos;
+
+    block_stream.seekg(-sizeof(uint64_t), std::ios::end);
+    block_stream.read((char*)&end_pos, sizeof(end_pos));
+
+    if(end_pos == block_log::npos) {
+        ilog("Block log ${f} contains no blocks. No need to construct index.", ("f",block_file.generic_string()));
+        return;
+    }
+
+    block_stream.seekg(0);
+
+    auto first = 0u;
+    auto gs    = genesis_state();
+    read_log_header(block_stream, first, gs);
+
+    auto pos = uint64_t(0);
+    while(pos < end_pos) {
+        signed_block tmp;
+        fc::raw::unpack(block_stream, tmp);
+
+        block_stream.read((char*)&pos, sizeof(pos));
+        if(tmp.block_num() % 1000 == 0) {
+            ilog2_("Block log index reconstructed for block {:n}", tmp.block_num());
+        }
+        index_stream.write((char*)&pos, sizeof(pos));
+    }
+}
+
+void
+sync_file(const fc::path& path) {
+    auto fd = ::open(path.generic_string().c_str(), O_RDONLY);
+    EVT_ASSERT(fd >= 0, block_log_exception, "Cannot open ${f} to sync", ("f",path.generic_string()));
+
+    auto r = ::fdatasync(fd);
+    ::close(fd);
+    EVT_ASSERT(r == 0, block_log_exception, "Cannot sync ${f}, errno: ${e}", ("f",path.generic_string())("e",errno));
+}
+
+// falls back to copying when they're on different devices
+void
+move_file(const fc::path& from, const fc::path& to) {
+    try {
+        fc::rename(from, to);
+    }
+    catch(...) {
+        fc::copy(from, to);
+        fc::remove(from);
+    }
+}
+
+// header is kept as it is, and each block is compressed into its own frame so that it can be decompressed alone
+// returns false if it's stopped before done
+bool
+compress_segment(const log_segment& seg, const fc::path& block_file, const fc::path& index_file, const std::atomic_bool& stopping) {
+    std::ofstream block_stream;
+    std::ofstream index_stream;
+    block_stream.exceptions(std::fstream::failbit | std::fstream::badbit);
+    index_stream.exceptions(std::fstream::failbit | std::fstream::badbit);
+    block_stream.open(block_file.generic_string().c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    index_stream.open(index_file.generic_string().c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+
+    auto pos = read_index(seg, seg.first_num);
+    block_stream.write(seg.block_map->data, pos);
+
+    auto cctx = std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)>(ZSTD_createCCtx(), &ZSTD_freeCCtx);
+    auto buf  = std::vector<char>();
+    for(auto num = seg.first_num; num <= seg.last_num; num++) {
+        if(stopping.load(std::memory_order_relaxed)) {
+            return false;
+        }
+
+        // position of block follows it and is not kept, it's the same as the index entry
+        auto begin = read_index(seg, num);
+        auto end   = (num < seg.last_num ? read_index(seg, num + 1) : seg.block_size) - sizeof(uint64_t);
+
+        buf.resize(ZSTD_compressBound(end - begin));
+        auto sz = ZSTD_compressCCtx(cctx.get(), buf.data(), buf.size(), seg.block_map->data + begin, end - begin, 3);
+        EVT_ASSERT(!ZSTD_isError(sz), block_log_exception, "Compress block ${n} failed: ${e}", ("n",num)("e",ZSTD_getErrorName(sz)));
+
+        block_stream.write(buf.data(), sz);
+        index_stream.write((char*)&pos, sizeof(pos));
+        pos += sz;
+    }
+    index_stream.write((char*)&pos, sizeof(pos));
+    return true;
+}
+
+void
+build_compressed_index(const fc::path& block_file, const fc::path& index_file) {
+    std::ifstream block_stream;
+    std::ofstream index_stream;
+    block_stream.exceptions(std::fstream::failbit | std::fstream::badbit);
+    index_stream.exceptions(std::fstream::failbit | std::fstream::badbit);
+    block_stream.open(block_file.generic_string().c_str(), LOG_READ);
+    index_stream.open(index_file.generic_string().c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+
+    auto first = 0u;
+    auto gs    = genesis_state();
+    read_log_header(block_stream, first, gs);
+
+    auto pos  = (uint64_t)block_stream.tellg();
+    auto size = (uint64_t)fc::file_size(block_file);
+    auto map  = mapped_file(block_file, size);
+    while(pos < size) {
+        auto sz = ZSTD_findFrameCompressedSize(map.data + pos, size - pos);
+        EVT_ASSERT(!ZSTD_isError(sz), block_log_exception, "Invalid frame at ${p} in ${f}", ("p",pos)("f",block_file.generic_string()));
+
+        index_stream.write((char*)&pos, sizeof(pos));
+        pos += sz;
+    }
+    index_stream.write((char*)&pos, sizeof(pos));
+}
+
 class block_log_impl {
 public:
     signed_block_ptr head;
@@ -38,6 +493,40 @@ public:
     uint32_t         version                      = 0;
     uint32_t         first_block_num              = 0;
 
+    block_log_config conf;  // directories are resolved when log is opened
+
+    // readers only use the mappings and never touch the streams, so they can be in any thread
+    // current segment is stored before sizes are published, and replaced ones are kept alive till their readers are done
+    segment_ptr           current;
+    catalog_ptr           catalog    = std::make_shared<std::vector<segment_ptr>>();
+    std::atomic<uint64_t> block_size = 0;  // bytes of current block file visible to readers
+    std::atomic<uint32_t> head_num   = 0;  // 0 if there's no blocks in current file
+
+    static constexpr size_t kMinMapSize = 64 * 1024 * 1024;
+
+    // retained files are compressed in background thread when it's enabled
+    // catalog is replaced by both threads, so it's only stored with `catalog_mutex` held
+    std::mutex              catalog_mutex;
+    std::thread             compressor;
+    std::deque<segment_ptr> compress_queue;
+    std::mutex              compress_mutex;
+    std::condition_variable compress_cv;
+    std::atomic_bool        stopping = false;
+
+    // blocks of async append that are not published yet, front ones are being written by writer thread
+    // they're only popped after published, so readers find them either here or in files
+    std::deque<signed_block_ptr> pending;
+    std::mutex                   pending_mutex;
+    std::condition_variable      pending_cv;  // notified when blocks are pushed or popped
+    std::thread                  writer;
+    bool                         writer_stopping = false;
+    std::exception_ptr           writer_error;
+
+    uint32_t                      written_num = 0;  // last block written into files, only used by the writing thread
+    uint32_t                      unsynced    = 0;  // blocks written since last fsync
+    std::atomic<uint32_t>         durable_num = 0;
+    std::function<void(uint32_t)> on_durable;
+
     inline void
     check_open_files() {
         if(!open_files) {
@@ -46,8 +535,61 @@ public:
     }
     void reopen();
 
+    // makes appended data visible to readers, files are remapped if they exceed the capacity of mappings
     void
-    close() {
+    publish(uint32_t num) {
+        auto bsize = (size_t)fc::file_size(block_file);
+        auto isize = (size_t)fc::file_size(index_file);
+        auto cur   = std::atomic_load(&current);
+        if(!cur || bsize > cur->block_map->capacity || isize > cur->index_map->capacity) {
+            auto seg = std::make_shared<log_segment>();
+            seg->first_num  = first_block_num;
+            seg->block_file = block_file;
+            seg->index_file = index_file;
+            seg->block_map  = std::make_shared<mapped_file>(block_file, std::max(bsize * 2, kMinMapSize));
+            seg->index_map  = std::make_shared<mapped_file>(index_file, std::max(isize * 2, kMinMapSize));
+            std::atomic_store(&current, segment_ptr(std::move(seg)));
+        }
+        block_size.store(bsize, std::memory_order_release);
+        head_num.store(num, std::memory_order_release);
+    }
+
+    void
+    unpublish() {
+        head_num.store(0, std::memory_order_release);
+        block_size.store(0, std::memory_order_release);
+        std::atomic_store(&current, segment_ptr());
+    }
+
+    void load_catalog();
+    void split(uint32_t last);
+    void prune(std::vector<segment_ptr>& segs);
+    void write_header(const genesis_state& gs, uint32_t first_num);
+
+    void compress_async(const segment_ptr& seg);
+    void compress(const segment_ptr& seg);
+    void stop_compressor();
+
+    uint64_t write_block(const signed_block& b);
+    void     commit(uint32_t num, uint32_t n);
+    void     start_writer();
+    void     stop_writer();
+    void     wait_pending();
+
+    signed_block_ptr
+    find_pending(uint32_t num) {
+        if(!conf.async_append) {
+            return nullptr;
+        }
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        if(pending.empty() || num < pending.front()->block_num() || num - pending.front()->block_num() >= pending.size()) {
+            return nullptr;
+        }
+        return pending[num - pending.front()->block_num()];
+    }
+
+    void
+    close_streams() {
         if(block_stream.is_open()) {
             block_stream.close();
         }
@@ -56,8 +598,13 @@ public:
         }
         open_files = false;
     }
-};
 
+    void
+    close() {
+        unpublish();
+        close_streams();
+    }
+};
 
 void
 block_log_impl::reopen() {
@@ -76,12 +623,411 @@ block_log_impl::reopen() {
     open_files = true;
 }
 
+void
+block_log_impl::load_catalog() {
+    auto segs = std::vector<std::shared_ptr<log_segment>>();
+    if(fc::is_directory(conf.retained_dir)) {
+        auto paths = std::vector<fc::path>();
+        for(auto it = fc::directory_iterator(conf.retained_dir); it != fc::directory_iterator(); it++) {
+            paths.emplace_back(*it);
+        }
+        for(auto& path : paths) {
+            auto name  = path.filename().generic_string();
+            auto ext   = path.extension().generic_string();
+            auto first = 0u, last = 0u;
+            if(ext == ".tmp") {
+                // left by compression which is not done
+                fc::remove(path);
+                continue;
+            }
+            if((ext != ".log" && ext != ".zlog") || sscanf(name.c_str(), "blocks-%u-%u.", &first, &last) != 2) {
+                continue;
+            }
+
+            auto base = fmt::format("blocks-{}-{}", first, last);
+            if(ext == ".log" && fc::exists(conf.retained_dir / (base + ".zlog"))) {
+                // compressed file only appears when it's complete, so raw one is stale
+                fc::remove(path);
+                fc::remove_all(conf.retained_dir / (base + ".index"));
+                continue;
+            }
+
+            auto seg = std::make_shared<log_segment>();
+            seg->first_num  = first;
+            seg->last_num   = last;
+            seg->compressed = (ext == ".zlog");
+            seg->block_file = path;
+            seg->index_file = conf.retained_dir / (base + (seg->compressed ? ".zindex" : ".index"));
+            segs.emplace_back(std::move(seg));
+        }
+    }
+    std::sort(segs.begin(), segs.end(), [](auto& l, auto& r) { return l->first_num < r->first_num; });
+
+    // every file has its own index, the missing or incomplete ones are rebuilt in parallel
+    auto missing = std::vector<std::shared_ptr<log_segment>>();
+    for(auto& seg : segs) {
+        auto entries = seg->last_num - seg->first_num + 1 + (seg->compressed ? 1 : 0);
+        if(!fc::exists(seg->index_file) || fc::file_size(seg->index_file) != sizeof(uint64_t) * entries) {
+            missing.emplace_back(seg);
+        }
+    }
+    if(!missing.empty()) {
+        ilog("Reconstructing indexes of ${n} retained block log files", ("n",missing.size()));
+
+        auto n     = std::min((size_t)std::max(std::thread::hardware_concurrency(), 1u), missing.size());
+        auto tasks = std::vector<std::future<void>>();
+        for(auto i = 0u; i < n; i++) {
+            tasks.emplace_back(std::async(std::launch::async, [i, n, &missing] {
+                for(auto j = i; j < missing.size(); j += n) {
+                    auto& seg = *missing[j];
+                    if(seg.compressed) {
+                        build_compressed_index(seg.block_file, seg.index_file);
+                    }
+                    else {
+                        build_index(seg.block_file, seg.index_file);
+                    }
+                }
+            }));
+        }
+        for(auto& t : tasks) {
+            t.get();
+        }
+    }
+
+    auto cat = std::make_shared<std::vector<segment_ptr>>();
+    for(auto& seg : segs) {
+        EVT_ASSERT(cat->empty() || cat->back()->last_num + 1 == seg->first_num, block_log_exception,
+            "Retained block log files are not continuous, block ${n} is expected to be first one of ${f}",
+            ("n",cat->back()->last_num + 1)("f",seg->block_file.generic_string()));
+
+        seg->block_size = fc::file_size(seg->block_file);
+        seg->block_map  = std::make_shared<mapped_file>(seg->block_file, seg->block_size);
+        seg->index_map  = std::make_shared<mapped_file>(seg->index_file, fc::file_size(seg->index_file));
+        cat->emplace_back(std::move(seg));
+    }
+    std::atomic_store(&catalog, catalog_ptr(cat));
+
+    // the ones split before it's enabled, or not done before stopped
+    if(conf.compress_retained) {
+        for(auto& seg : *cat) {
+            if(!seg->compressed) {
+                compress_async(seg);
+            }
+        }
+    }
+}
+
+// current file is moved into retained directory, and a new one starting from next block takes its place
+void
+block_log_impl::split(uint32_t last) {
+    auto name = fmt::format("blocks-{}-{}", first_block_num, last);
+    ilog("Splitting block log, blocks from ${f} to ${l} are moved into ${n}", ("f",first_block_num)("l",last)("n",name));
+
+    block_stream.flush();
+    index_stream.flush();
+    close_streams();
+    if(conf.sync_interval > 0) {
+        sync_file(block_file);
+        sync_file(index_file);
+    }
+
+    auto seg = std::make_shared<log_segment>();
+    seg->first_num  = first_block_num;
+    seg->last_num   = last;
+    seg->block_file = conf.retained_dir / (name + ".log");
+    seg->index_file = conf.retained_dir / (name + ".index");
+
+    fc::create_directories(conf.retained_dir);
+    fc::rename(index_file, seg->index_file);
+    fc::rename(block_file, seg->block_file);
+
+    seg->block_size = fc::file_size(seg->block_file);
+    seg->block_map  = std::make_shared<mapped_file>(seg->block_file, seg->block_size);
+    seg->index_map  = std::make_shared<mapped_file>(seg->index_file, fc::file_size(seg->index_file));
+
+    {
+        std::lock_guard<std::mutex> lock(catalog_mutex);
+
+        auto segs = *std::atomic_load(&catalog);
+        segs.emplace_back(seg);
+        prune(segs);
+
+        // readers see the blocks in retained ones before they're gone from current
+        std::atomic_store(&catalog, catalog_ptr(std::make_shared<std::vector<segment_ptr>>(std::move(segs))));
+    }
+    unpublish();
+
+    write_header(read_genesis(seg->block_file), last + 1);
+
+    if(conf.compress_retained) {
+        compress_async(seg);
+    }
+}
+
+void
+block_log_impl::prune(std::vector<segment_ptr>& segs) {
+    if(conf.max_retained == 0) {
+        return;
+    }
+    while(segs.size() > conf.max_retained) {
+        auto& seg = *segs.front();
+        if(!conf.archive_dir.empty()) {
+            ilog("Archiving block log file ${f}", ("f",seg.block_file.generic_string()));
+            fc::create_directories(conf.archive_dir);
+            move_file(seg.block_file, conf.archive_dir / seg.block_file.filename());
+            move_file(seg.index_file, conf.archive_dir / seg.index_file.filename());
+        }
+        else {
+            ilog("Removing block log file ${f}", ("f",seg.block_file.generic_string()));
+            fc::remove(seg.block_file);
+            fc::remove(seg.index_file);
+        }
+        // mappings are still valid for the pending readers after files are moved
+        segs.erase(segs.begin());
+    }
+}
+
+void
+block_log_impl::compress_async(const segment_ptr& seg) {
+    {
+        std::lock_guard<std::mutex> lock(compress_mutex);
+        compress_queue.emplace_back(seg);
+    }
+    compress_cv.notify_one();
+
+    if(compressor.joinable()) {
+        return;
+    }
+
+    stopping = false;
+    compressor = std::thread([this] {
+        utilities::affinity::enter_pool("blocklog", 0);
+        while(true) {
+            auto seg = segment_ptr();
+            {
+                std::unique_lock<std::mutex> lock(compress_mutex);
+                compress_cv.wait(lock, [this] { return stopping || !compress_queue.empty(); });
+                if(stopping) {
+                    return;
+                }
+                seg = compress_queue.front();
+                compress_queue.pop_front();
+            }
+            try {
+                compress(seg);
+            }
+            catch(const fc::exception& e) {
+                elog("Compress block log file ${f} failed: ${e}", ("f",seg->block_file.generic_string())("e",e.to_detail_string()));
+            }
+            catch(const std::exception& e) {
+                elog("Compress block log file ${f} failed: ${e}", ("f",seg->block_file.generic_string())("e",e.what()));
+            }
+        }
+    });
+}
+
+// compressed file takes the place of raw one in catalog, unless it's pruned or reset meanwhile
+void
+block_log_impl::compress(const segment_ptr& seg) {
+    auto name = fmt::format("blocks-{}-{}", seg->first_num, seg->last_num);
+    auto cseg = std::make_shared<log_segment>();
+    cseg->first_num  = seg->first_num;
+    cseg->last_num   = seg->last_num;
+    cseg->compressed = true;
+    cseg->block_file = conf.retained_dir / (name + ".zlog");
+    cseg->index_file = conf.retained_dir / (name + ".zindex");
+
+    auto tmp_block = conf.retained_dir / (name + ".zlog.tmp");
+    auto tmp_index = conf.retained_dir / (name + ".zindex.tmp");
+    if(!compress_segment(*seg, tmp_block, tmp_index, stopping)) {
+        fc::remove_all(tmp_block);
+        fc::remove_all(tmp_index);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(catalog_mutex);
+
+    auto segs = *std::atomic_load(&catalog);
+    auto it   = std::find(segs.begin(), segs.end(), seg);
+    if(it == segs.end()) {
+        fc::remove_all(tmp_block);
+        fc::remove_all(tmp_index);
+        return;
+    }
+
+    // compressed one is complete once its block file appears
+    fc::rename(tmp_index, cseg->index_file);
+    fc::rename(tmp_block, cseg->block_file);
+
+    cseg->block_size = fc::file_size(cseg->block_file);
+    cseg->block_map  = std::make_shared<mapped_file>(cseg->block_file, cseg->block_size);
+    cseg->index_map  = std::make_shared<mapped_file>(cseg->index_file, fc::file_size(cseg->index_file));
+
+    *it = cseg;
+    std::atomic_store(&catalog, catalog_ptr(std::make_shared<std::vector<segment_ptr>>(std::move(segs))));
+
+    // raw one is still mapped for the pending readers
+    fc::remove(seg->block_file);
+    fc::remove(seg->index_file);
+    ilog("Compressed block log file ${f}, ${r} bytes to ${c} bytes", ("f",cseg->block_file.generic_string())("r",seg->block_size)("c",cseg->block_size));
+}
+
+void
+block_log_impl::stop_compressor() {
+    if(!compressor.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(compress_mutex);
+        stopping = true;
+        compress_queue.clear();
+    }
+    compress_cv.notify_one();
+    compressor.join();
+}
+
+// caller flushes and publishes the written blocks
+uint64_t
+block_log_impl::write_block(const signed_block& b) {
+    auto num = b.block_num();
+    if(conf.stride > 0 && written_num >= first_block_num && num > first_block_num && (num - 1) % conf.stride == 0) {
+        split(written_num);
+    }
+
+    check_open_files();
+
+    block_stream.seekp(0, std::ios::end);
+    index_stream.seekp(0, std::ios::end);
+    uint64_t pos = block_stream.tellp();
+    EVT_ASSERT((size_t)index_stream.tellp() == sizeof(uint64_t) * (num - first_block_num),
+               block_log_append_fail,
+               "Append to index file occuring at wrong position.",
+               ("position", (uint64_t)index_stream.tellp())("expected", (num - first_block_num) * sizeof(uint64_t)));
+    auto data = fc::raw::pack(b);
+    block_stream.write(data.data(), data.size());
+    block_stream.write((char*)&pos, sizeof(pos));
+    index_stream.write((char*)&pos, sizeof(pos));
+    written_num = num;
+
+    return pos;
+}
+
+// `n` blocks up to `num` are written, files are fsynced only once there're enough blocks since last time
+void
+block_log_impl::commit(uint32_t num, uint32_t n) {
+    block_stream.flush();
+    index_stream.flush();
+    publish(num);
+
+    if(conf.sync_interval > 0) {
+        unsynced += n;
+        if(unsynced < conf.sync_interval) {
+            return;
+        }
+        sync_file(block_file);
+        sync_file(index_file);
+        unsynced = 0;
+    }
+
+    durable_num.store(num, std::memory_order_release);
+    if(on_durable) {
+        on_durable(num);
+    }
+}
+
+// all the blocks pending at a time are written as one batch
+void
+block_log_impl::start_writer() {
+    writer_stopping = false;
+    writer = std::thread([this] {
+        utilities::affinity::enter_pool("blocklog", 1);
+        auto batch = std::vector<signed_block_ptr>();
+        while(true) {
+            {
+                std::unique_lock<std::mutex> lock(pending_mutex);
+                pending_cv.wait(lock, [this] { return writer_stopping || !pending.empty(); });
+                if(pending.empty()) {
+                    return;  // pending ones are always written before stopped
+                }
+                batch.assign(pending.begin(), pending.end());
+            }
+
+            try {
+                for(auto& b : batch) {
+                    write_block(*b);
+                }
+                commit(batch.back()->block_num(), batch.size());
+            }
+            catch(...) {
+                elog("Writing blocks from ${n} into block log failed", ("n",batch.front()->block_num()));
+
+                std::lock_guard<std::mutex> lock(pending_mutex);
+                writer_error = std::current_exception();
+                pending_cv.notify_all();
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(pending_mutex);
+                pending.erase(pending.begin(), pending.begin() + batch.size());
+            }
+            pending_cv.notify_all();
+        }
+    });
+}
+
+void
+block_log_impl::stop_writer() {
+    if(!writer.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        writer_stopping = true;
+    }
+    pending_cv.notify_all();
+    writer.join();
+
+    if(!pending.empty()) {
+        elog("${n} blocks from ${b} are not written into block log", ("n",pending.size())("b",pending.front()->block_num()));
+    }
+}
+
+void
+block_log_impl::wait_pending() {
+    std::unique_lock<std::mutex> lock(pending_mutex);
+    pending_cv.wait(lock, [this] { return pending.empty() || writer_error; });
+    if(writer_error) {
+        std::rethrow_exception(writer_error);
+    }
+}
+
+void
+block_log_impl::write_header(const genesis_state& gs, uint32_t first_num) {
+    reopen();
+
+    auto data       = fc::raw::pack(gs);
+    version         = block_log::max_supported_version;
+    first_block_num = first_num;
+    block_stream.seekp(0, std::ios::end);
+    block_stream.write((char*)&version, sizeof(version));
+    block_stream.write((char*)&first_block_num, sizeof(first_block_num));
+    block_stream.write(data.data(), data.size());
+
+    auto totem = block_log::npos;
+    block_stream.write((char*)&totem, sizeof(totem));
+    block_stream.flush();
+
+    genesis_written_to_block_log = true;
+}
+
 }  // namespace detail
 
-block_log::block_log(const fc::path& data_dir)
+block_log::block_log(const fc::path& data_dir, const block_log_config& conf)
     : my(new detail::block_log_impl()) {
     my->block_stream.exceptions(std::fstream::failbit | std::fstream::badbit);
     my->index_stream.exceptions(std::fstream::failbit | std::fstream::badbit);
+    my->conf = conf;
     open(data_dir);
 }
 
@@ -91,6 +1037,8 @@ block_log::block_log(block_log&& other) {
 
 block_log::~block_log() {
     if(my) {
+        my->stop_writer();
+        my->stop_compressor();
         flush();
         my->close();
         my.reset();
@@ -99,6 +1047,8 @@ block_log::~block_log() {
 
 void
 block_log::open(const fc::path& data_dir) {
+    my->stop_writer();
+    my->stop_compressor();
     my->close();
 
     if(!fc::is_directory(data_dir)) {
@@ -107,8 +1057,23 @@ block_log::open(const fc::path& data_dir) {
     my->block_file = data_dir / "blocks.log";
     my->index_file = data_dir / "blocks.index";
 
+    if(my->conf.retained_dir.is_relative()) {
+        my->conf.retained_dir = data_dir / my->conf.retained_dir;
+    }
+    if(!my->conf.archive_dir.empty() && my->conf.archive_dir.is_relative()) {
+        my->conf.archive_dir = data_dir / my->conf.archive_dir;
+    }
+    my->load_catalog();
+
     my->reopen();
 
+    auto& cat = *my->catalog;
+    if(!cat.empty() && fc::file_size(my->block_file) == 0) {
+        // stopped while the log was being split
+        ilog("Log is empty after the retained ones, continue from block ${n}", ("n",cat.back()->last_num + 1));
+        my->write_header(detail::read_genesis(cat.back()->block_file), cat.back()->last_num + 1);
+    }
+
     /* On startup of the block log, there are several states the log file and the index file can be
        * in relation to each other.
        *
@@ -127,6 +1092,9 @@ block_log::open(const fc::path& data_dir) {
        *  - If the index file head is not in the log file, delete the index and replay.
        *  - If the index file head is in the log, but not up to date, replay from index head.
        */
+    my->written_num = 0;
+    my->durable_num = 0;
+
     auto log_size   = fc::file_size(my->block_file);
     auto index_size = fc::file_size(my->index_file);
 
@@ -149,6 +1117,9 @@ block_log::open(const fc::path& data_dir) {
         else {
             my->first_block_num = 1;
         }
+        EVT_ASSERT(cat.empty() || cat.back()->last_num + 1 == my->first_block_num, block_log_exception,
+            "Block log should start from block ${n} after the retained ones, but it starts from ${f}",
+            ("n",cat.back()->last_num + 1)("f",my->first_block_num));
 
         my->head = read_head();
         if(my->head) {
@@ -181,6 +1152,12 @@ block_log::open(const fc::path& data_dir) {
             ilog("Index is empty");
             construct_index();
         }
+
+        flush();
+        // head may be the last retained block
+        my->publish(my->head && my->head->block_num() >= my->first_block_num ? my->head->block_num() : 0);
+        my->written_num = my->head ? my->head->block_num() : 0;
+        my->durable_num = my->written_num;
     }
     else if(index_size) {
         ilog("Index is nonempty, remove and recreate it");
@@ -195,42 +1172,62 @@ block_log::append(const signed_block_ptr& b) {
     try {
         EVT_ASSERT(my->genesis_written_to_block_log, block_log_append_fail, "Cannot append to block log until the genesis is first written");
 
-        my->check_open_files();
-
-        my->block_stream.seekp(0, std::ios::end);
-        my->index_stream.seekp(0, std::ios::end);
-        uint64_t pos = my->block_stream.tellp();
-        EVT_ASSERT((size_t)my->index_stream.tellp() == sizeof(uint64_t) * (b->block_num() - my->first_block_num),
-                   block_log_append_fail,
-                   "Append to index file occuring at wrong position.",
-                   ("position", (uint64_t)my->index_stream.tellp())("expected", (b->block_num() - my->first_block_num) * sizeof(uint64_t)));
-        auto data = fc::raw::pack(*b);
-        my->block_stream.write(data.data(), data.size());
-        my->block_stream.write((char*)&pos, sizeof(pos));
-        my->index_stream.write((char*)&pos, sizeof(pos));
+        if(!my->conf.async_append) {
+            auto pos = my->write_block(*b);
+            my->head    = b;
+            my->head_id = b->id();
+            my->commit(b->block_num(), 1);
+
+            return pos;
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(my->pending_mutex);
+            my->pending_cv.wait(lock, [this] { return my->pending.size() < my->conf.max_pending || my->writer_error; });
+            if(my->writer_error) {
+                std::rethrow_exception(my->writer_error);
+            }
+            my->pending.emplace_back(b);
+        }
+        my->pending_cv.notify_all();
+        if(!my->writer.joinable()) {
+            my->start_writer();
+        }
         my->head    = b;
         my->head_id = b->id();
 
-        flush();
-
-        return pos;
+        return npos;
     }
     FC_LOG_AND_RETHROW()
 }
 
 void
 block_log::flush() {
+    if(my->writer.joinable()) {
+        // streams are flushed by writer after each batch
+        my->wait_pending();
+        return;
+    }
     my->block_stream.flush();
     my->index_stream.flush();
 }
 
 void
 block_log::reset(const genesis_state& gs, const signed_block_ptr& first_block, uint32_t first_block_num) {
+    my->stop_writer();
     my->close();
 
     fc::remove_all(my->block_file);
     fc::remove_all(my->index_file);
 
+    // retained files are not part of the new log
+    my->stop_compressor();
+    {
+        std::lock_guard<std::mutex> lock(my->catalog_mutex);
+        std::atomic_store(&my->catalog, detail::catalog_ptr(std::make_shared<std::vector<detail::segment_ptr>>()));
+    }
+    fc::remove_all(my->conf.retained_dir);
+
     my->reopen();
 
     auto data           = fc::raw::pack(gs);
@@ -246,8 +1243,10 @@ block_log::reset(const genesis_state& gs, const signed_block_ptr& first_block, u
     auto totem = npos;
     my->block_stream.write((char*)&totem, sizeof(totem));
 
+    my->written_num = 0;
     if(first_block) {
         append(first_block);
+        flush();
     }
 
     auto pos = my->block_stream.tellp();
@@ -262,23 +1261,51 @@ block_log::reset(const genesis_state& gs, const signed_block_ptr& first_block, u
 
 std::pair<signed_block_ptr, uint64_t>
 block_log::read_block(uint64_t pos) const {
-    my->check_open_files();
+    // size is loaded before mapping, so the mapping is always large enough for it
+    auto size = my->block_size.load(std::memory_order_acquire);
+    auto cur  = std::atomic_load(&my->current);
+    EVT_ASSERT(cur, block_log_exception, "There's no blocks in block log");
 
-    my->block_stream.seekg(pos);
-    std::pair<signed_block_ptr, uint64_t> result;
-    result.first = std::make_shared<signed_block>();
-    fc::raw::unpack(my->block_stream, *result.first);
-    result.second = uint64_t(my->block_stream.tellg()) + 8;
-    return result;
+    return detail::unpack_block(*cur, size, pos);
 }
 
 signed_block_ptr
 block_log::read_block_by_num(uint32_t block_num) const {
     try {
+        if(auto b = my->find_pending(block_num)) {
+            return b;
+        }
+
         signed_block_ptr b;
-        uint64_t         pos = get_block_pos(block_num);
-        if(pos != npos) {
-            b = read_block(pos).first;
+
+        auto cat = std::atomic_load(&my->catalog);
+        if(!cat->empty() && block_num <= cat->back()->last_num) {
+            if(block_num >= cat->front()->first_num) {
+                auto it = std::upper_bound(cat->begin(), cat->end(), block_num, [](auto n, auto& s) { return n < s->first_num; });
+                auto& seg = **(it - 1);
+                if(seg.compressed) {
+                    b = detail::unpack_compressed_block(seg, block_num);
+                }
+                else {
+                    b = detail::unpack_block(seg, seg.block_size, detail::read_index(seg, block_num)).first;
+                }
+            }
+        }
+        else {
+            // position and block are read from the same mapping
+            auto head = my->head_num.load(std::memory_order_acquire);
+            auto size = my->block_size.load(std::memory_order_acquire);
+            auto cur  = std::atomic_load(&my->current);
+            if(cur && block_num <= head && block_num >= cur->first_num) {
+                b = detail::unpack_block(*cur, size, detail::read_index(*cur, block_num)).first;
+            }
+            else if(std::atomic_load(&my->catalog) != cat) {
+                // log is split meanwhile
+                return read_block_by_num(block_num);
+            }
+        }
+
+        if(b) {
             EVT_ASSERT(b->block_num() == block_num, reversible_blocks_exception,
                        "Wrong block was read from block log.", ("returned", b->block_num())("expected", block_num));
         }
@@ -287,19 +1314,77 @@ block_log::read_block_by_num(uint32_t block_num) const {
     FC_LOG_AND_RETHROW()
 }
 
+std::optional<block_log::transaction_location>
+block_log::read_transaction(uint32_t block_num, uint32_t index) const {
+    try {
+        auto from_block = [&](const signed_block_ptr& b) -> std::optional<transaction_location> {
+            if(!b || index >= b->transactions.size()) {
+                return std::nullopt;
+            }
+            return transaction_location { .header = *b, .receipt = transaction_receipt(b->transactions[index]) };
+        };
+
+        if(auto b = my->find_pending(block_num)) {
+            return from_block(b);
+        }
+
+        auto loc = std::optional<transaction_location>();
+
+        auto cat = std::atomic_load(&my->catalog);
+        if(!cat->empty() && block_num <= cat->back()->last_num) {
+            if(block_num < cat->front()->first_num) {
+                return std::nullopt;
+            }
+            auto it = std::upper_bound(cat->begin(), cat->end(), block_num, [](auto n, auto& s) { return n < s->first_num; });
+            auto& seg = **(it - 1);
+            if(seg.compressed) {
+                // the frame is decompressed as a whole anyway
+                return from_block(detail::unpack_compressed_block(seg, block_num));
+            }
+            auto pos = detail::read_index(seg, block_num);
+            EVT_ASSERT(pos < seg.block_size, block_log_exception, "Position ${p} is out of block log, size: ${s}", ("p",pos)("s",seg.block_size));
+            loc = detail::unpack_receipt(seg.block_map->data + pos, seg.block_size - pos, index);
+        }
+        else {
+            // position and block are read from the same mapping
+            auto head = my->head_num.load(std::memory_order_acquire);
+            auto size = my->block_size.load(std::memory_order_acquire);
+            auto cur  = std::atomic_load(&my->current);
+            if(cur && block_num <= head && block_num >= cur->first_num) {
+                auto pos = detail::read_index(*cur, block_num);
+                EVT_ASSERT(pos < size, block_log_exception, "Position ${p} is out of block log, size: ${s}", ("p",pos)("s",size));
+                loc = detail::unpack_receipt(cur->block_map->data + pos, size - pos, index);
+            }
+            else if(std::atomic_load(&my->catalog) != cat) {
+                // log is split meanwhile
+                return read_transaction(block_num, index);
+            }
+        }
+
+        if(loc) {
+            EVT_ASSERT(loc->header.block_num() == block_num, reversible_blocks_exception,
+                       "Wrong block was read from block log.", ("returned", loc->header.block_num())("expected", block_num));
+        }
+        return loc;
+    }
+    FC_LOG_AND_RETHROW()
+}
+
 uint64_t
 block_log::get_block_pos(uint32_t block_num) const {
-    my->check_open_files();
-    if(!(my->head && block_num <= block_header::num_from_id(my->head_id) && block_num >= my->first_block_num))
+    auto head = my->head_num.load(std::memory_order_acquire);
+    auto cur  = std::atomic_load(&my->current);
+    if(!(cur && head > 0 && block_num <= head && block_num >= cur->first_num))
         return npos;
-    my->index_stream.seekg(sizeof(uint64_t) * (block_num - my->first_block_num));
-    uint64_t pos;
-    my->index_stream.read((char*)&pos, sizeof(pos));
-    return pos;
+
+    return detail::read_index(*cur, block_num);
 }
 
 signed_block_ptr
 block_log::read_head() const {
+    if(my->writer.joinable()) {
+        my->wait_pending();
+    }
     my->check_open_files();
 
     uint64_t pos;
@@ -312,7 +1397,15 @@ block_log::read_head() const {
     my->block_stream.seekg(-sizeof(pos), std::ios::end);
     my->block_stream.read((char*)&pos, sizeof(pos));
     if(pos != npos) {
-        return read_block(pos).first;
+        // head is read by the writer side, where streams are used
+        my->block_stream.seekg(pos);
+        auto b = std::make_shared<signed_block>();
+        fc::raw::unpack(my->block_stream, *b);
+        return b;
+    }
+    else if(auto cat = std::atomic_load(&my->catalog); !cat->empty()) {
+        // current file is just split
+        return read_block_by_num(cat->back()->last_num);
     }
     else {
         return {};
@@ -330,57 +1423,56 @@ block_log::first_block_num() const {
 }
 
 void
-block_log::construct_index() {
-    ilog("Reconstructing Block Log Index...");
-    my->close();
-
-    fc::remove_all(my->index_file);
-
-    my->reopen();
+block_log::set_durable_callback(std::function<void(uint32_t)> cb) {
+    my->on_durable = std::move(cb);
+}
 
-    uint64_t end_pos;
+uint32_t
+block_log::last_durable_block_num() const {
+    return my->durable_num.load(std::memory_order_acquire);
+}
 
-    my->block_stream.seekg(-sizeof(uint64_t), std::ios::end);
-    my->block_stream.read((char*)&end_pos, sizeof(end_pos));
+uint32_t
+block_log::first_available_block_num() const {
+    auto cat = std::atomic_load(&my->catalog);
+    return cat->empty() ? my->first_block_num : cat->front()->first_num;
+}
 
-    if(end_pos == npos) {
-        ilog("Block log contains no blocks. No need to construct index.");
-        return;
+block_log_reader::block_log_reader(const block_log& log, uint32_t first_block_num)
+    : log_(log)
+    , next_num_(first_block_num)
+    , last_num_(log.my->head ? log.my->head->block_num() : 0) {
+    if(first_block_num < log.first_available_block_num()) {
+        last_num_ = 0;
     }
+}
 
-    uint64_t pos = 0;
-    if(my->version == 1) {
-        pos = 4;  // Skip version which should have already been checked.
-    }
-    else {
-        pos = 8;  // Skip version and first block offset which should have already been checked
+signed_block_ptr
+block_log_reader::read_next() {
+    if(next_num_ > last_num_) {
+        return nullptr;
     }
-    my->block_stream.seekg(pos);
 
-    genesis_state gs;
-    fc::raw::unpack(my->block_stream, gs);
+    auto b = log_.read_block_by_num(next_num_);
+    EVT_ASSERT(b, block_log_exception, "Block ${n} is not found in block log", ("n", next_num_));
+    next_num_++;
 
-    // skip the totem
-    if(my->version > 1) {
-        uint64_t totem;
-        my->block_stream.read((char*)&totem, sizeof(totem));
-    }
+    return b;
+}
 
-    my->index_stream.seekp(0, std::ios::end);
-    while(pos < end_pos) {
-        signed_block tmp;
-        fc::raw::unpack(my->block_stream, tmp);
-        
-        my->block_stream.read((char*)&pos, sizeof(pos));
-        if(tmp.block_num() % 1000 == 0) {
-            ilog2_("Block log index reconstructed for block {:n}", tmp.block_num());
-        }
-        my->index_stream.write((char*)&pos, sizeof(pos));
-    }
+void
+block_log::construct_index() {
+    ilog("Reconstructing Block Log Index...");
+    my->close();
+
+    fc::remove_all(my->index_file);
+    detail::build_index(my->block_file, my->index_file, my->conf.recovery_threads);
+
+    my->reopen();
 }  // construct_index
 
 fc::path
-block_log::repair_log(const fc::path& data_dir, uint32_t truncate_at_block) {
+block_log::repair_log(const fc::path& data_dir, uint32_t truncate_at_block, const fc::path& retained_dir, uint32_t threads) {
     ilog("Recovering Block Log...");
     EVT_ASSERT(fc::is_directory(data_dir) && fc::is_regular_file(data_dir / "blocks.log"), block_log_not_found,
                "Block log not found in '${blocks_dir}'", ("blocks_dir", data_dir));
@@ -404,6 +1496,10 @@ block_log::repair_log(const fc::path& data_dir, uint32_t truncate_at_block) {
     ilog("Moved existing blocks directory to backup location: '${new_blocks_dir}'", ("new_blocks_dir", backup_dir));
 
     fc::create_directories(blocks_dir);
+    if(retained_dir.is_relative() && fc::is_directory(backup_dir / retained_dir)) {
+        // only current file is recovered, retained ones are fixed since they're split
+        fc::rename(backup_dir / retained_dir, blocks_dir / retained_dir);
+    }
     auto block_log_path = blocks_dir / "blocks.log";
 
     ilog("Reconstructing '${new_block_log}' from backed up block log", ("new_block_log", block_log_path));
@@ -451,6 +1547,14 @@ block_log::repair_log(const fc::path& data_dir, uint32_t truncate_at_block) {
         new_block_stream.write((char*)&actual_totem, sizeof(actual_totem));
     }
 
+    if(threads > 1) {
+        uint64_t pos = old_block_stream.tellg();
+        if(detail::repair_parallel(backup_dir / "blocks.log", new_block_stream, pos, end_pos, first_block_num, truncate_at_block, threads)) {
+            return backup_dir;
+        }
+        ilog("Positions of blocks are broken, recover it sequentially");
+    }
+
     std::exception_ptr     except_ptr;
     vector<char>           incomplete_block_data;
     optional<signed_block> bad_block;
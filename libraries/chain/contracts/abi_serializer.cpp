@@ -7,6 +7,10 @@
 #include <boost/algorithm/string/predicate.hpp>
 #include <fc/io/raw.hpp>
 #include <fc/io/varint.hpp>
+#include <fc/io/json.hpp>
+#include <rapidjson/reader.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
 
 #include <evt/chain/chain_config.hpp>
 #include <evt/chain/transaction.hpp>
@@ -21,6 +25,866 @@ namespace evt { namespace chain { namespace contracts {
 
 const size_t abi_serializer::max_recursion_depth;
 
+namespace impl {
+
+struct json_writer {
+    rapidjson::StringBuffer                    buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer{buffer};
+
+    // writes in the same way as the rapidjson generator of fc::json, so doubles and blobs are formatted by
+    // `variant::as_string` as well
+    void
+    write(const fc::variant& v) {
+        switch(v.get_type()) {
+        case fc::variant::null_type: {
+            writer.Null();
+            break;
+        }
+        case fc::variant::int64_type: {
+            writer.Int64(v.as_int64());
+            break;
+        }
+        case fc::variant::uint64_type: {
+            writer.Uint64(v.as_uint64());
+            break;
+        }
+        case fc::variant::double_type: {
+            // printed by `variant::as_string` instead of the shortest form of rapidjson
+            auto str = v.as_string();
+            writer.RawValue(str.c_str(), str.size(), rapidjson::kNumberType);
+            break;
+        }
+        case fc::variant::bool_type: {
+            writer.Bool(v.as_bool());
+            break;
+        }
+        case fc::variant::string_type: {
+            auto& str = v.get_string();
+            writer.String(str.c_str(), str.size());
+            break;
+        }
+        case fc::variant::blob_type: {
+            // base64 encoded
+            auto str = v.as_string();
+            writer.String(str.c_str(), str.size());
+            break;
+        }
+        case fc::variant::array_type: {
+            writer.StartArray();
+            for(auto& a : v.get_array()) {
+                write(a);
+            }
+            writer.EndArray();
+            break;
+        }
+        case fc::variant::object_type: {
+            writer.StartObject();
+            for(auto& it : v.get_object()) {
+                auto& key = it.key();
+                writer.Key(key.c_str(), key.size());
+                write(it.value());
+            }
+            writer.EndObject();
+            break;
+        }
+        default: {
+            FC_THROW_EXCEPTION(fc::invalid_arg_exception, "Unsupported variant type: " + std::to_string(v.get_type()));
+        }
+        }  // switch
+    }
+};
+
+}  // namespace impl
+
+namespace impl {
+
+// packs json events of rapidjson reader straight into binary by the resolved type plans
+// whenever the result may differ from packing the parsed variant, it stops and caller falls back to that
+struct json_packer {
+    using type_plan = abi_serializer::type_plan;
+
+    json_packer(const abi_serializer& self, const execution_context& exec_ctx, bool trx_mode)
+        : self(self)
+        , exec_ctx(exec_ctx)
+        , ctx(self, exec_ctx)
+        , trx_mode(trx_mode) {}
+
+private:
+    static constexpr int      kMaxJsonDepth   = 200;  // same as the default of fc::json::from_string
+    static constexpr size_t   kMaxPackedSize  = 1024 * 1024;  // buffer size used in `_variant_to_binary`
+    static constexpr uint32_t kMaxBatchSize   = 1000;  // same as `push_transactions`
+    static constexpr uint32_t kCheckInterval  = 16;
+    static constexpr int      kRootDepth      = 2;  // scopes entered by `variant_to_binary` before packing the value
+    static constexpr int      kTrxDepth       = 4;  // not less than the scopes entered by `from_variant` before the transaction
+
+    enum frame_kind { kStructFrame = 0, kArrayFrame, kVariantFrame, kBuilderFrame, kPtrxFrame, kBatchFrame };
+    enum event_kind { kScalarEvent = 0, kObjectEvent, kArrayEvent };
+    enum ptrx_field { kSignatures = 0, kCompression, kPackedTrx, kTransaction, kPtrxFields };
+
+    struct slot {
+        const type_name*           name;
+        const type_plan::field_op* op;
+        int                        depth;  // recursion depth of the value
+        size_t                     begin   = 0;
+        size_t                     end     = 0;
+        bool                       present = false;
+    };
+
+    struct builder_level {
+        bool                   is_object;
+        mutable_variant_object obj;
+        variants               arr;
+        std::string            key;
+    };
+
+    struct frame {
+        frame_kind       kind;
+        const type_plan* plan  = nullptr;
+        int              depth = 0;
+        size_t           start = 0;  // offset in output where the value starts
+
+        // struct
+        small_vector<slot, 8> slots;
+        int                   pending     = -1;  // slot of the value being packed, also used by packed transaction
+        bool                  trx_root    = false;
+        optional<fc::variant> act_name;
+        int64_t               data_len_at = -1;  // offset of the reserved length of action data
+
+        // array and batch
+        uint32_t count = 0;
+
+        // variant
+        int  vindex    = -1;
+        bool vtype     = false;  // value of type is expected
+        bool vdata     = false;  // value of data is being packed
+        bool data_done = false;
+
+        // builder, value is packed by `plan` when it's built, or stored into packed transaction if there's no plan
+        small_vector<builder_level, 4> levels;
+
+        // packed transaction
+        fc::variant fields[kPtrxFields];
+        bool        present[kPtrxFields] = {};
+        size_t      trx_begin            = 0;
+        size_t      trx_end              = 0;
+        bool        trx_packed           = false;
+    };
+
+public:
+    bool
+    pack(const type_name& type, const std::string& json) {
+        root_plan = &self.build_plan(type, local_plans);
+        return parse(json);
+    }
+
+    bool
+    parse_trxs(const std::string& json, bool batch) {
+        auto it = self.plans_.find("transaction");
+        if(it == self.plans_.end() || it->second.kind != type_plan::kStruct) {
+            return false;
+        }
+        trx_plan = &it->second;
+        if(auto ait = self.plans_.find("action"); ait != self.plans_.end()) {
+            act_plan = &ait->second;
+        }
+        this->batch = batch;
+        return parse(json);
+    }
+
+public:
+    bool Null() { return scalar(fc::variant(), 0); }
+    bool Bool(bool b) { return scalar(fc::variant(b), 0); }
+    bool Int(int i) { return scalar(fc::variant(i), 0); }
+    bool Uint(unsigned i) { return scalar(fc::variant(i), 0); }
+    bool Int64(int64_t i) { return scalar(fc::variant(i), 0); }
+    bool Uint64(uint64_t i) { return scalar(fc::variant(i), 0); }
+    bool Double(double d) { return scalar(fc::variant(d), 0); }
+    bool RawNumber(const char*, rapidjson::SizeType, bool) { return false; }
+    bool String(const char* str, rapidjson::SizeType len, bool) { return scalar(fc::variant(std::string(str, len)), len); }
+    bool StartObject() { return start(true); }
+    bool StartArray() { return start(false); }
+    bool Key(const char* str, rapidjson::SizeType len, bool) { return key(str, len); }
+    bool EndObject(rapidjson::SizeType) { return end(true); }
+    bool EndArray(rapidjson::SizeType) { return end(false); }
+
+private:
+    bool
+    parse(const std::string& json) {
+        if(json.find('\0') != std::string::npos) {
+            return false;
+        }
+        try {
+            auto reader = rapidjson::Reader();
+            auto ss     = rapidjson::StringStream(json.c_str());
+            if(!reader.Parse(ss, *this) || !root_done) {
+                return false;
+            }
+            return trx_mode || out.size() <= kMaxPackedSize;
+        }
+        catch(const abi_serialization_deadline_exception&) {
+            if(!trx_mode) {
+                throw;
+            }
+            // transactions of batch have their own deadlines when they're parsed from variants
+            return false;
+        }
+        catch(const fc::exception&) {
+            return false;
+        }
+        catch(const std::exception&) {
+            return false;
+        }
+    }
+
+    void
+    check_deadline() {
+        if((values++ % kCheckInterval) == 0) {
+            ctx.check_deadline();
+        }
+    }
+
+    frame&
+    push_frame(frame_kind kind, const type_plan* plan, int depth) {
+        auto& f = frames.emplace_back();
+        f.kind  = kind;
+        f.plan  = plan;
+        f.depth = depth;
+        f.start = out.size();
+        return f;
+    }
+
+    void
+    write_varint_at(size_t pos, uint32_t v) {
+        char buf[5];
+        auto n = 0;
+        do {
+            auto b = uint8_t(v & 0x7f);
+            v >>= 7;
+            b |= ((v > 0) << 7);
+            buf[n++] = (char)b;
+        } while(v);
+
+        out[pos] = buf[0];
+        if(n > 1) {
+            out.insert(out.begin() + pos + 1, buf + 1, buf + n);
+        }
+    }
+
+    bool
+    pack_builtin(const type_plan& plan, const fc::variant& v, size_t cap) {
+        auto pos = out.size();
+        while(true) {
+            cap = std::min(cap, kMaxPackedSize + 1);
+            out.resize(pos + cap);
+            auto ds = fc::datastream<char*>(out.data() + pos, cap);
+            try {
+                plan.builtin->second(v, ds, plan.builtin_array, plan.builtin_optional);
+                out.resize(pos + ds.tellp());
+                return true;
+            }
+            catch(const fc::out_of_range_exception&) {
+                out.resize(pos);
+                if(cap > kMaxPackedSize) {
+                    return false;
+                }
+                cap *= 4;
+            }
+        }
+    }
+
+    bool
+    add_slots(frame& f, const type_plan& plan, int depth) {
+        if(plan.base != nullptr) {
+            if(plan.base->kind != type_plan::kStruct || depth + 1 >= (int)abi_serializer::max_recursion_depth) {
+                return false;
+            }
+            if(!add_slots(f, *plan.base, depth + 1)) {
+                return false;
+            }
+        }
+        auto& st = plan.s_itr->second;
+        for(auto i = 0u; i < st.fields.size(); ++i) {
+            f.slots.emplace_back(slot{ .name = &st.fields[i].name, .op = &plan.fields[i], .depth = depth + 1 });
+        }
+        return true;
+    }
+
+    // packs the value starts with the event by the plan
+    bool
+    pack_value(const type_plan* plan, int depth, event_kind ev, const fc::variant* v, size_t len) {
+        while(true) {
+            if(depth >= (int)abi_serializer::max_recursion_depth) {
+                return false;
+            }
+
+            switch(plan->kind) {
+            case type_plan::kBuiltin: {
+                if(ev == kScalarEvent) {
+                    return pack_builtin(*plan, *v, len * 2 + 32) && done();
+                }
+                push_frame(kBuilderFrame, plan, depth).levels.emplace_back(builder_level{ .is_object = (ev == kObjectEvent) });
+                return true;
+            }
+            case type_plan::kOptional: {
+                if(ev == kScalarEvent && v->is_null()) {
+                    out.push_back(0);
+                    return done();
+                }
+                out.push_back(1);
+                plan = plan->element;
+                depth++;
+                break;
+            }
+            case type_plan::kEnum: {
+                if(ev != kScalarEvent || !v->is_string() || plan->element->kind != type_plan::kBuiltin
+                    || depth + 1 >= (int)abi_serializer::max_recursion_depth) {
+                    return false;
+                }
+                auto& fields = plan->e_itr->second.fields;
+                auto& es     = v->get_string();
+                auto  index  = 0u;
+                for(auto& field : fields) {
+                    if(field == es) {
+                        break;
+                    }
+                    index++;
+                }
+                if(index >= fields.size()) {
+                    return false;
+                }
+                return pack_builtin(*plan->element, fc::variant(index), 32) && done();
+            }
+            case type_plan::kArray: {
+                if(ev != kArrayEvent) {
+                    return false;
+                }
+                out.push_back(0);  // reserved for size
+                push_frame(kArrayFrame, plan, depth);
+                return true;
+            }
+            case type_plan::kVariant: {
+                if(ev != kObjectEvent) {
+                    return false;
+                }
+                push_frame(kVariantFrame, plan, depth);
+                return true;
+            }
+            case type_plan::kStruct: {
+                if(ev != kObjectEvent) {
+                    return false;
+                }
+                auto& f = push_frame(kStructFrame, plan, depth);
+                return add_slots(f, *plan, depth);
+            }
+            default: {
+                return false;
+            }
+            }  // switch
+        }
+    }
+
+    // plan and recursion depth of next value in top frame
+    bool
+    expected(const type_plan*& plan, int& depth) {
+        auto& f = frames.back();
+        switch(f.kind) {
+        case kStructFrame: {
+            if(f.pending < 0) {
+                return false;
+            }
+            plan  = f.slots[f.pending].op->type;
+            depth = f.slots[f.pending].depth;
+            return true;
+        }
+        case kArrayFrame: {
+            plan  = f.plan->element;
+            depth = f.depth + 1;
+            return true;
+        }
+        case kVariantFrame: {
+            if(!f.vdata) {
+                return false;
+            }
+            plan  = f.plan->fields[f.vindex].type;
+            depth = f.depth + 1;
+            return true;
+        }
+        default: {
+            return false;
+        }
+        }  // switch
+    }
+
+    // called when a value is packed
+    bool
+    done() {
+        if(frames.empty()) {
+            root_done = true;
+            return true;
+        }
+
+        auto& f = frames.back();
+        switch(f.kind) {
+        case kStructFrame: {
+            if(f.data_len_at >= 0) {
+                auto len = out.size() - f.data_len_at - 1;
+                if(len > kMaxPackedSize) {
+                    return false;
+                }
+                write_varint_at(f.data_len_at, len);
+                f.data_len_at = -1;
+            }
+            auto& s   = f.slots[f.pending];
+            s.end     = out.size();
+            s.present = true;
+            f.pending = -1;
+            return true;
+        }
+        case kArrayFrame: {
+            f.count++;
+            return true;
+        }
+        case kVariantFrame: {
+            f.vdata     = false;
+            f.data_done = true;
+            return true;
+        }
+        case kPtrxFrame: {
+            f.trx_end              = out.size();
+            f.trx_packed           = true;
+            f.present[f.pending]   = true;
+            f.pending              = -1;
+            return true;
+        }
+        default: {
+            return false;
+        }
+        }  // switch
+    }
+
+    bool
+    store_ptrx_field(fc::variant&& v) {
+        auto& f = frames.back();
+        if(f.kind != kPtrxFrame || f.pending < 0) {
+            return false;
+        }
+        f.fields[f.pending]  = std::move(v);
+        f.present[f.pending] = true;
+        f.pending            = -1;
+        return true;
+    }
+
+    bool
+    build(frame& f, fc::variant&& v) {
+        auto& l = f.levels.back();
+        if(l.is_object) {
+            l.obj(std::move(l.key), std::move(v));
+        }
+        else {
+            l.arr.push_back(std::move(v));
+        }
+        return true;
+    }
+
+    bool
+    scalar(fc::variant&& v, size_t len) {
+        if(skip_level > 0) {
+            return true;
+        }
+        if(skip_next) {
+            skip_next = false;
+            return true;
+        }
+        check_deadline();
+
+        if(frames.empty()) {
+            return !trx_mode && pack_value(root_plan, kRootDepth, kScalarEvent, &v, len);
+        }
+
+        auto& f = frames.back();
+        switch(f.kind) {
+        case kBuilderFrame: {
+            return build(f, std::move(v));
+        }
+        case kPtrxFrame: {
+            return store_ptrx_field(std::move(v));
+        }
+        case kStructFrame: {
+            if(f.plan == act_plan && f.pending >= 0 && *f.slots[f.pending].name == "name") {
+                f.act_name = v;
+            }
+            break;
+        }
+        case kVariantFrame: {
+            if(f.vtype) {
+                if(!v.is_string()) {
+                    return false;
+                }
+                auto& vt    = f.plan->v_itr->second;
+                auto& dtype = v.get_string();
+                auto  index = 0u;
+                for(auto& field : vt.fields) {
+                    if(field.name == dtype) {
+                        break;
+                    }
+                    index++;
+                }
+                if(index >= vt.fields.size()) {
+                    return false;
+                }
+                f.vindex = index;
+                f.vtype  = false;
+                return true;
+            }
+            break;
+        }
+        default: {
+            return false;
+        }
+        }  // switch
+
+        auto plan  = (const type_plan*)nullptr;
+        auto depth = 0;
+        return expected(plan, depth) && pack_value(plan, depth, kScalarEvent, &v, len);
+    }
+
+    bool
+    start_act_data() {
+        auto& f = frames.back();
+        if(!f.act_name.has_value()) {
+            return false;
+        }
+        auto name = action_name();
+        fc::from_variant(*f.act_name, name);
+
+        auto plan = self.get_action_plan(name, exec_ctx);
+        if(plan == nullptr) {
+            return false;
+        }
+        auto depth    = f.slots[f.pending].depth + 1;
+        f.data_len_at = out.size();
+        out.push_back(0);  // reserved for length
+
+        return pack_value(plan, depth, kObjectEvent, nullptr, 0);
+    }
+
+    bool
+    start(bool is_object) {
+        if(++json_depth > kMaxJsonDepth) {
+            return false;
+        }
+        if(skip_level > 0) {
+            skip_level++;
+            return true;
+        }
+        if(skip_next) {
+            skip_next  = false;
+            skip_level = 1;
+            return true;
+        }
+        check_deadline();
+
+        auto ev = is_object ? kObjectEvent : kArrayEvent;
+        if(frames.empty()) {
+            if(!trx_mode) {
+                return pack_value(root_plan, kRootDepth, ev, nullptr, 0);
+            }
+            if(is_object == batch) {
+                return false;
+            }
+            push_frame(is_object ? kPtrxFrame : kBatchFrame, nullptr, 0);
+            return true;
+        }
+
+        auto& f = frames.back();
+        switch(f.kind) {
+        case kBuilderFrame: {
+            f.levels.emplace_back(builder_level{ .is_object = is_object });
+            return true;
+        }
+        case kBatchFrame: {
+            if(!is_object || f.count >= kMaxBatchSize) {
+                return false;
+            }
+            push_frame(kPtrxFrame, nullptr, 0);
+            return true;
+        }
+        case kPtrxFrame: {
+            if(f.pending < 0) {
+                return false;
+            }
+            if(f.pending == kTransaction && is_object) {
+                f.trx_begin = out.size();
+                if(!pack_value(trx_plan, kTrxDepth, kObjectEvent, nullptr, 0)) {
+                    return false;
+                }
+                frames.back().trx_root = true;
+                return true;
+            }
+            // other fields are converted from variants
+            push_frame(kBuilderFrame, nullptr, 0).levels.emplace_back(builder_level{ .is_object = is_object });
+            return true;
+        }
+        case kStructFrame: {
+            if(is_object && f.plan == act_plan && f.pending >= 0 && *f.slots[f.pending].name == "data") {
+                return start_act_data();
+            }
+            break;
+        }
+        default: {
+            break;
+        }
+        }  // switch
+
+        auto plan  = (const type_plan*)nullptr;
+        auto depth = 0;
+        return expected(plan, depth) && pack_value(plan, depth, ev, nullptr, 0);
+    }
+
+    bool
+    key(const char* str, size_t len) {
+        if(skip_level > 0) {
+            return true;
+        }
+
+        auto k  = std::string_view(str, len);
+        auto& f = frames.back();
+        switch(f.kind) {
+        case kBuilderFrame: {
+            f.levels.back().key = std::string(str, len);
+            return true;
+        }
+        case kStructFrame: {
+            auto index = -1;
+            for(auto i = 0u; i < f.slots.size(); ++i) {
+                if(*f.slots[i].name == k) {
+                    if(index >= 0) {
+                        return false;  // same name in struct and its base
+                    }
+                    index = i;
+                }
+            }
+            if(index < 0) {
+                if(f.trx_root && k == "signatures") {
+                    return false;  // signatures of signed transaction are parsed as well
+                }
+                skip_next = true;
+                return true;
+            }
+            if(f.slots[index].present) {
+                return false;  // variant keeps the last one of duplicated keys
+            }
+            f.slots[index].begin = out.size();
+            f.pending            = index;
+            return true;
+        }
+        case kVariantFrame: {
+            if(k == "type") {
+                if(f.vindex >= 0) {
+                    return false;
+                }
+                f.vtype = true;
+            }
+            else if(k == "data") {
+                if(f.vindex < 0 || f.data_done) {
+                    return false;  // type is needed before data
+                }
+                out.push_back(0);
+                write_varint_at(out.size() - 1, f.vindex);
+                f.vdata = true;
+            }
+            else {
+                skip_next = true;
+            }
+            return true;
+        }
+        case kPtrxFrame: {
+            static const char* names[] = { "signatures", "compression", "packed_trx", "transaction" };
+
+            auto index = -1;
+            for(auto i = 0; i < kPtrxFields; ++i) {
+                if(k == names[i]) {
+                    index = i;
+                    break;
+                }
+            }
+            if(index < 0) {
+                skip_next = true;
+                return true;
+            }
+            if(f.present[index]) {
+                return false;
+            }
+            f.pending = index;
+            return true;
+        }
+        default: {
+            return false;
+        }
+        }  // switch
+    }
+
+    bool
+    end_struct() {
+        auto& f        = frames.back();
+        auto  in_order = true;
+        auto  pos      = f.start;
+        for(auto& s : f.slots) {
+            if(!s.present) {
+                if(!s.op->is_optional || s.depth >= (int)abi_serializer::max_recursion_depth) {
+                    return false;
+                }
+                in_order = false;
+                continue;
+            }
+            if(s.begin != pos) {
+                in_order = false;
+            }
+            pos = s.end;
+        }
+
+        if(!in_order) {
+            auto tmp = bytes(out.begin() + f.start, out.end());
+            out.resize(f.start);
+            for(auto& s : f.slots) {
+                if(s.present) {
+                    out.insert(out.end(), tmp.begin() + (s.begin - f.start), tmp.begin() + (s.end - f.start));
+                }
+                else {
+                    out.push_back(0);  // absent optional
+                }
+            }
+        }
+        frames.pop_back();
+        return done();
+    }
+
+    bool
+    end_ptrx() {
+        auto& f = frames.back();
+        if(!f.present[kSignatures] || !f.present[kCompression]) {
+            return false;
+        }
+
+        auto signatures  = signatures_type();
+        auto compression = packed_transaction::compression_type();
+        fc::from_variant(f.fields[kSignatures], signatures);
+        fc::from_variant(f.fields[kCompression], compression);
+
+        auto& pt = f.fields[kPackedTrx];
+        if(f.present[kPackedTrx] && pt.is_string() && !pt.get_string().empty()) {
+            auto packed_trx = bytes();
+            fc::from_variant(pt, packed_trx);
+            ptrxs.emplace_back(std::move(packed_trx), std::move(signatures), compression);
+        }
+        else {
+            if(!f.trx_packed) {
+                return false;
+            }
+            auto trx = signed_transaction();
+            auto ds  = fc::datastream<const char*>(out.data() + f.trx_begin, f.trx_end - f.trx_begin);
+            fc::raw::unpack(ds, static_cast<transaction&>(trx));
+            if(ds.remaining() > 0) {
+                return false;
+            }
+            trx.signatures = std::move(signatures);
+            ptrxs.emplace_back(std::move(trx), compression);
+        }
+
+        out.resize(f.start);
+        frames.pop_back();
+        if(frames.empty()) {
+            root_done = true;
+        }
+        else {
+            frames.back().count++;
+        }
+        return true;
+    }
+
+    bool
+    end(bool is_object) {
+        json_depth--;
+        if(skip_level > 0) {
+            skip_level--;
+            return true;
+        }
+
+        auto& f = frames.back();
+        switch(f.kind) {
+        case kBuilderFrame: {
+            auto& l = f.levels.back();
+            auto  v = l.is_object ? fc::variant(std::move(l.obj)) : fc::variant(std::move(l.arr));
+            f.levels.pop_back();
+            if(!f.levels.empty()) {
+                return build(f, std::move(v));
+            }
+
+            auto plan = f.plan;
+            frames.pop_back();
+            if(plan != nullptr) {
+                return pack_builtin(*plan, v, 4096) && done();
+            }
+            return store_ptrx_field(std::move(v));
+        }
+        case kStructFrame: {
+            return end_struct();
+        }
+        case kArrayFrame: {
+            auto at    = f.start - 1;
+            auto count = f.count;
+            frames.pop_back();
+            write_varint_at(at, count);
+            return done();
+        }
+        case kVariantFrame: {
+            if(f.vindex < 0 || !f.data_done) {
+                return false;
+            }
+            frames.pop_back();
+            return done();
+        }
+        case kPtrxFrame: {
+            return end_ptrx();
+        }
+        case kBatchFrame: {
+            frames.pop_back();
+            root_done = true;
+            return true;
+        }
+        default: {
+            return false;
+        }
+        }  // switch
+    }
+
+public:
+    bytes                           out;
+    std::vector<packed_transaction> ptrxs;
+
+private:
+    const abi_serializer&    self;
+    const execution_context& exec_ctx;
+    abi_traverse_context     ctx;
+    bool                     trx_mode;
+    bool                     batch = false;
+
+    abi_serializer::type_plans local_plans;
+    const type_plan*           root_plan = nullptr;
+    const type_plan*           trx_plan  = nullptr;
+    const type_plan*           act_plan  = nullptr;
+
+    std::vector<frame> frames;
+
+    int      json_depth = 0;
+    int      skip_level = 0;      // nesting level of the value being skipped
+    bool     skip_next  = false;  // next value is skipped
+    bool     root_done  = false;
+    uint32_t values     = 0;
+};
+
+}  // namespace impl
+
 using boost::algorithm::ends_with;
 using std::string;
 
@@ -64,6 +928,28 @@ pack_unpack() {
         });
 }
 
+// bytes and strings are converted to variant from views into the binary, without the intermediate copy
+template <typename T, typename V>
+auto
+pack_unpack_view() {
+    auto pu = pack_unpack<T>();
+    pu.first = [unpack = std::move(pu.first)](fc::datastream<const char*>& stream, bool is_array, bool is_optional) -> fc::variant {
+        if(is_array || is_optional) {
+            return unpack(stream, is_array, is_optional);
+        }
+
+        auto v = V();
+        fc::raw::unpack_view(stream, v);
+        if constexpr(std::is_same_v<V, std::string_view>) {
+            return fc::variant(std::string(v));
+        }
+        else {
+            return v.empty() ? fc::variant("") : fc::variant(fc::to_hex(v.data(), v.size()));
+        }
+    };
+    return pu;
+}
+
 abi_serializer::abi_serializer(const abi_def& abi, const std::chrono::microseconds max_serialization_time_)
     : max_serialization_time_(max_serialization_time_) {
     configure_built_in_types();
@@ -74,6 +960,7 @@ void
 abi_serializer::add_specialized_unpack_pack(const string& name,
                                             std::pair<abi_serializer::unpack_function, abi_serializer::pack_function> unpack_pack) {
     built_in_types_[name] = std::move(unpack_pack);
+    build_plans();
 }
 
 void
@@ -87,8 +974,8 @@ abi_serializer::configure_built_in_types() {
     built_in_types_.emplace("percent", pack_unpack<percent_type>());
     built_in_types_.emplace("percent_slim", pack_unpack<percent_slim>());
 
-    built_in_types_.emplace("bytes", pack_unpack<bytes>());
-    built_in_types_.emplace("string", pack_unpack<string>());
+    built_in_types_.emplace("bytes", pack_unpack_view<bytes, fc::bytes_view>());
+    built_in_types_.emplace("string", pack_unpack_view<string, std::string_view>());
     
     built_in_types_.emplace("time_point", pack_unpack<fc::time_point>());
     built_in_types_.emplace("time_point_sec", pack_unpack<fc::time_point_sec>());
@@ -125,6 +1012,7 @@ abi_serializer::configure_built_in_types() {
 
 void
 abi_serializer::set_abi(const abi_def& abi) {
+    plans_.clear();
     typedefs_.clear();
     structs_.clear();
     variants_.clear();
@@ -154,6 +1042,113 @@ abi_serializer::set_abi(const abi_def& abi) {
     EVT_ASSERT(enums_.size() == abi.enums.size(), duplicate_abi_enum_def_exception, "duplicate enum definition detected");
 
     validate();
+    build_plans();
+}
+
+void
+abi_serializer::build_plans() {
+    plans_.clear();
+    for(auto& td : typedefs_) {
+        build_plan(td.first, plans_);
+    }
+    for(auto& st : structs_) {
+        build_plan(st.first, plans_);
+    }
+    for(auto& vt : variants_) {
+        build_plan(vt.first, plans_);
+    }
+    for(auto& et : enums_) {
+        build_plan(et.first, plans_);
+    }
+}
+
+void
+abi_serializer::bind_actions(const execution_context& exec_ctx) {
+    action_plans_.clear();
+    for(auto& names : exec_ctx.get_all_acttype_names()) {
+        auto& plans = action_plans_.emplace_back();
+        for(auto& type : names) {
+            auto it = plans_.find(type);
+            plans.emplace_back(it != plans_.end() ? &it->second : nullptr);
+        }
+    }
+    bound_ctx_ = &exec_ctx;
+}
+
+const abi_serializer::type_plan*
+abi_serializer::get_action_plan(name act, const execution_context& exec_ctx) const {
+    if(&exec_ctx == bound_ctx_) {
+        // versions are read when called, switching versions doesn't need to bind again
+        auto [index, ver] = exec_ctx.get_index_and_version(act);
+        auto& plans       = action_plans_[index];
+        if(ver > 0 && ver <= (int)plans.size()) {
+            return plans[ver - 1];
+        }
+    }
+
+    auto type = exec_ctx.get_acttype_name(act);
+    if(auto it = plans_.find(type); it != plans_.end()) {
+        return &it->second;
+    }
+    return nullptr;
+}
+
+// plans not found in `plans_` are built into `plans`
+const abi_serializer::type_plan&
+abi_serializer::build_plan(const type_name& type, type_plans& plans) const {
+    if(auto it = plans_.find(type); it != plans_.end()) {
+        return it->second;
+    }
+    if(auto it = plans.find(type); it != plans.end()) {
+        return it->second;
+    }
+
+    // plan is inserted before building its references, so recursive types can refer to itself
+    auto& p = plans[type];
+    p.name  = type;
+    p.rtype = resolve_type(type);
+
+    auto ftype = fundamental_type(p.rtype);
+    auto field_ops = [&](auto& fields) {
+        for(auto& f : fields) {
+            p.fields.emplace_back(type_plan::field_op{ .type = &build_plan(f.type, plans), .is_optional = is_optional(f.type) });
+        }
+    };
+
+    if(auto bit = built_in_types_.find(ftype); bit != built_in_types_.end()) {
+        p.kind             = type_plan::kBuiltin;
+        p.builtin          = &bit->second;
+        p.builtin_array    = is_array(p.rtype);
+        p.builtin_optional = is_optional(p.rtype);
+    }
+    else if(is_array(p.rtype)) {
+        p.kind    = type_plan::kArray;
+        p.element = &build_plan(ftype, plans);
+    }
+    else if(is_optional(p.rtype)) {
+        p.kind    = type_plan::kOptional;
+        p.element = &build_plan(ftype, plans);
+    }
+    else if(auto vit = variants_.find(p.rtype); vit != variants_.end()) {
+        p.kind  = type_plan::kVariant;
+        p.v_itr = vit;
+        field_ops(vit->second.fields);
+    }
+    else if(auto eit = enums_.find(p.rtype); eit != enums_.end()) {
+        p.kind    = type_plan::kEnum;
+        p.e_itr   = eit;
+        p.element = &build_plan(eit->second.integer, plans);
+    }
+    else if(auto sit = structs_.find(p.rtype); sit != structs_.end()) {
+        p.kind  = type_plan::kStruct;
+        p.s_itr = sit;
+        if(sit->second.base != type_name()) {
+            p.base = &build_plan(resolve_type(sit->second.base), plans);
+        }
+        field_ops(sit->second.fields);
+    }
+    // unknown types are reported when they're traversed
+    return p;
 }
 
 bool
@@ -323,16 +1318,16 @@ abi_serializer::resolve_type(const type_name& type) const {
 }
 
 void
-abi_serializer::_binary_to_variant(const type_name& type, fc::datastream<const char*>& stream,
+abi_serializer::_binary_to_variant(const type_plan& plan, fc::datastream<const char*>& stream,
                                    fc::mutable_variant_object& obj, impl::binary_to_variant_context& ctx) const {
-    auto h     = ctx.enter_scope();
-    auto s_itr = structs_.find(type);
-    EVT_ASSERT(s_itr != structs_.end(), invalid_type_inside_abi, "Unknown type ${type}", ("type", ctx.maybe_shorten(type)));
+    auto h = ctx.enter_scope();
+    EVT_ASSERT(plan.kind == type_plan::kStruct, invalid_type_inside_abi, "Unknown type ${type}", ("type", ctx.maybe_shorten(plan.rtype)));
 
+    auto& s_itr = plan.s_itr;
     ctx.hint_struct_type_if_in_array(s_itr);
     const auto& st = s_itr->second;
-    if(st.base != type_name()) {
-        _binary_to_variant(resolve_type(st.base), stream, obj, ctx);
+    if(plan.base != nullptr) {
+        _binary_to_variant(*plan.base, stream, obj, ctx);
     }
 
     for(auto i = 0u; i < st.fields.size(); ++i) {
@@ -342,27 +1337,31 @@ abi_serializer::_binary_to_variant(const type_name& type, fc::datastream<const c
                       ("f", ctx.maybe_shorten(field.name))("p", ctx.get_path_string()));
         }
         auto h1 = ctx.push_to_path(impl::field_path_item{.parent_itr = s_itr, .field_ordinal = i});
-        obj(field.name, _binary_to_variant(resolve_type(field.type), stream, ctx));
+        obj(field.name, _binary_to_variant(*plan.fields[i].type, stream, ctx));
     }
 }
 
 fc::variant
 abi_serializer::_binary_to_variant(const type_name& type, fc::datastream<const char*>& stream,
                                    impl::binary_to_variant_context& ctx) const {
-    auto h     = ctx.enter_scope();
-    auto rtype = resolve_type(type);
-    auto ftype = fundamental_type(rtype);
-    auto btype = built_in_types_.find(ftype);
+    auto plans = type_plans();
+    return _binary_to_variant(build_plan(type, plans), stream, ctx);
+}
+
+fc::variant
+abi_serializer::_binary_to_variant(const type_plan& plan, fc::datastream<const char*>& stream,
+                                   impl::binary_to_variant_context& ctx) const {
+    auto h = ctx.enter_scope();
 
-    if(btype != built_in_types_.end()) {
+    if(plan.kind == type_plan::kBuiltin) {
         try {
-            return btype->second.first(stream, is_array(rtype), is_optional(rtype));
+            return plan.builtin->first(stream, plan.builtin_array, plan.builtin_optional);
         }
         EVT_RETHROW_EXCEPTIONS(unpack_exception, "Unable to unpack ${class} type '${type}' while processing '${p}'",
-                               ("class", is_array(rtype) ? "array of built-in" : is_optional(rtype) ? "optional of built-in" : "built-in")("type", ftype)("p", ctx.get_path_string()))
+                               ("class", plan.builtin_array ? "array of built-in" : plan.builtin_optional ? "optional of built-in" : "built-in")("type", fundamental_type(plan.rtype))("p", ctx.get_path_string()))
     }
 
-    if(is_array(rtype)) {
+    if(plan.kind == type_plan::kArray) {
         ctx.hint_array_type_if_in_array();
 
         auto size = fc::unsigned_int();
@@ -375,7 +1374,7 @@ abi_serializer::_binary_to_variant(const type_name& type, fc::datastream<const c
         auto h1   = ctx.push_to_path(impl::array_index_path_item{});
         for(decltype(size.value) i = 0; i < size; ++i) {
             ctx.set_array_index_of_path_back(i);
-            auto v = _binary_to_variant(ftype, stream, ctx);
+            auto v = _binary_to_variant(*plan.element, stream, ctx);
             // QUESTION: Is it actually desired behavior to require the returned variant to not be null?
             //           This would disallow arrays of optionals in general (though if all optionals in the array were present it would be allowed).
             //           Is there any scenario in which the returned variant would be null other than in the case of an empty optional?
@@ -388,16 +1387,16 @@ abi_serializer::_binary_to_variant(const type_name& type, fc::datastream<const c
         
         return fc::variant(std::move(vars));
     }
-    else if(is_optional(rtype)) {
+    else if(plan.kind == type_plan::kOptional) {
         char flag;
         try {
             fc::raw::unpack(stream, flag);
         }
         EVT_RETHROW_EXCEPTIONS(unpack_exception, "Unable to unpack presence flag of optional '${p}'", ("p", ctx.get_path_string()))
-        return flag ? _binary_to_variant(ftype, stream, ctx) : fc::variant();
+        return flag ? _binary_to_variant(*plan.element, stream, ctx) : fc::variant();
     }
-    else if(is_variant(rtype)) {
-        auto v_itr = variants_.find(rtype);
+    else if(plan.kind == type_plan::kVariant) {
+        auto& v_itr = plan.v_itr;
         ctx.hint_variant_type_if_in_array(v_itr);
 
         auto i = fc::unsigned_int();
@@ -413,16 +1412,16 @@ abi_serializer::_binary_to_variant(const type_name& type, fc::datastream<const c
         auto h1 = ctx.push_to_path(impl::variant_path_item{.parent_itr = v_itr, .index = i});
 
         vo["type"] = vt.fields[i].name;
-        vo["data"] = _binary_to_variant(vt.fields[i].type, stream, ctx);
+        vo["data"] = _binary_to_variant(*plan.fields[i].type, stream, ctx);
 
         return fc::variant(std::move(vo));
     }
-    else if(is_enum(rtype)) {
-        auto e_itr = enums_.find(rtype);
+    else if(plan.kind == type_plan::kEnum) {
+        auto& e_itr = plan.e_itr;
         ctx.hint_enum_type_if_in_array(e_itr);
 
         auto& et = e_itr->second;
-        auto  ev = _binary_to_variant(et.integer, stream, ctx);
+        auto  ev = _binary_to_variant(*plan.element, stream, ctx);
         // we assume the enum is start at 0 and each item is increased by 1
         EVT_ASSERT2(ev.as_uint64() < et.fields.size(), unpack_exception, "Value of enum '{}' is not valid", ctx.get_path_string());
 
@@ -430,16 +1429,22 @@ abi_serializer::_binary_to_variant(const type_name& type, fc::datastream<const c
     }
 
     auto mvo = fc::mutable_variant_object();
-    _binary_to_variant(rtype, stream, mvo, ctx);
+    _binary_to_variant(plan, stream, mvo, ctx);
     
     return fc::variant(std::move(mvo));
 }
 
 fc::variant
 abi_serializer::_binary_to_variant(const type_name& type, const bytes& binary, impl::binary_to_variant_context& ctx) const {
+    auto plans = type_plans();
+    return _binary_to_variant(build_plan(type, plans), binary, ctx);
+}
+
+fc::variant
+abi_serializer::_binary_to_variant(const type_plan& plan, const bytes& binary, impl::binary_to_variant_context& ctx) const {
     auto h   = ctx.enter_scope();
     auto ds  = fc::datastream(binary.data(), binary.size());
-    auto var = _binary_to_variant(type, ds, ctx);
+    auto var = _binary_to_variant(plan, ds, ctx);
     if(ds.remaining() > 0) {
         EVT_THROW2(unpack_exception, "Binary buffer is not EOF after unpack variable, remaining: {} bytes.", ds.remaining());
     }
@@ -460,17 +1465,148 @@ abi_serializer::binary_to_variant(const type_name& type, fc::datastream<const ch
     return _binary_to_variant(type, binary, ctx);
 }
 
+void
+abi_serializer::_binary_to_json_fields(const type_plan& plan, fc::datastream<const char*>& stream,
+                                       impl::json_writer& w, impl::binary_to_variant_context& ctx) const {
+    auto h = ctx.enter_scope();
+    EVT_ASSERT(plan.kind == type_plan::kStruct, invalid_type_inside_abi, "Unknown type ${type}", ("type", ctx.maybe_shorten(plan.rtype)));
+
+    auto& s_itr = plan.s_itr;
+    ctx.hint_struct_type_if_in_array(s_itr);
+    const auto& st = s_itr->second;
+    if(plan.base != nullptr) {
+        _binary_to_json_fields(*plan.base, stream, w, ctx);
+    }
+
+    for(auto i = 0u; i < st.fields.size(); ++i) {
+        const auto& field = st.fields[i];
+        if(!stream.remaining()) {
+            EVT_THROW(unpack_exception, "Stream unexpectedly ended; unable to unpack field '${f}' of struct '${p}'",
+                      ("f", ctx.maybe_shorten(field.name))("p", ctx.get_path_string()));
+        }
+        auto h1 = ctx.push_to_path(impl::field_path_item{.parent_itr = s_itr, .field_ordinal = i});
+        w.writer.Key(field.name.c_str(), field.name.size());
+        _binary_to_json(*plan.fields[i].type, stream, w, ctx);
+    }
+}
+
+void
+abi_serializer::_binary_to_json(const type_plan& plan, fc::datastream<const char*>& stream,
+                                impl::json_writer& w, impl::binary_to_variant_context& ctx) const {
+    if(plan.kind != type_plan::kArray && plan.kind != type_plan::kOptional
+        && plan.kind != type_plan::kVariant && plan.kind != type_plan::kStruct) {
+        // built-in and enum values are small, they're written from variants
+        // unknown types are also left to report the errors
+        w.write(_binary_to_variant(plan, stream, ctx));
+        return;
+    }
+
+    auto h = ctx.enter_scope();
+
+    if(plan.kind == type_plan::kArray) {
+        ctx.hint_array_type_if_in_array();
+
+        auto size = fc::unsigned_int();
+        try {
+            fc::raw::unpack(stream, size);
+        }
+        EVT_RETHROW_EXCEPTIONS(unpack_exception, "Unable to unpack size of array '${p}'", ("p", ctx.get_path_string()))
+
+        // null elements are not allowed, need to check before they're written
+        auto& ep       = *plan.element;
+        auto  nullable = ep.kind == type_plan::kOptional || (ep.kind == type_plan::kBuiltin && ep.builtin_optional);
+
+        w.writer.StartArray();
+        auto h1 = ctx.push_to_path(impl::array_index_path_item{});
+        for(decltype(size.value) i = 0; i < size; ++i) {
+            ctx.set_array_index_of_path_back(i);
+            if(nullable) {
+                auto v = _binary_to_variant(ep, stream, ctx);
+                EVT_ASSERT(!v.is_null(), unpack_exception, "Invalid packed array '${p}'", ("p", ctx.get_path_string()));
+                w.write(v);
+            }
+            else {
+                _binary_to_json(ep, stream, w, ctx);
+            }
+        }
+        w.writer.EndArray();
+    }
+    else if(plan.kind == type_plan::kOptional) {
+        char flag;
+        try {
+            fc::raw::unpack(stream, flag);
+        }
+        EVT_RETHROW_EXCEPTIONS(unpack_exception, "Unable to unpack presence flag of optional '${p}'", ("p", ctx.get_path_string()))
+        if(flag) {
+            _binary_to_json(*plan.element, stream, w, ctx);
+        }
+        else {
+            w.writer.Null();
+        }
+    }
+    else if(plan.kind == type_plan::kVariant) {
+        auto& v_itr = plan.v_itr;
+        ctx.hint_variant_type_if_in_array(v_itr);
+
+        auto i = fc::unsigned_int();
+        try {
+            fc::raw::unpack(stream, i);
+        }
+        EVT_RETHROW_EXCEPTIONS(unpack_exception, "Unable to unpack index of variant '${p}'", ("p", ctx.get_path_string()));
+
+        auto& vt = v_itr->second;
+        EVT_ASSERT2((uint32_t)i < vt.fields.size(), unpack_exception, "Index of variant '{}' if not valid", ctx.get_path_string());
+
+        auto h1 = ctx.push_to_path(impl::variant_path_item{.parent_itr = v_itr, .index = i});
+        auto& name = vt.fields[i].name;
+
+        w.writer.StartObject();
+        w.writer.Key("type", 4);
+        w.writer.String(name.c_str(), name.size());
+        w.writer.Key("data", 4);
+        _binary_to_json(*plan.fields[i].type, stream, w, ctx);
+        w.writer.EndObject();
+    }
+    else {
+        w.writer.StartObject();
+        _binary_to_json_fields(plan, stream, w, ctx);
+        w.writer.EndObject();
+    }
+}
+
+std::string
+abi_serializer::binary_to_json(const type_name& type, const bytes& binary, const execution_context& exec_ctx, bool short_path) const {
+    auto ctx = impl::binary_to_variant_context(*this, exec_ctx, type);
+    ctx.short_path = short_path;
+
+    auto h     = ctx.enter_scope();
+    auto plans = type_plans();
+    auto ds    = fc::datastream(binary.data(), binary.size());
+    auto w     = impl::json_writer();
+
+    _binary_to_json(build_plan(type, plans), ds, w, ctx);
+    if(ds.remaining() > 0) {
+        EVT_THROW2(unpack_exception, "Binary buffer is not EOF after unpack variable, remaining: {} bytes.", ds.remaining());
+    }
+    return std::string(w.buffer.GetString(), w.buffer.GetSize());
+}
+
 void
 abi_serializer::_variant_to_binary(const type_name& type, const fc::variant& var, fc::datastream<char*>& ds, impl::variant_to_binary_context& ctx) const {
+    auto plans = type_plans();
+    _variant_to_binary(build_plan(type, plans), var, ds, ctx);
+}
+
+void
+abi_serializer::_variant_to_binary(const type_plan& plan, const fc::variant& var, fc::datastream<char*>& ds, impl::variant_to_binary_context& ctx) const {
+    const auto& type = plan.name;
     try {
-        auto h     = ctx.enter_scope();
-        auto rtype = resolve_type(type);
+        auto h = ctx.enter_scope();
 
-        auto btype = built_in_types_.find(fundamental_type(rtype));
-        if(btype != built_in_types_.end()) {
-            btype->second.second(var, ds, is_array(rtype), is_optional(rtype));
+        if(plan.kind == type_plan::kBuiltin) {
+            plan.builtin->second(var, ds, plan.builtin_array, plan.builtin_optional);
         }
-        else if(is_array(rtype)) {
+        else if(plan.kind == type_plan::kArray) {
             ctx.hint_array_type_if_in_array();
             auto& vars = var.get_array();
             fc::raw::pack(ds, (fc::unsigned_int)vars.size());
@@ -480,22 +1616,22 @@ abi_serializer::_variant_to_binary(const type_name& type, const fc::variant& var
             int64_t i = 0;
             for(const auto& var : vars) {
                 ctx.set_array_index_of_path_back(i);
-                _variant_to_binary(fundamental_type(rtype), var, ds, ctx);
+                _variant_to_binary(*plan.element, var, ds, ctx);
                 ++i;
             }
         }
-        else if(is_optional(rtype)) {
+        else if(plan.kind == type_plan::kOptional) {
             char flag = 1;
             if(var.is_null()) {
                 flag = 0;
             }
             fc::raw::pack(ds, flag);
             if(flag) {
-                _variant_to_binary(fundamental_type(rtype), var, ds, ctx);
+                _variant_to_binary(*plan.element, var, ds, ctx);
             }
         }
-        else if(is_variant(rtype)) {
-            auto v_itr = variants_.find(rtype);
+        else if(plan.kind == type_plan::kVariant) {
+            auto& v_itr = plan.v_itr;
             ctx.hint_variant_type_if_in_array(v_itr);
 
             auto& vt = v_itr->second; 
@@ -526,10 +1662,10 @@ abi_serializer::_variant_to_binary(const type_name& type, const fc::variant& var
             fc::raw::pack(ds, (fc::unsigned_int)index);
 
             auto h1 = ctx.push_to_path(impl::variant_path_item{.parent_itr = v_itr, .index = index});
-            _variant_to_binary(vt.fields[index].type, vo["data"], ds, ctx);
+            _variant_to_binary(*plan.fields[index].type, vo["data"], ds, ctx);
         }
-        else if(is_enum(rtype)) {
-            auto e_itr = enums_.find(rtype);
+        else if(plan.kind == type_plan::kEnum) {
+            auto& e_itr = plan.e_itr;
             ctx.hint_enum_type_if_in_array(e_itr);
 
             auto& et = e_itr->second;
@@ -544,28 +1680,29 @@ abi_serializer::_variant_to_binary(const type_name& type, const fc::variant& var
             }
             EVT_ASSERT2(index < et.fields.size(), pack_exception, "Invalid value of enum '{}'", ctx.get_path_string());
 
-            _variant_to_binary(et.integer, fc::variant(index), ds, ctx);
+            _variant_to_binary(*plan.element, fc::variant(index), ds, ctx);
         }
-        else if(is_struct(rtype)) {
-            auto s_itr = structs_.find(rtype);
+        else if(plan.kind == type_plan::kStruct) {
+            auto& s_itr = plan.s_itr;
             ctx.hint_struct_type_if_in_array(s_itr);
 
             auto& st = s_itr->second;
             if(var.is_object()) {
                 const auto& vo = var.get_object();
 
-                if(st.base != type_name()) {
-                    _variant_to_binary(resolve_type(st.base), var, ds, ctx);
+                if(plan.base != nullptr) {
+                    _variant_to_binary(*plan.base, var, ds, ctx);
                 }
                 for(uint32_t i = 0; i < st.fields.size(); ++i) {
                     const auto& field = st.fields[i];
+                    const auto& fop   = plan.fields[i];
                     if(vo.contains(string(field.name).c_str())) {
                         auto h1 = ctx.push_to_path(impl::field_path_item{.parent_itr = s_itr, .field_ordinal = i});
-                        _variant_to_binary(field.type, vo[field.name], ds, ctx);
+                        _variant_to_binary(*fop.type, vo[field.name], ds, ctx);
                     }
-                    else if(is_optional(field.type)) {
+                    else if(fop.is_optional) {
                         auto h1 = ctx.push_to_path(impl::field_path_item{.parent_itr = s_itr, .field_ordinal = i});
-                        _variant_to_binary(field.type, fc::variant(), ds, ctx);
+                        _variant_to_binary(*fop.type, fc::variant(), ds, ctx);
                     }
                     else {
                         EVT_THROW(pack_exception, "Missing field '${f}' in input object while processing struct '${p}'",
@@ -582,7 +1719,7 @@ abi_serializer::_variant_to_binary(const type_name& type, const fc::variant& var
                     const auto& field = st.fields[i];
                     if(va.size() > i) {
                         auto h1 = ctx.push_to_path(impl::field_path_item{.parent_itr = s_itr, .field_ordinal = i});
-                        _variant_to_binary(field.type, va[i], ds, ctx);
+                        _variant_to_binary(*plan.fields[i].type, va[i], ds, ctx);
                     }
                     else {
                         EVT_THROW(pack_exception, "Early end to input array specifying the fields of struct '${p}'; require input for field '${f}'",
@@ -607,10 +1744,22 @@ abi_serializer::_variant_to_binary(const type_name& type, const fc::variant& var
         auto h = ctx.enter_scope();
         EVT_ASSERT2(_is_type(type), unknown_abi_type_exception, "Unknown type: {} in ABI", type);
 
+        auto plans = type_plans();
+        return _variant_to_binary(build_plan(type, plans), var, ctx);
+    }
+    FC_CAPTURE_AND_RETHROW((type)(var))
+}
+
+bytes
+abi_serializer::_variant_to_binary(const type_plan& plan, const fc::variant& var, impl::variant_to_binary_context& ctx) const {
+    const auto& type = plan.name;
+    try {
+        auto h = ctx.enter_scope();
+
         auto temp = bytes(1024 * 1024);
         auto ds   = fc::datastream<char*>(temp.data(), temp.size());
 
-        _variant_to_binary(type, var, ds, ctx);
+        _variant_to_binary(plan, var, ds, ctx);
         temp.resize(ds.tellp());
         return temp;
     }
@@ -631,6 +1780,28 @@ abi_serializer::variant_to_binary(const type_name& type, const fc::variant& var,
     _variant_to_binary(type, var, ds, ctx);
 }
 
+bytes
+abi_serializer::json_to_binary(const type_name& type, const std::string& json, const execution_context& exec_ctx, bool short_path) const {
+    if(_is_type(type)) {
+        auto packer = impl::json_packer(*this, exec_ctx, false /* trx_mode */);
+        if(packer.pack(type, json)) {
+            return std::move(packer.out);
+        }
+    }
+    // errors are also reported in this way
+    return variant_to_binary(type, fc::json::from_string(json), exec_ctx, short_path);
+}
+
+bool
+abi_serializer::json_to_packed_transactions(const std::string& json, bool batch, std::vector<packed_transaction>& ptrxs, const execution_context& exec_ctx) const {
+    auto packer = impl::json_packer(*this, exec_ctx, true /* trx_mode */);
+    if(!packer.parse_trxs(json, batch)) {
+        return false;
+    }
+    ptrxs = std::move(packer.ptrxs);
+    return true;
+}
+
 namespace impl {
 
 void
@@ -649,7 +1820,9 @@ abi_traverse_context::enter_scope() {
     EVT_ASSERT(recursion_depth < abi_serializer::max_recursion_depth, abi_recursion_depth_exception,
                "recursive definition, max_recursion_depth ${r} ", ("r", abi_serializer::max_recursion_depth));
 
-    check_deadline();
+    if(deadline != std::chrono::steady_clock::time_point::max() && (scopes_entered++ % kDeadlineCheckInterval) == 0) {
+        check_deadline();
+    }
 
     return {std::move(callback)};
 }
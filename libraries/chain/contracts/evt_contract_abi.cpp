@@ -491,6 +491,15 @@ evt_contract_abi() {
         }
     });
 
+    evt_abi.structs.emplace_back( struct_def {
+        "distpsvbonus_v2", "", {
+           {"sym_id", "symbol_id_type"},
+           {"deadline", "time_point"},
+           {"final_receiver", "address?"},
+           {"max_holders", "uint32"}
+        }
+    });
+
     // abi_def fields
     evt_abi.structs.emplace_back( struct_def {
         "field_def", "", {
@@ -6,56 +6,162 @@
 
 #include <string.h>
 #include <algorithm>
+#include <string_view>
 
-#include <boost/multiprecision/cpp_int.hpp>
 #include <boost/endian/conversion.hpp>
 
 #include <fc/crypto/hex.hpp>
 #include <fc/crypto/elliptic.hpp>
 #include <evt/chain/exceptions.hpp>
 
-using namespace boost::multiprecision;
+namespace evt { namespace chain { namespace contracts {
+
+namespace internal {
+
+constexpr char ALPHABETS[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ$+-/:*";
+const int      MAX_BYTES   = 240;  // 195 / ((42 ^ 2) / 2048)
+const int      MAX_LENGTH  = 400;  // max length of EVT-Link
+const char*    URI_SCHEMA  = "https://evt.li/";
 
 // pay: 2(header) + 5(time) + 5(max_pay) + 7(symbol) + 16(link-id)  = 35
 // pass: 2(header) + 5(time) + 22(domain) + 22(token) + 16(link-id) = 67
 // sigs: 65 * 3 = 195
-using bigint_segs = number<cpp_int_backend<536, 536, unsigned_magnitude, checked, void>>;
-using bigint_sigs = number<cpp_int_backend<1560, 1560, unsigned_magnitude, checked, void>>;
+const size_t SEGS_MAX_BYTES = 67;
+const size_t SIGS_MAX_BYTES = 195;
+
+// 11 base42 digits are processed at once, 42 ^ 11 < 2 ^ 64
+const size_t   DIGITS_PER_LIMB = 11;
+const uint64_t LIMB_BASE       = 717368321110468608ull;
+
+struct base42_table {
+    constexpr base42_table()
+        : values() {
+        for(auto i = 0; i < 256; i++) {
+            values[i] = -1;
+        }
+        for(auto i = 0; i < 42; i++) {
+            values[(uint8_t)ALPHABETS[i]] = i;
+        }
+    }
 
-namespace evt { namespace chain { namespace contracts {
+    int8_t values[256];
+};
 
-namespace internal {
+constexpr auto BASE42_TABLE = base42_table();
+
+// fixed-size unsigned integer of 64-bit limbs (little-endian), just enough for base42 conversion
+template<size_t MaxBytes>
+class base42_num {
+public:
+    static const size_t MAX_LIMBS = (MaxBytes + 7) / 8;
+
+public:
+    bool empty() const { return n_ == 0; }
+
+    // this = this * mul + add
+    void
+    mul_add(uint64_t mul, uint64_t add) {
+        auto carry = add;
+        for(auto i = 0u; i < n_; i++) {
+            auto p    = (uint128_t)limbs_[i] * mul + carry;
+            limbs_[i] = (uint64_t)p;
+            carry     = (uint64_t)(p >> 64);
+        }
+        if(carry) {
+            EVT_ASSERT(n_ < MAX_LIMBS, evt_link_exception, "EVT-Link is too long");
+            limbs_[n_++] = carry;
+        }
+    }
+
+    // this = this / div, returns the remainder
+    uint64_t
+    div_mod(uint64_t div) {
+        auto rem = (uint64_t)0;
+        for(auto i = n_; i-- > 0;) {
+            auto cur  = ((uint128_t)rem << 64) | limbs_[i];
+            limbs_[i] = (uint64_t)(cur / div);
+            rem       = (uint64_t)(cur % div);
+        }
+        while(n_ > 0 && limbs_[n_ - 1] == 0) {
+            n_--;
+        }
+        return rem;
+    }
+
+    size_t
+    byte_size() const {
+        if(n_ == 0) {
+            return 0;
+        }
+        return (n_ - 1) * 8 + (64 - __builtin_clzll(limbs_[n_ - 1]) + 7) / 8;
+    }
+
+    void
+    read_be(const char* b, size_t sz) {
+        FC_ASSERT(sz <= MaxBytes, "Data is too large to be encoded in EVT-Link");
+        n_ = (sz + 7) / 8;
+        for(auto i = 0u; i < n_; i++) {
+            limbs_[i] = 0;
+        }
+        for(auto i = 0u; i < sz; i++) {
+            auto pos = sz - 1 - i;  // from the least significant byte
+            limbs_[pos / 8] |= (uint64_t)(uint8_t)b[i] << (pos % 8 * 8);
+        }
+        while(n_ > 0 && limbs_[n_ - 1] == 0) {
+            n_--;
+        }
+    }
 
-const char* ALPHABETS  = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ$+-/:*";
-const int   MAX_BYTES  = 240;  // 195 / ((42 ^ 2) / 2048)
-const char* URI_SCHEMA = "https://evt.li/";
-
-template<typename T>
-bytes
-decode(const std::string& nums, uint pos, uint end) {
-    auto num = T{0};
-    auto pz  = nums.find_first_not_of('0', pos);
-    EVT_ASSERT(pz != string::npos, evt_link_exception, "Invalid EVT-Link");
-
-    for(auto i = pz; i < end; i++) {
-        auto c = strchr(ALPHABETS, nums[i]);
-        FC_ASSERT(c != nullptr, "invalid character in evt-link");
-        num *= 42;
-        num += (c - ALPHABETS);
+    void
+    write_be(char* b) const {
+        auto sz = byte_size();
+        for(auto i = 0u; i < sz; i++) {
+            auto pos = sz - 1 - i;
+            b[i] = (char)(limbs_[pos / 8] >> (pos % 8 * 8));
+        }
     }
 
-    auto b = bytes();
-    b.reserve(MAX_BYTES);
-    for(auto i = 0u; i < (pz - pos); i++) {
-        b.emplace_back(0);
+private:
+    uint64_t limbs_[MAX_LIMBS];
+    size_t   n_ = 0;
+};
+
+// decodes base42 string in [pos, end) into `out`, which has at least MAX_LENGTH bytes.
+// every leading '0' becomes one zero byte, returns the number of bytes written
+template<size_t MaxBytes>
+size_t
+decode(const std::string& nums, size_t pos, size_t end, char* out) {
+    auto pz = pos;
+    while(pz < end && nums[pz] == '0') {
+        pz++;
     }
-    boost::multiprecision::export_bits(num, std::back_inserter(b), 8);
+    EVT_ASSERT(pz < end, evt_link_exception, "Invalid EVT-Link");
+
+    auto num = base42_num<MaxBytes>();
+    for(auto i = pz; i < end; i += DIGITS_PER_LIMB) {
+        auto k   = std::min(end - i, DIGITS_PER_LIMB);
+        auto v   = (uint64_t)0;
+        auto mul = (uint64_t)1;
+        for(auto j = 0u; j < k; j++) {
+            auto d = BASE42_TABLE.values[(uint8_t)nums[i + j]];
+            FC_ASSERT(d >= 0, "invalid character in evt-link");
+            v   = v * 42 + d;
+            mul = mul * 42;
+        }
+        num.mul_add(mul, v);
+    }
+
+    auto zeros = pz - pos;
+    auto sz    = num.byte_size();
+    EVT_ASSERT(sz <= MaxBytes && zeros + sz <= (size_t)MAX_LENGTH, evt_link_exception, "EVT-Link is too long");
 
-    return b;
+    memset(out, 0, zeros);
+    num.write_be(out + zeros);
+    return zeros + sz;
 }
 
 evt_link::segments_type
-parse_segments(const bytes& b, uint16_t& header) {
+parse_segments(std::string_view b, uint16_t& header) {
     FC_ASSERT(b.size() > 2);
 
     auto h  = *(uint16_t*)&b[0];
@@ -123,7 +229,7 @@ parse_segments(const bytes& b, uint16_t& header) {
 }
 
 evt_link::signatures_type
-parse_signatures(const bytes& b) {
+parse_signatures(std::string_view b) {
     FC_ASSERT(b.size() > 0 && b.size() % 65 == 0);
     auto sigs = evt_link::signatures_type();
 
@@ -152,16 +258,17 @@ evt_link::parse_from_evtli(const std::string& str) {
     }
 
     auto d = str.find_first_of('_', start);
-    
-    auto bsegs = bytes();
-    auto bsigs = bytes();
+
+    char segs_buf[MAX_LENGTH], sigs_buf[MAX_LENGTH];
+    auto bsegs = std::string_view();
+    auto bsigs = std::string_view();
 
     if(d == std::string::npos) {
-        bsegs = decode<bigint_segs>(str, start, str.size());
+        bsegs = std::string_view(segs_buf, decode<SEGS_MAX_BYTES>(str, start, str.size(), segs_buf));
     }
     else {
-        bsegs = decode<bigint_segs>(str, start, d);
-        bsigs = decode<bigint_sigs>(str, d + 1, str.size());
+        bsegs = std::string_view(segs_buf, decode<SEGS_MAX_BYTES>(str, start, d, segs_buf));
+        bsigs = std::string_view(sigs_buf, decode<SIGS_MAX_BYTES>(str, d + 1, str.size(), sigs_buf));
     }
 
     auto link = evt_link();
@@ -264,29 +371,35 @@ write_signatures_bytes(const evt_link& link, Stream& stream) {
     }
 }
 
-template<typename Num>
+template<size_t MaxBytes>
 void
-encode(const bytes& b, size_t sz, std::string& str) {
+encode(const char* b, size_t sz, std::string& str) {
     auto i = 0u;
-    for(i = 0u; i < sz; i++) {
-        if(b[i] == 0) {
-            str.push_back('0');
-        }
-        else {
-            break;
-        }
+    while(i < sz && b[i] == 0) {
+        str.push_back('0');
+        i++;
     }
 
-    auto num = Num{0};
-    boost::multiprecision::import_bits(num, b.begin() + i, b.begin() + sz, 8);
-
-    while(num >= 42) {
-        auto r = num % 42;
-        str.push_back(*(ALPHABETS + (int)r));
-        num /= 42;
+    auto num = base42_num<MaxBytes>();
+    num.read_be(b + i, sz - i);
+
+    // digits are produced from the least significant one
+    char digits[MaxBytes * 8 / 5 + DIGITS_PER_LIMB];
+    auto n = 0u;
+    while(!num.empty()) {
+        auto r = num.div_mod(LIMB_BASE);
+        for(auto j = 0u; j < DIGITS_PER_LIMB; j++) {
+            digits[n++] = ALPHABETS[r % 42];
+            r /= 42;
+        }
+    }
+    while(n > 0 && digits[n - 1] == '0') {
+        n--;
     }
-    str.push_back(*(ALPHABETS + (int)num));
-    std::reverse(str.begin() + i, str.end());
+    if(n == 0) {
+        digits[n++] = '0';
+    }
+    std::reverse_copy(digits, digits + n, std::back_inserter(str));
 }
 
 }  // namespace internal
@@ -304,43 +417,44 @@ std::string
 evt_link::to_string(int prefix) const {
     using namespace internal;
 
-    auto temp = bytes(MAX_BYTES);
-    auto ds   = fc::datastream<char*>(temp.data(), temp.size());
-    auto str  = string();
+    char temp[MAX_BYTES];
+    auto ds  = fc::datastream<char*>(temp, sizeof(temp));
+    auto str = string();
 
+    str.reserve(MAX_LENGTH);
     if(prefix) {
         str.append(URI_SCHEMA);
     }
 
-    auto str1 = string();
     write_segments_bytes(*this, ds);
-    encode<bigint_segs>(temp, ds.tellp(), str1);
-    str.append(str1);
+    encode<SEGS_MAX_BYTES>(temp, ds.tellp(), str);
 
     if(!signatures_.empty()) {
         str.push_back('_');
 
         ds.seekp(0);
         write_signatures_bytes(*this, ds);
-
-        auto str2 = string();
-        encode<bigint_sigs>(temp, ds.tellp(), str2);
-        str.append(str2);
+        encode<SIGS_MAX_BYTES>(temp, ds.tellp(), str);
     }
 
     return str;
 }
 
-public_keys_set
+const public_keys_set&
 evt_link::restore_keys() const {
     auto hash = digest();
-    auto keys = public_keys_set();
+    if(restored_keys_.has_value() && restored_keys_->digest == hash && restored_keys_->signatures == signatures_) {
+        return restored_keys_->keys;
+    }
 
+    auto keys = public_keys_set();
     keys.reserve(signatures_.size());
     for(auto& sig : signatures_) {
         keys.emplace(public_key_type(sig, hash));
     }
-    return keys;
+
+    restored_keys_.emplace(restored_keys { hash, signatures_, std::move(keys) });
+    return restored_keys_->keys;
 }
 
 void
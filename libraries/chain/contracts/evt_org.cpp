@@ -26,6 +26,20 @@ initialize_evt_org(token_database& tokendb, const genesis_state& genesis) {
         auto v2 = make_db_value(genesis.get_pevt_ft());
         tokendb.put_token(token_type::fungible, action_op::add, std::nullopt, PEVT_SYM_ID, v2.as_string_view());
 
+        for(auto& ftg : { genesis.evt, genesis.pevt }) {
+            if(ftg.metas.empty()) {
+                continue;
+            }
+
+            auto ms   = meta_set();
+            ms.domain = N128(.fungible);
+            ms.key    = name128::from_number(ftg.sym.id());
+            ms.metas  = ftg.metas;
+
+            auto vm = make_db_value(ms);
+            tokendb.put_token(token_type::meta, action_op::add, std::nullopt, get_meta_db_key(ms.domain, ms.key), vm.as_string_view());
+        }
+
         auto addr = address(N(.fungible), name128::from_number(EVT_SYM_ID), 0);
         auto prop = property {
                         .amount = genesis.evt.total_supply.amount(),
@@ -4,19 +4,36 @@
  */
 #include <evt/chain/controller.hpp>
 
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <sys/mman.h>
+
 #include <chainbase/chainbase.hpp>
 #include <fmt/format.h>
 
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+
 #include <fc/io/json.hpp>
 #include <fc/scoped_exit.hpp>
 #include <fc/variant_object.hpp>
 
+#include <evt/chain/action_profiler.hpp>
 #include <evt/chain/authority_checker.hpp>
 #include <evt/chain/block_log.hpp>
 #include <evt/chain/charge_manager.hpp>
 #include <evt/chain/chain_snapshot.hpp>
 #include <evt/chain/execution_context_impl.hpp>
 #include <evt/chain/fork_database.hpp>
+#include <evt/chain/recovered_keys_cache.hpp>
+#include <evt/chain/irreversible_blocks_cache.hpp>
 #include <evt/chain/snapshot.hpp>
 #include <evt/chain/token_database.hpp>
 #include <evt/chain/token_database_cache.hpp>
@@ -30,8 +47,12 @@
 #include <evt/chain/global_property_object.hpp>
 #include <evt/chain/transaction_object.hpp>
 #include <evt/chain/reversible_block_object.hpp>
+#include <evt/chain/reversible_block_log.hpp>
 #include <evt/chain/contracts/evt_link_object.hpp>
 
+#include <evt/utilities/thread_affinity.hpp>
+#include <evt/utilities/trace.hpp>
+
 namespace evt { namespace chain {
 
 using controller_index_set = index_set<
@@ -41,6 +62,131 @@ using controller_index_set = index_set<
    transaction_multi_index
 >;
 
+namespace internal {
+
+// logs how long one phase of startup takes, phases may run in parallel
+struct startup_phase {
+    startup_phase(const char* name)
+        : name(name), begin(fc::time_point::now()) {}
+
+    ~startup_phase() {
+        ilog("Startup phase: ${p} took ${t} ms", ("p",name)("t",(fc::time_point::now() - begin).count() / 1000));
+    }
+
+    const char*    name;
+    fc::time_point begin;
+};
+
+// advises huge pages, faults in and locks the mapping of one chainbase database, so the first blocks
+// after restart don't stall on page faults. segment manager is placed at the start of the mapping
+void
+warm_up_mapping(const char* name, database& db, const controller::config& cfg) {
+    auto sm   = db.get_segment_manager();
+    auto base = (char*)sm;
+    auto size = (size_t)sm->get_size();
+
+#ifdef MADV_HUGEPAGE
+    if(cfg.state_huge_pages && madvise(base, size, MADV_HUGEPAGE) != 0) {
+        // page cache is only backed by huge pages when the file is on tmpfs or hugetlbfs
+        wlog("Cannot advise huge pages for ${n}: ${e}", ("n",name)("e",strerror(errno)));
+    }
+#endif
+
+    if(cfg.state_prefault_threads > 0) {
+        const size_t kPageSize  = 4096;
+        const size_t kChunkSize = 64 * 1024 * 1024;
+
+        madvise(base, size, MADV_WILLNEED);
+
+        auto next    = std::atomic<size_t>(0);
+        auto done    = std::atomic<size_t>(0);
+        auto threads = std::vector<std::thread>();
+        for(auto i = 0u; i < cfg.state_prefault_threads; i++) {
+            threads.emplace_back([&] {
+                auto p    = (volatile const char*)base;
+                auto sink = 0;
+                while(true) {
+                    auto begin = next.fetch_add(kChunkSize);
+                    if(begin >= size) {
+                        break;
+                    }
+                    auto end = std::min(begin + kChunkSize, size);
+                    for(auto j = begin; j < end; j += kPageSize) {
+                        sink += p[j];
+                    }
+                    done += end - begin;
+                }
+                (void)sink;
+            });
+        }
+
+        auto start    = fc::time_point::now();
+        auto last_log = start;
+        while(done.load() < size) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            auto now = fc::time_point::now();
+            if(now - last_log >= fc::seconds(5)) {
+                ilog("Warming up ${n}: ${p}%", ("n",name)("p",done.load() * 100 / size));
+                last_log = now;
+            }
+        }
+        for(auto& t : threads) {
+            t.join();
+        }
+        ilog("Warmed up ${n} of ${s} MiB in ${t} ms", ("n",name)("s",size / 1024 / 1024)("t",(fc::time_point::now() - start).count() / 1000));
+    }
+
+    if(cfg.state_mlock && mlock(base, size) != 0) {
+        wlog("Cannot lock ${n} in memory: ${e}, RLIMIT_MEMLOCK may be too low", ("n",name)("e",strerror(errno)));
+    }
+}
+
+// keys of the tokens which are very likely read when `trx` is applied, they're resolved only by the
+// domain and key of the actions so that there's no need to unpack the action data here
+void
+collect_prefetch_keys(const transaction& trx, prefetch_keys_t& keys) {
+    for(auto& act : trx.actions) {
+        if(act.domain == N128(.group)) {
+            keys.tokens.emplace_back(token_type::group, std::nullopt, act.key);
+        }
+        else if(act.domain == N128(.fungible)) {
+            keys.tokens.emplace_back(token_type::fungible, std::nullopt, act.key);
+        }
+        else if(act.domain == N128(.suspend)) {
+            keys.tokens.emplace_back(token_type::suspend, std::nullopt, act.key);
+        }
+        else if(act.domain == N128(.lock)) {
+            keys.tokens.emplace_back(token_type::lock, std::nullopt, act.key);
+        }
+        else if(!act.domain.reserved()) {
+            keys.tokens.emplace_back(token_type::domain, std::nullopt, act.domain);
+            if(!act.key.reserved()) {
+                keys.tokens.emplace_back(token_type::token, act.domain, act.key);
+            }
+        }
+    }
+
+    // balances of payer for charging
+    keys.assets.emplace_back(trx.payer, PEVT_SYM_ID);
+    keys.assets.emplace_back(trx.payer, EVT_SYM_ID);
+}
+
+// inverse of `token_database::get_db_key`, only tokens are stored under the prefixes of their domains
+std::pair<std::optional<name128>, name128>
+split_hot_key(const token_database_cache::hot_key& hk) {
+    auto prefix = name128();
+    auto key    = name128();
+    memcpy(&prefix, hk.key.data(), sizeof(name128));
+    memcpy(&key, hk.key.data() + sizeof(name128), sizeof(name128));
+
+    if(hk.type == token_type::token) {
+        return { prefix, key };
+    }
+    return { std::nullopt, key };
+}
+
+}  // namespace internal
+
 class maybe_session {
 public:
     maybe_session() = default;
@@ -119,11 +265,12 @@ struct pending_state {
     pending_state(pending_state&& ps)
         : _db_session(move(ps._db_session)) {}
 
-    maybe_session                   _db_session;
-    block_state_ptr                 _pending_block_state;
-    small_vector<action_receipt, 4> _actions;
-    controller::block_status        _block_status = controller::block_status::incomplete;
-    optional<block_id_type>         _producer_block_id;
+    maybe_session                      _db_session;
+    block_state_ptr                    _pending_block_state;
+    small_vector<action_receipt, 4>    _actions;
+    std::vector<transaction_trace_ptr> _traces;  // only collected when block traces are subscribed
+    controller::block_status           _block_status = controller::block_status::incomplete;
+    optional<block_id_type>            _producer_block_id;
 
     void
     push() {
@@ -133,14 +280,19 @@ struct pending_state {
 
 struct controller_impl {
     controller&              self;
+    fc::time_point           startup_begin = fc::time_point::now();
     chainbase::database      db;
     chainbase::database      reversible_blocks; ///< a special database to persist blocks that have successfully been applied but are still reversible
+    std::optional<reversible_block_log> reversible_log;  ///< used instead of `reversible_blocks` when `reversible_blocks_log` is set
     block_log                blog;
     optional<pending_state>  pending;
     block_state_ptr          head;
-    fork_database            fork_db;
     token_database           token_db;
     token_database_cache     token_db_cache;
+    std::future<void>        token_db_opening;    // started before fork db is loaded, waited in init()
+    std::future<std::unique_ptr<abi_serializer>> system_api_loading;
+    std::once_flag           system_api_once;
+    fork_database            fork_db;
     controller::config       conf;
     chain_id_type            chain_id;
     evt_execution_context    exec_ctx;
@@ -152,7 +304,21 @@ struct controller_impl {
     bool                     in_trx_requiring_checks = false; ///< if true, checks that are normally skipped on replay (e.g. auth checks) cannot be skipped
     bool                     trusted_producer_light_validation = false;
     uint32_t                 snapshot_head_block = 0;
-    abi_serializer           system_api;
+    std::unique_ptr<abi_serializer> system_api;
+
+    std::optional<boost::asio::thread_pool> prefetch_pool;
+    std::atomic<int>                        prefetch_pending = 0;
+    std::optional<boost::asio::thread_pool> signature_pool;
+    std::atomic<int>                        signature_pending = 0;  // transactions of blocks ahead waiting for recovering
+    std::optional<boost::asio::thread_pool> traces_thread;          // delivers async block traces, made once subscribed
+    recovered_keys_cache                    keys_cache;
+    irreversible_blocks_cache               blocks_cache;
+
+    std::vector<token_database_cache::hot_key> hot_keys;  // loaded on startup, cleared after cache is warmed
+    std::future<void>                          hot_keys_prefetch;
+
+    db_value_arena value_arena;  // values packed when transactions are applied
+    action_profiler profiler;
 
     /**
      *  Transactions that were undone by pop_block or abort_block, transactions
@@ -166,14 +332,17 @@ struct controller_impl {
         auto prev = fork_db.get_block(head->header.previous);
         EVT_ASSERT(prev, block_validate_exception, "attempt to pop beyond last irreversible block");
 
-        if(const auto* b = reversible_blocks.find<reversible_block_object,by_num>(head->block_num)) {
+        if(reversible_log.has_value()) {
+            reversible_log->remove_from(head->block_num);
+        }
+        else if(const auto* b = reversible_blocks.find<reversible_block_object,by_num>(head->block_num)) {
             reversible_blocks.remove(*b);
         }
 
         if(read_mode == db_read_mode::SPECULATIVE) {
             EVT_ASSERT(head->block, block_validate_exception, "attempting to pop a block that was sparsely loaded from a snapshot");
             for(const auto& t : head->trxs) {
-                unapplied_transactions[t->signed_id] = t;
+                unapplied_transactions[t->signed_id()] = t;
             }
         }
         head = prev;
@@ -189,22 +358,79 @@ struct controller_impl {
         , reversible_blocks(cfg.blocks_dir / config::reversible_blocks_dir_name,
              cfg.read_only ? database::read_only : database::read_write,
              cfg.reversible_cache_size)
-        , blog(cfg.blocks_dir)
-        , fork_db(cfg.state_dir)
+        , blog(cfg.blocks_dir, block_log_config {
+              .stride            = cfg.blocks_log_stride,
+              .max_retained      = cfg.max_retained_block_files,
+              .retained_dir      = cfg.blocks_retained_dir,
+              .archive_dir       = cfg.blocks_archive_dir,
+              .compress_retained = cfg.compress_retained_blocks,
+              .async_append      = cfg.async_blocks_log,
+              .max_pending       = cfg.blocks_log_max_pending,
+              .sync_interval     = cfg.blocks_log_sync_interval,
+              .recovery_threads  = cfg.blocks_recovery_threads })
         , token_db(cfg.db_config)
-        , token_db_cache(token_db, cfg.db_config.object_cache_size)
+        , token_db_cache(token_db, cfg.db_config.object_cache_size, cfg.db_config.cache_write_back)
+        , token_db_opening(std::async(std::launch::async, [this] {
+              auto phase = internal::startup_phase("open token database");
+              token_db.open();
+          }))
+        , system_api_loading(std::async(std::launch::async, [max = cfg.max_serialization_time] {
+              auto phase = internal::startup_phase("construct system abi");
+              return std::make_unique<abi_serializer>(contracts::evt_contract_abi(), max);
+          }))
+        , fork_db(cfg.state_dir, cfg.fork_db_journal)
         , conf(cfg)
         , chain_id(cfg.genesis.compute_chain_id())
         , exec_ctx(s)
         , read_mode(cfg.read_mode)
-        , system_api(contracts::evt_contract_abi(), cfg.max_serialization_time) {
+        , keys_cache(cfg.signature_cache_size)
+        , blocks_cache(cfg.blocks_cache_size)
+        , profiler(cfg.profile_actions) {
 
         fork_db.irreversible.connect([&](auto b) {
             on_irreversible(b);
         });
+        ilog("Startup phase: open chain state and load fork database took ${t} ms", ("t",(fc::time_point::now() - startup_begin).count() / 1000));
+
+        if(cfg.state_huge_pages || cfg.state_mlock || cfg.state_prefault_threads > 0) {
+            internal::warm_up_mapping("chain state", db, cfg);
+            internal::warm_up_mapping("reversible blocks", reversible_blocks, cfg);
+        }
+
+        if(cfg.reversible_blocks_log && !cfg.read_only) {
+            reversible_log.emplace(cfg.blocks_dir / config::reversible_blocks_dir_name, true /* async */);
+        }
+        if(cfg.prefetch_threads > 0) {
+            auto scope = utilities::affinity::pool_scope("prefetch");
+            prefetch_pool.emplace(cfg.prefetch_threads);
+        }
+        if(cfg.signature_threads > 0) {
+            auto scope = utilities::affinity::pool_scope("signature");
+            signature_pool.emplace(cfg.signature_threads);
+        }
     }
 
     ~controller_impl() {
+        if(token_db_opening.valid()) {
+            // never started, the hot keys below are saved from the token database
+            token_db_opening.wait();
+        }
+        if(hot_keys_prefetch.valid()) {
+            hot_keys_prefetch.wait();
+        }
+        save_hot_keys();
+        if(traces_thread.has_value()) {
+            traces_thread->join();
+        }
+        // workers of signatures may post prefetches, join them first
+        if(signature_pool.has_value()) {
+            signature_pool->join();
+        }
+        if(prefetch_pool.has_value()) {
+            // pending prefetches are useless now
+            prefetch_pool->stop();
+            prefetch_pool->join();
+        }
         pending.reset();
         db.flush();
         reversible_blocks.flush();
@@ -271,15 +497,32 @@ struct controller_impl {
         db.commit(s->block_num);
         token_db.pop_savepoints(s->block_num);
 
+        // record hot keys periodically in case node isn't shutdown cleanly
+        const uint32_t kHotKeysSaveInterval = 10000;
+        if(s->block_num % kHotKeysSaveInterval == 0) {
+            save_hot_keys();
+        }
+
         if(append_to_blog) {
-            blog.append(s->block);
+            // position is only unknown when the block is written in background
+            auto pos = blog.append(s->block);
+            EVT_ASSERT(pos != block_log::npos || conf.async_blocks_log, block_log_append_fail,
+                       "Append block: ${n} into block log failed", ("n", s->block_num));
+        }
+        if(s->block) {
+            blocks_cache.put(s->block);
         }
 
-        const auto& ubi    = reversible_blocks.get_index<reversible_block_index, by_num>();
-        auto        objitr = ubi.begin();
-        while(objitr != ubi.end() && objitr->blocknum <= s->block_num) {
-            reversible_blocks.remove(*objitr);
-            objitr = ubi.begin();
+        if(reversible_log.has_value()) {
+            reversible_log->remove_until(s->block_num);
+        }
+        else {
+            const auto& ubi    = reversible_blocks.get_index<reversible_block_index, by_num>();
+            auto        objitr = ubi.begin();
+            while(objitr != ubi.end() && objitr->blocknum <= s->block_num) {
+                reversible_blocks.remove(*objitr);
+                objitr = ubi.begin();
+            }
         }
 
         // the "head" block when a snapshot is loaded is virtual and has no block data, all of its effects
@@ -304,6 +547,9 @@ struct controller_impl {
             }
             emit(self.irreversible_block, s);
         }
+
+        // irreversible blocks are never popped, plugins lagging behind may hold the state for a long time
+        s->trim();
     }
 
     void
@@ -316,25 +562,107 @@ struct controller_impl {
         ilog("existing block log, attempting to replay from ${s} to ${n} blocks",
             ("s", fmt::format("{:n}", start_block_num))("n", fmt::format("{:n}", blog_head->block_num())));
 
-        auto start = fc::time_point::now();
-        while(auto next = blog.read_block_by_num(head->block_num + 1)) {
+        // blocks are read and unpacked in a separate thread, their tokens are prefetched and keys are
+        // recovered in background while current one is applied
+        const size_t kReplayReadAhead = 64;
+
+        // irreversible blocks are applied without any sessions, there's nothing could be rolled back
+        if(self.skip_db_sessions(controller::block_status::irreversible)) {
+            token_db.set_fast_writes(true);
+        }
+        auto reset_fast_writes = fc::make_scoped_exit([this] {
+            try {
+                token_db.set_fast_writes(false);
+            }
+            FC_LOG_AND_DROP();
+        });
+
+        auto start  = fc::time_point::now();
+        auto reader = block_log_reader(blog, start_block_num);
+
+        auto ahead    = std::deque<signed_block_ptr>();
+        auto mutex    = std::mutex();
+        auto cv       = std::condition_variable();
+        auto done     = false;
+        auto stopped  = false;
+        auto read_exc = std::exception_ptr();
+
+        auto read_thread = std::thread([&] {
+            try {
+                while(auto b = reader.read_next()) {
+                    prefetch_block(b);
+                    recover_block_keys(b);
+
+                    auto lock = std::unique_lock<std::mutex>(mutex);
+                    cv.wait(lock, [&] { return stopped || ahead.size() < kReplayReadAhead; });
+                    if(stopped) {
+                        break;
+                    }
+                    ahead.emplace_back(std::move(b));
+                    cv.notify_all();
+                }
+            }
+            catch(...) {
+                read_exc = std::current_exception();
+            }
+
+            auto lock = std::lock_guard<std::mutex>(mutex);
+            done = true;
+            cv.notify_all();
+        });
+        auto stop_read_thread = fc::make_scoped_exit([&] {
+            {
+                auto lock = std::lock_guard<std::mutex>(mutex);
+                stopped = true;
+                cv.notify_all();
+            }
+            read_thread.join();
+        });
+
+        while(true) {
+            auto next = signed_block_ptr();
+            {
+                auto lock = std::unique_lock<std::mutex>(mutex);
+                cv.wait(lock, [&] { return done || !ahead.empty(); });
+                if(ahead.empty()) {
+                    break;
+                }
+                next = std::move(ahead.front());
+                ahead.pop_front();
+                cv.notify_all();
+            }
+
             replay_push_block(next, controller::block_status::irreversible);
             if(next->block_num() % 500 == 0) {
                 ilog2_("{:n} of {:n}", next->block_num(), blog_head->block_num());
             }
         }
+        if(read_exc) {
+            std::rethrow_exception(read_exc);
+        }
         std::cerr << "\n";
         ilog("${n} blocks replayed", ("n", fmt::format("{:n}", head->block_num - start_block_num)));
 
+        reset_fast_writes.cancel();
+        token_db.set_fast_writes(false);
+
         // if the irreversible log is played without undo sessions enabled, we need to sync the
         // revision ordinal to the appropriate expected value here.
         if(self.skip_db_sessions(controller::block_status::irreversible))
             db.set_revision(head->block_num);
 
         int rev = 0;
-        while(auto obj = reversible_blocks.find<reversible_block_object, by_num>(head->block_num + 1)) {
-            ++rev;
-            replay_push_block(obj->get_block(), controller::block_status::validated);
+        if(reversible_log.has_value()) {
+            while(auto b = reversible_log->read_block(head->block_num + 1)) {
+                ++rev;
+                replay_push_block(b, controller::block_status::validated);
+            }
+        }
+        else {
+            while(auto obj = reversible_blocks.find<reversible_block_object, by_num>(head->block_num + 1)) {
+                ++rev;
+                replay_push_block(obj->get_block(), controller::block_status::validated);
+            }
         }
 
         ilog("${n} reversible blocks replayed", ("n", fmt::format("{:n}", rev)));
@@ -349,9 +677,212 @@ struct controller_impl {
     }
 
 
+    void
+    save_hot_keys() {
+        // files in token database dir belong to the primary when it's opened as secondary
+        if(conf.cache_hot_keys == 0 || conf.read_only || token_db.is_secondary()) {
+            return;
+        }
+
+        auto keys     = token_db_cache.hot_keys(conf.cache_hot_keys);
+        auto filename = conf.db_config.db_path / config::token_database_hotkeys_filename;
+        auto tmpname  = conf.db_config.db_path / (std::string(config::token_database_hotkeys_filename) + ".tmp");
+
+        try {
+            auto fs = std::ofstream();
+            fs.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+            fs.open(tmpname.to_native_ansi_path(), (std::ios::out | std::ios::binary | std::ios::trunc));
+
+            fc::raw::pack(fs, fc::unsigned_int(keys.size()));
+            for(auto& hk : keys) {
+                fc::raw::pack(fs, (uint8_t)hk.type);
+                fc::raw::pack(fs, hk.key);
+            }
+
+            fs.flush();
+            fs.close();
+            fc::rename(tmpname, filename);
+        }
+        catch(...) {
+            // only a hint, failures should not affect the chain
+            wlog("Failed to save hot keys of token database cache");
+        }
+    }
+
+    void
+    load_hot_keys() {
+        auto filename = conf.db_config.db_path / config::token_database_hotkeys_filename;
+        if(conf.cache_hot_keys == 0 || !fc::exists(filename)) {
+            return;
+        }
+
+        try {
+            auto fs = std::ifstream();
+            fs.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+            fs.open(filename.to_native_ansi_path(), (std::ios::in | std::ios::binary));
+
+            auto sz = fc::unsigned_int();
+            fc::raw::unpack(fs, sz);
+
+            hot_keys.clear();
+            hot_keys.reserve(std::min(sz.value, conf.cache_hot_keys));
+            for(auto i = 0u; i < sz.value && i < conf.cache_hot_keys; i++) {
+                auto hk   = token_database_cache::hot_key();
+                auto type = uint8_t();
+                fc::raw::unpack(fs, type);
+                fc::raw::unpack(fs, hk.key);
+                if(type > (uint8_t)token_type::max_value || type == (uint8_t)token_type::asset) {
+                    continue;
+                }
+                hk.type = (token_type)type;
+                hot_keys.emplace_back(hk);
+            }
+        }
+        catch(...) {
+            // only a hint, node just starts cold without it
+            wlog("Failed to load hot keys of token database cache, ignored");
+            hot_keys.clear();
+            return;
+        }
+
+        // warm block cache of token database in background first, raw reads of db are thread safe
+        hot_keys_prefetch = std::async(std::launch::async, [this] {
+            const size_t kPrefetchBatchSize = 256;
+
+            auto keys = prefetch_keys_t();
+            for(auto i = 0u; i < hot_keys.size(); i++) {
+                auto [domain, key] = internal::split_hot_key(hot_keys[i]);
+                keys.tokens.emplace_back(hot_keys[i].type, domain, key);
+                if(keys.tokens.size() == kPrefetchBatchSize || i == hot_keys.size() - 1) {
+                    try {
+                        token_db.prefetch(keys);
+                    }
+                    catch(...) {}
+                    keys.tokens.clear();
+                }
+            }
+        });
+    }
+
+    // objects cache is not thread safe, hot objects are unpacked into cache here in main thread
+    // reads are the same as the ones when actions are applied, missed keys are cached as well
+    void
+    warm_token_db_cache() {
+        using namespace contracts;
+
+        if(!hot_keys_prefetch.valid()) {
+            return;
+        }
+        hot_keys_prefetch.wait();
+        hot_keys_prefetch = std::future<void>();
+
+        auto count = 0u;
+        for(auto& hk : hot_keys) {
+            auto [domain, key] = internal::split_hot_key(hk);
+            try {
+                switch(hk.type) {
+                case token_type::domain: {
+                    token_db_cache.read_token<domain_def>(hk.type, domain, key, true /* no throw */);
+                    break;
+                }
+                case token_type::token: {
+                    token_db_cache.read_token<token_def>(hk.type, domain, key, true /* no throw */);
+                    break;
+                }
+                case token_type::group: {
+                    token_db_cache.read_token<group_def>(hk.type, domain, key, true /* no throw */);
+                    break;
+                }
+                case token_type::suspend: {
+                    token_db_cache.read_token<suspend_def>(hk.type, domain, key, true /* no throw */);
+                    break;
+                }
+                case token_type::lock: {
+                    token_db_cache.read_token<lock_def>(hk.type, domain, key, true /* no throw */);
+                    break;
+                }
+                case token_type::fungible: {
+                    token_db_cache.read_token<fungible_def>(hk.type, domain, key, true /* no throw */);
+                    break;
+                }
+                default: {
+                    // values of other types are only warmed in block cache
+                    continue;
+                }
+                }  // switch
+                count++;
+            }
+            catch(...) {
+                // types of the keys maybe changed since they were recorded
+            }
+        }
+        ilog("Warmed token database cache with ${n} hot objects", ("n", count));
+        hot_keys.clear();
+        hot_keys.shrink_to_fit();
+    }
+
+    const abi_serializer&
+    get_system_api() {
+        // built in background since construction, plugins may ask for it before startup
+        std::call_once(system_api_once, [this] {
+            system_api = system_api_loading.get();
+            // types of actions are resolved once here, all the threads share this immutable instance afterwards
+            system_api->bind_actions(exec_ctx);
+        });
+        return *system_api;
+    }
+
+    // reversible blocks are moved between chainbase and the log when `reversible_blocks_log` is switched
+    void
+    migrate_reversible_blocks() {
+        if(conf.read_only) {
+            return;
+        }
+
+        const auto& ubi = reversible_blocks.get_index<reversible_block_index, by_num>();
+        if(reversible_log.has_value()) {
+            if(ubi.empty() || reversible_log->last_block_num() > 0) {
+                return;
+            }
+            for(auto& obj : ubi) {
+                reversible_log->append(obj.get_block());
+            }
+            reversible_log->flush();
+            while(!ubi.empty()) {
+                reversible_blocks.remove(*ubi.begin());
+            }
+            ilog("Moved reversible blocks from chainbase into log");
+            return;
+        }
+
+        auto dir = conf.blocks_dir / config::reversible_blocks_dir_name;
+        if(!fc::exists(dir / reversible_block_log::file_name)) {
+            return;
+        }
+        if(ubi.empty()) {
+            auto log = reversible_block_log(dir);
+            log.for_each([&](auto& b) {
+                reversible_blocks.create<reversible_block_object>([&](auto& ubo) {
+                    ubo.blocknum = b->block_num();
+                    ubo.set_block(b);
+                });
+            });
+        }
+        fc::remove(dir / reversible_block_log::file_name);
+        ilog("Moved reversible blocks from log into chainbase");
+    }
+
     void
     init(const snapshot_reader_ptr& snapshot) {
-        token_db.open();
+        {
+            auto phase = internal::startup_phase("wait for token database");
+            token_db_opening.get();
+        }
+        migrate_reversible_blocks();
+        if(!snapshot) {
+            // tokens in db are replaced when starting from snapshot
+            load_hot_keys();
+        }
 
         bool report_integrity_hash = !!snapshot;
         if(snapshot) {
@@ -373,6 +904,20 @@ struct controller_impl {
                            "Block log is provided with snapshot but does not contain the head block from the snapshot");
             }
         }
+        else if(token_db.is_secondary()) {
+            // tokens are written by the primary, blocks are neither replayed nor applied here
+            EVT_ASSERT(read_mode == db_read_mode::READ_ONLY, token_database_exception,
+                "Secondary token database can only be used in read-only mode");
+            if(!head) {
+                initialize_fork_db();
+            }
+            initialize_execution_context();
+
+            if(!blog.read_head()) {
+                blog.reset(conf.genesis, head->block);
+            }
+            return;
+        }
         else {
             if(!head) {
                 initialize_fork_db();  // set head to genesis state
@@ -390,12 +935,21 @@ struct controller_impl {
             }
         }
 
-        const auto& ubi    = reversible_blocks.get_index<reversible_block_index, by_num>();
-        auto        objitr = ubi.rbegin();
-        if(objitr != ubi.rend()) {
-            EVT_ASSERT(objitr->blocknum == head->block_num, fork_database_exception,
+        auto last_reversible = uint32_t(0);
+        if(reversible_log.has_value()) {
+            last_reversible = reversible_log->last_block_num();
+        }
+        else {
+            const auto& ubi    = reversible_blocks.get_index<reversible_block_index, by_num>();
+            auto        objitr = ubi.rbegin();
+            if(objitr != ubi.rend()) {
+                last_reversible = objitr->blocknum;
+            }
+        }
+        if(last_reversible > 0) {
+            EVT_ASSERT(last_reversible == head->block_num, fork_database_exception,
                        "reversible block database is inconsistent with fork database, replay blockchain",
-                       ("head", head->block_num)("unconfimed", objitr->blocknum));
+                       ("head", head->block_num)("unconfimed", last_reversible));
         }
         else {
             auto end = blog.read_head();
@@ -439,7 +993,30 @@ struct controller_impl {
     }
 
     void
-    add_to_snapshot(const snapshot_writer_ptr& snapshot) const {
+    add_to_snapshot(const snapshot_writer_ptr&     snapshot,
+                    const std::optional<fc::path>& tokendb_checkpoint = std::nullopt,
+                    const std::optional<fc::path>& delta_base         = std::nullopt) const {
+        EVT_ASSERT(!tokendb_checkpoint.has_value() || !delta_base.has_value(), snapshot_exception,
+            "Delta snapshot cannot write token database as checkpoint");
+
+        // only token database is written as delta, all the sections of chainbase are small enough to be written fully
+        auto add_tokens = [&] {
+            if(delta_base.has_value()) {
+                auto infile = std::ifstream(delta_base->generic_string(), (std::ios::in | std::ios::binary));
+                auto base   = make_snapshot_reader(infile);
+                base->validate();
+                token_database_snapshot::add_delta_to_snapshot(snapshot, token_db, base, delta_base->filename().generic_string());
+                return;
+            }
+            token_database_snapshot::add_to_snapshot(snapshot, token_db, tokendb_checkpoint);
+        };
+
+        // token database is written by another thread meanwhile if writer accepts sections from many threads
+        auto tokens = std::future<void>();
+        if(snapshot->concurrent()) {
+            tokens = std::async(std::launch::async, add_tokens);
+        }
+
         snapshot->write_section<chain_snapshot_header>([this](auto& section) {
             section.add_row(chain_snapshot_header(), db);
         });
@@ -462,7 +1039,12 @@ struct controller_impl {
             });
         });
 
-        token_database_snapshot::add_to_snapshot(snapshot, token_db);
+        if(tokens.valid()) {
+            tokens.get();
+        }
+        else {
+            add_tokens();
+        }
     }
 
     void
@@ -473,6 +1055,14 @@ struct controller_impl {
             header.validate();
         });
 
+        // same as writing, token database is restored by another thread meanwhile
+        auto tokens = std::future<void>();
+        if(snapshot->concurrent()) {
+            tokens = std::async(std::launch::async, [&] {
+                token_database_snapshot::read_from_snapshot(snapshot, token_db, conf.snapshot_dir);
+            });
+        }
+
         snapshot->read_section<block_state>([this](auto& section) {
             block_header_state head_header_state;
             section.read_row(head_header_state, db);
@@ -499,7 +1089,12 @@ struct controller_impl {
             });
         });
 
-        token_database_snapshot::read_from_snapshot(snapshot, token_db);
+        if(tokens.valid()) {
+            tokens.get();
+        }
+        else {
+            token_database_snapshot::read_from_snapshot(snapshot, token_db, conf.snapshot_dir);
+        }
         db.set_revision(head->block_num);
     }
 
@@ -513,6 +1108,31 @@ struct controller_impl {
         return enc.result();
     }
 
+    // digest of token database is maintained incrementally, all the sections of chainbase are small enough
+    // to be hashed fully, so it's cheap enough to be calculated for each block
+    sha256
+    calculate_state_digest() {
+        auto enc = sha256::encoder();
+        fc::raw::pack(enc, token_db.state_digest());
+
+        auto hash_writer = std::make_shared<integrity_hash_snapshot_writer>(enc);
+        hash_writer->write_section<block_state>([this](auto& section) {
+            section.template add_row<block_header_state>(*fork_db.head(), db);
+        });
+        controller_index_set::walk_indices([this, &hash_writer](auto utils) {
+            using value_t = typename decltype(utils)::index_t::value_type;
+
+            hash_writer->write_section<value_t>([this](auto& section) {
+                decltype(utils)::walk(db, [this, &section](const auto& row) {
+                    section.add_row(row, db);
+                });
+            });
+        });
+        hash_writer->finalize();
+
+        return enc.result();
+    }
+
     /**
      *  Sets fork database head to the genesis state.
      */
@@ -569,11 +1189,45 @@ struct controller_impl {
         initialize_evt_org(token_db, conf.genesis);
     }
 
+    bool
+    block_traces_subscribed() const {
+        return !self.applied_block_traces.empty() || !self.applied_block_traces_async.empty();
+    }
+
+    void
+    emit_block_traces() {
+        if(!block_traces_subscribed()) {
+            return;
+        }
+
+        auto bt = std::make_shared<block_traces>(block_traces{ pending->_pending_block_state, std::move(pending->_traces) });
+        emit(self.applied_block_traces, bt);
+
+        if(self.applied_block_traces_async.empty()) {
+            return;
+        }
+        if(!traces_thread.has_value()) {
+            // one thread only, so blocks are delivered in order
+            auto scope = utilities::affinity::pool_scope("traces");
+            traces_thread.emplace(1);
+        }
+        boost::asio::post(*traces_thread, [this, bt] {
+            try {
+                emit(self.applied_block_traces_async, bt);
+            }
+            catch(...) {
+                elog("Failed to deliver traces of block ${n} asynchronously", ("n",bt->block->block_num));
+            }
+        });
+    }
+
     /**
      * @post regardless of the success of commit block there is no active pending block
      */
     void
     commit_block(bool add_to_fork_db) {
+        EVT_TRACE_SPAN("commit_block", pending->_pending_block_state->block_num);
+
         auto reset_pending_on_exit = fc::make_scoped_exit([this] {
             pending.reset();
         });
@@ -588,12 +1242,19 @@ struct controller_impl {
             }
 
             if(!replaying) {
-                reversible_blocks.create<reversible_block_object>([&](auto& ubo) {
-                    ubo.blocknum = pending->_pending_block_state->block_num;
-                    ubo.set_block(pending->_pending_block_state->block);
-                });
+                if(reversible_log.has_value()) {
+                    // packed and written in background, the block is shared with fork database
+                    reversible_log->append(pending->_pending_block_state->block);
+                }
+                else {
+                    reversible_blocks.create<reversible_block_object>([&](auto& ubo) {
+                        ubo.blocknum = pending->_pending_block_state->block_num;
+                        ubo.set_block(pending->_pending_block_state->block);
+                    });
+                }
             }
 
+            emit_block_traces();
             emit(self.accepted_block, pending->_pending_block_state);
         }
         catch (...) {
@@ -647,18 +1308,28 @@ struct controller_impl {
 
     void
     check_authorization(const public_keys_set& signed_keys, const transaction& trx) {
+        EVT_TRACE_SPAN("check_authorization");
+
         auto& conf = db.get<global_property_object>().configuration;
 
         auto checker = authority_checker(self, exec_ctx, signed_keys, conf.max_authority_depth);
         for(const auto& act : trx.actions) {
+            auto start = profiler.enabled() ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
             EVT_ASSERT(checker.satisfied(act), unsatisfied_authorization,
                        "${name} action in domain: ${domain} with key: ${key} authorized failed",
                        ("domain", act.domain)("key", act.key)("name", act.name));
+
+            if(profiler.enabled()) {
+                auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+                profiler.record_auth(exec_ctx.index_of(act.name), act.name, exec_ctx.get_current_version(act.name), us);
+            }
         }
     }
 
     void
     check_authorization(const public_keys_set& signed_keys, const action& act) {
+        EVT_TRACE_SPAN("check_authorization");
+
         auto& conf = db.get<global_property_object>().configuration;
 
         auto checker = authority_checker(self, exec_ctx, signed_keys, conf.max_authority_depth);
@@ -667,16 +1338,28 @@ struct controller_impl {
                    ("domain", act.domain)("key", act.key)("name", act.name));
     }
 
+    // traces of transactions in blocks are consumed only by subscribers of applied_transaction and
+    // the block traces signals, details of actions are skipped when there's none of them
+    bool
+    lite_trace_allowed() const {
+        return pending->_block_status != controller::block_status::incomplete
+            && !conf.contracts_console
+            && self.applied_transaction.empty()
+            && !block_traces_subscribed();
+    }
+
     transaction_trace_ptr
     push_suspend_transaction(const transaction_metadata_ptr& trx, fc::time_point deadline) {
+        auto arena_scope = db_value_arena::scope(value_arena);
         try {
             auto reset_in_trx_requiring_checks = fc::make_scoped_exit([old_value=in_trx_requiring_checks, this] {
                 in_trx_requiring_checks = old_value;
             });
             in_trx_requiring_checks = true;
 
-            auto trx_context     = transaction_context(self, exec_ctx, trx);
-            trx_context.deadline = deadline;
+            auto trx_context       = transaction_context(self, exec_ctx, trx);
+            trx_context.deadline   = deadline;
+            trx_context.lite_trace = lite_trace_allowed();
 
             auto trace = trx_context.trace;
             try {
@@ -697,6 +1380,9 @@ struct controller_impl {
 
                 trx_context.squash();
                 restore.cancel();
+                if(block_traces_subscribed()) {
+                    pending->_traces.emplace_back(trace);
+                }
                 return trace;
             }
             catch(const fc::exception& e) {
@@ -720,6 +1406,10 @@ struct controller_impl {
             }
             emit(self.accepted_transaction, trx);
             emit(self.applied_transaction, trace);
+            if(block_traces_subscribed()) {
+                // receipts of failed ones are also in block
+                pending->_traces.emplace_back(trace);
+            }
             return trace;
         }
         FC_CAPTURE_AND_RETHROW()
@@ -733,16 +1423,22 @@ struct controller_impl {
     push_transaction(const transaction_metadata_ptr& trx,
                      fc::time_point                  deadline) {
         EVT_ASSERT(deadline != fc::time_point(), transaction_exception, "deadline cannot be uninitialized");
+        EVT_TRACE_SPAN("push_transaction");
 
+        auto arena_scope = db_value_arena::scope(value_arena);
         transaction_trace_ptr trace;
         try {
             auto& trn         = trx->packed_trx->get_signed_transaction();
             auto  trx_context = transaction_context(self, exec_ctx, trx);
 
-            trx_context.deadline = deadline;
-            trace                = trx_context.trace;
+            trx_context.deadline   = deadline;
+            trx_context.lite_trace = lite_trace_allowed();
+            trace                  = trx_context.trace;
 
             try {
+                EVT_ASSERT(self.is_compression_activated(trx->packed_trx->get_compression()), tx_compression_not_activated,
+                    "Compression of transaction: ${c} is not activated", ("c",trx->packed_trx->get_compression()));
+
                 if(trx->implicit) {
                     trx_context.init_for_implicit_trx();
                 }
@@ -752,12 +1448,13 @@ struct controller_impl {
                 }
 
                 if(!self.skip_auth_check() && !trx->implicit) {
-                    const auto& keys = trx->recover_keys(chain_id);
+                    const auto& keys = keys_cache.recover(*trx, chain_id);
                     check_authorization(keys, trn);
                 }
 
                 trx_context.exec();
                 trx_context.finalize();  // Automatically rounds up network and CPU usage in trace and bills payers if successful
+                trx->elapsed = trace->elapsed;
 
                 auto restore = make_block_restore_point();
 
@@ -790,10 +1487,13 @@ struct controller_impl {
                 else {
                     restore.cancel();
                     trx_context.squash();
+                    if(block_traces_subscribed()) {
+                        pending->_traces.emplace_back(trace);
+                    }
                 }
 
                 if(!trx->implicit) {
-                    unapplied_transactions.erase(trx->signed_id);
+                    unapplied_transactions.erase(trx->signed_id());
                 }
                 return trace;
             }
@@ -802,7 +1502,7 @@ struct controller_impl {
                 trace->except_ptr = std::current_exception();
             }
             if(!failure_is_subjective(*trace->except)) {
-                unapplied_transactions.erase(trx->signed_id);
+                unapplied_transactions.erase(trx->signed_id());
             }
 
             emit(self.accepted_transaction, trx);
@@ -878,20 +1578,31 @@ struct controller_impl {
 
     void
     apply_block(const signed_block_ptr& b, controller::block_status s) {
+        EVT_TRACE_SPAN("apply_block", b->block_num());
+
+        // values are kept till the whole block is applied
+        auto arena_scope = db_value_arena::scope(value_arena);
         try {
             try {
                 EVT_ASSERT(b->block_extensions.size() == 0, block_validate_exception, "no supported extensions");
                 auto producer_block_id = b->id();
                 start_block(b->timestamp, b->confirmed, s, producer_block_id);
 
+                auto mtrxs = make_block_transaction_metadatas(b);
+                // keys are not used when authorities are not checked
+                auto recovering = self.skip_auth_check() ? std::vector<std::future<void>>() : recover_keys_async(mtrxs);
+
                 auto num_pending_receipts = pending->_pending_block_state->block->transactions.size();
-                for(const auto& receipt : b->transactions) {
-                    auto trace = transaction_trace_ptr();
+                for(auto i = 0u; i < b->transactions.size(); i++) {
+                    auto& receipt = b->transactions[i];
+                    auto  trace   = transaction_trace_ptr();
                     if(receipt.type == transaction_receipt::input) {
-                        auto& pt    = receipt.trx;
-                        auto  mtrx  = std::make_shared<transaction_metadata>(std::make_shared<packed_transaction>(pt));
-                        
-                        trace = push_transaction(mtrx, fc::time_point::maximum());
+                        if(!recovering.empty()) {
+                            recovering[i].wait();
+                        }
+                        // compression is checked by push_transaction against the state right before this
+                        // transaction, the same as producer does, so the activating vote can be in this block
+                        trace = push_transaction(mtrxs[i], fc::time_point::maximum());
                     }
                     else if(receipt.type == transaction_receipt::suspend) {
                         // suspend transaction is executed in its parent transaction
@@ -954,11 +1665,138 @@ struct controller_impl {
         FC_CAPTURE_AND_RETHROW()
     }  /// apply_block
 
+    void
+    prefetch(std::function<void(prefetch_keys_t&)>&& collect) {
+        const int kMaxPendingPrefetches = 1024;
+
+        if(!prefetch_pool.has_value()) {
+            return;
+        }
+        // apply loop has fallen behind too far, prefetched blocks would be evicted before being used
+        if(prefetch_pending.load(std::memory_order_relaxed) >= kMaxPendingPrefetches) {
+            return;
+        }
+
+        prefetch_pending++;
+        boost::asio::post(*prefetch_pool, [this, collect = std::move(collect)] {
+            auto keys = prefetch_keys_t();
+            try {
+                collect(keys);
+                token_db.prefetch(keys);
+            }
+            catch(...) {
+                // prefetch is only a hint, errors will be reported when transactions are applied
+            }
+            prefetch_pending--;
+        });
+    }
+
+    // signatures are recovered in parallel as it's free of conflicts and doesn't touch any state,
+    // transactions are still applied serially in receipt order after their keys are ready
+    std::vector<std::future<void>>
+    recover_keys_async(const std::vector<transaction_metadata_ptr>& trxs) {
+        auto futures = std::vector<std::future<void>>();
+        if(!signature_pool.has_value() || trxs.size() < 2) {
+            return futures;
+        }
+
+        futures.reserve(trxs.size());
+        for(auto& trx : trxs) {
+            auto p = std::make_shared<std::promise<void>>();
+            futures.emplace_back(p->get_future());
+            if(trx == nullptr) {
+                p->set_value();
+                continue;
+            }
+            recover_keys_async(trx, [p] { p->set_value(); });
+        }
+        return futures;
+    }
+
+    // `trx` should not be touched by others until `next` is called
+    void
+    recover_keys_async(const transaction_metadata_ptr& trx, std::function<void()>&& next) {
+        if(!signature_pool.has_value()) {
+            next();
+            return;
+        }
+        boost::asio::post(*signature_pool, [trx, next = std::move(next), this] {
+            try {
+                keys_cache.recover(*trx, chain_id);
+            }
+            catch(...) {
+                // invalid signatures are reported when the transaction is applied
+            }
+            next();
+        });
+    }
+
+    bool
+    trusted_by_checkpoint(uint32_t block_num) const {
+        // nothing is trusted when all checks are forced
+        return !conf.force_all_checks && block_num <= conf.trusted_checkpoint_num;
+    }
+
+    // keys of transactions in blocks ahead are recovered into cache and picked up when the blocks are applied
+    void
+    recover_block_keys(const signed_block_ptr& b) {
+        const int kMaxPendingRecoveries = 1024 * 8;
+
+        if(!signature_pool.has_value() || trusted_by_checkpoint(b->block_num())) {
+            return;
+        }
+        for(auto& mtrx : make_block_transaction_metadatas(b)) {
+            if(!mtrx) {
+                continue;
+            }
+            // apply loop has fallen behind too far
+            if(signature_pending.load(std::memory_order_relaxed) >= kMaxPendingRecoveries) {
+                return;
+            }
+
+            signature_pending++;
+            recover_keys_async(mtrx, [this] { signature_pending--; });
+        }
+    }
+
+    // stage of block validation free of state, done in worker threads
+    void
+    prefetch_packed_block(std::vector<char>&& packed) {
+        if(!signature_pool.has_value()) {
+            return;
+        }
+        boost::asio::post(*signature_pool, [this, packed = std::move(packed)] {
+            try {
+                auto b = std::make_shared<signed_block>();
+                fc::raw::unpack(packed, *b);
+
+                prefetch_block(b);
+                recover_block_keys(b);
+            }
+            catch(...) {
+                // invalid blocks are reported when they're pushed
+            }
+        });
+    }
+
+    void
+    prefetch_block(const signed_block_ptr& b) {
+        prefetch([b](auto& keys) {
+            for(auto& receipt : b->transactions) {
+                internal::collect_prefetch_keys(receipt.trx.get_transaction(), keys);
+            }
+        });
+    }
+
     void
     push_block(const signed_block_ptr& b) {
+        EVT_TRACE_SPAN("push_block", b->block_num());
+
         auto s = controller::block_status::complete;
         EVT_ASSERT(!pending.has_value(), block_validate_exception, "it is not valid to push a block when there is a pending block");
 
+        prefetch_block(b);
+
         auto reset_prod_light_validation = fc::make_scoped_exit([old_value=trusted_producer_light_validation, this]() {
             trusted_producer_light_validation = old_value;
         });
@@ -1085,7 +1923,7 @@ struct controller_impl {
         if(pending.has_value()) {
             if(read_mode == db_read_mode::SPECULATIVE) {
                 for(const auto& t : pending->_pending_block_state->trxs) {
-                    unapplied_transactions[t->signed_id] = t;
+                    unapplied_transactions[t->signed_id()] = t;
                 }
             }
             pending.reset();
@@ -1123,6 +1961,8 @@ struct controller_impl {
     void
     finalize_block() {
         EVT_ASSERT(pending.has_value(), block_validate_exception, "it is not valid to finalize when there is no pending block");
+        EVT_TRACE_SPAN("finalize_block");
+
         try {
             set_action_merkle();
             set_trx_merkle();
@@ -1151,7 +1991,11 @@ struct controller_impl {
         const auto& dedupe_index    = transaction_idx.indices().get<by_expiration>();
         auto        now             = self.pending_block_time();
         while((!dedupe_index.empty()) && (now > fc::time_point(dedupe_index.begin()->expiration))) {
-            transaction_idx.remove(*dedupe_index.begin());
+            // removes all the transactions expired at the same second at once
+            auto end = dedupe_index.upper_bound(dedupe_index.begin()->expiration);
+            for(auto it = dedupe_index.begin(); it != end;) {
+                transaction_idx.remove(*it++);
+            }
         }
     }
 
@@ -1185,7 +2029,12 @@ controller::startup(const snapshot_reader_ptr& snapshot) {
     }
 
     try {
-        my->init(snapshot);
+        {
+            auto phase = internal::startup_phase("initialize chain");
+            my->init(snapshot);
+        }
+        auto phase = internal::startup_phase("warm token database cache");
+        my->warm_token_db_cache();
     }
     catch(boost::interprocess::bad_alloc& e) {
         if(snapshot) {
@@ -1208,6 +2057,11 @@ controller::fork_db() const {
     return my->fork_db;
 }
 
+const block_log&
+controller::get_block_log() const {
+    return my->blog;
+}
+
 token_database&
 controller::token_db() const {
     return my->token_db;
@@ -1218,6 +2072,11 @@ controller::token_db_cache() const {
     return my->token_db_cache;
 }
 
+action_profiler&
+controller::get_action_profiler() const {
+    return my->profiler;
+}
+
 charge_manager
 controller::get_charge_manager() const {
     return charge_manager(*this, my->exec_ctx);
@@ -1264,6 +2123,34 @@ controller::push_block(const signed_block_ptr& b) {
     my->push_block(b);
 }
 
+void
+controller::prefetch_transaction(const transaction_metadata_ptr& trx) const {
+    my->prefetch([ptrx = trx->packed_trx](auto& keys) {
+        internal::collect_prefetch_keys(ptrx->get_transaction(), keys);
+    });
+}
+
+void
+controller::prefetch_block(const signed_block_ptr& b) const {
+    my->prefetch_block(b);
+    my->recover_block_keys(b);
+}
+
+void
+controller::prefetch_packed_block(std::vector<char>&& packed) const {
+    my->prefetch_packed_block(std::move(packed));
+}
+
+const public_keys_set&
+controller::recover_keys(const transaction_metadata_ptr& trx) const {
+    return my->keys_cache.recover(*trx, my->chain_id);
+}
+
+void
+controller::recover_keys_async(const transaction_metadata_ptr& trx, std::function<void()>&& next) const {
+    my->recover_keys_async(trx, std::move(next));
+}
+
 transaction_trace_ptr
 controller::push_transaction(const transaction_metadata_ptr& trx, fc::time_point deadline) {
     validate_db_available_size();
@@ -1402,6 +2289,9 @@ controller::fetch_block_by_number(uint32_t block_num) const {
         if(blk_state && blk_state->block) {
             return blk_state->block;
         }
+        if(auto b = my->blocks_cache.get(block_num)) {
+            return b;
+        }
 
         return my->blog.read_block_by_num(block_num);
     }
@@ -1432,7 +2322,10 @@ controller::get_block_id_for_num(uint32_t block_num) const {
             return blk_state->id;
         }
 
-        auto signed_blk = my->blog.read_block_by_num(block_num);
+        auto signed_blk = my->blocks_cache.get(block_num);
+        if(!signed_blk) {
+            signed_blk = my->blog.read_block_by_num(block_num);
+        }
 
         EVT_ASSERT(BOOST_LIKELY(signed_blk != nullptr), unknown_block_exception,
                    "Could not find block: ${block}", ("block", block_num));
@@ -1444,17 +2337,48 @@ controller::get_block_id_for_num(uint32_t block_num) const {
 
 evt_link_object
 controller::get_link_obj_for_link_id(const link_id_type& link_id) const {
-    evt_link_object link_obj;
+    auto link_obj = find_link_obj_for_link_id(link_id);
+    if(!link_obj.has_value()) {
+        EVT_THROW2(evt_link_existed_exception, "Cannot find EvtLink with id: {}", fc::to_hex((char*)&link_id, sizeof(link_id)));
+    }
+    return *link_obj;
+}
 
-    auto str = std::string();
-    try {
-        my->token_db.read_token(token_type::evtlink, std::nullopt, link_id, str);
+bool
+controller::is_compression_activated(packed_transaction::compression_type type) const {
+    if(type != packed_transaction::zstd) {
+        return true;
     }
-    catch(token_database_exception&) {
-        EVT_THROW2(evt_link_existed_exception, "Cannot find EvtLink with id: {}", fc::to_hex((char*)&link_id, sizeof(link_id)));
+
+    auto votes = flat_map<public_key_type, int64_t>();
+    auto found = my->token_db.read_token(token_type::prodvote, std::nullopt, N128(zstd-compression), [&](auto& v) {
+        extract_db_value(v, votes);
+    }, true);
+    if(!found) {
+        return false;
+    }
+
+    // same quorum as the updates of prodvote
+    auto& sche = active_producers();
+    auto  n    = (size_t)0;
+    for(auto& p : sche.producers) {
+        if(votes.find(p.block_signing_key) != votes.cend()) {
+            n++;
+        }
     }
+    return n == sche.producers.size() || n > ::ceil(2.0 * sche.producers.size() / 3.0);
+}
 
-    extract_db_value(str, link_obj);
+std::optional<evt_link_object>
+controller::find_link_obj_for_link_id(const link_id_type& link_id) const {
+    auto link_obj = evt_link_object();
+    auto found    = my->token_db.read_token(token_type::evtlink, std::nullopt, link_id, [&](auto& v) {
+        extract_db_value(v, link_obj);
+    }, true);
+
+    if(!found) {
+        return std::nullopt;
+    }
     return link_obj;
 }
 
@@ -1466,6 +2390,43 @@ controller::get_block_num_for_trx_id(const transaction_id_type& trx_id) const {
     EVT_THROW(unknown_transaction_exception, "Transaction: ${t} is not existed", ("t",trx_id));
 }
 
+std::optional<uint32_t>
+controller::get_trx_index_for_trx_id(const transaction_id_type& trx_id) const {
+    if(const auto* t = my->db.find<transaction_object, by_trx_id>(trx_id)) {
+        if(t->trx_index != transaction_object::kUnknownIndex) {
+            return t->trx_index;
+        }
+        return std::nullopt;
+    }
+    EVT_THROW(unknown_transaction_exception, "Transaction: ${t} is not existed", ("t",trx_id));
+}
+
+std::optional<std::pair<block_id_type, transaction_receipt>>
+controller::fetch_transaction_receipt(uint32_t block_num, uint32_t index) const {
+    try {
+        auto from_block = [&](const signed_block_ptr& b) -> std::optional<std::pair<block_id_type, transaction_receipt>> {
+            if(index >= b->transactions.size()) {
+                return std::nullopt;
+            }
+            return std::make_pair(b->id(), transaction_receipt(b->transactions[index]));
+        };
+
+        auto blk_state = my->fork_db.get_block_in_current_chain_by_num(block_num);
+        if(blk_state && blk_state->block) {
+            return from_block(blk_state->block);
+        }
+        if(auto b = my->blocks_cache.get(block_num)) {
+            return from_block(b);
+        }
+
+        if(auto loc = my->blog.read_transaction(block_num, index)) {
+            return std::make_pair(loc->header.id(), std::move(loc->receipt));
+        }
+        return std::nullopt;
+    }
+    FC_CAPTURE_AND_RETHROW((block_num)(index))
+}
+
 fc::sha256
 controller::calculate_integrity_hash() const {
     try {
@@ -1474,10 +2435,20 @@ controller::calculate_integrity_hash() const {
     FC_LOG_AND_RETHROW()
 }
 
+sha256
+controller::calculate_state_digest() const {
+    try {
+        return my->calculate_state_digest();
+    }
+    FC_LOG_AND_RETHROW()
+}
+
 void
-controller::write_snapshot(const snapshot_writer_ptr& snapshot) const {
+controller::write_snapshot(const snapshot_writer_ptr&     snapshot,
+                           const std::optional<fc::path>& tokendb_checkpoint,
+                           const std::optional<fc::path>& delta_base) const {
     EVT_ASSERT(!my->pending.has_value(), block_validate_exception, "cannot take a consistent snapshot with a pending block");
-    return my->add_to_snapshot(snapshot);
+    return my->add_to_snapshot(snapshot, tokendb_checkpoint, delta_base);
 }
 
 void
@@ -1607,7 +2578,14 @@ controller::light_validation_allowed(bool replay_opts_disabled_by_policy) const
 
 bool
 controller::skip_auth_check() const {
-    return light_validation_allowed(my->conf.force_all_checks);
+    if(light_validation_allowed(my->conf.force_all_checks)) {
+        return true;
+    }
+    // blocks below trusted checkpoint are replayed or synced without authority checks unless all checks are forced
+    return my->pending.has_value()
+           && my->pending->_block_status != block_status::incomplete
+           && !my->in_trx_requiring_checks
+           && my->trusted_by_checkpoint(my->pending->_pending_block_state->block_num);
 }
 
 bool
@@ -1648,6 +2626,11 @@ controller::contracts_console() const {
     return my->conf.contracts_console;
 }
 
+bool
+controller::lite_trace() const {
+    return my->pending.has_value() && my->lite_trace_allowed();
+}
+
 db_read_mode
 controller::get_read_mode() const {
    return my->read_mode;
@@ -1670,7 +2653,7 @@ controller::get_genesis_state() const {
 
 const abi_serializer&
 controller::get_abi_serializer() const {
-    return my->system_api;
+    return my->get_system_api();
 }
 
 unapplied_transactions_type&
@@ -1735,6 +2718,36 @@ controller::validate_reversible_available_size() const {
    EVT_ASSERT(free >= guard, reversible_guard_exception, "reversible free: ${f}, guard size: ${g}", ("f", free)("g",guard));
 }
 
+controller::memory_usage
+controller::get_memory_usage() const {
+    auto m = memory_usage();
+
+    auto sm           = my->db.get_segment_manager();
+    m.state_size      = sm->get_size();
+    m.state_used      = sm->get_size() - sm->get_free_memory();
+    if(my->reversible_log.has_value()) {
+        m.reversible_size = m.reversible_used = my->reversible_log->file_size();
+    }
+    else {
+        auto rsm          = my->reversible_blocks.get_segment_manager();
+        m.reversible_size = rsm->get_size();
+        m.reversible_used = rsm->get_size() - rsm->get_free_memory();
+    }
+
+    m.fork_db_blocks = my->fork_db.size();
+    m.fork_db_bytes  = my->fork_db.memory_usage();
+
+    m.unapplied_transactions = my->unapplied_transactions.size();
+
+    m.token_db_cache_usage    = my->token_db_cache.usage();
+    m.token_db_cache_capacity = my->token_db_cache.capacity();
+    m.blocks_cache_usage      = my->blocks_cache.size();
+    m.keys_cache_usage        = my->keys_cache.size();
+
+    m.token_db = my->token_db.memory_usage();
+    return m;
+}
+
 bool
 controller::is_known_unexpired_transaction(const transaction_id_type& id) const {
     return db().find<transaction_object, by_trx_id>(id);
@@ -1778,15 +2791,13 @@ public_keys_set
 controller::get_suspend_required_keys(const proposal_name& name, const public_keys_set& candidate_keys) const {
     suspend_def suspend;
 
-    auto str = std::string();
-    try {
-        my->token_db.read_token(token_type::suspend, std::nullopt, name, str);
-    }
-    catch(token_database_exception&) {
+    auto r = my->token_db.try_read_token(token_type::suspend, std::nullopt, name, [&](auto& v) {
+        extract_db_value(v, suspend);
+    });
+    if(r == read_status::not_found) {
         EVT_THROW2(unknown_lock_exception, "Cannot find suspend proposal: {}", name);
     }
 
-    extract_db_value(str, suspend);
     return get_suspend_required_keys(suspend.trx, candidate_keys);
 }
 
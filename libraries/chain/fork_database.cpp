@@ -12,6 +12,7 @@
 #include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index_container.hpp>
 #include <fc/io/fstream.hpp>
+#include <algorithm>
 #include <fstream>
 
 namespace evt { namespace chain {
@@ -43,20 +44,81 @@ typedef multi_index_container<
                    composite_key_compare<std::greater<uint32_t>, std::greater<uint32_t>, std::greater<uint32_t>>>>>
     fork_multi_index_type;
 
+namespace {
+
+enum journal_type : uint8_t {
+    kJournalAdd = 0,     // block state
+    kJournalRemove,      // block id, it's removed or pruned
+    kJournalValid,       // block id
+    kJournalInChain,     // block id, it's marked in current chain
+    kJournalNotInChain,  // block id, it's marked not in current chain
+    kJournalConfirm      // header confirmation
+};
+
+// journal is rewritten with current blocks when its records are more than this times of the blocks
+const uint32_t kJournalCompactRatio = 8;
+const uint32_t kJournalMinRecords   = 4096;
+
+}  // namespace
+
 struct fork_database_impl {
     fork_multi_index_type index;
     block_state_ptr       head;
     fc::path              datadir;
+
+    std::ofstream journal;
+    uint32_t      journal_records = 0;
+
+    template<typename T>
+    void
+    append_journal(journal_type type, const T& v) {
+        if(!journal.is_open()) {
+            return;
+        }
+        fc::raw::pack(journal, (uint8_t)type);
+        fc::raw::pack(journal, v);
+        journal.flush();
+
+        if(++journal_records > std::max(kJournalMinRecords, (uint32_t)index.size() * kJournalCompactRatio)) {
+            compact_journal();
+        }
+    }
+
+    void
+    compact_journal() {
+        auto filename = datadir / config::forkdb_journal_filename;
+        auto tmpname  = datadir / (std::string(config::forkdb_journal_filename) + ".tmp");
+
+        if(journal.is_open()) {
+            journal.close();
+        }
+
+        auto out = std::ofstream(tmpname.generic_string(), (std::ios::out | std::ios::binary | std::ios::trunc));
+        // ordered by block num, so blocks are always written after their previous ones
+        for(auto& s : index.get<by_block_num>()) {
+            fc::raw::pack(out, (uint8_t)kJournalAdd);
+            fc::raw::pack(out, *s);
+        }
+        out.close();
+        EVT_ASSERT(!out.fail(), fork_database_exception, "Failed to write fork database journal: ${f}", ("f", tmpname.generic_string()));
+
+        // replaced atomically, so there's always a complete journal
+        fc::rename(tmpname, filename);
+
+        journal.open(filename.generic_string(), (std::ios::out | std::ios::binary | std::ios::app));
+        journal_records = index.size();
+    }
 };
 
-fork_database::fork_database(const fc::path& data_dir)
+fork_database::fork_database(const fc::path& data_dir, bool journal)
     : my(new fork_database_impl()) {
     my->datadir = data_dir;
 
     if(!fc::is_directory(my->datadir))
         fc::create_directories(my->datadir);
 
-    auto fork_db_dat = my->datadir / config::forkdb_filename;
+    auto fork_db_dat     = my->datadir / config::forkdb_filename;
+    auto fork_db_journal = my->datadir / config::forkdb_journal_filename;
     if(fc::exists(fork_db_dat)) {
         string content;
         fc::read_file_contents(fork_db_dat, content);
@@ -76,6 +138,109 @@ fork_database::fork_database(const fc::path& data_dir)
 
         fc::remove(fork_db_dat);
     }
+    else if(fc::exists(fork_db_journal)) {
+        // it's not closed cleanly last time
+        replay_journal(fork_db_journal);
+    }
+
+    if(journal) {
+        my->compact_journal();
+    }
+    else if(fc::exists(fork_db_journal)) {
+        fc::remove(fork_db_journal);
+    }
+}
+
+void
+fork_database::replay_journal(const fc::path& filename) {
+    auto content = string();
+    fc::read_file_contents(filename, content);
+
+    auto ds = fc::datastream<const char*>(content.data(), content.size());
+    auto n  = 0u;
+    try {
+        while(ds.remaining() > 0) {
+            auto type = uint8_t();
+            auto id   = block_id_type();
+            fc::raw::unpack(ds, type);
+
+            switch(type) {
+            case kJournalAdd: {
+                auto s = block_state();
+                fc::raw::unpack(ds, s);
+                my->index.erase(s.id);
+                my->index.insert(std::make_shared<block_state>(move(s)));
+                break;
+            }
+            case kJournalRemove: {
+                fc::raw::unpack(ds, id);
+                my->index.erase(id);
+                break;
+            }
+            case kJournalValid: {
+                fc::raw::unpack(ds, id);
+                if(auto b = get_block(id)) {
+                    b->validated = true;
+                }
+                break;
+            }
+            case kJournalInChain:
+            case kJournalNotInChain: {
+                fc::raw::unpack(ds, id);
+                if(auto b = get_block(id)) {
+                    mark_in_current_chain(b, type == kJournalInChain);
+                }
+                break;
+            }
+            case kJournalConfirm: {
+                auto c = header_confirmation();
+                fc::raw::unpack(ds, c);
+                if(get_block(c.block_id)) {
+                    add(c);
+                }
+                break;
+            }
+            default: {
+                EVT_THROW(fork_database_exception, "Unknown type of fork database journal: ${t}", ("t", type));
+            }
+            }  // switch
+            n++;
+        }
+    }
+    catch(const fc::exception& e) {
+        // the last record may be written partially when it's crashed
+        wlog("Fork database journal is broken after ${n} records: ${e}", ("n", n)("e", e.to_string()));
+    }
+
+    if(my->index.empty()) {
+        return;
+    }
+
+    // blocks not validated yet may not be applied into state, they're dropped and would be received again.
+    // the root block is kept, which is the genesis or the one loaded from snapshot
+    auto invalid = vector<block_id_type>();
+    for(auto& s : my->index) {
+        if(!s->validated && my->index.find(s->header.previous) != my->index.end()) {
+            invalid.emplace_back(s->id);
+        }
+    }
+    for(auto& id : invalid) {
+        if(get_block(id)) {
+            remove(id);
+        }
+    }
+
+    // head is the latest block applied in current chain
+    my->head = *my->index.get<by_lib_block_num>().begin();
+
+    auto& numidx = my->index.get<by_block_num>();
+    for(auto it = numidx.rbegin(); it != numidx.rend(); it++) {
+        if((*it)->in_current_chain) {
+            my->head = *it;
+            break;
+        }
+    }
+    ilog("Fork database is recovered from journal with ${n} blocks, head: ${h}", ("n", my->index.size())("h", my->head->block_num));
 }
 
 void
@@ -95,6 +260,13 @@ fork_database::close() {
         fc::raw::pack(out, my->head->id);
     else
         fc::raw::pack(out, block_id_type());
+    out.close();
+
+    // all the blocks are persisted, journal is not needed anymore
+    if(my->journal.is_open()) {
+        my->journal.close();
+        fc::remove(my->datadir / config::forkdb_journal_filename);
+    }
 
     /// we don't normally indicate the head block as irreversible
     /// we cannot normally prune the lib if it is the head block because
@@ -121,6 +293,8 @@ fork_database::set(block_state_ptr s) {
     // EVT_ASSERT( s->block_num == s->header.block_num() );
 
     EVT_ASSERT(result.second, fork_database_exception, "unable to insert block state, duplicate state detected");
+    my->append_journal(kJournalAdd, *s);
+
     if(!my->head) {
         my->head = s;
     }
@@ -142,6 +316,7 @@ fork_database::add(const block_state_ptr& n, bool skip_validate_previous) {
 
     auto inserted = my->index.insert(n);
     EVT_ASSERT(inserted.second, fork_database_exception, "duplicate block added?");
+    my->append_journal(kJournalAdd, *n);
 
     my->head = *my->index.get<by_lib_block_num>().begin();
 
@@ -177,6 +352,20 @@ fork_database::head() const {
     return my->head;
 }
 
+size_t
+fork_database::size() const {
+    return my->index.size();
+}
+
+uint64_t
+fork_database::memory_usage() const {
+    auto bytes = uint64_t(0);
+    for(auto& s : my->index) {
+        bytes += sizeof(block_state) + fc::raw::pack_size(*s);
+    }
+    return bytes;
+}
+
 /**
  *  Given two head blocks, return two branches of the fork graph that
  *  end with a common ancestor (same prior block)
@@ -223,8 +412,10 @@ fork_database::remove(const block_id_type& id) {
 
     for(uint32_t i = 0; i < remove_queue.size(); ++i) {
         auto itr = my->index.find(remove_queue[i]);
-        if(itr != my->index.end())
+        if(itr != my->index.end()) {
             my->index.erase(itr);
+            my->append_journal(kJournalRemove, remove_queue[i]);
+        }
 
         auto& previdx = my->index.get<by_prev>();
         auto  previtr = previdx.lower_bound(remove_queue[i]);
@@ -245,6 +436,7 @@ fork_database::set_validity(const block_state_ptr& h, bool valid) {
     else {
         /// remove older than irreversible and mark block as valid
         h->validated = true;
+        my->append_journal(kJournalValid, h->id);
     }
 }
 
@@ -261,6 +453,7 @@ fork_database::mark_in_current_chain(const block_state_ptr& h, bool in_current_c
         itr, [&](auto& bsp) {  // Need to modify this way rather than directly so that Boost MultiIndex can re-sort
             bsp->in_current_chain = in_current_chain;
         });
+    my->append_journal(in_current_chain ? kJournalInChain : kJournalNotInChain, h->id);
 }
 
 void
@@ -276,8 +469,10 @@ fork_database::prune(const block_state_ptr& h) {
 
     auto itr = my->index.find(h->id);
     if(itr != my->index.end()) {
+        auto id = (*itr)->id;
         irreversible(*itr);
         my->index.erase(itr);
+        my->append_journal(kJournalRemove, id);
     }
 
     auto& numidx = my->index.get<by_block_num>();
@@ -318,6 +513,7 @@ fork_database::add(const header_confirmation& c) {
     auto b = get_block(c.block_id);
     EVT_ASSERT(b, fork_db_block_not_found, "unable to find block id ${id}", ("id", c.block_id));
     b->add_confirmation(c);
+    my->append_journal(kJournalConfirm, c);
 
     if(b->bft_irreversible_blocknum < b->block_num
        && b->confirmations.size() >= ((b->active_schedule.producers.size() * 2) / 3 + 1)) {
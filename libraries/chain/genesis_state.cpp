@@ -122,7 +122,13 @@ auto upgrade_ft = [](auto& ftg, bool can_transfer) {
     ft.transfer     = transfer;
     ft.manage       = ftg.manage;
     ft.total_supply = ftg.total_supply;
-    ft.metas        = ftg.metas;
+
+    // metas themselves are stored apart by `initialize_evt_org`
+    for(auto& m : ftg.metas) {
+        if(m.key == N128(.disable-set-transfer) && m.value == "true") {
+            ft.flags |= (meta_flags)meta_flag::disable_set_transfer;
+        }
+    }
 
     return ft;
 };
@@ -4,6 +4,7 @@
  */
 #pragma once
 #include <any>
+#include <memory>
 #include <type_traits>
 #include <evt/chain/types.hpp>
 #include <evt/chain/exceptions.hpp>
@@ -24,14 +25,14 @@ public:
 public:
     action() : index_(-1) {}
 
-    // don't copy cache_ when in copy ctor.
+    // decoded data is immutable and shared with copies, so actions copied into traces are not decoded again
     action(const action& lhs)
         : name(lhs.name)
         , domain(lhs.domain)
         , key(lhs.key)
         , data(lhs.data)
         , index_(lhs.index_)
-        , cache_() {}
+        , cache_(lhs.cache_) {}
 
     action(action&& lhs) noexcept = default;
 
@@ -42,6 +43,7 @@ public:
             key    = lhs.key;
             data   = lhs.data;
             index_ = lhs.index_;
+            cache_ = lhs.cache_;
         }
         return *this;
     }
@@ -51,7 +53,7 @@ public:
             name   = lhs.name;
             domain = lhs.domain;
             key    = lhs.key;
-            data   = lhs.data;
+            data   = std::move(lhs.data);
             index_ = lhs.index_;
             cache_ = std::move(lhs.cache_);
         }
@@ -66,7 +68,7 @@ public:
         , key(key)
         , data(fc::raw::pack(value))
         , index_(-1)
-        , cache_(std::make_any<T>(value)) {}
+        , cache_(std::make_shared<const std::any>(std::in_place_type<T>, value)) {}
 
     action(const action_name name, const domain_name& domain, const domain_key& key, const bytes& data)
         : name(name)
@@ -79,7 +81,7 @@ public:
     void
     set_data(const T& value) {
         data   = fc::raw::pack(value);
-        cache_ = std::make_any<T>(value);
+        cache_ = std::make_shared<const std::any>(std::in_place_type<T>, value);
     }
 
     void
@@ -87,23 +89,28 @@ public:
         index_ = index;
     }
 
-    // if T is a reference, will return the reference to the internal cache value
+    // if T is a const reference, will return the reference to the internal cache value
     // Otherwise if T is a value type, will return new copy. 
+    // data is decoded only once and in place, it's shared by the copies of this action
     template <typename T>
     T
     data_as() const {
-        if(!cache_.has_value()) {
+        if(!cache_) {
             using raw_type = std::remove_const_t<std::remove_reference_t<T>>;
             EVT_ASSERT(name == raw_type::get_action_name(), action_type_exception, "action name is not consistent with action struct");
-            cache_ = std::make_any<raw_type>(fc::raw::unpack<raw_type>(data));
+
+            auto c  = std::make_shared<std::any>();
+            auto ds = fc::datastream<const char*>(data.data(), data.size());
+            fc::raw::unpack(ds, c->emplace<raw_type>());
+            cache_ = std::move(c);
         }
         // no need to check name here, `any_cast` will throws exception if types don't match
-        return std::any_cast<T>(cache_);
+        return std::any_cast<T>(*cache_);
     }
 
 private:
-    mutable int      index_;
-    mutable std::any cache_;
+    mutable int                              index_;
+    mutable std::shared_ptr<const std::any> cache_;
 
 private:
     friend class apply_context;
@@ -0,0 +1,143 @@
+/**
+ *  @file
+ *  @copyright defined in evt/LICENSE.txt
+ */
+#pragma once
+#include <array>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include <evt/chain/types.hpp>
+#include <evt/chain/token_database.hpp>
+
+namespace evt { namespace chain {
+
+// summary of the executions of one version of action, times are in microseconds
+struct action_profile {
+    action_name act;
+    int         version = 0;
+
+    uint64_t count      = 0;
+    uint64_t failed     = 0;
+    uint64_t total_time = 0;
+    uint64_t p50_time   = 0;  // percentiles are the upper bounds of buckets in histogram
+    uint64_t p99_time   = 0;
+    uint64_t max_time   = 0;
+
+    uint64_t auth_count      = 0;
+    uint64_t auth_total_time = 0;
+    uint64_t auth_max_time   = 0;
+
+    uint64_t db_reads     = 0;
+    uint64_t db_writes    = 0;
+    uint64_t cache_hits   = 0;
+    uint64_t cache_misses = 0;
+};
+
+// collects wall time and database operations of actions when they're applied and authorized
+// it's only used in main thread, nothing is collected unless it's enabled
+class action_profiler : boost::noncopyable {
+public:
+    static const int kLatencyBuckets = 20;  // bucket i counts the ones within [2^(i-1), 2^i) microseconds
+
+public:
+    action_profiler(bool enabled) : enabled_(enabled) {}
+
+public:
+    bool enabled() const { return enabled_; }
+
+    void
+    record_exec(int index, action_name act, int version, uint64_t us, const db_op_counters& counters, bool failed) {
+        auto& e = get_entry(index, act, version);
+        auto& p = e.profile;
+
+        p.count++;
+        p.failed += failed;
+        p.total_time += us;
+        p.max_time = std::max(p.max_time, us);
+        e.latency[bucket_of(us)]++;
+
+        p.db_reads += counters.reads;
+        p.db_writes += counters.writes;
+        p.cache_hits += counters.cache_hits;
+        p.cache_misses += counters.cache_misses;
+    }
+
+    void
+    record_auth(int index, action_name act, int version, uint64_t us) {
+        auto& p = get_entry(index, act, version).profile;
+
+        p.auth_count++;
+        p.auth_total_time += us;
+        p.auth_max_time = std::max(p.auth_max_time, us);
+    }
+
+    std::vector<action_profile>
+    get_profiles() const {
+        auto profiles = std::vector<action_profile>();
+        for(auto& vers : entries_) {
+            for(auto& e : vers) {
+                if(e.profile.version == 0) {
+                    continue;  // placeholder of versions not recorded
+                }
+                auto p     = e.profile;
+                p.p50_time = std::min(percentile(e, 50), p.max_time);
+                p.p99_time = std::min(percentile(e, 99), p.max_time);
+                profiles.emplace_back(std::move(p));
+            }
+        }
+        return profiles;
+    }
+
+    void reset() { entries_.clear(); }
+
+private:
+    struct entry {
+        action_profile                         profile;
+        std::array<uint64_t, kLatencyBuckets> latency = {};
+    };
+
+    static int
+    bucket_of(uint64_t us) {
+        return (us == 0) ? 0 : std::min(64 - __builtin_clzll(us), kLatencyBuckets - 1);
+    }
+
+    static uint64_t
+    percentile(const entry& e, int pct) {
+        auto target = (e.profile.count * pct + 99) / 100;
+        auto n      = 0ul;
+        for(auto i = 0; i < kLatencyBuckets; i++) {
+            n += e.latency[i];
+            if(n >= target) {
+                return (1ul << i) - 1;
+            }
+        }
+        return e.profile.max_time;
+    }
+
+    entry&
+    get_entry(int index, action_name act, int version) {
+        assert(index >= 0 && version > 0);
+        if((size_t)index >= entries_.size()) {
+            entries_.resize(index + 1);
+        }
+        auto& vers = entries_[index];
+        if((size_t)version > vers.size()) {
+            vers.resize(version);
+        }
+        auto& e = vers[version - 1];
+        if(e.profile.version == 0) {
+            e.profile.act     = act;
+            e.profile.version = version;
+        }
+        return e;
+    }
+
+private:
+    bool                                enabled_;
+    std::vector<small_vector<entry, 2>> entries_;  // indexed by action index and then version - 1
+};
+
+}}  // namespace evt::chain
+
+FC_REFLECT(evt::chain::action_profile, (act)(version)(count)(failed)(total_time)(p50_time)(p99_time)(max_time)
+           (auth_count)(auth_total_time)(auth_max_time)(db_reads)(db_writes)(cache_hits)(cache_misses));
@@ -56,6 +56,11 @@ public:
         return _new_ft_holders.emplace_back(std::move(nfth));
     }
 
+    ft_balance&
+    add_ft_balance(ft_balance&& ftb) {
+        return _ft_balances.emplace_back(std::move(ftb));
+    }
+
 public:
     fmt::memory_buffer&
     get_console_buffer() {
@@ -74,7 +79,8 @@ public:
 private:
     fmt::memory_buffer         _pending_console_output;
     small_vector<action, 2>    _generated_actions;
-    small_vector<ft_holder, 2> _new_ft_holders;
+    small_vector<ft_holder, 2>  _new_ft_holders;
+    small_vector<ft_balance, 2> _ft_balances;
 };
 
 }}  // namespace evt::chain
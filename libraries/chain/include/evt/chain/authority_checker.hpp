@@ -8,7 +8,6 @@
 #include <fc/scoped_exit.hpp>
 
 #include <boost/dynamic_bitset.hpp>
-#include <boost/range/algorithm/find.hpp>
 
 #include <evt/chain/controller.hpp>
 #include <evt/chain/config.hpp>
@@ -33,13 +32,14 @@ enum toke_type { kNFT = 0, kFT };
 template<uint64_t>
 struct check_authority {};
 
-#define READ_DB_TOKEN(TYPE, PREFIX, KEY, VPTR, EXCEPTION, FORMAT, ...)       \
-    try {                                                                    \
-        using vtype = typename decltype(VPTR)::element_type;                 \
-        VPTR = tokendb_cache_.template read_token<vtype>(TYPE, PREFIX, KEY); \
-    }                                                                        \
-    catch(token_database_exception&) {                                       \
-        EVT_THROW2(EXCEPTION, FORMAT, __VA_ARGS__);                          \
+#define READ_DB_TOKEN(TYPE, PREFIX, KEY, VPTR, EXCEPTION, FORMAT, ...)              \
+    {                                                                               \
+        using vtype = typename decltype(VPTR)::element_type;                        \
+        auto rr = tokendb_cache_.template try_read_token<vtype>(TYPE, PREFIX, KEY); \
+        if(!rr.found()) {                                                           \
+            EVT_THROW2(EXCEPTION, FORMAT, __VA_ARGS__);                             \
+        }                                                                           \
+        VPTR = std::move(rr.value);                                                 \
     }
 
 }  // namespace internal
@@ -84,7 +84,8 @@ public:
 
         uint32_t
         operator()(const public_key_type& key, const weight_type weight) {
-            auto itr = boost::find(checker_->signing_keys_, key);
+            // signing keys are sorted in flat set, binary search on them and position is the index of used keys
+            auto itr = checker_->signing_keys_.find(key);
             if(itr != checker_->signing_keys_.end()) {
                 checker_->used_keys_[itr - checker_->signing_keys_.begin()] = true;
                 total_weight_ += weight;
@@ -114,9 +115,9 @@ public:
         , used_keys_(signing_keys.size(), false) {}
 
 private:
-    template<int Permission>
+    template<int Permission, typename Func>
     void
-    get_domain_permission(const domain_name& domain_name, std::function<void(const permission_def&)>&& cb) {
+    get_domain_permission(const domain_name& domain_name, Func&& cb) {
         using namespace internal;
 
         auto domain = make_empty_cache_ptr<domain_def>();
@@ -133,9 +134,9 @@ private:
         }
     }
 
-    template<int Permission>
+    template<int Permission, typename Func>
     void
-    get_fungible_permission(const symbol_id_type sym_id, std::function<void(const permission_def&)>&& cb) {
+    get_fungible_permission(const symbol_id_type sym_id, Func&& cb) {
         using namespace internal;
 
         auto fungible = make_empty_cache_ptr<fungible_def>();
@@ -152,8 +153,9 @@ private:
         }
     }
 
+    template<typename Func>
     void
-    get_group(const group_name& name, std::function<void(const group_def&)>&& cb) {
+    get_group(const group_name& name, Func&& cb) {
         auto group = make_empty_cache_ptr<group_def>();
         READ_DB_TOKEN(token_type::group, std::nullopt, name, group, unknown_group_exception, "Cannot find group: {}", name);
 
@@ -202,11 +204,14 @@ private:
     satisfied_node(const group& group, const group::node& node, uint32_t depth) {
         FC_ASSERT(depth < max_recursion_depth_);
         FC_ASSERT(!node.is_leaf());
+        // nodes and keys are already flattened in group which is cached unpacked,
+        // children are visited in place without going through callbacks
         auto vistor = weight_tally_visitor(this);
-        group.visit_node(node, [&](const auto& n) {
+        for(auto i = 0u; i < node.size; i++) {
+            auto& n = group.nodes_[node.index + i];
             FC_ASSERT(!n.is_root());
             if(n.is_leaf()) {
-                vistor(group.get_leaf_key(n), n.weight);
+                vistor(group.keys_[n.index], n.weight);
             }
             else {
                 if(satisfied_node(group, n, depth + 1)) {
@@ -214,12 +219,8 @@ private:
                 }
             }
             if(vistor.total_weight() >= node.threshold) {
-                return false;  // no need to visit more nodes
+                return true;  // no need to visit more nodes
             }
-            return true;
-        });
-        if(vistor.total_weight() >= node.threshold) {
-            return true;
         }
         return false;
     }
@@ -240,6 +241,28 @@ private:
     satisfied_permission(const permission_def& permission, const action& action) {
         using namespace internal;
 
+        // most permissions are made of keys only, they're checked without dispatching on refs
+        switch(permission.shape) {
+        case permission_def::single_key: {
+            return weight_tally_visitor(this)(permission.authorizers[0].ref.get_account(), 1) == 1;
+        }
+        case permission_def::keys_only: {
+            auto total_weight = 0u;
+            for(const auto& aw : permission.authorizers) {
+                if(weight_tally_visitor(this)(aw.ref.get_account(), 1) == 1) {
+                    total_weight += aw.weight;
+                    if(total_weight >= permission.threshold) {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+        default: {
+            break;
+        }
+        }  // switch
+
         uint32_t total_weight = 0;
         for(const auto& aw : permission.authorizers) {
             auto& ref        = aw.ref;
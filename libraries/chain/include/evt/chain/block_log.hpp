@@ -3,6 +3,9 @@
  *  @copyright defined in evt/LICENSE.txt
  */
 #pragma once
+#include <fstream>
+#include <functional>
+#include <optional>
 #include <fc/filesystem.hpp>
 #include <evt/chain/block.hpp>
 #include <evt/chain/genesis_state.hpp>
@@ -13,6 +16,18 @@ namespace detail {
 class block_log_impl;
 }
 
+struct block_log_config {
+    uint32_t stride            = 0;           // blocks in each file when log is split, 0 means it's never split
+    uint32_t max_retained      = 0;           // split files kept in retained dir, the oldest ones are archived or removed beyond it, 0 for no limit
+    fc::path retained_dir      = "retained";  // relative ones are under blocks dir
+    fc::path archive_dir;                     // files beyond the limit are moved here, they're removed if it's empty
+    bool     compress_retained = false;       // retained files are compressed in background
+    bool     async_append      = false;       // blocks are written in background thread, pending ones are read from memory
+    uint32_t max_pending       = 1024;        // appending waits once there're this many pending blocks
+    uint32_t sync_interval     = 0;           // files are fsynced once this many blocks are written since last time, 0 to never fsync
+    uint32_t recovery_threads  = 1;           // threads verifying blocks when index is rebuilt, 1 to walk them sequentially
+};
+
 /* The block log is an external append only log of the blocks with a header. Blocks should only
     * be written to the log after they irreverisble as the log is append only. The log is a doubly
     * linked list of blocks. There is a secondary index file of only block positions that enables
@@ -36,18 +51,30 @@ class block_log_impl;
     *
     * The main file is the only file that needs to persist. The index file can be reconstructed during a
     * linear scan of the main file.
+    *
+    * When `stride` of config is set, current file is split once it has `stride` blocks and it's moved into
+    * the retained directory as blocks-FIRST-LAST.log with its own index blocks-FIRST-LAST.index. Each one is
+    * a complete log with the header of version 2, names of them serve as the catalog of blocks.
+    *
+    * When `compress_retained` is set, each retained file is rewritten as blocks-FIRST-LAST.zlog, which has
+    * the same header followed by one zstd frame for each block. Its index blocks-FIRST-LAST.zindex has the
+    * position of each frame and then the end of last one, so that any block is decompressed alone.
     */
 
 class block_log {
 public:
-    block_log(const fc::path& data_dir);
+    block_log(const fc::path& data_dir, const block_log_config& conf = block_log_config());
     block_log(block_log&& other);
     ~block_log();
 
+    // returns npos when `async_append` is set, block is written later in background
     uint64_t append(const signed_block_ptr& b);
+    // waits till all the pending blocks are written when `async_append` is set
     void     flush();
     void     reset(const genesis_state& gs, const signed_block_ptr& genesis_block, uint32_t first_block_num = 1);
 
+    // blocks are read from memory mapped files, so they're safe to be called in other threads
+    // and never block each other, only `append` and `reset` are required to be called in one thread
     std::pair<signed_block_ptr, uint64_t> read_block(uint64_t file_pos) const;
     signed_block_ptr                      read_block_by_num(uint32_t block_num) const;
     signed_block_ptr
@@ -55,20 +82,35 @@ public:
         return read_block_by_num(block_header::num_from_id(id));
     }
 
+    // header of block and its receipt at `index`, the receipts before it are skipped without unpacking
+    // their transactions. returns empty if the block is not found or there's no such receipt
+    struct transaction_location {
+        signed_block_header header;
+        transaction_receipt receipt;
+    };
+    std::optional<transaction_location> read_transaction(uint32_t block_num, uint32_t index) const;
+
     /**
-          * Return offset of block in file, or block_log::npos if it does not exist.
+          * Return offset of block in current file, or block_log::npos if it does not exist.
           */
     uint64_t                get_block_pos(uint32_t block_num) const;
     signed_block_ptr        read_head() const;
     const signed_block_ptr& head() const;
-    uint32_t                first_block_num() const;
+    uint32_t                first_block_num() const;  // of current file
+    uint32_t                first_available_block_num() const;  // including the retained files
+
+    // durable blocks are flushed, and fsynced as well when `sync_interval` is set
+    // callback is called with the last durable one, in the writer thread when `async_append` is set
+    void     set_durable_callback(std::function<void(uint32_t)> cb);
+    uint32_t last_durable_block_num() const;
 
     static const uint64_t npos = std::numeric_limits<uint64_t>::max();
 
     static const uint32_t min_supported_version;
     static const uint32_t max_supported_version;
 
-    static fc::path repair_log(const fc::path& data_dir, uint32_t truncate_at_block = 0);
+    // blocks are verified in parallel chunks when `threads` > 1, chunks are split by the trailing positions of blocks
+    static fc::path repair_log(const fc::path& data_dir, uint32_t truncate_at_block = 0, const fc::path& retained_dir = "retained", uint32_t threads = 1);
 
     static genesis_state extract_genesis_state(const fc::path& data_dir);
 
@@ -77,6 +119,27 @@ private:
     void construct_index();
 
     std::unique_ptr<detail::block_log_impl> my;
+
+    friend class block_log_reader;
+};
+
+/**
+ * Sequential reader of the block log, blocks are read forward from `first_block_num` to the head
+ * of the log when it's constructed, across the retained files.
+ * Blocks are read from the mappings, so it can be used in other thread as long as the log is not reset meanwhile.
+ */
+class block_log_reader {
+public:
+    block_log_reader(const block_log& log, uint32_t first_block_num);
+
+public:
+    // returns nullptr when there's no more blocks
+    signed_block_ptr read_next();
+
+private:
+    const block_log& log_;
+    uint32_t         next_num_;
+    uint32_t         last_num_;
 };
 
 }}  // namespace evt::chain
@@ -23,6 +23,14 @@ struct block_state : public block_header_state {
     /// this data is redundant with the data stored in block, but facilitates
     /// recapturing transactions when we pop a block
     vector<transaction_metadata_ptr> trxs;
+
+    // drops the data only needed while the block can be popped, it's called when the block becomes irreversible.
+    // transactions with their recovered keys are released, `block` is kept for fetching and queued consumers
+    void
+    trim() {
+        trxs.clear();
+        trxs.shrink_to_fit();
+    }
 };
 
 using block_state_ptr = std::shared_ptr<block_state>;
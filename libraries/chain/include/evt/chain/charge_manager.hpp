@@ -21,7 +21,13 @@ using act_charge_result = std::tuple<uint32_t, uint32_t>;
 
 namespace internal {
 
+// charges with `kDynamic` set depend on the data of action besides its size,
+// others are taken from the constants without invoking
 struct base_act_charge {
+    static constexpr uint32_t kCpu         = 15;
+    static constexpr uint32_t kExtraFactor = 10;
+    static constexpr bool     kDynamic     = false;
+
     static uint32_t
     storage(const action& act) {
         return act.data.size();
@@ -29,18 +35,56 @@ struct base_act_charge {
 
     static uint32_t
     cpu(const action& act) {
-        return 15;
+        return kCpu;
     }
 
     static uint32_t
     extra_factor(const action& act) {
-        return 10;
+        return kExtraFactor;
     }
 };
 
 template<uint64_t N, typename T>
 struct act_charge : public base_act_charge {};
 
+using namespace contracts;
+
+template<typename T>
+struct act_charge<N(issuetoken), T> : public base_act_charge {
+    static constexpr bool kDynamic = true;
+
+    static uint32_t
+    cpu(const action& act) {
+        auto& itact = act.data_as<add_clr_t<T>>();
+        if(itact.names.empty()) {
+            return 15;
+        }
+        return 15 + (itact.names.size() - 1) * 3;
+    }
+};
+
+template<typename T>
+struct act_charge<N(addmeta), T> : public base_act_charge {
+    static constexpr uint32_t kCpu         = 600;
+    static constexpr uint32_t kExtraFactor = 10;
+};
+
+template<typename T>
+struct act_charge<N(issuefungible), T> : public base_act_charge {
+    static constexpr bool kDynamic = true;
+
+    static uint32_t
+    extra_factor(const action& act) {
+        auto& ifact = act.data_as<add_clr_t<T>>();
+        auto sym = ifact.number.sym();
+        // set charge to zero when issuing EVT
+        if(sym == evt_sym()) {
+            return 0;
+        }
+        return 1;
+    }
+};
+
 template<uint64_t N>
 struct get_act_charge {
     template<typename T>
@@ -50,9 +94,30 @@ struct get_act_charge {
         uint32_t s = 0;
 
         s += charge::storage(act) * config.base_storage_charge_factor;
-        s += charge::cpu(act) * config.base_cpu_charge_factor;
+        if constexpr(!charge::kDynamic) {
+            s += charge::kCpu * config.base_cpu_charge_factor;
+            return std::make_tuple(s, charge::kExtraFactor);
+        }
+        else {
+            s += charge::cpu(act) * config.base_cpu_charge_factor;
+            return std::make_tuple(s, charge::extra_factor(act));
+        }
+    }
+};
 
-        return std::make_tuple(s, charge::extra_factor(act));
+struct act_charge_info {
+    uint32_t cpu;
+    uint32_t extra_factor;
+    bool     dynamic;
+};
+
+template<uint64_t N>
+struct get_act_charge_info {
+    template<typename T>
+    static constexpr act_charge_info
+    get() {
+        using charge = act_charge<N, T>;
+        return act_charge_info { charge::kCpu, charge::kExtraFactor, charge::kDynamic };
     }
 };
 
@@ -61,8 +126,14 @@ struct get_act_charge {
 class charge_manager {
 public:
     charge_manager(const controller& control, const evt_execution_context& exec_ctx)
-        : control_(control)
-        , config_(control.get_global_properties().configuration)
+        : config_(control.get_global_properties().configuration)
+        , head_block_num_(control.head_block_num())
+        , exec_ctx_(exec_ctx) {}
+
+    // reads nothing from controller, so charges can be calculated outside main thread with a copy of config
+    charge_manager(const chain_config& config, uint32_t head_block_num, const evt_execution_context& exec_ctx)
+        : config_(config)
+        , head_block_num_(head_block_num)
         , exec_ctx_(exec_ctx) {}
 
 private:
@@ -100,6 +171,12 @@ public:
             if(act.index_ == -1) {
                 act.index_ = exec_ctx_.index_of(act.name);
             }
+            auto& info = exec_ctx_.get_constant<get_act_charge_info, act_charge_info>(act.index_);
+            if(!info.dynamic) {
+                auto as = base_act_charge::storage(act) * config_.base_storage_charge_factor + info.cpu * config_.base_cpu_charge_factor;
+                s += (as + pts) * info.extra_factor;
+                continue;
+            }
             auto as = exec_ctx_.invoke<get_act_charge, act_charge_result>(act.index_, act, config_);
             s += (std::get<0>(as) + pts) * std::get<1>(as);  // std::get<1>(as): extra factor per action
         }
@@ -107,11 +184,11 @@ public:
         s *= config_.global_charge_factor;
 
 #ifdef MAINNET_BUILD
-        if(control_.head_block_num() >= 2750000) {
+        if(head_block_num_ >= 2750000) {
             s /= 1000'000;
         }
 #else
-        if(control_.head_block_num() >= 100) {
+        if(head_block_num_ >= 100) {
             s /= 1000'000;
         }
 #endif
@@ -119,54 +196,9 @@ public:
     }
 
 private:
-    const controller&            control_;
     const chain_config&          config_;
+    uint32_t                     head_block_num_;
     const evt_execution_context& exec_ctx_;
 };
 
-namespace internal {
-
-using namespace contracts;
-
-template<typename T>
-struct act_charge<N(issuetoken), T> : public base_act_charge {
-    static uint32_t
-    cpu(const action& act) {
-        auto& itact = act.data_as<add_clr_t<T>>();
-        if(itact.names.empty()) {
-            return 15;
-        }
-        return 15 + (itact.names.size() - 1) * 3;
-    }
-};
-
-template<typename T>
-struct act_charge<N(addmeta), T> : public base_act_charge {
-    static uint32_t
-    cpu(const action& act) {
-        return 600;
-    }
-
-    static uint32_t
-    extra_factor(const action& act) {
-        return 10;
-    }
-};
-
-template<typename T>
-struct act_charge<N(issuefungible), T> : public base_act_charge {
-    static uint32_t
-    extra_factor(const action& act) {
-        auto& ifact = act.data_as<add_clr_t<T>>();
-        auto sym = ifact.number.sym();
-        // set charge to zero when issuing EVT
-        if(sym == evt_sym()) {
-            return 0;
-        }
-        return 1;
-    }
-};
-
-}  // namespace internal
-
 }}  // namespace evt::chain
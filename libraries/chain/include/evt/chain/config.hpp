@@ -18,10 +18,14 @@ const static auto reversible_blocks_dir_name       = "reversible";
 const static auto default_token_database_dir_name  = "tokendb";
 const static auto default_reversible_cache_size    = 340*1024*1024ll;  /// 1MB * 340 blocks based on 21 producer BFT delay
 const static auto default_reversible_guard_size    = 2*1024*1024ll;    /// 1MB * 2 blocks based on 21 producer BFT delay
+const static auto token_database_journal_filename  = "savepoints.journal";
 const static auto token_database_persisit_filename = "savepoints.log";
+const static auto token_database_hotkeys_filename  = "hotkeys.dat";
+const static auto token_database_format_filename   = "format";
 
 const static auto default_state_dir_name        = "state";
 const static auto forkdb_filename               = "forkdb.dat";
+const static auto forkdb_journal_filename       = "forkdb.journal";
 const static auto default_state_size            = 1*1024*1024*1024ll;
 const static auto default_state_guard_size      = 128*1024*1024ll;
 
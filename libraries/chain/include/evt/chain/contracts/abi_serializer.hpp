@@ -28,6 +28,8 @@ struct abi_traverse_context;
 struct abi_traverse_context_with_path;
 struct binary_to_variant_context;
 struct variant_to_binary_context;
+struct json_writer;
+struct json_packer;
 }  // namespace impl
 
 /**
@@ -39,6 +41,10 @@ struct abi_serializer : boost::noncopyable {
     abi_serializer(const abi_def& abi, const std::chrono::microseconds max_serialization_time);
     void set_abi(const abi_def& abi);
 
+    // resolves the types of all the versions of actions in `exec_ctx` once, so that actions are converted
+    // with it without looking up their types by names. Not thread-safe, should be done before being shared
+    void bind_actions(const execution_context& exec_ctx);
+
     type_name resolve_type(const type_name& t) const;
     type_name fundamental_type(const type_name& type) const;
 
@@ -60,9 +66,19 @@ struct abi_serializer : boost::noncopyable {
     fc::variant binary_to_variant(const type_name& type, const bytes& binary, const execution_context&, bool short_path = false) const;
     fc::variant binary_to_variant(const type_name& type, fc::datastream<const char*>& binary, const execution_context&, bool short_path = false) const;
 
+    // same as converting the result of `binary_to_variant` by fc::json::to_string but without building variants
+    std::string binary_to_json(const type_name& type, const bytes& binary, const execution_context&, bool short_path = false) const;
+
     bytes variant_to_binary(const type_name& type, const fc::variant& var, const execution_context&,  bool short_path = false) const;
     void  variant_to_binary(const type_name& type, const fc::variant& var, fc::datastream<char*>& ds, const execution_context&, bool short_path = false) const;
 
+    // same as `variant_to_binary` of the parsed json but packs directly from json if possible
+    bytes json_to_binary(const type_name& type, const std::string& json, const execution_context&, bool short_path = false) const;
+
+    // parses one packed transaction or an array of them (`batch`) from json directly in the same way as `from_variant`
+    // returns false if it cannot be done in this way, then caller should parse json into variant instead
+    bool json_to_packed_transactions(const std::string& json, bool batch, std::vector<packed_transaction>& ptrxs, const execution_context&) const;
+
     template <typename T>
     void to_variant(const T& o, fc::variant& vo, const execution_context&) const;
 
@@ -93,17 +109,60 @@ struct abi_serializer : boost::noncopyable {
 
     static const size_t max_recursion_depth = 32;  // arbitrary depth to prevent infinite recursion
 
+private:
+    // type resolved when abi is set, so that traversal doesn't need to look up the maps by names
+    struct type_plan {
+        enum kind_t { kUnknown = 0, kBuiltin, kArray, kOptional, kVariant, kEnum, kStruct };
+
+        struct field_op {
+            const type_plan* type;
+            bool             is_optional;  // optional field can be omitted in input object
+        };
+
+        kind_t    kind = kUnknown;
+        type_name name;   // type name as referenced
+        type_name rtype;  // resolved type name
+
+        const pair<unpack_function, pack_function>* builtin          = nullptr;
+        bool                                        builtin_array    = false;
+        bool                                        builtin_optional = false;
+
+        const type_plan* element = nullptr;  // element of array or optional, integer type of enum
+        const type_plan* base    = nullptr;  // base of struct
+
+        std::map<type_name, struct_def>::const_iterator  s_itr;
+        std::map<type_name, variant_def>::const_iterator v_itr;
+        std::map<type_name, enum_def>::const_iterator    e_itr;
+
+        small_vector<field_op, 8> fields;  // fields of struct or variant in order
+    };
+    using type_plans = std::map<type_name, type_plan>;
+
 private:  
     void configure_built_in_types();
 
+    void             build_plans();
+    const type_plan& build_plan(const type_name& type, type_plans& plans) const;
+
     fc::variant _binary_to_variant(const type_name& type, const bytes& binary, impl::binary_to_variant_context& ctx) const;
     fc::variant _binary_to_variant(const type_name& type, fc::datastream<const char*>& binary, impl::binary_to_variant_context& ctx) const;
-    void        _binary_to_variant(const type_name& type, fc::datastream<const char*>& stream,
+    fc::variant _binary_to_variant(const type_plan& plan, const bytes& binary, impl::binary_to_variant_context& ctx) const;
+    fc::variant _binary_to_variant(const type_plan& plan, fc::datastream<const char*>& stream, impl::binary_to_variant_context& ctx) const;
+    void        _binary_to_variant(const type_plan& plan, fc::datastream<const char*>& stream,
                                    fc::mutable_variant_object& obj, impl::binary_to_variant_context& ctx) const;
 
+    void _binary_to_json(const type_plan& plan, fc::datastream<const char*>& stream, impl::json_writer& writer, impl::binary_to_variant_context& ctx) const;
+    void _binary_to_json_fields(const type_plan& plan, fc::datastream<const char*>& stream, impl::json_writer& writer, impl::binary_to_variant_context& ctx) const;
+
     bytes _variant_to_binary(const type_name& type, const fc::variant& var, impl::variant_to_binary_context& ctx) const;
+    bytes _variant_to_binary(const type_plan& plan, const fc::variant& var, impl::variant_to_binary_context& ctx) const;
     void  _variant_to_binary(const type_name& type, const fc::variant& var,
                              fc::datastream<char*>& ds, impl::variant_to_binary_context& ctx) const;
+    void  _variant_to_binary(const type_plan& plan, const fc::variant& var,
+                             fc::datastream<char*>& ds, impl::variant_to_binary_context& ctx) const;
+
+    // plan of current version of action, nullptr if its type is not defined in abi
+    const type_plan* get_action_plan(name act, const execution_context& exec_ctx) const;
 
     bool _is_type(const type_name& type) const;
 
@@ -117,6 +176,12 @@ private:
 
     std::map<type_name, pair<unpack_function, pack_function>> built_in_types_;
 
+    type_plans plans_;  // plans of all the types defined in abi
+
+    // plans of actions resolved by `bind_actions`, indexed by action index then version - 1 of `bound_ctx_`
+    const execution_context*                       bound_ctx_ = nullptr;
+    std::vector<small_vector<const type_plan*, 4>> action_plans_;
+
     std::chrono::microseconds max_serialization_time_;
 
 private:
@@ -124,6 +189,7 @@ private:
     friend struct impl::abi_to_variant;
     friend struct impl::abi_traverse_context;
     friend struct impl::abi_traverse_context_with_path;
+    friend struct impl::json_packer;
 };
 
 namespace impl {
@@ -159,9 +225,13 @@ public:
     const execution_context& exec_ctx;
 
 protected:
+    // reading clock costs more than entering one scope, so deadline is only checked every few scopes
+    static constexpr uint32_t kDeadlineCheckInterval = 16;
+
     std::chrono::microseconds             max_serialization_time;
     std::chrono::steady_clock::time_point deadline;
     size_t                                recursion_depth;
+    uint32_t                              scopes_entered = 0;
 };
 
 struct empty_path_root {};
@@ -412,12 +482,12 @@ struct abi_to_variant {
         mvo("key", act.key);
 
         const auto& self = ctx.self;
-        auto        type = ctx.exec_ctx.get_acttype_name(act.name);
-        if(!type.empty()) {
+        auto        plan = self.get_action_plan(act.name, ctx.exec_ctx);
+        if(plan != nullptr) {
             try {
-                binary_to_variant_context _ctx(ctx, type);
+                binary_to_variant_context _ctx(ctx, plan->name);
                 _ctx.short_path = true;  // Just to be safe while avoiding the complexity of threading an override boolean all over the place
-                mvo("data", self._binary_to_variant(type, act.data, _ctx));
+                mvo("data", self._binary_to_variant(*plan, act.data, _ctx));
                 mvo("hex_data", act.data);
             }
             catch(...) {
@@ -570,11 +640,11 @@ struct abi_from_variant {
             }
             else if(data.is_object()) {
                 const auto& self = ctx.self;
-                auto        type = ctx.exec_ctx.get_acttype_name(act.name);
-                if(!type.empty()) {
-                    auto _ctx = variant_to_binary_context(ctx, type);
+                auto        plan = self.get_action_plan(act.name, ctx.exec_ctx);
+                if(plan != nullptr) {
+                    auto _ctx = variant_to_binary_context(ctx, plan->name);
                     _ctx.short_path  = true;  // Just to be safe while avoiding the complexity of threading an override boolean all over the place
-                    act.data         = self._variant_to_binary(type, data, _ctx);
+                    act.data         = self._variant_to_binary(*plan, data, _ctx);
                     valid_empty_data = act.data.empty();
                 }
             }
@@ -86,7 +86,7 @@ validate(const group& group) {
     return validate(group, root);
 }
 
-auto make_permission_checker = [](const auto& tokendb) {
+auto make_permission_checker = [](auto& tokendb_cache) {
     auto checker = [&](const auto& p, auto allowed_owner) {
         for(const auto& a : p.authorizers) {
             auto& ref = a.ref;
@@ -102,7 +102,7 @@ auto make_permission_checker = [](const auto& tokendb) {
             }
             case authorizer_ref::group_t: {
                 auto& name = ref.get_group();
-                auto dbexisted = tokendb.exists_token(token_type::group, std::nullopt, name);
+                auto dbexisted = tokendb_cache.exists_token(token_type::group, std::nullopt, name);
                 EVT_ASSERT(dbexisted, unknown_group_exception, "Group ${name} does not exist.", ("name", name));
                 break;
             }
@@ -213,25 +213,29 @@ get_db_prefix<token_def>(const token_def& v) {
         tokendb_cache.put_token(TYPE, action_op::put, get_db_prefix(VALUE), get_db_key(VALUE), VALUE); \
     }
 
-#define PUT_DB_ASSET(ADDR, VALUE)                                     \
-    {                                                                 \
-        auto dv = make_db_value(VALUE);                               \
-        tokendb.put_asset(ADDR, VALUE.sym.id(), dv.as_string_view()); \
+#define PUT_DB_ASSET(ADDR, VALUE)                                                           \
+    {                                                                                       \
+        auto dv = make_db_value(VALUE);                                                     \
+        tokendb.put_asset(ADDR, VALUE.sym.id(), dv.as_string_view());                       \
+        context.add_ft_balance(                                                             \
+            ft_balance { .addr = ADDR, .sym_id = VALUE.sym.id(), .amount = VALUE.amount }); \
     }
 
-#define READ_DB_TOKEN(TYPE, PREFIX, KEY, VPTR, EXCEPTION, FORMAT, ...)      \
-    try {                                                                   \
-        using vtype = typename decltype(VPTR)::element_type;                \
-        VPTR = tokendb_cache.template read_token<vtype>(TYPE, PREFIX, KEY); \
-    }                                                                       \
-    catch(token_database_exception&) {                                      \
-        EVT_THROW2(EXCEPTION, FORMAT, __VA_ARGS__);                         \
+// misses are only thrown here as the errors of actions, lookups below never throw for them
+#define READ_DB_TOKEN(TYPE, PREFIX, KEY, VPTR, EXCEPTION, FORMAT, ...)              \
+    {                                                                               \
+        using vtype = typename decltype(VPTR)::element_type;                        \
+        auto rr = tokendb_cache.template try_read_token<vtype>(TYPE, PREFIX, KEY);  \
+        if(!rr.found()) {                                                           \
+            EVT_THROW2(EXCEPTION, FORMAT, __VA_ARGS__);                             \
+        }                                                                           \
+        VPTR = std::move(rr.value);                                                 \
     }
-    
-#define READ_DB_TOKEN_NO_THROW(TYPE, PREFIX, KEY, VPTR)                                          \
-    {                                                                                            \
-        using vtype = typename decltype(VPTR)::element_type;                                     \
-        VPTR = tokendb_cache.template read_token<vtype>(TYPE, PREFIX, KEY, true /* no throw */); \
+
+#define READ_DB_TOKEN_NO_THROW(TYPE, PREFIX, KEY, VPTR)                                   \
+    {                                                                                     \
+        using vtype = typename decltype(VPTR)::element_type;                              \
+        VPTR = tokendb_cache.template try_read_token<vtype>(TYPE, PREFIX, KEY).value;     \
     }
 
 #define MAKE_PROPERTY(AMOUNT, SYM)                                            \
@@ -246,21 +250,19 @@ get_db_prefix<token_def>(const token_def& v) {
     EVT_ASSERT2(VALUEREF.sym == PROVIDED, asset_symbol_exception, "Provided symbol({}) is invalid, expected: {}", PROVIDED, VALUEREF.sym);
 
 #define READ_DB_ASSET(ADDR, SYM, VALUEREF)                                                              \
-    try {                                                                                               \
+    {                                                                                                   \
         auto str = std::string();                                                                       \
-        tokendb.read_asset(ADDR, SYM.id(), str);                                                        \
-                                                                                                        \
+        if(tokendb.try_read_asset(ADDR, SYM.id(), str) == read_status::not_found) {                     \
+            EVT_THROW2(balance_exception, "There's no balance left in {} with sym id: {}", ADDR, SYM.id()); \
+        }                                                                                               \
         extract_db_value(str, VALUEREF);                                                                \
     }                                                                                                   \
-    catch(token_database_exception&) {                                                                  \
-        EVT_THROW2(balance_exception, "There's no balance left in {} with sym id: {}", ADDR, SYM.id()); \
-    }                                                                                                   \
     CHECK_SYM(VALUEREF, SYM);
 
 #define READ_DB_ASSET_NO_THROW(ADDR, SYM, VALUEREF)                         \
     {                                                                       \
         auto str = std::string();                                           \
-        if(!tokendb.read_asset(ADDR, SYM.id(), str, true /* no throw */)) { \
+        if(tokendb.try_read_asset(ADDR, SYM.id(), str) == read_status::not_found) { \
             VALUEREF = MAKE_PROPERTY(0, SYM);                               \
             context.add_new_ft_holder(                                      \
                 ft_holder { .addr = ADDR, .sym_id = SYM.id() });            \
@@ -274,7 +276,7 @@ get_db_prefix<token_def>(const token_def& v) {
 #define READ_DB_ASSET_NO_THROW_NO_NEW(ADDR, SYM, VALUEREF)                  \
     {                                                                       \
         auto str = std::string();                                           \
-        if(!tokendb.read_asset(ADDR, SYM.id(), str, true /* no throw */)) { \
+        if(tokendb.try_read_asset(ADDR, SYM.id(), str) == read_status::not_found) { \
             VALUEREF = MAKE_PROPERTY(0, SYM);                               \
         }                                                                   \
         else {                                                              \
@@ -299,7 +301,7 @@ EVT_ACTION_IMPL_BEGIN(newdomain) {
         check_name_reserved(ndact.name);
 
         DECLARE_TOKEN_DB()
-        EVT_ASSERT(!tokendb.exists_token(token_type::domain, std::nullopt, ndact.name), domain_duplicate_exception,
+        EVT_ASSERT(!tokendb_cache.exists_token(token_type::domain, std::nullopt, ndact.name), domain_duplicate_exception,
             "Domain ${name} already exists.", ("name",ndact.name));
 
         EVT_ASSERT(ndact.issue.name == "issue", permission_type_exception,
@@ -316,7 +318,7 @@ EVT_ACTION_IMPL_BEGIN(newdomain) {
         EVT_ASSERT(validate(ndact.manage), permission_type_exception,
             "Manage permission is not valid, which may be caused by duplicated keys.");
 
-        auto pchecker = make_permission_checker(tokendb);
+        auto pchecker = make_permission_checker(tokendb_cache);
         pchecker(ndact.issue, false);
         pchecker(ndact.transfer, true /* allowed_owner */);
         pchecker(ndact.manage, false);
@@ -350,30 +352,41 @@ EVT_ACTION_IMPL_BEGIN(issuetoken) {
         }
 
         DECLARE_TOKEN_DB()
-        EVT_ASSERT2(tokendb.exists_token(token_type::domain, std::nullopt, itact.domain), unknown_domain_exception,
+        EVT_ASSERT2(tokendb_cache.exists_token(token_type::domain, std::nullopt, itact.domain), unknown_domain_exception,
             "Cannot find domain: {}.", itact.domain);
 
-        auto check_name = [&](const auto& name) {
+        // lookup all the names in one batch
+        auto existed = tokendb_cache.exists_tokens(token_type::token, itact.domain, itact.names);
+
+        auto check_name = [&](const auto& name, auto exist) {
             check_name_reserved(name);
-            EVT_ASSERT2(!tokendb.exists_token(token_type::token, itact.domain, name), token_duplicate_exception,
+            EVT_ASSERT2(!exist, token_duplicate_exception,
                 "Token: {} in {} is already exists.", name, itact.domain);
         };
 
-        auto values  = small_vector<db_value, 4>();
-        auto data    = small_vector<std::string_view, 4>();
-        values.reserve(itact.names.size());
-        data.reserve(itact.names.size());
+        // values of the tokens only differ in names, so domain and owner are packed once and shared,
+        // layout here should be the same as the reflection of `token_def`: domain, name and owner
+        auto domain = make_db_value(itact.domain);
+        auto owner  = make_db_value(itact.owner);
 
-        auto token   = token_def();
-        token.domain = itact.domain;
-        token.owner  = itact.owner;
+        auto total = size_t(0);
+        for(auto i = 0u; i < itact.names.size(); i++) {
+            check_name(itact.names[i], existed[i]);
+            total += fc::raw::pack_size(itact.names[i]);
+        }
+        total += (domain.size() + owner.size()) * itact.names.size();
 
-        for(auto& n : itact.names) {
-            check_name(n);
+        auto buf  = std::string(total, '\0');
+        auto data = small_vector<std::string_view, 4>();
+        data.reserve(itact.names.size());
 
-            token.name = n;
-            values.emplace_back(make_db_value(token));
-            data.emplace_back(values.back().as_string_view());
+        auto ds = fc::datastream<char*>(buf.data(), buf.size());
+        for(auto& n : itact.names) {
+            auto begin = ds.pos();
+            ds.write(domain.as_string_view().data(), domain.size());
+            fc::raw::pack(ds, n);
+            ds.write(owner.as_string_view().data(), owner.size());
+            data.emplace_back(begin, ds.pos() - begin);
         }
 
         tokendb.put_tokens(token_type::token, action_op::add, itact.domain, std::move(itact.names), data);
@@ -446,8 +459,7 @@ EVT_ACTION_IMPL_BEGIN(destroytoken) {
         READ_DB_TOKEN(token_type::domain, std::nullopt, dtact.domain, domain, unknown_domain_exception,
             "Cannot find domain: {}", dtact.domain);       
 
-        auto dd = get_metavalue(*domain, get_metakey<reserved_meta_key::disable_destroy>(domain_metas));
-        if(dd.has_value() && *dd == "true") {
+        if(check_metaflag(*domain, meta_flag::disable_destroy)) {
             EVT_THROW(token_cannot_destroy_exception, "Token in this domain: ${d} cannot be destroyed", ("d",dtact.domain));
         }
 
@@ -480,7 +492,7 @@ EVT_ACTION_IMPL_BEGIN(newgroup) {
         check_name_reserved(ngact.name);
         
         DECLARE_TOKEN_DB()
-        EVT_ASSERT(!tokendb.exists_token(token_type::group, std::nullopt, ngact.name), group_duplicate_exception,
+        EVT_ASSERT(!tokendb_cache.exists_token(token_type::group, std::nullopt, ngact.name), group_duplicate_exception,
             "Group ${name} already exists.", ("name",ngact.name));
         EVT_ASSERT(validate(ngact.group), group_type_exception, "Input group is not valid.");
 
@@ -527,7 +539,7 @@ EVT_ACTION_IMPL_BEGIN(updatedomain) {
         auto domain = make_empty_cache_ptr<domain_def>();
         READ_DB_TOKEN(token_type::domain, std::nullopt, udact.name, domain, unknown_domain_exception,"Cannot find domain: {}", udact.name);
 
-        auto pchecker = make_permission_checker(tokendb);
+        auto pchecker = make_permission_checker(tokendb_cache);
         if(udact.issue.has_value()) {
             EVT_ASSERT(udact.issue->name == "issue", permission_type_exception,
                 "Name ${name} does not match with the name of issue permission.", ("name",udact.issue->name));
@@ -538,8 +550,7 @@ EVT_ACTION_IMPL_BEGIN(updatedomain) {
             domain->issue = std::move(*udact.issue);
         }
         if(udact.transfer.has_value()) {
-            auto dt = get_metavalue(*domain, get_metakey<reserved_meta_key::disable_set_transfer>(domain_metas));
-            if(dt.has_value() && *dt == "true") {
+            if(check_metaflag(*domain, meta_flag::disable_set_transfer)) {
                 EVT_THROW(domain_cannot_update_exception, "Transfer permission of this domain cannot be updated");
             }
 
@@ -596,7 +607,7 @@ calculate_passive_bonus(token_database_cache& tokendb_cache,
     }
 
     auto bonus = pbs->base_charge;
-    bonus += (int64_t)boost::multiprecision::floor(pbs->rate.value() * amount);  // add trx fees
+    bonus += pbs->rate.floor_mul(amount);  // add trx fees
     if(pbs->minimum_charge.has_value()) {
         bonus = std::max(*pbs->minimum_charge, bonus);    // >= minimum
     }
@@ -717,7 +728,7 @@ EVT_ACTION_IMPL_BEGIN(newfungible) {
 
         DECLARE_TOKEN_DB()
 
-        EVT_ASSERT(!tokendb.exists_token(token_type::fungible, std::nullopt, nfact.sym.id()), fungible_duplicate_exception,
+        EVT_ASSERT(!tokendb_cache.exists_token(token_type::fungible, std::nullopt, nfact.sym.id()), fungible_duplicate_exception,
             "FT with symbol id: ${s} is already existed", ("s",nfact.sym.id()));
 
         EVT_ASSERT(nfact.issue.name == "issue", permission_type_exception,
@@ -736,7 +747,7 @@ EVT_ACTION_IMPL_BEGIN(newfungible) {
                 "Transfer permission is not valid, which may be caused by duplicated keys.");
         }
 
-        auto pchecker = make_permission_checker(tokendb);
+        auto pchecker = make_permission_checker(tokendb_cache);
         pchecker(nfact.issue, false);
         pchecker(nfact.manage, false);
         if constexpr(EVT_ACTION_VER() > 1) {
@@ -759,12 +770,17 @@ EVT_ACTION_IMPL_BEGIN(newfungible) {
         }
         else {
             // set with default transfer(owner only)
-            fungible.transfer = permission_def {
-                .name        = N(transfer),
-                .threshold   = 1,
-                .authorizers = { authorizer_weight(authorizer_ref(), 1) }
-            };
-            fungible.metas.emplace_back(get_metakey<reserved_meta_key::disable_set_transfer>(fungible_metas), "true", authorizer_ref(nfact.creator));
+            fungible.transfer             = permission_def();
+            fungible.transfer.name        = N(transfer);
+            fungible.transfer.threshold   = 1;
+            fungible.transfer.authorizers = { authorizer_weight(authorizer_ref(), 1) };
+            fungible.flags |= (meta_flags)meta_flag::disable_set_transfer;
+
+            auto ms   = meta_set();
+            ms.domain = N128(.fungible);
+            ms.key    = name128::from_number(nfact.sym.id());
+            ms.metas.emplace_back(get_metakey<reserved_meta_key::disable_set_transfer>(fungible_metas), "true", authorizer_ref(nfact.creator));
+            tokendb_cache.put_token(token_type::meta, action_op::add, std::nullopt, get_meta_db_key(ms.domain, ms.key), std::move(ms));
         }
         fungible.total_supply = nfact.total_supply;
 
@@ -794,7 +810,7 @@ EVT_ACTION_IMPL_BEGIN(updfungible) {
         READ_DB_TOKEN(token_type::fungible, std::nullopt, ufact.sym_id, fungible, unknown_fungible_exception,
             "Cannot find FT with sym id: {}", ufact.sym_id);
 
-        auto pchecker = make_permission_checker(tokendb);
+        auto pchecker = make_permission_checker(tokendb_cache);
         if(ufact.issue.has_value()) {
             EVT_ASSERT(ufact.issue->name == "issue", permission_type_exception,
                 "Name ${name} does not match with the name of issue permission.", ("name",ufact.issue->name));
@@ -806,8 +822,7 @@ EVT_ACTION_IMPL_BEGIN(updfungible) {
         }
         if constexpr(EVT_ACTION_VER() > 1) {
             if(ufact.transfer.has_value()) {
-                auto dt = get_metavalue(*fungible, get_metakey<reserved_meta_key::disable_set_transfer>(fungible_metas));
-                if(dt.has_value() && *dt == "true") {
+                if(check_metaflag(*fungible, meta_flag::disable_set_transfer)) {
                     EVT_THROW(fungible_cannot_update_exception, "Transfer permission of this FT cannot be updated");
                 }
 
@@ -849,7 +864,7 @@ EVT_ACTION_IMPL_BEGIN(issuefungible) {
         check_address_reserved(ifact.address);
 
         DECLARE_TOKEN_DB()
-        EVT_ASSERT(tokendb.exists_token(token_type::fungible, std::nullopt, sym.id()), fungible_duplicate_exception,
+        EVT_ASSERT(tokendb_cache.exists_token(token_type::fungible, std::nullopt, sym.id()), fungible_duplicate_exception,
             "{sym} FT doesn't exist", ("sym",sym));
 
         auto addr = get_fungible_address(sym);
@@ -1045,6 +1060,33 @@ check_duplicate_meta(const T& v, const meta_key& key) {
     return false;
 }
 
+// reads metas of the owner identified by `domain` and `key`, empty set is returned if there's none
+template<typename CACHE>
+auto
+read_meta_set(CACHE& tokendb_cache, const name128& domain, const name128& key) {
+    auto ms = tokendb_cache.template read_token<meta_set>(token_type::meta, std::nullopt, get_meta_db_key(domain, key), true /* no throw */);
+    if(ms != nullptr) {
+        EVT_ASSERT2(ms->domain == domain && ms->key == key, meta_key_exception,
+            "Metas stored for {}-{} belong to {}-{}.", domain, key, ms->domain, ms->key);
+    }
+    return ms;
+}
+
+template<typename CACHE, typename PTR>
+void
+add_meta(CACHE& tokendb_cache, const name128& domain, const name128& key, PTR& ms, meta&& m) {
+    if(ms == nullptr) {
+        auto nms   = meta_set();
+        nms.domain = domain;
+        nms.key    = key;
+        nms.metas.emplace_back(std::move(m));
+        tokendb_cache.put_token(token_type::meta, action_op::add, std::nullopt, get_meta_db_key(domain, key), std::move(nms));
+        return;
+    }
+    ms->metas.emplace_back(std::move(m));
+    tokendb_cache.put_token(token_type::meta, action_op::update, std::nullopt, get_meta_db_key(domain, key), *ms);
+}
+
 template<>
 bool
 check_duplicate_meta<group_def>(const group_def& v, const meta_key& key) {
@@ -1091,11 +1133,15 @@ EVT_ACTION_IMPL_BEGIN(addmeta) {
                 EVT_ASSERT(check_reserved_meta(amact, fungible_metas), meta_key_exception, "Meta-key is reserved and cannot be used");
             }
 
+            auto sym_id   = (symbol_id_type)std::stoul((std::string)act.key);
             auto fungible = make_empty_cache_ptr<fungible_def>();
-            READ_DB_TOKEN(token_type::fungible, std::nullopt, (symbol_id_type)std::stoul((std::string)act.key), fungible,
+            READ_DB_TOKEN(token_type::fungible, std::nullopt, sym_id, fungible,
                 unknown_fungible_exception, "Cannot find fungible with symbol id: {}", act.key);
 
-            EVT_ASSERT(!check_duplicate_meta(*fungible, amact.key), meta_key_exception,
+            // normalized key, so that one fungible has only one set of metas
+            auto mkey = name128::from_number(sym_id);
+            auto ms   = read_meta_set(tokendb_cache, N128(.fungible), mkey);
+            EVT_ASSERT(ms == nullptr || !check_duplicate_meta(*ms, amact.key), meta_key_exception,
                 "Metadata with key ${key} already exists.", ("key",amact.key));
             
             if(amact.creator.is_account_ref()) {
@@ -1109,8 +1155,11 @@ EVT_ACTION_IMPL_BEGIN(addmeta) {
                 EVT_ASSERT(check_involved_fungible(tokendb_cache, *fungible, N(manage), amact.creator), meta_involve_exception,
                     "Creator is not involved in fungible: ${name}.", ("name",act.key));
             }
-            fungible->metas.emplace_back(meta(amact.key, amact.value, amact.creator));
-            UPD_DB_TOKEN(token_type::fungible, *fungible);
+            add_meta(tokendb_cache, N128(.fungible), mkey, ms, meta(amact.key, amact.value, amact.creator));
+            if(auto flag = get_reserved_metaflag(amact, fungible_metas); flag != 0) {
+                fungible->flags |= flag;
+                UPD_DB_TOKEN(token_type::fungible, *fungible);
+            }
         }
         else if(act.key == N128(.meta)) {  // domain
             if(amact.key.reserved()) {
@@ -1121,14 +1170,18 @@ EVT_ACTION_IMPL_BEGIN(addmeta) {
             READ_DB_TOKEN(token_type::domain, std::nullopt, act.domain, domain, unknown_domain_exception,
                 "Cannot find domain: {}", act.domain);
 
-            EVT_ASSERT(!check_duplicate_meta(*domain, amact.key), meta_key_exception,
+            auto ms = read_meta_set(tokendb_cache, act.domain, act.key);
+            EVT_ASSERT(ms == nullptr || !check_duplicate_meta(*ms, amact.key), meta_key_exception,
                 "Metadata with key ${key} already exists.", ("key",amact.key));
             // check involved, only person involved in `manage` permission can add meta
             EVT_ASSERT(check_involved_domain(tokendb_cache, *domain, N(manage), amact.creator), meta_involve_exception,
                 "Creator is not involved in domain: ${name}.", ("name",act.key));
 
-            domain->metas.emplace_back(meta(amact.key, amact.value, amact.creator));
-            UPD_DB_TOKEN(token_type::domain, *domain);
+            add_meta(tokendb_cache, act.domain, act.key, ms, meta(amact.key, amact.value, amact.creator));
+            if(auto flag = get_reserved_metaflag(amact, domain_metas); flag != 0) {
+                domain->flags |= flag;
+                UPD_DB_TOKEN(token_type::domain, *domain);
+            }
         }
         else {  // token
             check_meta_key_reserved(amact.key);
@@ -1138,7 +1191,8 @@ EVT_ACTION_IMPL_BEGIN(addmeta) {
 
             EVT_ASSERT(!check_token_destroy(*token), token_destroyed_exception, "Metadata cannot be added on destroyed token.");
             EVT_ASSERT(!check_token_locked(*token), token_locked_exception, "Metadata cannot be added on locked token.");
-            EVT_ASSERT(!check_duplicate_meta(*token, amact.key), meta_key_exception, "Metadata with key ${key} already exists.", ("key",amact.key));
+            auto ms = read_meta_set(tokendb_cache, act.domain, act.key);
+            EVT_ASSERT(ms == nullptr || !check_duplicate_meta(*ms, amact.key), meta_key_exception, "Metadata with key ${key} already exists.", ("key",amact.key));
 
             auto domain = make_empty_cache_ptr<domain_def>();
             READ_DB_TOKEN(token_type::domain, std::nullopt, act.domain, domain, unknown_domain_exception, "Cannot find domain: {}", amact.key);
@@ -1156,8 +1210,7 @@ EVT_ACTION_IMPL_BEGIN(addmeta) {
                     || check_involved_domain(tokendb_cache, *domain, N(transfer), amact.creator);
                 EVT_ASSERT(involved, meta_involve_exception, "Creator is not involved in token ${domain}-${name}.", ("domain",act.domain)("name",act.key));
             }
-            token->metas.emplace_back(meta(amact.key, amact.value, amact.creator));
-            UPD_DB_TOKEN(token_type::token, *token);
+            add_meta(tokendb_cache, act.domain, act.key, ms, meta(amact.key, amact.value, amact.creator));
         }
     }
     EVT_CAPTURE_AND_RETHROW(tx_apply_exception);
@@ -1186,7 +1239,7 @@ EVT_ACTION_IMPL_BEGIN(newsuspend) {
         }
 
         DECLARE_TOKEN_DB()
-        EVT_ASSERT(!tokendb.exists_token(token_type::suspend, std::nullopt, nsact.name), suspend_duplicate_exception,
+        EVT_ASSERT(!tokendb_cache.exists_token(token_type::suspend, std::nullopt, nsact.name), suspend_duplicate_exception,
             "Suspend ${name} already exists.", ("name",nsact.name));
 
         auto suspend     = suspend_def();
@@ -1388,8 +1441,8 @@ EVT_ACTION_IMPL_BEGIN(everipass) {
             }
         }
 
-        auto keys  = link.restore_keys();
-        auto token = make_empty_cache_ptr<token_def>();
+        auto& keys = link.restore_keys();
+        auto  token = make_empty_cache_ptr<token_def>();
         READ_DB_TOKEN(token_type::token, d, t, token, unknown_token_exception, "Cannot find token: {} in {}", t, d);
 
         EVT_ASSERT(!check_token_destroy(*token), token_destroyed_exception, "Destroyed token cannot be destroyed during everiPass.");
@@ -1482,7 +1535,7 @@ EVT_ACTION_IMPL_BEGIN(everipay) {
 
         // check link id
         auto link_id = link.get_link_id();
-        EVT_ASSERT(!tokendb.exists_token(token_type::evtlink, std::nullopt, link_id), evt_link_dupe_exception,
+        EVT_ASSERT(!tokendb_cache.exists_token(token_type::evtlink, std::nullopt, link_id), evt_link_dupe_exception,
             "Duplicate EVT-Link ${id}", ("id", fc::to_hex((char*)&link_id, sizeof(link_id))));
 
         auto link_obj = evt_link_object {
@@ -1493,7 +1546,7 @@ EVT_ACTION_IMPL_BEGIN(everipay) {
         ADD_DB_TOKEN(token_type::evtlink, link_obj);
 
         // check signature
-        auto keys = link.restore_keys();
+        auto& keys = link.restore_keys();
         EVT_ASSERT(keys.size() == 1, everipay_exception, "There're more than one signature on everiPay link, which is invalid");
         
         // check payee
@@ -1509,23 +1562,32 @@ EVT_ACTION_IMPL_END()
 
 namespace internal {
 
+// returns false if the value is the same as current one
 auto update_chain_config = [](auto& conf, auto key, auto v) {
+    auto update = [v](auto& field) {
+        if(field == (std::decay_t<decltype(field)>)v) {
+            return false;
+        }
+        field = v;
+        return true;
+    };
+
     switch(key.value) {
     case N128(network-charge-factor): {
-        conf.base_network_charge_factor = v;
-        break;
+        return update(conf.base_network_charge_factor);
     }
     case N128(storage-charge-factor): {
-        conf.base_storage_charge_factor = v;
-        break;
+        return update(conf.base_storage_charge_factor);
     }
     case N128(cpu-charge-factor): {
-        conf.base_cpu_charge_factor = v;
-        break;
+        return update(conf.base_cpu_charge_factor);
     }
     case N128(global-charge-factor): {
-        conf.global_charge_factor = v;
-        break;
+        return update(conf.global_charge_factor);
+    }
+    case N128(zstd-compression): {
+        // switch is read from the votes directly, see `controller::is_compression_activated`
+        return false;
     }
     default: {
         EVT_THROW2(prodvote_key_exception, "Configuration key: {} is not valid", key);
@@ -1543,6 +1605,8 @@ EVT_ACTION_IMPL_BEGIN(prodvote) {
         EVT_ASSERT(context.has_authorized(N128(.prodvote), pvact.key), action_authorize_exception,
             "Invalid authorization fields in action(domain and key).");
         EVT_ASSERT(pvact.value > 0 && pvact.value < 1'000'000, prodvote_value_exception, "Invalid prodvote value: ${v}", ("v",pvact.value));
+        EVT_ASSERT(pvact.key != N128(zstd-compression) || pvact.value == 1, prodvote_value_exception,
+            "Only 1 can be voted for activating zstd compression");
 
         auto  conf     = context.control.get_global_properties().configuration;
         auto& sche     = context.control.active_producers();
@@ -1642,8 +1706,10 @@ EVT_ACTION_IMPL_BEGIN(prodvote) {
                 nv = *it;
             }
 
-            update_chain_config(conf, pvact.key, nv);
-            context.control.set_chain_config(conf);
+            if(update_chain_config(conf, pvact.key, nv)) {
+                // median is usually unchanged by one vote, global properties are only written on changes
+                context.control.set_chain_config(conf);
+            }
         }
         else {
             // update action version
@@ -1687,7 +1753,7 @@ EVT_ACTION_IMPL_BEGIN(newlock) {
         EVT_ASSERT(context.has_authorized(N128(.lock), nlact.name), action_authorize_exception, "Invalid authorization fields in action(domain and key).");
 
         DECLARE_TOKEN_DB()
-        EVT_ASSERT(!tokendb.exists_token(token_type::lock, std::nullopt, nlact.name), lock_duplicate_exception,
+        EVT_ASSERT(!tokendb_cache.exists_token(token_type::lock, std::nullopt, nlact.name), lock_duplicate_exception,
             "Lock assets with same name: ${n} is already existed", ("n",nlact.name));
 
         auto now = context.control.pending_block_time();
@@ -1717,7 +1783,7 @@ EVT_ACTION_IMPL_BEGIN(newlock) {
         EVT_ASSERT(nlact.assets.size() > 0, lock_assets_exception, "Assets for lock should not be empty");
 
         auto has_fungible = false;
-        auto keys         = context.trx_context.trx_meta->recover_keys(context.control.get_chain_id());
+        auto keys         = context.control.recover_keys(context.trx_context.trx_meta);
         for(auto& la : nlact.assets) {
             switch(la.type()) {
             case asset_type::tokens: {
@@ -1771,10 +1837,11 @@ EVT_ACTION_IMPL_BEGIN(newlock) {
             case asset_type::tokens: {
                 auto& tokens = la.template get<locknft_def>();
 
-                for(auto& tn : tokens.names) {
-                    auto token = make_empty_cache_ptr<token_def>();
-                    READ_DB_TOKEN(token_type::token, tokens.domain, tn, token, unknown_token_exception,
-                        "Cannot find token: {} in {}", tn, tokens.domain);
+                auto tks = tokendb_cache.template read_tokens<token_def>(token_type::token, tokens.domain, tokens.names, true /* no throw */);
+                for(auto i = 0u; i < tokens.names.size(); i++) {
+                    auto& token = tks[i];
+                    EVT_ASSERT2(token != nullptr, unknown_token_exception,
+                        "Cannot find token: {} in {}", tokens.names[i], tokens.domain);
                     token->owner = { laddr };
 
                     UPD_DB_TOKEN(token_type::token, *token);
@@ -1889,10 +1956,11 @@ EVT_ACTION_IMPL_BEGIN(tryunlock) {
             case asset_type::tokens: {
                 auto& tokens = la.template get<locknft_def>();
 
-                for(auto& tn : tokens.names) {
-                    auto token = make_empty_cache_ptr<token_def>();
-                    READ_DB_TOKEN(token_type::token, tokens.domain, tn, token, unknown_token_exception,
-                        "Cannot find token: {} in {}", tn, tokens.domain);
+                auto tks = tokendb_cache.template read_tokens<token_def>(token_type::token, tokens.domain, tokens.names, true /* no throw */);
+                for(auto i = 0u; i < tokens.names.size(); i++) {
+                    auto& token = tks[i];
+                    EVT_ASSERT2(token != nullptr, unknown_token_exception,
+                        "Cannot find token: {} in {}", tokens.names[i], tokens.domain);
                     token->owner = *pkeys;
                     UPD_DB_TOKEN(token_type::token, *token);
                 }
@@ -1939,7 +2007,7 @@ auto check_n_rtn = [](auto& asset, auto sym, auto ctype) -> decltype(asset) {
 };
 
 void
-check_bonus_receiver(const token_database& tokendb, const dist_receiver& receiver) {
+check_bonus_receiver(token_database_cache& tokendb_cache, const dist_receiver& receiver) {
     switch(receiver.type()) {
     case dist_receiver_type::address: {
         auto& addr = receiver.get<address>();
@@ -1951,7 +2019,7 @@ check_bonus_receiver(const token_database& tokendb, const dist_receiver& receive
         auto  sym_id = sr.threshold.symbol_id();
 
         check_n_rtn(sr.threshold, sr.threshold.sym(), bonus_check_type::natural);
-        EVT_ASSERT2(tokendb.exists_token(token_type::fungible, std::nullopt, sym_id),
+        EVT_ASSERT2(tokendb_cache.exists_token(token_type::fungible, std::nullopt, sym_id),
             bonus_receiver_exception, "Provided bonus tokens, which has sym id: {}, used for receiving is not existed", sym_id);
         break;
     }
@@ -1963,9 +2031,35 @@ auto get_percent_string = [](auto& per) {
     return fmt::format("{} %", p.str(5));
 };
 
+// percents of v2 rules are fixed-point, only the ones of v1 rules need decimal arithmetic
+inline int64_t
+floor_percent(const percent_slim& p, int64_t amount) {
+    return p.floor_mul(amount);
+}
+
+inline int64_t
+floor_percent(const percent_type& p, int64_t amount) {
+    return (int64_t)boost::multiprecision::floor(p * real_type(amount));
+}
+
+// holders of the fungibles receiving bonus are aggregated by token database, so their number and total balance above
+// the thresholds are known without walking them. aggregates are not part of the state, only the registrations are here
 template<typename T>
 void
-check_bonus_rules(const token_database& tokendb, const T& rules, asset amount) {
+add_holder_aggregates(token_database& tokendb, const T& rules) {
+    for(auto& rule : rules) {
+        rule.visit([&tokendb](auto& r) {
+            if(r.receiver.type() == dist_receiver_type::ftholders) {
+                auto& sr = r.receiver.template get<dist_stack_receiver>();
+                tokendb.add_asset_aggregate(sr.threshold.symbol_id(), sr.threshold.amount());
+            }
+        });
+    }
+}
+
+template<typename T>
+void
+check_bonus_rules(token_database_cache& tokendb_cache, const T& rules, asset amount) {
     auto sym            = amount.sym();
     auto remain         = amount.amount();
     auto remain_percent = percent_type(0);
@@ -1978,7 +2072,7 @@ check_bonus_rules(const token_database& tokendb, const T& rules, asset amount) {
                 "Rule #{} is not valid, fix rule should be defined in front of remain-percent rules", index);
             auto& fr  = rule.template get<dist_rule_type::fixed>();
             // check receiver
-            check_bonus_receiver(tokendb, fr.receiver);
+            check_bonus_receiver(tokendb_cache, fr.receiver);
             // check sym and > 0
             auto& frv = check_n_rtn(fr.amount, sym, bonus_check_type::positive);
             // check large than remain
@@ -1992,13 +2086,13 @@ check_bonus_rules(const token_database& tokendb, const T& rules, asset amount) {
                 "Rule #{} is not valid, percent rule should be defined in front of remain-percent rules", index);
             auto& pr = rule.template get<dist_rule_type::percent>();
             // check receiver
-            check_bonus_receiver(tokendb, pr.receiver);
+            check_bonus_receiver(tokendb_cache, pr.receiver);
 
             auto p = (percent_type)pr.percent;
             // check valid precent
             EVT_ASSERT2(p > 0 && p <= 1, bonus_percent_value_exception,
                 "Rule #{} is not valid, precent value should be in range (0,1]", index);
-            auto prv = (int64_t)boost::multiprecision::floor(p * real_type(amount.amount()));
+            auto prv = floor_percent(pr.percent, amount.amount());
             // check large than remain
             EVT_ASSERT2(prv <= remain, bonus_rules_exception,
                 "Rule #{} is not valid, its required amount: {} is large than remainning: {}", index, asset(prv, sym), asset(remain, sym));
@@ -2012,12 +2106,12 @@ check_bonus_rules(const token_database& tokendb, const T& rules, asset amount) {
             EVT_ASSERT2(remain > 0, bonus_rules_exception, "There's no bonus left for reamining-percent rule to distribute");
             auto& pr = rule.template get<dist_rule_type::remaining_percent>();
             // check receiver
-            check_bonus_receiver(tokendb, pr.receiver);
+            check_bonus_receiver(tokendb_cache, pr.receiver);
 
             auto p = (percent_type)pr.percent;
             // check valid precent
             EVT_ASSERT2(p > 0 && p <= 1, bonus_percent_value_exception, "Precent value should be in range (0,1]");
-            auto prv = (int64_t)boost::multiprecision::floor(p * real_type(remain));
+            auto prv = floor_percent(pr.percent, remain);
             // check percent result is large than minial unit of asset
             EVT_ASSERT2(prv >= 1, bonus_percent_result_exception,
                 "Rule #{} is not valid, the amount for this rule shoule be as least large than one unit of asset, but it's zero now.", index);
@@ -2111,7 +2205,7 @@ EVT_ACTION_IMPL_BEGIN(setpsvbonus) {
         EVT_ASSERT(sym != evt_sym(), bonus_symbol_exception, "Passive bonus cannot be registered in EVT");
         EVT_ASSERT(sym != pevt_sym(), bonus_symbol_exception, "Passive bonus cannot be registered in Pinned EVT");
 
-        EVT_ASSERT2(!tokendb.exists_token(token_type::psvbonus, std::nullopt, get_psvbonus_db_key(sym.id(), kPsvBonus)),
+        EVT_ASSERT2(!tokendb_cache.exists_token(token_type::psvbonus, std::nullopt, get_psvbonus_db_key(sym.id(), kPsvBonus)),
             bonus_dupe_exception, "It's now allowd to update passive bonus currently.");
 
         auto rate = (percent_type)spbact.rate;
@@ -2136,7 +2230,7 @@ EVT_ACTION_IMPL_BEGIN(setpsvbonus) {
         pb.dist_threshold = check_n_rtn(spbact.dist_threshold, sym, bonus_check_type::positive);
 
         EVT_ASSERT2(spbact.rules.size() > 0, bonus_rules_exception, "Rules for passive bonus cannot be empty");
-        check_bonus_rules(tokendb, spbact.rules, spbact.dist_threshold);
+        check_bonus_rules(tokendb_cache, spbact.rules, spbact.dist_threshold);
 
         if constexpr (EVT_ACTION_VER() == 1) {
             pb.rules = to_rules_v2(spbact.rules);
@@ -2147,6 +2241,8 @@ EVT_ACTION_IMPL_BEGIN(setpsvbonus) {
 
         check_passive_methods(context.control.get_execution_context(), spbact.methods);
         pb.methods = std::move(spbact.methods);
+
+        add_holder_aggregates(tokendb, pb.rules);
         
         pb.round = 0;
         ADD_DB_TOKEN(token_type::psvbonus, pb);
@@ -2205,24 +2301,34 @@ public:
     symbol_id_type  sym_id;
     holder_slim_map slim;
     holder_coll_map coll;
-    int64_t         total;
+    int64_t         total = 0;
 };
 
+void
+add_holder_amount(holder_dist& dist, const std::string_view& k, int64_t amount) {
+    auto h  = fc::city_hash32(k.data(), k.size());
+    auto it = dist.slim.emplace(h, amount);
+    if(it.second == false) {
+        // meet collision
+        dist.coll.emplace(std::string(k.data(), k.size()), amount);
+    }
+    dist.total += amount;
+}
+
+template<typename K, typename V>
+void
+add_holder(holder_dist& dist, const K& k, const V& v) {
+    property prop;
+    extract_db_value(v, prop);
+
+    add_holder_amount(dist, std::string_view(k.data(), k.size()), prop.amount);
+}
+
 void
 build_holder_dist(const token_database& tokendb, symbol sym, holder_dist& dist) {
     dist.sym_id = sym.id();
     tokendb.read_assets_range(sym.id(), 0, [&dist](auto& k, auto&& v) {
-        property prop;
-        extract_db_value(v, prop);
-
-        auto h  = fc::city_hash32(k.data(), k.size());
-        auto it = dist.slim.emplace(h, prop.amount);
-        if(it.second == false) {
-            // meet collision
-            dist.coll.emplace(std::string(k.data(), k.size()), prop.amount);
-        }
-        dist.total += prop.amount;
-
+        add_holder(dist, k, v);
         return true;
     });
 };
@@ -2238,6 +2344,35 @@ struct bonusdist {
     optional<address> final_receiver;
 };
 
+// where the holders walk of a distribution stops, it's continued by following `distpsvbonus` actions.
+// the walk spans blocks and balances keep moving meanwhile, so each holder is recorded with the balance when
+// it's walked instead of the one when the round starts. bonus collected is only moved to the round once the walk
+// finishes, so the distribution itself doesn't change the balances being walked
+struct bonusdist_progress {
+    uint32_t    round;
+    uint32_t    holders_index;  // index of holder_dist being walked
+    std::string cursor;         // key of last walked holder, empty to start from the first one
+    uint64_t    walked;
+    bool        finished;
+    uint32_t    chunks;         // chunks of holders walked so far, merged into the round once the walk finishes
+};
+
+struct bonusdist_chunk_holder {
+    uint32_t    holders_index;
+    std::string key;
+    int64_t     amount;
+};
+
+// holders walked by one action, each chunk is stored apart so continuations don't rewrite the whole round
+struct bonusdist_chunk {
+    std::vector<bonusdist_chunk_holder> holders;
+};
+
+// rounds of distributions start from 1, so round 0 is used for the progress
+const uint64_t kPsvBonusDistProgress = 0;
+// chunks are indexed from this one on, they're overwritten by the walks of later rounds
+const uint64_t kPsvBonusDistChunks = 1ull << 63;
+
 name128
 get_psvbonus_dist_db_key(uint64_t sym_id, uint64_t round) {
     uint128_t v = round;
@@ -2245,6 +2380,51 @@ get_psvbonus_dist_db_key(uint64_t sym_id, uint64_t round) {
     return v;
 }
 
+// walks at most `limit` holders from where the progress stops into `chunk`
+void
+walk_holder_dists(const token_database& tokendb, const bonusdist& bd, bonusdist_progress& progress, uint32_t limit, bonusdist_chunk& chunk) {
+    while(progress.holders_index < bd.holders.size()) {
+        auto& dist    = bd.holders[progress.holders_index];
+        auto  stopped = false;
+        auto  func    = [&](auto& k, auto&& v) {
+            if(limit == 0) {
+                stopped = true;
+                return false;
+            }
+            property prop;
+            extract_db_value(v, prop);
+
+            chunk.holders.emplace_back(bonusdist_chunk_holder { .holders_index = progress.holders_index, .key = std::string(k.data(), k.size()), .amount = prop.amount });
+            progress.cursor.assign(k.data(), k.size());
+            progress.walked++;
+            limit--;
+            return true;
+        };
+
+        if(progress.cursor.empty()) {
+            tokendb.read_assets_range(dist.sym_id, 0, func);
+        }
+        else {
+            tokendb.read_assets_range(dist.sym_id, std::string_view(progress.cursor), func);
+        }
+
+        if(stopped) {
+            return;
+        }
+        progress.cursor.clear();
+        progress.holders_index++;
+    }
+    progress.finished = true;
+}
+
+// chunks are merged in the order they're walked, so the result is the same as walking all the holders at once
+void
+merge_holder_chunk(bonusdist& bd, const bonusdist_chunk& chunk) {
+    for(auto& h : chunk.holders) {
+        add_holder_amount(bd.holders[h.holders_index], h.key, h.amount);
+    }
+}
+
 }  // namespace internal
 
 EVT_ACTION_IMPL_BEGIN(distpsvbonus) {
@@ -2261,6 +2441,51 @@ EVT_ACTION_IMPL_BEGIN(distpsvbonus) {
         READ_DB_TOKEN(token_type::psvbonus, std::nullopt, get_psvbonus_db_key(spbact.sym_id, kPsvBonus), pb, unknown_bonus_exception,
             "Cannot find passive bonus registered for fungible token with sym id: {}.", spbact.sym_id);
 
+        auto progress = make_empty_cache_ptr<bonusdist_progress>();
+        auto limit    = std::numeric_limits<uint32_t>::max();
+        if constexpr (EVT_ACTION_VER() > 1) {
+            if(spbact.max_holders > 0) {
+                limit = spbact.max_holders;
+            }
+
+            READ_DB_TOKEN_NO_THROW(token_type::psvbonus_dist, std::nullopt, get_psvbonus_dist_db_key(spbact.sym_id, kPsvBonusDistProgress), progress);
+            if(progress != nullptr && !progress->finished) {
+                // continues the walk of current round instead of starting a new one
+                auto bd = make_empty_cache_ptr<bonusdist>();
+                READ_DB_TOKEN(token_type::psvbonus_dist, std::nullopt, get_psvbonus_dist_db_key(spbact.sym_id, progress->round), bd, unknown_bonus_exception,
+                    "Cannot find distribution of round: {} for fungible token with sym id: {}.", progress->round, spbact.sym_id);
+
+                EVT_ASSERT2(bd->deadline == time_point_sec(spbact.deadline) && bd->final_receiver == spbact.final_receiver, bonus_dist_continuation_exception,
+                    "Deadline and final receiver should be the same as the ones of distribution in progress, round: {}", progress->round);
+
+                auto chunk = bonusdist_chunk();
+                walk_holder_dists(tokendb, *bd, *progress, limit, chunk);
+                if(!progress->finished) {
+                    tokendb_cache.put_token(token_type::psvbonus_dist, action_op::put, std::nullopt, get_psvbonus_dist_db_key(spbact.sym_id, kPsvBonusDistChunks | progress->chunks), std::move(chunk));
+                    progress->chunks++;
+                }
+                else {
+                    // round only holds the sym ids of its holders until here, all the chunks are merged into it once
+                    for(auto i = 0u; i < progress->chunks; i++) {
+                        auto c = make_empty_cache_ptr<bonusdist_chunk>();
+                        READ_DB_TOKEN(token_type::psvbonus_dist, std::nullopt, get_psvbonus_dist_db_key(spbact.sym_id, kPsvBonusDistChunks | i), c, unknown_bonus_exception,
+                            "Cannot find chunk: {} of distribution of round: {} for fungible token with sym id: {}.", i, progress->round, spbact.sym_id);
+                        merge_holder_chunk(*bd, *c);
+                    }
+                    merge_holder_chunk(*bd, chunk);
+                    tokendb_cache.put_token(token_type::psvbonus_dist, action_op::update, std::nullopt, get_psvbonus_dist_db_key(spbact.sym_id, progress->round), *bd);
+                }
+                tokendb_cache.put_token(token_type::psvbonus_dist, action_op::update, std::nullopt, get_psvbonus_dist_db_key(spbact.sym_id, kPsvBonusDistProgress), *progress);
+
+                if(progress->finished) {
+                    property pbonus;
+                    READ_DB_ASSET_NO_THROW(get_psvbonus_address(spbact.sym_id, 0), pb->dist_threshold.sym(), pbonus);
+                    transfer_fungible(context, get_psvbonus_address(spbact.sym_id, 0), get_psvbonus_address(spbact.sym_id, progress->round), asset(pbonus.amount, pbonus.sym), N(distpsvbonus), false /* pay bonus */);
+                }
+                return;
+            }
+        }
+
         auto sym = pb->dist_threshold.sym();
 
         property pbonus;
@@ -2268,6 +2493,9 @@ EVT_ACTION_IMPL_BEGIN(distpsvbonus) {
         EVT_ASSERT2(pbonus.amount >= pb->dist_threshold.amount(), bonus_unreached_dist_threshold,
             "Distribution threshold: {} is unreached, current: {}", pb->dist_threshold, asset(pbonus.amount, sym));
 
+        // registrations are dropped when node restarts
+        add_holder_aggregates(tokendb, pb->rules);
+
         auto bd = bonusdist();
         for(auto& rule : pb->rules) {
             auto ftrev = std::optional<dist_stack_receiver>();
@@ -2293,7 +2521,13 @@ EVT_ACTION_IMPL_BEGIN(distpsvbonus) {
 
             if(ftrev.has_value()) {
                 auto dist = holder_dist();
-                build_holder_dist(tokendb, ftrev->threshold.sym(), dist);
+                if constexpr (EVT_ACTION_VER() > 1) {
+                    // holders are walked below at most `limit` ones at a time
+                    dist.sym_id = ftrev->threshold.sym().id();
+                }
+                else {
+                    build_holder_dist(tokendb, ftrev->threshold.sym(), dist);
+                }
                 bd.holders.emplace_back(std::move(dist));
             }
         }
@@ -2307,11 +2541,35 @@ EVT_ACTION_IMPL_BEGIN(distpsvbonus) {
         pb->deadline = spbact.deadline;
         UPD_DB_TOKEN(token_type::psvbonus, *pb);
 
-        auto dbv = make_db_value(bd);
-        tokendb_cache.put_token(token_type::psvbonus_dist, action_op::add, std::nullopt, get_psvbonus_db_key(spbact.sym_id, pb->round), dbv);
+        if constexpr (EVT_ACTION_VER() > 1) {
+            auto p     = bonusdist_progress { .round = pb->round, .holders_index = 0, .cursor = {}, .walked = 0, .finished = false, .chunks = 0 };
+            auto chunk = bonusdist_chunk();
+            walk_holder_dists(tokendb, bd, p, limit, chunk);
+            if(!p.finished) {
+                tokendb_cache.put_token(token_type::psvbonus_dist, action_op::put, std::nullopt, get_psvbonus_dist_db_key(spbact.sym_id, kPsvBonusDistChunks), std::move(chunk));
+                p.chunks = 1;
+            }
+            else {
+                merge_holder_chunk(bd, chunk);
+                transfer_fungible(context, get_psvbonus_address(spbact.sym_id, 0), get_psvbonus_address(spbact.sym_id, pb->round), asset(pbonus.amount, pbonus.sym), N(distpsvbonus), false /* pay bonus */);
+            }
+            tokendb_cache.put_token(token_type::psvbonus_dist, action_op::add, std::nullopt, get_psvbonus_dist_db_key(spbact.sym_id, pb->round), std::move(bd));
 
-        // transfer all the FTs from cllected address to distribute address of current round
-        transfer_fungible(context, get_psvbonus_address(spbact.sym_id, 0), get_psvbonus_address(spbact.sym_id, pb->round), asset(pbonus.amount, pbonus.sym), N(distpsvbonus), false /* pay bonus */);
+            if(progress == nullptr) {
+                tokendb_cache.put_token(token_type::psvbonus_dist, action_op::add, std::nullopt, get_psvbonus_dist_db_key(spbact.sym_id, kPsvBonusDistProgress), std::move(p));
+            }
+            else {
+                *progress = std::move(p);
+                tokendb_cache.put_token(token_type::psvbonus_dist, action_op::update, std::nullopt, get_psvbonus_dist_db_key(spbact.sym_id, kPsvBonusDistProgress), *progress);
+            }
+        }
+        else {
+            auto dbv = make_db_value(bd);
+            tokendb_cache.put_token(token_type::psvbonus_dist, action_op::add, std::nullopt, get_psvbonus_db_key(spbact.sym_id, pb->round), dbv);
+
+            // transfer all the FTs from cllected address to distribute address of current round
+            transfer_fungible(context, get_psvbonus_address(spbact.sym_id, 0), get_psvbonus_address(spbact.sym_id, pb->round), asset(pbonus.amount, pbonus.sym), N(distpsvbonus), false /* pay bonus */);
+        }
     }
     EVT_CAPTURE_AND_RETHROW(tx_apply_exception);
 }
@@ -2321,3 +2579,6 @@ EVT_ACTION_IMPL_END()
 
 FC_REFLECT(evt::chain::contracts::internal::holder_dist, (sym_id)(slim)(coll)(total));
 FC_REFLECT(evt::chain::contracts::internal::bonusdist, (created_at)(created_index)(holders)(deadline)(final_receiver));
+FC_REFLECT(evt::chain::contracts::internal::bonusdist_progress, (round)(holders_index)(cursor)(walked)(finished)(chunks));
+FC_REFLECT(evt::chain::contracts::internal::bonusdist_chunk_holder, (holders_index)(key)(amount));
+FC_REFLECT(evt::chain::contracts::internal::bonusdist_chunk, (holders));
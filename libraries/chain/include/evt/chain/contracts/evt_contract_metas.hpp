@@ -22,12 +22,14 @@ auto domain_metas = hana::make_map(
     hana::make_pair(
         hana::int_c<(int)reserved_meta_key::disable_destroy>,
         hana::make_tuple(uint128_c<N128(.disable-destroy)>,
-        hana::type_c<bool>)
+        hana::type_c<bool>,
+        meta_flag::disable_destroy)
     ),
     hana::make_pair(
         hana::int_c<(int)reserved_meta_key::disable_set_transfer>,
         hana::make_tuple(uint128_c<N128(.disable-set-transfer)>,
-        hana::type_c<bool>)
+        hana::type_c<bool>,
+        meta_flag::disable_set_transfer)
     )
 );
 
@@ -35,7 +37,8 @@ auto fungible_metas = hana::make_map(
     hana::make_pair(
         hana::int_c<(int)reserved_meta_key::disable_set_transfer>,
         hana::make_tuple(uint128_c<N128(.disable-set-transfer)>,
-        hana::type_c<bool>)
+        hana::type_c<bool>,
+        meta_flag::disable_set_transfer)
     )
 );
 
@@ -44,13 +47,19 @@ constexpr auto get_metakey = [](auto& metas) {
     return name128(hana::at(hana::at_key(metas, hana::int_c<(int)KeyType>), hana::int_c<0>)());
 };
 
-auto get_metavalue = [](const auto& obj, auto k) {
-    for(const auto& p : obj.metas) {
-        if(p.key.value == k) {
-            return optional<std::string>{ p.value };
+auto check_metaflag = [](const auto& obj, meta_flag flag) {
+    return (obj.flags & (meta_flags)flag) != 0;
+};
+
+// flag of the reserved meta which `act` enables, zero if it doesn't enable any
+auto get_reserved_metaflag = [](const auto& act, const auto& metas) {
+    auto flag = meta_flags(0);
+    hana::for_each(hana::values(metas), [&](const auto& m) {
+        if(act.key.value == hana::at(m, hana::int_c<0>) && act.value == "true") {
+            flag = (meta_flags)hana::at(m, hana::int_c<2>);
         }
-    }
-    return optional<std::string>();
+    });
+    return flag;
 };
 
 auto check_reserved_meta = [](const auto& act, const auto& metas) {
@@ -78,13 +78,22 @@ public:
 
 public:
     fc::sha256 digest() const;
-    public_keys_set restore_keys() const;
+    // keys recovered are memoized with the digest and signatures they're recovered from,
+    // so it's recomputed only when the link is changed
+    const public_keys_set& restore_keys() const;
 
 private:
     uint16_t        header_;
     segments_type   segments_;
     signatures_type signatures_;
 
+    struct restored_keys {
+        fc::sha256      digest;
+        signatures_type signatures;
+        public_keys_set keys;
+    };
+    mutable std::optional<restored_keys> restored_keys_;
+
 private:
     friend struct fc::reflector<evt_link>;
 };
@@ -3,6 +3,8 @@
  *  @copyright defined in evt/LICENSE.txt
  */
 #pragma once
+#include <string.h>
+#include <fc/crypto/sha256.hpp>
 #include <evt/chain/types.hpp>
 #include <evt/chain/contracts/authorizer_ref.hpp>
 
@@ -24,6 +26,35 @@ struct meta {
 };
 using meta_list = small_vector<meta, 4>;
 
+// reserved metas enabled on domains and fungibles are also kept as flags on them,
+// so checking them doesn't need to read the metas
+enum class meta_flag : uint8_t {
+    disable_destroy      = 1 << 0,
+    disable_set_transfer = 1 << 1
+};
+using meta_flags = uint8_t;
+
+// metas of one domain, token or fungible, stored apart from the owner in `token_type::meta`
+// `domain` and `key` are the ones of the `addmeta` actions on the owner
+struct meta_set {
+    name128   domain;
+    name128   key;
+    meta_list metas;
+};
+
+inline name128
+get_meta_db_key(const name128& domain, const name128& key) {
+    auto enc = fc::sha256::encoder();
+    enc.write((const char*)&domain, sizeof(domain));
+    enc.write((const char*)&key, sizeof(key));
+
+    auto h = enc.result();
+    auto v = uint128_t();
+    memcpy(&v, h.data(), sizeof(v));
+    return v;
+}
+
 }}}  // namespac evt::chain::contracts
 
 FC_REFLECT(evt::chain::contracts::meta, (key)(value)(creator));
+FC_REFLECT(evt::chain::contracts::meta_set, (domain)(key)(metas));
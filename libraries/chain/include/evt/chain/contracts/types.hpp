@@ -82,8 +82,6 @@ struct token_def {
     domain_name  domain;
     token_name   name;
     address_list owner;
-
-    meta_list metas;
 };
 
 struct key_weight {
@@ -100,12 +98,34 @@ struct authorizer_weight {
     weight_type    weight;
 };
 
-struct permission_def {
+struct permission_def : public fc::reflect_init {
+    // shape of authorizers classified once unpacked, so checks of the simple ones skip the general path
+    // it's not serialized, permissions built in place are left as `general` until `reflector_init` is called
+    enum shape_type : uint8_t { general = 0, single_key, keys_only };
+
     permission_def() = default;
 
+    void
+    reflector_init() {
+        shape = general;
+        for(auto& aw : authorizers) {
+            if(!aw.ref.is_account_ref()) {
+                return;
+            }
+        }
+        if(authorizers.size() == 1 && authorizers[0].weight >= threshold) {
+            shape = single_key;
+        }
+        else if(!authorizers.empty()) {
+            shape = keys_only;
+        }
+    }
+
     permission_name                    name;
     uint32_t                           threshold;
     small_vector<authorizer_weight, 4> authorizers;
+
+    shape_type shape = general;
 };
 
 struct domain_def {
@@ -119,7 +139,7 @@ struct domain_def {
     permission_def transfer;
     permission_def manage;
 
-    meta_list metas;
+    meta_flags flags = 0;  // metas are stored in `token_type::meta`
 };
 
 // Remaining for the usage in genesis state
@@ -157,7 +177,7 @@ struct fungible_def {
 
     asset total_supply;
     
-    meta_list metas;
+    meta_flags flags = 0;  // metas are stored in `token_type::meta`
 };
 
 enum class suspend_status {
@@ -624,6 +644,15 @@ struct distpsvbonus {
     EVT_ACTION_VER1(distpsvbonus);
 };
 
+struct distpsvbonus_v2 {
+    symbol_id_type    sym_id;
+    time_point        deadline;
+    optional<address> final_receiver;
+    uint32_t          max_holders;  // holders walked by one action, zero for no limit
+
+    EVT_ACTION_VER2(distpsvbonus, distpsvbonus_v2);
+};
+
 struct recvpsvbonus {
     symbol_id_type                   sym_id;
     small_vector<public_key_type, 2> receivers;
@@ -633,13 +662,13 @@ struct recvpsvbonus {
 }}}  // namespace evt::chain::contracts
 
 FC_REFLECT(evt::chain::contracts::property, (amount)(sym)(created_at)(created_index));
-FC_REFLECT(evt::chain::contracts::token_def, (domain)(name)(owner)(metas));
+FC_REFLECT(evt::chain::contracts::token_def, (domain)(name)(owner));
 FC_REFLECT(evt::chain::contracts::key_weight, (key)(weight));
 FC_REFLECT(evt::chain::contracts::authorizer_weight, (ref)(weight));
 FC_REFLECT(evt::chain::contracts::permission_def, (name)(threshold)(authorizers));
-FC_REFLECT(evt::chain::contracts::domain_def, (name)(creator)(create_time)(issue)(transfer)(manage)(metas));
+FC_REFLECT(evt::chain::contracts::domain_def, (name)(creator)(create_time)(issue)(transfer)(manage)(flags));
 FC_REFLECT(evt::chain::contracts::fungible_def_genesis, (name)(sym_name)(sym)(creator)(create_time)(issue)(manage)(total_supply)(metas));
-FC_REFLECT(evt::chain::contracts::fungible_def, (name)(sym_name)(sym)(creator)(create_time)(issue)(transfer)(manage)(total_supply)(metas));
+FC_REFLECT(evt::chain::contracts::fungible_def, (name)(sym_name)(sym)(creator)(create_time)(issue)(transfer)(manage)(total_supply)(flags));
 
 FC_REFLECT_ENUM(evt::chain::contracts::suspend_status, (proposed)(executed)(failed)(cancelled));
 FC_REFLECT(evt::chain::contracts::suspend_def, (name)(proposer)(status)(trx)(signed_keys)(signatures));
@@ -701,3 +730,4 @@ FC_REFLECT(evt::chain::contracts::tryunlock, (name)(executor));
 FC_REFLECT(evt::chain::contracts::setpsvbonus, (sym)(rate)(base_charge)(charge_threshold)(minimum_charge)(dist_threshold)(rules)(methods));
 FC_REFLECT(evt::chain::contracts::setpsvbonus_v2, (sym_id)(rate)(base_charge)(charge_threshold)(minimum_charge)(dist_threshold)(rules)(methods));
 FC_REFLECT(evt::chain::contracts::distpsvbonus, (sym_id)(deadline)(final_receiver));
+FC_REFLECT(evt::chain::contracts::distpsvbonus_v2, (sym_id)(deadline)(final_receiver)(max_holders));
@@ -21,10 +21,12 @@ namespace evt { namespace chain {
 using unapplied_transactions_type = map<transaction_id_type, transaction_metadata_ptr>;
 
 class fork_database;
+class block_log;
 class apply_context;
 class charge_manager;
 class execution_context;
 class token_database_cache;
+class action_profiler;
 
 struct controller_impl;
 using boost::signals2::signal;
@@ -44,6 +46,13 @@ struct evt_link_object;
 using contracts::abi_serializer;
 using contracts::evt_link_object;
 
+// traces of the transactions applied into one block, delivered at once when the block is committed
+struct block_traces {
+    block_state_ptr                    block;
+    std::vector<transaction_trace_ptr> traces;
+};
+using block_traces_ptr = std::shared_ptr<const block_traces>;
+
 enum class db_read_mode {
     SPECULATIVE,
     HEAD,
@@ -65,12 +74,33 @@ public:
         uint64_t state_guard_size       = chain::config::default_state_guard_size;
         uint64_t reversible_cache_size  = chain::config::default_reversible_cache_size;
         uint64_t reversible_guard_size  = chain::config::default_reversible_guard_size;
+        bool     reversible_blocks_log  = false;  // keep reversible blocks in an append-only log written in background instead of chainbase
         bool     read_only              = false;
         bool     force_all_checks       = false;
         bool     disable_replay_opts    = false;
         bool     loadtest_mode          = false;
         bool     charge_free_mode       = false;
         bool     contracts_console      = false;
+        uint32_t prefetch_threads       = 2;  // threads warming token database before transactions are applied, 0 to disable
+        uint32_t cache_hot_keys         = 10000;  // keys of cache recorded and preloaded on startup, 0 to disable
+        uint32_t signature_threads      = 4;  // threads recovering keys of incoming transactions and blocks being applied, 0 to disable
+        uint32_t signature_cache_size   = 100000;  // number of transactions whose recovered keys are cached
+        uint32_t blocks_cache_size      = 1000;  // number of recent irreversible blocks cached in memory, 0 to disable
+        bool     profile_actions        = false;  // collect wall time and database operations of actions
+        bool     fork_db_journal        = false;  // journal changes of fork database so it's recovered if not closed cleanly
+        bool     state_huge_pages       = false;  // advise huge pages for the mappings of chain state and reversible blocks
+        bool     state_mlock            = false;  // lock the mappings in memory
+        uint32_t state_prefault_threads = 0;      // threads faulting in the mappings on startup, 0 to disable
+
+        uint32_t blocks_log_stride        = 0;  // blocks in each file of block log, 0 to never split it
+        uint32_t max_retained_block_files = 0;  // 0 for no limit
+        path     blocks_retained_dir      = "retained";
+        path     blocks_archive_dir;
+        bool     compress_retained_blocks = false;  // compress retained files of block log with zstd
+        bool     async_blocks_log         = false;  // append irreversible blocks in background thread
+        uint32_t blocks_log_max_pending   = 1024;
+        uint32_t blocks_log_sync_interval = 0;  // blocks between fsyncs of block log, 0 to never fsync
+        uint32_t blocks_recovery_threads  = 1;  // threads verifying blocks when index of block log is rebuilt
 
         std::chrono::microseconds max_serialization_time = std::chrono::milliseconds(chain::config::default_abi_serializer_max_time_ms);
 
@@ -78,9 +108,15 @@ public:
         validation_mode block_validation_mode = validation_mode::FULL;
 
         flat_set<account_name> trusted_producers;
+        // blocks at or below it skip recovering keys and checking authorities in replay and sync unless
+        // `force_all_checks` is set, state is still applied. ids of checkpoint blocks are enforced by chain plugin
+        uint32_t               trusted_checkpoint_num = 0;
 
         token_database::config db_config;
 
+        // native checkpoint of token database in snapshot is resolved under this directory
+        path snapshot_dir;
+
         genesis_state genesis;
     };
 
@@ -91,6 +127,26 @@ public:
         incomplete   = 3, ///< this is an incomplete block (either being produced by a producer or speculatively produced by a node)
     };
 
+    // bytes held by the structures of chain, sizes of state databases are the ones they're mapped with
+    struct memory_usage {
+        uint64_t state_size      = 0;
+        uint64_t state_used      = 0;
+        uint64_t reversible_size = 0;
+        uint64_t reversible_used = 0;
+
+        uint32_t fork_db_blocks = 0;
+        uint64_t fork_db_bytes  = 0;
+
+        uint32_t unapplied_transactions = 0;
+
+        uint64_t token_db_cache_usage    = 0;
+        uint64_t token_db_cache_capacity = 0;
+        uint64_t blocks_cache_usage      = 0;  // recent irreversible blocks
+        uint64_t keys_cache_usage        = 0;  // recovered keys of transactions
+
+        token_database_memory_usage token_db;
+    };
+
     explicit controller(const config& cfg);
     ~controller();
 
@@ -129,12 +185,26 @@ public:
 
     void push_block(const signed_block_ptr& b);
 
+    // warm token database with the tokens going to be touched by the transactions in background
+    void prefetch_transaction(const transaction_metadata_ptr& trx) const;
+    void prefetch_block(const signed_block_ptr& b) const;  // keys of transactions are recovered as well
+    void prefetch_packed_block(std::vector<char>&& packed) const;  // block is unpacked in worker thread
+
+    // recovered keys are cached and shared by all the metadata of the same signed transaction
+    const public_keys_set& recover_keys(const transaction_metadata_ptr& trx) const;
+
+    // recover signing keys of transaction in background, `next` is called in worker thread once they're ready,
+    // or directly if there's no worker
+    void recover_keys_async(const transaction_metadata_ptr& trx, std::function<void()>&& next) const;
+
     chainbase::database& db() const;
     fork_database& fork_db() const;
+    const block_log& get_block_log() const;
     token_database& token_db() const;
     token_database_cache& token_db_cache() const;
 
     charge_manager get_charge_manager() const;
+    action_profiler& get_action_profiler() const;
 
     execution_context& get_execution_context() const;
 
@@ -172,10 +242,23 @@ public:
 
     block_id_type   get_block_id_for_num(uint32_t block_num) const;
     evt_link_object get_link_obj_for_link_id(const link_id_type&) const;
+    // no-throw version of `get_link_obj_for_link_id`, returns empty when link id is not found
+    std::optional<evt_link_object> find_link_obj_for_link_id(const link_id_type&) const;
     uint32_t        get_block_num_for_trx_id(const transaction_id_type& trx_id) const;
+    // position of the transaction in its block, empty if it's unknown
+    std::optional<uint32_t> get_trx_index_for_trx_id(const transaction_id_type& trx_id) const;
+    // id of block and the receipt at `index` of it, only the receipt is unpacked when block is read from block log
+    std::optional<std::pair<block_id_type, transaction_receipt>> fetch_transaction_receipt(uint32_t block_num, uint32_t index) const;
 
     fc::sha256 calculate_integrity_hash() const;
-    void write_snapshot(const std::shared_ptr<snapshot_writer>& snapshot) const;
+    // cheap digest of state, it's maintained incrementally and can be compared between nodes at the same head.
+    // it's not the same as integrity hash
+    fc::sha256 calculate_state_digest() const;
+    // token database is written as a native checkpoint into `tokendb_checkpoint` if it's provided
+    // or only its changes since the snapshot `delta_base` are written, which should be in the same directory
+    void write_snapshot(const std::shared_ptr<snapshot_writer>& snapshot,
+                        const std::optional<fc::path>&          tokendb_checkpoint = std::nullopt,
+                        const std::optional<fc::path>&          delta_base         = std::nullopt) const;
 
     bool is_producing_block() const;
 
@@ -184,6 +267,8 @@ public:
     void validate_db_available_size() const;
     void validate_reversible_available_size() const;
 
+    memory_usage get_memory_usage() const;
+
     bool is_known_unexpired_transaction(const transaction_id_type& id) const;
 
     int64_t set_proposed_producers(vector<producer_key> producers);
@@ -193,12 +278,16 @@ public:
 
     bool light_validation_allowed(bool replay_opts_disabled_by_policy) const;
     bool skip_auth_check() const;
+    // zstd is only accepted after more than 2/3 of active producers voted `zstd-compression` by prodvote
+    bool is_compression_activated(packed_transaction::compression_type type) const;
     bool skip_db_sessions() const;
     bool skip_db_sessions(block_status bs) const;
     bool skip_trx_checks() const;
     bool loadtest_mode() const;
     bool charge_free_mode() const;
     bool contracts_console() const;
+    // whether transactions applied in the pending block get traces without the details of actions
+    bool lite_trace() const;
 
     db_read_mode    get_read_mode() const;
     validation_mode get_validation_mode() const;
@@ -214,6 +303,12 @@ public:
     signal<void(const transaction_trace_ptr&)>    applied_transaction;
     signal<void(const int&)>                      bad_alloc;
 
+    // batched alternatives of applied_transaction, traces are only collected when any of them is connected.
+    // the first one is emitted in main thread right before accepted_block, the other one in a dedicated thread
+    // in the order of blocks, its handlers should not touch chain state
+    signal<void(const block_traces_ptr&)> applied_block_traces;
+    signal<void(const block_traces_ptr&)> applied_block_traces_async;
+
     public_keys_set get_required_keys(const transaction& trx, const public_keys_set& candidate_keys) const;
     public_keys_set get_suspend_required_keys(const transaction& trx, const public_keys_set& candidate_keys) const;
     public_keys_set get_suspend_required_keys(const proposal_name& name, const public_keys_set& candidate_keys) const;
@@ -228,6 +323,8 @@ private:
 
 }}  // namespace evt::chain
 
+FC_REFLECT(evt::chain::controller::memory_usage, (state_size)(state_used)(reversible_size)(reversible_used)(fork_db_blocks)(fork_db_bytes)
+           (unapplied_transactions)(token_db_cache_usage)(token_db_cache_capacity)(blocks_cache_usage)(keys_cache_usage)(token_db));
 FC_REFLECT(evt::chain::controller::config,
            (blocks_dir)
            (state_dir)
@@ -240,6 +337,7 @@ FC_REFLECT(evt::chain::controller::config,
            (charge_free_mode)
            (contracts_console)
            (trusted_producers)
+           (trusted_checkpoint_num)
            (db_config)
            (genesis)
            );
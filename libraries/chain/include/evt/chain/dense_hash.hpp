@@ -46,7 +46,14 @@ pack(Stream& s, const google::dense_hash_map<K, V, Others...>& map) {
 template<typename Stream, typename K, typename V, typename ... Others>
 inline void
 unpack(Stream& s, google::dense_hash_map<K, V, Others...>& map) {
-    return;
+    // empty key should be set before, buckets are restored in the same layout as packed
+    auto b = StreamWrapper<Stream>(s);
+    auto r = map.unserialize([](auto ps, auto v) {
+        fc::raw::unpack(ps->underlying_stream(), const_cast<std::remove_const_t<K>&>(v->first));
+        fc::raw::unpack(ps->underlying_stream(), v->second);
+        return true;
+    }, &b);
+    FC_ASSERT(r, "Invalid packed dense_hash_map");
 }
 
 }}  // namespace fc
\ No newline at end of file
@@ -143,6 +143,9 @@ FC_DECLARE_DERIVED_EXCEPTION( payer_exception,                 transaction_excep
 FC_DECLARE_DERIVED_EXCEPTION( too_many_tx_at_once,             transaction_exception, 3030013, "Pushing too many transactions at once" );
 FC_DECLARE_DERIVED_EXCEPTION( tx_too_big,                      transaction_exception, 3030014, "Transaction is too big" );
 FC_DECLARE_DERIVED_EXCEPTION( unknown_transaction_compression, transaction_exception, 3030015, "Unknown transaction compression" );
+FC_DECLARE_DERIVED_EXCEPTION( tx_queue_full,                   transaction_exception, 3030016, "Incoming transaction queue is full" );
+FC_DECLARE_DERIVED_EXCEPTION( tx_compression_error,            transaction_exception, 3030017, "Error compressing transaction" );
+FC_DECLARE_DERIVED_EXCEPTION( tx_compression_not_activated,    transaction_exception, 3030018, "Transaction compression is not activated" );
 
 FC_DECLARE_DERIVED_EXCEPTION( action_exception,           chain_exception,  3040000, "action exception" );
 FC_DECLARE_DERIVED_EXCEPTION( action_authorize_exception, action_exception, 3040001, "invalid action authorization" );
@@ -244,6 +247,7 @@ FC_DECLARE_DERIVED_EXCEPTION( bonus_latest_not_expired,       bonus_exception,
 FC_DECLARE_DERIVED_EXCEPTION( bonus_unreached_dist_threshold, bonus_exception,  3041011, "Distribution threshold is unreached" );
 FC_DECLARE_DERIVED_EXCEPTION( bonus_method_exception,         bonus_exception,  3041012, "Invalid method for passive bonus" );
 FC_DECLARE_DERIVED_EXCEPTION( bonus_symbol_exception,         bonus_exception,  3041013, "Invalid symbol in bonus definition" );
+FC_DECLARE_DERIVED_EXCEPTION( bonus_dist_continuation_exception, bonus_exception, 3041014, "Continuation doesn't match the distribution in progress" );
 
 FC_DECLARE_DERIVED_EXCEPTION( producer_exception,                      chain_exception,    3050000, "Producer exception" );
 FC_DECLARE_DERIVED_EXCEPTION( producer_priv_key_not_found,             producer_exception, 3050001, "Producer private key is not available" );
@@ -314,6 +318,7 @@ FC_DECLARE_DERIVED_EXCEPTION( missing_chain_plugin_exception,        plugin_exce
 FC_DECLARE_DERIVED_EXCEPTION( missing_producer_api_plugin_exception, plugin_exception, 3130009, "Missing Producer API Plugin" );
 FC_DECLARE_DERIVED_EXCEPTION( missing_postgres_plugin_exception,     plugin_exception, 3130010, "Missing postgres Plugin" );
 FC_DECLARE_DERIVED_EXCEPTION( exceed_query_limit_exception,          plugin_exception, 3130011, "Exceed max query limit" );
+FC_DECLARE_DERIVED_EXCEPTION( invalid_query_cursor_exception,        plugin_exception, 3130012, "Invalid cursor of paginated query" );
 
 FC_DECLARE_DERIVED_EXCEPTION( wallet_exception,                  chain_exception,  3140000, "wallet exception" );
 FC_DECLARE_DERIVED_EXCEPTION( wallet_exist_exception,            wallet_exception, 3140001, "Wallet already exists" );
@@ -341,6 +346,7 @@ FC_DECLARE_DERIVED_EXCEPTION( token_database_squash_exception,     token_databas
 FC_DECLARE_DERIVED_EXCEPTION( token_database_snapshot_exception,   token_database_exception, 3150009, "Create or restore snapshot failed" );
 FC_DECLARE_DERIVED_EXCEPTION( token_database_persist_exception,    token_database_exception, 3150010, "Persist savepoints failed" );
 FC_DECLARE_DERIVED_EXCEPTION( token_database_cache_exception,      token_database_exception, 3150010, "Invalid cache entry" );
+FC_DECLARE_DERIVED_EXCEPTION( token_database_format_exception,     token_database_exception, 3150011, "Unsupported format of token database" );
 
 FC_DECLARE_DERIVED_EXCEPTION( guard_exception,            database_exception, 3160101, "Database exception" );
 FC_DECLARE_DERIVED_EXCEPTION( database_guard_exception,   guard_exception,    3160102, "Database usage is at unsafe levels" );
@@ -399,6 +405,7 @@ FC_DECLARE_DERIVED_EXCEPTION( postgres_send_exception,        postgres_plugin_ex
 FC_DECLARE_DERIVED_EXCEPTION( postgres_poll_exception,        postgres_plugin_exception, 3230006, "Poll messages from postgres failed" );
 FC_DECLARE_DERIVED_EXCEPTION( postgres_query_exception,       postgres_plugin_exception, 3230007, "Query from postgres failed" );
 FC_DECLARE_DERIVED_EXCEPTION( postgres_not_enabled_exception, postgres_plugin_exception, 3230008, "Postgres plugin is not enabled" );
+FC_DECLARE_DERIVED_EXCEPTION( postgres_query_timeout_exception, postgres_plugin_exception, 3230009, "Query from postgres is timeout" );
 
 FC_DECLARE_DERIVED_EXCEPTION( execution_exception,      chain_exception,     3240000, "Execution exception" );
 FC_DECLARE_DERIVED_EXCEPTION( unknown_action_exception, execution_exception, 3240001, "Unknown action exception" );
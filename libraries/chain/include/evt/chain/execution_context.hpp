@@ -35,6 +35,11 @@ public:
     virtual int get_current_version(name act) const = 0;
     virtual int get_max_version(name act) const = 0;
     virtual std::vector<action_ver_type> get_current_actions() const = 0;
+
+    // index and current version of action, resolved by one lookup
+    virtual std::pair<int, int> get_index_and_version(name act) const = 0;
+    // type names of all the versions of each action, ordered by action index then version
+    virtual std::vector<std::vector<std::string>> get_all_acttype_names() const = 0;
 };
 
 // helper method to add const lvalue reference to type object
@@ -7,6 +7,8 @@
 #include <algorithm>
 #include <array>
 #include <functional>
+#include <memory>
+#include <optional>
 #include <string>
 #include <type_traits>
 
@@ -38,10 +40,6 @@ public:
             type_names_[i].emplace_back(decltype(+act)::type::get_type_name());
             assert(type_names_[i].size() == decltype(+act)::type::get_version());
         });
-
-        act_names_arr_ = hana::unpack(act_names_, [](auto ...i) {
-            return std::array<uint64_t, sizeof...(i)>{{i...}};
-        });
     }
 
     ~execution_context_impl() override {}
@@ -106,6 +104,8 @@ public:
 
     int
     set_version(name act, int newver) override {
+        EVT_ASSERT(!pinned_vers_.has_value(), action_version_exception, "Versions of pinned context cannot be set");
+
         auto index = index_of(act);
         auto cver  = get_curr_ver(index);
         auto mver  = type_names_[index].size();
@@ -120,6 +120,8 @@ public:
 
     int
     set_version_unsafe(name act, int newver) override {
+        EVT_ASSERT(!pinned_vers_.has_value(), action_version_exception, "Versions of pinned context cannot be set");
+
         auto index = index_of(act);
         auto cver  = get_curr_ver(index);
 
@@ -145,50 +147,45 @@ public:
         return (int)type_names_[index_of(act)].size();
     }
 
+    std::pair<int, int>
+    get_index_and_version(name act) const override {
+        auto index = index_of(act);
+        return { index, get_curr_ver(index) };
+    }
+
+    std::vector<std::vector<std::string>>
+    get_all_acttype_names() const override {
+        auto names = std::vector<std::vector<std::string>>();
+        names.reserve(type_names_.size());
+        for(auto& tn : type_names_) {
+            names.emplace_back(tn.cbegin(), tn.cend());
+        }
+        return names;
+    }
+
     template <template<uint64_t> typename Invoker, typename RType, typename ... Args>
     RType
     invoke(int actindex, Args&&... args) const {
-        using opt_type = std::conditional_t<std::is_void<RType>::value, int, RType>;
-
-        auto fn = [&](auto i) -> std::optional<opt_type> {
-            auto name  = act_names_[i];
-            auto vers  = hana::filter(act_types_,
-                [&](auto& t) { return hana::equal(name, hana::ulong_c<decltype(+t)::type::get_action_name().value>); });
-            auto cver = get_curr_ver(i);
-
-            static_assert(hana::length(vers)() > hana::size_c<0>(), "empty version actions!");
-
-            auto result = std::optional<opt_type>();
-            hana::for_each(vers, [&, cver](auto v) {
-                using ty = typename decltype(+v)::type;
-
-                constexpr auto n = ty::get_action_name().value;
-                if(ty::get_version() == cver) {
-                    if constexpr (std::is_void<RType>::value) {
-                        Invoker<n>::template invoke<ty>(std::forward<Args>(args)...);
-                        result = 1;
-                    }
-                    else {
-                        result = Invoker<n>::template invoke<ty>(std::forward<Args>(args)...);
-                    }
-                }
-            });
+        EVT_ASSERT(actindex >= 0 && actindex < (int)kActsNum, action_index_exception, "Invalid action index: ${act}", ("act", actindex));
 
-            return result;
-        };
+        auto cver = get_curr_ver(actindex);
+        auto pos  = act_offsets_[actindex] + cver - 1;
+        EVT_ASSERT(cver > 0 && pos < act_offsets_[actindex + 1], action_index_exception, "Invalid action index: ${act}", ("act", actindex));
 
-        auto range  = hana::make_range(hana::int_c<0>, hana::length(act_names_));
-        auto result = std::optional<opt_type>();
-        hana::for_each(range, [&](auto i) {
-            if(i() == actindex) {
-                result = fn(i);
-            }
-        });
+        return dispatcher<Invoker, RType, Args...>::table[pos](std::forward<Args>(args)...);
+    }
 
-        EVT_ASSERT(result.has_value(), action_index_exception, "Invalid action index: ${act}", ("act", actindex));
-        if constexpr (!std::is_void<RType>::value) {
-            return *result;
-        }
+    // values evaluated at compile time for each action type, fetched without any dispatching
+    template <template<uint64_t> typename Getter, typename RType>
+    const RType&
+    get_constant(int actindex) const {
+        EVT_ASSERT(actindex >= 0 && actindex < (int)kActsNum, action_index_exception, "Invalid action index: ${act}", ("act", actindex));
+
+        auto cver = get_curr_ver(actindex);
+        auto pos  = act_offsets_[actindex] + cver - 1;
+        EVT_ASSERT(cver > 0 && pos < act_offsets_[actindex + 1], action_index_exception, "Invalid action index: ${act}", ("act", actindex));
+
+        return constants<Getter, RType>::table[pos];
     }
 
     template <typename T, typename Func>
@@ -216,7 +213,18 @@ public:
     get_current_actions() const override {
         auto acts = std::vector<action_ver_type>();
         acts.reserve(act_names_arr_.size());
-        
+
+        if(pinned_vers_.has_value()) {
+            for(auto i = 0u; i < kActsNum; i++) {
+                acts.push_back(action_ver_type {
+                    .act  = name(act_names_arr_[i]),
+                    .ver  = (*pinned_vers_)[i],
+                    .type = type_names_[i][(*pinned_vers_)[i] - 1]
+                });
+            }
+            return acts;
+        }
+
         auto& conf = chain_.get_global_properties();
         for(auto& av : conf.action_vers) {
             acts.push_back(action_ver_type {
@@ -228,9 +236,27 @@ public:
         return acts;
     }
 
+    // context whose versions of actions are pinned to the current ones, it's made in main thread and never reads
+    // chain state afterwards, so it can be used by other threads while the chain keeps changing.
+    // versions of it can not be set
+    std::unique_ptr<execution_context_impl>
+    pin_versions() const {
+        auto  ctx  = std::make_unique<execution_context_impl>(chain_);
+        auto& conf = chain_.get_global_properties();
+
+        ctx->pinned_vers_.emplace();
+        for(auto i = 0u; i < kActsNum; i++) {
+            (*ctx->pinned_vers_)[i] = conf.action_vers[i].ver;
+        }
+        return ctx;
+    }
+
 private:
     int
     get_curr_ver(int index) const {
+        if(pinned_vers_.has_value()) {
+            return (*pinned_vers_)[index];
+        }
         auto& conf = chain_.get_global_properties();
         return conf.action_vers[index].ver;
     }
@@ -238,11 +264,72 @@ private:
 private:
     static constexpr auto act_types_ = hana::make_tuple(hana::type_c<ACTTYPE>...);
     static constexpr auto act_names_ = hana::sort(hana::unique(hana::transform(act_types_, [](auto& a) { return hana::ulong_c<decltype(+a)::type::get_action_name().value>; })));
+    static constexpr auto kActsNum   = decltype(hana::length(act_names_))::value;
+
+    static constexpr auto act_names_arr_ = hana::unpack(act_names_, [](auto ...i) {
+        return std::array<uint64_t, sizeof...(i)>{{i...}};
+    });
+
+    // action types are placed in dispatch table ordered by action index then version,
+    // versions of action `i` are in [act_offsets_[i], act_offsets_[i + 1])
+    static constexpr auto act_offsets_ = [] {
+        constexpr uint64_t names[] = { ACTTYPE::get_action_name().value... };
+
+        auto offsets = std::array<int, kActsNum + 1>{};
+        for(auto i = 0u; i < kActsNum; i++) {
+            auto n = 0;
+            for(auto name : names) {
+                if(name == act_names_arr_[i]) {
+                    n++;
+                }
+            }
+            offsets[i + 1] = offsets[i] + n;
+        }
+        return offsets;
+    }();
+
+    template<typename T>
+    static constexpr int
+    table_pos_of() {
+        auto i = 0u;
+        while(act_names_arr_[i] != T::get_action_name().value) {
+            i++;
+        }
+        return act_offsets_[i] + T::get_version() - 1;
+    }
+
+    // table of invokers of all the action types, it's generated for each kind of invoking
+    template <template<uint64_t> typename Invoker, typename RType, typename ... Args>
+    struct dispatcher {
+        using invoke_func = RType (*)(Args&&...);
+
+        template<typename T>
+        static RType
+        invoke(Args&&... args) {
+            return Invoker<T::get_action_name().value>::template invoke<T>(std::forward<Args>(args)...);
+        }
+
+        static constexpr auto table = [] {
+            auto t = std::array<invoke_func, sizeof...(ACTTYPE)>{};
+            ((t[table_pos_of<ACTTYPE>()] = &invoke<ACTTYPE>), ...);
+            return t;
+        }();
+    };
+
+    // table of constants of all the action types, placed the same as dispatch table
+    template <template<uint64_t> typename Getter, typename RType>
+    struct constants {
+        static constexpr auto table = [] {
+            auto t = std::array<RType, sizeof...(ACTTYPE)>{};
+            ((t[table_pos_of<ACTTYPE>()] = Getter<ACTTYPE::get_action_name().value>::template get<ACTTYPE>()), ...);
+            return t;
+        }();
+    };
 
 private:
-    controller&                                                        chain_;
-    std::array<uint64_t, hana::length(act_names_)>                     act_names_arr_;
-    std::array<small_vector<std::string, 4>, hana::length(act_names_)> type_names_;
+    controller&                                          chain_;
+    std::array<small_vector<std::string, 4>, kActsNum>   type_names_;
+    std::optional<std::array<int, kActsNum>>             pinned_vers_;
 };
 
 using evt_execution_context = execution_context_impl<
@@ -280,7 +367,8 @@ using evt_execution_context = execution_context_impl<
                                   contracts::tryunlock,
                                   contracts::setpsvbonus,
                                   contracts::setpsvbonus_v2,
-                                  contracts::distpsvbonus
+                                  contracts::distpsvbonus,
+                                  contracts::distpsvbonus_v2
                               >;
 
 }}  // namespace evt::chain
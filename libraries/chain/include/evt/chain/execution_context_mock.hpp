@@ -106,6 +106,22 @@ public:
         return (int)type_names_[index_of(act)].size();
     }
 
+    std::pair<int, int>
+    get_index_and_version(name act) const override {
+        auto index = index_of(act);
+        return { index, get_curr_ver(index) };
+    }
+
+    std::vector<std::vector<std::string>>
+    get_all_acttype_names() const override {
+        auto names = std::vector<std::vector<std::string>>();
+        names.reserve(type_names_.size());
+        for(auto& tn : type_names_) {
+            names.emplace_back(tn.cbegin(), tn.cend());
+        }
+        return names;
+    }
+
     template <template<uint64_t> typename Invoker, typename RType, typename ... Args>
     RType
     invoke(int actindex, Args&&... args) const {
@@ -240,7 +256,8 @@ using evt_execution_context_mock = execution_context_mock<
                                       contracts::tryunlock,
                                       contracts::setpsvbonus,
                                       contracts::setpsvbonus_v2,
-                                      contracts::distpsvbonus
+                                      contracts::distpsvbonus,
+                                      contracts::distpsvbonus_v2
                                   >;
 
 }}  // namespace evt::chain
@@ -22,10 +22,13 @@ typedef vector<block_state_ptr> branch_type;
  * database tracks the longest chain and the last irreversible block number. All
  * blocks older than the last irreversible block are freed after emitting the
  * irreversible signal.
+ *
+ * When journal is enabled, every change is appended into a journal file so that
+ * the fork database is recovered even if it's not closed cleanly.
  */
 class fork_database {
 public:
-    fork_database(const fc::path& data_dir);
+    fork_database(const fc::path& data_dir, bool journal = false);
     ~fork_database();
 
     void close();
@@ -51,6 +54,9 @@ public:
 
     const block_state_ptr& head() const;
 
+    size_t   size() const;
+    uint64_t memory_usage() const;  // approximated by packed sizes of block states, walks all of them
+
     /**
      *  Given two head blocks, return two branches of the fork graph that
      *  end with a common ancestor (same prior block)
@@ -73,6 +79,7 @@ public:
 
 private:
     void                           set_bft_irreversible(block_id_type id);
+    void                           replay_journal(const fc::path& filename);
     unique_ptr<fork_database_impl> my;
 };
 
@@ -241,6 +241,71 @@ public:
         return _active_nodes.back();
     }
 
+    /**
+       * Add nodes to the incremental tree in one pass, the result is the same as appending them one by one.
+       *
+       * Active nodes (except the root) are the roots of the fully-realized sub-trees of the binary
+       * decomposition of _node_count, ordered from the smallest to the largest. All the nodes but the
+       * last one are folded level by level into them, each level of new fully-realized nodes is hashed
+       * at once. Partial nodes are not computed for them since they would be discarded immediately.
+       * The last node is appended as usual to compute the root.
+       *
+       * @param digests - the nodes to add, cannot be empty
+       * @return - the new root
+       */
+    const DigestType&
+    append(const vector<DigestType>& digests) {
+        FC_ASSERT(!digests.empty(), "there's no nodes to append");
+        if(digests.size() == 1) {
+            return append(digests.front());
+        }
+
+        auto chunks_num = (size_t)__builtin_popcountll(_node_count);
+        auto chunks     = vector<DigestType>(_active_nodes.begin(), _active_nodes.begin() + chunks_num);
+        auto next       = 0u;  // next old chunk to be combined
+
+        auto updated_chunks = vector<DigestType>();
+        updated_chunks.reserve(detail::calcluate_max_depth(_node_count + digests.size()));
+
+        auto nodes = vector<DigestType>(digests.begin(), digests.end() - 1);
+        auto index = _node_count;  // index of the first node in current level
+        while(!nodes.empty()) {
+            if(index & 0x1) {
+                // the "left" value of first node is the root of old sub-tree in this level
+                nodes.insert(nodes.begin(), chunks[next++]);
+                index--;
+            }
+            if(nodes.size() & 0x1) {
+                // the last one without "right" value is a new fully-realized sub-tree
+                updated_chunks.emplace_back(nodes.back());
+                nodes.pop_back();
+            }
+
+            auto n = nodes.size() / 2;
+            for(auto i = 0u; i < n; i++) {
+                nodes[2 * i]     = make_canonical_left(nodes[2 * i]);
+                nodes[2 * i + 1] = make_canonical_right(nodes[2 * i + 1]);
+            }
+            DigestType::hash_pairs(nodes.data(), n, nodes.data());
+            nodes.resize(n);
+
+            // move up a level in the tree
+            index = index >> 1;
+        }
+        // sub-trees in higher levels are not touched
+        updated_chunks.insert(updated_chunks.end(), chunks.begin() + next, chunks.end());
+
+        _node_count += digests.size() - 1;
+        if(_node_count & (_node_count - 1)) {
+            // root is not used by next append unless the count is a power-of-2,
+            // in which case the only sub-tree is the root itself
+            updated_chunks.emplace_back();
+        }
+        detail::move_nodes(_active_nodes, std::move(updated_chunks));
+
+        return append(digests.back());
+    }
+
     /**l
        * return the current root of the incremental merkle
        *
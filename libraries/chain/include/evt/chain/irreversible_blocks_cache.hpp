@@ -0,0 +1,63 @@
+/**
+ *  @file
+ *  @copyright defined in evt/LICENSE.txt
+*/
+#pragma once
+#include <memory>
+#include <boost/noncopyable.hpp>
+#include <rocksdb/cache.h>
+#include <evt/chain/block.hpp>
+
+namespace evt { namespace chain {
+
+// recent irreversible blocks kept in memory by their numbers, so that syncing peers and api clients
+// fetching them don't read and unpack them from block log again
+// irreversible blocks never change, so entries are never invalidated, it's disabled if capacity is 0
+class irreversible_blocks_cache : boost::noncopyable {
+public:
+    irreversible_blocks_cache(size_t capacity)
+        : cache_(capacity > 0 ? rocksdb::NewLRUCache(capacity, kCacheShardBits) : nullptr) {}
+
+private:
+    // each shard of lru cache has its own mutex
+    static constexpr int kCacheShardBits = 4;
+
+    static rocksdb::Slice
+    as_slice(const uint32_t& block_num) {
+        return rocksdb::Slice((const char*)&block_num, sizeof(block_num));
+    }
+
+public:
+    // thread safe, blocks are put by main thread and fetched by any threads
+    void
+    put(const signed_block_ptr& b) {
+        if(!cache_) {
+            return;
+        }
+        auto num = b->block_num();
+        // capacity is the number of blocks
+        auto s   = cache_->Insert(as_slice(num), (void*)new signed_block_ptr(b), 1, [](auto& ck, auto cv) { delete (signed_block_ptr*)cv; }, nullptr /* handle */);
+        FC_ASSERT(s == rocksdb::Status::OK());
+    }
+
+    signed_block_ptr
+    get(uint32_t block_num) const {
+        if(!cache_) {
+            return nullptr;
+        }
+        auto h = cache_->Lookup(as_slice(block_num));
+        if(h == nullptr) {
+            return nullptr;
+        }
+        auto b = *(const signed_block_ptr*)cache_->Value(h);
+        cache_->Release(h);
+        return b;
+    }
+
+    size_t size() const { return cache_ ? cache_->GetUsage() : 0; }
+
+private:
+    std::shared_ptr<rocksdb::Cache> cache_;
+};
+
+}}  // namespace evt::chain
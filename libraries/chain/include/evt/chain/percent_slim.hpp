@@ -33,6 +33,18 @@ public:
     uint32_t raw_value() const { return v_.value; }
     explicit operator percent_type() const { return value(); }
 
+    // floor(value() * amount) in 128-bit integers, it's exact so results are the same
+    // as the ones calculated in percent_type but without the multiprecision decimals
+    int64_t
+    floor_mul(int64_t amount) const {
+        auto p = (__int128)v_.value * amount;
+        auto q = p / kMaxAmount;
+        if(p % kMaxAmount < 0) {
+            q--;
+        }
+        return (int64_t)q;
+    }
+
 public:
     static percent_slim from_string(const string& from);
     string              to_string() const;
@@ -0,0 +1,69 @@
+/**
+ *  @file
+ *  @copyright defined in evt/LICENSE.txt
+*/
+#pragma once
+#include <memory>
+#include <boost/noncopyable.hpp>
+#include <rocksdb/cache.h>
+#include <evt/chain/transaction_metadata.hpp>
+
+namespace evt { namespace chain {
+
+// recovered signing keys of transactions shared by all the metadata of the same signed transaction,
+// so that keys of one transaction are recovered only once even if it's received or applied many times
+class recovered_keys_cache : boost::noncopyable {
+public:
+    recovered_keys_cache(size_t capacity)
+        : cache_(rocksdb::NewLRUCache(capacity, kCacheShardBits)) {}
+
+private:
+    // each shard of lru cache has its own mutex
+    static constexpr int kCacheShardBits = 4;
+
+    struct cache_entry {
+        chain_id_type   chain_id;
+        public_keys_set keys;
+    };
+
+    static rocksdb::Slice
+    as_slice(const transaction_id_type& id) {
+        return rocksdb::Slice(id.data(), id.data_size());
+    }
+
+public:
+    // keys in `trx` are filled from cache, only recovered from signatures if they're not existed
+    // it's thread safe as long as `trx` itself is not touched by others at the same time
+    const public_keys_set&
+    recover(transaction_metadata& trx, const chain_id_type& chain_id) {
+        if(trx.signing_keys.has_value() && trx.signing_keys->first == chain_id) {
+            return trx.signing_keys->second;
+        }
+
+        auto k = as_slice(trx.signed_id());
+        if(auto h = cache_->Lookup(k); h != nullptr) {
+            auto entry = (const cache_entry*)cache_->Value(h);
+            if(entry->chain_id == chain_id) {
+                trx.signing_keys = std::make_pair(chain_id, entry->keys);
+                cache_->Release(h);
+                return trx.signing_keys->second;
+            }
+            cache_->Release(h);
+        }
+
+        auto& keys  = trx.recover_keys(chain_id);
+        auto  entry = new cache_entry { chain_id, keys };
+        // capacity is the number of transactions
+        auto  s     = cache_->Insert(k, (void*)entry, 1, [](auto& ck, auto cv) { delete (cache_entry*)cv; }, nullptr /* handle */);
+        FC_ASSERT(s == rocksdb::Status::OK());
+
+        return keys;
+    }
+
+    size_t size() const { return cache_->GetUsage(); }
+
+private:
+    std::shared_ptr<rocksdb::Cache> cache_;
+};
+
+}}  // namespace evt::chain
@@ -0,0 +1,89 @@
+/**
+ *  @file
+ *  @copyright defined in evt/LICENSE.txt
+ */
+#pragma once
+#include <deque>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <boost/asio/thread_pool.hpp>
+#include <boost/noncopyable.hpp>
+#include <fc/filesystem.hpp>
+#include <evt/chain/block.hpp>
+
+namespace evt { namespace chain {
+
+/* Append-only log of the reversible blocks, used instead of the chainbase database of them when
+ * `reversible_blocks_log` is set in the config of controller.
+ *
+ * +--------+-----------+------------------+------------------+-----+------------------+
+ * | Header | Dead ... | Entry of lib + 1 | Entry of lib + 2 | ... | Entry of head    |
+ * +--------+-----------+------------------+------------------+-----+------------------+
+ *
+ * Header is the magic, version and the position of first live entry, each entry is the number and size
+ * of the block followed by the packed block. Blocks in log are always contiguous from the one after the
+ * last irreversible block to head, so the index is only their positions in memory which is rebuilt by one
+ * scan when the log is opened, the torn tail left by a crash is truncated then.
+ *
+ * Popping head truncates the file, and the blocks become irreversible are dropped from the front by moving
+ * the start in header. Once the dead front is larger than the live part, the live part is moved to the
+ * beginning of a new file, so the file works like a ring and stays small.
+ *
+ * When `async` is set, blocks are packed and written in one background thread, mutations are queued in
+ * order and reads wait for all the queued ones first. Errors of background writes are thrown by next read
+ * or `flush`.
+ */
+class reversible_block_log : boost::noncopyable {
+public:
+    reversible_block_log(const fc::path& dir, bool async = false, bool read_only = false);
+    ~reversible_block_log();
+
+public:
+    void append(const signed_block_ptr& b);
+    void remove_from(uint32_t block_num);   // removes `block_num` and the ones after it
+    void remove_until(uint32_t block_num);  // removes `block_num` and the ones before it
+    void flush();
+
+    signed_block_ptr read_block(uint32_t block_num);
+    void             for_each(const std::function<void(const signed_block_ptr&)>& func);
+
+    uint32_t first_block_num();  // 0 if it's empty
+    uint32_t last_block_num();   // 0 if it's empty
+    uint64_t file_size();
+
+    bool recovered() const { return recovered_; }  // torn tail was found when opened
+
+public:
+    static const char* file_name;
+
+private:
+    void open();
+    void write_start();
+    void compact();
+
+    void append_block(const signed_block_ptr& b);
+    void truncate_from(uint32_t block_num);
+    void drop_until(uint32_t block_num);
+
+    signed_block_ptr read_entry(uint64_t pos) const;
+
+    template<typename Func>
+    void run(Func&& func);
+
+private:
+    fc::path path_;
+    int      fd_;
+    bool     read_only_;
+    bool     recovered_ = false;
+
+    uint64_t             start_pos_;
+    uint64_t             end_pos_;
+    uint32_t             first_num_ = 0;
+    std::deque<uint64_t> positions_;  // of the entries from `first_num_`
+
+    std::optional<boost::asio::thread_pool> writer_;
+    std::exception_ptr                      error_;
+};
+
+}}  // namespace evt::chain
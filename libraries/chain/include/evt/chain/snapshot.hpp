@@ -4,8 +4,13 @@
  */
 #pragma once
 
+#include <memory>
+#include <mutex>
 #include <ostream>
 #include <optional>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
 #include <evt/chain/database_utils.hpp>
 #include <evt/chain/exceptions.hpp>
 #include <fc/variant_object.hpp>
@@ -19,8 +24,9 @@ namespace evt { namespace chain {
  * Version 2: Token database upgrades to binary format
  * Version 3: Postgres upgrades to binary format and use zlib compress stream
  * Version 4: Add seq to postgres and execution context to global property object
+ * Version 5: Metas of domains, tokens and fungibles are stored apart in token database
  */
-static const uint32_t current_snapshot_version = 4;
+static const uint32_t current_snapshot_version = 5;
 
 namespace detail {
 template <typename T>
@@ -217,6 +223,9 @@ public:
         write_section(detail::snapshot_section_traits<T>::section_name(), f);
     }
 
+    // sections can be written by different threads at the same time, rows of one are always written by one thread
+    virtual bool concurrent() const { return false; }
+
     virtual ~snapshot_writer(){};
 
 protected:
@@ -406,6 +415,9 @@ public:
     virtual size_t get_section_size(const string& section_name) = 0;
     virtual std::vector<std::string> get_section_names(const std::string& prefix) const = 0;
 
+    // sections can be read by different threads at the same time, rows of one are always read by one thread
+    virtual bool concurrent() const { return false; }
+
     virtual ~snapshot_reader(){};
 
 protected:
@@ -518,6 +530,106 @@ private:
     std::vector<section_index> section_indexes;
 };
 
+namespace detail {
+
+struct zstd_snapshot_chunk {
+    uint64_t pos;       // in file
+    uint32_t size;      // compressed
+    uint32_t raw_size;  // of rows
+};
+
+struct zstd_snapshot_section {
+    std::string                      name;
+    uint64_t                         row_count = 0;
+    std::vector<zstd_snapshot_chunk> chunks;
+};
+
+}  // namespace detail
+
+/**
+ * Binary snapshot of format 2, rows of each section are split into chunks of whole rows and each chunk is
+ * compressed by zstd alone. Index of the sections and their chunks is in the footer, so that sections can be
+ * written and read by many threads at the same time:
+ *
+ * +-------+---------+---------------------------------+-------+--------------+-------+
+ * | Magic | Version | Chunks of sections in any order | Index | Pos of Index | Magic |
+ * +-------+---------+---------------------------------+-------+--------------+-------+
+ */
+class zstd_snapshot_writer : public snapshot_writer {
+public:
+    explicit zstd_snapshot_writer(std::ostream& snapshot);
+
+    void write_start_section(const std::string& section_name) override;
+    void write_row(const detail::abstract_snapshot_row_writer& row_writer) override;
+    void write_end_section() override;
+    void finalize();
+
+    bool concurrent() const override { return true; }
+
+    static const uint32_t magic_number = 0x30510551;
+    static const size_t   chunk_size   = 4 * 1024 * 1024;  // raw size of rows in each chunk
+
+private:
+    struct section_state {
+        detail::zstd_snapshot_section section;
+        std::ostringstream            rows;
+    };
+
+    section_state* cur_section();
+    void write_chunk(section_state& s);
+
+    std::ostream&                              snapshot;
+    std::mutex                                 mutex;  // guards stream and sections
+    std::vector<detail::zstd_snapshot_section> sections;
+
+    // section being written by each thread
+    std::mutex                                                           states_mutex;
+    std::unordered_map<std::thread::id, std::unique_ptr<section_state>> states;
+};
+
+class zstd_snapshot_reader : public snapshot_reader {
+public:
+    explicit zstd_snapshot_reader(std::istream& snapshot);
+
+    void validate() const override;
+    std::vector<std::string> get_section_names(const std::string& prefix) const override;
+    bool has_section(const string& section_name) override;
+    void set_section(const string& section_name) override;
+    size_t get_section_size(const string& section_name) override;
+    bool read_row(detail::abstract_snapshot_row_reader& row_reader) override;
+    bool empty() override;
+    bool eof() override;
+    void clear_section() override;
+
+    bool concurrent() const override { return true; }
+
+private:
+    struct section_state {
+        const detail::zstd_snapshot_section* section;
+        size_t                               next_chunk = 0;
+        uint64_t                             cur_row    = 0;
+        std::istringstream                   rows;
+    };
+
+    void build_section_indexes() override;
+    const detail::zstd_snapshot_section* find_section(const std::string& section_name) const;
+    void read_chunk(section_state& s);
+    section_state* cur_section();
+
+    std::istream&                              snapshot;
+    mutable std::mutex                         mutex;  // guards stream
+    std::streampos                             header_pos;
+    uint64_t                                   index_pos;
+    std::vector<detail::zstd_snapshot_section> sections;
+
+    // section being read by each thread
+    std::mutex                                                           states_mutex;
+    std::unordered_map<std::thread::id, std::unique_ptr<section_state>> states;
+};
+
+// reader of binary snapshot in either format, chosen by the magic number at the beginning
+snapshot_reader_ptr make_snapshot_reader(std::istream& snapshot);
+
 class integrity_hash_snapshot_writer : public snapshot_writer {
 public:
     explicit integrity_hash_snapshot_writer(fc::sha256::encoder& enc);
@@ -532,3 +644,6 @@ private:
 };
 
 }}  // namespace evt::chain
+
+FC_REFLECT(evt::chain::detail::zstd_snapshot_chunk, (pos)(size)(raw_size));
+FC_REFLECT(evt::chain::detail::zstd_snapshot_section, (name)(row_count)(chunks));
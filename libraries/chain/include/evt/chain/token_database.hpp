@@ -3,10 +3,14 @@
  *  @copyright defined in evt/LICENSE.txt
 */
 #pragma once
+#include <array>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <optional>
+#include <string>
 #include <string_view>
+#include <vector>
 #include <boost/noncopyable.hpp>
 #include <boost/signals2/signal.hpp>
 #include <fc/reflect/reflect.hpp>
@@ -24,10 +28,19 @@ class Slice;
 namespace evt { namespace chain {
 
 using read_value_func = std::function<bool(const std::string_view& key, std::string&&)>;
+using read_view_func  = std::function<void(const std::string_view& value)>;
+
+// status of lookups reporting misses by result instead of exceptions
+// misses are expected in many callers, throw only where a miss is really an error
+enum class read_status { found = 0, not_found };
+using read_owner_func = std::function<bool(const name128& domain, const name128& name)>;
+using read_expiry_func = std::function<bool(const fc::time_point_sec& expiry, const name128& name)>;
+using read_asset_index_func = std::function<bool(const symbol_id_type sym_id)>;
 
 enum class storage_profile {
     disk   = 0,
-    memory = 1
+    memory = 1,
+    hash   = 2   // point reads are served by hash tables in memory, rocksdb on disk is kept for durability and ranges
 };
 
 enum class token_type {
@@ -42,57 +55,141 @@ enum class token_type {
     evtlink,
     psvbonus,
     psvbonus_dist,
-    max_value = psvbonus_dist
+    meta,
+    max_value = meta
 };
 
+const char* get_token_type_name(token_type type);
+std::optional<token_type> get_token_type(const std::string_view& name);
+
 enum class action_op {
     add = 0,
     update,
     put
 };
 
-struct db_value {
+// bump allocator of packed values, blocks are reused and values are dropped all at once
+// when the outermost scope on it exits, so views of values made in scope are only valid till then
+class db_value_arena : boost::noncopyable {
+public:
+    static const size_t kBlockSize    = 64 * 1024;
+    static const size_t kMaxValueSize = kBlockSize / 4;  // larger values are not allocated in arena
+    static const size_t kMaxKeptBlocks = 16;
+
+    class scope : boost::noncopyable {
+    public:
+        scope(db_value_arena& arena) : arena_(arena), prev_(current_) {
+            arena_.depth_++;
+            current_ = &arena_;
+        }
+
+        ~scope() {
+            current_ = prev_;
+            if(--arena_.depth_ == 0) {
+                arena_.reset();
+            }
+        }
+
+    private:
+        db_value_arena& arena_;
+        db_value_arena* prev_;
+    };
+
+public:
+    // nullptr is returned if it's too large, caller should allocate it by itself
+    char*
+    allocate(size_t sz) {
+        if(sz > kMaxValueSize) {
+            return nullptr;
+        }
+        if(blocks_.empty() || offset_ + sz > kBlockSize) {
+            if(!blocks_.empty()) {
+                idx_++;
+            }
+            if(idx_ == blocks_.size()) {
+                blocks_.emplace_back(std::make_unique<char[]>(kBlockSize));
+            }
+            offset_ = 0;
+        }
+
+        auto p = blocks_[idx_].get() + offset_;
+        offset_ += sz;
+        return p;
+    }
+
+    void
+    reset() {
+        if(blocks_.size() > kMaxKeptBlocks) {
+            blocks_.resize(kMaxKeptBlocks);
+        }
+        idx_    = 0;
+        offset_ = 0;
+    }
+
+    size_t blocks_size() const { return blocks_.size(); }
+
+    // arena of the innermost scope in current thread, nullptr if there's none
+    static db_value_arena* current() { return current_; }
+
+private:
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    size_t                                idx_    = 0;
+    size_t                                offset_ = 0;
+    int                                   depth_  = 0;
+
+    inline static thread_local db_value_arena* current_ = nullptr;
+};
+
+// counters of operations on token database and its cache made in current thread,
+// they're only collected in the scope of them, used to profile actions
+struct db_op_counters {
+    uint64_t reads        = 0;
+    uint64_t writes       = 0;
+    uint64_t cache_hits   = 0;
+    uint64_t cache_misses = 0;
+
+    class scope : boost::noncopyable {
+    public:
+        scope(db_op_counters& counters) : prev_(current_) { current_ = &counters; }
+        ~scope() { current_ = prev_; }
+
+    private:
+        db_op_counters* prev_;
+    };
+
+    // counters of the innermost scope in current thread, nullptr if there's none
+    static db_op_counters* current() { return current_; }
+
 private:
-    static const int kInStakeSize = 1024 * 4;
-    enum { kArray = 0, kString };
-    using data_variant_t = std::variant<std::array<char, kInStakeSize>, std::string>;
+    inline static thread_local db_op_counters* current_ = nullptr;
+};
 
+// packed value, it's a view into current arena if there's one, otherwise it owns the buffer
+struct db_value {
 public:
-    db_value(const db_value& lhs) : var_(lhs.var_) {
-        set_view();
+    db_value(const db_value& lhs) : str_(lhs.str_) {
+        view_ = str_.empty() ? lhs.view_ : std::string_view(str_);
     }
 
-    db_value(db_value&& lhs) noexcept : var_(std::move(lhs.var_)) {
-        set_view();
+    db_value(db_value&& lhs) noexcept : str_(std::move(lhs.str_)) {
+        view_ = str_.empty() ? lhs.view_ : std::string_view(str_);
     }
 
 private:
     template<typename T>
-    db_value(const T& v) : var_(std::in_place_index_t<kArray>()) {
-        auto sz = fc::raw::pack_size(v);
-        if(sz <= kInStakeSize) {
-            auto& arr = std::get<kArray>(var_);
-            auto  ds  = fc::datastream<char*>(arr.data(), arr.size());
-            fc::raw::pack(ds, v);
-
-            view_ = std::string_view(arr.data(), sz);
+    db_value(const T& v) {
+        auto sz    = fc::raw::pack_size(v);
+        auto arena = db_value_arena::current();
+        auto buf   = arena != nullptr ? arena->allocate(sz) : nullptr;
+        if(buf == nullptr) {
+            str_.resize(sz);
+            buf = str_.data();
         }
-        else {
-            auto& str = var_.emplace<kString>();
-            str.resize(sz);
 
-            auto ds = fc::datastream<char*>((char*)str.data(), str.size());
-            fc::raw::pack(ds, v);
+        auto ds = fc::datastream<char*>(buf, sz);
+        fc::raw::pack(ds, v);
 
-            view_ = std::string_view(str.data(), sz);
-        }
-    }
-
-    void
-    set_view() {
-        std::visit([this](auto& buf) {
-            view_ = std::string_view(buf.data(), buf.size());
-        }, var_);
+        view_ = std::string_view(buf, sz);
     }
 
 public:
@@ -100,7 +197,7 @@ public:
     size_t size() const { return view_.size(); }
 
 private:
-    data_variant_t   var_;
+    std::string      str_;
     std::string_view view_;
 
 public:
@@ -121,16 +218,133 @@ extract_db_value(const std::string& str, T& v) {
     fc::raw::unpack(ds, v);
 }
 
-using token_keys_t = small_vector<name128, 4>;
+template<typename T>
+void
+extract_db_value(const std::string_view& str, T& v) {
+    auto ds = fc::datastream<const char*>(str.data(), str.size());
+    fc::raw::unpack(ds, v);
+}
+
+// aggregated values of holders whose balances are not less than one threshold
+struct asset_aggregate {
+    int64_t holders = 0;
+    int64_t total   = 0;
+};
+
+// structured counters of token database, they're only collected when `enable_stats` is set
+struct token_database_metrics {
+    struct type_metrics {
+        std::string           type;
+        uint64_t              reads       = 0;
+        uint64_t              writes      = 0;
+        uint64_t              exists      = 0;
+        uint64_t              read_bytes  = 0;
+        uint64_t              write_bytes = 0;
+        std::vector<uint64_t> read_latency;  // histogram, bucket i counts the ones within [2^(i-1), 2^i) microseconds
+        std::vector<uint64_t> write_latency;
+    };
+
+    std::vector<type_metrics> types;
+    uint32_t                  savepoints_depth        = 0;
+    uint32_t                  tokens_write_cache_size = 0;
+    uint32_t                  assets_write_cache_size = 0;
+    uint64_t                  block_cache_hit         = 0;
+    uint64_t                  block_cache_miss        = 0;
+    double                    block_cache_hit_ratio   = 0;
+};
+
+// bytes held in memory by token database
+struct token_database_memory_usage {
+    uint64_t block_cache_usage    = 0;  // block caches shared by column families and the ones of their own
+    uint64_t block_cache_capacity = 0;
+    uint64_t memtables            = 0;  // active and unflushed memtables of all column families
+    uint64_t table_readers        = 0;  // index and filter blocks held outside of block cache
+    uint64_t write_cache          = 0;  // reversible writes in write cache layers and previous values kept for rollback
+    uint32_t write_cache_entries  = 0;
+    uint64_t hash_tables          = 0;  // values and buckets of hash tables in hash profile
+    uint64_t savepoints           = 0;  // keys recorded in savepoints and previous values of the persist ones
+    uint32_t savepoints_snapshots = 0;  // runtime savepoints, each one holds a snapshot of rocksdb
+};
+
+using token_keys_t   = small_vector<name128, 4>;
+using token_db_key_t = std::array<char, sizeof(name128) * 2>;  // prefix and key of token
+using token_values_t = small_vector<std::string, 4>;
+using bulk_entries_t = std::vector<std::pair<std::string, std::string>>;  // keys without prefix and values
+
+// keys of the tokens and assets which are going to be read soon
+struct prefetch_keys_t {
+    small_vector<std::tuple<token_type, std::optional<name128>, name128>, 4> tokens;
+    small_vector<std::pair<address, symbol_id_type>, 2>                      assets;
+};
+
+// consistent view of token database at the moment it's created, including the reversible writes in savepoints.
+// it's created by the thread owning the database, usually at block boundaries, and then can be read from any thread.
+// it sees nothing written after that and should be released before the database is closed or restored
+class token_database_read_view : boost::noncopyable {
+private:
+    token_database_read_view(std::unique_ptr<class token_database_read_view_impl>&& my);
+
+public:
+    ~token_database_read_view();
+
+public:
+    int read_token(token_type type, const std::optional<name128>& domain, const name128& key, std::string& out, bool no_throw = false) const;
+    int read_asset(const address& addr, const symbol_id_type sym_id, std::string& out, bool no_throw = false) const;
+
+    int read_tokens_range(token_type type, const std::optional<name128>& domain, int skip, const read_value_func& func) const;
+    int read_tokens_range(token_type type, const std::optional<name128>& domain, const std::optional<name128>& start, const read_value_func& func) const;
+    int read_assets_range(const symbol_id_type sym_id, int skip, const read_value_func& func) const;
+    int read_assets_range(const symbol_id_type sym_id, const std::optional<address>& start, const read_value_func& func) const;
+
+    // latest savepoint seen by the view, zero if there's none
+    int64_t seq() const;
+
+private:
+    std::unique_ptr<class token_database_read_view_impl> my_;
+    friend class token_database;
+};
+
+using token_database_read_view_ptr = std::shared_ptr<const token_database_read_view>;
 
 class token_database : boost::noncopyable {
 public:
     struct config {
-        storage_profile profile           = storage_profile::disk;
-        uint32_t        block_cache_size  = 256 * 1024 * 1024; // 256M
-        uint32_t        object_cache_size = 256 * 1024 * 1024; // 256M
-        fc::path        db_path           = ::evt::chain::config::default_token_database_dir_name;
-        bool            enable_stats      = true;
+        storage_profile profile            = storage_profile::disk;
+        uint32_t        block_cache_size   = 256 * 1024 * 1024; // 256M
+        uint32_t        object_cache_size  = 256 * 1024 * 1024; // 256M
+        fc::path        db_path            = ::evt::chain::config::default_token_database_dir_name;
+        bool            enable_stats       = true;
+        bool            enable_batch       = true;  // owner index writes of latest savepoint are kept in one indexed batch seen by reads, written when savepoints change and dropped on rollback
+        bool            enable_owner_index = false; // maintain the index from owner address to the tokens and assets and expiry index of suspends and locks
+        bool            cache_write_back   = false; // objects put into cache are packed and written only when savepoints are changed
+        uint32_t        wal_ttl            = 0;     // seconds obsolete wal files are archived, delta snapshots read changes from them
+        fc::path        secondary_path;             // if set, `db_path` of another node is opened as read-only secondary instance keeping its own files here
+        uint32_t        max_runtime_savepoints = 0; // older savepoints beyond it are spilled into persist form releasing their snapshots, 0 for no limit
+
+        // tunings of rocksdb, options in `options_file` override the built-in ones of db and the column families with
+        // the same names, then the ones below override both if they're set
+        fc::path        options_file;
+        uint32_t        max_background_jobs = 0;      // flushes and compactions running at the same time
+        uint64_t        rate_limit          = 0;      // bytes per second written by flushes and compactions
+        bool            direct_io           = false;  // reads, flushes and compactions bypass page cache
+        bool            pipelined_write     = false;  // wal and memtables are written in pipeline
+
+        // tiers below the block cache in disk and hash profiles: compressed blocks in memory, then blocks on local fast disk
+        // like nvme, mostly for nodes whose db is on network-attached storage
+        uint64_t        compressed_cache_size = 0;
+        fc::path        persistent_cache_path;
+        uint64_t        persistent_cache_size = 0;
+
+        // tokens of the types listed here are stored in their own column families with tuned options
+        struct column_config {
+            token_type  type;
+            uint32_t    block_size    = 4 * 1024;
+            int32_t     bloom_bits    = 10;
+            std::string compression   = "lz4";  // none, snappy, lz4 or zstd
+            uint32_t    cache_size    = 0;      // dedicated block cache if not zero, otherwise shared
+            bool        high_priority = false;  // keep index and filter blocks in high priority pool of cache
+        };
+        std::vector<column_config> columns;
     };
 
     class session {
@@ -156,7 +370,7 @@ public:
         }
 
     public:
-        void accept() { _accept = 1; }
+        void accept() { _accept = 1; _token_db.flush_cache_values(); }
         void squash() { _accept = 1; _token_db.squash(); }
         void undo()   { _accept = 1; _token_db.rollback_to_latest_savepoint(); }
 
@@ -186,6 +400,11 @@ public:
     void open(int load_persistence = true);
     void close(int persist = true);
 
+    // secondary instance only sees the changes flushed or logged by primary when it's opened or caught up,
+    // savepoints of primary are not visible so reads are of the latest writes rather than irreversible state
+    bool is_secondary() const;
+    void catch_up_with_primary();
+
 public:
     void put_token(token_type type, action_op op, const std::optional<name128>& domain, const name128& key, const std::string_view& data);
     void put_tokens(token_type type, action_op op, const std::optional<name128>& domain, token_keys_t&& keys, const small_vector_base<std::string_view>& data);
@@ -195,11 +414,55 @@ public:
     int exists_asset(const address& addr, const symbol_id_type sym_id) const;
 
     int read_token(token_type type, const std::optional<name128>& domain, const name128& key, std::string& out, bool no_throw = false) const;
+    // zero-copy version of `read_token`, `func` is invoked with the view of value pinned in db
+    // the view is only valid inside `func`
+    int read_token(token_type type, const std::optional<name128>& domain, const name128& key, const read_view_func& func, bool no_throw = false) const;
     int read_asset(const address& addr, const symbol_id_type sym_id, std::string& out, bool no_throw = false) const;
 
+    // exception-free versions of `read_token` and `read_asset`, only errors of db are thrown
+    read_status try_read_token(token_type type, const std::optional<name128>& domain, const name128& key, const read_view_func& func) const;
+    read_status try_read_asset(const address& addr, const symbol_id_type sym_id, std::string& out) const;
+
+    // batch version of `read_token`, all the keys are fetched in one `MultiGet` call
+    // value of the key which is not found will be set to empty string when `no_throw` is set
+    // returns the number of keys found
+    int read_tokens(token_type type, const std::optional<name128>& domain, const small_vector_base<name128>& keys, small_vector_base<std::string>& outs, bool no_throw = false) const;
+
     int read_tokens_range(token_type type, const std::optional<name128>& domain, int skip, const read_value_func& func) const;
     int read_assets_range(const symbol_id_type sym_id, int skip, const read_value_func& func) const;
 
+    // resumable versions of range reading, iterator seeks to `start` directly and begins with the key right after it.
+    // keys passed into `func` can be used as the `start` of next page
+    int read_tokens_range(token_type type, const std::optional<name128>& domain, const std::optional<name128>& start, const read_value_func& func) const;
+    int read_assets_range(const symbol_id_type sym_id, const std::optional<address>& start, const read_value_func& func) const;
+    // same as above but `start` is the raw key passed into `func`, for callers which only keep the keys
+    int read_assets_range(const symbol_id_type sym_id, const std::string_view& start, const read_value_func& func) const;
+
+    // registers the aggregate of holders of `sym_id` with balance not less than `threshold`(and above zero).
+    // it's built by one scan here and then maintained in `put_asset` and restored with savepoints, registering
+    // it again does nothing. registrations are kept in memory only and dropped when db is closed
+    void add_asset_aggregate(const symbol_id_type sym_id, int64_t threshold = 0);
+    // the aggregate registered above, it's never built here
+    std::optional<asset_aggregate> read_asset_aggregate(const symbol_id_type sym_id, int64_t threshold = 0) const;
+
+    // order-independent digest of all the tokens and assets including reversible writes. it's built by one scan
+    // at the first query and then maintained incrementally in writes and restored with savepoints.
+    // values put into object cache are written back first, so it's not const
+    fc::sha256 state_digest();
+    // the same digest built by a full scan regardless of the maintained one, used to verify it
+    fc::sha256 build_state_digest();
+
+    // iterate the tokens owned by `addr` through owner index, only available when `enable_owner_index` is set
+    int read_tokens_by_owner(const address& addr, const std::optional<name128>& domain, const read_owner_func& func) const;
+
+    // iterate the symbol ids of all the fungibles which `addr` has balance of, in one prefix scan of asset index
+    // the index shares the column of owner index and is also only available when `enable_owner_index` is set
+    int read_assets_by_address(const address& addr, const read_asset_index_func& func) const;
+
+    // iterate the proposed suspends or locks in the order of their expiry(transaction expiration for suspends
+    // and unlock time for locks) up to `until`, also only available when `enable_owner_index` is set
+    int read_expiry_range(token_type type, const fc::time_point_sec& until, const read_expiry_func& func) const;
+
 public:
     void add_savepoint(int64_t seq);
     void rollback_to_latest_savepoint();
@@ -215,7 +478,61 @@ public:
     size_t savepoints_size() const;
 
 public:
-    std::string stats() const;
+    // values put into object cache are written back first, so it's not const
+    // only savepoints not newer than `until` are seen by the view
+    token_database_read_view_ptr create_read_view(int64_t until = std::numeric_limits<int64_t>::max());
+
+public:
+    std::string            stats() const;
+    token_database_metrics metrics() const;
+
+    token_database_memory_usage memory_usage() const;
+
+public:
+    // hard-linked copy of db files and savepoints journal, `dir` should not exist
+    void create_checkpoint(const fc::path& dir) const;
+    // replace current database with the checkpoint, all the savepoints in it become irreversible
+    void restore_checkpoint(const fc::path& dir);
+
+    // bulk load entries sorted by keys into db through external sst files, there should be no savepoints.
+    // they're thread-safe with each other and used to restore from snapshot
+    void ingest_tokens(token_type type, const std::optional<name128>& domain, const bulk_entries_t& entries);
+    void ingest_assets(const symbol_id_type sym_id, const bulk_entries_t& entries);
+
+    // raw entries of column families, used by delta snapshots
+    // keys of tokens are routed into the column families of their types
+    enum class raw_column : uint8_t { tokens = 0, assets, owners };
+    struct raw_entry {
+        raw_column                 column;
+        std::string                key;
+        std::optional<std::string> value;  // key is deleted if it's empty
+    };
+    using raw_entries_t = std::vector<raw_entry>;
+    using raw_key_func  = std::function<void(raw_column, const std::string_view&)>;
+
+    // sequence number of the latest write in db
+    uint64_t latest_sequence() const;
+    // keys written into db after sequence `seq`, they're read from wal, so it throws if any of the wal files
+    // is purged or the writes are made without wal
+    void read_changed_keys(uint64_t seq, const raw_key_func& func) const;
+    // keys of reversible writes which are not written into db yet
+    void read_volatile_keys(const raw_key_func& func) const;
+    // keys written in the savepoint of `seq`, each key is passed once. they're the delta of one block as
+    // savepoints are made per block, and current values are read by `read_raw`, the ones not found are removed.
+    // values put into object cache are written back first, so it's not const
+    void read_savepoint_keys(int64_t seq, const raw_key_func& func);
+    // returns false if key is not existed, reversible writes are included
+    bool read_raw(raw_column column, const std::string_view& key, std::string& out) const;
+    // there should be no savepoints, entries of owner index are skipped if it's not enabled
+    void write_raw(const raw_entries_t& entries);
+
+    // load the blocks of keys from disk into block cache, values in savepoints are not touched.
+    // it's thread-safe and intended to be invoked from background threads before transactions are applied
+    void prefetch(const prefetch_keys_t& keys) const;
+
+    // write without wal, used when irreversible blocks are replayed and nothing would be rolled back.
+    // memtables are flushed when it's disabled, so no data is lost unless it's crashed in between
+    void set_fast_writes(bool enable);
 
 private:
     void flush() const;
@@ -223,9 +540,13 @@ private:
     void load_savepoints(std::istream&);
 
 private:  // for cache usage
-    std::string get_db_key(token_type type, const std::optional<name128>& domain, const name128& key);
+    token_db_key_t get_db_key(token_type type, const std::optional<name128>& domain, const name128& key) const;
     boost::signals2::signal<void(const rocksdb::Slice&)> rollback_token_value;
     boost::signals2::signal<void(const rocksdb::Slice&)> remove_token_value;
+    boost::signals2::signal<void(const rocksdb::Slice&)> add_token_value;  // emitted for tokens may be newly added
+    boost::signals2::signal<void()>                      flush_cache_values;    // before savepoints are changed
+    boost::signals2::signal<void()>                      discard_cache_values;  // before latest savepoint is rolled back
+    boost::signals2::signal<void()>                      clear_cache_values;    // after secondary instance is caught up with primary
 
 private:
     std::unique_ptr<class token_database_impl> my_;
@@ -235,4 +556,14 @@ private:
 
 }}  // namespace evt::chain
 
-FC_REFLECT(evt::chain::token_database::config, (profile)(block_cache_size)(object_cache_size)(db_path));
+FC_REFLECT(evt::chain::asset_aggregate, (holders)(total));
+FC_REFLECT(evt::chain::token_database_metrics::type_metrics, (type)(reads)(writes)(exists)(read_bytes)(write_bytes)(read_latency)(write_latency));
+FC_REFLECT(evt::chain::token_database_metrics, (types)(savepoints_depth)(tokens_write_cache_size)(assets_write_cache_size)(block_cache_hit)(block_cache_miss)(block_cache_hit_ratio));
+FC_REFLECT(evt::chain::token_database_memory_usage, (block_cache_usage)(block_cache_capacity)(memtables)(table_readers)(write_cache)(write_cache_entries)(hash_tables)(savepoints)(savepoints_snapshots));
+FC_REFLECT_ENUM(evt::chain::storage_profile, (disk)(memory)(hash));
+FC_REFLECT_ENUM(evt::chain::token_type, (asset)(domain)(token)(group)(suspend)(lock)(fungible)(prodvote)(evtlink)(psvbonus)(psvbonus_dist)(meta));
+FC_REFLECT(evt::chain::token_database::config::column_config, (type)(block_size)(bloom_bits)(compression)(cache_size)(high_priority));
+FC_REFLECT(evt::chain::token_database::config, (profile)(block_cache_size)(object_cache_size)(db_path)(enable_stats)(enable_batch)(enable_owner_index)
+                                               (cache_write_back)(wal_ttl)(secondary_path)(max_runtime_savepoints)(options_file)(max_background_jobs)
+                                               (rate_limit)(direct_io)(pipelined_write)(compressed_cache_size)(persistent_cache_path)(persistent_cache_size)
+                                               (columns));
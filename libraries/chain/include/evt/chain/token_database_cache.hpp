@@ -3,7 +3,10 @@
  *  @copyright defined in evt/LICENSE.txt
 */
 #pragma once
+#include <algorithm>
+#include <map>
 #include <memory>
+#include <vector>
 #include <boost/type_index.hpp>
 #include <fc/io/datastream.hpp>
 #include <fc/io/raw.hpp>
@@ -14,26 +17,68 @@ namespace evt { namespace chain {
 
 class token_database_cache {
 public:
-    token_database_cache(token_database& db, size_t cache_size)
+    token_database_cache(token_database& db, size_t cache_size, bool write_back = false)
         : db_(db)
-        , cache_(rocksdb::NewLRUCache(cache_size)) {
+        , cache_(rocksdb::NewLRUCache(cache_size, kCacheShardBits))
+        , miss_cache_(rocksdb::NewLRUCache(cache_size / 16, kCacheShardBits))
+        , write_back_(write_back) {
         watch_db();
     }
 
+    ~token_database_cache() {
+        for(auto& c : connections_) {
+            c.disconnect();
+        }
+        discard();
+    }
+
 private:
+    // each shard of lru cache has its own mutex
+    static constexpr int kCacheShardBits = 6;
+
+    // one tag per type, types of entries are checked by the addresses of tags
+    // which is much cheaper than comparing `type_index`, the name is only used for errors
+    struct type_tag {
+        std::string (*name)();
+    };
+
     template<typename T>
-    struct cache_entry {
+    static constexpr type_tag type_tag_v = { [] { return boost::typeindex::type_id<T>().pretty_name(); } };
+
+    // common header of entries, entries of all types can be visited by it
+    struct entry_base {
+        const type_tag* tag;
+        token_type      type;
+        token_db_key_t  key;
+        uint32_t        hits;  // times looked up since inserted
+    };
+
+    template<typename T>
+    struct cache_entry : entry_base {
     public:
-        cache_entry() : ti(boost::typeindex::type_id<T>()) {}
+        cache_entry(token_type type, const token_db_key_t& key)
+            : entry_base { &type_tag_v<T>, type, key, 0 } {}
 
         template<typename U>
-        cache_entry(U&& d) : ti(boost::typeindex::type_id<T>()), data(std::forward<U>(d)) {}
+        cache_entry(token_type type, const token_db_key_t& key, U&& d)
+            : entry_base { &type_tag_v<T>, type, key, 0 }, data(std::forward<U>(d)) {}
 
     public:
-        boost::typeindex::type_index ti;
-        T                            data;
+        T data;
     };
 
+    template<typename T, typename E>
+    static void
+    check_entry_type(const E* entry) {
+        EVT_ASSERT2(entry->tag == &type_tag_v<T>, token_database_cache_exception,
+            "Types are not matched between cache({}) and query({})", entry->tag->name(), type_tag_v<T>.name());
+    }
+
+    static rocksdb::Slice
+    as_slice(const token_db_key_t& k) {
+        return rocksdb::Slice(k.data(), k.size());
+    }
+
 public:
     template<typename T>
     struct cache_deleter {
@@ -56,49 +101,181 @@ public:
 
 public:
     template<typename T>
-    std::unique_ptr<T, cache_deleter<T>>
+    using cache_ptr_t = std::unique_ptr<T, cache_deleter<T>>;
+
+    template<typename T>
+    struct read_result {
+    public:
+        bool found() const { return status == read_status::found; }
+
+    public:
+        read_status    status;
+        cache_ptr_t<T> value;
+    };
+
+    template<typename T>
+    cache_ptr_t<T>
     read_token(token_type type, const std::optional<name128>& domain, const name128& key, bool no_throw = false) {
         static_assert(std::is_class_v<T>, "T should be a class type");
 
         auto k = db_.get_db_key(type, domain, key);
-        auto h = cache_->Lookup(k);
-        if(h != nullptr) {
-            auto entry = (cache_entry<T>*)cache_->Value(h);
-            EVT_ASSERT2(entry->ti == boost::typeindex::type_id<T>(), token_database_cache_exception,
-                "Types are not matched between cache({}) and query({})", entry->ti.pretty_name(), boost::typeindex::type_id<T>().pretty_name());
-            return std::unique_ptr<T, cache_deleter<T>>(&entry->data, cache_deleter<T>(this, h));
+        if(auto ptr = lookup_entry<T>(k); ptr != nullptr) {
+            return ptr;
+        }
+        if(no_throw && lookup_miss(k)) {
+            return nullptr;
         }
 
-        auto str = std::string();
-        auto r   = db_.read_token(type, domain, key, str, no_throw);
+        // unpack directly from the value pinned in db
+        auto ptr = cache_ptr_t<T>();
+        auto r   = db_.read_token(type, domain, key, [&](auto& v) {
+            ptr = insert_entry<T>(type, k, v);
+        }, no_throw);
         if(no_throw && !r) {
+            insert_miss(k);
             return nullptr;
         }
 
-        auto entry = new cache_entry<T>();
-        extract_db_value(str, entry->data);
+        return ptr;
+    }
 
-        auto s = cache_->Insert(k, (void*)entry, str.size(),
-            [](auto& ck, auto cv) { delete (cache_entry<T>*)cv; }, &h);
-        FC_ASSERT(s == rocksdb::Status::OK());
+    // exception-free version of `read_token`, misses are returned as `not_found` and also cached
+    // so later lookups of the same key don't reach db
+    template<typename T>
+    read_result<T>
+    try_read_token(token_type type, const std::optional<name128>& domain, const name128& key) {
+        static_assert(std::is_class_v<T>, "T should be a class type");
+
+        auto k = db_.get_db_key(type, domain, key);
+        if(auto ptr = lookup_entry<T>(k); ptr != nullptr) {
+            return { read_status::found, std::move(ptr) };
+        }
+        if(lookup_miss(k)) {
+            return { read_status::not_found, nullptr };
+        }
+
+        auto ptr = cache_ptr_t<T>();
+        auto r   = db_.try_read_token(type, domain, key, [&](auto& v) {
+            ptr = insert_entry<T>(type, k, v);
+        });
+        if(r == read_status::not_found) {
+            insert_miss(k);
+        }
+        return { r, std::move(ptr) };
+    }
+
+    // same as `token_database::exists_token` but results are cached, including the ones not existed
+    bool
+    exists_token(token_type type, const std::optional<name128>& domain, const name128& key) {
+        auto k = db_.get_db_key(type, domain, key);
+        if(auto h = cache_->Lookup(as_slice(k)); h != nullptr) {
+            cache_->Release(h);
+            return true;
+        }
+        if(lookup_miss(k)) {
+            return false;
+        }
+
+        auto r = db_.exists_token(type, domain, key);
+        if(!r) {
+            insert_miss(k);
+        }
+        return r;
+    }
+
+    // batch version of `exists_token`, keys unknown to cache are looked up in db in one batch
+    small_vector<bool, 4>
+    exists_tokens(token_type type, const std::optional<name128>& domain, const small_vector_base<name128>& keys) {
+        auto rs     = small_vector<bool, 4>(keys.size(), false);
+        auto dbkeys = small_vector<token_db_key_t, 4>();
+        auto misses = small_vector<name128, 4>();
+        auto idxs   = small_vector<size_t, 4>();
+        dbkeys.reserve(keys.size());
+
+        for(auto i = 0u; i < keys.size(); i++) {
+            dbkeys.emplace_back(db_.get_db_key(type, domain, keys[i]));
+            if(auto h = cache_->Lookup(as_slice(dbkeys.back())); h != nullptr) {
+                cache_->Release(h);
+                rs[i] = true;
+                continue;
+            }
+            if(!lookup_miss(dbkeys.back())) {
+                misses.emplace_back(keys[i]);
+                idxs.emplace_back(i);
+            }
+        }
+        if(misses.empty()) {
+            return rs;
+        }
+
+        auto strs = token_values_t();
+        db_.read_tokens(type, domain, misses, strs, true /* no throw */);
 
-        return std::unique_ptr<T, cache_deleter<T>>(&entry->data, cache_deleter<T>(this, h));
+        for(auto i = 0u; i < idxs.size(); i++) {
+            if(strs[i].empty()) {
+                insert_miss(dbkeys[idxs[i]]);
+                continue;
+            }
+            rs[idxs[i]] = true;
+        }
+        return rs;
     }
 
+    // batch version of `read_token`, keys missed in cache are read from db in one batch
+    // result has the same order as `keys`, nullptr is filled for keys not found when `no_throw` is set
     template<typename T>
-    std::unique_ptr<T, cache_deleter<T>>
+    small_vector<cache_ptr_t<T>, 4>
+    read_tokens(token_type type, const std::optional<name128>& domain, const small_vector_base<name128>& keys, bool no_throw = false) {
+        static_assert(std::is_class_v<T>, "T should be a class type");
+
+        auto ptrs   = small_vector<cache_ptr_t<T>, 4>();
+        auto dbkeys = small_vector<token_db_key_t, 4>();
+        auto misses = small_vector<name128, 4>();
+        auto idxs   = small_vector<size_t, 4>();
+        ptrs.reserve(keys.size());
+        dbkeys.reserve(keys.size());
+
+        for(auto i = 0u; i < keys.size(); i++) {
+            dbkeys.emplace_back(db_.get_db_key(type, domain, keys[i]));
+            ptrs.emplace_back(lookup_entry<T>(dbkeys.back()));
+            if(ptrs.back() == nullptr) {
+                if(no_throw && lookup_miss(dbkeys.back())) {
+                    continue;
+                }
+                misses.emplace_back(keys[i]);
+                idxs.emplace_back(i);
+            }
+        }
+        if(misses.empty()) {
+            return ptrs;
+        }
+
+        auto strs = token_values_t();
+        db_.read_tokens(type, domain, misses, strs, no_throw);
+
+        for(auto i = 0u; i < idxs.size(); i++) {
+            if(strs[i].empty()) {
+                insert_miss(dbkeys[idxs[i]]);
+                continue;
+            }
+            auto& k = dbkeys[idxs[i]];
+            // the same key may show up more than once in `keys`, reuse the entry inserted before
+            if(auto ptr = lookup_entry<T>(k); ptr != nullptr) {
+                ptrs[idxs[i]] = std::move(ptr);
+                continue;
+            }
+            ptrs[idxs[i]] = insert_entry<T>(type, k, strs[i]);
+        }
+        return ptrs;
+    }
+
+    template<typename T>
+    cache_ptr_t<T>
     lookup_token(token_type type, const std::optional<name128>& domain, const name128& key, bool no_throw = false) {
         static_assert(std::is_class_v<T>, "T should be a class type");
 
         auto k = db_.get_db_key(type, domain, key);
-        auto h = cache_->Lookup(k);
-        if(h != nullptr) {
-            auto entry = (cache_entry<T>*)cache_->Value(h);
-            EVT_ASSERT2(entry->ti == boost::typeindex::type_id<T>(), token_database_cache_exception,
-                "Types are not matched between cache({}) and query({})", entry->ti.pretty_name(), boost::typeindex::type_id<T>().pretty_name());
-            return std::unique_ptr<T, cache_deleter<T>>(&entry->data, cache_deleter<T>(this, h));
-        }
-        return nullptr;
+        return lookup_entry<T>(k);
     }
 
     template<typename T, bool RtnPTR = false, typename U = std::decay_t<T>>
@@ -108,20 +285,40 @@ public:
         using entry_t = cache_entry<U>;
 
         auto k = db_.get_db_key(type, domain, key);
-        auto h = cache_->Lookup(k);
+        auto h = cache_->Lookup(as_slice(k));
         if(h != nullptr) {
             auto entry = (entry_t*)cache_->Value(h);
-            EVT_ASSERT2(entry->ti == boost::typeindex::type_id<T>(), token_database_cache_exception,
-                "Types are not matched between cache({}) and query({})", entry->ti.pretty_name(), boost::typeindex::type_id<T>().pretty_name());
+            check_entry_type<U>(entry);
             EVT_ASSERT2(&entry->data == &data, token_database_cache_exception,
                 "Provided updated data object should be the same as original one in cache");
         }
 
+        if(write_back_) {
+            // object is packed and written into db when savepoints are changed, entry is pinned in cache until then
+            if(h == nullptr) {
+                auto entry = new entry_t(type, k, std::forward<T>(data));
+                auto s     = cache_->Insert(as_slice(k), (void*)entry, sizeof(entry_t),
+                    [](auto& ck, auto cv) { delete (cache_entry<U>*)cv; }, &h);
+                FC_ASSERT(s == rocksdb::Status::OK());
+            }
+            mark_dirty<U>(type, op, domain, key, k, h);
+            miss_cache_->Erase(as_slice(k));
+
+            if constexpr(RtnPTR) {
+                auto ph = cache_->Lookup(as_slice(k));
+                return std::unique_ptr<U, cache_deleter<U>>(&((entry_t*)cache_->Value(ph))->data, cache_deleter<U>(this, ph));
+            }
+            else {
+                return;
+            }
+        }
+
         auto v = make_db_value(data);
-        db_.put_token(type, op, domain, key, v.as_string_view());
+        db_.put_token(type, op, domain, key, v.as_string_view());  // miss entry is erased by `add_token_value`
         
         if(h != nullptr) {
             // if there's already cache item, no need to insert new one
+            cache_->Release(h);
             if constexpr(!RtnPTR) {
                 return;
             }
@@ -130,34 +327,202 @@ public:
             }
         }
 
-        auto entry = new entry_t(std::forward<T>(data));
+        auto entry = new entry_t(type, k, std::forward<T>(data));
         if constexpr(!RtnPTR) {
-            auto s = cache_->Insert(k, (void*)entry, v.size(),
+            auto s = cache_->Insert(as_slice(k), (void*)entry, v.size(),
                 [](auto& ck, auto cv) { delete (cache_entry<U>*)cv; }, nullptr /* handle */);
             FC_ASSERT(s == rocksdb::Status::OK());
         }
         else {
-            auto s = cache_->Insert(k, (void*)entry, v.size(),
+            auto s = cache_->Insert(as_slice(k), (void*)entry, v.size(),
                 [](auto& ck, auto cv) { delete (cache_entry<U>*)cv; }, &h);
             FC_ASSERT(s == rocksdb::Status::OK());
             return std::unique_ptr<U, cache_deleter<U>>(&entry->data, cache_deleter<U>(this, h));
         }
     }
 
+    // pack the dirty objects and write them into db in the order they're put first
+    void
+    flush() {
+        if(dirty_.empty()) {
+            return;
+        }
+
+        auto dirty = std::move(dirty_);
+        dirty_.clear();
+        dirty_idxs_.clear();
+        for(auto& d : dirty) {
+            auto v = d.pack(cache_->Value(d.handle));
+            db_.put_token(d.type, d.op, d.domain, d.key, v.as_string_view());
+            cache_->Release(d.handle);
+        }
+    }
+
+    // objects are modified in place, drop them from cache as well
+    void
+    discard() {
+        for(auto& d : dirty_) {
+            cache_->Release(d.handle);
+            cache_->Erase(as_slice(d.dbkey));
+        }
+        dirty_.clear();
+        dirty_idxs_.clear();
+    }
+
+    size_t dirty_size() const { return dirty_.size(); }
+
+    // charges of cached objects and keys known to be missing
+    size_t usage() const { return cache_->GetUsage() + miss_cache_->GetUsage(); }
+    size_t capacity() const { return cache_->GetCapacity() + miss_cache_->GetCapacity(); }
+
+public:
+    struct hot_key {
+        token_type     type;
+        token_db_key_t key;   // prefix and key in db
+        uint32_t       hits;
+    };
+
+    // at most `n` keys of entries in cache, most looked up ones first
+    std::vector<hot_key>
+    hot_keys(size_t n) const {
+        // callback of rocksdb cache cannot capture, results are passed by thread local pointer
+        static thread_local std::vector<hot_key>* visiting = nullptr;
+
+        auto keys = std::vector<hot_key>();
+        visiting  = &keys;
+        cache_->ApplyToAllCacheEntries([](void* v, size_t) {
+            auto entry = (const entry_base*)v;
+            visiting->emplace_back(hot_key { entry->type, entry->key, entry->hits });
+        }, true /* thread safe */);
+        visiting = nullptr;
+
+        auto cmp = [](auto& l, auto& r) { return l.hits > r.hits; };
+        if(keys.size() > n) {
+            std::partial_sort(keys.begin(), keys.begin() + n, keys.end(), cmp);
+            keys.resize(n);
+        }
+        else {
+            std::sort(keys.begin(), keys.end(), cmp);
+        }
+        return keys;
+    }
+
+private:
+    template<typename T>
+    cache_ptr_t<T>
+    lookup_entry(const token_db_key_t& k) {
+        auto h = cache_->Lookup(as_slice(k));
+        if(auto c = db_op_counters::current(); c != nullptr) {
+            (h != nullptr) ? c->cache_hits++ : c->cache_misses++;
+        }
+        if(h == nullptr) {
+            return nullptr;
+        }
+
+        auto entry = (cache_entry<T>*)cache_->Value(h);
+        check_entry_type<T>(entry);
+        entry->hits++;
+        return cache_ptr_t<T>(&entry->data, cache_deleter<T>(this, h));
+    }
+
+    template<typename T>
+    cache_ptr_t<T>
+    insert_entry(token_type type, const token_db_key_t& k, const std::string_view& str) {
+        auto entry = new cache_entry<T>(type, k);
+        extract_db_value(str, entry->data);
+
+        auto h = (rocksdb::Cache::Handle*)nullptr;
+        auto s = cache_->Insert(as_slice(k), (void*)entry, str.size(),
+            [](auto& ck, auto cv) { delete (cache_entry<T>*)cv; }, &h);
+        FC_ASSERT(s == rocksdb::Status::OK());
+
+        return cache_ptr_t<T>(&entry->data, cache_deleter<T>(this, h));
+    }
+
+    template<typename U>
+    void
+    mark_dirty(token_type type, action_op op, const std::optional<name128>& domain, const name128& key, const token_db_key_t& k, rocksdb::Cache::Handle* h) {
+        if(auto it = dirty_idxs_.find(k); it != dirty_idxs_.end()) {
+            // first op is kept, `add` followed by `update` is still an `add` in savepoint
+            cache_->Release(h);
+            return;
+        }
+        dirty_idxs_.emplace(k, dirty_.size());
+        dirty_.emplace_back(dirty_entry {
+            .type   = type,
+            .op     = op,
+            .domain = domain,
+            .key    = key,
+            .dbkey  = k,
+            .handle = h,
+            .pack   = [](void* v) { return make_db_value(((cache_entry<U>*)v)->data); }
+        });
+    }
+
+    bool
+    lookup_miss(const token_db_key_t& k) {
+        auto h = miss_cache_->Lookup(as_slice(k));
+        if(h == nullptr) {
+            return false;
+        }
+        miss_cache_->Release(h);
+        return true;
+    }
+
+    void
+    insert_miss(const token_db_key_t& k) {
+        // only key is stored, value is not used
+        auto s = miss_cache_->Insert(as_slice(k), nullptr, k.size(), [](auto& ck, auto cv) {}, nullptr /* handle */);
+        FC_ASSERT(s == rocksdb::Status::OK());
+    }
+
 private:
     void
     watch_db() {
-        db_.rollback_token_value.connect([this](auto& key) {
+        connections_.emplace_back(db_.flush_cache_values.connect([this] {
+            flush();
+        }));
+        connections_.emplace_back(db_.discard_cache_values.connect([this] {
+            discard();
+        }));
+        connections_.emplace_back(db_.clear_cache_values.connect([this] {
+            // objects still referenced are kept, there should be none as reads and catching up are in the same thread
+            cache_->EraseUnRefEntries();
+            miss_cache_->EraseUnRefEntries();
+        }));
+        connections_.emplace_back(db_.rollback_token_value.connect([this](auto& key) {
             cache_->Erase(key);
-        });
-        db_.remove_token_value.connect([this](auto& key) {
+            miss_cache_->Erase(key);
+        }));
+        connections_.emplace_back(db_.remove_token_value.connect([this](auto& key) {
             cache_->Erase(key);
-        });
+            miss_cache_->Erase(key);
+        }));
+        connections_.emplace_back(db_.add_token_value.connect([this](auto& key) {
+            miss_cache_->Erase(key);
+        }));
     }
 
 private:
     token_database&                 db_;
     std::shared_ptr<rocksdb::Cache> cache_;
+    std::shared_ptr<rocksdb::Cache> miss_cache_;  // keys known not existed in db
+
+    struct dirty_entry {
+        token_type               type;
+        action_op                op;
+        std::optional<name128>   domain;
+        name128                  key;
+        token_db_key_t           dbkey;
+        rocksdb::Cache::Handle*  handle;
+        db_value                 (*pack)(void*);
+    };
+
+    bool                                write_back_;
+    std::vector<dirty_entry>            dirty_;
+    std::map<token_db_key_t, size_t>    dirty_idxs_;
+
+    std::vector<boost::signals2::connection> connections_;
 };
 
 template<typename T>
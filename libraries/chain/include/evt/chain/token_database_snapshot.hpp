@@ -3,6 +3,9 @@
  *  @copyright defined in evt/LICENSE.txt
 */
 #pragma once
+#include <optional>
+#include <string>
+#include <fc/filesystem.hpp>
 #include <evt/chain/snapshot.hpp>
 
 namespace evt { namespace chain {
@@ -11,8 +14,15 @@ class token_database;
 
 namespace token_database_snapshot {
 
-void add_to_snapshot(snapshot_writer_ptr snapshot, const token_database& db);
-void read_from_snapshot(snapshot_reader_ptr snapshot, token_database& db);
+// when `checkpoint` is provided, a native checkpoint of token database is created there
+// and only its directory name is written into snapshot
+void add_to_snapshot(snapshot_writer_ptr snapshot, const token_database& db, const std::optional<fc::path>& checkpoint = std::nullopt);
+// only the entries changed since `base` snapshot are written, `base_name` is the file name of base which is
+// resolved under the same directory when reading, and base is restored first before the changes are applied.
+// it throws if the changes are not in wal of token database anymore, full snapshot should be written then
+void add_delta_to_snapshot(snapshot_writer_ptr snapshot, const token_database& db, snapshot_reader_ptr base, const std::string& base_name);
+// native checkpoint is restored from the directory with the same name under `snapshot_dir`
+void read_from_snapshot(snapshot_reader_ptr snapshot, token_database& db, const fc::path& snapshot_dir = fc::path());
 
 }  // namespace token_database_snapshot
 
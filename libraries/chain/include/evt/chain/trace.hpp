@@ -4,6 +4,7 @@
  */
 #pragma once
 
+#include <boost/pool/pool_alloc.hpp>
 #include <evt/chain/action.hpp>
 #include <evt/chain/action_receipt.hpp>
 #include <evt/chain/block.hpp>
@@ -22,6 +23,13 @@ public:
     }
 };
 
+// balance of one address after it's changed by action
+struct ft_balance {
+    address        addr;
+    symbol_id_type sym_id;
+    int64_t        amount;
+};
+
 struct action_trace {
     action_trace(const action_receipt& r)
         : receipt(r) {}
@@ -40,7 +48,8 @@ struct action_trace {
     std::optional<fc::exception> except;
 
     small_vector<action, 2>    generated_actions;
-    small_vector<ft_holder, 2> new_ft_holders;
+    small_vector<ft_holder, 2>  new_ft_holders;
+    small_vector<ft_balance, 2> ft_balances;
 };
 
 struct transaction_trace;
@@ -60,8 +69,16 @@ struct transaction_trace {
     std::exception_ptr           except_ptr;
 };
 
+// traces are shared with plugins and api threads and released there, so they're allocated from
+// a thread-safe pool of fixed size chunks instead of being owned by any per-transaction arena
+inline transaction_trace_ptr
+make_transaction_trace() {
+    return std::allocate_shared<transaction_trace>(boost::fast_pool_allocator<transaction_trace>());
+}
+
 }}  // namespace evt::chain
 
 FC_REFLECT(evt::chain::ft_holder, (addr)(sym_id));
-FC_REFLECT(evt::chain::action_trace, (receipt)(act)(elapsed)(console)(trx_id)(block_num)(block_time)(producer_block_id)(except)(generated_actions)(new_ft_holders));
+FC_REFLECT(evt::chain::ft_balance, (addr)(sym_id)(amount));
+FC_REFLECT(evt::chain::action_trace, (receipt)(act)(elapsed)(console)(trx_id)(block_num)(block_time)(producer_block_id)(except)(generated_actions)(new_ft_holders)(ft_balances));
 FC_REFLECT(evt::chain::transaction_trace, (id)(receipt)(elapsed)(is_suspend)(action_traces)(charge)(net_usage)(except));
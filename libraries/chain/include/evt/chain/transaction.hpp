@@ -96,6 +96,7 @@ public:
     enum compression_type {
         none = 0,
         zlib = 1,
+        zstd = 2,
     };
 
 public:
@@ -169,6 +170,6 @@ FC_REFLECT(evt::chain::transaction_header, (expiration)(ref_block_num)(ref_block
 FC_REFLECT_ENUM(evt::chain::transaction_ext, (suspend_name));
 FC_REFLECT_DERIVED(evt::chain::transaction, (evt::chain::transaction_header), (actions)(payer)(transaction_extensions));
 FC_REFLECT_DERIVED(evt::chain::signed_transaction, (evt::chain::transaction), (signatures));
-FC_REFLECT_ENUM(evt::chain::packed_transaction::compression_type, (none)(zlib));
+FC_REFLECT_ENUM(evt::chain::packed_transaction::compression_type, (none)(zlib)(zstd));
 // @ignore unpacked_trx
 FC_REFLECT(evt::chain::packed_transaction, (signatures)(compression)(packed_trx));
@@ -63,8 +63,9 @@ public:
 
     small_vector<action_receipt, 4> executed;
 
-    bool      is_input  = false;
-    uint32_t  charge    = 0;
+    bool      is_input   = false;
+    bool      lite_trace = false;  // only fill the parts of trace required by consensus
+    uint32_t  charge     = 0;
     uint64_t  net_limit = 0;
     uint64_t& net_usage;  // reference to trace->net_usage
 
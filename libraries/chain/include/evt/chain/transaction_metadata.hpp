@@ -3,6 +3,9 @@
  *  @copyright defined in evt/LICENSE.txt
  */
 #pragma once
+#include <deque>
+#include <mutex>
+#include <vector>
 #include <boost/noncopyable.hpp>
 #include <evt/chain/block.hpp>
 #include <evt/chain/trace.hpp>
@@ -17,24 +20,37 @@ namespace evt { namespace chain {
 class transaction_metadata : boost::noncopyable {
 public:
     transaction_id_type                             id;
-    transaction_id_type                             signed_id;
     packed_transaction_ptr                          packed_trx;
     optional<pair<chain_id_type, public_keys_set>>  signing_keys;
     bool                                            accepted = false;
     bool                                            implicit = false;
+    fc::microseconds                                elapsed;  // time used when it was applied last time
 
 public:
     explicit transaction_metadata(const signed_transaction& t, packed_transaction::compression_type c = packed_transaction::none)
-        : id(t.id()), packed_trx(std::make_shared<packed_transaction>(t, c)) {
-        signed_id = digest_type::hash(*packed_trx);
+        : packed_trx(std::make_shared<packed_transaction>(t, c)) {
+        // uncompressed bytes are just packed from `t`, hash them rather than packing it again.
+        // it's not applicable to the received ones whose bytes may be not canonical
+        if(c == packed_transaction::none) {
+            auto& raw = packed_trx->get_packed_transaction();
+            id = transaction_id_type::hash(raw.data(), raw.size());
+        }
+        else {
+            id = t.id();
+        }
     }
 
     explicit transaction_metadata(const packed_transaction_ptr& ptrx)
-        : id(ptrx->id()), packed_trx(ptrx) {
-        signed_id = digest_type::hash(*packed_trx);
-    }
+        : id(ptrx->id()), packed_trx(ptrx) {}
 
 public:
+    // digest of the whole packed transaction including signatures, only computed once when it's first used
+    const transaction_id_type&
+    signed_id() const {
+        std::call_once(signed_id_flag_, [this] { signed_id_ = digest_type::hash(*packed_trx); });
+        return signed_id_;
+    }
+
     const public_keys_set&
     recover_keys(const chain_id_type& chain_id) {
         if(!signing_keys.has_value() || signing_keys->first != chain_id) {  // Unlikely for more than one chain_id to be used in one nodeos instance
@@ -42,8 +58,42 @@ public:
         }
         return signing_keys->second;
     }
+
+private:
+    mutable std::once_flag      signed_id_flag_;
+    mutable transaction_id_type signed_id_;
 };
 
 using transaction_metadata_ptr = std::shared_ptr<transaction_metadata>;
 
+/**
+ *  Makes the metadata of the input transactions in a decoded block, nullptr for the others.
+ *
+ *  Transactions are not copied out of the block, and the metadata of all of them are allocated in one arena
+ *  sharing the refcount of the block instead of one by one. So the block, its transactions and their metadata
+ *  are freed together once the last of them is released, which keeps the whole block alive meanwhile.
+ */
+inline std::vector<transaction_metadata_ptr>
+make_block_transaction_metadatas(const signed_block_ptr& b) {
+    struct arena {
+        signed_block_ptr                 block;
+        std::deque<transaction_metadata> mtrxs;
+    };
+
+    auto a   = std::make_shared<arena>();
+    a->block = b;
+
+    auto mtrxs = std::vector<transaction_metadata_ptr>();
+    mtrxs.reserve(b->transactions.size());
+    for(auto& receipt : b->transactions) {
+        if(receipt.type != transaction_receipt::input) {
+            mtrxs.emplace_back(nullptr);
+            continue;
+        }
+        auto& m = a->mtrxs.emplace_back(packed_transaction_ptr(b, &receipt.trx));
+        mtrxs.emplace_back(a, &m);
+    }
+    return mtrxs;
+}
+
 }}  // namespace evt::chain
@@ -3,6 +3,7 @@
  *  @copyright defined in evt/LICENSE.txt
  */
 #pragma once
+#include <limits>
 #include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/mem_fun.hpp>
 
@@ -24,19 +25,23 @@ class transaction_object : public chainbase::object<transaction_object_type, tra
     time_point_sec      expiration;
     transaction_id_type trx_id;
     uint32_t            block_num;
+    // position of receipt in the block, it's not in snapshots and unknown for the ones restored from them
+    uint32_t            trx_index = kUnknownIndex;
+
+    static constexpr uint32_t kUnknownIndex = std::numeric_limits<uint32_t>::max();
 };
 
 struct by_expiration;
 struct by_trx_id;
+
+// ids are looked up for every incoming transaction, hashed index keeps it from going through a deep tree.
+// expired ones are removed in the groups of same expiration, order inside a group doesn't matter
 using transaction_multi_index = chainbase::shared_multi_index_container<
     transaction_object,
     indexed_by<
         ordered_unique<tag<by_id>, BOOST_MULTI_INDEX_MEMBER(transaction_object, transaction_object::id_type, id)>,
-        ordered_unique<tag<by_trx_id>, BOOST_MULTI_INDEX_MEMBER(transaction_object, transaction_id_type, trx_id)>,
-        ordered_unique<
-            tag<by_expiration>,
-            composite_key<transaction_object, BOOST_MULTI_INDEX_MEMBER(transaction_object, time_point_sec, expiration),
-                          BOOST_MULTI_INDEX_MEMBER(transaction_object, transaction_object::id_type, id)>>>>;
+        hashed_unique<tag<by_trx_id>, BOOST_MULTI_INDEX_MEMBER(transaction_object, transaction_id_type, trx_id), std::hash<transaction_id_type>>,
+        ordered_non_unique<tag<by_expiration>, BOOST_MULTI_INDEX_MEMBER(transaction_object, time_point_sec, expiration)>>>;
 
 typedef chainbase::generic_index<transaction_multi_index> transaction_index;
 
@@ -49,11 +49,15 @@ merkle(vector<digest_type> ids) {
         if(ids.size() % 2)
             ids.push_back(ids.back());
 
-        for(auto i = 0u; i < ids.size() / 2; i++) {
-            ids[i] = digest_type::hash(make_canonical_pair(ids[2 * i], ids[(2 * i) + 1]));
+        // the whole level is hashed at once, same as hashing each canonical pair
+        auto n = ids.size() / 2;
+        for(auto i = 0u; i < n; i++) {
+            ids[2 * i]     = make_canonical_left(ids[2 * i]);
+            ids[2 * i + 1] = make_canonical_right(ids[2 * i + 1]);
         }
+        digest_type::hash_pairs(ids.data(), n, ids.data());
 
-        ids.resize(ids.size() / 2);
+        ids.resize(n);
     }
 
     return ids.front();
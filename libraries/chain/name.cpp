@@ -2,6 +2,8 @@
  *  @file
  *  @copyright defined in evt/LICENSE.txt
  */
+#include <algorithm>
+#include <array>
 #include <boost/algorithm/string.hpp>
 #include <evt/chain/exceptions.hpp>
 #include <evt/chain/name.hpp>
@@ -10,9 +12,63 @@
 
 namespace evt { namespace chain {
 
+namespace internal {
+
+const char* kNameCharmap = ".abcdefghijklmnopqrstuvwxyz12345";
+
+// symbol of each char, -1 for the chars not in charmap
+constexpr auto kNameSymbols = [] {
+    auto symbols = std::array<int8_t, 256>();
+    for(auto c = 0; c < 256; c++) {
+        symbols[c] = -1;
+    }
+    symbols['.'] = 0;
+    for(auto c = 'a'; c <= 'z'; c++) {
+        symbols[c] = c - 'a' + 1;
+    }
+    for(auto c = '1'; c <= '5'; c++) {
+        symbols[c] = c - '1' + 27;
+    }
+    return symbols;
+}();
+
+// returns false if `str` is not normalized, then the slow path is taken to produce the same error
+bool
+fast_string_to_name(const char* str, size_t len, uint64_t& value) {
+    if(len == 0 || len > 13 || str[len - 1] == '.') {
+        return false;
+    }
+
+    auto v       = uint64_t(0);
+    auto invalid = 0;
+    for(auto i = 0u; i < std::min(len, (size_t)12); i++) {
+        auto s = kNameSymbols[(uint8_t)str[i]];
+        invalid |= s;
+        v |= (uint64_t)(uint8_t)s << (64 - 5 * (i + 1));
+    }
+    if(len == 13) {
+        // the last char only has 4 bits
+        auto s = kNameSymbols[(uint8_t)str[12]];
+        invalid |= s | (s > 0x0f ? -1 : 0);
+        v |= (uint64_t)(uint8_t)s & 0x0f;
+    }
+    if(invalid < 0) {
+        return false;
+    }
+
+    value = v;
+    return true;
+}
+
+}  // namespace internal
+
 void
 name::set(const char* str) {
     const auto len = strnlen(str, 14);
+    if(internal::fast_string_to_name(str, len, value)) {
+        return;
+    }
+
     EVT_ASSERT(len <= 13, name_type_exception, "Name is longer than 13 characters (${name}) ", ("name", string(str)));
     EVT_ASSERT(len > 0, name_type_exception, "Name cannot be empty");
     value = string_to_name(str);
@@ -22,21 +78,20 @@ name::set(const char* str) {
 }
 
 name::operator string() const {
-    static const char* charmap = ".abcdefghijklmnopqrstuvwxyz12345";
-
-    string str(13, '.');
-
-    auto tmp = value;
-    str[12] = charmap[tmp & 0x0f];
-    tmp >>= 4;
+    if(value == 0) {
+        return string();
+    }
 
-    for(auto i = 1u; i <= 12; ++i, tmp >>= 5) {
-        char c    = charmap[tmp & 0x1f];
-        str[12-i] = c;
+    char buf[13];
+    for(auto i = 0u; i < 12; i++) {
+        buf[i] = internal::kNameCharmap[(value >> (64 - 5 * (i + 1))) & 0x1f];
     }
+    buf[12] = internal::kNameCharmap[value & 0x0f];
 
-    str.erase(str.find_last_not_of('.') + 1);
-    return str;
+    // trailing '.'(zero symbols) are trimmed, the lowest set bit tells the last char
+    auto low = (uint32_t)__builtin_ctzll(value);
+    auto len = (low < 4) ? 13u : (63 - low) / 5 + 1;
+    return string(buf, len);
 }
 
 }}  // namespace evt::chain
@@ -3,15 +3,81 @@
  *  @copyright defined in evt/LICENSE.txt
  */
 #include <evt/chain/name128.hpp>
+#include <array>
 #include <boost/algorithm/string.hpp>
 #include <evt/chain/exceptions.hpp>
 #include <fc/variant.hpp>
 
 namespace evt { namespace chain {
 
+namespace internal {
+
+const char* kName128Charmap = ".-0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+// symbol of each char, -1 for the chars not in charmap
+constexpr auto kName128Symbols = [] {
+    auto symbols = std::array<int8_t, 256>();
+    for(auto c = 0; c < 256; c++) {
+        symbols[c] = -1;
+    }
+    symbols['.'] = 0;
+    symbols['-'] = 1;
+    for(auto c = '0'; c <= '9'; c++) {
+        symbols[c] = c - '0' + 2;
+    }
+    for(auto c = 'a'; c <= 'z'; c++) {
+        symbols[c] = c - 'a' + 12;
+    }
+    for(auto c = 'A'; c <= 'Z'; c++) {
+        symbols[c] = c - 'A' + 38;
+    }
+    return symbols;
+}();
+
+// encodes a normalized name in three 64-bit words of 7 symbols instead of shifting 128-bit value per char
+// returns false if `str` is not normalized, then the slow path is taken to produce the same error
+bool
+fast_string_to_name128(const char* str, size_t len, uint128_t& value) {
+    if(len == 0 || len > 21 || str[len - 1] == '.') {
+        return false;
+    }
+
+    uint64_t words[3] = { 0, 0, 0 };
+    auto     invalid  = 0;
+    for(auto i = 0u; i < len; i++) {
+        auto s = kName128Symbols[(uint8_t)str[i]];
+        invalid |= s;
+        words[i / 7] |= (uint64_t)(uint8_t)s << (6 * (i % 7));
+    }
+    if(invalid < 0) {
+        return false;
+    }
+
+    value = ((uint128_t)words[0] | ((uint128_t)words[1] << 42) | ((uint128_t)words[2] << 84)) << 2;
+    if(len <= 5) {
+        value |= name128::i32;
+    }
+    else if(len <= 10) {
+        value |= name128::i64;
+    }
+    else if(len <= 15) {
+        value |= name128::i96;
+    }
+    else {
+        value |= name128::i128;
+    }
+    return true;
+}
+
+}  // namespace internal
+
 void
 name128::set(const char* str) {
     const auto len = strnlen(str, 22);
+    if(internal::fast_string_to_name128(str, len, value)) {
+        return;
+    }
+
     EVT_ASSERT(len <= 21, name128_type_exception, "Name128 is longer than 21 characters (${name}) ",
                ("name", std::string(str)));
     EVT_ASSERT(len > 0, name128_type_exception, "Name128 cannot be empty");
@@ -24,6 +90,10 @@ name128::set(const char* str) {
 void
 name128::set(const std::string& str) {
     const auto len = str.size();
+    if(internal::fast_string_to_name128(str.data(), len, value)) {
+        return;
+    }
+
     EVT_ASSERT(len <= 21, name128_type_exception, "Name128 is longer than 21 characters (${name}) ",
                ("name", str));
     value = string_to_name128(str.c_str());
@@ -33,12 +103,7 @@ name128::set(const std::string& str) {
 }
 
 name128::operator std::string() const {
-    static const char* charmap = ".-0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
-
-    auto str = std::string(21, '.');
-    
     auto stop = 0u;
-    auto tmp  = value >> 2;
     auto tag  = (int)value & 0x03;
 
     switch(tag) {
@@ -60,12 +125,23 @@ name128::operator std::string() const {
     }
     }  // switch
 
-    for(auto i = 0u; i < stop; ++i, tmp >>= 6) {
-        auto c = charmap[tmp & 0x3f];
-        str[i] = c;
+    // symbols after `stop` are ignored and trailing '.'(zero symbols) are trimmed
+    auto tmp = (value >> 2) & (((uint128_t)1 << (6 * stop)) - 1);
+    if(tmp == 0) {
+        return std::string();
     }
 
-    str.erase(str.find_last_not_of('.', stop) + 1);
+    auto hi   = (uint64_t)(tmp >> 64);
+    auto bits = hi ? (128 - __builtin_clzll(hi)) : (64 - __builtin_clzll((uint64_t)tmp));
+    auto len  = (bits + 5) / 6;
+
+    // decodes 7 symbols from each 64-bit word
+    uint64_t words[3] = { (uint64_t)tmp & 0x3ffffffffff, (uint64_t)(tmp >> 42) & 0x3ffffffffff, (uint64_t)(tmp >> 84) };
+
+    auto str = std::string(len, '.');
+    for(auto i = 0u; i < len; i++) {
+        str[i] = internal::kName128Charmap[(words[i / 7] >> (6 * (i % 7))) & 0x3f];
+    }
     return str;
 }
 
@@ -0,0 +1,345 @@
+/**
+ *  @file
+ *  @copyright defined in evt/LICENSE.txt
+ */
+#include <evt/chain/reversible_block_log.hpp>
+#include <evt/chain/exceptions.hpp>
+#include <cstring>
+#include <future>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <boost/asio/post.hpp>
+#include <fc/io/raw.hpp>
+#include <evt/utilities/thread_affinity.hpp>
+
+namespace evt { namespace chain {
+
+namespace {
+
+const uint32_t kMagic   = 0x52564c47;  // "RVLG"
+const uint32_t kVersion = 1;
+
+struct log_header {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t start;  // position of first live entry
+};
+
+struct entry_header {
+    uint32_t block_num;
+    uint32_t size;
+};
+
+const uint64_t kHeaderSize = sizeof(log_header);
+
+// dead front smaller than this is never compacted, moving a few blocks each time is not worth it
+const uint64_t kMinCompactSize = 16 * 1024 * 1024;
+
+void
+read_exact(int fd, uint64_t pos, void* buf, size_t size) {
+    auto r = ::pread(fd, buf, size, pos);
+    EVT_ASSERT(r == (ssize_t)size, reversible_blocks_exception, "Cannot read reversible blocks log at ${p}", ("p",pos));
+}
+
+void
+write_exact(int fd, uint64_t pos, const void* buf, size_t size) {
+    auto r = ::pwrite(fd, buf, size, pos);
+    EVT_ASSERT(r == (ssize_t)size, reversible_blocks_exception, "Cannot write reversible blocks log at ${p}", ("p",pos));
+}
+
+}  // namespace
+
+const char* reversible_block_log::file_name = "reversible.log";
+
+reversible_block_log::reversible_block_log(const fc::path& dir, bool async, bool read_only)
+    : path_(dir / file_name)
+    , fd_(-1)
+    , read_only_(read_only) {
+    if(!read_only_) {
+        fc::create_directories(dir);
+    }
+    fd_ = ::open(path_.generic_string().c_str(), read_only_ ? O_RDONLY : (O_RDWR | O_CREAT), 0644);
+    EVT_ASSERT(fd_ >= 0, reversible_blocks_exception, "Cannot open reversible blocks log: ${f}", ("f",path_));
+
+    open();
+    if(async && !read_only_) {
+        auto scope = utilities::affinity::pool_scope("reversible");
+        writer_.emplace(1);
+    }
+}
+
+reversible_block_log::~reversible_block_log() {
+    try {
+        flush();
+    }
+    FC_LOG_AND_DROP();
+    if(writer_.has_value()) {
+        writer_->join();
+    }
+    if(fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+template<typename Func>
+void
+reversible_block_log::run(Func&& func) {
+    EVT_ASSERT(!read_only_, reversible_blocks_exception, "Reversible blocks log is opened as read-only");
+    if(!writer_.has_value()) {
+        func();
+        return;
+    }
+    boost::asio::post(*writer_, [this, func = std::forward<Func>(func)] {
+        if(error_) {
+            // log is stale after a failed write, later ones are skipped
+            return;
+        }
+        try {
+            func();
+        }
+        catch(...) {
+            error_ = std::current_exception();
+        }
+    });
+}
+
+void
+reversible_block_log::flush() {
+    if(writer_.has_value()) {
+        auto done = std::promise<void>();
+        boost::asio::post(*writer_, [&] { done.set_value(); });
+        done.get_future().wait();
+    }
+    if(error_) {
+        std::rethrow_exception(error_);
+    }
+}
+
+void
+reversible_block_log::open() {
+    auto size = (uint64_t)::lseek(fd_, 0, SEEK_END);
+    if(size < kHeaderSize) {
+        EVT_ASSERT(!read_only_, reversible_blocks_exception, "Reversible blocks log is empty: ${f}", ("f",path_));
+        start_pos_ = end_pos_ = kHeaderSize;
+        write_start();
+        EVT_ASSERT(::ftruncate(fd_, kHeaderSize) == 0, reversible_blocks_exception, "Cannot truncate reversible blocks log");
+        return;
+    }
+
+    auto header = log_header();
+    read_exact(fd_, 0, &header, sizeof(header));
+    EVT_ASSERT(header.magic == kMagic && header.version == kVersion, reversible_blocks_exception,
+        "Unsupported reversible blocks log: ${f}", ("f",path_));
+    EVT_ASSERT(header.start >= kHeaderSize && header.start <= size, reversible_blocks_exception,
+        "Invalid start of reversible blocks log: ${s}", ("s",header.start));
+
+    // blocks are unpacked to verify them, there're only the reversible ones
+    auto pos = header.start;
+    while(pos + sizeof(entry_header) <= size) {
+        auto eh = entry_header();
+        read_exact(fd_, pos, &eh, sizeof(eh));
+        if(eh.size == 0 || pos + sizeof(eh) + eh.size > size) {
+            break;
+        }
+        if(!positions_.empty() && eh.block_num != first_num_ + positions_.size()) {
+            break;
+        }
+
+        auto b = signed_block_ptr();
+        try {
+            b = read_entry(pos);
+        }
+        catch(...) {
+        }
+        if(!b || b->block_num() != eh.block_num) {
+            break;
+        }
+
+        if(positions_.empty()) {
+            first_num_ = eh.block_num;
+        }
+        positions_.emplace_back(pos);
+        pos += sizeof(eh) + eh.size;
+    }
+
+    start_pos_ = header.start;
+    end_pos_   = pos;
+    if(end_pos_ < size) {
+        recovered_ = true;
+        if(!read_only_) {
+            wlog("Truncate torn tail of reversible blocks log from ${p}, ${n} blocks are recovered", ("p",end_pos_)("n",positions_.size()));
+            EVT_ASSERT(::ftruncate(fd_, end_pos_) == 0, reversible_blocks_exception, "Cannot truncate reversible blocks log");
+        }
+    }
+}
+
+void
+reversible_block_log::write_start() {
+    auto header = log_header { kMagic, kVersion, start_pos_ };
+    write_exact(fd_, 0, &header, sizeof(header));
+}
+
+signed_block_ptr
+reversible_block_log::read_entry(uint64_t pos) const {
+    auto eh = entry_header();
+    read_exact(fd_, pos, &eh, sizeof(eh));
+
+    auto data = std::vector<char>(eh.size);
+    read_exact(fd_, pos + sizeof(eh), data.data(), data.size());
+
+    auto b  = std::make_shared<signed_block>();
+    auto ds = fc::datastream<const char*>(data.data(), data.size());
+    fc::raw::unpack(ds, *b);
+    return b;
+}
+
+void
+reversible_block_log::append(const signed_block_ptr& b) {
+    run([this, b] { append_block(b); });
+}
+
+void
+reversible_block_log::append_block(const signed_block_ptr& b) {
+    auto num = b->block_num();
+    if(!positions_.empty() && num != first_num_ + positions_.size()) {
+        // not continued from the blocks in log, they're stale
+        wlog("Block ${n} is not continued from reversible blocks log (${f} to ${l}), drop them",
+            ("n",num)("f",first_num_)("l",first_num_ + positions_.size() - 1));
+        positions_.clear();
+        start_pos_ = end_pos_ = kHeaderSize;
+        write_start();
+        EVT_ASSERT(::ftruncate(fd_, kHeaderSize) == 0, reversible_blocks_exception, "Cannot truncate reversible blocks log");
+    }
+
+    // packed in place after the header, there's no other copy of the block
+    auto size = fc::raw::pack_size(*b);
+    auto buf  = std::vector<char>(sizeof(entry_header) + size);
+    auto eh   = entry_header { num, (uint32_t)size };
+    memcpy(buf.data(), &eh, sizeof(eh));
+
+    auto ds = fc::datastream<char*>(buf.data() + sizeof(eh), size);
+    fc::raw::pack(ds, *b);
+    write_exact(fd_, end_pos_, buf.data(), buf.size());
+
+    if(positions_.empty()) {
+        first_num_ = num;
+    }
+    positions_.emplace_back(end_pos_);
+    end_pos_ += buf.size();
+}
+
+void
+reversible_block_log::remove_from(uint32_t block_num) {
+    run([this, block_num] { truncate_from(block_num); });
+}
+
+void
+reversible_block_log::truncate_from(uint32_t block_num) {
+    if(positions_.empty() || block_num >= first_num_ + positions_.size()) {
+        return;
+    }
+
+    auto n   = block_num > first_num_ ? block_num - first_num_ : 0;
+    end_pos_ = positions_[n];
+    positions_.resize(n);
+    EVT_ASSERT(::ftruncate(fd_, end_pos_) == 0, reversible_blocks_exception, "Cannot truncate reversible blocks log");
+}
+
+void
+reversible_block_log::remove_until(uint32_t block_num) {
+    run([this, block_num] { drop_until(block_num); });
+}
+
+void
+reversible_block_log::drop_until(uint32_t block_num) {
+    if(positions_.empty() || block_num < first_num_) {
+        return;
+    }
+
+    auto n = std::min<size_t>(block_num - first_num_ + 1, positions_.size());
+    positions_.erase(positions_.begin(), positions_.begin() + n);
+    first_num_ += n;
+
+    if(positions_.empty()) {
+        // all are irreversible, start over from the beginning
+        start_pos_ = end_pos_ = kHeaderSize;
+        write_start();
+        EVT_ASSERT(::ftruncate(fd_, kHeaderSize) == 0, reversible_blocks_exception, "Cannot truncate reversible blocks log");
+        return;
+    }
+
+    start_pos_ = positions_.front();
+    write_start();
+
+    auto dead = start_pos_ - kHeaderSize;
+    if(dead >= kMinCompactSize && dead > end_pos_ - start_pos_) {
+        compact();
+    }
+}
+
+void
+reversible_block_log::compact() {
+    auto live = std::vector<char>(end_pos_ - start_pos_);
+    read_exact(fd_, start_pos_, live.data(), live.size());
+
+    auto tmp_path = path_;
+    tmp_path.replace_extension(".tmp");
+
+    auto fd = ::open(tmp_path.generic_string().c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    EVT_ASSERT(fd >= 0, reversible_blocks_exception, "Cannot open reversible blocks log: ${f}", ("f",tmp_path));
+
+    auto header = log_header { kMagic, kVersion, kHeaderSize };
+    write_exact(fd, 0, &header, sizeof(header));
+    write_exact(fd, kHeaderSize, live.data(), live.size());
+    EVT_ASSERT(::fdatasync(fd) == 0, reversible_blocks_exception, "Cannot sync reversible blocks log");
+
+    // the old file is still valid till the new one replaces it
+    fc::rename(tmp_path, path_);
+    ::close(fd_);
+    fd_ = fd;
+
+    auto delta = start_pos_ - kHeaderSize;
+    for(auto& p : positions_) {
+        p -= delta;
+    }
+    start_pos_ = kHeaderSize;
+    end_pos_  -= delta;
+}
+
+signed_block_ptr
+reversible_block_log::read_block(uint32_t block_num) {
+    flush();
+    if(positions_.empty() || block_num < first_num_ || block_num >= first_num_ + positions_.size()) {
+        return nullptr;
+    }
+    return read_entry(positions_[block_num - first_num_]);
+}
+
+void
+reversible_block_log::for_each(const std::function<void(const signed_block_ptr&)>& func) {
+    flush();
+    for(auto p : positions_) {
+        func(read_entry(p));
+    }
+}
+
+uint32_t
+reversible_block_log::first_block_num() {
+    flush();
+    return positions_.empty() ? 0 : first_num_;
+}
+
+uint32_t
+reversible_block_log::last_block_num() {
+    flush();
+    return positions_.empty() ? 0 : first_num_ + positions_.size() - 1;
+}
+
+uint64_t
+reversible_block_log::file_size() {
+    flush();
+    return end_pos_;
+}
+
+}}  // namespace evt::chain
@@ -3,8 +3,10 @@
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/iostreams/filter/zlib.hpp>
 
+#include <fc/io/raw.hpp>
 #include <fc/scoped_exit.hpp>
 #include <evt/chain/exceptions.hpp>
+#include <zstd.h>
 
 namespace evt { namespace chain {
 
@@ -417,6 +419,307 @@ istream_snapshot_reader::build_section_indexes() {
     }
 }
 
+zstd_snapshot_writer::zstd_snapshot_writer(std::ostream& snapshot)
+    : snapshot(snapshot) {
+    // write magic number
+    auto totem = magic_number;
+    snapshot.write((char*)&totem, sizeof(totem));
+
+    // write version
+    auto version = current_snapshot_version;
+    snapshot.write((char*)&version, sizeof(version));
+}
+
+zstd_snapshot_writer::section_state*
+zstd_snapshot_writer::cur_section() {
+    std::lock_guard<std::mutex> lock(states_mutex);
+
+    auto it = states.find(std::this_thread::get_id());
+    return it != states.end() ? it->second.get() : nullptr;
+}
+
+void
+zstd_snapshot_writer::write_start_section(const std::string& section_name) {
+    auto state = std::make_unique<section_state>();
+    state->section.name = section_name;
+
+    std::lock_guard<std::mutex> lock(states_mutex);
+    auto it = states.emplace(std::this_thread::get_id(), std::move(state));
+    EVT_ASSERT(it.second, snapshot_exception, "Attempting to write a new section without closing the previous section");
+}
+
+void
+zstd_snapshot_writer::write_row(const detail::abstract_snapshot_row_writer& row_writer) {
+    auto state = cur_section();
+    assert(state);
+
+    auto& s       = *state;
+    auto  wrapper = detail::ostream_wrapper(s.rows);
+    row_writer.write(wrapper);
+    s.section.row_count++;
+
+    if((size_t)s.rows.tellp() >= chunk_size) {
+        write_chunk(s);
+    }
+}
+
+void
+zstd_snapshot_writer::write_end_section() {
+    auto state = cur_section();
+    assert(state);
+
+    // state is dropped even if the last chunk fails to be written
+    auto drop_state = fc::make_scoped_exit([this]() {
+        std::lock_guard<std::mutex> lock(states_mutex);
+        states.erase(std::this_thread::get_id());
+    });
+
+    write_chunk(*state);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        sections.emplace_back(std::move(state->section));
+    }
+}
+
+// rows are compressed by current thread, only writing into stream is serialized
+void
+zstd_snapshot_writer::write_chunk(section_state& s) {
+    auto data = s.rows.str();
+    if(data.empty()) {
+        return;
+    }
+    s.rows.str(std::string());
+
+    auto buf = std::vector<char>(ZSTD_compressBound(data.size()));
+    auto sz  = ZSTD_compress(buf.data(), buf.size(), data.data(), data.size(), 3);
+    EVT_ASSERT(!ZSTD_isError(sz), snapshot_exception, "Compress section ${n} failed: ${e}", ("n",s.section.name)("e",ZSTD_getErrorName(sz)));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    s.section.chunks.emplace_back(detail::zstd_snapshot_chunk {
+        .pos      = (uint64_t)snapshot.tellp(),
+        .size     = (uint32_t)sz,
+        .raw_size = (uint32_t)data.size()
+    });
+    snapshot.write(buf.data(), sz);
+}
+
+void
+zstd_snapshot_writer::finalize() {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    uint64_t index_pos = snapshot.tellp();
+    auto     index     = fc::raw::pack(sections);
+    snapshot.write(index.data(), index.size());
+    snapshot.write((char*)&index_pos, sizeof(index_pos));
+
+    auto totem = magic_number;
+    snapshot.write((char*)&totem, sizeof(totem));
+}
+
+zstd_snapshot_reader::zstd_snapshot_reader(std::istream& snapshot)
+    : snapshot(snapshot)
+    , header_pos(snapshot.tellg())
+    , index_pos(0) {
+    build_section_indexes();
+}
+
+void
+zstd_snapshot_reader::validate() const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto restore_pos = fc::make_scoped_exit([this, pos = snapshot.tellg(), ex = snapshot.exceptions()]() {
+        snapshot.seekg(pos);
+        snapshot.exceptions(ex);
+    });
+
+    snapshot.exceptions(std::istream::failbit | std::istream::eofbit);
+
+    try {
+        // validate totem
+        auto                     expected_totem = zstd_snapshot_writer::magic_number;
+        decltype(expected_totem) actual_totem;
+        snapshot.seekg(header_pos);
+        snapshot.read((char*)&actual_totem, sizeof(actual_totem));
+        EVT_ASSERT(actual_totem == expected_totem, snapshot_exception,
+                   "Binary snapshot has unexpected magic number!");
+
+        // validate version
+        auto                       expected_version = current_snapshot_version;
+        decltype(expected_version) actual_version;
+        snapshot.read((char*)&actual_version, sizeof(actual_version));
+        EVT_ASSERT(actual_version == expected_version, snapshot_exception,
+                   "Binary snapshot is an unsuppored version.  Expected : ${expected}, Got: ${actual}",
+                   ("expected", expected_version)("actual", actual_version));
+
+        auto data_pos = (uint64_t)snapshot.tellg();
+        for(auto& s : sections) {
+            for(auto& c : s.chunks) {
+                EVT_ASSERT(c.pos >= data_pos && c.pos + c.size <= index_pos, snapshot_exception,
+                           "Chunk of section ${n} is out of snapshot", ("n",s.name));
+            }
+        }
+    }
+    catch(const std::exception& e) {
+        snapshot_exception fce(FC_LOG_MESSAGE(warn, "Binary snapshot validation threw IO exception (${what})", ("what", e.what())));
+        throw fce;
+    }
+}
+
+std::vector<std::string>
+zstd_snapshot_reader::get_section_names(const std::string& prefix) const {
+    auto names = std::vector<std::string>();
+    for(auto& s : sections) {
+        if(boost::starts_with(s.name, prefix)) {
+            names.emplace_back(s.name);
+        }
+    }
+    return names;
+}
+
+const detail::zstd_snapshot_section*
+zstd_snapshot_reader::find_section(const std::string& section_name) const {
+    for(auto& s : sections) {
+        if(s.name == section_name) {
+            return &s;
+        }
+    }
+    return nullptr;
+}
+
+bool
+zstd_snapshot_reader::has_section(const string& section_name) {
+    return find_section(section_name) != nullptr;
+}
+
+void
+zstd_snapshot_reader::set_section(const string& section_name) {
+    auto s = find_section(section_name);
+    EVT_ASSERT(s, snapshot_exception, "Binary snapshot has no section named ${n}", ("n", section_name));
+
+    auto state = std::make_unique<section_state>();
+    state->section = s;
+
+    std::lock_guard<std::mutex> lock(states_mutex);
+    states[std::this_thread::get_id()] = std::move(state);
+}
+
+size_t
+zstd_snapshot_reader::get_section_size(const string& section_name) {
+    auto s = find_section(section_name);
+    EVT_ASSERT(s, snapshot_exception, "Binary snapshot has no section named ${n}", ("n", section_name));
+
+    auto size = size_t(0);
+    for(auto& c : s->chunks) {
+        size += c.size;
+    }
+    return size;
+}
+
+// only reading from stream is serialized, chunk is decompressed by current thread
+void
+zstd_snapshot_reader::read_chunk(section_state& s) {
+    EVT_ASSERT(s.next_chunk < s.section->chunks.size(), snapshot_exception, "Section ${n} has no more rows", ("n",s.section->name));
+
+    auto& c   = s.section->chunks[s.next_chunk++];
+    auto  buf = std::vector<char>(c.size);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        snapshot.seekg(c.pos);
+        snapshot.read(buf.data(), buf.size());
+        EVT_ASSERT(snapshot.gcount() == std::streamsize(buf.size()), snapshot_exception, "Chunk of section ${n} is incomplete", ("n",s.section->name));
+    }
+
+    auto data = std::string(c.raw_size, '\0');
+    auto sz   = ZSTD_decompress(data.data(), data.size(), buf.data(), buf.size());
+    EVT_ASSERT(!ZSTD_isError(sz) && sz == c.raw_size, snapshot_exception, "Decompress section ${n} failed", ("n",s.section->name));
+
+    s.rows.clear();
+    s.rows.str(std::move(data));
+}
+
+zstd_snapshot_reader::section_state*
+zstd_snapshot_reader::cur_section() {
+    std::lock_guard<std::mutex> lock(states_mutex);
+
+    auto it = states.find(std::this_thread::get_id());
+    return it != states.end() ? it->second.get() : nullptr;
+}
+
+bool
+zstd_snapshot_reader::read_row(detail::abstract_snapshot_row_reader& row_reader) {
+    auto state = cur_section();
+    assert(state);
+
+    // chunks end at the boundaries of rows
+    auto& s = *state;
+    if(s.rows.peek() == std::char_traits<char>::eof()) {
+        read_chunk(s);
+    }
+    row_reader.provide(s.rows);
+    return ++s.cur_row < s.section->row_count;
+}
+
+bool
+zstd_snapshot_reader::empty() {
+    return cur_section()->section->row_count == 0;
+}
+
+bool
+zstd_snapshot_reader::eof() {
+    auto& s = *cur_section();
+    return s.cur_row >= s.section->row_count;
+}
+
+void
+zstd_snapshot_reader::clear_section() {
+    std::lock_guard<std::mutex> lock(states_mutex);
+    states.erase(std::this_thread::get_id());
+}
+
+void
+zstd_snapshot_reader::build_section_indexes() {
+    auto restore_pos = fc::make_scoped_exit([this, pos = snapshot.tellg()]() {
+        snapshot.seekg(pos);
+    });
+
+    const std::streamoff header_size = sizeof(zstd_snapshot_writer::magic_number) + sizeof(current_snapshot_version);
+    const std::streamoff footer_size = sizeof(index_pos) + sizeof(zstd_snapshot_writer::magic_number);
+
+    snapshot.seekg(0, std::ios::end);
+    auto end_pos = snapshot.tellg();
+    EVT_ASSERT(end_pos - header_pos >= header_size + footer_size, snapshot_validation_exception, "Binary snapshot is incomplete");
+
+    auto totem = uint32_t(0);
+    snapshot.seekg(end_pos - footer_size);
+    snapshot.read((char*)&index_pos, sizeof(index_pos));
+    snapshot.read((char*)&totem, sizeof(totem));
+    EVT_ASSERT(totem == zstd_snapshot_writer::magic_number, snapshot_validation_exception, "Binary snapshot has no index of sections");
+
+    auto index_end = (uint64_t)(end_pos - footer_size);
+    EVT_ASSERT(index_pos >= (uint64_t)(header_pos + header_size) && index_pos <= index_end, snapshot_validation_exception,
+               "Binary snapshot has invalid index of sections");
+
+    auto index = std::vector<char>(index_end - index_pos);
+    snapshot.seekg(index_pos);
+    snapshot.read(index.data(), index.size());
+
+    auto ds = fc::datastream<const char*>(index.data(), index.size());
+    fc::raw::unpack(ds, sections);
+}
+
+snapshot_reader_ptr
+make_snapshot_reader(std::istream& snapshot) {
+    auto pos   = snapshot.tellg();
+    auto totem = uint32_t(0);
+    snapshot.read((char*)&totem, sizeof(totem));
+    snapshot.seekg(pos);
+
+    if(totem == zstd_snapshot_writer::magic_number) {
+        return std::make_shared<zstd_snapshot_reader>(snapshot);
+    }
+    return std::make_shared<istream_snapshot_reader>(snapshot);
+}
+
 integrity_hash_snapshot_writer::integrity_hash_snapshot_writer(fc::sha256::encoder& enc)
     : enc(enc) {
 }
@@ -8,29 +8,55 @@
 #define __cpp_lib_string_view
 #endif
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <deque>
 #include <fstream>
+#include <map>
+#include <numeric>
+#include <set>
+#include <shared_mutex>
 #include <string_view>
 #include <unordered_set>
+#include <sys/mman.h>
 
+#include <boost/endian/conversion.hpp>
 #include <rocksdb/db.h>
 #include <rocksdb/cache.h>
 #include <rocksdb/options.h>
+#include <rocksdb/persistent_cache.h>
+#include <rocksdb/convenience.h>
+#include <rocksdb/rate_limiter.h>
 #include <rocksdb/filter_policy.h>
 #include <rocksdb/slice_transform.h>
 #include <rocksdb/statistics.h>
 #include <rocksdb/table.h>
+#include <rocksdb/transaction_log.h>
+#include <rocksdb/utilities/checkpoint.h>
+#include <rocksdb/utilities/options_util.h>
+#include <rocksdb/utilities/stackable_db.h>
+#include <rocksdb/sst_file_writer.h>
+#include <rocksdb/utilities/write_batch_with_index.h>
 
 #include <llvm/ADT/StringSet.h>
 #include <llvm/ADT/StringMap.h>
 
+#include <fmt/format.h>
+
 #include <fc/filesystem.hpp>
 #include <fc/io/datastream.hpp>
 #include <fc/io/raw.hpp>
+#include <fc/scoped_exit.hpp>
 #include <fc/container/ring_vector.hpp>
+#include <fc/uint128.hpp>
 
 #include <evt/chain/config.hpp>
 #include <evt/chain/exceptions.hpp>
+#include <evt/chain/dense_hash.hpp>
+#include <evt/chain/contracts/types.hpp>
+#include <evt/utilities/trace.hpp>
 
 namespace evt { namespace chain {
 
@@ -49,8 +75,10 @@ namespace internal {
 #endif
 
 const char*  kAssetsColumnFamilyName = "Assets";
+const char*  kOwnersColumnFamilyName = "Owners";
 const size_t kSymbolIdSize           = sizeof(symbol_id_type);
 const size_t kPublicKeySize          = sizeof(fc::ecc::public_key_shim);
+const size_t kOwnerKeySize           = kPublicKeySize + sizeof(name128) * 2;
 const size_t kDefaultSavePointsSize  = (4 / 3 * 24 + 1) * 12;
 
 struct db_token_key : boost::noncopyable {
@@ -111,6 +139,32 @@ private:
     rocksdb::Slice slice;
 };
 
+// key of owner index: address + domain + name
+struct db_owner_key : boost::noncopyable {
+public:
+    db_owner_key(const address& addr, const name128& domain, const name128& name)
+        : slice((const char*)this, sizeof(buf)) {
+        addr.to_bytes(buf, kPublicKeySize);
+        memcpy(buf + kPublicKeySize, &domain, sizeof(name128));
+        memcpy(buf + kPublicKeySize + sizeof(name128), &name, sizeof(name128));
+    }
+
+    const rocksdb::Slice&
+    as_slice() const {
+        return slice;
+    }
+
+    std::string_view
+    as_string_view() const {
+        return std::string_view((const char*)this, sizeof(buf));
+    }
+
+private:
+    char buf[kOwnerKeySize];
+
+    rocksdb::Slice slice;
+};
+
 name128 action_key_prefixes[] = {
     N128(.asset),
     N128(.domain),
@@ -122,11 +176,125 @@ name128 action_key_prefixes[] = {
     N128(.prodvote),
     N128(.evtlink),
     N128(.psvbonus),
-    N128(.psvbonus-dist)
+    N128(.psvbonus-dist),
+    N128(.meta)
 };
 
 static_assert(sizeof(action_key_prefixes) / sizeof(name128) == (int)token_type::max_value + 1);
 
+// pseudo token type used in savepoints for the entries of owner index
+const int kOwnerIndexType = (int)token_type::max_value + 1;
+
+// value of entries in owner index, it cannot be empty because empty value means removed in persist savepoints
+const auto kOwnerKeyValue = rocksdb::Slice("\x01", 1);
+
+// entries of expiry index share the column of owner index, each indexed type uses a reserved generated
+// address as the owner and the expiry in big endian as the domain, so entries of one type are in time order
+address
+get_expiry_index_address(token_type type) {
+    return address(N(.expiry), action_key_prefixes[(int)type], 0);
+}
+
+name128
+get_expiry_index_slot(const fc::time_point_sec& expiry) {
+    auto v    = boost::endian::native_to_big(expiry.sec_since_epoch());
+    auto slot = name128();
+    memcpy(&slot, &v, sizeof(v));
+    return slot;
+}
+
+fc::time_point_sec
+get_expiry_from_slot(const char* slot) {
+    auto v = uint32_t();
+    memcpy(&v, slot, sizeof(v));
+    return fc::time_point_sec(boost::endian::big_to_native(v));
+}
+
+bool
+has_expiry_index(token_type type) {
+    return type == token_type::suspend || type == token_type::lock;
+}
+
+// marker entry written once the expiry index is built, owner indexes built before it was introduced have no expiries
+address
+get_expiry_index_marker() {
+    return address(N(.index), N128(.expiry), 0);
+}
+
+// entries of asset index share the column of owner index too, they're keyed by the holder address, the reserved
+// `.asset` prefix as the domain and the symbol id as the name, so all the balances of one address are in one prefix
+const name128& kAssetIndexDomain = action_key_prefixes[(int)token_type::asset];
+
+name128
+get_asset_index_slot(symbol_id_type sym_id) {
+    auto slot = name128();
+    memcpy(&slot, &sym_id, sizeof(sym_id));
+    return slot;
+}
+
+symbol_id_type
+get_sym_id_from_slot(const char* slot) {
+    auto sym_id = symbol_id_type();
+    memcpy(&sym_id, slot, sizeof(sym_id));
+    return sym_id;
+}
+
+// marker entry written once the asset index is built, indexes built before it was introduced have no assets
+address
+get_asset_index_marker() {
+    return address(N(.index), kAssetIndexDomain, 0);
+}
+
+// builds the entry of asset index from the key of asset: symbol id + address
+std::string
+get_asset_index_key(const rocksdb::Slice& asset_key) {
+    assert(asset_key.size() == kSymbolIdSize + kPublicKeySize);
+
+    auto key = std::string(kOwnerKeySize, '\0');
+    memcpy(key.data(), asset_key.data() + kSymbolIdSize, kPublicKeySize);
+    memcpy(key.data() + kPublicKeySize, &kAssetIndexDomain, sizeof(name128));
+    memcpy(key.data() + kPublicKeySize + sizeof(name128), asset_key.data(), kSymbolIdSize);
+    return key;
+}
+
+// suspend proposals are indexed by the expiration of transaction and locks by the unlock time,
+// both are only indexed while they are still proposed
+std::optional<fc::time_point_sec>
+get_expiry(token_type type, const std::string_view& data) {
+    using namespace contracts;
+
+    switch(type) {
+    case token_type::suspend: {
+        auto suspend = suspend_def();
+        extract_db_value(data, suspend);
+        if(suspend.status == suspend_status::proposed) {
+            return suspend.trx.expiration;
+        }
+        break;
+    }
+    case token_type::lock: {
+        auto lock = lock_def();
+        extract_db_value(data, lock);
+        if(lock.status == lock_status::proposed) {
+            return lock.unlock_time;
+        }
+        break;
+    }
+    default: {
+        assert(false);
+    }
+    }  // switch
+    return std::nullopt;
+}
+
+// journal is rewritten from savepoints in memory when it grows larger than this
+const size_t kJournalCompactSize = 256 * 1024 * 1024;
+
+// format of the values in token database, it's kept in the format file of db dir and databases without it are
+// of format 1. values are not migrated, databases of older formats need to be rebuilt
+// 2: metas are stored apart from domains, tokens and fungibles
+const uint32_t kFormatVersion = 2;
+
 using keys_hash_set = llvm::StringSet<llvm::MallocAllocator>;
 
 struct flag {
@@ -149,7 +317,8 @@ enum data_type {
     kTokenKey = 0,
     kTokenFullKey,
     kAssetKey,
-    kTokenKeys
+    kTokenKeys,
+    kOwnerKey
 };
 
 // realtime action
@@ -226,6 +395,8 @@ struct rt_token_fullkey {
     name128 key;
 };
 
+static_assert(sizeof(rt_token_fullkey) == sizeof(name128) * 2);
+
 struct rt_token_keys {
     name128      prefix;
     token_keys_t keys;
@@ -235,1376 +406,4523 @@ struct rt_asset_key {
     char key[kSymbolIdSize + kPublicKeySize];
 };
 
+struct rt_owner_key {
+    char key[kOwnerKeySize];
+};
+
 struct pd_header {
     int dirty_flag;
 };
 
-}  // namespace internal
-
-class write_cache_layer : boost::noncopyable {
-private:
-    struct cache_entry {
-    public:
-        cache_entry(int32_t used_count, std::string&& value)
-            : used_count(used_count)
-            , value(std::move(value)) {}
+enum journal_type {
+    kJournalAddSavepoint = 0,
+    kJournalPutToken,
+    kJournalPutAsset,
+    kJournalPutOwner,
+    kJournalRollback,
+    kJournalSquash,
+    kJournalPopBack,
+    kJournalPopFront
+};
 
-    public:
-        int32_t     used_count;
-        std::string value;
-    };
+// record appended to savepoints journal
+// `seq` is used by adding or popping savepoints, `key` and `value` are used by puts
+// for owner index, `value` is the old value before put which is restored by rollback
+struct journal_record {
+    uint8_t     type;
+    int64_t     seq;
+    std::string key;
+    std::string value;
+};
 
-    using data_map_t = llvm::StringMap<cache_entry>;
+// seek to `seek` and invoke `func` with each key(without prefix) and value under the same prefix
+// if `seek` is longer than prefix, it's the cursor of last read and is not included in the results
+int
+scan_range(rocksdb::Iterator* it, const rocksdb::Slice& seek, size_t prefix_size, int skip, const read_value_func& func) {
+    auto i     = 0;
+    auto count = 0;
 
-    struct data_op {
-    public:
-        data_op(data_map_t::iterator& it, std::string&& pv)
-            : it(&(*it)), pv(std::move(pv)) {}
+    it->Seek(seek);
+    if(seek.size() > prefix_size && it->Valid() && it->key() == seek) {
+        it->Next();
+    }
+    while(it->Valid()) {
+        if(i++ < skip) {
+            it->Next();
+            continue;
+        }
 
-    public:
-        data_map_t::value_type* it;
-        std::string             pv;
-    };
+        count++;
+        auto value = it->value().ToString();
+        auto key   = it->key();
 
-    struct data_ops {
-        int64_t              seq;
-        std::vector<data_op> vec;
-    };
+        key.remove_prefix(prefix_size);
+        if(!func(key.ToStringView(), std::move(value))) {
+            return count;
+        }
+        it->Next();
+    }
+    return count;
+}
 
-public:
-    write_cache_layer() : ops_(internal::kDefaultSavePointsSize) {}
+const int kLatencyBuckets = 20;
+
+const char* token_type_names[] = {
+    "asset",
+    "domain",
+    "token",
+    "group",
+    "suspend",
+    "lock",
+    "fungible",
+    "prodvote",
+    "evtlink",
+    "psvbonus",
+    "psvbonus_dist",
+    "meta"
+};
 
-public:
-    void put(const std::string_view& key, const std::string_view& value);
-    int read(const std::string_view& key, std::string& value) const;
-    int exists(const std::string_view& key) const;
+static_assert(sizeof(token_type_names) / sizeof(const char*) == (int)token_type::max_value + 1);
 
-public:
-    void add_savepoint(int64_t seq);
-    void rollback_to_latest_savepoint();
-    void squash();
-    void pop_front(std::function<void(const llvm::StringRef&, std::string&&)> persist_func);
-    void pop_back();
+std::string
+get_type_column_name(int type) {
+    return fmt::format("Type-{}", token_type_names[type]);
+}
 
-    void clear();
-    void persist_savepoints(std::ostream& os) const;
-    void load_savepoints(std::istream& is);
+rocksdb::CompressionType
+get_compression_type(const std::string& name) {
+    if(name == "none") {
+        return rocksdb::kNoCompression;
+    }
+    else if(name == "snappy") {
+        return rocksdb::kSnappyCompression;
+    }
+    else if(name == "lz4") {
+        return rocksdb::kLZ4Compression;
+    }
+    else if(name == "zstd") {
+        return rocksdb::kZSTD;
+    }
+    EVT_THROW(token_database_exception, "Unknown compression type: ${c}", ("c", name));
+}
 
-private:
-    data_map_t                data_;
-    fc::ring_vector<data_ops> ops_;
+// counters are atomic because range reads may be invoked from multiple threads when writing snapshot
+struct type_stats {
+    std::atomic<uint64_t> reads       = 0;
+    std::atomic<uint64_t> writes      = 0;
+    std::atomic<uint64_t> exists      = 0;
+    std::atomic<uint64_t> read_bytes  = 0;
+    std::atomic<uint64_t> write_bytes = 0;
 
-private:
-    friend class token_database_impl;
+    std::array<std::atomic<uint64_t>, kLatencyBuckets> read_latency  = {};
+    std::array<std::atomic<uint64_t>, kLatencyBuckets> write_latency = {};
 };
 
-void
-write_cache_layer::put(const std::string_view& key, const std::string_view& value) {
-    assert(!ops_.empty());
+enum stats_kind { kStatsRead = 0, kStatsWrite, kStatsExists };
 
-    auto pair = data_.try_emplace(llvm::StringRef(key.data(), key.size()), 1, std::string(value.data(), value.size()));
-    if(!pair.second) {
-        auto pv = std::move(pair.first->second.value);
-        pair.first->second.used_count += 1;
-        pair.first->second.value       = std::string(value.data(), value.size());
-        ops_.back().vec.emplace_back(data_op(pair.first, std::move(pv)));
-        return;
+// measures one operation and records it into `stats` when destructed
+// does nothing if `stats` is null which means stats are disabled
+class stats_guard : boost::noncopyable {
+public:
+    stats_guard(type_stats* stats, stats_kind kind)
+        :
+#ifdef EVT_TRACING
+          span_(kind == kStatsWrite ? "token_db write" : (kind == kStatsRead ? "token_db read" : "token_db exists")),
+#endif
+          stats_(stats), kind_(kind), bytes(0) {
+        if(auto c = db_op_counters::current(); c != nullptr) {
+            (kind == kStatsWrite) ? c->writes++ : c->reads++;
+        }
+        if(stats_) {
+            start_ = std::chrono::steady_clock::now();
+        }
     }
-    ops_.back().vec.emplace_back(data_op(pair.first, std::string()));
-}
 
-int
-write_cache_layer::read(const std::string_view& key, std::string& value) const {
-    auto it = data_.find(llvm::StringRef(key.data(), key.size()));
-    if(it == data_.end()) {
-        return 0;
+    ~stats_guard() {
+        if(!stats_) {
+            return;
+        }
+
+        auto us     = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_).count();
+        auto bucket = (us <= 0) ? 0 : std::min(64 - __builtin_clzll((uint64_t)us), kLatencyBuckets - 1);
+        switch(kind_) {
+        case kStatsRead: {
+            stats_->reads++;
+            stats_->read_bytes += bytes;
+            stats_->read_latency[bucket]++;
+            break;
+        }
+        case kStatsWrite: {
+            stats_->writes++;
+            stats_->write_bytes += bytes;
+            stats_->write_latency[bucket]++;
+            break;
+        }
+        case kStatsExists: {
+            stats_->exists++;
+            stats_->read_latency[bucket]++;
+            break;
+        }
+        }  // switch
     }
-    value = it->second.value;
-    return 1;
-}
 
-int
-write_cache_layer::exists(const std::string_view& key) const {
-    return data_.find(llvm::StringRef(key.data(), key.size())) != data_.end();
-}
+private:
+#ifdef EVT_TRACING
+    evt::utilities::trace::span span_;
+#endif
+    type_stats*                           stats_;
+    stats_kind                            kind_;
+    std::chrono::steady_clock::time_point start_;
 
-void
-write_cache_layer::add_savepoint(int64_t seq) {
-    ops_.push_back(data_ops{ .seq = seq, .vec = {} });
-}
+public:
+    size_t bytes;
+};
 
-void
-write_cache_layer::rollback_to_latest_savepoint() {
-    auto& ops = ops_.back();
-    for(auto it = ops.vec.rbegin(); it != ops.vec.rend(); it++) {
-        auto& op = *it;
-        if(--op.it->second.used_count == 0) {
-            data_.erase(op.it->first());
+// transparent huge pages are requested for large blocks(bucket arrays of hash tables),
+// so that random lookups in big tables miss less in TLB
+template<typename T>
+class huge_page_allocator {
+public:
+    using value_type      = T;
+    using size_type       = size_t;
+    using difference_type = ptrdiff_t;
+    using pointer         = T*;
+    using const_pointer   = const T*;
+    using reference       = T&;
+    using const_reference = const T&;
+
+    template<typename U>
+    struct rebind { using other = huge_page_allocator<U>; };
+
+    static const size_t kHugePageSize = 2 * 1024 * 1024;
+
+public:
+    huge_page_allocator() = default;
+    template<typename U>
+    huge_page_allocator(const huge_page_allocator<U>&) {}
+
+public:
+    pointer
+    allocate(size_type n, const void* = nullptr) {
+        auto sz = n * sizeof(T);
+        if(sz < kHugePageSize) {
+            return std::allocator<T>().allocate(n);
         }
-        else {
-            assert(!op.it->second.value.empty());
-            op.it->second.value = std::move(op.pv);
+        auto p = mmap(nullptr, sz, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(p == MAP_FAILED) {
+            throw std::bad_alloc();
         }
+#ifdef MADV_HUGEPAGE
+        madvise(p, sz, MADV_HUGEPAGE);
+#endif
+        return (pointer)p;
     }
-    ops_.pop_back();
-}
-
-void
-write_cache_layer::squash() {
-    assert(ops_.size() >= 2);
-    auto& b1 = ops_[ops_.size() - 1];
-    auto& b2 = ops_[ops_.size() - 2];
-
-    b2.vec.insert(b2.vec.end(), b1.vec.begin(), b1.vec.end());
-    ops_.pop_back();
-}
 
-void
-write_cache_layer::pop_front(std::function<void(const llvm::StringRef&, std::string&&)> persist_func) {
-    for(auto& op : ops_.front().vec) {
-        if(--op.it->second.used_count == 0) {
-            persist_func(op.it->first(), std::move(op.it->second.value));
-            data_.erase(op.it->first());
+    void
+    deallocate(pointer p, size_type n) {
+        auto sz = n * sizeof(T);
+        if(sz < kHugePageSize) {
+            std::allocator<T>().deallocate(p, n);
+            return;
         }
+        munmap(p, sz);
     }
 
-    ops_.pop_front();
-}
+    size_type max_size() const { return std::numeric_limits<size_type>::max() / sizeof(T); }
 
-void
-write_cache_layer::pop_back() {
-    ops_.pop_back();
-}
+    pointer       address(reference r) const { return &r; }
+    const_pointer address(const_reference r) const { return &r; }
 
-namespace internal {
+    void construct(pointer p, const value_type& v) { new(p) value_type(v); }
+    void destroy(pointer p) { p->~value_type(); }
 
-struct wc_entry {
-    std::string k;
-    std::string v;
+    bool operator==(const huge_page_allocator&) const { return true; }
+    bool operator!=(const huge_page_allocator&) const { return false; }
 };
 
-struct wc_entry_pack {
-    int64_t               seq;
-    std::vector<wc_entry> vec;
+// keys of tokens and assets have fixed sizes in their column families, so padding them with zeros is unambiguous
+struct hash_key {
+    static const size_t kMaxSize = 40;
+
+    std::array<char, kMaxSize> data;
 };
 
-}  // namespace internal
+static_assert(sizeof(name128) * 2 <= hash_key::kMaxSize && kPublicKeySize + kSymbolIdSize <= hash_key::kMaxSize);
 
-void
-write_cache_layer::clear() {
-    data_.clear();
-    ops_.clear();
-}
+hash_key
+make_hash_key(const rocksdb::Slice& key) {
+    assert(key.size() <= hash_key::kMaxSize);
 
-void
-write_cache_layer::persist_savepoints(std::ostream& os) const {
-    using namespace internal;
+    auto k = hash_key();
+    k.data.fill(0);
+    memcpy(k.data.data(), key.data(), key.size());
+    return k;
+}
 
-    auto pack = std::vector<wc_entry_pack>();
-    pack.resize(ops_.size());
-    for(auto i = 0; i < ops_.size(); i++) {
-        auto& ops = ops_[i];
-        
-        auto& epack = pack[i];
-        epack.seq   = ops.seq;
-        for(auto& op : ops.vec) {
-            epack.vec.emplace_back(wc_entry {
-                .k  = op.it->first().str(),
-                .v  = op.it->second.value
-            });
-        }
-    }
-    fc::raw::pack(os, pack);
+// padding of real keys is zero, so they can never be these ones
+hash_key
+make_filled_hash_key(char c) {
+    auto k = hash_key();
+    k.data.fill(c);
+    return k;
 }
 
-void
-write_cache_layer::load_savepoints(std::istream& is) {
-    using namespace internal;
-
-    auto pack = std::vector<wc_entry_pack>();
-    fc::raw::unpack(is, pack);
+struct hash_key_hasher {
+    size_t operator()(const hash_key& k) const { return fc::city_hash_size_t(k.data.data(), k.data.size()); }
+};
 
-    for(auto& ops : pack) {
-        this->add_savepoint(ops.seq);
-        for(auto& op : ops.vec) {
-            this->put(op.k, op.v);
-        }
-    }
-}
+struct hash_key_equal {
+    bool operator()(const hash_key& l, const hash_key& r) const { return memcmp(l.data.data(), r.data.data(), hash_key::kMaxSize) == 0; }
+};
 
-class token_database_impl : boost::noncopyable {
-public:
-    token_database_impl(token_database& self, const token_database::config& config);
+using hash_values_t = google::dense_hash_map<hash_key, std::string, hash_key_hasher, hash_key_equal,
+                                             huge_page_allocator<std::pair<const hash_key, std::string>>>;
 
+// rocksdb is still the durable store in `hash` profile: its wal logs the writes and flushed tables are the checkpoints.
+// latest values of column families are mirrored in open-addressing hash tables here and point reads without
+// snapshot are served by them, while reads with snapshot and iterators still go to rocksdb, which keeps the
+// order needed by range reads. tables are loaded by one scan on the first read and dropped when column family
+// is changed in other ways than writes(ingestion), then loaded again later
+class hash_memory_db : public rocksdb::StackableDB {
 public:
-    void open(int load_persistence = true);
-    void close(int persist = true);
+    hash_memory_db(rocksdb::DB* db, std::set<std::string> skipped_columns)
+        : rocksdb::StackableDB(db)
+        , skipped_columns_(std::move(skipped_columns)) {}
 
 public:
-    void put_token(token_type type, action_op op, const name128& prefix, const name128& key, const std::string_view& data);
-    void put_tokens(token_type type,
-                    action_op op,
-                    const name128& prefix,
-                    token_keys_t&& keys,
-                    const small_vector_base<std::string_view>& data);
-    void put_asset(const address& addr, const symbol_id_type sym_id, const std::string_view& data);
+    using rocksdb::StackableDB::Get;
+    using rocksdb::StackableDB::MultiGet;
+    using rocksdb::StackableDB::Put;
+    using rocksdb::StackableDB::Delete;
+    using rocksdb::StackableDB::SingleDelete;
+    using rocksdb::StackableDB::IngestExternalFile;
+    using rocksdb::StackableDB::DropColumnFamily;
+
+    rocksdb::Status
+    Get(const rocksdb::ReadOptions& opts, rocksdb::ColumnFamilyHandle* cf, const rocksdb::Slice& key, rocksdb::PinnableSlice* value) override {
+        if(opts.snapshot == nullptr && key.size() <= hash_key::kMaxSize && load(cf)) {
+            auto lock = std::shared_lock<std::shared_mutex>(mutex_);
+            if(auto t = loaded_table(cf->GetID()); t != nullptr) {
+                auto it = t->values.find(make_hash_key(key));
+                if(it == t->values.end()) {
+                    return rocksdb::Status::NotFound();
+                }
+                value->PinSelf(it->second);
+                return rocksdb::Status::OK();
+            }
+        }
+        return rocksdb::StackableDB::Get(opts, cf, key, value);
+    }
 
-    int exists_token(const name128& prefix, const name128& key) const;
-    int exists_asset(const address& addr, const symbol_id_type sym_id) const;
+    std::vector<rocksdb::Status>
+    MultiGet(const rocksdb::ReadOptions& opts, const std::vector<rocksdb::ColumnFamilyHandle*>& cfs,
+             const std::vector<rocksdb::Slice>& keys, std::vector<std::string>* values) override {
+        auto hashed = opts.snapshot == nullptr;
+        for(auto i = 0u; hashed && i < keys.size(); i++) {
+            hashed = keys[i].size() <= hash_key::kMaxSize && ((i > 0 && cfs[i] == cfs[i - 1]) || load(cfs[i]));
+        }
 
-    int read_token(const name128& prefix, const name128& key, std::string& out, bool no_throw = false) const;
-    int read_asset(const address& addr, const symbol_id_type sym_id, std::string& out, bool no_throw = false) const;
+        if(hashed) {
+            auto lock     = std::shared_lock<std::shared_mutex>(mutex_);
+            auto statuses = std::vector<rocksdb::Status>(keys.size());
+            values->resize(keys.size());
 
-    int read_tokens_range(const name128& prefix, int skip, const read_value_func& func) const;
-    int read_assets_range(const symbol_id_type sym_id, int skip, const read_value_func& func) const;
+            auto i = 0u;
+            for(; i < keys.size(); i++) {
+                auto t = loaded_table(cfs[i]->GetID());
+                if(t == nullptr) {
+                    break;
+                }
+                if(auto it = t->values.find(make_hash_key(keys[i])); it != t->values.end()) {
+                    (*values)[i] = it->second;
+                }
+                else {
+                    statuses[i] = rocksdb::Status::NotFound();
+                }
+            }
+            if(i == keys.size()) {
+                return statuses;
+            }
+        }
+        return rocksdb::StackableDB::MultiGet(opts, cfs, keys, values);
+    }
 
-public:
-    void add_savepoint(int64_t seq);
-    void rollback_to_latest_savepoint();
-    void pop_savepoints(int64_t until);
-    void pop_back_savepoint();
-    void squash();
+    rocksdb::Status
+    Put(const rocksdb::WriteOptions& opts, rocksdb::ColumnFamilyHandle* cf, const rocksdb::Slice& key, const rocksdb::Slice& value) override {
+        auto status = rocksdb::StackableDB::Put(opts, cf, key, value);
+        if(status.ok()) {
+            auto lock = std::unique_lock<std::shared_mutex>(mutex_);
+            put(cf->GetID(), key, value);
+        }
+        return status;
+    }
 
-    int64_t latest_savepoint_seq() const;
-    int64_t new_savepoint_session_seq() const;
-    size_t  savepoints_size() const { return savepoints_.size(); }
+    rocksdb::Status
+    Delete(const rocksdb::WriteOptions& opts, rocksdb::ColumnFamilyHandle* cf, const rocksdb::Slice& key) override {
+        auto status = rocksdb::StackableDB::Delete(opts, cf, key);
+        if(status.ok()) {
+            auto lock = std::unique_lock<std::shared_mutex>(mutex_);
+            remove(cf->GetID(), key);
+        }
+        return status;
+    }
 
-    void rollback_rt_group(internal::rt_group*);
-    void rollback_pd_group(internal::pd_group*);
+    rocksdb::Status
+    SingleDelete(const rocksdb::WriteOptions& opts, rocksdb::ColumnFamilyHandle* cf, const rocksdb::Slice& key) override {
+        auto status = rocksdb::StackableDB::SingleDelete(opts, cf, key);
+        if(status.ok()) {
+            auto lock = std::unique_lock<std::shared_mutex>(mutex_);
+            remove(cf->GetID(), key);
+        }
+        return status;
+    }
 
-    int should_record() { return !savepoints_.empty(); }
+    rocksdb::Status
+    Write(const rocksdb::WriteOptions& opts, rocksdb::WriteBatch* batch) override {
+        auto status = rocksdb::StackableDB::Write(opts, batch);
+        if(status.ok()) {
+            auto lock    = std::unique_lock<std::shared_mutex>(mutex_);
+            auto handler = batch_handler(*this);
+            batch->Iterate(&handler);
+        }
+        return status;
+    }
 
-    void record(uint8_t action_type, uint8_t op, uint8_t data_type, void* data);
-    void free_savepoint(internal::savepoint&);
-    void free_all_savepoints();
+    rocksdb::Status
+    IngestExternalFile(rocksdb::ColumnFamilyHandle* cf, const std::vector<std::string>& files, const rocksdb::IngestExternalFileOptions& opts) override {
+        auto status = rocksdb::StackableDB::IngestExternalFile(cf, files, opts);
 
-    void persist_savepoints() const;
-    void load_savepoints();
-    void persist_savepoints(std::ostream&) const;
-    void load_savepoints(std::istream&);
-    void flush() const;
+        auto lock = std::unique_lock<std::shared_mutex>(mutex_);
+        unload(cf->GetID());
+        return status;
+    }
 
-    std::string get_db_path() const { return config_.db_path.to_native_ansi_path(); }
+    rocksdb::Status
+    DropColumnFamily(rocksdb::ColumnFamilyHandle* cf) override {
+        auto id     = cf->GetID();
+        auto status = rocksdb::StackableDB::DropColumnFamily(cf);
+        if(status.ok()) {
+            auto lock = std::unique_lock<std::shared_mutex>(mutex_);
+            tables_.erase(id);
+        }
+        return status;
+    }
 
 public:
-    token_database&        self_;
-    token_database::config config_;
-
-    rocksdb::DB*          db_;
-    rocksdb::ReadOptions  read_opts_;
-    rocksdb::WriteOptions write_opts_;
-
-    rocksdb::ColumnFamilyHandle* tokens_handle_;
-    rocksdb::ColumnFamilyHandle* assets_handle_;
-
-    write_cache_layer assets_write_cache_;
-
-    fc::ring_vector<internal::savepoint> savepoints_;
-};
-
-token_database_impl::token_database_impl(token_database& self, const token_database::config& config)
-    : self_(self)
-    , config_(config)
-    , db_(nullptr)
-    , read_opts_()
-    , write_opts_()
-    , tokens_handle_(nullptr)
-    , assets_handle_(nullptr)
-    , savepoints_(internal::kDefaultSavePointsSize) {}
-
-void
-token_database_impl::open(int load_persistence) {
-    using namespace rocksdb;
-    using namespace internal;
+    // loads the table of column family if it's not loaded yet, returns false if it's not hashed
+    bool
+    load(rocksdb::ColumnFamilyHandle* cf) {
+        auto id = cf->GetID();
+        {
+            auto lock = std::shared_lock<std::shared_mutex>(mutex_);
+            if(auto it = tables_.find(id); it != tables_.end() && (it->second.loaded || it->second.skipped)) {
+                return it->second.loaded;
+            }
+        }
 
-    EVT_ASSERT(db_ == nullptr, token_database_exception, "Token database is already opened");
+        auto lock = std::unique_lock<std::shared_mutex>(mutex_);
+        auto& t   = tables_[id];
+        if(t.loaded || t.skipped) {
+            return t.loaded;
+        }
+        if(skipped_columns_.count(cf->GetName())) {
+            t.skipped = true;
+            return false;
+        }
 
-    auto options = Options();
-    options.OptimizeUniversalStyleCompaction();
+        auto opts = rocksdb::ReadOptions();
+        opts.total_order_seek = true;
+        opts.fill_cache       = false;
+
+        auto it = std::unique_ptr<rocksdb::Iterator>(GetBaseDB()->NewIterator(opts, cf));
+        for(it->SeekToFirst(); it->Valid(); it->Next()) {
+            auto key = it->key();
+            if(key.size() > hash_key::kMaxSize) {
+                clear(t);
+                t.skipped = true;
+                return false;
+            }
+            auto v = it->value();
+            t.values[make_hash_key(key)] = v.ToString();
+            t.bytes += v.size();
+        }
+        if(!it->status().ok()) {
+            clear(t);
+            EVT_THROW(token_database_rocksdb_exception, "Rocksdb internal error: ${err}", ("err", it->status().getState()));
+        }
 
-    options.create_if_missing               = true;
-    options.compression                     = CompressionType::kLZ4Compression;
-    options.bottommost_compression          = CompressionType::kZSTD;
-    options.allow_concurrent_memtable_write = false;
-    options.prefix_extractor.reset(NewFixedPrefixTransform(sizeof(name128)));
-    options.memtable_factory.reset(NewHashSkipListRepFactory());
-    if(config_.enable_stats) {
-        options.statistics = rocksdb::CreateDBStatistics();
-#if ROCKSDB_MAJOR >= 6
-        options.statistics->set_stats_level(StatsLevel::kExceptTimeForMutex);
-#else
-        options.statistics->stats_level_ = StatsLevel::kExceptTimeForMutex;
-#endif
+        t.loaded = true;
+        return true;
     }
 
-    auto assets_options = ColumnFamilyOptions(options);
-
-    if(config_.profile == storage_profile::disk) {
-        auto table_opts = BlockBasedTableOptions();
-
-        table_opts.index_type     = BlockBasedTableOptions::kHashSearch;
-        table_opts.checksum       = kxxHash64;
-        table_opts.format_version = 4;
-        table_opts.block_cache    = NewLRUCache(config_.block_cache_size);
-        table_opts.filter_policy.reset(NewBloomFilterPolicy(10, false));
+    // approximate bytes of the buckets and values of tables
+    size_t
+    memory_usage() const {
+        auto lock = std::shared_lock<std::shared_mutex>(mutex_);
 
-        options.table_factory.reset(NewBlockBasedTableFactory(table_opts));
-        assets_options.prefix_extractor.reset(NewFixedPrefixTransform(kSymbolIdSize));
+        auto sz = size_t(0);
+        for(auto& it : tables_) {
+            sz += it.second.bytes + it.second.values.bucket_count() * sizeof(hash_values_t::value_type);
+        }
+        return sz;
     }
-    else if(config_.profile == storage_profile::memory) {
-        auto tokens_table_options = PlainTableOptions();
-        auto assets_table_options = PlainTableOptions();
-        tokens_table_options.user_key_len = sizeof(name128) + sizeof(name128);
-        assets_table_options.user_key_len = kPublicKeySize + kSymbolIdSize;
 
-        options.table_factory.reset(NewPlainTableFactory(tokens_table_options));
-        assets_options.table_factory.reset(NewPlainTableFactory(assets_table_options));
-        assets_options.prefix_extractor.reset(NewFixedPrefixTransform(kSymbolIdSize));
-    }
-    else {
-        EVT_THROW(token_database_exception, "Unknown token database profile");
-    }
+private:
+    struct table {
+        table() {
+            values.set_empty_key(make_filled_hash_key('\xff'));
+            values.set_deleted_key(make_filled_hash_key('\xfe'));
+        }
 
-    read_opts_.total_order_seek     = false;
-    read_opts_.prefix_same_as_start = true;
-    read_opts_.tailing              = true;
+        hash_values_t values;
+        size_t        bytes   = 0;  // bytes of values
+        bool          loaded  = false;
+        bool          skipped = false;  // column family is not hashed
+    };
 
-    auto columns = std::vector<ColumnFamilyDescriptor>();
-    auto handles = std::vector<ColumnFamilyHandle*>();
-    columns.emplace_back(kDefaultColumnFamilyName, options);
+    struct batch_handler : public rocksdb::WriteBatch::Handler {
+        batch_handler(hash_memory_db& db) : db(db) {}
 
-    if(!fc::exists(config_.db_path)) {
-        auto t = config_.db_path.to_native_ansi_path();
-        // create new database and open
-        fc::create_directories(config_.db_path);
-        
-        auto status  = DB::Open(options, config_.db_path.to_native_ansi_path(), columns, &handles, &db_);
-        if(!status.ok()) {
-            EVT_THROW(token_database_rocksdb_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+        rocksdb::Status
+        PutCF(uint32_t id, const rocksdb::Slice& key, const rocksdb::Slice& value) override {
+            db.put(id, key, value);
+            return rocksdb::Status::OK();
         }
 
-        assert(handles.size() == 1);
-        tokens_handle_ = handles[0];
+        rocksdb::Status
+        DeleteCF(uint32_t id, const rocksdb::Slice& key) override {
+            db.remove(id, key);
+            return rocksdb::Status::OK();
+        }
 
-        status = db_->CreateColumnFamily(assets_options, kAssetsColumnFamilyName, &assets_handle_);
-        if(!status.ok()) {
-            EVT_THROW(token_database_rocksdb_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+        rocksdb::Status
+        SingleDeleteCF(uint32_t id, const rocksdb::Slice& key) override {
+            db.remove(id, key);
+            return rocksdb::Status::OK();
         }
 
-        if(load_persistence) {
-            load_savepoints();
+        rocksdb::Status
+        DeleteRangeCF(uint32_t id, const rocksdb::Slice&, const rocksdb::Slice&) override {
+            db.unload(id);
+            return rocksdb::Status::OK();
         }
-        return;
-    }
 
-    columns.emplace_back(kAssetsColumnFamilyName, assets_options);
+        rocksdb::Status
+        MergeCF(uint32_t id, const rocksdb::Slice&, const rocksdb::Slice&) override {
+            db.unload(id);
+            return rocksdb::Status::OK();
+        }
 
-    auto status = DB::Open(options, config_.db_path.to_native_ansi_path(), columns, &handles, &db_);
-    if(!status.ok()) {
-        EVT_THROW(token_database_rocksdb_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
-    }
+        void LogData(const rocksdb::Slice&) override {}
 
-    assert(handles.size() == 2);
-    tokens_handle_ = handles[0];
-    assets_handle_ = handles[1];
+        hash_memory_db& db;
+    };
 
-    if(load_persistence) {
-        load_savepoints();
+private:
+    // following ones should be invoked with lock held
+
+    const table*
+    loaded_table(uint32_t id) const {
+        auto it = tables_.find(id);
+        return (it != tables_.end() && it->second.loaded) ? &it->second : nullptr;
     }
-}
 
-void
-token_database_impl::close(int persist) {
-    if(db_) {
-        if(persist) {
-            persist_savepoints();
+    // writes into the tables not loaded are skipped, they're read from db when loading
+    void
+    put(uint32_t id, const rocksdb::Slice& key, const rocksdb::Slice& value) {
+        auto it = tables_.find(id);
+        if(it == tables_.end() || !it->second.loaded) {
+            return;
         }
-        if(!savepoints_.empty()) {
-            free_all_savepoints();
+        auto& t = it->second;
+        if(key.size() > hash_key::kMaxSize) {
+            clear(t);
+            t.skipped = true;
+            return;
         }
-        
-        delete tokens_handle_;
-        delete assets_handle_;
-        delete db_;
-
-        db_ = nullptr;
-    }
-}
-
-void
-token_database_impl::put_token(token_type type, action_op op, const name128& prefix, const name128& key, const std::string_view& data) {
-    using namespace internal;
 
-    auto dbkey  = db_token_key(prefix, key);
-    auto status = db_->Put(write_opts_, dbkey.as_slice(), data);
-    if(!status.ok()) {
-        FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+        auto& v = t.values[make_hash_key(key)];
+        t.bytes = t.bytes - v.size() + value.size();
+        v.assign(value.data(), value.size());
     }
-    if(should_record()) {
-        void* data;
 
-        // for `token` action, needs to record both prefix and key, prefix refers to the domain
-        // for `non-token` action, prefix is not necessary which can be inferred by the `type`
-        if(type != token_type::token) {
-            assert(prefix == action_key_prefixes[(int)type]);
-            auto data = (rt_token_key*)malloc(sizeof(rt_token_key));
-            data->key = key;
-
-            record((int)type, (int)op, (int)kTokenKey, data);
+    void
+    remove(uint32_t id, const rocksdb::Slice& key) {
+        auto it = tables_.find(id);
+        if(it == tables_.end() || !it->second.loaded || key.size() > hash_key::kMaxSize) {
+            return;
         }
-        else {
-            auto data    = (rt_token_fullkey*)malloc(sizeof(rt_token_fullkey));
-            data->prefix = prefix;
-            data->key    = key;
-
-            record((int)type, (int)op, (int)kTokenFullKey, data);
+        auto& t = it->second;
+        if(auto vit = t.values.find(make_hash_key(key)); vit != t.values.end()) {
+            t.bytes -= vit->second.size();
+            t.values.erase(vit);
         }
     }
-}
-
-void
-token_database_impl::put_tokens(token_type type,
-                                action_op op,
-                                const name128& prefix,
-                                token_keys_t&& keys,
-                                const small_vector_base<std::string_view>& data){
-    using namespace internal;
-    assert(keys.size() == data.size());
 
-    for(auto i = 0u; i < keys.size(); i++) {
-        auto dbkey  = db_token_key(prefix, keys[i]);
-        auto status = db_->Put(write_opts_, dbkey.as_slice(), data[i]);
-        if(!status.ok()) {
-            FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+    void
+    unload(uint32_t id) {
+        if(auto it = tables_.find(id); it != tables_.end() && it->second.loaded) {
+            clear(it->second);
         }
     }
-    if(should_record()) {
-        auto data = (rt_token_keys*)malloc(sizeof(rt_token_keys));
-        data->prefix = prefix;
-        new(&data->keys) token_keys_t(std::move(keys));
 
-        record((int)type, (int)op, (int)kTokenKeys, data);
+    static void
+    clear(table& t) {
+        t.values.clear();
+        t.values.resize(0);  // release buckets
+        t.bytes  = 0;
+        t.loaded = false;
     }
-}
 
-void
-token_database_impl::put_asset(const address& addr, const symbol_id_type sym_id, const std::string_view& data) {
-    using namespace internal;
+private:
+    std::set<std::string>     skipped_columns_;
+    std::map<uint32_t, table> tables_;  // keyed by id of column family
+    mutable std::shared_mutex mutex_;   // tables may be read by prefetching threads
+};
 
-    auto dbkey = db_asset_key(addr, sym_id);
-    if(should_record()) {
-        assets_write_cache_.put(dbkey.as_string_view(), data);
-        return;
-    }
-    else {
-        auto status = db_->Put(write_opts_, assets_handle_, dbkey.as_slice(), data);
-        if(!status.ok()) {
-            FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
-        }
-    }
-}
+}  // namespace internal
 
-int
-token_database_impl::exists_token(const name128& prefix, const name128& key) const {
-    using namespace internal;
+class write_cache_layer : boost::noncopyable {
+private:
+    struct cache_entry {
+    public:
+        cache_entry(int32_t used_count, std::string&& value)
+            : used_count(used_count)
+            , value(std::move(value)) {}
 
-    auto dbkey  = db_token_key(prefix, key);
-    auto value  = std::string();
-    auto status = db_->Get(read_opts_, dbkey.as_slice(), &value);
+    public:
+        int32_t     used_count;
+        std::string value;
+    };
+
+    using data_map_t = llvm::StringMap<cache_entry>;
+
+    struct data_op {
+    public:
+        data_op(data_map_t::iterator& it, std::string&& pv)
+            : it(&(*it)), pv(std::move(pv)) {}
+
+    public:
+        data_map_t::value_type* it;
+        std::string             pv;
+    };
+
+    struct data_ops {
+        int64_t              seq;
+        std::vector<data_op> vec;
+    };
+
+public:
+    write_cache_layer() : ops_(internal::kDefaultSavePointsSize) {}
+
+public:
+    void put(const std::string_view& key, const std::string_view& value);
+    int read(const std::string_view& key, std::string& value) const;
+    int exists(const std::string_view& key) const;
+
+    const std::string* lookup(const std::string_view& key) const;
+
+public:
+    void add_savepoint(int64_t seq);
+    void rollback_to_latest_savepoint(std::function<void(const llvm::StringRef&)> rollback_func = nullptr);
+    void squash();
+    void pop_front(std::function<void(const llvm::StringRef&, std::string&&)> persist_func);
+    void pop_back();
+
+    void clear();
+    void persist_savepoints(std::ostream& os) const;
+    void load_savepoints(std::istream& is);
+
+    size_t memory_usage() const;  // approximate bytes of entries and previous values
+
+    // copies entries as they were when savepoints after `until` were not made yet
+    void copy_until(int64_t until, std::map<std::string, std::string>& out) const;
+
+private:
+    data_map_t                data_;
+    fc::ring_vector<data_ops> ops_;
+
+private:
+    friend class token_database_impl;
+};
+
+void
+write_cache_layer::put(const std::string_view& key, const std::string_view& value) {
+    assert(!ops_.empty());
+
+    auto pair = data_.try_emplace(llvm::StringRef(key.data(), key.size()), 1, std::string(value.data(), value.size()));
+    if(!pair.second) {
+        auto pv = std::move(pair.first->second.value);
+        pair.first->second.used_count += 1;
+        pair.first->second.value       = std::string(value.data(), value.size());
+        ops_.back().vec.emplace_back(data_op(pair.first, std::move(pv)));
+        return;
+    }
+    ops_.back().vec.emplace_back(data_op(pair.first, std::string()));
+}
+
+int
+write_cache_layer::read(const std::string_view& key, std::string& value) const {
+    auto it = data_.find(llvm::StringRef(key.data(), key.size()));
+    if(it == data_.end()) {
+        return 0;
+    }
+    value = it->second.value;
+    return 1;
+}
+
+int
+write_cache_layer::exists(const std::string_view& key) const {
+    return data_.find(llvm::StringRef(key.data(), key.size())) != data_.end();
+}
+
+const std::string*
+write_cache_layer::lookup(const std::string_view& key) const {
+    auto it = data_.find(llvm::StringRef(key.data(), key.size()));
+    if(it == data_.end()) {
+        return nullptr;
+    }
+    return &it->second.value;
+}
+
+void
+write_cache_layer::add_savepoint(int64_t seq) {
+    ops_.push_back(data_ops{ .seq = seq, .vec = {} });
+}
+
+void
+write_cache_layer::rollback_to_latest_savepoint(std::function<void(const llvm::StringRef&)> rollback_func) {
+    auto& ops = ops_.back();
+    for(auto it = ops.vec.rbegin(); it != ops.vec.rend(); it++) {
+        auto& op = *it;
+        if(rollback_func) {
+            rollback_func(op.it->first());
+        }
+        if(--op.it->second.used_count == 0) {
+            data_.erase(op.it->first());
+        }
+        else {
+            assert(!op.it->second.value.empty());
+            op.it->second.value = std::move(op.pv);
+        }
+    }
+    ops_.pop_back();
+}
+
+void
+write_cache_layer::squash() {
+    assert(ops_.size() >= 2);
+    auto& b1 = ops_[ops_.size() - 1];
+    auto& b2 = ops_[ops_.size() - 2];
+
+    b2.vec.insert(b2.vec.end(), b1.vec.begin(), b1.vec.end());
+    ops_.pop_back();
+}
+
+void
+write_cache_layer::copy_until(int64_t until, std::map<std::string, std::string>& out) const {
+    for(auto& it : data_) {
+        out.emplace(it.first().str(), it.second.value);
+    }
+
+    // undo the ops in newer savepoints from back to front, empty previous value means the key is added by that op
+    for(auto i = ops_.size(); i > 0 && ops_[i - 1].seq > until; i--) {
+        auto& ops = ops_[i - 1];
+        for(auto it = ops.vec.rbegin(); it != ops.vec.rend(); it++) {
+            if(it->pv.empty()) {
+                out.erase(it->it->first().str());
+            }
+            else {
+                out[it->it->first().str()] = it->pv;
+            }
+        }
+    }
+}
+
+void
+write_cache_layer::pop_front(std::function<void(const llvm::StringRef&, std::string&&)> persist_func) {
+    for(auto& op : ops_.front().vec) {
+        if(--op.it->second.used_count == 0) {
+            persist_func(op.it->first(), std::move(op.it->second.value));
+            data_.erase(op.it->first());
+        }
+    }
+
+    ops_.pop_front();
+}
+
+void
+write_cache_layer::pop_back() {
+    ops_.pop_back();
+}
+
+namespace internal {
+
+struct wc_entry {
+    std::string k;
+    std::string v;
+};
+
+struct wc_entry_pack {
+    int64_t               seq;
+    std::vector<wc_entry> vec;
+};
+
+}  // namespace internal
+
+void
+write_cache_layer::clear() {
+    data_.clear();
+    ops_.clear();
+}
+
+size_t
+write_cache_layer::memory_usage() const {
+    auto bytes = size_t(0);
+    for(auto& e : data_) {
+        bytes += sizeof(e) + e.getKeyLength() + e.second.value.capacity();
+    }
+    for(auto i = 0; i < ops_.size(); i++) {
+        for(auto& op : ops_[i].vec) {
+            bytes += sizeof(op) + op.pv.capacity();
+        }
+    }
+    return bytes;
+}
+
+void
+write_cache_layer::persist_savepoints(std::ostream& os) const {
+    using namespace internal;
+
+    auto pack = std::vector<wc_entry_pack>();
+    pack.resize(ops_.size());
+    for(auto i = 0; i < ops_.size(); i++) {
+        auto& ops = ops_[i];
+        
+        auto& epack = pack[i];
+        epack.seq   = ops.seq;
+        for(auto& op : ops.vec) {
+            epack.vec.emplace_back(wc_entry {
+                .k  = op.it->first().str(),
+                .v  = op.it->second.value
+            });
+        }
+    }
+    fc::raw::pack(os, pack);
+}
+
+void
+write_cache_layer::load_savepoints(std::istream& is) {
+    using namespace internal;
+
+    auto pack = std::vector<wc_entry_pack>();
+    fc::raw::unpack(is, pack);
+
+    for(auto& ops : pack) {
+        this->add_savepoint(ops.seq);
+        for(auto& op : ops.vec) {
+            this->put(op.k, op.v);
+        }
+    }
+}
+
+class token_database_impl : boost::noncopyable {
+public:
+    token_database_impl(token_database& self, const token_database::config& config);
+
+public:
+    void open(int load_persistence = true);
+    void close(int persist = true);
+
+    void wrap_hash_db();
+    void load_hash_tables();
+    void write_format() const;
+    void check_format() const;
+
+public:
+    void put_token(token_type type, action_op op, const name128& prefix, const name128& key, const std::string_view& data);
+    void put_tokens(token_type type,
+                    action_op op,
+                    const name128& prefix,
+                    token_keys_t&& keys,
+                    const small_vector_base<std::string_view>& data);
+    void put_asset(const address& addr, const symbol_id_type sym_id, const std::string_view& data);
+
+    int exists_token(const name128& prefix, const name128& key) const;
+    int exists_asset(const address& addr, const symbol_id_type sym_id) const;
+
+    int read_token(const name128& prefix, const name128& key, std::string& out, bool no_throw = false) const;
+    int read_token(const name128& prefix, const name128& key, const read_view_func& func, bool no_throw = false) const;
+    int read_asset(const address& addr, const symbol_id_type sym_id, std::string& out, bool no_throw = false) const;
+
+    int read_tokens(const name128& prefix, const small_vector_base<name128>& keys, small_vector_base<std::string>& outs, bool no_throw = false) const;
+
+    int read_tokens_range(const name128& prefix, const std::optional<name128>& start, int skip, const read_value_func& func) const;
+    int read_tokens_by_owner(const address& addr, const std::optional<name128>& domain, const read_owner_func& func) const;
+    int read_assets_by_address(const address& addr, const read_asset_index_func& func) const;
+    int read_assets_range(const symbol_id_type sym_id, const std::optional<address>& start, int skip, const read_value_func& func) const;
+    int read_assets_range(const symbol_id_type sym_id, const std::string_view& start, const read_value_func& func) const;
+
+
+public:
+    void add_savepoint(int64_t seq);
+    void rollback_to_latest_savepoint();
+    void pop_savepoints(int64_t until);
+    void pop_back_savepoint();
+    void squash();
+
+    int64_t latest_savepoint_seq() const;
+    int64_t new_savepoint_session_seq() const;
+    size_t  savepoints_size() const { return savepoints_.size(); }
+
+    void rollback_rt_group(internal::rt_group*);
+    void rollback_pd_group(internal::pd_group*);
+
+    bool should_record() const { return !savepoints_.empty(); }
+
+    void record(uint8_t action_type, uint8_t op, uint8_t data_type, void* data);
+    void free_savepoint(internal::savepoint&);
+    void free_all_savepoints();
+    void spill_savepoints();
+    size_t savepoints_memory_usage() const;
+
+    internal::pd_group make_pd_group(const internal::savepoint&) const;
+
+    void load_savepoints();
+    void replay_journal(std::istream&);
+    void compact_journal();
+    void journal(uint8_t type, int64_t seq, const std::string_view& key = {}, const std::string_view& value = {});
+    void persist_savepoints(std::ostream&) const;
+    void load_savepoints(std::istream&);
+    void flush() const;
+    void set_fast_writes(bool enable);
+    void catch_up_with_primary();
+
+    void create_checkpoint(const fc::path& dir) const;
+    void restore_checkpoint(const fc::path& dir);
+
+    void ingest(rocksdb::ColumnFamilyHandle* handle, const std::string_view& prefix, const bulk_entries_t& entries);
+
+    bool should_batch() const { return config_.enable_batch && !savepoints_.empty(); }
+    bool has_batch() const { return batch_.GetWriteBatch()->Count() > 0; }
+    void write_batch() const;
+
+    // iterator of owner index which also sees the pending writes in batch, nothing is written by reads
+    std::unique_ptr<rocksdb::Iterator> new_owners_iterator() const;
+
+    rocksdb::Status get_token_value(const rocksdb::Slice& key, std::string* value) const;
+
+    int scan_with_write_cache(const write_cache_layer& cache,
+                              rocksdb::ColumnFamilyHandle* handle,
+                              const rocksdb::Slice& prefix,
+                              const rocksdb::Slice& seek,
+                              int skip,
+                              const read_value_func& func) const;
+
+    void update_owners_index(const name128& domain, const name128& name, action_op op, const std::string_view& data);
+    void put_owner_key(const address& addr, const name128& domain, const name128& name, bool add);
+    void build_owners_index();
+    void build_asset_index();
+    void build_expiry_index();
+
+    int  read_expiry_range(token_type type, const fc::time_point_sec& until, const read_expiry_func& func) const;
+    void update_expiry_index(token_type type, const name128& name, action_op op, const std::string_view& data);
+
+    fc::sha256 state_digest() const;
+    fc::sha256 build_state_digest() const;
+    void update_state_digest(bool asset, const std::string_view& key, const std::string_view& data);
+    void reset_state_digest();
+
+    void                           add_asset_aggregate(const symbol_id_type sym_id, int64_t threshold);
+    std::optional<asset_aggregate> read_asset_aggregate(const symbol_id_type sym_id, int64_t threshold) const;
+    asset_aggregate                build_asset_aggregate(const symbol_id_type sym_id, int64_t threshold) const;
+    void                           update_asset_aggregates(const symbol_id_type sym_id, const std::string_view& key, const std::string_view& data);
+    void                           rebuild_asset_aggregates();
+
+    rocksdb::ColumnFamilyHandle*
+    get_handle(int type) const {
+        switch(type) {
+        case (int)token_type::asset:   return assets_handle_;
+        case internal::kOwnerIndexType: return owners_handle_;
+        default:                       return type_handles_[type];
+        }
+    }
+
+    // column family of the tokens with `prefix`, which is the first part of the key
+    rocksdb::ColumnFamilyHandle*
+    get_tokens_handle(const char* prefix) const {
+        if(config_.columns.empty()) {
+            return tokens_handle_;
+        }
+        for(auto i = 0u; i < sizeof(internal::action_key_prefixes) / sizeof(name128); i++) {
+            if(memcmp(prefix, &internal::action_key_prefixes[i], sizeof(name128)) == 0) {
+                return type_handles_[i];
+            }
+        }
+        return type_handles_[(int)token_type::token];
+    }
+
+    void move_type_column(int type, rocksdb::ColumnFamilyHandle* from, rocksdb::ColumnFamilyHandle* to);
+
+    rocksdb::Status get_token_value(const rocksdb::Slice& key, rocksdb::PinnableSlice* value) const;
+
+    std::string get_db_path() const { return config_.db_path.to_native_ansi_path(); }
+
+    internal::type_stats*
+    get_stats(token_type type) const {
+        return config_.enable_stats ? &stats_[(int)type] : nullptr;
+    }
+    token_database_metrics get_metrics() const;
+    token_database_memory_usage get_memory_usage() const;
+
+public:
+    token_database&        self_;
+    token_database::config config_;
+
+    rocksdb::DB*               db_;
+    internal::hash_memory_db*  hash_db_;  // same as `db_` in hash profile, otherwise nullptr
+    rocksdb::ReadOptions       read_opts_;
+    rocksdb::WriteOptions write_opts_;
+
+    rocksdb::ColumnFamilyHandle* tokens_handle_;
+    rocksdb::ColumnFamilyHandle* assets_handle_;
+    rocksdb::ColumnFamilyHandle* owners_handle_;  // only available when owner index is enabled
+
+    // column families of token types, they refer to `tokens_handle_` unless configured in `columns`
+    std::array<rocksdb::ColumnFamilyHandle*, (int)token_type::max_value + 1> type_handles_;
+
+    std::shared_ptr<rocksdb::Statistics>                                 statistics_;
+    std::vector<std::shared_ptr<rocksdb::Cache>>                         block_caches_;  // distinct ones used by column families
+    mutable std::array<internal::type_stats, (int)token_type::max_value + 1> stats_;
+
+    // reversible writes of tokens and assets are kept in memory until they're irreversible
+    write_cache_layer tokens_write_cache_;
+    write_cache_layer assets_write_cache_;
+
+    // digest of tokens and assets, built by one scan at the first query and then maintained incrementally in writes.
+    // the digest when each savepoint is added is kept and restored when it's rolled back, it's empty for the
+    // savepoints loaded from disk, so rolling back them drops the digest and it's built again later
+    struct digest_entry {
+        int64_t                   seq;
+        std::optional<fc::sha256> digest;
+    };
+
+    mutable std::optional<fc::sha256> digest_;
+    std::deque<digest_entry>          digest_entries_;
+    mutable std::atomic<bool>         digest_stale_;  // set by ingestion which may run in several threads
+
+    // aggregates of asset holders registered by `add_asset_aggregate`, keyed by symbol id and threshold.
+    // they're maintained in writes of assets and kept with savepoints like the digest above, the ones of savepoints
+    // loaded from disk are empty, so rolling back them builds all the registered aggregates again
+    using asset_aggregates_t = std::map<std::pair<symbol_id_type, int64_t>, asset_aggregate>;
+    struct aggregates_entry {
+        int64_t                           seq;
+        std::optional<asset_aggregates_t> aggregates;
+    };
+
+    asset_aggregates_t           aggregates_;
+    std::deque<aggregates_entry> aggregates_entries_;
+
+    // pending writes of owner index in the latest savepoint
+    // they're written into db in one batch when the savepoint is squashed or a new savepoint is added
+    mutable rocksdb::WriteBatchWithIndex batch_;
+
+    fc::ring_vector<internal::savepoint> savepoints_;
+    uint32_t                             runtime_savepoints_;  // savepoints holding snapshots of db
+
+    // changes of savepoints are appended into journal, it's replayed when opening.
+    // records are flushed to os when savepoints are added or popped but not synced, so journal survives the crash
+    // of process but not the one of os, as neither does db written without sync
+    mutable std::ofstream journal_;
+    size_t                journal_size_;
+    bool                  replaying_;  // journal is being replayed, writes of owner index are already in db
+
+    std::atomic<uint32_t> ingest_seq_;
+};
+
+token_database_impl::token_database_impl(token_database& self, const token_database::config& config)
+    : self_(self)
+    , config_(config)
+    , db_(nullptr)
+    , hash_db_(nullptr)
+    , read_opts_()
+    , write_opts_()
+    , tokens_handle_(nullptr)
+    , assets_handle_(nullptr)
+    , owners_handle_(nullptr)
+    , batch_(rocksdb::BytewiseComparator(), 0 /* reserved_bytes */, true /* overwrite_key */)
+    , savepoints_(internal::kDefaultSavePointsSize)
+    , runtime_savepoints_(0)
+    , journal_size_(0)
+    , replaying_(false)
+    , ingest_seq_(0)
+    , digest_stale_(false) {}
+
+void
+token_database_impl::open(int load_persistence) {
+    using namespace rocksdb;
+    using namespace internal;
+
+    EVT_ASSERT(db_ == nullptr, token_database_exception, "Token database is already opened");
+
+    auto options = Options();
+    options.OptimizeUniversalStyleCompaction();
+
+    options.create_if_missing               = true;
+    options.compression                     = CompressionType::kLZ4Compression;
+    options.bottommost_compression          = CompressionType::kZSTD;
+    options.allow_concurrent_memtable_write = false;
+    options.prefix_extractor.reset(NewFixedPrefixTransform(sizeof(name128)));
+    options.memtable_factory.reset(NewHashSkipListRepFactory());
+    if(config_.wal_ttl > 0) {
+        // obsolete wal files are moved into archive instead of deleted
+        options.WAL_ttl_seconds = config_.wal_ttl;
+    }
+    if(config_.enable_stats) {
+        options.statistics = rocksdb::CreateDBStatistics();
+#if ROCKSDB_MAJOR >= 6
+        options.statistics->set_stats_level(StatsLevel::kExceptTimeForMutex);
+#else
+        options.statistics->stats_level_ = StatsLevel::kExceptTimeForMutex;
+#endif
+        statistics_ = options.statistics;
+    }
+
+    auto assets_options = ColumnFamilyOptions(options);
+
+    auto types_options = std::array<std::optional<ColumnFamilyOptions>, (int)token_type::max_value + 1>();
+
+    // tables on disk are the checkpoints of hash tables in `hash` profile, they're only read by range reads
+    if(config_.profile == storage_profile::disk || config_.profile == storage_profile::hash) {
+        auto table_opts = BlockBasedTableOptions();
+
+        auto high_pri = std::any_of(config_.columns.cbegin(), config_.columns.cend(), [](auto& c) { return c.high_priority; });
+
+        table_opts.index_type     = BlockBasedTableOptions::kHashSearch;
+        table_opts.checksum       = kxxHash64;
+        table_opts.format_version = 4;
+        table_opts.block_cache    = NewLRUCache(config_.block_cache_size, -1, false, high_pri ? 0.2 : 0.0);
+        table_opts.filter_policy.reset(NewBloomFilterPolicy(10, false));
+        block_caches_ = { table_opts.block_cache };
+
+        if(config_.compressed_cache_size > 0) {
+#if ROCKSDB_MAJOR >= 8
+            // compressed block cache is replaced by the secondary cache of block cache
+            auto lru_opts = LRUCacheOptions(config_.block_cache_size, -1, false, high_pri ? 0.2 : 0.0);
+            lru_opts.secondary_cache = NewCompressedSecondaryCache(config_.compressed_cache_size);
+            table_opts.block_cache   = NewLRUCache(lru_opts);
+            block_caches_            = { table_opts.block_cache };
+#else
+            table_opts.block_cache_compressed = NewLRUCache(config_.compressed_cache_size);
+            block_caches_.emplace_back(table_opts.block_cache_compressed);
+#endif
+        }
+        if(config_.persistent_cache_size > 0) {
+#if ROCKSDB_MAJOR < 8
+            EVT_ASSERT(!config_.persistent_cache_path.empty(), token_database_exception, "Path of persistent cache is not set");
+            fc::create_directories(config_.persistent_cache_path);
+
+            auto pcache = std::shared_ptr<PersistentCache>();
+            auto status = NewPersistentCache(Env::Default(), config_.persistent_cache_path.to_native_ansi_path(),
+                config_.persistent_cache_size, nullptr /* log */, false /* optimized for nvm */, &pcache);
+            if(!status.ok()) {
+                EVT_THROW(token_database_rocksdb_exception, "Cannot open persistent cache: ${err}", ("err", status.ToString()));
+            }
+            table_opts.persistent_cache = pcache;
+#else
+            EVT_THROW(token_database_exception, "Persistent cache of token database is not supported by rocksdb 8 or later");
+#endif
+        }
+
+        options.table_factory.reset(NewBlockBasedTableFactory(table_opts));
+        assets_options.prefix_extractor.reset(NewFixedPrefixTransform(kSymbolIdSize));
+
+        for(auto& c : config_.columns) {
+            auto type_table_opts = table_opts;
+            type_table_opts.block_size = c.block_size;
+            type_table_opts.filter_policy.reset(NewBloomFilterPolicy(c.bloom_bits, false));
+            if(c.cache_size > 0) {
+                type_table_opts.block_cache = NewLRUCache(c.cache_size, -1, false, c.high_priority ? 0.2 : 0.0);
+                block_caches_.emplace_back(type_table_opts.block_cache);
+            }
+            if(c.high_priority) {
+                type_table_opts.cache_index_and_filter_blocks                   = true;
+                type_table_opts.cache_index_and_filter_blocks_with_high_priority = true;
+                type_table_opts.pin_l0_filter_and_index_blocks_in_cache         = true;
+            }
+
+            auto opts = ColumnFamilyOptions(options);
+            opts.table_factory.reset(NewBlockBasedTableFactory(type_table_opts));
+            types_options[(int)c.type] = opts;
+        }
+    }
+    else if(config_.profile == storage_profile::memory) {
+        auto tokens_table_options = PlainTableOptions();
+        auto assets_table_options = PlainTableOptions();
+        tokens_table_options.user_key_len = sizeof(name128) + sizeof(name128);
+        assets_table_options.user_key_len = kPublicKeySize + kSymbolIdSize;
+
+        options.table_factory.reset(NewPlainTableFactory(tokens_table_options));
+        assets_options.table_factory.reset(NewPlainTableFactory(assets_table_options));
+        assets_options.prefix_extractor.reset(NewFixedPrefixTransform(kSymbolIdSize));
+
+        // only compression can be tuned in memory profile, everything is in memory already
+        for(auto& c : config_.columns) {
+            types_options[(int)c.type] = ColumnFamilyOptions(options);
+        }
+    }
+    else {
+        EVT_THROW(token_database_exception, "Unknown token database profile");
+    }
+
+    for(auto& c : config_.columns) {
+        EVT_ASSERT(c.type != token_type::asset, token_database_exception, "Assets are always stored in their own column family");
+        types_options[(int)c.type]->compression = get_compression_type(c.compression);
+    }
+
+    // OPTIONS file of operators overrides the options above, except the ones the layout of keys relies on
+    if(!config_.options_file.empty()) {
+        auto db_opts  = DBOptions();
+        auto cf_descs = std::vector<ColumnFamilyDescriptor>();
+#if ROCKSDB_MAJOR >= 7
+        auto cfg_opts = ConfigOptions();
+        auto status   = LoadOptionsFromFile(cfg_opts, config_.options_file.to_native_ansi_path(), &db_opts, &cf_descs);
+#else
+        auto status   = LoadOptionsFromFile(config_.options_file.to_native_ansi_path(), Env::Default(), &db_opts, &cf_descs);
+#endif
+        EVT_ASSERT(status.ok(), token_database_exception, "Cannot load rocksdb options file: ${f}, ${err}",
+            ("f", config_.options_file.to_native_ansi_path())("err", status.ToString()));
+
+        auto stats = options.statistics;
+        auto ttl   = options.WAL_ttl_seconds;
+        static_cast<DBOptions&>(options) = db_opts;
+        options.create_if_missing = true;
+        options.statistics        = stats;
+        options.WAL_ttl_seconds   = ttl;
+
+        auto apply_column = [&](const std::string& name, ColumnFamilyOptions& target) {
+            auto it = std::find_if(cf_descs.cbegin(), cf_descs.cend(), [&](auto& d) { return d.name == name; });
+            if(it == cf_descs.cend()) {
+                return;
+            }
+            auto prefix = target.prefix_extractor;
+            target = it->options;
+            target.prefix_extractor = prefix;  // keys are read by their prefixes
+        };
+        apply_column(kDefaultColumnFamilyName, options);
+        apply_column(kAssetsColumnFamilyName, assets_options);
+        for(auto i = 0u; i < types_options.size(); i++) {
+            if(types_options[i].has_value()) {
+                apply_column(get_type_column_name(i), *types_options[i]);
+            }
+        }
+    }
+
+    if(config_.max_background_jobs > 0) {
+        options.max_background_jobs = config_.max_background_jobs;
+    }
+    if(config_.rate_limit > 0) {
+        options.rate_limiter.reset(NewGenericRateLimiter(config_.rate_limit));
+    }
+    if(config_.direct_io) {
+        // plain tables of memory profile are read by mmap
+        EVT_ASSERT(config_.profile != storage_profile::memory, token_database_exception, "Direct I/O cannot be used in memory profile");
+        options.use_direct_reads                       = true;
+        options.use_direct_io_for_flush_and_compaction = true;
+    }
+    if(config_.pipelined_write) {
+        options.enable_pipelined_write = true;
+    }
+
+    // owner index uses address as prefix
+    auto owners_options = ColumnFamilyOptions(options);
+    owners_options.prefix_extractor.reset(NewFixedPrefixTransform(kPublicKeySize));
+    if(config_.profile == storage_profile::memory) {
+        auto owners_table_options = PlainTableOptions();
+        owners_table_options.user_key_len = kOwnerKeySize;
+
+        owners_options.table_factory.reset(NewPlainTableFactory(owners_table_options));
+    }
+
+    read_opts_.total_order_seek     = false;
+    read_opts_.prefix_same_as_start = true;
+    read_opts_.tailing              = true;
+
+    auto columns = std::vector<ColumnFamilyDescriptor>();
+    auto handles = std::vector<ColumnFamilyHandle*>();
+    columns.emplace_back(kDefaultColumnFamilyName, options);
+
+    auto secondary = !config_.secondary_path.empty();
+    if(secondary) {
+        EVT_ASSERT(fc::exists(config_.db_path), token_database_exception, "Secondary instance can only open an existing token database");
+        EVT_ASSERT(config_.profile != storage_profile::hash, token_database_exception, "Secondary instance cannot be opened in hash profile");
+        // secondary instance requires all the table files being kept opened
+        options.max_open_files = -1;
+        // and doesn't support tailing iterators, the ones created after catching up see the new changes anyway
+        read_opts_.tailing = false;
+    }
+
+    if(!fc::exists(config_.db_path)) {
+        auto t = config_.db_path.to_native_ansi_path();
+        // create new database and open
+        fc::create_directories(config_.db_path);
+        write_format();
+        
+        auto status  = DB::Open(options, config_.db_path.to_native_ansi_path(), columns, &handles, &db_);
+        if(!status.ok()) {
+            EVT_THROW(token_database_rocksdb_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+        }
+        wrap_hash_db();
+
+        assert(handles.size() == 1);
+        tokens_handle_ = handles[0];
+
+        status = db_->CreateColumnFamily(assets_options, kAssetsColumnFamilyName, &assets_handle_);
+        if(!status.ok()) {
+            EVT_THROW(token_database_rocksdb_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+        }
+
+        if(config_.enable_owner_index) {
+            status = db_->CreateColumnFamily(owners_options, kOwnersColumnFamilyName, &owners_handle_);
+            if(!status.ok()) {
+                EVT_THROW(token_database_rocksdb_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+            }
+            build_asset_index();
+        }
+
+        type_handles_.fill(tokens_handle_);
+        for(auto i = 0u; i < types_options.size(); i++) {
+            if(!types_options[i].has_value()) {
+                continue;
+            }
+            status = db_->CreateColumnFamily(*types_options[i], get_type_column_name(i), &type_handles_[i]);
+            if(!status.ok()) {
+                EVT_THROW(token_database_rocksdb_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+            }
+        }
+
+        load_hash_tables();
+        if(load_persistence) {
+            load_savepoints();
+        }
+        compact_journal();
+        return;
+    }
+
+    check_format();
+
+    auto names  = std::vector<std::string>();
+    auto status = DB::ListColumnFamilies(options, config_.db_path.to_native_ansi_path(), &names);
+    if(!status.ok()) {
+        EVT_THROW(token_database_rocksdb_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+    }
+    auto has_column = [&names](const auto& name) {
+        return std::find(names.cbegin(), names.cend(), name) != names.cend();
+    };
+    auto has_owners = has_column(kOwnersColumnFamilyName);
+
+    columns.emplace_back(kAssetsColumnFamilyName, assets_options);
+    if(has_owners) {
+        columns.emplace_back(kOwnersColumnFamilyName, owners_options);
+    }
+
+    // open column families of token types, the ones not configured anymore are opened with default options
+    auto type_columns = small_vector<int, 4>();
+    for(auto i = 0u; i < types_options.size(); i++) {
+        if(has_column(get_type_column_name(i))) {
+            columns.emplace_back(get_type_column_name(i), types_options[i].has_value() ? *types_options[i] : ColumnFamilyOptions(options));
+            type_columns.emplace_back(i);
+        }
+    }
+
+    if(secondary) {
+#if ROCKSDB_MAJOR >= 6
+        fc::create_directories(config_.secondary_path);
+        status = DB::OpenAsSecondary(options, config_.db_path.to_native_ansi_path(), config_.secondary_path.to_native_ansi_path(),
+            columns, &handles, &db_);
+#else
+        EVT_THROW(token_database_exception, "Secondary instance of token database requires rocksdb 6 or later");
+#endif
+    }
+    else {
+        status = DB::Open(options, config_.db_path.to_native_ansi_path(), columns, &handles, &db_);
+    }
+    if(!status.ok()) {
+        EVT_THROW(token_database_rocksdb_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+    }
+    wrap_hash_db();
+
+    assert(handles.size() == columns.size());
+    tokens_handle_ = handles[0];
+    assets_handle_ = handles[1];
+
+    type_handles_.fill(tokens_handle_);
+    if(secondary) {
+        // column families cannot be changed by secondary instance, tokens are read where primary keeps them
+        for(auto i = 0u; i < type_columns.size(); i++) {
+            type_handles_[type_columns[i]] = handles[handles.size() - type_columns.size() + i];
+        }
+        if(has_owners) {
+            owners_handle_ = handles[2];
+        }
+        return;
+    }
+
+    for(auto i = 0u; i < type_columns.size(); i++) {
+        auto t = type_columns[i];
+        auto h = handles[handles.size() - type_columns.size() + i];
+        if(types_options[t].has_value()) {
+            type_handles_[t] = h;
+            continue;
+        }
+
+        // move tokens back into default column family and drop it
+        move_type_column(t, h, tokens_handle_);
+        status = db_->DropColumnFamily(h);
+        if(!status.ok()) {
+            EVT_THROW(token_database_rocksdb_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+        }
+        delete h;
+    }
+    for(auto i = 0u; i < types_options.size(); i++) {
+        if(!types_options[i].has_value() || type_handles_[i] != tokens_handle_) {
+            continue;
+        }
+
+        // newly configured, move existing tokens into it
+        status = db_->CreateColumnFamily(*types_options[i], get_type_column_name(i), &type_handles_[i]);
+        if(!status.ok()) {
+            EVT_THROW(token_database_rocksdb_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+        }
+        move_type_column(i, tokens_handle_, type_handles_[i]);
+    }
+
+    if(has_owners) {
+        owners_handle_ = handles[2];
+        if(!config_.enable_owner_index) {
+            // index will be stale if it's not maintained, drop it and rebuild when it's enabled again
+            status = db_->DropColumnFamily(owners_handle_);
+            if(!status.ok()) {
+                EVT_THROW(token_database_rocksdb_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+            }
+            delete owners_handle_;
+            owners_handle_ = nullptr;
+        }
+        else {
+            // indexes introduced after the owner index are backfilled once
+            auto has_marker = [this](const address& addr) {
+                auto marker = db_owner_key(addr, name128(), name128());
+                auto value  = std::string();
+                auto status = db_->Get(read_opts_, owners_handle_, marker.as_slice(), &value);
+                if(!status.ok() && !status.IsNotFound()) {
+                    EVT_THROW(token_database_rocksdb_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+                }
+                return status.ok();
+            };
+            if(!has_marker(get_asset_index_marker())) {
+                build_asset_index();
+            }
+            if(!has_marker(get_expiry_index_marker())) {
+                build_expiry_index();
+            }
+        }
+    }
+    else if(config_.enable_owner_index) {
+        status = db_->CreateColumnFamily(owners_options, kOwnersColumnFamilyName, &owners_handle_);
+        if(!status.ok()) {
+            EVT_THROW(token_database_rocksdb_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+        }
+        build_owners_index();
+    }
+
+    load_hash_tables();
+    if(load_persistence) {
+        load_savepoints();
+    }
+    compact_journal();
+}
+
+void
+token_database_impl::write_format() const {
+    using namespace internal;
+
+    auto filename = config_.db_path / config::token_database_format_filename;
+    auto fs       = std::ofstream(filename.to_native_ansi_path(), std::ios::out | std::ios::trunc);
+    fs << kFormatVersion;
+    fs.close();
+    EVT_ASSERT(fs.good(), token_database_exception, "Cannot write format file of token database: ${f}", ("f", filename.to_native_ansi_path()));
+}
+
+void
+token_database_impl::check_format() const {
+    using namespace internal;
+
+    auto filename = config_.db_path / config::token_database_format_filename;
+    auto version  = 1u;
+    if(fc::exists(filename)) {
+        auto fs = std::ifstream(filename.to_native_ansi_path());
+        fs >> version;
+        EVT_ASSERT(!fs.fail(), token_database_format_exception, "Invalid format file of token database: ${f}", ("f", filename.to_native_ansi_path()));
+    }
+
+    // values of older formats are unpacked wrongly by current definitions, like the metas count of domains read as flags
+    EVT_ASSERT(version == kFormatVersion, token_database_format_exception,
+        "Token database in ${d} is of format ${v} but format ${c} is required, replay the chain or restore it from a snapshot",
+        ("d", config_.db_path.to_native_ansi_path())("v", version)("c", kFormatVersion));
+}
+
+void
+token_database_impl::wrap_hash_db() {
+    if(config_.profile != storage_profile::hash) {
+        return;
+    }
+    // owner index is only read by ranges
+    hash_db_ = new internal::hash_memory_db(db_, { internal::kOwnersColumnFamilyName });
+    db_      = hash_db_;
+}
+
+void
+token_database_impl::load_hash_tables() {
+    if(hash_db_ == nullptr) {
+        return;
+    }
+    // loaded here rather than by the first reads, which are usually made when transactions are applied
+    hash_db_->load(tokens_handle_);
+    hash_db_->load(assets_handle_);
+    for(auto h : type_handles_) {
+        hash_db_->load(h);
+    }
+}
+
+void
+token_database_impl::close(int persist) {
+    if(db_) {
+        write_batch();
+
+        // all the changes are already in journal
+        journal_.close();
+        if(!persist && config_.secondary_path.empty()) {
+            fc::remove_all(config_.db_path / config::token_database_journal_filename);
+        }
+        if(!savepoints_.empty()) {
+            free_all_savepoints();
+        }
+        digest_.reset();
+        digest_entries_.clear();
+        aggregates_.clear();
+        aggregates_entries_.clear();
+        
+        for(auto h : type_handles_) {
+            if(h != tokens_handle_) {
+                delete h;
+            }
+        }
+        type_handles_.fill(nullptr);
+
+        delete tokens_handle_;
+        delete assets_handle_;
+        if(owners_handle_) {
+            delete owners_handle_;
+            owners_handle_ = nullptr;
+        }
+        delete db_;
+
+        db_      = nullptr;
+        hash_db_ = nullptr;
+    }
+}
+
+void
+token_database_impl::put_token(token_type type, action_op op, const name128& prefix, const name128& key, const std::string_view& data) {
+    using namespace internal;
+
+    if(type == token_type::token && owners_handle_) {
+        update_owners_index(prefix, key, op, data);
+    }
+    else if(has_expiry_index(type) && owners_handle_) {
+        update_expiry_index(type, key, op, data);
+    }
+
+    auto dbkey = db_token_key(prefix, key);
+    update_state_digest(false, dbkey.as_string_view(), data);
+    if(should_record()) {
+        tokens_write_cache_.put(dbkey.as_string_view(), data);
+        journal(kJournalPutToken, 0, dbkey.as_string_view(), data);
+        return;
+    }
+
+    auto status = db_->Put(write_opts_, get_handle((int)type), dbkey.as_slice(), data);
+    if(!status.ok()) {
+        FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+    }
+}
+
+void
+token_database_impl::put_tokens(token_type type,
+                                action_op op,
+                                const name128& prefix,
+                                token_keys_t&& keys,
+                                const small_vector_base<std::string_view>& data){
+    using namespace internal;
+    assert(keys.size() == data.size());
+
+    if(type == token_type::token && owners_handle_) {
+        for(auto i = 0u; i < keys.size(); i++) {
+            update_owners_index(prefix, keys[i], op, data[i]);
+        }
+    }
+    else if(has_expiry_index(type) && owners_handle_) {
+        for(auto i = 0u; i < keys.size(); i++) {
+            update_expiry_index(type, keys[i], op, data[i]);
+        }
+    }
+
+    if(digest_.has_value()) {
+        for(auto i = 0u; i < keys.size(); i++) {
+            update_state_digest(false, db_token_key(prefix, keys[i]).as_string_view(), data[i]);
+        }
+    }
+
+    if(should_record()) {
+        for(auto i = 0u; i < keys.size(); i++) {
+            auto dbkey = db_token_key(prefix, keys[i]);
+            tokens_write_cache_.put(dbkey.as_string_view(), data[i]);
+            journal(kJournalPutToken, 0, dbkey.as_string_view(), data[i]);
+        }
+        return;
+    }
+
+    // written in one batch and in the order of keys, which is cheaper for memtable than random order
+    auto idxs = small_vector<uint32_t, 4>(keys.size());
+    std::iota(idxs.begin(), idxs.end(), 0u);
+    std::sort(idxs.begin(), idxs.end(), [&](auto l, auto r) {
+        return memcmp(&keys[l], &keys[r], sizeof(name128)) < 0;
+    });
+
+    auto handle = get_handle((int)type);
+    auto batch  = rocksdb::WriteBatch();
+    for(auto i : idxs) {
+        auto dbkey = db_token_key(prefix, keys[i]);
+        batch.Put(handle, dbkey.as_slice(), data[i]);
+    }
+
+    auto status = db_->Write(write_opts_, &batch);
+    if(!status.ok()) {
+        FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+    }
+}
+
+void
+token_database_impl::put_asset(const address& addr, const symbol_id_type sym_id, const std::string_view& data) {
+    using namespace internal;
+
+    auto dbkey = db_asset_key(addr, sym_id);
+    if(owners_handle_ && !exists_asset(addr, sym_id)) {
+        // assets are never removed, only the first put adds the entry of asset index
+        put_owner_key(addr, kAssetIndexDomain, get_asset_index_slot(sym_id), true /* add */);
+    }
+    update_state_digest(true, dbkey.as_string_view(), data);
+    if(!aggregates_.empty()) {
+        update_asset_aggregates(sym_id, dbkey.as_string_view(), data);
+    }
+    if(should_record()) {
+        assets_write_cache_.put(dbkey.as_string_view(), data);
+        journal(kJournalPutAsset, 0, dbkey.as_string_view(), data);
+        return;
+    }
+    else {
+        auto status = db_->Put(write_opts_, assets_handle_, dbkey.as_slice(), data);
+        if(!status.ok()) {
+            FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+        }
+    }
+}
+
+int
+token_database_impl::exists_token(const name128& prefix, const name128& key) const {
+    using namespace internal;
+
+    auto dbkey  = db_token_key(prefix, key);
+    auto value  = std::string();
+    auto status = get_token_value(dbkey.as_slice(), &value);
+    return status.ok();
+}
+
+int
+token_database_impl::exists_asset(const address& addr, const symbol_id_type sym_id) const {
+    using namespace internal;
+
+    auto dbkey  = db_asset_key(addr, sym_id);
+    auto value  = std::string();
+
+    if(assets_write_cache_.exists(dbkey.as_string_view())) {
+        return true;
+    }
+    auto status = db_->Get(read_opts_, assets_handle_, dbkey.as_slice(), &value);
     return status.ok();
 }
 
-int
-token_database_impl::exists_asset(const address& addr, const symbol_id_type sym_id) const {
+int
+token_database_impl::read_token(const name128& prefix, const name128& key, std::string& out, bool no_throw) const {
+    using namespace internal;
+
+    auto dbkey  = db_token_key(prefix, key);
+    auto status = get_token_value(dbkey.as_slice(), &out);
+    if(!status.ok()) {
+        if(!status.IsNotFound()) {
+            FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+        }
+        if(!no_throw) {
+            EVT_THROW(unknown_token_database_key, "Cannot find key: ${k} with prefix: ${p}", ("k",key)("p",prefix));
+        }
+        return false;
+    }
+    return true;
+}
+
+int
+token_database_impl::read_token(const name128& prefix, const name128& key, const read_view_func& func, bool no_throw) const {
+    using namespace internal;
+
+    auto dbkey = db_token_key(prefix, key);
+    if(auto v = tokens_write_cache_.lookup(dbkey.as_string_view()); v != nullptr) {
+        func(*v);
+        return true;
+    }
+
+    auto value  = rocksdb::PinnableSlice();
+    auto status = get_token_value(dbkey.as_slice(), &value);
+    if(!status.ok()) {
+        if(!status.IsNotFound()) {
+            FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+        }
+        if(!no_throw) {
+            EVT_THROW(unknown_token_database_key, "Cannot find key: ${k} with prefix: ${p}", ("k",key)("p",prefix));
+        }
+        return false;
+    }
+
+    func(std::string_view(value.data(), value.size()));
+    return true;
+}
+
+int
+token_database_impl::read_asset(const address& addr, const symbol_id_type sym_id, std::string& out, bool no_throw) const {
+    using namespace internal;
+
+    auto key = db_asset_key(addr, sym_id);
+    if(assets_write_cache_.read(key.as_string_view(), out)) {
+        return true;
+    }
+
+    auto status = db_->Get(read_opts_, assets_handle_, key.as_slice(), &out);
+    if(!status.ok()) {
+        if(!status.IsNotFound()) {
+            FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+        }
+        if(!no_throw) {
+            EVT_THROW2(unknown_token_database_key, "There's no balance of fungible with sym id: {} in address: {}", sym_id, addr);
+        }
+        return false;
+    }
+    return true;
+}
+
+int
+token_database_impl::read_tokens(const name128& prefix, const small_vector_base<name128>& keys, small_vector_base<std::string>& outs, bool no_throw) const {
+    using namespace internal;
+
+    // `rt_token_fullkey` has the same layout as `db_token_key`
+    // and can be stored continuously which makes slices below stable
+    auto dbkeys  = small_vector<rt_token_fullkey, 4>();
+    auto slices  = std::vector<rocksdb::Slice>();
+    auto handles = std::vector<rocksdb::ColumnFamilyHandle*>(keys.size(), get_tokens_handle((const char*)&prefix));
+    dbkeys.reserve(keys.size());
+    slices.reserve(keys.size());
+
+    for(auto& k : keys) {
+        dbkeys.emplace_back(rt_token_fullkey { .prefix = prefix, .key = k });
+        slices.emplace_back((const char*)&dbkeys.back(), sizeof(rt_token_fullkey));
+    }
+
+    auto values   = std::vector<std::string>();
+    auto statuses = db_->MultiGet(read_opts_, handles, slices, &values);
+    assert(statuses.size() == keys.size() && values.size() == keys.size());
+
+    if(!tokens_write_cache_.data_.empty()) {
+        // reversible writes override the values in db
+        for(auto i = 0u; i < keys.size(); i++) {
+            auto v = tokens_write_cache_.lookup(slices[i].ToStringView());
+            if(v != nullptr) {
+                statuses[i] = rocksdb::Status::OK();
+                values[i]   = *v;
+            }
+        }
+    }
+
+    auto count = 0;
+    outs.resize(keys.size());
+    for(auto i = 0u; i < keys.size(); i++) {
+        auto& status = statuses[i];
+        if(!status.ok()) {
+            if(!status.IsNotFound()) {
+                FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+            }
+            if(!no_throw) {
+                EVT_THROW(unknown_token_database_key, "Cannot find key: ${k} with prefix: ${p}", ("k",keys[i])("p",prefix));
+            }
+            outs[i].clear();
+            continue;
+        }
+        outs[i] = std::move(values[i]);
+        count++;
+    }
+    return count;
+}
+
+int
+token_database_impl::read_tokens_range(const name128& prefix, const std::optional<name128>& start, int skip, const read_value_func& func) const {
+    using namespace internal;
+
+    auto ps = rocksdb::Slice((char*)&prefix, sizeof(prefix));
+    if(start.has_value()) {
+        auto key = db_token_key(prefix, *start);
+        return scan_with_write_cache(tokens_write_cache_, get_tokens_handle(ps.data()), ps, key.as_slice(), skip, func);
+    }
+    return scan_with_write_cache(tokens_write_cache_, get_tokens_handle(ps.data()), ps, ps, skip, func);
+}
+
+int
+token_database_impl::read_tokens_by_owner(const address& addr, const std::optional<name128>& domain, const read_owner_func& func) const {
+    using namespace internal;
+
+    EVT_ASSERT(owners_handle_ != nullptr, token_database_exception, "Owner index is not enabled");
+
+    auto prefix = std::string(kPublicKeySize, '\0');
+    addr.to_bytes(prefix.data(), kPublicKeySize);
+    if(domain.has_value()) {
+        prefix.append((const char*)&(*domain), sizeof(name128));
+    }
+
+    auto it    = new_owners_iterator();
+    auto count = 0;
+
+    it->Seek(prefix);
+    while(it->Valid() && it->key().starts_with(prefix)) {
+        assert(it->key().size() == kOwnerKeySize);
+
+        // we should use memcpy here because key may not be aligned
+        auto d = name128(), n = name128();
+        memcpy(&d, it->key().data() + kPublicKeySize, sizeof(name128));
+        memcpy(&n, it->key().data() + kPublicKeySize + sizeof(name128), sizeof(name128));
+        if(d == kAssetIndexDomain) {
+            // entries of asset index
+            it->Next();
+            continue;
+        }
+
+        count++;
+        if(!func(d, n)) {
+            break;
+        }
+        it->Next();
+    }
+    return count;
+}
+
+int
+token_database_impl::read_assets_by_address(const address& addr, const read_asset_index_func& func) const {
+    using namespace internal;
+
+    EVT_ASSERT(owners_handle_ != nullptr, token_database_exception, "Asset index is not enabled");
+
+    auto prefix = std::string(kPublicKeySize + sizeof(name128), '\0');
+    addr.to_bytes(prefix.data(), kPublicKeySize);
+    memcpy(prefix.data() + kPublicKeySize, &kAssetIndexDomain, sizeof(name128));
+
+    auto it    = new_owners_iterator();
+    auto count = 0;
+
+    it->Seek(prefix);
+    while(it->Valid() && it->key().starts_with(prefix)) {
+        assert(it->key().size() == kOwnerKeySize);
+
+        count++;
+        if(!func(get_sym_id_from_slot(it->key().data() + kPublicKeySize + sizeof(name128)))) {
+            break;
+        }
+        it->Next();
+    }
+    return count;
+}
+
+void
+token_database_impl::update_owners_index(const name128& domain, const name128& name, action_op op, const std::string_view& data) {
+    using namespace internal;
+    using contracts::token_def;
+
+    // only owners changed are updated
+    auto olds = contracts::address_list();
+    if(op != action_op::add) {
+        auto dbkey  = db_token_key(domain, name);
+        auto value  = rocksdb::PinnableSlice();
+        auto status = get_token_value(dbkey.as_slice(), &value);
+        if(status.ok()) {
+            auto token = token_def();
+            extract_db_value(std::string_view(value.data(), value.size()), token);
+            olds = std::move(token.owner);
+        }
+        else if(!status.IsNotFound()) {
+            FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+        }
+    }
+
+    auto token = token_def();
+    extract_db_value(data, token);
+
+    for(auto& o : olds) {
+        if(std::find(token.owner.cbegin(), token.owner.cend(), o) == token.owner.cend()) {
+            put_owner_key(o, domain, name, false /* add */);
+        }
+    }
+    for(auto& o : token.owner) {
+        if(std::find(olds.cbegin(), olds.cend(), o) == olds.cend()) {
+            put_owner_key(o, domain, name, true /* add */);
+        }
+    }
+}
+
+int
+token_database_impl::read_expiry_range(token_type type, const fc::time_point_sec& until, const read_expiry_func& func) const {
+    using namespace internal;
+
+    EVT_ASSERT(owners_handle_ != nullptr, token_database_exception, "Expiry index is not enabled");
+    EVT_ASSERT2(has_expiry_index(type), token_database_exception, "Type: {} has no expiry index", token_type_names[(int)type]);
+
+    auto prefix = std::string(kPublicKeySize, '\0');
+    get_expiry_index_address(type).to_bytes(prefix.data(), kPublicKeySize);
+
+    auto it    = new_owners_iterator();
+    auto count = 0;
+
+    it->Seek(prefix);
+    while(it->Valid() && it->key().starts_with(prefix)) {
+        assert(it->key().size() == kOwnerKeySize);
+
+        auto expiry = get_expiry_from_slot(it->key().data() + kPublicKeySize);
+        if(expiry > until) {
+            break;
+        }
+
+        auto n = name128();
+        memcpy(&n, it->key().data() + kPublicKeySize + sizeof(name128), sizeof(name128));
+
+        count++;
+        if(!func(expiry, n)) {
+            break;
+        }
+        it->Next();
+    }
+    return count;
+}
+
+void
+token_database_impl::update_expiry_index(token_type type, const name128& name, action_op op, const std::string_view& data) {
+    using namespace internal;
+
+    auto old = std::optional<fc::time_point_sec>();
+    if(op != action_op::add) {
+        auto dbkey  = db_token_key(action_key_prefixes[(int)type], name);
+        auto value  = rocksdb::PinnableSlice();
+        auto status = get_token_value(dbkey.as_slice(), &value);
+        if(status.ok()) {
+            old = get_expiry(type, std::string_view(value.data(), value.size()));
+        }
+        else if(!status.IsNotFound()) {
+            FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+        }
+    }
+
+    auto expiry = get_expiry(type, data);
+    if(old == expiry) {
+        return;
+    }
+
+    auto addr = get_expiry_index_address(type);
+    if(old.has_value()) {
+        put_owner_key(addr, get_expiry_index_slot(*old), name, false /* add */);
+    }
+    if(expiry.has_value()) {
+        put_owner_key(addr, get_expiry_index_slot(*expiry), name, true /* add */);
+    }
+}
+
+void
+token_database_impl::put_owner_key(const address& addr, const name128& domain, const name128& name, bool add) {
+    using namespace internal;
+
+    auto dbkey  = db_owner_key(addr, domain, name);
+    auto status = rocksdb::Status::OK();
+    if(should_record() && journal_.is_open()) {
+        // old value is required to rollback after restarting
+        auto old = std::string();
+        if(has_batch()) {
+            status = batch_.GetFromBatchAndDB(db_, read_opts_, owners_handle_, dbkey.as_slice(), &old);
+        }
+        else {
+            status = db_->Get(read_opts_, owners_handle_, dbkey.as_slice(), &old);
+        }
+        if(!status.ok() && !status.IsNotFound()) {
+            FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+        }
+        journal(kJournalPutOwner, 0, dbkey.as_string_view(), old);
+        status = rocksdb::Status::OK();
+    }
+
+    if(should_batch()) {
+        if(add) {
+            batch_.Put(owners_handle_, dbkey.as_slice(), kOwnerKeyValue);
+        }
+        else {
+            batch_.Delete(owners_handle_, dbkey.as_slice());
+        }
+    }
+    else {
+        if(add) {
+            status = db_->Put(write_opts_, owners_handle_, dbkey.as_slice(), kOwnerKeyValue);
+        }
+        else {
+            status = db_->Delete(write_opts_, owners_handle_, dbkey.as_slice());
+        }
+    }
+    if(!status.ok()) {
+        FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+    }
+
+    if(should_record()) {
+        // both insert and remove are recorded as `put`, old state is restored from snapshot when rollback
+        auto data = (rt_owner_key*)malloc(sizeof(rt_owner_key));
+        memcpy(data->key, dbkey.as_string_view().data(), sizeof(data->key));
+
+        record(kOwnerIndexType, (int)action_op::put, (int)kOwnerKey, data);
+    }
+}
+
+void
+token_database_impl::build_owners_index() {
+    using namespace internal;
+    using contracts::token_def;
+
+    assert(owners_handle_ != nullptr);
+    wlog("Building owner index in token database, it may take a while");
+
+    auto opts = read_opts_;
+    opts.total_order_seek     = true;
+    opts.prefix_same_as_start = false;
+    opts.tailing              = false;
+
+    auto reserved = std::unordered_set<std::string_view>();
+    for(auto& p : action_key_prefixes) {
+        reserved.emplace((const char*)&p, sizeof(p));
+    }
+
+    auto it    = std::unique_ptr<rocksdb::Iterator>(db_->NewIterator(opts, get_handle((int)token_type::token)));
+    auto batch = rocksdb::WriteBatch();
+
+    it->SeekToFirst();
+    while(it->Valid()) {
+        auto key = it->key();
+        if(key.size() != sizeof(name128) * 2 || reserved.find(std::string_view(key.data(), sizeof(name128))) != reserved.cend()) {
+            it->Next();
+            continue;
+        }
+
+        auto token = token_def();
+        extract_db_value(std::string_view(it->value().data(), it->value().size()), token);
+        for(auto& o : token.owner) {
+            auto dbkey = db_owner_key(o, token.domain, token.name);
+            batch.Put(owners_handle_, dbkey.as_slice(), kOwnerKeyValue);
+        }
+        it->Next();
+    }
+
+    auto status = db_->Write(write_opts_, &batch);
+    if(!status.ok()) {
+        FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+    }
+
+    build_asset_index();
+    build_expiry_index();
+}
+
+void
+token_database_impl::build_expiry_index() {
+    using namespace internal;
+
+    assert(owners_handle_ != nullptr);
+    wlog("Building expiry index in token database, it may take a while");
+
+    auto batch = rocksdb::WriteBatch();
+    for(auto type : { token_type::suspend, token_type::lock }) {
+        auto& prefix = action_key_prefixes[(int)type];
+        auto  addr   = get_expiry_index_address(type);
+
+        auto it = std::unique_ptr<rocksdb::Iterator>(db_->NewIterator(read_opts_, get_handle((int)type)));
+        it->Seek(rocksdb::Slice((const char*)&prefix, sizeof(prefix)));
+        while(it->Valid() && it->key().starts_with(rocksdb::Slice((const char*)&prefix, sizeof(prefix)))) {
+            auto expiry = get_expiry(type, std::string_view(it->value().data(), it->value().size()));
+            if(expiry.has_value()) {
+                auto name = name128();
+                memcpy(&name, it->key().data() + sizeof(name128), sizeof(name128));
+
+                auto dbkey = db_owner_key(addr, get_expiry_index_slot(*expiry), name);
+                batch.Put(owners_handle_, dbkey.as_slice(), kOwnerKeyValue);
+            }
+            it->Next();
+        }
+    }
+
+    auto marker = db_owner_key(get_expiry_index_marker(), name128(), name128());
+    batch.Put(owners_handle_, marker.as_slice(), kOwnerKeyValue);
+
+    auto status = db_->Write(write_opts_, &batch);
+    if(!status.ok()) {
+        FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+    }
+}
+
+void
+token_database_impl::build_asset_index() {
+    using namespace internal;
+
+    assert(owners_handle_ != nullptr);
+    wlog("Building asset index in token database, it may take a while");
+
+    auto opts = read_opts_;
+    opts.total_order_seek     = true;
+    opts.prefix_same_as_start = false;
+    opts.tailing              = false;
+
+    auto it    = std::unique_ptr<rocksdb::Iterator>(db_->NewIterator(opts, assets_handle_));
+    auto batch = rocksdb::WriteBatch();
+
+    it->SeekToFirst();
+    while(it->Valid()) {
+        batch.Put(owners_handle_, get_asset_index_key(it->key()), kOwnerKeyValue);
+        it->Next();
+    }
+
+    auto marker = db_owner_key(get_asset_index_marker(), name128(), name128());
+    batch.Put(owners_handle_, marker.as_slice(), kOwnerKeyValue);
+
+    auto status = db_->Write(write_opts_, &batch);
+    if(!status.ok()) {
+        FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+    }
+}
+
+void
+token_database_impl::move_type_column(int type, rocksdb::ColumnFamilyHandle* from, rocksdb::ColumnFamilyHandle* to) {
+    using namespace internal;
+
+    const int kMoveBatchSize = 10000;
+
+    wlog("Moving ${t} tokens in token database, it may take a while", ("t", token_type_names[type]));
+
+    auto opts   = read_opts_;
+    auto prefix = rocksdb::Slice((const char*)&action_key_prefixes[type], sizeof(name128));
+
+    // tokens are prefixed by their domains, so need to scan all and skip reserved ones
+    auto reserved = std::unordered_set<std::string_view>();
+    if(type == (int)token_type::token) {
+        for(auto& p : action_key_prefixes) {
+            reserved.emplace((const char*)&p, sizeof(p));
+        }
+        opts.total_order_seek     = true;
+        opts.prefix_same_as_start = false;
+    }
+
+    auto it    = std::unique_ptr<rocksdb::Iterator>(db_->NewIterator(opts, from));
+    auto batch = rocksdb::WriteBatch();
+    auto write = [&] {
+        auto status = db_->Write(write_opts_, &batch);
+        if(!status.ok()) {
+            FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+        }
+        batch.Clear();
+    };
+
+    if(type == (int)token_type::token) {
+        it->SeekToFirst();
+    }
+    else {
+        it->Seek(prefix);
+    }
+    while(it->Valid()) {
+        auto key = it->key();
+        if(type == (int)token_type::token) {
+            if(reserved.find(std::string_view(key.data(), sizeof(name128))) != reserved.cend()) {
+                it->Next();
+                continue;
+            }
+        }
+        else if(!key.starts_with(prefix)) {
+            break;
+        }
+
+        batch.Put(to, key, it->value());
+        batch.Delete(from, key);
+        if(batch.Count() >= kMoveBatchSize) {
+            write();
+        }
+        it->Next();
+    }
+    write();
+}
+
+namespace internal {
+
+enum digest_tag : char {
+    kDigestToken = 't',
+    kDigestAsset = 'a'
+};
+
+// entries are hashed into 256 bits and summed up lane by lane, the sum is a multiset hash
+// which doesn't depend on the order of writes and a removed entry is simply subtracted
+fc::sha256
+hash_digest_entry(digest_tag tag, const std::string_view& key, const std::string_view& value) {
+    auto enc = fc::sha256::encoder();
+    enc.write((const char*)&tag, sizeof(tag));
+    enc.write(key.data(), key.size());
+    enc.write(value.data(), value.size());
+    return enc.result();
+}
+
+void
+add_digest_entry(fc::sha256& digest, digest_tag tag, const std::string_view& key, const std::string_view& value) {
+    auto h = hash_digest_entry(tag, key, value);
+    for(auto i = 0; i < 4; i++) {
+        digest._hash[i] += h._hash[i];
+    }
+}
+
+void
+sub_digest_entry(fc::sha256& digest, digest_tag tag, const std::string_view& key, const std::string_view& value) {
+    auto h = hash_digest_entry(tag, key, value);
+    for(auto i = 0; i < 4; i++) {
+        digest._hash[i] -= h._hash[i];
+    }
+}
+
+}  // namespace internal
+
+fc::sha256
+token_database_impl::build_state_digest() const {
+    using namespace internal;
+
+    auto digest = fc::sha256();
+    auto scan   = [&](auto handle, auto tag) {
+        auto it = std::unique_ptr<rocksdb::Iterator>(db_->NewIterator(read_opts_, handle));
+        for(it->SeekToFirst(); it->Valid(); it->Next()) {
+            add_digest_entry(digest, tag, it->key().ToStringView(), it->value().ToStringView());
+        }
+        if(!it->status().ok()) {
+            FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", it->status().getState()));
+        }
+    };
+
+    auto handles = std::set<rocksdb::ColumnFamilyHandle*>(type_handles_.cbegin(), type_handles_.cend());
+    handles.emplace(tokens_handle_);
+    for(auto h : handles) {
+        scan(h, kDigestToken);
+    }
+    scan(assets_handle_, kDigestAsset);
+
+    // reversible values in write caches replace the ones in db
+    auto overlay = [&](auto& cache, auto tag, auto handle_of) {
+        auto value = std::string();
+        for(auto& e : cache.data_) {
+            auto key    = std::string_view(e.first().data(), e.first().size());
+            auto status = db_->Get(read_opts_, handle_of(key), rocksdb::Slice(key.data(), key.size()), &value);
+            if(status.ok()) {
+                sub_digest_entry(digest, tag, key, value);
+            }
+            else if(!status.IsNotFound()) {
+                FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+            }
+            add_digest_entry(digest, tag, key, e.second.value);
+        }
+    };
+    overlay(tokens_write_cache_, kDigestToken, [this](auto& k) { return get_tokens_handle(k.data()); });
+    overlay(assets_write_cache_, kDigestAsset, [this](auto&) { return assets_handle_; });
+
+    return digest;
+}
+
+void
+token_database_impl::update_state_digest(bool asset, const std::string_view& key, const std::string_view& data) {
+    using namespace internal;
+
+    if(!digest_.has_value()) {
+        return;
+    }
+
+    auto tag    = asset ? kDigestAsset : kDigestToken;
+    auto old    = std::string();
+    auto status = rocksdb::Status::OK();
+    if(asset) {
+        if(!assets_write_cache_.read(key, old)) {
+            status = db_->Get(read_opts_, assets_handle_, rocksdb::Slice(key.data(), key.size()), &old);
+        }
+    }
+    else {
+        status = get_token_value(rocksdb::Slice(key.data(), key.size()), &old);
+    }
+
+    if(status.ok()) {
+        sub_digest_entry(*digest_, tag, key, old);
+    }
+    else if(!status.IsNotFound()) {
+        FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+    }
+    add_digest_entry(*digest_, tag, key, data);
+}
+
+fc::sha256
+token_database_impl::state_digest() const {
+    if(digest_stale_.exchange(false)) {
+        digest_.reset();
+    }
+    if(!digest_.has_value()) {
+        digest_ = build_state_digest();
+    }
+    return *digest_;
+}
+
+void
+token_database_impl::reset_state_digest() {
+    digest_.reset();
+    for(auto& e : digest_entries_) {
+        e.digest.reset();
+    }
+}
+
+namespace internal {
+
+// amount is the first field of `property`
+int64_t
+get_asset_amount(const std::string_view& v) {
+    auto amount = int64_t();
+    auto ds     = fc::datastream<const char*>(v.data(), v.size());
+    fc::raw::unpack(ds, amount);
+    return amount;
+}
+
+bool
+is_aggregated(int64_t amount, int64_t threshold) {
+    return amount > 0 && amount >= threshold;
+}
+
+}  // namespace internal
+
+void
+token_database_impl::add_asset_aggregate(const symbol_id_type sym_id, int64_t threshold) {
+    EVT_ASSERT(config_.secondary_path.empty(), token_database_exception, "Secondary instance of token database is read-only");
+
+    auto key = std::make_pair(sym_id, threshold);
+    if(aggregates_.find(key) != aggregates_.cend()) {
+        return;
+    }
+    aggregates_.emplace(key, build_asset_aggregate(sym_id, threshold));
+}
+
+std::optional<asset_aggregate>
+token_database_impl::read_asset_aggregate(const symbol_id_type sym_id, int64_t threshold) const {
+    auto it = aggregates_.find(std::make_pair(sym_id, threshold));
+    if(it == aggregates_.cend()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+asset_aggregate
+token_database_impl::build_asset_aggregate(const symbol_id_type sym_id, int64_t threshold) const {
+    using namespace internal;
+
+    auto agg = asset_aggregate();
+    read_assets_range(sym_id, std::nullopt, 0, [&](auto& k, auto&& v) {
+        auto amount = get_asset_amount(v);
+        if(is_aggregated(amount, threshold)) {
+            agg.holders++;
+            agg.total += amount;
+        }
+        return true;
+    });
+    return agg;
+}
+
+void
+token_database_impl::update_asset_aggregates(const symbol_id_type sym_id, const std::string_view& key, const std::string_view& data) {
+    using namespace internal;
+
+    auto it = aggregates_.lower_bound(std::make_pair(sym_id, std::numeric_limits<int64_t>::min()));
+    if(it == aggregates_.end() || it->first.first != sym_id) {
+        return;
+    }
+
+    auto old_amount = int64_t(0);
+    auto old_value  = std::string();
+    if(assets_write_cache_.read(key, old_value)) {
+        old_amount = get_asset_amount(old_value);
+    }
+    else {
+        auto status = db_->Get(read_opts_, assets_handle_, rocksdb::Slice(key.data(), key.size()), &old_value);
+        if(status.ok()) {
+            old_amount = get_asset_amount(old_value);
+        }
+        else if(!status.IsNotFound()) {
+            FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+        }
+    }
+    auto new_amount = get_asset_amount(data);
+
+    for(; it != aggregates_.end() && it->first.first == sym_id; it++) {
+        auto  threshold = it->first.second;
+        auto& agg       = it->second;
+        if(is_aggregated(old_amount, threshold)) {
+            agg.holders--;
+            agg.total -= old_amount;
+        }
+        if(is_aggregated(new_amount, threshold)) {
+            agg.holders++;
+            agg.total += new_amount;
+        }
+    }
+}
+
+void
+token_database_impl::rebuild_asset_aggregates() {
+    for(auto& it : aggregates_) {
+        it.second = build_asset_aggregate(it.first.first, it.first.second);
+    }
+}
+
+int
+token_database_impl::scan_with_write_cache(const write_cache_layer& cache,
+                                           rocksdb::ColumnFamilyHandle* handle,
+                                           const rocksdb::Slice& prefix,
+                                           const rocksdb::Slice& seek,
+                                           int skip,
+                                           const read_value_func& func) const {
+    using namespace internal;
+
+    auto in_range = [&prefix](auto& k) {
+        return k.size() >= prefix.size() && memcmp(k.data(), prefix.data(), prefix.size()) == 0;
+    };
+    auto has_cached = std::any_of(cache.data_.begin(), cache.data_.end(), [&](auto& it) { return in_range(it.first()); });
+
+    auto it = std::unique_ptr<rocksdb::Iterator>(db_->NewIterator(read_opts_, handle));
+    if(!has_cached) {
+        return scan_range(it.get(), seek, prefix.size(), skip, func);
+    }
+
+    // cached values under the prefix are merged with the ones in db by an indexed batch which is never written
+    auto overlay = rocksdb::WriteBatchWithIndex(rocksdb::BytewiseComparator(), 0 /* reserved_bytes */, true /* overwrite_key */);
+    for(auto& e : cache.data_) {
+        if(!in_range(e.first())) {
+            continue;
+        }
+        overlay.Put(handle, rocksdb::Slice(e.first().data(), e.first().size()), rocksdb::Slice(e.second.value.data(), e.second.value.size()));
+    }
+
+    auto mit = std::unique_ptr<rocksdb::Iterator>(overlay.NewIteratorWithBase(handle, it.release()));
+    return scan_range(mit.get(), seek, prefix.size(), skip, func);
+}
+
+int
+token_database_impl::read_assets_range(const symbol_id_type sym_id, const std::optional<address>& start, int skip, const read_value_func& func) const {
+    using namespace internal;
+
+    auto ps = rocksdb::Slice((char*)&sym_id, sizeof(sym_id));
+    if(start.has_value()) {
+        auto key = db_asset_key(*start, sym_id);
+        return scan_with_write_cache(assets_write_cache_, assets_handle_, ps, key.as_slice(), skip, func);
+    }
+    return scan_with_write_cache(assets_write_cache_, assets_handle_, ps, ps, skip, func);
+}
+
+int
+token_database_impl::read_assets_range(const symbol_id_type sym_id, const std::string_view& start, const read_value_func& func) const {
+    using namespace internal;
+
+    assert(start.size() == kPublicKeySize);
+
+    char buf[kSymbolIdSize + kPublicKeySize];
+    memcpy(buf, &sym_id, kSymbolIdSize);
+    memcpy(buf + kSymbolIdSize, start.data(), kPublicKeySize);
+
+    auto ps = rocksdb::Slice((char*)&sym_id, sizeof(sym_id));
+    return scan_with_write_cache(assets_write_cache_, assets_handle_, ps, rocksdb::Slice(buf, sizeof(buf)), 0, func);
+}
+
+void
+token_database_impl::add_savepoint(int64_t seq) {
+    using namespace internal;
+
+    EVT_ASSERT(config_.secondary_path.empty(), token_database_exception, "Secondary instance of token database is read-only");
+
+    if(!savepoints_.empty()) {
+        auto& b = savepoints_.back();
+        if(b.seq >= seq) {
+            EVT_THROW(token_database_seq_not_valid, "Seq is not valid, prev: ${prev}, curr: ${curr}",
+                      ("prev", b.seq)("curr", seq));
+        }
+    }
+
+    // pending writes belong to previous savepoint, they need to be visible in the snapshot of new one
+    write_batch();
+
+    savepoints_.push_back(savepoint(seq, kRuntime));
+    auto rt = new rt_group { .rb_snapshot = (const void*)db_->GetSnapshot(), .actions = {} }; 
+    SETPOINTER(void, savepoints_.back().node.group, rt);
+    runtime_savepoints_++;
+
+    tokens_write_cache_.add_savepoint(seq);
+    assets_write_cache_.add_savepoint(seq);
+    digest_entries_.emplace_back(digest_entry { .seq = seq, .digest = digest_ });
+    aggregates_entries_.emplace_back(aggregates_entry { .seq = seq, .aggregates = aggregates_ });
+
+    journal(kJournalAddSavepoint, seq);
+    journal_.flush();
+
+    if(config_.max_runtime_savepoints > 0 && runtime_savepoints_ > config_.max_runtime_savepoints) {
+        spill_savepoints();
+    }
+}
+
+void
+token_database_impl::free_savepoint(internal::savepoint& sp) {
+    using namespace internal;
+
+    auto n = sp.node;
+
+    switch(n.f.type) {
+    case kRuntime: {
+        auto rt = GETPOINTER(rt_group, n.group);
+        for(auto& act : rt->actions) {
+            switch(act.get_data_type()) {
+            case kTokenKey:
+            case kTokenFullKey:
+            case kAssetKey:
+            case kOwnerKey: {
+                free(GETPOINTER(void, act.data));
+                break;
+            }
+            case kTokenKeys: {
+                auto p = GETPOINTER(rt_token_keys, act.data);
+                //need to call dtor of keys manually
+                p->keys.~token_keys_t();
+                free(p);
+                break;
+            }
+            }  // switch
+        }
+        db_->ReleaseSnapshot((const rocksdb::Snapshot*)rt->rb_snapshot);
+        delete rt;
+        runtime_savepoints_--;
+        break;
+    }
+    case kPersist: {
+        auto pd = GETPOINTER(pd_group, n.group);
+        delete pd;
+        break;
+    }
+    }  // switch
+}
+
+void
+token_database_impl::spill_savepoints() {
+    using namespace internal;
+
+    // each runtime savepoint pins the versions of db at its snapshot, so older ones are converted into persist
+    // form with the previous values read from their snapshots, the same as they're persisted into disk.
+    // the latest two are always kept as runtime ones for squash
+    for(auto i = 0u; i + 2 < (size_t)savepoints_.size() && runtime_savepoints_ > config_.max_runtime_savepoints; i++) {
+        auto& sp = savepoints_[i];
+        if(sp.node.f.type != kRuntime) {
+            continue;
+        }
+
+        auto pd = new pd_group(make_pd_group(sp));
+        free_savepoint(sp);
+
+        sp.node = sp_node(kPersist);
+        SETPOINTER(void, sp.node.group, pd);
+    }
+}
+
+void
+token_database_impl::free_all_savepoints() {
+    while(!savepoints_.empty()) {
+        free_savepoint(savepoints_.front());
+        savepoints_.pop_front();
+    }
+}
+
+void
+token_database_impl::pop_savepoints(int64_t until) {
+    write_batch();
+    while(!savepoints_.empty() && savepoints_.front().seq < until) {
+        auto it = std::move(savepoints_.front());
+        savepoints_.pop_front();
+        free_savepoint(it);
+
+        // pop write cache and persist into underlying db
+        assert(digest_entries_.front().seq == it.seq);
+        digest_entries_.pop_front();
+        assert(aggregates_entries_.front().seq == it.seq);
+        aggregates_entries_.pop_front();
+
+        assert(tokens_write_cache_.ops_.front().seq == it.seq);
+        assert(assets_write_cache_.ops_.front().seq == it.seq);
+        auto batch = rocksdb::WriteBatch();
+        tokens_write_cache_.pop_front([&](auto& k, auto&& v) {
+            batch.Put(get_tokens_handle(k.data()), rocksdb::Slice(k.data(), k.size()), v);
+        });
+        assets_write_cache_.pop_front([&](auto& k, auto&& v) {
+            batch.Put(assets_handle_, rocksdb::Slice(k.data(), k.size()), v);
+        });
+        auto sync_write_opts = write_opts_;
+        sync_write_opts.sync = !write_opts_.disableWAL;  // sync requires wal
+        db_->Write(sync_write_opts, &batch);
+    }
+
+    // values are persisted above, record it after that
+    journal(kJournalPopFront, until);
+    journal_.flush();
+    if(journal_.is_open() && (savepoints_.empty() || journal_size_ > kJournalCompactSize)) {
+        compact_journal();
+    }
+}
+
+void
+token_database_impl::pop_back_savepoint() {
+    EVT_ASSERT(!savepoints_.empty(), token_database_no_savepoint, "There's no savepoints anymore");
+
+    write_batch();
+
+    auto it = std::move(savepoints_.back());
+    savepoints_.pop_back();
+    free_savepoint(it);
+
+    tokens_write_cache_.pop_back();
+    assets_write_cache_.pop_back();
+    digest_entries_.pop_back();
+    aggregates_entries_.pop_back();
+
+    journal(kJournalPopBack, 0);
+}
+
+void
+token_database_impl::squash() {
+    using namespace internal;
+    EVT_ASSERT(savepoints_.size() >= 2, token_database_squash_exception, "Squash needs at least two savepoints.");
+    
+    auto n = savepoints_.back().node;
+    EVT_ASSERT(n.f.type == kRuntime, token_database_squash_exception, "Squash needs two realtime savepoints.");
+
+    savepoints_.pop_back();
+    auto n2 = savepoints_.back().node;
+    EVT_ASSERT(n2.f.type == kRuntime, token_database_squash_exception, "Squash needs two realtime savepoints.");
+
+    // write all the pending writes in one batch
+    write_batch();
+
+    auto rt1 = GETPOINTER(rt_group, n.group);
+    auto rt2 = GETPOINTER(rt_group, n2.group);
+
+    // add all actions from rt1 into end of rt2
+    rt2->actions.insert(rt2->actions.cend(), rt1->actions.cbegin(), rt1->actions.cend());
+
+    // just release rt1's snapshot
+    db_->ReleaseSnapshot((const rocksdb::Snapshot*)rt1->rb_snapshot);
+    delete rt1;
+    runtime_savepoints_--;
+
+    tokens_write_cache_.squash();
+    assets_write_cache_.squash();
+
+    // digest and aggregates when the previous savepoint is added are still the ones to restore
+    digest_entries_.pop_back();
+    aggregates_entries_.pop_back();
+
+    journal(kJournalSquash, 0);
+}
+
+int64_t
+token_database_impl::latest_savepoint_seq() const {
+    EVT_ASSERT(!savepoints_.empty(), token_database_no_savepoint, "There's no savepoints anymore");
+    return savepoints_.back().seq;
+}
+
+int64_t
+token_database_impl::new_savepoint_session_seq() const {
+    int64_t seq = 1;
+    if(!savepoints_.empty()) {
+        seq = savepoints_.back().seq + 1;
+    }
+    return seq;
+}
+
+void
+token_database_impl::record(uint8_t action_type, uint8_t op, uint8_t data_type, void* data) {
+    using namespace internal;
+
+    if(!should_record()) {
+        return;
+    }
+    auto n = savepoints_.back().node;
+    assert(n.f.type == kRuntime);
+
+    GETPOINTER(rt_group, n.group)->actions.emplace_back(rt_action(action_type, op, data_type, data));
+}
+
+namespace internal {
+
+std::string
+get_sp_key(const rt_action& act) {
+    switch(act.get_data_type()) {
+    case kTokenKey: {
+        auto data = GETPOINTER(rt_token_key, act.data);
+        return db_token_key(action_key_prefixes[act.f.type], data->key).as_string();
+    }
+    case kTokenFullKey: {
+        auto data = GETPOINTER(rt_token_fullkey, act.data);
+        return db_token_key(data->prefix, data->key).as_string();
+    }
+    case kAssetKey: {
+        auto data = GETPOINTER(rt_asset_key, act.data);
+        return std::string(data->key, sizeof(data->key));
+    }
+    case kOwnerKey: {
+        auto data = GETPOINTER(rt_owner_key, act.data);
+        return std::string(data->key, sizeof(data->key));
+    }
+    case kTokenKeys: {
+        assert(false);
+    }
+    }  // switch
+    return std::string();
+}
+
+}  // namespace internal
+
+void
+token_database_impl::rollback_rt_group(internal::rt_group* rt) {
+    using namespace internal;
+
+    if(rt->actions.empty()) {
+        db_->ReleaseSnapshot((const rocksdb::Snapshot*)rt->rb_snapshot);
+        return;
+    }
+
+    auto snapshot_read_opts_     = read_opts_;
+    snapshot_read_opts_.snapshot = (const rocksdb::Snapshot*)rt->rb_snapshot;
+
+    auto key_set = keys_hash_set();
+    auto batch   = rocksdb::WriteBatch();
+    
+    for(auto it = rt->actions.begin(); it < rt->actions.end(); it++) {
+        auto data = GETPOINTER(void, it->data);
+
+        auto fn = [&](auto& key, auto type, auto op) {
+            switch(op) {
+            case action_op::add: {
+                assert(key_set.find(key) == key_set.end());
+
+                batch.Delete(get_handle((int)type), key);
+                self_.remove_token_value(key);
+            
+                // insert key into key set
+                key_set.insert(key);
+                break;
+            }
+            case action_op::update: {
+                // only update operation need to check if key is already processed
+                if(key_set.find(key) != key_set.end()) {
+                    break;
+                }
+                auto old_value = std::string();
+                auto status    = db_->Get(snapshot_read_opts_, get_handle((int)type), key, &old_value);
+                if(!status.ok()) {
+                    FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+                }
+                batch.Put(get_handle((int)type), key, old_value);
+                self_.rollback_token_value(key);
+
+                // insert key into key set
+                key_set.insert(key);
+                break;
+            }
+            case action_op::put: {
+                // only update operation need to check if key is already processed
+                if(key_set.find(key) != key_set.end()) {
+                    break;
+                }
+
+                // Asset and owner index types only have put op
+                auto handle    = get_handle((int)type);
+                auto old_value = std::string();
+                auto status    = db_->Get(snapshot_read_opts_, handle, key, &old_value);
+
+                // key may not existed in latest snapshot, remove it
+                if(!status.ok()) {
+                    if(status.code() != rocksdb::Status::kNotFound) {
+                        FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+                    }
+                    batch.Delete(handle, key);
+                    if(handle != assets_handle_ && handle != owners_handle_) {
+                        self_.remove_token_value(key);
+                    }
+                }
+                else {
+                    batch.Put(handle, key, old_value);
+                    if(handle != assets_handle_ && handle != owners_handle_) {
+                        self_.rollback_token_value(key);
+                    }
+                }
+
+                // insert key into key set
+                key_set.insert(key);
+                break;
+            }
+            }  // switch
+        };
+
+        auto op         = it->get_action_op();
+        auto data_type  = it->get_data_type();
+        auto type       = it->get_token_type();
+
+        switch(data_type) {
+        case kTokenKey:
+        case kTokenFullKey:
+        case kAssetKey:
+        case kOwnerKey: {
+            auto key  = get_sp_key(*it);
+            fn(key, type, op);
+            break;
+        }
+        case kTokenKeys: {
+            auto  keys   = (rt_token_keys*)data;
+            auto& prefix = keys->prefix;
+            for(auto& k : keys->keys) {
+                auto key = db_token_key(prefix, k).as_string();
+                fn(key, type, op);
+            }
+
+            //need to call dtor of keys manually
+            keys->keys.~token_keys_t();
+            break;
+        }
+        }  // switch
+
+        free(data);
+    }  // for
+
+    auto sync_write_opts = write_opts_;
+    sync_write_opts.sync = !write_opts_.disableWAL;  // sync requires wal
+    db_->Write(sync_write_opts, &batch);
+
+    db_->ReleaseSnapshot((const rocksdb::Snapshot*)rt->rb_snapshot);
+}
+
+void
+token_database_impl::rollback_pd_group(internal::pd_group* pd) {
+    using namespace internal;
+
+    if(pd->actions.empty()) {
+        return;
+    }
+
+    // keyset is not required here,
+    // because it has done during creating persist savepoint.
+    // cache still needs rollback as savepoints spilled from runtime ones may have cached values
+    auto batch = rocksdb::WriteBatch();
+    for(auto it = pd->actions.begin(); it < pd->actions.end(); it++) {
+        switch((action_op)it->op) {
+        case action_op::add: {
+            assert(it->value.empty());
+            batch.Delete(get_handle(it->type), it->key);
+            self_.remove_token_value(it->key);
+            break;
+        }
+        case action_op::update: {
+            assert(!it->value.empty());
+            batch.Put(get_handle(it->type), it->key, it->value);
+            self_.rollback_token_value(it->key);
+            break;
+        }
+        case action_op::put: {
+            // Asset and owner index types only have put op
+            auto handle = get_handle(it->type);
+            if(handle == nullptr) {
+                // owner index is disabled after savepoints persisted, it's already dropped
+                break;
+            }
+            if(handle == owners_handle_ && replaying_) {
+                // owner index is written into db directly, the values restored by the rollback replayed and the
+                // ones written after it are all in db already, restoring them again would revert the later ones
+                break;
+            }
+            if(it->value.empty()) {
+                batch.Delete(handle, it->key);
+                if(handle != assets_handle_ && handle != owners_handle_) {
+                    self_.remove_token_value(it->key);
+                }
+            }
+            else {
+                batch.Put(handle, it->key, it->value);
+                if(handle != assets_handle_ && handle != owners_handle_) {
+                    self_.rollback_token_value(it->key);
+                }
+            }
+            break;
+        }
+        }  // switch
+    }
+
+    auto sync_write_opts = write_opts_;
+    sync_write_opts.sync = !write_opts_.disableWAL;  // sync requires wal
+    db_->Write(sync_write_opts, &batch);
+}
+
+void
+token_database_impl::rollback_to_latest_savepoint() {
+    using namespace internal;
+    EVT_ASSERT(!savepoints_.empty(), token_database_no_savepoint, "There's no savepoints anymore");
+
+    auto  seq = savepoints_.back().seq;
+    auto& n   = savepoints_.back().node;
+
+    assert(!digest_entries_.empty() && digest_entries_.back().seq == seq);
+    digest_ = std::move(digest_entries_.back().digest);
+    digest_entries_.pop_back();
+
+    assert(!aggregates_entries_.empty() && aggregates_entries_.back().seq == seq);
+    auto aggregates = std::move(aggregates_entries_.back().aggregates);
+    aggregates_entries_.pop_back();
+
+    switch(n.f.type) {
+    case kRuntime: {
+        // pending writes of owner index are only of latest savepoint, simply discard them.
+        // keys written before may still need to be restored from snapshot below
+        batch_.Clear();
+
+        auto rt = GETPOINTER(rt_group, n.group);
+        rollback_rt_group(rt);
+        delete rt;
+        runtime_savepoints_--;
+
+        break;
+    }
+    case kPersist: {
+        auto pd = GETPOINTER(pd_group, n.group);
+        rollback_pd_group(pd);
+        delete pd;
+
+        break;
+    }
+    }  // switch
+
+    savepoints_.pop_back();
+
+    assert(seq == tokens_write_cache_.ops_.back().seq);
+    tokens_write_cache_.rollback_to_latest_savepoint([this](auto& k) {
+        self_.rollback_token_value(rocksdb::Slice(k.data(), k.size()));
+    });
+
+    assert(seq == assets_write_cache_.ops_.back().seq);
+    assets_write_cache_.rollback_to_latest_savepoint();
+
+    // balances are all restored above
+    if(aggregates.has_value()) {
+        aggregates_ = std::move(*aggregates);
+    }
+    else {
+        rebuild_asset_aggregates();
+    }
+
+    journal(kJournalRollback, seq);
+}
+
+void
+token_database_impl::compact_journal() {
+    using namespace internal;
+
+    try {
+        if(journal_.is_open()) {
+            journal_.close();
+        }
+
+        // write savepoints into a new file and replace the journal with it
+        auto filename = config_.db_path / config::token_database_journal_filename;
+        auto tmpname  = config_.db_path / (std::string(config::token_database_journal_filename) + ".tmp");
+
+        auto fs = std::ofstream();
+        fs.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+        fs.open(tmpname.to_native_ansi_path(), (std::ios::out | std::ios::binary | std::ios::trunc));
+
+        auto h = pd_header {
+            .dirty_flag = 0
+        };
+        fc::raw::pack(fs, h);
+
+        persist_savepoints(fs);
+        assets_write_cache_.persist_savepoints(fs);
+        tokens_write_cache_.persist_savepoints(fs);
+
+        fs.flush();
+        fs.close();
+        fc::rename(tmpname, filename);
+
+        // savepoints log of older versions is replaced by journal
+        auto legacy = config_.db_path / config::token_database_persisit_filename;
+        if(fc::exists(legacy)) {
+            fc::remove(legacy);
+        }
+
+        journal_.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+        journal_.open(filename.to_native_ansi_path(), (std::ios::out | std::ios::binary | std::ios::app));
+        journal_size_ = fc::file_size(filename);
+    }
+    EVT_CAPTURE_AND_RETHROW(token_database_persist_exception);
+}
+
+void
+token_database_impl::journal(uint8_t type, int64_t seq, const std::string_view& key, const std::string_view& value) {
+    using namespace internal;
+
+    if(!journal_.is_open()) {
+        return;
+    }
+
+    auto r = journal_record {
+        .type  = type,
+        .seq   = seq,
+        .key   = std::string(key),
+        .value = std::string(value)
+    };
+    auto data = fc::raw::pack(r);
+    auto size = (uint32_t)data.size();
+
+    journal_.write((const char*)&size, sizeof(size));
+    journal_.write(data.data(), data.size());
+    journal_size_ += sizeof(size) + data.size();
+}
+
+void
+token_database_impl::replay_journal(std::istream& is) {
+    using namespace internal;
+
+    auto count = 0;
+    auto data  = std::vector<char>();
+
+    replaying_ = true;
+    auto guard = fc::make_scoped_exit([this] { replaying_ = false; });
+    while(true) {
+        auto size = uint32_t();
+        if(!is.read((char*)&size, sizeof(size))) {
+            break;
+        }
+        data.resize(size);
+        if(!is.read(data.data(), size)) {
+            wlog("Incomplete record at the end of savepoints journal is ignored");
+            break;
+        }
+
+        auto r = fc::raw::unpack<journal_record>(data);
+        switch(r.type) {
+        case kJournalAddSavepoint: {
+            // savepoints replayed are persist ones, the same as loaded from file
+            savepoints_.push_back(savepoint(r.seq, kPersist));
+            auto pd = new pd_group { .seq = r.seq, .actions = {} };
+            SETPOINTER(void, savepoints_.back().node.group, pd);
+
+            tokens_write_cache_.add_savepoint(r.seq);
+            assets_write_cache_.add_savepoint(r.seq);
+            digest_entries_.emplace_back(digest_entry { .seq = r.seq, .digest = std::nullopt });
+            aggregates_entries_.emplace_back(aggregates_entry { .seq = r.seq, .aggregates = std::nullopt });
+            break;
+        }
+        case kJournalPutToken: {
+            tokens_write_cache_.put(r.key, r.value);
+            break;
+        }
+        case kJournalPutAsset: {
+            assets_write_cache_.put(r.key, r.value);
+            break;
+        }
+        case kJournalPutOwner: {
+            // only the first old value in one savepoint is kept
+            auto  pd   = GETPOINTER(pd_group, savepoints_.back().node.group);
+            auto& acts = pd->actions;
+            if(std::find_if(acts.cbegin(), acts.cend(), [&](auto& act) { return act.key == r.key; }) == acts.cend()) {
+                acts.emplace_back(pd_action { .op = (uint16_t)action_op::put, .type = (uint16_t)kOwnerIndexType, .key = r.key, .value = r.value });
+            }
+            break;
+        }
+        case kJournalRollback: {
+            // values of tokens and assets restored in db before are restored again, it's harmless as later writes
+            // of them are replayed from write caches. owner index is skipped, see `rollback_pd_group`
+            rollback_to_latest_savepoint();
+            break;
+        }
+        case kJournalSquash: {
+            auto pd1 = GETPOINTER(pd_group, savepoints_.back().node.group);
+            savepoints_.pop_back();
+            auto pd2 = GETPOINTER(pd_group, savepoints_.back().node.group);
+
+            for(auto& act : pd1->actions) {
+                auto& acts = pd2->actions;
+                if(std::find_if(acts.cbegin(), acts.cend(), [&](auto& a) { return a.key == act.key; }) == acts.cend()) {
+                    acts.emplace_back(std::move(act));
+                }
+            }
+            delete pd1;
+
+            tokens_write_cache_.squash();
+            assets_write_cache_.squash();
+            digest_entries_.pop_back();
+            aggregates_entries_.pop_back();
+            break;
+        }
+        case kJournalPopBack: {
+            pop_back_savepoint();
+            break;
+        }
+        case kJournalPopFront: {
+            pop_savepoints(r.seq);
+            break;
+        }
+        default: {
+            EVT_THROW(token_database_persist_exception, "Unknown type of journal record: ${t}", ("t", r.type));
+        }
+        }  // switch
+        count++;
+    }
+
+    ilog("Replayed ${n} records of savepoints journal", ("n", count));
+}
+
+void
+token_database_impl::load_savepoints() {
+    auto filename = config_.db_path / config::token_database_journal_filename;
+    auto journal  = fc::exists(filename);
+    if(!journal) {
+        // savepoints log of older versions
+        filename = config_.db_path / config::token_database_persisit_filename;
+        if(!fc::exists(filename)) {
+            wlog("No savepoints log in token database");
+            return;
+        }
+    }
+
+    auto fs = std::ifstream();
+    fs.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+    fs.open(filename.to_native_ansi_path(), (std::ios::in | std::ios::binary));
+
+    // delete old savepoints if existed (from snapshot)
+    savepoints_.clear();
+    runtime_savepoints_ = 0;
+    tokens_write_cache_.clear();
+    assets_write_cache_.clear();
+    digest_.reset();
+    digest_entries_.clear();
+    aggregates_.clear();
+    aggregates_entries_.clear();
+
+    // load
+    load_savepoints(fs);
+    assets_write_cache_.load_savepoints(fs);
+    if(fs.peek() == std::char_traits<char>::eof()) {
+        // savepoints persisted by older versions have token changes in persist groups only
+        for(auto i = 0u; i < savepoints_.size(); i++) {
+            tokens_write_cache_.add_savepoint(savepoints_[i].seq);
+        }
+    }
+    else {
+        tokens_write_cache_.load_savepoints(fs);
+    }
+
+    if(journal) {
+        // records appended after journal is compacted
+        fs.exceptions(std::ifstream::goodbit);
+        replay_journal(fs);
+    }
+
+    // close
+    fs.close();
+}
+
+internal::pd_group
+token_database_impl::make_pd_group(const internal::savepoint& sp) const {
+    using namespace internal;
+
+    auto pd = pd_group();
+    pd.seq  = sp.seq;
+
+    auto n = sp.node;
+
+    switch(n.f.type) {
+    case kPersist: {
+        auto pd2 = GETPOINTER(pd_group, n.group);
+        pd.actions.insert(pd.actions.cbegin(), pd2->actions.cbegin(), pd2->actions.cend());
+
+        break;
+    }
+    case kRuntime: {
+        auto rt = GETPOINTER(rt_group, n.group);
+
+        auto key_set = keys_hash_set();
+
+        auto snapshot_read_opts_     = read_opts_;
+        snapshot_read_opts_.snapshot = (const rocksdb::Snapshot*)rt->rb_snapshot;
+
+        // only the value before the first write of each key is kept, the later writes are skipped
+        auto fn = [&](pd_action& pdact, auto type, auto op) {
+            if(key_set.find(pdact.key) != key_set.end()) {
+                return false;
+            }
+            key_set.insert(pdact.key);
+
+            switch(op) {
+            case action_op::add: {
+                // no need to read value
+                break;
+            }
+            case action_op::update: {
+                auto status = db_->Get(snapshot_read_opts_, get_handle((int)type), pdact.key, &pdact.value);
+                if(!status.ok()) {
+                    FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+                }
+                break;
+            }
+            case action_op::put: {
+                auto handle = get_handle((int)type);
+                auto status = db_->Get(snapshot_read_opts_, handle, pdact.key, &pdact.value);
+
+                // key may not existed in latest snapshot
+                if(!status.ok()) {
+                    if(status.code() != rocksdb::Status::kNotFound) {
+                        FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+                    }
+                    pdact.value.clear();
+                }
+                break;
+            }
+            }  // switch
+
+            return true;
+        };
+
+        for(auto& act : rt->actions) {
+            auto data = GETPOINTER(void, act.data);
+
+            auto op         = act.get_action_op();
+            auto data_type  = act.get_data_type();
+            auto type       = act.get_token_type();
+
+            auto pdact = pd_action();
+            pdact.op   = (int)op;
+            pdact.type = (int)type;
+
+            switch(data_type) {
+            case kTokenKey:
+            case kTokenFullKey:
+            case kAssetKey:
+            case kOwnerKey: {
+                pdact.key = get_sp_key(act);
+                if(fn(pdact, type, op)) {
+                    pd.actions.emplace_back(std::move(pdact));
+                }
+                break;
+            }
+            case kTokenKeys: {
+                auto  keys   = (rt_token_keys*)data;
+                auto& prefix = keys->prefix;
+                for(auto& k : keys->keys) {
+                    pdact.key = db_token_key(prefix, k).as_string();
+                    pdact.value.clear();
+                    if(fn(pdact, type, op)) {
+                        pd.actions.emplace_back(pdact);
+                    }
+                }
+                break;
+            }
+            }  // switch
+        }  // for
+        break;
+    }
+    }  // switch
+
+    return pd;
+}
+
+void
+token_database_impl::persist_savepoints(std::ostream& os) const {
+    auto pds = std::vector<internal::pd_group>();
+    pds.reserve(savepoints_.size());
+
+    for(auto i = 0u; i < savepoints_.size(); i++) {
+        pds.emplace_back(make_pd_group(savepoints_[i]));
+    }
+
+    fc::raw::pack(os, pds);
+}
+
+size_t
+token_database_impl::savepoints_memory_usage() const {
     using namespace internal;
 
-    auto dbkey  = db_asset_key(addr, sym_id);
-    auto value  = std::string();
+    auto sz = size_t(0);
+    for(auto i = 0u; i < savepoints_.size(); i++) {
+        auto n = savepoints_[i].node;
 
-    if(assets_write_cache_.exists(dbkey.as_string_view())) {
-        return true;
+        switch(n.f.type) {
+        case kRuntime: {
+            auto rt = GETPOINTER(rt_group, n.group);
+            sz += sizeof(rt_group);
+            for(auto& act : rt->actions) {
+                sz += sizeof(rt_action);
+                switch(act.get_data_type()) {
+                case kTokenKey:     sz += sizeof(rt_token_key); break;
+                case kTokenFullKey: sz += sizeof(rt_token_fullkey); break;
+                case kAssetKey:     sz += sizeof(rt_asset_key); break;
+                case kOwnerKey:     sz += sizeof(rt_owner_key); break;
+                case kTokenKeys: {
+                    auto p = GETPOINTER(rt_token_keys, act.data);
+                    sz += sizeof(rt_token_keys) + p->keys.size() * sizeof(name128);
+                    break;
+                }
+                }  // switch
+            }
+            break;
+        }
+        case kPersist: {
+            auto pd = GETPOINTER(pd_group, n.group);
+            sz += sizeof(pd_group);
+            for(auto& act : pd->actions) {
+                sz += sizeof(pd_action) + act.key.size() + act.value.size();
+            }
+            break;
+        }
+        }  // switch
     }
-    auto status = db_->Get(read_opts_, assets_handle_, dbkey.as_slice(), &value);
-    return status.ok();
+    return sz;
 }
 
-int
-token_database_impl::read_token(const name128& prefix, const name128& key, std::string& out, bool no_throw) const {
+void
+token_database_impl::load_savepoints(std::istream& is) {
     using namespace internal;
 
-    auto dbkey  = db_token_key(prefix, key);
-    auto status = db_->Get(read_opts_, dbkey.as_slice(), &out);
+    auto h = pd_header();
+    fc::raw::unpack(is, h);
+    EVT_ASSERT(h.dirty_flag == 0, token_database_dirty_flag_exception, "checkpoints log file dirty flag set");
+
+    auto pds = std::vector<pd_group>();
+    fc::raw::unpack(is, pds);
+
+    for(auto& pd : pds) {
+        savepoints_.push_back(savepoint(pd.seq, kPersist));
+        digest_entries_.emplace_back(digest_entry { .seq = pd.seq, .digest = std::nullopt });
+        aggregates_entries_.emplace_back(aggregates_entry { .seq = pd.seq, .aggregates = std::nullopt });
+
+        auto ppd = new pd_group(pd);
+        SETPOINTER(void, savepoints_.back().node.group, ppd);
+    }
+}
+
+std::unique_ptr<rocksdb::Iterator>
+token_database_impl::new_owners_iterator() const {
+    auto it = db_->NewIterator(read_opts_, owners_handle_);
+    if(!has_batch()) {
+        return std::unique_ptr<rocksdb::Iterator>(it);
+    }
+    return std::unique_ptr<rocksdb::Iterator>(batch_.NewIteratorWithBase(owners_handle_, it));
+}
+
+void
+token_database_impl::write_batch() const {
+    if(!has_batch()) {
+        return;
+    }
+
+    auto status = db_->Write(write_opts_, batch_.GetWriteBatch());
     if(!status.ok()) {
-        if(!status.IsNotFound()) {
-            FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
-        }
-        if(!no_throw) {
-            EVT_THROW(unknown_token_database_key, "Cannot find key: ${k} with prefix: ${p}", ("k",key)("p",prefix));
-        }
-        return false;
+        FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
     }
-    return true;
+    batch_.Clear();
 }
 
-int
-token_database_impl::read_asset(const address& addr, const symbol_id_type sym_id, std::string& out, bool no_throw) const {
+rocksdb::Status
+token_database_impl::get_token_value(const rocksdb::Slice& key, std::string* value) const {
+    if(auto v = tokens_write_cache_.lookup(key.ToStringView()); v != nullptr) {
+        *value = *v;
+        return rocksdb::Status::OK();
+    }
+    return db_->Get(read_opts_, get_tokens_handle(key.data()), key, value);
+}
+
+rocksdb::Status
+token_database_impl::get_token_value(const rocksdb::Slice& key, rocksdb::PinnableSlice* value) const {
+    if(auto v = tokens_write_cache_.lookup(key.ToStringView()); v != nullptr) {
+        value->PinSelf(*v);
+        return rocksdb::Status::OK();
+    }
+    return db_->Get(read_opts_, get_tokens_handle(key.data()), key, value);
+}
+
+void
+token_database_impl::create_checkpoint(const fc::path& dir) const {
     using namespace internal;
 
-    auto key = db_asset_key(addr, sym_id);
-    if(assets_write_cache_.read(key.as_string_view(), out)) {
-        return true;
+    EVT_ASSERT(!fc::exists(dir), token_database_exception, "Checkpoint directory: ${d} already exists", ("d", dir.to_native_ansi_path()));
+
+    // journal needs to be consistent with db files
+    write_batch();
+    if(journal_.is_open()) {
+        journal_.flush();
     }
 
-    auto status = db_->Get(read_opts_, assets_handle_, key.as_slice(), &out);
+    auto cp     = (rocksdb::Checkpoint*)nullptr;
+    auto status = rocksdb::Checkpoint::Create(db_, &cp);
     if(!status.ok()) {
-        if(!status.IsNotFound()) {
-            FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+        EVT_THROW(token_database_rocksdb_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+    }
+    auto checkpoint = std::unique_ptr<rocksdb::Checkpoint>(cp);
+
+    status = checkpoint->CreateCheckpoint(dir.to_native_ansi_path());
+    if(!status.ok()) {
+        EVT_THROW(token_database_rocksdb_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+    }
+
+    auto journal = config_.db_path / config::token_database_journal_filename;
+    if(fc::exists(journal)) {
+        fc::copy(journal, dir / config::token_database_journal_filename);
+    }
+    fc::copy(config_.db_path / config::token_database_format_filename, dir / config::token_database_format_filename);
+}
+
+void
+token_database_impl::restore_checkpoint(const fc::path& dir) {
+    using namespace internal;
+
+    EVT_ASSERT(fc::is_directory(dir), token_database_exception, "Checkpoint directory: ${d} doesn't exist", ("d", dir.to_native_ansi_path()));
+
+    close(false);
+    fc::remove_all(config_.db_path);
+    fc::create_directories(config_.db_path);
+
+    // files in checkpoint are immutable, link them if possible
+    for(auto it = fc::directory_iterator(dir); it != fc::directory_iterator(); ++it) {
+        auto file   = *it;
+        auto target = config_.db_path / file.filename();
+        try {
+            fc::create_hard_link(file, target);
         }
-        if(!no_throw) {
-            EVT_THROW2(unknown_token_database_key, "There's no balance of fungible with sym id: {} in address: {}", sym_id, addr);
+        catch(...) {
+            fc::copy(file, target);
         }
-        return false;
     }
-    return true;
+
+    open(true);
+
+    // state in snapshot is the head state
+    pop_savepoints(std::numeric_limits<int64_t>::max());
 }
 
-int
-token_database_impl::read_tokens_range(const name128& prefix, int skip, const read_value_func& func) const {
+void
+token_database_impl::ingest(rocksdb::ColumnFamilyHandle* handle, const std::string_view& prefix, const bulk_entries_t& entries) {
     using namespace internal;
 
-    auto it    = db_->NewIterator(read_opts_);
-    auto key   = rocksdb::Slice((char*)&prefix, sizeof(prefix));
-    auto i     = 0;
-    auto count = 0;
-    
-    it->Seek(key);
-    while(it->Valid()) {
-        if(i++ < skip) {
-            it->Next();
-            continue;
+    if(entries.empty()) {
+        return;
+    }
+    digest_stale_ = true;
+
+    auto key = std::string(prefix);
+    if(config_.profile == storage_profile::memory) {
+        // plain table files cannot be built outside, write them in one batch instead
+        auto batch = rocksdb::WriteBatch();
+        for(auto& e : entries) {
+            key.resize(prefix.size());
+            key.append(e.first);
+            batch.Put(handle, key, e.second);
+        }
+        auto status = db_->Write(write_opts_, &batch);
+        if(!status.ok()) {
+            EVT_THROW(token_database_rocksdb_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
         }
+        return;
+    }
 
-        count++;
-        auto value = it->value().ToString();
-        auto key   = it->key();
+    auto filename = config_.db_path / fmt::format("ingest-{}.sst", ingest_seq_++);
+    auto writer   = rocksdb::SstFileWriter(rocksdb::EnvOptions(), db_->GetOptions(handle), handle);
 
-        key.remove_prefix(sizeof(prefix));
-        if(!func(key.ToStringView(), std::move(value))) {
-            delete it;
-            return count;
+    auto status = writer.Open(filename.to_native_ansi_path());
+    if(!status.ok()) {
+        EVT_THROW(token_database_rocksdb_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+    }
+    for(auto& e : entries) {
+        key.resize(prefix.size());
+        key.append(e.first);
+        status = writer.Put(key, e.second);
+        if(!status.ok()) {
+            EVT_THROW(token_database_rocksdb_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
         }
-        it->Next();
     }
-    delete it;
-    return count;
+    status = writer.Finish();
+    if(!status.ok()) {
+        EVT_THROW(token_database_rocksdb_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+    }
+
+    auto opts       = rocksdb::IngestExternalFileOptions();
+    opts.move_files = true;
+
+    status = db_->IngestExternalFile(handle, { filename.to_native_ansi_path() }, opts);
+    if(!status.ok()) {
+        EVT_THROW(token_database_rocksdb_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+    }
 }
 
-int
-token_database_impl::read_assets_range(const symbol_id_type sym_id, int skip, const read_value_func& func) const {
+token_database_metrics
+token_database_impl::get_metrics() const {
     using namespace internal;
 
-    // create snapshot first
-    auto ss = db_->GetSnapshot();
-    
-    // write new values from cache into db
-    for(auto& it : assets_write_cache_.data_) {
-        auto k = rocksdb::Slice(it.first().data(), it.first().size());
-        auto v = rocksdb::Slice(it.second.value.data(), it.second.value.size());
-        db_->Put(write_opts_, assets_handle_, k, v);
+    auto m = token_database_metrics();
+    for(auto i = 0u; i < stats_.size(); i++) {
+        auto& s  = stats_[i];
+        auto  tm = token_database_metrics::type_metrics();
+
+        tm.type          = token_type_names[i];
+        tm.reads         = s.reads;
+        tm.writes        = s.writes;
+        tm.exists        = s.exists;
+        tm.read_bytes    = s.read_bytes;
+        tm.write_bytes   = s.write_bytes;
+        tm.read_latency  = std::vector<uint64_t>(s.read_latency.cbegin(), s.read_latency.cend());
+        tm.write_latency = std::vector<uint64_t>(s.write_latency.cbegin(), s.write_latency.cend());
+
+        m.types.emplace_back(std::move(tm));
     }
 
-    // scan values
-    auto it    = db_->NewIterator(read_opts_, assets_handle_);
-    auto key   = rocksdb::Slice((char*)&sym_id, sizeof(sym_id));
-    auto count = 0;
-    auto i     = 0;
-    
-    it->Seek(key);
-    while(it->Valid()) {
-        if(i++ < skip) {
-            it->Next();
-            continue;
+    m.savepoints_depth        = savepoints_.size();
+    m.tokens_write_cache_size = tokens_write_cache_.data_.size();
+    m.assets_write_cache_size = assets_write_cache_.data_.size();
+
+    if(statistics_) {
+        m.block_cache_hit  = statistics_->getTickerCount(rocksdb::BLOCK_CACHE_HIT);
+        m.block_cache_miss = statistics_->getTickerCount(rocksdb::BLOCK_CACHE_MISS);
+        if(m.block_cache_hit + m.block_cache_miss > 0) {
+            m.block_cache_hit_ratio = (double)m.block_cache_hit / (m.block_cache_hit + m.block_cache_miss);
         }
+    }
+    return m;
+}
 
-        count++;
-        auto value = it->value().ToString();
-        auto key   = it->key();
+token_database_memory_usage
+token_database_impl::get_memory_usage() const {
+    auto m = token_database_memory_usage();
+    for(auto& c : block_caches_) {
+        m.block_cache_usage    += c->GetUsage();
+        m.block_cache_capacity += c->GetCapacity();
+    }
 
-        key.remove_prefix(sizeof(sym_id));
-        if(!func(key.ToStringView(), std::move(value))) {
-            delete it;
-            return count;
+    auto v = uint64_t(0);
+    if(db_->GetAggregatedIntProperty(rocksdb::DB::Properties::kCurSizeAllMemTables, &v)) {
+        m.memtables = v;
+    }
+    if(db_->GetAggregatedIntProperty(rocksdb::DB::Properties::kEstimateTableReadersMem, &v)) {
+        m.table_readers = v;
+    }
+
+    m.write_cache         = tokens_write_cache_.memory_usage() + assets_write_cache_.memory_usage();
+    m.write_cache_entries = tokens_write_cache_.data_.size() + assets_write_cache_.data_.size();
+    if(hash_db_ != nullptr) {
+        m.hash_tables = hash_db_->memory_usage();
+    }
+    m.savepoints           = savepoints_memory_usage();
+    m.savepoints_snapshots = runtime_savepoints_;
+    return m;
+}
+
+void
+token_database_impl::flush() const {
+    write_batch();
+
+    auto status = db_->Flush(rocksdb::FlushOptions());
+    if(!status.ok()) {
+        FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+    }
+}
+
+void
+token_database_impl::set_fast_writes(bool enable) {
+    if(write_opts_.disableWAL == enable) {
+        return;
+    }
+    if(!enable) {
+        // data written without wal only lives in memtables, persist them before wal is back
+        flush();
+    }
+    write_opts_.disableWAL = enable;
+}
+
+void
+token_database_impl::catch_up_with_primary() {
+    EVT_ASSERT(!config_.secondary_path.empty(), token_database_exception, "Token database is not opened as secondary instance");
+
+#if ROCKSDB_MAJOR >= 6
+    auto status = db_->TryCatchUpWithPrimary();
+    if(!status.ok()) {
+        EVT_THROW(token_database_rocksdb_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+    }
+#endif
+    // digest is maintained by writes which secondary instance never sees
+    digest_.reset();
+}
+
+const char*
+get_token_type_name(token_type type) {
+    return internal::token_type_names[(int)type];
+}
+
+std::optional<token_type>
+get_token_type(const std::string_view& name) {
+    for(auto i = 0u; i < sizeof(internal::token_type_names) / sizeof(const char*); i++) {
+        if(name == internal::token_type_names[i]) {
+            return (token_type)i;
         }
-        it->Next();
     }
-    delete it;
+    return std::nullopt;
+}
 
-    // restore values
-    auto snapshot_read_opts_     = read_opts_;
-    snapshot_read_opts_.snapshot = ss;
+token_database::token_database(const config& config)
+    : my_(std::make_unique<token_database_impl>(*this, config)) {}
+
+token_database::~token_database() {
+    my_->close();
+}
 
-    auto batch = rocksdb::WriteBatch();
-    for(auto& it : assets_write_cache_.data_) {
-        auto v = std::string();
-        auto k = rocksdb::Slice(it.first().data(), it.first().size());
-        auto s = db_->Get(snapshot_read_opts_, assets_handle_, k, &v);
-        if(s.ok()) {
-            // put value back
-            batch.Put(assets_handle_, k, v);
-        }
-        else if(s.code() == rocksdb::Status::kNotFound) {
-            // remove value
-            batch.Delete(assets_handle_, k);
-        }
-        else {
-            FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", s.getState()));
-        }
-    }
-    auto sync_write_opts = write_opts_;
-    sync_write_opts.sync = true;
-    db_->Write(sync_write_opts, &batch);
+void
+token_database::open(int load_persistence) {
+    my_->open(load_persistence);
+}
 
-    return count;
+void
+token_database::close(int persist) {
+    flush_cache_values();
+    my_->close(persist);
 }
 
 void
-token_database_impl::add_savepoint(int64_t seq) {
+token_database::put_token(token_type type, action_op op, const std::optional<name128>& domain, const name128& key, const std::string_view& data) {
     using namespace internal;
 
-    if(!savepoints_.empty()) {
-        auto& b = savepoints_.back();
-        if(b.seq >= seq) {
-            EVT_THROW(token_database_seq_not_valid, "Seq is not valid, prev: ${prev}, curr: ${curr}",
-                      ("prev", b.seq)("curr", seq));
-        }
-    }
+    assert(type != token_type::asset);
+    assert((type == token_type::token) != (!domain.has_value()));
+    auto& prefix = domain.has_value() ? *domain : action_key_prefixes[(int)type];
 
-    savepoints_.push_back(savepoint(seq, kRuntime));
-    auto rt = new rt_group { .rb_snapshot = (const void*)db_->GetSnapshot(), .actions = {} }; 
-    SETPOINTER(void, savepoints_.back().node.group, rt);
+    auto g  = stats_guard(my_->get_stats(type), kStatsWrite);
+    g.bytes = data.size();
+    my_->put_token(type, op, prefix, key, data);
 
-    assets_write_cache_.add_savepoint(seq);
+    if(op != action_op::update) {
+        add_token_value(db_token_key(prefix, key).as_slice());
+    }
 }
 
 void
-token_database_impl::free_savepoint(internal::savepoint& sp) {
+token_database::put_tokens(token_type type,
+                           action_op op,
+                           const std::optional<name128>& domain,
+                           token_keys_t&& keys,
+                           const small_vector_base<std::string_view>& data) {
     using namespace internal;
 
-    auto n = sp.node;
+    assert(type != token_type::asset);
+    assert((type == token_type::token) != (!domain.has_value()));
+    auto& prefix = domain.has_value() ? *domain : action_key_prefixes[(int)type];
 
-    switch(n.f.type) {
-    case kRuntime: {
-        auto rt = GETPOINTER(rt_group, n.group);
-        for(auto& act : rt->actions) {
-            switch(act.get_data_type()) {
-            case kTokenKey:
-            case kTokenFullKey:
-            case kAssetKey: {
-                free(GETPOINTER(void, act.data));
-                break;
-            }
-            case kTokenKeys: {
-                auto p = GETPOINTER(rt_token_keys, act.data);
-                //need to call dtor of keys manually
-                p->keys.~token_keys_t();
-                free(p);
-                break;
-            }
-            }  // switch
-        }
-        db_->ReleaseSnapshot((const rocksdb::Snapshot*)rt->rb_snapshot);
-        delete rt;
-        break;
+    auto g = stats_guard(my_->get_stats(type), kStatsWrite);
+    for(auto& d : data) {
+        g.bytes += d.size();
     }
-    case kPersist: {
-        auto pd = GETPOINTER(pd_group, n.group);
-        delete pd;
-        break;
+    if(op != action_op::update) {
+        for(auto& k : keys) {
+            add_token_value(db_token_key(prefix, k).as_slice());
+        }
     }
-    }  // switch
+    my_->put_tokens(type, op, prefix, std::move(keys), data);
 }
 
 void
-token_database_impl::free_all_savepoints() {
-    while(!savepoints_.empty()) {
-        free_savepoint(savepoints_.front());
-        savepoints_.pop_front();
-    }
+token_database::put_asset(const address& addr, const symbol_id_type sym_id, const std::string_view& data) {
+    using namespace internal;
+
+    auto g  = stats_guard(my_->get_stats(token_type::asset), kStatsWrite);
+    g.bytes = data.size();
+    my_->put_asset(addr, sym_id, data);
 }
 
-void
-token_database_impl::pop_savepoints(int64_t until) {
-    while(!savepoints_.empty() && savepoints_.front().seq < until) {
-        auto it = std::move(savepoints_.front());
-        savepoints_.pop_front();
-        free_savepoint(it);
+int
+token_database::exists_token(token_type type, const std::optional<name128>& domain, const name128& key) const {
+    using namespace internal;
 
-        // pop write cache and persist into underlying db
-        assert(assets_write_cache_.ops_.front().seq == it.seq);
-        auto batch = rocksdb::WriteBatch();
-        assets_write_cache_.pop_front([&](auto& k, auto&& v) {
-            batch.Put(assets_handle_, rocksdb::Slice(k.data(), k.size()), v);
-        });
-        auto sync_write_opts = write_opts_;
-        sync_write_opts.sync = true;
-        db_->Write(sync_write_opts, &batch);
-    }
+    assert(type != token_type::asset);
+    assert((type == token_type::token) != (!domain.has_value()));
+    auto& prefix = domain.has_value() ? *domain : action_key_prefixes[(int)type];
+
+    auto g = stats_guard(my_->get_stats(type), kStatsExists);
+    return my_->exists_token(prefix, key);
 }
 
-void
-token_database_impl::pop_back_savepoint() {
-    EVT_ASSERT(!savepoints_.empty(), token_database_no_savepoint, "There's no savepoints anymore");
+int
+token_database::exists_asset(const address& addr, const symbol_id_type sym_id) const {
+    using namespace internal;
 
-    auto it = std::move(savepoints_.back());
-    savepoints_.pop_back();
-    free_savepoint(it);
+    auto g = stats_guard(my_->get_stats(token_type::asset), kStatsExists);
+    return my_->exists_asset(addr, sym_id);
+}
 
-    assets_write_cache_.pop_back();
+int
+token_database::read_token(token_type type, const std::optional<name128>& domain, const name128& key, std::string& out, bool no_throw) const {
+    using namespace internal;
+
+    assert(type != token_type::asset);
+    assert((type == token_type::token) != (!domain.has_value()));
+    auto& prefix = domain.has_value() ? *domain : action_key_prefixes[(int)type];
+
+    auto g = stats_guard(my_->get_stats(type), kStatsRead);
+    auto r = my_->read_token(prefix, key, out, no_throw);
+    g.bytes = out.size();
+    return r;
 }
 
-void
-token_database_impl::squash() {
+int
+token_database::read_token(token_type type, const std::optional<name128>& domain, const name128& key, const read_view_func& func, bool no_throw) const {
     using namespace internal;
-    EVT_ASSERT(savepoints_.size() >= 2, token_database_squash_exception, "Squash needs at least two savepoints.");
-    
-    auto n = savepoints_.back().node;
-    EVT_ASSERT(n.f.type == kRuntime, token_database_squash_exception, "Squash needs two realtime savepoints.");
 
-    savepoints_.pop_back();
-    auto n2 = savepoints_.back().node;
-    EVT_ASSERT(n2.f.type == kRuntime, token_database_squash_exception, "Squash needs two realtime savepoints.");
+    assert(type != token_type::asset);
+    assert((type == token_type::token) != (!domain.has_value()));
+    auto& prefix = domain.has_value() ? *domain : action_key_prefixes[(int)type];
 
-    auto rt1 = GETPOINTER(rt_group, n.group);
-    auto rt2 = GETPOINTER(rt_group, n2.group);
+    auto g = stats_guard(my_->get_stats(type), kStatsRead);
+    return my_->read_token(prefix, key, [&](auto& v) { g.bytes = v.size(); func(v); }, no_throw);
+}
 
-    // add all actions from rt1 into end of rt2
-    rt2->actions.insert(rt2->actions.cend(), rt1->actions.cbegin(), rt1->actions.cend());
+int
+token_database::read_asset(const address& addr, const symbol_id_type sym_id, std::string& out, bool no_throw) const {
+    using namespace internal;
 
-    // just release rt1's snapshot
-    db_->ReleaseSnapshot((const rocksdb::Snapshot*)rt1->rb_snapshot);
-    delete rt1;
+    auto g = stats_guard(my_->get_stats(token_type::asset), kStatsRead);
+    auto r = my_->read_asset(addr, sym_id, out, no_throw);
+    g.bytes = out.size();
+    return r;
+}
 
-    assets_write_cache_.squash();
+read_status
+token_database::try_read_token(token_type type, const std::optional<name128>& domain, const name128& key, const read_view_func& func) const {
+    return read_token(type, domain, key, func, true /* no throw */) ? read_status::found : read_status::not_found;
 }
 
-int64_t
-token_database_impl::latest_savepoint_seq() const {
-    EVT_ASSERT(!savepoints_.empty(), token_database_no_savepoint, "There's no savepoints anymore");
-    return savepoints_.back().seq;
+read_status
+token_database::try_read_asset(const address& addr, const symbol_id_type sym_id, std::string& out) const {
+    return read_asset(addr, sym_id, out, true /* no throw */) ? read_status::found : read_status::not_found;
 }
 
-int64_t
-token_database_impl::new_savepoint_session_seq() const {
-    int64_t seq = 1;
-    if(!savepoints_.empty()) {
-        seq = savepoints_.back().seq + 1;
+int
+token_database::read_tokens(token_type type,
+                            const std::optional<name128>& domain,
+                            const small_vector_base<name128>& keys,
+                            small_vector_base<std::string>& outs,
+                            bool no_throw) const {
+    using namespace internal;
+
+    assert(type != token_type::asset);
+    assert((type == token_type::token) != (!domain.has_value()));
+    auto& prefix = domain.has_value() ? *domain : action_key_prefixes[(int)type];
+
+    auto g = stats_guard(my_->get_stats(type), kStatsRead);
+    auto r = my_->read_tokens(prefix, keys, outs, no_throw);
+    for(auto& o : outs) {
+        g.bytes += o.size();
     }
-    return seq;
+    return r;
 }
 
-void
-token_database_impl::record(uint8_t action_type, uint8_t op, uint8_t data_type, void* data) {
+int
+token_database::read_tokens_range(token_type type, const std::optional<name128>& domain, int skip, const read_value_func& func) const {
     using namespace internal;
 
-    if(!should_record()) {
-        return;
-    }
-    auto n = savepoints_.back().node;
-    assert(n.f.type == kRuntime);
+    assert(type != token_type::asset);
+    assert((type == token_type::token) != (!domain.has_value()));
+    auto& prefix = domain.has_value() ? *domain : action_key_prefixes[(int)type];
 
-    GETPOINTER(rt_group, n.group)->actions.emplace_back(rt_action(action_type, op, data_type, data));
+    auto g = stats_guard(my_->get_stats(type), kStatsRead);
+    return my_->read_tokens_range(prefix, std::nullopt, skip, [&](auto& k, auto&& v) { g.bytes += v.size(); return func(k, std::move(v)); });
 }
 
-namespace internal {
+int
+token_database::read_assets_range(const symbol_id_type sym_id, int skip, const read_value_func& func) const {
+    using namespace internal;
 
-std::string
-get_sp_key(const rt_action& act) {
-    switch(act.get_data_type()) {
-    case kTokenKey: {
-        auto data = GETPOINTER(rt_token_key, act.data);
-        return db_token_key(action_key_prefixes[act.f.type], data->key).as_string();
-    }
-    case kTokenFullKey: {
-        auto data = GETPOINTER(rt_token_fullkey, act.data);
-        return db_token_key(data->prefix, data->key).as_string();
-    }
-    case kAssetKey: {
-        auto data = GETPOINTER(rt_asset_key, act.data);
-        return std::string(data->key, sizeof(data->key));
-    }
-    case kTokenKeys: {
-        assert(false);
-    }
-    }  // switch
-    return std::string();
+    auto g = stats_guard(my_->get_stats(token_type::asset), kStatsRead);
+    return my_->read_assets_range(sym_id, std::nullopt, skip, [&](auto& k, auto&& v) { g.bytes += v.size(); return func(k, std::move(v)); });
 }
 
-}  // namespace internal
-
-void
-token_database_impl::rollback_rt_group(internal::rt_group* rt) {
+int
+token_database::read_tokens_range(token_type type,
+                                  const std::optional<name128>& domain,
+                                  const std::optional<name128>& start,
+                                  const read_value_func& func) const {
     using namespace internal;
 
-    if(rt->actions.empty()) {
-        db_->ReleaseSnapshot((const rocksdb::Snapshot*)rt->rb_snapshot);
-        return;
-    }
+    assert(type != token_type::asset);
+    assert((type == token_type::token) != (!domain.has_value()));
+    auto& prefix = domain.has_value() ? *domain : action_key_prefixes[(int)type];
 
-    auto snapshot_read_opts_     = read_opts_;
-    snapshot_read_opts_.snapshot = (const rocksdb::Snapshot*)rt->rb_snapshot;
+    auto g = stats_guard(my_->get_stats(type), kStatsRead);
+    return my_->read_tokens_range(prefix, start, 0, [&](auto& k, auto&& v) { g.bytes += v.size(); return func(k, std::move(v)); });
+}
 
-    auto key_set = keys_hash_set();
-    auto batch   = rocksdb::WriteBatch();
-    
-    for(auto it = rt->actions.begin(); it < rt->actions.end(); it++) {
-        auto data = GETPOINTER(void, it->data);
+int
+token_database::read_tokens_by_owner(const address& addr, const std::optional<name128>& domain, const read_owner_func& func) const {
+    return my_->read_tokens_by_owner(addr, domain, func);
+}
 
-        auto fn = [&](auto& key, auto type, auto op) {
-            switch(op) {
-            case action_op::add: {
-                assert(key_set.find(key) == key_set.end());
+int
+token_database::read_assets_by_address(const address& addr, const read_asset_index_func& func) const {
+    return my_->read_assets_by_address(addr, func);
+}
 
-                batch.Delete(key);
-                self_.remove_token_value(key);
-            
-                // insert key into key set
-                key_set.insert(key);
-                break;
-            }
-            case action_op::update: {
-                // only update operation need to check if key is already processed
-                if(key_set.find(key) != key_set.end()) {
-                    break;
-                }
-                auto old_value = std::string();
-                auto status    = db_->Get(snapshot_read_opts_, key, &old_value);
-                if(!status.ok()) {
-                    FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
-                }
-                batch.Put(key, old_value);
-                self_.rollback_token_value(key);
+int
+token_database::read_expiry_range(token_type type, const fc::time_point_sec& until, const read_expiry_func& func) const {
+    return my_->read_expiry_range(type, until, func);
+}
+
+int
+token_database::read_assets_range(const symbol_id_type sym_id, const std::optional<address>& start, const read_value_func& func) const {
+    using namespace internal;
+
+    auto g = stats_guard(my_->get_stats(token_type::asset), kStatsRead);
+    return my_->read_assets_range(sym_id, start, 0, [&](auto& k, auto&& v) { g.bytes += v.size(); return func(k, std::move(v)); });
+}
 
-                // insert key into key set
-                key_set.insert(key);
-                break;
-            }
-            case action_op::put: {
-                // only update operation need to check if key is already processed
-                if(key_set.find(key) != key_set.end()) {
-                    break;
-                }
+int
+token_database::read_assets_range(const symbol_id_type sym_id, const std::string_view& start, const read_value_func& func) const {
+    using namespace internal;
 
-                // Asset type only has put op
-                auto handle    = (type == token_type::asset) ? assets_handle_ : tokens_handle_;
-                auto old_value = std::string();
-                auto status    = db_->Get(snapshot_read_opts_, handle, key, &old_value);
+    auto g = stats_guard(my_->get_stats(token_type::asset), kStatsRead);
+    return my_->read_assets_range(sym_id, start, [&](auto& k, auto&& v) { g.bytes += v.size(); return func(k, std::move(v)); });
+}
 
-                // key may not existed in latest snapshot, remove it
-                if(!status.ok()) {
-                    if(status.code() != rocksdb::Status::kNotFound) {
-                        FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
-                    }
-                    batch.Delete(handle, key);
-                    if(handle == tokens_handle_) {
-                        self_.remove_token_value(key);
-                    }
-                }
-                else {
-                    batch.Put(handle, key, old_value);
-                    if(handle == tokens_handle_) {
-                        self_.rollback_token_value(key);
-                    }
-                }
+token_database::session
+token_database::new_savepoint_session(int64_t seq) {
+    flush_cache_values();
+    my_->add_savepoint(seq);
+    return session(*this, seq);
+}
 
-                // insert key into key set
-                key_set.insert(key);
-                break;
-            }
-            }  // switch
-        };
+token_database::session
+token_database::new_savepoint_session() {
+    flush_cache_values();
+    auto seq = my_->new_savepoint_session_seq();
+    my_->add_savepoint(seq);
+    return session(*this, seq);
+}
 
-        auto op         = it->get_action_op();
-        auto data_type  = it->get_data_type();
-        auto type       = it->get_token_type();
+size_t
+token_database::savepoints_size() const {
+    return my_->savepoints_size();
+}
 
-        switch(data_type) {
-        case kTokenKey:
-        case kTokenFullKey:
-        case kAssetKey: {
-            auto key  = get_sp_key(*it);
-            fn(key, type, op);
-            break;
-        }
-        case kTokenKeys: {
-            auto  keys   = (rt_token_keys*)data;
-            auto& prefix = keys->prefix;
-            for(auto& k : keys->keys) {
-                auto key = db_token_key(prefix, k).as_string();
-                fn(key, type, op);
-            }
+void
+token_database::add_savepoint(int64_t seq) {
+    flush_cache_values();
+    my_->add_savepoint(seq);
+}
 
-            //need to call dtor of keys manually
-            keys->keys.~token_keys_t();
-            break;
-        }
-        }  // switch
+void
+token_database::rollback_to_latest_savepoint() {
+    discard_cache_values();
+    my_->rollback_to_latest_savepoint();
+}
 
-        free(data);
-    }  // for
+void
+token_database::pop_savepoints(int64_t until) {
+    flush_cache_values();
+    my_->pop_savepoints(until);
+}
 
-    auto sync_write_opts = write_opts_;
-    sync_write_opts.sync = true;
-    db_->Write(sync_write_opts, &batch);
+void
+token_database::pop_back_savepoint() {
+    flush_cache_values();
+    my_->pop_back_savepoint();
+}
 
-    db_->ReleaseSnapshot((const rocksdb::Snapshot*)rt->rb_snapshot);
+void
+token_database::squash() {
+    flush_cache_values();
+    my_->squash();
+}
+
+int64_t
+token_database::latest_savepoint_seq() const {
+    return my_->latest_savepoint_seq();
+}
+
+std::string
+token_database::stats() const {
+    auto s = std::string();
+    if(my_->db_->GetProperty(rocksdb::DB::Properties::kStats, &s)) {
+        return s;
+    }
+    return "NA";
+}
+
+token_database_metrics
+token_database::metrics() const {
+    return my_->get_metrics();
+}
+
+token_database_memory_usage
+token_database::memory_usage() const {
+    return my_->get_memory_usage();
 }
 
 void
-token_database_impl::rollback_pd_group(internal::pd_group* pd) {
+token_database::ingest_tokens(token_type type, const std::optional<name128>& domain, const bulk_entries_t& entries) {
     using namespace internal;
+    using contracts::token_def;
 
-    if(pd->actions.empty()) {
-        return;
-    }
+    assert(type != token_type::asset);
+    assert((type == token_type::token) != (!domain.has_value()));
+    EVT_ASSERT(my_->savepoints_.empty(), token_database_exception, "Cannot ingest tokens when there're savepoints");
 
-    // keyset is not required here,
-    // because it has done during creating persist savepoint
-    // cache rollback is also no need here
-    // because cache cannot have persist value objects
-    auto batch = rocksdb::WriteBatch();
-    for(auto it = pd->actions.begin(); it < pd->actions.end(); it++) {
-        switch((action_op)it->op) {
-        case action_op::add: {
-            assert(it->value.empty());
-            batch.Delete(it->key);
-            break;
+    auto& prefix = domain.has_value() ? *domain : action_key_prefixes[(int)type];
+    my_->ingest(my_->get_handle((int)type), std::string_view((const char*)&prefix, sizeof(prefix)), entries);
+
+    if(type == token_type::token && my_->owners_handle_) {
+        auto batch = rocksdb::WriteBatch();
+        for(auto& e : entries) {
+            auto token = token_def();
+            extract_db_value(std::string_view(e.second), token);
+            for(auto& o : token.owner) {
+                auto dbkey = db_owner_key(o, token.domain, token.name);
+                batch.Put(my_->owners_handle_, dbkey.as_slice(), kOwnerKeyValue);
+            }
         }
-        case action_op::update: {
-            assert(!it->value.empty());
-            batch.Put(it->key, it->value);
-            break;
+        auto status = my_->db_->Write(my_->write_opts_, &batch);
+        if(!status.ok()) {
+            EVT_THROW(token_database_rocksdb_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
         }
-        case action_op::put: {
-            // Asset type only has put op
-            auto handle = (it->type == (int)token_type::asset) ? assets_handle_ : tokens_handle_;
-            if(it->value.empty()) {
-                batch.Delete(handle, it->key);
-            }
-            else {
-                batch.Put(handle, it->key, it->value);
+    }
+    else if(has_expiry_index(type) && my_->owners_handle_) {
+        auto addr  = get_expiry_index_address(type);
+        auto batch = rocksdb::WriteBatch();
+        for(auto& e : entries) {
+            auto expiry = get_expiry(type, std::string_view(e.second));
+            if(expiry.has_value()) {
+                auto name = name128();
+                memcpy(&name, e.first.data(), sizeof(name128));
+
+                auto dbkey = db_owner_key(addr, get_expiry_index_slot(*expiry), name);
+                batch.Put(my_->owners_handle_, dbkey.as_slice(), kOwnerKeyValue);
             }
-            break;
         }
-        }  // switch
+        auto status = my_->db_->Write(my_->write_opts_, &batch);
+        if(!status.ok()) {
+            EVT_THROW(token_database_rocksdb_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+        }
     }
-
-    auto sync_write_opts = write_opts_;
-    sync_write_opts.sync = true;
-    db_->Write(sync_write_opts, &batch);
 }
 
 void
-token_database_impl::rollback_to_latest_savepoint() {
-    using namespace internal;
-    EVT_ASSERT(!savepoints_.empty(), token_database_no_savepoint, "There's no savepoints anymore");
+token_database::ingest_assets(const symbol_id_type sym_id, const bulk_entries_t& entries) {
+    EVT_ASSERT(my_->savepoints_.empty(), token_database_exception, "Cannot ingest assets when there're savepoints");
+    // it may run in several threads, the aggregates cannot be rebuilt here
+    EVT_ASSERT(my_->aggregates_.empty(), token_database_exception, "Cannot ingest assets when there're aggregates registered");
+    my_->ingest(my_->assets_handle_, std::string_view((const char*)&sym_id, sizeof(sym_id)), entries);
 
-    auto  seq = savepoints_.back().seq;
-    auto& n   = savepoints_.back().node;
+    if(my_->owners_handle_) {
+        auto batch = rocksdb::WriteBatch();
+        auto key   = std::string((const char*)&sym_id, sizeof(sym_id));
+        for(auto& e : entries) {
+            key.resize(sizeof(sym_id));
+            key.append(e.first);
+            batch.Put(my_->owners_handle_, get_asset_index_key(key), kOwnerKeyValue);
+        }
+        auto status = my_->db_->Write(my_->write_opts_, &batch);
+        if(!status.ok()) {
+            EVT_THROW(token_database_rocksdb_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+        }
+    }
+}
 
-    switch(n.f.type) {
-    case kRuntime: {
-        auto rt = GETPOINTER(rt_group, n.group);
-        rollback_rt_group(rt);
-        delete rt;
+namespace internal {
 
-        break;
+// collects keys of write batches, column family of each key is classified by its id
+class raw_keys_handler : public rocksdb::WriteBatch::Handler {
+public:
+    raw_keys_handler(const token_database_impl& db, const token_database::raw_key_func& func)
+        : db_(db)
+        , func_(func) {}
+
+public:
+    rocksdb::Status
+    PutCF(uint32_t cf, const rocksdb::Slice& key, const rocksdb::Slice&) override {
+        return on_key(cf, key);
     }
-    case kPersist: {
-        auto pd = GETPOINTER(pd_group, n.group);
-        rollback_pd_group(pd);
-        delete pd;
 
-        break;
+    rocksdb::Status
+    DeleteCF(uint32_t cf, const rocksdb::Slice& key) override {
+        return on_key(cf, key);
     }
-    }  // switch
 
-    savepoints_.pop_back();
+    rocksdb::Status
+    SingleDeleteCF(uint32_t cf, const rocksdb::Slice& key) override {
+        return on_key(cf, key);
+    }
 
-    assert(seq == assets_write_cache_.ops_.back().seq);
-    assets_write_cache_.rollback_to_latest_savepoint();
-}
+    rocksdb::Status
+    MergeCF(uint32_t cf, const rocksdb::Slice& key, const rocksdb::Slice&) override {
+        return on_key(cf, key);
+    }
 
-void
-token_database_impl::persist_savepoints() const {
-    using namespace internal;
+    rocksdb::Status
+    DeleteRangeCF(uint32_t, const rocksdb::Slice&, const rocksdb::Slice&) override {
+        return rocksdb::Status::NotSupported("Range deletion is not supported");
+    }
 
-    try {
-        auto filename = config_.db_path / config::token_database_persisit_filename;
-        if(fc::exists(filename)) {
-            fc::remove(filename);
-        }
-        auto fs = std::fstream();
-        fs.exceptions(std::fstream::failbit | std::fstream::badbit);
-        fs.open(filename.to_native_ansi_path(), (std::ios::out | std::ios::binary));
+    void LogData(const rocksdb::Slice&) override {}
 
-        auto h = pd_header {
-            .dirty_flag = 1
-        };
-        // set dirty first
-        fc::raw::pack(fs, h);
+private:
+    rocksdb::Status
+    on_key(uint32_t cf, const rocksdb::Slice& key) {
+        using raw_column = token_database::raw_column;
 
-        persist_savepoints(fs);
-        assets_write_cache_.persist_savepoints(fs);
+        if(cf == db_.assets_handle_->GetID()) {
+            func_(raw_column::assets, key.ToStringView());
+        }
+        else if(db_.owners_handle_ != nullptr && cf == db_.owners_handle_->GetID()) {
+            func_(raw_column::owners, key.ToStringView());
+        }
+        else {
+            // default and all the type columns
+            func_(raw_column::tokens, key.ToStringView());
+        }
+        return rocksdb::Status::OK();
+    }
 
-        // clear dirty
-        fs.seekp(0);
-        h.dirty_flag = 0;
-        fc::raw::pack(fs, h);
+private:
+    const token_database_impl&          db_;
+    const token_database::raw_key_func& func_;
+};
 
-        // flush and close
-        fs.flush();
-        fs.close();
-    }
-    EVT_CAPTURE_AND_RETHROW(token_database_persist_exception);
+}  // namespace internal
+
+uint64_t
+token_database::latest_sequence() const {
+    return my_->db_->GetLatestSequenceNumber();
 }
 
 void
-token_database_impl::load_savepoints() {
-    auto filename = config_.db_path / config::token_database_persisit_filename;
-    if(!fc::exists(filename)) {
-        wlog("No savepoints log in token database");
+token_database::read_changed_keys(uint64_t seq, const raw_key_func& func) const {
+    using namespace internal;
+
+    auto latest = my_->db_->GetLatestSequenceNumber();
+    if(latest <= seq) {
         return;
     }
 
-    auto fs = std::fstream();
-    fs.exceptions(std::fstream::failbit | std::fstream::badbit);
-    fs.open(filename.to_native_ansi_path(), (std::ios::in | std::ios::binary));
+    auto it     = std::unique_ptr<rocksdb::TransactionLogIterator>();
+    auto status = my_->db_->GetUpdatesSince(seq + 1, &it);
+    if(!status.ok()) {
+        EVT_THROW(token_database_rocksdb_exception, "Cannot read wal since sequence: ${seq}, ${err}", ("seq", seq)("err", status.getState()));
+    }
 
-    // delete old savepoints if existed (from snapshot)
-    savepoints_.clear();
-    assets_write_cache_.clear();
+    auto handler = raw_keys_handler(*my_, func);
+    auto next    = seq + 1;
+    for(; it->Valid(); it->Next()) {
+        auto batch = it->GetBatch();
+        // a gap in sequences means the writes in between are not in wal
+        EVT_ASSERT(batch.sequence <= next, token_database_exception,
+            "Changes of sequences [${from}, ${to}) are not in wal", ("from", next)("to", batch.sequence));
 
-    // load
-    load_savepoints(fs);
-    assets_write_cache_.load_savepoints(fs);
+        status = batch.writeBatchPtr->Iterate(&handler);
+        if(!status.ok()) {
+            EVT_THROW(token_database_rocksdb_exception, "Cannot iterate write batch in wal: ${err}", ("err", status.getState()));
+        }
+        next = std::max<uint64_t>(next, batch.sequence + batch.writeBatchPtr->Count());
+    }
+    if(!it->status().ok()) {
+        EVT_THROW(token_database_rocksdb_exception, "Cannot read wal: ${err}", ("err", it->status().getState()));
+    }
+    EVT_ASSERT(next > latest, token_database_exception,
+        "Changes of sequences [${from}, ${to}] are not in wal", ("from", next)("to", latest));
+}
 
-    // close
-    fs.close();
+void
+token_database::read_volatile_keys(const raw_key_func& func) const {
+    using namespace internal;
+
+    for(auto& it : my_->tokens_write_cache_.data_) {
+        func(raw_column::tokens, std::string_view(it.first().data(), it.first().size()));
+    }
+    for(auto& it : my_->assets_write_cache_.data_) {
+        func(raw_column::assets, std::string_view(it.first().data(), it.first().size()));
+    }
+    if(my_->has_batch()) {
+        // pending writes of owner index
+        auto handler = raw_keys_handler(*my_, func);
+        my_->batch_.GetWriteBatch()->Iterate(&handler);
+    }
 }
 
 void
-token_database_impl::persist_savepoints(std::ostream& os) const {
+token_database::read_savepoint_keys(int64_t seq, const raw_key_func& func) {
     using namespace internal;
 
-    auto pds = std::vector<pd_group>();
+    flush_cache_values();
 
-    for(auto i = 0u; i < savepoints_.size(); i++) {
-        auto& sp = savepoints_[i];
+    auto& savepoints = my_->savepoints_;
+    auto  i          = 0u;
+    while(i < savepoints.size() && savepoints[i].seq != seq) {
+        i++;
+    }
+    EVT_ASSERT(i < savepoints.size(), token_database_no_savepoint, "Cannot find savepoint with seq: ${s}", ("s",seq));
 
-        auto pd = pd_group();
-        pd.seq  = sp.seq;
+    auto n = savepoints[i].node;
+    EVT_ASSERT(n.f.type == kRuntime, token_database_exception, "Keys are only available in realtime savepoints");
 
-        auto n = sp.node;
+    auto key_set = keys_hash_set();
+    auto on_key  = [&](auto column, auto&& key) {
+        if(key_set.insert(key).second) {
+            func(column, key);
+        }
+    };
 
-        switch(n.f.type) {
-        case kPersist: {
-            auto pd2 = GETPOINTER(pd_group, n.group);
-            pd.actions.insert(pd.actions.cbegin(), pd2->actions.cbegin(), pd2->actions.cend());
-            
+    auto rt = GETPOINTER(rt_group, n.group);
+    for(auto& act : rt->actions) {
+        switch(act.get_data_type()) {
+        case kTokenKey:
+        case kTokenFullKey: {
+            on_key(raw_column::tokens, get_sp_key(act));
+            break;
+        }
+        case kAssetKey: {
+            on_key(raw_column::assets, get_sp_key(act));
+            break;
+        }
+        case kOwnerKey: {
+            on_key(raw_column::owners, get_sp_key(act));
+            break;
+        }
+        case kTokenKeys: {
+            auto keys = GETPOINTER(rt_token_keys, act.data);
+            for(auto& k : keys->keys) {
+                on_key(raw_column::tokens, db_token_key(keys->prefix, k).as_string());
+            }
             break;
         }
-        case kRuntime: {
-            auto rt = GETPOINTER(rt_group, n.group);
-
-            auto key_set = keys_hash_set();
+        }  // switch
+    }
+}
 
-            auto snapshot_read_opts_     = read_opts_;
-            snapshot_read_opts_.snapshot = (const rocksdb::Snapshot*)rt->rb_snapshot;
+void
+token_database::add_asset_aggregate(const symbol_id_type sym_id, int64_t threshold) {
+    my_->add_asset_aggregate(sym_id, threshold);
+}
 
-            for(auto& act : rt->actions) {
-                auto data = GETPOINTER(void, act.data);
+std::optional<asset_aggregate>
+token_database::read_asset_aggregate(const symbol_id_type sym_id, int64_t threshold) const {
+    return my_->read_asset_aggregate(sym_id, threshold);
+}
 
-                auto fn = [&](const auto& key, auto type, auto op) {
-                    auto value = std::string();
+fc::sha256
+token_database::state_digest() {
+    // values in object cache are not written into db yet
+    flush_cache_values();
+    return my_->state_digest();
+}
 
-                    switch(op) {
-                    case action_op::add: {
-                        assert(key_set.find(key) == key_set.end());
+fc::sha256
+token_database::build_state_digest() {
+    flush_cache_values();
+    return my_->build_state_digest();
+}
 
-                        // no need to read value
-                        key_set.insert(key);
-                        break;
-                    }
-                    case action_op::update: {
-                        if(key_set.find(key) != key_set.end()) {
-                            break;
-                        }
-
-                        auto status = db_->Get(snapshot_read_opts_, key, &value);
-                        if(!status.ok()) {
-                            FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
-                        }
-
-                        key_set.insert(key);
-                        break;
-                    }
-                    case action_op::put: {
-                        if(key_set.find(key) != key_set.end()) {
-                            break;
-                        }
-
-                        auto handle = (type == token_type::asset) ? assets_handle_ : tokens_handle_;
-                        auto status = db_->Get(snapshot_read_opts_, handle, key, &value);
-                        
-                        // key may not existed in latest snapshot
-                        if(!status.ok() && status.code() != rocksdb::Status::kNotFound) {
-                            FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
-                        }
-
-                        key_set.insert(key);
-                        break;
-                    }
-                    }  // switch
+bool
+token_database::read_raw(raw_column column, const std::string_view& key, std::string& out) const {
+    auto k      = rocksdb::Slice(key.data(), key.size());
+    auto status = rocksdb::Status();
 
-                    return value;
-                };
+    switch(column) {
+    case raw_column::tokens: {
+        status = my_->get_token_value(k, &out);
+        break;
+    }
+    case raw_column::assets: {
+        if(my_->assets_write_cache_.read(key, out)) {
+            return true;
+        }
+        status = my_->db_->Get(my_->read_opts_, my_->assets_handle_, k, &out);
+        break;
+    }
+    case raw_column::owners: {
+        if(my_->owners_handle_ == nullptr) {
+            return false;
+        }
+        status = my_->batch_.GetFromBatchAndDB(my_->db_, my_->read_opts_, my_->owners_handle_, k, &out);
+        break;
+    }
+    }  // switch
 
-                auto op         = act.get_action_op();
-                auto data_type  = act.get_data_type();
-                auto type       = act.get_token_type();
+    if(status.IsNotFound()) {
+        return false;
+    }
+    if(!status.ok()) {
+        EVT_THROW(token_database_rocksdb_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+    }
+    return true;
+}
 
-                auto pdact = pd_action();
-                pdact.op   = (int)op;
-                pdact.type = (int)type;
+void
+token_database::write_raw(const raw_entries_t& entries) {
+    EVT_ASSERT(my_->savepoints_.empty(), token_database_exception, "Cannot write raw entries when there're savepoints");
 
-                switch(data_type) {
-                case kTokenKey:
-                case kTokenFullKey:
-                case kAssetKey: {
-                    pdact.key   = get_sp_key(act);
-                    pdact.value = fn(pdact.key, type, op);
-                    pd.actions.emplace_back(std::move(pdact));
-                    break;
-                }
-                case kTokenKeys: {
-                    auto  keys   = (rt_token_keys*)data;
-                    auto& prefix = keys->prefix;
-                    for(auto& k : keys->keys) {
-                        pdact.key   = db_token_key(prefix, k).as_string();
-                        pdact.value = fn(pdact.key, type, op);
-                        pd.actions.emplace_back(pdact);
-                    }
-                    break;
-                }
-                }  // switch
-            }  // for
-            break;
-        }
+    auto batch = rocksdb::WriteBatch();
+    for(auto& e : entries) {
+        auto handle = (rocksdb::ColumnFamilyHandle*)nullptr;
+        switch(e.column) {
+        case raw_column::tokens: handle = my_->get_tokens_handle(e.key.data()); break;
+        case raw_column::assets: handle = my_->assets_handle_; break;
+        case raw_column::owners: handle = my_->owners_handle_; break;
         }  // switch
+        if(handle == nullptr) {
+            continue;
+        }
 
-        pds.emplace_back(std::move(pd));
-    }  // for
+        if(e.value.has_value()) {
+            batch.Put(handle, e.key, *e.value);
+        }
+        else {
+            batch.Delete(handle, e.key);
+        }
+    }
 
-    fc::raw::pack(os, pds);
+    auto status = my_->db_->Write(my_->write_opts_, &batch);
+    if(!status.ok()) {
+        EVT_THROW(token_database_rocksdb_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+    }
+    my_->reset_state_digest();
+    my_->rebuild_asset_aggregates();
 }
 
 void
-token_database_impl::load_savepoints(std::istream& is) {
+token_database::prefetch(const prefetch_keys_t& keys) const {
     using namespace internal;
 
-    auto h = pd_header();
-    fc::raw::unpack(is, h);
-    EVT_ASSERT(h.dirty_flag == 0, token_database_dirty_flag_exception, "checkpoints log file dirty flag set");
-
-    auto pds = std::vector<pd_group>();
-    fc::raw::unpack(is, pds);
-
-    for(auto& pd : pds) {
-        savepoints_.push_back(savepoint(pd.seq, kPersist));
+    auto dbkeys  = small_vector<std::string, 8>();
+    auto handles = std::vector<rocksdb::ColumnFamilyHandle*>();
+    dbkeys.reserve(keys.tokens.size() + keys.assets.size());
+    handles.reserve(keys.tokens.size() + keys.assets.size());
 
-        auto ppd = new pd_group(pd);
-        SETPOINTER(void, savepoints_.back().node.group, ppd);
+    for(auto& [type, domain, key] : keys.tokens) {
+        assert(type != token_type::asset);
+        auto& prefix = domain.has_value() ? *domain : action_key_prefixes[(int)type];
+        dbkeys.emplace_back(db_token_key(prefix, key).as_string());
+        handles.emplace_back(my_->get_tokens_handle((const char*)&prefix));
+    }
+    for(auto& [addr, sym_id] : keys.assets) {
+        dbkeys.emplace_back(db_asset_key(addr, sym_id).as_string());
+        handles.emplace_back(my_->assets_handle_);
+    }
+    if(dbkeys.empty() || my_->db_ == nullptr) {
+        return;
     }
+
+    auto slices = std::vector<rocksdb::Slice>(dbkeys.cbegin(), dbkeys.cend());
+    auto values = std::vector<std::string>();
+    // statuses are ignored, missing keys are fine here
+    my_->db_->MultiGet(my_->read_opts_, handles, slices, &values);
 }
 
 void
-token_database_impl::flush() const {
-    auto status = db_->Flush(rocksdb::FlushOptions());
-    if(!status.ok()) {
-        FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
-    }
+token_database::set_fast_writes(bool enable) {
+    my_->set_fast_writes(enable);
 }
 
-token_database::token_database(const config& config)
-    : my_(std::make_unique<token_database_impl>(*this, config)) {}
-
-token_database::~token_database() {
-    my_->close();
+bool
+token_database::is_secondary() const {
+    return !my_->config_.secondary_path.empty();
 }
 
 void
-token_database::open(int load_persistence) {
-    my_->open(load_persistence);
+token_database::catch_up_with_primary() {
+    my_->catch_up_with_primary();
+    clear_cache_values();
 }
 
 void
-token_database::close(int persist) {
-    my_->close(persist);
+token_database::create_checkpoint(const fc::path& dir) const {
+    my_->create_checkpoint(dir);
 }
 
 void
-token_database::put_token(token_type type, action_op op, const std::optional<name128>& domain, const name128& key, const std::string_view& data) {
-    using namespace internal;
-
-    assert(type != token_type::asset);
-    assert((type == token_type::token) != (!domain.has_value()));
-    auto& prefix = domain.has_value() ? *domain : action_key_prefixes[(int)type];
-    my_->put_token(type, op, prefix, key, data);
+token_database::restore_checkpoint(const fc::path& dir) {
+    my_->restore_checkpoint(dir);
 }
 
 void
-token_database::put_tokens(token_type type,
-                           action_op op,
-                           const std::optional<name128>& domain,
-                           token_keys_t&& keys,
-                           const small_vector_base<std::string_view>& data) {
-    using namespace internal;
+token_database::flush() const {
+    my_->flush();
+}
 
-    assert(type != token_type::asset);
-    assert((type == token_type::token) != (!domain.has_value()));
-    auto& prefix = domain.has_value() ? *domain : action_key_prefixes[(int)type];
-    my_->put_tokens(type, op, prefix, std::move(keys), data);
+void
+token_database::persist_savepoints(std::ostream& os) const {
+    my_->persist_savepoints(os);
 }
 
 void
-token_database::put_asset(const address& addr, const symbol_id_type sym_id, const std::string_view& data) {
-    my_->put_asset(addr, sym_id, data);
+token_database::load_savepoints(std::istream& is) {
+    my_->load_savepoints(is);
 }
 
-int
-token_database::exists_token(token_type type, const std::optional<name128>& domain, const name128& key) const {
-    using namespace internal;
+class token_database_read_view_impl : boost::noncopyable {
+public:
+    token_database_read_view_impl(const token_database_impl& tdb, int64_t until);
+    ~token_database_read_view_impl();
 
-    assert(type != token_type::asset);
-    assert((type == token_type::token) != (!domain.has_value()));
-    auto& prefix = domain.has_value() ? *domain : action_key_prefixes[(int)type];
-    return my_->exists_token(prefix, key);
+public:
+    int read(rocksdb::ColumnFamilyHandle* handle, const std::map<std::string, std::string>& cache, const rocksdb::Slice& key, std::string& out) const;
+    int scan(rocksdb::ColumnFamilyHandle* handle,
+             const std::map<std::string, std::string>& cache,
+             const rocksdb::Slice& prefix,
+             const rocksdb::Slice& seek,
+             int skip,
+             const read_value_func& func) const;
+
+public:
+    const token_database_impl& tdb_;
+    const rocksdb::Snapshot*   snapshot_;
+    rocksdb::ReadOptions       read_opts_;
+    int64_t                    seq_ = 0;
+
+    // copies of reversible writes, sorted in the same order as keys in db
+    std::map<std::string, std::string> tokens_;
+    std::map<std::string, std::string> assets_;
+};
+
+token_database_read_view_impl::token_database_read_view_impl(const token_database_impl& tdb, int64_t until)
+    : tdb_(tdb)
+    , snapshot_(tdb.db_->GetSnapshot())
+    , read_opts_(tdb.read_opts_) {
+    // tailing iterators don't support snapshots
+    read_opts_.tailing  = false;
+    read_opts_.snapshot = snapshot_;
+
+    for(auto i = 0u; i < tdb.savepoints_.size() && tdb.savepoints_[i].seq <= until; i++) {
+        seq_ = tdb.savepoints_[i].seq;
+    }
+    tdb.tokens_write_cache_.copy_until(until, tokens_);
+    tdb.assets_write_cache_.copy_until(until, assets_);
 }
 
-int
-token_database::exists_asset(const address& addr, const symbol_id_type sym_id) const {
-    return my_->exists_asset(addr, sym_id);
+token_database_read_view_impl::~token_database_read_view_impl() {
+    tdb_.db_->ReleaseSnapshot(snapshot_);
 }
 
 int
-token_database::read_token(token_type type, const std::optional<name128>& domain, const name128& key, std::string& out, bool no_throw) const {
-    using namespace internal;
+token_database_read_view_impl::read(rocksdb::ColumnFamilyHandle* handle, const std::map<std::string, std::string>& cache, const rocksdb::Slice& key, std::string& out) const {
+    if(auto it = cache.find(key.ToString()); it != cache.end()) {
+        out = it->second;
+        return true;
+    }
 
-    assert(type != token_type::asset);
-    assert((type == token_type::token) != (!domain.has_value()));
-    auto& prefix = domain.has_value() ? *domain : action_key_prefixes[(int)type];
-    return my_->read_token(prefix, key, out, no_throw);
+    auto status = tdb_.db_->Get(read_opts_, handle, key, &out);
+    if(!status.ok()) {
+        if(!status.IsNotFound()) {
+            FC_THROW_EXCEPTION(fc::unrecoverable_exception, "Rocksdb internal error: ${err}", ("err", status.getState()));
+        }
+        return false;
+    }
+    return true;
 }
 
+// same as `scan_range` but values in db are merged with the cached ones
 int
-token_database::read_asset(const address& addr, const symbol_id_type sym_id, std::string& out, bool no_throw) const {
-    return my_->read_asset(addr, sym_id, out, no_throw);
+token_database_read_view_impl::scan(rocksdb::ColumnFamilyHandle* handle,
+                                    const std::map<std::string, std::string>& cache,
+                                    const rocksdb::Slice& prefix,
+                                    const rocksdb::Slice& seek,
+                                    int skip,
+                                    const read_value_func& func) const {
+    auto in_range = [&prefix](auto& k) {
+        return k.size() >= prefix.size() && memcmp(k.data(), prefix.data(), prefix.size()) == 0;
+    };
+
+    auto it  = std::unique_ptr<rocksdb::Iterator>(tdb_.db_->NewIterator(read_opts_, handle));
+    auto cit = cache.lower_bound(seek.ToString());
+    it->Seek(seek);
+    if(seek.size() > prefix.size()) {
+        if(it->Valid() && it->key() == seek) {
+            it->Next();
+        }
+        if(cit != cache.end() && cit->first == seek.ToStringView()) {
+            cit++;
+        }
+    }
+
+    auto i     = 0;
+    auto count = 0;
+    while(true) {
+        auto db_valid    = it->Valid() && in_range(it->key());
+        auto cache_valid = cit != cache.end() && in_range(cit->first);
+        if(!db_valid && !cache_valid) {
+            break;
+        }
+
+        auto cmp = !db_valid ? 1 : (!cache_valid ? -1 : it->key().compare(rocksdb::Slice(cit->first)));
+        if(i++ >= skip) {
+            count++;
+            auto key   = (cmp < 0) ? it->key() : rocksdb::Slice(cit->first);
+            auto value = (cmp < 0) ? it->value().ToString() : cit->second;
+
+            key.remove_prefix(prefix.size());
+            if(!func(key.ToStringView(), std::move(value))) {
+                return count;
+            }
+        }
+
+        // cached values override the ones in db
+        if(cmp <= 0) {
+            it->Next();
+        }
+        if(cmp >= 0) {
+            cit++;
+        }
+    }
+    return count;
 }
 
+token_database_read_view::token_database_read_view(std::unique_ptr<token_database_read_view_impl>&& my)
+    : my_(std::move(my)) {}
+
+token_database_read_view::~token_database_read_view() = default;
+
 int
-token_database::read_tokens_range(token_type type, const std::optional<name128>& domain, int skip, const read_value_func& func) const {
+token_database_read_view::read_token(token_type type, const std::optional<name128>& domain, const name128& key, std::string& out, bool no_throw) const {
     using namespace internal;
 
     assert(type != token_type::asset);
     assert((type == token_type::token) != (!domain.has_value()));
     auto& prefix = domain.has_value() ? *domain : action_key_prefixes[(int)type];
-    return my_->read_tokens_range(prefix, skip, func);
+
+    auto dbkey = db_token_key(prefix, key);
+    if(!my_->read(my_->tdb_.get_tokens_handle((const char*)&prefix), my_->tokens_, dbkey.as_slice(), out)) {
+        if(!no_throw) {
+            EVT_THROW(unknown_token_database_key, "Cannot find key: ${k} with prefix: ${p}", ("k",key)("p",prefix));
+        }
+        return false;
+    }
+    return true;
 }
 
 int
-token_database::read_assets_range(const symbol_id_type sym_id, int skip, const read_value_func& func) const {
-    return my_->read_assets_range(sym_id, skip, func);
-}
+token_database_read_view::read_asset(const address& addr, const symbol_id_type sym_id, std::string& out, bool no_throw) const {
+    using namespace internal;
 
-token_database::session
-token_database::new_savepoint_session(int64_t seq) {
-    my_->add_savepoint(seq);
-    return session(*this, seq);
+    auto dbkey = db_asset_key(addr, sym_id);
+    if(!my_->read(my_->tdb_.assets_handle_, my_->assets_, dbkey.as_slice(), out)) {
+        if(!no_throw) {
+            EVT_THROW2(unknown_token_database_key, "There's no balance of fungible with sym id: {} in address: {}", sym_id, addr);
+        }
+        return false;
+    }
+    return true;
 }
 
-token_database::session
-token_database::new_savepoint_session() {
-    auto seq = my_->new_savepoint_session_seq();
-    my_->add_savepoint(seq);
-    return session(*this, seq);
-}
+int
+token_database_read_view::read_tokens_range(token_type type, const std::optional<name128>& domain, int skip, const read_value_func& func) const {
+    using namespace internal;
 
-size_t
-token_database::savepoints_size() const {
-    return my_->savepoints_size();
-}
+    assert(type != token_type::asset);
+    assert((type == token_type::token) != (!domain.has_value()));
+    auto& prefix = domain.has_value() ? *domain : action_key_prefixes[(int)type];
 
-void
-token_database::add_savepoint(int64_t seq) {
-    my_->add_savepoint(seq);
+    auto ps = rocksdb::Slice((char*)&prefix, sizeof(prefix));
+    return my_->scan(my_->tdb_.get_tokens_handle(ps.data()), my_->tokens_, ps, ps, skip, func);
 }
 
-void
-token_database::rollback_to_latest_savepoint() {
-    my_->rollback_to_latest_savepoint();
-}
+int
+token_database_read_view::read_tokens_range(token_type type,
+                                            const std::optional<name128>& domain,
+                                            const std::optional<name128>& start,
+                                            const read_value_func& func) const {
+    using namespace internal;
 
-void
-token_database::pop_savepoints(int64_t until) {
-    my_->pop_savepoints(until);
-}
+    assert(type != token_type::asset);
+    assert((type == token_type::token) != (!domain.has_value()));
+    auto& prefix = domain.has_value() ? *domain : action_key_prefixes[(int)type];
 
-void
-token_database::pop_back_savepoint() {
-    my_->pop_back_savepoint();
+    auto ps = rocksdb::Slice((char*)&prefix, sizeof(prefix));
+    if(start.has_value()) {
+        auto key = db_token_key(prefix, *start);
+        return my_->scan(my_->tdb_.get_tokens_handle(ps.data()), my_->tokens_, ps, key.as_slice(), 0, func);
+    }
+    return my_->scan(my_->tdb_.get_tokens_handle(ps.data()), my_->tokens_, ps, ps, 0, func);
 }
 
-void
-token_database::squash() {
-    my_->squash();
+int
+token_database_read_view::read_assets_range(const symbol_id_type sym_id, int skip, const read_value_func& func) const {
+    auto ps = rocksdb::Slice((char*)&sym_id, sizeof(sym_id));
+    return my_->scan(my_->tdb_.assets_handle_, my_->assets_, ps, ps, skip, func);
 }
 
-int64_t
-token_database::latest_savepoint_seq() const {
-    return my_->latest_savepoint_seq();
-}
+int
+token_database_read_view::read_assets_range(const symbol_id_type sym_id, const std::optional<address>& start, const read_value_func& func) const {
+    using namespace internal;
 
-std::string
-token_database::stats() const {
-    auto s = std::string();
-    if(my_->db_->GetProperty(rocksdb::DB::Properties::kStats, &s)) {
-        return s;
+    auto ps = rocksdb::Slice((char*)&sym_id, sizeof(sym_id));
+    if(start.has_value()) {
+        auto key = db_asset_key(*start, sym_id);
+        return my_->scan(my_->tdb_.assets_handle_, my_->assets_, ps, key.as_slice(), 0, func);
     }
-    return "NA";
-}
-
-void
-token_database::flush() const {
-    my_->flush();
+    return my_->scan(my_->tdb_.assets_handle_, my_->assets_, ps, ps, 0, func);
 }
 
-void
-token_database::persist_savepoints(std::ostream& os) const {
-    my_->persist_savepoints(os);
+int64_t
+token_database_read_view::seq() const {
+    return my_->seq_;
 }
 
-void
-token_database::load_savepoints(std::istream& is) {
-    my_->load_savepoints(is);
+token_database_read_view_ptr
+token_database::create_read_view(int64_t until) {
+    flush_cache_values();
+    return token_database_read_view_ptr(new token_database_read_view(std::make_unique<token_database_read_view_impl>(*my_, until)));
 }
 
-std::string
-token_database::get_db_key(token_type type, const std::optional<name128>& domain, const name128& key) {
+token_db_key_t
+token_database::get_db_key(token_type type, const std::optional<name128>& domain, const name128& key) const {
     using namespace internal;
 
     auto& prefix = domain.has_value() ? *domain : action_key_prefixes[(int)type];
-    auto  dkey   = db_token_key(prefix, key);
-    return dkey.as_string();
+    auto  dkey   = token_db_key_t();
+    memcpy(dkey.data(), &prefix, sizeof(name128));
+    memcpy(dkey.data() + sizeof(name128), &key, sizeof(name128));
+    return dkey;
 }
 
 }}  // namespace evt::chain
@@ -1612,5 +4930,6 @@ token_database::get_db_key(token_type type, const std::optional<name128>& domain
 FC_REFLECT(evt::chain::internal::pd_header, (dirty_flag));
 FC_REFLECT(evt::chain::internal::pd_action, (op)(type)(key)(value));
 FC_REFLECT(evt::chain::internal::pd_group,  (seq)(actions));
+FC_REFLECT(evt::chain::internal::journal_record, (type)(seq)(key)(value));
 FC_REFLECT(evt::chain::internal::wc_entry, (k)(v));
 FC_REFLECT(evt::chain::internal::wc_entry_pack, (seq)(vec));
@@ -1,6 +1,13 @@
 #include <evt/chain/token_database_snapshot.hpp>
 
 #include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <fstream>
+#include <future>
+#include <set>
+#include <thread>
 #include <vector>
 #include <fmt/format.h>
 #include <rocksdb/db.h>
@@ -10,6 +17,19 @@ namespace evt { namespace chain {
 
 namespace internal {
 
+const auto kCheckpointSection = ".tokendb-checkpoint";
+const auto kStateSection      = ".tokendb-state";
+const auto kDeltaSection      = ".tokendb-delta";
+
+using raw_column = token_database::raw_column;
+using raw_key_t  = std::pair<raw_column, std::string>;
+
+// sequence of db when snapshot is written and the keys whose values are not in db yet
+struct db_state {
+    uint64_t               sequence;
+    std::vector<raw_key_t> volatile_keys;
+};
+
 // TODO: Replace with values provided by token database class directly
 const char* section_names[] = {
     ".asset",
@@ -22,7 +42,8 @@ const char* section_names[] = {
     ".prodvote",
     ".evtlink",
     ".psvbonus",
-    ".psvbonus-dist"
+    ".psvbonus-dist",
+    ".meta"
 };
 
 void
@@ -62,34 +83,102 @@ add_reserved_tokens(snapshot_writer_ptr          writer,
     }
 }
 
+// invoke `work` on each item by a pool of threads, and then `done` on the results in the original order.
+// at most as many as the number of cores are in flight, which bounds memory used by results
+template<typename T, typename R, typename W, typename D>
 void
-add_tokens(snapshot_writer_ptr writer, const token_database& db, const std::vector<domain_name> domains) {
-    for(auto& d : domains) {
-        writer->write_section(d.to_string(), [&](auto& w) {
-            db.read_tokens_range(token_type::token, d, 0, [&w](auto& key, auto&& v) {
-                w.add_row(key.data(), key.size());
-                w.add_row(v);
+pipeline(const std::vector<T>& items, W&& work, D&& done) {
+    auto n       = std::max(1u, std::thread::hardware_concurrency());
+    auto futures = std::deque<std::future<R>>();
+    auto next    = 0u;
+
+    auto launch = [&] {
+        if(next < items.size()) {
+            futures.emplace_back(std::async(std::launch::async, [&work, &item = items[next++]] { return work(item); }));
+        }
+    };
 
-                return true;
-            });
-        });
+    while(next < items.size() && futures.size() < n) {
+        launch();
+    }
+    for(auto i = 0u; i < items.size(); i++) {
+        auto r = futures.front().get();
+        futures.pop_front();
+        launch();
+
+        done(items[i], std::move(r));
     }
 }
 
+// invoke `work` on each item by a pool of threads as many as the number of cores, in no particular order
+template<typename T, typename W>
 void
-add_assets(snapshot_writer_ptr writer, const token_database& db, const std::vector<symbol_id_type>& symbol_ids) {
-    for(auto& id : symbol_ids) {
-        auto sn = fmt::format(".asset-{}", id);
-        writer->write_section(sn, [&](auto& w) {
-            db.read_assets_range(id, 0, [&w](auto& key, auto&& v) {
-                assert(key.size() == sizeof(fc::ecc::public_key_shim));
-                w.add_row(key.data(), key.size());
-                w.add_row(v);
+parallel_for_each(const std::vector<T>& items, W&& work) {
+    auto n       = std::min((size_t)std::max(1u, std::thread::hardware_concurrency()), items.size());
+    auto next    = std::atomic<size_t>(0);
+    auto futures = std::vector<std::future<void>>();
+
+    for(auto i = 0u; i < n; i++) {
+        futures.emplace_back(std::async(std::launch::async, [&] {
+            for(auto j = next++; j < items.size(); j = next++) {
+                work(items[j]);
+            }
+        }));
+    }
+    for(auto& f : futures) {
+        f.get();
+    }
+}
 
-                return true;
-            });
+void
+write_rows(snapshot_writer_ptr writer, const std::string& section, const bulk_entries_t& rows) {
+    writer->write_section(section, [&](auto& w) {
+        for(auto& r : rows) {
+            w.add_row(r.first.data(), r.first.size());
+            w.add_row(r.second);
+        }
+    });
+}
+
+// sections are read in parallel, and they're written by the same threads if writer accepts that
+// otherwise they're written one at a time in order
+template<typename T, typename R, typename S>
+void
+add_sections(snapshot_writer_ptr writer, const std::vector<T>& items, R&& read, S&& section_name) {
+    if(writer->concurrent()) {
+        parallel_for_each(items, [&](auto& item) {
+            write_rows(writer, section_name(item), read(item));
         });
+        return;
     }
+    pipeline<T, bulk_entries_t>(items, read, [&](auto& item, auto&& rows) {
+        write_rows(writer, section_name(item), rows);
+    });
+}
+
+void
+add_tokens(snapshot_writer_ptr writer, const token_database& db, const std::vector<domain_name> domains) {
+    add_sections(writer, domains, [&db](auto& d) {
+        auto rows = bulk_entries_t();
+        db.read_tokens_range(token_type::token, d, 0, [&rows](auto& key, auto&& v) {
+            rows.emplace_back(std::string(key), std::move(v));
+            return true;
+        });
+        return rows;
+    }, [](auto& d) { return d.to_string(); });
+}
+
+void
+add_assets(snapshot_writer_ptr writer, const token_database& db, const std::vector<symbol_id_type>& symbol_ids) {
+    add_sections(writer, symbol_ids, [&db](auto& id) {
+        auto rows = bulk_entries_t();
+        db.read_assets_range(id, 0, [&rows](auto& key, auto&& v) {
+            assert(key.size() == sizeof(fc::ecc::public_key_shim));
+            rows.emplace_back(std::string(key), std::move(v));
+            return true;
+        });
+        return rows;
+    }, [](auto& id) { return fmt::format(".asset-{}", id); });
 }
 
 void
@@ -123,64 +212,231 @@ read_reserved_tokens(snapshot_reader_ptr          reader,
     }
 }
 
-void
-read_tokens(snapshot_reader_ptr reader, token_database& db, const std::vector<domain_name>& domains) {
-    for(auto& d : domains) {
-        reader->read_section(d.to_string(), [&](auto& r) {
-            while(!r.eof()) {
-                auto k = name128();
-                auto v = std::string();
+template<size_t N>
+bulk_entries_t
+read_rows(snapshot_reader_ptr reader, const std::string& section) {
+    auto rows = bulk_entries_t();
+    reader->read_section(section, [&](auto& r) {
+        while(!r.eof()) {
+            auto k = std::string(N, '\0');
+            auto v = std::string();
 
-                r.read_row((char*)&k, sizeof(k));
-                r.read_row(v);
+            r.read_row(k.data(), N);
+            r.read_row(v);
 
-                db.put_token(token_type::token, action_op::put, d, k, std::string_view(v.data(), v.size()));
-            }
+            rows.emplace_back(std::move(k), std::move(v));
+        }
+    });
+    return rows;
+}
+
+// sorted rows of each section are ingested by other threads, and they're also read by these threads if
+// reader accepts that, otherwise reader can only be read sequentially
+template<size_t N, typename T, typename S, typename I>
+void
+ingest_sections(snapshot_reader_ptr reader, const std::vector<T>& items, S&& section_name, I&& ingest) {
+    if(reader->concurrent()) {
+        parallel_for_each(items, [&](auto& item) {
+            ingest(item, read_rows<N>(reader, section_name(item)));
         });
+        return;
     }
+
+    auto n       = std::max(1u, std::thread::hardware_concurrency());
+    auto futures = std::deque<std::future<void>>();
+
+    for(auto& item : items) {
+        auto rows = std::make_shared<bulk_entries_t>(read_rows<N>(reader, section_name(item)));
+        if(futures.size() >= n) {
+            futures.front().get();
+            futures.pop_front();
+        }
+        futures.emplace_back(std::async(std::launch::async, [&ingest, &item, rows] { ingest(item, *rows); }));
+    }
+    for(auto& f : futures) {
+        f.get();
+    }
+}
+
+void
+read_tokens(snapshot_reader_ptr reader, token_database& db, const std::vector<domain_name>& domains) {
+    ingest_sections<sizeof(name128)>(reader, domains, [](auto& d) { return d.to_string(); }, [&db](auto& d, auto& rows) {
+        db.ingest_tokens(token_type::token, d, rows);
+    });
 }
 
 void
 read_assets(snapshot_reader_ptr reader, token_database& db, const std::vector<symbol_id_type>& symbol_ids) {
-    for(auto& id : symbol_ids) {
-        auto sn = fmt::format(".asset-{}", id);
-        reader->read_section(sn, [&](auto& r) {
-            while(!r.eof()) {
-                auto k = fc::ecc::public_key_shim();
-                auto v = std::string();
+    ingest_sections<sizeof(fc::ecc::public_key_shim)>(reader, symbol_ids, [](auto& id) { return fmt::format(".asset-{}", id); }, [&db](auto& id, auto& rows) {
+        db.ingest_assets(id, rows);
+    });
+}
 
-                r.read_row((char*)&k, sizeof(k));
-                r.read_row(v);
+void
+add_state(snapshot_writer_ptr writer, const token_database& db) {
+    writer->write_section(kStateSection, [&](auto& w) {
+        w.add_row(db.latest_sequence());
+        db.read_volatile_keys([&](auto column, auto& key) {
+            w.add_row((uint8_t)column);
+            w.add_row(std::string(key));
+        });
+    });
+}
+
+db_state
+read_state(snapshot_reader_ptr reader) {
+    EVT_ASSERT(reader->has_section(kStateSection), token_database_snapshot_exception,
+        "Snapshot has no state of token database, it cannot be the base of delta");
+
+    auto state = db_state();
+    reader->read_section(kStateSection, [&](auto& r) {
+        r.read_row(state.sequence);
+        while(!r.eof()) {
+            auto column = uint8_t();
+            auto key    = std::string();
+
+            r.read_row(column);
+            r.read_row(key);
+
+            state.volatile_keys.emplace_back((raw_column)column, std::move(key));
+        }
+    });
+    return state;
+}
+
+// names in snapshot are resolved in the snapshot dir, only plain file names are accepted so nothing outside is touched
+void
+check_file_name(const std::string& name) {
+    EVT_ASSERT(!name.empty() && name != "." && name != ".." && name.find_first_of(std::string("/\\\0", 3)) == std::string::npos,
+        token_database_snapshot_exception, "Invalid file name in snapshot: ${n}", ("n", name));
+}
 
-                auto addr = address(public_key_type(k));
-                db.put_asset(addr, id, std::string_view(v.data(), v.size()));
+void
+read_delta(snapshot_reader_ptr reader, token_database& db, const fc::path& snapshot_dir) {
+    auto base_name = std::string();
+    auto base_seq  = uint64_t();
+    auto entries   = token_database::raw_entries_t();
+
+    reader->read_section(kDeltaSection, [&](auto& r) {
+        r.read_row(base_name);
+        r.read_row(base_seq);
+        while(!r.eof()) {
+            auto column = uint8_t();
+            auto found  = uint8_t();
+            auto e      = token_database::raw_entry();
+
+            r.read_row(column);
+            r.read_row(e.key);
+            r.read_row(found);
+            e.column = (raw_column)column;
+            if(found) {
+                e.value.emplace();
+                r.read_row(*e.value);
             }
-        });
-    }
+            entries.emplace_back(std::move(e));
+        }
+    });
+
+    // base is restored first, it may be a delta itself
+    check_file_name(base_name);
+    auto path = snapshot_dir / base_name;
+    EVT_ASSERT(fc::is_regular_file(path), token_database_snapshot_exception,
+        "Base snapshot: ${p} is not found", ("p", path.generic_string()));
+
+    auto infile = std::ifstream(path.generic_string(), (std::ios::in | std::ios::binary));
+    auto base   = make_snapshot_reader(infile);
+    base->validate();
+    EVT_ASSERT(read_state(base).sequence == base_seq, token_database_snapshot_exception,
+        "Base snapshot: ${p} doesn't match the delta", ("p", path.generic_string()));
+
+    token_database_snapshot::read_from_snapshot(base, db, snapshot_dir);
+    db.write_raw(entries);
 }
 
 }  // namespace internal
 
 void
-token_database_snapshot::add_to_snapshot(snapshot_writer_ptr writer, const token_database& db) {
+token_database_snapshot::add_to_snapshot(snapshot_writer_ptr writer, const token_database& db, const std::optional<fc::path>& checkpoint) {
     using namespace internal;
 
     try {
+        if(checkpoint.has_value()) {
+            db.create_checkpoint(*checkpoint);
+            writer->write_section(kCheckpointSection, [&](auto& w) {
+                w.add_row(checkpoint->filename().generic_string());
+            });
+            add_state(writer, db);
+            return;
+        }
+
         auto domains    = std::vector<domain_name>();
         auto symbol_ids = std::vector<symbol_id_type>();
 
         add_reserved_tokens(writer, db, domains, symbol_ids);
         add_tokens(writer, db, domains);
         add_assets(writer, db, symbol_ids);
+        add_state(writer, db);
+    }
+    EVT_CAPTURE_AND_RETHROW(token_database_snapshot_exception);
+}
+
+void
+token_database_snapshot::add_delta_to_snapshot(snapshot_writer_ptr writer, const token_database& db, snapshot_reader_ptr base, const std::string& base_name) {
+    using namespace internal;
+
+    try {
+        auto state = read_state(base);
+
+        // volatile entries in base may be rolled back later without writing db, so they're always written again
+        auto keys    = std::set<raw_key_t>(state.volatile_keys.begin(), state.volatile_keys.end());
+        auto add_key = [&keys](auto column, auto& key) {
+            keys.emplace(column, std::string(key));
+        };
+        db.read_changed_keys(state.sequence, add_key);
+        db.read_volatile_keys(add_key);
+
+        writer->write_section(kDeltaSection, [&](auto& w) {
+            w.add_row(base_name);
+            w.add_row(state.sequence);
+
+            auto value = std::string();
+            for(auto& [column, key] : keys) {
+                auto found = db.read_raw(column, key, value);
+
+                w.add_row((uint8_t)column);
+                w.add_row(key);
+                w.add_row((uint8_t)found);
+                if(found) {
+                    w.add_row(value);
+                }
+            }
+        });
+        add_state(writer, db);
     }
     EVT_CAPTURE_AND_RETHROW(token_database_snapshot_exception);
 }
 
 void
-token_database_snapshot::read_from_snapshot(snapshot_reader_ptr reader, token_database& db) {
+token_database_snapshot::read_from_snapshot(snapshot_reader_ptr reader, token_database& db, const fc::path& snapshot_dir) {
     using namespace internal;
 
     try {
+        if(reader->has_section(kCheckpointSection)) {
+            auto name = std::string();
+            reader->read_section(kCheckpointSection, [&](auto& r) {
+                r.read_row(name);
+            });
+
+            check_file_name(name);
+            db.restore_checkpoint(snapshot_dir / name);
+            FC_ASSERT(db.savepoints_size() == 0);
+            return;
+        }
+        if(reader->has_section(kDeltaSection)) {
+            read_delta(reader, db, snapshot_dir);
+            return;
+        }
+
         // clear all the savepoints
         db.close(false);
         db.open(false);
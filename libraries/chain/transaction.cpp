@@ -11,6 +11,7 @@
 #include <boost/iostreams/filter/zlib.hpp>
 #include <boost/iostreams/filtering_stream.hpp>
 #include <boost/range/adaptor/transformed.hpp>
+#include <zstd.h>
 
 #include <evt/chain/exceptions.hpp>
 #include <evt/chain/transaction.hpp>
@@ -57,15 +58,20 @@ transaction::get_signature_keys(const signatures_base_type& signatures, const ch
 
     try {
         auto digest = sig_digest(chain_id);
+        auto items  = fc::crypto::recovery_items();
+        items.reserve(signatures.size());
+        for(auto& sig : signatures) {
+            items.emplace_back(sig, digest);
+        }
 
         auto recovered_pub_keys = public_keys_set();
-        for(auto& sig : signatures) {
+        for(auto& key : fc::crypto::recover_public_keys(items)) {
             auto successful_insertion                   = false;
-            std::tie(std::ignore, successful_insertion) = recovered_pub_keys.emplace(sig, digest);
+            std::tie(std::ignore, successful_insertion) = recovered_pub_keys.emplace(key);
             EVT_ASSERT(allow_duplicate_keys || successful_insertion, tx_duplicate_sig,
                        "transaction includes more than one signature signed using the same key associated with public "
                        "key: ${key}",
-                       ("key", public_key_type(sig, digest)));
+                       ("key", key));
         }
 
         return recovered_pub_keys;
@@ -185,6 +191,39 @@ pack_transaction(const transaction& t) {
     return fc::raw::pack(t);
 }
 
+// same limit as zlib for zip bomb protections, size of content is checked before anything is allocated
+const size_t kZstdDecompressLimit = 1 * 1024 * 1024;
+const int    kZstdCompressLevel   = 19;  // transactions are compressed once and decompressed by every node
+
+static transaction
+zstd_decompress_transaction(const bytes& data) {
+    static thread_local auto dctx = std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)>(ZSTD_createDCtx(), &ZSTD_freeDCtx);
+
+    // frames without content size are never produced by `zstd_compress_transaction`
+    auto size = ZSTD_getFrameContentSize(data.data(), data.size());
+    EVT_ASSERT(size != ZSTD_CONTENTSIZE_ERROR && size != ZSTD_CONTENTSIZE_UNKNOWN, tx_decompression_error,
+        "Invalid zstd frame of transaction");
+    EVT_ASSERT(size <= kZstdDecompressLimit, tx_decompression_error, "Exceeded maximum decompressed transaction size");
+
+    auto out = bytes(size);
+    auto sz  = ZSTD_decompressDCtx(dctx.get(), out.data(), out.size(), data.data(), data.size());
+    EVT_ASSERT(!ZSTD_isError(sz) && sz == size, tx_decompression_error, "Decompress transaction failed: ${e}",
+        ("e",ZSTD_isError(sz) ? ZSTD_getErrorName(sz) : "size mismatched"));
+    return unpack_transaction(out);
+}
+
+static bytes
+zstd_compress_transaction(const transaction& t) {
+    static thread_local auto cctx = std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)>(ZSTD_createCCtx(), &ZSTD_freeCCtx);
+
+    auto in  = pack_transaction(t);
+    auto out = bytes(ZSTD_compressBound(in.size()));
+    auto sz  = ZSTD_compressCCtx(cctx.get(), out.data(), out.size(), in.data(), in.size(), kZstdCompressLevel);
+    EVT_ASSERT(!ZSTD_isError(sz), tx_compression_error, "Compress transaction failed: ${e}", ("e",ZSTD_getErrorName(sz)));
+    out.resize(sz);
+    return out;
+}
+
 static bytes
 zlib_compress_transaction(const transaction& t) {
     auto in   = pack_transaction(t);
@@ -208,6 +247,9 @@ packed_transaction::local_unpack_transaction() {
         case zlib:
             unpacked_trx = signed_transaction(zlib_decompress_transaction(packed_trx), signatures);
             break;
+        case zstd:
+            unpacked_trx = signed_transaction(zstd_decompress_transaction(packed_trx), signatures);
+            break;
         default:
             EVT_THROW(unknown_transaction_compression, "Unknown transaction compression algorithm");
         }
@@ -225,6 +267,9 @@ packed_transaction::local_pack_transaction() {
         case zlib:
             packed_trx = zlib_compress_transaction(unpacked_trx);
             break;
+        case zstd:
+            packed_trx = zstd_compress_transaction(unpacked_trx);
+            break;
         default:
             EVT_THROW(unknown_transaction_compression, "Unknown transaction compression algorithm");
         }
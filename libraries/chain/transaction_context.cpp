@@ -23,7 +23,7 @@ transaction_context::transaction_context(controller&                    control,
     , undo_token_session()
     , trx_meta(trx_meta)
     , trx(trx_meta->packed_trx->get_signed_transaction())
-    , trace(std::make_shared<transaction_trace>())
+    , trace(make_transaction_trace())
     , start(start)
     , net_usage(trace->net_usage) {
     if(!control.skip_db_sessions()) {
@@ -33,6 +33,7 @@ transaction_context::transaction_context(controller&                    control,
     trace->id = trx_meta->id;
 
     executed.reserve(trx.actions.size() + 1); // one for paycharge action
+    trace->action_traces.reserve(trx.actions.size() + 1);
 
     if(!trx.transaction_extensions.empty()) {
         for(auto& ext : trx.transaction_extensions) {
@@ -188,7 +189,7 @@ transaction_context::check_paid() const {
             // no need to check signature here, have checked in contract
             break;
         }
-        auto& keys = trx_meta->recover_keys(control.get_chain_id());
+        auto& keys = control.recover_keys(trx_meta);
         if(keys.find(payer.get_public_key()) == keys.end()) {
             EVT_THROW(payer_exception, "Payer: ${p} needs to sign this transaction.", ("p",payer));
         }
@@ -286,6 +287,8 @@ transaction_context::record_transaction(const transaction_id_type& id, fc::time_
             transaction.trx_id     = id;
             transaction.expiration = expire;
             transaction.block_num  = control.pending_block_state()->block_num;
+            // receipt is pushed after it's applied, so it's the next one
+            transaction.trx_index  = control.pending_block_state()->block->transactions.size();
         });
     }
     catch(const boost::interprocess::bad_alloc&) {
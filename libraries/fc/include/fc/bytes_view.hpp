@@ -0,0 +1,40 @@
+#pragma once
+#include <stddef.h>
+#include <vector>
+
+namespace fc {
+
+/**
+ *  Read-only view of a contiguous range of bytes, it doesn't own the data and
+ *  is only valid as long as the buffer it points into.
+ */
+class bytes_view {
+public:
+    bytes_view()
+        : _data(nullptr)
+        , _size(0) {}
+
+    bytes_view(const char* data, size_t size)
+        : _data(data)
+        , _size(size) {}
+
+    bytes_view(const std::vector<char>& v)
+        : _data(v.data())
+        , _size(v.size()) {}
+
+public:
+    const char* data() const { return _data; }
+    size_t      size() const { return _size; }
+    bool        empty() const { return _size == 0; }
+
+    const char* begin() const { return _data; }
+    const char* end() const { return _data + _size; }
+
+    std::vector<char> to_bytes() const { return std::vector<char>(begin(), end()); }
+
+private:
+    const char* _data;
+    size_t      _size;
+};
+
+}  // namespace fc
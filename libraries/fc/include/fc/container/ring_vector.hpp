@@ -1,5 +1,8 @@
 
 #pragma once
+#include <assert.h>
+#include <utility>
+#include <vector>
 
 namespace fc {
 
@@ -15,17 +18,16 @@ public:
     }
 
 public:
-    template<typename ... ARGS>
     void
     push_back(const T& item) {
         buf_[tail_] = item;
+        advance_tail();
+    }
 
-        if(++tail_ >= capacity_) {
-            tail_ = 0;
-        }
-        if(head_ == tail_) {
-            expand();
-        }
+    void
+    push_back(T&& item) {
+        buf_[tail_] = std::move(item);
+        advance_tail();
     }
 
     void
@@ -101,12 +103,23 @@ public:
     }
 
 private:
+    void
+    advance_tail() {
+        if(++tail_ >= capacity_) {
+            tail_ = 0;
+        }
+        if(head_ == tail_) {
+            expand();
+        }
+    }
+
+    // capacity is doubled when it's full, items are moved into the new buffer from head
     void
     expand() {
         auto new_vec = std::vector<T>();
         new_vec.resize(capacity_ * 2);
         for(auto i = 0u; i < capacity_; i++) {
-            new_vec[i] = buf_[(head_ + i) % capacity_];
+            new_vec[i] = std::move(buf_[(head_ + i) % capacity_]);
         }
 
         head_      = 0;
@@ -1,4 +1,6 @@
 #pragma once
+#include <utility>
+#include <vector>
 #include <fc/crypto/elliptic.hpp>
 #include <fc/crypto/elliptic_r1.hpp>
 #include <fc/crypto/signature.hpp>
@@ -44,11 +46,21 @@ private:
     friend bool operator==(const public_key& p1, const public_key& p2);
     friend bool operator!=(const public_key& p1, const public_key& p2);
     friend bool operator<(const public_key& p1, const public_key& p2);
-    
+    friend std::size_t hash_value(const public_key& k);  // not cryptographic; for containers
+
     friend struct reflector<public_key>;
     friend class private_key;
 };  // public_key
 
+size_t hash_value(const public_key& k);
+
+using recovery_items = std::vector<std::pair<signature, sha256>>;
+
+// recover the keys of many (signature, digest) pairs at once, keys are returned in the same order.
+// pairs are split into at most `lanes` contiguous ranges recovered in parallel, all of them share
+// the precomputed tables of the one secp256k1 context. it throws if any of the signatures is invalid
+std::vector<public_key> recover_public_keys(const recovery_items& items, uint32_t lanes = 1, bool check_canonical = true);
+
 }}  // namespace fc::crypto
 
 namespace fc {
@@ -56,4 +68,14 @@ void to_variant(const crypto::public_key& var, variant& vo);
 void from_variant(const variant& var, crypto::public_key& vo);
 }  // namespace fc
 
+namespace std {
+template <>
+struct hash<fc::crypto::public_key> {
+    std::size_t
+    operator()(const fc::crypto::public_key& k) const {
+        return fc::crypto::hash_value(k);
+    }
+};
+} // std
+
 FC_REFLECT(fc::crypto::public_key, (_storage));
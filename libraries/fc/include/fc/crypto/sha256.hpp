@@ -24,6 +24,12 @@ public:
     static sha256 hash(const string&);
     static sha256 hash(const sha256&);
 
+    /**
+     * Hashes each pair of digests: out[i] = hash(in[2 * i], in[2 * i + 1]) for i in [0, n),
+     * `out` can be the same as `in`. It's the same as hashing `std::pair<sha256, sha256>` but much faster.
+     */
+    static void hash_pairs(const sha256* in, size_t n, sha256* out);
+
     template<typename T>
     static sha256 hash(const T& t) {
         sha256::encoder e;
@@ -35,6 +35,16 @@ public:
         detail::throw_datastream_range_error("read", _end - _start, int64_t(-((_end - _pos) - 1)));
     }
 
+    // returns the position of next `s` bytes and skips them without copying
+    inline T borrow(size_t s) {
+        if(size_t(_end - _pos) >= (size_t)s) {
+            auto p = _pos;
+            _pos += s;
+            return p;
+        }
+        detail::throw_datastream_range_error("borrow", _end - _start, int64_t(-((_end - _pos) - 1)));
+    }
+
     inline bool write(const char* d, size_t s) {
         if(_end - _pos >= (int32_t)s) {
             memcpy(_pos, d, s);
@@ -14,14 +14,20 @@ using std::ostream;
  */
 class json {
 public:
+    // rapidjson ones are the defaults, they produce the same values as legacy ones:
+    // numbers are converted the same way and doubles can be kept as strings with `*_with_string_doubles`.
+    // strict and relaxed parsers are always backed by legacy implementation
     enum parse_type {
-        legacy_parser                     = 0,
-        strict_parser                     = 1,
-        relaxed_parser                    = 2,
-        rapidjson_parser                  = 3,
-        legacy_parser_with_string_doubles = 4
+        legacy_parser                        = 0,
+        strict_parser                        = 1,
+        relaxed_parser                       = 2,
+        rapidjson_parser                     = 3,
+        legacy_parser_with_string_doubles    = 4,
+        rapidjson_parser_with_string_doubles = 5
     };
     
+    // stringify_large_ints_and_doubles and rapidjson_generator are written by rapidjson,
+    // legacy_generator by legacy implementation
     enum output_formatting {
         stringify_large_ints_and_doubles = 0,
         legacy_generator                 = 1,
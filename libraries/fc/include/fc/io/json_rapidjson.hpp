@@ -7,11 +7,14 @@
 #include <vector>
 #include <tuple>
 #include <fc/io/json.hpp>
+#include <fc/string.hpp>
 #include <fc/container/small_vector_fwd.hpp>
 #include <fc/static_variant.hpp>
 #include <rapidjson/document.h>
 #include <rapidjson/reader.h>
 #include <rapidjson/writer.h>
+#include <rapidjson/memorystream.h>
+#include <rapidjson/stringbuffer.h>
 #include <rapidjson/prettywriter.h>
 #include <rapidjson/istreamwrapper.h>
 #include <rapidjson/ostreamwrapper.h>
@@ -22,20 +25,27 @@ using namespace rapidjson;
 namespace fc { namespace rapidjson {
 
 template<typename T, bool strict>
-variant variant_from_stream(T& in, uint32_t max_depth);
+variant variant_from_stream(T& in, uint32_t max_depth, bool string_doubles = false);
 
-template<typename T>
+inline variant  variant_from_string(const char* str, size_t len, uint32_t max_depth, bool string_doubles = false);
+inline variants variants_from_string(const char* str, size_t len, uint32_t max_depth);
+
+template<bool stringify = false, typename T>
 void to_stream(T& out, const variant& v);
 
-template<typename T>
+template<bool stringify = false, typename T>
 void to_stream_pretty(T& out, const variant& v);
 
+template<bool stringify = false>
+std::string to_string(const variant& v);
+
 namespace internal {
 
 class VariantHandler : public BaseReaderHandler<UTF8<>, VariantHandler> {
 public:
-    VariantHandler(variant& v, uint32_t max_depth) : v_(v),
-                                                     max_depth_(max_depth)
+    VariantHandler(variant& v, uint32_t max_depth, bool string_doubles = false) : v_(v),
+                                                                                 max_depth_(max_depth),
+                                                                                 string_doubles_(string_doubles)
     { }
 
 public:
@@ -73,9 +83,25 @@ public:
         return insert_element(d);
     }
 
+    // numbers are parsed as strings first to be converted the same as legacy parser:
+    // integers to int64 or uint64, decimals to double (or kept as string if `string_doubles`)
+    // and numbers with exponent are kept as string
     bool
     RawNumber(const Ch* str, SizeType len, bool copy) {
-        FC_THROW_EXCEPTION(parse_error_exception, "Not supported raw number");
+        auto num = std::string(str, len);
+        if(num.find_first_of("eE") != std::string::npos) {
+            return insert_element(std::move(num));
+        }
+        if(num.find('.') != std::string::npos) {
+            if(string_doubles_) {
+                return insert_element(std::move(num));
+            }
+            return insert_element(fc::to_double(num));
+        }
+        if(num[0] == '-') {
+            return insert_element(fc::to_int64(num));
+        }
+        return insert_element(fc::to_uint64(num));
     }
 
     bool
@@ -154,7 +180,9 @@ private:
     inline bool
     insert_element(T&& v) {
         if(obj_levels_.empty()) {
-            return false;
+            // root is a scalar
+            v_ = variant(std::forward<T>(v));
+            return true;
         }
         auto& l = obj_levels_.top();
 
@@ -200,22 +228,20 @@ private:
     stack<obj_level>   obj_levels_;
     variant&           v_;
     uint32_t           max_depth_;
+    bool               string_doubles_;
 };
 
-}  // namespace internal
+constexpr auto kParseFlags = kParseNumbersAsStringsFlag;
 
-template<typename T, bool strict>
+template<unsigned flags, typename S>
 variant
-variant_from_stream(T& in, uint32_t max_depth) {
-    using namespace internal;
-
+parse(S& ss, uint32_t max_depth, bool string_doubles) {
     variant var;
 
     Reader reader;
-    VariantHandler handler(var, max_depth);
+    VariantHandler handler(var, max_depth, string_doubles);
 
-    BasicIStreamWrapper<T> ss(in);
-    if(!reader.Parse(ss, handler)) {
+    if(!reader.Parse<flags>(ss, handler)) {
         auto e = reader.GetParseErrorCode();
         FC_THROW_EXCEPTION(parse_error_exception, "Unexpected content, err: ${err}, offset: ${offset}",
             ("err",GetParseError_En(e))("offset",reader.GetErrorOffset()));
@@ -224,9 +250,49 @@ variant_from_stream(T& in, uint32_t max_depth) {
     return var;
 }
 
+}  // namespace internal
+
+template<typename T, bool strict>
+variant
+variant_from_stream(T& in, uint32_t max_depth, bool string_doubles) {
+    using namespace internal;
+
+    BasicIStreamWrapper<T> ss(in);
+    return parse<kParseFlags>(ss, max_depth, string_doubles);
+}
+
+// parses from the memory directly instead of through a std::stream
+inline variant
+variant_from_string(const char* str, size_t len, uint32_t max_depth, bool string_doubles) {
+    using namespace internal;
+
+    MemoryStream ss(str, len);
+    return parse<kParseFlags>(ss, max_depth, string_doubles);
+}
+
+// parses values separated by whitespaces
+inline variants
+variants_from_string(const char* str, size_t len, uint32_t max_depth) {
+    using namespace internal;
+
+    auto result = variants();
+
+    MemoryStream ss(str, len);
+    while(true) {
+        SkipWhitespace(ss);
+        if(ss.Tell() == len) {
+            break;
+        }
+        result.emplace_back(parse<kParseFlags | kParseStopWhenDoneFlag>(ss, max_depth, false));
+    }
+    return result;
+}
+
 namespace internal {
 
-template<typename W>
+// output is the same as legacy generator: doubles are printed by `variant::as_string` and
+// blobs are base64 encoded, and with `stringify` large ints and doubles are quoted as strings
+template<bool stringify, typename W>
 void
 serialize(W& writer, const variant& v) {
     switch(v.get_type()) {
@@ -235,15 +301,35 @@ serialize(W& writer, const variant& v) {
         break;
     }
     case variant::int64_type: {
-        writer.Int64(v.as_int64());
+        auto i = v.as_int64();
+        if(stringify && i > 0xffffffff) {
+            auto str = v.as_string();
+            writer.String(str.c_str(), str.size());
+        }
+        else {
+            writer.Int64(i);
+        }
         break;
     }
     case variant::uint64_type: {
-        writer.Uint64(v.as_uint64());
+        auto i = v.as_uint64();
+        if(stringify && i > 0xffffffff) {
+            auto str = v.as_string();
+            writer.String(str.c_str(), str.size());
+        }
+        else {
+            writer.Uint64(i);
+        }
         break;
     }
     case variant::double_type: {
-        writer.Double(v.as_double());
+        auto str = v.as_string();
+        if(stringify) {
+            writer.String(str.c_str(), str.size());
+        }
+        else {
+            writer.RawValue(str.c_str(), str.size(), kNumberType);
+        }
         break;
     }
     case variant::bool_type: {
@@ -256,8 +342,8 @@ serialize(W& writer, const variant& v) {
         break;
     }
     case variant::blob_type: {
-        auto& blob = v.get_blob();
-        writer.String(&blob.data[0], blob.data.size());
+        auto str = v.as_string();
+        writer.String(str.c_str(), str.size());
         break;
     }
     case variant::array_type: {
@@ -265,7 +351,7 @@ serialize(W& writer, const variant& v) {
 
         writer.StartArray();
         for(auto& a : arr) {
-            serialize(writer, a);
+            serialize<stringify>(writer, a);
         }
         writer.EndArray();
         break;
@@ -277,7 +363,7 @@ serialize(W& writer, const variant& v) {
         for(auto& it : obj) {
             auto& key = it.key();
             writer.Key(key.c_str(), key.size());
-            serialize(writer, it.value());
+            serialize<stringify>(writer, it.value());
         }
         writer.EndObject();
         break;
@@ -290,7 +376,7 @@ serialize(W& writer, const variant& v) {
 
 }  // namespace internal
 
-template<typename T>
+template<bool stringify, typename T>
 void
 to_stream(T& out, const variant& v) {
     using namespace internal;
@@ -298,10 +384,10 @@ to_stream(T& out, const variant& v) {
     BasicOStreamWrapper<T> ss(out);
 
     Writer<BasicOStreamWrapper<T>> writer(ss);
-    serialize(writer, v);
+    serialize<stringify>(writer, v);
 }
 
-template<typename T>
+template<bool stringify, typename T>
 void
 to_stream_pretty(T& out, const variant& v) {
     using namespace internal;
@@ -309,7 +395,20 @@ to_stream_pretty(T& out, const variant& v) {
     BasicOStreamWrapper<T> ss(out);
 
     PrettyWriter<BasicOStreamWrapper<T>> writer(ss);
-    serialize(writer, v);
+    serialize<stringify>(writer, v);
+}
+
+// writes into the buffer directly instead of through a std::stream
+template<bool stringify>
+std::string
+to_string(const variant& v) {
+    using namespace internal;
+
+    StringBuffer buf;
+
+    Writer<StringBuffer> writer(buf);
+    serialize<stringify>(writer, v);
+    return std::string(buf.GetString(), buf.GetSize());
 }
 
 }}  // namespace fc::rapidjson
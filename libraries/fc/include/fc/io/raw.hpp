@@ -3,6 +3,7 @@
 #include <deque>
 #include <map>
 #include <optional>
+#include <string_view>
 #include <tuple>
 
 #include <boost/multiprecision/cpp_dec_float.hpp>
@@ -21,6 +22,7 @@
 #include <fc/io/varint.hpp>
 #include <fc/variant_wrapper.hpp>
 #include <fc/fwd.hpp>
+#include <fc/bytes_view.hpp>
 #include <fc/smart_ref_fwd.hpp>
 #include <fc/time.hpp>
 #include <fc/filesystem.hpp>
@@ -386,6 +388,49 @@ unpack(Stream& s, std::string& v) {
     }
 }
 
+// std::string_view & fc::bytes_view, packed the same as std::string and std::vector<char>
+template<typename Stream>
+inline void
+pack(Stream& s, const std::string_view& v) {
+    FC_ASSERT(v.size() <= MAX_SIZE_OF_BYTE_ARRAYS);
+    fc::raw::pack(s, unsigned_int((uint32_t)v.size()));
+    if(v.size()) {
+        s.write(v.data(), v.size());
+    }
+}
+
+template<typename Stream>
+inline void
+pack(Stream& s, const bytes_view& v) {
+    FC_ASSERT(v.size() <= MAX_SIZE_OF_BYTE_ARRAYS);
+    fc::raw::pack(s, unsigned_int((uint32_t)v.size()));
+    if(v.size()) {
+        s.write(v.data(), v.size());
+    }
+}
+
+// borrowed unpack, the views point into the buffer of stream instead of copying
+// and are only valid as long as that buffer
+template<typename T>
+inline void
+unpack_view(datastream<T>& s, std::string_view& v) {
+    auto sz = unsigned_int();
+    fc::raw::unpack(s, sz);
+    FC_ASSERT(sz.value <= MAX_SIZE_OF_BYTE_ARRAYS);
+
+    v = std::string_view(s.borrow(sz.value), sz.value);
+}
+
+template<typename T>
+inline void
+unpack_view(datastream<T>& s, bytes_view& v) {
+    auto sz = unsigned_int();
+    fc::raw::unpack(s, sz);
+    FC_ASSERT(sz.value <= MAX_SIZE_OF_BYTE_ARRAYS);
+
+    v = bytes_view(s.borrow(sz.value), sz.value);
+}
+
 // bip::basic_string
 template<typename Stream>
 inline void
@@ -4,6 +4,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 #include <variant>
@@ -48,6 +49,11 @@ class private_key;
 template<typename Storage>
 class fixed_string;
 
+class bytes_view;
+
+template<typename T>
+class datastream;
+
 namespace raw {
 template<typename T>
 inline size_t pack_size(const T& v);
@@ -163,6 +169,14 @@ void unpack(Stream& s, std::string&);
 template<typename Stream>
 void pack(Stream& s, const std::string&);
 template<typename Stream>
+inline void pack(Stream& s, const std::string_view& v);
+template<typename Stream>
+inline void pack(Stream& s, const bytes_view& v);
+template<typename T>
+inline void unpack_view(datastream<T>& s, std::string_view& v);
+template<typename T>
+inline void unpack_view(datastream<T>& s, bytes_view& v);
+template<typename Stream>
 void unpack(Stream& s, fc::ecc::public_key&);
 template<typename Stream>
 void pack(Stream& s, const fc::ecc::public_key&);
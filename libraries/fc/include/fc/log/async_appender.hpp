@@ -0,0 +1,53 @@
+#pragma once
+#include <fc/log/appender.hpp>
+#include <fc/log/logger.hpp>
+
+namespace fc {
+
+// Log appender that forwards messages to another appender on a background thread,
+// messages are queued into a lock-free ring buffer, so callers don't pay for formatting and I/O.
+// The wrapped appender must be defined before this one in the logging config.
+class async_appender : public appender {
+public:
+    struct overflow_policy {
+        enum type {
+            drop_newest,  // discard the message being logged
+            drop_oldest,  // discard the oldest queued message to make room
+            block         // wait until there is room
+        };
+    };
+
+    struct config {
+        string                appender;                              // name of the wrapped appender
+        uint32_t              capacity = 8192;                       // rounded up to the power of 2
+        overflow_policy::type overflow = overflow_policy::drop_newest;
+    };
+
+    struct stats {
+        uint64_t enqueued;
+        uint64_t dropped;
+        uint64_t written;
+    };
+
+    async_appender(const variant& args);
+    async_appender(const config& cfg, appender::ptr target);
+    ~async_appender() override;
+
+    void initialize(boost::asio::io_service& io_service) override {}
+    void log(const log_message& m) override;
+
+    // waits until all messages queued before are written
+    void  flush();
+    stats get_stats() const;
+
+private:
+    class impl;
+    std::unique_ptr<impl> my;
+};
+
+}  // namespace fc
+
+#include <fc/reflect/reflect.hpp>
+FC_REFLECT_ENUM(fc::async_appender::overflow_policy::type, (drop_newest)(drop_oldest)(block));
+FC_REFLECT(fc::async_appender::config, (appender)(capacity)(overflow));
+FC_REFLECT(fc::async_appender::stats, (enqueued)(dropped)(written));
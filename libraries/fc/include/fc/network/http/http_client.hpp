@@ -26,8 +26,12 @@ class http_client {
          return post_sync(dest, payload_v, deadline);
       }
 
+      // opens a connection to dest ahead and keeps it in the pool, so the first request has no handshake
+      void connect(const url& dest, const time_point& deadline = time_point::maximum());
+
       void add_cert(const std::string& cert_pem_string);
       void set_verify_peers(bool enabled);
+      void set_pool_limits(uint32_t max_idle_per_host, const microseconds& idle_timeout);
 
 private:
    std::unique_ptr<class http_client_impl> _my;
@@ -0,0 +1,37 @@
+#pragma once
+#include <stddef.h>
+
+namespace fc {
+
+namespace detail {
+class variant_arena;
+}
+
+/**
+ *  While alive, the string, array and object nodes of variants created on the current
+ *  thread are bump allocated from one arena instead of individually from the heap.
+ *
+ *  Destroying a node only runs its destructor, the arena is freed at once when both
+ *  the scope has ended and its last node has been destroyed. So variants built in the
+ *  scope may still outlive it (on any thread), they just keep the arena alive.
+ *
+ *  Scopes can be nested, the innermost one is used.
+ */
+class variant_arena_scope {
+public:
+    explicit variant_arena_scope(size_t chunk_size = 64 * 1024);
+    ~variant_arena_scope();
+
+    variant_arena_scope(const variant_arena_scope&) = delete;
+    variant_arena_scope& operator=(const variant_arena_scope&) = delete;
+
+public:
+    /// bytes allocated from the arena so far
+    size_t allocated() const;
+
+private:
+    detail::variant_arena* _arena;
+    detail::variant_arena* _prev;
+};
+
+}  // namespace fc
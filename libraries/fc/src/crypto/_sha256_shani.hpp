@@ -0,0 +1,149 @@
+#pragma once
+
+/* SHA-256 with x86 sha extensions (sha-ni), used for hashing pairs of digests and by the incremental encoder.
+ * Functions are compiled for the extensions individually and only called if cpu supports them,
+ * `L` messages are hashed together to hide the latency of instructions.
+ */
+#if defined(__x86_64__)
+#include <stddef.h>
+#include <stdint.h>
+#include <cpuid.h>
+#include <immintrin.h>
+
+namespace fc { namespace detail {
+
+#define SHANI_TARGET __attribute__((target("sha,sse4.1,ssse3")))
+
+alignas(16) inline const uint32_t kSha256K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+// initial state in the order of (ABEF, CDGH) used by sha-ni
+alignas(16) inline const uint32_t kSha256Init[8] = {
+    0x9b05688c, 0x510e527f, 0xbb67ae85, 0x6a09e667, 0x5be0cd19, 0x1f83d9ab, 0xa54ff53a, 0x3c6ef372
+};
+
+// padding block of 64 bytes message: 0x80, zeros and the message length of 512 bits
+alignas(16) inline const uint8_t kSha256Pad64[64] = {
+    0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0,    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0,    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0,    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x02, 0
+};
+
+template<int L>
+SHANI_TARGET inline void
+sha256_shani_compress(__m128i (&abef)[L], __m128i (&cdgh)[L], const uint8_t* (&data)[L]) {
+    const auto kMask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    __m128i abef_save[L], cdgh_save[L], w[L][4];
+    for(int l = 0; l < L; l++) {
+        abef_save[l] = abef[l];
+        cdgh_save[l] = cdgh[l];
+    }
+
+    for(int i = 0; i < 16; i++) {
+        auto k = _mm_load_si128((const __m128i*)&kSha256K[i * 4]);
+        for(int l = 0; l < L; l++) {
+            auto& wi = w[l][i % 4];
+            if(i < 4) {
+                wi = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data[l] + i * 16)), kMask);
+            }
+            else {
+                // w[i] = msg2(msg1(w[i-4], w[i-3]) + alignr(w[i-1], w[i-2]), w[i-1])
+                auto t = _mm_alignr_epi8(w[l][(i + 3) % 4], w[l][(i + 2) % 4], 4);
+                wi     = _mm_sha256msg1_epu32(wi, w[l][(i + 1) % 4]);
+                wi     = _mm_sha256msg2_epu32(_mm_add_epi32(wi, t), w[l][(i + 3) % 4]);
+            }
+            auto msg = _mm_add_epi32(wi, k);
+            cdgh[l]  = _mm_sha256rnds2_epu32(cdgh[l], abef[l], msg);
+            abef[l]  = _mm_sha256rnds2_epu32(abef[l], cdgh[l], _mm_shuffle_epi32(msg, 0x0e));
+        }
+    }
+
+    for(int l = 0; l < L; l++) {
+        abef[l] = _mm_add_epi32(abef[l], abef_save[l]);
+        cdgh[l] = _mm_add_epi32(cdgh[l], cdgh_save[l]);
+    }
+}
+
+// (ABEF, CDGH) -> (ABCD, EFGH) in big endian
+SHANI_TARGET inline void
+sha256_shani_store(__m128i abef, __m128i cdgh, uint8_t* out) {
+    const auto kMask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    auto feba = _mm_shuffle_epi32(abef, 0x1b);
+    auto dchg = _mm_shuffle_epi32(cdgh, 0xb1);
+    auto dcba = _mm_blend_epi16(feba, dchg, 0xf0);
+    auto hgfe = _mm_alignr_epi8(dchg, feba, 8);
+    _mm_storeu_si128((__m128i*)(out + 0), _mm_shuffle_epi8(dcba, kMask));
+    _mm_storeu_si128((__m128i*)(out + 16), _mm_shuffle_epi8(hgfe, kMask));
+}
+
+template<int L>
+SHANI_TARGET inline void
+sha256_shani_hash64(const uint8_t* const (&in)[L], uint8_t* const (&out)[L]) {
+    __m128i abef[L], cdgh[L];
+    const uint8_t* data[L];
+    for(int l = 0; l < L; l++) {
+        abef[l] = _mm_load_si128((const __m128i*)&kSha256Init[0]);
+        cdgh[l] = _mm_load_si128((const __m128i*)&kSha256Init[4]);
+        data[l] = in[l];
+    }
+    sha256_shani_compress<L>(abef, cdgh, data);
+    for(int l = 0; l < L; l++) {
+        data[l] = kSha256Pad64;
+    }
+    sha256_shani_compress<L>(abef, cdgh, data);
+
+    for(int l = 0; l < L; l++) {
+        sha256_shani_store(abef[l], cdgh[l], out[l]);
+    }
+}
+
+// compress `n` blocks of 64 bytes into `state`, which is kept in the order of (ABEF, CDGH)
+SHANI_TARGET inline void
+sha256_shani_blocks(uint32_t (&state)[8], const uint8_t* data, size_t n) {
+    __m128i abef[1] = { _mm_loadu_si128((const __m128i*)&state[0]) };
+    __m128i cdgh[1] = { _mm_loadu_si128((const __m128i*)&state[4]) };
+    for(size_t i = 0; i < n; i++) {
+        const uint8_t* d[1] = { data + i * 64 };
+        sha256_shani_compress<1>(abef, cdgh, d);
+    }
+    _mm_storeu_si128((__m128i*)&state[0], abef[0]);
+    _mm_storeu_si128((__m128i*)&state[4], cdgh[0]);
+}
+
+SHANI_TARGET inline void
+sha256_shani_digest(const uint32_t (&state)[8], uint8_t* out) {
+    sha256_shani_store(_mm_loadu_si128((const __m128i*)&state[0]), _mm_loadu_si128((const __m128i*)&state[4]), out);
+}
+
+inline bool
+has_sha_extensions() {
+    unsigned int eax, ebx, ecx, edx;
+    if(!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+    auto sse41 = (ecx & bit_SSE4_1) != 0;
+    auto ssse3 = (ecx & bit_SSSE3) != 0;
+    if(!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+    return sse41 && ssse3 && (ebx & bit_SHA) != 0;
+}
+
+inline const bool kHasShaExtensions = has_sha_extensions();
+
+#undef SHANI_TARGET
+
+}}  // namespace fc::detail
+
+#endif
@@ -11,640 +11,199 @@
 // - E-mail usually won't line-break if there's no punctuation to break at.
 // - Doubleclicking selects the whole number as one word if it's all alphanumeric.
 //
-#ifndef BITCOIN_BASE58_H
-#define BITCOIN_BASE58_H
-
-#include <string>
-#include <vector>
-#include <limits>
-#include <algorithm>
 #include <string.h>
+#include <ctype.h>
+#include <algorithm>
+#include <array>
 
-#include <fc/log/logger.hpp>
-#include <fc/string.hpp>
+#include <fc/crypto/base58.hpp>
+#include <fc/container/small_vector_fwd.hpp>
 #include <fc/exception/exception.hpp>
 
-#include <stdexcept>
-#include <vector>
-#include <openssl/bn.h>
-
-/** Errors thrown by the bignum class */
-class bignum_error : public std::runtime_error {
-public:
-    explicit bignum_error(const std::string& str)
-        : std::runtime_error(str) {}
-};
-
-/** RAII encapsulated BN_CTX (OpenSSL bignum context) */
-class CAutoBN_CTX {
-protected:
-    BN_CTX* pctx;
-    BN_CTX* operator=(BN_CTX* pnew) { return pctx = pnew; }
-
-public:
-    CAutoBN_CTX() {
-        pctx = BN_CTX_new();
-        if(pctx == NULL)
-            throw bignum_error("CAutoBN_CTX : BN_CTX_new() returned NULL");
-    }
-
-    ~CAutoBN_CTX() {
-        if(pctx != NULL)
-            BN_CTX_free(pctx);
-    }
+namespace fc {
 
-    operator BN_CTX*() { return pctx; }
-    BN_CTX&  operator*() { return *pctx; }
-    BN_CTX** operator&() { return &pctx; }
-    bool     operator!() { return (pctx == NULL); }
-};
+namespace {
 
-/** C++ wrapper for BIGNUM (OpenSSL bignum) */
-class CBigNum {
-    BIGNUM* bn;
+// Numbers are converted with limbs instead of one digit / byte each time:
+// base58 side uses limbs of 5 digits (58^5 < 2^30) and binary side uses 32 bits limbs,
+// so that each step of multiplying and adding is done by 64 bits integers.
+// Limbs are kept on stack for payloads of keys, addresses and signatures (33, 37, 65 bytes and so on).
 
-public:
-    CBigNum()
-        : bn(BN_new()) {}
+const char kBase58Alphabet[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
 
-    CBigNum(const CBigNum& b)
-        : CBigNum() {
-        if(!BN_copy(bn, b.bn)) {
-            BN_clear_free(bn);
-            throw bignum_error("CBigNum::CBigNum(const CBigNum&) : BN_copy failed");
-        }
-    }
+constexpr uint32_t kBase58LimbDigits = 5;
+constexpr uint32_t kBase58Limb       = 58u * 58u * 58u * 58u * 58u;
+constexpr uint32_t kPow58[]          = { 1u, 58u, 58u * 58u, 58u * 58u * 58u, 58u * 58u * 58u * 58u, kBase58Limb };
 
-    CBigNum& operator=(const CBigNum& b) {
-        if(!BN_copy(bn, b.bn))
-            throw bignum_error("CBigNum::operator= : BN_copy failed");
-        return (*this);
+// -1 for invalid characters
+constexpr auto kBase58Map = [] {
+    auto map = std::array<int8_t, 256>();
+    for(auto& m : map) {
+        m = -1;
     }
-
-    ~CBigNum() {
-        BN_clear_free(bn);
+    for(auto i = 0; i < 58; i++) {
+        map[(uint8_t)kBase58Alphabet[i]] = i;
     }
+    return map;
+}();
 
-    //CBigNum(char n) is not portable.  Use 'signed char' or 'unsigned char'.
-    CBigNum(signed char n)
-        : CBigNum() {
-        if(n >= 0)
-            setulong(n);
-        else
-            setint64(n);
-    }
-    CBigNum(short n)
-        : CBigNum() {
-        if(n >= 0)
-            setulong(n);
-        else
-            setint64(n);
-    }
-    CBigNum(int n)
-        : CBigNum() {
-        if(n >= 0)
-            setulong(n);
-        else
-            setint64(n);
-    }
-    CBigNum(int64_t n)
-        : CBigNum() { setint64(n); }
-    CBigNum(unsigned char n)
-        : CBigNum() { setulong(n); }
-    CBigNum(unsigned short n)
-        : CBigNum() { setulong(n); }
-    CBigNum(unsigned int n)
-        : CBigNum() { setulong(n); }
-    CBigNum(uint64_t n)
-        : CBigNum() { setuint64(n); }
+template<typename T>
+using limbs = fc::small_vector<T, 24>;
 
-    explicit CBigNum(const std::vector<unsigned char>& vch)
-        : CBigNum() {
-        setvch(vch);
+// `limbs` is little endian with `base`, does `limbs = limbs * mul + add`
+template<uint64_t base, typename T>
+inline void
+mul_add(limbs<T>& l, uint64_t mul, uint64_t add) {
+    auto carry = add;
+    for(auto& v : l) {
+        auto t = (uint64_t)v * mul + carry;
+        v      = (T)(t % base);
+        carry  = t / base;
     }
-
-    void setulong(unsigned long n) {
-        if(!BN_set_word(bn, n))
-            throw bignum_error("CBigNum conversion from unsigned long : BN_set_word failed");
+    while(carry > 0) {
+        l.push_back((T)(carry % base));
+        carry /= base;
     }
+}
 
-    unsigned long getulong() const {
-        return BN_get_word(bn);
-    }
+}  // namespace
 
-    unsigned int getuint() const {
-        return BN_get_word(bn);
-    }
+std::string
+to_base58(const char* d, size_t s) {
+    auto data = (const uint8_t*)d;
 
-    int getint() const {
-        unsigned long n = BN_get_word(bn);
-        if(!BN_is_negative(bn))
-            return (n > (unsigned long)std::numeric_limits<int>::max() ? std::numeric_limits<int>::max() : n);
-        else
-            return (n > (unsigned long)std::numeric_limits<int>::max() ? std::numeric_limits<int>::min() : -(int)n);
+    auto zeros = 0u;
+    while(zeros < s && data[zeros] == 0) {
+        zeros++;
     }
 
-    void setint64(int64_t n) {
-        unsigned char  pch[sizeof(n) + 6];
-        unsigned char* p         = pch + 4;
-        bool           fNegative = false;
-        if(n < (int64_t)0) {
-            n         = -n;
-            fNegative = true;
-        }
-        bool fLeadingZeroes = true;
-        for(int i = 0; i < 8; i++) {
-            unsigned char c = (n >> 56) & 0xff;
-            n <<= 8;
-            if(fLeadingZeroes) {
-                if(c == 0)
-                    continue;
-                if(c & 0x80)
-                    *p++ = (fNegative ? 0x80 : 0);
-                else if(fNegative)
-                    c |= 0x80;
-                fLeadingZeroes = false;
-            }
-            *p++ = c;
-        }
-        unsigned int nSize = p - (pch + 4);
-        pch[0]             = (nSize >> 24) & 0xff;
-        pch[1]             = (nSize >> 16) & 0xff;
-        pch[2]             = (nSize >> 8) & 0xff;
-        pch[3]             = (nSize)&0xff;
-        BN_mpi2bn(pch, p - pch, bn);
-    }
+    // number in base 58^5, fed by 32 bits big endian words (the first one may be partial)
+    auto l = limbs<uint32_t>();
+    l.reserve(s * 138 / 100 / kBase58LimbDigits + 1);
 
-    void setuint64(uint64_t n) {
-        unsigned char  pch[sizeof(n) + 6];
-        unsigned char* p              = pch + 4;
-        bool           fLeadingZeroes = true;
-        for(int i = 0; i < 8; i++) {
-            unsigned char c = (n >> 56) & 0xff;
-            n <<= 8;
-            if(fLeadingZeroes) {
-                if(c == 0)
-                    continue;
-                if(c & 0x80)
-                    *p++ = 0;
-                fLeadingZeroes = false;
-            }
-            *p++ = c;
+    auto i = (size_t)zeros;
+    if(auto head = (s - i) % 4; head > 0) {
+        auto w = 0u;
+        for(auto end = i + head; i < end; i++) {
+            w = (w << 8) | data[i];
         }
-        unsigned int nSize = p - (pch + 4);
-        pch[0]             = (nSize >> 24) & 0xff;
-        pch[1]             = (nSize >> 16) & 0xff;
-        pch[2]             = (nSize >> 8) & 0xff;
-        pch[3]             = (nSize)&0xff;
-        BN_mpi2bn(pch, p - pch, bn);
-    }
-
-    void setvch(const std::vector<unsigned char>& vch) {
-        std::vector<unsigned char> vch2(vch.size() + 4);
-        unsigned int               nSize = vch.size();
-        // BIGNUM's byte stream format expects 4 bytes of
-        // big endian size data info at the front
-        vch2[0] = (nSize >> 24) & 0xff;
-        vch2[1] = (nSize >> 16) & 0xff;
-        vch2[2] = (nSize >> 8) & 0xff;
-        vch2[3] = (nSize >> 0) & 0xff;
-        // swap data to big endian
-        reverse_copy(vch.begin(), vch.end(), vch2.begin() + 4);
-        BN_mpi2bn(&vch2[0], vch2.size(), bn);
-    }
-
-    std::vector<unsigned char> getvch() const {
-        unsigned int nSize = BN_bn2mpi(bn, NULL);
-        if(nSize <= 4)
-            return std::vector<unsigned char>();
-        std::vector<unsigned char> vch(nSize);
-        BN_bn2mpi(bn, &vch[0]);
-        vch.erase(vch.begin(), vch.begin() + 4);
-        reverse(vch.begin(), vch.end());
-        return vch;
-    }
-
-    CBigNum& SetCompact(unsigned int nCompact) {
-        unsigned int               nSize = nCompact >> 24;
-        std::vector<unsigned char> vch(4 + nSize);
-        vch[3] = nSize;
-        if(nSize >= 1)
-            vch[4] = (nCompact >> 16) & 0xff;
-        if(nSize >= 2)
-            vch[5] = (nCompact >> 8) & 0xff;
-        if(nSize >= 3)
-            vch[6] = (nCompact >> 0) & 0xff;
-        BN_mpi2bn(&vch[0], vch.size(), bn);
-        return *this;
+        mul_add<kBase58Limb>(l, 1ull << (8 * head), w);
     }
-
-    unsigned int GetCompact() const {
-        unsigned int               nSize = BN_bn2mpi(bn, NULL);
-        std::vector<unsigned char> vch(nSize);
-        nSize -= 4;
-        BN_bn2mpi(bn, &vch[0]);
-        unsigned int nCompact = nSize << 24;
-        if(nSize >= 1)
-            nCompact |= (vch[4] << 16);
-        if(nSize >= 2)
-            nCompact |= (vch[5] << 8);
-        if(nSize >= 3)
-            nCompact |= (vch[6] << 0);
-        return nCompact;
+    for(; i < s; i += 4) {
+        auto w = ((uint32_t)data[i] << 24) | ((uint32_t)data[i + 1] << 16) | ((uint32_t)data[i + 2] << 8) | data[i + 3];
+        mul_add<kBase58Limb>(l, 1ull << 32, w);
     }
 
-    void SetHex(const std::string& str) {
-        // skip 0x
-        const char* psz = str.c_str();
-        while(isspace(*psz))
-            psz++;
-        bool fNegative = false;
-        if(*psz == '-') {
-            fNegative = true;
-            psz++;
+    auto str = std::string(zeros + l.size() * kBase58LimbDigits, kBase58Alphabet[0]);
+    auto pos = str.size();
+    for(auto v : l) {
+        for(auto j = 0u; j < kBase58LimbDigits; j++) {
+            str[--pos] = kBase58Alphabet[v % 58];
+            v /= 58;
         }
-        if(psz[0] == '0' && tolower(psz[1]) == 'x')
-            psz += 2;
-        while(isspace(*psz))
-            psz++;
-
-        // hex string to bignum
-        static signed char phexdigit[256] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-                                             0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-                                             0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-                                             0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 0,
-                                             0, 0, 0, 0, 0, 0xa, 0xb, 0xc, 0xd, 0xe, 0xf,
-                                             0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-                                             0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xa, 0xb,
-                                             0xc, 0xd, 0xe, 0xf, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-        *this = 0;
-        while(isxdigit(*psz)) {
-            *this <<= 4;
-            int n = phexdigit[(unsigned char)*psz++];
-            *this += n;
-        }
-        if(fNegative)
-            BN_set_negative(bn, 1);
-    }
-
-    std::string ToString(int nBase = 10) const {
-        CAutoBN_CTX pctx;
-        CBigNum     bnBase = nBase;
-        CBigNum     bn0    = 0;
-        std::string str;
-        CBigNum     bn = *this;
-        BN_set_negative(bn.bn, false);
-        CBigNum dv;
-        CBigNum rem;
-        if(BN_cmp(bn.bn, bn0.bn) == 0)
-            return "0";
-        while(BN_cmp(bn.bn, bn0.bn) > 0) {
-            if(!BN_div(dv.bn, rem.bn, bn.bn, bnBase.bn, pctx))
-                throw bignum_error("CBigNum::ToString() : BN_div failed");
-            bn             = dv;
-            unsigned int c = rem.getulong();
-            str += "0123456789abcdef"[c];
-        }
-        if(BN_is_negative(this->bn))
-            str += "-";
-        reverse(str.begin(), str.end());
-        return str;
     }
+    // remove zero digits from the most significant limb
+    auto first = str.find_first_not_of(kBase58Alphabet[0], zeros);
+    str.erase(zeros, (first == std::string::npos ? str.size() : first) - zeros);
+    return str;
+}
 
-    std::string GetHex() const {
-        return ToString(16);
-    }
+std::string
+to_base58(const std::vector<char>& d) {
+    if(d.size())
+        return to_base58(d.data(), d.size());
+    return std::string();
+}
 
-    bool operator!() const {
-        return BN_is_zero(bn);
-    }
+namespace {
 
-    CBigNum& operator+=(const CBigNum& b) {
-        if(!BN_add(bn, bn, b.bn))
-            throw bignum_error("CBigNum::operator+= : BN_add failed");
-        return *this;
-    }
-
-    CBigNum& operator-=(const CBigNum& b) {
-        if(!BN_sub(bn, bn, b.bn))
-            throw bignum_error("CBigNum::operator-= : BN_sub failed");
-        return *this;
+// same as before: leading and trailing whitespaces are skipped
+// returns false if there're invalid characters
+template<typename Output>
+bool
+decode_base58(const char* psz, Output&& output) {
+    while(isspace(*psz)) {
+        psz++;
     }
 
-    CBigNum& operator*=(const CBigNum& b) {
-        CAutoBN_CTX pctx;
-        if(!BN_mul(bn, bn, b.bn, pctx))
-            throw bignum_error("CBigNum::operator*= : BN_mul failed");
-        return *this;
+    auto end = psz;
+    while(*end != '\0' && kBase58Map[(uint8_t)*end] >= 0) {
+        end++;
     }
-
-    CBigNum& operator/=(const CBigNum& b) {
-        CAutoBN_CTX pctx;
-        if(!BN_div(bn, NULL, bn, b.bn, pctx))
-            throw bignum_error("CBigNum::operator/= : BN_div failed");
-        return *this;
+    for(auto p = end; *p != '\0'; p++) {
+        if(!isspace(*p)) {
+            return false;
+        }
     }
 
-    CBigNum& operator%=(const CBigNum& b) {
-        CAutoBN_CTX pctx;
-        if(!BN_div(NULL, bn, bn, b.bn, pctx))
-            throw bignum_error("CBigNum::operator%= : BN_div failed");
-        return *this;
+    auto zeros = 0u;
+    while(psz + zeros < end && psz[zeros] == kBase58Alphabet[0]) {
+        zeros++;
     }
 
-    CBigNum& operator<<=(unsigned int shift) {
-        if(!BN_lshift(bn, bn, shift))
-            throw bignum_error("CBigNum:operator<<= : BN_lshift failed");
-        return *this;
-    }
+    // number in base 2^32, fed by limbs of 5 digits (the first one may be partial)
+    auto l = limbs<uint32_t>();
+    l.reserve((end - psz) * 733 / 1000 / 4 + 1);
 
-    CBigNum& operator>>=(unsigned int shift) {
-        // Note: BN_rshift segfaults on 64-bit if 2^shift is greater than the number
-        //   if built on ubuntu 9.04 or 9.10, probably depends on version of openssl
-        CBigNum a = 1;
-        a <<= shift;
-        if(BN_cmp(a.bn, bn) > 0) {
-            *this = 0;
-            return *this;
+    auto p = psz + zeros;
+    while(p < end) {
+        auto n = (uint32_t)std::min<size_t>(kBase58LimbDigits, end - p);
+        if(p == psz + zeros && (end - p) % kBase58LimbDigits > 0) {
+            n = (end - p) % kBase58LimbDigits;
         }
-
-        if(!BN_rshift(bn, bn, shift))
-            throw bignum_error("CBigNum:operator>>= : BN_rshift failed");
-        return *this;
-    }
-
-    CBigNum& operator++() {
-        // prefix operator
-        if(!BN_add(bn, bn, BN_value_one()))
-            throw bignum_error("CBigNum::operator++ : BN_add failed");
-        return *this;
+        auto v = 0u;
+        for(auto j = 0u; j < n; j++) {
+            v = v * 58 + kBase58Map[(uint8_t)*p++];
+        }
+        mul_add<1ull << 32>(l, kPow58[n], v);
     }
 
-    const CBigNum operator++(int) {
-        // postfix operator
-        const CBigNum ret = *this;
-        ++(*this);
-        return ret;
+    // strip zero bytes of the most significant limb
+    auto bytes = l.size() * 4;
+    if(!l.empty()) {
+        for(auto top = l.back(); (top >> 24) == 0; top <<= 8) {
+            bytes--;
+        }
     }
 
-    CBigNum& operator--() {
-        // prefix operator
-        CBigNum r;
-        if(!BN_sub(r.bn, bn, BN_value_one()))
-            throw bignum_error("CBigNum::operator-- : BN_sub failed");
-        *this = r;
-        return *this;
+    if(zeros + bytes == 0) {
+        return true;
     }
-
-    const CBigNum operator--(int) {
-        // postfix operator
-        const CBigNum ret = *this;
-        --(*this);
-        return ret;
+    auto out = output(zeros + bytes);
+    if(out == nullptr) {
+        return false;
     }
-
-    const BIGNUM* to_bignum() const {
-        return bn;
+    memset(out, 0, zeros);
+    out += zeros;
+    for(auto i = 0u; i < bytes; i++) {
+        auto k = bytes - 1 - i;
+        out[i] = (char)(l[k / 4] >> (8 * (k % 4)));
     }
-    BIGNUM* to_bignum() {
-        return bn;
-    }
-};
-
-inline const CBigNum
-operator+(const CBigNum& a, const CBigNum& b) {
-    CBigNum r;
-    if(!BN_add(r.to_bignum(), a.to_bignum(), b.to_bignum()))
-        throw bignum_error("CBigNum::operator+ : BN_add failed");
-    return r;
-}
-
-inline const CBigNum
-operator-(const CBigNum& a, const CBigNum& b) {
-    CBigNum r;
-    if(!BN_sub(r.to_bignum(), a.to_bignum(), b.to_bignum()))
-        throw bignum_error("CBigNum::operator- : BN_sub failed");
-    return r;
-}
-
-inline const CBigNum
-operator-(const CBigNum& a) {
-    CBigNum r(a);
-    BN_set_negative(r.to_bignum(), !BN_is_negative(r.to_bignum()));
-    return r;
-}
-
-inline const CBigNum operator*(const CBigNum& a, const CBigNum& b) {
-    CAutoBN_CTX pctx;
-    CBigNum     r;
-    if(!BN_mul(r.to_bignum(), a.to_bignum(), b.to_bignum(), pctx))
-        throw bignum_error("CBigNum::operator* : BN_mul failed");
-    return r;
-}
-
-inline const CBigNum
-operator/(const CBigNum& a, const CBigNum& b) {
-    CAutoBN_CTX pctx;
-    CBigNum     r;
-    if(!BN_div(r.to_bignum(), NULL, a.to_bignum(), b.to_bignum(), pctx))
-        throw bignum_error("CBigNum::operator/ : BN_div failed");
-    return r;
-}
-
-inline const CBigNum
-operator%(const CBigNum& a, const CBigNum& b) {
-    CAutoBN_CTX pctx;
-    CBigNum     r;
-    if(!BN_mod(r.to_bignum(), a.to_bignum(), b.to_bignum(), pctx))
-        throw bignum_error("CBigNum::operator% : BN_div failed");
-    return r;
-}
-
-inline const CBigNum
-operator<<(const CBigNum& a, unsigned int shift) {
-    CBigNum r;
-    if(!BN_lshift(r.to_bignum(), a.to_bignum(), shift))
-        throw bignum_error("CBigNum:operator<< : BN_lshift failed");
-    return r;
-}
-
-inline const CBigNum
-operator>>(const CBigNum& a, unsigned int shift) {
-    CBigNum r = a;
-    r >>= shift;
-    return r;
-}
-
-inline bool
-operator==(const CBigNum& a, const CBigNum& b) {
-    return (BN_cmp(a.to_bignum(), b.to_bignum()) == 0);
-}
-
-inline bool
-operator!=(const CBigNum& a, const CBigNum& b) {
-    return (BN_cmp(a.to_bignum(), b.to_bignum()) != 0);
-}
-
-inline bool
-operator<=(const CBigNum& a, const CBigNum& b) {
-    return (BN_cmp(a.to_bignum(), b.to_bignum()) <= 0);
-}
-
-inline bool
-operator>=(const CBigNum& a, const CBigNum& b) {
-    return (BN_cmp(a.to_bignum(), b.to_bignum()) >= 0);
-}
-
-inline bool
-operator<(const CBigNum& a, const CBigNum& b) {
-    return (BN_cmp(a.to_bignum(), b.to_bignum()) < 0);
-}
-
-inline bool
-operator>(const CBigNum& a, const CBigNum& b) {
-    return (BN_cmp(a.to_bignum(), b.to_bignum()) > 0);
-}
-
-static const char* pszBase58 = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
-
-// Encode a byte sequence as a base58-encoded string
-inline std::string
-EncodeBase58(const unsigned char* pbegin, const unsigned char* pend) {
-    CAutoBN_CTX pctx;
-    CBigNum     bn58 = 58;
-    CBigNum     bn0  = 0;
-
-    // Convert big endian data to little endian
-    // Extra zero at the end make sure bignum will interpret as a positive number
-    std::vector<unsigned char> vchTmp(pend - pbegin + 1, 0);
-    reverse_copy(pbegin, pend, vchTmp.begin());
-
-    // Convert little endian data to bignum
-    CBigNum bn;
-    bn.setvch(vchTmp);
-
-    // Convert bignum to std::string
-    std::string str;
-    // Expected size increase from base58 conversion is approximately 137%
-    // use 138% to be safe
-    str.reserve((pend - pbegin) * 138 / 100 + 1);
-    CBigNum dv;
-    CBigNum rem;
-    while(bn > bn0) {
-        if(!BN_div(dv.to_bignum(), rem.to_bignum(), bn.to_bignum(), bn58.to_bignum(), pctx))
-            throw bignum_error("EncodeBase58 : BN_div failed");
-        bn             = dv;
-        unsigned int c = rem.getulong();
-        str += pszBase58[c];
-    }
-
-    // Leading zeroes encoded as base58 zeros
-    for(const unsigned char* p = pbegin; p < pend && *p == 0; p++)
-        str += pszBase58[0];
-
-    // Convert little endian std::string to big endian
-    reverse(str.begin(), str.end());
-    //    slog( "Encode '%s'", str.c_str() );
-    return str;
-}
-
-// Encode a byte vector as a base58-encoded string
-inline std::string
-EncodeBase58(const std::vector<unsigned char>& vch) {
-    return EncodeBase58(&vch[0], &vch[0] + vch.size());
-}
-
-// Decode a base58-encoded string psz into byte vector vchRet
-// returns true if decoding is succesful
-inline bool
-DecodeBase58(const char* psz, std::vector<unsigned char>& vchRet) {
-    CAutoBN_CTX pctx;
-    vchRet.clear();
-    CBigNum bn58 = 58;
-    CBigNum bn   = 0;
-    CBigNum bnChar;
-    while(isspace(*psz))
-        psz++;
-
-    // Convert big endian string to bignum
-    for(const char* p = psz; *p; p++) {
-        const char* p1 = strchr(pszBase58, *p);
-        if(p1 == NULL) {
-            while(isspace(*p))
-                p++;
-            if(*p != '\0') {
-                //slog( "%s  '%c'", pszBase58,*p );
-                return false;
-            }
-            break;
-        }
-        bnChar.setulong(p1 - pszBase58);
-        if(!BN_mul(bn.to_bignum(), bn.to_bignum(), bn58.to_bignum(), pctx))
-            throw bignum_error("DecodeBase58 : BN_mul failed");
-        bn += bnChar;
-    }
-
-    // Get bignum as little endian data
-    std::vector<unsigned char> vchTmp = bn.getvch();
-
-    // Trim off sign byte if present
-    if(vchTmp.size() >= 2 && vchTmp.end()[-1] == 0 && vchTmp.end()[-2] >= 0x80)
-        vchTmp.erase(vchTmp.end() - 1);
-
-    // Restore leading zeros
-    int nLeadingZeros = 0;
-    for(const char* p = psz; *p == pszBase58[0]; p++)
-        nLeadingZeros++;
-    vchRet.assign(nLeadingZeros + vchTmp.size(), 0);
-
-    // Convert little endian data to big endian
-    reverse_copy(vchTmp.begin(), vchTmp.end(), vchRet.end() - vchTmp.size());
     return true;
 }
 
-// Decode a base58-encoded string str into byte vector vchRet
-// returns true if decoding is succesful
-inline bool
-DecodeBase58(const std::string& str, std::vector<unsigned char>& vchRet) {
-    return DecodeBase58(str.c_str(), vchRet);
-}
-
-namespace fc {
-
-std::string
-to_base58(const char* d, size_t s) {
-    return EncodeBase58((const unsigned char*)d, (const unsigned char*)d + s).c_str();
-}
+}  // namespace
 
-std::string
-to_base58(const std::vector<char>& d) {
-    if(d.size())
-        return to_base58(d.data(), d.size());
-    return std::string();
-}
 std::vector<char>
 from_base58(const std::string& base58_str) {
-    std::vector<unsigned char> out;
-    if(!DecodeBase58(base58_str.c_str(), out)) {
+    auto out = std::vector<char>();
+    if(!decode_base58(base58_str.c_str(), [&](size_t n) { out.resize(n); return out.data(); })) {
         FC_THROW_EXCEPTION(parse_error_exception, "Unable to decode base58 string ${base58_str}", ("base58_str", base58_str));
     }
-    return std::vector<char>((const char*)out.data(), ((const char*)out.data()) + out.size());
+    return out;
 }
+
 /**
  *  @return the number of bytes decoded
  */
 size_t
 from_base58(const std::string& base58_str, char* out_data, size_t out_data_len) {
-    //slog( "%s", base58_str.c_str() );
-    std::vector<unsigned char> out;
-    if(!DecodeBase58(base58_str.c_str(), out)) {
+    auto size = (size_t)0;
+    if(!decode_base58(base58_str.c_str(), [&](size_t n) { size = n; return n <= out_data_len ? out_data : nullptr; })) {
+        FC_ASSERT(size <= out_data_len);
         FC_THROW_EXCEPTION(parse_error_exception, "Unable to decode base58 string ${base58_str}", ("base58_str", base58_str));
     }
-    FC_ASSERT(out.size() <= out_data_len);
-    memcpy(out_data, out.data(), out.size());
-    return out.size();
+    return size;
 }
 
 }  // namespace fc
-
-#endif
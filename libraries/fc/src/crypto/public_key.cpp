@@ -1,6 +1,10 @@
 #include <fc/crypto/public_key.hpp>
 #include <fc/crypto/common.hpp>
 #include <fc/exception/exception.hpp>
+#include <algorithm>
+#include <array>
+#include <string.h>
+#include <future>
 
 namespace fc { namespace crypto {
 
@@ -58,11 +62,59 @@ public_key::valid() const {
     return _storage.visit(is_valid_visitor());
 }
 
-public_key::operator std::string() const {
-    auto data_str = _storage.visit(base58str_visitor<storage_type, config::public_key_prefix, 0>());
+namespace {
+
+// keys are stored compressed, the bytes after the parity byte are the x-coordinate
+// which is uniformly distributed, so a word of it is already a good hash
+struct hash_visitor : public fc::visitor<size_t> {
+    template<typename KeyType>
+    size_t operator()(const KeyType& key) const {
+        static_assert(sizeof(key._data) >= 1 + sizeof(size_t), "key is too short to be hashed");
+        auto h = size_t();
+        memcpy(&h, key._data.data() + 1, sizeof(h));
+        return h;
+    }
+};
 
+// strings of recently formatted keys, the same keys are formatted again and again in json responses.
+// it's direct-mapped by the x-coordinate of keys and one per thread, so no locking is needed
+struct key_string_cache {
+    static constexpr size_t kSize = 64;
+
+    using data_type = typename public_key::storage_type::template type_at<0>::data_type;
+
+    struct entry {
+        data_type   key;
+        std::string str;
+    };
+
+    std::string*
+    lookup(const public_key& pkey, const data_type& key) {
+        auto& e = entries[hash_value(pkey) % kSize];
+        if(e.str.empty() || e.key != key) {
+            e.key = key;
+            e.str.clear();
+        }
+        return &e.str;
+    }
+
+    std::array<entry, kSize> entries;
+};
+
+}  // namespace
+
+public_key::operator std::string() const {
     FC_ASSERT(_storage.which() == 0);
-    return std::string(config::public_key_evt_prefix) + data_str;
+
+    using default_type = typename storage_type::template type_at<0>;
+    static thread_local key_string_cache cache;
+
+    auto str = cache.lookup(*this, _storage.template get<default_type>().serialize());
+    if(str->empty()) {
+        auto data_str = _storage.visit(base58str_visitor<storage_type, config::public_key_prefix, 0>());
+        *str = std::string(config::public_key_evt_prefix) + data_str;
+    }
+    return *str;
 }
 
 std::ostream&
@@ -86,6 +138,43 @@ operator<(const public_key& p1, const public_key& p2) {
     return less_comparator<public_key::storage_type>::apply(p1._storage, p2._storage);
 }
 
+size_t
+hash_value(const public_key& k) {
+    return k._storage.visit(hash_visitor()) ^ k._storage.which();
+}
+
+std::vector<public_key>
+recover_public_keys(const recovery_items& items, uint32_t lanes, bool check_canonical) {
+    // fewer signatures are not worth a thread
+    const size_t kMinLaneSize = 8;
+
+    auto keys    = std::vector<public_key>(items.size());
+    auto recover = [&](size_t begin, size_t end) {
+        for(auto i = begin; i < end; i++) {
+            keys[i] = public_key(items[i].first, items[i].second, check_canonical);
+        }
+    };
+
+    auto n = std::max<size_t>(1, std::min<size_t>(lanes, items.size() / kMinLaneSize));
+    if(n == 1) {
+        recover(0, items.size());
+        return keys;
+    }
+
+    // first range is recovered in current thread
+    auto step    = (items.size() + n - 1) / n;
+    auto futures = std::vector<std::future<void>>();
+    futures.reserve(n - 1);
+    for(auto i = 1u; i < n; i++) {
+        futures.emplace_back(std::async(std::launch::async, recover, i * step, std::min(items.size(), (i + 1) * step)));
+    }
+    recover(0, step);
+    for(auto& f : futures) {
+        f.get();
+    }
+    return keys;
+}
+
 }}  // namespace fc::crypto
 
 namespace fc {
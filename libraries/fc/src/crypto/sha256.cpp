@@ -3,11 +3,13 @@
 #include <fc/fwd_impl.hpp>
 #include <openssl/sha.h>
 #include <string.h>
+#include <algorithm>
 #include <cmath>
 #include <fc/crypto/sha256.hpp>
 #include <fc/variant.hpp>
 #include <fc/exception/exception.hpp>
 #include "_digest_common.hpp"
+#include "_sha256_shani.hpp"
 
 namespace fc {
 
@@ -41,8 +43,18 @@ sha256::data() const {
     return (char*)&_hash[0];
 }
 
+// state of sha-ni path, it's chosen once by cpuid and openssl is used otherwise
+struct sha256_shani_ctx {
+    uint32_t state[8];  // in the order of (ABEF, CDGH)
+    uint8_t  buf[64];
+    uint64_t length;    // bytes written
+};
+
 struct sha256::encoder::impl {
-    SHA256_CTX ctx;
+    union {
+        SHA256_CTX       ctx;
+        sha256_shani_ctx shani;
+    };
 };
 
 sha256::encoder::~encoder() {}
@@ -67,19 +79,106 @@ sha256::hash(const sha256& s) {
     return hash(s.data(), sizeof(s._hash));
 }
 
+void
+sha256::hash_pairs(const sha256* in, size_t n, sha256* out) {
+    static_assert(sizeof(sha256) == 32);
+
+    auto i = 0u;
+#if defined(__x86_64__)
+    if(detail::kHasShaExtensions) {
+        for(; i + 2 <= n; i += 2) {
+            const uint8_t* const src[2] = { (const uint8_t*)&in[2 * i], (const uint8_t*)&in[2 * i + 2] };
+            uint8_t* const       dst[2] = { (uint8_t*)&out[i], (uint8_t*)&out[i + 1] };
+            detail::sha256_shani_hash64<2>(src, dst);
+        }
+        if(i < n) {
+            const uint8_t* const src[1] = { (const uint8_t*)&in[2 * i] };
+            uint8_t* const       dst[1] = { (uint8_t*)&out[i] };
+            detail::sha256_shani_hash64<1>(src, dst);
+        }
+        return;
+    }
+#endif
+    for(; i < n; i++) {
+        SHA256((const uint8_t*)&in[2 * i], sizeof(sha256) * 2, (uint8_t*)out[i].data());
+    }
+}
+
 void
 sha256::encoder::write(const char* d, uint32_t dlen) {
+#if defined(__x86_64__)
+    if(detail::kHasShaExtensions) {
+        if(dlen == 0) {
+            return;
+        }
+
+        auto& c    = my->shani;
+        auto  data = (const uint8_t*)d;
+        auto  used = (uint32_t)(c.length % 64);
+        c.length += dlen;
+
+        if(used > 0) {
+            auto n = std::min(64 - used, dlen);
+            memcpy(c.buf + used, data, n);
+            if(used + n < 64) {
+                return;
+            }
+            detail::sha256_shani_blocks(c.state, c.buf, 1);
+            data += n;
+            dlen -= n;
+        }
+        if(auto blocks = dlen / 64; blocks > 0) {
+            detail::sha256_shani_blocks(c.state, data, blocks);
+            data += blocks * 64;
+            dlen -= blocks * 64;
+        }
+        if(dlen > 0) {
+            memcpy(c.buf, data, dlen);
+        }
+        return;
+    }
+#endif
     SHA256_Update(&my->ctx, d, dlen);
 }
 
 sha256
 sha256::encoder::result() {
     sha256 h;
+#if defined(__x86_64__)
+    if(detail::kHasShaExtensions) {
+        auto& c    = my->shani;
+        auto  used = (uint32_t)(c.length % 64);
+
+        // padding: 0x80, zeros and then message length in bits in big endian
+        c.buf[used++] = 0x80;
+        if(used > 56) {
+            memset(c.buf + used, 0, 64 - used);
+            detail::sha256_shani_blocks(c.state, c.buf, 1);
+            used = 0;
+        }
+        memset(c.buf + used, 0, 56 - used);
+
+        auto bits = c.length * 8;
+        for(auto i = 0; i < 8; i++) {
+            c.buf[63 - i] = (uint8_t)(bits >> (i * 8));
+        }
+        detail::sha256_shani_blocks(c.state, c.buf, 1);
+        detail::sha256_shani_digest(c.state, (uint8_t*)h.data());
+        return h;
+    }
+#endif
     SHA256_Final((uint8_t*)h.data(), &my->ctx);
     return h;
 }
 void
 sha256::encoder::reset() {
+#if defined(__x86_64__)
+    if(detail::kHasShaExtensions) {
+        memcpy(my->shani.state, detail::kSha256Init, sizeof(my->shani.state));
+        my->shani.length = 0;
+        return;
+    }
+#endif
     SHA256_Init(&my->ctx);
 }
 
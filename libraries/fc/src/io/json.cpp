@@ -443,6 +443,16 @@ namespace fc
 
    variant json::from_string( const std::string& utf8_str, parse_type ptype, uint32_t max_depth )
    { try {
+      switch( ptype )
+      {
+          case rapidjson_parser:
+              return rapidjson::variant_from_string( utf8_str.data(), utf8_str.size(), max_depth );
+          case rapidjson_parser_with_string_doubles:
+              return rapidjson::variant_from_string( utf8_str.data(), utf8_str.size(), max_depth, true );
+          default:
+              break;
+      }
+
       std::stringstream in( utf8_str );
       //in.exceptions( std::ifstream::eofbit );
       switch( ptype )
@@ -455,14 +465,6 @@ namespace fc
               return json_relaxed::variant_from_stream<std::stringstream, true>( in, max_depth );
           case relaxed_parser:
               return json_relaxed::variant_from_stream<std::stringstream, false>( in, max_depth );
-          case rapidjson_parser: {
-              auto c = in.peek();
-              if(c == '"') {
-                  in.seekg(0);
-                  return variant_from_stream<std::stringstream, legacy_parser>( in, max_depth );
-              }
-              return rapidjson::variant_from_stream<std::stringstream, false>( in, max_depth );
-          }
           default:
               FC_ASSERT( false, "Unknown JSON parser type {ptype}", ("ptype", ptype) );
       }
@@ -470,6 +472,9 @@ namespace fc
 
    variants json::variants_from_string( const std::string& utf8_str, parse_type ptype, uint32_t max_depth )
    { try {
+      if( ptype == rapidjson_parser )
+         return rapidjson::variants_from_string( utf8_str.data(), utf8_str.size(), max_depth );
+
       variants result;
       std::stringstream in( utf8_str );
       //in.exceptions( std::ifstream::eofbit );
@@ -672,9 +677,20 @@ namespace fc
 
    std::string   json::to_string( const variant& v, output_formatting format )
    {
-      std::stringstream ss;
-      fc::to_stream( ss, v, format );
-      return ss.str();
+      switch(format) {
+      case stringify_large_ints_and_doubles: {
+         return rapidjson::to_string<true>(v);
+      }
+      case legacy_generator: {
+         std::stringstream ss;
+         fc::to_stream( ss, v, format );
+         return ss.str();
+      }
+      case rapidjson_generator: {
+         return rapidjson::to_string(v);
+      }
+      }  // switch
+      return std::string();
    }
 
 
@@ -778,7 +794,11 @@ namespace fc
    std::string json::to_pretty_string( const variant& v, output_formatting format )
    {
       switch(format) {
-      case stringify_large_ints_and_doubles:
+      case stringify_large_ints_and_doubles: {
+         std::stringstream ss;
+         rapidjson::to_stream_pretty<true>(ss, v);
+         return ss.str();
+      }
       case legacy_generator: {
          return pretty_print(to_string(v, format), 2);
       }
@@ -802,7 +822,7 @@ namespace fc
       else
       {
        std::ofstream o(fi.generic_string().c_str());
-       fc::to_stream( o, v, format );
+       json::to_stream( o, v, format );
       }
    }
    variant json::from_file( const fc::path& p, parse_type ptype, uint32_t max_depth )
@@ -812,6 +832,17 @@ namespace fc
       //buffered_istream bi( tmp );
       std::ifstream bi( p.string(), std::ios::binary );
       switch( ptype )
+      {
+          case rapidjson_parser:
+          case rapidjson_parser_with_string_doubles: {
+              // read whole file and parse from memory, it's much faster than through std::ifstream
+              auto str = std::string( std::istreambuf_iterator<char>(bi), std::istreambuf_iterator<char>() );
+              return rapidjson::variant_from_string( str.data(), str.size(), max_depth, ptype == rapidjson_parser_with_string_doubles );
+          }
+          default:
+              break;
+      }
+      switch( ptype )
       {
           case legacy_parser:
              return variant_from_stream<std::ifstream, legacy_parser>( bi, max_depth );
@@ -821,8 +852,6 @@ namespace fc
               return json_relaxed::variant_from_stream<std::ifstream, true>( bi, max_depth );
           case relaxed_parser:
               return json_relaxed::variant_from_stream<std::ifstream, false>( bi, max_depth );
-          case rapidjson_parser:
-              return rapidjson::variant_from_stream<std::ifstream, false>( bi, max_depth );
           default:
               FC_ASSERT( false, "Unknown JSON parser type {ptype}", ("ptype", ptype) );
       }
@@ -849,7 +878,10 @@ namespace fc
    std::ostream& json::to_stream( std::ostream& out, const variant& v, output_formatting format )
    {
       switch(format) {
-      case stringify_large_ints_and_doubles:
+      case stringify_large_ints_and_doubles: {
+          rapidjson::to_stream<true>(out, v);
+          break;
+      }
       case legacy_generator: {
           fc::to_stream( out, v, format );
           break;
@@ -865,13 +897,16 @@ namespace fc
    std::ostream& json::to_stream( std::ostream& out, const variants& v, output_formatting format )
    {
       switch(format) {
-      case stringify_large_ints_and_doubles:
+      case stringify_large_ints_and_doubles: {
+          rapidjson::to_stream<true>(out, variant(v));
+          break;
+      }
       case legacy_generator: {
           fc::to_stream( out, v, format );
           break;
       }
       case rapidjson_generator: {
-          rapidjson::to_stream(out, v);
+          rapidjson::to_stream(out, variant(v));
           break;
       }
       }  // switch
@@ -881,13 +916,16 @@ namespace fc
    std::ostream& json::to_stream( std::ostream& out, const variant_object& v, output_formatting format )
    {
       switch(format) {
-      case stringify_large_ints_and_doubles:
+      case stringify_large_ints_and_doubles: {
+          rapidjson::to_stream<true>(out, variant(v));
+          break;
+      }
       case legacy_generator: {
           fc::to_stream( out, v, format );
           break;
       }
       case rapidjson_generator: {
-          rapidjson::to_stream(out, v);
+          rapidjson::to_stream(out, variant(v));
           break;
       }
       }  // switch
@@ -898,6 +936,16 @@ namespace fc
    bool json::is_valid( const std::string& utf8_str, parse_type ptype, uint32_t max_depth )
    {
       if( utf8_str.size() == 0 ) return false;
+      if( ptype == rapidjson_parser || ptype == rapidjson_parser_with_string_doubles ) {
+         try {
+            rapidjson::variant_from_string( utf8_str.data(), utf8_str.size(), max_depth );
+            return true;
+         }
+         catch( const fc::exception& ) {
+            return false;
+         }
+      }
+
       std::stringstream in( utf8_str );
       switch( ptype )
       {
@@ -913,9 +961,6 @@ namespace fc
           case relaxed_parser:
              json_relaxed::variant_from_stream<std::stringstream, false>( in, max_depth );
               break;
-          case rapidjson_parser:
-             rapidjson::variant_from_stream<std::stringstream, false>( in, max_depth );
-              break;
           default:
               FC_ASSERT( false, "Unknown JSON parser type {ptype}", ("ptype", ptype) );
       }
@@ -6,6 +6,7 @@
 #include <fc/log/appender.hpp>
 #include <fc/log/logger.hpp>
 #include <fc/log/console_appender.hpp>
+#include <fc/log/async_appender.hpp>
 
 #ifndef FCLITE
 #include <fc/log/file_appender.hpp>
@@ -50,6 +51,7 @@ appender::create(const fc::string& name, const fc::string& type, const variant&
 }
 
 static bool reg_console_appender = appender::register_appender<console_appender>("console");
+static bool reg_async_appender   = appender::register_appender<async_appender>("async");
 #ifndef FCLITE
 //static bool reg_file_appender = appender::register_appender<file_appender>( "file" );
 static bool reg_gelf_appender = appender::register_appender<gelf_appender>("gelf");
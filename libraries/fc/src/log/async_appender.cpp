@@ -0,0 +1,259 @@
+#include <fc/log/async_appender.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include <fc/exception/exception.hpp>
+#include <fc/log/log_message.hpp>
+#include <fc/log/logger_config.hpp>
+#include <fc/reflect/variant.hpp>
+#include <fc/variant.hpp>
+
+namespace fc {
+
+extern std::unordered_map<std::string, appender::ptr>& get_appender_map();
+
+namespace detail {
+
+// bounded multi-producer multi-consumer queue, each cell has a sequence number telling
+// whether it's ready to be written or read at the position, so no locking is needed
+class log_ring_buffer {
+public:
+    log_ring_buffer(size_t capacity)
+        : _cells(new cell[capacity])
+        , _mask(capacity - 1) {
+        for(auto i = 0u; i < capacity; i++) {
+            _cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+public:
+    bool
+    try_push(const log_message& m) {
+        auto pos = _head.load(std::memory_order_relaxed);
+        while(true) {
+            auto& c   = _cells[pos & _mask];
+            auto  seq = c.seq.load(std::memory_order_acquire);
+            auto  dif = (intptr_t)seq - (intptr_t)pos;
+            if(dif == 0) {
+                if(_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    c.msg = m;
+                    c.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if(dif < 0) {
+                return false;  // full
+            }
+            else {
+                pos = _head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool
+    try_pop(log_message& m) {
+        auto pos = _tail.load(std::memory_order_relaxed);
+        while(true) {
+            auto& c   = _cells[pos & _mask];
+            auto  seq = c.seq.load(std::memory_order_acquire);
+            auto  dif = (intptr_t)seq - (intptr_t)(pos + 1);
+            if(dif == 0) {
+                if(_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    m = std::move(c.msg);
+                    c.seq.store(pos + _mask + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if(dif < 0) {
+                return false;  // empty
+            }
+            else {
+                pos = _tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool
+    empty() const {
+        return _head.load() == _tail.load();
+    }
+
+private:
+    struct cell {
+        std::atomic<size_t> seq;
+        log_message         msg;
+    };
+
+    std::unique_ptr<cell[]> _cells;
+    size_t                  _mask;
+
+    alignas(64) std::atomic<size_t> _head = 0;
+    alignas(64) std::atomic<size_t> _tail = 0;
+};
+
+}  // namespace detail
+
+class async_appender::impl {
+public:
+    impl(const config& c, appender::ptr t)
+        : cfg(c)
+        , target(std::move(t))
+        , queue(round_capacity(c.capacity)) {
+        worker = std::thread([this] { run(); });
+    }
+
+    ~impl() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        cv.notify_one();
+        worker.join();
+    }
+
+    static size_t
+    round_capacity(uint32_t capacity) {
+        auto c = (size_t)2;
+        while(c < capacity) {
+            c <<= 1;
+        }
+        return c;
+    }
+
+    void
+    push(const log_message& m) {
+        switch(cfg.overflow) {
+        case overflow_policy::drop_newest: {
+            if(!queue.try_push(m)) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            break;
+        }
+        case overflow_policy::drop_oldest: {
+            auto old = log_message();
+            while(!queue.try_push(m)) {
+                if(queue.try_pop(old)) {
+                    dropped.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            break;
+        }
+        case overflow_policy::block: {
+            while(!queue.try_push(m)) {
+                notify();
+                std::this_thread::yield();
+            }
+            break;
+        }
+        }  // switch
+        enqueued.fetch_add(1, std::memory_order_relaxed);
+        notify();
+    }
+
+    // only takes the lock when worker is going to sleep
+    void
+    notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(sleeping.load()) {
+            std::lock_guard<std::mutex> lock(mutex);
+            cv.notify_one();
+        }
+    }
+
+    void
+    run() {
+        set_thread_name("log");
+
+        auto m = log_message();
+        while(true) {
+            writing = true;
+            if(queue.try_pop(m)) {
+                try {
+                    target->log(m);
+                }
+                catch(const fc::exception& e) {
+                    std::cerr << "async_appender: failed to write log: " << e.to_string() << "\n";
+                }
+                catch(const std::exception& e) {
+                    std::cerr << "async_appender: failed to write log: " << e.what() << "\n";
+                }
+                written.fetch_add(1, std::memory_order_relaxed);
+                writing = false;
+                continue;
+            }
+            writing = false;
+
+            std::unique_lock<std::mutex> lock(mutex);
+            if(stopping && queue.empty()) {
+                break;
+            }
+            sleeping = true;
+            if(queue.empty() && !stopping) {
+                cv.wait_for(lock, std::chrono::milliseconds(100));
+            }
+            sleeping = false;
+        }
+    }
+
+public:
+    config        cfg;
+    appender::ptr target;
+
+    detail::log_ring_buffer queue;
+    std::thread             worker;
+
+    std::mutex              mutex;
+    std::condition_variable cv;
+    std::atomic<bool>       sleeping = false;
+    std::atomic<bool>       writing  = false;
+    bool                    stopping = false;
+
+    std::atomic<uint64_t> enqueued = 0;
+    std::atomic<uint64_t> dropped  = 0;
+    std::atomic<uint64_t> written  = 0;
+};
+
+static appender::ptr
+get_target(const async_appender::config& cfg) {
+    auto& map = get_appender_map();
+    auto  it  = map.find(cfg.appender);
+    FC_ASSERT(it != map.end() && it->second, "Appender '${name}' to be wrapped by async appender is not defined before", ("name", cfg.appender));
+    return it->second;
+}
+
+async_appender::async_appender(const variant& args) {
+    auto cfg = args.as<config>();
+    my.reset(new impl(cfg, get_target(cfg)));
+}
+
+async_appender::async_appender(const config& cfg, appender::ptr target)
+    : my(new impl(cfg, std::move(target))) {}
+
+async_appender::~async_appender() {}
+
+void
+async_appender::log(const log_message& m) {
+    my->push(m);
+}
+
+void
+async_appender::flush() {
+    while(!my->queue.empty() || my->writing) {
+        my->notify();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+async_appender::stats
+async_appender::get_stats() const {
+    return stats{ my->enqueued.load(), my->dropped.load(), my->written.load() };
+}
+
+}  // namespace fc
@@ -11,6 +11,7 @@
 
 #include <fc/log/appender.hpp>
 #include <fc/log/console_appender.hpp>
+#include <fc/log/async_appender.hpp>
 
 #ifndef FCLITE
 #include <fc/log/gelf_appender.hpp>
@@ -33,6 +34,7 @@ bool
 configure_logging(const logging_config& cfg) {
     try {
         static bool reg_console_appender = appender::register_appender<console_appender>("console");
+        static bool reg_async_appender   = appender::register_appender<async_appender>("async");
 #ifndef FCLITE
         static bool reg_gelf_appender = appender::register_appender<gelf_appender>("gelf");
 #endif
@@ -63,9 +65,9 @@ configure_logging(const logging_config& cfg) {
             }
         }
 #ifndef FCLITE
-        return reg_console_appender || reg_gelf_appender;
+        return reg_console_appender || reg_async_appender || reg_gelf_appender;
 #else
-        return reg_console_appender;
+        return reg_console_appender || reg_async_appender;
 #endif
     }
     catch(exception& e) {
@@ -9,6 +9,11 @@
 #include <boost/asio/ssl/rfc2818_verification.hpp>
 #include <boost/filesystem.hpp>
 
+#include <cerrno>
+#include <deque>
+#include <mutex>
+#include <sys/socket.h>
+
 #include <fc/network/http/http_client.hpp>
 #include <fc/io/json.hpp>
 #include <fc/scoped_exit.hpp>
@@ -43,7 +48,12 @@ public:
                                      , unix_socket_ptr
 #endif
                                     >;
-   using connection_map = std::map<host_key, connection>;
+   struct pooled_connection {
+      connection conn;
+      time_point last_used;
+   };
+   using connection_pool = std::map<host_key, std::deque<pooled_connection>>;
+   using ssl_session_map = std::map<host_key, SSL_SESSION*>;
    using unix_url_split_map = std::map<string, fc::url>;
    using error_code = boost::system::error_code;
    using deadline_type = boost::posix_time::ptime;
@@ -55,6 +65,12 @@ public:
       set_verify_peers(true);
    }
 
+   ~http_client_impl() {
+      for (auto& it : _ssl_sessions) {
+         SSL_SESSION_free(it.second);
+      }
+   }
+
    void add_cert(const std::string& cert_pem_string) {
       error_code ec;
       _sslc.add_certificate_authority(boost::asio::buffer(cert_pem_string.data(), cert_pem_string.size()), ec);
@@ -69,6 +85,11 @@ public:
       }
    }
 
+   void set_pool_limits(uint32_t max_idle_per_host, const microseconds& idle_timeout) {
+      _max_idle_per_host = max_idle_per_host;
+      _idle_timeout = idle_timeout;
+   }
+
    template<typename SyncReadStream, typename Fn, typename CancelFn>
    error_code sync_do_with_deadline( SyncReadStream& s, deadline_type deadline, Fn f, CancelFn cf ) {
       bool timer_expired = false;
@@ -168,37 +189,28 @@ public:
    }
 
 #ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
-   connection_map::iterator create_unix_connection( const url& dest, const deadline_type& deadline) {
-      auto key = url_to_host_key(dest);
+   connection create_unix_connection( const url& dest, const deadline_type& deadline) {
       auto socket = std::make_unique<local::stream_protocol::socket>(_ioc);
 
       error_code ec;
       socket->connect(local::stream_protocol::endpoint(*dest.host()), ec);
       FC_ASSERT(!ec, "Failed to connect: ${message}", ("message",ec.message()));
 
-      auto res = _connections.emplace(std::piecewise_construct,
-                                      std::forward_as_tuple(key),
-                                      std::forward_as_tuple(std::move(socket)));
-
-      return res.first;
+      return connection(std::move(socket));
    }
 #endif
 
-   connection_map::iterator create_raw_connection( const url& dest, const deadline_type& deadline ) {
-      auto key = url_to_host_key(dest);
+   connection create_raw_connection( const url& dest, const deadline_type& deadline ) {
       auto socket = std::make_unique<tcp::socket>(_ioc);
 
       error_code ec = sync_connect_with_timeout(*socket, *dest.host(), dest.port() ? std::to_string(*dest.port()) : "80", deadline);
       FC_ASSERT(!ec, "Failed to connect: ${message}", ("message",ec.message()));
+      socket->set_option(tcp::no_delay(true), ec);
 
-      auto res = _connections.emplace(std::piecewise_construct,
-                                      std::forward_as_tuple(key),
-                                      std::forward_as_tuple(std::move(socket)));
-
-      return res.first;
+      return connection(std::move(socket));
    }
 
-   connection_map::iterator create_ssl_connection( const url& dest, const deadline_type& deadline ) {
+   connection create_ssl_connection( const url& dest, const deadline_type& deadline ) {
       auto key = url_to_host_key(dest);
       auto ssl_socket = std::make_unique<ssl::stream<tcp::socket>>(_ioc, _sslc);
 
@@ -211,6 +223,12 @@ public:
 
       ssl_socket->set_verify_callback(boost::asio::ssl::rfc2818_verification(*dest.host()));
 
+      // resume the last session of this host to skip the full handshake
+      auto sitr = _ssl_sessions.find(key);
+      if (sitr != _ssl_sessions.end()) {
+         SSL_set_session(ssl_socket->native_handle(), sitr->second);
+      }
+
       error_code ec = sync_connect_with_timeout(ssl_socket->next_layer(), *dest.host(), dest.port() ? std::to_string(*dest.port()) : "443", deadline);
       if (!ec) {
          ec = sync_do_with_deadline(ssl_socket->next_layer(), deadline, [&ssl_socket](std::optional<error_code>& final_ec) {
@@ -220,15 +238,12 @@ public:
          });
       }
       FC_ASSERT(!ec, "Failed to connect: ${message}", ("message",ec.message()));
+      ssl_socket->next_layer().set_option(tcp::no_delay(true), ec);
 
-      auto res = _connections.emplace(std::piecewise_construct,
-                                      std::forward_as_tuple(key),
-                                      std::forward_as_tuple(std::move(ssl_socket)));
-
-      return res.first;
+      return connection(std::move(ssl_socket));
    }
 
-   connection_map::iterator create_connection( const url& dest, const deadline_type& deadline ) {
+   connection create_connection( const url& dest, const deadline_type& deadline ) {
       if (dest.proto() == "http") {
          return create_raw_connection(dest, deadline);
       } else if (dest.proto() == "https") {
@@ -242,39 +257,76 @@ public:
       }
    }
 
-   struct check_closed_visitor : public visitor<bool> {
-      bool operator() ( const raw_socket_ptr& ptr ) const {
-         return !ptr->is_open();
+   struct check_alive_visitor : public visitor<bool> {
+      template<typename S>
+      bool operator() ( const S& ptr ) const {
+         auto& socket = ptr->lowest_layer();
+         if (!socket.is_open()) {
+            return false;
+         }
+         // an idle connection has nothing to read, otherwise peer has closed it or sent something unexpected
+         char c;
+         auto n = ::recv(socket.native_handle(), &c, 1, MSG_PEEK | MSG_DONTWAIT);
+         return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
       }
+   };
 
-      bool operator() ( const ssl_socket_ptr& ptr ) const {
-         return !ptr->lowest_layer().is_open();
+   // most recently used connection is taken first, connections idle for too long or closed are dropped
+   std::optional<connection> take_idle_connection( const host_key& key ) {
+      auto itr = _pool.find(key);
+      if (itr == _pool.end()) {
+         return {};
       }
 
-#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
-      bool operator() ( const unix_socket_ptr& ptr) const {
-         return !ptr->is_open();
+      auto now = time_point::now();
+      auto& idles = itr->second;
+      while (!idles.empty()) {
+         auto pc = std::move(idles.back());
+         idles.pop_back();
+         if (now - pc.last_used < _idle_timeout && pc.conn.visit(check_alive_visitor())) {
+            return std::optional<connection>(std::move(pc.conn));
+         }
       }
-#endif
-   };
+      return {};
+   }
 
-   bool check_closed( const connection_map::iterator& conn_itr ) {
-      if (conn_itr->second.visit(check_closed_visitor())) {
-         _connections.erase(conn_itr);
-         return true;
-      } else {
-         return false;
+   void release_connection( const host_key& key, connection&& conn ) {
+      if (conn.contains<ssl_socket_ptr>()) {
+         // session tickets of TLS 1.3 arrive after handshake, so the session is saved once a response is read
+         auto session = SSL_get1_session(conn.get<ssl_socket_ptr>()->native_handle());
+         if (session != nullptr) {
+            auto& cached = _ssl_sessions[key];
+            if (cached != nullptr) {
+               SSL_SESSION_free(cached);
+            }
+            cached = session;
+         }
+      }
+
+      if (_max_idle_per_host == 0) {
+         return;
       }
+      auto& idles = _pool[key];
+      if (idles.size() >= _max_idle_per_host) {
+         idles.pop_front();
+      }
+      idles.emplace_back(pooled_connection{ std::move(conn), time_point::now() });
    }
 
-   connection_map::iterator get_connection( const url& dest, const deadline_type& deadline ) {
+   void connect(const url& dest, const fc::time_point& _deadline) {
+      std::lock_guard<std::mutex> lock(_mutex);
+
       auto key = url_to_host_key(dest);
-      auto conn_itr = _connections.find(key);
-      if (conn_itr == _connections.end() || check_closed(conn_itr)) {
-         return create_connection(dest, deadline);
-      } else {
-         return conn_itr;
+      auto itr = _pool.find(key);
+      if (itr != _pool.end() && !itr->second.empty()) {
+         return;
       }
+      release_connection(key, create_connection(dest, to_deadline(_deadline)));
+   }
+
+   static deadline_type to_deadline(const fc::time_point& deadline) {
+      static const deadline_type epoch(boost::gregorian::date(1970, 1, 1));
+      return epoch + boost::posix_time::microseconds(deadline.time_since_epoch().count());
    }
 
    struct write_request_visitor : visitor<error_code> {
@@ -314,8 +366,9 @@ public:
    };
 
    variant post_sync(const url& dest, const variant& payload, const fc::time_point& _deadline) {
-      static const deadline_type epoch(boost::gregorian::date(1970, 1, 1));
-      auto deadline = epoch + boost::posix_time::microseconds(_deadline.time_since_epoch().count());
+      std::lock_guard<std::mutex> lock(_mutex);
+
+      auto deadline = to_deadline(_deadline);
       FC_ASSERT(dest.host().has_value(), "No host set on URL");
 
       string path = dest.path() ? dest.path()->generic_string() : "/";
@@ -340,14 +393,9 @@ public:
       req.body() = json::to_string(payload);
       req.prepare_payload();
 
-      auto conn_iter = get_connection(dest, deadline);
-      auto eraser = make_scoped_exit([this, &conn_iter](){
-         _connections.erase(conn_iter);
-      });
-
-      // Send the HTTP request to the remote host
-      error_code ec = conn_iter->second.visit(write_request_visitor(this, req, deadline));
-      FC_ASSERT(!ec, "Failed to send request: ${message}", ("message",ec.message()));
+      auto key = url_to_host_key(dest);
+      auto pooled = take_idle_connection(key);
+      auto conn = pooled ? std::move(*pooled) : create_connection(dest, deadline);
 
       // This buffer is used for reading and must be persisted
       boost::beast::flat_buffer buffer;
@@ -355,13 +403,27 @@ public:
       // Declare a container to hold the response
       http::response<http::string_body> res;
 
-      // Receive the HTTP response
-      ec = conn_iter->second.visit(read_response_visitor(this, buffer, res, deadline));
-      FC_ASSERT(!ec, "Failed to read response: ${message}", ("message",ec.message()));
+      // Send the HTTP request to the remote host and receive the HTTP response
+      auto send_request = [&]() -> error_code {
+         auto ec = conn.visit(write_request_visitor(this, req, deadline));
+         if (ec) {
+            return ec;
+         }
+         return conn.visit(read_response_visitor(this, buffer, res, deadline));
+      };
+
+      error_code ec = send_request();
+      if (ec && pooled && ec != boost::system::errc::timed_out && buffer.size() == 0) {
+         // peer may close a pooled connection right after it passed the check, retry once on a new one
+         conn = create_connection(dest, deadline);
+         res = http::response<http::string_body>();
+         ec = send_request();
+      }
+      FC_ASSERT(!ec, "Failed to send request or read response: ${message}", ("message",ec.message()));
 
-      // if the connection can be kept open, keep it open
+      // if the connection can be kept open, return it to the pool
       if (res.keep_alive()) {
-         eraser.cancel();
+         release_connection(key, std::move(conn));
       }
 
       auto result = json::from_string(res.body());
@@ -432,8 +494,12 @@ public:
 
    boost::asio::io_context  _ioc;
    ssl::context             _sslc;
-   connection_map           _connections;
+   connection_pool          _pool;
+   ssl_session_map          _ssl_sessions;
    unix_url_split_map       _unix_url_paths;
+   uint32_t                 _max_idle_per_host = 2;
+   microseconds             _idle_timeout = seconds(60);
+   std::mutex               _mutex;  // requests are made from both main and signing threads
 };
 
 
@@ -452,6 +518,19 @@ variant http_client::post_sync(const url& dest, const variant& payload, const fc
       return _my->post_sync(dest, payload, deadline);
 }
 
+void http_client::connect(const url& dest, const fc::time_point& deadline) {
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+   if(dest.proto() == "unix")
+      _my->connect(_my->get_unix_url(*dest.host()), deadline);
+   else
+#endif
+      _my->connect(dest, deadline);
+}
+
+void http_client::set_pool_limits(uint32_t max_idle_per_host, const microseconds& idle_timeout) {
+   _my->set_pool_limits(max_idle_per_host, idle_timeout);
+}
+
 void http_client::add_cert(const std::string& cert_pem_string) {
    _my->add_cert(cert_pem_string);
 }
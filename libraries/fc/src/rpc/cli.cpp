@@ -103,7 +103,7 @@ void cli::run()
          }
          std::cout << line << "\n";
          line += char(EOF);
-         fc::variants args = fc::json::variants_from_string(line);;
+         fc::variants args = fc::json::variants_from_string(line, fc::json::relaxed_parser);
          if( args.size() == 0 )
             continue;
 
@@ -1,10 +1,14 @@
 #include <string.h>
 #include <algorithm>
+#include <atomic>
+#include <new>
+#include <vector>
 
 #include <boost/scoped_array.hpp>
 
 #include <fc/variant.hpp>
 #include <fc/variant_object.hpp>
+#include <fc/variant_arena.hpp>
 #include <fc/exception/exception.hpp>
 #include <fc/reflect/variant.hpp>
 #include <fc/io/json.hpp>
@@ -12,6 +16,109 @@
 #include <fc/crypto/hex.hpp>
 
 namespace fc {
+
+namespace detail {
+
+// bump allocator of variant nodes, it's referenced by its scope and by every live node in it
+class variant_arena {
+public:
+    explicit variant_arena(size_t chunk_size)
+        : _chunk_size(chunk_size) {}
+
+    ~variant_arena() {
+        for(auto c : _chunks) {
+            ::operator delete(c);
+        }
+    }
+
+public:
+    // only called by the thread owning the scope
+    void*
+    allocate(size_t size) {
+        size = (size + 15) & ~(size_t)15;
+        if(size > (size_t)(_end - _pos)) {
+            auto sz = std::max(size, _chunk_size);
+            _chunks.emplace_back((char*)::operator new(sz));
+            _pos = _chunks.back();
+            _end = _pos + sz;
+        }
+        auto p = _pos;
+        _pos += size;
+        _allocated += size;
+        _refs.fetch_add(1, std::memory_order_relaxed);
+        return p;
+    }
+
+    // nodes may be released from any thread
+    void
+    release() {
+        if(_refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+
+    size_t allocated() const { return _allocated; }
+
+private:
+    size_t              _chunk_size;
+    std::vector<char*>  _chunks;
+    char*               _pos       = nullptr;
+    char*               _end       = nullptr;
+    size_t              _allocated = 0;
+    std::atomic<size_t> _refs      { 1 };
+};
+
+static thread_local variant_arena* current_arena = nullptr;
+
+// every node is prefixed with the arena it comes from, nullptr for the heap
+struct alignas(16) node_header {
+    variant_arena* arena;
+};
+
+template<typename T, typename... Args>
+T*
+new_node(Args&&... args) {
+    static_assert(alignof(T) <= alignof(node_header));
+
+    auto arena = current_arena;
+    auto size  = sizeof(node_header) + sizeof(T);
+    auto h     = new(arena ? arena->allocate(size) : ::operator new(size)) node_header{ arena };
+    try {
+        return new(h + 1) T(std::forward<Args>(args)...);
+    }
+    catch(...) {
+        arena ? arena->release() : ::operator delete(h);
+        throw;
+    }
+}
+
+template<typename T>
+void
+delete_node(T* node) {
+    auto h     = reinterpret_cast<node_header*>(node) - 1;
+    auto arena = h->arena;
+    node->~T();
+    arena ? arena->release() : ::operator delete(h);
+}
+
+}  // namespace detail
+
+variant_arena_scope::variant_arena_scope(size_t chunk_size)
+    : _arena(new detail::variant_arena(chunk_size))
+    , _prev(detail::current_arena) {
+    detail::current_arena = _arena;
+}
+
+variant_arena_scope::~variant_arena_scope() {
+    detail::current_arena = _prev;
+    _arena->release();
+}
+
+size_t
+variant_arena_scope::allocated() const {
+    return _arena->allocated();
+}
+
 /**
   *  The TypeID is stored in the 'last byte' of the variant.
   */
@@ -85,12 +192,12 @@ variant::variant(bool val) {
 }
 
 variant::variant(char* str) {
-    *reinterpret_cast<string**>(this) = new string(str);
+    *reinterpret_cast<string**>(this) = detail::new_node<string>(str);
     set_variant_type(this, string_type);
 }
 
 variant::variant(const char* str) {
-    *reinterpret_cast<string**>(this) = new string(str);
+    *reinterpret_cast<string**>(this) = detail::new_node<string>(str);
     set_variant_type(this, string_type);
 }
 
@@ -101,7 +208,7 @@ variant::variant(wchar_t* str) {
     for(unsigned i = 0; i < len; ++i) {
         buffer[i] = (char)str[i];
     }
-    *reinterpret_cast<string**>(this) = new string(buffer.get(), len);
+    *reinterpret_cast<string**>(this) = detail::new_node<string>(buffer.get(), len);
     set_variant_type(this, string_type);
 }
 
@@ -112,30 +219,30 @@ variant::variant(const wchar_t* str) {
     for(unsigned i = 0; i < len; ++i) {
         buffer[i] = (char)str[i];
     }
-    *reinterpret_cast<string**>(this) = new string(buffer.get(), len);
+    *reinterpret_cast<string**>(this) = detail::new_node<string>(buffer.get(), len);
     set_variant_type(this, string_type);
 }
 
 variant::variant(fc::string val) {
-    *reinterpret_cast<string**>(this) = new string(fc::move(val));
+    *reinterpret_cast<string**>(this) = detail::new_node<string>(fc::move(val));
     set_variant_type(this, string_type);
 }
 variant::variant(blob val) {
-    *reinterpret_cast<blob**>(this) = new blob(fc::move(val));
+    *reinterpret_cast<blob**>(this) = detail::new_node<blob>(fc::move(val));
     set_variant_type(this, blob_type);
 }
 
 variant::variant(variant_object obj) {
-    *reinterpret_cast<variant_object**>(this) = new variant_object(fc::move(obj));
+    *reinterpret_cast<variant_object**>(this) = detail::new_node<variant_object>(fc::move(obj));
     set_variant_type(this, object_type);
 }
 variant::variant(mutable_variant_object obj) {
-    *reinterpret_cast<variant_object**>(this) = new variant_object(fc::move(obj));
+    *reinterpret_cast<variant_object**>(this) = detail::new_node<variant_object>(fc::move(obj));
     set_variant_type(this, object_type);
 }
 
 variant::variant(variants arr) {
-    *reinterpret_cast<variants**>(this) = new variants(fc::move(arr));
+    *reinterpret_cast<variants**>(this) = detail::new_node<variants>(fc::move(arr));
     set_variant_type(this, array_type);
 }
 
@@ -148,16 +255,16 @@ void
 variant::clear() {
     switch(get_type()) {
     case object_type:
-        delete *reinterpret_cast<variant_object**>(this);
+        detail::delete_node(*reinterpret_cast<variant_object**>(this));
         break;
     case array_type:
-        delete *reinterpret_cast<variants**>(this);
+        detail::delete_node(*reinterpret_cast<variants**>(this));
         break;
     case string_type:
-        delete *reinterpret_cast<string**>(this);
+        detail::delete_node(*reinterpret_cast<string**>(this));
         break;
     case blob_type:
-        delete *reinterpret_cast<blob**>(this);
+        detail::delete_node(*reinterpret_cast<blob**>(this));
         break;
     default:
         break;
@@ -168,20 +275,20 @@ variant::clear() {
 variant::variant(const variant& v) {
     switch(v.get_type()) {
     case object_type:
-        *reinterpret_cast<variant_object**>(this) = new variant_object(**reinterpret_cast<const const_variant_object_ptr*>(&v));
+        *reinterpret_cast<variant_object**>(this) = detail::new_node<variant_object>(**reinterpret_cast<const const_variant_object_ptr*>(&v));
         set_variant_type(this, object_type);
         return;
     case array_type:
-        *reinterpret_cast<variants**>(this) = new variants(**reinterpret_cast<const const_variants_ptr*>(&v));
+        *reinterpret_cast<variants**>(this) = detail::new_node<variants>(**reinterpret_cast<const const_variants_ptr*>(&v));
         set_variant_type(this, array_type);
         return;
     case string_type:
-        *reinterpret_cast<string**>(this) = new string(**reinterpret_cast<const const_string_ptr*>(&v));
+        *reinterpret_cast<string**>(this) = detail::new_node<string>(**reinterpret_cast<const const_string_ptr*>(&v));
         set_variant_type(this, string_type);
         return;
     case blob_type:
         *reinterpret_cast<blob**>(this)  =
-        new blob(**reinterpret_cast<const const_blob_ptr*>(&v));
+        detail::new_node<blob>(**reinterpret_cast<const const_blob_ptr*>(&v));
         set_variant_type(this, blob_type);
         return;
     default:
@@ -216,16 +323,16 @@ variant::operator=(const variant& v) {
     clear();
     switch(v.get_type()) {
     case object_type:
-        *reinterpret_cast<variant_object**>(this) = new variant_object((**reinterpret_cast<const const_variant_object_ptr*>(&v)));
+        *reinterpret_cast<variant_object**>(this) = detail::new_node<variant_object>((**reinterpret_cast<const const_variant_object_ptr*>(&v)));
         break;
     case array_type:
-        *reinterpret_cast<variants**>(this) = new variants((**reinterpret_cast<const const_variants_ptr*>(&v)));
+        *reinterpret_cast<variants**>(this) = detail::new_node<variants>((**reinterpret_cast<const const_variants_ptr*>(&v)));
         break;
     case string_type:
-        *reinterpret_cast<string**>(this) = new string((**reinterpret_cast<const const_string_ptr*>(&v)));
+        *reinterpret_cast<string**>(this) = detail::new_node<string>((**reinterpret_cast<const const_string_ptr*>(&v)));
         break;
     case blob_type:
-        *reinterpret_cast<blob**>(this) = new blob((**reinterpret_cast<const const_blob_ptr*>(&v)));
+        *reinterpret_cast<blob**>(this) = detail::new_node<blob>((**reinterpret_cast<const const_blob_ptr*>(&v)));
         break;
     default:
         memcpy(this, &v, sizeof(v));
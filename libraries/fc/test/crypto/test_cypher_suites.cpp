@@ -2,10 +2,14 @@
 #define BOOST_TEST_DYN_LINK
 
 #include <boost/test/unit_test.hpp>
+#include <unordered_set>
+#include <openssl/sha.h>
 
 #include <fc/crypto/public_key.hpp>
 #include <fc/crypto/private_key.hpp>
 #include <fc/crypto/signature.hpp>
+#include <fc/crypto/sha256.hpp>
+#include <fc/crypto/base58.hpp>
 #include <fc/utility.hpp>
 
 using namespace fc::crypto;
@@ -81,4 +85,78 @@ BOOST_AUTO_TEST_CASE(test_k1_recyle) try {
 // } FC_LOG_AND_RETHROW();
 
 
+BOOST_AUTO_TEST_CASE(test_sha256_encoder) try {
+   BOOST_CHECK_EQUAL(sha256::hash("", 0).str(), "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+   BOOST_CHECK_EQUAL(sha256::hash("abc", 3).str(), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+
+   auto msg = std::string("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq");
+   BOOST_CHECK_EQUAL(sha256::hash(msg).str(), "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+
+   // lengths around the padding boundaries, written at once or in pieces of all sizes
+   auto buf = std::string();
+   for(auto i = 0; i < 300; i++) {
+      buf.push_back((char)(i * 7 + 3));
+   }
+   for(auto len = 0u; len <= buf.size(); len++) {
+      auto expected = sha256();
+      SHA256((const unsigned char*)buf.data(), len, (unsigned char*)expected.data());
+
+      BOOST_CHECK_EQUAL(sha256::hash(buf.data(), len).str(), expected.str());
+      for(auto piece : { 1u, 3u, 17u, 63u, 64u, 65u }) {
+         auto enc = sha256::encoder();
+         for(auto i = 0u; i < len; i += piece) {
+            enc.write(buf.data() + i, std::min(piece, (uint32_t)(len - i)));
+         }
+         BOOST_CHECK_EQUAL(enc.result().str(), expected.str());
+      }
+   }
+
+   auto enc = sha256::encoder();
+   enc.write("abc", 3);
+   enc.reset();
+   enc.write(msg.data(), msg.size());
+   BOOST_CHECK_EQUAL(enc.result().str(), "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(test_base58) try {
+   BOOST_CHECK_EQUAL(fc::to_base58(std::vector<char>()), "");
+   BOOST_CHECK_EQUAL(fc::to_base58("\0\0a", 3), "112g");
+   BOOST_CHECK_EQUAL(fc::to_base58("hello world", 11), "StV1DL6CwTryKyV");
+   BOOST_CHECK(fc::from_base58("StV1DL6CwTryKyV") == std::vector<char>({ 'h', 'e', 'l', 'l', 'o', ' ', 'w', 'o', 'r', 'l', 'd' }));
+   BOOST_CHECK(fc::from_base58(" 112g\n") == std::vector<char>({ 0, 0, 'a' }));
+   BOOST_CHECK_THROW(fc::from_base58("0OIl"), fc::parse_error_exception);
+
+   auto buf = std::vector<char>();
+   for(auto i = 0; i < 100; i++) {
+      buf.push_back((char)(i * 37 + 11));
+      auto zeros = buf;
+      zeros.insert(zeros.begin(), 2, 0);
+      BOOST_CHECK(fc::from_base58(fc::to_base58(buf)) == buf);
+      BOOST_CHECK(fc::from_base58(fc::to_base58(zeros)) == zeros);
+   }
+
+   char out[4];
+   BOOST_CHECK_EQUAL(fc::from_base58("112g", out, sizeof(out)), 3);
+   BOOST_CHECK_THROW(fc::from_base58("StV1DL6CwTryKyV", out, sizeof(out)), fc::assert_exception);
+
+   // formatted public keys are cached
+   auto key = private_key(std::string("5KQwrPbwdL6PhXujxW37FSSQZ1JiwsST4cqQzDeyXtP79zkvFD3")).get_public_key();
+   for(auto i = 0; i < 3; i++) {
+      BOOST_CHECK_EQUAL(std::string(key), "EVT6MRyAjQq8ud7hVNYcfnVPJqcVpscN5So8BhtHuGYqET5GDW5CV");
+      BOOST_CHECK(public_key(std::string(key)) == key);
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(test_public_key_hash) try {
+   auto key1 = private_key(std::string("5KQwrPbwdL6PhXujxW37FSSQZ1JiwsST4cqQzDeyXtP79zkvFD3")).get_public_key();
+   auto key2 = private_key::generate().get_public_key();
+
+   BOOST_CHECK_EQUAL(std::hash<public_key>()(key1), std::hash<public_key>()(public_key(std::string(key1))));
+   BOOST_CHECK_NE(std::hash<public_key>()(key1), std::hash<public_key>()(key2));
+
+   auto keys = std::unordered_set<public_key>{ key1, key2 };
+   BOOST_CHECK_EQUAL(keys.size(), 2);
+   BOOST_CHECK(keys.count(public_key(std::string(key2))) == 1);
+} FC_LOG_AND_RETHROW();
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -121,4 +121,56 @@ BOOST_AUTO_TEST_CASE( serialize ) {
     auto v2 = fc::json::from_string(j2);
 
     check_variants_equal(v1, v2);
-}
\ No newline at end of file
+}
+BOOST_AUTO_TEST_CASE( deseriazlie_scalars ) {
+    for(auto json : { "123", "-123", "18446744073709551615", "1.5", "1e5", "true", "null", R"("hello")" }) {
+        auto v1 = fc::json::from_string(json, fc::json::legacy_parser);
+        auto v2 = fc::json::from_string(json, fc::json::rapidjson_parser);
+        check_variants_equal(v1, v2);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( deseriazlie_numbers ) {
+    auto json = R"({"a": 1, "b": -2, "c": 3.25, "d": 4e2, "e": [18446744073709551615, -9223372036854775808]})";
+
+    check_variants_equal(fc::json::from_string(json, fc::json::legacy_parser),
+                         fc::json::from_string(json, fc::json::rapidjson_parser));
+    check_variants_equal(fc::json::from_string(json, fc::json::legacy_parser_with_string_doubles),
+                         fc::json::from_string(json, fc::json::rapidjson_parser_with_string_doubles));
+
+    auto v = fc::json::from_string(json, fc::json::rapidjson_parser_with_string_doubles);
+    BOOST_TEST_CHECK(v["c"].is_string());
+    BOOST_TEST_CHECK(v["c"].as_string() == "3.25");
+}
+
+BOOST_AUTO_TEST_CASE( deseriazlie_variants ) {
+    auto vs = fc::json::variants_from_string(R"( {"a": 1} [1, 2] "str" 3 )");
+    BOOST_TEST_CHECK(vs.size() == 4);
+    BOOST_TEST_CHECK(vs[0]["a"].as_uint64() == 1);
+    BOOST_TEST_CHECK(vs[1].size() == 2);
+    BOOST_TEST_CHECK(vs[2].as_string() == "str");
+    BOOST_TEST_CHECK(vs[3].as_uint64() == 3);
+
+    BOOST_TEST_CHECK(fc::json::variants_from_string("  ").empty());
+    BOOST_TEST_CHECK(fc::json::is_valid(R"({"a": [1, 2]})"));
+    BOOST_TEST_CHECK(!fc::json::is_valid(R"({"a": [1, 2})"));
+}
+
+BOOST_AUTO_TEST_CASE( serialize_parity ) {
+    auto v = fc::variant(fc::mutable_variant_object()
+        ("small", 1)
+        ("large", uint64_t(0x100000000))
+        ("neg", int64_t(-5))
+        ("double", 1.5)
+        ("str", "a\"b\\c\n")
+        ("arr", fc::variants{ fc::variant(), fc::variant(true) }));
+
+    BOOST_TEST_CHECK(fc::json::to_string(v, fc::json::rapidjson_generator) == fc::json::to_string(v, fc::json::legacy_generator));
+
+    auto r = fc::json::from_string(fc::json::to_string(v, fc::json::stringify_large_ints_and_doubles));
+    BOOST_TEST_CHECK(r["small"].is_uint64());
+    BOOST_TEST_CHECK(r["large"].as_string() == "4294967296");
+    BOOST_TEST_CHECK(r["neg"].as_int64() == -5);
+    BOOST_TEST_CHECK(r["double"].as_string() == v["double"].as_string());
+    BOOST_TEST_CHECK(r["str"].as_string() == v["str"].as_string());
+}
@@ -0,0 +1,162 @@
+/**
+ *  @file
+ *  @copyright defined in evt/LICENSE.txt
+ */
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <boost/noncopyable.hpp>
+#include <fc/reflect/reflect.hpp>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace evt { namespace utilities {
+
+// lock spinning for a short while and then parking on futex, so waiters don't burn a core when holder is slow.
+// state is 0 when unlocked, 1 when locked and 2 when locked with waiters parked, only the last one wakes up them.
+// counters are updated while the lock is held, time of holding is only measured when profiling is enabled
+class adaptive_lock : boost::noncopyable {
+public:
+    static constexpr int kSpins = 100;
+
+    struct stats {
+        size_t   acquisitions;
+        size_t   spins;    // acquisitions which had to spin
+        size_t   waits;    // acquisitions which had to park
+        uint64_t held_ns;  // total time of holding, zero if profiling is not enabled
+    };
+
+public:
+    adaptive_lock() = default;
+
+public:
+    void
+    lock() {
+        auto c = 0u;
+        if(state_.compare_exchange_strong(c, 1, std::memory_order_acquire)) {
+            acquired(false, false);
+            return;
+        }
+
+        for(auto i = 0; i < kSpins; i++) {
+            relax();
+            c = 0;
+            if(state_.load(std::memory_order_relaxed) == 0 && state_.compare_exchange_weak(c, 1, std::memory_order_acquire)) {
+                acquired(true, false);
+                return;
+            }
+        }
+
+        // once parked, lock is always taken as 2 since there may be others still waiting
+        if(c != 2) {
+            c = state_.exchange(2, std::memory_order_acquire);
+        }
+        while(c != 0) {
+            wait(2);
+            c = state_.exchange(2, std::memory_order_acquire);
+        }
+        acquired(true, true);
+    }
+
+    bool
+    try_lock() {
+        auto c = 0u;
+        if(state_.compare_exchange_strong(c, 1, std::memory_order_acquire)) {
+            acquired(false, false);
+            return true;
+        }
+        return false;
+    }
+
+    void
+    unlock() {
+        if(profiling_.load(std::memory_order_relaxed) && held_since_ > 0) {
+            add(held_ns_, now() - held_since_);
+        }
+        if(state_.exchange(0, std::memory_order_release) == 2) {
+            wake();
+        }
+    }
+
+public:
+    void set_profiling(bool enabled) { profiling_.store(enabled, std::memory_order_relaxed); }
+
+    stats
+    get_stats() const {
+        return stats {
+            acquisitions_.load(std::memory_order_relaxed),
+            spins_.load(std::memory_order_relaxed),
+            waits_.load(std::memory_order_relaxed),
+            held_ns_.load(std::memory_order_relaxed)
+        };
+    }
+
+private:
+    template<typename T>
+    static void
+    add(std::atomic<T>& counter, T v) {
+        // only written by the holder, so no need of read-modify-write
+        counter.store(counter.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+    }
+
+    void
+    acquired(bool spun, bool waited) {
+        add<size_t>(acquisitions_, 1);
+        if(spun) {
+            add<size_t>(spins_, 1);
+        }
+        if(waited) {
+            add<size_t>(waits_, 1);
+        }
+        held_since_ = profiling_.load(std::memory_order_relaxed) ? now() : 0;
+    }
+
+    static uint64_t
+    now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static void
+    relax() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    }
+
+    void
+    wait(uint32_t expected) {
+#if defined(__linux__)
+        syscall(SYS_futex, (uint32_t*)&state_, FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+#else
+        std::this_thread::yield();
+#endif
+    }
+
+    void
+    wake() {
+#if defined(__linux__)
+        syscall(SYS_futex, (uint32_t*)&state_, FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#endif
+    }
+
+private:
+    std::atomic<uint32_t> state_ = 0;
+    std::atomic_bool      profiling_ = false;
+    uint64_t              held_since_ = 0;
+
+    std::atomic<size_t>   acquisitions_ = 0;
+    std::atomic<size_t>   spins_        = 0;
+    std::atomic<size_t>   waits_        = 0;
+    std::atomic<uint64_t> held_ns_      = 0;
+};
+
+}}  // namespace evt::utilities
+
+FC_REFLECT(evt::utilities::adaptive_lock::stats, (acquisitions)(spins)(waits)(held_ns));
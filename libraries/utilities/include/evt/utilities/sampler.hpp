@@ -0,0 +1,42 @@
+/**
+ *  @file
+ *  @copyright defined in evt/LICENSE.txt
+ */
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <fc/reflect/reflect.hpp>
+
+namespace evt { namespace utilities { namespace sampler {
+
+// Stacks sampled and aggregated in collapsed format, each line is `group;outermost;...;innermost count`
+// which is the input of flamegraph.pl and most flame graph viewers.
+// group is `main` for main thread, otherwise the prefix of the thread name before `-` or `:`, like
+// `net`, `http`, `postgres` and `rocksdb`
+struct profile {
+    uint64_t    samples = 0;  // samples aggregated
+    uint64_t    dropped = 0;  // samples dropped as buffer is full
+    std::string collapsed;
+};
+
+// Starts sampling the stacks of the threads running on cpu by SIGPROF, `frequency` times per second of cpu
+// time consumed by the process. Samples are kept in a buffer of `buffer_size` (at most 200000, about 80MB)
+// allocated here, the ones beyond it are dropped. Samples of previous runs are cleared.
+// Only available on linux, it throws on other platforms
+void start(uint32_t frequency, uint32_t buffer_size);
+void stop();
+bool is_started();
+
+// Aggregates the samples till now, it can be called while sampling. Only the ones of `groups` are
+// included if it's not empty. Frames are symbolized by dynamic symbols, so functions not exported are
+// shown as `module+offset` unless built with `-rdynamic`.
+// It runs in the calling thread and symbolizing is slow (dladdr and demangling of each distinct frame), so
+// callers in main thread stall block production meanwhile. Symbols are cached till next start, so later
+// calls only pay for the new frames
+profile get_profile(const std::vector<std::string>& groups = {});
+
+}}}  // namespace evt::utilities::sampler
+
+FC_REFLECT(evt::utilities::sampler::profile, (samples)(dropped)(collapsed));
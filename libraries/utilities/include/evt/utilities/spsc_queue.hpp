@@ -0,0 +1,159 @@
+/**
+ *  @file
+ *  @copyright defined in evt/LICENSE.txt
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include <evt/utilities/adaptive_lock.hpp>
+
+namespace evt { namespace utilities {
+
+// queue between one producer and one consumer thread
+// items are passed through a lock-free ring, producer never blocks:
+// when the ring is full, items go to an overflow list instead which is drained by consumer once ring is empty,
+// so order of items is always kept
+template<typename T>
+class spsc_queue : boost::noncopyable {
+public:
+    struct stats {
+        size_t size;
+        size_t capacity;
+        size_t high_watermark;  // max size ever reached
+        size_t overflowed;      // items ever pushed into overflow list
+        size_t pushed;
+
+        adaptive_lock::stats overflow_lock;  // contention between producer and consumer on overflow list
+    };
+
+public:
+    explicit spsc_queue(size_t capacity) {
+        auto n = size_t(1);
+        while(n < capacity) {
+            n <<= 1;
+        }
+        ring_.resize(n);
+        mask_ = n - 1;
+    }
+
+public:
+    // producer side
+    template<typename V>
+    void
+    push(V&& v) {
+        auto tail = tail_.load(std::memory_order_relaxed);
+        if(overflow_size_.load(std::memory_order_acquire) == 0 && tail - head_.load(std::memory_order_acquire) < ring_.size()) {
+            ring_[tail & mask_].emplace(std::forward<V>(v));
+            tail_.store(tail + 1, std::memory_order_release);
+        }
+        else {
+            std::lock_guard<adaptive_lock> lock(overflow_lock_);
+            overflow_.emplace_back(std::forward<V>(v));
+            overflow_size_.fetch_add(1, std::memory_order_release);
+            overflowed_++;
+        }
+
+        pushed_++;
+        auto sz = size();
+        if(sz > high_watermark_.load(std::memory_order_relaxed)) {
+            high_watermark_.store(sz, std::memory_order_relaxed);
+        }
+
+        if(waiting_.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(wait_mutex_);
+            wait_cv_.notify_one();
+        }
+    }
+
+    // consumer side, moves all the available items into `out`
+    template<typename Container>
+    size_t
+    pop_all(Container& out) {
+        auto n = 0u;
+        while(true) {
+            auto head = head_.load(std::memory_order_relaxed);
+            auto tail = tail_.load(std::memory_order_acquire);
+            for(; head != tail; head++, n++) {
+                auto& slot = ring_[head & mask_];
+                out.emplace_back(std::move(*slot));
+                slot.reset();
+            }
+            head_.store(head, std::memory_order_release);
+
+            if(overflow_size_.load(std::memory_order_acquire) == 0) {
+                return n;
+            }
+
+            // overflowed items are after the ones in ring, and ring is not pushed while overflow is not empty
+            // so take them only when ring is drained
+            auto items = std::deque<T>();
+            {
+                std::lock_guard<adaptive_lock> lock(overflow_lock_);
+                if(tail_.load(std::memory_order_acquire) != head) {
+                    continue;
+                }
+                items.swap(overflow_);
+                overflow_size_.store(0, std::memory_order_release);
+            }
+            for(auto& v : items) {
+                out.emplace_back(std::move(v));
+                n++;
+            }
+            return n;
+        }
+    }
+
+    // consumer side, waits till any item is pushed or timeout
+    template<typename Duration>
+    void
+    wait_for(const Duration& timeout) {
+        std::unique_lock<std::mutex> lock(wait_mutex_);
+        waiting_.store(true, std::memory_order_release);
+        wait_cv_.wait_for(lock, timeout, [this] { return !empty(); });
+        waiting_.store(false, std::memory_order_release);
+    }
+
+    bool empty() const { return size() == 0; }
+
+    size_t
+    size() const {
+        return (tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire))
+            + overflow_size_.load(std::memory_order_acquire);
+    }
+
+    stats
+    get_stats() const {
+        return stats { size(), ring_.size(), high_watermark_.load(), overflowed_.load(), pushed_.load(), overflow_lock_.get_stats() };
+    }
+
+    // measures the time overflow lock is held
+    void set_lock_profiling(bool enabled) { overflow_lock_.set_profiling(enabled); }
+
+private:
+    std::vector<std::optional<T>> ring_;
+    size_t                        mask_;
+
+    alignas(64) std::atomic<size_t> head_ = 0;  // written by consumer
+    alignas(64) std::atomic<size_t> tail_ = 0;  // written by producer
+
+    adaptive_lock       overflow_lock_;
+    std::deque<T>       overflow_;
+    std::atomic<size_t> overflow_size_ = 0;
+
+    std::atomic_bool        waiting_ = false;
+    std::mutex              wait_mutex_;
+    std::condition_variable wait_cv_;
+
+    std::atomic<size_t> high_watermark_ = 0;
+    std::atomic<size_t> overflowed_     = 0;
+    std::atomic<size_t> pushed_         = 0;
+};
+
+}}  // namespace evt::utilities
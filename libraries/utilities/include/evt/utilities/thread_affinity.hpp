@@ -0,0 +1,44 @@
+/**
+ *  @file
+ *  @copyright defined in evt/LICENSE.txt
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+#include <boost/noncopyable.hpp>
+
+namespace evt { namespace utilities { namespace affinity {
+
+// Parses list of cpus like "0-3,8,10-11"
+std::vector<int> parse_cpu_list(const std::string& list);
+
+// Sets the cpus threads of `pool` are pinned to, threads of the pools not set are left unpinned.
+// It should be set before threads of the pool are started
+void set_pool_cpus(const std::string& pool, const std::vector<int>& cpus);
+
+// Pins current thread to the cpus of `pool` if they're set, threads created by it afterwards inherit them.
+// Returns false if it's not set or not supported on this platform
+bool pin_current_thread(const std::string& pool);
+
+// Same as above and also names current thread as `pool-index` for logs, traces and the sampling profiler
+void enter_pool(const std::string& pool, int index);
+
+// Pins current thread to the cpus of `pool` in its scope and restores them after, threads created
+// in the scope inherit them and are named as `pool`, used for the pools whose threads cannot be pinned by themselves
+class pool_scope : boost::noncopyable {
+public:
+    explicit pool_scope(const std::string& pool);
+    ~pool_scope();
+
+private:
+    std::vector<int> saved_;       // cpus of current thread before, empty if they're not changed
+    std::string      saved_name_;  // kernel name of current thread before
+};
+
+// Prefers the memory allocated by current thread, and threads created by it afterwards, on the numa node
+// of the cpu it runs on now. Current thread should be pinned to the cpus of one node before.
+// Returns the node or -1 if it's not supported
+int prefer_local_numa_node();
+
+}}}  // namespace evt::utilities::affinity
@@ -0,0 +1,67 @@
+/**
+ *  @file
+ *  @copyright defined in evt/LICENSE.txt
+ */
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+#include <boost/noncopyable.hpp>
+#include <boost/preprocessor/cat.hpp>
+#include <fc/variant.hpp>
+
+namespace evt { namespace utilities { namespace trace {
+
+namespace detail {
+
+extern std::atomic<bool> started;
+
+int64_t begin_span();
+void    end_span(const char* name, uint64_t arg, int64_t start);
+
+}  // namespace detail
+
+// Records the time spent in its scope while tracing is started and the outermost span of
+// the thread is sampled, the spans nested in a sampled one are all recorded.
+// `name` is kept by pointer so it should be a string literal.
+class span : boost::noncopyable {
+public:
+    explicit span(const char* name, uint64_t arg = 0)
+        : name_(name)
+        , arg_(arg)
+        , entered_(detail::started.load(std::memory_order_relaxed)) {
+        if(entered_) {
+            start_ = detail::begin_span();
+        }
+    }
+
+    ~span() {
+        if(entered_) {
+            detail::end_span(name_, arg_, start_);
+        }
+    }
+
+private:
+    const char* name_;
+    uint64_t    arg_;
+    bool        entered_;
+    int64_t     start_ = -1;  // -1 if not sampled
+};
+
+// Starts recording one of every `sample_rate` outermost spans of each thread,
+// each thread keeps its latest `buffer_size` spans, previous ones are dropped
+void start(uint32_t sample_rate, uint32_t buffer_size);
+void stop();
+bool is_started();
+
+// Recorded spans of all threads in Chrome trace event format, loadable by chrome://tracing or Perfetto
+fc::variant get_chrome_trace();
+
+}}}  // namespace evt::utilities::trace
+
+// Spans are removed at compile time unless built with ENABLE_TRACING
+#ifdef EVT_TRACING
+#define EVT_TRACE_SPAN(...) ::evt::utilities::trace::span BOOST_PP_CAT(_evt_trace_span_, __LINE__)(__VA_ARGS__)
+#else
+#define EVT_TRACE_SPAN(...)
+#endif
@@ -0,0 +1,269 @@
+/**
+ *  @file
+ *  @copyright defined in evt/LICENSE.txt
+ */
+#include <evt/utilities/sampler.hpp>
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#if defined(__linux__)
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#endif
+
+#include <fc/exception/exception.hpp>
+
+namespace evt { namespace utilities { namespace sampler {
+
+namespace detail {
+
+const int      kMaxDepth   = 48;
+const int      kSkipDepth  = 2;  // frames of signal handler and the trampoline returning to kernel
+const uint32_t kMaxSamples = 200000;  // about 80MB of buffer
+
+// filled in signal handler, so it's fixed size and `ready` is only set after all the others are written
+struct sample {
+    std::atomic<bool> ready;
+    uint32_t          tid;
+    uint16_t          depth;
+    char              name[16];  // kernel name of thread
+    void*             pcs[kMaxDepth];  // innermost first
+};
+
+struct buffer {
+    buffer(uint32_t size)
+        : samples(new sample[size])
+        , size(size) {
+        for(auto i = 0u; i < size; i++) {
+            samples[i].ready.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    std::unique_ptr<sample[]> samples;
+    uint32_t                  size;
+    std::atomic<uint64_t>     next    = 0;
+    std::atomic<uint64_t>     dropped = 0;
+};
+
+std::mutex              mutex;  // serializes the controls and aggregation, never taken in signal handler
+std::unique_ptr<buffer> samples;
+std::atomic<buffer*>    current    = nullptr;
+std::atomic<bool>       started    = false;
+std::atomic<int>        in_handler = 0;
+
+// symbols are kept across calls of `get_profile` as resolving them is the most costly part of it,
+// cleared on start in case modules are unloaded and their addresses reused
+std::unordered_map<void*, std::string> symbols;
+
+#if defined(__linux__)
+
+void
+on_signal(int, siginfo_t*, void*) {
+    auto saved_errno = errno;
+
+    in_handler.fetch_add(1);
+    auto b = current.load();
+    if(started.load() && b != nullptr) {
+        auto i = b->next.fetch_add(1, std::memory_order_relaxed);
+        if(i < b->size) {
+            auto& s = b->samples[i];
+
+            void* pcs[kMaxDepth + kSkipDepth];
+            auto  n = std::max(backtrace(pcs, kMaxDepth + kSkipDepth) - kSkipDepth, 0);
+            memcpy(s.pcs, pcs + kSkipDepth, n * sizeof(void*));
+            s.depth = (uint16_t)n;
+            s.tid   = (uint32_t)syscall(SYS_gettid);
+            prctl(PR_GET_NAME, s.name);
+            s.ready.store(true, std::memory_order_release);
+        }
+        else {
+            b->dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    in_handler.fetch_sub(1);
+
+    errno = saved_errno;
+}
+
+void
+set_timer(uint32_t frequency) {
+    auto us = frequency > 0 ? 1000000 / frequency : 0;
+    auto tv = timeval { .tv_sec = (time_t)(us / 1000000), .tv_usec = (suseconds_t)(us % 1000000) };
+    auto it = itimerval { .it_interval = tv, .it_value = tv };
+    setitimer(ITIMER_PROF, &it, nullptr);
+}
+
+// waits for the handlers already entered, after that none of them touches the buffer
+void
+quiesce() {
+    started = false;
+    while(in_handler.load() > 0) {
+        std::this_thread::yield();
+    }
+}
+
+std::string
+symbolize(void* pc, bool return_address) {
+    // return addresses point to the instruction after the call, step back into the call
+    auto addr = (char*)pc - (return_address ? 1 : 0);
+    auto buf  = std::array<char, 64>();
+
+    auto info = Dl_info();
+    if(dladdr(addr, &info) == 0) {
+        snprintf(buf.data(), buf.size(), "%p", pc);
+        return buf.data();
+    }
+    if(info.dli_sname != nullptr) {
+        auto status = 0;
+        auto dm     = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+        auto name   = std::string((status == 0 && dm != nullptr) ? dm : info.dli_sname);
+        free(dm);
+
+        // semicolons separate frames in collapsed stacks
+        std::replace(name.begin(), name.end(), ';', ':');
+        return name;
+    }
+
+    auto module = std::string(info.dli_fname != nullptr ? info.dli_fname : "?");
+    module = module.substr(module.find_last_of('/') + 1);
+    snprintf(buf.data(), buf.size(), "+0x%zx", (size_t)(addr - (char*)info.dli_fbase));
+    return module + buf.data();
+}
+
+std::string
+process_name() {
+    auto name = std::string();
+    auto fs   = std::ifstream("/proc/self/comm");
+    std::getline(fs, name);
+    return name;
+}
+
+#endif
+
+}  // namespace detail
+
+void
+start(uint32_t frequency, uint32_t buffer_size) {
+#if defined(__linux__)
+    FC_ASSERT(frequency > 0 && frequency <= 1000, "Frequency of sampling should be within 1 to 1000");
+    FC_ASSERT(buffer_size > 0 && buffer_size <= detail::kMaxSamples, "Size of buffer should be within 1 to ${max}", ("max", detail::kMaxSamples));
+
+    auto lock = std::lock_guard<std::mutex>(detail::mutex);
+    detail::set_timer(0);
+    detail::quiesce();
+
+    // first call of backtrace loads the unwinder which allocates, it's not safe in signal handler
+    void* pcs[1];
+    backtrace(pcs, 1);
+
+    detail::samples = std::make_unique<detail::buffer>(buffer_size);
+    detail::current = detail::samples.get();
+    detail::symbols.clear();
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_sigaction = detail::on_signal;
+    sa.sa_flags     = SA_RESTART | SA_SIGINFO;
+    sigemptyset(&sa.sa_mask);
+    FC_ASSERT(sigaction(SIGPROF, &sa, nullptr) == 0, "Cannot install handler of SIGPROF");
+
+    detail::started = true;
+    detail::set_timer(frequency);
+#else
+    FC_THROW("Sampling profiler is not supported on this platform");
+#endif
+}
+
+void
+stop() {
+#if defined(__linux__)
+    auto lock = std::lock_guard<std::mutex>(detail::mutex);
+    detail::set_timer(0);
+    detail::quiesce();
+#endif
+}
+
+bool
+is_started() {
+    return detail::started.load();
+}
+
+profile
+get_profile(const std::vector<std::string>& groups) {
+    auto p = profile();
+#if defined(__linux__)
+    auto lock = std::lock_guard<std::mutex>(detail::mutex);
+    auto b    = detail::samples.get();
+    if(b == nullptr) {
+        return p;
+    }
+
+    auto pid   = (uint32_t)getpid();
+    auto pname = detail::process_name();
+
+    auto& symbols = detail::symbols;
+    auto  stacks  = std::map<std::string, uint64_t>();
+
+    auto n = std::min<uint64_t>(b->next.load(), b->size);
+    for(auto i = 0u; i < n; i++) {
+        auto& s = b->samples[i];
+        if(!s.ready.load(std::memory_order_acquire)) {
+            continue;
+        }
+
+        auto group = std::string("main");
+        if(s.tid != pid) {
+            group = std::string(s.name, strnlen(s.name, sizeof(s.name)));
+            group = group.substr(0, group.find_first_of("-:"));
+            if(group.empty() || group == pname) {
+                // threads not named inherit the name of process
+                group = "other";
+            }
+        }
+        if(!groups.empty() && std::find(groups.cbegin(), groups.cend(), group) == groups.cend()) {
+            continue;
+        }
+
+        auto stack = group;
+        for(auto j = (int)s.depth - 1; j >= 0; j--) {
+            auto it = symbols.find(s.pcs[j]);
+            if(it == symbols.end()) {
+                it = symbols.emplace(s.pcs[j], detail::symbolize(s.pcs[j], j > 0)).first;
+            }
+            stack += ';';
+            stack += it->second;
+        }
+        stacks[stack]++;
+        p.samples++;
+    }
+    p.dropped = b->dropped.load();
+
+    for(auto& it : stacks) {
+        p.collapsed += it.first;
+        p.collapsed += ' ';
+        p.collapsed += std::to_string(it.second);
+        p.collapsed += '\n';
+    }
+#endif
+    return p;
+}
+
+}}}  // namespace evt::utilities::sampler
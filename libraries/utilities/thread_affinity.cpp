@@ -0,0 +1,191 @@
+/**
+ *  @file
+ *  @copyright defined in evt/LICENSE.txt
+ */
+#include <evt/utilities/thread_affinity.hpp>
+
+#include <map>
+#include <mutex>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+#include <boost/algorithm/string.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/log/logger.hpp>
+#include <fc/log/logger_config.hpp>
+
+namespace evt { namespace utilities { namespace affinity {
+
+namespace internal {
+
+struct registry {
+    std::mutex                              mutex;
+    std::map<std::string, std::vector<int>> pools;
+};
+
+registry&
+get_registry() {
+    static auto r = registry();
+    return r;
+}
+
+}  // namespace internal
+
+std::vector<int>
+parse_cpu_list(const std::string& list) {
+    auto ranges = std::vector<std::string>();
+    boost::split(ranges, list, boost::is_any_of(","));
+
+    auto cpus = std::vector<int>();
+    for(auto& r : ranges) {
+        auto pos = r.find('-');
+        try {
+            auto first = std::stoi(r.substr(0, pos));
+            auto last  = (pos == std::string::npos) ? first : std::stoi(r.substr(pos + 1));
+            FC_ASSERT(first >= 0 && first <= last, "Invalid range of cpus: ${r}", ("r",r));
+            for(auto i = first; i <= last; i++) {
+                cpus.emplace_back(i);
+            }
+        }
+        catch(const std::logic_error&) {
+            FC_THROW_EXCEPTION(fc::parse_error_exception, "Invalid list of cpus: ${l}", ("l",list));
+        }
+    }
+    return cpus;
+}
+
+void
+set_pool_cpus(const std::string& pool, const std::vector<int>& cpus) {
+    auto& r = internal::get_registry();
+    auto lock = std::lock_guard<std::mutex>(r.mutex);
+    r.pools[pool] = cpus;
+}
+
+bool
+pin_current_thread(const std::string& pool) {
+    auto& r    = internal::get_registry();
+    auto  cpus = std::vector<int>();
+    {
+        auto lock = std::lock_guard<std::mutex>(r.mutex);
+        auto it   = r.pools.find(pool);
+        if(it == r.pools.end()) {
+            return false;
+        }
+        cpus = it->second;
+    }
+
+#if defined(__linux__)
+    auto set = cpu_set_t();
+    CPU_ZERO(&set);
+    for(auto cpu : cpus) {
+        if(cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    auto err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if(err != 0) {
+        wlog("Cannot pin thread of ${p} pool to its cpus, error: ${e}", ("p",pool)("e",err));
+        return false;
+    }
+    return true;
+#else
+    wlog("Pinning threads is not supported on this platform, ${p} pool is left unpinned", ("p",pool));
+    return false;
+#endif
+}
+
+namespace internal {
+
+// kernel name of thread is seen by tools like top and the sampling profiler, it's truncated to 15 chars
+void
+set_kernel_thread_name(const std::string& name) {
+#if defined(__linux__)
+    pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+#endif
+}
+
+}  // namespace internal
+
+void
+enter_pool(const std::string& pool, int index) {
+    auto name = pool + "-" + std::to_string(index);
+    fc::set_thread_name(name);
+    internal::set_kernel_thread_name(name);
+    pin_current_thread(pool);
+}
+
+pool_scope::pool_scope(const std::string& pool) {
+#if defined(__linux__)
+    // threads created in the scope inherit the kernel name as well
+    char name[16] = {};
+    if(pthread_getname_np(pthread_self(), name, sizeof(name)) == 0) {
+        saved_name_ = name;
+        internal::set_kernel_thread_name(pool);
+    }
+
+    auto set = cpu_set_t();
+    CPU_ZERO(&set);
+    if(pthread_getaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+        return;
+    }
+    auto saved = std::vector<int>();
+    for(auto i = 0; i < CPU_SETSIZE; i++) {
+        if(CPU_ISSET(i, &set)) {
+            saved.emplace_back(i);
+        }
+    }
+    if(pin_current_thread(pool)) {
+        saved_ = std::move(saved);
+    }
+#endif
+}
+
+pool_scope::~pool_scope() {
+#if defined(__linux__)
+    if(!saved_name_.empty()) {
+        internal::set_kernel_thread_name(saved_name_);
+    }
+    if(saved_.empty()) {
+        return;
+    }
+    auto set = cpu_set_t();
+    CPU_ZERO(&set);
+    for(auto cpu : saved_) {
+        CPU_SET(cpu, &set);
+    }
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+}
+
+int
+prefer_local_numa_node() {
+#if defined(__linux__) && defined(SYS_getcpu) && defined(SYS_set_mempolicy)
+    const int kMpolPreferred = 1;  // MPOL_PREFERRED of <numaif.h>, libnuma isn't required just for it
+
+    auto cpu  = 0u;
+    auto node = 0u;
+    if(syscall(SYS_getcpu, &cpu, &node, nullptr) != 0) {
+        return -1;
+    }
+
+    auto mask = 0ul;
+    if(node >= sizeof(mask) * 8) {
+        return -1;
+    }
+    mask = 1ul << node;
+    // kernel reads `maxnode - 1` bits of mask
+    if(syscall(SYS_set_mempolicy, kMpolPreferred, &mask, sizeof(mask) * 8 + 1) != 0) {
+        return -1;
+    }
+    return (int)node;
+#else
+    return -1;
+#endif
+}
+
+}}}  // namespace evt::utilities::affinity
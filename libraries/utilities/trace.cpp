@@ -0,0 +1,168 @@
+/**
+ *  @file
+ *  @copyright defined in evt/LICENSE.txt
+ */
+#include <evt/utilities/trace.hpp>
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <fc/log/logger_config.hpp>
+#include <fc/variant_object.hpp>
+#include <evt/utilities/spinlock.hpp>
+
+namespace evt { namespace utilities { namespace trace {
+
+namespace detail {
+
+std::atomic<bool> started = false;
+
+struct event {
+    const char* name;
+    uint64_t    arg;
+    int64_t     start;  // ns
+    int64_t     dur;
+};
+
+// ring of the latest spans of one thread, written by its thread and read when dumping
+struct thread_buffer {
+    thread_buffer(uint32_t generation, uint32_t tid, size_t size)
+        : generation(generation), tid(tid), events(size), name(fc::get_thread_name()) {}
+
+    uint32_t           generation;
+    uint32_t           tid;
+    spinlock           lock;
+    std::vector<event> events;
+    size_t             next = 0;
+    bool               full = false;
+    std::string        name;
+};
+
+struct registry {
+    std::mutex                                  mutex;
+    std::vector<std::shared_ptr<thread_buffer>> buffers;
+    std::atomic<uint32_t>                       generation  = 0;  // increased by each start, buffers of old ones are dropped
+    std::atomic<uint32_t>                       sample_rate = 1;
+    uint32_t                                    buffer_size = 0;
+    uint32_t                                    next_tid    = 1;
+};
+
+registry&
+get_registry() {
+    static auto r = new registry();  // never destroyed, threads may still end spans on exit
+    return *r;
+}
+
+struct thread_state {
+    int                            depth   = 0;
+    bool                           sampled = false;
+    uint32_t                       roots   = 0;
+    std::shared_ptr<thread_buffer> buffer;
+};
+
+thread_local thread_state tstate;
+
+int64_t
+now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+thread_buffer&
+get_buffer() {
+    auto& r = get_registry();
+    if(!tstate.buffer || tstate.buffer->generation != r.generation.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        tstate.buffer = std::make_shared<thread_buffer>(r.generation.load(), r.next_tid++, std::max(r.buffer_size, 1u));
+        r.buffers.emplace_back(tstate.buffer);
+    }
+    return *tstate.buffer;
+}
+
+int64_t
+begin_span() {
+    if(tstate.depth++ == 0) {
+        tstate.sampled = (tstate.roots++ % get_registry().sample_rate.load(std::memory_order_relaxed)) == 0;
+    }
+    return tstate.sampled ? now() : -1;
+}
+
+void
+end_span(const char* name, uint64_t arg, int64_t start) {
+    tstate.depth--;
+    if(start < 0 || !started.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    auto& b = get_buffer();
+    b.lock.lock();
+    b.events[b.next] = event{ name, arg, start, now() - start };
+    if(++b.next == b.events.size()) {
+        b.next = 0;
+        b.full = true;
+    }
+    b.lock.unlock();
+}
+
+}  // namespace detail
+
+void
+start(uint32_t sample_rate, uint32_t buffer_size) {
+    auto& r = detail::get_registry();
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.sample_rate = std::max(sample_rate, 1u);
+        r.buffer_size = std::max(buffer_size, 1u);
+        r.buffers.clear();
+        r.generation++;
+    }
+    detail::started = true;
+}
+
+void
+stop() {
+    detail::started = false;
+}
+
+bool
+is_started() {
+    return detail::started.load();
+}
+
+fc::variant
+get_chrome_trace() {
+    auto& r = detail::get_registry();
+
+    auto buffers = std::vector<std::shared_ptr<detail::thread_buffer>>();
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        buffers = r.buffers;
+    }
+
+    auto events = fc::variants();
+    for(auto& b : buffers) {
+        events.emplace_back(fc::mutable_variant_object("name", "thread_name")("ph", "M")("pid", 0)("tid", b->tid)
+            ("args", fc::mutable_variant_object("name", b->name)));
+
+        b->lock.lock();
+        auto copy = std::vector<detail::event>();
+        if(b->full) {
+            copy.insert(copy.end(), b->events.begin() + b->next, b->events.end());
+        }
+        copy.insert(copy.end(), b->events.begin(), b->events.begin() + b->next);
+        b->lock.unlock();
+
+        for(auto& e : copy) {
+            auto ev = fc::mutable_variant_object("name", e.name)("cat", "evt")("ph", "X")("pid", 0)("tid", b->tid)
+                ("ts", e.start / 1000.0)("dur", e.dur / 1000.0);
+            if(e.arg != 0) {
+                ev("args", fc::mutable_variant_object("arg", e.arg));
+            }
+            events.emplace_back(std::move(ev));
+        }
+    }
+    return fc::mutable_variant_object("traceEvents", std::move(events))("displayTimeUnit", "ns");
+}
+
+}}}  // namespace evt::utilities::trace
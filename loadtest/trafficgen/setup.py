@@ -20,6 +20,7 @@ setup(
     entry_points={
         'console_scripts': [
             'trafficgen = trafficgen.generator:main',
+            'trafficgen-latency = trafficgen.latency:run',
         ]
     },
 )
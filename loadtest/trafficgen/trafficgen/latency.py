@@ -0,0 +1,173 @@
+import datetime
+import json
+import os
+import struct
+import threading
+import time
+import urllib.request
+
+import click
+
+from . import utils
+
+# Pushes generated traffic and measures the time from submitting each transaction until
+# it's included in a block and until the block becomes irreversible. The node reports when
+# transactions are included by `get_trx_inclusion` api, enabled by `--trx-inclusion-tracking-size`,
+# it's in local time of the node so clocks of both sides should be synchronized.
+
+BUCKETS = [0.1, 0.2, 0.5, 1, 2, 3, 5, 10, 20, 30, 60, 120, 300]  # upper bounds in seconds
+
+
+def post(url, path, data):
+    req = urllib.request.Request(url + path, data=data, headers={'Content-Type': 'application/json'})
+    with urllib.request.urlopen(req, timeout=10) as resp:
+        return json.loads(resp.read())
+
+
+def parse_time(s):
+    # time points of fc are in utc without timezone
+    return datetime.datetime.strptime(s, '%Y-%m-%dT%H:%M:%S.%f').replace(tzinfo=datetime.timezone.utc).timestamp()
+
+
+class Histogram:
+    def __init__(self):
+        self.samples = []
+
+    def add(self, v):
+        self.samples.append(v)
+
+    def percentile(self, p):
+        s = sorted(self.samples)
+        return s[min(len(s) - 1, int(len(s) * p / 100))]
+
+    def dump(self, title):
+        click.echo('{}: {} trxs'.format(title, len(self.samples)))
+        if not self.samples:
+            return
+
+        click.echo('  min {:.3f}s  p50 {:.3f}s  p90 {:.3f}s  p99 {:.3f}s  max {:.3f}s'.format(
+            min(self.samples), self.percentile(50), self.percentile(90), self.percentile(99), max(self.samples)))
+
+        counts = [0] * (len(BUCKETS) + 1)
+        for v in self.samples:
+            i = 0
+            while i < len(BUCKETS) and v > BUCKETS[i]:
+                i += 1
+            counts[i] += 1
+
+        peak = max(counts)
+        for i, c in enumerate(counts):
+            if c == 0:
+                continue
+            label = '<= {}s'.format(BUCKETS[i]) if i < len(BUCKETS) else '>  {}s'.format(BUCKETS[-1])
+            click.echo('  {:>8} {:>8} {}'.format(label, c, '#' * max(1, round(c / peak * 50))))
+
+
+class Tracker:
+    """correlates submitted transactions with their inclusion reported by node"""
+
+    def __init__(self, url):
+        self.url = url
+        self.lock = threading.Lock()
+        self.pending = {}  # id -> submit time, waits for inclusion or irreversible
+        self.included = set()
+        self.to_block = Histogram()
+        self.to_lib = Histogram()
+        self.failed = 0
+
+    def submitted(self, trx_id, t):
+        with self.lock:
+            self.pending[trx_id] = t
+
+    def poll(self):
+        with self.lock:
+            ids = list(self.pending.keys())
+
+        for i in range(0, len(ids), 1000):
+            results = post(self.url, '/v1/chain/get_trx_inclusion', json.dumps({'ids': ids[i:i + 1000]}).encode())
+            with self.lock:
+                for r in results:
+                    submit = self.pending.get(r['id'])
+                    if submit is None:
+                        continue
+                    if r['id'] not in self.included:
+                        self.included.add(r['id'])
+                        self.to_block.add(parse_time(r['included_at']) - submit)
+                    if r.get('irreversible_at') is not None:
+                        self.to_lib.add(parse_time(r['irreversible_at']) - submit)
+                        self.included.discard(r['id'])
+                        del self.pending[r['id']]
+
+    def remaining(self):
+        with self.lock:
+            return len(self.pending)
+
+
+def pusher(url, filename, rate, tracker):
+    reader = utils.Reader(filename)
+    start = time.time()
+    n = 0
+    while True:
+        try:
+            trx = reader.read_trx()
+        except struct.error:
+            break
+
+        if rate > 0:
+            # open loop: each thread keeps its own pace regardless of responses
+            delay = start + n / rate - time.time()
+            if delay > 0:
+                time.sleep(delay)
+
+        t = time.time()
+        try:
+            resp = post(url, '/v1/chain/push_transaction', trx.encode())
+            tracker.submitted(resp['transaction_id'], t)
+        except Exception:
+            with tracker.lock:
+                tracker.failed += 1
+        n += 1
+    reader.close()
+
+
+@click.command()
+@click.option('--url', '-u', default='http://127.0.0.1:8888')
+@click.option('--folder', '-f', type=click.Path(exists=True), default='./', help='Folder of traffic data generated by trafficgen')
+@click.option('--rate', '-r', default=0.0, help='Transactions pushed per second by each region, 0 for as fast as possible')
+@click.option('--poll-interval', '-p', default=0.5, help='Seconds between two queries of inclusion')
+@click.option('--timeout', '-t', default=300, help='Seconds to wait for irreversible after all are pushed')
+@click.argument('regions', nargs=-1, required=True)
+def run(url, folder, rate, poll_interval, timeout, regions):
+    """Pushes traffic of REGIONS and reports submit-to-block and submit-to-LIB latency"""
+    tracker = Tracker(url)
+
+    threads = []
+    for region in regions:
+        t = threading.Thread(target=pusher, args=(url, os.path.join(folder, region + '_traffic_data.lz4'), rate, tracker))
+        t.start()
+        threads.append(t)
+
+    def pushing():
+        return any(t.is_alive() for t in threads)
+
+    deadline = None
+    while pushing() or tracker.remaining() > 0:
+        time.sleep(poll_interval)
+        tracker.poll()
+
+        if deadline is None and not pushing():
+            deadline = time.time() + timeout
+        if deadline is not None and time.time() > deadline:
+            click.echo('Timeout, {} trxs are not irreversible yet'.format(tracker.remaining()))
+            break
+
+    for t in threads:
+        t.join()
+
+    click.echo('Failed to push: {}'.format(tracker.failed))
+    tracker.to_block.dump('Submit to block')
+    tracker.to_lib.dump('Submit to LIB')
+
+
+if __name__ == '__main__':
+    run()
@@ -64,6 +64,7 @@
 #include <boost/beast/websocket.hpp>
 
 #include <evt/chain/plugin_interface.hpp>
+#include <evt/utilities/thread_affinity.hpp>
 
 using tcp    = boost::asio::ip::tcp;
 namespace ws = boost::beast::websocket;
@@ -121,7 +122,7 @@ struct hello {
     public_key_type       peer_id;
     string                network_version;
     string                agent;
-    string                protocol_version = "1.0.1";
+    string                protocol_version = "1.0.2";
     string                user;
     string                password;
     chain_id_type         chain_id;
@@ -157,6 +158,16 @@ struct block_notice {
 
 FC_REFLECT(block_notice, (block_ids));
 
+/**
+ *  Pending transactions sent in one websocket frame instead of one frame each,
+ *  only sent to peers with protocol version 1.0.2 or later
+ */
+struct trx_batch {
+    vector<packed_transaction_ptr> trxs;
+};
+
+FC_REFLECT(trx_batch, (trxs));
+
 struct ping {
     fc::time_point sent;
     fc::sha256     code;
@@ -175,7 +186,8 @@ using bnet_message = fc::static_variant<hello,
                                         block_notice,
                                         signed_block_ptr,
                                         packed_transaction_ptr,
-                                        ping, pong>;
+                                        ping, pong,
+                                        trx_batch>;
 
 struct by_id;
 struct by_num;
@@ -257,6 +269,7 @@ public:
     block_status_index       _block_status;
     transaction_status_index _transaction_status;
     const uint32_t           _max_block_status_range = 2048; // limit tracked block_status known_by_peer
+    const uint32_t           _max_trx_batch_size     = 64;   // limit transactions sent in one trx_batch
 
     public_key_type _local_peer_id;
     uint32_t        _local_lib = 0;
@@ -269,6 +282,7 @@ public:
     block_id_type   _remote_lib_id;
     bool            _remote_request_trx = false;
     bool            _remote_request_irreversible_only = false;
+    bool            _remote_trx_batch = false;
 
     uint32_t      _last_sent_block_num = 0;
     block_id_type _last_sent_block_id;  /// the id of the last block sent
@@ -814,14 +828,28 @@ public:
             if(start == idx.end() || start->known_by_peer())
                 return false;
 
-            auto ptrx_ptr = start->trx->packed_trx;
+            if(!_remote_trx_batch) {
+                auto ptrx_ptr = start->trx->packed_trx;
 
-            idx.modify(start, [&](auto& stat) {
-                stat.mark_known_by_peer();
-            });
+                idx.modify(start, [&](auto& stat) {
+                    stat.mark_known_by_peer();
+                });
+
+                // wlog("sending trx ${id}", ("id",start->id) );
+                send(ptrx_ptr);
+                return true;
+            }
 
-            // wlog("sending trx ${id}", ("id",start->id) );
-            send(ptrx_ptr);
+            // marked ones are moved to the end of index, so the next unknown one is always at beginning
+            trx_batch batch;
+            while(start != idx.end() && !start->known_by_peer() && batch.trxs.size() < _max_trx_batch_size) {
+                batch.trxs.emplace_back(start->trx->packed_trx);
+                idx.modify(start, [&](auto& stat) {
+                    stat.mark_known_by_peer();
+                });
+                start = idx.begin();
+            }
+            send(batch);
 
             return true;
         }
@@ -1005,6 +1033,9 @@ public:
             case bnet_message::tag<pong>::value:
                 on(msg.get<pong>());
                 break;
+            case bnet_message::tag<trx_batch>::value:
+                on(msg.get<trx_batch>());
+                break;
             default:
                 wlog("bad message received");
                 _ws->close(boost::beast::websocket::close_code::bad_payload);
@@ -1110,6 +1141,14 @@ public:
 
     void on(const packed_transaction_ptr& p);
 
+    void
+    on(const trx_batch& batch) {
+        peer_ilog(this, "received trx_batch of ${n} transactions", ("n", batch.trxs.size()));
+        for(const auto& p : batch.trxs) {
+            on(p);
+        }
+    }
+
     void
     on_write(boost::system::error_code ec, std::size_t bytes_transferred) {
         boost::ignore_unused(bytes_transferred);
@@ -1486,7 +1525,10 @@ bnet_plugin::plugin_startup() {
 
     my->_socket_threads.reserve(my->_num_threads);
     for(auto i = 0; i < my->_num_threads; ++i) {
-        my->_socket_threads.emplace_back([&ioc] { wlog( "start thread" ); ioc.run(); wlog( "end thread" ); });
+        my->_socket_threads.emplace_back([&ioc, i] {
+            evt::utilities::affinity::enter_pool("bnet", i);
+            wlog( "start thread" ); ioc.run(); wlog( "end thread" );
+        });
     }
 
     for(const auto& peer : my->_connect_to_peers) {
@@ -1624,6 +1666,7 @@ session::on(const hello& hi, fc::datastream<const char*>& ds) {
 
     _last_sent_block_num   = hi.last_irr_block_num;
     _remote_request_trx    = hi.request_transactions;
+    _remote_trx_batch      = hi.protocol_version >= "1.0.2";
     _remote_peer_id        = hi.peer_id;
     _remote_lib            = hi.last_irr_block_num;
 
@@ -6,6 +6,7 @@
 #include <evt/chain_api_plugin/chain_api_plugin.hpp>
 
 #include <fc/io/json.hpp>
+#include <fc/variant_arena.hpp>
 
 namespace evt {
 
@@ -51,24 +52,28 @@ get_json<std::string>(const std::string& value) {
 
 }  // namespace internal
 
-#define CALL(api_name, api_handle, api_namespace, call_name, http_response_code)                                             \
-    {                                                                                                                        \
-        std::string("/v1/" #api_name "/" #call_name),                                                                        \
-            [api_handle](string, string body, url_response_callback cb) mutable {                                            \
-                using namespace internal;                                                                                  \
-                try {                                                                                                        \
-                    if(body.empty()) {                                                                                       \
-                        body = "{}";                                                                                         \
-                    }                                                                                                        \
-                    auto result = api_handle.call_name(fc::json::from_string(body).as<api_namespace::call_name##_params>()); \
-                    cb(http_response_code, get_json(result));                                                                \
-                }                                                                                                            \
-                catch(...) {                                                                                                 \
-                    http_plugin::handle_exception(#api_name, #call_name, body, cb);                                          \
-                }                                                                                                            \
-            }                                                                                                                \
+#define CALL_METHOD(api_name, api_handle, api_namespace, call_name, call_method, http_response_code)                           \
+    {                                                                                                                          \
+        std::string("/v1/" #api_name "/" #call_name),                                                                          \
+            [api_handle](string, string body, url_response_callback cb) mutable {                                              \
+                using namespace internal;                                                                                      \
+                try {                                                                                                          \
+                    auto arena = fc::variant_arena_scope();                                                                    \
+                    if(body.empty()) {                                                                                         \
+                        body = "{}";                                                                                           \
+                    }                                                                                                          \
+                    auto result = api_handle.call_method(fc::json::from_string(body).as<api_namespace::call_name##_params>()); \
+                    cb(http_response_code, get_json(result));                                                                  \
+                }                                                                                                              \
+                catch(...) {                                                                                                   \
+                    http_plugin::handle_exception(#api_name, #call_name, body, cb);                                            \
+                }                                                                                                              \
+            }                                                                                                                  \
     }
 
+#define CALL(api_name, api_handle, api_namespace, call_name, http_response_code) \
+    CALL_METHOD(api_name, api_handle, api_namespace, call_name, call_name, http_response_code)
+
 #define CALL_ASYNC(api_name, api_handle, api_namespace, call_name, call_result, http_response_code)                 \
     {                                                                                                               \
         std::string("/v1/" #api_name "/" #call_name),                                                               \
@@ -92,10 +97,40 @@ get_json<std::string>(const std::string& value) {
             }                                                                                                       \
     }
 
+// the api parses the body itself, which is json or raw bytes of the params
+// empty body is replaced by `default_body`, which is empty for raw bytes so the api reports the missing body
+#define CALL_ASYNC_BODY(api_name, api_handle, api_namespace, call_name, call_method, default_body, call_result, http_response_code) \
+    {                                                                                                               \
+        std::string("/v1/" #api_name "/" #call_name),                                                               \
+            [api_handle](string, string body, url_response_callback cb) mutable {                                   \
+                if(body.empty())                                                                                    \
+                    body = default_body;                                                                            \
+                api_handle.call_method(body,                                                                        \
+                                     [cb, body](const fc::static_variant<fc::exception_ptr, call_result>& result) { \
+                                         if(result.contains<fc::exception_ptr>()) {                                 \
+                                             try {                                                                  \
+                                                 result.get<fc::exception_ptr>()->dynamic_rethrow_exception();      \
+                                             }                                                                      \
+                                             catch(...) {                                                           \
+                                                 http_plugin::handle_exception(#api_name, #call_name, body, cb);    \
+                                             }                                                                      \
+                                         }                                                                          \
+                                         else {                                                                     \
+                                             cb(http_response_code, result.visit(async_result_visitor()));          \
+                                         }                                                                          \
+                                     });                                                                            \
+            }                                                                                                       \
+    }
+
 #define CHAIN_RO_CALL(call_name, http_response_code) CALL(chain, ro_api, chain_apis::read_only, call_name, http_response_code)
+#define CHAIN_RO_CALL_JSON(call_name, http_response_code) CALL_METHOD(chain, ro_api, chain_apis::read_only, call_name, call_name##_json, http_response_code)
 #define CHAIN_RW_CALL(call_name, http_response_code) CALL(chain, rw_api, chain_apis::read_write, call_name, http_response_code)
 #define CHAIN_RO_CALL_ASYNC(call_name, call_result, http_response_code) CALL_ASYNC(chain, ro_api, chain_apis::read_only, call_name, call_result, http_response_code)
+#define CHAIN_RO_CALL_ASYNC_BODY(call_name, call_result, http_response_code) CALL_ASYNC_BODY(chain, ro_api, chain_apis::read_only, call_name, call_name, "{}", call_result, http_response_code)
+#define CHAIN_RO_CALL_ASYNC_RAW(call_name, call_result, http_response_code) CALL_ASYNC_BODY(chain, ro_api, chain_apis::read_only, call_name, call_name, "", call_result, http_response_code)
 #define CHAIN_RW_CALL_ASYNC(call_name, call_result, http_response_code) CALL_ASYNC(chain, rw_api, chain_apis::read_write, call_name, call_result, http_response_code)
+#define CHAIN_RW_CALL_ASYNC_JSON(call_name, call_result, http_response_code) CALL_ASYNC_BODY(chain, rw_api, chain_apis::read_write, call_name, call_name##_json, "{}", call_result, http_response_code)
+#define CHAIN_RW_CALL_ASYNC_RAW(call_name, call_result, http_response_code) CALL_ASYNC_BODY(chain, rw_api, chain_apis::read_write, call_name, call_name, "", call_result, http_response_code)
 
 void
 chain_api_plugin::plugin_startup() {
@@ -108,10 +143,10 @@ chain_api_plugin::plugin_startup() {
     ro_api.set_shorten_abi_errors(!_http_plugin.verbose_errors());
 
     _http_plugin.add_api({CHAIN_RO_CALL(get_info, 200),
-                          CHAIN_RO_CALL(get_block, 200),
-                          CHAIN_RO_CALL(get_block_header_state, 200),
+                          CHAIN_RO_CALL_JSON(get_block, 200),
+                          CHAIN_RO_CALL_JSON(get_block_header_state, 200),
                           CHAIN_RO_CALL(get_head_block_header_state, 200),
-                          CHAIN_RO_CALL(get_transaction, 200),
+                          CHAIN_RO_CALL_JSON(get_transaction, 200),
                           CHAIN_RO_CALL(get_trx_id_for_link_id, 200),
                           CHAIN_RO_CALL(abi_json_to_bin, 200),
                           CHAIN_RO_CALL(abi_bin_to_json, 200),
@@ -119,13 +154,21 @@ chain_api_plugin::plugin_startup() {
                           CHAIN_RO_CALL(get_required_keys, 200),
                           CHAIN_RO_CALL(get_suspend_required_keys, 200),
                           CHAIN_RO_CALL(get_charge, 200),
-                          CHAIN_RO_CALL(get_transaction_ids_for_block, 200),
+                          CHAIN_RO_CALL_ASYNC_BODY(get_charges, chain_apis::read_only::get_charges_results, 200),
+                          CHAIN_RO_CALL_ASYNC_RAW(get_packed_charges, chain_apis::read_only::get_charges_results, 200),
+                          CHAIN_RO_CALL_JSON(get_transaction_ids_for_block, 200),
                           CHAIN_RO_CALL(get_abi, 200),
                           CHAIN_RO_CALL(get_actions, 200),
+                          CHAIN_RO_CALL(get_trx_inclusion, 200),
                           CHAIN_RW_CALL_ASYNC(push_block, chain_apis::read_write::push_block_results, 202),
-                          CHAIN_RW_CALL_ASYNC(push_transaction, chain_apis::read_write::push_transaction_results, 202),
-                          CHAIN_RW_CALL_ASYNC(push_transactions, chain_apis::read_write::push_transactions_results, 202)});
-    _http_plugin.add_api({CHAIN_RO_CALL(get_db_info, 200)}, true /* local only API */);
+                          CHAIN_RW_CALL_ASYNC_JSON(push_transaction, chain_apis::read_write::push_transaction_results, 202),
+                          CHAIN_RW_CALL_ASYNC_JSON(push_transactions, chain_apis::read_write::push_transactions_results, 202),
+                          CHAIN_RW_CALL_ASYNC_RAW(push_packed_transaction, chain_apis::read_write::push_transaction_results, 202),
+                          CHAIN_RW_CALL_ASYNC_RAW(push_packed_transactions, chain_apis::read_write::push_transactions_results, 202)});
+    _http_plugin.add_api({CHAIN_RO_CALL(get_db_info, 200),
+                          CHAIN_RO_CALL(get_memory_usage, 200),
+                          CHAIN_RO_CALL(get_action_profiles, 200),
+                          CHAIN_RW_CALL(reset_action_profiles, 200)}, true /* local only API */);
 }
 
 void
@@ -6,6 +6,7 @@
 
 #include <appbase/channel.hpp>
 #include <appbase/method.hpp>
+#include <fc/filesystem.hpp>
 
 #include <evt/chain/block.hpp>
 #include <evt/chain/block_state.hpp>
@@ -38,6 +39,9 @@ using get_head_block_id   = method_decl<chain_plugin_interface, block_id_type()>
 using get_lib_block_id    = method_decl<chain_plugin_interface, block_id_type()>;
 
 using get_last_irreversible_block_number = method_decl<chain_plugin_interface, uint32_t()>;
+
+// fetches the snapshot of trusted block published by a majority of the peers into the dir and returns its path, provided by net plugin
+using fetch_snapshot = method_decl<chain_plugin_interface, fc::path(const std::vector<std::string>& peers, const fc::path& dir, const block_id_type& trusted_id), first_provider_policy>;
 }  // namespace methods
 
 namespace incoming {
@@ -50,6 +54,8 @@ namespace methods {
 // synchronously push a block/trx to a single provider
 using block_sync        = method_decl<chain_plugin_interface, void(const signed_block_ptr&), first_provider_policy>;
 using transaction_async = method_decl<chain_plugin_interface, void(const transaction_metadata_ptr&, bool, next_function<transaction_trace_ptr>), first_provider_policy>;
+// batch of trxs applied in order, each has its own next function
+using transactions_async = method_decl<chain_plugin_interface, void(const std::vector<transaction_metadata_ptr>&, bool, const std::vector<next_function<transaction_trace_ptr>>&), first_provider_policy>;
 }  // namespace methods
 }  // namespace incoming
 
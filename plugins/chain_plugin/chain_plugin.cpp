@@ -3,20 +3,30 @@
  *  @copyright defined in evt/LICENSE.txt
  */
 #include <evt/chain_plugin/chain_plugin.hpp>
+#include <evt/chain_plugin/raw_body.hpp>
+#include <evt/chain_plugin/response_cache.hpp>
 
 #include <signal.h>
 #include <stdlib.h>
+#include <deque>
+#include <unordered_map>
 
+#include <boost/algorithm/string.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/signals2/connection.hpp>
 
 #include <fc/io/json.hpp>
 #include <fc/variant.hpp>
 
 #include <evt/chain/block_log.hpp>
+#include <evt/chain/charge_manager.hpp>
 #include <evt/chain/config.hpp>
 #include <evt/chain/exceptions.hpp>
 #include <evt/chain/fork_database.hpp>
 #include <evt/chain/reversible_block_object.hpp>
+#include <evt/chain/reversible_block_log.hpp>
 #include <evt/chain/types.hpp>
 #include <evt/chain/genesis_state.hpp>
 #include <evt/chain/snapshot.hpp>
@@ -25,6 +35,7 @@
 #include <evt/chain/contracts/evt_link_object.hpp>
 
 #include <evt/utilities/key_conversion.hpp>
+#include <evt/utilities/thread_affinity.hpp>
 
 namespace evt {
 
@@ -124,6 +135,9 @@ operator<<(std::ostream& osm, evt::chain::storage_profile m) {
     else if(m == evt::chain::storage_profile::memory) {
         osm << "memory";
     }
+    else if(m == evt::chain::storage_profile::hash) {
+        osm << "hash";
+    }
 
     return osm;
 }
@@ -148,6 +162,9 @@ validate(boost::any&                     v,
     else if(s == "memory") {
         v = boost::any(evt::chain::storage_profile::memory);
     }
+    else if(s == "hash") {
+        v = boost::any(evt::chain::storage_profile::hash);
+    }
     else {
         throw validation_error(validation_error::invalid_option_value);
     }
@@ -207,6 +224,35 @@ public:
     std::optional<chain_id_type>      chain_id;
     std::optional<bfs::path>          snapshot_path;
 
+    std::shared_ptr<chain_apis::response_cache> response_cache;
+
+    // serves the read only apis which don't touch chain state after their params are taken in main thread
+    std::shared_ptr<boost::asio::thread_pool> read_pool;
+
+    // memory usage reported by other plugins, called in main thread
+    std::map<std::string, chain_plugin::memory_usage_func> memory_reporters;
+
+    // local time when recent transactions are included into blocks and become irreversible,
+    // load generators query it to measure latency, updated and queried in main thread
+    struct trx_inclusion {
+        uint32_t       block_num;
+        fc::time_point included_at;
+        fc::time_point irreversible_at;
+    };
+    size_t                                                trx_inclusions_capacity = 0;
+    std::unordered_map<transaction_id_type, trx_inclusion> trx_inclusions;
+    std::deque<transaction_id_type>                        trx_inclusions_order;
+
+    void on_trx_included(const block_state_ptr& bs);
+    void on_trx_irreversible(const block_state_ptr& bs);
+
+    // secondary token database follows the primary one by catching up periodically in main thread,
+    // so reads of apis never see it in the middle of catching up
+    uint32_t                                   catch_up_interval = 0;
+    std::optional<boost::asio::steady_timer>   catch_up_timer;
+
+    void schedule_catch_up();
+
     // retained references to channels for easy publication
     channels::pre_accepted_block::channel_type&    pre_accepted_block_channel;
     channels::accepted_block_header::channel_type& accepted_block_header_channel;
@@ -248,20 +294,66 @@ void
 chain_plugin::set_program_options(options_description& cli, options_description& cfg) {
     cfg.add_options()
         ("blocks-dir", bpo::value<bfs::path>()->default_value("blocks"), "the location of the blocks directory (absolute path or relative to application data dir)")
+        ("blocks-log-stride", bpo::value<uint32_t>()->default_value(0), "split the block log into files of this number of blocks each, the older files are kept in blocks-retained-dir, 0 to never split")
+        ("max-retained-block-files", bpo::value<uint32_t>()->default_value(0), "the maximum number of split block log files kept in blocks-retained-dir, the oldest ones are moved into blocks-archive-dir or deleted beyond it, 0 for no limit")
+        ("blocks-retained-dir", bpo::value<bfs::path>()->default_value("retained"), "the location of the split block log files (absolute path or relative to blocks dir)")
+        ("blocks-archive-dir", bpo::value<bfs::path>()->default_value(""), "the location where the split block log files beyond max-retained-block-files are moved into (absolute path or relative to blocks dir), they're deleted if it's empty")
+        ("blocks-compress-retained", bpo::bool_switch()->default_value(false), "compress the split block log files in blocks-retained-dir with zstd in background, blocks are still read at random from them")
+        ("blocks-log-async", bpo::bool_switch()->default_value(false), "append irreversible blocks into block log in background thread, the pending ones are served from memory")
+        ("blocks-log-max-pending", bpo::value<uint32_t>()->default_value(1024), "the maximum number of blocks waiting to be written when blocks-log-async is enabled")
+        ("blocks-log-sync-interval", bpo::value<uint32_t>()->default_value(0), "fsync block log once this number of blocks are written since last time, 0 to never fsync")
+        ("blocks-recovery-threads", bpo::value<uint32_t>()->default_value(1), "the number of threads verifying blocks when block log is repaired or its index is rebuilt, 1 to do it sequentially")
         ("token-db-dir", bpo::value<bfs::path>()->default_value("tokendb"), "the location of the token database directory (absolute path or relative to application data dir)")
         ("token-db-cache-size-mb", bpo::value<uint32_t>()->default_value(512), "the cache size of token database in MBytes")
         ("token-db-profile", boost::program_options::value<evt::chain::storage_profile>()->default_value(evt::chain::storage_profile::disk),
-            "Token database profile (\"disk\", or \"memory\").\n"
+            "Token database profile (\"disk\", \"memory\" or \"hash\").\n"
             "In \"disk\" profile database is optimized for the standard storage devices.\n"
             "In \"memory\" mode database is optimized for the usage in ultra-low latency devices like memory\n"
+            "In \"hash\" mode all the tokens and assets are also kept in hash tables in memory serving point reads, it requires enough RAM to hold them\n"
         )
+        ("token-db-write-batch", bpo::value<bool>()->default_value(true), "keep owner index writes of the latest savepoint of token database in one write batch, written when savepoints change and discarded on rollback")
+        ("token-db-owner-index", bpo::bool_switch()->default_value(false), "maintain the index from owner address to the non-fungible tokens and fungible balances in token database")
+        ("token-db-cache-write-back", bpo::bool_switch()->default_value(false), "defer packing and writing objects put into token database cache until the transaction or block is accepted")
+        ("token-db-options-file", bpo::value<bfs::path>(), "rocksdb OPTIONS file of token database (absolute path or relative to application data dir), its db options and the options of column families "
+                                                         "with the same names (default, Assets and the ones of token-db-column) override the built-in ones")
+        ("token-db-background-jobs", bpo::value<uint32_t>()->default_value(0), "max number of flushes and compactions of token database running at the same time, 0 to keep the default")
+        ("token-db-rate-limit-mb", bpo::value<uint32_t>()->default_value(0), "MBytes per second written by flushes and compactions of token database, 0 for no limit")
+        ("token-db-direct-io", bpo::bool_switch()->default_value(false), "read, flush and compact token database with direct I/O bypassing page cache, not available in memory profile")
+        ("token-db-pipelined-write", bpo::bool_switch()->default_value(false), "write wal and memtables of token database in pipeline")
+        ("token-db-compressed-cache-mb", bpo::value<uint32_t>()->default_value(0), "MBytes of compressed blocks of token database cached in memory below the block cache, 0 to disable, only in disk and hash profiles")
+        ("token-db-persistent-cache-dir", bpo::value<bfs::path>()->default_value("token-db-cache"), "directory on local fast disk of the persistent cache of token database (absolute path or relative to application data dir)")
+        ("token-db-persistent-cache-mb", bpo::value<uint32_t>()->default_value(0), "MBytes of blocks of token database cached on local disk below the block cache, 0 to disable, only in disk and hash profiles")
+        ("token-db-wal-ttl", bpo::value<uint32_t>()->default_value(0), "seconds obsolete wal files of token database are archived, delta snapshots can only be based on snapshots whose changes are still in wal")
+        ("token-db-runtime-savepoints", bpo::value<uint32_t>()->default_value(0), "max number of reversible savepoints of token database holding rocksdb snapshots, older ones are spilled into journal form with previous values in memory, 0 for no limit")
+        ("token-db-secondary-dir", bpo::value<bfs::path>(), "open the token database in token-db-dir, written by another node on this machine, as read-only secondary instance keeping its own files in this directory, requires read-mode = read-only")
+        ("token-db-catch-up-interval-ms", bpo::value<uint32_t>()->default_value(500), "milliseconds between two catching up of secondary token database with the primary one")
+        ("token-db-prefetch-threads", bpo::value<uint32_t>()->default_value(2), "number of threads prefetching tokens from token database before transactions are applied, 0 to disable")
+        ("signature-threads", bpo::value<uint32_t>()->default_value(4), "number of threads recovering keys of incoming transactions and transactions in blocks being applied, 0 to disable")
+        ("read-only-threads", bpo::value<uint32_t>()->default_value(2), "number of threads serving read only apis not touching chain state, like get_charges, 0 to serve them in main thread")
+        ("thread-affinity", bpo::value<vector<string>>()->composing(),
+            "pin the threads of one pool to cpus, in the form of pool=cpus like http=2-5,8, may be specified multiple times. "
+            "pools are main, http, net, bnet, prefetch, signature, signing, read, traces, blocklog, reversible, mongo and postgres, background threads of token database follow main")
+        ("numa-local-memory", bpo::bool_switch()->default_value(false), "prefer the memory of token database and chainbase on the numa node of main thread, main thread should be pinned to the cpus of one node by thread-affinity")
+        ("signature-cache-size", bpo::value<uint32_t>()->default_value(100000), "number of transactions whose recovered keys are cached")
+        ("irreversible-blocks-cache-size", bpo::value<uint32_t>()->default_value(1000), "number of recent irreversible blocks cached in memory for peers and api clients fetching them, 0 to disable")
+        ("token-db-cache-hot-keys", bpo::value<uint32_t>()->default_value(10000), "number of most accessed keys in token database cache recorded and preloaded on startup, 0 to disable")
+        ("response-cache-size-mb", bpo::value<uint32_t>()->default_value(0), "the size of cache of rendered responses of irreversible blocks and transactions in MBytes, 0 to disable")
+        ("trx-inclusion-tracking-size", bpo::value<uint32_t>()->default_value(0), "number of recent transactions whose inclusion and irreversible time are kept for get_trx_inclusion api, 0 to disable")
+        ("token-db-column", bpo::value<vector<string>>()->composing(), "Store tokens of one type in dedicated column family of token database with tuned options, "
+                                                                      "in the format of TYPE[:BLOCK_SIZE[:BLOOM_BITS[:COMPRESSION[:CACHE_SIZE_MB[:high]]]]], e.g. token:16384:10:zstd:128.")
         ("checkpoint", bpo::value<vector<string>>()->composing(), "Pairs of [BLOCK_NUM,BLOCK_ID] that should be enforced as checkpoints.")
         ("abi-serializer-max-time-ms", bpo::value<uint32_t>()->default_value(config::default_abi_serializer_max_time_ms), "Override default maximum ABI serialization time allowed in ms")
         ("chain-state-db-size-mb", bpo::value<uint64_t>()->default_value(config::default_state_size / (1024 * 1024)), "Maximum size (in MiB) of the chain state database")
         ("chain-state-db-guard-size-mb", bpo::value<uint64_t>()->default_value(config::default_state_guard_size / (1024 * 1024)), "Safely shut down node when free space remaining in the chain state database drops below this size (in MiB).")
         ("reversible-blocks-db-size-mb", bpo::value<uint64_t>()->default_value(config::default_reversible_cache_size / (1024 * 1024)), "Maximum size (in MiB) of the reversible blocks database")
+        ("reversible-blocks-log", bpo::bool_switch()->default_value(false), "keep reversible blocks in an append-only log written in background thread instead of the reversible blocks database, existing blocks are moved on startup when it's switched")
+        ("fork-db-journal", bpo::bool_switch()->default_value(false), "append changes of fork database into a journal, so it's recovered quickly without replaying reversible blocks if node is not shutdown cleanly")
+        ("chain-state-huge-pages", bpo::bool_switch()->default_value(false), "advise huge pages for the mappings of chain state and reversible blocks databases, only effective when state dir is on tmpfs or hugetlbfs")
+        ("chain-state-mlock", bpo::bool_switch()->default_value(false), "lock the mappings of chain state and reversible blocks databases in memory, RLIMIT_MEMLOCK should be large enough")
+        ("chain-state-prefault-threads", bpo::value<uint32_t>()->default_value(0), "number of threads faulting in the mappings of chain state and reversible blocks databases on startup, 0 to disable")
         ("reversible-blocks-db-guard-size-mb", bpo::value<uint64_t>()->default_value(config::default_reversible_guard_size / (1024 * 1024)), "Safely shut down node when free space remaining in the reverseible blocks database drops below this size (in MiB).")
         ("contracts-console", bpo::bool_switch()->default_value(false), "print contract's output to console")
+        ("profile-actions", bpo::bool_switch()->default_value(false), "collect wall time and database operations of actions, exposed by get_action_profiles")
         ("read-mode", boost::program_options::value<evt::chain::db_read_mode>()->default_value(evt::chain::db_read_mode::SPECULATIVE),
             "Database read mode (\"speculative\", \"head\", or \"read-only\").\n"// or \"irreversible\").\n"
             "In \"speculative\" mode database contains changes done up to the head block plus changes made by transactions not yet included to the blockchain.\n"
@@ -274,6 +366,7 @@ chain_plugin::set_program_options(options_description& cli, options_description&
             "In \"full\" mode all incoming blocks will be fully validated.\n"
             "In \"light\" mode all incoming blocks headers will be fully validated; transactions in those validated blocks will be trusted \n")
         ("trusted-producer", bpo::value<vector<string>>()->composing(), "Indicate a producer whose blocks headers signed by it will be fully validated, but transactions in those validated blocks will be trusted.")
+        ("checkpoint-light-validation", bpo::bool_switch()->default_value(false), "skip recovering signatures and checking authorities of transactions in blocks at or below the highest checkpoint while replaying or syncing, block headers are still validated")
         ;
 
     cli.add_options()
@@ -294,6 +387,11 @@ chain_plugin::set_program_options(options_description& cli, options_description&
         ("export-reversible-blocks", bpo::value<bfs::path>(), "export reversible block database in portable format into specified file and then exit")
         ("trusted-producer", bpo::value<vector<string>>()->composing(), "Indicate a producer whose blocks headers signed by it will be fully validated, but transactions in those validated blocks will be trusted.")
         ("snapshot", bpo::value<bfs::path>(), "File to read Snapshot State from")
+        ("snapshot-peer", bpo::value<vector<string>>()->composing(),
+            "host:port of a trusted peer to fetch the latest published snapshot from when chain state is empty, may be specified multiple times. "
+            "chunks are fetched from all the peers advertising the same snapshot in parallel, and it's saved into the snapshots dir under data dir")
+        ("snapshot-trusted-block-id", bpo::value<string>(),
+            "id of the head block of the snapshot fetched from snapshot-peer, it's required and only the snapshot of it advertised by a majority of the peers is fetched")
         ;
 }
 
@@ -352,6 +450,26 @@ chain_plugin::plugin_initialize(const variables_map& options) {
             throw;
         }
 
+        if(options.count("thread-affinity")) {
+            for(auto& s : options.at("thread-affinity").as<vector<string>>()) {
+                auto pos = s.find('=');
+                EVT_ASSERT(pos != string::npos && pos > 0, plugin_config_exception, "Invalid thread-affinity: ${s}, should be pool=cpus", ("s",s));
+                utilities::affinity::set_pool_cpus(s.substr(0, pos), utilities::affinity::parse_cpu_list(s.substr(pos + 1)));
+            }
+            // threads created by main afterwards, including the background ones of rocksdb, inherit it
+            utilities::affinity::pin_current_thread("main");
+        }
+        if(options.at("numa-local-memory").as<bool>()) {
+            // it's set before databases are opened so their caches and memtables are allocated on the node
+            auto node = utilities::affinity::prefer_local_numa_node();
+            if(node >= 0) {
+                ilog("memory is preferred on numa node ${n}", ("n",node));
+            }
+            else {
+                wlog("numa-local-memory is not supported on this platform");
+            }
+        }
+
         my->chain_config = controller::config();
 
         LOAD_VALUE_SET(options, "trusted-producer", my->chain_config->trusted_producers);
@@ -393,11 +511,29 @@ chain_plugin::plugin_initialize(const variables_map& options) {
             }
         }
 
+        if(options.at("checkpoint-light-validation").as<bool>()) {
+            EVT_ASSERT(!my->loaded_checkpoints.empty(), plugin_config_exception, "checkpoint-light-validation requires at least one checkpoint");
+            // ids of checkpoint blocks are verified in pre_accepted_block, so blocks below the highest one are known to be the trusted chain
+            my->chain_config->trusted_checkpoint_num = my->loaded_checkpoints.rbegin()->first;
+            ilog("Transactions in blocks at or below ${n} are trusted", ("n",my->chain_config->trusted_checkpoint_num));
+        }
+
         if(options.count("abi-serializer-max-time-ms")) {
             my->chain_config->max_serialization_time = std::chrono::milliseconds(options.at("abi-serializer-max-time-ms").as<uint32_t>());
         }
 
         my->chain_config->blocks_dir = my->blocks_dir;
+        my->chain_config->blocks_log_stride        = options.at("blocks-log-stride").as<uint32_t>();
+        my->chain_config->max_retained_block_files = options.at("max-retained-block-files").as<uint32_t>();
+        my->chain_config->blocks_retained_dir      = options.at("blocks-retained-dir").as<bfs::path>();
+        my->chain_config->blocks_archive_dir       = options.at("blocks-archive-dir").as<bfs::path>();
+        my->chain_config->compress_retained_blocks = options.at("blocks-compress-retained").as<bool>();
+        my->chain_config->async_blocks_log         = options.at("blocks-log-async").as<bool>();
+        my->chain_config->blocks_log_max_pending   = options.at("blocks-log-max-pending").as<uint32_t>();
+        my->chain_config->blocks_log_sync_interval = options.at("blocks-log-sync-interval").as<uint32_t>();
+        my->chain_config->blocks_recovery_threads  = options.at("blocks-recovery-threads").as<uint32_t>();
+        EVT_ASSERT(my->chain_config->blocks_log_max_pending > 0, plugin_config_exception, "blocks-log-max-pending should be greater than 0");
+        EVT_ASSERT(my->chain_config->blocks_recovery_threads > 0, plugin_config_exception, "blocks-recovery-threads should be greater than 0");
         my->chain_config->state_dir  = app().data_dir() / config::default_state_dir_name;
         my->chain_config->read_only  = my->readonly;
 
@@ -414,6 +550,113 @@ chain_plugin::plugin_initialize(const variables_map& options) {
             my->chain_config->db_config.profile = options.at("token-db-profile").as<storage_profile>();
         }
 
+        if(options.count("token-db-write-batch")) {
+            my->chain_config->db_config.enable_batch = options.at("token-db-write-batch").as<bool>();
+        }
+        my->chain_config->db_config.enable_owner_index = options.at("token-db-owner-index").as<bool>();
+        my->chain_config->db_config.cache_write_back   = options.at("token-db-cache-write-back").as<bool>();
+        if(options.count("token-db-options-file")) {
+            auto of = options.at("token-db-options-file").as<bfs::path>();
+            my->chain_config->db_config.options_file = of.is_relative() ? app().data_dir() / of : of;
+        }
+        if(options.count("token-db-background-jobs")) {
+            my->chain_config->db_config.max_background_jobs = options.at("token-db-background-jobs").as<uint32_t>();
+        }
+        if(options.count("token-db-rate-limit-mb")) {
+            my->chain_config->db_config.rate_limit = (uint64_t)options.at("token-db-rate-limit-mb").as<uint32_t>() * 1024 * 1024;
+        }
+        my->chain_config->db_config.direct_io       = options.at("token-db-direct-io").as<bool>();
+        my->chain_config->db_config.pipelined_write = options.at("token-db-pipelined-write").as<bool>();
+        my->chain_config->db_config.compressed_cache_size = (uint64_t)options.at("token-db-compressed-cache-mb").as<uint32_t>() * 1024 * 1024;
+        my->chain_config->db_config.persistent_cache_size = (uint64_t)options.at("token-db-persistent-cache-mb").as<uint32_t>() * 1024 * 1024;
+        if(my->chain_config->db_config.persistent_cache_size > 0) {
+            auto pd = options.at("token-db-persistent-cache-dir").as<bfs::path>();
+            my->chain_config->db_config.persistent_cache_path = pd.is_relative() ? app().data_dir() / pd : pd;
+        }
+        if(options.count("token-db-wal-ttl")) {
+            my->chain_config->db_config.wal_ttl = options.at("token-db-wal-ttl").as<uint32_t>();
+        }
+        if(options.count("token-db-runtime-savepoints")) {
+            my->chain_config->db_config.max_runtime_savepoints = options.at("token-db-runtime-savepoints").as<uint32_t>();
+        }
+        if(options.count("token-db-secondary-dir")) {
+            auto sd = options.at("token-db-secondary-dir").as<bfs::path>();
+            my->chain_config->db_config.secondary_path = sd.is_relative() ? app().data_dir() / sd : sd;
+            my->catch_up_interval = options.at("token-db-catch-up-interval-ms").as<uint32_t>();
+
+            // token database of primary must never be removed here
+            EVT_ASSERT(!options.at("delete-all-blocks").as<bool>() && !options.at("hard-replay-blockchain").as<bool>()
+                && !options.at("replay-blockchain").as<bool>() && !options.count("snapshot"), plugin_config_exception,
+                "Secondary token database cannot be used with deleting, replaying blocks or starting from snapshot");
+            EVT_ASSERT(my->catch_up_interval > 0, plugin_config_exception, "token-db-catch-up-interval-ms should be greater than 0");
+        }
+
+        if(options.count("token-db-prefetch-threads")) {
+            my->chain_config->prefetch_threads = options.at("token-db-prefetch-threads").as<uint32_t>();
+        }
+
+        if(options.count("signature-threads")) {
+            my->chain_config->signature_threads = options.at("signature-threads").as<uint32_t>();
+        }
+
+        if(options.count("signature-cache-size")) {
+            my->chain_config->signature_cache_size = options.at("signature-cache-size").as<uint32_t>();
+        }
+        if(options.count("irreversible-blocks-cache-size")) {
+            my->chain_config->blocks_cache_size = options.at("irreversible-blocks-cache-size").as<uint32_t>();
+        }
+
+        if(options.count("token-db-cache-hot-keys")) {
+            my->chain_config->cache_hot_keys = options.at("token-db-cache-hot-keys").as<uint32_t>();
+        }
+
+        if(options.count("response-cache-size-mb")) {
+            auto sz = options.at("response-cache-size-mb").as<uint32_t>();
+            if(sz > 0) {
+                my->response_cache = std::make_shared<chain_apis::response_cache>((size_t)sz * 1024 * 1024);
+            }
+        }
+
+        if(options.count("read-only-threads")) {
+            auto n = options.at("read-only-threads").as<uint32_t>();
+            if(n > 0) {
+                auto scope = utilities::affinity::pool_scope("read");
+                my->read_pool = std::make_shared<boost::asio::thread_pool>(n);
+            }
+        }
+
+        if(options.count("trx-inclusion-tracking-size")) {
+            my->trx_inclusions_capacity = options.at("trx-inclusion-tracking-size").as<uint32_t>();
+        }
+
+        if(options.count("token-db-column")) {
+            auto cols = options.at("token-db-column").as<vector<string>>();
+            for(const auto& col : cols) {
+                auto parts = vector<string>();
+                boost::split(parts, col, boost::is_any_of(":"));
+
+                auto type = get_token_type(parts[0]);
+                EVT_ASSERT(type.has_value() && *type != token_type::asset, plugin_config_exception, "Invalid token type in token-db-column: ${c}", ("c", col));
+                EVT_ASSERT(parts.size() <= 6, plugin_config_exception, "Invalid token-db-column: ${c}", ("c", col));
+
+                auto cc = token_database::config::column_config { .type = *type };
+                try {
+                    if(parts.size() > 1) { cc.block_size = std::stoul(parts[1]); }
+                    if(parts.size() > 2) { cc.bloom_bits = std::stoi(parts[2]); }
+                    if(parts.size() > 3) { cc.compression = parts[3]; }
+                    if(parts.size() > 4) { cc.cache_size = std::stoul(parts[4]) * 1024 * 1024; }
+                }
+                catch(const std::logic_error&) {
+                    EVT_THROW(plugin_config_exception, "Invalid token-db-column: ${c}", ("c", col));
+                }
+                if(parts.size() > 5) {
+                    EVT_ASSERT(parts[5] == "high", plugin_config_exception, "Invalid token-db-column: ${c}", ("c", col));
+                    cc.high_priority = true;
+                }
+                my->chain_config->db_config.columns.emplace_back(std::move(cc));
+            }
+        }
+
         if(options.count("chain-state-db-size-mb")) {
             my->chain_config->state_size = options.at("chain-state-db-size-mb").as<uint64_t>() * 1024 * 1024;
         }
@@ -422,10 +665,18 @@ chain_plugin::plugin_initialize(const variables_map& options) {
             my->chain_config->state_guard_size = options.at("chain-state-db-guard-size-mb").as<uint64_t>() * 1024 * 1024;
         }
 
+        my->chain_config->fork_db_journal = options.at("fork-db-journal").as<bool>();
+
+        my->chain_config->state_huge_pages       = options.at("chain-state-huge-pages").as<bool>();
+        my->chain_config->state_mlock            = options.at("chain-state-mlock").as<bool>();
+        my->chain_config->state_prefault_threads = options.at("chain-state-prefault-threads").as<uint32_t>();
+
         if(options.count("reversible-blocks-db-size-mb")) {
             my->chain_config->reversible_cache_size = options.at("reversible-blocks-db-size-mb").as<uint64_t>() * 1024 * 1024;
         }
 
+        my->chain_config->reversible_blocks_log = options.at("reversible-blocks-log").as<bool>();
+
         if(options.count("reversible-blocks-db-guard-size-mb")) {
             my->chain_config->reversible_guard_size = options.at("reversible-blocks-db-guard-size-mb").as<uint64_t>() * 1024 * 1024;
         }
@@ -435,6 +686,7 @@ chain_plugin::plugin_initialize(const variables_map& options) {
         my->chain_config->loadtest_mode       = options.at("loadtest-mode").as<bool>();
         my->chain_config->charge_free_mode    = options.at("charge-free-mode").as<bool>();
         my->chain_config->contracts_console   = options.at("contracts-console").as<bool>();
+        my->chain_config->profile_actions     = options.at("profile-actions").as<bool>();
 
         if(options.count("extract-genesis-json") || options.at("print-genesis-json").as<bool>()) {
             genesis_state gs;
@@ -492,7 +744,8 @@ chain_plugin::plugin_initialize(const variables_map& options) {
             ilog("Hard replay requested: deleting state database");
             clear_directory_contents(my->chain_config->state_dir);
             fc::remove_all(my->tokendb_dir);
-            auto backup_dir = block_log::repair_log(my->blocks_dir, options.at("truncate-at-block").as<uint32_t>());
+            auto backup_dir = block_log::repair_log(my->blocks_dir, options.at("truncate-at-block").as<uint32_t>(), my->chain_config->blocks_retained_dir,
+                my->chain_config->blocks_recovery_threads);
             if(fc::exists(backup_dir / config::reversible_blocks_dir_name) || options.at("fix-reversible-blocks").as<bool>()) {
                 // Do not try to recover reversible blocks if the directory does not exist, unless the option was explicitly provided.
                 if(!recover_reversible_blocks(backup_dir / config::reversible_blocks_dir_name,
@@ -554,12 +807,36 @@ chain_plugin::plugin_initialize(const variables_map& options) {
 
         if(options.count("snapshot")) {
             my->snapshot_path = options.at("snapshot").as<bfs::path>();
+        }
+        else if(options.count("snapshot-peer") && !fc::exists(my->chain_config->state_dir / "shared_memory.bin")) {
+            EVT_ASSERT(options.count("snapshot-trusted-block-id"), plugin_config_exception,
+                       "snapshot-trusted-block-id is required to fetch snapshot from snapshot-peer");
+
+            auto& peers      = options.at("snapshot-peer").as<vector<string>>();
+            auto  trusted_id = block_id_type(options.at("snapshot-trusted-block-id").as<string>());
+            ilog("Fetching snapshot of ${id} from ${n} peers", ("id", trusted_id)("n", peers.size()));
+            my->snapshot_path = app().get_method<methods::fetch_snapshot>()(peers, app().data_dir() / "snapshots", trusted_id);
+
+            // peers are only trusted for the chunks, the state inside should be of the trusted block as well
+            auto infile = std::ifstream(my->snapshot_path->generic_string(), (std::ios::in | std::ios::binary));
+            auto reader = make_snapshot_reader(infile);
+            reader->validate();
+            auto head = block_header_state();
+            reader->read_section<block_state>([&](auto& section) {
+                section.read_row(head);
+            });
+            EVT_ASSERT(head.id == trusted_id, plugin_config_exception,
+                       "Head block of snapshot fetched from peers is ${h}, but ${id} is trusted", ("h", head.id)("id", trusted_id));
+        }
+
+        if(my->snapshot_path) {
             EVT_ASSERT(fc::exists(*my->snapshot_path), plugin_config_exception,
                        "Cannot load snapshot, ${name} does not exist", ("name", my->snapshot_path->generic_string()));
+            my->chain_config->snapshot_dir = my->snapshot_path->parent_path();
 
             // recover genesis information from the snapshot
             auto infile = std::ifstream(my->snapshot_path->generic_string(), (std::ios::in | std::ios::binary));
-            auto reader = std::make_shared<istream_snapshot_reader>(infile);
+            auto reader = make_snapshot_reader(infile);
             reader->validate();
             reader->read_section<genesis_state>([this](auto& section) {
                 section.read_row(my->chain_config->genesis);
@@ -648,6 +925,8 @@ chain_plugin::plugin_initialize(const variables_map& options) {
             my->chain_config->read_mode = options.at("read-mode").as<db_read_mode>();
             EVT_ASSERT(my->chain_config->read_mode != db_read_mode::IRREVERSIBLE, plugin_config_exception, "irreversible mode not currently supported.");
         }
+        EVT_ASSERT(my->chain_config->db_config.secondary_path.empty() || my->chain_config->read_mode == db_read_mode::READ_ONLY,
+            plugin_config_exception, "Secondary token database requires read-mode = read-only");
 
         if(options.count("validation-mode")) {
             my->chain_config->block_validation_mode = options.at("validation-mode").as<validation_mode>();
@@ -695,10 +974,16 @@ chain_plugin::plugin_initialize(const variables_map& options) {
             });
 
         my->accepted_block_connection = my->chain->accepted_block.connect([this](const block_state_ptr& blk) {
+            if(my->trx_inclusions_capacity > 0) {
+                my->on_trx_included(blk);
+            }
             my->accepted_block_channel.publish(priority::high, blk);
         });
 
         my->irreversible_block_connection = my->chain->irreversible_block.connect([this](const block_state_ptr& blk) {
+            if(my->trx_inclusions_capacity > 0) {
+                my->on_trx_irreversible(blk);
+            }
             my->irreversible_block_channel.publish(priority::low, blk);
         });
 
@@ -707,11 +992,6 @@ chain_plugin::plugin_initialize(const variables_map& options) {
                 my->accepted_transaction_channel.publish(priority::low, meta);
             });
 
-        my->applied_transaction_connection = my->chain->applied_transaction.connect(
-            [this](const transaction_trace_ptr& trace) {
-                my->applied_transaction_channel.publish(priority::low, trace);
-            });
-
         my->chain->add_indices();
     }
     FC_LOG_AND_RETHROW()
@@ -720,10 +1000,19 @@ chain_plugin::plugin_initialize(const variables_map& options) {
 void
 chain_plugin::plugin_startup() {
     try {
+        // subscribers of the channel are all known after initialization of plugins, traces of transactions in
+        // blocks are lite without them
+        if(my->applied_transaction_channel.has_subscribers()) {
+            my->applied_transaction_connection = my->chain->applied_transaction.connect(
+                [this](const transaction_trace_ptr& trace) {
+                    my->applied_transaction_channel.publish(priority::low, trace);
+                });
+        }
+
         try {
             if(my->snapshot_path) {
                 auto infile = std::ifstream(my->snapshot_path->generic_string(), (std::ios::in | std::ios::binary));
-                auto reader = std::make_shared<istream_snapshot_reader>(infile);
+                auto reader = make_snapshot_reader(infile);
                 my->chain->startup(reader);
                 infile.close();
             }
@@ -746,6 +1035,12 @@ chain_plugin::plugin_startup() {
         ilog("Blockchain started; head block is #${num}, genesis timestamp is ${ts}",
              ("num", my->chain->head_block_num())("ts", (std::string)my->chain_config->genesis.initial_timestamp));
 
+        if(my->chain->token_db().is_secondary()) {
+            ilog("Token database is following primary one as secondary instance");
+            my->catch_up_timer.emplace(app().get_io_service());
+            my->schedule_catch_up();
+        }
+
         my->chain_config.reset();
     }
     FC_CAPTURE_AND_RETHROW()
@@ -753,18 +1048,25 @@ chain_plugin::plugin_startup() {
 
 void
 chain_plugin::plugin_shutdown() {
+    if(my->catch_up_timer) {
+        my->catch_up_timer->cancel();
+    }
     my->pre_accepted_block_connection.reset();
     my->accepted_block_header_connection.reset();
     my->accepted_block_connection.reset();
     my->irreversible_block_connection.reset();
     my->accepted_transaction_connection.reset();
     my->applied_transaction_connection.reset();
+    if(my->read_pool) {
+        // tasks in it refer to the chain
+        my->read_pool->join();
+    }
     my->chain.reset();
 }
 
 chain_apis::read_only
 chain_plugin::get_read_only_api() const {
-    return chain_apis::read_only(chain());
+    return chain_apis::read_only(chain(), my->response_cache, my->read_pool);
 }
 
 chain_apis::read_write
@@ -796,6 +1098,10 @@ chain_plugin::block_is_on_preferred_chain(const block_id_type& block_id) {
 bool
 chain_plugin::recover_reversible_blocks(const fc::path& db_dir, uint32_t cache_size,
                                         optional<fc::path> new_db_dir, uint32_t truncate_at_block) {
+    if(fc::exists(db_dir / reversible_block_log::file_name)) {
+        return recover_reversible_log(db_dir, new_db_dir, truncate_at_block);
+    }
+
     try {
         chainbase::database reversible(db_dir, database::read_only);  // Test if dirty
         // If it reaches here, then the reversible database is not dirty
@@ -905,6 +1211,35 @@ chain_plugin::recover_reversible_blocks(const fc::path& db_dir, uint32_t cache_s
     return true;
 }
 
+bool
+chain_plugin::recover_reversible_log(const fc::path& log_dir, optional<fc::path> new_log_dir, uint32_t truncate_at_block) {
+    auto dir = log_dir;
+    if(new_log_dir) {
+        fc::create_directories(*new_log_dir);
+        fc::copy(log_dir / reversible_block_log::file_name, *new_log_dir / reversible_block_log::file_name);
+        dir = *new_log_dir;
+    }
+
+    // torn tail is truncated when log is opened
+    auto log       = reversible_block_log(dir);
+    auto truncated = false;
+    if(truncate_at_block > 0 && log.last_block_num() > truncate_at_block) {
+        log.remove_from(truncate_at_block + 1);
+        truncated = true;
+        ilog("Stopped recovery of reversible blocks early at specified block number: ${stop}", ("stop", truncate_at_block));
+    }
+
+    auto start = log.first_block_num();
+    auto end   = log.last_block_num();
+    if(start == 0)
+        ilog("There were no recoverable blocks in the reversible blocks log");
+    else
+        ilog("Recovered ${num} blocks from reversible blocks log: blocks ${start} to ${end}",
+             ("num", end - start + 1)("start", start)("end", end));
+
+    return log.recovered() || truncated || new_log_dir.has_value();
+}
+
 bool
 chain_plugin::import_reversible_blocks(const fc::path& reversible_dir,
                                        uint32_t        cache_size,
@@ -961,6 +1296,24 @@ chain_plugin::import_reversible_blocks(const fc::path& reversible_dir,
 bool
 chain_plugin::export_reversible_blocks(const fc::path& reversible_dir,
                                        const fc::path& reversible_blocks_file) {
+    if(fc::exists(reversible_dir / reversible_block_log::file_name)) {
+        auto log = reversible_block_log(reversible_dir, false, true /* read_only */);
+
+        std::fstream reversible_blocks;
+        reversible_blocks.open(reversible_blocks_file.generic_string().c_str(), std::ios::out | std::ios::binary);
+        log.for_each([&](auto& b) {
+            auto data = fc::raw::pack(*b);
+            reversible_blocks.write(data.data(), data.size());
+        });
+
+        if(log.first_block_num() == 0) {
+            ilog("There were no recoverable blocks in the reversible blocks log");
+            return false;
+        }
+        ilog("Exported blocks ${start} to ${end} from reversible blocks log", ("start", log.first_block_num())("end", log.last_block_num()));
+        return !log.recovered();
+    }
+
     chainbase::database reversible(reversible_dir, database::read_only, 0, true);
     std::fstream        reversible_blocks;
     reversible_blocks.open(reversible_blocks_file.generic_string().c_str(), std::ios::out | std::ios::binary);
@@ -1023,6 +1376,85 @@ chain_plugin::get_chain_id() const {
     return *my->chain_id;
 }
 
+void
+chain_plugin::register_memory_usage(const std::string& name, memory_usage_func func) {
+    my->memory_reporters[name] = std::move(func);
+}
+
+fc::variant
+chain_plugin::get_memory_usage() const {
+    auto mvo = fc::mutable_variant_object("chain", chain().get_memory_usage());
+    for(auto& r : my->memory_reporters) {
+        mvo(r.first, r.second());
+    }
+    return mvo;
+}
+
+void
+chain_plugin_impl::schedule_catch_up() {
+    catch_up_timer->expires_from_now(std::chrono::milliseconds(catch_up_interval));
+    catch_up_timer->async_wait([this](auto& ec) {
+        if(ec == boost::asio::error::operation_aborted) {
+            return;
+        }
+        try {
+            chain->token_db().catch_up_with_primary();
+        }
+        FC_LOG_AND_DROP();
+        schedule_catch_up();
+    });
+}
+
+void
+chain_plugin_impl::on_trx_included(const block_state_ptr& bs) {
+    auto now = fc::time_point::now();
+    for(auto& trx : bs->trxs) {
+        // included again by a block of another fork, the latest one is kept
+        auto r = trx_inclusions.insert_or_assign(trx->id, trx_inclusion { bs->block_num, now, fc::time_point() });
+        if(!r.second) {
+            continue;
+        }
+
+        trx_inclusions_order.emplace_back(trx->id);
+        if(trx_inclusions_order.size() > trx_inclusions_capacity) {
+            trx_inclusions.erase(trx_inclusions_order.front());
+            trx_inclusions_order.pop_front();
+        }
+    }
+}
+
+void
+chain_plugin_impl::on_trx_irreversible(const block_state_ptr& bs) {
+    auto now = fc::time_point::now();
+    for(auto& trx : bs->trxs) {
+        auto it = trx_inclusions.find(trx->id);
+        if(it != trx_inclusions.end() && it->second.block_num == bs->block_num) {
+            it->second.irreversible_at = now;
+        }
+    }
+}
+
+std::vector<chain_apis::read_only::trx_inclusion>
+chain_plugin::get_trx_inclusion(const std::vector<transaction_id_type>& ids) const {
+    EVT_ASSERT(my->trx_inclusions_capacity > 0, plugin_config_exception, "Tracking of transaction inclusion is not enabled by --trx-inclusion-tracking-size");
+
+    auto results = std::vector<chain_apis::read_only::trx_inclusion>();
+    results.reserve(ids.size());
+    for(auto& id : ids) {
+        auto it = my->trx_inclusions.find(id);
+        if(it == my->trx_inclusions.end()) {
+            continue;
+        }
+
+        auto& i = it->second;
+        results.emplace_back(chain_apis::read_only::trx_inclusion { id, i.block_num, i.included_at });
+        if(i.irreversible_at != fc::time_point()) {
+            results.back().irreversible_at = i.irreversible_at;
+        }
+    }
+    return results;
+}
+
 void
 chain_plugin::log_guard_exception(const chain::guard_exception& e) const {
     if(e.code() == chain::database_guard_exception::code_value) {
@@ -1165,24 +1597,42 @@ read_only::get_transaction(const get_transaction_params& params) {
     else {
         block_num = *params.block_num;
     }
+
+    auto render = [&](const auto& trx, const auto& block_id) {
+        auto var = fc::variant();
+        if(params.raw.has_value() && *params.raw) {
+            fc::to_variant(trx, var);
+        }
+        else {
+            db.get_abi_serializer().to_variant(trx, var, db.get_execution_context());
+        }
+
+        auto mv = fc::mutable_variant_object(var);
+        mv["block_num"] = block_num;
+        mv["block_id"]  = block_id;
+
+        return mv;
+    };
+
+    // only the receipt is decoded if its position is recorded, it's checked in case of fork switches
+    // and falls back to scanning the block. positions of expired transactions are not kept
+    auto index = std::optional<uint32_t>();
+    if(db.is_known_unexpired_transaction(params.id) && db.get_block_num_for_trx_id(params.id) == (uint32_t)block_num) {
+        index = db.get_trx_index_for_trx_id(params.id);
+    }
+    if(index.has_value()) {
+        auto r = db.fetch_transaction_receipt(block_num, *index);
+        if(r.has_value() && r->second.trx.id() == params.id) {
+            return render(r->second.trx, r->first);
+        }
+    }
+
     auto block = db.fetch_block_by_number(block_num);
     EVT_ASSERT(block, unknown_block_exception, "Could not find head block");
 
     for(auto& tx : block->transactions) {
         if(tx.trx.id() == params.id) {
-            auto var = fc::variant();
-            if(params.raw.has_value() && *params.raw) {
-                fc::to_variant(tx.trx, var);
-            }
-            else {
-                db.get_abi_serializer().to_variant(tx.trx, var, db.get_execution_context());
-            }
-
-            auto mv = fc::mutable_variant_object(var);
-            mv["block_num"] = block_num;
-            mv["block_id"]  = block->id();
-
-            return mv;
+            return render(tx.trx, block->id());
         }
     }
     EVT_THROW(unknown_transaction_exception, "Cannot find transaction");
@@ -1205,6 +1655,12 @@ read_only::get_trx_id_for_link_id(const get_trx_id_for_link_id_params& params) c
     return vo;
 }
 
+read_write::reset_action_profiles_results
+read_write::reset_action_profiles(const reset_action_profiles_params&) {
+    db.get_action_profiler().reset();
+    return reset_action_profiles_results{};
+}
+
 void
 read_write::push_block(read_write::push_block_params&& params, next_function<read_write::push_block_results> next) {
     try {
@@ -1223,11 +1679,29 @@ read_write::push_block(read_write::push_block_params&& params, next_function<rea
 void
 read_write::push_transaction(const read_write::push_transaction_params& params, next_function<read_write::push_transaction_results> next) {
     try {
-        auto  ptrx     = std::make_shared<packed_transaction>();
+        auto ptrx = std::make_shared<packed_transaction>();
+        try {
+            db.get_abi_serializer().from_variant(params, *ptrx, db.get_execution_context());
+        }
+        EVT_RETHROW_EXCEPTIONS(chain::packed_transaction_type_exception, "Invalid packed transaction")
+
+        push_transaction(ptrx, next);
+    }
+    catch(boost::interprocess::bad_alloc&) {
+        chain_plugin::handle_db_exhaustion();
+    }
+    catch(fc::unrecoverable_exception&) {
+        raise(SIGUSR1);
+    }
+    CATCH_AND_CALL(next);
+}
+
+void
+read_write::push_transaction(const packed_transaction_ptr& ptrx, next_function<read_write::push_transaction_results> next) {
+    try {
         auto& exec_ctx = db.get_execution_context();
         auto  trx_meta = transaction_metadata_ptr();
         try {
-            db.get_abi_serializer().from_variant(params, *ptrx, exec_ctx);
             trx_meta = std::make_shared<transaction_metadata>(ptrx);
         }
         EVT_RETHROW_EXCEPTIONS(chain::packed_transaction_type_exception, "Invalid packed transaction")
@@ -1259,39 +1733,153 @@ read_write::push_transaction(const read_write::push_transaction_params& params,
     CATCH_AND_CALL(next);
 }
 
+static read_write::push_transaction_results
+error_results(const fc::exception& e) {
+    return read_write::push_transaction_results{transaction_id_type(), fc::mutable_variant_object("error", e.to_detail_string())};
+}
+
+// all the trxs are submitted at once, their keys are recovered in parallel before they're applied in order
+// results are placed by the indexes of trxs and returned when all are done, null trxs are the ones already failed
 static void
-push_recurse(read_write* rw, int index, const std::shared_ptr<read_write::push_transactions_params>& params, const std::shared_ptr<read_write::push_transactions_results>& results, const next_function<read_write::push_transactions_results>& next) {
-    auto wrapped_next = [=](const fc::static_variant<fc::exception_ptr, read_write::push_transaction_results>& result) {
-        if(result.contains<fc::exception_ptr>()) {
-            const auto& e = result.get<fc::exception_ptr>();
-            results->emplace_back(read_write::push_transaction_results{transaction_id_type(), fc::mutable_variant_object("error", e->to_detail_string())});
+push_batch(controller& db, const std::vector<packed_transaction_ptr>& ptrxs, const std::shared_ptr<read_write::push_transactions_results>& results, const next_function<read_write::push_transactions_results>& next) {
+    auto& exec_ctx  = db.get_execution_context();
+    auto  trxs      = std::vector<transaction_metadata_ptr>();
+    auto  nexts     = std::vector<next_function<transaction_trace_ptr>>();
+    auto  remaining = std::make_shared<size_t>(0);
+
+    trxs.reserve(ptrxs.size());
+    nexts.reserve(ptrxs.size());
+    for(auto i = 0u; i < ptrxs.size(); i++) {
+        if(ptrxs[i] == nullptr) {
+            continue;
         }
-        else {
-            const auto& r = result.get<read_write::push_transaction_results>();
-            results->emplace_back(r);
-        }
-
-        auto next_index = index + 1;
-        if((size_t)next_index < params->size()) {
-            push_recurse(rw, next_index, params, results, next);
+        try {
+            try {
+                trxs.emplace_back(std::make_shared<transaction_metadata>(ptrxs[i]));
+            }
+            EVT_RETHROW_EXCEPTIONS(chain::packed_transaction_type_exception, "Invalid packed transaction")
         }
-        else {
-            next(*results);
+        catch(const fc::exception& e) {
+            (*results)[i] = error_results(e);
+            continue;
         }
-    };
 
-    rw->push_transaction(params->at(index), wrapped_next);
+        nexts.emplace_back([&db, &exec_ctx, i, results, remaining, next](const fc::static_variant<fc::exception_ptr, transaction_trace_ptr>& result) {
+            if(result.contains<fc::exception_ptr>()) {
+                (*results)[i] = error_results(*result.get<fc::exception_ptr>());
+            }
+            else {
+                auto& trx_trace_ptr = result.get<transaction_trace_ptr>();
+                try {
+                    auto pretty_output = fc::variant();
+                    db.get_abi_serializer().to_variant(*trx_trace_ptr, pretty_output, exec_ctx);
+
+                    (*results)[i] = read_write::push_transaction_results{trx_trace_ptr->id, pretty_output};
+                }
+                catch(const fc::exception& e) {
+                    (*results)[i] = error_results(e);
+                }
+            }
+
+            if(--*remaining == 0) {
+                next(*results);
+            }
+        });
+    }
+
+    if(trxs.empty()) {
+        next(*results);
+        return;
+    }
+    *remaining = trxs.size();
+    app().get_method<incoming::methods::transactions_async>()(trxs, true, nexts);
 }
 
 void
 read_write::push_transactions(const read_write::push_transactions_params& params, next_function<read_write::push_transactions_results> next) {
     try {
         FC_ASSERT(params.size() <= 1000, "Attempt to push too many transactions at once");
-        auto params_copy = std::make_shared<read_write::push_transactions_params>(params.begin(), params.end());
-        auto result      = std::make_shared<read_write::push_transactions_results>();
-        result->reserve(params.size());
+        auto ptrxs  = std::vector<packed_transaction_ptr>();
+        auto result = std::make_shared<read_write::push_transactions_results>(params.size());
+
+        ptrxs.reserve(params.size());
+        for(auto i = 0u; i < params.size(); i++) {
+            auto ptrx = std::make_shared<packed_transaction>();
+            try {
+                try {
+                    db.get_abi_serializer().from_variant(params[i], *ptrx, db.get_execution_context());
+                }
+                EVT_RETHROW_EXCEPTIONS(chain::packed_transaction_type_exception, "Invalid packed transaction")
+            }
+            catch(const fc::exception& e) {
+                (*result)[i] = error_results(e);
+                ptrx.reset();
+            }
+            ptrxs.emplace_back(std::move(ptrx));
+        }
+
+        push_batch(db, ptrxs, result, next);
+    }
+    catch(boost::interprocess::bad_alloc&) {
+        chain_plugin::handle_db_exhaustion();
+    }
+    catch(fc::unrecoverable_exception&) {
+        raise(SIGUSR1);
+    }
+    CATCH_AND_CALL(next);
+}
+
+void
+read_write::push_transaction_json(const std::string& body, next_function<read_write::push_transaction_results> next) {
+    auto ptrxs = std::vector<packed_transaction>();
+    if(!db.get_abi_serializer().json_to_packed_transactions(body, false /* batch */, ptrxs, db.get_execution_context())) {
+        // falls back to variant, which also reports the errors
+        push_transaction(fc::json::from_string(body).as<push_transaction_params>(), next);
+        return;
+    }
+    push_transaction(std::make_shared<packed_transaction>(std::move(ptrxs.front())), next);
+}
 
-        push_recurse(this, 0, params_copy, result, next);
+void
+read_write::push_transactions_json(const std::string& body, next_function<read_write::push_transactions_results> next) {
+    auto ptrxs = std::vector<packed_transaction>();
+    if(!db.get_abi_serializer().json_to_packed_transactions(body, true /* batch */, ptrxs, db.get_execution_context()) || ptrxs.empty()) {
+        push_transactions(fc::json::from_string(body).as<push_transactions_params>(), next);
+        return;
+    }
+    try {
+        auto params = std::vector<packed_transaction_ptr>();
+        params.reserve(ptrxs.size());
+        for(auto& ptrx : ptrxs) {
+            params.emplace_back(std::make_shared<packed_transaction>(std::move(ptrx)));
+        }
+        auto result = std::make_shared<read_write::push_transactions_results>(params.size());
+
+        push_batch(db, params, result, next);
+    }
+    CATCH_AND_CALL(next);
+}
+
+void
+read_write::push_packed_transaction(const std::string& body, next_function<read_write::push_transaction_results> next) {
+    try {
+        push_transaction(unpack_packed_transaction(body), next);
+    }
+    CATCH_AND_CALL(next);
+}
+
+void
+read_write::push_packed_transactions(const std::string& body, next_function<read_write::push_transactions_results> next) {
+    try {
+        auto params = std::make_shared<std::vector<packed_transaction_ptr>>(unpack_packed_transactions(body));
+        auto result = std::make_shared<read_write::push_transactions_results>();
+        if(params->empty()) {
+            next(*result);
+            return;
+        }
+        result->reserve(params->size());
+
+        push_recurse(this, 0, params, result, next);
     }
     CATCH_AND_CALL(next);
 }
@@ -1395,6 +1983,112 @@ read_only::get_charge(const get_charge_params& params) const {
     return result;
 }
 
+// charge of one trx, errors are returned in place so the others are not affected
+template<typename F>
+static fc::variant
+charge_or_error(const charge_manager& cm, F&& get_ptrx, size_t sigs_num) {
+    try {
+        return fc::mutable_variant_object("charge", cm.calculate(get_ptrx(), sigs_num));
+    }
+    catch(const fc::exception& e) {
+        return fc::mutable_variant_object("error", e.to_detail_string());
+    }
+}
+
+// versions of actions are changed by blocks applied in main thread, tasks in read pool use a pinned copy
+static std::shared_ptr<const evt_execution_context>
+pin_execution_context(const controller& db) {
+    return static_cast<const evt_execution_context&>(db.get_execution_context()).pin_versions();
+}
+
+// runs the task in read pool when it's enabled and delivers the results in main thread
+static void
+run_charges_task(const std::shared_ptr<boost::asio::thread_pool>& pool,
+                 std::function<read_only::get_charges_results()>&& task,
+                 const next_function<read_only::get_charges_results>& next) {
+    if(!pool) {
+        try {
+            next(task());
+        }
+        CATCH_AND_CALL(next);
+        return;
+    }
+
+    boost::asio::post(*pool, [task = std::move(task), next] {
+        auto main_next = [&next](const fc::static_variant<fc::exception_ptr, read_only::get_charges_results>& result) {
+            app().post(priority::low, [next, result] {
+                next(result);
+            });
+        };
+        try {
+            main_next(task());
+        }
+        CATCH_AND_CALL(main_next);
+    });
+}
+
+void
+read_only::get_charges(const std::string& body, next_function<get_charges_results> next) const {
+    // config and versions of actions are copied in main thread, so chain state is not read in read pool.
+    // abi serializer is immutable after startup
+    auto exec_ctx = pin_execution_context(db);
+    auto config   = db.get_global_properties().configuration;
+    auto head_num = db.head_block_num();
+
+    run_charges_task(read_pool, [&db = db, exec_ctx, config, head_num, body] {
+        auto params = fc::json::from_string(body).as<get_charges_params>();
+        FC_ASSERT(params.size() <= 1000, "Attempt to get charges of too many transactions at once");
+
+        auto cm      = charge_manager(config, head_num, *exec_ctx);
+        auto results = get_charges_results();
+        results.reserve(params.size());
+        for(auto& p : params) {
+            results.emplace_back(charge_or_error(cm, [&] {
+                auto trx = transaction();
+                try {
+                    db.get_abi_serializer().from_variant(p.transaction, trx, *exec_ctx);
+                }
+                EVT_RETHROW_EXCEPTIONS(chain::transaction_type_exception, "Invalid transaction");
+                return packed_transaction(std::move(trx), {});
+            }, p.sigs_num));
+        }
+        return results;
+    }, next);
+}
+
+void
+read_only::get_packed_charges(const std::string& body, next_function<get_charges_results> next) const {
+    auto exec_ctx = pin_execution_context(db);
+    auto config   = db.get_global_properties().configuration;
+    auto head_num = db.head_block_num();
+
+    run_charges_task(read_pool, [exec_ctx, config, head_num, body] {
+        check_raw_body(body);
+
+        auto ds   = fc::datastream<const char*>(body.data(), body.size());
+        auto size = fc::unsigned_int();
+        fc::raw::unpack(ds, size);
+        FC_ASSERT(size.value <= 1000, "Attempt to get charges of too many transactions at once");
+
+        auto cm      = charge_manager(config, head_num, *exec_ctx);
+        auto results = get_charges_results();
+        results.reserve(size.value);
+        for(auto i = 0u; i < size.value; i++) {
+            auto ptrx     = packed_transaction();
+            auto sigs_num = fc::unsigned_int();
+            try {
+                fc::raw::unpack(ds, ptrx);
+                fc::raw::unpack(ds, sigs_num);
+            }
+            EVT_RETHROW_EXCEPTIONS(chain::packed_transaction_type_exception, "Invalid packed transactions")
+
+            results.emplace_back(charge_or_error(cm, [&]() -> auto& { return ptrx; }, sigs_num.value));
+        }
+        EVT_ASSERT(ds.remaining() == 0, chain::packed_transaction_type_exception, "Extra bytes after packed transactions");
+        return results;
+    }, next);
+}
+
 fc::variant
 read_only::get_transaction_ids_for_block(const get_transaction_ids_for_block_params& params) const {
     auto block = signed_block_ptr();
@@ -1413,6 +2107,68 @@ read_only::get_transaction_ids_for_block(const get_transaction_ids_for_block_par
     return arr;
 }
 
+template <typename Func>
+std::string
+read_only::render_json(const std::string& key, uint32_t block_num, Func&& func) const {
+    if(cache == nullptr) {
+        return fc::json::to_string(func());
+    }
+    return cache->render(key, block_num, db.last_irreversible_block_num(), std::forward<Func>(func));
+}
+
+std::string
+read_only::get_block_json(const get_block_params& params) const {
+    auto block_num = 0u;
+    if(params.block_num_or_id.size() == 64) {
+        try {
+            block_num = block_header::num_from_id(fc::variant(params.block_num_or_id).as<block_id_type>());
+        }
+        EVT_RETHROW_EXCEPTIONS(chain::block_id_type_exception, "Invalid block ID: ${block_num_or_id}", ("block_num_or_id", params.block_num_or_id))
+    }
+    else if(!params.block_num_or_id.empty() && params.block_num_or_id.size() <= 64) {
+        try {
+            block_num = fc::to_uint64(params.block_num_or_id);
+        }
+        EVT_RETHROW_EXCEPTIONS(chain::block_id_type_exception, "Invalid block ID: ${block_num_or_id}", ("block_num_or_id", params.block_num_or_id))
+    }
+    return render_json("get_block:" + params.block_num_or_id, block_num, [&] { return get_block(params); });
+}
+
+std::string
+read_only::get_block_header_state_json(const get_block_header_state_params& params) const {
+    auto block_num = std::numeric_limits<uint32_t>::max();
+    try {
+        block_num = fc::to_uint64(params.block_num_or_id);
+    }
+    catch(...) {
+        try {
+            block_num = block_header::num_from_id(fc::variant(params.block_num_or_id).as<block_id_type>());
+        }
+        catch(...) {
+            // invalid ones are not cached, get_block_header_state reports the error
+        }
+    }
+    return render_json("get_block_header_state:" + params.block_num_or_id, block_num, [&] { return get_block_header_state(params); });
+}
+
+std::string
+read_only::get_transaction_json(const get_transaction_params& params) {
+    auto block_num = params.block_num.has_value() ? *params.block_num : db.get_block_num_for_trx_id(params.id);
+    auto raw       = params.raw.has_value() && *params.raw;
+    auto key       = "get_transaction:" + params.id.str() + ":" + std::to_string(block_num) + (raw ? ":raw" : "");
+    return render_json(key, block_num, [&] {
+        auto p      = params;
+        p.block_num = block_num;
+        return get_transaction(p);
+    });
+}
+
+std::string
+read_only::get_transaction_ids_for_block_json(const get_transaction_ids_for_block_params& params) const {
+    auto block_num = block_header::num_from_id(params.block_id);
+    return render_json("get_transaction_ids_for_block:" + params.block_id.str(), block_num, [&] { return get_transaction_ids_for_block(params); });
+}
+
 const std::string&
 read_only::get_abi(const get_abi_params&) const {
     static std::string _abi_json;
@@ -1461,9 +2217,35 @@ read_only::get_actions(const get_actions_params&) const {
     }
 }
 
-std::string
+std::vector<chain::action_profile>
+read_only::get_action_profiles(const get_action_profiles_params&) const {
+    auto& profiler = db.get_action_profiler();
+    EVT_ASSERT(profiler.enabled(), chain::plugin_config_exception, "Action profiling is not enabled, set 'profile-actions' to enable it");
+
+    return profiler.get_profiles();
+}
+
+fc::variant
 read_only::get_db_info(const get_db_info_params&) const {
-    return db.token_db().stats();
+    auto& tokendb = db.token_db();
+
+    auto var = fc::variant();
+    fc::to_variant(tokendb.metrics(), var);
+
+    auto mvar = fc::mutable_variant_object(var);
+    mvar["stats"] = tokendb.stats();
+    return mvar;
+}
+
+fc::variant
+read_only::get_memory_usage(const get_memory_usage_params&) const {
+    return app().get_plugin<chain_plugin>().get_memory_usage();
+}
+
+std::vector<read_only::trx_inclusion>
+read_only::get_trx_inclusion(const get_trx_inclusion_params& params) const {
+    EVT_ASSERT(params.ids.size() <= 1000, chain_type_exception, "Cannot query more than 1000 transactions at once");
+    return app().get_plugin<chain_plugin>().get_trx_inclusion(params.ids);
 }
 
 }  // namespace chain_apis
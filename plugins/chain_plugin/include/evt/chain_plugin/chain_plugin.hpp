@@ -4,6 +4,7 @@
  */
 #pragma once
 #include <appbase/application.hpp>
+#include <evt/chain/action_profiler.hpp>
 #include <evt/chain/asset.hpp>
 #include <evt/chain/block.hpp>
 #include <evt/chain/version.hpp>
@@ -20,6 +21,10 @@ namespace fc {
 class variant;
 }
 
+namespace boost { namespace asio {
+class thread_pool;
+}}  // namespace boost::asio
+
 namespace evt {
 using namespace appbase;
 using std::unique_ptr;
@@ -47,14 +52,18 @@ struct empty {};
 template <typename>
 struct resolver_factory;
 
+class response_cache;
+
 class read_only {
 public:
-    const controller& db;
-    bool  shorten_abi_errors = true;
+    const controller&                         db;
+    bool                                      shorten_abi_errors = true;
+    std::shared_ptr<response_cache>           cache;
+    std::shared_ptr<boost::asio::thread_pool> read_pool;
 
 public:
-    read_only(const controller& db)
-        : db(db) {}
+    read_only(const controller& db, std::shared_ptr<response_cache> cache = nullptr, std::shared_ptr<boost::asio::thread_pool> read_pool = nullptr)
+        : db(db), cache(std::move(cache)), read_pool(std::move(read_pool)) {}
 
     void set_shorten_abi_errors(bool f) { shorten_abi_errors = f; }
 
@@ -132,6 +141,14 @@ public:
     };
     get_charge_result get_charge(const get_charge_params& params) const;
 
+    // charges of many transactions calculated in read pool, each result is either {"charge"} or {"error"}
+    using get_charges_params  = vector<get_charge_params>;
+    using get_charges_results = vector<fc::variant>;
+    void get_charges(const std::string& body, chain::plugin_interface::next_function<get_charges_results> next) const;
+
+    // body is the raw bytes of vector of packed transactions, each one is followed by varuint32 of signatures number
+    void get_packed_charges(const std::string& body, chain::plugin_interface::next_function<get_charges_results> next) const;
+
     struct get_block_params {
         string block_num_or_id;
     };
@@ -162,6 +179,13 @@ public:
     };
     fc::variant get_transaction_ids_for_block(const get_transaction_ids_for_block_params& params) const;
 
+    // same as above but return the rendered json
+    // responses of irreversible blocks never change, they're cached if response cache is enabled
+    std::string get_block_json(const get_block_params& params) const;
+    std::string get_block_header_state_json(const get_block_header_state_params& params) const;
+    std::string get_transaction_json(const get_transaction_params& params);
+    std::string get_transaction_ids_for_block_json(const get_transaction_ids_for_block_params& params) const;
+
     using get_abi_params = empty;
     const std::string& get_abi(const get_abi_params&) const;
 
@@ -169,7 +193,31 @@ public:
     const std::string& get_actions(const get_actions_params&) const;
 
     using get_db_info_params = empty;
-    std::string get_db_info(const get_db_info_params&) const;
+    fc::variant get_db_info(const get_db_info_params&) const;
+
+    // bytes held by chain and the structures reported by plugins
+    using get_memory_usage_params = empty;
+    fc::variant get_memory_usage(const get_memory_usage_params&) const;
+
+    using get_action_profiles_params = empty;
+    std::vector<chain::action_profile> get_action_profiles(const get_action_profiles_params&) const;
+
+    // local time when transactions are included into blocks and become irreversible,
+    // the ones not included yet or not tracked anymore are omitted
+    struct get_trx_inclusion_params {
+        std::vector<transaction_id_type> ids;
+    };
+    struct trx_inclusion {
+        transaction_id_type      id;
+        uint32_t                 block_num;
+        fc::time_point           included_at;
+        optional<fc::time_point> irreversible_at;
+    };
+    std::vector<trx_inclusion> get_trx_inclusion(const get_trx_inclusion_params& params) const;
+
+private:
+    template <typename Func>
+    std::string render_json(const std::string& key, uint32_t block_num, Func&& func) const;
 };
 
 class read_write {
@@ -190,11 +238,24 @@ public:
         fc::variant         processed;
     };
     void push_transaction(const push_transaction_params& params, chain::plugin_interface::next_function<push_transaction_results> next);
+    void push_transaction(const chain::packed_transaction_ptr& ptrx, chain::plugin_interface::next_function<push_transaction_results> next);
 
     using push_transactions_params  = vector<push_transaction_params>;
     using push_transactions_results = vector<push_transaction_results>;
     void push_transactions(const push_transactions_params& params, chain::plugin_interface::next_function<push_transactions_results> next);
 
+    // same as above but parse the request body directly instead of converting it into params
+    void push_transaction_json(const std::string& body, chain::plugin_interface::next_function<push_transaction_results> next);
+    void push_transactions_json(const std::string& body, chain::plugin_interface::next_function<push_transactions_results> next);
+
+    // body is the raw bytes of packed transaction, or vector of them
+    void push_packed_transaction(const std::string& body, chain::plugin_interface::next_function<push_transaction_results> next);
+    void push_packed_transactions(const std::string& body, chain::plugin_interface::next_function<push_transactions_results> next);
+
+    using reset_action_profiles_params  = empty;
+    using reset_action_profiles_results = empty;
+    reset_action_profiles_results reset_action_profiles(const reset_action_profiles_params&);
+
     friend resolver_factory<read_write>;
 };
 }  // namespace chain_apis
@@ -222,6 +283,7 @@ public:
     bool block_is_on_preferred_chain(const chain::block_id_type& block_id);
 
     static bool recover_reversible_blocks(const fc::path& db_dir, uint32_t cache_size, optional<fc::path> new_db_dir = optional<fc::path>(), uint32_t truncate_at_block = 0);
+    static bool recover_reversible_log(const fc::path& log_dir, optional<fc::path> new_log_dir = optional<fc::path>(), uint32_t truncate_at_block = 0);
 
     static bool import_reversible_blocks(const fc::path& reversible_dir, uint32_t cache_size, const fc::path& reversible_blocks_file);
 
@@ -239,6 +301,13 @@ public:
 
     void handle_guard_exception(const chain::guard_exception& e) const;
 
+    // plugins report the memory used by their structures under `name`, `func` is called in main thread
+    using memory_usage_func = std::function<fc::variant()>;
+    void        register_memory_usage(const std::string& name, memory_usage_func func);
+    fc::variant get_memory_usage() const;
+
+    std::vector<chain_apis::read_only::trx_inclusion> get_trx_inclusion(const std::vector<chain::transaction_id_type>& ids) const;
+
     static void handle_db_exhaustion();
 
 private:
@@ -270,4 +339,6 @@ FC_REFLECT(evt::chain_apis::read_only::get_suspend_required_keys_result, (requir
 FC_REFLECT(evt::chain_apis::read_only::get_charge_params, (transaction)(sigs_num));
 FC_REFLECT(evt::chain_apis::read_only::get_charge_result, (charge));
 FC_REFLECT(evt::chain_apis::read_only::get_transaction_ids_for_block_params, (block_id));
+FC_REFLECT(evt::chain_apis::read_only::get_trx_inclusion_params, (ids));
+FC_REFLECT(evt::chain_apis::read_only::trx_inclusion, (id)(block_num)(included_at)(irreversible_at));
 FC_REFLECT(evt::chain_apis::read_write::push_transaction_results, (transaction_id)(processed));
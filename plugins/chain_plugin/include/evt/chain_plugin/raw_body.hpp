@@ -0,0 +1,60 @@
+/**
+ *  @file
+ *  @copyright defined in evt/LICENSE.txt
+ */
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include <fc/io/raw.hpp>
+#include <evt/chain/exceptions.hpp>
+#include <evt/chain/transaction.hpp>
+
+namespace evt { namespace chain_apis {
+
+// bodies of the apis taking raw bytes are required, they're not defaulted to `{}` like the json ones
+inline void
+check_raw_body(const std::string& body) {
+    EVT_ASSERT(!body.empty(), chain::packed_transaction_type_exception, "Body of raw bytes is required");
+}
+
+// body is the raw bytes of one packed transaction
+inline chain::packed_transaction_ptr
+unpack_packed_transaction(const std::string& body) {
+    check_raw_body(body);
+
+    auto ptrx = std::make_shared<chain::packed_transaction>();
+    try {
+        auto ds = fc::datastream<const char*>(body.data(), body.size());
+        fc::raw::unpack(ds, *ptrx);
+        EVT_ASSERT(ds.remaining() == 0, chain::packed_transaction_type_exception, "Extra bytes after packed transaction");
+    }
+    EVT_RETHROW_EXCEPTIONS(chain::packed_transaction_type_exception, "Invalid packed transaction")
+    return ptrx;
+}
+
+// body is a varint count followed by that many packed transactions, at most 1000 of them
+inline std::vector<chain::packed_transaction_ptr>
+unpack_packed_transactions(const std::string& body) {
+    check_raw_body(body);
+
+    auto trxs = std::vector<chain::packed_transaction_ptr>();
+    try {
+        auto ds   = fc::datastream<const char*>(body.data(), body.size());
+        auto size = fc::unsigned_int();
+        fc::raw::unpack(ds, size);
+        FC_ASSERT(size.value <= 1000, "Attempt to push too many transactions at once");
+
+        trxs.reserve(size.value);
+        for(auto i = 0u; i < size.value; i++) {
+            auto ptrx = std::make_shared<chain::packed_transaction>();
+            fc::raw::unpack(ds, *ptrx);
+            trxs.emplace_back(std::move(ptrx));
+        }
+        EVT_ASSERT(ds.remaining() == 0, chain::packed_transaction_type_exception, "Extra bytes after packed transactions");
+    }
+    EVT_RETHROW_EXCEPTIONS(chain::packed_transaction_type_exception, "Invalid packed transactions")
+    return trxs;
+}
+
+}}  // namespace evt::chain_apis
@@ -0,0 +1,68 @@
+/**
+ *  @file
+ *  @copyright defined in evt/LICENSE.txt
+ */
+#pragma once
+#include <optional>
+#include <string>
+#include <boost/noncopyable.hpp>
+#include <rocksdb/cache.h>
+#include <fc/exception/exception.hpp>
+#include <fc/io/json.hpp>
+
+namespace evt { namespace chain_apis {
+
+// lru cache of rendered json responses, it's shared by all the copies of read only api
+class response_cache : boost::noncopyable {
+public:
+    response_cache(size_t capacity)
+        : cache_(rocksdb::NewLRUCache(capacity, kCacheShardBits)) {}
+
+private:
+    // each shard of lru cache has its own mutex
+    static constexpr int kCacheShardBits = 4;
+
+public:
+    std::optional<std::string>
+    get(const std::string& key) {
+        auto h = cache_->Lookup(key);
+        if(h == nullptr) {
+            return std::nullopt;
+        }
+        auto json = *(const std::string*)cache_->Value(h);
+        cache_->Release(h);
+        return json;
+    }
+
+    void
+    put(const std::string& key, const std::string& json) {
+        auto v = new std::string(json);
+        // capacity is the total size of responses
+        auto s = cache_->Insert(key, (void*)v, json.size(), [](auto& ck, auto cv) { delete (std::string*)cv; }, nullptr /* handle */);
+        FC_ASSERT(s == rocksdb::Status::OK());
+    }
+
+    // responses of blocks at or below `lib` never change and are cached, the ones above it are always rendered
+    // by `func`. errors thrown by `func` are passed to caller and never cached
+    template <typename Func>
+    std::string
+    render(const std::string& key, uint32_t block_num, uint32_t lib, Func&& func) {
+        auto irreversible = block_num <= lib;
+        if(irreversible) {
+            if(auto json = get(key); json.has_value()) {
+                return std::move(*json);
+            }
+        }
+
+        auto json = fc::json::to_string(func());
+        if(irreversible) {
+            put(key, json);
+        }
+        return json;
+    }
+
+private:
+    std::shared_ptr<rocksdb::Cache> cache_;
+};
+
+}}  // namespace evt::chain_apis
@@ -0,0 +1,568 @@
+/**
+ *  @file
+ *  @copyright defined in evt/LICENSE.txt
+ */
+#include <evt/event_stream_plugin/event_stream_plugin.hpp>
+
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <fc/io/json.hpp>
+#include <fc/io/raw.hpp>
+
+#include <websocketpp/config/asio_no_tls.hpp>
+#include <websocketpp/logger/stub.hpp>
+#include <websocketpp/server.hpp>
+
+#include <evt/chain/block.hpp>
+#include <evt/chain/block_state.hpp>
+#include <evt/chain/exceptions.hpp>
+#include <evt/chain/contracts/abi_serializer.hpp>
+
+namespace evt {
+
+static appbase::abstract_plugin& _event_stream_plugin = app().register_plugin<event_stream_plugin>();
+
+using namespace evt::chain;
+using namespace evt::event_stream;
+
+using boost::asio::ip::tcp;
+using boost::asio::steady_timer;
+using websocketpp::connection_hdl;
+
+namespace internal {
+
+struct ws_config : public websocketpp::config::asio {
+    typedef ws_config type;
+    typedef asio      base;
+
+    typedef websocketpp::log::stub elog_type;
+    typedef websocketpp::log::stub alog_type;
+
+    struct transport_config : public base::transport_config {
+        typedef type::concurrency_type concurrency_type;
+        typedef type::alog_type        alog_type;
+        typedef type::elog_type        elog_type;
+        typedef type::request_type     request_type;
+        typedef type::response_type    response_type;
+        typedef websocketpp::transport::asio::basic_socket::endpoint socket_type;
+    };
+
+    typedef websocketpp::transport::asio::endpoint<transport_config> transport_type;
+};
+
+using ws_server_type = websocketpp::server<ws_config>;
+
+struct subscribe_params {
+    std::vector<domain_name> domains;
+    std::vector<domain_key>  keys;
+    std::vector<action_name> actions;
+    std::vector<address>     addresses;
+    std::string              encoding = "json";
+    uint32_t                 start_block = 0;  // 0 for only new blocks
+    bool                     irreversible_only = false;
+};
+
+// collects all the string values, addresses and public keys are all strings in the json form of actions
+void
+collect_strings(const fc::variant& v, std::vector<std::string>& strs) {
+    if(v.is_string()) {
+        strs.emplace_back(v.get_string());
+    }
+    else if(v.is_array()) {
+        for(auto& e : v.get_array()) {
+            collect_strings(e, strs);
+        }
+    }
+    else if(v.is_object()) {
+        for(auto& e : v.get_object()) {
+            collect_strings(e.value(), strs);
+        }
+    }
+}
+
+}  // namespace internal
+
+}  // namespace evt
+
+FC_REFLECT(evt::internal::subscribe_params, (domains)(keys)(actions)(addresses)(encoding)(start_block)(irreversible_only));
+
+namespace evt {
+
+using internal::ws_server_type;
+
+class event_stream_plugin_impl : public std::enable_shared_from_this<event_stream_plugin_impl> {
+public:
+    struct client {
+        connection_hdl hdl;
+        bool           subscribed        = false;
+        bool           closed            = false;
+        bool           live              = false;  // false while sending blocks before the head
+        bool           binary            = false;
+        bool           irreversible_only = false;
+        uint32_t       next_block        = 0;      // next block to send while catching up
+
+        std::set<domain_name> domains;
+        std::set<domain_key>  keys;
+        std::set<action_name> actions;
+        std::set<std::string> addresses;
+
+        std::optional<steady_timer> timer;
+    };
+    using client_ptr = std::shared_ptr<client>;
+
+    // one action of the block being dispatched, the decoded data and payloads are
+    // built at most once no matter how many clients it's sent to
+    struct action_context {
+        const signed_block&       block;
+        const block_id_type&      block_id;
+        const packed_transaction& trx;
+        const action&             act;
+        uint16_t                  index;
+        bool                      irreversible;
+
+        std::optional<transaction_id_type>      trx_id;
+        std::optional<fc::variant>              data;
+        std::optional<std::vector<std::string>> strings;
+        std::optional<std::string>              json;
+        std::optional<std::string>              binary;
+    };
+
+    enum { kCatchUpBatch = 50, kCatchUpRetryMs = 20 };
+
+public:
+    event_stream_plugin_impl(controller& db)
+        : db_(db) {}
+
+public:
+    void init();
+    void start();
+    void shutdown();
+
+private:
+    void on_open(connection_hdl hdl);
+    void on_close(connection_hdl hdl);
+    void on_message(connection_hdl hdl, ws_server_type::message_ptr msg);
+    void subscribe(const client_ptr& c, const std::string& payload);
+
+    void applied_block(const block_state_ptr& bs);
+    void applied_irreversible_block(const block_state_ptr& bs);
+
+    void dispatch_block(const signed_block& block, const block_id_type& id, bool irreversible, const std::vector<client_ptr>& targets);
+    bool matches(const client& c, action_context& ctx);
+    const fc::variant& data_of(action_context& ctx);
+    const std::string& payload_of(action_context& ctx, bool binary);
+
+    void catch_up(const client_ptr& c);
+    void send(const client_ptr& c, const std::string& payload, bool binary);
+    void close(const client_ptr& c, const std::string& reason);
+
+public:
+    controller& db_;
+
+    std::optional<tcp::endpoint> listen_endpoint_;
+    uint32_t                     max_clients_;
+    size_t                       max_buffer_size_;
+    uint32_t                     max_resume_blocks_;
+
+    ws_server_type                                                       server_;
+    std::map<connection_hdl, client_ptr, std::owner_less<connection_hdl>> clients_;
+
+    std::optional<boost::signals2::scoped_connection> accepted_block_connection_;
+    std::optional<boost::signals2::scoped_connection> irreversible_block_connection_;
+};
+
+void
+event_stream_plugin_impl::on_open(connection_hdl hdl) {
+    auto c = std::make_shared<client>();
+    c->hdl = hdl;
+    clients_.emplace(hdl, c);
+
+    if(clients_.size() > max_clients_) {
+        close(c, "Too many clients");
+    }
+}
+
+void
+event_stream_plugin_impl::on_close(connection_hdl hdl) {
+    auto it = clients_.find(hdl);
+    if(it == clients_.end()) {
+        return;
+    }
+
+    auto& c   = it->second;
+    c->closed = true;
+    if(c->timer) {
+        c->timer->cancel();
+    }
+    clients_.erase(it);
+}
+
+void
+event_stream_plugin_impl::on_message(connection_hdl hdl, ws_server_type::message_ptr msg) {
+    auto it = clients_.find(hdl);
+    if(it == clients_.end()) {
+        return;
+    }
+
+    auto c = it->second;
+    try {
+        EVT_ASSERT(!c->subscribed, chain::plugin_exception, "Already subscribed");
+        subscribe(c, msg->get_payload());
+    }
+    catch(const fc::exception& e) {
+        close(c, e.top_message());
+    }
+    catch(const std::exception& e) {
+        close(c, e.what());
+    }
+}
+
+void
+event_stream_plugin_impl::subscribe(const client_ptr& c, const std::string& payload) {
+    auto params = internal::subscribe_params();
+    fc::from_variant(fc::json::from_string(payload), params);
+
+    EVT_ASSERT(params.encoding == "json" || params.encoding == "binary", chain::plugin_exception,
+        "Unknown encoding: ${e}, should be json or binary", ("e",params.encoding));
+
+    c->binary            = params.encoding == "binary";
+    c->irreversible_only = params.irreversible_only;
+    c->domains.insert(params.domains.cbegin(), params.domains.cend());
+    c->keys.insert(params.keys.cbegin(), params.keys.cend());
+    c->actions.insert(params.actions.cbegin(), params.actions.cend());
+    for(auto& addr : params.addresses) {
+        c->addresses.emplace(addr.to_string());
+    }
+
+    auto head = c->irreversible_only ? db_.last_irreversible_block_num() : db_.head_block_num();
+    if(params.start_block == 0 || params.start_block > head) {
+        c->live = true;
+    }
+    else {
+        EVT_ASSERT(max_resume_blocks_ == 0 || head - params.start_block < max_resume_blocks_, chain::plugin_exception,
+            "Start block is too old, can resume from at most ${n} blocks before head", ("n",max_resume_blocks_));
+        c->next_block = params.start_block;
+        c->timer.emplace(app().get_io_service());
+        catch_up(c);
+    }
+    c->subscribed = true;
+}
+
+void
+event_stream_plugin_impl::catch_up(const client_ptr& c) {
+    if(c->closed) {
+        return;
+    }
+
+    auto ec  = websocketpp::lib::error_code();
+    auto con = server_.get_con_from_hdl(c->hdl, ec);
+    if(ec) {
+        return;
+    }
+
+    // blocks are read only while the client keeps up, so slow clients don't pile up blocks in memory
+    auto full = con->get_buffered_amount() >= max_buffer_size_ / 2;
+    if(!full) {
+        auto lib  = db_.last_irreversible_block_num();
+        auto head = c->irreversible_only ? lib : db_.head_block_num();
+        for(auto i = 0; i < kCatchUpBatch && c->next_block <= head; i++, c->next_block++) {
+            auto block = db_.fetch_block_by_number(c->next_block);
+            if(!block) {
+                close(c, "Cannot find block " + std::to_string(c->next_block));
+                return;
+            }
+            dispatch_block(*block, block->id(), c->next_block <= lib, { c });
+            if(c->closed) {
+                // closed because of overflow
+                return;
+            }
+        }
+
+        if(c->next_block > head) {
+            // all the blocks before are sent, following ones come from signals
+            c->live = true;
+            return;
+        }
+    }
+
+    auto wptr = std::weak_ptr<event_stream_plugin_impl>(shared_from_this());
+    c->timer->expires_from_now(std::chrono::milliseconds(full ? kCatchUpRetryMs : 0));
+    c->timer->async_wait([wptr, c](auto& ec) {
+        auto self = wptr.lock();
+        if(self && ec != boost::asio::error::operation_aborted) {
+            self->catch_up(c);
+        }
+    });
+}
+
+void
+event_stream_plugin_impl::applied_block(const block_state_ptr& bs) {
+    auto targets = std::vector<client_ptr>();
+    for(auto& it : clients_) {
+        auto& c = it.second;
+        if(c->live && !c->irreversible_only) {
+            targets.emplace_back(c);
+        }
+    }
+    if(targets.empty()) {
+        return;
+    }
+    dispatch_block(*bs->block, bs->id, false, targets);
+}
+
+void
+event_stream_plugin_impl::applied_irreversible_block(const block_state_ptr& bs) {
+    if(clients_.empty()) {
+        return;
+    }
+
+    auto targets = std::vector<client_ptr>();
+    auto others  = std::vector<client_ptr>();
+    for(auto& it : clients_) {
+        auto& c = it.second;
+        if(c->live) {
+            (c->irreversible_only ? targets : others).emplace_back(c);
+        }
+    }
+
+    // clients may be closed while sending, so they're not sent in the loop over `clients_`
+    auto notice = std::optional<std::pair<std::string, std::string>>();  // json and binary
+    for(auto& c : others) {
+        if(!notice) {
+            auto ev = irreversible_event { bs->block_num, bs->id };
+            auto vo = fc::mutable_variant_object("type", "irreversible")("block_num", ev.block_num)("block_id", ev.block_id);
+            auto bv = fc::raw::pack(stream_event(ev));
+            notice.emplace(fc::json::to_string(vo), std::string(bv.begin(), bv.end()));
+        }
+        send(c, c->binary ? notice->second : notice->first, c->binary);
+    }
+    if(targets.empty()) {
+        return;
+    }
+    dispatch_block(*bs->block, bs->id, true, targets);
+}
+
+void
+event_stream_plugin_impl::dispatch_block(const signed_block& block, const block_id_type& id, bool irreversible, const std::vector<client_ptr>& targets) {
+    for(auto& receipt : block.transactions) {
+        if(receipt.status != transaction_receipt::executed) {
+            continue;
+        }
+
+        auto& trx = receipt.trx;
+        auto& actions = trx.get_transaction().actions;
+        for(auto i = 0u; i < actions.size(); i++) {
+            auto ctx = action_context { block, id, trx, actions[i], (uint16_t)i, irreversible };
+            for(auto& c : targets) {
+                if(matches(*c, ctx)) {
+                    send(c, payload_of(ctx, c->binary), c->binary);
+                }
+            }
+        }
+    }
+}
+
+bool
+event_stream_plugin_impl::matches(const client& c, action_context& ctx) {
+    auto& act = ctx.act;
+    if(!c.actions.empty() && c.actions.count(act.name) == 0) {
+        return false;
+    }
+    if(!c.domains.empty() && c.domains.count(act.domain) == 0) {
+        return false;
+    }
+    if(!c.keys.empty() && c.keys.count(act.key) == 0) {
+        return false;
+    }
+    if(c.addresses.empty()) {
+        return true;
+    }
+
+    // addresses are checked last, it needs the data to be decoded
+    if(!ctx.strings) {
+        ctx.strings.emplace();
+        internal::collect_strings(data_of(ctx), *ctx.strings);
+    }
+    for(auto& s : *ctx.strings) {
+        if(c.addresses.count(s)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const fc::variant&
+event_stream_plugin_impl::data_of(action_context& ctx) {
+    if(!ctx.data) {
+        try {
+            auto& exec_ctx = db_.get_execution_context();
+            ctx.data = db_.get_abi_serializer().binary_to_variant(exec_ctx.get_acttype_name(ctx.act.name), ctx.act.data, exec_ctx);
+        }
+        catch(...) {
+            // keeps the raw data if it cannot be decoded
+            ctx.data = fc::variant(ctx.act.data);
+        }
+    }
+    return *ctx.data;
+}
+
+const std::string&
+event_stream_plugin_impl::payload_of(action_context& ctx, bool binary) {
+    if(!ctx.trx_id) {
+        ctx.trx_id = ctx.trx.id();
+    }
+
+    if(binary) {
+        if(!ctx.binary) {
+            auto ev = action_event { ctx.block.block_num(), ctx.block_id, *ctx.trx_id, ctx.index, ctx.irreversible, ctx.act };
+            auto bv = fc::raw::pack(stream_event(std::move(ev)));
+            ctx.binary.emplace(bv.begin(), bv.end());
+        }
+        return *ctx.binary;
+    }
+
+    if(!ctx.json) {
+        auto act = fc::mutable_variant_object("name", ctx.act.name)("domain", ctx.act.domain)("key", ctx.act.key)("data", data_of(ctx));
+        auto vo  = fc::mutable_variant_object("type", "action")
+            ("block_num", ctx.block.block_num())
+            ("block_id", ctx.block_id)
+            ("trx_id", *ctx.trx_id)
+            ("action_index", ctx.index)
+            ("irreversible", ctx.irreversible)
+            ("act", std::move(act));
+        ctx.json.emplace(fc::json::to_string(vo));
+    }
+    return *ctx.json;
+}
+
+void
+event_stream_plugin_impl::send(const client_ptr& c, const std::string& payload, bool binary) {
+    if(c->closed) {
+        return;
+    }
+
+    auto ec  = websocketpp::lib::error_code();
+    auto con = server_.get_con_from_hdl(c->hdl, ec);
+    if(ec) {
+        return;
+    }
+
+    // slow clients are dropped instead of buffering without limit, they can resume from the last block received
+    if(con->get_buffered_amount() + payload.size() > max_buffer_size_) {
+        close(c, "Buffer overflow");
+        return;
+    }
+    con->send(payload, binary ? websocketpp::frame::opcode::binary : websocketpp::frame::opcode::text);
+}
+
+void
+event_stream_plugin_impl::close(const client_ptr& c, const std::string& reason) {
+    // reason of close frame is limited to 123 bytes
+    auto ec = websocketpp::lib::error_code();
+    server_.close(c->hdl, websocketpp::close::status::policy_violation, reason.substr(0, 120), ec);
+    on_close(c->hdl);
+}
+
+void
+event_stream_plugin_impl::init() {
+    auto& chain = app().get_plugin<chain_plugin>().chain();
+
+    accepted_block_connection_.emplace(chain.accepted_block.connect([&](const block_state_ptr& bs) {
+        applied_block(bs);
+    }));
+    irreversible_block_connection_.emplace(chain.irreversible_block.connect([&](const block_state_ptr& bs) {
+        applied_irreversible_block(bs);
+    }));
+}
+
+void
+event_stream_plugin_impl::start() {
+    // served on the main thread together with the signals of controller, so clients need no locks
+    server_.init_asio(&app().get_io_service());
+    server_.set_reuse_addr(true);
+    server_.set_max_message_size(64 * 1024);
+
+    server_.set_open_handler([this](auto hdl) { on_open(hdl); });
+    server_.set_close_handler([this](auto hdl) { on_close(hdl); });
+    server_.set_fail_handler([this](auto hdl) { on_close(hdl); });
+    server_.set_message_handler([this](auto hdl, auto msg) { on_message(hdl, msg); });
+
+    server_.listen(*listen_endpoint_);
+    server_.start_accept();
+}
+
+void
+event_stream_plugin_impl::shutdown() {
+    accepted_block_connection_.reset();
+    irreversible_block_connection_.reset();
+
+    if(server_.is_listening()) {
+        server_.stop_listening();
+    }
+    for(auto& it : clients_) {
+        auto ec = websocketpp::lib::error_code();
+        if(it.second->timer) {
+            it.second->timer->cancel();
+        }
+        server_.close(it.first, websocketpp::close::status::going_away, "Shutdown", ec);
+    }
+    clients_.clear();
+}
+
+event_stream_plugin::event_stream_plugin() {}
+event_stream_plugin::~event_stream_plugin() {}
+
+void
+event_stream_plugin::set_program_options(options_description&, options_description& cfg) {
+    cfg.add_options()
+        ("event-stream-address", bpo::value<std::string>()->default_value("127.0.0.1:8900"), "The local IP and port to listen for incoming websocket connections of event streaming.")
+        ("event-stream-max-clients", bpo::value<uint32_t>()->default_value(100), "Max number of clients connected at the same time.")
+        ("event-stream-max-buffer-kb", bpo::value<uint32_t>()->default_value(8 * 1024), "Max size of events buffered for one client in KB, clients exceeding it are disconnected.")
+        ("event-stream-max-resume-blocks", bpo::value<uint32_t>()->default_value(100000), "Max number of blocks before head the clients can resume from, 0 for no limit.")
+    ;
+}
+
+void
+event_stream_plugin::plugin_initialize(const variables_map& options) {
+    try {
+        my_ = std::make_shared<event_stream_plugin_impl>(app().get_plugin<chain_plugin>().chain());
+        my_->max_clients_       = options.at("event-stream-max-clients").as<uint32_t>();
+        my_->max_buffer_size_   = (size_t)options.at("event-stream-max-buffer-kb").as<uint32_t>() * 1024;
+        my_->max_resume_blocks_ = options.at("event-stream-max-resume-blocks").as<uint32_t>();
+
+        auto lipstr = options.at("event-stream-address").as<std::string>();
+        auto host   = lipstr.substr(0, lipstr.find(':'));
+        EVT_ASSERT(host.size() < lipstr.size(), chain::plugin_config_exception, "Invalid event-stream-address: ${a}", ("a",lipstr));
+        auto port = lipstr.substr(host.size() + 1);
+
+        auto resolver = tcp::resolver(app().get_io_service());
+        auto query    = tcp::resolver::query(tcp::v4(), host.c_str(), port.c_str());
+        my_->listen_endpoint_ = *resolver.resolve(query);
+        ilog("configured event stream to listen on ${h}:${p}", ("h",host)("p",port));
+
+        my_->init();
+    }
+    FC_LOG_AND_RETHROW()
+}
+
+void
+event_stream_plugin::plugin_startup() {
+    ilog("starting event_stream_plugin");
+    my_->start();
+}
+
+void
+event_stream_plugin::plugin_shutdown() {
+    if(my_) {
+        my_->shutdown();
+        my_.reset();
+    }
+}
+
+}  // namespace evt
@@ -0,0 +1,68 @@
+/**
+ *  @file
+ *  @copyright defined in evt/LICENSE.txt
+ */
+#pragma once
+
+#include <evt/chain_plugin/chain_plugin.hpp>
+#include <evt/chain/action.hpp>
+#include <evt/chain/types.hpp>
+
+#include <appbase/application.hpp>
+
+namespace evt {
+
+using namespace appbase;
+
+namespace event_stream {
+
+using chain::action;
+using chain::block_id_type;
+using chain::transaction_id_type;
+
+// Events pushed to the clients, in binary encoding each websocket message is one packed `stream_event`
+struct action_event {
+    uint32_t            block_num;
+    block_id_type       block_id;
+    transaction_id_type trx_id;
+    uint16_t            action_index;
+    bool                irreversible;  // block is already irreversible when the event is sent
+    action              act;
+};
+
+struct irreversible_event {
+    uint32_t      block_num;
+    block_id_type block_id;
+};
+
+using stream_event = fc::static_variant<action_event, irreversible_event>;
+
+}  // namespace event_stream
+
+// Pushes actions of accepted blocks to websocket clients.
+// Each client sends one subscribe message in json after connected:
+//   { "domains": [], "keys": [], "actions": [], "addresses": [],
+//     "encoding": "json" | "binary", "start_block": 1, "irreversible_only": false }
+// Empty filter matches any, values in one filter are OR-ed and filters are AND-ed.
+// Actions of blocks from `start_block` are sent first and then the ones of new blocks.
+class event_stream_plugin : public plugin<event_stream_plugin> {
+public:
+    APPBASE_PLUGIN_REQUIRES((chain_plugin))
+
+    event_stream_plugin();
+    virtual ~event_stream_plugin();
+
+    virtual void set_program_options(options_description&, options_description&) override;
+
+    void plugin_initialize(const variables_map&);
+    void plugin_startup();
+    void plugin_shutdown();
+
+private:
+    std::shared_ptr<class event_stream_plugin_impl> my_;
+};
+
+}  // namespace evt
+
+FC_REFLECT(evt::event_stream::action_event, (block_num)(block_id)(trx_id)(action_index)(irreversible)(act));
+FC_REFLECT(evt::event_stream::irreversible_event, (block_num)(block_id));
@@ -9,9 +9,12 @@
 #include <chrono>
 #include <unordered_map>
 #include <thread>
+#include <vector>
+#include <string_view>
 
 #include <boost/asio.hpp>
 #include <fc/io/json.hpp>
+#include <fc/io/raw.hpp>
 #include <fc/crypto/city.hpp>
 
 #include <evt/chain_plugin/chain_plugin.hpp>
@@ -27,13 +30,13 @@ static appbase::abstract_plugin& _evt_link_plugin = app().register_plugin<evt_li
 
 using evt::chain::bytes;
 using evt::chain::link_id_type;
+using evt::chain::block_id_type;
 using evt::chain::block_state_ptr;
+using evt::chain::transaction_id_type;
 using evt::chain::transaction_trace_ptr;
 using evt::chain::contracts::evt_link;
-using evt::chain::contracts::everipay;
 
 using boost::asio::steady_timer;
-using steady_timer_ptr = std::shared_ptr<steady_timer>;
 
 struct evt_link_id_hasher {
     size_t
@@ -44,8 +47,20 @@ struct evt_link_id_hasher {
 
 class evt_link_plugin_impl : public std::enable_shared_from_this<evt_link_plugin_impl> {
 public:
-    using deferred_pair = std::pair<deferred_id, steady_timer_ptr>;
-    enum { kDeferredId = 0, kTimer };
+    // waiting requests expire on a timing wheel, one timer ticks over the slots
+    // instead of one timer for each request
+    struct waiter {
+        link_id_type link_id;
+        deferred_id  id;
+    };
+    enum { kTickMs = 50 };
+
+    // recently packed link ids, so polling clients don't hit token database
+    struct recent_link {
+        uint32_t            block_num;
+        block_id_type       block_id;
+        transaction_id_type trx_id;
+    };
 
 public:
     evt_link_plugin_impl(controller& db)
@@ -63,20 +78,86 @@ private:
     template<typename T>
     void response(const link_id_type& link_id, T&& response_fun);
 
+    void schedule_tick();
+    void on_tick();
+    void expire(const std::vector<waiter>& waiters);
+
+    void add_recent_link(const link_id_type& link_id, recent_link&& link);
+    bool respond_from_recent_links(const link_id_type& link_id, deferred_id id);
+
 public:
     controller& db_;
 
     std::atomic_bool init_{false};
     uint32_t         timeout_;
 
-    std::unordered_multimap<link_id_type, deferred_pair, evt_link_id_hasher> link_ids_;
+    std::unordered_multimap<link_id_type, deferred_id, evt_link_id_hasher> link_ids_;
+
+    std::vector<std::vector<waiter>> wheel_;
+    size_t                           wheel_pos_ = 0;
+    std::optional<steady_timer>      wheel_timer_;
+    steady_timer::time_point         next_tick_;
+    bool                             ticking_ = false;
+
+    std::unordered_map<link_id_type, recent_link, evt_link_id_hasher> recent_links_;
+    std::deque<link_id_type>                                          recent_links_order_;
+    uint32_t                                                          recent_links_size_;
 
     std::optional<boost::signals2::scoped_connection> accepted_block_connection_;
 };
 
+namespace internal {
+
+// reads the link id from packed everipay action without unpacking the whole action,
+// both everipay and everipay_v2 start with the link
+bool
+peek_link_id(const bytes& data, link_id_type& link_id) {
+    auto ds     = fc::datastream<char*>((char*)data.data(), data.size());
+    auto header = uint16_t();
+    auto size   = fc::unsigned_int();
+    fc::raw::unpack(ds, header);
+    fc::raw::unpack(ds, size);
+
+    for(auto i = 0u; i < size.value; i++) {
+        auto key  = uint8_t();
+        auto skey = uint8_t();
+        auto has  = false;
+        auto strv = std::string_view();
+
+        fc::raw::unpack(ds, key);
+        fc::raw::unpack(ds, skey);
+        fc::raw::unpack(ds, has);
+        if(has) {
+            auto intv = uint32_t();
+            fc::raw::unpack(ds, intv);
+        }
+        fc::raw::unpack(ds, has);
+        if(has) {
+            fc::raw::unpack_view(ds, strv);
+        }
+
+        if(key == evt_link::link_id) {
+            if(strv.size() != sizeof(link_id)) {
+                return false;
+            }
+            memcpy(&link_id, strv.data(), sizeof(link_id));
+            return true;
+        }
+        if(key > evt_link::link_id) {
+            // segments are sorted by keys
+            return false;
+        }
+    }
+    return false;
+}
+
+}  // namespace internal
+
 void
 evt_link_plugin_impl::applied_block(const block_state_ptr& bs) {
-    if(link_ids_.empty()) {
+    using namespace internal;
+
+    if(link_ids_.empty() && recent_links_size_ == 0) {
         return;
     }
 
@@ -86,9 +167,18 @@ evt_link_plugin_impl::applied_block(const block_state_ptr& bs) {
                 continue;
             }
 
-            auto& epact = act.data_as<const everipay&>();
+            // only unpack the link id and skip the ones no one is waiting for
+            auto link_id = link_id_type();
+            if(!peek_link_id(act.data, link_id)) {
+                continue;
+            }
+            add_recent_link(link_id, recent_link { bs->block_num, bs->id, trx->id });
+
+            if(link_ids_.count(link_id) == 0) {
+                continue;
+            }
 
-            response(epact.link.get_link_id(), [&] {
+            response(link_id, [&] {
                 auto vo         = fc::mutable_variant_object();
                 vo["block_num"] = bs->block_num;
                 vo["block_id"]  = bs->id;
@@ -118,9 +208,10 @@ evt_link_plugin_impl::response(const link_id_type& link_id, T&& response_fun) {
         auto pair = self->link_ids_.equal_range(link_id);
         if(pair.first != self->link_ids_.end()) {
             std::for_each(pair.first, pair.second, [&](auto& it) {
-                app().get_plugin<http_plugin>().set_deferred_response(std::get<kDeferredId>(it.second), 200, json);
+                app().get_plugin<http_plugin>().set_deferred_response(it.second, 200, json);
             });
 
+            // entries left in the wheel are skipped when they expire
             self->link_ids_.erase(link_id);
             return;
         }
@@ -129,70 +220,153 @@ evt_link_plugin_impl::response(const link_id_type& link_id, T&& response_fun) {
 
 void
 evt_link_plugin_impl::add_and_schedule(const link_id_type& link_id, deferred_id id) {
-    auto it = link_ids_.emplace(link_id, std::make_pair(id, std::make_shared<steady_timer>(app().get_io_service())));
+    link_ids_.emplace(link_id, id);
+
+    // one more tick because the current one is partly passed, so requests never expire early
+    auto ticks = wheel_.size() - 1;
+    wheel_[(wheel_pos_ + ticks) % wheel_.size()].emplace_back(waiter { link_id, id });
+
+    if(!ticking_) {
+        ticking_   = true;
+        next_tick_ = steady_timer::clock_type::now();
+        schedule_tick();
+    }
+}
+
+void
+evt_link_plugin_impl::schedule_tick() {
+    next_tick_ += std::chrono::milliseconds(kTickMs);
+    wheel_timer_->expires_at(next_tick_);
 
-    auto timer = std::get<kTimer>(it->second);
-    timer->expires_from_now(std::chrono::milliseconds(timeout_));
-    
     auto wptr = std::weak_ptr<evt_link_plugin_impl>(shared_from_this());
-    timer->async_wait([wptr, link_id](auto& ec) {
+    wheel_timer_->async_wait([wptr](auto& ec) {
         auto self = wptr.lock();
         if(self && ec != boost::asio::error::operation_aborted) {
-            auto pair = self->link_ids_.equal_range(link_id);
-            if(pair.first == self->link_ids_.end()) {
-                wlog("Cannot find context for id: ${id}", ("id",link_id));
-                return;
-            }
-            
-            auto ids = std::vector<deferred_id>();
-            std::for_each(pair.first, pair.second, [&ids](auto& it) {
-                ids.emplace_back(std::get<kDeferredId>(it.second));
-            });
+            self->on_tick();
+        }
+    });
+}
 
-            self->link_ids_.erase(link_id);
+void
+evt_link_plugin_impl::on_tick() {
+    wheel_pos_ = (wheel_pos_ + 1) % wheel_.size();
 
-            try {
-                EVT_THROW(chain::exceed_evt_link_watch_time_exception, "Exceed EVT-Link watch time: ${time} ms", ("time",self->timeout_));
-            }
-            catch(...) {
-                http_plugin::handle_exception("evt_link", "get_trx_id_for_link_id", "", [&ids](auto code, auto body) {
-                    for(auto id : ids) {
-                        app().get_plugin<http_plugin>().set_deferred_response(id, code, body);
-                    }
-                });
-            }
+    auto waiters = std::vector<waiter>();
+    waiters.swap(wheel_[wheel_pos_]);
+    expire(waiters);
+
+    if(link_ids_.empty()) {
+        // nothing is waiting, the rest in wheel are all responded already
+        for(auto& slot : wheel_) {
+            slot.clear();
         }
-    });
+        ticking_ = false;
+        return;
+    }
+    schedule_tick();
 }
 
 void
-evt_link_plugin_impl::get_trx_id_for_link_id(const link_id_type& link_id, deferred_id id) {
-    // try to fetch from chain first
-    try {
-        auto obj = db_.get_link_obj_for_link_id(link_id);
-        if(obj.block_num > db_.fork_db_head_block_num()) {
-            // block not finalize yet
-            add_and_schedule(link_id, id);
-            return;
+evt_link_plugin_impl::expire(const std::vector<waiter>& waiters) {
+    auto ids = std::vector<deferred_id>();
+    for(auto& w : waiters) {
+        auto pair = link_ids_.equal_range(w.link_id);
+        auto it   = std::find_if(pair.first, pair.second, [&w](auto& it) { return it.second == w.id; });
+        if(it == pair.second) {
+            // already responded
+            continue;
         }
+        ids.emplace_back(w.id);
+        link_ids_.erase(it);
+    }
+
+    if(ids.empty()) {
+        return;
+    }
+
+    try {
+        EVT_THROW(chain::exceed_evt_link_watch_time_exception, "Exceed EVT-Link watch time: ${time} ms", ("time",timeout_));
+    }
+    catch(...) {
+        http_plugin::handle_exception("evt_link", "get_trx_id_for_link_id", "", [&ids](auto code, auto body) {
+            for(auto id : ids) {
+                app().get_plugin<http_plugin>().set_deferred_response(id, code, body);
+            }
+        });
+    }
+}
+
+void
+evt_link_plugin_impl::add_recent_link(const link_id_type& link_id, recent_link&& link) {
+    if(recent_links_size_ == 0) {
+        return;
+    }
 
-        auto vo         = fc::mutable_variant_object();
-        vo["block_num"] = obj.block_num;
-        vo["block_id"]  = db_.get_block_id_for_num(obj.block_num);
-        vo["trx_id"]    = obj.trx_id;
+    // link may be packed again in another block after fork switched
+    auto r = recent_links_.insert_or_assign(link_id, std::move(link));
+    if(!r.second) {
+        return;
+    }
+
+    recent_links_order_.emplace_back(link_id);
+    if(recent_links_order_.size() > recent_links_size_) {
+        recent_links_.erase(recent_links_order_.front());
+        recent_links_order_.pop_front();
+    }
+}
+
+bool
+evt_link_plugin_impl::respond_from_recent_links(const link_id_type& link_id, deferred_id id) {
+    auto it = recent_links_.find(link_id);
+    if(it == recent_links_.end()) {
+        return false;
+    }
+
+    auto& link = it->second;
+    if(link.block_num > db_.fork_db_head_block_num() || db_.get_block_id_for_num(link.block_num) != link.block_id) {
+        // block is switched out, let token database decide
+        return false;
+    }
+
+    auto vo         = fc::mutable_variant_object();
+    vo["block_num"] = link.block_num;
+    vo["block_id"]  = link.block_id;
+    vo["trx_id"]    = link.trx_id;
 
-        app().get_plugin<http_plugin>().set_deferred_response(id, 200, fc::json::to_string(vo));
+    app().get_plugin<http_plugin>().set_deferred_response(id, 200, fc::json::to_string(vo));
+    return true;
+}
+
+void
+evt_link_plugin_impl::get_trx_id_for_link_id(const link_id_type& link_id, deferred_id id) {
+    if(respond_from_recent_links(link_id, id)) {
+        return;
     }
-    catch(const chain::evt_link_existed_exception&) {
-        // cannot find now, put into map
+
+    // try to fetch from chain then
+    auto obj = db_.find_link_obj_for_link_id(link_id);
+    if(!obj.has_value() || obj->block_num > db_.fork_db_head_block_num()) {
+        // cannot find now or block not finalize yet, put into map
         add_and_schedule(link_id, id);
+        return;
     }
+
+    auto vo         = fc::mutable_variant_object();
+    vo["block_num"] = obj->block_num;
+    vo["block_id"]  = db_.get_block_id_for_num(obj->block_num);
+    vo["trx_id"]    = obj->trx_id;
+
+    app().get_plugin<http_plugin>().set_deferred_response(id, 200, fc::json::to_string(vo));
 }
 
 void
 evt_link_plugin_impl::init() {
     init_ = true;
 
+    // slots cover the timeout plus the tick in progress
+    wheel_.resize((timeout_ + kTickMs - 1) / kTickMs + 2);
+    wheel_timer_.emplace(app().get_io_service());
+
     auto& chain_plug = app().get_plugin<chain_plugin>();
     auto& chain      = chain_plug.chain();
 
@@ -210,13 +384,15 @@ void
 evt_link_plugin::set_program_options(options_description&, options_description& cfg) {
     cfg.add_options()
         ("evt-link-timeout", bpo::value<uint32_t>()->default_value(5000), "Max time waitting for the deferred request.")
+        ("evt-link-recent-size", bpo::value<uint32_t>()->default_value(100000), "Max number of recently packed link ids kept in memory, 0 to disable.")
     ;
 }
 
 void
 evt_link_plugin::plugin_initialize(const variables_map& options) {
     my_ = std::make_shared<evt_link_plugin_impl>(app().get_plugin<chain_plugin>().chain());
-    my_->timeout_ = options.at("evt-link-timeout").as<uint32_t>();
+    my_->timeout_           = options.at("evt-link-timeout").as<uint32_t>();
+    my_->recent_links_size_ = options.at("evt-link-recent-size").as<uint32_t>();
     my_->init();
 }
 
@@ -12,6 +12,7 @@
 #include <evt/chain/types.hpp>
 #include <evt/chain/asset.hpp>
 #include <evt/chain/address.hpp>
+#include <evt/chain/block_state.hpp>
 #include <evt/chain/controller.hpp>
 #include <evt/chain/token_database.hpp>
 #include <evt/chain/token_database_cache.hpp>
@@ -23,16 +24,113 @@ static appbase::abstract_plugin& _evt_plugin = app().register_plugin<evt_plugin>
 
 using namespace evt;
 using namespace evt::chain;
+using evt_apis::read_state;
+
+// reads tokens in the state requested, pending one is read from token database along with its cache
+// and the others from the view of token database made for that state
+class state_reader {
+public:
+    state_reader(controller& db, read_state state, token_database_read_view_ptr view, uint32_t block_num)
+        : db_(db), state_(state), view_(std::move(view)), block_num_(block_num) {}
+
+public:
+    template<typename T>
+    std::shared_ptr<const T>
+    read_token(token_type type, const std::optional<name128>& domain, const name128& key, bool no_throw = false) const {
+        if(!view_) {
+            auto ptr = db_.token_db_cache().template read_token<T>(type, domain, key, no_throw);
+            if(ptr == nullptr) {
+                return nullptr;
+            }
+            return std::shared_ptr<const T>(std::move(ptr));
+        }
+
+        auto str = std::string();
+        if(!view_->read_token(type, domain, key, str, no_throw)) {
+            return nullptr;
+        }
+        auto ptr = std::make_shared<T>();
+        extract_db_value(str, *ptr);
+        return ptr;
+    }
+
+    int
+    read_asset(const address& addr, const symbol_id_type sym_id, std::string& out, bool no_throw = false) const {
+        if(!view_) {
+            return db_.token_db().read_asset(addr, sym_id, out, no_throw);
+        }
+        return view_->read_asset(addr, sym_id, out, no_throw);
+    }
+
+    template<typename Cursor>
+    int
+    read_tokens_range(token_type type, const std::optional<name128>& domain, const Cursor& cursor, const read_value_func& func) const {
+        if(!view_) {
+            return db_.token_db().read_tokens_range(type, domain, cursor, func);
+        }
+        return view_->read_tokens_range(type, domain, cursor, func);
+    }
+
+    bool       is_live() const { return !view_; }
+    read_state state() const { return state_; }
+    uint32_t   block_num() const { return block_num_; }
+
+private:
+    controller&                  db_;
+    read_state                   state_;
+    token_database_read_view_ptr view_;
+    uint32_t                     block_num_;
+};
 
 class evt_plugin_impl {
 public:
     evt_plugin_impl(controller& db)
         : db_(db) {}
 
+public:
+    state_reader get_reader(const std::optional<read_state>& state);
+
+private:
+    token_database_read_view_ptr get_view(token_database_read_view_ptr& view, block_id_type& view_id, const block_id_type& id, uint32_t num);
+
 public:
     controller& db_;
+
+    // views are made lazily once head or irreversible block is changed and shared by the requests after
+    token_database_read_view_ptr head_view_;
+    block_id_type                head_view_id_;
+    token_database_read_view_ptr irreversible_view_;
+    block_id_type                irreversible_view_id_;
 };
 
+token_database_read_view_ptr
+evt_plugin_impl::get_view(token_database_read_view_ptr& view, block_id_type& view_id, const block_id_type& id, uint32_t num) {
+    if(!view || view_id != id) {
+        view    = db_.token_db().create_read_view(num);
+        view_id = id;
+    }
+    return view;
+}
+
+state_reader
+evt_plugin_impl::get_reader(const std::optional<read_state>& state) {
+    switch(state.value_or(read_state::pending)) {
+    case read_state::head: {
+        auto num = db_.head_block_num();
+        return state_reader(db_, read_state::head, get_view(head_view_, head_view_id_, db_.head_block_id(), num), num);
+    }
+    case read_state::irreversible: {
+        auto num = db_.last_irreversible_block_num();
+        return state_reader(db_, read_state::irreversible,
+            get_view(irreversible_view_, irreversible_view_id_, db_.last_irreversible_block_id(), num), num);
+    }
+    default: {
+        auto pbs = db_.pending_block_state();
+        return state_reader(db_, read_state::pending, nullptr, pbs ? pbs->block_num : db_.head_block_num());
+    }
+    }  // switch
+}
+
 evt_plugin::evt_plugin() {}
 evt_plugin::~evt_plugin() {}
 
@@ -45,11 +143,18 @@ evt_plugin::plugin_startup() {
     this->my_.reset(new evt_plugin_impl(app().get_plugin<chain_plugin>().chain()));
 }
 
-void evt_plugin::plugin_shutdown() {}
+void
+evt_plugin::plugin_shutdown() {
+    // views should be released before token database is closed
+    if(my_) {
+        my_->head_view_.reset();
+        my_->irreversible_view_.reset();
+    }
+}
 
 evt_apis::read_only
 evt_plugin::get_read_only_api() const {
-    return evt_apis::read_only(my_->db_);
+    return evt_apis::read_only(my_->db_, *my_);
 }
 
 evt_apis::read_write
@@ -59,13 +164,13 @@ evt_plugin::get_read_write_api() {
 
 namespace evt_apis {
 
-#define READ_DB_TOKEN(TYPE, PREFIX, KEY, VPTR, EXCEPTION, FORMAT, ...)      \
-    try {                                                                   \
-        using vtype = typename decltype(VPTR)::element_type;                \
-        VPTR = tokendb_cache.template read_token<vtype>(TYPE, PREFIX, KEY); \
-    }                                                                       \
-    catch(token_database_exception&) {                                      \
-        EVT_THROW2(EXCEPTION, FORMAT, __VA_ARGS__);                         \
+#define READ_DB_TOKEN(TYPE, PREFIX, KEY, VPTR, EXCEPTION, FORMAT, ...)                   \
+    try {                                                                                \
+        using vtype = std::remove_const_t<typename decltype(VPTR)::element_type>;        \
+        VPTR = reader.template read_token<vtype>(TYPE, PREFIX, KEY);                     \
+    }                                                                                    \
+    catch(token_database_exception&) {                                                   \
+        EVT_THROW2(EXCEPTION, FORMAT, __VA_ARGS__);                                      \
     }
     
 #define MAKE_PROPERTY(AMOUNT, SYM) \
@@ -79,7 +184,7 @@ namespace evt_apis {
 #define READ_DB_ASSET(ADDR, SYM, VALUEREF)                                                         \
     try {                                                                                          \
         auto str = std::string();                                                                  \
-        tokendb.read_asset(ADDR, SYM.id(), str);                                                   \
+        reader.read_asset(ADDR, SYM.id(), str);                                                    \
                                                                                                    \
         extract_db_value(str, VALUEREF);                                                           \
     }                                                                                              \
@@ -90,7 +195,7 @@ namespace evt_apis {
 #define READ_DB_ASSET_NO_THROW(ADDR, SYM, VALUEREF)                         \
     {                                                                       \
         auto str = std::string();                                           \
-        if(!tokendb.read_asset(ADDR, SYM.id(), str, true /* no throw */)) { \
+        if(!reader.read_asset(ADDR, SYM.id(), str, true /* no throw */)) {  \
             VALUEREF = MAKE_PROPERTY(0, SYM);                               \
         }                                                                   \
         else {                                                              \
@@ -98,9 +203,8 @@ namespace evt_apis {
         }                                                                   \
     }
 
-#define DECLARE_TOKEN_DB()                     \
-    auto& tokendb = db_.token_db();            \
-    auto& tokendb_cache = db_.token_db_cache();
+#define DECLARE_STATE_READER() \
+    auto reader = my_.get_reader(params.state);
 
 enum psvbonus_type { kPsvBonus = 0, kPsvBonusSlim };
 
@@ -111,48 +215,71 @@ get_psvbonus_db_key(symbol_id_type id, uint64_t nonce) {
     return v;
 }
 
+// metas are stored apart from their owners, merges them back into the result
+fc::variant
+with_metas(const state_reader& reader, const name128& domain, const name128& key, fc::variant&& var) {
+    auto metas = fc::variant();
+    auto ms    = reader.read_token<meta_set>(token_type::meta, std::nullopt, get_meta_db_key(domain, key), true /* no throw */);
+    fc::to_variant(ms != nullptr ? ms->metas : meta_list(), metas);
+
+    auto mvar = fc::mutable_variant_object(var);
+    mvar.erase("flags");
+    mvar["metas"] = std::move(metas);
+    return mvar;
+}
+
+// results keep the old shape unless state is requested explicitly
+template<typename T>
+fc::variant
+with_state(const T& params, const state_reader& reader, fc::variant&& var) {
+    if(!params.state.has_value()) {
+        return std::move(var);
+    }
+    return fc::mutable_variant_object("state", reader.state())("block_num", reader.block_num())("result", std::move(var));
+}
+
 fc::variant
 read_only::get_domain(const read_only::get_domain_params& params) {
-    DECLARE_TOKEN_DB();
+    DECLARE_STATE_READER();
 
     auto var    = variant();
-    auto domain = make_empty_cache_ptr<domain_def>();
+    auto domain = std::shared_ptr<const domain_def>();
     READ_DB_TOKEN(token_type::domain, std::nullopt, params.name, domain, unknown_domain_exception, "Cannot find domain: {}", params.name);
 
     fc::to_variant(*domain, var);
 
-    auto mvar = fc::mutable_variant_object(var);
+    auto mvar = fc::mutable_variant_object(with_metas(reader, params.name, N128(.meta), std::move(var)));
     mvar["address"] = address(N(.domain), params.name, 0);
-    return mvar;
+    return with_state(params, reader, std::move(mvar));
 }
 
 fc::variant
 read_only::get_group(const read_only::get_group_params& params) {
-    DECLARE_TOKEN_DB();
+    DECLARE_STATE_READER();
 
     auto var   = variant();
-    auto group = make_empty_cache_ptr<group_def>();
+    auto group = std::shared_ptr<const group_def>();
     READ_DB_TOKEN(token_type::group, std::nullopt, params.name, group, unknown_group_exception, "Cannot find group: {}", params.name);
 
     fc::to_variant(*group, var);
-    return var;
+    return with_state(params, reader, std::move(var));
 }
 
 fc::variant
 read_only::get_token(const read_only::get_token_params& params) {
-    DECLARE_TOKEN_DB();
+    DECLARE_STATE_READER();
 
     auto var   = variant();
-    auto token = make_empty_cache_ptr<token_def>();
+    auto token = std::shared_ptr<const token_def>();
     READ_DB_TOKEN(token_type::token, params.domain, params.name, token, unknown_token_exception, "Cannot find token: {} in {}", params.name, params.domain);
 
     fc::to_variant(*token, var);
-    return var;
+    return with_state(params, reader, with_metas(reader, params.domain, params.name, std::move(var)));
 }
 
 fc::variant
 read_only::get_tokens(const get_tokens_params& params) {
-    DECLARE_TOKEN_DB();
+    DECLARE_STATE_READER();
 
     auto vars = fc::variants();
     int s = 0, t = 10;
@@ -165,35 +292,74 @@ read_only::get_tokens(const get_tokens_params& params) {
     }
 
     int i = 0;
-    tokendb.read_tokens_range(token_type::token, params.domain, s, [&](auto& key, auto&& value) {
+    auto fn = [&](auto& key, auto&& value) {
         auto var = fc::variant();
 
         token_def token;
         extract_db_value(value, token);
 
         fc::to_variant(token, var);
-        vars.emplace_back(std::move(var));
+        vars.emplace_back(with_metas(reader, token.domain, token.name, std::move(var)));
 
         if(++i == t) {
             return false;
         }
         return true;
+    };
+
+    if(params.start.has_value()) {
+        // seek to the cursor directly instead of skipping
+        reader.read_tokens_range(token_type::token, params.domain, params.start, fn);
+    }
+    else {
+        reader.read_tokens_range(token_type::token, params.domain, s, fn);
+    }
+
+    return with_state(params, reader, std::move(vars));
+}
+
+fc::variant
+read_only::get_owned_tokens(const get_owned_tokens_params& params) {
+    // owner index is kept for the latest state only
+    EVT_ASSERT(params.state.value_or(read_state::pending) == read_state::pending, unsupported_feature,
+        "Tokens of owner can only be read in pending state");
+    DECLARE_STATE_READER();
+
+    auto t = 10;
+    if(params.take.has_value()) {
+        t = *params.take;
+        EVT_ASSERT(t <= 100, chain::exceed_query_limit_exception, "Exceed limit of max actions return allowed for each query, limit: 100 per query");
+    }
+
+    auto keys = std::vector<std::pair<domain_name, token_name>>();
+    db_.token_db().read_tokens_by_owner(params.owner, params.domain, [&](auto& domain, auto& name) {
+        keys.emplace_back(domain, name);
+        return (int)keys.size() < t;
     });
 
-    return vars;
+    auto vars = fc::variants();
+    for(auto& k : keys) {
+        auto var   = fc::variant();
+        auto token = std::shared_ptr<const token_def>();
+        READ_DB_TOKEN(token_type::token, k.first, k.second, token, unknown_token_exception, "Cannot find token: {} in {}", k.second, k.first);
+
+        fc::to_variant(*token, var);
+        vars.emplace_back(with_metas(reader, k.first, k.second, std::move(var)));
+    }
+    return with_state(params, reader, std::move(vars));
 }
 
 fc::variant
 read_only::get_fungible(const get_fungible_params& params) {
-    DECLARE_TOKEN_DB();
+    DECLARE_STATE_READER();
 
     auto var      = variant();
-    auto fungible = make_empty_cache_ptr<fungible_def>();
+    auto fungible = std::shared_ptr<const fungible_def>();
     READ_DB_TOKEN(token_type::fungible, std::nullopt, params.id, fungible, unknown_fungible_exception, "Cannot find fungible with sym id: {}", params.id);
 
     fc::to_variant(*fungible, var);
 
-    auto mvar = fc::mutable_variant_object(var);
+    auto mvar = fc::mutable_variant_object(with_metas(reader, N128(.fungible), name128::from_number(params.id), std::move(var)));
     auto addr = address(N(.fungible), name128::from_number(params.id), 0);
 
     property prop;
@@ -201,16 +367,16 @@ read_only::get_fungible(const get_fungible_params& params) {
 
     mvar["current_supply"] = fungible->total_supply - asset(prop.amount, fungible->sym);
     mvar["address"]        = addr;
-    return mvar;
+    return with_state(params, reader, std::move(mvar));
 }
 
 fc::variant
 read_only::get_fungible_balance(const get_fungible_balance_params& params) {
-    DECLARE_TOKEN_DB();
+    DECLARE_STATE_READER();
 
     auto vars = variants();
     if(params.sym_id.has_value()) {
-        auto fungible = make_empty_cache_ptr<fungible_def>();
+        auto fungible = std::shared_ptr<const fungible_def>();
         READ_DB_TOKEN(token_type::fungible, std::nullopt, *params.sym_id, fungible,
             unknown_fungible_exception, "Cannot find fungible with sym id: {}", *params.sym_id);
 
@@ -222,16 +388,43 @@ read_only::get_fungible_balance(const get_fungible_balance_params& params) {
         fc::to_variant(as, var);
 
         vars.emplace_back(std::move(var));
-        return vars;
+        return with_state(params, reader, std::move(vars));
+    }
+
+    // asset index is kept for the latest state only, same as owner index
+    // and it's only available when token-db-owner-index is set, otherwise please refer to the history_plugin
+    EVT_ASSERT(params.state.value_or(read_state::pending) == read_state::pending, unsupported_feature,
+        "All the balance of fungibles within one address can only be read in pending state");
+
+    auto sym_ids = std::vector<symbol_id_type>();
+    db_.token_db().read_assets_by_address(params.address, [&](auto sym_id) {
+        sym_ids.emplace_back(sym_id);
+        return true;
+    });
+
+    for(auto sym_id : sym_ids) {
+        auto str = std::string();
+        if(!reader.read_asset(params.address, sym_id, str, true /* no throw */)) {
+            continue;
+        }
+
+        property prop;
+        extract_db_value(str, prop);
+
+        auto as  = asset(prop.amount, prop.sym);
+        auto var = variant();
+        fc::to_variant(as, var);
+
+        vars.emplace_back(std::move(var));
     }
-    EVT_THROW(unsupported_feature, "Read all the balance of fungibles tokens within one address is not supported in evt_plugin anymore, please refer to the history_plugin");
+    return with_state(params, reader, std::move(vars));
 }
 
 fc::variant
 read_only::get_fungible_psvbonus(const get_fungible_psvbonus_params& params) {
-    DECLARE_TOKEN_DB();
+    DECLARE_STATE_READER();
 
-    auto pb   = make_empty_cache_ptr<passive_bonus>();
+    auto pb   = std::shared_ptr<const passive_bonus>();
     auto dkey = get_psvbonus_db_key(params.id, kPsvBonus);
     READ_DB_TOKEN(token_type::psvbonus, std::nullopt, dkey, pb, unknown_bonus_exception,
         "Cannot find passive bonus registered for fungible token with sym id: {}.", params.id);
@@ -243,31 +436,49 @@ read_only::get_fungible_psvbonus(const get_fungible_psvbonus_params& params) {
     auto addr = address(N(.psvbonus), name128::from_number(params.id), 0);
     mvar["address"] = addr;
 
-    return mvar;
+    // aggregates of holders receiving bonus are kept for the latest state only
+    if(params.state.value_or(read_state::pending) == read_state::pending) {
+        auto holders = variants();
+        for(auto& rule : pb->rules) {
+            rule.visit([&](auto& r) {
+                if(r.receiver.type() != dist_receiver_type::ftholders) {
+                    return;
+                }
+                auto& sr  = r.receiver.template get<dist_stack_receiver>();
+                auto  agg = db_.token_db().read_asset_aggregate(sr.threshold.symbol_id(), sr.threshold.amount());
+                if(agg.has_value()) {
+                    holders.emplace_back(fc::mutable_variant_object("threshold", sr.threshold)("holders", agg->holders)("total", agg->total));
+                }
+            });
+        }
+        mvar["holders"] = std::move(holders);
+    }
+
+    return with_state(params, reader, std::move(mvar));
 }
 
 fc::variant
 read_only::get_suspend(const get_suspend_params& params) {
-    DECLARE_TOKEN_DB();
+    DECLARE_STATE_READER();
 
     auto var     = variant();
-    auto suspend = make_empty_cache_ptr<suspend_def>();
+    auto suspend = std::shared_ptr<const suspend_def>();
     READ_DB_TOKEN(token_type::suspend, std::nullopt, params.name, suspend, unknown_suspend_exception, "Cannot find suspend proposal: {}", params.name);
 
     db_.get_abi_serializer().to_variant(*suspend, var, db_.get_execution_context());
-    return var;
+    return with_state(params, reader, std::move(var));
 }
 
 fc::variant
 read_only::get_lock(const get_lock_params& params) {
-    DECLARE_TOKEN_DB();
+    DECLARE_STATE_READER();
 
     auto var  = variant();
-    auto lock = make_empty_cache_ptr<lock_def>();
+    auto lock = std::shared_ptr<const lock_def>();
     READ_DB_TOKEN(token_type::lock, std::nullopt, params.name, lock, unknown_lock_exception, "Cannot find lock proposal: {}", params.name);
 
     fc::to_variant(*lock, var);
-    return var;
+    return with_state(params, reader, std::move(var));
 }
 
 }  // namespace evt_apis
@@ -19,59 +19,87 @@ class controller;
 }  // namespace chain
 
 class evt_plugin;
+class evt_plugin_impl;
 
 namespace evt_apis {
 
 using namespace evt::chain;
 using namespace evt::chain::contracts;
 
+// state read by apis: pending one includes the transactions applied into pending block so far,
+// the others are read from the views of token database made when head or irreversible block is changed.
+// results are returned along with the block they reflect when state is set in params
+enum class read_state {
+    pending = 0,
+    head,
+    irreversible
+};
+
 class read_only {
 public:
-    read_only(const controller& db)
-        : db_(db) {}
+    read_only(const controller& db, evt_plugin_impl& my)
+        : db_(db), my_(my) {}
 
 public:
     struct get_domain_params {
-        domain_name name;
+        domain_name               name;
+        std::optional<read_state> state;
     };
     fc::variant get_domain(const get_domain_params& params);
 
     struct get_group_params {
-        group_name name;
+        group_name                name;
+        std::optional<read_state> state;
     };
     fc::variant get_group(const get_group_params& params);
 
     struct get_token_params {
-        domain_name domain;
-        token_name  name;
+        domain_name               domain;
+        token_name                name;
+        std::optional<read_state> state;
     };
     fc::variant get_token(const get_token_params& params);
 
     struct get_tokens_params {
-        domain_name        domain;
-        std::optional<int> skip;
-        std::optional<int> take;
+        domain_name                domain;
+        std::optional<int>         skip;
+        std::optional<int>         take;
+        std::optional<token_name>  start;  // resume from the token right after `start`, `skip` is ignored when provided
+        std::optional<read_state>  state;
     };
     fc::variant get_tokens(const get_tokens_params& params);
 
+    // owner index only has the pending state
+    struct get_owned_tokens_params {
+        address_type               owner;
+        std::optional<domain_name> domain;
+        std::optional<int>         take;
+        std::optional<read_state>  state;
+    };
+    fc::variant get_owned_tokens(const get_owned_tokens_params& params);
+
     struct get_fungible_params {
-        symbol_id_type id;
+        symbol_id_type            id;
+        std::optional<read_state> state;
     };
     fc::variant get_fungible(const get_fungible_params& params);
 
     struct get_fungible_balance_params {
         address_type                  address;
         std::optional<symbol_id_type> sym_id;
+        std::optional<read_state>     state;
     };
     fc::variant get_fungible_balance(const get_fungible_balance_params& params);
 
     struct get_fungible_psvbonus_params {
-        symbol_id_type id;
+        symbol_id_type            id;
+        std::optional<read_state> state;
     };
     fc::variant get_fungible_psvbonus(const get_fungible_psvbonus_params& params);
 
     struct get_suspend_params {
-        proposal_name name;
+        proposal_name             name;
+        std::optional<read_state> state;
     };
     fc::variant get_suspend(const get_suspend_params& params);
 
@@ -80,6 +108,7 @@ public:
 
 private:
     const controller& db_;
+    evt_plugin_impl&  my_;
 };
 
 class read_write {};
@@ -108,11 +137,13 @@ private:
 
 }  // namespace evt
 
-FC_REFLECT(evt::evt_apis::read_only::get_domain_params, (name));
-FC_REFLECT(evt::evt_apis::read_only::get_group_params, (name));
-FC_REFLECT(evt::evt_apis::read_only::get_token_params, (domain)(name));
-FC_REFLECT(evt::evt_apis::read_only::get_tokens_params, (domain)(skip)(take));
-FC_REFLECT(evt::evt_apis::read_only::get_fungible_params, (id));
-FC_REFLECT(evt::evt_apis::read_only::get_fungible_balance_params, (address)(sym_id));
-FC_REFLECT(evt::evt_apis::read_only::get_fungible_psvbonus_params, (id));
-FC_REFLECT(evt::evt_apis::read_only::get_suspend_params, (name));
+FC_REFLECT_ENUM(evt::evt_apis::read_state, (pending)(head)(irreversible));
+FC_REFLECT(evt::evt_apis::read_only::get_domain_params, (name)(state));
+FC_REFLECT(evt::evt_apis::read_only::get_group_params, (name)(state));
+FC_REFLECT(evt::evt_apis::read_only::get_token_params, (domain)(name)(state));
+FC_REFLECT(evt::evt_apis::read_only::get_tokens_params, (domain)(skip)(take)(start)(state));
+FC_REFLECT(evt::evt_apis::read_only::get_owned_tokens_params, (owner)(domain)(take)(state));
+FC_REFLECT(evt::evt_apis::read_only::get_fungible_params, (id)(state));
+FC_REFLECT(evt::evt_apis::read_only::get_fungible_balance_params, (address)(sym_id)(state));
+FC_REFLECT(evt::evt_apis::read_only::get_fungible_psvbonus_params, (id)(state));
+FC_REFLECT(evt::evt_apis::read_only::get_suspend_params, (name)(state));
@@ -50,7 +50,7 @@ history_api_plugin::plugin_initialize(const variables_map&) {}
 #define ASYNC_CALL(api_name, api_handle, api_namespace, call_name)                                                            \
     {                                                                                                                         \
         std::string("/v1/" #api_name "/" #call_name),                                                                         \
-            [api_handle](string, string body, int id) mutable {                                                               \
+            [api_handle](string, string body, deferred_id id) mutable {                                                       \
                 try {                                                                                                         \
                     if(body.empty())                                                                                          \
                         body = "{}";                                                                                          \
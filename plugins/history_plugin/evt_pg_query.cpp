@@ -6,6 +6,7 @@
 
 #pragma GCC diagnostic ignored "-Wunused-local-typedefs"
 
+#include <cstdio>
 #include <functional>
 #include <fmt/format.h>
 #include <libpq-fe.h>
@@ -67,7 +68,9 @@ enum task_type {
     kGetTransaction,
     kGetTransactions,
     kGetFungibleIds,
-    kGetTransactionActions
+    kGetTransactionActions,
+    kGetActionsPage,
+    kGetFungibleActionsPage
 };
 
 const char* call_names[] = {
@@ -81,23 +84,11 @@ const char* call_names[] = {
     "get_transaction",
     "get_transactions",
     "get_fungible_ids",
-    "get_transaction_actions"
+    "get_transaction_actions",
+    "get_actions",
+    "get_fungible_actions"
 };
 
-template<typename T>
-int
-response_ok(int id, const T& obj) {
-    app().get_plugin<http_plugin>().set_deferred_response(id, 200, fc::json::to_string(obj));
-    return PG_OK;
-}
-
-template<>
-int
-response_ok<std::string>(int id, const std::string& str) {
-    app().get_plugin<http_plugin>().set_deferred_response(id, 200, str);
-    return PG_OK;
-}
-
 // This function is used to fix the representation of timestamp returned by postgres
 // Use 'T' as the separate the date and time to follow the ISO 8601 standard
 char*
@@ -110,107 +101,275 @@ fix_pg_timestamp(char* str) {
     return str;
 }
 
+// rows of actions queries are rendered as json array
+void
+format_actions_to(fmt::memory_buffer& builder, pg_result const* r, int n) {
+    fmt::format_to(builder, "[");
+    for(int i = 0; i < n; i++) {
+        fmt::format_to(builder,
+            fmt(R"({{"trx_id":"{}","name":"{}","domain":"{}","key":"{}","data":{},"timestamp":"{}"}})"),
+            PQgetvalue(r, i, 0),
+            PQgetvalue(r, i, 1),
+            PQgetvalue(r, i, 2),
+            PQgetvalue(r, i, 3),
+            PQgetvalue(r, i, 4),
+            fix_pg_timestamp(PQgetvalue(r, i, 5))
+            );
+        if(i < n - 1) {
+            fmt::format_to(builder, ",");
+        }
+    }
+    fmt::format_to(builder, "]");
+}
+
+// actions are paginated by keyset of (block_num, trx_num, seq_num) instead of offset,
+// `filter` uses the first `nparams` parameters and the keyset and limit are the following ones
+std::string
+actions_page_plan(const char* filter, int nparams, bool asc) {
+    return fmt::format(R"sql(SELECT actions.trx_id, name, domain, key, data, transactions.timestamp, actions.block_num, actions.trx_num, actions.seq_num
+                             FROM actions
+                             JOIN transactions ON actions.trx_id = transactions.trx_id AND actions.block_num = transactions.block_num
+                             WHERE {0} AND (actions.block_num, actions.trx_num, actions.seq_num) {1} (${2}, ${3}, ${4})
+                             ORDER BY actions.block_num {5}, actions.trx_num {5}, actions.seq_num {5}
+                             LIMIT ${6}
+                             )sql",
+        filter, asc ? ">" : "<", nparams + 1, nparams + 2, nparams + 3, asc ? "ASC" : "DESC", nparams + 4);
+}
+
+// cursor is "block_num-trx_num-seq_num" of the last action in previous page
+struct action_cursor {
+    int block_num;
+    int trx_num;
+    int seq_num;
+};
+
+action_cursor
+parse_cursor(const std::string& str, bool asc) {
+    if(str.empty()) {
+        // first page
+        return asc ? action_cursor { -1, -1, -1 } : action_cursor { INT32_MAX, INT32_MAX, INT32_MAX };
+    }
+
+    auto c = action_cursor();
+    auto n = 0;
+    auto r = sscanf(str.c_str(), "%d-%d-%d%n", &c.block_num, &c.trx_num, &c.seq_num, &n);
+    EVT_ASSERT(r == 3 && n == (int)str.size(), chain::invalid_query_cursor_exception, "Invalid cursor: ${c}", ("c",str));
+    return c;
+}
+
 }  // namespace internal
 
 int
-pg_query::connect(const std::string& conn) {
-    conn_ = PQconnectdb(conn.c_str());
+pg_query::connect(const std::string& conn, int num) {
+    for(auto i = 0; i < std::max(num, 1); i++) {
+        auto c  = std::make_unique<connection>(io_serv_);
+        c->conn = PQconnectdb(conn.c_str());
 
-    auto status = PQstatus(conn_);
-    EVT_ASSERT(status == CONNECTION_OK, chain::postgres_connection_exception, "Connect failed");
+        auto status = PQstatus(c->conn);
+        EVT_ASSERT(status == CONNECTION_OK, chain::postgres_connection_exception, "Connect failed");
 
-    socket_ = boost::asio::ip::tcp::socket(io_serv_, boost::asio::ip::tcp::v4(), PQsocket(conn_));
+        c->socket = boost::asio::ip::tcp::socket(io_serv_, boost::asio::ip::tcp::v4(), PQsocket(c->conn));
+        conns_.emplace_back(std::move(c));
+    }
     return PG_OK;
 }
 
 int
 pg_query::close() {
-    FC_ASSERT(conn_);
-    PQfinish(conn_);
-    conn_ = nullptr;
+    FC_ASSERT(!conns_.empty());
+    for(auto& c : conns_) {
+        c->timer.cancel();
+        PQfinish(c->conn);
+        c->conn = nullptr;
+    }
 
     return PG_OK;
 }
 
 int
 pg_query::prepare_stmts() {
-    for(auto it : internal::prepare_register::instance().stmts) {
-        auto r = PQprepare(conn_, it.first.c_str(), it.second.c_str(), 0, NULL);
-        EVT_ASSERT(PQresultStatus(r) == PGRES_COMMAND_OK, chain::postgres_exec_exception,
-            "Prepare sql failed, sql: ${s}, detail: ${d}", ("s",it.second)("d",PQerrorMessage(conn_)));
-        PQclear(r);
+    for(auto& c : conns_) {
+        for(auto it : internal::prepare_register::instance().stmts) {
+            auto r = PQprepare(c->conn, it.first.c_str(), it.second.c_str(), 0, NULL);
+            EVT_ASSERT(PQresultStatus(r) == PGRES_COMMAND_OK, chain::postgres_exec_exception,
+                "Prepare sql failed, sql: ${s}, detail: ${d}", ("s",it.second)("d",PQerrorMessage(c->conn)));
+            PQclear(r);
+        }
     }
     return PG_OK;
 }
 
 int
 pg_query::begin_poll_read() {
-    socket_.async_wait(boost::asio::ip::tcp::socket::wait_type::wait_read, std::bind(&pg_query::poll_read, this));
+    for(auto& c : conns_) {
+        c->socket.async_wait(boost::asio::ip::tcp::socket::wait_type::wait_read, std::bind(&pg_query::poll_read, this, std::ref(*c)));
+    }
     return PG_OK;
 }
 
+uint64_t
+pg_query::cache_version() const {
+    // results depend on both postgres and chain states
+    return ((uint64_t)app().get_plugin<postgres_plugin>().last_sync_block_num() << 32) | chain_.head_block_num();
+}
+
+template<typename T>
 int
-pg_query::queue(int id, int task, std::string&& stmt) {
-    tasks_.emplace(id, task, std::move(stmt));
+pg_query::response_ok(deferred_id id, const T& obj) {
+    return response_ok(id, fc::json::to_string(obj));
+}
+
+// rendered json is moved into response without copying
+int
+pg_query::response_ok(deferred_id id, std::string&& str) {
+    if(cache_size_ > 0 && responding_ != nullptr) {
+        // results of the queries sent before states changed are not cached
+        auto version = cache_version();
+        if(responding_->version == version) {
+            if(cache_version_ != version) {
+                cache_.clear();
+                cache_version_ = version;
+            }
+            if(cache_.size() < cache_size_) {
+                cache_.emplace(responding_->stmt, str);
+            }
+        }
+    }
+
+    app().get_plugin<http_plugin>().set_deferred_response(id, 200, std::move(str));
+    return PG_OK;
+}
+
+int
+pg_query::queue(deferred_id id, int task, std::string&& stmt) {
+    auto version = cache_version();
+    if(cache_size_ > 0) {
+        if(cache_version_ != version) {
+            cache_.clear();
+            cache_version_ = version;
+        }
+        if(auto it = cache_.find(stmt); it != cache_.end()) {
+            app().get_plugin<http_plugin>().set_deferred_response(id, 200, std::string(it->second));
+            return PG_OK;
+        }
+    }
+
+    // dispatch to the connection with fewest tasks
+    auto c = conns_.front().get();
+    for(auto& it : conns_) {
+        if(it->tasks.size() < c->tasks.size()) {
+            c = it.get();
+        }
+    }
+    auto& t   = c->tasks.emplace(id, task, std::move(stmt));
+    t.version = version;
     
-    if(!sending_) {
-        send_once();
+    if(!c->sending) {
+        send_once(*c);
     }
     return PG_OK;
 }
 
 int
-pg_query::send_once() {
+pg_query::send_once(connection& c) {
     using namespace internal;
 
-    assert(!tasks_.empty());
-    auto& t = tasks_.front();
-
-    auto r = PQsendQuery(conn_, t.stmt.c_str());
-    if(r == 1) {
-        sending_ = true;
-        return PG_OK;
+    assert(!c.tasks.empty());
+    auto& t = c.tasks.front();
+
+    auto waited = std::chrono::steady_clock::now() - t.queued;
+    if(timeout_.count() == 0 || waited < timeout_) {
+        auto r = PQsendQuery(c.conn, t.stmt.c_str());
+        if(r == 1) {
+            c.sending = true;
+            c.seq++;
+            if(timeout_.count() > 0) {
+                c.timer.expires_after(timeout_ - waited);
+                c.timer.async_wait([this, &c, seq = c.seq](auto& ec) {
+                    if(!ec) {
+                        cancel_query(c, seq);
+                    }
+                });
+            }
+            return PG_OK;
+        }
     }
 
     try {
+        if(timeout_.count() > 0 && waited >= timeout_) {
+            EVT_THROW2(chain::postgres_query_timeout_exception,
+                "'{}' query is timeout after waiting for {} ms in queue", call_names[t.type], timeout_.count());
+        }
         EVT_THROW2(chain::postgres_send_exception,
-            "Send '{}' query command failed, try agian later, detail: {}", call_names[t.type], PQerrorMessage(conn_));
+            "Send '{}' query command failed, try agian later, detail: {}", call_names[t.type], PQerrorMessage(c.conn));
     }
     catch(...) {
         app().get_plugin<http_plugin>().handle_async_exception(t.id, "history", call_names[t.type], "");
     }
 
-    tasks_.pop();
-    if(!tasks_.empty()) {
+    c.tasks.pop();
+    if(!c.tasks.empty()) {
         // send next one
-        return send_once();
+        return send_once(c);
     }
     return PG_FAIL;
 }
 
 int
-pg_query::poll_read() {
+pg_query::cancel_query(connection& c, uint64_t seq) {
+    if(!c.sending || c.seq != seq) {
+        // query is already finished
+        return PG_FAIL;
+    }
+
+    char errbuf[256];
+    auto cancel = PQgetCancel(c.conn);
+    auto r      = PQcancel(cancel, errbuf, sizeof(errbuf));
+    PQfreeCancel(cancel);
+
+    if(r != 1) {
+        wlog("Cancel timeout query of postgres failed, detail: ${d}", ("d",errbuf));
+        return PG_FAIL;
+    }
+    // result of canceled query is still received in `poll_read`
+    c.timedout = true;
+    return PG_OK;
+}
+
+int
+pg_query::poll_read(connection& c) {
     using namespace internal;
 
     bool busy = false;
     while(1) {
-        auto r = PQconsumeInput(conn_);
-        EVT_ASSERT(r, chain::postgres_poll_exception, "Poll messages from postgres failed, detail: ${d}", ("d",PQerrorMessage(conn_)));
+        auto r = PQconsumeInput(c.conn);
+        EVT_ASSERT(r, chain::postgres_poll_exception, "Poll messages from postgres failed, detail: ${d}", ("d",PQerrorMessage(c.conn)));
 
-        if(PQisBusy(conn_)) {
+        if(PQisBusy(c.conn)) {
             busy = true;
             break;
         }
 
-        auto re = PQgetResult(conn_);
+        auto re = PQgetResult(c.conn);
         if(re == NULL) {
             break;
         }
 
-        auto t = tasks_.front();
-        tasks_.pop();
+        auto t = c.tasks.front();
+        c.tasks.pop();
+        c.timer.cancel();
 
+        responding_ = &t;
         try {
+            if(c.timedout) {
+                c.timedout = false;
+                // query may be finished before it's canceled
+                if(PQresultStatus(re) != PGRES_TUPLES_OK) {
+                    EVT_THROW2(chain::postgres_query_timeout_exception,
+                        "'{}' query is timeout after {} ms", call_names[t.type], timeout_.count());
+                }
+            }
+
             switch(t.type) {
             case kGetTokens: {
                 get_tokens_resume(t.id, re);
@@ -256,31 +415,37 @@ pg_query::poll_read() {
                 get_transaction_actions_resume(t.id, re);
                 break;
             }
+            case kGetActionsPage:
+            case kGetFungibleActionsPage: {
+                get_actions_page_resume(t.id, re);
+                break;
+            }
             };  // switch
         }
         catch(...) {
             app().get_plugin<http_plugin>().handle_async_exception(t.id, "history", call_names[t.type], "");
         }
+        responding_ = nullptr;
 
         PQclear(re);
     }
 
-    socket_.async_wait(boost::asio::ip::tcp::socket::wait_type::wait_read, std::bind(&pg_query::poll_read, this));
+    c.socket.async_wait(boost::asio::ip::tcp::socket::wait_type::wait_read, std::bind(&pg_query::poll_read, this, std::ref(c)));
     if(busy) {
         // still needs wait next data part
         return PG_OK;
     }
-    if(!tasks_.empty()) {
+    if(!c.tasks.empty()) {
         // send next one
-        if(send_once() == PG_FAIL) {
+        c.sending = false;
+        if(send_once(c) == PG_FAIL) {
             // no send
-            FC_ASSERT(tasks_.empty(), "Tasks should be empty");
-            sending_ = false;
+            FC_ASSERT(c.tasks.empty(), "Tasks should be empty");
         }
         // keep sending state
     }
     else {  // tasks is empty
-        sending_ = false;
+        c.sending = false;
     }
     return PG_OK;
 }
@@ -289,7 +454,7 @@ PREPARE_SQL_ONCE(gt_plan,  "SELECT domain, name FROM tokens WHERE $1 @> owner AN
 PREPARE_SQL_ONCE(gt_plan2, "SELECT domain, name FROM tokens WHERE $1 @> owner");  // without domain filter
 
 int
-pg_query::get_tokens_async(int id, const read_only::get_tokens_params& params) {
+pg_query::get_tokens_async(deferred_id id, const read_only::get_tokens_params& params) {
     using namespace internal;
 
     auto pkeys_buf = fmt::memory_buffer();
@@ -307,10 +472,10 @@ pg_query::get_tokens_async(int id, const read_only::get_tokens_params& params) {
 }
 
 int
-pg_query::get_tokens_resume(int id, pg_result const* r) {
+pg_query::get_tokens_resume(deferred_id id, pg_result const* r) {
     using namespace internal;
 
-    EVT_ASSERT(PQresultStatus(r) == PGRES_TUPLES_OK, chain::postgres_query_exception, "Get tokens failed, detail: ${s}", ("s",PQerrorMessage(conn_)));
+    EVT_ASSERT(PQresultStatus(r) == PGRES_TUPLES_OK, chain::postgres_query_exception, "Get tokens failed, detail: ${s}", ("s",PQresultErrorMessage(r)));
 
     auto n = PQntuples(r);
     if(n == 0) {
@@ -334,7 +499,7 @@ pg_query::get_tokens_resume(int id, pg_result const* r) {
 PREPARE_SQL_ONCE(gd_plan, "SELECT name FROM domains WHERE creator = ANY($1);");
 
 int
-pg_query::get_domains_async(int id, const read_only::get_params& params) {
+pg_query::get_domains_async(deferred_id id, const read_only::get_params& params) {
     using namespace internal;
 
     auto pkeys_buf = fmt::memory_buffer();
@@ -345,10 +510,10 @@ pg_query::get_domains_async(int id, const read_only::get_params& params) {
 }
 
 int
-pg_query::get_domains_resume(int id, pg_result const* r) {
+pg_query::get_domains_resume(deferred_id id, pg_result const* r) {
     using namespace internal;
 
-    EVT_ASSERT(PQresultStatus(r) == PGRES_TUPLES_OK, chain::postgres_query_exception, "Get domains failed, detail: ${s}", ("s",PQerrorMessage(conn_)));
+    EVT_ASSERT(PQresultStatus(r) == PGRES_TUPLES_OK, chain::postgres_query_exception, "Get domains failed, detail: ${s}", ("s",PQresultErrorMessage(r)));
 
     auto n = PQntuples(r);
     if(n == 0) {
@@ -367,7 +532,7 @@ pg_query::get_domains_resume(int id, pg_result const* r) {
 PREPARE_SQL_ONCE(gg_plan, "SELECT name FROM groups WHERE key = ANY($1);");
 
 int
-pg_query::get_groups_async(int id, const read_only::get_params& params) {
+pg_query::get_groups_async(deferred_id id, const read_only::get_params& params) {
     using namespace internal;
 
     auto pkeys_buf = fmt::memory_buffer();
@@ -378,10 +543,10 @@ pg_query::get_groups_async(int id, const read_only::get_params& params) {
 }
 
 int
-pg_query::get_groups_resume(int id, pg_result const* r) {
+pg_query::get_groups_resume(deferred_id id, pg_result const* r) {
     using namespace internal;
 
-    EVT_ASSERT(PQresultStatus(r) == PGRES_TUPLES_OK, chain::postgres_query_exception, "Get groups failed, detail: ${s}", ("s",PQerrorMessage(conn_)));
+    EVT_ASSERT(PQresultStatus(r) == PGRES_TUPLES_OK, chain::postgres_query_exception, "Get groups failed, detail: ${s}", ("s",PQresultErrorMessage(r)));
 
     auto n = PQntuples(r);
     if(n == 0) {
@@ -400,7 +565,7 @@ pg_query::get_groups_resume(int id, pg_result const* r) {
 PREPARE_SQL_ONCE(gf_plan, "SELECT sym_id FROM fungibles WHERE creator = ANY($1);");
 
 int
-pg_query::get_fungibles_async(int id, const read_only::get_params& params) {
+pg_query::get_fungibles_async(deferred_id id, const read_only::get_params& params) {
     using namespace internal;
 
     auto pkeys_buf = fmt::memory_buffer();
@@ -411,10 +576,10 @@ pg_query::get_fungibles_async(int id, const read_only::get_params& params) {
 }
 
 int
-pg_query::get_fungibles_resume(int id, pg_result const* r) {
+pg_query::get_fungibles_resume(deferred_id id, pg_result const* r) {
     using namespace internal;
 
-    EVT_ASSERT(PQresultStatus(r) == PGRES_TUPLES_OK, chain::postgres_query_exception, "Get fungibles failed, detail: ${s}", ("s",PQerrorMessage(conn_)));
+    EVT_ASSERT(PQresultStatus(r) == PGRES_TUPLES_OK, chain::postgres_query_exception, "Get fungibles failed, detail: ${s}", ("s",PQresultErrorMessage(r)));
 
     auto n = PQntuples(r);
     if(n == 0) {
@@ -432,7 +597,7 @@ pg_query::get_fungibles_resume(int id, pg_result const* r) {
 
 auto ga_plan0 = R"sql(SELECT actions.trx_id, name, domain, key, data, transactions.timestamp
                       FROM actions
-                      JOIN transactions ON actions.trx_id = transactions.trx_id
+                      JOIN transactions ON actions.trx_id = transactions.trx_id AND actions.block_num = transactions.block_num
                       WHERE domain = $1
                       ORDER BY actions.global_seq {0}
                       LIMIT $2 OFFSET $3
@@ -441,7 +606,7 @@ auto ga_plan0 = R"sql(SELECT actions.trx_id, name, domain, key, data, transactio
 // with key filter
 auto ga_plan1 = R"sql(SELECT actions.trx_id, name, domain, key, data, transactions.timestamp
                       FROM actions
-                      JOIN transactions ON actions.trx_id = transactions.trx_id
+                      JOIN transactions ON actions.trx_id = transactions.trx_id AND actions.block_num = transactions.block_num
                       WHERE domain = $1 AND key = $2
                       ORDER BY actions.global_seq {0}
                       LIMIT $3 OFFSET $4
@@ -450,7 +615,7 @@ auto ga_plan1 = R"sql(SELECT actions.trx_id, name, domain, key, data, transactio
 // with name filter
 auto ga_plan2 = R"sql(SELECT actions.trx_id, name, domain, key, data, transactions.timestamp
                       FROM actions
-                      JOIN transactions ON actions.trx_id = transactions.trx_id
+                      JOIN transactions ON actions.trx_id = transactions.trx_id AND actions.block_num = transactions.block_num
                       WHERE domain = $1 AND name = ANY($2)
                       ORDER BY actions.global_seq {0}
                       LIMIT $3 OFFSET $4
@@ -459,7 +624,7 @@ auto ga_plan2 = R"sql(SELECT actions.trx_id, name, domain, key, data, transactio
 // with key and name filter
 auto ga_plan3 = R"sql(SELECT actions.trx_id, name, domain, key, data, transactions.timestamp
                       FROM actions
-                      JOIN transactions ON actions.trx_id = transactions.trx_id
+                      JOIN transactions ON actions.trx_id = transactions.trx_id AND actions.block_num = transactions.block_num
                       WHERE domain = $1 AND key = $2 AND name = ANY($3)
                       ORDER BY actions.global_seq {0}
                       LIMIT $4 OFFSET $5
@@ -474,8 +639,17 @@ PREPARE_SQL_ONCE(ga_plan22, fmt::format(ga_plan2, "ASC"));
 PREPARE_SQL_ONCE(ga_plan31, fmt::format(ga_plan3, "DESC"));
 PREPARE_SQL_ONCE(ga_plan32, fmt::format(ga_plan3, "ASC"));
 
+PREPARE_SQL_ONCE(ga_pplan01, internal::actions_page_plan("domain = $1", 1, false));
+PREPARE_SQL_ONCE(ga_pplan02, internal::actions_page_plan("domain = $1", 1, true));
+PREPARE_SQL_ONCE(ga_pplan11, internal::actions_page_plan("domain = $1 AND key = $2", 2, false));
+PREPARE_SQL_ONCE(ga_pplan12, internal::actions_page_plan("domain = $1 AND key = $2", 2, true));
+PREPARE_SQL_ONCE(ga_pplan21, internal::actions_page_plan("domain = $1 AND name = ANY($2)", 2, false));
+PREPARE_SQL_ONCE(ga_pplan22, internal::actions_page_plan("domain = $1 AND name = ANY($2)", 2, true));
+PREPARE_SQL_ONCE(ga_pplan31, internal::actions_page_plan("domain = $1 AND key = $2 AND name = ANY($3)", 3, false));
+PREPARE_SQL_ONCE(ga_pplan32, internal::actions_page_plan("domain = $1 AND key = $2 AND name = ANY($3)", 3, true));
+
 int
-pg_query::get_actions_async(int id, const read_only::get_actions_params& params) {
+pg_query::get_actions_async(deferred_id id, const read_only::get_actions_params& params) {
     using namespace internal;
 
     int s = 0, t = 10;
@@ -487,104 +661,52 @@ pg_query::get_actions_async(int id, const read_only::get_actions_params& params)
         EVT_ASSERT(t <= 20, chain::exceed_query_limit_exception, "Exceed limit of max actions return allowed for each query, limit: 20 per query");
     }
 
-    auto stmt = std::string();
-
-    int j = 0;
-    if(params.dire.has_value() && *params.dire == direction::asc) {
-        j += 1;
-    }
+    // plans are named by filters: 0 for only domain, 1 with key, 2 with names and 3 with both,
+    // and then by direction: 1 for desc and 2 for asc
+    auto asc    = params.dire.has_value() && *params.dire == direction::asc;
+    auto filter = 0;
+    auto args   = fmt::format(fmt("'{}'"), (std::string)params.domain);
     if(params.key.has_value()) {
-        j += 2;
+        filter += 1;
+        args += fmt::format(fmt(",'{}'"), (std::string)*params.key);
     }
     if(!params.names.empty()) {
-        j += 4;
-    }
+        filter += 2;
 
-    switch(j) {
-    case 0: { // only domain, desc
-        stmt = fmt::format(fmt("EXECUTE ga_plan01 ('{}',{},{});"), (std::string)params.domain, t, s);
-        break;
-    }
-    case 1: { // only domain, asc
-        stmt = fmt::format(fmt("EXECUTE ga_plan02 ('{}',{},{});"), (std::string)params.domain, t, s);
-        break;
-    }
-    case 2: { // domain + key, desc
-        stmt = fmt::format(fmt("EXECUTE ga_plan11 ('{}','{}',{},{});"), (std::string)params.domain, (std::string)*params.key, t, s);
-        break;
-    }
-    case 3: { // domain + key, asc
-        stmt = fmt::format(fmt("EXECUTE ga_plan12 ('{}','{}',{},{});"), (std::string)params.domain, (std::string)*params.key, t, s);
-        break;
-    }
-    case 4: { // domain + name, desc
-        auto names_buf = fmt::memory_buffer();
-        format_array_to(names_buf, std::begin(params.names), std::end(params.names));
-
-        stmt = fmt::format(fmt("EXECUTE ga_plan21 ('{}','{}',{},{});"), (std::string)params.domain, fmt::to_string(names_buf), t, s);
-        break;
-    }
-    case 5: { // domain + name, asc
         auto names_buf = fmt::memory_buffer();
         format_array_to(names_buf, std::begin(params.names), std::end(params.names));
-
-        stmt = fmt::format(fmt("EXECUTE ga_plan22 ('{}','{}',{},{});"), (std::string)params.domain, fmt::to_string(names_buf), t, s);
-        break;
-    }
-    case 6: { // domain + key + name, desc
-        auto names_buf = fmt::memory_buffer();
-        format_array_to(names_buf, std::begin(params.names), std::end(params.names));
-
-        stmt = fmt::format(fmt("EXECUTE ga_plan31 ('{}','{}','{}',{},{});"), (std::string)params.domain, (std::string)*params.key, fmt::to_string(names_buf), t, s);
-        break;
+        args += fmt::format(fmt(",'{}'"), fmt::to_string(names_buf));
     }
-    case 7: { // domain + key + name, asc
-        auto names_buf = fmt::memory_buffer();
-        format_array_to(names_buf, std::begin(params.names), std::end(params.names));
 
-        stmt = fmt::format(fmt("EXECUTE ga_plan32 ('{}','{}','{}',{},{});"), (std::string)params.domain, (std::string)*params.key, fmt::to_string(names_buf), t, s);
-        break;
+    if(params.cursor.has_value()) {
+        auto c    = parse_cursor(*params.cursor, asc);
+        auto stmt = fmt::format(fmt("EXECUTE ga_pplan{}{} ({},{},{},{},{});"), filter, asc ? 2 : 1, args, c.block_num, c.trx_num, c.seq_num, t);
+        return queue(id, kGetActionsPage, std::move(stmt));
     }
-    };  // switch
 
+    auto stmt = fmt::format(fmt("EXECUTE ga_plan{}{} ({},{},{});"), filter, asc ? 2 : 1, args, t, s);
     return queue(id, kGetActions, std::move(stmt));
 }
 
 int
-pg_query::get_actions_resume(int id, pg_result const* r) {
+pg_query::get_actions_resume(deferred_id id, pg_result const* r) {
     using namespace internal;
 
-    EVT_ASSERT(PQresultStatus(r) == PGRES_TUPLES_OK, chain::postgres_query_exception, "Get actions failed, detail: ${s}", ("s",PQerrorMessage(conn_)));
+    EVT_ASSERT(PQresultStatus(r) == PGRES_TUPLES_OK, chain::postgres_query_exception, "Get actions failed, detail: ${s}", ("s",PQresultErrorMessage(r)));
     auto n = PQntuples(r);
     if(n == 0) {
         return response_ok(id, std::string("[]")); // return empty
     }
 
     auto builder = fmt::memory_buffer();
-
-    fmt::format_to(builder, "[");
-    for(int i = 0; i < n; i++) {
-        fmt::format_to(builder,
-            fmt(R"({{"trx_id":"{}","name":"{}","domain":"{}","key":"{}","data":{},"timestamp":"{}"}})"),
-            PQgetvalue(r, i, 0),
-            PQgetvalue(r, i, 1),
-            PQgetvalue(r, i, 2),
-            PQgetvalue(r, i, 3),
-            PQgetvalue(r, i, 4),
-            fix_pg_timestamp(PQgetvalue(r, i, 5))
-            );
-        if(i < n - 1) {
-            fmt::format_to(builder, ",");
-        }
-    }
-    fmt::format_to(builder, "]");
+    format_actions_to(builder, r, n);
 
     return response_ok(id, fmt::to_string(builder));
 }
 
 auto gfa_plan0 = R"sql(SELECT actions.trx_id, name, domain, key, data, transactions.timestamp
                        FROM actions
-                       JOIN transactions ON actions.trx_id = transactions.trx_id
+                       JOIN transactions ON actions.trx_id = transactions.trx_id AND actions.block_num = transactions.block_num
                        WHERE
                            domain = '.fungible'
                            AND key = $1
@@ -596,7 +718,7 @@ auto gfa_plan0 = R"sql(SELECT actions.trx_id, name, domain, key, data, transacti
 // with address filter
 auto gfa_plan1 = R"sql(SELECT actions.trx_id, name, domain, key, data, transactions.timestamp
                        FROM actions
-                       JOIN transactions ON actions.trx_id = transactions.trx_id
+                       JOIN transactions ON actions.trx_id = transactions.trx_id AND actions.block_num = transactions.block_num
                        WHERE
                            domain = '.fungible'
                            AND key = $1
@@ -618,8 +740,30 @@ PREPARE_SQL_ONCE(gfa_plan02, fmt::format(gfa_plan0, "ASC"));
 PREPARE_SQL_ONCE(gfa_plan11, fmt::format(gfa_plan1, "DESC"));
 PREPARE_SQL_ONCE(gfa_plan12, fmt::format(gfa_plan1, "ASC"));
 
+auto gfa_pfilter0 = R"sql(domain = '.fungible'
+                          AND key = $1
+                          AND name = ANY('{"issuefungible","transferft","recycleft","evt2pevt","everipay","paybonus"}'))sql";
+
+// with address filter
+auto gfa_pfilter1 = R"sql(domain = '.fungible'
+                          AND key = $1
+                          AND name = ANY('{"issuefungible","transferft","recycleft","evt2pevt","everipay","paybonus"}')
+                          AND (
+                              data->>'address' = $2 OR
+                              data->>'from' = $2 OR
+                              data->>'to' = $2 OR
+                              data->>'payee' = $2 OR
+                              data->'link'->'keys' @> $3 OR
+                              data->>'payer' = $2
+                          ))sql";
+
+PREPARE_SQL_ONCE(gfa_pplan01, internal::actions_page_plan(gfa_pfilter0, 1, false));
+PREPARE_SQL_ONCE(gfa_pplan02, internal::actions_page_plan(gfa_pfilter0, 1, true));
+PREPARE_SQL_ONCE(gfa_pplan11, internal::actions_page_plan(gfa_pfilter1, 3, false));
+PREPARE_SQL_ONCE(gfa_pplan12, internal::actions_page_plan(gfa_pfilter1, 3, true));
+
 int
-pg_query::get_fungible_actions_async(int id, const read_only::get_fungible_actions_params& params) {
+pg_query::get_fungible_actions_async(deferred_id id, const read_only::get_fungible_actions_params& params) {
     using namespace internal;
 
     int s = 0, t = 10;
@@ -631,43 +775,34 @@ pg_query::get_fungible_actions_async(int id, const read_only::get_fungible_actio
         EVT_ASSERT(t <= 20, chain::exceed_query_limit_exception, "Exceed limit of max actions return allowed for each query, limit: 20 per query");
     }
 
-    auto stmt = std::string();
-
-    int j = 0;
-    if(params.dire.has_value() && *params.dire == direction::asc) {
-        j += 1;
-    }
+    // plans are named by filters: 0 for only sym id and 1 with address,
+    // and then by direction: 1 for desc and 2 for asc
+    auto asc    = params.dire.has_value() && *params.dire == direction::asc;
+    auto filter = 0;
+    auto args   = std::string();
     if(params.addr.has_value()) {
-        j += 2;
-    }
-
-    switch(j) {
-    case 0: { // only sym id, desc
-        stmt = fmt::format(fmt("EXECUTE gfa_plan01 ('{}',{},{});"), params.sym_id, t, s);
-        break;
-    }
-    case 1: { // only sym id, asc
-        stmt = fmt::format(fmt("EXECUTE gfa_plan02 ('{}',{},{});"), params.sym_id, t, s);
-        break;
+        filter = 1;
+        args   = fmt::format(fmt("'{0}','{1}','\"{1}\"'"), params.sym_id, (std::string)*params.addr);
     }
-    case 2: { // sym id + address, desc
-        stmt = fmt::format(fmt("EXECUTE gfa_plan11 ('{0}','{1}','\"{1}\"',{2},{3});"), params.sym_id, (std::string)*params.addr, t, s);
-        break;
+    else {
+        args = fmt::format(fmt("'{}'"), params.sym_id);
     }
-    case 3: { // sym id + address, asc
-        stmt = fmt::format(fmt("EXECUTE gfa_plan12 ('{0}','{1}','\"{1}\"',{2},{3});"), params.sym_id, (std::string)*params.addr, t, s);
-        break;
+
+    if(params.cursor.has_value()) {
+        auto c    = parse_cursor(*params.cursor, asc);
+        auto stmt = fmt::format(fmt("EXECUTE gfa_pplan{}{} ({},{},{},{},{});"), filter, asc ? 2 : 1, args, c.block_num, c.trx_num, c.seq_num, t);
+        return queue(id, kGetFungibleActionsPage, std::move(stmt));
     }
-    };  // switch
 
+    auto stmt = fmt::format(fmt("EXECUTE gfa_plan{}{} ({},{},{});"), filter, asc ? 2 : 1, args, t, s);
     return queue(id, kGetFungibleActions, std::move(stmt));
 }
 
 int
-pg_query::get_fungible_actions_resume(int id, pg_result const* r) {
+pg_query::get_fungible_actions_resume(deferred_id id, pg_result const* r) {
     using namespace internal;
 
-    EVT_ASSERT(PQresultStatus(r) == PGRES_TUPLES_OK, chain::postgres_query_exception, "Get fungible actions failed, detail: ${s}", ("s",PQerrorMessage(conn_)));
+    EVT_ASSERT(PQresultStatus(r) == PGRES_TUPLES_OK, chain::postgres_query_exception, "Get fungible actions failed, detail: ${s}", ("s",PQresultErrorMessage(r)));
 
     auto n = PQntuples(r);
     if(n == 0) {
@@ -675,23 +810,29 @@ pg_query::get_fungible_actions_resume(int id, pg_result const* r) {
     }
 
     auto builder = fmt::memory_buffer();
+    format_actions_to(builder, r, n);
 
-    fmt::format_to(builder, "[");
-    for(int i = 0; i < n; i++) {
-        fmt::format_to(builder,
-            fmt(R"({{"trx_id":"{}","name":"{}","domain":"{}","key":"{}","data":{},"timestamp":"{}"}})"),
-            PQgetvalue(r, i, 0),
-            PQgetvalue(r, i, 1),
-            PQgetvalue(r, i, 2),
-            PQgetvalue(r, i, 3),
-            PQgetvalue(r, i, 4),
-            fix_pg_timestamp(PQgetvalue(r, i, 5))
-            );
-        if(i < n - 1) {
-            fmt::format_to(builder, ",");
-        }
+    return response_ok(id, fmt::to_string(builder));
+}
+
+int
+pg_query::get_actions_page_resume(deferred_id id, pg_result const* r) {
+    using namespace internal;
+
+    EVT_ASSERT(PQresultStatus(r) == PGRES_TUPLES_OK, chain::postgres_query_exception, "Get actions failed, detail: ${s}", ("s",PQresultErrorMessage(r)));
+
+    auto n       = PQntuples(r);
+    auto builder = fmt::memory_buffer();
+
+    fmt::format_to(builder, R"({{"actions":)");
+    format_actions_to(builder, r, n);
+    if(n == 0) {
+        // no more pages
+        fmt::format_to(builder, R"(,"cursor":null}})");
+    }
+    else {
+        fmt::format_to(builder, fmt(R"(,"cursor":"{}-{}-{}"}})"), PQgetvalue(r, n - 1, 6), PQgetvalue(r, n - 1, 7), PQgetvalue(r, n - 1, 8));
     }
-    fmt::format_to(builder, "]");
 
     return response_ok(id, fmt::to_string(builder));
 }
@@ -699,7 +840,7 @@ pg_query::get_fungible_actions_resume(int id, pg_result const* r) {
 PREPARE_SQL_ONCE(gfb_plan, "SELECT address, sym_ids FROM ft_holders WHERE address = $1;");
 
 int
-pg_query::get_fungibles_balance_async(int id, const read_only::get_fungibles_balance_params& params) {
+pg_query::get_fungibles_balance_async(deferred_id id, const read_only::get_fungibles_balance_params& params) {
     using namespace internal;
 
     auto stmt = fmt::format(fmt("EXECUTE gfb_plan('{}');"), (std::string)params.addr);
@@ -707,23 +848,21 @@ pg_query::get_fungibles_balance_async(int id, const read_only::get_fungibles_bal
 }
 
 #define READ_DB_ASSET(ADDR, SYM_ID, VALUEREF)                                                         \
-    try {                                                                                             \
+    {                                                                                                 \
         auto str = std::string();                                                                     \
-        tokendb.read_asset(ADDR, SYM_ID, str);                                                        \
-                                                                                                      \
+        if(tokendb.try_read_asset(ADDR, SYM_ID, str) == read_status::not_found) {                     \
+            EVT_THROW2(balance_exception, "There's no balance left in {} with sym id: {}", ADDR, SYM_ID); \
+        }                                                                                             \
         extract_db_value(str, VALUEREF);                                                              \
-    }                                                                                                 \
-    catch(token_database_exception&) {                                                                \
-        EVT_THROW2(balance_exception, "There's no balance left in {} with sym id: {}", ADDR, SYM_ID); \
     }
 
 int
-pg_query::get_fungibles_balance_resume(int id, pg_result const* r) {
+pg_query::get_fungibles_balance_resume(deferred_id id, pg_result const* r) {
     using namespace internal;
     using namespace boost::algorithm;
     using namespace chain;
 
-    EVT_ASSERT(PQresultStatus(r) == PGRES_TUPLES_OK, chain::postgres_query_exception, "Get transaction failed, detail: ${s}", ("s",PQerrorMessage(conn_)));
+    EVT_ASSERT(PQresultStatus(r) == PGRES_TUPLES_OK, chain::postgres_query_exception, "Get transaction failed, detail: ${s}", ("s",PQresultErrorMessage(r)));
 
     auto n = PQntuples(r);
     if(n == 0) {
@@ -756,7 +895,7 @@ pg_query::get_fungibles_balance_resume(int id, pg_result const* r) {
 PREPARE_SQL_ONCE(gtrx_plan, "SELECT block_num, trx_id FROM transactions WHERE trx_id = $1;");
 
 int
-pg_query::get_transaction_async(int id, const read_only::get_transaction_params& params) {
+pg_query::get_transaction_async(deferred_id id, const read_only::get_transaction_params& params) {
     using namespace internal;
 
     auto stmt = fmt::format(fmt("EXECUTE gtrx_plan('{}');"), (std::string)params.id);
@@ -764,10 +903,10 @@ pg_query::get_transaction_async(int id, const read_only::get_transaction_params&
 }
 
 int
-pg_query::get_transaction_resume(int id, pg_result const* r) {
+pg_query::get_transaction_resume(deferred_id id, pg_result const* r) {
     using namespace internal;
 
-    EVT_ASSERT(PQresultStatus(r) == PGRES_TUPLES_OK, chain::postgres_query_exception, "Get transaction failed, detail: ${s}", ("s",PQerrorMessage(conn_)));
+    EVT_ASSERT(PQresultStatus(r) == PGRES_TUPLES_OK, chain::postgres_query_exception, "Get transaction failed, detail: ${s}", ("s",PQresultErrorMessage(r)));
 
     auto n = PQntuples(r);
     if(n == 0) {
@@ -805,7 +944,7 @@ PREPARE_SQL_ONCE(gtrxs_plan0, "SELECT block_num, trx_id FROM transactions WHERE
 PREPARE_SQL_ONCE(gtrxs_plan1, "SELECT block_num, trx_id FROM transactions WHERE keys && $1 ORDER BY timestamp ASC  LIMIT $2 OFFSET $3;")
 
 int
-pg_query::get_transactions_async(int id, const read_only::get_transactions_params& params) {
+pg_query::get_transactions_async(deferred_id id, const read_only::get_transactions_params& params) {
     using namespace internal;
 
     int s = 0, t = 10;
@@ -832,10 +971,10 @@ pg_query::get_transactions_async(int id, const read_only::get_transactions_param
 }
 
 int
-pg_query::get_transactions_resume(int id, pg_result const* r) {
+pg_query::get_transactions_resume(deferred_id id, pg_result const* r) {
     using namespace internal;
 
-    EVT_ASSERT(PQresultStatus(r) == PGRES_TUPLES_OK, chain::postgres_query_exception, "Get transaction failed, detail: ${s}", ("s",PQerrorMessage(conn_)));
+    EVT_ASSERT(PQresultStatus(r) == PGRES_TUPLES_OK, chain::postgres_query_exception, "Get transaction failed, detail: ${s}", ("s",PQresultErrorMessage(r)));
 
     auto n = PQntuples(r);
     if(n == 0) {
@@ -874,7 +1013,7 @@ pg_query::get_transactions_resume(int id, pg_result const* r) {
 PREPARE_SQL_ONCE(gfi_plan, "SELECT sym_id FROM fungibles ORDER BY sym_id ASC LIMIT $1 OFFSET $2;");
 
 int
-pg_query::get_fungible_ids_async(int id, const read_only::get_fungible_ids_params& params) {
+pg_query::get_fungible_ids_async(deferred_id id, const read_only::get_fungible_ids_params& params) {
     using namespace internal;
 
     int s = 0, t = 100;
@@ -891,10 +1030,10 @@ pg_query::get_fungible_ids_async(int id, const read_only::get_fungible_ids_param
 }
 
 int
-pg_query::get_fungible_ids_resume(int id, pg_result const* r) {
+pg_query::get_fungible_ids_resume(deferred_id id, pg_result const* r) {
     using namespace internal;
 
-    EVT_ASSERT(PQresultStatus(r) == PGRES_TUPLES_OK, chain::postgres_query_exception, "Get fungible ids failed, detail: ${s}", ("s",PQerrorMessage(conn_)));
+    EVT_ASSERT(PQresultStatus(r) == PGRES_TUPLES_OK, chain::postgres_query_exception, "Get fungible ids failed, detail: ${s}", ("s",PQresultErrorMessage(r)));
 
     auto n = PQntuples(r);
     if(n == 0) {
@@ -916,13 +1055,13 @@ pg_query::get_fungible_ids_resume(int id, pg_result const* r) {
 
 PREPARE_SQL_ONCE(gta_plan, R"sql(SELECT actions.trx_id, name, domain, key, data, transactions.timestamp
                                  FROM actions
-                                 JOIN transactions ON actions.trx_id = transactions.trx_id
+                                 JOIN transactions ON actions.trx_id = transactions.trx_id AND actions.block_num = transactions.block_num
                                  WHERE actions.trx_id = $1
                                  ORDER BY actions.seq_num ASC
                                  )sql");
 
 int
-pg_query::get_transaction_actions_async(int id, const read_only::get_transaction_actions_params& params) {
+pg_query::get_transaction_actions_async(deferred_id id, const read_only::get_transaction_actions_params& params) {
     using namespace internal;
 
     auto stmt = fmt::format(fmt("EXECUTE gta_plan('{}');"), (std::string)params.id);
@@ -930,10 +1069,10 @@ pg_query::get_transaction_actions_async(int id, const read_only::get_transaction
 }
 
 int
-pg_query::get_transaction_actions_resume(int id, pg_result const* r) {
+pg_query::get_transaction_actions_resume(deferred_id id, pg_result const* r) {
     using namespace internal;
 
-    EVT_ASSERT(PQresultStatus(r) == PGRES_TUPLES_OK, chain::postgres_query_exception, "Get transaction actions failed, detail: ${s}", ("s",PQerrorMessage(conn_)));
+    EVT_ASSERT(PQresultStatus(r) == PGRES_TUPLES_OK, chain::postgres_query_exception, "Get transaction actions failed, detail: ${s}", ("s",PQresultErrorMessage(r)));
 
     auto n = PQntuples(r);
     if(n == 0) {
@@ -941,23 +1080,7 @@ pg_query::get_transaction_actions_resume(int id, pg_result const* r) {
     }
 
     auto builder = fmt::memory_buffer();
-
-    fmt::format_to(builder, "[");
-    for(int i = 0; i < n; i++) {
-        fmt::format_to(builder,
-            fmt(R"({{"trx_id":"{}","name":"{}","domain":"{}","key":"{}","data":{},"timestamp":"{}"}})"),
-            PQgetvalue(r, i, 0),
-            PQgetvalue(r, i, 1),
-            PQgetvalue(r, i, 2),
-            PQgetvalue(r, i, 3),
-            PQgetvalue(r, i, 4),
-            fix_pg_timestamp(PQgetvalue(r, i, 5))
-            );
-        if(i < n - 1) {
-            fmt::format_to(builder, ",");
-        }
-    }
-    fmt::format_to(builder, "]");
+    format_actions_to(builder, r, n);
 
     return response_ok(id, fmt::to_string(builder));
 }
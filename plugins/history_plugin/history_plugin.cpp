@@ -13,9 +13,11 @@ static appbase::abstract_plugin& _history_plugin = app().register_plugin<history
 
 class history_plugin_impl {
 public:
-    history_plugin_impl()
+    history_plugin_impl(uint32_t connections, uint32_t timeout_ms, uint32_t cache_size)
         : pg_query_(app().get_io_service(), app().get_plugin<chain_plugin>().chain()) {
-        pg_query_.connect(app().get_plugin<postgres_plugin>().connstr());
+        pg_query_.connect(app().get_plugin<postgres_plugin>().connstr(), (int)connections);
+        pg_query_.set_query_timeout(timeout_ms);
+        pg_query_.set_cache_size(cache_size);
         pg_query_.prepare_stmts();
         pg_query_.begin_poll_read();
     }
@@ -33,16 +35,27 @@ history_plugin::~history_plugin() {}
 
 void
 history_plugin::set_program_options(options_description& cli, options_description& cfg) {
+    cfg.add_options()
+        ("history-query-connections", bpo::value<uint32_t>()->default_value(4),
+            "The number of connections to postgres for history queries, queries are dispatched to the least loaded one")
+        ("history-query-timeout-ms", bpo::value<uint32_t>()->default_value(5000),
+            "Cancel history queries not finished within this time since they're received, 0 to disable")
+        ("history-cache-size", bpo::value<uint32_t>()->default_value(10000),
+            "The max number of history responses cached till next block is synced or applied, 0 to disable")
+        ;
 }
 
 void
 history_plugin::plugin_initialize(const variables_map& options) {
+    query_connections_ = std::max(options.at("history-query-connections").as<uint32_t>(), 1u);
+    query_timeout_ms_  = options.at("history-query-timeout-ms").as<uint32_t>();
+    cache_size_        = options.at("history-cache-size").as<uint32_t>();
 }
 
 void
 history_plugin::plugin_startup() {
     if(app().get_plugin<postgres_plugin>().enabled()) {
-        my_.reset(new history_plugin_impl());
+        my_.reset(new history_plugin_impl(query_connections_, query_timeout_ms_, cache_size_));
     }
     else {
         wlog("evt::postgres_plugin configured, but no --postgres-uri specified.");
@@ -57,77 +70,77 @@ history_plugin::plugin_shutdown() {
 namespace history_apis {
 
 void
-read_only::get_tokens_async(int id, const get_tokens_params& params) {
+read_only::get_tokens_async(deferred_id id, const get_tokens_params& params) {
     EVT_ASSERT(plugin_.my_, chain::postgres_not_enabled_exception, "Postgres plugin is not enabled.");
 
     plugin_.my_->pg_query_.get_tokens_async(id, params);
 }
 
 void
-read_only::get_domains_async(int id, const get_params& params) {
+read_only::get_domains_async(deferred_id id, const get_params& params) {
     EVT_ASSERT(plugin_.my_, chain::postgres_not_enabled_exception, "Postgres plugin is not enabled.");
 
     plugin_.my_->pg_query_.get_domains_async(id, params);
 }
 
 void
-read_only::get_groups_async(int id, const get_params& params) {
+read_only::get_groups_async(deferred_id id, const get_params& params) {
     EVT_ASSERT(plugin_.my_, chain::postgres_not_enabled_exception, "Postgres plugin is not enabled.");
 
     plugin_.my_->pg_query_.get_groups_async(id, params);
 }
 
 void
-read_only::get_fungibles_async(int id, const get_params& params) {
+read_only::get_fungibles_async(deferred_id id, const get_params& params) {
     EVT_ASSERT(plugin_.my_, chain::postgres_not_enabled_exception, "Postgres plugin is not enabled.");
 
     plugin_.my_->pg_query_.get_fungibles_async(id, params);
 }
 
 void
-read_only::get_actions_async(int id, const get_actions_params& params) {
+read_only::get_actions_async(deferred_id id, const get_actions_params& params) {
     EVT_ASSERT(plugin_.my_, chain::postgres_not_enabled_exception, "Postgres plugin is not enabled.");
 
     plugin_.my_->pg_query_.get_actions_async(id, params);
 }
 
 void
-read_only::get_fungible_actions_async(int id, const get_fungible_actions_params& params) {
+read_only::get_fungible_actions_async(deferred_id id, const get_fungible_actions_params& params) {
     EVT_ASSERT(plugin_.my_, chain::postgres_not_enabled_exception, "Postgres plugin is not enabled.");
 
     plugin_.my_->pg_query_.get_fungible_actions_async(id, params);
 }
 
 void
-read_only::get_fungibles_balance_async(int id, const get_fungibles_balance_params& params) {
+read_only::get_fungibles_balance_async(deferred_id id, const get_fungibles_balance_params& params) {
     EVT_ASSERT(plugin_.my_, chain::postgres_not_enabled_exception, "Postgres plugin is not enabled.");
 
     plugin_.my_->pg_query_.get_fungibles_balance_async(id, params);
 }
 
 void
-read_only::get_transaction_async(int id, const get_transaction_params& params) {
+read_only::get_transaction_async(deferred_id id, const get_transaction_params& params) {
     EVT_ASSERT(plugin_.my_, chain::postgres_not_enabled_exception, "Postgres plugin is not enabled.");
 
     plugin_.my_->pg_query_.get_transaction_async(id, params);
 }
 
 void
-read_only::get_transactions_async(int id, const get_transactions_params& params) {
+read_only::get_transactions_async(deferred_id id, const get_transactions_params& params) {
     EVT_ASSERT(plugin_.my_, chain::postgres_not_enabled_exception, "Postgres plugin is not enabled.");
 
     plugin_.my_->pg_query_.get_transactions_async(id, params);
 }
 
 void
-read_only::get_fungible_ids_async(int id, const get_fungible_ids_params& params) {
+read_only::get_fungible_ids_async(deferred_id id, const get_fungible_ids_params& params) {
     EVT_ASSERT(plugin_.my_, chain::postgres_not_enabled_exception, "Postgres plugin is not enabled.");
 
     plugin_.my_->pg_query_.get_fungible_ids_async(id, params);
 }
 
 void
-read_only::get_transaction_actions_async(int id, const get_transaction_actions_params& params) {
+read_only::get_transaction_actions_async(deferred_id id, const get_transaction_actions_params& params) {
     EVT_ASSERT(plugin_.my_, chain::postgres_not_enabled_exception, "Postgres plugin is not enabled.");
 
     plugin_.my_->pg_query_.get_transaction_actions_async(id, params);
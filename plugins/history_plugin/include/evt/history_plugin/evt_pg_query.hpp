@@ -3,11 +3,16 @@
  *  @copyright defined in evt/LICENSE.txt
  */
 #pragma once
+#include <chrono>
+#include <memory>
 #include <queue>
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include <boost/noncopyable.hpp>
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <evt/chain/block_state.hpp>
 #include <evt/chain/transaction.hpp>
 #include <evt/chain/contracts/types.hpp>
@@ -36,72 +41,112 @@ class pg_query : boost::noncopyable {
 private:
     struct task {
     public:
-        task(int id, int type, std::string&& stmt)
-            : id(id), type(type), stmt(std::move(stmt)) {}
+        task(deferred_id id, int type, std::string&& stmt)
+            : id(id), type(type), stmt(std::move(stmt)), queued(std::chrono::steady_clock::now()) {}
 
     public:
-        int         id;
+        deferred_id id;
         int         type;
         std::string stmt;
+        uint64_t    version = 0;  // cache version when it's queued
+
+        std::chrono::steady_clock::time_point queued;
+    };
+
+    // one async connection with its own tasks, only the front one is sent and others wait for it
+    struct connection : boost::noncopyable {
+    public:
+        connection(boost::asio::io_context& io_serv) : socket(io_serv), timer(io_serv) {}
+
+    public:
+        pg_conn* conn     = nullptr;
+        bool     sending  = false;
+        bool     timedout = false;  // current query is canceled due to timeout
+        uint64_t seq      = 0;      // increased on each sending, used to ignore outdated timers
+
+        std::queue<task>             tasks;
+        boost::asio::ip::tcp::socket socket;
+        boost::asio::steady_timer    timer;
     };
 
 public:
     pg_query(boost::asio::io_context& io_serv, controller& chain)
-        : conn_(nullptr), sending_(false), io_serv_(io_serv), chain_(chain), socket_(io_serv) {}
+        : io_serv_(io_serv), chain_(chain) {}
 
 public:
-    int connect(const std::string& conn);
+    int connect(const std::string& conn, int num = 1);
     int close();
     int prepare_stmts();
     int begin_poll_read();
 
+    // queries not finished within timeout since they're queued are canceled, 0 means no timeout
+    void set_query_timeout(uint32_t ms) { timeout_ = std::chrono::milliseconds(ms); }
+
+    // responses are cached by their statements until next block is synced into postgres or applied by chain,
+    // 0 means no cache
+    void set_cache_size(size_t size) { cache_size_ = size; }
+
 public:
-    int get_tokens_async(int id, const read_only::get_tokens_params& params);
-    int get_tokens_resume(int id, pg_result const*);
+    int get_tokens_async(deferred_id id, const read_only::get_tokens_params& params);
+    int get_tokens_resume(deferred_id id, pg_result const*);
+
+    int get_domains_async(deferred_id id, const read_only::get_params& params);
+    int get_domains_resume(deferred_id id, pg_result const*);
 
-    int get_domains_async(int id, const read_only::get_params& params);
-    int get_domains_resume(int id, pg_result const*);
+    int get_groups_async(deferred_id id, const read_only::get_params& params);
+    int get_groups_resume(deferred_id id, pg_result const*);
 
-    int get_groups_async(int id, const read_only::get_params& params);
-    int get_groups_resume(int id, pg_result const*);
+    int get_fungibles_async(deferred_id id, const read_only::get_params& params);
+    int get_fungibles_resume(deferred_id id, pg_result const*);
 
-    int get_fungibles_async(int id, const read_only::get_params& params);
-    int get_fungibles_resume(int id, pg_result const*);
+    int get_actions_async(deferred_id id, const read_only::get_actions_params& params);
+    int get_actions_resume(deferred_id id, pg_result const*);
 
-    int get_actions_async(int id, const read_only::get_actions_params& params);
-    int get_actions_resume(int id, pg_result const*);
+    int get_fungible_actions_async(deferred_id id, const read_only::get_fungible_actions_params& params);
+    int get_fungible_actions_resume(deferred_id id, pg_result const*);
 
-    int get_fungible_actions_async(int id, const read_only::get_fungible_actions_params& params);
-    int get_fungible_actions_resume(int id, pg_result const*);
+    // actions queried by cursor are returned with cursor of next page
+    int get_actions_page_resume(deferred_id id, pg_result const*);
 
-    int get_fungibles_balance_async(int id, const read_only::get_fungibles_balance_params& params);
-    int get_fungibles_balance_resume(int id, pg_result const*);
+    int get_fungibles_balance_async(deferred_id id, const read_only::get_fungibles_balance_params& params);
+    int get_fungibles_balance_resume(deferred_id id, pg_result const*);
 
-    int get_transaction_async(int id, const read_only::get_transaction_params& params);
-    int get_transaction_resume(int id, pg_result const*);
+    int get_transaction_async(deferred_id id, const read_only::get_transaction_params& params);
+    int get_transaction_resume(deferred_id id, pg_result const*);
 
-    int get_transactions_async(int id, const read_only::get_transactions_params& params);
-    int get_transactions_resume(int id, pg_result const*);
+    int get_transactions_async(deferred_id id, const read_only::get_transactions_params& params);
+    int get_transactions_resume(deferred_id id, pg_result const*);
 
-    int get_fungible_ids_async(int id, const read_only::get_fungible_ids_params& params);
-    int get_fungible_ids_resume(int id, pg_result const*);
+    int get_fungible_ids_async(deferred_id id, const read_only::get_fungible_ids_params& params);
+    int get_fungible_ids_resume(deferred_id id, pg_result const*);
 
-    int get_transaction_actions_async(int id, const read_only::get_transaction_actions_params& params);
-    int get_transaction_actions_resume(int id, pg_result const*);
+    int get_transaction_actions_async(deferred_id id, const read_only::get_transaction_actions_params& params);
+    int get_transaction_actions_resume(deferred_id id, pg_result const*);
 
 private:
-    int queue(int id, int task, std::string&& stmt);
-    int poll_read();
-    int send_once();
+    int queue(deferred_id id, int task, std::string&& stmt);
+    int poll_read(connection& c);
+    int send_once(connection& c);
+    int cancel_query(connection& c, uint64_t seq);
+
+    // responses of resumed queries, they're cached here if caching is enabled
+    template<typename T>
+    int response_ok(deferred_id id, const T& obj);
+    int response_ok(deferred_id id, std::string&& str);
+
+    uint64_t cache_version() const;
 
 private:
-    pg_conn* conn_;
+    std::vector<std::unique_ptr<connection>> conns_;
+    std::chrono::milliseconds                timeout_ = std::chrono::milliseconds(0);
+
+    std::unordered_map<std::string, std::string> cache_;
+    uint64_t                                     cache_version_ = 0;
+    size_t                                       cache_size_    = 0;
+    const task*                                  responding_    = nullptr;  // task whose result is being resumed
 
-    bool                         sending_;
-    std::queue<task>             tasks_;
-    boost::asio::io_context&     io_serv_;
-    chain::controller&           chain_;
-    boost::asio::ip::tcp::socket socket_;
+    boost::asio::io_context& io_serv_;
+    chain::controller&       chain_;
 };
 
 }  // namespace evt
\ No newline at end of file
@@ -24,6 +24,8 @@ using evt::chain::symbol_id_type;
 using evt::chain::token_name;
 using evt::chain::transaction_id_type;
 
+using deferred_id = uint64_t;  // same as the one in http_plugin
+
 namespace history_apis {
 
 enum class direction : uint8_t {
@@ -40,7 +42,7 @@ public:
         std::vector<public_key_type> keys;
         optional<domain_name>        domain;
     };
-    void get_tokens_async(int id, const get_tokens_params& params);
+    void get_tokens_async(deferred_id id, const get_tokens_params& params);
 
     struct get_params {
         std::vector<public_key_type> keys;
@@ -49,9 +51,9 @@ public:
     using get_groups_params = get_params;
     using get_fungibles_params = get_params;
 
-    void get_domains_async(int id, const get_params& params);
-    void get_groups_async(int id, const get_params& params);
-    void get_fungibles_async(int id, const get_params& params);
+    void get_domains_async(deferred_id id, const get_params& params);
+    void get_groups_async(deferred_id id, const get_params& params);
+    void get_fungibles_async(deferred_id id, const get_params& params);
 
     struct get_actions_params {
         std::string                                 domain;
@@ -60,8 +62,9 @@ public:
         optional<fc::enum_type<uint8_t, direction>> dire;
         optional<int>                               skip;
         optional<int>                               take;
+        optional<std::string>                       cursor;  // empty for first page, `skip` is ignored if it's provided
     };
-    void get_actions_async(int id, const get_actions_params& params);
+    void get_actions_async(deferred_id id, const get_actions_params& params);
 
     struct get_fungible_actions_params {
         symbol_id_type                              sym_id;
@@ -69,18 +72,19 @@ public:
         optional<address>                           addr;
         optional<int>                               skip;
         optional<int>                               take; 
+        optional<std::string>                       cursor;  // empty for first page, `skip` is ignored if it's provided
     };
-    void get_fungible_actions_async(int id, const get_fungible_actions_params& params);
+    void get_fungible_actions_async(deferred_id id, const get_fungible_actions_params& params);
 
     struct get_fungibles_balance_params {
         address addr;
     };
-    void get_fungibles_balance_async(int id, const get_fungibles_balance_params& params);
+    void get_fungibles_balance_async(deferred_id id, const get_fungibles_balance_params& params);
 
     struct get_transaction_params {
         transaction_id_type id;
     };
-    void get_transaction_async(int id, const get_transaction_params& params);
+    void get_transaction_async(deferred_id id, const get_transaction_params& params);
 
     struct get_transactions_params {
         std::vector<public_key_type>                keys;
@@ -88,16 +92,16 @@ public:
         optional<int>                               skip;
         optional<int>                               take;
     };
-    void get_transactions_async(int id, const get_transactions_params& params);
+    void get_transactions_async(deferred_id id, const get_transactions_params& params);
 
     struct get_fungible_ids_params {
         optional<int> skip;
         optional<int> take;
     };
-    void get_fungible_ids_async(int id, const get_fungible_ids_params& params);
+    void get_fungible_ids_async(deferred_id id, const get_fungible_ids_params& params);
 
     using get_transaction_actions_params = get_transaction_params;
-    void get_transaction_actions_async(int id, const get_transaction_actions_params& params);
+    void get_transaction_actions_async(deferred_id id, const get_transaction_actions_params& params);
 
 private:
     const history_plugin& plugin_;
@@ -123,6 +127,10 @@ public:
 
 private:
     std::unique_ptr<class history_plugin_impl> my_;
+    uint32_t query_connections_ = 1;
+    uint32_t query_timeout_ms_  = 0;
+    uint32_t cache_size_        = 0;
+
     friend class history_apis::read_only;
 };
 
@@ -131,8 +139,8 @@ private:
 FC_REFLECT_ENUM(evt::history_apis::direction, (asc)(desc));
 FC_REFLECT(evt::history_apis::read_only::get_params, (keys));
 FC_REFLECT(evt::history_apis::read_only::get_tokens_params, (keys)(domain));
-FC_REFLECT(evt::history_apis::read_only::get_actions_params, (domain)(key)(dire)(names)(skip)(take));
-FC_REFLECT(evt::history_apis::read_only::get_fungible_actions_params, (sym_id)(dire)(addr)(skip)(take));
+FC_REFLECT(evt::history_apis::read_only::get_actions_params, (domain)(key)(dire)(names)(skip)(take)(cursor));
+FC_REFLECT(evt::history_apis::read_only::get_fungible_actions_params, (sym_id)(dire)(addr)(skip)(take)(cursor));
 FC_REFLECT(evt::history_apis::read_only::get_fungibles_balance_params, (addr));
 FC_REFLECT(evt::history_apis::read_only::get_transaction_params, (id));
 FC_REFLECT(evt::history_apis::read_only::get_transactions_params, (keys)(dire)(skip)(take));
@@ -19,7 +19,11 @@ http_client_plugin::set_program_options(options_description&, options_descriptio
         ("https-client-root-cert", boost::program_options::value<vector<string>>()->composing()->multitoken(),
             "PEM encoded trusted root certificate (or path to file containing one) used to validate any TLS connections made.  (may specify multiple times)\n")
         ("https-client-validate-peers", boost::program_options::value<bool>()->default_value(true),
-            "true: validate that the peer certificates are valid and trusted, false: ignore cert errors");
+            "true: validate that the peer certificates are valid and trusted, false: ignore cert errors")
+        ("http-client-max-idle-connections", boost::program_options::value<uint32_t>()->default_value(2),
+            "Max idle keep-alive connections kept for each host, 0 to close connections after each request")
+        ("http-client-idle-timeout", boost::program_options::value<uint32_t>()->default_value(60),
+            "Seconds an idle keep-alive connection is kept before it's closed");
 }
 
 void
@@ -52,6 +56,8 @@ http_client_plugin::plugin_initialize(const variables_map& options) {
         }
 
         my->set_verify_peers(options.at("https-client-validate-peers").as<bool>());
+        my->set_pool_limits(options.at("http-client-max-idle-connections").as<uint32_t>(),
+                            fc::seconds(options.at("http-client-idle-timeout").as<uint32_t>()));
     }
     FC_LOG_AND_RETHROW();
 }
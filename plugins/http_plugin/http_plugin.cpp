@@ -4,9 +4,15 @@
  */
 #include <evt/http_plugin/http_plugin.hpp>
 
+#include <array>
+#include <atomic>
+#include <cstdlib>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <shared_mutex>
 #include <thread>
+#include <tuple>
 #include <type_traits>
 #include <regex>
 
@@ -16,8 +22,12 @@
 #include <fc/network/ip.hpp>
 #include <fc/reflect/variant.hpp>
 
+#include <boost/algorithm/string.hpp>
 #include <boost/asio.hpp>
 
+#include <zlib.h>
+#include <zstd.h>
+
 #include <websocketpp/client.hpp>
 #include <websocketpp/config/asio.hpp>
 #include <websocketpp/config/asio_client.hpp>
@@ -25,7 +35,10 @@
 #include <websocketpp/server.hpp>
 
 #include <evt/chain/exceptions.hpp>
+#include <evt/chain/plugin_interface.hpp>
 #include <evt/http_plugin/local_endpoint.hpp>
+#include <evt/utilities/thread_affinity.hpp>
+#include <evt/utilities/trace.hpp>
 
 namespace evt {
 
@@ -71,7 +84,8 @@ struct asio_with_stub_log : public websocketpp::config::asio {
 
     typedef base::rng_type rng_type;
 
-    static bool const enable_multithreading = false;
+    // connections are served by a pool of threads, each one has its own strand
+    static bool const enable_multithreading = true;
 
     struct transport_config : public base::transport_config {
         typedef type::concurrency_type concurrency_type;
@@ -81,7 +95,7 @@ struct asio_with_stub_log : public websocketpp::config::asio {
         typedef type::response_type    response_type;
         typedef TSOCKET                socket_type;
 
-        static bool const enable_multithreading = false;
+        static bool const enable_multithreading = true;
     };
 
     typedef TENDPOINT<transport_config> transport_type;
@@ -105,6 +119,203 @@ using io_work_t                   = boost::asio::executor_work_guard<boost::asio
 
 static bool verbose_http_errors = false;
 
+// histogram with buckets of power of 2, bucket i counts the values within [2^(i-1), 2^i)
+// it's recorded in both main thread and http threads
+struct histogram {
+    static const int kBuckets = 32;
+
+    std::array<std::atomic<uint64_t>, kBuckets> buckets = {};
+    std::atomic<uint64_t>                       count   = {0};
+    std::atomic<uint64_t>                       sum     = {0};
+
+    void
+    record(uint64_t v) {
+        auto i = (v == 0) ? 0 : std::min(64 - __builtin_clzll(v), kBuckets - 1);
+        buckets[i].fetch_add(1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(v, std::memory_order_relaxed);
+    }
+
+    void
+    print(std::string& out, const std::string& name, const std::string& endpoint) const {
+        auto labels = "endpoint=\"" + endpoint + "\"";
+        auto n      = 0ul;
+        for(auto i = 0; i < kBuckets - 1; i++) {
+            n += buckets[i].load(std::memory_order_relaxed);
+            out += name + "_bucket{" + labels + ",le=\"" + std::to_string((1ul << i) - 1) + "\"} " + std::to_string(n) + "\n";
+        }
+        out += name + "_bucket{" + labels + ",le=\"+Inf\"} " + std::to_string(count.load(std::memory_order_relaxed)) + "\n";
+        out += name + "_sum{" + labels + "} " + std::to_string(sum.load(std::memory_order_relaxed)) + "\n";
+        out += name + "_count{" + labels + "} " + std::to_string(count.load(std::memory_order_relaxed)) + "\n";
+    }
+};
+
+// times are in microseconds
+// exec time includes the serialization of response which is done by handlers,
+// send time is from response is returned until it's sent, which includes the compression
+struct endpoint_metrics {
+    histogram queue_time;
+    histogram exec_time;
+    histogram send_time;
+    histogram response_size;
+};
+
+// classes of requests, each one has its own rate limit and priority in main thread
+enum class request_class { write = 0, read, scan };
+
+const char* request_class_names[] = { "write", "read", "scan" };
+
+// token bucket limiting the rate of one class of requests, it's used in http threads
+struct token_bucket {
+    double         rate   = 0;  // requests per second, 0 means unlimited
+    double         burst  = 0;
+    double         tokens = 0;
+    fc::time_point last;
+    std::mutex     mutex;
+
+    bool
+    try_take() {
+        if(rate == 0) {
+            return true;
+        }
+
+        auto lock = std::lock_guard<std::mutex>(mutex);
+        auto now  = fc::time_point::now();
+
+        tokens = std::min(burst, tokens + (now - last).count() * rate / 1000000);
+        last   = now;
+        if(tokens < 1) {
+            return false;
+        }
+        tokens -= 1;
+        return true;
+    }
+};
+
+namespace compress {
+
+enum class encoding { none = 0, gzip, zstd };
+
+// picks the encoding accepted by client, zstd is preferred
+encoding
+negotiate(const std::string& accept_encoding) {
+    auto encs = std::vector<std::string>();
+    boost::split(encs, accept_encoding, boost::is_any_of(","));
+
+    auto r = encoding::none;
+    for(auto& e : encs) {
+        auto name = e.substr(0, e.find(';'));
+        boost::trim(name);
+        boost::to_lower(name);
+
+        auto q = e.find("q=");
+        if(q != std::string::npos && std::atof(e.c_str() + q + 2) <= 0) {
+            continue;  // q=0 means not acceptable
+        }
+        if(name == "zstd") {
+            return encoding::zstd;
+        }
+        if(name == "gzip") {
+            r = encoding::gzip;
+        }
+    }
+    return r;
+}
+
+optional<std::string>
+gzip(const std::string& in) {
+    auto zs = z_stream();
+    if(deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16 /* gzip header */, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return std::nullopt;
+    }
+
+    auto out = std::string();
+    out.resize(deflateBound(&zs, in.size()));
+
+    zs.next_in   = (Bytef*)in.data();
+    zs.avail_in  = in.size();
+    zs.next_out  = (Bytef*)out.data();
+    zs.avail_out = out.size();
+
+    auto r = deflate(&zs, Z_FINISH);
+    deflateEnd(&zs);
+    if(r != Z_STREAM_END) {
+        return std::nullopt;
+    }
+    out.resize(zs.total_out);
+    return out;
+}
+
+optional<std::string>
+zstd(const std::string& in) {
+    auto out = std::string();
+    out.resize(ZSTD_compressBound(in.size()));
+
+    auto sz = ZSTD_compress(out.data(), out.size(), in.data(), in.size(), 3 /* default level */);
+    if(ZSTD_isError(sz)) {
+        return std::nullopt;
+    }
+    out.resize(sz);
+    return out;
+}
+
+}  // namespace compress
+
+// slots of deferred connections with a stack of free ones, so allocating and releasing are both O(1).
+// ids are tagged with the generation of slot, ids of the connections already released are stale and ignored
+template <typename ConnPtr>
+struct deferred_slots {
+    struct slot {
+        ConnPtr  con;
+        uint32_t gen = 0;
+    };
+
+    std::vector<slot>     slots;
+    std::vector<uint32_t> frees;
+
+    void
+    reset(size_t size) {
+        slots.clear();
+        slots.resize(size);
+        frees.resize(size);
+        for(auto i = 0u; i < size; i++) {
+            frees[i] = size - i - 1;  // lower slots are used first
+        }
+    }
+
+    size_t count() const { return slots.size() - frees.size(); }
+
+    // returns index of the slot, or -1 if all are used
+    int64_t
+    alloc(const ConnPtr& con) {
+        if(frees.empty()) {
+            return -1;
+        }
+        auto index = frees.back();
+        frees.pop_back();
+        slots[index].con = con;
+        return index;
+    }
+
+    void
+    release(uint32_t index) {
+        auto& s = slots[index];
+        s.con = nullptr;
+        s.gen = (s.gen + 1) & kMaxGen;
+        frees.push_back(index);
+    }
+
+    static const uint32_t kMaxGen = 0x7fffffff;
+};
+
+// layout of deferred id: https flag(1 bit), generation(31 bits), index(32 bits)
+const deferred_id kHttpsFlag = (deferred_id)1 << 63;
+
+inline deferred_id
+make_deferred_id(bool https, uint32_t gen, uint32_t index) {
+    return (https ? kHttpsFlag : 0) | ((deferred_id)gen << 32) | index;
+}
+
 class http_plugin_impl {
 public:
     http_plugin_impl() {}
@@ -113,6 +324,7 @@ public:
     map<string, url_handler>          url_handlers;
     map<string, url_handler>          url_local_handlers;
     map<string, url_deferred_handler> url_deferred_handlers;
+    std::shared_mutex                 handlers_mutex;  // handlers are added by other plugins while server is running
     optional<tcp::endpoint>           listen_endpoint;
     string                            access_control_allow_origin;
     string                            access_control_allow_headers;
@@ -121,17 +333,14 @@ public:
     size_t                            max_body_size;
     size_t                            max_deferred_connection_size;
 
-    vector<http_connection_ptr_type>  http_conns;
-    vector<https_connection_ptr_type> https_conns;
-
-    size_t http_conn_index  = 0;
-    size_t https_conn_index = 0;
-    size_t http_conn_count  = 0;
-    size_t https_conn_count = 0;
+    deferred_slots<http_connection_ptr_type>  http_conns;
+    deferred_slots<https_connection_ptr_type> https_conns;
+    std::mutex                                conns_mutex;
 
     websocket_server_type server;
 
-    optional<std::thread>                    server_thread;
+    vector<std::thread>                      server_threads;
+    uint16_t                                 server_threads_num = 2;
     std::shared_ptr<boost::asio::io_context> server_ioc;
     optional<io_work_t>                      server_ioc_work;
     std::atomic<int64_t>                     bytes_in_flight{0};
@@ -149,6 +358,119 @@ public:
     bool        validate_host;
     set<string> valid_hosts;
     bool        http_no_response;
+    bool        http_compress     = false;
+    size_t      compress_min_size = 0;
+
+    std::array<token_bucket, 3>   class_buckets;
+    map<string, request_class>    endpoint_classes;  // classes configured explicitly, fixed after initialized
+
+    // writes are pushes, scans are the queries of ranges or history, all the others are reads
+    request_class
+    get_request_class(const string& resource) const {
+        if(auto it = endpoint_classes.find(resource); it != endpoint_classes.end()) {
+            return it->second;
+        }
+        if(resource.find("/push_") != string::npos) {
+            return request_class::write;
+        }
+        if(boost::starts_with(resource, "/v1/history/") || resource == "/v1/evt/get_tokens" || resource == "/v1/evt/get_owned_tokens") {
+            return request_class::scan;
+        }
+        return request_class::read;
+    }
+
+    static int
+    get_priority(request_class cls) {
+        switch(cls) {
+        case request_class::write: return appbase::priority::low;
+        case request_class::read:  return appbase::priority::low;
+        case request_class::scan:  return appbase::priority::lowest;
+        }  // switch
+        return appbase::priority::low;
+    }
+
+    bool                                             http_metrics = false;
+    map<string, std::unique_ptr<endpoint_metrics>>   endpoints_metrics;  // guarded by handlers_mutex
+    vector<std::tuple<string, string, metric_gauge>> gauges;             // guarded by handlers_mutex
+
+    std::atomic<uint32_t> head_block_num{0};
+    std::atomic<uint32_t> lib_num{0};
+    std::atomic<uint64_t> trxs_num{0};
+
+    chain::plugin_interface::channels::accepted_block::channel_type::handle     accepted_block_subscription;
+    chain::plugin_interface::channels::irreversible_block::channel_type::handle irreversible_block_subscription;
+
+    static uint64_t
+    elapsed_us(fc::time_point start) {
+        return (fc::time_point::now() - start).count();
+    }
+
+    endpoint_metrics*
+    get_metrics(const string& resource) {
+        if(!http_metrics) {
+            return nullptr;
+        }
+        auto it = endpoints_metrics.find(resource);
+        return it != endpoints_metrics.end() ? it->second.get() : nullptr;
+    }
+
+    std::string
+    render_metrics() {
+        auto out  = std::string();
+        auto lock = std::shared_lock<std::shared_mutex>(handlers_mutex);
+
+        auto print_histograms = [&](auto name, auto help, auto field) {
+            out += std::string("# HELP ") + name + " " + help + "\n";
+            out += std::string("# TYPE ") + name + " histogram\n";
+            for(auto& it : endpoints_metrics) {
+                (it.second.get()->*field).print(out, name, it.first);
+            }
+        };
+        print_histograms("evt_http_queue_time_us", "Time from request is accepted until handler starts in main thread", &endpoint_metrics::queue_time);
+        print_histograms("evt_http_exec_time_us", "Time of handler executing and serializing the response", &endpoint_metrics::exec_time);
+        print_histograms("evt_http_send_time_us", "Time from response is returned by handler until it's sent", &endpoint_metrics::send_time);
+        print_histograms("evt_http_response_size_bytes", "Size of the response bodies", &endpoint_metrics::response_size);
+
+        for(auto& [name, help, gauge] : gauges) {
+            out += "# HELP " + name + " " + help + "\n";
+            out += "# TYPE " + name + " gauge\n";
+            out += name + " " + std::to_string(gauge()) + "\n";
+        }
+        return out;
+    }
+
+    // sets the body of response, compresses it if it's large enough and client accepts
+    // it's called in the http threads instead of main thread
+    template <typename ConPtr>
+    void
+    set_body(ConPtr& con, std::string body) {
+        if(http_no_response) {
+            return;
+        }
+        if(http_compress && body.size() >= compress_min_size) {
+            auto enc  = compress::negotiate(con->get_request_header("Accept-Encoding"));
+            auto data = optional<std::string>();
+            switch(enc) {
+            case compress::encoding::gzip: {
+                data = compress::gzip(body);
+                break;
+            }
+            case compress::encoding::zstd: {
+                data = compress::zstd(body);
+                break;
+            }
+            default: break;
+            }  // switch
+
+            con->append_header("Vary", "Accept-Encoding");
+            if(data.has_value() && data->size() < body.size()) {
+                con->append_header("Content-Encoding", enc == compress::encoding::gzip ? "gzip" : "zstd");
+                con->set_body(std::move(*data));
+                return;
+            }
+        }
+        con->set_body(std::move(body));
+    }
 
     bool
     host_port_is_valid(const std::string& header_host_port, const string& endpoint_local_host_port) {
@@ -250,41 +572,51 @@ public:
         }
     }
 
+    // handlers run in main thread while connections are only safe to touch in server threads, so the error
+    // response is sent there as the normal ones
+    template <typename T>
+    void
+    post_exception(const std::shared_ptr<boost::asio::io_context>& ioc, typename websocketpp::server<T>::connection_ptr con) {
+        boost::asio::post(*ioc, [this, e = std::current_exception(), con] {
+            try {
+                std::rethrow_exception(e);
+            }
+            catch(...) {
+                handle_exception<T>(con);
+                con->send_http_response();
+            }
+        });
+    }
+
     template <typename T>
     deferred_id
     alloc_deferred_id(typename websocketpp::server<T>::connection_ptr con) {
-        if(http_conn_count + https_conn_count >= max_deferred_connection_size) {
+        auto lock = std::lock_guard<std::mutex>(conns_mutex);
+        if(http_conns.count() + https_conns.count() >= max_deferred_connection_size) {
             EVT_THROW2(chain::exceed_deferred_request, "Exceed max allowed deferred connections, max: {}", max_deferred_connection_size);
         }
 
+        auto index = (int64_t)-1;
+        auto gen   = 0u;
         if constexpr (std::is_same_v<T, http_config>) {
             // http
-            assert(http_conns.size() == max_deferred_connection_size);
-            for(auto i = http_conn_index; i < http_conn_index + max_deferred_connection_size; i++) {
-                auto j = i % max_deferred_connection_size;
-                if(http_conns[j] == nullptr) {
-                    http_conns[j]   = con;
-                    http_conn_index = j + 1; // next slot
-                    http_conn_count++;
-                    return j;
-                }
+            index = http_conns.alloc(con);
+            if(index >= 0) {
+                gen = http_conns.slots[index].gen;
             }
         }
         if constexpr (std::is_same_v<T, https_config>) {
             // https
-            assert(https_conns.size() == max_deferred_connection_size);
-            for(auto i = https_conn_index; i < https_conn_index + max_deferred_connection_size; i++) {
-                auto j = i % max_deferred_connection_size;
-                if(https_conns[j] == nullptr) {
-                    https_conns[j]   = con;
-                    https_conn_index = j + 1; // next slot
-                    https_conn_count++;
-                    return j | (1 << 31);
-                }
+            index = https_conns.alloc(con);
+            if(index >= 0) {
+                gen = https_conns.slots[index].gen;
             }
         }
-        EVT_THROW2(chain::alloc_deferred_fail,
-            "Alloc deferred id failed, http index: {}, https index: {}", http_conn_index, https_conn_index);
+        if(index < 0) {
+            EVT_THROW2(chain::alloc_deferred_fail,
+                "Alloc deferred id failed, http count: {}, https count: {}", http_conns.count(), https_conns.count());
+        }
+        return make_deferred_id(std::is_same_v<T, https_config>, gen, index);
     }
 
     template<class T>
@@ -341,35 +673,75 @@ public:
                 return;
             }
 
-            auto body     = con->get_request_body();
             auto resource = con->get_uri()->get_resource();
+            auto cls      = get_request_class(resource);
+            auto priority = get_priority(cls);
 
+            if constexpr (!std::is_same_v<T, local_config>) {
+                // shed the requests over budget before the body is touched
+                if(!class_buckets[(int)cls].try_take()) {
+                    dlog2("429 - too many {} requests: {}", request_class_names[(int)cls], resource);
+                    error_results results{websocketpp::http::status_code::too_many_requests, "Too Many Requests", error_results::error_info()};
+                    con->set_body(fc::json::to_string(results));
+                    con->set_status(websocketpp::http::status_code::too_many_requests);
+                    return;
+                }
+            }
+
+            auto body = con->get_request_body();
+
+            if(http_metrics && resource == "/metrics") {
+                // served in http threads directly, so it's not affected by the queueing of main thread
+                con->replace_header("Content-Type", "text/plain; version=0.0.4");
+                con->set_body(render_metrics());
+                con->set_status(websocketpp::http::status_code::ok);
+                return;
+            }
+
+            auto accepted = fc::time_point::now();
+
+            auto lock = std::shared_lock<std::shared_mutex>(handlers_mutex);
             {
                 auto handler_itr = url_handlers.find(resource);
                 if(handler_itr != url_handlers.cend()) {
+                    auto metrics = get_metrics(resource);
+
                     con->defer_http_response();
                     bytes_in_flight += body.size();
-                    app().post(appbase::priority::low,
-                        [this, ioc = this->server_ioc, handler_itr, resource{std::move(resource)}, body{std::move(body)}, con] {
+                    app().post(priority,
+                        [this, ioc = this->server_ioc, handler_itr, resource{std::move(resource)}, body{std::move(body)}, con, metrics, accepted] {
                             this->bytes_in_flight -= body.size();
+
+                            auto started = fc::time_point::now();
+                            if(metrics != nullptr) {
+                                metrics->queue_time.record((started - accepted).count());
+                            }
                             try {
+                                EVT_TRACE_SPAN("http_plugin::handler", body.size());
                                 handler_itr->second(resource, body,
-                                    [this, ioc{std::move(ioc)}, con](auto code, auto response_body) {
+                                    [this, ioc, con, metrics, started](auto code, auto response_body) {
+                                        auto returned = fc::time_point::now();
+                                        if(metrics != nullptr) {
+                                            metrics->exec_time.record((returned - started).count());
+                                            metrics->response_size.record(response_body.size());
+                                        }
+
                                         this->bytes_in_flight += response_body.size();
-                                        boost::asio::post(*ioc, [this, response_body{std::move(response_body)}, con, code]() {
+                                        boost::asio::post(*ioc, [this, response_body{std::move(response_body)}, con, code, metrics, returned]() {
                                             size_t body_size = response_body.size();
-                                            if(!this->http_no_response) {
-                                                con->set_body(std::move(response_body));
-                                            }
+                                            this->set_body(con, std::move(response_body));
                                             con->set_status(websocketpp::http::status_code::value(code));
                                             con->send_http_response();
                                             this->bytes_in_flight -= body_size;
+
+                                            if(metrics != nullptr) {
+                                                metrics->send_time.record(elapsed_us(returned));
+                                            }
                                         });
                                     });
                             }
                             catch(...) {
-                                handle_exception<T>(con);
-                                con->send_http_response();
+                                post_exception<T>(ioc, con);
                             }
                         });
                     return;
@@ -388,16 +760,27 @@ public:
                         this->visit_connection(id, [](auto) { return false; });
                     });
 
+                    auto metrics = get_metrics(resource);
+
                     bytes_in_flight += body.size();
-                    app().post(appbase::priority::low,
-                        [this, deferred_handler_it, resource{std::move(resource)}, body{std::move(body)}, con, id]() {
+                    app().post(priority,
+                        [this, ioc = this->server_ioc, deferred_handler_it, resource{std::move(resource)}, body{std::move(body)}, con, id, metrics, accepted]() {
                             this->bytes_in_flight -= body.size();
+
+                            auto started = fc::time_point::now();
+                            if(metrics != nullptr) {
+                                // responses of deferred handlers are set later and only the handler call is timed
+                                metrics->queue_time.record((started - accepted).count());
+                            }
                             try {
+                                EVT_TRACE_SPAN("http_plugin::deferred_handler", body.size());
                                 deferred_handler_it->second(resource, body, id);
                             }
                             catch(...) {
-                                handle_exception<T>(con);
-                                con->send_http_response();
+                                post_exception<T>(ioc, con);
+                            }
+                            if(metrics != nullptr) {
+                                metrics->exec_time.record(elapsed_us(started));
                             }
                          });
                     return;
@@ -412,25 +795,24 @@ public:
                         [this, ioc = this->server_ioc, handler_itr, resource{std::move(resource)}, body{std::move(body)}, con] {
                             try {
                                 handler_itr->second(resource, body,
-                                    [this, ioc{std::move(ioc)}, con](auto code, auto response_body) {
+                                    [this, ioc, con](auto code, auto response_body) {
                                         boost::asio::post(*ioc, [this, response_body{std::move(response_body)}, con, code]() {
-                                            if(!this->http_no_response) {
-                                                con->set_body(std::move(response_body));
-                                            }
+                                            this->set_body(con, std::move(response_body));
                                             con->set_status(websocketpp::http::status_code::value(code));
                                             con->send_http_response();
                                         });
                                     });
                             }
                             catch(...) {
-                                handle_exception<T>(con);
-                                con->send_http_response();
+                                post_exception<T>(ioc, con);
                             }
                         });
                     return;
                 }
             }
 
+            lock.unlock();
+
             dlog("404 - not found: ${ep}", ("ep", resource));
             error_results results{websocketpp::http::status_code::not_found,
                                   "Not Found", error_results::error_info(fc::exception(FC_LOG_MESSAGE(error, "Unknown Endpoint")), verbose_http_errors)};
@@ -445,28 +827,29 @@ public:
     template<typename FUNC>
     void
     visit_connection(deferred_id id, FUNC&& vistor) {
-        if((id & (1 << 31)) == 0) {
-            // http
-            FC_ASSERT(id < max_deferred_connection_size);
-            auto con = http_conns[id];
-            FC_ASSERT(con != nullptr);
-
-            if(!vistor(con)) {
-                http_conns[id] = nullptr;
-                http_conn_count--;
+        auto lock  = std::lock_guard<std::mutex>(conns_mutex);
+        auto gen   = (uint32_t)(id >> 32) & deferred_slots<http_connection_ptr_type>::kMaxGen;
+        auto index = (uint32_t)id;
+
+        auto visit = [&](auto& conns) {
+            FC_ASSERT(index < conns.slots.size());
+            auto& s = conns.slots[index];
+            if(s.con == nullptr || s.gen != gen) {
+                // connection is already released, slot may be used by another one
+                return;
+            }
+            if(!vistor(s.con)) {
+                conns.release(index);
             }
+        };
+
+        if((id & kHttpsFlag) == 0) {
+            // http
+            visit(http_conns);
         }
         else {
             // https
-            auto index = id & (0xFFFFFFFF >> 1);
-            FC_ASSERT(index < max_deferred_connection_size);
-            auto con = https_conns[index];
-            FC_ASSERT(con != nullptr);
-
-            if(!vistor(con)) {
-                https_conns[index] = nullptr;
-                https_conn_count--;
-            }
+            visit(https_conns);
         }
     }
 
@@ -477,9 +860,7 @@ public:
             boost::asio::post(*server_ioc, [this, id, code, body{std::move(body)}] {
                 visit_connection(id, [this, code, body{std::move(body)}](auto con) {
                     auto body_size = body.size();
-                    if(!this->http_no_response) {
-                        con->set_body(std::move(body));
-                    }
+                    this->set_body(con, std::move(body));
                     con->set_status(websocketpp::http::status_code::value(code));
                     con->send_http_response();
                     this->bytes_in_flight -= body_size;
@@ -496,7 +877,7 @@ public:
     create_server_for_endpoint(const tcp::endpoint& ep, websocketpp::server<T>& ws) {
         try {
             ws.clear_access_channels(websocketpp::log::alevel::all);
-            ws.init_asio(&app().get_io_service());
+            ws.init_asio(&(*server_ioc));
             ws.set_reuse_addr(true);
             ws.set_max_http_body_size(max_body_size);
             ws.set_http_handler([&](connection_hdl hdl) {
@@ -563,6 +944,15 @@ http_plugin::set_program_options(options_description&, options_description& cfg)
         ("http-alias", bpo::value<std::vector<string>>()->composing(),
             "Additionaly acceptable values for the \"Host\" header of incoming HTTP requests, can be specified multiple times.  Includes http/s_server_address by default.")
         ("http-no-response", bpo::bool_switch()->default_value(false), "special for load-testing, response all the requests with empty body")
+        ("http-threads", bpo::value<uint16_t>()->default_value(2), "Number of worker threads in http thread pool")
+        ("http-class-limit", bpo::value<vector<string>>()->composing(),
+            "Limit the rate of one class of requests in the format CLASS:RATE[:BURST], CLASS is one of write, read and scan, "
+            "RATE is requests per second and BURST is RATE by default. Requests over the limit are rejected with 429")
+        ("http-request-class", bpo::value<vector<string>>()->composing(),
+            "Override the class of one endpoint in the format URL=CLASS, by default pushes are writes, history and token list queries are scans, the others are reads")
+        ("http-metrics", bpo::bool_switch()->default_value(false), "Serve latency histograms of endpoints and chain counters on /metrics in Prometheus format")
+        ("http-compress", bpo::bool_switch()->default_value(false), "Compress responses with zstd or gzip if client accepts either of them")
+        ("http-compress-min-size", bpo::value<uint32_t>()->default_value(1024), "Minimum size in bytes of the responses to be compressed")
         ;
 }
 
@@ -575,6 +965,38 @@ http_plugin::plugin_initialize(const variables_map& options) {
             my->valid_hosts.insert(aliases.begin(), aliases.end());
         }
 
+        auto parse_class = [](const string& name) {
+            for(auto i = 0u; i < std::size(request_class_names); i++) {
+                if(name == request_class_names[i]) {
+                    return (request_class)i;
+                }
+            }
+            EVT_THROW(chain::plugin_config_exception, "Unknown request class: ${c}", ("c", name));
+        };
+
+        if(options.count("http-class-limit")) {
+            for(auto& limit : options.at("http-class-limit").as<vector<string>>()) {
+                auto parts = vector<string>();
+                boost::split(parts, limit, boost::is_any_of(":"));
+                EVT_ASSERT(parts.size() == 2 || parts.size() == 3, chain::plugin_config_exception, "Invalid http-class-limit: ${l}", ("l", limit));
+
+                auto& bucket = my->class_buckets[(int)parse_class(parts[0])];
+                bucket.rate   = std::stod(parts[1]);
+                bucket.burst  = (parts.size() == 3) ? std::stod(parts[2]) : bucket.rate;
+                bucket.tokens = bucket.burst;
+                bucket.last   = fc::time_point::now();
+                EVT_ASSERT(bucket.rate >= 0 && bucket.burst >= 1, chain::plugin_config_exception, "Invalid http-class-limit: ${l}", ("l", limit));
+            }
+        }
+
+        if(options.count("http-request-class")) {
+            for(auto& c : options.at("http-request-class").as<vector<string>>()) {
+                auto pos = c.find('=');
+                EVT_ASSERT(pos != string::npos, chain::plugin_config_exception, "Invalid http-request-class: ${c}", ("c", c));
+                my->endpoint_classes[c.substr(0, pos)] = parse_class(c.substr(pos + 1));
+            }
+        }
+
         tcp::resolver resolver(app().get_io_service());
 
         if(current_http_plugin_defaults.default_http_port > 0 && options.count("http-server-address") && options.at("http-server-address").as<string>().length()) {
@@ -649,9 +1071,14 @@ http_plugin::plugin_initialize(const variables_map& options) {
         my->max_bytes_in_flight          = options.at("http-max-bytes-in-flight-mb").as<uint32_t>() * 1024 * 1024;
         my->max_deferred_connection_size = options.at("max-deferred-connection-size").as<uint32_t>();
         my->http_no_response             = options.at("http-no-response").as<bool>();
+        my->server_threads_num           = options.at("http-threads").as<uint16_t>();
+        my->http_compress                = options.at("http-compress").as<bool>();
+        my->http_metrics                 = options.at("http-metrics").as<bool>();
+        my->compress_min_size            = options.at("http-compress-min-size").as<uint32_t>();
         verbose_http_errors              = options.at("verbose-http-errors").as<bool>();
 
         FC_ASSERT(my->max_deferred_connection_size < std::numeric_limits<int32_t>::max());
+        EVT_ASSERT(my->server_threads_num > 0, chain::plugin_config_exception, "http-threads ${num} must be greater than 0", ("num", my->server_threads_num));
 
         //watch out for the returns above when adding new code here
     }
@@ -662,15 +1089,16 @@ void
 http_plugin::plugin_startup() {
     my->server_ioc = std::make_shared<boost::asio::io_context>();
     my->server_ioc_work.emplace(boost::asio::make_work_guard(*my->server_ioc));
-    my->server_thread.emplace([ioc = my->server_ioc] {
-        ioc->run();
-    });
+    for(auto i = 0; i < my->server_threads_num; i++) {
+        my->server_threads.emplace_back([ioc = my->server_ioc, i] {
+            evt::utilities::affinity::enter_pool("http", i);
+            ioc->run();
+        });
+    }
 
     if(my->listen_endpoint.has_value()) {
         try {
-            my->http_conns.resize(my->max_deferred_connection_size);
-            my->http_conn_index = 0;
-            my->http_conn_count = 0;
+            my->http_conns.reset(my->max_deferred_connection_size);
 
             my->create_server_for_endpoint(*my->listen_endpoint, my->server);
 
@@ -719,9 +1147,7 @@ http_plugin::plugin_startup() {
 
     if(my->https_listen_endpoint.has_value()) {
         try {
-            my->https_conns.resize(my->max_deferred_connection_size);
-            my->https_conn_index = 0;
-            my->https_conn_count = 0;
+            my->https_conns.reset(my->max_deferred_connection_size);
 
             my->create_server_for_endpoint(*my->https_listen_endpoint, my->https_server);
             my->https_server.set_tls_init_handler([this](websocketpp::connection_hdl hdl) -> ssl_context_ptr {
@@ -746,6 +1172,22 @@ http_plugin::plugin_startup() {
         }
     }
 
+    if(my->http_metrics) {
+        using namespace chain::plugin_interface;
+
+        my->accepted_block_subscription = app().get_channel<channels::accepted_block>().subscribe([this](auto& bsp) {
+            my->head_block_num = bsp->block_num;
+            my->trxs_num += bsp->block->transactions.size();
+        });
+        my->irreversible_block_subscription = app().get_channel<channels::irreversible_block>().subscribe([this](auto& bsp) {
+            my->lib_num = bsp->block_num;
+        });
+
+        add_metric("evt_chain_head_block_num", "Number of the last accepted block", [this] { return my->head_block_num.load(); });
+        add_metric("evt_chain_lib_num", "Number of the last irreversible block", [this] { return my->lib_num.load(); });
+        add_metric("evt_chain_block_trxs_total", "Number of transactions in accepted blocks", [this] { return my->trxs_num.load(); });
+    }
+
     add_api({{
         std::string("/v1/node/get_supported_apis"),
         [&](string, string body, url_response_callback cb) mutable {
@@ -778,10 +1220,10 @@ http_plugin::plugin_shutdown() {
     if(my->server_ioc) {
         my->server_ioc->stop();
     }
-    if(my->server_thread.has_value()) {
-        my->server_thread->join();
-        my->server_thread.reset();
+    for(auto& t : my->server_threads) {
+        t.join();
     }
+    my->server_threads.clear();
 }
 
 void
@@ -792,8 +1234,10 @@ http_plugin::add_handler(const string& url, const url_handler& handler, bool loc
     else {
         ilog("add local only api url: ${c}", ("c", url));
     }
+    auto lock = std::unique_lock<std::shared_mutex>(my->handlers_mutex);
     if(!local_only) {
         my->url_handlers.insert(std::make_pair(url, handler));
+        my->endpoints_metrics.try_emplace(url, std::make_unique<endpoint_metrics>());
     }
     else {
         if(!my->unix_endpoint) {
@@ -806,16 +1250,21 @@ http_plugin::add_handler(const string& url, const url_handler& handler, bool loc
 void
 http_plugin::add_deferred_handler(const string& url, const url_deferred_handler& handler) {
     ilog("add deferred api url: ${c}", ("c", url));
-    boost::asio::post(app().get_io_service(), [=]() {
-        my->url_deferred_handlers.insert(std::make_pair(url, handler));
-    });
+    auto lock = std::unique_lock<std::shared_mutex>(my->handlers_mutex);
+    my->url_deferred_handlers.insert(std::make_pair(url, handler));
+    my->endpoints_metrics.try_emplace(url, std::make_unique<endpoint_metrics>());
+}
+
+void
+http_plugin::add_metric(const string& name, const string& help, const metric_gauge& gauge) {
+    auto lock = std::unique_lock<std::shared_mutex>(my->handlers_mutex);
+    my->gauges.emplace_back(name, help, gauge);
 }
 
 void
-http_plugin::set_deferred_response(deferred_id id, int code, const string& body) {
-    boost::asio::post(app().get_io_service(), [=]() {
-        my->set_deferred_response(id, code, body);
-    });
+http_plugin::set_deferred_response(deferred_id id, int code, string body) {
+    // it's thread safe, response is posted to http threads directly without waiting in main thread
+    my->set_deferred_response(id, code, std::move(body));
 }
 
 void
@@ -877,7 +1326,7 @@ http_plugin::handle_async_exception(deferred_id id, const char* api_name, const
     }
     catch(...) {
         http_plugin::handle_exception(api_name, call_name, body, [id](auto code, auto body) {
-            app().get_plugin<http_plugin>().set_deferred_response(id, code, body);
+            app().get_plugin<http_plugin>().set_deferred_response(id, code, std::move(body));
         });
     }
 }
@@ -903,6 +1352,7 @@ http_plugin::get_supported_apis_result
 http_plugin::get_supported_apis() const {
     get_supported_apis_result result;
 
+    auto lock = std::shared_lock<std::shared_mutex>(my->handlers_mutex);
     for(const auto& handler : my->url_handlers) {
         if(handler.first != "/v1/node/get_supported_apis") {
             result.apis.emplace_back(handler.first);
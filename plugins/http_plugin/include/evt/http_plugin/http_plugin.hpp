@@ -10,7 +10,7 @@
 namespace evt {
 using namespace appbase;
 
-using deferred_id = uint32_t;
+using deferred_id = uint64_t;
 
 /**
  * @brief A callback function provided to a URL handler to
@@ -44,6 +44,13 @@ using url_handler = std::function<void(string, string, url_response_callback)>;
  **/
 using url_deferred_handler = std::function<void(string, string, deferred_id)>;
 
+/**
+ * @brief Callback type for a gauge exposed on metrics endpoint
+ *
+ * It's called in the http threads, so it must be thread safe
+ **/
+using metric_gauge = std::function<int64_t()>;
+
 /**
  * @brief An API, containing URLs and handlers
  *
@@ -82,8 +89,8 @@ struct http_plugin_defaults {
  *  thread.  The callback can be called from any thread and will 
  *  automatically propagate the call to the http thread.
  *
- *  The HTTP service will run in its own thread with its own io_service to
- *  make sure that HTTP request processing does not interfer with other
+ *  The HTTP service will run in its own pool of threads with its own io_service
+ *  to make sure that HTTP request processing does not interfer with other
  *  plugins.  
  */
 class http_plugin : public appbase::plugin<http_plugin> {
@@ -118,7 +125,11 @@ public:
         }
     }
 
-    void set_deferred_response(deferred_id id, int code, const string& body);
+    // thread safe, body is moved to the connection to avoid copying large responses
+    void set_deferred_response(deferred_id id, int code, string body);
+
+    // gauges are exposed on /metrics in prometheus format if http-metrics is enabled
+    void add_metric(const string& name, const string& help, const metric_gauge& gauge);
 
     // standard exception handling for api handlers
     static void handle_exception(const char *api_name, const char *call_name, const string& body, url_response_callback cb);
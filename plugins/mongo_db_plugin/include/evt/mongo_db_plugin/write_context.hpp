@@ -4,9 +4,14 @@
  */
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <future>
 #include <string>
 #include <memory>
 #include <optional>
+#include <vector>
 #include <boost/scope_exit.hpp>
 #include <bsoncxx/exception/exception.hpp>
 #include <bsoncxx/json.hpp>
@@ -22,13 +27,13 @@ using mongocxx::database;
 using mongocxx::collection;
 using mongocxx::bulk_write;
 
-#define define_collection(n)                                        \
+#define define_collection(n, opts)                                   \
     collection                 n##_collection;                       \
     std::optional<bulk_write>  n##_commits;                          \
                                                                     \
     auto& get_##n() {                                               \
         if(!(n##_commits)) {                                        \
-            n##_commits = n##_collection.create_bulk_write(opts_);  \
+            n##_commits = n##_collection.create_bulk_write(opts);   \
         }                                                           \
         total_++;                                                   \
         return *n##_commits;                                        \
@@ -51,27 +56,41 @@ class write_context {
 public:
     write_context() {
         opts_.ordered(true);
+        unordered_opts_.ordered(false);
     }
 
 public:
-    define_collection(blocks);
-    define_collection(trxs);
-    define_collection(actions);
-    define_collection(domains);
-    define_collection(tokens);
-    define_collection(groups);
-    define_collection(fungibles);
+    // documents of other collections are inserted and then updated in the same batch, so keep them in order
+    // actions are insert only, server is free to apply them in any order
+    define_collection(blocks, opts_);
+    define_collection(trxs, opts_);
+    define_collection(actions, unordered_opts_);
+    define_collection(domains, opts_);
+    define_collection(tokens, opts_);
+    define_collection(groups, opts_);
+    define_collection(fungibles, opts_);
 
 public:
+    // each collection should be from its own client when writer threads is more than one
+    void
+    set_writer_threads(size_t threads) {
+        writer_threads_ = std::max(threads, (size_t)1);
+    }
+
     void
     execute() {
+        auto commits = std::array<std::function<void()>, 6> {
+            [this] { commit_collection(trxs); },
+            [this] { commit_collection(actions); },
+            [this] { commit_collection(domains); },
+            [this] { commit_collection(tokens); },
+            [this] { commit_collection(groups); },
+            [this] { commit_collection(fungibles); }
+        };
+        parallel_commit(commits);
+
+        // blocks are the sync point of database, they're only written after all the others of the batch are done
         commit_collection(blocks);
-        commit_collection(trxs);
-        commit_collection(actions);
-        commit_collection(domains);
-        commit_collection(tokens);
-        commit_collection(groups);
-        commit_collection(fungibles);
 
         total_ = 0;
     }
@@ -82,6 +101,31 @@ public:
     }
 
 private:
+    template<typename Commits>
+    void
+    parallel_commit(Commits& commits) {
+        auto n = std::min(writer_threads_, commits.size());
+        if(n <= 1) {
+            for(auto& c : commits) {
+                c();
+            }
+            return;
+        }
+
+        auto tasks = std::vector<std::future<void>>();
+        for(auto i = 0u; i < n; i++) {
+            tasks.emplace_back(std::async(std::launch::async, [i, n, &commits] {
+                for(auto j = i; j < commits.size(); j += n) {
+                    commits[j]();
+                }
+            }));
+        }
+        // exceptions are all handled within commits
+        for(auto& t : tasks) {
+            t.wait();
+        }
+    }
+
     void
     handle_mongo_exception(std::string desc) {
         bool shutdown = true;
@@ -136,7 +180,9 @@ private:
 
 private:
     mongocxx::options::bulk_write opts_;
-    size_t                        total_;
+    mongocxx::options::bulk_write unordered_opts_;
+    size_t                        writer_threads_ = 1;
+    size_t                        total_          = 0;
 };
 
 }  // namespace evt
@@ -7,9 +7,11 @@
 #include <evt/mongo_db_plugin/write_context.hpp>
 
 #include <functional>
+#include <future>
 #include <queue>
 #include <tuple>
 #include <thread>
+#include <vector>
 
 #if __has_include(<condition>)
 #include <condition>
@@ -28,7 +30,12 @@ using boost::condition_variable_any;
 #include <evt/chain/token_database.hpp>
 #include <evt/chain/contracts/evt_contract_abi.hpp>
 
-#include <evt/utilities/spinlock.hpp>
+#include <evt/utilities/adaptive_lock.hpp>
+#include <evt/utilities/spsc_queue.hpp>
+#include <evt/utilities/thread_affinity.hpp>
+
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
 
 #include <fc/io/json.hpp>
 #include <fc/variant.hpp>
@@ -53,8 +60,7 @@ using namespace chain;
 using namespace chain::contracts;
 using namespace chain::plugin_interface;
 
-using evt::utilities::spinlock;
-using evt::utilities::spinlock_guard;
+using evt::utilities::spsc_queue;
 
 static appbase::abstract_plugin& _mongo_db_plugin = app().register_plugin<mongo_db_plugin>();
 
@@ -62,6 +68,11 @@ class mongo_db_plugin_impl {
 private:
     using inblock_ptr = std::tuple<block_state_ptr, bool>; // true for irreversible block
 
+    struct trx_docs {
+        std::optional<bsoncxx::document::value> trx;
+        std::vector<bsoncxx::document::value>   actions;
+    };
+
 public:
     mongo_db_plugin_impl(const controller& control)
         : control_(control)
@@ -72,6 +83,7 @@ public:
 
 public:
     void consume_queues();
+    fc::variant get_memory_usage() const;  // sizes of queues, items hold the block states and traces
 
     void applied_block(const block_state_ptr&);
     void applied_irreversible_block(const block_state_ptr&);
@@ -84,10 +96,14 @@ public:
     void process_transaction(const transaction_trace&, write_context& write_ctx);
     void _process_transaction(const transaction_trace&, write_context& write_ctx);
 
+    transaction_trace_ptr find_trx_trace(std::deque<transaction_trace_ptr>& traces, const transaction_id_type& trx_id);
     void add_trx_trace(bsoncxx::builder::basic::document& trx_doc,
-                       const chain::transaction& trx,
-                       std::deque<transaction_trace_ptr>& traces,
-                       std::function<void(action&)>&& on_paycharge_act);
+                       const transaction_trace& trace,
+                       const std::function<void(const action&)>& on_paycharge_act);
+
+    // runs fn over [0, size) split into ranges on interpret pool and current thread
+    template<typename Fn>
+    void run_parallel(size_t size, Fn&& fn);
 
     void add_trx_ext(bsoncxx::builder::basic::document& trx_doc, const chain::transaction& trx);
 
@@ -104,16 +120,23 @@ public:
     mongocxx::client   mongo_conn;
     mongocxx::database mongo_db;
 
+    // one client for each collection written in parallel, client is not thread safe
+    size_t                        writer_threads = 1;
+    std::vector<mongocxx::client> writer_conns;
+
     evt_interpreter    interpreter;
 
+    // documents of transactions in one block are built in parallel, decoding actions by abi costs most of the cpu
+    size_t                                  interpret_threads = 0;
+    std::optional<boost::asio::thread_pool> interpret_pool;
+
     size_t processed  = 0;
     size_t queue_size = 0;
 
-    std::deque<inblock_ptr>           block_state_queue;
-    std::deque<transaction_trace_ptr> transaction_trace_queue;
+    // filled by main thread, which is never blocked by them even if database is slow
+    std::optional<spsc_queue<inblock_ptr>>           block_state_queue;
+    std::optional<spsc_queue<transaction_trace_ptr>> transaction_trace_queue;
 
-    spinlock                    lock_;
-    condition_variable_any      cond_;
     std::thread                 consume_thread_;
     std::atomic_bool            done_{false};
 
@@ -135,71 +158,56 @@ public:
 
 
 
-template <typename Q, typename V>
-inline void
-queueb(Q& bqueue, V&& v, spinlock& lock, condition_variable_any& cv, size_t queue_size) {
-    lock.lock();
-
-    auto sleep_time = 0ul;
-
-    while(bqueue.size() > queue_size) {
-        lock.unlock();
-        cv.notify_one();
-
-        sleep_time += 100;
-        std::this_thread::sleep_for(std::chrono::milliseconds(sleep_time));
-
-        lock.lock();
-    }
-    bqueue.emplace_back(std::forward<V>(v));
-    lock.unlock();
-    cv.notify_one();
-}
-
-template <typename Q, typename V>
-inline void
-queuet(Q& tqueue, V&& v, spinlock& lock, condition_variable_any& cv) {
-    lock.lock();
-    tqueue.emplace_back(std::forward<V>(v));
-    lock.unlock();
-    cv.notify_one();
-}
-
 void
 mongo_db_plugin_impl::applied_irreversible_block(const block_state_ptr& bsp) {
-    queueb(block_state_queue, std::make_tuple(bsp, true), lock_, cond_, queue_size);
+    block_state_queue->push(std::make_tuple(bsp, true));
+}
+
+fc::variant
+mongo_db_plugin_impl::get_memory_usage() const {
+    auto bstats = block_state_queue->get_stats();
+    auto tstats = transaction_trace_queue->get_stats();
+    return fc::mutable_variant_object("blocks_queue_size", bstats.size)
+        ("blocks_queue_capacity", bstats.capacity)
+        ("blocks_high_watermark", bstats.high_watermark)
+        ("traces_queue_size", tstats.size)
+        ("traces_high_watermark", tstats.high_watermark)
+        ("blocks_queue_lock", bstats.overflow_lock)
+        ("traces_queue_lock", tstats.overflow_lock);
 }
 
 void
 mongo_db_plugin_impl::applied_block(const block_state_ptr& bsp) {
-    queueb(block_state_queue, std::make_tuple(bsp, false), lock_, cond_, queue_size);
+    block_state_queue->push(std::make_tuple(bsp, false));
 }
 
 void
 mongo_db_plugin_impl::applied_transaction(const transaction_trace_ptr& ttp) {
-    queuet(transaction_trace_queue, ttp, lock_, cond_);
+    transaction_trace_queue->push(ttp);
 }
 
 void
 mongo_db_plugin_impl::consume_queues() {
     try {
+        auto bqueue = std::deque<inblock_ptr>();
+        auto traces = std::deque<transaction_trace_ptr>();  // ones not consumed are left for next blocks
         while(true) {
-            lock_.lock();
-            while(block_state_queue.empty() && !done_) {
-                cond_.wait(lock_);
+            if(block_state_queue->empty() && !done_) {
+                block_state_queue->wait_for(std::chrono::milliseconds(100));
+                continue;
             }
 
-            auto bqueue = std::move(block_state_queue);
-            auto traces = std::move(transaction_trace_queue);
-
-            lock_.unlock();
+            block_state_queue->pop_all(bqueue);
+            transaction_trace_queue->pop_all(traces);
 
             const int BlockPtr       = 0;
             const int IsIrreversible = 1;
 
             // warn if queue size greater than 75%
             if(bqueue.size() > (queue_size * 0.75)) {
-                wlog("queue size: ${q}, head block num: ${b}", ("q", bqueue.size())("b",std::get<BlockPtr>(bqueue.front())->block_num));
+                auto stats = block_state_queue->get_stats();
+                wlog("queue size: ${q}, head block num: ${b}, high watermark: ${h}, overflowed: ${o}",
+                    ("q", bqueue.size())("b",std::get<BlockPtr>(bqueue.front())->block_num)("h", stats.high_watermark)("o", stats.overflowed));
             }
             else if(done_) {
                 ilog("draining queue, size: ${q}", ("q", bqueue.size()));
@@ -229,11 +237,6 @@ mongo_db_plugin_impl::consume_queues() {
             if(write_ctx_.total() > 0) {
                 write_ctx_.execute();
             }
-
-            if(!traces.empty()) {
-                spinlock_guard lock(lock_);
-                transaction_trace_queue.insert(transaction_trace_queue.begin(), traces.begin(), traces.end());
-            }
         }
         ilog("mongo_db_plugin consume thread shutdown gracefully");
     }
@@ -260,8 +263,7 @@ add_data(bsoncxx::builder::basic::document& act_doc,
         auto& abis    = evt_abi;
         auto  acttype = exec_ctx.get_acttype_name(act.name);
 
-        auto v    = abis.binary_to_variant(acttype, act.data, exec_ctx);
-        auto json = fc::json::to_string(v);
+        auto json = abis.binary_to_json(acttype, act.data, exec_ctx);
         try {
             const auto& value = bsoncxx::from_json(json);
             act_doc.append(kvp("data", value));
@@ -399,8 +401,7 @@ mongo_db_plugin_impl::_process_block(const signed_block& block, std::deque<trans
 
     write_ctx.get_blocks().append(insert_one(block_doc.view()));
 
-    int32_t act_num        = 0;
-    auto    process_action = [&](const std::string& trans_id_str, const chain::action& msg) -> auto {
+    auto process_action = [&](const std::string& trans_id_str, const chain::action& msg, int32_t act_num) {
         auto msg_oid = bsoncxx::oid{};
         auto doc     = bsoncxx::builder::basic::document{};
 
@@ -414,16 +415,16 @@ mongo_db_plugin_impl::_process_block(const signed_block& block, std::deque<trans
                    kvp("created_at", b_date{now}));
 
         add_data(doc, msg, control_.get_abi_serializer(), control_.get_execution_context());
-        write_ctx.get_actions().append(insert_one(doc.view()));
+        return doc.extract();
     };
 
-    int32_t trx_num  = 0;
-    auto process_trx = [&](const chain::transaction& trx, auto status) -> auto {
-        auto       txn_oid      = bsoncxx::oid{};
-        auto       doc          = bsoncxx::builder::basic::document{};
-        auto       trx_id       = trx.id();
-        const auto trans_id_str = trx_id.str();
-        
+    auto process_trx = [&](const transaction_receipt& trx_receipt, int32_t trx_num, const transaction_trace_ptr& trace, trx_docs& docs) {
+        const auto& trx          = trx_receipt.trx.get_signed_transaction();
+        auto        txn_oid      = bsoncxx::oid{};
+        auto        doc          = bsoncxx::builder::basic::document{};
+        auto        trx_id       = trx.id();
+        const auto  trans_id_str = trx_id.str();
+
         doc.append(kvp("_id", txn_oid),
                    kvp("trx_id", trans_id_str),
                    kvp("seq_num", b_int32{trx_num}),
@@ -438,11 +439,10 @@ mongo_db_plugin_impl::_process_block(const signed_block& block, std::deque<trans
                    kvp("pending", b_bool{true}),
                    kvp("created_at", b_date{now}));
         // add all input actions in this trx
-        if(status == transaction_receipt_header::executed && !trx.actions.empty()) {
-            act_num = 0;
+        int32_t act_num = 0;
+        if(trx_receipt.status == transaction_receipt_header::executed) {
             for(const auto& act : trx.actions) {
-                process_action(trans_id_str, act);
-                act_num++;
+                docs.actions.emplace_back(process_action(trans_id_str, act, act_num++));
             }
         }
 
@@ -451,17 +451,11 @@ mongo_db_plugin_impl::_process_block(const signed_block& block, std::deque<trans
         }
 
         // add trace(elapsed and charge) and paycharge action
-        add_trx_trace(doc, trx, traces, [&](auto& act) {
-            process_action(trans_id_str, act);
-        });
-
-        return doc;
-    };
-
-    trx_num = 0;
-    for(const auto& trx_receipt : block.transactions) {
-        const auto& trx = trx_receipt.trx.get_signed_transaction();
-        auto        doc = process_trx(trx, trx_receipt.status);
+        if(trace) {
+            add_trx_trace(doc, *trace, [&](auto& act) {
+                docs.actions.emplace_back(process_action(trans_id_str, act, act_num++));
+            });
+        }
 
         doc.append(kvp("type", (std::string)trx_receipt.type));
         doc.append(kvp("status", (std::string)trx_receipt.status));
@@ -479,8 +473,29 @@ mongo_db_plugin_impl::_process_block(const signed_block& block, std::deque<trans
             }
         }));
 
-        write_ctx.get_trxs().append(insert_one(doc.view()));
-        ++trx_num;
+        docs.trx.emplace(doc.extract());
+    };
+
+    // traces are matched in order, then documents of transactions are built in parallel and written in order
+    auto& receipts   = block.transactions;
+    auto  trx_traces = std::vector<transaction_trace_ptr>();
+    trx_traces.reserve(receipts.size());
+    for(const auto& trx_receipt : receipts) {
+        trx_traces.emplace_back(find_trx_trace(traces, trx_receipt.trx.id()));
+    }
+
+    auto docs = std::vector<trx_docs>(receipts.size());
+    run_parallel(receipts.size(), [&](size_t begin, size_t end) {
+        for(auto i = begin; i < end; i++) {
+            process_trx(receipts[i], (int32_t)i, trx_traces[i], docs[i]);
+        }
+    });
+
+    for(auto& d : docs) {
+        write_ctx.get_trxs().append(insert_one(d.trx->view()));
+        for(auto& act : d.actions) {
+            write_ctx.get_actions().append(insert_one(act.view()));
+        }
     }
 
     ++processed;
@@ -514,40 +529,89 @@ mongo_db_plugin_impl::_process_transaction(const transaction_trace& trace, write
     return;
 }
 
+transaction_trace_ptr
+mongo_db_plugin_impl::find_trx_trace(std::deque<transaction_trace_ptr>& traces, const transaction_id_type& trx_id) {
+    // traces before the matched one are of transactions not in blocks, drop them
+    while(!traces.empty()) {
+        auto trace = traces.front();
+        traces.pop_front();
+
+        if(trace->id == trx_id) {
+            return trace;
+        }
+    }
+    return nullptr;
+}
+
 void
-mongo_db_plugin_impl::add_trx_trace(bsoncxx::builder::basic::document& trx_doc,
-                                    const chain::transaction&          trx,
-                                    std::deque<transaction_trace_ptr>& traces,
-                                    std::function<void(action&)>&&     on_paycharge_act) {
-    using namespace evt::internal;
+mongo_db_plugin_impl::add_trx_trace(bsoncxx::builder::basic::document&           trx_doc,
+                                    const transaction_trace&                     trace,
+                                    const std::function<void(const action&)>&    on_paycharge_act) {
     using namespace bsoncxx::types;
-    using namespace bsoncxx::builder;
-    using namespace mongocxx::model;
     using bsoncxx::builder::basic::kvp;
 
     auto trace_doc = bsoncxx::builder::basic::document{};
+    trace_doc.append(kvp("elapsed", (int64_t)trace.elapsed.count()),
+                     kvp("charge", (int64_t)trace.charge));
+    trx_doc.append(kvp("trace", trace_doc));
+    if(trace.action_traces.empty()) {
+        return;
+    }
+    // because paycharage action is alwasys the latest action
+    // only check latest
+    auto& act = trace.action_traces.back().act;
+    if(act.name == N(paycharge)) {
+        on_paycharge_act(act);
+    }
+}
 
-    auto it = traces.begin();
-    while(it != traces.end()) {
-        auto trace = *it;
-        traces.pop_front();
+template<typename Fn>
+void
+mongo_db_plugin_impl::run_parallel(size_t size, Fn&& fn) {
+    const size_t kMinLaneSize = 16;
 
-        if(trace->id == trx.id()) {
-            trace_doc.append(kvp("elapsed", (int64_t)trace->elapsed.count()),
-                             kvp("charge", (int64_t)trace->charge));
-            trx_doc.append(kvp("trace", trace_doc));
-            if(trace->action_traces.empty()) {
-                return;
+    auto n = interpret_pool.has_value() ? std::max<size_t>(1, std::min<size_t>(interpret_threads + 1, size / kMinLaneSize)) : 1;
+    if(n == 1) {
+        fn(0, size);
+        return;
+    }
+
+    // first range is run in current thread
+    auto step    = (size + n - 1) / n;
+    auto futures = std::vector<std::future<void>>();
+    for(auto begin = step; begin < size; begin += step) {
+        auto end = std::min(begin + step, size);
+        auto p   = std::make_shared<std::promise<void>>();
+        futures.emplace_back(p->get_future());
+        boost::asio::post(*interpret_pool, [p, &fn, begin, end] {
+            try {
+                fn(begin, end);
+                p->set_value();
             }
-            // because paycharage action is alwasys the latest action
-            // only check latest
-            auto& act = trace->action_traces.back().act;
-            if(act.name == N(paycharge)) {
-                on_paycharge_act(act);
+            catch(...) {
+                p->set_exception(std::current_exception());
             }
-            return;
+        });
+    }
+
+    auto except = std::exception_ptr();
+    try {
+        fn(0, step);
+    }
+    catch(...) {
+        except = std::current_exception();
+    }
+    // ranges refer to the caller's locals, so all of them are waited before rethrowing
+    for(auto& f : futures) {
+        try {
+            f.get();
+        }
+        catch(...) {
+            except = std::current_exception();
         }
-        it++;
+    }
+    if(except) {
+        std::rethrow_exception(except);
     }
 }
 
@@ -578,9 +642,11 @@ mongo_db_plugin_impl::~mongo_db_plugin_impl() {
     }
     try {
         done_ = true;
-        cond_.notify_one();
 
         consume_thread_.join();
+        if(interpret_pool.has_value()) {
+            interpret_pool->join();
+        }
     }
     catch(std::exception& e) {
         elog("Exception on mongo_db_plugin shutdown of consume thread: ${e}", ("e", e.what()));
@@ -648,13 +714,22 @@ mongo_db_plugin_impl::init() {
         fungibles.create_index(bsoncxx::from_json(R"xxx({ "sym_id" : 1 })xxx"));
     }
 
-    write_ctx_.blocks_collection    = mongo_db[blocks_col];
-    write_ctx_.trxs_collection      = mongo_db[trxs_col];
-    write_ctx_.actions_collection   = mongo_db[actions_col];
-    write_ctx_.domains_collection   = mongo_db[domains_col];
-    write_ctx_.tokens_collection    = mongo_db[tokens_col];
-    write_ctx_.groups_collection    = mongo_db[groups_col];
-    write_ctx_.fungibles_collection = mongo_db[fungibles_col];
+    auto get_collection = [this](const std::string& name) {
+        if(writer_threads <= 1) {
+            return mongo_db[name];
+        }
+        auto& conn = writer_conns.emplace_back(mongo_uri);
+        return conn[mongo_db.name()][name];
+    };
+
+    write_ctx_.set_writer_threads(writer_threads);
+    write_ctx_.blocks_collection    = get_collection(blocks_col);
+    write_ctx_.trxs_collection      = get_collection(trxs_col);
+    write_ctx_.actions_collection   = get_collection(actions_col);
+    write_ctx_.domains_collection   = get_collection(domains_col);
+    write_ctx_.tokens_collection    = get_collection(tokens_col);
+    write_ctx_.groups_collection    = get_collection(groups_col);
+    write_ctx_.fungibles_collection = get_collection(fungibles_col);
 
     // initilize evt interpreter
     interpreter.initialize_db(mongo_db);
@@ -670,8 +745,11 @@ mongo_db_plugin_impl::init() {
         applied_irreversible_block(bs);
     }));
 
-    applied_transaction_connection.emplace(chain.applied_transaction.connect([&](const chain::transaction_trace_ptr& t) {
-        applied_transaction(t);
+    // traces are delivered once per block, before the block itself
+    applied_transaction_connection.emplace(chain.applied_block_traces.connect([&](const chain::block_traces_ptr& bt) {
+        for(auto& t : bt->traces) {
+            applied_transaction(t);
+        }
     }));
 
     if(need_init) {
@@ -732,12 +810,22 @@ mongo_db_plugin::set_program_options(options_description& cli, options_descripti
         ("mongodb-queue-size,q", bpo::value<uint>()->default_value(5120), "The queue size between evtd and MongoDB plugin thread.")
         ("mongodb-uri,m", bpo::value<std::string>(), "MongoDB URI connection string, see: https://docs.mongodb.com/master/reference/connection-string/."
                                                      " If not specified then plugin is disabled. Default database 'EVT' is used if not specified in URI.")
+        ("mongodb-writer-threads", bpo::value<uint>()->default_value(4), "Number of threads writing collections into MongoDB in parallel, 1 to write them one by one.")
+        ("mongodb-interpret-threads", bpo::value<uint>()->default_value(2), "Number of extra threads building documents of transactions in parallel, 0 to build them in consume thread only.")
+        ("mongodb-lock-profiling", bpo::bool_switch()->default_value(false), "Measure the time locks of queues between main thread and MongoDB plugin thread are held, reported along with their contention counters.")
         ;
 }
 
 void
 mongo_db_plugin::plugin_initialize(const variables_map& options) {
     my_ = std::make_unique<mongo_db_plugin_impl>(app().get_plugin<chain_plugin>().chain());
+    my_->block_state_queue.emplace(options.at("mongodb-queue-size").as<uint>());
+    // several transactions per block
+    my_->transaction_trace_queue.emplace(options.at("mongodb-queue-size").as<uint>() * 8);
+    if(options.at("mongodb-lock-profiling").as<bool>()) {
+        my_->block_state_queue->set_lock_profiling(true);
+        my_->transaction_trace_queue->set_lock_profiling(true);
+    }
 
     if(options.count("mongodb-uri")) {
         ilog("initializing mongo_db_plugin");
@@ -761,6 +849,14 @@ mongo_db_plugin::plugin_initialize(const variables_map& options) {
             my_->queue_size = size;
         }
 
+        my_->writer_threads = options.at("mongodb-writer-threads").as<uint>();
+        EVT_ASSERT(my_->writer_threads > 0, plugin_config_exception, "mongodb-writer-threads must be greater than 0");
+
+        my_->interpret_threads = options.at("mongodb-interpret-threads").as<uint>();
+        if(my_->interpret_threads > 0) {
+            my_->interpret_pool.emplace(my_->interpret_threads);
+        }
+
         std::string uri_str = options.at("mongodb-uri").as<std::string>();
         ilog("connecting to ${u}", ("u", uri_str));
         
@@ -780,7 +876,10 @@ mongo_db_plugin::plugin_initialize(const variables_map& options) {
 
         my_->init();
 
-        my_->consume_thread_ = std::thread([this] { my_->consume_queues(); });
+        my_->consume_thread_ = std::thread([this] {
+            evt::utilities::affinity::enter_pool("mongo", 0);
+            my_->consume_queues();
+        });
     }
     else {
         wlog("evt::mongo_db_plugin configured, but no --mongodb-uri specified.");
@@ -789,7 +888,11 @@ mongo_db_plugin::plugin_initialize(const variables_map& options) {
 }
 
 void
-mongo_db_plugin::plugin_startup() {}
+mongo_db_plugin::plugin_startup() {
+    if(my_->configured) {
+        app().get_plugin<chain_plugin>().register_memory_usage("mongo", [this] { return my_->get_memory_usage(); });
+    }
+}
 
 void
 mongo_db_plugin::plugin_shutdown() {
@@ -15,6 +15,14 @@ struct connection_status {
     bool              connecting = false;
     bool              syncing    = false;
     handshake_message last_handshake;
+
+    uint32_t         write_queue_size = 0;  // bytes waiting to be sent
+    uint32_t         sync_queue_size  = 0;  // blocks waiting to be sent for sync
+    uint64_t         bytes_received   = 0;
+    uint64_t         bytes_sent       = 0;
+    vector<uint64_t> messages_received;     // indexed by which of net_message
+    int64_t          rtt_us           = 0;  // round trip time measured by time_message
+    uint64_t         trxs_held_back   = 0;  // transactions not relayed because peer was lagging
 };
 
 class net_plugin : public appbase::plugin<net_plugin> {
@@ -45,4 +53,5 @@ private:
 
 }  // namespace evt
 
-FC_REFLECT(evt::connection_status, (peer)(connecting)(syncing)(last_handshake))
+FC_REFLECT(evt::connection_status, (peer)(connecting)(syncing)(last_handshake)(write_queue_size)(sync_queue_size)
+           (bytes_received)(bytes_sent)(messages_received)(rtt_us)(trxs_held_back))
@@ -161,6 +161,51 @@ struct sync_request_message {
     uint32_t end_block;
 };
 
+// transactions coalesced by sender, only sent to the peers supporting it
+struct transaction_batch_message {
+    vector<packed_transaction> trxs;
+};
+
+struct compact_receipt : public transaction_receipt_header {
+    transaction_id_type id;
+};
+
+// block with only ids of its transactions, receivers rebuild it from the transactions they already have
+struct compact_block_message {
+    signed_block_header     header;
+    vector<compact_receipt> trxs;
+    extensions_type         block_extensions;
+};
+
+// packed net_message compressed by zstd, only sent to peers supporting it
+struct compressed_message {
+    vector<char> data;
+};
+
+// asks for the latest snapshot published by peer, may be sent without handshake by nodes bootstrapping from it
+struct snapshot_info_request_message {
+    uint32_t min_block_num = 0;  ///< older snapshots are not wanted
+};
+
+struct snapshot_info_message {
+    block_id_type      block_id;        ///< head block of the snapshot, empty if there is none
+    uint64_t           size       = 0;
+    uint32_t           chunk_size = 0;
+    vector<fc::sha256> chunk_hashes;    ///< sha256 of each chunk, the last one may be shorter
+};
+
+struct snapshot_chunk_request_message {
+    block_id_type block_id;
+    uint32_t      index = 0;
+};
+
+// data is empty if the snapshot is not served anymore
+struct snapshot_chunk_message {
+    block_id_type block_id;
+    uint32_t      index = 0;
+    vector<char>  data;
+};
+
 using net_message = static_variant<handshake_message,
                                    chain_size_message,
                                    go_away_message,
@@ -168,8 +213,15 @@ using net_message = static_variant<handshake_message,
                                    notice_message,
                                    request_message,
                                    sync_request_message,
-                                   signed_block,         // which = 7
-                                   packed_transaction>;  // which = 8
+                                   signed_block,                // which = 7
+                                   packed_transaction,          // which = 8
+                                   transaction_batch_message,   // which = 9
+                                   compact_block_message,       // which = 10
+                                   compressed_message,          // which = 11
+                                   snapshot_info_request_message,
+                                   snapshot_info_message,
+                                   snapshot_chunk_request_message,
+                                   snapshot_chunk_message>;     // which = 15
 
 }  // namespace evt
 
@@ -183,6 +235,14 @@ FC_REFLECT(evt::time_message, (org)(rec)(xmt)(dst));
 FC_REFLECT(evt::notice_message, (known_trx)(known_blocks));
 FC_REFLECT(evt::request_message, (req_trx)(req_blocks));
 FC_REFLECT(evt::sync_request_message, (start_block)(end_block));
+FC_REFLECT(evt::transaction_batch_message, (trxs));
+FC_REFLECT_DERIVED(evt::compact_receipt, (evt::chain::transaction_receipt_header), (id));
+FC_REFLECT(evt::compact_block_message, (header)(trxs)(block_extensions));
+FC_REFLECT(evt::compressed_message, (data));
+FC_REFLECT(evt::snapshot_info_request_message, (min_block_num));
+FC_REFLECT(evt::snapshot_info_message, (block_id)(size)(chunk_size)(chunk_hashes));
+FC_REFLECT(evt::snapshot_chunk_request_message, (block_id)(index));
+FC_REFLECT(evt::snapshot_chunk_message, (block_id)(index)(data));
 
 /**
  *
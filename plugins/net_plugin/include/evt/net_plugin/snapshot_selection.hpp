@@ -0,0 +1,61 @@
+/**
+ *  @file
+ *  @copyright defined in evt/LICENSE.txt
+ */
+#pragma once
+#include <algorithm>
+#include <optional>
+#include <evt/net_plugin/protocol.hpp>
+
+namespace evt {
+
+// limits of snapshots fetched from peers, hashes of larger ones don't fit in one message anyway
+constexpr uint64_t max_snapshot_size       = 256ull * 1024 * 1024 * 1024;
+constexpr uint32_t max_snapshot_chunk_size = 4 * 1024 * 1024;
+
+// checks the info advertised by one peer is self-consistent before anything is allocated for it
+inline bool
+is_valid_snapshot_info(const snapshot_info_message& info) {
+    if(info.block_id == block_id_type() || info.size == 0 || info.size > max_snapshot_size) {
+        return false;
+    }
+    if(info.chunk_size == 0 || info.chunk_size > max_snapshot_chunk_size) {
+        return false;
+    }
+    return info.chunk_hashes.size() == (info.size + info.chunk_size - 1) / info.chunk_size;
+}
+
+inline bool
+is_same_snapshot(const snapshot_info_message& lhs, const snapshot_info_message& rhs) {
+    return lhs.block_id == rhs.block_id && lhs.size == rhs.size && lhs.chunk_size == rhs.chunk_size
+        && lhs.chunk_hashes == rhs.chunk_hashes;
+}
+
+/**
+ * Selects the snapshot to fetch among the infos advertised by peers. Only the valid ones of `trusted_id` are
+ * considered if it's not empty, and one is selected only if at least `quorum` peers advertised exactly the same
+ * info, the newest of them wins and ties are broken by the votes.
+ */
+inline std::optional<snapshot_info_message>
+select_snapshot(const vector<snapshot_info_message>& infos, uint32_t quorum, const block_id_type& trusted_id) {
+    auto best  = std::optional<snapshot_info_message>();
+    auto votes = 0u;
+    for(auto& info : infos) {
+        if(!is_valid_snapshot_info(info) || (trusted_id != block_id_type() && info.block_id != trusted_id)) {
+            continue;
+        }
+        auto n = (uint32_t)std::count_if(infos.cbegin(), infos.cend(), [&](auto& o) { return is_same_snapshot(o, info); });
+        if(n < std::max(quorum, 1u)) {
+            continue;
+        }
+
+        auto num = block_header::num_from_id(info.block_id);
+        if(!best || num > block_header::num_from_id(best->block_id) || (num == block_header::num_from_id(best->block_id) && n > votes)) {
+            best  = info;
+            votes = n;
+        }
+    }
+    return best;
+}
+
+}  // namespace evt
@@ -0,0 +1,60 @@
+/**
+ *  @file
+ *  @copyright defined in evt/LICENSE.txt
+ */
+#pragma once
+#include <chrono>
+#include <unordered_set>
+#include <vector>
+#include <fc/crypto/city.hpp>
+
+namespace evt {
+
+/**
+ * Hashes of raw transaction messages seen in current and previous windows, rotated rather than expired one by
+ * one. Checking and recording are separated, so the messages dropped for other reasons are not recorded and
+ * the copies relayed later are still accepted.
+ */
+class trx_dedup {
+public:
+    using clock = std::chrono::steady_clock;
+
+public:
+    void set_window(std::chrono::milliseconds window) { window_ = window; }
+    bool enabled() const { return window_.count() > 0; }
+
+    static uint64_t
+    hash(const std::vector<char>& raw) {
+        return fc::city_hash64(raw.data(), raw.size());
+    }
+
+    bool
+    seen(uint64_t h, clock::time_point now = clock::now()) {
+        if(!enabled()) {
+            return false;
+        }
+        if(now - rotated_at_ >= window_) {
+            prev_ = std::move(current_);
+            current_.clear();
+            rotated_at_ = now;
+        }
+        return current_.count(h) || prev_.count(h);
+    }
+
+    void
+    record(uint64_t h) {
+        if(enabled()) {
+            current_.emplace(h);
+        }
+    }
+
+    size_t size() const { return current_.size() + prev_.size(); }
+
+private:
+    std::chrono::milliseconds    window_{0};  // 0 means duplicates are only found after unpacked
+    std::unordered_set<uint64_t> current_;
+    std::unordered_set<uint64_t> prev_;
+    clock::time_point            rotated_at_;
+};
+
+}  // namespace evt
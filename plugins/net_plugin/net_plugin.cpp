@@ -4,12 +4,20 @@
  */
 #include <evt/net_plugin/net_plugin.hpp>
 #include <evt/net_plugin/protocol.hpp>
+#include <evt/net_plugin/snapshot_selection.hpp>
+#include <evt/net_plugin/trx_dedup.hpp>
 
+#include <deque>
+#include <fstream>
 #include <boost/asio/read.hpp>
 #include <boost/asio/write.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/ip/host_name.hpp>
 #include <boost/asio/steady_timer.hpp>
+#include <boost/multi_index/sequenced_index.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+
+#include <zstd.h>
 
 #include <fc/network/message_buffer.hpp>
 #include <fc/network/ip.hpp>
@@ -24,9 +32,12 @@
 #include <evt/chain/controller.hpp>
 #include <evt/chain/exceptions.hpp>
 #include <evt/chain/block.hpp>
+#include <evt/chain/merkle.hpp>
 #include <evt/chain/plugin_interface.hpp>
 #include <evt/chain/multi_index_includes.hpp>
 #include <evt/producer_plugin/producer_plugin.hpp>
+#include <evt/utilities/thread_affinity.hpp>
+#include <evt/utilities/trace.hpp>
 
 using namespace evt::chain::plugin_interface::compat;
 
@@ -43,6 +54,7 @@ using boost::asio::ip::tcp;
 using boost::asio::ip::address_v4;
 using boost::asio::ip::host_name;
 using boost::multi_index_container;
+using boost::multi_index::hashed_unique;
 
 using fc::time_point;
 using fc::time_point_sec;
@@ -75,15 +87,16 @@ struct sha256_less {
     }
 };
 
+// transactions are looked up by id for every one gossiped, hashed index avoids comparing ids along the tree
 typedef multi_index_container<
     node_transaction_state,
     indexed_by<
-        ordered_unique<
+        hashed_unique<
             tag<by_id>,
             member<node_transaction_state,
                    transaction_id_type,
                    &node_transaction_state::id>,
-            sha256_less>,
+            std::hash<transaction_id_type>>,
         ordered_non_unique<
             tag<by_expiry>,
             member<node_transaction_state,
@@ -96,6 +109,24 @@ typedef multi_index_container<
                    &node_transaction_state::block_num>>>>
     node_transaction_index;
 
+struct block_buffer_state {
+    block_id_type                 id;
+    std::shared_ptr<vector<char>> buffer;      /// send buffer of signed_block shared by all connections
+    std::shared_ptr<vector<char>> compressed;  /// compressed one sent during sync, filled on first use
+};
+
+typedef multi_index_container<
+    block_buffer_state,
+    indexed_by<
+        bmi::sequenced<>,  /// in order of insertion
+        ordered_unique<
+            tag<by_id>,
+            member<block_buffer_state,
+                   block_id_type,
+                   &block_buffer_state::id>,
+            sha256_less>>>
+    block_buffer_index;
+
 class net_plugin_impl {
 public:
     unique_ptr<tcp::acceptor> acceptor;
@@ -121,6 +152,7 @@ public:
     possible_connections allowed_connections{None};
 
     connection_ptr find_connection(const string& host) const;
+    fc::variant    get_memory_usage() const;  // local transactions and queues of connections
 
     std::set<connection_ptr>     connections;
     bool                         done = false;
@@ -134,6 +166,14 @@ public:
     boost::asio::steady_timer::duration   txn_exp_period;
     boost::asio::steady_timer::duration   resp_expected_period;
     boost::asio::steady_timer::duration   keepalive_interval{std::chrono::seconds{32}};
+    unique_ptr<boost::asio::steady_timer> trx_batch_timer;
+    std::chrono::microseconds             trx_batch_window{0};  // 0 means transactions are sent one by one
+    uint32_t                              trx_batch_size    = 0;
+    bool                                  trx_batch_pending = false;
+    bool                                  compact_blocks    = true;
+
+    // copies of one transaction relayed by many peers are dropped before they're unpacked or hashed by sha256
+    trx_dedup                             seen_trx_messages;
     int                                   max_cleanup_time_ms = 0;
 
     const std::chrono::system_clock::duration peer_authentication_interval{std::chrono::seconds{1}};  ///< Peer clock may be no more than 1 second skewed from our clock, including network latency.
@@ -148,14 +188,26 @@ public:
     int              started_sessions = 0;
 
     node_transaction_index local_txns;
+    block_buffer_index     block_buffers;
+    uint32_t               block_buffers_size = 0;  // 0 means blocks are packed every time they're sent
+    uint32_t               sync_compress_min_size = 0;  // 0 means blocks are not compressed during sync
 
     shared_ptr<tcp::resolver> resolver;
 
     bool use_socket_read_watermark = false;
 
+    fc::path                                     snapshot_dir;  // newest snapshot published here is served to peers, empty to disable
+    fc::path                                     snapshot_path;
+    std::shared_ptr<const snapshot_info_message> snapshot_info;  // of `snapshot_path`, chunks are hashed in net threads
+    bool                                         snapshot_hashing = false;
+    std::vector<connection_wptr>                 snapshot_waiters;  // peers waiting for the info till hashing is done
+
+    chain::plugin_interface::methods::fetch_snapshot::method_type::handle fetch_snapshot_provider;
+
     channels::transaction_ack::channel_type::handle incoming_transaction_ack_subscription;
 
-    optional<std::thread>                    server_thread;
+    std::vector<std::thread>                 server_threads;
+    uint16_t                                 thread_pool_size = 2;
     std::shared_ptr<boost::asio::io_context> server_ioc;
     optional<io_work_t>                      server_ioc_work;
 
@@ -174,12 +226,18 @@ public:
      * encountered unpacking or processing the message.
      */
     bool process_next_message(const connection_ptr& conn, uint32_t message_length);
+    void dispatch_message(const connection_ptr& conn, net_message&& msg);
+    void apply_ahead_blocks();
+    void decode_transactions(const connection_ptr& conn, std::vector<char>&& raw);
+    bool accepts_transactions(const connection_ptr& c);
+    void prefetch_buffered_blocks(const connection_ptr& conn);
 
     void   close(const connection_ptr& c);
     size_t count_open_sockets() const;
 
     template<typename VerifierFunc>
     void send_transaction_to_all(const std::shared_ptr<std::vector<char>>& send_buffer, VerifierFunc verify);
+    void start_trx_batch_timer();
 
     void accepted_block(const block_state_ptr&);
     void transaction_ack(const std::pair<fc::exception_ptr, transaction_metadata_ptr>&);
@@ -211,11 +269,28 @@ public:
     void handle_message(const connection_ptr& c, const signed_block_ptr& msg);
     void handle_message(const connection_ptr& c, const packed_transaction& msg) = delete;  // packed_transaction_ptr overload used instead
     void handle_message(const connection_ptr& c, const packed_transaction_ptr& msg);
+    void handle_message(const connection_ptr& c, const transaction_metadata_ptr& trx);
+    void handle_message(const connection_ptr& c, const transaction_batch_message& msg) = delete;  // rvalue overload used instead
+    void handle_message(const connection_ptr& c, transaction_batch_message&& msg);
+    void handle_message(const connection_ptr& c, const compact_block_message& msg);
+    void handle_message(const connection_ptr& c, const compressed_message& msg);
+    void handle_message(const connection_ptr& c, const snapshot_info_request_message& msg);
+    void handle_message(const connection_ptr& c, const snapshot_info_message& msg);
+    void handle_message(const connection_ptr& c, const snapshot_chunk_request_message& msg);
+    void handle_message(const connection_ptr& c, const snapshot_chunk_message& msg);
+
+    bool                    can_serve_snapshot(const connection_ptr& c);
+    std::optional<fc::path> latest_published_snapshot() const;
+    void                    refresh_snapshot_info();
+    void                    reply_snapshot_waiters();
 
     void start_conn_timer(boost::asio::steady_timer::duration du, std::weak_ptr<connection> from_connection);
     void start_txn_timer();
     void start_monitors();
 
+    std::shared_ptr<vector<char>> get_block_buffer(const signed_block_ptr& sb, bool compress = false);
+    std::shared_ptr<vector<char>> compress_send_buffer(const std::shared_ptr<vector<char>>& send_buffer);
+
     void expire_txns();
     void expire_local_txns();
     void connection_monitor(std::weak_ptr<connection> from_connection);
@@ -306,10 +381,17 @@ constexpr auto                              def_conn_retry_wait          = 30;
 constexpr auto                              def_txn_expire_wait          = std::chrono::seconds(3);
 constexpr auto                              def_resp_expected_wait       = std::chrono::seconds(5);
 constexpr auto                              def_sync_fetch_span          = 100;
+constexpr auto                              def_sync_fetch_peers         = 4;
+constexpr auto                              def_snapshot_chunk_size      = 1024 * 1024;
+constexpr auto                              def_snapshot_timeout         = std::chrono::seconds(30);
 
 constexpr auto     message_header_size = 4;
 constexpr uint32_t signed_block_which = 7;        // see protocol net_message
 constexpr uint32_t packed_transaction_which = 8;  // see protocol net_message
+constexpr uint32_t transaction_batch_which  = 9;  // see protocol net_message
+constexpr uint32_t compact_block_which      = 10; // see protocol net_message
+constexpr uint32_t compressed_message_which = 11; // see protocol net_message
+constexpr uint32_t snapshot_chunk_which     = 15; // see protocol net_message
 
 /**
  *  For a while, network version was a 16 bit value equal to the second set of 16 bits
@@ -331,8 +413,12 @@ constexpr uint16_t net_version_range = 106;
  */
 constexpr uint16_t proto_base          = 0;
 constexpr uint16_t proto_explicit_sync = 1;
+constexpr uint16_t proto_trx_batch     = 2;  // transaction_batch_message is supported
+constexpr uint16_t proto_compact_block = 3;  // compact_block_message is supported
+constexpr uint16_t proto_compressed    = 4;  // compressed_message is supported
+constexpr uint16_t proto_snapshot      = 5;  // snapshot messages are supported
 
-constexpr uint16_t net_version = proto_explicit_sync;
+constexpr uint16_t net_version = proto_snapshot;
 
 struct transaction_state {
     transaction_id_type id;
@@ -343,7 +429,7 @@ struct transaction_state {
 typedef multi_index_container<
     transaction_state,
     indexed_by<
-        ordered_unique<tag<by_id>, member<transaction_state, transaction_id_type, &transaction_state::id>, sha256_less>,
+        hashed_unique<tag<by_id>, member<transaction_state, transaction_id_type, &transaction_state::id>, std::hash<transaction_id_type>>,
         ordered_non_unique<tag<by_expiry>, member<transaction_state, fc::time_point_sec, &transaction_state::expires>>,
         ordered_non_unique<
             tag<by_block_num>,
@@ -415,6 +501,16 @@ public:
     }
 
     uint32_t write_queue_size() const { return _write_queue_size; }
+    uint32_t sync_queue_size() const { return _sync_write_queue.size(); }
+
+    size_t
+    out_queue_bytes() const {
+        auto bytes = size_t(0);
+        for(auto& m : _out_queue) {
+            bytes += m.buff->size();
+        }
+        return bytes;
+    }
 
     bool is_out_queue_empty() const { return _out_queue.empty(); }
 
@@ -495,6 +591,7 @@ public:
     optional<sync_state>                     peer_requested;  // this peer is requesting info from us
     std::shared_ptr<boost::asio::io_context> server_ioc; // keep ioc alive
     boost::asio::io_context::strand          strand;
+    boost::asio::io_context::strand          decode_strand;  // transactions of one connection are decoded in order
     socket_ptr                               socket;
 
     fc::message_buffer<1024 * 1024> pending_message_buffer;
@@ -514,10 +611,17 @@ public:
     string                                peer_addr;
     unique_ptr<boost::asio::steady_timer> response_expected;
     unique_ptr<boost::asio::steady_timer> read_delay_timer;
+    vector<std::shared_ptr<vector<char>>> batched_trxs;  // send buffers of transactions waiting to be sent in one batch
+    size_t                                batched_trxs_size = 0;
     go_away_reason                        no_retry = no_reason;
     block_id_type                         fork_head;
     uint32_t                              fork_head_num = 0;
     optional<request_message>             last_req;
+    double                                sync_rate = 0;  // blocks per second measured in the sync spans from this peer
+    uint64_t                              bytes_received = 0;
+    uint64_t                              bytes_sent     = 0;
+    vector<uint64_t>                      messages_received;  // indexed by which of net_message
+    uint64_t                              trxs_held_back = 0;
 
     connection_status get_status() const {
         connection_status stat;
@@ -525,6 +629,14 @@ public:
         stat.connecting     = connecting;
         stat.syncing        = syncing;
         stat.last_handshake = last_handshake_recv;
+
+        stat.write_queue_size  = buffer_queue.write_queue_size();
+        stat.sync_queue_size   = buffer_queue.sync_queue_size();
+        stat.bytes_received    = bytes_received;
+        stat.bytes_sent        = bytes_sent;
+        stat.messages_received = messages_received;
+        stat.rtt_us            = (int64_t)(rtt / 1000);
+        stat.trxs_held_back    = trxs_held_back;
         return stat;
     }
 
@@ -540,6 +652,7 @@ public:
 
     // Computed data
     double offset{0};  //!< peer offset
+    double rtt{0};     //!< round trip delay in nanoseconds
 
     static const size_t ts_buffer_size{32};
     char                ts[ts_buffer_size];  //!< working buffer for making human readable timestamps
@@ -583,6 +696,7 @@ public:
     void enqueue_buffer(const std::shared_ptr<std::vector<char>>& send_buffer,
                         bool trigger_send, int priority, go_away_reason close_after_send,
                         bool to_sync_queue = false);
+    void flush_trx_batch();
     void cancel_sync(go_away_reason);
     void flush_queues();
     bool enqueue_sync_block();
@@ -641,13 +755,23 @@ struct msg_handler : public fc::visitor<void> {
     void operator()(packed_transaction& msg) const {
         EVT_ASSERT(false, plugin_config_exception, "operator()(packed_transaction&&) should be called");
     }
+    void operator()(const transaction_batch_message& msg) const {
+        EVT_ASSERT(false, plugin_config_exception, "operator()(transaction_batch_message&&) should be called");
+    }
+    void operator()(transaction_batch_message& msg) const {
+        EVT_ASSERT(false, plugin_config_exception, "operator()(transaction_batch_message&&) should be called");
+    }
 
     void operator()(signed_block&& msg) const {
         impl.handle_message(c, std::make_shared<signed_block>(std::move(msg)));
+        impl.apply_ahead_blocks();
     }
     void operator()(packed_transaction&& msg) const {
         impl.handle_message(c, std::make_shared<packed_transaction>(std::move(msg)));
     }
+    void operator()(transaction_batch_message&& msg) const {
+        impl.handle_message(c, std::move(msg));
+    }
 
     template<typename T>
     void operator()(T&& msg) const {
@@ -663,19 +787,35 @@ private:
         in_sync
     };
 
-    uint32_t       sync_known_lib_num;
-    uint32_t       sync_last_requested_num;
-    uint32_t       sync_next_expected_num;
-    uint32_t       sync_req_span;
-    connection_ptr source;
-    stages         state;
+    struct sync_span {
+        uint32_t       start;
+        uint32_t       end;
+        connection_ptr peer;  // empty if peer failed and the span is waiting for another one
+        fc::time_point requested;
+    };
+
+    uint32_t sync_known_lib_num;
+    uint32_t sync_last_requested_num;
+    uint32_t sync_next_expected_num;
+    uint32_t sync_req_span;
+    uint32_t sync_fetch_peers;
+    stages   state;
+
+    std::deque<sync_span>                                           spans;         // requested ranges in order of block numbers
+    std::map<uint32_t, std::pair<connection_ptr, signed_block_ptr>> ahead_blocks;  // received before the ones in front of them
 
     chain_plugin* chain_plug = nullptr;
 
     constexpr auto stage_str(stages s);
 
+    bool     fetching_from(const connection_ptr& c) const;
+    uint32_t span_size(const connection_ptr& c) const;
+    void     release_spans(const connection_ptr& c);
+    void     reset_spans();
+    void     recv_span_block(const connection_ptr& c, uint32_t blk_num);
+
 public:
-    explicit sync_manager(uint32_t span);
+    sync_manager(uint32_t span, uint32_t fetch_peers);
     void set_state(stages s);
     bool sync_required();
     void send_handshakes();
@@ -689,6 +829,9 @@ public:
     void recv_block(const connection_ptr& c, const block_id_type& blk_id, uint32_t blk_num);
     void recv_handshake(const connection_ptr& c, const handshake_message& msg);
     void recv_notice(const connection_ptr& c, const notice_message& msg);
+
+    bool defer_block(const connection_ptr& c, const signed_block_ptr& b);
+    optional<std::pair<connection_ptr, signed_block_ptr>> next_ahead_block();
 };
 
 class dispatch_manager {
@@ -717,6 +860,7 @@ connection::connection(string endpoint)
     , peer_requested()
     , server_ioc(my_impl->server_ioc)
     , strand(app().get_io_service())
+    , decode_strand(*my_impl->server_ioc)
     , socket(std::make_shared<tcp::socket>(std::ref(*my_impl->server_ioc)))
     , node_id()
     , last_handshake_recv()
@@ -742,6 +886,7 @@ connection::connection(socket_ptr s)
     , peer_requested()
     , server_ioc(my_impl->server_ioc)
     , strand(app().get_io_service())
+    , decode_strand(*my_impl->server_ioc)
     , socket(s)
     , node_id()
     , last_handshake_recv()
@@ -791,6 +936,8 @@ connection::reset() {
 void
 connection::flush_queues() {
     buffer_queue.clear_write_queue();
+    batched_trxs.clear();
+    batched_trxs_size = 0;
 }
 
 void
@@ -979,6 +1126,7 @@ connection::do_queue_write(int priority) {
                     my_impl->close(conn);
                     return;
                 }
+                conn->bytes_sent += w;
                 conn->buffer_queue.clear_out_queue();
                 conn->enqueue_sync_block();
                 conn->do_queue_write(priority);
@@ -1101,9 +1249,72 @@ create_send_buffer(const packed_transaction& trx) {
     return create_send_buffer(packed_transaction_which, trx);
 }
 
+// only ids of transactions are sent, receivers are expected to have them already
+static std::shared_ptr<std::vector<char>>
+create_compact_send_buffer(const signed_block_ptr& sb) {
+    auto cb             = compact_block_message();
+    cb.header           = *sb;
+    cb.block_extensions = sb->block_extensions;
+    cb.trxs.reserve(sb->transactions.size());
+    for(auto& r : sb->transactions) {
+        auto cr   = compact_receipt();
+        cr.status = r.status;
+        cr.type   = r.type;
+        cr.id     = r.trx.id();
+        cb.trxs.emplace_back(std::move(cr));
+    }
+    return create_send_buffer(compact_block_which, cb);
+}
+
+// concatenates the packed transactions in their own send buffers into one transaction_batch_message
+static std::shared_ptr<std::vector<char>>
+create_send_buffer(const vector<std::shared_ptr<vector<char>>>& trx_buffers) {
+    static_assert(packed_transaction_which < 0x80 && transaction_batch_which < 0x80, "which should be encoded in one byte");
+    constexpr auto trx_offset = message_header_size + 1;  // skip header and which of packed_transaction
+
+    auto trxs_size = size_t(0);
+    for(auto& b : trx_buffers) {
+        trxs_size += b->size() - trx_offset;
+    }
+
+    const uint32_t payload_size = 1 + fc::raw::pack_size(unsigned_int((uint32_t)trx_buffers.size())) + trxs_size;
+
+    const char* const header     = reinterpret_cast<const char* const>(&payload_size); // avoid variable size encoding of uint32_t
+    constexpr size_t header_size = sizeof(payload_size);
+    const size_t buffer_size     = header_size + payload_size;
+
+    auto send_buffer = std::make_shared<vector<char>>(buffer_size);
+    fc::datastream<char*> ds(send_buffer->data(), buffer_size);
+    ds.write(header, header_size);
+    fc::raw::pack(ds, unsigned_int(transaction_batch_which));
+    fc::raw::pack(ds, unsigned_int((uint32_t)trx_buffers.size()));
+    for(auto& b : trx_buffers) {
+        ds.write(b->data() + trx_offset, b->size() - trx_offset);
+    }
+
+    return send_buffer;
+}
+
+void
+connection::flush_trx_batch() {
+    if(batched_trxs.empty()) {
+        return;
+    }
+    if(batched_trxs.size() == 1) {
+        enqueue_buffer(batched_trxs.front(), true, priority::low, no_reason);
+    }
+    else {
+        enqueue_buffer(create_send_buffer(batched_trxs), true, priority::low, no_reason);
+    }
+    batched_trxs.clear();
+    batched_trxs_size = 0;
+}
+
 void
 connection::enqueue_block(const signed_block_ptr& sb, bool trigger_send, bool to_sync_queue) {
-    enqueue_buffer(create_send_buffer(sb), trigger_send, priority::low, no_reason, to_sync_queue);
+    // blocks are compressed only during sync, where bandwidth matters more than latency
+    auto compress = to_sync_queue && protocol_version >= proto_compressed;
+    enqueue_buffer(my_impl->get_block_buffer(sb, compress), trigger_send, priority::low, no_reason, to_sync_queue);
 }
 
 void
@@ -1231,12 +1442,12 @@ connection::peer_has_block(const block_id_type& blkid) {
 
 //-----------------------------------------------------------
 
-sync_manager::sync_manager(uint32_t req_span)
+sync_manager::sync_manager(uint32_t req_span, uint32_t fetch_peers)
     : sync_known_lib_num(0)
     , sync_last_requested_num(0)
     , sync_next_expected_num(1)
     , sync_req_span(req_span)
-    , source()
+    , sync_fetch_peers(fetch_peers)
     , state(in_sync) {
     chain_plug = app().find_plugin<chain_plugin>();
     EVT_ASSERT(chain_plug, chain::missing_chain_plugin_exception, "");
@@ -1279,15 +1490,15 @@ sync_manager::is_active(const connection_ptr& c) {
 void
 sync_manager::reset_lib_num(const connection_ptr& c) {
     if(state == in_sync) {
-        source.reset();
+        reset_spans();
     }
     if(c->current()) {
         if(c->last_handshake_recv.last_irreversible_block_num > sync_known_lib_num) {
             sync_known_lib_num = c->last_handshake_recv.last_irreversible_block_num;
         }
     }
-    else if(c == source) {
-        sync_last_requested_num = 0;
+    else if(fetching_from(c)) {
+        release_spans(c);
         request_next_chunk();
     }
 }
@@ -1300,88 +1511,95 @@ sync_manager::sync_required() {
     return (sync_last_requested_num < sync_known_lib_num || chain_plug->chain().fork_db_head_block_num() < sync_last_requested_num);
 }
 
-void
-sync_manager::request_next_chunk(const connection_ptr& conn) {
-    uint32_t head_block = chain_plug->chain().fork_db_head_block_num();
+bool
+sync_manager::fetching_from(const connection_ptr& c) const {
+    return std::any_of(spans.cbegin(), spans.cend(), [&c](auto& s) { return s.peer == c; });
+}
 
-    if(head_block < sync_last_requested_num && source && source->current()) {
-        fc_ilog(logger, "ignoring request, head is ${h} last req = ${r} source is ${p}",
-                ("h", head_block)("r", sync_last_requested_num)("p", source->peer_name()));
-        return;
+// peers get spans in proportion to their rates measured in previous spans, unmeasured ones get the full span
+uint32_t
+sync_manager::span_size(const connection_ptr& c) const {
+    auto best = 0.0;
+    for(auto& cp : my_impl->connections) {
+        best = std::max(best, cp->sync_rate);
     }
+    if(c->sync_rate <= 0 || best <= 0) {
+        return sync_req_span;
+    }
+    auto size = (uint32_t)(sync_req_span * c->sync_rate / best);
+    return std::max(size, std::max(sync_req_span / 8, 1u));
+}
 
+// spans of failed peer are kept in place and fetched from another one
+void
+sync_manager::release_spans(const connection_ptr& c) {
+    for(auto& s : spans) {
+        if(s.peer == c) {
+            s.peer.reset();
+        }
+    }
+}
+
+void
+sync_manager::reset_spans() {
+    spans.clear();
+    ahead_blocks.clear();
+    sync_last_requested_num = 0;
+}
+
+void
+sync_manager::request_next_chunk(const connection_ptr& conn) {
     /* ----------
-     * next chunk provider selection criteria
-     * a provider is supplied and able to be used, use it.
-     * otherwise select the next available from the list, round-robin style.
+     * spans are fetched from several peers at the same time, at most one span from each peer,
+     * the supplied provider is preferred and the others are used in order of their measured rates.
+     * blocks arriving ahead of their turn are kept in ahead_blocks and applied in order.
      */
-
-    if(conn && conn->current()) {
-        source = conn;
+    auto idle = vector<connection_ptr>();
+    for(auto& c : my_impl->connections) {
+        if(c != conn && c->current() && !fetching_from(c)) {
+            idle.emplace_back(c);
+        }
     }
-    else {
-        if(my_impl->connections.size() == 1) {
-            if(!source) {
-                source = *my_impl->connections.begin();
-            }
+    std::stable_sort(idle.begin(), idle.end(), [](auto& l, auto& r) { return l->sync_rate > r->sync_rate; });
+    if(conn && conn->current() && !fetching_from(conn)) {
+        idle.insert(idle.begin(), conn);
+    }
+
+    auto now  = fc::time_point::now();
+    auto next = idle.begin();
+    auto send = [&](sync_span& s) {
+        s.peer      = *next++;
+        s.requested = now;
+        fc_ilog(logger, "requesting range ${s} to ${e}, from ${n}",
+                ("n", s.peer->peer_name())("s", s.start)("e", s.end));
+        s.peer->request_sync_blocks(s.start, s.end);
+    };
+
+    for(auto& s : spans) {
+        if(!s.peer && next != idle.end()) {
+            s.start = std::max(s.start, sync_next_expected_num);
+            send(s);
         }
-        else {
-            // init to a linear array search
-            auto cptr = my_impl->connections.begin();
-            auto cend = my_impl->connections.end();
-            // do we remember the previous source?
-            if(source) {
-                //try to find it in the list
-                cptr = my_impl->connections.find(source);
-                cend = cptr;
-                if(cptr == my_impl->connections.end()) {
-                    //not there - must have been closed! cend is now connections.end, so just flatten the ring.
-                    source.reset();
-                    cptr = my_impl->connections.begin();
-                }
-                else {
-                    //was found - advance the start to the next. cend is the old source.
-                    if(++cptr == my_impl->connections.end() && cend != my_impl->connections.end()) {
-                        cptr = my_impl->connections.begin();
-                    }
-                }
-            }
+    }
 
-            //scan the list of peers looking for another able to provide sync blocks.
-            auto cstart_it = cptr;
-            do {
-                //select the first one which is current and break out.
-                if((*cptr)->current()) {
-                    source = *cptr;
-                    break;
-                }
-                if(++cptr == my_impl->connections.end())
-                    cptr = my_impl->connections.begin();
-            } while(cptr != cstart_it);
-            // no need to check the result, either source advanced or the whole list was checked and the old source is reused.
+    while(next != idle.end() && spans.size() < sync_fetch_peers && sync_last_requested_num < sync_known_lib_num) {
+        uint32_t start = std::max(sync_last_requested_num + 1, sync_next_expected_num);
+        uint32_t end   = std::min(start + span_size(*next) - 1, sync_known_lib_num);
+        if(end < start) {
+            break;
         }
+        spans.emplace_back(sync_span{start, end, connection_ptr(), now});
+        send(spans.back());
+        sync_last_requested_num = end;
     }
 
-    // verify there is an available source
-    if(!source || !source->current()) {
+    // verify there is an available source if anything is left to fetch
+    auto fetching = std::any_of(spans.cbegin(), spans.cend(), [](auto& s) { return (bool)s.peer; });
+    if(!fetching && (!spans.empty() || sync_last_requested_num < sync_known_lib_num)) {
         fc_elog(logger, "Unable to continue syncing at this time");
-        sync_known_lib_num      = chain_plug->chain().last_irreversible_block_num();
-        sync_last_requested_num = 0;
+        sync_known_lib_num = chain_plug->chain().last_irreversible_block_num();
+        reset_spans();
         set_state(in_sync);  // probably not, but we can't do anything else
-        return;
-    }
-
-    if(sync_last_requested_num != sync_known_lib_num) {
-        uint32_t start = sync_next_expected_num;
-        uint32_t end   = start + sync_req_span - 1;
-        if(end > sync_known_lib_num)
-            end = sync_known_lib_num;
-        if(end > 0 && end >= start) {
-            fc_ilog(logger, "requesting range ${s} to ${e}, from ${n}",
-                    ("n", source->peer_name())("s", start)("e", end));
-            source->request_sync_blocks(start, end);
-            sync_last_requested_num = end;
-        }
     }
 }
 
@@ -1424,9 +1642,9 @@ sync_manager::reassign_fetch(const connection_ptr& c, go_away_reason reason) {
     fc_ilog(logger, "reassign_fetch, our last req is ${cc}, next expected is ${ne} peer ${p}",
             ("cc", sync_last_requested_num)("ne", sync_next_expected_num)("p", c->peer_name()));
 
-    if(c == source) {
+    if(fetching_from(c)) {
         c->cancel_sync(reason);
-        sync_last_requested_num = 0;
+        release_spans(c);
         request_next_chunk();
     }
 }
@@ -1560,8 +1778,7 @@ void
 sync_manager::rejected_block(const connection_ptr& c, uint32_t blk_num) {
     if(state != in_sync) {
         fc_ilog(logger, "block ${bn} not accepted from ${p}", ("bn", blk_num)("p", c->peer_name()));
-        sync_last_requested_num = 0;
-        source.reset();
+        reset_spans();
         my_impl->close(c);
         set_state(in_sync);
         send_handshakes();
@@ -1581,7 +1798,7 @@ sync_manager::recv_block(const connection_ptr& c, const block_id_type& blk_id, u
     if(state == head_catchup) {
         fc_dlog(logger, "sync_manager in head_catchup state");
         set_state(in_sync);
-        source.reset();
+        reset_spans();
 
         block_id_type null_id;
         for(const auto& cp : my_impl->connections) {
@@ -1604,17 +1821,65 @@ sync_manager::recv_block(const connection_ptr& c, const block_id_type& blk_id, u
     else if(state == lib_catchup) {
         if(blk_num == sync_known_lib_num) {
             fc_dlog(logger, "All caught up with last known last irreversible block resending handshake");
+            reset_spans();
             set_state(in_sync);
             send_handshakes();
         }
-        else if(blk_num == sync_last_requested_num) {
-            request_next_chunk();
-        }
         else {
-            fc_dlog(logger, "calling sync_wait on connection ${p}", ("p", c->peer_name()));
+            recv_span_block(c, blk_num);
+        }
+    }
+}
+
+// peer is given next span once it finishes the current one
+void
+sync_manager::recv_span_block(const connection_ptr& c, uint32_t blk_num) {
+    auto it = std::find_if(spans.begin(), spans.end(), [&](auto& s) { return s.peer == c && s.start <= blk_num && blk_num <= s.end; });
+    if(it == spans.end()) {
+        if(fetching_from(c)) {
             c->sync_wait();
         }
+        return;
+    }
+    if(blk_num != it->end) {
+        fc_dlog(logger, "calling sync_wait on connection ${p}", ("p", c->peer_name()));
+        c->sync_wait();
+        return;
+    }
+
+    auto secs = std::max((fc::time_point::now() - it->requested).count(), (int64_t)1) / 1000000.0;
+    auto rate = (it->end - it->start + 1) / secs;
+    c->sync_rate = (c->sync_rate > 0) ? (c->sync_rate + rate) / 2 : rate;
+    spans.erase(it);
+    request_next_chunk(c);
+}
+
+// blocks within the span of `c` but ahead of the next expected one wait until the ones before them are applied
+bool
+sync_manager::defer_block(const connection_ptr& c, const signed_block_ptr& b) {
+    auto blk_num = b->block_num();
+    if(state != lib_catchup || blk_num <= sync_next_expected_num) {
+        return false;
+    }
+    if(std::none_of(spans.cbegin(), spans.cend(), [&](auto& s) { return s.peer == c && s.start <= blk_num && blk_num <= s.end; })) {
+        return false;
     }
+    ahead_blocks[blk_num] = std::make_pair(c, b);
+    recv_span_block(c, blk_num);
+    return true;
+}
+
+optional<std::pair<connection_ptr, signed_block_ptr>>
+sync_manager::next_ahead_block() {
+    while(!ahead_blocks.empty() && ahead_blocks.begin()->first < sync_next_expected_num) {
+        ahead_blocks.erase(ahead_blocks.begin());
+    }
+    if(state != lib_catchup || ahead_blocks.empty() || ahead_blocks.begin()->first != sync_next_expected_num) {
+        return {};
+    }
+    auto next = std::move(ahead_blocks.begin()->second);
+    ahead_blocks.erase(ahead_blocks.begin());
+    return next;
 }
 
 //------------------------------------------------------------------------
@@ -1631,7 +1896,12 @@ dispatch_manager::bcast_block(const block_state_ptr& bs) {
     auto bnum    = bs->block_num;
     auto pbstate = peer_block_state{bs->id, bnum};
 
-    std::shared_ptr<std::vector<char>> send_buffer;
+    // suspend transactions are generated by producer and never relayed, peers cannot have them
+    auto& trxs        = bs->block->transactions;
+    auto  can_compact = my_impl->compact_blocks && !trxs.empty()
+                        && std::none_of(trxs.cbegin(), trxs.cend(), [](auto& r) { return r.type == transaction_receipt::suspend; });
+
+    std::shared_ptr<std::vector<char>> send_buffer, compact_buffer;
     for(auto& cp : my_impl->connections) {
         if(skips.find(cp) != skips.end() || !cp->current()) {
             continue;
@@ -1641,8 +1911,16 @@ dispatch_manager::bcast_block(const block_state_ptr& bs) {
             if(!cp->add_peer_block(pbstate)) {
                 continue;
             }
+            if(can_compact && cp->protocol_version >= proto_compact_block) {
+                if(!compact_buffer) {
+                    compact_buffer = create_compact_send_buffer(bs->block);
+                }
+                fc_dlog(logger, "bcast compact block ${b} to ${p}", ("b", bnum)("p", cp->peer_name()));
+                cp->enqueue_buffer(compact_buffer, true, priority::high, no_reason);
+                continue;
+            }
             if(!send_buffer) {
-                send_buffer = create_send_buffer(bs->block);
+                send_buffer = my_impl->get_block_buffer(bs->block);
             }
             fc_dlog(logger, "bcast block ${b} to ${p}", ("b", bnum)("p", cp->peer_name()));
             cp->enqueue_buffer(send_buffer, true, priority::high, no_reason);
@@ -1710,10 +1988,15 @@ dispatch_manager::bcast_transaction(const transaction_metadata_ptr& ptrx) {
         if(skips.find(c) != skips.end() || c->syncing) {
             return false;
         }
-        const auto& bs      = c->trx_state.find(id);
-        bool        unknown = bs == c->trx_state.end();
+        // transactions are held back from lagging peer until its write queue drains,
+        // instead of letting the queue grow until the connection is closed
+        if(c->buffer_queue.write_queue_size() > def_max_write_queue_size / 2) {
+            c->trxs_held_back++;
+            return false;
+        }
+        // inserting fails if peer already knows the transaction
+        bool unknown = c->trx_state.insert(transaction_state({id, 0, trx_expiration})).second;
         if(unknown) {
-            c->trx_state.insert(transaction_state({id, 0, trx_expiration}));
             fc_dlog(logger, "sending trx to ${n}", ("n", c->peer_name()));
         }
         return unknown;
@@ -2089,6 +2372,8 @@ net_plugin_impl::start_read_message(const connection_ptr& conn) {
                             }
                             EVT_ASSERT(bytes_transferred <= conn->pending_message_buffer.bytes_to_write(), plugin_exception, "");
                             conn->pending_message_buffer.advance_write_ptr(bytes_transferred);
+                            conn->bytes_received += bytes_transferred;
+                            prefetch_buffered_blocks(conn);
                             while(conn->pending_message_buffer.bytes_to_read() > 0) {
                                 uint32_t bytes_in_buffer = conn->pending_message_buffer.bytes_to_read();
 
@@ -2166,6 +2451,39 @@ net_plugin_impl::start_read_message(const connection_ptr& conn) {
     }
 }
 
+// blocks behind the first one in buffer are unpacked and have their keys recovered in background
+// while the ones before them are being applied
+void
+net_plugin_impl::prefetch_buffered_blocks(const connection_ptr& conn) {
+    static_assert(signed_block_which < 0x80, "which of signed_block should be encoded in one byte");
+
+    auto& mb    = conn->pending_message_buffer;
+    auto  index = mb.read_index();
+    auto  left  = mb.bytes_to_read();
+    auto  first = true;
+    while(left >= message_header_size) {
+        auto message_length = uint32_t();
+        mb.peek(&message_length, sizeof(message_length), index);
+        if(message_length > def_send_buffer_size * 2 || message_length == 0 || left < message_length + message_header_size) {
+            break;
+        }
+        left -= message_length + message_header_size;
+
+        auto which = char();
+        mb.peek(&which, 1, index);
+        if(which != (char)signed_block_which || first) {
+            // first block is going to be applied right now, its keys are recovered when applying
+            first = first && which != (char)signed_block_which;
+            std::decay_t<decltype(mb)>::advance_index(index, message_length - 1);
+            continue;
+        }
+
+        auto packed = std::vector<char>(message_length - 1);
+        mb.peek(packed.data(), packed.size(), index);
+        chain_plug->chain().prefetch_packed_block(std::move(packed));
+    }
+}
+
 bool
 net_plugin_impl::process_next_message(const connection_ptr& conn, uint32_t message_length) {
     try {
@@ -2173,7 +2491,12 @@ net_plugin_impl::process_next_message(const connection_ptr& conn, uint32_t messa
         auto peek_ds = conn->pending_message_buffer.create_peek_datastream();
         unsigned_int which{};
         fc::raw::unpack(peek_ds, which);
-        if(which == signed_block_which) {
+        if(which.value < net_message::count()) {
+            conn->messages_received.resize(net_message::count());
+            conn->messages_received[which.value]++;
+        }
+        // compact_block_message starts with header as well
+        if(which == signed_block_which || which == compact_block_which) {
             block_header bh;
             fc::raw::unpack(peek_ds, bh);
 
@@ -2187,19 +2510,28 @@ net_plugin_impl::process_next_message(const connection_ptr& conn, uint32_t messa
             }
         }
 
+        // transactions are unpacked and have their ids and keys computed in net threads
+        if(which == packed_transaction_which || which == transaction_batch_which) {
+            auto raw = std::vector<char>(message_length);
+            conn->pending_message_buffer.read(raw.data(), raw.size());
+            auto h   = seen_trx_messages.enabled() ? trx_dedup::hash(raw) : 0;
+            if(seen_trx_messages.seen(h)) {
+                peer_dlog(conn, "got a duplicate transaction message - dropping");
+                return true;
+            }
+            // messages dropped here are not recorded, so the copies relayed after sync are still accepted
+            if(!accepts_transactions(conn)) {
+                return true;
+            }
+            seen_trx_messages.record(h);
+            decode_transactions(conn, std::move(raw));
+            return true;
+        }
+
         auto ds = conn->pending_message_buffer.create_datastream();
         net_message msg;
         fc::raw::unpack(ds, msg);
-        msg_handler m(*this, conn);
-        if(msg.contains<signed_block>()) {
-            m(std::move(msg.get<signed_block>()));
-        }
-        else if(msg.contains<packed_transaction>()) {
-            m(std::move(msg.get<packed_transaction>()));
-        }
-        else {
-            msg.visit(m);
-        }
+        dispatch_message(conn, std::move(msg));
     }
     catch(const fc::exception& e) {
         edump((e.to_detail_string()));
@@ -2209,6 +2541,24 @@ net_plugin_impl::process_next_message(const connection_ptr& conn, uint32_t messa
     return true;
 }
 
+void
+net_plugin_impl::dispatch_message(const connection_ptr& conn, net_message&& msg) {
+    EVT_TRACE_SPAN("net_plugin::dispatch_message", msg.which());
+    msg_handler m(*this, conn);
+    if(msg.contains<signed_block>()) {
+        m(std::move(msg.get<signed_block>()));
+    }
+    else if(msg.contains<packed_transaction>()) {
+        m(std::move(msg.get<packed_transaction>()));
+    }
+    else if(msg.contains<transaction_batch_message>()) {
+        m(std::move(msg.get<transaction_batch_message>()));
+    }
+    else {
+        msg.visit(m);
+    }
+}
+
 size_t
 net_plugin_impl::count_open_sockets() const {
     size_t count = 0;
@@ -2224,11 +2574,41 @@ void
 net_plugin_impl::send_transaction_to_all(const std::shared_ptr<std::vector<char>>& send_buffer, VerifierFunc verify) {
     for(auto& c : connections) {
         if(c->current() && verify(c)) {
-            c->enqueue_buffer(send_buffer, true, priority::low, no_reason);
+            if(trx_batch_window.count() == 0 || c->protocol_version < proto_trx_batch) {
+                c->enqueue_buffer(send_buffer, true, priority::low, no_reason);
+                continue;
+            }
+
+            c->batched_trxs.emplace_back(send_buffer);
+            c->batched_trxs_size += send_buffer->size();
+            // keep batch far below the limit of message length
+            if(c->batched_trxs.size() >= trx_batch_size || c->batched_trxs_size >= def_send_buffer_size / 2) {
+                c->flush_trx_batch();
+            }
+            else if(!trx_batch_pending) {
+                start_trx_batch_timer();
+            }
         }
     }
 }
 
+void
+net_plugin_impl::start_trx_batch_timer() {
+    trx_batch_pending = true;
+    trx_batch_timer->expires_from_now(trx_batch_window);
+    trx_batch_timer->async_wait([this](boost::system::error_code ec) {
+        app().post(priority::low, [this, ec]() {
+            trx_batch_pending = false;
+            if(ec) {
+                return;
+            }
+            for(auto& c : connections) {
+                c->flush_trx_batch();
+            }
+        });
+    });
+}
+
 bool
 net_plugin_impl::is_valid(const handshake_message& msg) {
     // Do some basic validation of an incoming handshake_message, so things
@@ -2408,10 +2788,16 @@ net_plugin_impl::handle_message(const connection_ptr& c, const time_message& msg
     }
 
     c->offset = (double(c->rec - c->org) + double(msg.xmt - c->dst)) / 2;
+    c->rtt    = double(c->dst - c->org) - double(msg.xmt - c->rec);
     double NsecPerUsec{1000};
 
     if(logger.is_enabled(fc::log_level::all))
         logger.log(FC_LOG_MESSAGE(all, "Clock offset is ${o}ns (${us}us)", ("o", c->offset)("us", c->offset / NsecPerUsec)));
+
+    // half of round trip is the estimated time for a block to reach this peer
+    if(producer_plug != nullptr && c->rtt > 0) {
+        producer_plug->report_propagation_delay(fc::microseconds((int64_t)(c->rtt / NsecPerUsec / 2)));
+    }
     c->org = 0;
     c->rec = 0;
 }
@@ -2523,6 +2909,91 @@ net_plugin_impl::handle_message(const connection_ptr& c, const sync_request_mess
     }
 }
 
+bool
+net_plugin_impl::accepts_transactions(const connection_ptr& c) {
+    controller& cc = chain_plug->chain();
+    if(cc.get_read_mode() == evt::db_read_mode::READ_ONLY) {
+        fc_dlog(logger, "got a txn in read-only mode - dropping");
+        return false;
+    }
+    if(sync_master->is_active(c)) {
+        fc_dlog(logger, "got a txn during sync - dropping");
+        return false;
+    }
+    return true;
+}
+
+void
+net_plugin_impl::decode_transactions(const connection_ptr& conn, std::vector<char>&& raw) {
+    // counted as in progress until they're handed to chain
+    auto raw_size = (uint32_t)raw.size();
+    conn->trx_in_progress_size += raw_size;
+
+    connection_wptr weak_conn = conn;
+    boost::asio::post(conn->decode_strand, [this, weak_conn, raw_size, raw = std::move(raw)] {
+        EVT_TRACE_SPAN("net_plugin::decode_transactions", raw_size);
+        auto trxs = std::vector<transaction_metadata_ptr>();
+        auto ok   = true;
+        try {
+            auto ds  = fc::datastream<const char*>(raw.data(), raw.size());
+            auto msg = net_message();
+            fc::raw::unpack(ds, msg);
+
+            auto& cc  = chain_plug->chain();
+            auto  add = [&](packed_transaction&& pt) {
+                auto trx = std::make_shared<transaction_metadata>(std::make_shared<packed_transaction>(std::move(pt)));
+                try {
+                    cc.recover_keys(trx);
+                }
+                catch(...) {
+                    // invalid signatures are reported when transaction is applied
+                }
+                trxs.emplace_back(std::move(trx));
+            };
+            if(msg.contains<packed_transaction>()) {
+                add(std::move(msg.get<packed_transaction>()));
+            }
+            else {
+                auto& batch = msg.get<transaction_batch_message>();
+                trxs.reserve(batch.trxs.size());
+                for(auto& pt : batch.trxs) {
+                    add(std::move(pt));
+                }
+            }
+        }
+        catch(const fc::exception& e) {
+            fc_elog(logger, "failed to decode transactions: ${e}", ("e", e.to_detail_string()));
+            ok = false;
+        }
+
+        app().post(priority::medium, [this, weak_conn, raw_size, ok, trxs = std::move(trxs)] {
+            auto conn = weak_conn.lock();
+            if(!conn || !conn->socket || !conn->socket->is_open()) {
+                return;
+            }
+            conn->trx_in_progress_size -= raw_size;
+            if(!ok) {
+                close(conn);
+                return;
+            }
+            if(trxs.size() > 1) {
+                peer_ilog(conn, "received transaction_batch_message of ${n} transactions", ("n", trxs.size()));
+            }
+            for(auto& trx : trxs) {
+                handle_message(conn, trx);
+            }
+        });
+    });
+}
+
+// applies blocks received from other peers during sync once the ones before them are applied
+void
+net_plugin_impl::apply_ahead_blocks() {
+    while(auto next = sync_master->next_ahead_block()) {
+        handle_message(next->first, next->second);
+    }
+}
+
 size_t
 calc_trx_size(const packed_transaction_ptr& trx) {
     // transaction is stored packed and unpacked, double packed_size and size of signed as an approximation of use
@@ -2531,20 +3002,18 @@ calc_trx_size(const packed_transaction_ptr& trx) {
 
 void
 net_plugin_impl::handle_message(const connection_ptr& c, const packed_transaction_ptr& trx) {
+    handle_message(c, std::make_shared<transaction_metadata>(trx));
+}
+
+void
+net_plugin_impl::handle_message(const connection_ptr& c, const transaction_metadata_ptr& ptrx) {
     fc_dlog(logger, "got a packed transaction, cancel wait");
     peer_ilog(c, "received packed_transaction");
-    controller& cc = my_impl->chain_plug->chain();
-    if(cc.get_read_mode() == evt::db_read_mode::READ_ONLY) {
-        fc_dlog(logger, "got a txn in read-only mode - dropping");
-        return;
-    }
-    if(sync_master->is_active(c)) {
-        fc_dlog(logger, "got a txn during sync - dropping");
+    if(!accepts_transactions(c)) {
         return;
     }
 
-    auto        ptrx = std::make_shared<transaction_metadata>(trx);
-    const auto& tid  = ptrx->id;
+    const auto& tid = ptrx->id;
 
     if(local_txns.get<by_id>().find(tid) != local_txns.end()) {
         fc_dlog(logger, "got a duplicate transaction - dropping");
@@ -2572,6 +3041,266 @@ net_plugin_impl::handle_message(const connection_ptr& c, const packed_transactio
     });
 }
 
+void
+net_plugin_impl::handle_message(const connection_ptr& c, transaction_batch_message&& msg) {
+    peer_ilog(c, "received transaction_batch_message of ${n} transactions", ("n", msg.trxs.size()));
+    for(auto& trx : msg.trxs) {
+        handle_message(c, std::make_shared<packed_transaction>(std::move(trx)));
+    }
+}
+
+void
+net_plugin_impl::handle_message(const connection_ptr& c, const compact_block_message& msg) {
+    controller&   cc      = chain_plug->chain();
+    block_id_type blk_id  = msg.header.id();
+    uint32_t      blk_num = msg.header.block_num();
+    peer_ilog(c, "received compact_block_message : #${n} with ${t} transactions", ("n", blk_num)("t", msg.trxs.size()));
+
+    try {
+        if(cc.fetch_block_by_id(blk_id)) {
+            c->cancel_wait();
+            sync_master->recv_block(c, blk_id, blk_num);
+            return;
+        }
+    }
+    catch(...) {
+        fc_elog(logger, "Caught an unknown exception trying to recall blockID");
+    }
+
+    auto  block = std::make_shared<signed_block>(msg.header);
+    auto& index = local_txns.get<by_id>();
+    auto  found = true;
+
+    block->block_extensions = msg.block_extensions;
+    for(auto& cr : msg.trxs) {
+        auto it = index.find(cr.id);
+        if(it == index.end() || !it->serialized_txn) {
+            found = false;
+            break;
+        }
+
+        // skip header and which of packed_transaction in send buffer
+        constexpr auto trx_offset = message_header_size + 1;
+        auto&          buff       = *it->serialized_txn;
+        auto           ds         = fc::datastream<const char*>(buff.data() + trx_offset, buff.size() - trx_offset);
+
+        block->transactions.emplace_back();
+        auto& r = block->transactions.back();
+        r.status = cr.status;
+        r.type   = cr.type;
+        fc::raw::unpack(ds, r.trx);
+    }
+
+    if(found) {
+        // local copies may have different signatures from the ones in block
+        auto digests = vector<digest_type>();
+        digests.reserve(block->transactions.size());
+        for(auto& r : block->transactions) {
+            digests.emplace_back(r.digest());
+        }
+        if(merkle(std::move(digests)) == block->transaction_mroot) {
+            handle_message(c, block);
+            return;
+        }
+    }
+
+    peer_dlog(c, "cannot rebuild compact block #${n}, request the full one", ("n", blk_num));
+    auto req = request_message();
+    req.req_trx.mode    = none;
+    req.req_blocks.mode = normal;
+    req.req_blocks.ids.push_back(blk_id);
+    c->enqueue(req);
+    c->fetch_wait();
+    c->last_req = std::move(req);
+}
+
+void
+net_plugin_impl::handle_message(const connection_ptr& c, const compressed_message& msg) {
+    auto size = ZSTD_getFrameContentSize(msg.data.data(), msg.data.size());
+    EVT_ASSERT(size != ZSTD_CONTENTSIZE_ERROR && size != ZSTD_CONTENTSIZE_UNKNOWN && size <= def_send_buffer_size * 2,
+        plugin_exception, "Invalid compressed message from ${p}", ("p", c->peer_name()));
+
+    auto raw = std::vector<char>(size);
+    auto sz  = ZSTD_decompress(raw.data(), raw.size(), msg.data.data(), msg.data.size());
+    EVT_ASSERT(!ZSTD_isError(sz) && sz == size, plugin_exception, "Failed to decompress message from ${p}", ("p", c->peer_name()));
+
+    auto ds    = fc::datastream<const char*>(raw.data(), raw.size());
+    auto inner = net_message();
+    fc::raw::unpack(ds, inner);
+    EVT_ASSERT(!inner.contains<compressed_message>(), plugin_exception, "Nested compressed message from ${p}", ("p", c->peer_name()));
+
+    dispatch_message(c, std::move(inner));
+}
+
+// peers which are not allowed to connect without handshake can only fetch snapshots after one
+bool
+net_plugin_impl::can_serve_snapshot(const connection_ptr& c) {
+    if(allowed_connections != Any && c->last_handshake_recv.node_id == fc::sha256()) {
+        peer_wlog(c, "snapshot is requested before handshake");
+        c->enqueue(go_away_message(authentication));
+        return false;
+    }
+    return true;
+}
+
+std::optional<fc::path>
+net_plugin_impl::latest_published_snapshot() const {
+    if(snapshot_dir.empty() || !fc::is_directory(snapshot_dir)) {
+        return std::nullopt;
+    }
+
+    // only named as snapshot-<block id>.bin, the ones being written are skipped by the extension
+    auto latest = std::optional<fc::path>();
+    auto time   = std::time_t();
+    for(auto it = bfs::directory_iterator(snapshot_dir); it != bfs::directory_iterator(); it++) {
+        auto name = it->path().filename().generic_string();
+        if(!bfs::is_regular_file(it->path()) || name.size() != 9 + 64 + 4 || name.find("snapshot-") != 0 || it->path().extension() != ".bin") {
+            continue;
+        }
+        auto t = bfs::last_write_time(it->path());
+        if(!latest || t > time) {
+            latest = it->path();
+            time   = t;
+        }
+    }
+    return latest;
+}
+
+void
+net_plugin_impl::refresh_snapshot_info() {
+    if(snapshot_hashing) {
+        // waiters are replied once hashing is done
+        return;
+    }
+
+    auto latest = latest_published_snapshot();
+    if(!latest) {
+        snapshot_path.clear();
+        snapshot_info.reset();
+        reply_snapshot_waiters();
+        return;
+    }
+    if(*latest == snapshot_path && snapshot_info && fc::file_size(*latest) == snapshot_info->size) {
+        reply_snapshot_waiters();
+        return;
+    }
+
+    snapshot_hashing = true;
+    boost::asio::post(*server_ioc, [this, path = *latest] {
+        auto info = std::shared_ptr<snapshot_info_message>();
+        try {
+            auto name = path.stem().generic_string();
+            auto file = std::ifstream(path.generic_string(), std::ios::in | std::ios::binary);
+            EVT_ASSERT(file.is_open(), plugin_exception, "Cannot open snapshot: ${f}", ("f", path));
+
+            info             = std::make_shared<snapshot_info_message>();
+            info->block_id   = block_id_type(name.substr(name.find('-') + 1));
+            info->size       = fc::file_size(path);
+            info->chunk_size = def_snapshot_chunk_size;
+
+            auto buf = std::vector<char>(def_snapshot_chunk_size);
+            for(auto pos = uint64_t(0); pos < info->size; pos += buf.size()) {
+                auto sz = (size_t)std::min<uint64_t>(buf.size(), info->size - pos);
+                file.read(buf.data(), sz);
+                EVT_ASSERT(file.good(), plugin_exception, "Cannot read snapshot: ${f}", ("f", path));
+                info->chunk_hashes.emplace_back(fc::sha256::hash(buf.data(), sz));
+            }
+            fc_ilog(logger, "serving snapshot ${f} of ${n} chunks to peers", ("f", path)("n", info->chunk_hashes.size()));
+        }
+        catch(const fc::exception& e) {
+            fc_elog(logger, "failed to hash snapshot ${f}: ${e}", ("f", path)("e", e.to_detail_string()));
+            info.reset();
+        }
+
+        app().post(priority::low, [this, path, info] {
+            snapshot_hashing = false;
+            snapshot_path    = info ? path : fc::path();
+            snapshot_info    = info;
+            reply_snapshot_waiters();
+        });
+    });
+}
+
+void
+net_plugin_impl::reply_snapshot_waiters() {
+    auto waiters = std::move(snapshot_waiters);
+    snapshot_waiters.clear();
+    for(auto& w : waiters) {
+        auto c = w.lock();
+        if(!c || !c->socket || !c->socket->is_open()) {
+            continue;
+        }
+        c->enqueue(snapshot_info ? *snapshot_info : snapshot_info_message());
+    }
+}
+
+void
+net_plugin_impl::handle_message(const connection_ptr& c, const snapshot_info_request_message& msg) {
+    peer_ilog(c, "received snapshot_info_request_message");
+    if(!can_serve_snapshot(c)) {
+        return;
+    }
+    if(snapshot_dir.empty()) {
+        c->enqueue(snapshot_info_message());
+        return;
+    }
+    snapshot_waiters.emplace_back(c);
+    refresh_snapshot_info();
+}
+
+void
+net_plugin_impl::handle_message(const connection_ptr& c, const snapshot_info_message& msg) {
+    peer_wlog(c, "received unexpected snapshot_info_message");
+}
+
+void
+net_plugin_impl::handle_message(const connection_ptr& c, const snapshot_chunk_request_message& msg) {
+    peer_dlog(c, "received snapshot_chunk_request_message for chunk ${i}", ("i", msg.index));
+    if(!can_serve_snapshot(c)) {
+        return;
+    }
+
+    auto chunk     = snapshot_chunk_message();
+    chunk.block_id = msg.block_id;
+    chunk.index    = msg.index;
+    if(!snapshot_info || msg.block_id != snapshot_info->block_id || msg.index >= snapshot_info->chunk_hashes.size()) {
+        c->enqueue(chunk);
+        return;
+    }
+
+    // chunks are read in net threads, one peer only has one in flight
+    connection_wptr weak_conn = c;
+    boost::asio::post(*server_ioc, [this, weak_conn, path = snapshot_path, size = snapshot_info->size, chunk = std::move(chunk)]() mutable {
+        try {
+            auto pos  = (uint64_t)chunk.index * def_snapshot_chunk_size;
+            auto file = std::ifstream(path.generic_string(), std::ios::in | std::ios::binary);
+            chunk.data.resize((size_t)std::min<uint64_t>(def_snapshot_chunk_size, size - pos));
+            file.seekg(pos);
+            file.read(chunk.data.data(), chunk.data.size());
+            if(!file.good()) {
+                chunk.data.clear();
+            }
+        }
+        catch(...) {
+            chunk.data.clear();
+        }
+
+        auto buffer = create_send_buffer(snapshot_chunk_which, chunk);
+        app().post(priority::low, [weak_conn, buffer] {
+            auto c = weak_conn.lock();
+            if(!c || !c->socket || !c->socket->is_open()) {
+                return;
+            }
+            c->enqueue_buffer(buffer, true, priority::low, no_reason);
+        });
+    });
+}
+
+void
+net_plugin_impl::handle_message(const connection_ptr& c, const snapshot_chunk_message& msg) {
+    peer_wlog(c, "received unexpected snapshot_chunk_message");
+}
+
 void
 net_plugin_impl::handle_message(const connection_ptr& c, const signed_block_ptr& msg) {
     controller&   cc      = chain_plug->chain();
@@ -2591,6 +3320,10 @@ net_plugin_impl::handle_message(const connection_ptr& c, const signed_block_ptr&
         fc_elog(logger, "Caught an unknown exception trying to recall blockID");
     }
 
+    if(sync_master->defer_block(c, msg)) {
+        return;
+    }
+
     dispatcher->recv_block(c, blk_id, blk_num);
     fc::microseconds age(fc::time_point::now() - msg->timestamp);
     peer_ilog(c, "received signed_block : #${n} block age in secs = ${age}",
@@ -2781,6 +3514,53 @@ net_plugin_impl::close(const connection_ptr& c) {
     c->close();
 }
 
+// blocks are packed once and shared by all the connections sending them,
+// the oldest ones are dropped when cache is full
+std::shared_ptr<vector<char>>
+net_plugin_impl::get_block_buffer(const signed_block_ptr& sb, bool compress) {
+    if(block_buffers_size == 0) {
+        auto buffer = create_send_buffer(sb);
+        return compress ? compress_send_buffer(buffer) : buffer;
+    }
+
+    auto  id    = sb->id();
+    auto& index = block_buffers.get<by_id>();
+    auto  it    = index.find(id);
+    if(it == index.end()) {
+        it = block_buffers.project<by_id>(block_buffers.push_back(block_buffer_state{id, create_send_buffer(sb)}).first);
+        if(block_buffers.size() > block_buffers_size) {
+            block_buffers.pop_front();
+        }
+    }
+    if(!compress) {
+        return it->buffer;
+    }
+    if(!it->compressed) {
+        index.modify(it, [this](auto& s) { s.compressed = compress_send_buffer(s.buffer); });
+    }
+    return it->compressed;
+}
+
+// returns the original buffer if it's too small or not getting smaller
+std::shared_ptr<vector<char>>
+net_plugin_impl::compress_send_buffer(const std::shared_ptr<vector<char>>& send_buffer) {
+    if(sync_compress_min_size == 0 || send_buffer->size() < sync_compress_min_size) {
+        return send_buffer;
+    }
+
+    auto src  = send_buffer->data() + message_header_size;
+    auto size = send_buffer->size() - message_header_size;
+    auto cm   = compressed_message();
+    cm.data.resize(ZSTD_compressBound(size));
+
+    auto sz = ZSTD_compress(cm.data.data(), cm.data.size(), src, size, 3 /* default level */);
+    if(ZSTD_isError(sz) || sz >= size) {
+        return send_buffer;
+    }
+    cm.data.resize(sz);
+    return create_send_buffer(compressed_message_which, cm);
+}
+
 void
 net_plugin_impl::accepted_block(const block_state_ptr& block) {
     fc_dlog(logger, "signaled, id = ${id}", ("id", block->id));
@@ -2924,9 +3704,342 @@ handshake_initializer::populate(handshake_message& hello) {
     }
 }
 
+/**
+ * Fetches the latest snapshot published by trusted peers, it's used by chain plugin before the chain is started,
+ * so it runs its own io_context in the calling thread instead of the ones of this plugin.
+ *
+ * All the peers are asked for their latest snapshots first, then the newest one of `trusted_id` advertised by a
+ * majority of the configured peers is fetched in chunks from all the peers advertising exactly the same chunk
+ * hashes, with one chunk in flight for each peer. Chunks which fail the hash or time out are requested again from
+ * other peers, and the peers sending them are dropped.
+ */
+class snapshot_fetcher {
+public:
+    snapshot_fetcher(const vector<string>& peers, const fc::path& dir, const block_id_type& trusted_id)
+        : peers_(peers)
+        , dir_(dir)
+        , trusted_id_(trusted_id) {}
+
+public:
+    fc::path run();
+
+private:
+    struct peer {
+        peer(boost::asio::io_context& ioc, const string& addr)
+            : addr(addr)
+            , socket(ioc)
+            , timer(ioc) {}
+
+        string                    addr;
+        tcp::socket               socket;
+        boost::asio::steady_timer timer;
+        uint32_t                  length = 0;
+        vector<char>              buffer;
+
+        optional<snapshot_info_message> info;
+        optional<uint32_t>              chunk;  // index of the chunk in flight
+        bool                            closed = false;
+    };
+    using peer_ptr = std::shared_ptr<peer>;
+
+    void connect(const peer_ptr& p);
+    void send(const peer_ptr& p, const net_message& msg);
+    void read(const peer_ptr& p);
+    void on_message(const peer_ptr& p, net_message&& msg);
+    void close(const peer_ptr& p, const string& reason);
+
+    void start_fetch();
+    void request_chunks();
+    void on_chunk(const peer_ptr& p, snapshot_chunk_message&& msg);
+
+private:
+    boost::asio::io_context ioc_;
+    vector<string>          peers_;
+    fc::path                dir_;
+    block_id_type           trusted_id_;
+
+    vector<peer_ptr>                conns_;
+    uint32_t                        info_pending_ = 0;
+    optional<snapshot_info_message> info_;  // of the snapshot being fetched
+    std::deque<uint32_t>            pending_;
+    uint32_t                        done_ = 0;
+    fc::path                        part_path_;
+    std::fstream                    file_;
+};
+
+fc::path
+snapshot_fetcher::run() {
+    for(auto& addr : peers_) {
+        auto p = std::make_shared<peer>(ioc_, addr);
+        conns_.emplace_back(p);
+        info_pending_++;
+        connect(p);
+    }
+    ioc_.run();
+
+    EVT_ASSERT(info_.has_value(), plugin_exception, "No snapshot of ${id} is published by a majority of the peers", ("id", trusted_id_));
+    EVT_ASSERT(done_ == info_->chunk_hashes.size(), plugin_exception,
+        "Cannot fetch snapshot ${id} from the peers, only ${d} of ${n} chunks are fetched",
+        ("id", info_->block_id)("d", done_)("n", info_->chunk_hashes.size()));
+
+    file_.close();
+    auto path = dir_ / ("snapshot-" + info_->block_id.str() + ".bin");
+    fc::rename(part_path_, path);
+    fc_ilog(logger, "fetched snapshot ${f} from peers", ("f", path));
+    return path;
+}
+
+void
+snapshot_fetcher::connect(const peer_ptr& p) {
+    auto host = p->addr.substr(0, p->addr.find(':'));
+    EVT_ASSERT(host.size() < p->addr.size(), plugin_config_exception, "Invalid snapshot peer: ${a}", ("a", p->addr));
+    auto port = p->addr.substr(host.size() + 1);
+
+    auto resolver  = tcp::resolver(ioc_);
+    auto ec        = boost::system::error_code();
+    auto endpoints = resolver.resolve(host, port, ec);
+    if(ec) {
+        close(p, ec.message());
+        return;
+    }
+
+    p->timer.expires_after(def_snapshot_timeout);
+    p->timer.async_wait([this, p](auto& ec) {
+        if(!ec) {
+            close(p, "timeout");
+        }
+    });
+    boost::asio::async_connect(p->socket, endpoints, [this, p](auto& ec, const auto&) {
+        if(ec) {
+            close(p, ec.message());
+            return;
+        }
+        send(p, snapshot_info_request_message());
+        read(p);
+    });
+}
+
+void
+snapshot_fetcher::send(const peer_ptr& p, const net_message& msg) {
+    const uint32_t payload_size = fc::raw::pack_size(msg);
+
+    auto buffer = std::make_shared<vector<char>>(message_header_size + payload_size);
+    auto ds     = fc::datastream<char*>(buffer->data(), buffer->size());
+    ds.write((const char*)&payload_size, message_header_size);
+    fc::raw::pack(ds, msg);
+
+    boost::asio::async_write(p->socket, boost::asio::buffer(*buffer), [this, p, buffer](auto& ec, auto) {
+        if(ec) {
+            close(p, ec.message());
+        }
+    });
+}
+
+void
+snapshot_fetcher::read(const peer_ptr& p) {
+    boost::asio::async_read(p->socket, boost::asio::buffer(&p->length, message_header_size), [this, p](auto& ec, auto) {
+        if(ec) {
+            close(p, ec.message());
+            return;
+        }
+        if(p->length == 0 || p->length > def_send_buffer_size * 2) {
+            close(p, "invalid message length");
+            return;
+        }
+
+        p->buffer.resize(p->length);
+        boost::asio::async_read(p->socket, boost::asio::buffer(p->buffer), [this, p](auto& ec, auto) {
+            if(ec) {
+                close(p, ec.message());
+                return;
+            }
+
+            auto msg = net_message();
+            try {
+                auto ds = fc::datastream<const char*>(p->buffer.data(), p->buffer.size());
+                fc::raw::unpack(ds, msg);
+            }
+            catch(const fc::exception& e) {
+                close(p, e.to_string());
+                return;
+            }
+            on_message(p, std::move(msg));
+            if(!p->closed) {
+                read(p);
+            }
+        });
+    });
+}
+
+void
+snapshot_fetcher::on_message(const peer_ptr& p, net_message&& msg) {
+    if(msg.contains<snapshot_info_message>()) {
+        if(p->info.has_value() || info_.has_value()) {
+            return;
+        }
+        p->timer.cancel();
+        p->info = std::move(msg.get<snapshot_info_message>());
+        if(--info_pending_ == 0) {
+            start_fetch();
+        }
+    }
+    else if(msg.contains<snapshot_chunk_message>()) {
+        on_chunk(p, std::move(msg.get<snapshot_chunk_message>()));
+    }
+    else if(msg.contains<go_away_message>()) {
+        close(p, reason_str(msg.get<go_away_message>().reason));
+    }
+    // others like time_message are not interested
+}
+
+void
+snapshot_fetcher::close(const peer_ptr& p, const string& reason) {
+    if(p->closed) {
+        return;
+    }
+    p->closed = true;
+    p->timer.cancel();
+
+    auto ec = boost::system::error_code();
+    p->socket.close(ec);
+
+    if(!info_.has_value()) {
+        if(!p->info.has_value()) {
+            fc_wlog(logger, "cannot get snapshot info from ${p}: ${r}", ("p", p->addr)("r", reason));
+            if(--info_pending_ == 0) {
+                start_fetch();
+            }
+        }
+        return;
+    }
+
+    if(p->chunk.has_value()) {
+        fc_wlog(logger, "cannot fetch chunk ${i} of snapshot from ${p}: ${r}", ("i", *p->chunk)("p", p->addr)("r", reason));
+        pending_.push_front(*p->chunk);
+        p->chunk.reset();
+        request_chunks();
+    }
+}
+
+void
+snapshot_fetcher::start_fetch() {
+    auto infos = vector<snapshot_info_message>();
+    for(auto& p : conns_) {
+        if(!p->closed && p->info.has_value()) {
+            infos.emplace_back(*p->info);
+        }
+    }
+
+    // a majority of all the configured peers should agree on the same snapshot
+    auto quorum = (uint32_t)peers_.size() / 2 + 1;
+    auto best   = select_snapshot(infos, quorum, trusted_id_);
+    if(!best) {
+        for(auto& p : conns_) {
+            close(p, "no snapshot");
+        }
+        return;
+    }
+    auto votes = std::count_if(infos.cbegin(), infos.cend(), [&](auto& i) { return is_same_snapshot(i, *best); });
+
+    info_ = std::move(best);
+    fc_ilog(logger, "fetching snapshot ${id} of ${n} chunks from ${v} peers", ("id", info_->block_id)("n", info_->chunk_hashes.size())("v", votes));
+
+    fc::create_directories(dir_);
+    part_path_ = dir_ / ("snapshot-" + info_->block_id.str() + ".bin.part");
+    {
+        auto f = std::ofstream(part_path_.generic_string(), std::ios::out | std::ios::binary | std::ios::trunc);
+    }
+    bfs::resize_file(part_path_, info_->size);
+    file_.open(part_path_.generic_string(), std::ios::in | std::ios::out | std::ios::binary);
+    EVT_ASSERT(file_.is_open(), plugin_exception, "Cannot open snapshot file: ${f}", ("f", part_path_));
+
+    for(auto i = 0u; i < info_->chunk_hashes.size(); i++) {
+        pending_.emplace_back(i);
+    }
+    for(auto& p : conns_) {
+        if(p->info.has_value() && is_same_snapshot(*p->info, *info_)) {
+            continue;
+        }
+        close(p, "different snapshot");
+    }
+    request_chunks();
+}
+
+void
+snapshot_fetcher::request_chunks() {
+    if(done_ == info_->chunk_hashes.size()) {
+        for(auto& p : conns_) {
+            close(p, "done");
+        }
+        return;
+    }
+
+    for(auto& p : conns_) {
+        if(pending_.empty()) {
+            break;
+        }
+        if(p->closed || p->chunk.has_value()) {
+            continue;
+        }
+
+        auto req     = snapshot_chunk_request_message();
+        req.block_id = info_->block_id;
+        req.index    = pending_.front();
+        pending_.pop_front();
+
+        p->chunk = req.index;
+        p->timer.expires_after(def_snapshot_timeout);
+        p->timer.async_wait([this, p](auto& ec) {
+            if(!ec) {
+                close(p, "timeout");
+            }
+        });
+        send(p, req);
+    }
+}
+
+void
+snapshot_fetcher::on_chunk(const peer_ptr& p, snapshot_chunk_message&& msg) {
+    if(!info_.has_value() || !p->chunk.has_value() || *p->chunk != msg.index || msg.block_id != info_->block_id) {
+        close(p, "unexpected chunk");
+        return;
+    }
+
+    // info is validated when selected, so index within hashes is always within the size, checked anyway
+    auto pos = (uint64_t)msg.index * info_->chunk_size;
+    if(msg.index >= info_->chunk_hashes.size() || pos >= info_->size) {
+        close(p, "unexpected chunk");
+        return;
+    }
+    auto size = std::min<uint64_t>(info_->chunk_size, info_->size - pos);
+    if(msg.data.size() != size || fc::sha256::hash(msg.data.data(), msg.data.size()) != info_->chunk_hashes[msg.index]) {
+        close(p, "invalid chunk");
+        return;
+    }
+    p->timer.cancel();
+    p->chunk.reset();
+
+    file_.seekp(pos);
+    file_.write(msg.data.data(), msg.data.size());
+    EVT_ASSERT(file_.good(), plugin_exception, "Cannot write snapshot file: ${f}", ("f", part_path_));
+
+    auto n = (uint32_t)info_->chunk_hashes.size();
+    done_++;
+    if(done_ % std::max(n / 10, 1u) == 0) {
+        fc_ilog(logger, "fetched ${d} of ${n} chunks of snapshot", ("d", done_)("n", n));
+    }
+    request_chunks();
+}
+
 net_plugin::net_plugin()
     : my(new net_plugin_impl) {
     my_impl = my.get();
+
+    // registered here instead of initialization, chain plugin fetches snapshot before this plugin is initialized
+    my->fetch_snapshot_provider = app().get_method<chain::plugin_interface::methods::fetch_snapshot>().register_provider(
+        [](const vector<string>& peers, const fc::path& dir, const block_id_type& trusted_id) {
+            return snapshot_fetcher(peers, dir, trusted_id).run();
+        });
 }
 
 net_plugin::~net_plugin() {
@@ -2949,7 +4062,16 @@ net_plugin::set_program_options(options_description& /*cli*/, options_descriptio
         ("max-cleanup-time-msec", bpo::value<int>()->default_value(10), "max connection cleanup time per cleanup call in millisec")
         ("network-version-match", bpo::value<bool>()->default_value(false), "True to require exact match of peer network version.")
         ("sync-fetch-span", bpo::value<uint32_t>()->default_value(def_sync_fetch_span), "number of blocks to retrieve in a chunk from any individual peer during synchronization")
+        ("sync-fetch-peers", bpo::value<uint32_t>()->default_value(def_sync_fetch_peers), "maximum number of peers blocks are retrieved from at the same time during synchronization")
         ("use-socket-read-watermark", bpo::value<bool>()->default_value(false), "Enable expirimental socket read watermark optimization")
+        ("net-threads", bpo::value<uint16_t>()->default_value(2), "Number of worker threads owning p2p sockets and decoding incoming transactions")
+        ("p2p-trx-batch-us", bpo::value<uint32_t>()->default_value(1000), "Microseconds to coalesce transactions sent to each peer into one message, 0 to send them one by one")
+        ("p2p-trx-batch-size", bpo::value<uint32_t>()->default_value(100), "Maximum number of transactions coalesced into one message")
+        ("p2p-block-buffer-cache-size", bpo::value<uint32_t>()->default_value(256), "Number of recent packed blocks kept to be shared by all the peers they're sent to, 0 to pack them for every peer")
+        ("p2p-sync-compress-min-size", bpo::value<uint32_t>()->default_value(1024), "Blocks sent to peers during synchronization are compressed by zstd if they're at least this size in bytes, 0 to disable")
+        ("p2p-trx-dedup-ms", bpo::value<uint32_t>()->default_value(2000), "Milliseconds raw transaction messages are remembered by a fast hash, so the copies relayed by other peers are dropped before being unpacked, 0 to disable")
+        ("p2p-compact-blocks", bpo::value<bool>()->default_value(true), "Relay blocks to peers with only ids of their transactions, peers request full blocks if they cannot rebuild them")
+        ("p2p-snapshot-dir", bpo::value<bfs::path>(), "Directory whose newest snapshot-<id>.bin is served to peers bootstrapping from it (absolute path or relative to application data dir), snapshots published there should be full ones with token database inside")
         ("peer-log-format", bpo::value<string>()->default_value("[\"${_name}\" ${_ip}:${_port}]"),
             "The string used to format peers when logging messages about them.  Variables are escaped with ${<variable name>}.\n"
             "Available Variables:\n"
@@ -2977,7 +4099,8 @@ net_plugin::plugin_initialize(const variables_map& options) {
 
         my->network_version_match = options.at("network-version-match").as<bool>();
 
-        my->sync_master.reset(new sync_manager(options.at("sync-fetch-span").as<uint32_t>()));
+        EVT_ASSERT(options.at("sync-fetch-peers").as<uint32_t>() > 0, plugin_config_exception, "sync-fetch-peers must be greater than 0");
+        my->sync_master.reset(new sync_manager(options.at("sync-fetch-span").as<uint32_t>(), options.at("sync-fetch-peers").as<uint32_t>()));
         my->dispatcher.reset(new dispatch_manager);
 
         my->connector_period     = std::chrono::seconds(options.at("connection-cleanup-period").as<int>());
@@ -2991,6 +4114,23 @@ net_plugin::plugin_initialize(const variables_map& options) {
 
         my->use_socket_read_watermark = options.at("use-socket-read-watermark").as<bool>();
 
+        my->trx_batch_window = std::chrono::microseconds(options.at("p2p-trx-batch-us").as<uint32_t>());
+        my->trx_batch_size   = options.at("p2p-trx-batch-size").as<uint32_t>();
+        EVT_ASSERT(my->trx_batch_size > 0, plugin_config_exception, "p2p-trx-batch-size must be greater than 0");
+        my->compact_blocks   = options.at("p2p-compact-blocks").as<bool>();
+        my->seen_trx_messages.set_window(std::chrono::milliseconds(options.at("p2p-trx-dedup-ms").as<uint32_t>()));
+
+        my->block_buffers_size     = options.at("p2p-block-buffer-cache-size").as<uint32_t>();
+        my->sync_compress_min_size = options.at("p2p-sync-compress-min-size").as<uint32_t>();
+
+        if(options.count("p2p-snapshot-dir")) {
+            auto sd = options.at("p2p-snapshot-dir").as<bfs::path>();
+            my->snapshot_dir = sd.is_relative() ? app().data_dir() / sd : sd;
+        }
+
+        my->thread_pool_size = options.at("net-threads").as<uint16_t>();
+        EVT_ASSERT(my->thread_pool_size > 0, plugin_config_exception, "net-threads must be greater than 0");
+
         if(options.count("p2p-listen-endpoint") && options.at("p2p-listen-endpoint").as<string>().length()) {
             my->p2p_address = options.at("p2p-listen-endpoint").as<string>();
         }
@@ -3054,9 +4194,12 @@ net_plugin::plugin_startup() {
 
     my->server_ioc = std::make_shared<boost::asio::io_context>();
     my->server_ioc_work.emplace(boost::asio::make_work_guard(*my->server_ioc));
-    my->server_thread.emplace([ioc = my->server_ioc] {
-        ioc->run();
-    });
+    for(auto i = 0u; i < my->thread_pool_size; i++) {
+        my->server_threads.emplace_back([ioc = my->server_ioc, i] {
+            evt::utilities::affinity::enter_pool("net", i);
+            ioc->run();
+        });
+    }
 
     my->resolver = std::make_shared<tcp::resolver>(std::ref(*my->server_ioc));
     if(my->p2p_address.size() > 0) {
@@ -3089,6 +4232,8 @@ net_plugin::plugin_startup() {
     my->keepalive_timer.reset(new boost::asio::steady_timer(*my->server_ioc));
     my->ticker();
 
+    my->trx_batch_timer.reset(new boost::asio::steady_timer(*my->server_ioc));
+
     if(my->acceptor) {
         my->acceptor->open(my->listen_endpoint.protocol());
         my->acceptor->set_option(tcp::acceptor::reuse_address(true));
@@ -3118,6 +4263,8 @@ net_plugin::plugin_startup() {
 
     my->start_monitors();
 
+    my->chain_plug->register_memory_usage("net", [this] { return my->get_memory_usage(); });
+
     for(auto seed_node : my->supplied_peers) {
         connect(seed_node);
     }
@@ -3147,6 +4294,9 @@ net_plugin::plugin_shutdown() {
         if(my->keepalive_timer) {
             my->keepalive_timer->cancel();
         }
+        if(my->trx_batch_timer) {
+            my->trx_batch_timer->cancel();
+        }
 
         my->done = true;
         if(my->acceptor) {
@@ -3164,10 +4314,10 @@ net_plugin::plugin_shutdown() {
         if(my->server_ioc) {
             my->server_ioc->stop();
         }
-        if(my->server_thread.has_value()) {
-            my->server_thread->join();
-            my->server_thread.reset();
+        for(auto& t : my->server_threads) {
+            t.join();
         }
+        my->server_threads.clear();
         fc_ilog(logger, "exit shutdown");
     }
     FC_CAPTURE_AND_RETHROW()
@@ -3224,6 +4374,27 @@ net_plugin::connections() const {
     }
     return result;
 }
+fc::variant
+net_plugin_impl::get_memory_usage() const {
+    auto txns_bytes = size_t(0);
+    for(auto& t : local_txns) {
+        txns_bytes += sizeof(t) + (t.serialized_txn ? t.serialized_txn->size() : 0);
+    }
+
+    auto conns = fc::variants();
+    for(auto& c : connections) {
+        conns.emplace_back(fc::mutable_variant_object("peer", c->peer_name())
+            ("write_queue_bytes", c->buffer_queue.write_queue_size())
+            ("sync_queue_size", c->buffer_queue.sync_queue_size())
+            ("out_queue_bytes", c->buffer_queue.out_queue_bytes())
+            ("batched_trxs_bytes", c->batched_trxs_size));
+    }
+    return fc::mutable_variant_object("local_txns", local_txns.size())
+        ("local_txns_bytes", txns_bytes)
+        ("seen_trx_messages", seen_trx_messages.size())
+        ("connections", std::move(conns));
+}
+
 connection_ptr
 net_plugin_impl::find_connection(const string& host) const {
     for(const auto& c : connections)
@@ -6,8 +6,12 @@
 
 #pragma GCC diagnostic ignored "-Wunused-local-typedefs"
 
+#include <future>
+#include <optional>
+#include <vector>
 #include <fmt/format.h>
 #include <libpq-fe.h>
+#include <boost/endian/conversion.hpp>
 #include <boost/lexical_cast.hpp>
 #include <fc/io/json.hpp>
 #include <evt/chain/block_header.hpp>
@@ -27,8 +31,10 @@ namespace evt {
  * - 1.3.0  add `ft_holders` table
  * - 1.3.1  add serveral indexes for better query performance
  * - 1.4.0  update `fungibles` to support transfer permission
+ * - 1.5.0  add `trx_num` field and keyset pagination indexes to `actions` table
+ * - 1.6.0  add `balances`, `holder_counts` and `pending_balances` tables
  */
-static auto pg_version = "1.4.0";
+static auto pg_version = "1.6.0";
 
 namespace internal {
 
@@ -80,11 +86,9 @@ auto create_blocks_table = R"sql(CREATE TABLE IF NOT EXISTS public.blocks
                                      producer        character varying(21)    NOT NULL,
                                      pending         boolean                  NOT NULL DEFAULT true,
                                      created_at      timestamp with time zone NOT NULL DEFAULT now(),
-                                     CONSTRAINT      blocks_pkey PRIMARY KEY (block_id)
-                                 )
-                                 WITH (
-                                     OIDS = FALSE
+                                     CONSTRAINT      blocks_pkey PRIMARY KEY (block_id{pkey})
                                  )
+                                 {storage}
                                  TABLESPACE pg_default;
  
                                  CREATE INDEX IF NOT EXISTS blocks_block_num_index
@@ -112,11 +116,9 @@ auto create_trxs_table = R"sql(CREATE TABLE IF NOT EXISTS public.transactions
                                    charge        integer                  NOT NULL,
                                    suspend_name  character varying(21),
                                    created_at    timestamp with time zone NOT NULL DEFAULT now(),
-                                   CONSTRAINT    transactions_pkey PRIMARY KEY (trx_id)
-                               )
-                               WITH (
-                                   OIDS = FALSE
+                                   CONSTRAINT    transactions_pkey PRIMARY KEY (trx_id{pkey})
                                )
+                               {storage}
                                TABLESPACE pg_default;
                                CREATE INDEX IF NOT EXISTS transactions_block_num_index
                                    ON public.transactions USING btree
@@ -135,6 +137,7 @@ auto create_actions_table = R"sql(CREATE TABLE IF NOT EXISTS public.actions
                                       block_id   character(64)            NOT NULL,
                                       block_num  integer                  NOT NULL,
                                       trx_id     character(64)            NOT NULL,
+                                      trx_num    integer                  NOT NULL,
                                       seq_num    integer                  NOT NULL,
                                       global_seq bigint                   NOT NULL,
                                       name       character varying(13)    NOT NULL,
@@ -143,9 +146,7 @@ auto create_actions_table = R"sql(CREATE TABLE IF NOT EXISTS public.actions
                                       data       jsonb                    NOT NULL,
                                       created_at timestamp with time zone NOT NULL DEFAULT now()
                                   )
-                                  WITH (
-                                      OIDS = FALSE
-                                  )
+                                  {storage}
                                   TABLESPACE pg_default;
                                   CREATE INDEX IF NOT EXISTS actions_trx_id_index
                                       ON public.actions USING btree
@@ -162,6 +163,14 @@ auto create_actions_table = R"sql(CREATE TABLE IF NOT EXISTS public.actions
                                   CREATE INDEX IF NOT EXISTS actions_filter_index
                                       ON public.actions USING btree
                                       (domain, key, name)
+                                      TABLESPACE pg_default;
+                                  CREATE INDEX IF NOT EXISTS actions_domain_keyset_index
+                                      ON public.actions USING btree
+                                      (domain, block_num, trx_num, seq_num)
+                                      TABLESPACE pg_default;
+                                  CREATE INDEX IF NOT EXISTS actions_key_keyset_index
+                                      ON public.actions USING btree
+                                      (domain, key, block_num, trx_num, seq_num)
                                       TABLESPACE pg_default;)sql";
 
 auto create_metas_table = R"sql(CREATE SEQUENCE IF NOT EXISTS metas_id_seq;
@@ -276,6 +285,56 @@ auto create_ft_holders_table = R"sql(CREATE TABLE IF NOT EXISTS public.ft_holder
                                      )
                                      TABLESPACE pg_default;)sql";
 
+// balances of irreversible blocks, changes of reversible blocks are kept in `pending_balances` till they're irreversible
+auto create_balances_table = R"sql(CREATE TABLE IF NOT EXISTS public.balances
+                                   (
+                                       address    character(53)             NOT NULL,
+                                       sym_id     bigint                    NOT NULL,
+                                       amount     bigint                    NOT NULL,
+                                       block_num  integer                   NOT NULL,
+                                       updated_at timestamp with time zone  NOT NULL  DEFAULT now(),
+                                       CONSTRAINT balances_pkey PRIMARY KEY (address, sym_id)
+                                   )
+                                   WITH (
+                                       OIDS = FALSE
+                                   )
+                                   TABLESPACE pg_default;
+                                   CREATE INDEX IF NOT EXISTS balances_sym_id_index
+                                       ON public.balances USING btree
+                                       (sym_id, amount DESC)
+                                       TABLESPACE pg_default;)sql";
+
+// numbers of addresses with positive balance of each fungible
+auto create_holder_counts_table = R"sql(CREATE TABLE IF NOT EXISTS public.holder_counts
+                                        (
+                                            sym_id     bigint                    NOT NULL,
+                                            holders    bigint                    NOT NULL,
+                                            updated_at timestamp with time zone  NOT NULL  DEFAULT now(),
+                                            CONSTRAINT holder_counts_pkey PRIMARY KEY (sym_id)
+                                        )
+                                        WITH (
+                                            OIDS = FALSE
+                                        )
+                                        TABLESPACE pg_default;)sql";
+
+auto create_pending_balances_table = R"sql(CREATE TABLE IF NOT EXISTS public.pending_balances
+                                           (
+                                               id         bigserial                 NOT NULL,
+                                               block_id   character(64)             NOT NULL,
+                                               block_num  integer                   NOT NULL,
+                                               address    character(53)             NOT NULL,
+                                               sym_id     bigint                    NOT NULL,
+                                               amount     bigint                    NOT NULL,
+                                               CONSTRAINT pending_balances_pkey PRIMARY KEY (id)
+                                           )
+                                           WITH (
+                                               OIDS = FALSE
+                                           )
+                                           TABLESPACE pg_default;
+                                           CREATE INDEX IF NOT EXISTS pending_balances_block_num_index
+                                               ON public.pending_balances USING btree
+                                               (block_num)
+                                               TABLESPACE pg_default;)sql";
 
 struct table {
     std::string name;
@@ -292,7 +351,10 @@ table tables[] = {
     { "tokens",       false },
     { "groups",       false },
     { "fungibles",    false },
-    { "ft_holders",   false }
+    { "ft_holders",       false },
+    { "balances",         false },
+    { "holder_counts",    false },
+    { "pending_balances", false }
 };
 
 template<typename Iterator>
@@ -310,6 +372,99 @@ format_array_to(fmt::memory_buffer& buf, Iterator begin, Iterator end) {
     fmt::format_to(buf, fmt("}}\t"));
 }
 
+// writes one row of COPY in binary format, fields are in network byte order
+// see: https://www.postgresql.org/docs/11/sql-copy.html#id-1.9.3.55.9.4
+struct binary_row {
+public:
+    binary_row(fmt::memory_buffer& buf, int16_t nfields) : buf_(buf) {
+        if(buf_.size() == 0) {
+            static const char signature[] = "PGCOPY\n\377\r\n";
+            buf_.append(signature, signature + sizeof(signature));  // trailing '\0' is part of signature
+            put32(0);  // flags
+            put32(0);  // header extension length
+        }
+        put16(nfields);
+    }
+
+public:
+    static void
+    finish(fmt::memory_buffer& buf) {
+        auto v = boost::endian::native_to_big((int16_t)-1);
+        buf.append((const char*)&v, (const char*)&v + sizeof(v));
+    }
+
+public:
+    void put_int(int32_t v) { put32(sizeof(v)); put32(v); }
+    void put_bigint(int64_t v) { put32(sizeof(v)); put64(v); }
+    void put_bool(bool v) { put32(1); buf_.push_back(v ? 1 : 0); }
+    void put_null() { put32(-1); }
+
+    void
+    put_text(std::string_view str) {
+        put32((int32_t)str.size());
+        buf_.append(str.data(), str.data() + str.size());
+    }
+
+    // postgres counts timestamps in microseconds since 2000-01-01
+    void
+    put_timestamp(const fc::time_point& tp) {
+        put_bigint(tp.time_since_epoch().count() - kPgEpochUs);
+    }
+
+    // jsonb is a version byte followed by json text
+    void
+    put_jsonb(std::string_view json) {
+        put32((int32_t)json.size() + 1);
+        buf_.push_back(1);
+        buf_.append(json.data(), json.data() + json.size());
+    }
+
+    // one dimension array of bpchar
+    template<typename Iterator>
+    void
+    put_bpchar_array(Iterator begin, Iterator end) {
+        auto strs = std::vector<std::string>();
+        auto len  = 0;
+        for(auto it = begin; it != end; it++) {
+            strs.emplace_back((std::string)*it);
+            len += 4 + (int)strs.back().size();
+        }
+        if(strs.empty()) {
+            put32(12);
+            put32(0);  // ndim
+            put32(0);  // no nulls
+            put32(kBpcharOid);
+            return;
+        }
+        put32(20 + len);
+        put32(1);  // ndim
+        put32(0);  // no nulls
+        put32(kBpcharOid);
+        put32((int32_t)strs.size());
+        put32(1);  // lower bound
+        for(auto& str : strs) {
+            put_text(str);
+        }
+    }
+
+private:
+    static constexpr int64_t kPgEpochUs = 946684800ll * 1000000;
+    static constexpr int32_t kBpcharOid = 1042;
+
+    void put16(int16_t v) { v = boost::endian::native_to_big(v); buf_.append((const char*)&v, (const char*)&v + sizeof(v)); }
+    void put32(int32_t v) { v = boost::endian::native_to_big(v); buf_.append((const char*)&v, (const char*)&v + sizeof(v)); }
+    void put64(int64_t v) { v = boost::endian::native_to_big(v); buf_.append((const char*)&v, (const char*)&v + sizeof(v)); }
+
+private:
+    fmt::memory_buffer& buf_;
+};
+
+// columns written by binary COPY, the rest are filled by their defaults
+auto blocks_copy_columns  = "blocks (block_id, block_num, prev_block_id, timestamp, trx_merkle_root, trx_count, producer, pending)";
+auto trxs_copy_columns    = "transactions (trx_id, seq_num, block_id, block_num, action_count, timestamp, expiration, max_charge, payer, pending, "
+                            "type, status, signatures, keys, elapsed, charge, suspend_name)";
+auto actions_copy_columns = "actions (block_id, block_num, trx_id, trx_num, seq_num, global_seq, name, domain, key, data)";
+
 template<bool COPY = false>
 std::string
 escape_string(const std::string& str) {
@@ -351,6 +506,33 @@ pg::close() {
     PQfinish(conn_);
     conn_ = nullptr;
 
+    for(auto c : copy_conns_) {
+        PQfinish(c);
+    }
+    copy_conns_.clear();
+
+    return PG_OK;
+}
+
+int
+pg::connect_copy_pool(const std::string& conn, int num) {
+    // connections are made concurrently, each takes several round trips to server
+    auto connecting = std::vector<std::future<PGconn*>>();
+    for(auto i = 0; i < num; i++) {
+        connecting.emplace_back(std::async(std::launch::async, [&conn] { return PQconnectdb(conn.c_str()); }));
+    }
+
+    auto failed = false;
+    for(auto& f : connecting) {
+        auto c = f.get();
+        if(PQstatus(c) != CONNECTION_OK) {
+            PQfinish(c);
+            failed = true;
+            continue;
+        }
+        copy_conns_.emplace_back(c);
+    }
+    EVT_ASSERT(!failed, chain::postgres_connection_exception, "Connect failed for COPY connections");
     return PG_OK;
 }
 
@@ -390,6 +572,32 @@ pg::drop_partitions(const std::string& table) {
     return PG_OK;
 }
 
+// partition `i` of each history table holds the blocks in [1 + i * interval, 1 + (i + 1) * interval)
+int
+pg::ensure_partitions(uint32_t block_num) {
+    if(partition_interval_ == 0 || block_num < partitions_end_) {
+        return PG_OK;
+    }
+
+    auto stmts = fmt::memory_buffer();
+    while(partitions_end_ <= block_num) {
+        auto i     = (partitions_end_ - 1) / partition_interval_;
+        auto begin = 1 + (uint64_t)i * partition_interval_;
+        auto end   = begin + partition_interval_;
+        for(auto t : { "blocks", "transactions", "actions" }) {
+            fmt::format_to(stmts, fmt("CREATE TABLE IF NOT EXISTS public.{0}_p{1} PARTITION OF public.{0} FOR VALUES FROM ({2}) TO ({3});\n"),
+                t, i, begin, end);
+        }
+        partitions_end_ = (uint32_t)end;
+    }
+
+    auto r = PQexec(conn_, fmt::to_string(stmts).c_str());
+    EVT_ASSERT(PQresultStatus(r) == PGRES_COMMAND_OK, chain::postgres_exec_exception, "Create partitions failed, detail: ${s}", ("s",PQerrorMessage(conn_)));
+
+    PQclear(r);
+    return PG_OK;
+}
+
 int
 pg::create_db(const std::string& db) {
     auto sql = R"sql(CREATE DATABASE {}
@@ -517,6 +725,7 @@ pg::drop_all_tables() {
 int
 pg::drop_all_sequences() {
     drop_sequence("metas_id_seq");
+    drop_sequence("pending_balances_id_seq");
 
     return PG_OK;
 }
@@ -525,20 +734,31 @@ int
 pg::prepare_tables() {
     using namespace internal;
 
-    const char* stmts[] = {
+    // history tables are partitioned by range of block_num natively, and partition key should be in primary keys then
+    auto history = [this](auto stmt) {
+        if(partition_interval_ == 0) {
+            return fmt::format(stmt, fmt::arg("storage", "WITH (OIDS = FALSE)"), fmt::arg("pkey", ""));
+        }
+        return fmt::format(stmt, fmt::arg("storage", "PARTITION BY RANGE (block_num)"), fmt::arg("pkey", ", block_num"));
+    };
+
+    const std::string stmts[] = {
         create_stats_table,
-        create_blocks_table,
-        create_trxs_table,
+        history(create_blocks_table),
+        history(create_trxs_table),
         create_metas_table,
-        create_actions_table,
+        history(create_actions_table),
         create_domains_table,
         create_tokens_table,
         create_groups_table,
         create_fungibles_table,
-        create_ft_holders_table
+        create_ft_holders_table,
+        create_balances_table,
+        create_holder_counts_table,
+        create_pending_balances_table
     };
-    for(auto stmt : stmts) {
-        auto r = PQexec(conn_, stmt);
+    for(auto& stmt : stmts) {
+        auto r = PQexec(conn_, stmt.c_str());
         EVT_ASSERT(PQresultStatus(r) == PGRES_COMMAND_OK, chain::postgres_exec_exception,
             "Create table failed, detail: ${s}", ("s",PQerrorMessage(conn_)));
 
@@ -572,6 +792,45 @@ pg::prepare_stats() {
     return PG_OK;
 }
 
+int
+pg::drop_history_indexes(std::vector<std::string>& indexdefs) {
+    // primary keys are kept, they're needed to reject duplicated rows
+    auto r = PQexec(conn_, R"sql(SELECT indexname, indexdef FROM pg_indexes
+                                 WHERE schemaname = 'public'
+                                   AND tablename ~ '^(blocks|transactions|actions)(_[0-9]+)?$'
+                                   AND indexname NOT LIKE '%pkey';)sql");
+    EVT_ASSERT(PQresultStatus(r) == PGRES_TUPLES_OK, chain::postgres_exec_exception, "Get indexes failed, detail: ${s}", ("s",PQerrorMessage(conn_)));
+
+    auto stmts = fmt::memory_buffer();
+    for(auto i = 0; i < PQntuples(r); i++) {
+        fmt::format_to(stmts, fmt("DROP INDEX IF EXISTS {};\n"), PQgetvalue(r, i, 0));
+        indexdefs.emplace_back(PQgetvalue(r, i, 1));
+    }
+    PQclear(r);
+
+    if(indexdefs.empty()) {
+        return PG_OK;
+    }
+
+    auto r2 = PQexec(conn_, fmt::to_string(stmts).c_str());
+    EVT_ASSERT(PQresultStatus(r2) == PGRES_COMMAND_OK, chain::postgres_exec_exception, "Drop indexes failed, detail: ${s}", ("s",PQerrorMessage(conn_)));
+
+    PQclear(r2);
+    return PG_OK;
+}
+
+int
+pg::create_indexes(const std::vector<std::string>& indexdefs) {
+    for(auto& def : indexdefs) {
+        auto r = PQexec(conn_, def.c_str());
+        EVT_ASSERT(PQresultStatus(r) == PGRES_COMMAND_OK, chain::postgres_exec_exception,
+            "Create index failed, sql: ${sql}, detail: ${s}", ("sql",def)("s",PQerrorMessage(conn_)));
+
+        PQclear(r);
+    }
+    return PG_OK;
+}
+
 int
 pg::check_version() {
     auto cur_ver = std::string();
@@ -603,36 +862,125 @@ pg::new_copy_context() {
 }
 
 int
-pg::block_copy_to(const std::string& table, const std::string& data) {
-    auto stmt = fmt::format("COPY {} FROM STDIN;", table);
+pg::block_copy_to(pg_conn* conn, const std::string& table, const std::string& data) {
+    auto stmt = fmt::format("COPY {} FROM STDIN{};", table, binary_copy_ ? " WITH (FORMAT binary)" : "");
 
-    auto r = PQexec(conn_, stmt.c_str());
-    EVT_ASSERT(PQresultStatus(r) == PGRES_COPY_IN, chain::postgres_exec_exception, "Not expected COPY response, detail: ${s}", ("s",PQerrorMessage(conn_)));
+    auto r = PQexec(conn, stmt.c_str());
+    auto s = PQresultStatus(r);
     PQclear(r);
+    EVT_ASSERT(s == PGRES_COPY_IN, chain::postgres_exec_exception, "Not expected COPY response, detail: ${s}", ("s",PQerrorMessage(conn)));
 
-    auto nr = PQputCopyData(conn_, data.data(), (int)data.size());
-    EVT_ASSERT(nr == 1, chain::postgres_exec_exception, "Put data into COPY stream failed, detail: ${s}", ("s",PQerrorMessage(conn_)));
+    auto nr = PQputCopyData(conn, data.data(), (int)data.size());
+    EVT_ASSERT(nr == 1, chain::postgres_exec_exception, "Put data into COPY stream failed, detail: ${s}", ("s",PQerrorMessage(conn)));
 
-    auto nr2 = PQputCopyEnd(conn_, NULL);
-    EVT_ASSERT(nr2 == 1, chain::postgres_exec_exception, "Close data into COPY stream failed, detail: ${s}", ("s",PQerrorMessage(conn_)));
+    auto nr2 = PQputCopyEnd(conn, NULL);
+    EVT_ASSERT(nr2 == 1, chain::postgres_exec_exception, "Close data into COPY stream failed, detail: ${s}", ("s",PQerrorMessage(conn)));
 
-    auto r2 = PQgetResult(conn_);
-    EVT_ASSERT(PQresultStatus(r2) == PGRES_COMMAND_OK, chain::postgres_exec_exception, "Execute COPY command failed, detail: ${s}", ("s",PQerrorMessage(conn_)));
+    auto r2 = PQgetResult(conn);
+    auto s2 = PQresultStatus(r2);
     PQclear(r2);
+    EVT_ASSERT(s2 == PGRES_COMMAND_OK, chain::postgres_exec_exception, "Execute COPY command failed, detail: ${s}", ("s",PQerrorMessage(conn)));
+
+    // consume the rest results so that connection is ready for next command
+    while(auto r3 = PQgetResult(conn)) {
+        PQclear(r3);
+    }
 
     return PG_OK;
 }
 
+namespace internal {
+
 void
-pg::commit_copy_context(copy_context& cctx) {
-    if(cctx.blocks_copy_.size() > 0) {
-        block_copy_to("blocks", fmt::to_string(cctx.blocks_copy_));
+exec_command(pg_conn* conn, const char* stmt) {
+    auto r = PQexec(conn, stmt);
+    auto s = PQresultStatus(r);
+    PQclear(r);
+    EVT_ASSERT(s == PGRES_COMMAND_OK, chain::postgres_exec_exception, "Execute ${stmt} failed, detail: ${s}", ("stmt",stmt)("s",PQerrorMessage(conn)));
+}
+
+}  // namespace internal
+
+// each COPY stream is written in its own transaction of a pool connection in parallel,
+// these transactions are committed in order only after all of them succeed, otherwise all are rolled back
+int
+pg::parallel_copy_to(const std::vector<std::pair<const char*, std::string>>& copies) {
+    using namespace internal;
+
+    auto n     = std::min(copy_conns_.size(), copies.size());
+    auto tasks = std::vector<std::future<void>>();
+    for(auto i = 0u; i < n; i++) {
+        tasks.emplace_back(std::async(std::launch::async, [this, i, n, &copies] {
+            auto conn = copy_conns_[i];
+            exec_command(conn, "BEGIN;");
+            for(auto j = i; j < copies.size(); j += n) {
+                block_copy_to(conn, copies[j].first, copies[j].second);
+            }
+        }));
     }
-    if(cctx.trxs_copy_.size() > 0) {
-        block_copy_to("transactions", fmt::to_string(cctx.trxs_copy_));
+
+    auto except = std::exception_ptr();
+    for(auto& t : tasks) {
+        try {
+            t.get();
+        }
+        catch(...) {
+            if(!except) {
+                except = std::current_exception();
+            }
+        }
+    }
+
+    for(auto i = 0u; i < n; i++) {
+        exec_command(copy_conns_[i], except ? "ROLLBACK;" : "COMMIT;");
     }
-    if(cctx.actions_copy_.size() > 0) {
-        block_copy_to("actions", fmt::to_string(cctx.actions_copy_));
+    if(except) {
+        std::rethrow_exception(except);
+    }
+    return PG_OK;
+}
+
+std::vector<std::pair<const char*, std::string>>
+pg::collect_copies(copy_context& cctx) {
+    using namespace internal;
+
+    auto copies = std::vector<std::pair<const char*, std::string>>();
+    auto add    = [&](auto table, auto columns, auto& buf) {
+        if(buf.size() == 0) {
+            return;
+        }
+        if(binary_copy_) {
+            binary_row::finish(buf);
+            copies.emplace_back(columns, fmt::to_string(buf));
+        }
+        else {
+            copies.emplace_back(table, fmt::to_string(buf));
+        }
+    };
+    add("blocks", blocks_copy_columns, cctx.blocks_copy_);
+    add("transactions", trxs_copy_columns, cctx.trxs_copy_);
+    add("actions", actions_copy_columns, cctx.actions_copy_);
+
+    return copies;
+}
+
+void
+pg::commit_copy_context(copy_context& cctx) {
+    auto copies = collect_copies(cctx);
+    if(copy_conns_.empty() || copies.size() < 2) {
+        for(auto& c : copies) {
+            block_copy_to(conn_, c.first, c.second);
+        }
+        return;
+    }
+    parallel_copy_to(copies);
+}
+
+void
+pg::commit_copy_context(copy_context& cctx, size_t index) {
+    auto conn = copy_conns_.empty() ? conn_ : copy_conns_[index];
+    for(auto& c : collect_copies(cctx)) {
+        block_copy_to(conn, c.first, c.second);
     }
 }
 
@@ -657,16 +1005,33 @@ pg::commit_trx_context(trx_context& tctx) {
 }
 
 int
-pg::add_block(add_context& actx, const block_ptr block) {
+pg::add_block(add_context& actx, const chain::signed_block& block) {
+    using namespace internal;
+
+    actx.cctx.rows_++;
+    if(actx.cctx.db_.binary_copy_) {
+        auto row = binary_row(actx.cctx.blocks_copy_, 8);
+        row.put_text(actx.block_id);
+        row.put_int(actx.block_num);
+        row.put_text(block.previous.str());
+        row.put_timestamp(actx.time);
+        row.put_text(block.transaction_mroot.str());
+        row.put_int((int32_t)block.transactions.size());
+        row.put_text((std::string)block.producer);
+        row.put_bool(actx.pending);
+        return PG_OK;
+    }
+
     fmt::format_to(actx.cctx.blocks_copy_,
-        fmt("{}\t{:d}\t{}\t{}\t{}\t{:d}\t{}\tt\tnow\n"),
+        fmt("{}\t{:d}\t{}\t{}\t{}\t{:d}\t{}\t{}\tnow\n"),
         actx.block_id,
         actx.block_num,
-        block->header.previous.str(),
+        block.previous.str(),
         actx.ts,
-        block->header.transaction_mroot.str(),
-        block->block->transactions.size(),
-        (std::string)block->header.producer
+        block.transaction_mroot.str(),
+        block.transactions.size(),
+        (std::string)block.producer,
+        actx.pending ? "t" : "f"
         );
     return PG_OK;
 }
@@ -676,8 +1041,47 @@ pg::add_trx(add_context& actx, const trx_recept_t& trx, const trx_t& strx, int s
     using namespace internal;
 
     auto& cctx = actx.cctx;
+    cctx.rows_++;
+
+    auto suspend_name = std::optional<std::string>();
+    for(auto& ext : strx.transaction_extensions) {
+        if(std::get<0>(ext) == (uint16_t)chain::transaction_ext::suspend_name) {
+            auto& v      = std::get<1>(ext);
+            suspend_name = std::string(v.cbegin(), v.cend());
+            break;
+        }
+    }
+
+    if(cctx.db_.binary_copy_) {
+        auto keys = strx.get_signature_keys(actx.chain_id);
+        auto row  = binary_row(cctx.trxs_copy_, 17);
+        row.put_text(strx.id().str());
+        row.put_int(seq_num);
+        row.put_text(actx.block_id);
+        row.put_int(actx.block_num);
+        row.put_int((int32_t)strx.actions.size());
+        row.put_timestamp(actx.time);
+        row.put_timestamp(strx.expiration);
+        row.put_int((int32_t)strx.max_charge);
+        row.put_text((std::string)strx.payer);
+        row.put_bool(actx.pending);
+        row.put_text((std::string)trx.type);
+        row.put_text((std::string)trx.status);
+        row.put_bpchar_array(std::begin(strx.signatures), std::end(strx.signatures));
+        row.put_bpchar_array(std::begin(keys), std::end(keys));
+        row.put_int(elapsed);
+        row.put_int(charge);
+        if(suspend_name.has_value()) {
+            row.put_text(*suspend_name);
+        }
+        else {
+            row.put_null();
+        }
+        return PG_OK;
+    }
+
     fmt::format_to(cctx.trxs_copy_,
-        fmt("{}\t{:d}\t{}\t{}\t{:d}\t{}\t{}\t{:d}\t{}\tt\t{}\t{}\t"),
+        fmt("{}\t{:d}\t{}\t{}\t{:d}\t{}\t{}\t{:d}\t{}\t{}\t{}\t{}\t"),
         strx.id().str(),
         seq_num,
         actx.block_id,
@@ -687,6 +1091,7 @@ pg::add_trx(add_context& actx, const trx_recept_t& trx, const trx_t& strx, int s
         (std::string)strx.expiration,
         (int32_t)strx.max_charge,
         (std::string)strx.payer,
+        actx.pending ? "t" : "f",
         (std::string)trx.type,
         (std::string)trx.status
         );
@@ -702,20 +1107,8 @@ pg::add_trx(add_context& actx, const trx_recept_t& trx, const trx_t& strx, int s
     fmt::format_to(cctx.trxs_copy_, fmt("{}\t{}\t"), elapsed, charge);
 
     // extenscions
-    auto has_ext = 0;
-    for(auto& ext : strx.transaction_extensions) {
-        if(std::get<0>(ext) == (uint16_t)chain::transaction_ext::suspend_name) {
-            auto& v    = std::get<1>(ext);
-            auto  name = std::string(v.cbegin(), v.cend());
-
-            fmt::format_to(cctx.trxs_copy_, fmt("{}\t"), name);
-            has_ext = 1;
-            break;
-        }
-    }
-
-    if(has_ext) {
-        fmt::format_to(cctx.trxs_copy_, fmt("now\n"));
+    if(suspend_name.has_value()) {
+        fmt::format_to(cctx.trxs_copy_, fmt("{}\tnow\n"), *suspend_name);
     }
     else {
         fmt::format_to(cctx.trxs_copy_, fmt("\\N\tnow\n"));
@@ -725,24 +1118,40 @@ pg::add_trx(add_context& actx, const trx_recept_t& trx, const trx_t& strx, int s
 }
 
 int
-pg::add_action(add_context& actx, const act_trace_t& act_trace, const std::string& trx_id, int seq_num) {
+pg::add_action(add_context& actx, const action_t& act, uint64_t global_seq, const std::string& trx_id, int trx_num, int seq_num) {
     using namespace internal;
 
-    auto& act     = act_trace.act;
-    auto  acttype = actx.exec_ctx.get_acttype_name(act.name);
-    auto  data    = actx.abi.binary_to_variant(acttype, act.data, actx.exec_ctx);
+    auto acttype = actx.exec_ctx.get_acttype_name(act.name);
+    auto data    = actx.abi.binary_to_json(acttype, act.data, actx.exec_ctx);
+    actx.cctx.rows_++;
+
+    if(actx.cctx.db_.binary_copy_) {
+        auto row = binary_row(actx.cctx.actions_copy_, 10);
+        row.put_text(actx.block_id);
+        row.put_int(actx.block_num);
+        row.put_text(trx_id);
+        row.put_int(trx_num);
+        row.put_int(seq_num);
+        row.put_bigint((int64_t)global_seq);
+        row.put_text(act.name.to_string());
+        row.put_text(act.domain.to_string());
+        row.put_text(act.key.to_string());
+        row.put_jsonb(data);
+        return PG_OK;
+    }
 
     fmt::format_to(actx.cctx.actions_copy_,
-        fmt("{}\t{:d}\t{}\t{:d}\t{:d}\t{}\t{}\t{}\t{}\tnow\n"),
+        fmt("{}\t{:d}\t{}\t{:d}\t{:d}\t{:d}\t{}\t{}\t{}\t{}\tnow\n"),
         actx.block_id,
         actx.block_num,
         trx_id,
+        trx_num,
         seq_num,
-        act_trace.receipt.global_sequence,
+        global_seq,
         act.name.to_string(),
         act.domain.to_string(),
         act.key.to_string(),
-        escape_string<true>(fc::json::to_string(data))
+        escape_string<true>(data)
         );
 
     return PG_OK;
@@ -1004,17 +1413,15 @@ pg::add_fungible(trx_context& tctx, const fungible_def& ft) {
         tctx.trx_id()
         );
 
-    // support FT v1 reserved meta
-    if(!ft.metas.empty()) {
-        for(auto& m : ft.metas) {
-            auto am = addmeta();
-            am.key     = m.key;
-            am.value   = m.value;
-            am.creator = m.creator;
+    // support FT v1 reserved meta, which is added by creator along with the FT
+    if(ft.flags & (meta_flags)meta_flag::disable_set_transfer) {
+        auto am = addmeta();
+        am.key     = N128(.disable-set-transfer);
+        am.value   = "true";
+        am.creator = authorizer_ref(ft.creator);
 
-            auto act = evt::chain::action(N128(.fungible), evt::chain::name128::from_number(ft.sym.id()), am);
-            add_meta(tctx, act);
-        }
+        auto act = evt::chain::action(N128(.fungible), evt::chain::name128::from_number(ft.sym.id()), am);
+        add_meta(tctx, act);
     }
 
     return PG_OK;
@@ -1108,6 +1515,44 @@ pg::add_ft_holders(trx_context& tctx, const ft_holders_t& holders) {
     return PG_OK;
 }
 
+PREPARE_SQL_ONCE(afb_plan, "INSERT INTO pending_balances(block_id, block_num, address, sym_id, amount) VALUES($1, $2, $3, $4, $5);");
+
+int
+pg::add_ft_balances(trx_context& tctx, const add_context& actx, const ft_balances_t& balances) {
+    for(auto& b : balances) {
+        fmt::format_to(tctx.trx_buf_, fmt("EXECUTE afb_plan('{}',{},'{}',{},{});\n"), actx.block_id, actx.block_num, b.addr, (int64_t)b.sym_id, b.amount);
+    }
+    return PG_OK;
+}
+
+// last balances of block are moved into `balances`, holders are counted by the ones turned from zero to positive or reverse
+// then changes of the block and the ones forked out at the same height are dropped
+PREPARE_SQL_ONCE(mb_plan, R"sql(WITH changes AS (
+                                    SELECT DISTINCT ON (address, sym_id) address, sym_id, amount
+                                    FROM pending_balances
+                                    WHERE block_id = $1
+                                    ORDER BY address, sym_id, id DESC
+                                ), diffs AS (
+                                    SELECT c.sym_id, c.amount, COALESCE(b.amount, 0) AS old_amount
+                                    FROM changes c LEFT JOIN balances b ON b.address = c.address AND b.sym_id = c.sym_id
+                                ), upserts AS (
+                                    INSERT INTO balances
+                                    SELECT address, sym_id, amount, $2::integer, now() FROM changes
+                                    ON CONFLICT (address, sym_id) DO UPDATE SET amount = excluded.amount, block_num = excluded.block_num, updated_at = now()
+                                )
+                                INSERT INTO holder_counts
+                                SELECT sym_id, SUM(CASE WHEN amount > 0 AND old_amount <= 0 THEN 1 WHEN amount <= 0 AND old_amount > 0 THEN -1 ELSE 0 END), now()
+                                FROM diffs GROUP BY sym_id
+                                ON CONFLICT (sym_id) DO UPDATE SET holders = holder_counts.holders + excluded.holders, updated_at = now();)sql");
+PREPARE_SQL_ONCE(dpb_plan, "DELETE FROM pending_balances WHERE block_num <= $1;");
+
+int
+pg::merge_ft_balances(trx_context& tctx, const block_id_t& block_id) {
+    auto num = chain::block_header::num_from_id(block_id);
+    fmt::format_to(tctx.trx_buf_, fmt("EXECUTE mb_plan('{0}',{1});\nEXECUTE dpb_plan({1});\n"), block_id.str(), num);
+    return PG_OK;
+}
+
 int
 pg::backup(const std::shared_ptr<chain::snapshot_writer>& snapshot) const {
     using namespace internal;
@@ -1184,6 +1629,13 @@ pg::restore(const std::shared_ptr<chain::snapshot_reader>& snapshot) {
             EVT_ASSERT(PQresultStatus(r2) == PGRES_COMMAND_OK, chain::postgres_exec_exception, "Execute COPY command failed, detail: ${s}", ("s",PQerrorMessage(conn_)));
             PQclear(r2);
         });
+        if(t.name == "stats" && partition_interval_ > 0) {
+            // stats are restored first, partitions are created for the blocks restored next
+            auto id = std::string();
+            if(read_stat("last_sync_block_id", id) && !id.empty()) {
+                ensure_partitions(chain::block_header::num_from_id(block_id_t(id)));
+            }
+        }
         dlog("Restoring ${t} table - OK", ("t",t.name));
     }
 
@@ -21,10 +21,14 @@ public:
         db_.commit_copy_context(*this);
     }
 
+    // number of rows added to all the tables
+    size_t rows() const { return rows_; }
+
 private:
     fmt::memory_buffer blocks_copy_;
     fmt::memory_buffer trxs_copy_;
     fmt::memory_buffer actions_copy_;
+    size_t             rows_ = 0;
 
 private:
     pg& db_;
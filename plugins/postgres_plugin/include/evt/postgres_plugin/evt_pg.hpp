@@ -8,6 +8,7 @@
 #include <ostream>
 #include <string>
 #include <string_view>
+#include <vector>
 #include <boost/noncopyable.hpp>
 #include <evt/chain/block_state.hpp>
 #include <evt/chain/execution_context.hpp>
@@ -31,16 +32,17 @@ using namespace evt::chain::contracts;
 #define PG_OK   1
 #define PG_FAIL 0
 
-using action_t     = chain::action;
-using act_trace_t  = chain::action_trace;
-using abi_t        = chain::contracts::abi_serializer;
-using exec_ctx_t   = chain::execution_context;
-using block_ptr    = chain::block_state_ptr;
-using block_id_t   = chain::block_id_type;
-using chain_id_t   = chain::chain_id_type;
-using trx_recept_t = chain::transaction_receipt;
-using trx_t        = chain::signed_transaction;
-using ft_holders_t = chain::small_vector_base<chain::ft_holder>;
+using action_t      = chain::action;
+using act_trace_t   = chain::action_trace;
+using abi_t         = chain::contracts::abi_serializer;
+using exec_ctx_t    = chain::execution_context;
+using block_ptr     = chain::block_state_ptr;
+using block_id_t    = chain::block_id_type;
+using chain_id_t    = chain::chain_id_type;
+using trx_recept_t  = chain::transaction_receipt;
+using trx_t         = chain::signed_transaction;
+using ft_holders_t  = chain::small_vector_base<chain::ft_holder>;
+using ft_balances_t = chain::small_vector_base<chain::ft_balance>;
 
 struct copy_context;
 struct trx_context;
@@ -55,6 +57,8 @@ public:
     std::string_view  block_id;
     int               block_num;
     std::string       ts;
+    fc::time_point    time;
+    bool              pending = true;  // false for the blocks already irreversible
     const chain_id_t& chain_id;
     const abi_t&      abi;
     const exec_ctx_t& exec_ctx;
@@ -68,11 +72,24 @@ public:
     int connect(const std::string& conn);
     int close();
 
+    // extra connections used to write the COPY streams of one batch in parallel
+    int connect_copy_pool(const std::string& conn, int num);
+
+    // COPY streams are written in binary format instead of text, saves formatting and parsing
+    void set_binary_copy(bool binary) { binary_copy_ = binary; }
+
+    size_t copy_pool_size() const { return copy_conns_.size(); }
+
 public:
     int init_pathman();
     int create_partitions(const std::string& table, const std::string& relation, uint interval, uint part_nums);
     int drop_partitions(const std::string& table);
 
+    // history tables are created as declaratively partitioned tables by ranges of block_num instead of pg_pathman,
+    // partitions are created on demand by `ensure_partitions`, 0 means not partitioned natively
+    void set_native_partitions(uint32_t interval) { partition_interval_ = interval; }
+    int ensure_partitions(uint32_t block_num);
+
 public:
     int create_db(const std::string& db);
     int drop_db(const std::string& db);
@@ -87,6 +104,11 @@ public:
     int prepare_stmts();
     int prepare_stats();
 
+    // secondary indexes of blocks, transactions and actions tables(partitions included)
+    // definitions of dropped ones are returned so that they can be created again after bulk loading
+    int drop_history_indexes(std::vector<std::string>& indexdefs);
+    int create_indexes(const std::vector<std::string>& indexdefs);
+
 public:
     int backup(const std::shared_ptr<chain::snapshot_writer>& snapshot) const;
     int restore(const std::shared_ptr<chain::snapshot_reader>& snapshot);
@@ -101,14 +123,16 @@ public:
 public:
     copy_context new_copy_context();
     void commit_copy_context(copy_context&);
+    // writes all the COPY streams with the `index`th pool connection, used by bulk loading workers
+    void commit_copy_context(copy_context&, size_t index);
 
     trx_context new_trx_context();
     void commit_trx_context(trx_context&);
 
 public:
-    static int add_block(add_context&, const block_ptr);
+    static int add_block(add_context&, const chain::signed_block&);
     static int add_trx(add_context&, const trx_recept_t&, const trx_t&, int seq_num, int elapsed, int charge);
-    static int add_action(add_context&, const act_trace_t&, const std::string& trx_id, int seq_num);
+    static int add_action(add_context&, const action_t&, uint64_t global_seq, const std::string& trx_id, int trx_num, int seq_num);
     
     int get_latest_block_id(std::string& block_id) const;
     int set_block_irreversible(trx_context&, const block_id_t& block_id);
@@ -136,11 +160,23 @@ public:
 
     int add_ft_holders(trx_context&, const ft_holders_t&);
 
+    // balances changed by actions are pending till the block is irreversible,
+    // so `balances` and `holder_counts` tables are never affected by the blocks forked out
+    int add_ft_balances(trx_context&, const add_context&, const ft_balances_t&);
+    int merge_ft_balances(trx_context&, const block_id_t& block_id);
+
 private:
-    int block_copy_to(const std::string& table, const std::string& data);
+    std::vector<std::pair<const char*, std::string>> collect_copies(copy_context& cctx);
+
+    int block_copy_to(pg_conn* conn, const std::string& table, const std::string& data);
+    int parallel_copy_to(const std::vector<std::pair<const char*, std::string>>& copies);
 
 private:
-    pg_conn*    conn_;
+    pg_conn*              conn_;
+    std::vector<pg_conn*> copy_conns_;
+    bool                  binary_copy_ = false;
+    uint32_t              partition_interval_ = 0;
+    uint32_t              partitions_end_     = 1;  // blocks before it have partitions created
     std::string last_sync_block_id_;
     int         prepared_stmts_;
 };
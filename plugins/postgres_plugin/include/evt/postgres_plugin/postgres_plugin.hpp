@@ -34,6 +34,9 @@ public:
     bool enabled() const;
     const std::string& connstr() const;
 
+    // number of the last block committed into postgres, it's increased by the consumer thread
+    uint32_t last_sync_block_num() const;
+
 public:
     void read_from_snapshot(const std::shared_ptr<chain::snapshot_reader>& snapshot);
     void write_snapshot(const std::shared_ptr<chain::snapshot_writer>& snapshot) const;
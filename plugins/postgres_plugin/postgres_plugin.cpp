@@ -5,6 +5,7 @@
 #include <evt/postgres_plugin/postgres_plugin.hpp>
 
 #include <functional>
+#include <future>
 #include <queue>
 #include <optional>
 #include <tuple>
@@ -24,6 +25,7 @@ using boost::condition_variable_any;
 #include <fc/time.hpp>
 #include <fmt/format.h>
 
+#include <evt/chain/block_log.hpp>
 #include <evt/chain/config.hpp>
 #include <evt/chain/controller.hpp>
 #include <evt/chain/exceptions.hpp>
@@ -38,7 +40,9 @@ using boost::condition_variable_any;
 #include <evt/chain/token_database_cache.hpp>
 #include <evt/chain/contracts/abi_serializer.hpp>
 #include <evt/chain/contracts/evt_contract_abi.hpp>
-#include <evt/utilities/spinlock.hpp>
+#include <evt/utilities/adaptive_lock.hpp>
+#include <evt/utilities/spsc_queue.hpp>
+#include <evt/utilities/thread_affinity.hpp>
 
 #include <evt/postgres_plugin/evt_pg.hpp>
 #include <evt/postgres_plugin/copy_context.hpp>
@@ -50,8 +54,8 @@ using namespace chain;
 using namespace chain::contracts;
 using namespace chain::plugin_interface;
 
-using evt::utilities::spinlock;
-using evt::utilities::spinlock_guard;
+using evt::utilities::adaptive_lock;
+using evt::utilities::spsc_queue;
 
 static appbase::abstract_plugin& _postgres_plugin = app().register_plugin<postgres_plugin>();
 
@@ -67,6 +71,8 @@ public:
 
 public:
     void consume_queues();
+    void report_stats();
+    fc::variant get_memory_usage() const;  // sizes of queues, items hold the block states and traces
 
     void applied_block(const block_state_ptr&);
     void applied_irreversible_block(const block_state_ptr&);
@@ -78,6 +84,9 @@ public:
     
     void process_action(const action&, trx_context& tctx);
 
+    void bulk_load();
+    void bulk_load_block(const signed_block& block, copy_context& cctx);
+
     void verify_last_block(const std::string& prev_block_id);
     void verify_no_blocks();
 
@@ -93,17 +102,28 @@ public:
 
     bool     configured_          = false;
     uint32_t last_sync_block_num_ = 0;
+
+    std::atomic<uint32_t> synced_block_num_ = 0;  // updated after each batch is committed
     uint32_t part_limit_ = 0, part_num_ = 0;
+    bool     native_partitions_ = false;
 
     size_t processed_  = 0;
     size_t queue_size_ = 0;
 
-    std::deque<inblock_ptr>           block_state_queue_;
-    std::deque<transaction_trace_ptr> transaction_trace_queue_;
+    // ingest throughput is logged every `stats_interval_` seconds if it's not zero
+    uint32_t       stats_interval_  = 0;
+    size_t         ingested_blocks_ = 0, ingested_rows_ = 0;
+    size_t         reported_blocks_ = 0, reported_rows_ = 0;
+    fc::time_point last_report_;
 
-    spinlock               lock_;
-    condition_variable_any cond_;
+    bool     bulk_load_       = false;
+    uint32_t bulk_loaded_num_ = 0;  // history of blocks not greater than it are already loaded from block log
 
+    // filled by main thread, which is never blocked by them even if database is slow
+    std::optional<spsc_queue<inblock_ptr>>           block_state_queue_;
+    std::optional<spsc_queue<transaction_trace_ptr>> transaction_trace_queue_;
+
+    adaptive_lock          lock_;
     bool                   consuming_ = false;
     condition_variable_any ss_cond_;
 
@@ -115,48 +135,14 @@ public:
     std::optional<boost::signals2::scoped_connection> applied_transaction_connection_;
 };
 
-namespace internal {
-
-template <typename Q, typename V>
-inline void
-queueb(Q& bqueue, V&& v, spinlock& lock, condition_variable_any& cv, size_t queue_size) {
-    lock.lock();
-
-    auto sleep_time = 0ul;
-
-    while(bqueue.size() > queue_size) {
-        lock.unlock();
-        cv.notify_one();
-
-        sleep_time += 100;
-        std::this_thread::sleep_for(std::chrono::milliseconds(sleep_time));
-
-        lock.lock();
-    }
-    bqueue.emplace_back(std::forward<V>(v));
-    lock.unlock();
-    cv.notify_one();
-}
-
-template <typename Q, typename V>
-inline void
-queuet(Q& tqueue, V&& v, spinlock& lock, condition_variable_any& cv) {
-    lock.lock();
-    tqueue.emplace_back(std::forward<V>(v));
-    lock.unlock();
-    cv.notify_one();
-}
-
-}  // namespace internal
-
 void
 postgres_plugin_impl::applied_irreversible_block(const block_state_ptr& bsp) {
-    evt::internal::queueb(block_state_queue_, std::make_tuple(bsp, true), lock_, cond_, queue_size_);
+    block_state_queue_->push(std::make_tuple(bsp, true));
 }
 
 void
 postgres_plugin_impl::applied_block(const block_state_ptr& bsp) {
-    evt::internal::queueb(block_state_queue_, std::make_tuple(bsp, false), lock_, cond_, queue_size_);
+    block_state_queue_->push(std::make_tuple(bsp, false));
 }
 
 void
@@ -165,34 +151,42 @@ postgres_plugin_impl::applied_transaction(const transaction_trace_ptr& ttp) {
         ttp->receipt->status != transaction_receipt_header::soft_fail)) {
         return;
     }
-    evt::internal::queuet(transaction_trace_queue_, ttp, lock_, cond_);
+    transaction_trace_queue_->push(ttp);
 }
 
 void
 postgres_plugin_impl::consume_queues() {
-    using namespace evt::internal;
-
     try {
+        auto bqueue = std::deque<inblock_ptr>();
+        auto traces = std::deque<transaction_trace_ptr>();  // ones not consumed are left for next blocks
         while(true) {
-            lock_.lock();
-            while(block_state_queue_.empty() && !done_) {
-                consuming_ = false;
+            if(block_state_queue_->empty() && !done_) {
+                {
+                    std::lock_guard<adaptive_lock> lock(lock_);
+                    consuming_ = false;
+                }
                 ss_cond_.notify_all();
-                cond_.wait(lock_);
+                block_state_queue_->wait_for(std::chrono::milliseconds(100));
+                report_stats();
+                continue;
             }
 
-            auto bqueue = std::move(block_state_queue_);
-            auto traces = std::move(transaction_trace_queue_);
-
-            consuming_ = true;
-            lock_.unlock();
+            {
+                std::lock_guard<adaptive_lock> lock(lock_);
+                consuming_ = true;
+            }
+            block_state_queue_->pop_all(bqueue);
+            transaction_trace_queue_->pop_all(traces);
 
             const int BlockPtr       = 0;
             const int IsIrreversible = 1;
 
             // warn if queue size greater than 75%
             if(bqueue.size() > (queue_size_ * 0.75)) {
-                wlog("queue size: ${q}, head block num: ${b}", ("q", fmt::format("{:n}",bqueue.size()))("b",fmt::format("{:n}",std::get<BlockPtr>(bqueue.front())->block_num)));
+                auto stats = block_state_queue_->get_stats();
+                wlog("queue size: ${q}, head block num: ${b}, high watermark: ${h}, overflowed: ${o}",
+                    ("q", fmt::format("{:n}",bqueue.size()))("b",fmt::format("{:n}",std::get<BlockPtr>(bqueue.front())->block_num))
+                    ("h", fmt::format("{:n}",stats.high_watermark))("o", fmt::format("{:n}",stats.overflowed)));
             }
             else if(done_) {
                 ilog("draining queue, size: ${q}", ("q", fmt::format("{:n}",bqueue.size())));
@@ -214,6 +208,7 @@ postgres_plugin_impl::consume_queues() {
                 }
                 else {
                     process_block(std::get<BlockPtr>(b), traces, cctx, tctx);
+                    ingested_blocks_++;
                 }
 
                 bqueue.pop_front();
@@ -224,10 +219,10 @@ postgres_plugin_impl::consume_queues() {
             cctx.commit();
             tctx.commit();
 
-            if(!traces.empty()) {
-                spinlock_guard lock(lock_);
-                transaction_trace_queue_.insert(transaction_trace_queue_.begin(), traces.begin(), traces.end());
-            }
+            synced_block_num_.store(back->block_num, std::memory_order_release);
+
+            ingested_rows_ += cctx.rows();
+            report_stats();
         }
         ilog("postgres_plugin consume thread shutdown gracefully");
     }
@@ -242,6 +237,49 @@ postgres_plugin_impl::consume_queues() {
     }
 }
 
+void
+postgres_plugin_impl::report_stats() {
+    if(stats_interval_ == 0) {
+        return;
+    }
+
+    auto now = fc::time_point::now();
+    if(last_report_ == fc::time_point()) {
+        last_report_ = now;
+        return;
+    }
+    if(now - last_report_ < fc::seconds(stats_interval_)) {
+        return;
+    }
+
+    auto secs  = (now - last_report_).count() / 1'000'000.0;
+    auto stats = block_state_queue_->get_stats();
+    auto lock  = stats.overflow_lock;
+    ilog("ingest: ${b} blocks/s, ${r} rows/s, queue size: ${q}, high watermark: ${h}, synced block num: ${n}, "
+         "queue lock acquisitions: ${a}, spins: ${s}, waits: ${w}",
+        ("b", fmt::format("{:.1f}", (ingested_blocks_ - reported_blocks_) / secs))("r", fmt::format("{:.1f}", (ingested_rows_ - reported_rows_) / secs))
+        ("q", stats.size)("h", stats.high_watermark)("n", synced_block_num_.load())
+        ("a", lock.acquisitions)("s", lock.spins)("w", lock.waits));
+
+    last_report_     = now;
+    reported_blocks_ = ingested_blocks_;
+    reported_rows_   = ingested_rows_;
+}
+
+fc::variant
+postgres_plugin_impl::get_memory_usage() const {
+    auto bstats = block_state_queue_->get_stats();
+    auto tstats = transaction_trace_queue_->get_stats();
+    return fc::mutable_variant_object("blocks_queue_size", bstats.size)
+        ("blocks_queue_capacity", bstats.capacity)
+        ("blocks_high_watermark", bstats.high_watermark)
+        ("traces_queue_size", tstats.size)
+        ("traces_high_watermark", tstats.high_watermark)
+        ("blocks_queue_lock", bstats.overflow_lock)
+        ("traces_queue_lock", tstats.overflow_lock)
+        ("consuming_lock", lock_.get_stats());
+}
+
 void
 postgres_plugin_impl::verify_last_block(const std::string& prev_block_id) {
     auto last_block_id = std::string();
@@ -268,7 +306,10 @@ postgres_plugin_impl::process_irreversible_block(const block_state_ptr block, st
             // add it manually
             _process_block(block, traces, cctx, tctx);
         }
-        db_.set_block_irreversible(tctx, block->id);
+        if(block->block_num > bulk_loaded_num_) {
+            db_.set_block_irreversible(tctx, block->id);
+        }
+        db_.merge_ft_balances(tctx, block->id);
     }
     catch(fc::exception& e) {
         elog("Exception while processing irreversible block ${e}", ("e", e.to_string()));
@@ -306,13 +347,14 @@ postgres_plugin_impl::process_block(const block_state_ptr block, std::deque<tran
         break;                                               \
     }
 
-#define READ_DB_TOKEN(TYPE, PREFIX, KEY, VPTR, EXCEPTION, FORMAT, ...) \
-    try {                                                              \
-        using vtype = typename decltype(VPTR)::element_type;           \
-        VPTR = cache.template read_token<vtype>(TYPE, PREFIX, KEY);    \
-    }                                                                  \
-    catch(token_database_exception&) {                                 \
-        EVT_THROW2(EXCEPTION, FORMAT, __VA_ARGS__);                    \
+#define READ_DB_TOKEN(TYPE, PREFIX, KEY, VPTR, EXCEPTION, FORMAT, ...)     \
+    {                                                                      \
+        using vtype = typename decltype(VPTR)::element_type;               \
+        auto rr = cache.template try_read_token<vtype>(TYPE, PREFIX, KEY); \
+        if(!rr.found()) {                                                  \
+            EVT_THROW2(EXCEPTION, FORMAT, __VA_ARGS__);                    \
+        }                                                                  \
+        VPTR = std::move(rr.value);                                        \
     }
 
 void
@@ -372,8 +414,6 @@ postgres_plugin_impl::process_action(const action& act, trx_context& tctx) {
 
 void
 postgres_plugin_impl::_process_block(const block_state_ptr block, std::deque<transaction_trace_ptr>& traces, copy_context& cctx, trx_context& tctx) {
-    using namespace evt::internal;
-
     auto id = block->id.str();
     if(block->block_num <= last_sync_block_num_) {
         EVT_ASSERT(db_.exists_block(id), postgres_sync_exception,
@@ -381,7 +421,10 @@ postgres_plugin_impl::_process_block(const block_state_ptr block, std::deque<tra
         return;
     }
 
-    if(processed_ == 0) {
+    // only states are filled for the blocks loaded from block log
+    auto history = block->block_num > bulk_loaded_num_;
+
+    if(processed_ == 0 && history) {
         if(block->block_num <= 2) {
             // verify on start we have no previous blocks
             verify_no_blocks();
@@ -396,8 +439,13 @@ postgres_plugin_impl::_process_block(const block_state_ptr block, std::deque<tra
     actx.block_id  = id;
     actx.block_num = (int)block->block_num;
     actx.ts        = (std::string)block->header.timestamp.to_time_point();
+    actx.time      = block->header.timestamp.to_time_point();
 
-    db_.add_block(actx, block);
+    if(history) {
+        // next partition is created once blocks reach it
+        db_.ensure_partitions(block->block_num);
+        db_.add_block(actx, *block->block);
+    }
 
     // transactions
     auto trx_num = 0;
@@ -426,11 +474,16 @@ postgres_plugin_impl::_process_block(const block_state_ptr block, std::deque<tra
 
                     auto act_num = 0;
                     for(auto& act_trace : trace->action_traces) {
-                        db_.add_action(actx, act_trace, str_trx_id, act_num);
+                        if(history) {
+                            db_.add_action(actx, act_trace.act, act_trace.receipt.global_sequence, str_trx_id, trx_num, act_num);
+                        }
                         process_action(act_trace.act, tctx);
                         if(!act_trace.new_ft_holders.empty()) {
                             db_.add_ft_holders(tctx, act_trace.new_ft_holders);
                         }
+                        if(!act_trace.ft_balances.empty()) {
+                            db_.add_ft_balances(tctx, actx, act_trace.ft_balances);
+                        }
                         act_num++;
                     }
                     break;
@@ -439,11 +492,125 @@ postgres_plugin_impl::_process_block(const block_state_ptr block, std::deque<tra
             }
         }
 
-        db_.add_trx(actx, trx, strx, trx_num, elapsed, charge);
+        if(history) {
+            db_.add_trx(actx, trx, strx, trx_num, elapsed, charge);
+        }
+        ++trx_num;
+    }
+
+    if(history) {
+        ++processed_;
+    }
+}
+
+void
+postgres_plugin_impl::bulk_load_block(const signed_block& block, copy_context& cctx) {
+    auto id = block.id().str();
+
+    auto actx      = add_context(cctx, control_.get_chain_id(), control_.get_abi_serializer(), control_.get_execution_context());
+    actx.block_id  = id;
+    actx.block_num = (int)block.block_num();
+    actx.ts        = (std::string)block.timestamp.to_time_point();
+    actx.time      = block.timestamp.to_time_point();
+    actx.pending   = false;
+
+    db_.add_block(actx, block);
+
+    auto trx_num = 0;
+    for(const auto& trx : block.transactions) {
+        auto& strx       = trx.trx.get_signed_transaction();
+        auto  str_trx_id = strx.id().str();
+
+        if(trx.status == transaction_receipt_header::executed) {
+            // global sequence is only known by executing
+            auto act_num = 0;
+            for(auto& act : strx.actions) {
+                db_.add_action(actx, act, 0, str_trx_id, trx_num, act_num);
+                act_num++;
+            }
+        }
+
+        // elapsed and charge are only known by executing either
+        db_.add_trx(actx, trx, strx, trx_num, 0, 0);
         ++trx_num;
     }
+}
+
+// history of blocks in block log is loaded without secondary indexes, each worker reads its own ranges of blocks
+// and writes them with its own connection, indexes are created again at the end.
+// states are not touched, they're still filled when these blocks are replayed
+void
+postgres_plugin_impl::bulk_load() {
+    const uint32_t kRangeBlocks  = 10000;
+    const uint32_t kCommitBlocks = 500;
+
+    auto& blog = control_.get_block_log();
+    if(!blog.head()) {
+        ilog("No blocks in block log, skip bulk loading");
+        return;
+    }
+
+    auto first = blog.first_available_block_num();
+    auto last  = blog.head()->block_num();
+    ilog("bulk loading blocks from ${f} to ${l}", ("f",first)("l",last));
+
+    auto start     = fc::time_point::now();
+    auto indexdefs = std::vector<std::string>();
+    db_.ensure_partitions(last);
+    db_.drop_history_indexes(indexdefs);
+
+    auto next    = std::atomic<uint32_t>(first);
+    auto failed  = std::atomic_bool(false);
+    auto workers = std::max(db_.copy_pool_size(), (size_t)1);
+    auto tasks   = std::vector<std::future<void>>();
+    for(auto i = 0u; i < workers; i++) {
+        tasks.emplace_back(std::async(std::launch::async, [&, i] {
+            try {
+                while(!failed) {
+                    auto begin = next.fetch_add(kRangeBlocks);
+                    if(begin > last) {
+                        break;
+                    }
+                    auto end    = std::min(begin + kRangeBlocks - 1, last);
+                    auto reader = block_log_reader(blog, begin);
+                    for(auto num = begin; num <= end && !failed;) {
+                        auto cctx = db_.new_copy_context();
+                        for(auto n = 0u; n < kCommitBlocks && num <= end; n++, num++) {
+                            auto b = reader.read_next();
+                            EVT_ASSERT(b, postgres_plugin_exception, "Cannot read block ${n} from block log", ("n",num));
+                            bulk_load_block(*b, cctx);
+                        }
+                        db_.commit_copy_context(cctx, i);
+                    }
+                }
+            }
+            catch(...) {
+                failed = true;
+                throw;
+            }
+        }));
+    }
 
-    ++processed_;
+    auto except = std::exception_ptr();
+    for(auto& t : tasks) {
+        try {
+            t.get();
+        }
+        catch(...) {
+            if(!except) {
+                except = std::current_exception();
+            }
+        }
+    }
+    if(except) {
+        std::rethrow_exception(except);
+    }
+
+    ilog("bulk loaded ${n} blocks in ${t} ms, creating ${i} indexes", ("n",last - first + 1)("t",(fc::time_point::now() - start).count() / 1000)("i",indexdefs.size()));
+    db_.create_indexes(indexdefs);
+
+    bulk_loaded_num_ = last;
+    ilog("bulk loading finished in ${t} ms", ("t",(fc::time_point::now() - start).count() / 1000));
 }
 
 void
@@ -462,6 +629,7 @@ postgres_plugin_impl::init(bool init_db) {
             db_.check_last_sync_block();
 
             last_sync_block_num_ = block_header::num_from_id(block_id_type(db_.last_sync_block_id()));
+            synced_block_num_    = last_sync_block_num_;
         }
         EVT_RETHROW_EXCEPTIONS(evt::postgres_plugin_exception,
             "Check integrity of postgres database failed, please use --clear-postgres to clear database");
@@ -478,18 +646,23 @@ postgres_plugin_impl::init(bool init_db) {
         applied_irreversible_block(bs);
     }));
 
-    applied_transaction_connection_.emplace(chain.applied_transaction.connect([&](const chain::transaction_trace_ptr& t) {
-        applied_transaction(t);
+    // traces are delivered once per block, before the block itself
+    applied_transaction_connection_.emplace(chain.applied_block_traces.connect([&](const chain::block_traces_ptr& bt) {
+        for(auto& t : bt->traces) {
+            applied_transaction(t);
+        }
     }));
 
     if(init_db) {
-        db_.init_pathman();
+        if(!native_partitions_) {
+            db_.init_pathman();
+        }
 
         db_.prepare_tables();
         db_.prepare_stmts();
         db_.prepare_stats();
         
-        if(part_limit_ != 0) {
+        if(part_limit_ != 0 && !native_partitions_) {
             db_.create_partitions("public.blocks", "block_num", part_limit_, part_num_);
             db_.create_partitions("public.transactions", "block_num", part_limit_, part_num_);
             db_.create_partitions("public.actions", "block_num", part_limit_, part_num_);
@@ -508,6 +681,10 @@ postgres_plugin_impl::init(bool init_db) {
         db_.add_group(tctx, ng);
 
         tctx.commit();
+
+        if(bulk_load_) {
+            bulk_load();
+        }
     }
 }
 
@@ -517,7 +694,6 @@ postgres_plugin_impl::~postgres_plugin_impl() {
     }
     try {
         done_ = true;
-        cond_.notify_one();
 
         consume_thread_.join();
         db_.close();
@@ -541,6 +717,11 @@ postgres_plugin::connstr() const {
     return my_->connstr_;
 }
 
+uint32_t
+postgres_plugin::last_sync_block_num() const {
+    return my_->synced_block_num_.load(std::memory_order_acquire);
+}
+
 void
 postgres_plugin::read_from_snapshot(const std::shared_ptr<chain::snapshot_reader>& snapshot) {
     my_->db_.restore(snapshot);
@@ -549,7 +730,7 @@ postgres_plugin::read_from_snapshot(const std::shared_ptr<chain::snapshot_reader
 void
 postgres_plugin::write_snapshot(const std::shared_ptr<chain::snapshot_writer>& snapshot) const {
     my_->lock_.lock();
-    while(my_->consuming_ || !my_->block_state_queue_.empty()) {
+    while(my_->consuming_ || !my_->block_state_queue_->empty()) {
         my_->ss_cond_.wait(my_->lock_);
     }
     my_->lock_.unlock();
@@ -566,12 +747,28 @@ postgres_plugin::set_program_options(options_description& cli, options_descripti
         ("clear-postgres", bpo::bool_switch()->default_value(false), "clear postgres database, use --delete-all-blocks option will force set this option")
         ("postgres-partition-limit", bpo::value<uint>()->default_value(30000000), "The partition limit")
         ("postgres-partition-num", bpo::value<uint>()->default_value(10), "The number of partitions")
+        ("postgres-native-partitions", bpo::bool_switch()->default_value(false),
+            "Create history tables as declaratively partitioned ones(PostgreSQL 12+) instead of using pg_pathman when database is created, "
+            "each partition holds postgres-partition-limit blocks and next one is created when blocks reach it")
+        ("postgres-copy-connections", bpo::value<uint>()->default_value(3),
+            "The number of extra connections to write blocks, transactions and actions of one batch in parallel, 0 to write them serially")
+        ("postgres-binary-copy", bpo::value<bool>()->default_value(true), "Write blocks, transactions and actions with COPY in binary format instead of text")
+        ("postgres-bulk-load", bpo::bool_switch()->default_value(false),
+            "Load blocks, transactions and actions directly from block log when database is cleared, replaying then only fills the states. "
+            "Elapsed, charge and global sequence of the loaded ones are zero and generated actions are not included")
+        ("postgres-stats-interval", bpo::value<uint32_t>()->default_value(0),
+            "Log blocks/s, rows/s and queue size of writing into postgres every this many seconds, 0 to disable")
+        ("postgres-lock-profiling", bpo::bool_switch()->default_value(false),
+            "Measure the time locks between main thread and postgres thread are held, reported along with their contention counters")
         ;
 }
 
 void
 postgres_plugin::plugin_initialize(const variables_map& options) {
     my_ = std::make_unique<postgres_plugin_impl>(app().get_plugin<chain_plugin>().chain());
+    my_->block_state_queue_.emplace(options.at("postgres-queue-size").as<uint>());
+    // several transactions per block
+    my_->transaction_trace_queue_.emplace(options.at("postgres-queue-size").as<uint>() * 8);
 
     if(options.count("postgres-uri")) {
         ilog("initializing postgres_plugin");
@@ -591,6 +788,10 @@ postgres_plugin::plugin_initialize(const variables_map& options) {
                 "--clear-postgres option should be used with --(hard-)replay-blockchain");
         }
 
+        my_->bulk_load_ = options.at("postgres-bulk-load").as<bool>();
+        EVT_ASSERT(!my_->bulk_load_ || delete_state, postgres_plugin_exception,
+            "--postgres-bulk-load option should be used with --clear-postgres");
+
         if(options.count("postgres-partition-limit")) {
             my_->part_limit_ = options.at("postgres-partition-limit").as<uint>();
             if(my_->part_limit_ == 0) {
@@ -602,14 +803,35 @@ postgres_plugin::plugin_initialize(const variables_map& options) {
             my_->part_num_ = options.at("postgres-partition-num").as<uint>();
         }
 
+        my_->native_partitions_ = options.at("postgres-native-partitions").as<bool>();
+        EVT_ASSERT(!my_->native_partitions_ || my_->part_limit_ > 0, postgres_plugin_exception,
+            "--postgres-native-partitions option requires postgres-partition-limit to be greater than 0");
+
         if(options.count("postgres-queue-size")) {
             my_->queue_size_ = options.at("postgres-queue-size").as<uint>();
         }
+        my_->stats_interval_ = options.at("postgres-stats-interval").as<uint32_t>();
+
+        if(options.at("postgres-lock-profiling").as<bool>()) {
+            my_->lock_.set_profiling(true);
+            my_->block_state_queue_->set_lock_profiling(true);
+            my_->transaction_trace_queue_->set_lock_profiling(true);
+        }
 
         auto uri = options.at("postgres-uri").as<std::string>();
         ilog("connecting to ${u}", ("u", uri));
-        
+
+        auto begin   = fc::time_point::now();
+        auto copying = std::async(std::launch::async, [&] {
+            return my_->db_.connect_copy_pool(uri, (int)options.at("postgres-copy-connections").as<uint>());
+        });
         my_->db_.connect(uri);
+        copying.get();
+        ilog("connected to postgres in ${t} ms", ("t",(fc::time_point::now() - begin).count() / 1000));
+        my_->db_.set_binary_copy(options.at("postgres-binary-copy").as<bool>());
+        if(my_->native_partitions_) {
+            my_->db_.set_native_partitions(my_->part_limit_);
+        }
         my_->connstr_ = uri;
 
         if(!my_->db_.exists_table("blocks") || delete_state) {
@@ -623,7 +845,7 @@ postgres_plugin::plugin_initialize(const variables_map& options) {
 
             // recover genesis information from the snapshot
             auto infile = std::ifstream(snapshot_path.generic_string(), (std::ios::in | std::ios::binary));
-            auto reader = std::make_shared<istream_snapshot_reader>(infile);
+            auto reader = make_snapshot_reader(infile);
             reader->validate();
 
             if(reader->has_section("pg-blocks")) {
@@ -640,7 +862,10 @@ postgres_plugin::plugin_initialize(const variables_map& options) {
 
         my_->init(delete_state);
 
-        my_->consume_thread_ = std::thread([this] { my_->consume_queues(); });
+        my_->consume_thread_ = std::thread([this] {
+            evt::utilities::affinity::enter_pool("postgres", 0);
+            my_->consume_queues();
+        });
     }
     else {
         wlog("evt::postgres_plugin configured, but no --postgres-uri specified.");
@@ -649,7 +874,11 @@ postgres_plugin::plugin_initialize(const variables_map& options) {
 }
 
 void
-postgres_plugin::plugin_startup() {}
+postgres_plugin::plugin_startup() {
+    if(my_->configured_) {
+        app().get_plugin<chain_plugin>().register_memory_usage("postgres", [this] { return my_->get_memory_usage(); });
+    }
+}
 
 void
 postgres_plugin::plugin_shutdown() {
@@ -84,8 +84,24 @@ producer_api_plugin::plugin_startup() {
              INVOKE_V_R(producer, update_runtime_options, producer_plugin::runtime_options), 201),
         CALL(producer, producer, get_integrity_hash,
              INVOKE_R_V(producer, get_integrity_hash), 201),
+        CALL(producer, producer, get_state_digest,
+             INVOKE_R_V(producer, get_state_digest), 201),
         CALL(producer, producer, create_snapshot,
-             INVOKE_R_R(producer, create_snapshot, producer_plugin::create_snapshot_options), 201)},
+             INVOKE_R_R(producer, create_snapshot, producer_plugin::create_snapshot_options), 201),
+        CALL(producer, producer, get_production_stats,
+             INVOKE_R_V(producer, get_production_stats), 201),
+        CALL(producer, producer, start_trace,
+             INVOKE_V_R(producer, start_trace, producer_plugin::trace_options), 201),
+        CALL(producer, producer, stop_trace,
+             INVOKE_V_V(producer, stop_trace), 201),
+        CALL(producer, producer, get_trace,
+             INVOKE_R_V(producer, get_trace), 201),
+        CALL(producer, producer, start_profile,
+             INVOKE_V_R(producer, start_profile, producer_plugin::profile_options), 201),
+        CALL(producer, producer, stop_profile,
+             INVOKE_V_V(producer, stop_profile), 201),
+        CALL(producer, producer, get_profile,
+             INVOKE_R_R(producer, get_profile, producer_plugin::get_profile_options), 201)},
         true /* local only API */);
 }
 
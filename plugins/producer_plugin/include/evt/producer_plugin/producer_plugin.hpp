@@ -7,6 +7,7 @@
 
 #include <evt/chain_plugin/chain_plugin.hpp>
 #include <evt/http_client_plugin/http_client_plugin.hpp>
+#include <evt/utilities/sampler.hpp>
 #include <appbase/application.hpp>
 
 namespace evt {
@@ -31,6 +32,13 @@ public:
         chain::digest_type   integrity_hash;
     };
 
+    struct state_digest_information {
+        uint32_t             head_block_num;
+        chain::block_id_type head_block_id;
+        fc::time_point       head_block_time;
+        chain::digest_type   state_digest;
+    };
+
     struct snapshot_information {
         uint32_t             head_block_num;
         chain::block_id_type head_block_id;
@@ -40,8 +48,47 @@ public:
         bool                 postgres;
     };
 
+    // where the time of one produced block goes, times are in microseconds
+    struct production_stats {
+        uint32_t       block_num = 0;
+        fc::time_point timestamp;
+
+        uint32_t persisted_us        = 0;  // expiring persisted transactions
+        uint32_t unapplied_us        = 0;  // re-pushing unapplied transactions
+        uint32_t blacklist_us        = 0;  // expiring blacklisted transactions
+        uint32_t pending_incoming_us = 0;  // applying queued incoming transactions
+        uint32_t execution_us        = 0;  // executing incoming transactions since block started
+        uint32_t finalize_us         = 0;
+        uint32_t sign_us             = 0;
+        uint32_t commit_us           = 0;
+
+        uint32_t applied   = 0;
+        uint32_t failed    = 0;
+        uint32_t exhausted = 0;  // transactions which couldn't fit and were left for next block
+
+        std::string exhausted_reason;  // why starting the block returned exhausted, empty if it didn't
+    };
+
     struct create_snapshot_options {
-        bool postgres = false;
+        bool postgres   = false;
+        bool checkpoint = false;  // write token database as a native checkpoint beside the snapshot
+        bool compress   = false;  // write snapshot of format 2, whose sections are compressed by zstd and written in parallel
+        // head block id of a snapshot in snapshots dir, only the changes of token database since it are written if provided
+        std::string delta_base;
+    };
+
+    struct trace_options {
+        uint32_t sample_rate = 1;      // records one of every this many outermost spans of each thread
+        uint32_t buffer_size = 65536;  // latest spans kept for each thread
+    };
+
+    struct profile_options {
+        uint32_t frequency   = 99;     // samples per second of cpu time of the process
+        uint32_t buffer_size = 20000;  // samples kept (at most 200000), later ones are dropped
+    };
+
+    struct get_profile_options {
+        std::vector<std::string> groups;  // thread groups like main, net, http, postgres and rocksdb, all if empty
     };
 
     producer_plugin();
@@ -65,8 +112,25 @@ public:
     runtime_options get_runtime_options() const;
 
     integrity_hash_information get_integrity_hash() const;
+    state_digest_information get_state_digest() const;
     snapshot_information create_snapshot(const create_snapshot_options& options) const;
 
+    std::vector<production_stats> get_production_stats() const;  // recent produced blocks, latest last
+
+    // spans are only recorded when built with ENABLE_TRACING, trace is in Chrome trace event format
+    void        start_trace(const trace_options& options);
+    void        stop_trace();
+    fc::variant get_trace() const;
+
+    // stacks of threads are sampled by SIGPROF, profile is in collapsed format for flame graphs.
+    // profile is symbolized in main thread when got by api, which stalls production till it's done
+    void                              start_profile(const profile_options& options);
+    void                              stop_profile();
+    evt::utilities::sampler::profile get_profile(const get_profile_options& options) const;
+
+    // reported by network with the one-way delay to a peer, used to adapt time offsets of production
+    void report_propagation_delay(const fc::microseconds& delay);
+
     signal<void(const chain::producer_confirmation&)> confirmed_block;
 
 private:
@@ -77,5 +141,11 @@ private:
 
 FC_REFLECT(evt::producer_plugin::runtime_options, (max_transaction_time)(max_irreversible_block_age)(produce_time_offset_us)(last_block_time_offset_us));
 FC_REFLECT(evt::producer_plugin::integrity_hash_information, (head_block_num)(head_block_id)(head_block_time)(integrity_hash));
+FC_REFLECT(evt::producer_plugin::state_digest_information, (head_block_num)(head_block_id)(head_block_time)(state_digest));
 FC_REFLECT(evt::producer_plugin::snapshot_information, (head_block_num)(head_block_id)(head_block_time)(snapshot_name)(snapshot_size)(postgres));
-FC_REFLECT(evt::producer_plugin::create_snapshot_options, (postgres));
+FC_REFLECT(evt::producer_plugin::production_stats, (block_num)(timestamp)(persisted_us)(unapplied_us)(blacklist_us)(pending_incoming_us)
+           (execution_us)(finalize_us)(sign_us)(commit_us)(applied)(failed)(exhausted)(exhausted_reason));
+FC_REFLECT(evt::producer_plugin::create_snapshot_options, (postgres)(checkpoint)(compress)(delta_base));
+FC_REFLECT(evt::producer_plugin::trace_options, (sample_rate)(buffer_size));
+FC_REFLECT(evt::producer_plugin::profile_options, (frequency)(buffer_size));
+FC_REFLECT(evt::producer_plugin::get_profile_options, (groups));
@@ -5,9 +5,16 @@
 #include <evt/producer_plugin/producer_plugin.hpp>
 
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
 #include <iostream>
+#include <map>
+#include <set>
+#include <unordered_map>
 
 #include <boost/asio.hpp>
+#include <boost/asio/thread_pool.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/function_output_iterator.hpp>
 #include <boost/multi_index/hashed_index.hpp>
@@ -24,6 +31,9 @@
 #include <evt/chain/global_property_object.hpp>
 #include <evt/chain/plugin_interface.hpp>
 #include <evt/chain/snapshot.hpp>
+#include <evt/utilities/sampler.hpp>
+#include <evt/utilities/thread_affinity.hpp>
+#include <evt/utilities/trace.hpp>
 
 #ifdef POSTGRES_SUPPORT
 #include <evt/postgres_plugin/postgres_plugin.hpp>
@@ -70,25 +80,201 @@ failure_is_subjective(const fc::exception& e, bool deadline_is_subjective) {
 }
 }  // namespace
 
-struct transaction_id_with_expiry {
-    transaction_id_type trx_id;
-    fc::time_point      expiry;
+// ids of transactions with expiration, they're bucketed by expiration second
+// so expired ones are dropped a whole bucket at a time
+class transaction_id_expiry_set {
+public:
+    bool   empty() const { return ids_.empty(); }
+    size_t size() const { return ids_.size(); }
+
+    bool contains(const transaction_id_type& id) const { return ids_.find(id) != ids_.end(); }
+
+    // returns false if `id` is already in the set
+    bool
+    insert(const transaction_id_type& id, const fc::time_point_sec& expiry) {
+        if(!ids_.emplace(id, expiry.sec_since_epoch()).second) {
+            return false;
+        }
+        wheel_[expiry.sec_since_epoch()].emplace_back(id);
+        return true;
+    }
+
+    // drops all the ids expired at `now`, `f` is called with each of them
+    // returns the number of dropped ids
+    template<typename F>
+    size_t
+    expire(const fc::time_point& now, F&& f) {
+        auto n   = 0u;
+        auto sec = fc::time_point_sec(now).sec_since_epoch();  // truncated, expiration is in whole seconds
+        while(!wheel_.empty() && wheel_.begin()->first <= sec) {
+            for(auto& id : wheel_.begin()->second) {
+                f(id);
+                ids_.erase(id);
+                n++;
+            }
+            wheel_.erase(wheel_.begin());
+        }
+        return n;
+    }
+
+private:
+    std::unordered_map<transaction_id_type, uint32_t, std::hash<transaction_id_type>> ids_;    // id to expiration second
+    std::map<uint32_t, std::vector<transaction_id_type>>                            wheel_;  // expiration second to ids
 };
 
 struct by_id;
 struct by_expiry;
 
-using transaction_id_with_expiry_index = multi_index_container<
-    transaction_id_with_expiry,
+// transactions which failed recently, identified by signed id so that the ones signed again are not affected
+struct failed_transaction {
+    transaction_id_type signed_id;
+    fc::time_point      expiry;
+    fc::exception_ptr   except;
+};
+
+using failed_transaction_index = multi_index_container<
+    failed_transaction,
     indexed_by<
-        hashed_unique<tag<by_id>, BOOST_MULTI_INDEX_MEMBER(transaction_id_with_expiry, transaction_id_type, trx_id)>,
-        ordered_non_unique<tag<by_expiry>, BOOST_MULTI_INDEX_MEMBER(transaction_id_with_expiry, fc::time_point, expiry)>>>;
+        hashed_unique<tag<by_id>, BOOST_MULTI_INDEX_MEMBER(failed_transaction, transaction_id_type, signed_id)>,
+        ordered_non_unique<tag<by_expiry>, BOOST_MULTI_INDEX_MEMBER(failed_transaction, fc::time_point, expiry)>>>;
 
 enum class pending_block_mode {
     producing,
     speculating
 };
 
+/**
+ *  Transactions waiting for a pending block or retried after failing subjectively.
+ *  Each payer has its own fifo so transactions of one payer are still applied in order,
+ *  and the payer whose front transaction pays most charge per byte is served first.
+ *  Size is bounded by bytes, the payer using most of them loses its newest transactions,
+ *  speculative ones are evicted before the persistent ones pushed through api.
+ */
+class incoming_transaction_queue {
+public:
+    using entry = std::tuple<transaction_metadata_ptr, bool, next_function<transaction_trace_ptr>>;
+
+public:
+    void set_max_bytes(size_t max_bytes) { max_bytes_ = max_bytes; }
+
+    bool   empty() const { return count_ == 0; }
+    size_t size() const { return count_; }
+    size_t bytes() const { return bytes_; }
+
+    // returns the entries evicted to keep queue within the bound
+    std::vector<entry>
+    push(entry&& e) {
+        auto& trx   = std::get<0>(e);
+        auto  key   = payer_key(trx->packed_trx->get_signed_transaction().payer);
+        auto  bytes = trx->packed_trx->get_packed_transaction().size();
+        auto  prio  = (double)trx->packed_trx->get_signed_transaction().max_charge / std::max(bytes, (size_t)1);
+
+        auto& pq = payers_[key];
+        unlink(key, pq);
+        pq.trxs.emplace_back(queued{std::move(e), bytes, prio, seq_++});
+        pq.bytes += bytes;
+        bytes_ += bytes;
+        count_++;
+        link(key, pq);
+
+        auto evicted = std::vector<entry>();
+        while(max_bytes_ > 0 && bytes_ > max_bytes_ && count_ > 1) {
+            evicted.emplace_back(evict());
+        }
+        return evicted;
+    }
+
+    entry
+    pop() {
+        assert(!empty());
+        auto key = std::get<2>(*fronts_.begin());
+        auto it  = payers_.find(key);
+        unlink(key, it->second);
+
+        auto q = std::move(it->second.trxs.front());
+        it->second.trxs.pop_front();
+        it->second.bytes -= q.bytes;
+        bytes_ -= q.bytes;
+        count_--;
+
+        link(key, it->second);
+        return std::move(q.e);
+    }
+
+private:
+    struct queued {
+        entry    e;
+        size_t   bytes;
+        double   priority;  // max charge per byte
+        uint64_t seq;
+    };
+
+    struct payer_queue {
+        std::deque<queued> trxs;
+        size_t             bytes = 0;
+    };
+
+    static std::string
+    payer_key(const address& payer) {
+        auto key = std::string(payer.get_bytes_size(), '\0');
+        payer.to_bytes(key.data(), key.size());
+        return key;
+    }
+
+    void
+    unlink(const std::string& key, const payer_queue& pq) {
+        if(pq.trxs.empty()) {
+            return;
+        }
+        auto& f = pq.trxs.front();
+        fronts_.erase(std::make_tuple(-f.priority, f.seq, key));
+        by_bytes_.erase(std::make_pair(pq.bytes, key));
+    }
+
+    void
+    link(const std::string& key, const payer_queue& pq) {
+        if(pq.trxs.empty()) {
+            payers_.erase(key);
+            return;
+        }
+        auto& f = pq.trxs.front();
+        fronts_.emplace(-f.priority, f.seq, key);
+        by_bytes_.emplace(pq.bytes, key);
+    }
+
+    entry
+    evict() {
+        auto key = by_bytes_.rbegin()->second;
+        auto it  = payers_.find(key);
+        auto& pq = it->second;
+        unlink(key, pq);
+
+        auto rit = std::find_if(pq.trxs.rbegin(), pq.trxs.rend(), [](auto& q) { return !std::get<1>(q.e); });
+        if(rit == pq.trxs.rend()) {
+            rit = pq.trxs.rbegin();
+        }
+        auto qit = std::prev(rit.base());
+        auto q   = std::move(*qit);
+        pq.trxs.erase(qit);
+        pq.bytes -= q.bytes;
+        bytes_ -= q.bytes;
+        count_--;
+
+        link(key, pq);
+        return std::move(q.e);
+    }
+
+private:
+    std::unordered_map<std::string, payer_queue>         payers_;
+    std::set<std::tuple<double, uint64_t, std::string>> fronts_;    // negative priority and sequence of front of each payer
+    std::set<std::pair<size_t, std::string>>            by_bytes_;  // bytes used by each payer
+
+    size_t   max_bytes_ = 0;  // 0 means unlimited
+    size_t   bytes_     = 0;
+    size_t   count_     = 0;
+    uint64_t seq_       = 0;
+};
+
 #define CATCH_AND_CALL(NEXT)                                               \
     catch(const fc::exception& err) {                                      \
         NEXT(err.dynamic_copy_exception());                                \
@@ -119,6 +305,8 @@ public:
     void                     schedule_production_loop();
     void                     produce_block();
     bool                     maybe_produce_block();
+    void                     commit_produced_block();
+    void                     on_block_signed(uint32_t cid, const optional<signature_type>& sig, const fc::exception_ptr& except);
 
     boost::program_options::variables_map _options;
     bool                                  _production_enabled    = false;
@@ -131,14 +319,29 @@ public:
     boost::asio::deadline_timer                               _timer;
     std::map<chain::account_name, uint32_t>                   _producer_watermarks;
     pending_block_mode                                        _pending_block_mode;
-    transaction_id_with_expiry_index                          _persistent_transactions;
+    transaction_id_expiry_set                                 _persistent_transactions;
 
     int32_t          _max_transaction_time_ms;
     fc::microseconds _max_irreversible_block_age_us;
     int32_t          _produce_time_offset_us = 0;
     int32_t          _last_block_time_offset_us = 0;
+
+    // when adaptive, blocks are cut earlier than configured offsets if peers are far away
+    // estimate is smoothed like tcp does for rtt: mean plus four times of the mean deviation
+    bool             _adaptive_time_offsets    = false;
+    bool             _has_propagation_delay    = false;
+    double           _propagation_delay_us     = 0;
+    double           _propagation_delay_var_us = 0;
     fc::time_point   _irreversible_block_time;
     fc::microseconds _evtwd_provider_timeout_us;
+    std::vector<fc::url> _evtwd_urls;  // connected on startup, so signing a block doesn't wait for handshakes
+
+    // signatures of produced blocks are made off main thread, one at a time
+    // main thread keeps receiving transactions and blocks meanwhile
+    optional<boost::asio::thread_pool> _signing_thread;
+    block_state_ptr                    _signing_block;  // finalized pending block waiting for its signature
+    fc::time_point                     _signing_start;
+    uint32_t                           _signing_corelation_id = 0;
 
     time_point _last_signed_block_time;
     time_point _start_time            = fc::time_point::now();
@@ -154,8 +357,67 @@ public:
 
     incoming::methods::block_sync::method_type::handle        _incoming_block_sync_provider;
     incoming::methods::transaction_async::method_type::handle _incoming_transaction_async_provider;
+    incoming::methods::transactions_async::method_type::handle _incoming_transactions_async_provider;
+
+    transaction_id_expiry_set _blacklisted_transactions;
 
-    transaction_id_with_expiry_index _blacklisted_transactions;
+    using production_stats = producer_plugin::production_stats;
+
+    production_stats             _current_stats;  // of the pending block
+    std::deque<production_stats> _production_stats;  // latest ones of produced blocks
+    static constexpr size_t      max_production_stats = 64;
+    uint32_t                     _production_stats_log_blocks = 0;
+    uint32_t                     _produced_blocks             = 0;
+
+    static uint32_t
+    elapsed_us(const fc::time_point& start) {
+        return (uint32_t)(fc::time_point::now() - start).count();
+    }
+
+    // resubmitted transactions which just failed are rejected with the same error
+    // before paying for key recovery and execution again
+    failed_transaction_index _failed_transactions;
+    fc::microseconds         _failed_transaction_ttl;
+
+    void
+    remember_failed_transaction(const transaction_metadata_ptr& trx, const fc::exception_ptr& except) {
+        if(_failed_transaction_ttl.count() <= 0) {
+            return;
+        }
+        // state may change any time, so it's kept only for a short while
+        auto expiry = std::min(fc::time_point::now() + _failed_transaction_ttl, fc::time_point(trx->packed_trx->expiration()));
+        auto it     = _failed_transactions.find(trx->signed_id());
+        if(it != _failed_transactions.end()) {
+            _failed_transactions.modify(it, [&](auto& ft) { ft.expiry = expiry; ft.except = except; });
+        }
+        else {
+            _failed_transactions.insert(failed_transaction{trx->signed_id(), expiry, except});
+        }
+    }
+
+    bool
+    reject_recently_failed(const transaction_metadata_ptr& trx, const next_function<transaction_trace_ptr>& next) {
+        if(_failed_transactions.empty()) {
+            return false;
+        }
+        auto it = _failed_transactions.find(trx->signed_id());
+        if(it == _failed_transactions.end() || it->expiry <= fc::time_point::now()) {
+            return false;
+        }
+        fc_dlog(_trx_trace_log, "[TRX_TRACE] REJECTING recently failed tx: ${txid}", ("txid", trx->id));
+        next(it->except);
+        _transaction_ack_channel.publish(priority::low, std::pair<fc::exception_ptr, transaction_metadata_ptr>(it->except, trx));
+        return true;
+    }
+
+    void
+    purge_failed_transactions() {
+        auto& by_exp = _failed_transactions.get<by_expiry>();
+        auto  now    = fc::time_point::now();
+        while(!by_exp.empty() && by_exp.begin()->expiry <= now) {
+            by_exp.erase(by_exp.begin());
+        }
+    }
 
     optional<scoped_connection> _accepted_block_connection;
     optional<scoped_connection> _irreversible_block_connection;
@@ -353,23 +615,85 @@ public:
         }
     }
     
-    std::deque<std::tuple<transaction_metadata_ptr, bool, next_function<transaction_trace_ptr>>> _pending_incoming_transactions;
+    incoming_transaction_queue _pending_incoming_transactions;
+
+    void
+    queue_incoming_transaction(const transaction_metadata_ptr& trx, bool persist_until_expired, next_function<transaction_trace_ptr> next) {
+        auto evicted = _pending_incoming_transactions.push(std::make_tuple(trx, persist_until_expired, next));
+        for(auto& e : evicted) {
+            auto& etrx = std::get<0>(e);
+            auto  ex   = std::static_pointer_cast<fc::exception>(std::make_shared<tx_queue_full>(
+                FC_LOG_MESSAGE(error, "incoming transaction queue is full, dropped transaction ${id}", ("id", etrx->id))));
+            std::get<2>(e)(ex);
+            _transaction_ack_channel.publish(priority::low, std::pair<fc::exception_ptr, transaction_metadata_ptr>(ex, etrx));
+        }
+    }
 
     void
     on_incoming_transaction_async(const transaction_metadata_ptr& trx, bool persist_until_expired, next_function<transaction_trace_ptr> next) {
         chain::controller& chain = chain_plug->chain();
         const auto&        cfg   = chain.get_global_properties().configuration;
 
-        app().get_io_service().post([self = this, trx, persist_until_expired, next]() {
-            self->process_incoming_transaction_async(trx, persist_until_expired, next);
+        if(reject_recently_failed(trx, next)) {
+            return;
+        }
+
+        // tokens are read from disk in background while transaction is waiting in the queue
+        chain.prefetch_transaction(trx);
+
+        // transaction is queued only after its keys are recovered, so main thread don't need to do that
+        chain.recover_keys_async(trx, [self = this, trx, persist_until_expired, next]() {
+            app().get_io_service().post([self, trx, persist_until_expired, next]() {
+                self->process_incoming_transaction_async(trx, persist_until_expired, next);
+            });
         });
     }
 
+    // keys of all the trxs are recovered in parallel, then they're queued at once and applied in order
+    void
+    on_incoming_transactions_async(const std::vector<transaction_metadata_ptr>& trxs, bool persist_until_expired, const std::vector<next_function<transaction_trace_ptr>>& nexts) {
+        chain::controller& chain = chain_plug->chain();
+        FC_ASSERT(trxs.size() == nexts.size());
+
+        struct batch {
+            std::vector<transaction_metadata_ptr>             trxs;
+            std::vector<next_function<transaction_trace_ptr>> nexts;
+            std::atomic<size_t>                               remaining;
+        };
+        auto b = std::make_shared<batch>();
+        for(auto i = 0u; i < trxs.size(); i++) {
+            if(!reject_recently_failed(trxs[i], nexts[i])) {
+                b->trxs.emplace_back(trxs[i]);
+                b->nexts.emplace_back(nexts[i]);
+            }
+        }
+        if(b->trxs.empty()) {
+            return;
+        }
+        b->remaining = b->trxs.size();
+
+        for(auto& trx : b->trxs) {
+            chain.prefetch_transaction(trx);
+        }
+        for(auto& trx : b->trxs) {
+            chain.recover_keys_async(trx, [self = this, b, persist_until_expired]() {
+                if(--b->remaining > 0) {
+                    return;
+                }
+                app().get_io_service().post([self, b, persist_until_expired]() {
+                    for(auto i = 0u; i < b->trxs.size(); i++) {
+                        self->process_incoming_transaction_async(b->trxs[i], persist_until_expired, b->nexts[i]);
+                    }
+                });
+            });
+        }
+    }
+
     void
     process_incoming_transaction_async(const transaction_metadata_ptr& trx, bool persist_until_expired, next_function<transaction_trace_ptr> next) {
         chain::controller& chain = chain_plug->chain();
-        if(!chain.pending_block_state()) {
-            _pending_incoming_transactions.emplace_back(trx, persist_until_expired, next);
+        if(!chain.pending_block_state() || _signing_block) {
+            queue_incoming_transaction(trx, persist_until_expired, next);
             return;
         }
 
@@ -422,10 +746,13 @@ public:
         }
 
         try {
-            auto trace = chain.push_transaction(trx, deadline);
+            auto exec_start = fc::time_point::now();
+            auto trace      = chain.push_transaction(trx, deadline);
+            _current_stats.execution_us += elapsed_us(exec_start);
             if(trace->except) {
                 if(failure_is_subjective(*trace->except, deadline_is_subjective)) {
-                    _pending_incoming_transactions.emplace_back(trx, persist_until_expired, next);
+                    _current_stats.exhausted++;
+                    queue_incoming_transaction(trx, persist_until_expired, next);
                     if(_pending_block_mode == pending_block_mode::producing) {
                         fc_dlog(_trx_trace_log, "[TRX_TRACE] Block ${block_num} for producer ${prod} COULD NOT FIT, tx: ${txid} RETRYING ",
                                 ("block_num", chain.head_block_num() + 1)("prod", chain.pending_block_state()->header.producer)("txid", trx->id));
@@ -437,6 +764,8 @@ public:
                 }
                 else {
                     auto e_ptr = trace->except->dynamic_copy_exception();
+                    _current_stats.failed++;
+                    remember_failed_transaction(trx, e_ptr);
                     send_response(e_ptr);
                 }
             }
@@ -444,8 +773,9 @@ public:
                 if(persist_until_expired) {
                     // if this trx didnt fail/soft-fail and the persist flag is set, store its ID so that we can
                     // ensure its applied to all future speculative blocks as well.
-                    _persistent_transactions.insert(transaction_id_with_expiry{trx->id, trx->packed_trx->expiration()});
+                    _persistent_transactions.insert(trx->id, trx->packed_trx->expiration());
                 }
+                _current_stats.applied++;
                 send_response(trace);
             }
         }
@@ -485,6 +815,7 @@ public:
 
     fc::time_point calculate_pending_block_time() const;
     fc::time_point calculate_block_deadline(const fc::time_point&) const;
+    int32_t        calculate_time_offset(bool last_block) const;
     void schedule_delayed_production_loop(const std::weak_ptr<producer_plugin_impl>& weak_this, const block_timestamp_type& current_block_time);    
 };
 
@@ -528,6 +859,14 @@ producer_plugin::set_program_options(
             [this](bool p) { my->_pause_production = p; }), "Start this node in a state where production is paused")
         ("max-transaction-time", bpo::value<int32_t>()->default_value(30),
             "Limits the maximum time (in milliseconds) that is allowed a pushed transaction's code to execute before being considered invalid")
+        ("async-block-signing", bpo::value<bool>()->default_value(true),
+            "Sign produced blocks in a background thread so that incoming transactions and blocks are not stalled by signature providers")
+        ("failed-transaction-cache-ms", bpo::value<int32_t>()->default_value(1000),
+            "Time (in milliseconds) that resubmitted transactions are rejected with the same error after they failed, 0 to disable")
+        ("production-stats-log-blocks", bpo::value<uint32_t>()->default_value(12),
+            "Log the production timing breakdown once every this many produced blocks, 0 to disable")
+        ("adaptive-time-offsets", bpo::value<bool>()->default_value(false),
+            "Cut and ship blocks earlier than produce-time-offset-us and last-block-time-offset-us when the measured delay to peers requires it")
         ("max-irreversible-block-age", bpo::value<int32_t>()->default_value(-1),
             "Limits the maximum age (in seconds) of the DPOS Irreversible Block for a chain this node will produce blocks on (use negative value to indicate unlimited)")
         ("producer-name,p", boost::program_options::value<vector<string>>()->composing()->multitoken(),
@@ -548,6 +887,8 @@ producer_plugin::set_program_options(
             "offset of non last block producing time in microseconds. Negative number results in blocks to go out sooner, and positive number results in blocks to go out later")
          ("last-block-time-offset-us", boost::program_options::value<int32_t>()->default_value(0),
             "offset of last block producing time in microseconds. Negative number results in blocks to go out sooner, and positive number results in blocks to go out later")
+         ("incoming-transaction-queue-size-mb", bpo::value<uint32_t>()->default_value(1024),
+            "Maximum size (in MiB) of the queue of incoming transactions waiting to be applied, 0 for unlimited")
          ("snapshots-dir", bpo::value<bfs::path>()->default_value("snapshots"),
             "the location of the snapshots directory (absolute path or relative to application data dir)")
          ;
@@ -661,6 +1002,7 @@ producer_plugin::plugin_initialize(const boost::program_options::variables_map&
                     }
                     else if(spec_type_str == "EVTWD") {
                         my->_signature_providers[pubkey] = make_evtwd_signature_provider(my, spec_data, pubkey);
+                        my->_evtwd_urls.emplace_back(spec_data);
                     }
                 }
                 catch(...) {
@@ -670,15 +1012,25 @@ producer_plugin::plugin_initialize(const boost::program_options::variables_map&
         }
 
         my->_evtwd_provider_timeout_us = fc::milliseconds(options.at("evtwd-provider-timeout").as<int32_t>());
+        my->_failed_transaction_ttl = fc::milliseconds(options.at("failed-transaction-cache-ms").as<int32_t>());
+        my->_production_stats_log_blocks = options.at("production-stats-log-blocks").as<uint32_t>();
+        if(options.at("async-block-signing").as<bool>()) {
+            auto scope = utilities::affinity::pool_scope("signing");
+            my->_signing_thread.emplace(1);
+        }
 
         my->_produce_time_offset_us = options.at("produce-time-offset-us").as<int32_t>();
 
         my->_last_block_time_offset_us = options.at("last-block-time-offset-us").as<int32_t>();
 
+        my->_adaptive_time_offsets = options.at("adaptive-time-offsets").as<bool>();
+
         my->_max_transaction_time_ms = options.at("max-transaction-time").as<int32_t>();
 
         my->_max_irreversible_block_age_us = fc::seconds(options.at("max-irreversible-block-age").as<int32_t>());
 
+        my->_pending_incoming_transactions.set_max_bytes((size_t)options.at("incoming-transaction-queue-size-mb").as<uint32_t>() * 1024 * 1024);
+
         if(options.count("snapshots-dir")) {
             auto sd = options.at("snapshots-dir").as<bfs::path>();
             if(sd.is_relative()) {
@@ -714,6 +1066,11 @@ producer_plugin::plugin_initialize(const boost::program_options::variables_map&
             [this](const transaction_metadata_ptr& trx, bool persist_until_expired, next_function<transaction_trace_ptr> next) -> void {
                 return my->on_incoming_transaction_async(trx, persist_until_expired, next);
             });
+
+        my->_incoming_transactions_async_provider = app().get_method<incoming::methods::transactions_async>().register_provider(
+            [this](const std::vector<transaction_metadata_ptr>& trxs, bool persist_until_expired, const std::vector<next_function<transaction_trace_ptr>>& nexts) -> void {
+                return my->on_incoming_transactions_async(trxs, persist_until_expired, nexts);
+            });
     }
     FC_LOG_AND_RETHROW()
 }
@@ -736,6 +1093,15 @@ producer_plugin::plugin_startup() {
         my->_accepted_block_connection.emplace(chain.accepted_block.connect([this](const auto& bsp) { my->on_block(bsp); }));
         my->_irreversible_block_connection.emplace(chain.irreversible_block.connect([this](const auto& bsp) { my->on_irreversible_block(bsp->block); }));
 
+        for(auto& url : my->_evtwd_urls) {
+            try {
+                app().get_plugin<http_client_plugin>().get_client().connect(url, fc::time_point::now() + fc::seconds(5));
+            }
+            catch(const fc::exception& e) {
+                wlog("Cannot connect to signature provider ${u} ahead: ${e}", ("u",(std::string)url)("e",e.to_string()));
+            }
+        }
+
         const auto lib_num = chain.last_irreversible_block_num();
         const auto lib     = chain.fetch_block_by_number(lib_num);
         if(lib) {
@@ -756,6 +1122,14 @@ producer_plugin::plugin_startup() {
             }
         }
 
+        my->chain_plug->register_memory_usage("producer", [this] {
+            return fc::mutable_variant_object("pending_incoming", my->_pending_incoming_transactions.size())
+                ("pending_incoming_bytes", my->_pending_incoming_transactions.bytes())
+                ("persistent", my->_persistent_transactions.size())
+                ("blacklisted", my->_blacklisted_transactions.size())
+                ("failed", my->_failed_transactions.size());
+        });
+
         my->schedule_production_loop();
 
         ilog("producer plugin:  plugin_startup() end");
@@ -772,6 +1146,10 @@ producer_plugin::plugin_shutdown() {
         edump((e.to_detail_string()));
     }
 
+    if(my->_signing_thread.has_value()) {
+        my->_signing_thread->join();
+    }
+
     my->_accepted_block_connection.reset();
     my->_irreversible_block_connection.reset();
 }
@@ -848,6 +1226,54 @@ producer_plugin::get_runtime_options() const {
     };
 }
 
+void
+producer_plugin::report_propagation_delay(const fc::microseconds& delay) {
+    auto d = (double)delay.count();
+    if(!my->_has_propagation_delay) {
+        my->_propagation_delay_us     = d;
+        my->_propagation_delay_var_us = d / 2;
+        my->_has_propagation_delay    = true;
+        return;
+    }
+    my->_propagation_delay_var_us += (std::abs(d - my->_propagation_delay_us) - my->_propagation_delay_var_us) / 4;
+    my->_propagation_delay_us     += (d - my->_propagation_delay_us) / 8;
+}
+
+std::vector<producer_plugin::production_stats>
+producer_plugin::get_production_stats() const {
+    return std::vector<production_stats>(my->_production_stats.begin(), my->_production_stats.end());
+}
+
+void
+producer_plugin::start_trace(const trace_options& options) {
+    evt::utilities::trace::start(options.sample_rate, options.buffer_size);
+}
+
+void
+producer_plugin::stop_trace() {
+    evt::utilities::trace::stop();
+}
+
+fc::variant
+producer_plugin::get_trace() const {
+    return evt::utilities::trace::get_chrome_trace();
+}
+
+void
+producer_plugin::start_profile(const profile_options& options) {
+    evt::utilities::sampler::start(options.frequency, options.buffer_size);
+}
+
+void
+producer_plugin::stop_profile() {
+    evt::utilities::sampler::stop();
+}
+
+evt::utilities::sampler::profile
+producer_plugin::get_profile(const get_profile_options& options) const {
+    return evt::utilities::sampler::get_profile(options.groups);
+}
+
 producer_plugin::integrity_hash_information
 producer_plugin::get_integrity_hash() const {
     chain::controller& chain = my->chain_plug->chain();
@@ -867,6 +1293,25 @@ producer_plugin::get_integrity_hash() const {
     return {chain.head_block_num(), chain.head_block_id(), chain.head_block_time(), chain.calculate_integrity_hash()};
 }
 
+producer_plugin::state_digest_information
+producer_plugin::get_state_digest() const {
+    chain::controller& chain = my->chain_plug->chain();
+
+    auto reschedule = fc::make_scoped_exit([this]() {
+        my->schedule_production_loop();
+    });
+
+    if(chain.pending_block_state()) {
+        // digest is of the state at head block, pending block is aborted like integrity hash
+        chain.abort_block();
+    }
+    else {
+        reschedule.cancel();
+    }
+
+    return {chain.head_block_num(), chain.head_block_id(), chain.head_block_time(), chain.calculate_state_digest()};
+}
+
 producer_plugin::snapshot_information
 producer_plugin::create_snapshot(const create_snapshot_options& options) const {
     chain::controller& chain = my->chain_plug->chain();
@@ -890,11 +1335,36 @@ producer_plugin::create_snapshot(const create_snapshot_options& options) const {
                "snapshot named ${name} already exists", ("name", snapshot_path));
 
     auto snap_out = std::ofstream(snapshot_path, (std::ios::out | std::ios::binary));
-    auto writer   = std::make_shared<ostream_snapshot_writer>(snap_out);
+    auto writer   = snapshot_writer_ptr();
+    auto finalize = std::function<void()>();
+    if(options.compress) {
+        auto w   = std::make_shared<zstd_snapshot_writer>(snap_out);
+        writer   = w;
+        finalize = [w] { w->finalize(); };
+    }
+    else {
+        auto w   = std::make_shared<ostream_snapshot_writer>(snap_out);
+        writer   = w;
+        finalize = [w] { w->finalize(); };
+    }
 
     bool postgres = false;
 
-    chain.write_snapshot(writer);
+    if(!options.delta_base.empty()) {
+        auto base_path = fc::path(my->_snapshots_dir / fc::format_string("snapshot-${id}.bin", fc::mutable_variant_object()("id", options.delta_base)));
+        EVT_ASSERT(fc::is_regular_file(base_path), snapshot_exception,
+                   "base snapshot named ${name} is not found", ("name", base_path.generic_string()));
+        EVT_ASSERT(!options.checkpoint, snapshot_exception, "delta snapshot cannot write token database as checkpoint");
+        chain.write_snapshot(writer, std::nullopt, base_path);
+    }
+    else if(options.checkpoint) {
+        // checkpoint directory is placed beside the snapshot file with the same name
+        auto checkpoint_path = my->_snapshots_dir / fc::format_string("snapshot-${id}.tokendb", fc::mutable_variant_object()("id", head_id));
+        chain.write_snapshot(writer, fc::path(checkpoint_path));
+    }
+    else {
+        chain.write_snapshot(writer);
+    }
     if(options.postgres) {
 #ifdef POSTGRES_SUPPORT
         if(app().find_plugin("evt::postgres_plugin") == nullptr) {
@@ -915,7 +1385,7 @@ producer_plugin::create_snapshot(const create_snapshot_options& options) const {
 #endif
     }
 
-    writer->finalize();
+    finalize();
 
     auto sz = (size_t)snap_out.tellp(); 
     snap_out.flush();
@@ -1003,7 +1473,24 @@ producer_plugin_impl::calculate_pending_block_time() const {
 fc::time_point
 producer_plugin_impl::calculate_block_deadline(const fc::time_point& block_time) const {
     bool last_block = ((block_timestamp_type(block_time).slot % config::producer_repetitions) == config::producer_repetitions - 1);
-    return block_time + fc::microseconds(last_block ? _last_block_time_offset_us : _produce_time_offset_us);
+    return block_time + fc::microseconds(calculate_time_offset(last_block));
+}
+
+int32_t
+producer_plugin_impl::calculate_time_offset(bool last_block) const {
+    auto configured = last_block ? _last_block_time_offset_us : _produce_time_offset_us;
+    if(!_adaptive_time_offsets || !_has_propagation_delay) {
+        return configured;
+    }
+
+    // last block of the round should also reach next producer before it starts its own
+    auto estimate = (int64_t)(_propagation_delay_us + 4 * _propagation_delay_var_us);
+    if(last_block) {
+        estimate *= 2;
+    }
+    // always leave some of the window for applying transactions
+    estimate = std::min<int64_t>(estimate, config::block_interval_us * 8 / 10);
+    return std::min<int32_t>(configured, -(int32_t)estimate);
 }
 
 enum class tx_category {
@@ -1108,22 +1595,23 @@ producer_plugin_impl::start_block() {
             _pending_block_mode = pending_block_mode::speculating;
         }
 
+        _current_stats           = production_stats();
+        _current_stats.block_num = pbs->block_num;
+        _current_stats.timestamp = pbs->header.timestamp;
+
+        auto set_exhausted = [&](const char* reason) {
+            _current_stats.exhausted_reason = reason;
+            return start_block_result::exhausted;
+        };
+
         // attempt to play persisted transactions first
         bool exhausted = false;
+        auto stage_start = fc::time_point::now();
 
         // remove all persisted transactions that have now expired
-        auto& persisted_by_id     = _persistent_transactions.get<by_id>();
-        auto& persisted_by_expiry = _persistent_transactions.get<by_expiry>();
-        if(!persisted_by_expiry.empty()) {
-            int num_expired_persistent = 0;
-            int orig_count             = _persistent_transactions.size();
-
-            while(!persisted_by_expiry.empty() && persisted_by_expiry.begin()->expiry <= pbs->header.timestamp.to_time_point()) {
-                if(preprocess_deadline <= fc::time_point::now()) {
-                    exhausted = true;
-                    break;
-                }
-                auto const& txid = persisted_by_expiry.begin()->trx_id;
+        if(!_persistent_transactions.empty()) {
+            auto orig_count = _persistent_transactions.size();
+            auto num_expired_persistent = _persistent_transactions.expire(pbs->header.timestamp.to_time_point(), [&](auto& txid) {
                 if(_pending_block_mode == pending_block_mode::producing) {
                     fc_dlog(_trx_trace_log, "[TRX_TRACE] Block ${block_num} for producer ${prod} is EXPIRING PERSISTED tx: ${txid}",
                             ("block_num", chain.head_block_num() + 1)("prod", chain.pending_block_state()->header.producer)("txid", txid));
@@ -1132,30 +1620,20 @@ producer_plugin_impl::start_block() {
                     fc_dlog(_trx_trace_log, "[TRX_TRACE] Speculative execution is EXPIRING PERSISTED tx: ${txid}",
                             ("txid", txid));
                 }
-
-                persisted_by_expiry.erase(persisted_by_expiry.begin());
-                num_expired_persistent++;
-
-                if(exhausted) {
-                    fc_wlog(_log, "Unable to process all ${n} persisted transactions before deadline, Expired ${expired}",
-                            ("n", orig_count)("expired", num_expired_persistent));
-                }
-                else {
-                    fc_dlog(_log, "Processed ${n} persisted transactions, Expired ${expired}",
-                            ("n", orig_count)("expired", num_expired_persistent));
-                }
-            }
+            });
 
             fc_dlog(_log, "Processed ${n} persisted transactions, Expired ${expired}",
                     ("n", orig_count)("expired", num_expired_persistent));
         }
+        _current_stats.persisted_us = elapsed_us(stage_start);
 
         try {
             size_t orig_pending_txn_size = _pending_incoming_transactions.size();
+            stage_start = fc::time_point::now();
 
             // Processing unapplied transactions...
             //
-            if(_producers.empty() && persisted_by_id.empty()) {
+            if(_producers.empty() && _persistent_transactions.empty()) {
                 // if this node can never produce and has no persisted transactions,
                 // there is no need for unapplied transactions they can be dropped
                 chain.get_unapplied_transactions().clear();
@@ -1172,7 +1650,7 @@ producer_plugin_impl::start_block() {
                         if(trx->packed_trx->expiration() < pbs->header.timestamp.to_time_point()) {
                             return tx_category::EXPIRED;
                         }
-                        else if(persisted_by_id.find(trx->id) != persisted_by_id.end()) {
+                        else if(_persistent_transactions.contains(trx->id)) {
                             return tx_category::PERSISTED;
                         }
                         else {
@@ -1187,6 +1665,7 @@ producer_plugin_impl::start_block() {
 
                         if(preprocess_deadline <= fc::time_point::now()) {
                             exhausted = true;
+                            _current_stats.exhausted_reason = "deadline reached while re-pushing unapplied transactions";
                         }
                         if(exhausted) {
                             break;
@@ -1212,21 +1691,34 @@ producer_plugin_impl::start_block() {
                                     deadline               = preprocess_deadline;
                                 }
 
+                                // it would be cut off by the deadline as it took longer than the time left last time,
+                                // leave it and the rest to next block instead of wasting the time in re-executing it
+                                if(deadline_is_subjective && trx->elapsed.count() > 0 && fc::time_point::now() + trx->elapsed > deadline) {
+                                    exhausted = true;
+                                    _current_stats.exhausted++;
+                                    _current_stats.exhausted_reason = "unapplied transaction took longer than the time left";
+                                    break;
+                                }
+
                                 auto trace = chain.push_transaction(trx, deadline);
                                 if(trace->except) {
                                     if(failure_is_subjective(*trace->except, deadline_is_subjective)) {
                                         exhausted = true;
+                                        _current_stats.exhausted++;
+                                        _current_stats.exhausted_reason = "unapplied transaction hit the block deadline";
                                         break;
                                     }
                                     else {
                                         // this failed our configured maximum transaction time, we don't want to replay it
                                         // chain.plus_transactions can modify unapplied_trxs, so erase by id
-                                        unapplied_trxs.erase(trx->signed_id);
+                                        unapplied_trxs.erase(trx->signed_id());
                                         ++num_failed;
+                                        _current_stats.failed++;
                                     }
                                 }
                                 else {
                                     ++num_applied;
+                                    _current_stats.applied++;
                                 }
                             }
                             catch(const guard_exception& e) {
@@ -1244,36 +1736,38 @@ producer_plugin_impl::start_block() {
                 }
             }
 
-            if(_pending_block_mode == pending_block_mode::producing) {
-                auto& blacklist_by_id     = _blacklisted_transactions.get<by_id>();
-                auto& blacklist_by_expiry = _blacklisted_transactions.get<by_expiry>();
-                auto  now                 = fc::time_point::now();
-                if(!blacklist_by_expiry.empty()) {
-                    int num_expired = 0;
-                    int orig_count  = _blacklisted_transactions.size();
-
-                    while(!blacklist_by_expiry.empty() && blacklist_by_expiry.begin()->expiry <= now) {
-                        if (preprocess_deadline <= fc::time_point::now()) break;
-                        blacklist_by_expiry.erase(blacklist_by_expiry.begin());
-                        num_expired++;
-                    }
+            _current_stats.unapplied_us = elapsed_us(stage_start);
 
-                    fc_dlog(_log, "Processed ${n} blacklisted transactions, Expired ${expired}",
-                            ("n", orig_count)("expired", num_expired));
-                }
+            stage_start = fc::time_point::now();
+            purge_failed_transactions();
+
+            if(_pending_block_mode == pending_block_mode::producing && !_blacklisted_transactions.empty()) {
+                auto orig_count  = _blacklisted_transactions.size();
+                auto num_expired = _blacklisted_transactions.expire(fc::time_point::now(), [](auto&) {});
+
+                fc_dlog(_log, "Processed ${n} blacklisted transactions, Expired ${expired}",
+                        ("n", orig_count)("expired", num_expired));
             }
 
-            if(exhausted || preprocess_deadline <= fc::time_point::now()) {
+            _current_stats.blacklist_us = elapsed_us(stage_start);
+
+            if(exhausted) {
                 return start_block_result::exhausted;
             }
+            else if(preprocess_deadline <= fc::time_point::now()) {
+                return set_exhausted("deadline reached before applying incoming transactions");
+            }
             else {
                 // attempt to apply any pending incoming transactions
+                stage_start = fc::time_point::now();
+                auto pending_done = fc::make_scoped_exit([&] {
+                    _current_stats.pending_incoming_us = elapsed_us(stage_start);
+                });
                 if(!_pending_incoming_transactions.empty()) {
                     fc_dlog(_log, "Processing ${n} pending transactions", ("n", _pending_incoming_transactions.size()));
                     while(orig_pending_txn_size && _pending_incoming_transactions.size()) {
-                        if (preprocess_deadline <= fc::time_point::now()) return start_block_result::exhausted;
-                        auto e = _pending_incoming_transactions.front();
-                        _pending_incoming_transactions.pop_front();
+                        if (preprocess_deadline <= fc::time_point::now()) return set_exhausted("deadline reached while applying queued incoming transactions");
+                        auto e = _pending_incoming_transactions.pop();
                         --orig_pending_txn_size;
                         process_incoming_transaction_async(std::get<0>(e), std::get<1>(e), std::get<2>(e));
                     }
@@ -1297,6 +1791,15 @@ producer_plugin_impl::start_block() {
 void
 producer_plugin_impl::schedule_production_loop() {
     chain::controller& chain = chain_plug->chain();
+    if(_signing_block) {
+        if(chain.pending_block_state() == _signing_block) {
+            // loop is resumed once the block is signed and committed
+            return;
+        }
+        // pending block is aborted, its signature is dropped when it's back
+        _signing_block.reset();
+    }
+
     _timer.cancel();
     std::weak_ptr<producer_plugin_impl> weak_this = shared_from_this();
 
@@ -1469,12 +1972,108 @@ producer_plugin_impl::produce_block() {
     EVT_ASSERT(signature_provider_itr != _signature_providers.end(), producer_priv_key_not_found, "Attempting to produce a block for which we don't have the private key");
 
     //idump( (fc::time_point::now() - chain.pending_block_time()) );
+    auto stage_start = fc::time_point::now();
     chain.finalize_block();
-    chain.sign_block([&](const digest_type& d) {
-        auto debug_logger = maybe_make_debug_time_logger();
-        return signature_provider_itr->second(d);
+    _current_stats.finalize_us = elapsed_us(stage_start);
+
+    stage_start = fc::time_point::now();
+    if(!_signing_thread.has_value()) {
+        chain.sign_block([&](const digest_type& d) {
+            auto debug_logger = maybe_make_debug_time_logger();
+            return signature_provider_itr->second(d);
+        });
+        _current_stats.sign_us = elapsed_us(stage_start);
+        commit_produced_block();
+        return;
+    }
+
+    // pending block is left untouched till the signature is back:
+    // incoming transactions are queued and production loop is not restarted
+    _signing_block = pbs;
+
+    auto cid    = ++_signing_corelation_id;
+    auto digest = pbs->sig_digest();
+    _signing_start = stage_start;
+    boost::asio::post(*_signing_thread, [weak_this = weak_from_this(), signer = signature_provider_itr->second, digest, cid] {
+        auto sig    = optional<signature_type>();
+        auto except = fc::exception_ptr();
+        try {
+            auto debug_logger = maybe_make_debug_time_logger();
+            sig = signer(digest);
+        }
+        catch(const fc::exception& e) {
+            except = e.dynamic_copy_exception();
+        }
+        catch(const std::exception& e) {
+            except = fc::exception(FC_LOG_MESSAGE(warn, "${what}", ("what", e.what())), fc::std_exception_code, BOOST_CORE_TYPEID(e).name(), e.what()).dynamic_copy_exception();
+        }
+        catch(...) {
+            except = fc::unhandled_exception(FC_LOG_MESSAGE(warn, "unknown exception while signing block"), std::current_exception()).dynamic_copy_exception();
+        }
+
+        app().post(priority::high, [weak_this, cid, sig, except] {
+            if(auto self = weak_this.lock()) {
+                self->on_block_signed(cid, sig, except);
+            }
+        });
     });
+}
+
+void
+producer_plugin_impl::on_block_signed(uint32_t cid, const optional<signature_type>& sig, const fc::exception_ptr& except) {
+    if(cid != _signing_corelation_id || !_signing_block) {
+        return;
+    }
+
+    chain::controller& chain = chain_plug->chain();
+
+    auto bs = std::move(_signing_block);
+    _signing_block.reset();
+    if(chain.pending_block_state() != bs) {
+        // block is aborted while signing, loop is already restarted
+        return;
+    }
+
+    auto reschedule = fc::make_scoped_exit([this] {
+        schedule_production_loop();
+    });
+
+    try {
+        try {
+            if(except) {
+                except->dynamic_rethrow_exception();
+            }
+            chain.sign_block([&](const digest_type&) { return *sig; });
+            _current_stats.sign_us = elapsed_us(_signing_start);
+            commit_produced_block();
+            return;
+        }
+        catch(const guard_exception& e) {
+            chain_plug->handle_guard_exception(e);
+            return;
+        }
+        FC_LOG_AND_DROP();
+    }
+    catch (boost::interprocess::bad_alloc&) {
+        raise(SIGUSR1);
+        return;
+    }
+    catch(fc::unrecoverable_exception&) {
+        raise(SIGUSR1);
+        return;
+    }
+
+    fc_dlog(_log, "Aborting block due to signing error");
+    chain.abort_block();
+}
+
+void
+producer_plugin_impl::commit_produced_block() {
+    chain::controller& chain = chain_plug->chain();
+
+    auto commit_start = fc::time_point::now();
     chain.commit_block();
+    _current_stats.commit_us = elapsed_us(commit_start);
     auto hbt [[maybe_unused]] = chain.head_block_time();
     //idump((fc::time_point::now() - hbt));
 
@@ -1489,6 +2088,21 @@ producer_plugin_impl::produce_block() {
          ("count", new_bs->block->transactions.size())
          ("lib", chain.last_irreversible_block_num())
          ("confs", new_bs->header.confirmed));
+
+    _production_stats.emplace_back(std::move(_current_stats));
+    while(_production_stats.size() > max_production_stats) {
+        _production_stats.pop_front();
+    }
+
+    if(_production_stats_log_blocks > 0 && ++_produced_blocks % _production_stats_log_blocks == 0) {
+        auto& ps = _production_stats.back();
+        ilog("Production of block #${n}: persisted ${persisted}us, unapplied ${unapplied}us, blacklist ${blacklist}us, pending ${pending}us, "
+             "execution ${exec}us, finalize ${finalize}us, sign ${sign}us, commit ${commit}us [applied: ${applied}, failed: ${failed}, exhausted: ${exhausted}${reason}]",
+             ("n", ps.block_num)("persisted", ps.persisted_us)("unapplied", ps.unapplied_us)("blacklist", ps.blacklist_us)
+             ("pending", ps.pending_incoming_us)("exec", ps.execution_us)("finalize", ps.finalize_us)("sign", ps.sign_us)
+             ("commit", ps.commit_us)("applied", ps.applied)("failed", ps.failed)("exhausted", ps.exhausted)
+             ("reason", ps.exhausted_reason.empty() ? std::string() : ", " + ps.exhausted_reason));
+    }
 }
 
 }  // namespace evt
@@ -0,0 +1,60 @@
+/**
+ *  @file
+ *  @copyright defined in evt/LICENSE.txt
+ */
+#pragma once
+
+#include <evt/chain_plugin/chain_plugin.hpp>
+#include <evt/chain/types.hpp>
+
+#include <appbase/application.hpp>
+
+namespace evt {
+
+using namespace appbase;
+
+namespace state_delta {
+
+using chain::block_id_type;
+
+// raw entry of token database changed by the block, `column` is the value of `token_database::raw_column`
+struct delta_entry {
+    uint8_t                    column;
+    std::string                key;
+    std::optional<std::string> value;  // removed if it's empty
+};
+
+// Each frame is the packed `block_delta` prefixed by its size in 4 bytes little-endian.
+// Deltas are of accepted blocks, so blocks may be switched out by forks, the delta of a block
+// with the same or lower number replaces the ones from that block on.
+struct block_delta {
+    uint32_t                 block_num;
+    block_id_type            block_id;
+    block_id_type            previous;
+    std::vector<delta_entry> entries;
+};
+
+}  // namespace state_delta
+
+// Streams the entries of token database changed by each block to a file or tcp clients
+class state_delta_plugin : public plugin<state_delta_plugin> {
+public:
+    APPBASE_PLUGIN_REQUIRES((chain_plugin))
+
+    state_delta_plugin();
+    virtual ~state_delta_plugin();
+
+    virtual void set_program_options(options_description&, options_description&) override;
+
+    void plugin_initialize(const variables_map&);
+    void plugin_startup();
+    void plugin_shutdown();
+
+private:
+    std::shared_ptr<class state_delta_plugin_impl> my_;
+};
+
+}  // namespace evt
+
+FC_REFLECT(evt::state_delta::delta_entry, (column)(key)(value));
+FC_REFLECT(evt::state_delta::block_delta, (block_num)(block_id)(previous)(entries));
@@ -0,0 +1,321 @@
+/**
+ *  @file
+ *  @copyright defined in evt/LICENSE.txt
+ */
+#include <evt/state_delta_plugin/state_delta_plugin.hpp>
+
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <string>
+
+#include <boost/asio.hpp>
+#include <boost/endian/conversion.hpp>
+#include <fc/io/raw.hpp>
+
+#include <evt/chain/block_state.hpp>
+#include <evt/chain/exceptions.hpp>
+#include <evt/chain/token_database.hpp>
+
+namespace evt {
+
+static appbase::abstract_plugin& _state_delta_plugin = app().register_plugin<state_delta_plugin>();
+
+using namespace evt::chain;
+using namespace evt::state_delta;
+
+using boost::asio::ip::tcp;
+
+class state_delta_plugin_impl : public std::enable_shared_from_this<state_delta_plugin_impl> {
+public:
+    using frame_ptr = std::shared_ptr<const std::string>;
+
+    struct client {
+        client(boost::asio::io_context& ctx)
+            : socket(ctx) {}
+
+        tcp::socket           socket;
+        std::deque<frame_ptr> frames;
+        size_t                buffered = 0;
+        bool                  closed   = false;
+    };
+    using client_ptr = std::shared_ptr<client>;
+
+public:
+    state_delta_plugin_impl(controller& db)
+        : db_(db) {}
+
+public:
+    void init();
+    void start();
+    void shutdown();
+
+private:
+    void applied_block(const block_state_ptr& bs);
+    frame_ptr make_frame(const block_state_ptr& bs);
+
+    void accept();
+    void send(const client_ptr& c, const frame_ptr& frame);
+    void write(const client_ptr& c);
+    void close(const client_ptr& c);
+
+public:
+    controller& db_;
+
+    fc::path                     file_path_;
+    std::ofstream                file_;
+    std::optional<tcp::endpoint> listen_endpoint_;
+    std::optional<tcp::acceptor> acceptor_;
+    size_t                       max_buffer_size_;
+
+    std::set<client_ptr> clients_;
+    bool                 warned_ = false;
+
+    std::optional<boost::signals2::scoped_connection> accepted_block_connection_;
+};
+
+state_delta_plugin_impl::frame_ptr
+state_delta_plugin_impl::make_frame(const block_state_ptr& bs) {
+    auto& token_db = db_.token_db();
+
+    auto delta      = block_delta();
+    delta.block_num = bs->block_num;
+    delta.block_id  = bs->id;
+    delta.previous  = bs->header.previous;
+
+    auto value = std::string();
+    token_db.read_savepoint_keys(bs->block_num, [&](auto column, auto& key) {
+        auto entry   = delta_entry();
+        entry.column = (uint8_t)column;
+        entry.key    = std::string(key);
+        if(token_db.read_raw(column, key, value)) {
+            entry.value = std::move(value);
+        }
+        delta.entries.emplace_back(std::move(entry));
+    });
+
+    auto sz    = (uint32_t)fc::raw::pack_size(delta);
+    auto frame = std::make_shared<std::string>(sizeof(sz) + sz, '\0');
+    auto ds    = fc::datastream<char*>(frame->data(), frame->size());
+    fc::raw::pack(ds, boost::endian::native_to_little(sz));
+    fc::raw::pack(ds, delta);
+
+    return frame;
+}
+
+void
+state_delta_plugin_impl::applied_block(const block_state_ptr& bs) {
+    if(!file_.is_open() && clients_.empty()) {
+        return;
+    }
+
+    // savepoints are not made when irreversible blocks are replayed
+    auto& token_db = db_.token_db();
+    if(token_db.savepoints_size() == 0 || token_db.latest_savepoint_seq() < bs->block_num) {
+        if(!warned_) {
+            wlog("No savepoint of block ${n} in token database, deltas are not streamed till there is", ("n",bs->block_num));
+            warned_ = true;
+        }
+        return;
+    }
+    warned_ = false;
+
+    auto frame = frame_ptr();
+    try {
+        frame = make_frame(bs);
+    }
+    FC_LOG_AND_DROP();
+    if(!frame) {
+        return;
+    }
+
+    if(file_.is_open()) {
+        file_.write(frame->data(), frame->size());
+        file_.flush();
+        if(!file_.good()) {
+            // not thrown, it would fail the block in controller
+            elog("Cannot write state deltas into file: ${f}, stop writing", ("f",file_path_));
+            file_.close();
+        }
+    }
+
+    // clients may be closed while sending
+    auto clients = std::vector<client_ptr>(clients_.cbegin(), clients_.cend());
+    for(auto& c : clients) {
+        send(c, frame);
+    }
+}
+
+void
+state_delta_plugin_impl::accept() {
+    auto c    = std::make_shared<client>(app().get_io_service());
+    auto wptr = std::weak_ptr<state_delta_plugin_impl>(shared_from_this());
+    acceptor_->async_accept(c->socket, [wptr, c](auto& ec) {
+        auto self = wptr.lock();
+        if(!self || ec == boost::asio::error::operation_aborted) {
+            return;
+        }
+        if(!ec) {
+            // clients only receive the deltas of blocks accepted after they're connected
+            self->clients_.emplace(c);
+        }
+        else {
+            wlog("Cannot accept state delta client: ${e}", ("e",ec.message()));
+        }
+        self->accept();
+    });
+}
+
+void
+state_delta_plugin_impl::send(const client_ptr& c, const frame_ptr& frame) {
+    if(c->closed) {
+        return;
+    }
+
+    // slow clients are dropped instead of buffering without limit
+    if(c->buffered + frame->size() > max_buffer_size_) {
+        wlog("State delta client is too slow, disconnect it");
+        close(c);
+        return;
+    }
+
+    c->frames.emplace_back(frame);
+    c->buffered += frame->size();
+    if(c->frames.size() == 1) {
+        write(c);
+    }
+}
+
+void
+state_delta_plugin_impl::write(const client_ptr& c) {
+    auto wptr = std::weak_ptr<state_delta_plugin_impl>(shared_from_this());
+    boost::asio::async_write(c->socket, boost::asio::buffer(*c->frames.front()), [wptr, c](auto& ec, auto) {
+        auto self = wptr.lock();
+        if(!self || c->closed) {
+            return;
+        }
+        if(ec) {
+            self->close(c);
+            return;
+        }
+
+        c->buffered -= c->frames.front()->size();
+        c->frames.pop_front();
+        if(!c->frames.empty()) {
+            self->write(c);
+        }
+    });
+}
+
+void
+state_delta_plugin_impl::close(const client_ptr& c) {
+    auto ec = boost::system::error_code();
+    c->socket.close(ec);
+    c->closed = true;
+    clients_.erase(c);
+}
+
+void
+state_delta_plugin_impl::init() {
+    auto& chain = app().get_plugin<chain_plugin>().chain();
+    accepted_block_connection_.emplace(chain.accepted_block.connect([&](const block_state_ptr& bs) {
+        applied_block(bs);
+    }));
+}
+
+void
+state_delta_plugin_impl::start() {
+    if(!file_path_.empty()) {
+        file_.open(file_path_.string(), std::ios::out | std::ios::binary | std::ios::app);
+        EVT_ASSERT(file_.is_open(), chain::plugin_config_exception, "Cannot open state delta file: ${f}", ("f",file_path_));
+    }
+
+    if(listen_endpoint_) {
+        acceptor_.emplace(app().get_io_service());
+        acceptor_->open(listen_endpoint_->protocol());
+        acceptor_->set_option(tcp::acceptor::reuse_address(true));
+        acceptor_->bind(*listen_endpoint_);
+        acceptor_->listen();
+        accept();
+    }
+}
+
+void
+state_delta_plugin_impl::shutdown() {
+    accepted_block_connection_.reset();
+
+    if(acceptor_) {
+        auto ec = boost::system::error_code();
+        acceptor_->close(ec);
+    }
+    auto clients = std::vector<client_ptr>(clients_.cbegin(), clients_.cend());
+    for(auto& c : clients) {
+        close(c);
+    }
+    if(file_.is_open()) {
+        file_.close();
+    }
+}
+
+state_delta_plugin::state_delta_plugin() {}
+state_delta_plugin::~state_delta_plugin() {}
+
+void
+state_delta_plugin::set_program_options(options_description&, options_description& cfg) {
+    cfg.add_options()
+        ("state-delta-file", bpo::value<bfs::path>(), "File the deltas of blocks are appended to, relative paths are relative to the data dir.")
+        ("state-delta-address", bpo::value<std::string>(), "The local IP and port to listen for incoming tcp connections receiving deltas of blocks.")
+        ("state-delta-max-buffer-kb", bpo::value<uint32_t>()->default_value(64 * 1024), "Max size of deltas buffered for one client in KB, clients exceeding it are disconnected.")
+    ;
+}
+
+void
+state_delta_plugin::plugin_initialize(const variables_map& options) {
+    try {
+        my_ = std::make_shared<state_delta_plugin_impl>(app().get_plugin<chain_plugin>().chain());
+        my_->max_buffer_size_ = (size_t)options.at("state-delta-max-buffer-kb").as<uint32_t>() * 1024;
+
+        if(options.count("state-delta-file")) {
+            auto path = options.at("state-delta-file").as<bfs::path>();
+            if(path.is_relative()) {
+                path = app().data_dir() / path;
+            }
+            my_->file_path_ = path;
+        }
+
+        if(options.count("state-delta-address")) {
+            auto lipstr = options.at("state-delta-address").as<std::string>();
+            auto host   = lipstr.substr(0, lipstr.find(':'));
+            EVT_ASSERT(host.size() < lipstr.size(), chain::plugin_config_exception, "Invalid state-delta-address: ${a}", ("a",lipstr));
+            auto port = lipstr.substr(host.size() + 1);
+
+            auto resolver = tcp::resolver(app().get_io_service());
+            auto query    = tcp::resolver::query(tcp::v4(), host.c_str(), port.c_str());
+            my_->listen_endpoint_ = *resolver.resolve(query);
+            ilog("configured state delta to listen on ${h}:${p}", ("h",host)("p",port));
+        }
+
+        EVT_ASSERT(!my_->file_path_.empty() || my_->listen_endpoint_.has_value(), chain::plugin_config_exception,
+            "Either state-delta-file or state-delta-address should be set");
+
+        my_->init();
+    }
+    FC_LOG_AND_RETHROW()
+}
+
+void
+state_delta_plugin::plugin_startup() {
+    ilog("starting state_delta_plugin");
+    my_->start();
+}
+
+void
+state_delta_plugin::plugin_shutdown() {
+    if(my_) {
+        my_->shutdown();
+        my_.reset();
+    }
+}
+
+}  // namespace evt
@@ -5,13 +5,20 @@
 #include <evt/trafficgen_plugin/trafficgen_plugin.hpp>
 
 #include <signal.h>
+#include <deque>
+#include <fstream>
+#include <random>
+#include <boost/algorithm/string.hpp>
 #include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
 
 #include <evt/chain/exceptions.hpp>
 #include <evt/chain/transaction.hpp>
 #include <evt/chain/token_database.hpp>
+#include <evt/chain/contracts/evt_link.hpp>
 
 #include <fc/io/json.hpp>
+#include <fc/io/raw.hpp>
 #include <fc/variant.hpp>
 
 #include <evt/chain_plugin/chain_plugin.hpp>
@@ -30,6 +37,45 @@ using evt::chain::block_state_ptr;
 using evt::chain::packed_transaction_ptr;
 using evt::chain::private_key_type;
 using evt::chain::transaction_metadata;
+using evt::chain::transaction_metadata_ptr;
+
+namespace __internal {
+
+const uint32_t kCaptureMagic    = 0x43545645;  // 'EVTC'
+const auto     kTickInterval    = std::chrono::milliseconds(10);
+const auto     kReportInterval  = fc::seconds(10);
+const uint32_t kSetupTokensNum  = 200'000;
+
+// kinds of transactions in mixed workload, suspend is a flow of proposing, approving and executing
+enum workload_kind { kTransferFT = 0, kEveriPay, kIssueToken, kAddMeta, kSuspend, kWorkloadKindsNum };
+
+const char* workload_names[] = { "transferft", "everipay", "issuetoken", "addmeta", "suspend" };
+
+std::array<double, kWorkloadKindsNum>
+parse_workload(const std::string& str) {
+    auto weights = std::array<double, kWorkloadKindsNum>();
+
+    auto items = std::vector<std::string>();
+    boost::split(items, str, boost::is_any_of(","));
+    for(auto& item : items) {
+        auto kv = std::vector<std::string>();
+        boost::split(kv, item, boost::is_any_of(":"));
+        EVT_ASSERT(kv.size() == 2, chain::plugin_config_exception, "Invalid workload: ${w}, expect 'kind:weight'", ("w",item));
+
+        boost::trim(kv[0]);
+        auto it = std::find(std::begin(workload_names), std::end(workload_names), kv[0]);
+        EVT_ASSERT(it != std::end(workload_names), chain::plugin_config_exception, "Unknown kind of workload: ${k}", ("k",kv[0]));
+
+        auto w = std::stod(kv[1]);
+        EVT_ASSERT(w >= 0, chain::plugin_config_exception, "Weight of workload cannot be negative: ${w}", ("w",item));
+        weights[it - std::begin(workload_names)] = w;
+    }
+    EVT_ASSERT(std::any_of(weights.cbegin(), weights.cend(), [](auto w) { return w > 0; }), chain::plugin_config_exception,
+        "At least one kind of workload should have positive weight");
+    return weights;
+}
+
+}  // namespace __internal
 
 class trafficgen_plugin_impl : public std::enable_shared_from_this<trafficgen_plugin_impl> {
 public:
@@ -38,6 +84,8 @@ public:
 
 public:
     void init();
+    void init_capture(const fc::path& file);
+    void load_replay(const fc::path& file);
 
 private:
     int  pre_nft_setup(const block_id_type& id);
@@ -47,6 +95,15 @@ private:
     void push_once(int index);
     void push_trx(const action& act, const block_id_type& id);
 
+    packed_transaction_ptr make_trx(const action& act, const block_id_type& id);
+    packed_transaction_ptr next_mixed_trx();
+    name128                unique_name();
+
+    void start();
+    void tick();
+    void push(const packed_transaction_ptr& ptrx, size_t index);
+    void captured(const std::pair<fc::exception_ptr, transaction_metadata_ptr>& ack);
+
 public:
     controller& db_;
 
@@ -61,6 +118,31 @@ public:
 
     std::vector<packed_transaction_ptr> packed_trxs_;
 
+    // transactions per second pushed without waiting for the previous ones, 0 to push all at once,
+    // recorded ones are pushed at their original pace when it's 0
+    double rate_ = 0;
+
+    std::array<double, __internal::kWorkloadKindsNum> weights_;
+    uint32_t                                          issue_batch_ = 100;
+
+    std::mt19937_64                    rand_;
+    std::deque<packed_transaction_ptr> pending_;  // generated ones of the current mixed flow
+    uint64_t                           run_id_ = 0;  // distinguishes names of this run from the previous ones
+    uint64_t                           nonce_  = 0;
+
+    // recorded transactions and their offsets in microseconds since capture started
+    std::vector<std::pair<int64_t, packed_transaction_ptr>> records_;
+
+    std::optional<boost::asio::steady_timer> timer_;
+    fc::time_point                           started_;
+    fc::time_point                           last_report_;
+    size_t                                   sent_ = 0;
+    std::shared_ptr<std::atomic<size_t>>     failed_ = std::make_shared<std::atomic<size_t>>(0);
+
+    std::ofstream                                   capture_;
+    fc::time_point                                  capture_started_;
+    chain::plugin_interface::compat::channels::transaction_ack::channel_type::handle capture_subscription_;
+
     std::optional<boost::signals2::scoped_connection> accepted_block_connection_;
 };
 
@@ -69,15 +151,82 @@ trafficgen_plugin_impl::init() {
     auto& chain_plug = app().get_plugin<chain_plugin>();
     auto& chain      = chain_plug.chain();
 
+    rand_.seed(std::random_device()());
+    run_id_ = fc::time_point::now().sec_since_epoch();
+
     accepted_block_connection_.emplace(chain.accepted_block.connect([&](const chain::block_state_ptr& bs) {
         applied_block(bs);
     }));
 }
 
 void
-trafficgen_plugin_impl::push_trx(const action& act, const block_id_type& id) {
+trafficgen_plugin_impl::init_capture(const fc::path& file) {
+    using namespace __internal;
+
+    capture_.open(file.generic_string(), std::ios::out | std::ios::binary | std::ios::trunc);
+    EVT_ASSERT(capture_.is_open(), chain::plugin_config_exception, "Cannot open capture file: ${f}", ("f",file));
+
+    fc::raw::pack(capture_, kCaptureMagic);
+    fc::raw::pack(capture_, db_.get_chain_id());
+    capture_started_ = fc::time_point::now();
+
+    capture_subscription_ = app().get_channel<chain::plugin_interface::compat::channels::transaction_ack>().subscribe([this](auto& ack) {
+        captured(ack);
+    });
+    ilog("Capturing incoming transactions into ${f}", ("f",file));
+}
+
+void
+trafficgen_plugin_impl::captured(const std::pair<fc::exception_ptr, transaction_metadata_ptr>& ack) {
+    if(ack.first) {
+        return;
+    }
+
+    auto offset = (fc::time_point::now() - capture_started_).count();
+    fc::raw::pack(capture_, offset);
+    fc::raw::pack(capture_, *ack.second->packed_trx);
+}
+
+void
+trafficgen_plugin_impl::load_replay(const fc::path& file) {
+    using namespace __internal;
+    using namespace evt::chain;
+
+    auto content = std::string();
+    fc::read_file_contents(file, content);
+
+    auto ds    = fc::datastream<const char*>(content.data(), content.size());
+    auto magic = uint32_t();
+    auto id    = chain_id_type(fc::sha256());
+    fc::raw::unpack(ds, magic);
+    fc::raw::unpack(ds, id);
+    EVT_ASSERT(magic == kCaptureMagic, chain::plugin_config_exception, "${f} is not a file of captured transactions", ("f",file));
+    EVT_ASSERT(id == db_.get_chain_id(), chain::plugin_config_exception,
+        "Transactions are captured on chain: ${c}, their signatures are not valid on this chain", ("c",id));
+
+    try {
+        while(ds.remaining() > 0) {
+            auto offset = int64_t();
+            auto ptrx   = std::make_shared<packed_transaction>();
+            fc::raw::unpack(ds, offset);
+            fc::raw::unpack(ds, *ptrx);
+            records_.emplace_back(offset, std::move(ptrx));
+        }
+    }
+    catch(const fc::out_of_range_exception&) {
+        wlog("Last record of ${f} is truncated", ("f",file));
+    }
+
+    EVT_ASSERT(!records_.empty(), chain::plugin_config_exception, "No transactions are recorded in ${f}", ("f",file));
+    if(total_num_ == 0 || total_num_ > records_.size()) {
+        total_num_ = records_.size();
+    }
+    ilog("Loaded ${n} recorded transactions", ("n",records_.size()));
+}
+
+packed_transaction_ptr
+trafficgen_plugin_impl::make_trx(const action& act, const block_id_type& id) {
     using namespace evt::chain;
-    using namespace evt::chain::contracts;
 
     auto now = fc::time_point::now();
     auto trx = signed_transaction();
@@ -88,8 +237,12 @@ trafficgen_plugin_impl::push_trx(const action& act, const block_id_type& id) {
     trx.max_charge = 10000;
 
     trx.sign(from_priv_, db_.get_chain_id());
+    return std::make_shared<packed_transaction>(trx);
+}
 
-    auto ptrx = std::make_shared<packed_transaction>(trx);
+void
+trafficgen_plugin_impl::push_trx(const action& act, const block_id_type& id) {
+    auto ptrx = make_trx(act, id);
     app().get_method<chain::plugin_interface::incoming::methods::transaction_async>()(std::make_shared<transaction_metadata>(ptrx), true, [](const auto& result) -> void {
         if(result.template contains<fc::exception_ptr>()) {
             wlog("Push init trx failed e: ${e}", ("e",*result.template get<fc::exception_ptr>()));
@@ -145,7 +298,7 @@ trafficgen_plugin_impl::pre_nft_setup(const block_id_type& id) {
     auto ndact = action(N128(tttesttt), N128(.create), nd);
     push_trx(ndact, id);
 
-    for(auto i = 0; i < 20; i++) {
+    for(auto i = 0u; i < __internal::kSetupTokensNum / 10'000; i++) {
         auto it   = issuetoken();
         it.domain = "tttesttt";
         it.owner.emplace_back(from_addr_);
@@ -238,29 +391,232 @@ trafficgen_plugin_impl::pre_nft_generate(const block_id_type& id) {
     ilog("Generating nft ptrxs... Done");
 }
 
+name128
+trafficgen_plugin_impl::unique_name() {
+    return name128::from_number(run_id_ * 1'000'000 + nonce_++);
+}
+
+packed_transaction_ptr
+trafficgen_plugin_impl::next_mixed_trx() {
+    using namespace __internal;
+    using namespace evt::chain;
+    using namespace evt::chain::contracts;
+
+    if(!pending_.empty()) {
+        auto ptrx = std::move(pending_.front());
+        pending_.pop_front();
+        return ptrx;
+    }
+
+    auto id  = db_.head_block_id();
+    auto pub = from_addr_.get_public_key();
+
+    auto dist = std::discrete_distribution<int>(weights_.cbegin(), weights_.cend());
+    switch(dist(rand_)) {
+    case kTransferFT: {
+        auto tf   = transferft();
+        tf.from   = from_addr_;
+        tf.to     = private_key_type::generate().get_public_key();
+        tf.number = asset(10, evt_sym());
+        tf.memo   = "FROM THE NEW WORLD";
+        return make_trx(action(N128(.fungible), name128::from_number(evt_sym().id()), tf), id);
+    }
+    case kEveriPay: {
+        auto n       = nonce_++;
+        auto link_id = std::string(16, '\0');
+        memcpy(&link_id[0], &run_id_, sizeof(run_id_));
+        memcpy(&link_id[8], &n, sizeof(n));
+
+        auto ep = everipay();
+        ep.link.set_header(evt_link::version1 | evt_link::everiPay);
+        ep.link.add_segment(evt_link::segment(evt_link::timestamp, db_.head_block_time().sec_since_epoch()));
+        ep.link.add_segment(evt_link::segment(evt_link::max_pay, 1'000'000));
+        ep.link.add_segment(evt_link::segment(evt_link::symbol_id, evt_sym().id()));
+        ep.link.add_segment(evt_link::segment(evt_link::link_id, link_id));
+        ep.link.sign(from_priv_);
+        ep.payee  = private_key_type::generate().get_public_key();
+        ep.number = asset(1, evt_sym());
+        return make_trx(action(N128(.fungible), name128::from_number(evt_sym().id()), ep), id);
+    }
+    case kIssueToken: {
+        auto it   = issuetoken();
+        it.domain = "tttesttt";
+        it.owner.emplace_back(from_addr_);
+        for(auto i = 0u; i < issue_batch_; i++) {
+            it.names.emplace_back(unique_name());
+        }
+        return make_trx(action(N128(tttesttt), N128(.issue), it), id);
+    }
+    case kAddMeta: {
+        // tokens issued by setup are owned by sender
+        auto token = name128::from_number(rand_() % kSetupTokensNum);
+        auto am    = addmeta();
+        am.key     = unique_name();
+        am.value   = "FROM THE NEW WORLD";
+        am.creator = authorizer_ref(pub);
+        return make_trx(action(N128(tttesttt), token, am), id);
+    }
+    case kSuspend:
+    default: {
+        auto tf   = transferft();
+        tf.from   = from_addr_;
+        tf.to     = private_key_type::generate().get_public_key();
+        tf.number = asset(10, evt_sym());
+        tf.memo   = "FROM THE NEW WORLD";
+
+        auto ns     = newsuspend();
+        ns.name     = unique_name();
+        ns.proposer = pub;
+        ns.trx.set_reference_block(id);
+        ns.trx.expiration = fc::time_point::now() + fc::minutes(10);
+        ns.trx.payer      = from_addr_;
+        ns.trx.max_charge = 10000;
+        ns.trx.actions.emplace_back(action(N128(.fungible), name128::from_number(evt_sym().id()), tf));
+
+        auto as = aprvsuspend();
+        as.name = ns.name;
+        as.signatures.emplace_back(from_priv_.sign(ns.trx.sig_digest(db_.get_chain_id())));
+
+        auto es     = execsuspend();
+        es.name     = ns.name;
+        es.executor = pub;
+
+        pending_.emplace_back(make_trx(action(N128(.suspend), as.name, as), id));
+        pending_.emplace_back(make_trx(action(N128(.suspend), es.name, es), id));
+        return make_trx(action(N128(.suspend), ns.name, ns), id);
+    }
+    }  // switch
+}
+
 void
 trafficgen_plugin_impl::applied_block(const block_state_ptr& bs) {
-    if(bs->block_num >= start_num_) {
+    if(pushed_ || bs->block_num < start_num_) {
+        return;
+    }
+
+    auto ready = false;
+    if(type_ == "ft") {
         if(packed_trxs_.empty()) {
-            if(type_ == "ft") {
-                pre_ft_generate(bs->id);
-            }
-            else if(type_ == "nft") {
-                if(pre_nft_setup(bs->id)) {
-                    pre_nft_generate(bs->id);
-                }
+            pre_ft_generate(bs->id);
+            return;
+        }
+        ready = true;
+    }
+    else if(type_ == "nft") {
+        if(packed_trxs_.empty()) {
+            if(pre_nft_setup(bs->id)) {
+                pre_nft_generate(bs->id);
             }
+            return;
+        }
+        ready = true;
+    }
+    else if(type_ == "mixed") {
+        ready = pre_nft_setup(bs->id);
+    }
+    else {
+        ready = true;
+    }
+
+    // starts once chain is synced
+    auto now = fc::time_point::now();
+    if(ready && std::abs((db_.head_block_time() - now).to_seconds()) < 1) {
+        start();
+        pushed_ = true;
+    }
+}
+
+void
+trafficgen_plugin_impl::start() {
+    if(rate_ == 0 && type_ != "replay" && type_ != "mixed") {
+        const auto& exec = app().get_io_service().get_executor();
+        for(auto i = 0u; i < total_num_; i++) {
+            boost::asio::post(exec, std::bind(&trafficgen_plugin_impl::push_once, this, (int)i));
+        }
+        return;
+    }
+
+    if(rate_ > 0) {
+        ilog("Starting ${t} traffic at ${r} trxs/s", ("t",type_)("r",rate_));
+    }
+    else {
+        ilog("Starting ${t} traffic at recorded pace", ("t",type_));
+    }
+    started_     = fc::time_point::now();
+    last_report_ = started_;
+    timer_.emplace(app().get_io_service());
+    tick();
+}
+
+void
+trafficgen_plugin_impl::tick() {
+    using namespace __internal;
+
+    // open loop: sends what is due by now regardless of the ones not yet processed
+    auto now     = fc::time_point::now();
+    auto elapsed = (now - started_).count();
+    auto due     = size_t(0);
+    if(rate_ > 0) {
+        due = (size_t)(elapsed * rate_ / 1'000'000);
+    }
+    else {
+        auto it = std::upper_bound(records_.cbegin(), records_.cend(), elapsed + records_.front().first, [](auto t, auto& r) { return t < r.first; });
+        due = it - records_.cbegin();
+    }
+    if(total_num_ > 0) {
+        due = std::min(due, total_num_);
+    }
+
+    for(; sent_ < due; sent_++) {
+        if(type_ == "mixed") {
+            push(next_mixed_trx(), sent_);
+        }
+        else if(type_ == "replay") {
+            push(records_[sent_].second, sent_);
         }
         else {
-            auto now = fc::time_point::now();
-            if(!pushed_ && std::abs((db_.head_block_time() - now).to_seconds()) < 1) {
-                const auto& exec = app().get_io_service().get_executor();
-                for(auto i = 0u; i < total_num_; i++) {
-                    boost::asio::post(exec, std::bind(&trafficgen_plugin_impl::push_once, this, (int)i));
-                }
-                pushed_ = true;
-            }
+            push(packed_trxs_[sent_], sent_);
+        }
+    }
+
+    if(now - last_report_ >= kReportInterval || (total_num_ > 0 && sent_ >= total_num_)) {
+        ilog("Traffic sent: ${s}, failed: ${f}, ${r} trxs/s", ("s",sent_)("f",failed_->load())
+            ("r",(uint64_t)(sent_ * 1'000'000.0 / std::max(elapsed, (int64_t)1))));
+        last_report_ = now;
+    }
+    if(total_num_ > 0 && sent_ >= total_num_) {
+        return;
+    }
+
+    timer_->expires_after(kTickInterval);
+    auto wptr = std::weak_ptr<trafficgen_plugin_impl>(shared_from_this());
+    timer_->async_wait([wptr](auto& ec) {
+        auto self = wptr.lock();
+        if(self && ec != boost::asio::error::operation_aborted) {
+            self->tick();
         }
+    });
+}
+
+void
+trafficgen_plugin_impl::push(const packed_transaction_ptr& ptrx, size_t index) {
+    try {
+        app().get_method<chain::plugin_interface::incoming::methods::transaction_async>()(std::make_shared<transaction_metadata>(ptrx), true, [index, failed = failed_](const auto& result) -> void {
+            if(result.template contains<fc::exception_ptr>()) {
+                (*failed)++;
+                dlog("Push failed at index: ${i}, e: ${e}", ("i",index)("e",*result.template get<fc::exception_ptr>()));
+            }
+        });
+    }
+    catch(boost::interprocess::bad_alloc&) {
+        raise(SIGUSR1);
+    }
+    catch(fc::unrecoverable_exception&) {
+        raise(SIGUSR1);
+    }
+    catch(...) {
+        (*failed_)++;
+        wlog("Push failed at index: ${i}", ("i",index));
     }
 }
 
@@ -289,10 +645,17 @@ void
 trafficgen_plugin::set_program_options(options_description&, options_description& cfg) {
     cfg.add_options()
         ("traffic-start-num", bpo::value<uint32_t>()->default_value(0), "From which block num start trafficgen.")
-        ("traffic-total", bpo::value<size_t>()->default_value(0), "Total transactions to be generated")
+        ("traffic-total", bpo::value<size_t>()->default_value(0), "Total transactions to be generated, 0 for unlimited in 'mixed' and all the recorded ones in 'replay'")
         ("traffic-from", bpo::value<std::string>(), "Address of sender when generating")
         ("traffic-from-priv", bpo::value<std::string>(), "Private key of sender when generating")
-        ("traffic-type", bpo::value<std::string>()->default_value("ft"), "Type of transactions, can be 'nft' or 'ft'")
+        ("traffic-type", bpo::value<std::string>()->default_value("ft"), "Type of transactions, can be 'nft', 'ft', 'mixed' or 'replay'")
+        ("traffic-rate", bpo::value<double>()->default_value(0), "Transactions pushed per second regardless of the pending ones, 0 to push all at once, or at recorded pace for 'replay'")
+        ("traffic-workload", bpo::value<std::string>()->default_value("transferft:50,everipay:20,issuetoken:10,addmeta:10,suspend:10"),
+            "Weights of kinds of transactions in 'mixed' type, kinds are: transferft, everipay, issuetoken, addmeta and suspend")
+        ("traffic-issue-batch", bpo::value<uint32_t>()->default_value(100), "Tokens issued by each issuetoken in 'mixed' type")
+        ("traffic-capture-file", bpo::value<std::string>(), "Record incoming transactions into this file, which can be replayed later")
+        ("traffic-replay-file", bpo::value<std::string>(),
+            "Recorded transactions pushed in 'replay' type, the chain should be started from a snapshot taken before they're recorded")
     ;
 }
 
@@ -301,19 +664,45 @@ trafficgen_plugin::plugin_initialize(const variables_map& options) {
     my_ = std::make_shared<trafficgen_plugin_impl>(app().get_plugin<chain_plugin>().chain());
     my_->start_num_ = options.at("traffic-start-num").as<uint32_t>();
     my_->total_num_ = options.at("traffic-total").as<size_t>();
+    my_->rate_      = options.at("traffic-rate").as<double>();
 
-    EVT_ASSERT(my_->total_num_ <= 200'000, chain::plugin_config_exception, "Total number of generating transactions cannot be large than 200'000");
+    EVT_ASSERT(my_->rate_ >= 0, chain::plugin_config_exception, "Rate of traffic cannot be negative");
+
+    if(options.count("traffic-type")) {
+        auto type = options.at("traffic-type").as<std::string>();
+        EVT_ASSERT(type == "ft" || type == "nft" || type == "mixed" || type == "replay", chain::plugin_config_exception,
+            "Not valid value for --traffic-type option");
+        my_->type_ = type;
+    }
+
+    if(my_->type_ == "replay") {
+        EVT_ASSERT(options.count("traffic-replay-file"), chain::plugin_config_exception, "--traffic-replay-file is required by 'replay' type");
+    }
+    else if(my_->type_ == "ft" || my_->type_ == "nft") {
+        EVT_ASSERT(my_->total_num_ <= 200'000, chain::plugin_config_exception, "Total number of generating transactions cannot be large than 200'000");
+    }
+    else if(my_->type_ == "mixed") {
+        // everiPay links expire soon, so transactions are generated when they're sent
+        EVT_ASSERT(my_->rate_ > 0, chain::plugin_config_exception, "--traffic-rate is required by 'mixed' type");
+        my_->weights_     = __internal::parse_workload(options.at("traffic-workload").as<std::string>());
+        my_->issue_batch_ = options.at("traffic-issue-batch").as<uint32_t>();
+    }
 
     if(options.count("traffic-from") && options.count("traffic-from-priv")) {
         my_->from_addr_ = address(options.at("traffic-from").as<std::string>());
         my_->from_priv_ = private_key_type(options.at("traffic-from-priv").as<std::string>());
-        my_->init(); 
+        my_->init();
+    }
+    else if(my_->type_ == "replay") {
+        // recorded ones are signed already
+        my_->init();
     }
 
-    if(options.count("traffic-type")) {
-        auto type = options.at("traffic-type").as<std::string>();
-        EVT_ASSERT(type == "ft" || type == "nft", chain::plugin_config_exception, "Not valid value for --traffic-type option");
-        my_->type_ = type;
+    if(my_->type_ == "replay") {
+        my_->load_replay(options.at("traffic-replay-file").as<std::string>());
+    }
+    if(options.count("traffic-capture-file")) {
+        my_->init_capture(options.at("traffic-capture-file").as<std::string>());
     }
 }
 
@@ -324,6 +713,13 @@ trafficgen_plugin::plugin_startup() {
 
 void
 trafficgen_plugin::plugin_shutdown() {
+    if(my_->timer_.has_value()) {
+        my_->timer_->cancel();
+    }
+    if(my_->capture_.is_open()) {
+        my_->capture_subscription_.unsubscribe();
+        my_->capture_.close();
+    }
     my_->accepted_block_connection_.reset();
     my_.reset();
 }
@@ -101,6 +101,19 @@ public:
     /** Returns a signature given the digest and public_key, if this wallet can sign via that public key
        */
     virtual std::optional<signature_type> try_sign_digest(const digest_type digest, const public_key_type public_key) = 0;
+
+    /** Returns signatures of the digests in order, the ones this wallet cannot sign are left empty.
+     *  Wallets talking to devices may override it to sign the digests concurrently
+       */
+    virtual std::vector<std::optional<signature_type>>
+    try_sign_digests(const std::vector<std::pair<digest_type, public_key_type>>& digests) {
+        auto sigs = std::vector<std::optional<signature_type>>();
+        sigs.reserve(digests.size());
+        for(auto& d : digests) {
+            sigs.emplace_back(try_sign_digest(d.first, d.second));
+        }
+        return sigs;
+    }
 };
 
 }}  // namespace evt::wallet
\ No newline at end of file
@@ -4,9 +4,12 @@
  */
 #pragma once
 #include <boost/asio/deadline_timer.hpp>
+#include <boost/asio/thread_pool.hpp>
 #include <boost/filesystem/path.hpp>
 #include <boost/interprocess/sync/file_lock.hpp>
 #include <chrono>
+#include <optional>
+#include <unordered_map>
 #include <evt/chain/transaction.hpp>
 #include <evt/wallet_plugin/wallet_api.hpp>
 
@@ -22,6 +25,9 @@ namespace wallet {
 /// The name of the wallet is also used as part of the file name by soft_wallet. See wallet_manager::create.
 /// No const methods because timeout may cause lock_all() to be called.
 class wallet_manager {
+public:
+    using sign_digests_params = std::vector<std::pair<chain::digest_type, public_key_type>>;
+
 public:
     wallet_manager();
     wallet_manager(const wallet_manager&) = delete;
@@ -48,6 +54,9 @@ public:
     void
     set_timeout(int64_t secs) { set_timeout(std::chrono::seconds(secs)); }
 
+    /// Set the number of threads used to sign digests in batch.
+    /// @param threads 0 means digests are signed in the calling thread.
+    void set_signing_threads(uint32_t threads);
 
     /// Sign transaction with the private keys specified via their public keys.
     /// Use chain_controller::get_required_keys to determine which keys are needed for txn.
@@ -66,6 +75,13 @@ public:
     /// @throws fc::exception if corresponding private keys not found in unlocked wallets
     chain::signature_type sign_digest(const chain::digest_type& digest, const public_key_type& key);
 
+    /// Sign many digests at once, each with the private key specified via its public key.
+    /// Digests of keys which can be exported from wallets are signed in parallel, see set_signing_threads.
+    /// @param digests pairs of the digest to sign and the public key to sign it with
+    /// @return signatures in the same order of digests
+    /// @throws fc::exception if any of the private keys is not found in unlocked wallets
+    std::vector<chain::signature_type> sign_digests(const sign_digests_params& digests);
+
     /// Create a new wallet.
     /// A new wallet is created in file dir/{name}.wallet see set_dir.
     /// The new wallet is unlocked after creation.
@@ -141,6 +157,12 @@ private:
     /// Calls lock_all() if timeout has passed.
     void check_timeout();
 
+    /// Find the unlocked wallet holding the key, index of keys is rebuilt after wallets are changed.
+    wallet_api* find_wallet(const public_key_type& key);
+
+    /// Sign with the wallet found in index first and then the other unlocked wallets.
+    std::optional<chain::signature_type> try_sign_digest(const chain::digest_type& digest, const public_key_type& key);
+
 private:
     using timepoint_t = std::chrono::time_point<std::chrono::system_clock>;
     std::map<std::string, std::unique_ptr<wallet_api>> wallets;
@@ -152,6 +174,12 @@ private:
     
     std::unique_ptr<boost::interprocess::file_lock> wallet_dir_lock;
 
+    std::unordered_map<public_key_type, wallet_api*> key_index;
+    bool                                             key_index_dirty = true;
+
+    uint32_t                                signing_threads = 0;
+    std::optional<boost::asio::thread_pool> signing_pool;
+
     void start_lock_watch(std::shared_ptr<boost::asio::deadline_timer> t);
     void initialize_lock();
 };
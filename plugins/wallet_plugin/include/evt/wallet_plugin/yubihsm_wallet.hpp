@@ -14,7 +14,7 @@ struct yubihsm_wallet_impl;
 
 class yubihsm_wallet final : public wallet_api {
 public:
-    yubihsm_wallet(const string& connector, const uint16_t authkey);
+    yubihsm_wallet(const string& connector, const uint16_t authkey, const uint32_t sessions = 1);
     ~yubihsm_wallet();
 
     private_key_type get_private_key(public_key_type pubkey) const override;
@@ -32,7 +32,8 @@ public:
     string create_key(string key_type) override;
     bool   remove_key(string key) override;
 
-    std::optional<signature_type> try_sign_digest(const digest_type digest, const public_key_type public_key) override;
+    std::optional<signature_type>              try_sign_digest(const digest_type digest, const public_key_type public_key) override;
+    std::vector<std::optional<signature_type>> try_sign_digests(const std::vector<std::pair<digest_type, public_key_type>>& digests) override;
 
 private:
     std::unique_ptr<detail::yubihsm_wallet_impl> my;
@@ -2,8 +2,10 @@
  *  @file
  *  @copyright defined in evt/LICENSE.txt
  */
+#include <future>
 #include <fc/crypto/sha256.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/asio/post.hpp>
 #include <appbase/application.hpp>
 #include <evt/chain/exceptions.hpp>
 #include <evt/wallet_plugin/wallet_manager.hpp>
@@ -97,6 +99,7 @@ wallet_manager::create(const std::string& name) {
         wallets.erase(it);
     }
     wallets.emplace(name, std::move(wallet));
+    key_index_dirty = true;
 
     return password;
 }
@@ -122,6 +125,7 @@ wallet_manager::open(const std::string& name) {
         wallets.erase(it);
     }
     wallets.emplace(name, std::move(wallet));
+    key_index_dirty = true;
 }
 
 std::vector<std::string>
@@ -191,6 +195,7 @@ wallet_manager::get_my_signatures(const chain_id_type& chain_id) {
 void
 wallet_manager::lock_all() {
     // no call to check_timeout since we are locking all anyway
+    key_index_dirty = true;
     for(auto& i : wallets) {
         if(!i.second->is_locked()) {
             i.second->lock();
@@ -209,6 +214,7 @@ wallet_manager::lock(const std::string& name) {
         return;
     }
     w->lock();
+    key_index_dirty = true;
 }
 
 void
@@ -223,6 +229,7 @@ wallet_manager::unlock(const std::string& name, const std::string& password) {
         return;
     }
     w->unlock(password);
+    key_index_dirty = true;
 }
 
 void
@@ -236,6 +243,7 @@ wallet_manager::import_key(const std::string& name, const std::string& wif_key)
         EVT_THROW(chain::wallet_locked_exception, "Wallet is locked: ${w}", ("w", name));
     }
     w->import_key(wif_key);
+    key_index_dirty = true;
 }
 
 void
@@ -250,6 +258,7 @@ wallet_manager::remove_key(const std::string& name, const std::string& password,
     }
     w->check_password(password); //throws if bad password
     w->remove_key(key);
+    key_index_dirty = true;
 }
 
 string
@@ -264,29 +273,76 @@ wallet_manager::create_key(const std::string& name, const std::string& key_type)
     }
 
     string upper_key_type = boost::to_upper_copy<std::string>(key_type);
+    key_index_dirty = true;
     return w->create_key(upper_key_type);
 }
 
+wallet_api*
+wallet_manager::find_wallet(const public_key_type& key) {
+    if(key_index_dirty) {
+        key_index.clear();
+        for(const auto& i : wallets) {
+            if(i.second->is_locked()) {
+                continue;
+            }
+            for(const auto& k : i.second->list_public_keys()) {
+                // first wallet wins, the same as scanning wallets in order
+                key_index.emplace(k, i.second.get());
+            }
+        }
+        key_index_dirty = false;
+    }
+
+    auto it = key_index.find(key);
+    if(it == key_index.end()) {
+        return nullptr;
+    }
+    return it->second;
+}
+
+std::optional<chain::signature_type>
+wallet_manager::try_sign_digest(const chain::digest_type& digest, const public_key_type& key) {
+    auto w = find_wallet(key);
+    if(w != nullptr) {
+        auto sig = w->try_sign_digest(digest, key);
+        if(sig.has_value()) {
+            return sig;
+        }
+    }
+
+    // keys of hardware wallets may be changed outside, fall back to ask every unlocked wallet
+    for(const auto& i : wallets) {
+        if(!i.second->is_locked() && i.second.get() != w) {
+            auto sig = i.second->try_sign_digest(digest, key);
+            if(sig.has_value()) {
+                return sig;
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+void
+wallet_manager::set_signing_threads(uint32_t threads) {
+    signing_pool.reset();
+    signing_threads = threads;
+    if(threads > 0) {
+        signing_pool.emplace(threads);
+    }
+}
+
 chain::signed_transaction
 wallet_manager::sign_transaction(const chain::signed_transaction& txn, const flat_set<public_key_type>& keys, const chain::chain_id_type& id) {
     check_timeout();
     chain::signed_transaction stxn(txn);
 
+    auto digest = stxn.sig_digest(id);
     for(const auto& pk : keys) {
-        bool found = false;
-        for(const auto& i : wallets) {
-            if(!i.second->is_locked()) {
-                auto sig = i.second->try_sign_digest(stxn.sig_digest(id), pk);
-                if(sig.has_value()) {
-                    stxn.signatures.push_back(*sig);
-                    found = true;
-                    break;  // inner for
-                }
-            }
-        }
-        if(!found) {
+        auto sig = try_sign_digest(digest, pk);
+        if(!sig.has_value()) {
             EVT_THROW(chain::wallet_missing_pub_key_exception, "Public key not found in unlocked wallets ${k}", ("k", pk));
         }
+        stxn.signatures.push_back(*sig);
     }
 
     return stxn;
@@ -297,13 +353,9 @@ wallet_manager::sign_digest(const chain::digest_type& digest, const public_key_t
     check_timeout();
 
     try {
-        for(const auto& i : wallets) {
-            if(!i.second->is_locked()) {
-                auto sig = i.second->try_sign_digest(digest, key);
-                if(sig.has_value()) {
-                    return *sig;
-                }
-            }
+        auto sig = try_sign_digest(digest, key);
+        if(sig.has_value()) {
+            return *sig;
         }
     }
     FC_LOG_AND_RETHROW();
@@ -311,12 +363,96 @@ wallet_manager::sign_digest(const chain::digest_type& digest, const public_key_t
     EVT_THROW(chain::wallet_missing_pub_key_exception, "Public key not found in unlocked wallets ${k}", ("k", key));
 }
 
+std::vector<chain::signature_type>
+wallet_manager::sign_digests(const sign_digests_params& digests) {
+    // fewer digests are not worth a thread
+    const size_t kMinLaneSize = 8;
+
+    check_timeout();
+
+    auto sigs = std::vector<chain::signature_type>(digests.size());
+    auto jobs = std::vector<std::pair<size_t, private_key_type>>();  // index of digest and key to sign with
+    auto in_place = std::map<wallet_api*, std::vector<size_t>>();     // digests signed by wallet itself
+    for(auto i = 0u; i < digests.size(); i++) {
+        auto& [digest, key] = digests[i];
+
+        auto w = find_wallet(key);
+        if(w != nullptr && signing_pool.has_value()) {
+            try {
+                jobs.emplace_back(i, w->get_private_key(key));
+                continue;
+            }
+            catch(const fc::exception&) {
+                // hardware wallets cannot export keys, sign in place
+            }
+        }
+        in_place[w].emplace_back(i);
+    }
+
+    // wallets get their digests in one batch, so hardware ones can pipeline them
+    for(auto& [w, ids] : in_place) {
+        auto part = sign_digests_params();
+        part.reserve(ids.size());
+        for(auto i : ids) {
+            part.emplace_back(digests[i]);
+        }
+
+        auto psigs = (w != nullptr) ? w->try_sign_digests(part) : std::vector<std::optional<chain::signature_type>>(part.size());
+        for(auto k = 0u; k < ids.size(); k++) {
+            if(!psigs[k].has_value()) {
+                psigs[k] = try_sign_digest(part[k].first, part[k].second);
+            }
+            if(!psigs[k].has_value()) {
+                EVT_THROW(chain::wallet_missing_pub_key_exception, "Public key not found in unlocked wallets ${k}", ("k", part[k].second));
+            }
+            sigs[ids[k]] = *psigs[k];
+        }
+    }
+
+    auto sign = [&](size_t begin, size_t end) {
+        for(auto j = begin; j < end; j++) {
+            sigs[jobs[j].first] = jobs[j].second.sign(digests[jobs[j].first].first);
+        }
+    };
+
+    auto n = std::max<size_t>(1, std::min<size_t>(signing_threads + 1, jobs.size() / kMinLaneSize));
+    if(n == 1) {
+        sign(0, jobs.size());
+        return sigs;
+    }
+
+    // first range is signed in current thread
+    auto step    = (jobs.size() + n - 1) / n;
+    auto futures = std::vector<std::future<void>>();
+    for(auto begin = step; begin < jobs.size(); begin += step) {
+        auto end = std::min(begin + step, jobs.size());
+        auto p   = std::make_shared<std::promise<void>>();
+        futures.emplace_back(p->get_future());
+        boost::asio::post(*signing_pool, [p, &sign, begin, end] {
+            try {
+                sign(begin, end);
+                p->set_value();
+            }
+            catch(...) {
+                p->set_exception(std::current_exception());
+            }
+        });
+    }
+    sign(0, step);
+
+    for(auto& f : futures) {
+        f.get();
+    }
+    return sigs;
+}
+
 void
 wallet_manager::own_and_use_wallet(const string& name, std::unique_ptr<wallet_api>&& wallet) {
     if(wallets.find(name) != wallets.end()) {
         EVT_THROW(wallet_exception, "Tried to use wallet name that already exists.");
     }
     wallets.emplace(name, std::move(wallet));
+    key_index_dirty = true;
 }
 
 void
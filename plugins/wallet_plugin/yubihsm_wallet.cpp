@@ -16,6 +16,10 @@
 #include <boost/asio/steady_timer.hpp>
 #include <boost/dll/runtime_symbol_info.hpp>
 
+#include <condition_variable>
+#include <future>
+#include <mutex>
+
 #include <dlfcn.h>
 
 namespace evt { namespace wallet {
@@ -89,9 +93,16 @@ struct yubihsm_api {
 struct yubihsm_wallet_impl {
     using key_map_type = map<public_key_type, uint16_t>;
 
-    yubihsm_wallet_impl(const string& ep, const uint16_t ak)
+    // every session has its own connector, sessions are pooled so digests can be signed concurrently
+    struct hsm_session {
+        yh_connector* connector = nullptr;
+        yh_session*   session   = nullptr;
+    };
+
+    yubihsm_wallet_impl(const string& ep, const uint16_t ak, const uint32_t ss)
         : endpoint(ep)
-        , authkey(ak) {
+        , authkey(ak)
+        , pool_size(std::max(ss, 1u)) {
         yh_rc rc;
         if((rc = api.init()))
             FC_THROW("yubihsm init failure: ${c}", ("c", api.strerror(rc)));
@@ -107,11 +118,12 @@ struct yubihsm_wallet_impl {
 
     bool
     is_locked() const {
-        return !connector;
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        return alive == 0;
     }
 
     key_map_type::iterator
-    populate_key_map_with_keyid(const uint16_t key_id) {
+    populate_key_map_with_keyid(yh_session* session, const uint16_t key_id) {
         yh_rc   rc;
         size_t  blob_sz = 128;
         uint8_t blob[blob_sz];
@@ -134,19 +146,95 @@ struct yubihsm_wallet_impl {
     }
 
     void
-    unlock(const string& password) {
+    open_session(hsm_session& s, const string& password) {
         yh_rc   rc;
         uint8_t context[YH_CONTEXT_LEN] = {0};
 
+        if((rc = api.init_connector(endpoint.c_str(), &s.connector)))
+            FC_THROW_EXCEPTION(chain::wallet_exception, "Failled to initialize yubihsm connector URL: ${c}", ("c", api.strerror(rc)));
+        if((rc = api.connect_best(&s.connector, 1, NULL)))
+            FC_THROW_EXCEPTION(chain::wallet_exception, "Failed to connect to YubiHSM connector: ${m}", ("m", api.strerror(rc)));
+        if((rc = api.create_session_derived(s.connector, authkey, (const uint8_t*)password.data(), password.size(), false, context, sizeof(context), &s.session)))
+            FC_THROW_EXCEPTION(chain::wallet_exception, "Failed to create YubiHSM session: ${m}", ("m", api.strerror(rc)));
+        if((rc = api.authenticate_session(s.session, context, sizeof(context))))
+            FC_THROW_EXCEPTION(chain::wallet_exception, "Failed to authenticate YubiHSM session: ${m}", ("m", api.strerror(rc)));
+    }
+
+    void
+    close_session(hsm_session& s) {
+        if(s.session) {
+            api.util_close_session(s.session);
+            api.destroy_session(&s.session);
+        }
+        s.session = nullptr;
+        if(s.connector)
+            api.disconnect(s.connector);
+        //it would seem like this would leak-- there is no destroy() call for it. But I clearly can't reuse connectors
+        // as that fails with a "Unable to find a suitable connector"
+        s.connector = nullptr;
+    }
+
+    // takes an idle session out of pool, waits if all of them are in use
+    size_t
+    acquire() {
+        std::unique_lock<std::mutex> lock(pool_mutex);
+        pool_cv.wait(lock, [this] { return !idle.empty() || alive == 0; });
+        if(alive == 0)
+            FC_THROW_EXCEPTION(chain::wallet_locked_exception, "YubiHSM wallet is locked");
+
+        auto i = idle.back();
+        idle.pop_back();
+        return i;
+    }
+
+    // puts session back to pool, broken session is reopened once or dropped
+    void
+    release(size_t i, bool healthy) {
+        if(!healthy) {
+            close_session(sessions[i]);
+            try {
+                open_session(sessions[i], password);
+                healthy = true;
+            }
+            catch(chain::wallet_exception& e) {
+                wlog("Failed to reopen YubiHSM session: ${e}", ("e", e.to_string()));
+                close_session(sessions[i]);
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        if(healthy) {
+            idle.emplace_back(i);
+        }
+        else {
+            alive--;
+        }
+        pool_cv.notify_all();
+    }
+
+    void
+    unlock(const string& password) {
+        yh_rc rc;
+
         try {
-            if((rc = api.init_connector(endpoint.c_str(), &connector)))
-                FC_THROW_EXCEPTION(chain::wallet_exception, "Failled to initialize yubihsm connector URL: ${c}", ("c", api.strerror(rc)));
-            if((rc = api.connect_best(&connector, 1, NULL)))
-                FC_THROW_EXCEPTION(chain::wallet_exception, "Failed to connect to YubiHSM connector: ${m}", ("m", api.strerror(rc)));
-            if((rc = api.create_session_derived(connector, authkey, (const uint8_t*)password.data(), password.size(), false, context, sizeof(context), &session)))
-                FC_THROW_EXCEPTION(chain::wallet_exception, "Failed to create YubiHSM session: ${m}", ("m", api.strerror(rc)));
-            if((rc = api.authenticate_session(session, context, sizeof(context))))
-                FC_THROW_EXCEPTION(chain::wallet_exception, "Failed to authenticate YubiHSM session: ${m}", ("m", api.strerror(rc)));
+            sessions.resize(pool_size);
+            for(auto i = 0u; i < pool_size; i++) {
+                try {
+                    open_session(sessions[i], password);
+                }
+                catch(chain::wallet_exception& e) {
+                    if(i == 0) {
+                        throw;
+                    }
+                    // HSM limits the number of sessions, work with the ones opened
+                    wlog("Only ${n} YubiHSM sessions are opened: ${e}", ("n", i)("e", e.to_string()));
+                    close_session(sessions[i]);
+                    sessions.resize(i);
+                    break;
+                }
+            }
+
+            auto session = sessions[0].session;
 
             yh_object_descriptor authkey_desc;
             if((rc = api.util_get_object_info(session, authkey, YH_AUTHKEY, &authkey_desc)))
@@ -166,44 +254,65 @@ struct yubihsm_wallet_impl {
                 FC_THROW_EXCEPTION(chain::wallet_exception, "yh_util_list_objects failed: ${m}", ("m", api.strerror(rc)));
 
             for(size_t i = 0; i < found_objects_n; ++i)
-                populate_key_map_with_keyid(found_objs[i].id);
+                populate_key_map_with_keyid(session, found_objs[i].id);
         }
         catch(chain::wallet_exception& e) {
             lock();
             throw;
         }
 
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex);
+            for(auto i = 0u; i < sessions.size(); i++) {
+                idle.emplace_back(i);
+            }
+            alive = sessions.size();
+        }
+        // kept for reopening broken sessions while unlocked
+        this->password = password;
+
         prime_keepalive_timer();
     }
 
     void
     lock() {
-        if(session) {
-            api.util_close_session(session);
-            api.destroy_session(&session);
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex);
+            for(auto& s : sessions) {
+                close_session(s);
+            }
+            sessions.clear();
+            idle.clear();
+            alive = 0;
+            pool_cv.notify_all();
         }
-        session = nullptr;
-        if(connector)
-            api.disconnect(connector);
-        //it would seem like this would leak-- there is no destroy() call for it. But I clearly can't reuse connectors
-        // as that fails with a "Unable to find a suitable connector"
-        connector = nullptr;
 
+        password.clear();
         _keys.clear();
         keepalive_timer.cancel();
     }
 
+    // health check, idle sessions are echoed and the broken ones are reopened
     void
     prime_keepalive_timer() {
         keepalive_timer.expires_at(std::chrono::steady_clock::now() + std::chrono::seconds(20));
         keepalive_timer.async_wait([this](auto ec) {
-            if(ec || !session)
+            if(ec || is_locked())
                 return;
 
-            uint8_t data, resp;
-            yh_cmd  resp_cmd;
-            size_t  resp_sz = 1;
-            if(api.send_secure_msg(session, YHC_ECHO, &data, 1, &resp_cmd, &resp, &resp_sz))
+            auto ids = std::vector<size_t>();
+            {
+                std::lock_guard<std::mutex> lock(pool_mutex);
+                ids.swap(idle);
+            }
+            for(auto i : ids) {
+                uint8_t data, resp;
+                yh_cmd  resp_cmd;
+                size_t  resp_sz = 1;
+                release(i, api.send_secure_msg(sessions[i].session, YHC_ECHO, &data, 1, &resp_cmd, &resp, &resp_sz) == YHR_SUCCESS);
+            }
+
+            if(is_locked())
                 lock();
             else
                 prime_keepalive_timer();
@@ -219,8 +328,13 @@ struct yubihsm_wallet_impl {
         size_t  der_sig_sz = 128;
         uint8_t der_sig[der_sig_sz];
         yh_rc   rc;
-        if((rc = api.util_sign_ecdsa(session, it->second, (uint8_t*)d.data(), d.data_size(), der_sig, &der_sig_sz))) {
-            lock();
+
+        auto i = acquire();
+        rc = api.util_sign_ecdsa(sessions[i].session, it->second, (uint8_t*)d.data(), d.data_size(), der_sig, &der_sig_sz);
+        release(i, rc == YHR_SUCCESS);
+        if(rc) {
+            if(is_locked())
+                lock();
             FC_THROW_EXCEPTION(chain::wallet_exception, "yh_util_sign_ecdsa failed: ${m}", ("m", api.strerror(rc)));
         }
 
@@ -249,6 +363,35 @@ struct yubihsm_wallet_impl {
         return final_signature;
     }
 
+    // digests are signed in lanes, one for each session so the round trips to HSM are overlapped
+    std::vector<std::optional<signature_type>>
+    try_sign_digests(const std::vector<std::pair<digest_type, public_key_type>>& digests) {
+        auto sigs = std::vector<std::optional<signature_type>>(digests.size());
+        auto sign = [&](size_t lane, size_t lanes) {
+            for(auto i = lane; i < digests.size(); i += lanes) {
+                sigs[i] = try_sign_digest(digests[i].first, digests[i].second);
+            }
+        };
+
+        auto lanes = 0ul;
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex);
+            lanes = std::max<size_t>(1, std::min<size_t>(alive, digests.size()));
+        }
+
+        // first lane is signed in current thread
+        auto futures = std::vector<std::future<void>>();
+        for(auto lane = 1u; lane < lanes; lane++) {
+            futures.emplace_back(std::async(std::launch::async, sign, lane, lanes));
+        }
+        sign(0, lanes);
+
+        for(auto& f : futures) {
+            f.get();
+        }
+        return sigs;
+    }
+
     public_key_type
     create() {
         if(!api.check_capability(&authkey_caps, "asymmetric_gen"))
@@ -260,10 +403,13 @@ struct yubihsm_wallet_impl {
         if(api.capabilities_to_num("asymmetric_sign_ecdsa:export_under_wrap", &creation_caps))
             FC_THROW_EXCEPTION(chain::wallet_exception, "Cannot create caps mask");
 
+        auto i = acquire();
         try {
-            if((rc = api.util_generate_key_ec(session, &new_key_id, "evtwd created key", authkey_domains, &creation_caps, YH_ALGO_EC_P256)))
+            if((rc = api.util_generate_key_ec(sessions[i].session, &new_key_id, "evtwd created key", authkey_domains, &creation_caps, YH_ALGO_EC_P256)))
                 FC_THROW_EXCEPTION(chain::wallet_exception, "yh_util_generate_key_ec failed: ${m}", ("m", api.strerror(rc)));
-            return populate_key_map_with_keyid(new_key_id)->first;
+            auto pub_key = populate_key_map_with_keyid(sessions[i].session, new_key_id)->first;
+            release(i, true);
+            return pub_key;
         }
         catch(chain::wallet_exception& e) {
             lock();
@@ -271,10 +417,16 @@ struct yubihsm_wallet_impl {
         }
     }
 
-    yh_connector* connector = nullptr;
-    yh_session*   session   = nullptr;
-    string        endpoint;
-    uint16_t      authkey;
+    string   endpoint;
+    uint16_t authkey;
+    uint32_t pool_size;
+    string   password;
+
+    std::vector<hsm_session> sessions;
+    std::vector<size_t>      idle;       // indexes of idle sessions
+    size_t                   alive = 0;  // sessions not broken
+    mutable std::mutex       pool_mutex;
+    std::condition_variable  pool_cv;
 
     map<public_key_type, uint16_t> _keys;
 
@@ -289,8 +441,8 @@ struct yubihsm_wallet_impl {
 
 }  // namespace detail
 
-yubihsm_wallet::yubihsm_wallet(const string& connector, const uint16_t authkey)
-    : my(new detail::yubihsm_wallet_impl(connector, authkey)) {
+yubihsm_wallet::yubihsm_wallet(const string& connector, const uint16_t authkey, const uint32_t sessions)
+    : my(new detail::yubihsm_wallet_impl(connector, authkey, sessions)) {
 }
 
 yubihsm_wallet::~yubihsm_wallet() {
@@ -356,4 +508,9 @@ yubihsm_wallet::try_sign_digest(const digest_type digest, const public_key_type
     return my->try_sign_digest(digest, public_key);
 }
 
+std::vector<std::optional<signature_type>>
+yubihsm_wallet::try_sign_digests(const std::vector<std::pair<digest_type, public_key_type>>& digests) {
+    return my->try_sign_digests(digests);
+}
+
 }}  // namespace evt::wallet
\ No newline at end of file
@@ -187,6 +187,47 @@ format_host_header(const resolved_url& url) {
     }
 }
 
+static void
+write_request(boost::asio::streambuf&    request,
+              const resolved_url&        url,
+              const std::string&         path,
+              const std::vector<string>& headers,
+              const std::string&         postjson,
+              bool                       keep_alive) {
+    std::ostream request_stream(&request);
+
+    auto host_header_value = format_host_header(url);
+    if(keep_alive) {
+        request_stream << "POST " << path << " HTTP/1.1\r\n";
+    }
+    else {
+        request_stream << "POST " << path << " HTTP/1.0\r\n";
+    }
+    request_stream << "Host: " << host_header_value << "\r\n";
+    request_stream << "Content-Length: " << postjson.size() << "\r\n";
+    request_stream << "Accept: */*\r\n";
+    request_stream << (keep_alive ? "Connection: keep-alive\r\n" : "Connection: close\r\n");
+    // append more customized headers
+    for(auto& h : headers) {
+        request_stream << h << "\r\n";
+    }
+    request_stream << "\r\n";
+    request_stream << postjson;
+}
+
+static void
+print_request_buff(const boost::asio::streambuf& request) {
+    string s(request.size(), '\0');
+    buffer_copy(boost::asio::buffer(s), request.data());
+    std::cerr << "REQUEST:" << std::endl
+              << "---------------------" << std::endl
+              << s << std::endl
+              << "---------------------" << std::endl;
+}
+
+static fc::variant handle_response(const resolved_url& url, const std::string& path, unsigned int status_code,
+                                   const std::string& re, bool raw_response, bool print_response);
+
 fc::variant
 do_http_call(const connection_param& cp,
              const fc::variant&      postdata,
@@ -200,29 +241,10 @@ do_http_call(const connection_param& cp,
     const auto& url = cp.url;
 
     boost::asio::streambuf request;
-    std::ostream           request_stream(&request);
-
-    auto host_header_value = format_host_header(url);
-    request_stream << "POST " << url.path << " HTTP/1.0\r\n";
-    request_stream << "Host: " << host_header_value << "\r\n";
-    request_stream << "Content-Length: " << postjson.size() << "\r\n";
-    request_stream << "Accept: */*\r\n";
-    request_stream << "Connection: close\r\n";
-    // append more customized headers
-    std::vector<string>::iterator itr;
-    for(itr = cp.headers.begin(); itr != cp.headers.end(); itr++) {
-        request_stream << *itr << "\r\n";
-    }
-    request_stream << "\r\n";
-    request_stream << postjson;
+    write_request(request, url, url.path, cp.headers, postjson, false);
 
     if(print_request) {
-        string s(request.size(), '\0');
-        buffer_copy(boost::asio::buffer(s), request.data());
-        std::cerr << "REQUEST:" << std::endl
-                  << "---------------------" << std::endl
-                  << s << std::endl
-                  << "---------------------" << std::endl;
+        print_request_buff(request);
     }
 
     unsigned int status_code;
@@ -262,8 +284,18 @@ do_http_call(const connection_param& cp,
         throw;
     }
 
+    return handle_response(url, url.path, status_code, re, cp.raw_response, print_response);
+}
+
+static fc::variant
+handle_response(const resolved_url& url,
+                const std::string&  path,
+                unsigned int        status_code,
+                const std::string&  re,
+                bool                raw_response,
+                bool                print_response) {
     auto response_result = fc::variant();
-    if(!cp.raw_response) {
+    if(!raw_response) {
         response_result = fc::json::from_string(re);
     }
     else {
@@ -271,7 +303,7 @@ do_http_call(const connection_param& cp,
     }
 
     if(print_response) {
-        if(!cp.raw_response) {
+        if(!raw_response) {
             std::cerr << "RESPONSE:" << std::endl
                       << "---------------------" << std::endl
                       << fc::json::to_pretty_string(response_result) << std::endl
@@ -290,31 +322,31 @@ do_http_call(const connection_param& cp,
     }
     else if(status_code == 404) {
         if(url.scheme == "unix") {
-            if(url.path.compare(0, wallet_func_base.size(), wallet_func_base) == 0) {
+            if(path.compare(0, wallet_func_base.size(), wallet_func_base) == 0) {
                 throw chain::missing_wallet_api_plugin_exception(FC_LOG_MESSAGE(error, "Wallet is not available"));
             }
-            else if(url.path.compare(0, producer_func_base.size(), producer_func_base) == 0) {
+            else if(path.compare(0, producer_func_base.size(), producer_func_base) == 0) {
                 throw chain::missing_producer_api_plugin_exception(FC_LOG_MESSAGE(error, "Producer API plugin is not enabled"));
             }
         }
         else {
             // Unknown endpoint
-            if(url.path.compare(0, wallet_func_base.size(), wallet_func_base) == 0) {
+            if(path.compare(0, wallet_func_base.size(), wallet_func_base) == 0) {
                 throw chain::missing_wallet_api_plugin_exception(FC_LOG_MESSAGE(error, "Wallet can only be called via unix socket"));
             }
-            else if(url.path.compare(0, chain_func_base.size(), chain_func_base) == 0) {
+            else if(path.compare(0, chain_func_base.size(), chain_func_base) == 0) {
                 throw chain::missing_chain_api_plugin_exception(FC_LOG_MESSAGE(error, "Chain API plugin is not enabled"));
             }
-            else if(url.path.compare(0, net_func_base.size(), net_func_base) == 0) {
+            else if(path.compare(0, net_func_base.size(), net_func_base) == 0) {
                 throw chain::missing_net_api_plugin_exception(FC_LOG_MESSAGE(error, "Net API plugin is not enabled"));
             }
-            else if(url.path.compare(0, evt_func_base.size(), evt_func_base) == 0) {
+            else if(path.compare(0, evt_func_base.size(), evt_func_base) == 0) {
                 throw chain::missing_evt_api_plugin_exception(FC_LOG_MESSAGE(error, "EVT API plugin is not enabled"));
             }
-            else if(url.path.compare(0, history_func_base.size(), history_func_base) == 0) {
+            else if(path.compare(0, history_func_base.size(), history_func_base) == 0) {
                 throw chain::missing_history_api_plugin_exception(FC_LOG_MESSAGE(error, "History API plugin is not enabled"));
             }
-            else if(url.path.compare(0, producer_func_base.size(), producer_func_base) == 0) {
+            else if(path.compare(0, producer_func_base.size(), producer_func_base) == 0) {
                 throw chain::missing_producer_api_plugin_exception(FC_LOG_MESSAGE(error, "Producer API can only be called via unix socket"));
             }
         }
@@ -337,4 +369,158 @@ do_http_call(const connection_param& cp,
     return response_result;
 }
 
+// reads one response and leaves the bytes after it in buffer, so it works on connections kept open
+template <class T>
+std::string
+read_response(T& socket, boost::asio::streambuf& response, unsigned int& status_code, bool& keep_alive) {
+    boost::asio::read_until(socket, response, "\r\n\r\n");
+
+    std::istream response_stream(&response);
+    std::string  http_version;
+    response_stream >> http_version;
+    response_stream >> status_code;
+    std::string status_message;
+    std::getline(response_stream, status_message);
+    FC_ASSERT(!(!response_stream || http_version.substr(0, 5) != "HTTP/"), "Invalid Response");
+
+    // HTTP/1.1 keeps connection open by default, HTTP/1.0 doesn't
+    keep_alive = (http_version == "HTTP/1.1");
+
+    std::string header;
+    int         response_content_length = -1;
+    std::regex  clregex(R"xx(^Content-Length:\s+(\d+))xx", std::regex_constants::icase);
+    std::regex  connregex(R"xx(^Connection:\s+(\S+))xx", std::regex_constants::icase);
+    while(std::getline(response_stream, header) && header != "\r") {
+        std::smatch match;
+        if(std::regex_search(header, match, clregex)) {
+            response_content_length = std::stoi(match[1]);
+        }
+        else if(std::regex_search(header, match, connregex)) {
+            keep_alive = boost::algorithm::iequals(match.str(1), "keep-alive");
+        }
+    }
+    FC_ASSERT(response_content_length >= 0, "Invalid Content-Length response, header: ${h}", ("h",header));
+
+    if(response.size() < (size_t)response_content_length) {
+        boost::asio::read(socket, response, boost::asio::transfer_exactly(response_content_length - response.size()));
+    }
+
+    auto re = std::string(response_content_length, '\0');
+    response_stream.read(&re[0], response_content_length);
+    return re;
+}
+
+class persistent_connection::impl {
+public:
+    impl(const connection_param& cp)
+        : cp(cp)
+        , unix_socket(cp.context->ios)
+        , socket(cp.context->ios) {
+        FC_ASSERT(cp.url.scheme == "unix" || cp.url.scheme == "http", "Only http and unix socket connections can be kept open");
+    }
+
+    ~impl() {
+        close();
+    }
+
+public:
+    void
+    connect() {
+        if(cp.url.scheme == "unix") {
+            unix_socket.connect(boost::asio::local::stream_protocol::endpoint(cp.url.server));
+        }
+        else {
+            do_connect(socket, cp.url);
+        }
+        connected = true;
+    }
+
+    void
+    close() {
+        auto ec = boost::system::error_code();
+        unix_socket.close(ec);
+        socket.close(ec);
+        response.consume(response.size());
+        connected = false;
+    }
+
+    std::string
+    txrx(boost::asio::streambuf& request, unsigned int& status_code) {
+        auto keep_alive = false;
+        auto re         = std::string();
+        if(cp.url.scheme == "unix") {
+            boost::asio::write(unix_socket, request.data());
+            re = read_response(unix_socket, response, status_code, keep_alive);
+        }
+        else {
+            boost::asio::write(socket, request.data());
+            re = read_response(socket, response, status_code, keep_alive);
+        }
+        if(!keep_alive) {
+            close();
+        }
+        return re;
+    }
+
+    fc::variant
+    call(const std::string& path, const fc::variant& postdata, bool print_request, bool print_response) {
+        std::string postjson;
+        if(!postdata.is_null()) {
+            postjson = print_request ? fc::json::to_pretty_string(postdata) : fc::json::to_string(postdata);
+        }
+
+        auto full_path = cp.url.path + path;
+
+        boost::asio::streambuf request;
+        write_request(request, cp.url, full_path, cp.headers, postjson, true);
+
+        if(print_request) {
+            print_request_buff(request);
+        }
+
+        unsigned int status_code;
+        std::string  re;
+
+        auto reused = connected;
+        if(!connected) {
+            connect();
+        }
+        try {
+            re = txrx(request, status_code);
+        }
+        catch(boost::system::system_error& e) {
+            close();
+            // server may have closed the idle connection, retry once on a new one
+            if(!reused) {
+                throw;
+            }
+            connect();
+            re = txrx(request, status_code);
+        }
+
+        return handle_response(cp.url, full_path, status_code, re, cp.raw_response, print_response);
+    }
+
+public:
+    connection_param cp;
+    bool             connected = false;
+
+    boost::asio::local::stream_protocol::socket unix_socket;
+    tcp::socket                                 socket;
+    boost::asio::streambuf                      response;
+};
+
+persistent_connection::persistent_connection(const connection_param& cp)
+    : my(new impl(cp)) {}
+
+persistent_connection::~persistent_connection() {}
+
+fc::variant
+persistent_connection::call(const std::string& path,
+                            const fc::variant& postdata,
+                            bool               print_request,
+                            bool               print_response) {
+    return my->call(path, postdata, print_request, print_response);
+}
+
 }}}  // namespace evt::client::http
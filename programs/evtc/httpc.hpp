@@ -99,6 +99,28 @@ fc::variant do_http_call(
     bool                    print_request  = false,
     bool                    print_response = false);
 
+/**
+ *  Connection kept open between calls, so requests don't pay for connecting each time.
+ *  It's reconnected when server closes it, only http and unix socket are supported.
+ *  Not thread-safe, use one per thread.
+ */
+class persistent_connection {
+public:
+    persistent_connection(const connection_param& cp);
+    ~persistent_connection();
+
+public:
+    // path is relative to the url of connection
+    fc::variant call(const std::string& path,
+                     const fc::variant& postdata       = fc::variant(),
+                     bool               print_request  = false,
+                     bool               print_response = false);
+
+private:
+    class impl;
+    std::unique_ptr<impl> my;
+};
+
 const std::string chain_func_base             = "/v1/chain";
 const std::string get_info_func               = chain_func_base + "/get_info";
 const std::string get_db_info_func            = chain_func_base + "/get_db_info";
@@ -167,6 +189,7 @@ const std::string producer_paused       = producer_func_base + "/paused";
 const std::string producer_runtime_opts = producer_func_base + "/get_runtime_options";
 const std::string create_snapshot       = producer_func_base + "/create_snapshot";
 const std::string get_integrity_hash    = producer_func_base + "/get_integrity_hash";
+const std::string get_state_digest      = producer_func_base + "/get_state_digest";
 
 
 const string evtwd_stop = "/v1/evtwd/stop";
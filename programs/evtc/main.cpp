@@ -4,9 +4,13 @@
  */
 
 #include <iostream>
+#include <fstream>
 #include <limits>
+#include <map>
+#include <mutex>
 #include <regex>
 #include <string>
+#include <thread>
 #include <type_traits>
 #include <vector>
 
@@ -1269,6 +1273,8 @@ struct set_producer_subcommands {
     string  confkey;
     int64_t confvalue;
     bool    postgres;
+    bool    compress;
+    string  delta_base;
     string  prodsjson;
 
     vector<string> prodkeys;
@@ -1340,9 +1346,13 @@ struct set_producer_subcommands {
 
         auto cscmd = actionRoot->add_subcommand("snapshot", localized("Create a snapshot till current head block"));
         cscmd->add_flag("-p,--postgres", postgres, localized("Add postgres to snapshot"));
+        cscmd->add_flag("-z,--compress", compress, localized("Write snapshot with sections compressed by zstd in parallel"));
+        cscmd->add_option("-d,--delta-base", delta_base, localized("Head block id of the base snapshot, only the changes of token database since it are written"));
         cscmd->callback([this] {
             auto arg = fc::mutable_variant_object();
-            arg["postgres"] = postgres;
+            arg["postgres"]   = postgres;
+            arg["compress"]   = compress;
+            arg["delta_base"] = delta_base;
 
             const auto& v = call(url, create_snapshot, arg);
             print_info(v);
@@ -1353,6 +1363,12 @@ struct set_producer_subcommands {
             const auto& v = call(url, get_integrity_hash);
             print_info(v);
         });
+
+        auto sdcmd = actionRoot->add_subcommand("state_digest", localized("Get incrementally maintained digest of state at current head block"));
+        sdcmd->callback([] {
+            const auto& v = call(url, get_state_digest);
+            print_info(v);
+        });
     }
 };
 
@@ -1691,6 +1707,74 @@ struct set_get_history_subcommands {
     }
 };
 
+// each line is either a request object: {"path": "/v1/chain/get_info", "body": {...}}
+// or a signed transaction to push, results are printed as JSON lines in the same order
+void
+run_batch(std::istream& in, uint32_t concurrency) {
+    auto cp = connection_param(context, parse_url(url), no_verify ? false : true, headers);
+
+    auto mutex   = std::mutex();
+    auto line_no = (size_t)0;  // lines read
+    auto seq     = (size_t)0;  // requests read
+    auto next    = (size_t)0;  // next request to print
+    auto results = std::map<size_t, string>();
+
+    auto run = [&] {
+        auto conn = persistent_connection(cp);
+        auto line = string();
+        while(true) {
+            auto n = (size_t)0;
+            auto r = fc::mutable_variant_object();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                do {
+                    if(!std::getline(in, line)) {
+                        return;
+                    }
+                    line_no++;
+                } while(line.empty());
+                n = seq++;
+                r("line", line_no);
+            }
+
+            try {
+                auto v = fc::json::from_string(line);
+                if(v.is_object() && v.get_object().contains("path")) {
+                    auto& obj = v.get_object();
+                    r("result", conn.call(obj["path"].as_string(), obj.contains("body") ? obj["body"] : fc::variant(), print_request, print_response));
+                }
+                else {
+                    auto trx = v.as<signed_transaction>();
+                    r("result", conn.call(push_txn_func, fc::variant(packed_transaction(trx, packed_transaction::none)), print_request, print_response));
+                }
+            }
+            catch(const fc::exception& e) {
+                r("error", fc::mutable_variant_object("code", e.code())("name", e.name())("what", e.to_string()));
+            }
+            catch(const std::exception& e) {
+                r("error", fc::mutable_variant_object("what", e.what()));
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            results.emplace(n, fc::json::to_string(r));
+            for(auto it = results.begin(); it != results.end() && it->first == next; it = results.erase(it)) {
+                std::cout << it->second << "\n";
+                next++;
+            }
+            std::cout.flush();
+        }
+    };
+
+    auto workers = std::vector<std::thread>();
+    for(auto i = 1u; i < concurrency; i++) {
+        workers.emplace_back(run);
+    }
+    run();
+    for(auto& w : workers) {
+        w.join();
+    }
+}
+
 CLI::callback_t header_opt_callback = [](CLI::results_t res) {
     vector<string>::iterator itr;
 
@@ -1773,7 +1857,7 @@ main(int argc, char** argv) {
 
     // get db info
     get->add_subcommand("dbinfo", localized("Get current underlying token database statistics"))->callback([] {
-        std::cout << call(get_db_info_func, fc::variant(), true).get_string() << std::endl;
+        std::cout << fc::json::to_pretty_string(call(get_db_info_func, fc::variant(), true)) << std::endl;
     });
 
     // get actions
@@ -2128,6 +2212,25 @@ main(int argc, char** argv) {
         }
     });
 
+    // batch subcommand
+    string   batch_file;
+    uint32_t batch_concurrency = 4;
+
+    auto batch = app.add_subcommand("batch", localized("Send requests or transactions read line by line through connections kept open, results are printed as JSON lines"));
+    batch->add_option("file", batch_file, localized("The file to read from, stdin is used if not provided"));
+    batch->add_option("-c,--concurrency", batch_concurrency, localized("Number of requests sent concurrently"))->capture_default_str();
+    batch->callback([&] {
+        EVTC_ASSERT(batch_concurrency > 0, "Concurrency should be positive");
+        if(batch_file.empty()) {
+            run_batch(std::cin, batch_concurrency);
+        }
+        else {
+            auto in = std::ifstream(batch_file);
+            EVTC_ASSERT(in.is_open(), "Cannot open file: ${f}", ("f", batch_file));
+            run_batch(in, batch_concurrency);
+        }
+    });
+
     // Push subcommand
     auto push = app.add_subcommand("push", localized("Push arbitrary transactions to the blockchain"));
     push->require_subcommand();
@@ -0,0 +1,92 @@
+#!/usr/bin/env python3
+
+# Measures how fast postgres_plugin ingests blocks: a recorded block log (copied from
+# a real node, or from a node fed by trafficgen) is replayed by evtd at full speed, which
+# emits the same block and transaction signals postgres_plugin consumes when syncing.
+# The throughput evtd logs with --postgres-stats-interval is collected until the queue
+# is drained and no more blocks come in.
+
+import csv
+import os
+import re
+import shutil
+import subprocess
+import tempfile
+import time
+
+import click
+
+STATS_RE = re.compile(r'ingest: ([\d.]+) blocks/s, ([\d.]+) rows/s, queue size: (\d+), '
+                      r'high watermark: (\d+), synced block num: (\d+)')
+
+
+def green(text):
+    return click.style(text, fg='green')
+
+
+@click.command()
+@click.option('--evtd', help='path of evtd', type=click.Path(exists=True), default='evtd')
+@click.option('--blocks', '-b', help='dir with the recorded blocks.log and blocks.index', type=click.Path(exists=True), required=True)
+@click.option('--postgres-uri', '-p', help='postgres connection string, the database is cleared', required=True)
+@click.option('--interval', '-i', help='seconds between two samples', type=click.IntRange(1, 3600), default=1)
+@click.option('--idle', help='stop after this many samples without new blocks', type=click.IntRange(1, 1000), default=5)
+@click.option('--output', '-o', help='csv file the samples are written to', type=click.Path(), default='pg_ingest.csv')
+@click.option('--keep', help='keep the data dir of evtd', is_flag=True)
+@click.argument('evtd_args', nargs=-1, type=click.UNPROCESSED)
+def run(evtd, blocks, postgres_uri, interval, idle, output, keep, evtd_args):
+    """Replays BLOCKS into postgres and reports blocks/s, rows/s and queue size over time,
+    extra EVTD_ARGS are passed to evtd, like `--postgres-binary-copy false` to compare COPY paths"""
+    data_dir = tempfile.mkdtemp(prefix='evt_pg_ingest_')
+    os.makedirs(os.path.join(data_dir, 'blocks'))
+    for f in ('blocks.log', 'blocks.index'):
+        shutil.copy(os.path.join(blocks, f), os.path.join(data_dir, 'blocks', f))
+
+    cmd = [evtd, '--data-dir', data_dir, '--config-dir', data_dir,
+           '--plugin', 'evt::postgres_plugin', '--postgres-uri', postgres_uri,
+           '--replay-blockchain', '--clear-postgres',
+           '--postgres-stats-interval', str(interval)] + list(evtd_args)
+    click.echo('Running: {}'.format(' '.join(cmd)))
+
+    samples = []
+    start = time.monotonic()
+    proc = subprocess.Popen(cmd, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, universal_newlines=True)
+    try:
+        idles = 0
+        for line in proc.stderr:
+            m = STATS_RE.search(line)
+            if m is None:
+                continue
+
+            sample = [round(time.monotonic() - start, 1)] + [float(m.group(1)), float(m.group(2))] + [int(g) for g in m.groups()[2:]]
+            samples.append(sample)
+            click.echo('{:>8}s {:>10} blocks/s {:>12} rows/s  queue: {:>6}  synced: {}'.format(*sample[:4], sample[5]))
+
+            idles = idles + 1 if sample[1] == 0 and sample[3] == 0 else 0
+            if idles >= idle:
+                break
+    finally:
+        proc.terminate()
+        proc.wait()
+        if not keep:
+            shutil.rmtree(data_dir)
+
+    with open(output, 'w', newline='') as f:
+        writer = csv.writer(f)
+        writer.writerow(['time', 'blocks/s', 'rows/s', 'queue size', 'high watermark', 'synced block num'])
+        writer.writerows(samples)
+
+    busy = [s for s in samples if s[1] > 0]
+    if not busy:
+        click.echo('No blocks ingested')
+        return
+
+    click.echo('Ingested to block {} in {}s, avg {} blocks/s, {} rows/s, max queue size {}'.format(
+        green(str(busy[-1][5])),
+        green(str(round(len(busy) * interval, 1))),
+        green(str(round(sum(s[1] for s in busy) / len(busy), 1))),
+        green(str(round(sum(s[2] for s in busy) / len(busy), 1))),
+        green(str(max(s[4] for s in samples)))))
+
+
+if __name__ == '__main__':
+    run()
@@ -164,6 +164,158 @@ TEST_CASE_METHOD(abi_test, "optional_abi_test", "[abis]") {
     CHECK(fc::to_hex(bytes2) == fc::to_hex(bytes22));
 }
 
+TEST_CASE_METHOD(abi_test, "resolved_types_abi_test", "[abis]") {
+    auto abi = abi_def();
+    abi.types.emplace_back(type_def{"count", "uint32"});
+    abi.types.emplace_back(type_def{"nodes", "node[]"});
+    abi.enums.emplace_back(enum_def{"color", "uint8", {"red", "green"}});
+    abi.variants.emplace_back(variant_def{"payload", {{"num", "count"}, {"text", "string"}}});
+    abi.structs.emplace_back(struct_def{"base", "", {{"id", "count"}}});
+    abi.structs.emplace_back(struct_def{"node", "base", {{"color", "color"}, {"data", "payload?"}, {"children", "nodes"}}});
+
+    auto abis = abi_serializer(abi, std::chrono::hours(1));
+
+    auto json = R"({
+        "id": 1, "color": "green", "data": { "type": "text", "data": "root" },
+        "children": [
+            { "id": 2, "color": "red", "data": { "type": "num", "data": 5 }, "children": [] },
+            { "id": 3, "color": "red", "children": [ { "id": 4, "color": "green", "children": [] } ] }
+        ]
+    })";
+    auto var  = fc::json::from_string(json);
+    auto var2 = verify_byte_round_trip_conversion(abis, "node", var);
+
+    CHECK(var2["id"].as_uint64() == 1);
+    CHECK(var2["color"].get_string() == "green");
+    CHECK(var2["data"]["data"].get_string() == "root");
+    CHECK(var2["children"].size() == 2);
+    CHECK(var2["children"].get_array()[0]["data"]["type"].get_string() == "num");
+    CHECK(var2["children"].get_array()[1]["data"].is_null());
+    CHECK(var2["children"].get_array()[1]["children"].get_array()[0]["id"].as_uint64() == 4);
+
+    auto bytes = abis.variant_to_binary("node", var, get_exec_ctx());
+    CHECK(abis.binary_to_json("node", bytes, get_exec_ctx()) == fc::json::to_string(var2));
+
+    auto bytes2 = bytes;
+    bytes2.push_back(0);
+    CHECK_THROWS_AS(abis.binary_to_json("node", bytes2, get_exec_ctx()), unpack_exception);
+    bytes2.resize(bytes.size() - 1);
+    CHECK_THROWS_AS(abis.binary_to_json("node", bytes2, get_exec_ctx()), unpack_exception);
+
+    // types not defined in abi are still resolved
+    auto arr = fc::json::from_string(R"([{ "id": 5, "color": "red", "children": [] }])");
+    verify_byte_round_trip_conversion(abis, "node[]", arr);
+    verify_byte_round_trip_conversion(abis, "count?", fc::variant(7));
+
+    CHECK_THROWS_AS(abis.variant_to_binary("node", fc::json::from_string(R"({ "id": 1, "color": "blue", "children": [] })"), get_exec_ctx()), pack_exception);
+    CHECK_THROWS_AS(abis.variant_to_binary("unknown", var, get_exec_ctx()), unknown_abi_type_exception);
+}
+
+TEST_CASE_METHOD(abi_test, "binary_to_json_abi_test", "[abis]") {
+    auto abi = abi_def();
+    abi.structs.emplace_back(struct_def{"numbers", "", {{"f64", "float64"}, {"f32", "float32"}, {"data", "bytes"}, {"values", "float64[]"}}});
+
+    auto abis = abi_serializer(abi, std::chrono::hours(1));
+
+    // json should be the same as the one of fc::json, including the formatting of doubles
+    auto json = R"({ "f64": 3, "f32": 0.1, "data": "0a0b0c", "values": [ -2.5, 1e+300, 0.1, 100, 1.2345678901234567 ] })";
+    auto var  = fc::json::from_string(json);
+    auto var2 = verify_byte_round_trip_conversion(abis, "numbers", var);
+
+    auto bytes = abis.variant_to_binary("numbers", var, get_exec_ctx());
+    CHECK(abis.binary_to_json("numbers", bytes, get_exec_ctx()) == fc::json::to_string(var2));
+}
+
+TEST_CASE_METHOD(abi_test, "json_to_binary_abi_test", "[abis]") {
+    auto abi = abi_def();
+    abi.types.emplace_back(type_def{"count", "uint32"});
+    abi.types.emplace_back(type_def{"nodes", "node[]"});
+    abi.enums.emplace_back(enum_def{"color", "uint8", {"red", "green"}});
+    abi.variants.emplace_back(variant_def{"payload", {{"num", "count"}, {"text", "string"}}});
+    abi.structs.emplace_back(struct_def{"base", "", {{"id", "count"}}});
+    abi.structs.emplace_back(struct_def{"node", "base", {{"color", "color"}, {"data", "payload?"}, {"children", "nodes"}}});
+
+    auto abis = abi_serializer(abi, std::chrono::hours(1));
+
+    auto check_same = [&](auto& type, auto json) {
+        auto bytes = abis.variant_to_binary(type, fc::json::from_string(json), get_exec_ctx());
+        CHECK(fc::to_hex(abis.json_to_binary(type, json, get_exec_ctx())) == fc::to_hex(bytes));
+    };
+
+    // keys out of order, absent optional and unknown keys
+    check_same("node", R"({
+        "children": [
+            { "color": "red", "id": 2, "data": { "data": 5, "type": "num" }, "children": [] },
+            { "id": 3, "extra": { "a": [1, 2] }, "color": "red", "children": [ { "children": [], "id": 4, "color": "green" } ] }
+        ],
+        "id": 1, "color": "green", "data": { "type": "text", "data": "root" }
+    })");
+    check_same("node[]", R"([{ "id": 5, "color": "red", "children": [] }])");
+    check_same("count?", "7");
+    check_same("count?", "null");
+    check_same("payload", R"({ "type": "text", "data": "a" })");
+
+    // these are handled by variants, so the errors are the same
+    CHECK_THROWS_AS(abis.json_to_binary("node", R"({ "id": 1, "color": "blue", "children": [] })", get_exec_ctx()), pack_exception);
+    CHECK_THROWS_AS(abis.json_to_binary("node", R"({ "id": 1, "color": "red" })", get_exec_ctx()), pack_exception);
+    CHECK_THROWS_AS(abis.json_to_binary("unknown", R"({})", get_exec_ctx()), unknown_abi_type_exception);
+    CHECK_THROWS_AS(abis.json_to_binary("node", R"({ "id": 1, )", get_exec_ctx()), fc::parse_error_exception);
+
+    // last one of duplicated keys is used
+    check_same("node", R"({ "id": 1, "color": "red", "children": [], "id": 2 })");
+}
+
+TEST_CASE_METHOD(abi_test, "json_to_packed_transactions_abi_test", "[abis]") {
+    auto& abis = get_evt_abi();
+
+    auto json = std::string(R"=====(
+    {
+      "signatures": [],
+      "compression": "none",
+      "transaction": {
+        "expiration": "2018-06-01T00:00:00",
+        "ref_block_num": 1,
+        "ref_block_prefix": 2,
+        "max_charge": 10000,
+        "payer": "EVT6MRyAjQq8ud7hVNYcfnVPJqcVpscN5So8BhtHuGYqET5GDW5CV",
+        "actions": [{
+          "name": "addmeta",
+          "domain": "cookie",
+          "key": ".meta",
+          "data": {
+            "value": "value",
+            "key": "key",
+            "creator": "[A] EVT6MRyAjQq8ud7hVNYcfnVPJqcVpscN5So8BhtHuGYqET5GDW5CV"
+          }
+        }],
+        "transaction_extensions": []
+      }
+    }
+    )=====");
+
+    auto ptrx = packed_transaction();
+    abis.from_variant(fc::json::from_string(json), ptrx, get_exec_ctx());
+
+    auto ptrxs = std::vector<packed_transaction>();
+    REQUIRE(abis.json_to_packed_transactions(json, false /* batch */, ptrxs, get_exec_ctx()));
+    REQUIRE(ptrxs.size() == 1);
+    CHECK(ptrxs[0].id() == ptrx.id());
+    CHECK(fc::to_hex(ptrxs[0].get_packed_transaction()) == fc::to_hex(ptrx.get_packed_transaction()));
+
+    ptrxs.clear();
+    REQUIRE(abis.json_to_packed_transactions("[" + json + "," + json + "]", true /* batch */, ptrxs, get_exec_ctx()));
+    REQUIRE(ptrxs.size() == 2);
+    CHECK(ptrxs[1].id() == ptrx.id());
+
+    // not an array of transactions
+    CHECK(!abis.json_to_packed_transactions(json, true /* batch */, ptrxs, get_exec_ctx()));
+    // data before name is left to variants
+    auto json2 = json;
+    json2.replace(json2.find(R"("name": "addmeta",)"), 18, "");
+    json2.replace(json2.find("}],"), 0, R"(, "name": "addmeta")");
+    CHECK(!abis.json_to_packed_transactions(json2, false /* batch */, ptrxs, get_exec_ctx()));
+}
+
 TEST_CASE_METHOD(abi_test, "newdomain_abi_test", "[abis]") {
     auto& abis = get_evt_abi();
 
@@ -621,6 +621,30 @@ class Test(unittest.TestCase):
         self.assertTrue(type(iso8601.parse_date(res_dict[0]['timestamp'])) is datetime.datetime, msg=res_dict[0]['timestamp'])
         self.assertTrue(token1_name in resp, msg=resp)
 
+        # paginated by cursor
+        req = {
+            'domain': '.fungible',
+            'take': 4,
+            'cursor': ''
+        }
+        req['domain'] = domain_name
+
+        resp = api.get_actions(json.dumps(req)).text
+        res_dict = json.loads(resp)
+        self.assertEqual(len(res_dict['actions']), 4, msg=resp)
+        self.assertTrue(res_dict['cursor'] is not None, msg=resp)
+
+        req['cursor'] = res_dict['cursor']
+        resp = api.get_actions(json.dumps(req)).text
+        res_dict = json.loads(resp)
+        self.assertEqual(len(res_dict['actions']), 2, msg=resp)
+
+        req['cursor'] = res_dict['cursor']
+        resp = api.get_actions(json.dumps(req)).text
+        res_dict = json.loads(resp)
+        self.assertEqual(len(res_dict['actions']), 0, msg=resp)
+        self.assertTrue(res_dict['cursor'] is None, msg=resp)
+
         req = {
             'domain': '.fungible',
             'dire': 'asc',
@@ -0,0 +1,249 @@
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <thread>
+
+#include <catch/catch.hpp>
+
+#include <fc/filesystem.hpp>
+#include <fc/io/raw.hpp>
+#include <evt/chain/block_log.hpp>
+#include <evt/chain/genesis_state.hpp>
+
+using namespace evt;
+using namespace chain;
+
+extern std::string evt_unittests_dir;
+
+namespace {
+
+// blocks linked to each other, numbers of them start from 1
+std::vector<signed_block_ptr>
+make_blocks(uint32_t n) {
+    auto blocks = std::vector<signed_block_ptr>();
+    auto prev   = block_id_type();
+    for(auto i = 0u; i < n; i++) {
+        auto b       = std::make_shared<signed_block>();
+        b->timestamp = block_timestamp_type(i + 1);
+        b->producer  = N(evt);
+        b->previous  = prev;
+
+        prev = b->id();
+        blocks.emplace_back(std::move(b));
+    }
+    return blocks;
+}
+
+fc::path
+fresh_blocks_dir(const std::string& name) {
+    auto dir = fc::path(evt_unittests_dir) / "block_log_tests" / name;
+    if(fc::exists(dir)) {
+        fc::remove_all(dir);
+    }
+    return dir;
+}
+
+void
+append_blocks(block_log& log, const std::vector<signed_block_ptr>& blocks) {
+    log.reset(genesis_state(), blocks[0]);
+    for(auto i = 1u; i < blocks.size(); i++) {
+        log.append(blocks[i]);
+    }
+}
+
+// blocks from `first` to `last` are read by number and in sequence
+void
+check_blocks(const block_log& log, const std::vector<signed_block_ptr>& blocks, uint32_t first, uint32_t last) {
+    for(auto num = first; num <= last; num++) {
+        auto b = log.read_block_by_num(num);
+        REQUIRE(b);
+        CHECK(b->id() == blocks[num - 1]->id());
+    }
+
+    auto reader = block_log_reader(log, first);
+    for(auto num = first; num <= last; num++) {
+        auto b = reader.read_next();
+        REQUIRE(b);
+        CHECK(b->id() == blocks[num - 1]->id());
+    }
+    CHECK(!reader.read_next());
+}
+
+}  // namespace
+
+TEST_CASE("block_log_round_trip_test", "[block_log]") {
+    auto dir    = fresh_blocks_dir("round_trip");
+    auto blocks = make_blocks(20);
+    {
+        auto log = block_log(dir);
+        log.reset(genesis_state(), blocks[0]);
+        for(auto i = 1u; i < blocks.size(); i++) {
+            auto pos = log.append(blocks[i]);
+            REQUIRE(pos != block_log::npos);
+            CHECK(log.get_block_pos(blocks[i]->block_num()) == pos);
+            CHECK(log.read_block(pos).first->id() == blocks[i]->id());
+        }
+        CHECK(log.head()->id() == blocks.back()->id());
+        CHECK(log.read_head()->id() == blocks.back()->id());
+        check_blocks(log, blocks, 1, 20);
+    }
+
+    // reopened, lost index is rebuilt from the log
+    fc::remove(dir / "blocks.index");
+    {
+        auto log = block_log(dir);
+        CHECK(log.head()->id() == blocks.back()->id());
+        check_blocks(log, blocks, 1, 20);
+    }
+
+    // incomplete block left at the end is dropped by repair
+    {
+        auto f = std::ofstream((dir / "blocks.log").generic_string(), std::ios::app | std::ios::binary);
+        f.write("incomplete", 10);
+    }
+    fc::remove_all(block_log::repair_log(dir));
+    {
+        auto log = block_log(dir);
+        CHECK(log.head()->id() == blocks.back()->id());
+        check_blocks(log, blocks, 1, 20);
+    }
+}
+
+TEST_CASE("block_log_retention_test", "[block_log]") {
+    auto dir    = fresh_blocks_dir("retention");
+    auto blocks = make_blocks(14);
+    auto conf   = block_log_config { .stride = 4, .max_retained = 2, .archive_dir = "archive" };
+    {
+        auto log = block_log(dir, conf);
+        append_blocks(log, blocks);
+
+        // 1-4 is archived, 5-8 and 9-12 are retained, 13 and 14 are in current file
+        CHECK(log.first_block_num() == 13);
+        CHECK(log.first_available_block_num() == 5);
+        CHECK(!log.read_block_by_num(4));
+        check_blocks(log, blocks, 5, 14);
+    }
+    CHECK(fc::exists(dir / "archive" / "blocks-1-4.log"));
+    CHECK(fc::exists(dir / "archive" / "blocks-1-4.index"));
+    CHECK(fc::exists(dir / "retained" / "blocks-5-8.log"));
+    CHECK(fc::exists(dir / "retained" / "blocks-9-12.log"));
+
+    // retained files are loaded when reopened, lost index of them is rebuilt
+    fc::remove(dir / "retained" / "blocks-5-8.index");
+    {
+        auto log = block_log(dir, conf);
+        CHECK(log.first_available_block_num() == 5);
+        CHECK(log.head()->id() == blocks.back()->id());
+        check_blocks(log, blocks, 5, 14);
+    }
+    CHECK(fc::exists(dir / "retained" / "blocks-5-8.index"));
+}
+
+TEST_CASE("block_log_zstd_test", "[block_log]") {
+    auto dir      = fresh_blocks_dir("zstd");
+    auto retained = dir / "retained";
+    auto blocks   = make_blocks(10);
+    auto conf     = block_log_config { .stride = 4, .compress_retained = true };
+
+    // raw files are removed once compressed ones take their places
+    auto compressed = [&] {
+        for(auto name : { "blocks-1-4", "blocks-5-8" }) {
+            if(!fc::exists(retained / (std::string(name) + ".zlog")) || fc::exists(retained / (std::string(name) + ".log"))) {
+                return false;
+            }
+        }
+        return true;
+    };
+    {
+        auto log = block_log(dir, conf);
+        append_blocks(log, blocks);
+
+        for(auto i = 0; i < 200 && !compressed(); i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        REQUIRE(compressed());
+        check_blocks(log, blocks, 1, 10);
+    }
+    CHECK(fc::exists(retained / "blocks-1-4.zindex"));
+
+    // lost index of compressed file is rebuilt from its frames
+    fc::remove(retained / "blocks-5-8.zindex");
+    {
+        auto log = block_log(dir, conf);
+        check_blocks(log, blocks, 1, 10);
+    }
+    CHECK(fc::file_size(retained / "blocks-5-8.zindex") == sizeof(uint64_t) * 5);
+}
+
+TEST_CASE("block_log_async_test", "[block_log]") {
+    auto dir     = fresh_blocks_dir("async");
+    auto blocks  = make_blocks(50);
+    auto conf    = block_log_config { .async_append = true, .max_pending = 8 };
+    auto durable = std::atomic<uint32_t>(0);
+    {
+        auto log = block_log(dir, conf);
+        log.set_durable_callback([&durable](auto num) { durable = num; });
+        log.reset(genesis_state(), blocks[0]);
+        for(auto i = 1u; i < blocks.size(); i++) {
+            CHECK(log.append(blocks[i]) == block_log::npos);
+        }
+
+        // pending blocks are read from memory before they're written
+        CHECK(log.head()->id() == blocks.back()->id());
+        check_blocks(log, blocks, 1, 50);
+
+        log.flush();
+        CHECK(log.last_durable_block_num() == 50);
+        CHECK(durable == 50);
+        CHECK(log.get_block_pos(50) != block_log::npos);
+    }
+    {
+        auto log = block_log(dir);
+        CHECK(log.head()->id() == blocks.back()->id());
+        check_blocks(log, blocks, 1, 50);
+    }
+}
+
+TEST_CASE("block_log_parallel_repair_test", "[block_log]") {
+    auto dir    = fresh_blocks_dir("parallel_repair");
+    auto blocks = make_blocks(30);
+    auto conf   = block_log_config { .recovery_threads = 4 };
+    auto pos    = uint64_t(0);
+    {
+        auto log = block_log(dir, conf);
+        append_blocks(log, blocks);
+        pos = log.get_block_pos(21);
+    }
+
+    // index is rebuilt by verifying chunks of blocks in parallel
+    fc::remove(dir / "blocks.index");
+    {
+        auto log = block_log(dir, conf);
+        check_blocks(log, blocks, 1, 30);
+    }
+
+    // block 21 is broken while the positions of blocks are intact, number of block is in the leading bytes
+    // of its previous id, which follows timestamp, producer and confirmed
+    {
+        auto& b  = *blocks[20];
+        auto  at = pos + fc::raw::pack_size(b.timestamp) + fc::raw::pack_size(b.producer) + fc::raw::pack_size(b.confirmed);
+
+        auto f = std::fstream((dir / "blocks.log").generic_string(), std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(at);
+        f.put((char)0xff);
+    }
+    fc::remove_all(block_log::repair_log(dir, 0, "retained", 4));
+    {
+        auto log = block_log(dir, conf);
+        CHECK(log.head()->block_num() == 20);
+        check_blocks(log, blocks, 1, 20);
+    }
+
+    // recovery stops at given block
+    fc::remove_all(block_log::repair_log(dir, 12, "retained", 4));
+    {
+        auto log = block_log(dir, conf);
+        CHECK(log.head()->block_num() == 12);
+        check_blocks(log, blocks, 1, 12);
+    }
+}
@@ -1,5 +1,7 @@
 #include "contracts_tests.hpp"
+#include <fc/crypto/city.hpp>
 #include <evt/chain/address.hpp>
+#include <evt/chain/dense_hash.hpp>
 
 enum psvbonus_type { kPsvBonus = 0, kPsvBonusSlim };
 
@@ -18,6 +20,29 @@ auto CHECK_EQUAL = [](auto& lhs, auto& rhs) {
     CHECK(memcmp(b1.data(), b2.data(), b1.size()) == 0);
 };
 
+// the same layout as the distributions of passive bonus stored in token database
+struct bonus_holders {
+    bonus_holders() {
+        slim.set_empty_key(0);
+    }
+
+    symbol_id_type                           sym_id;
+    google::dense_hash_map<uint32_t, int64_t> slim;
+    std::unordered_map<std::string, int64_t>  coll;
+    int64_t                                  total = 0;
+};
+
+struct bonus_dist {
+    uint32_t                   created_at;
+    uint32_t                   created_index;
+    std::vector<bonus_holders> holders;
+    time_point_sec             deadline;
+    optional<address>          final_receiver;
+};
+
+FC_REFLECT(bonus_holders, (sym_id)(slim)(coll)(total));
+FC_REFLECT(bonus_dist, (created_at)(created_index)(holders)(deadline)(final_receiver));
+
 TEST_CASE_METHOD(contracts_test, "passive_bonus_test", "[contracts]") {
     auto spb = setpsvbonus();
     spb.sym = evt_sym();
@@ -407,4 +432,135 @@ TEST_CASE_METHOD(contracts_test, "passive_bonus_dist_test", "[contracts]") {
     CHECK(pb.methods.size() == pb2->methods.size());
     CHECK(pb.round == pb2->round);
     CHECK(pb.deadline == pb2->deadline);
-}
\ No newline at end of file
+}
+
+TEST_CASE_METHOD(contracts_test, "passive_bonus_dist_v2_test", "[contracts]") {
+    auto& tokendb = my_tester->control->token_db();
+    my_tester->control->get_execution_context().set_version(N(distpsvbonus), 2);
+
+    auto actkey     = name128::from_number(get_sym_id());
+    auto bonus_addr = address(N(.psvbonus), actkey, 0);
+
+    // balances of holders keyed by hash of address, the same as what version 1 walks at once
+    auto snapshot = [&](symbol_id_type sym_id) {
+        auto balances = std::map<uint32_t, int64_t>();
+        tokendb.read_assets_range(sym_id, 0, [&](auto& k, auto&& v) {
+            auto prop = property();
+            extract_db_value(v, prop);
+            balances[fc::city_hash32(k.data(), k.size())] = prop.amount;
+            return true;
+        });
+        return balances;
+    };
+
+    auto holders = snapshot(evt_sym().id()).size();
+    REQUIRE(holders > 1);
+
+    for(int i = 0; i < 300; i++) {
+        auto tf   = transferft();
+        tf.from   = key;
+        tf.to     = tester::get_public_key(N(to4));
+        tf.number = asset(2'00000, get_sym());
+
+        my_tester->push_action(action(N128(.fungible), actkey, tf), key_seeds, payer);
+        my_tester->produce_block();
+    }
+
+    property pool;
+    READ_DB_ASSET(bonus_addr, get_sym(), pool);
+
+    auto dpb        = distpsvbonus_v2();
+    dpb.sym_id      = get_sym().id();
+    dpb.deadline    = my_tester->control->head_block_time();
+    dpb.max_holders = 1;
+
+    auto keyseeds = std::vector<name>{ N(key2), N(payer) };
+    auto before   = snapshot(evt_sym().id());
+
+    // starts round 2 and walks the first holder
+    my_tester->push_action(action(N128(.psvbonus), actkey, dpb), keyseeds, payer);
+    my_tester->produce_block();
+
+    CHECK(tokendb.exists_token(token_type::psvbonus_dist, std::nullopt, get_psvbonus_db_key(get_sym_id(), 2)));
+    {
+        // bonus is moved to the round only after all the holders are walked
+        property bonus;
+        READ_DB_ASSET(bonus_addr, get_sym(), bonus);
+        CHECK(bonus.amount == pool.amount);
+    }
+    {
+        // walked holders are kept in chunks apart and merged into the round once the walk finishes
+        tokendb.flush_cache_values();
+        auto str = std::string();
+        tokendb.read_token(token_type::psvbonus_dist, std::nullopt, get_psvbonus_db_key(get_sym_id(), 2), str);
+        auto bd = bonus_dist();
+        extract_db_value(str, bd);
+        REQUIRE(!bd.holders.empty());
+        for(auto& h : bd.holders) {
+            CHECK(h.slim.empty());
+            CHECK(h.total == 0);
+        }
+    }
+
+    // continuations should be the same as the round
+    auto dpb2     = dpb;
+    dpb2.deadline = dpb.deadline + fc::seconds(1);
+    CHECK_THROWS_AS(my_tester->push_action(action(N128(.psvbonus), actkey, dpb2), keyseeds, payer), bonus_dist_continuation_exception);
+    dpb2 = dpb;
+    dpb2.final_receiver = address(tester::get_public_key(N(receiver)));
+    CHECK_THROWS_AS(my_tester->push_action(action(N128(.psvbonus), actkey, dpb2), keyseeds, payer), bonus_dist_continuation_exception);
+
+    // following actions continue the walk of round 2 one holder at a time
+    auto pushes = 1u;
+    while(true) {
+        try {
+            my_tester->push_action(action(N128(.psvbonus), actkey, dpb), keyseeds, payer);
+            my_tester->produce_block();
+        }
+        catch(bonus_unreached_dist_threshold&) {
+            break;
+        }
+        REQUIRE(++pushes <= holders * 2);
+    }
+    CHECK(pushes >= holders);
+
+    auto pb = passive_bonus();
+    READ_TOKEN2(token, N128(.psvbonus), get_psvbonus_db_key(get_sym_id(), kPsvBonus), pb);
+    CHECK(pb.round == 2);
+    {
+        property bonus;
+        READ_DB_ASSET(bonus_addr, get_sym(), bonus);
+        CHECK(bonus.amount == 0);
+        READ_DB_ASSET(address(N(.psvbonus), actkey, 2), get_sym(), bonus);
+        CHECK(bonus.amount == pool.amount);
+    }
+
+    // holders walked in chunks are the same as the ones walked at once, only the balances moved by the fees of
+    // the actions during the walk can be any of the ones before and after
+    auto after = snapshot(evt_sym().id());
+    REQUIRE(after.size() == before.size());
+
+    tokendb.flush_cache_values();
+    auto str = std::string();
+    tokendb.read_token(token_type::psvbonus_dist, std::nullopt, get_psvbonus_db_key(get_sym_id(), 2), str);
+    auto bd = bonus_dist();
+    extract_db_value(str, bd);
+    CHECK(bd.deadline == time_point_sec(dpb.deadline));
+
+    auto dit = std::find_if(bd.holders.cbegin(), bd.holders.cend(), [](auto& h) { return h.sym_id == evt_sym().id(); });
+    REQUIRE(dit != bd.holders.cend());
+    auto& dist = *dit;
+    CHECK(dist.coll.empty());
+    REQUIRE(dist.slim.size() == before.size());
+
+    auto total = int64_t(0);
+    for(auto& it : before) {
+        auto wit = dist.slim.find(it.first);
+        REQUIRE(wit != dist.slim.end());
+        CHECK((wit->second == it.second || wit->second == after[it.first]));
+        total += wit->second;
+    }
+    CHECK(dist.total == total);
+
+    my_tester->control->get_execution_context().set_version_unsafe(N(distpsvbonus), 1);
+}
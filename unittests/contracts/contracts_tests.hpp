@@ -1,5 +1,6 @@
 #include <catch/catch.hpp>
 
+#include <evt/chain/execution_context_impl.hpp>
 #include <evt/chain/token_database.hpp>
 #include <evt/chain/global_property_object.hpp>
 #include <evt/chain/contracts/evt_link_object.hpp>
@@ -173,3 +174,60 @@ protected:
     int                     ti;
     symbol_id_type          sym_id;
 };
+
+// a fresh chain of its own produced by `evt` alone, validators of it are started with their own configs
+// and apply the blocks of producer
+class producer_chain {
+public:
+    producer_chain(const std::string& name)
+        : basedir_(evt_unittests_dir + "/" + name)
+        , genesis_time_(fc::time_point::now()) {
+        if(fc::exists(basedir_)) {
+            fc::remove_all(basedir_);
+        }
+
+        producer = std::make_unique<tester>(make_config("producer"));
+        producer->block_signing_private_keys.insert(std::make_pair(tester::get_public_key("evt"), tester::get_private_key("evt")));
+    }
+
+public:
+    controller::config
+    make_config(const std::string& name) const {
+        auto cfg = controller::config();
+        cfg.blocks_dir        = basedir_ + "/" + name + "/blocks";
+        cfg.state_dir         = basedir_ + "/" + name + "/state";
+        cfg.db_config.db_path = basedir_ + "/" + name + "/tokendb";
+        cfg.charge_free_mode  = true;
+
+        cfg.genesis.initial_timestamp = genesis_time_;
+        cfg.genesis.initial_key       = tester::get_public_key("evt");
+        return cfg;
+    }
+
+    transaction_trace_ptr
+    push_prodvote(const conf_key& key, int64_t value) {
+        auto pv     = prodvote();
+        pv.producer = "evt";
+        pv.key      = key;
+        pv.value    = value;
+
+        auto var = fc::variant();
+        to_variant(pv, var);
+        return producer->push_action(N(prodvote), N128(.prodvote), key, var.get_object(), { "evt" }, address(tester::get_public_key("evt")));
+    }
+
+    // applies the blocks of producer which are not in validator yet
+    void
+    sync(tester& validator) const {
+        for(auto i = validator.control->head_block_num() + 1; i <= producer->control->head_block_num(); i++) {
+            validator.push_block(producer->control->fetch_block_by_number(i));
+        }
+    }
+
+public:
+    std::unique_ptr<tester> producer;
+
+private:
+    std::string    basedir_;
+    fc::time_point genesis_time_;
+};
@@ -409,13 +409,21 @@ TEST_CASE_METHOD(contracts_test, "transferft_test", "[contracts]") {
     CHECK_THROWS_AS(my_tester->push_action(N(transferft), N128(.fungible), (name128)std::to_string(get_sym_id()), var.get_object(), key_seeds, payer2), charge_exceeded_exception);
 
     my_tester->add_money(payer2, asset(100'000'000, evt_sym()));
-    my_tester->push_action(N(transferft), N128(.fungible), (name128)std::to_string(get_sym_id()), var.get_object(), key_seeds, payer2);
+    auto trace = my_tester->push_action(N(transferft), N128(.fungible), (name128)std::to_string(get_sym_id()), var.get_object(), key_seeds, payer2);
 
     auto& tokendb = my_tester->control->token_db();
     asset ast;
     READ_DB_ASSET(address(tester::get_public_key(N(to))), symbol(5, get_sym_id()), ast);
     CHECK(30'00000 == ast.amount());
 
+    // balances after transfer are recorded in trace
+    auto& balances = trace->action_traces[0].ft_balances;
+    REQUIRE(balances.size() == 2);
+    CHECK(balances[0].addr == address(tester::get_public_key(N(to))));
+    CHECK(balances[0].sym_id == get_sym_id());
+    CHECK(balances[0].amount == 30'00000);
+    CHECK(balances[1].addr == trft.from);
+
     //from == to test
     trft.from = address(tester::get_public_key(N(to)));
     to_variant(trft, var);
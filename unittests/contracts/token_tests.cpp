@@ -154,6 +154,26 @@ TEST_CASE_METHOD(contracts_test, "issuetoken_test", "[contracts]") {
 
     CHECK(EXISTS_TOKEN2(token, get_domain_name(), "t1"));
 
+    // values are assembled from domain and owner packed once, they should be the same as packing the whole token
+    istk.domain = get_domain_name(1);
+    istk.names  = {"v1", "v2", "v3"};
+    istk.owner  = {key, tester::get_public_key(N(other))};
+    my_tester->push_action(action(get_domain_name(1), N128(.issue), istk), key_seeds, payer);
+
+    auto check_value = [&](const auto& domain, const auto& name, const auto& owner) {
+        auto tk   = token_def(domain, name, owner);
+        auto str  = std::string();
+        tokendb.read_token(token_type::token, domain, name, str);
+        CHECK(str == make_db_value(tk).as_string_view());
+    };
+    for(auto& n : {"t1", "t2", "t3", "t4", "t5"}) {
+        check_value(get_domain_name(), name128(n), std::vector<address>{key});
+        check_value(get_domain_name(1), name128(n), std::vector<address>{key});
+    }
+    for(auto& n : istk.names) {
+        check_value(istk.domain, n, istk.owner);
+    }
+
     my_tester->produce_blocks();
 
     auto tk  = token_def();
@@ -284,6 +304,18 @@ TEST_CASE_METHOD(contracts_test, "destroytoken_auth_test", "[contracts]") {
     // add `.distable-destroy` with 'true' to domain-1
     my_tester->push_action(action(get_domain_name(1), N128(.meta), am), key_seeds, payer, 5'000'000);
 
+    // metas are stored apart, only the enabled reserved metas are flagged on domains
+    {
+        auto& cache = my_tester->control->token_db_cache();
+        auto  ms    = cache.read_token<meta_set>(token_type::meta, std::nullopt, get_meta_db_key(get_domain_name(1), N128(.meta)));
+        CHECK(ms->metas.back().key == N128(.disable-destroy));
+
+        auto d0 = cache.read_token<domain_def>(token_type::domain, std::nullopt, get_domain_name());
+        auto d1 = cache.read_token<domain_def>(token_type::domain, std::nullopt, get_domain_name(1));
+        CHECK(!(d0->flags & (meta_flags)meta_flag::disable_destroy));
+        CHECK(d1->flags & (meta_flags)meta_flag::disable_destroy);
+    }
+
     auto dt   = destroytoken();
     dt.domain = get_domain_name();
     dt.name   = N128(t4);
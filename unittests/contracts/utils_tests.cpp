@@ -1,3 +1,6 @@
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include "contracts_tests.hpp"
 
 TEST_CASE_METHOD(contracts_test, "prodvote_test", "[contracts]") {
@@ -64,6 +67,51 @@ TEST_CASE_METHOD(contracts_test, "prodvote_test", "[contracts]") {
     my_tester->produce_blocks();
 }
 
+TEST_CASE("zstd_activation_test", "[chain]") {
+    auto  chain    = producer_chain("zstd_activation_tests");
+    auto& producer = *chain.producer;
+
+    auto make_trx = [&] {
+        auto pv     = prodvote();
+        pv.producer = "evt";
+        pv.key      = N128(cpu-charge-factor);
+        pv.value    = 12;
+
+        auto var = fc::variant();
+        to_variant(pv, var);
+
+        auto trx = signed_transaction();
+        trx.actions.emplace_back(producer.get_action(N(prodvote), N128(.prodvote), pv.key, var.get_object()));
+        producer.set_transaction_headers(trx, address(tester::get_public_key("evt")));
+        trx.sign(tester::get_private_key("evt"), producer.control->get_chain_id());
+        return packed_transaction(trx, packed_transaction::zstd);
+    };
+
+    auto ptrx = make_trx();
+    CHECK(!producer.control->is_compression_activated(packed_transaction::zstd));
+    CHECK(producer.control->is_compression_activated(packed_transaction::zlib));
+    CHECK_THROWS_AS(producer.push_transaction(ptrx), tx_compression_not_activated);
+
+    CHECK_THROWS_AS(chain.push_prodvote(N128(zstd-compression), 2), prodvote_value_exception);
+
+    // activated and used in the same block
+    producer.produce_blocks();
+    chain.push_prodvote(N128(zstd-compression), 1);
+    CHECK(producer.control->is_compression_activated(packed_transaction::zstd));
+
+    ptrx = make_trx();
+    producer.push_transaction(ptrx);
+    CHECK(producer.control->get_global_properties().configuration.base_cpu_charge_factor == 12);
+    producer.produce_blocks();
+
+    // validators check each transaction against the state right before it, like the producer did
+    auto validator = tester(chain.make_config("validator"));
+    chain.sync(validator);
+    CHECK(validator.control->head_block_id() == producer.control->head_block_id());
+    CHECK(validator.control->is_compression_activated(packed_transaction::zstd));
+    CHECK(validator.control->get_global_properties().configuration.base_cpu_charge_factor == 12);
+}
+
 TEST_CASE_METHOD(contracts_test, "charge_test", "[contracts]") {
     const char* test_data = R"=====(
     {
@@ -308,3 +356,234 @@ TEST_CASE_METHOD(contracts_test, "updsched_test", "[contracts]") {
     my_tester->produce_blocks();
 }
 
+
+TEST_CASE("trusted_checkpoint_test", "[chain]") {
+    auto  chain    = producer_chain("checkpoint_tests");
+    auto& producer = *chain.producer;
+
+    chain.push_prodvote(N128(network-charge-factor), 2);
+    producer.produce_blocks();
+
+    // returns whether the authorities of transactions are skipped when the blocks are applied
+    auto validate = [&](bool force_all_checks) {
+        auto cfg = chain.make_config(force_all_checks ? "forced" : "trusted");
+        cfg.trusted_checkpoint_num = producer.control->head_block_num();
+        cfg.force_all_checks       = force_all_checks;
+
+        auto validator = tester(cfg);
+        auto skipped   = std::vector<bool>();
+        validator.control->applied_transaction.connect([&](auto&) {
+            skipped.emplace_back(validator.control->skip_auth_check());
+        });
+        chain.sync(validator);
+        CHECK(validator.control->head_block_id() == producer.control->head_block_id());
+        CHECK(validator.control->get_global_properties().configuration.base_network_charge_factor == 2);
+
+        REQUIRE(!skipped.empty());
+        return std::all_of(skipped.cbegin(), skipped.cend(), [](auto s) { return s; });
+    };
+
+    CHECK(validate(false));
+    CHECK(!validate(true));
+}
+
+TEST_CASE_METHOD(contracts_test, "pinned_execution_context_test", "[contracts]") {
+    auto& exec_ctx = static_cast<evt_execution_context&>(my_tester->control->get_execution_context());
+    auto  ver      = exec_ctx.get_current_version(N(everipass));
+    REQUIRE(exec_ctx.get_max_version(N(everipass)) > 1);
+
+    auto pinned = exec_ctx.pin_versions();
+    CHECK(pinned->get_current_version(N(everipass)) == ver);
+    CHECK(pinned->get_acttype_name(N(everipass)) == exec_ctx.get_acttype_name(N(everipass)));
+    CHECK(pinned->get_current_actions().size() == exec_ctx.get_current_actions().size());
+
+    // versions changed by chain are not seen by the pinned one
+    auto nver = ver == 1 ? 2 : 1;
+    exec_ctx.set_version_unsafe(N(everipass), nver);
+    CHECK(exec_ctx.get_current_version(N(everipass)) == nver);
+    CHECK(pinned->get_current_version(N(everipass)) == ver);
+    CHECK(pinned->get_current_actions()[pinned->index_of(N(everipass))].ver == ver);
+
+    CHECK_THROWS_AS(pinned->set_version_unsafe(N(everipass), nver), action_version_exception);
+    exec_ctx.set_version_unsafe(N(everipass), ver);
+}
+
+TEST_CASE("block_traces_test", "[chain]") {
+    auto  chain    = producer_chain("block_traces_tests");
+    auto& producer = *chain.producer;
+
+    auto key   = tester::get_public_key("evt");
+    auto payer = address(key);
+    auto var   = fc::variant();
+
+    const char* newdomain_data = R"=====(
+        {
+          "name" : "trdomain",
+          "creator" : "EVT5ve9Ezv9vLZKp1NmRzvB5ZoZ21YZ533BSB2Ai2jLzzMep6biU2",
+          "issue" : {
+            "name" : "issue",
+            "threshold" : 1,
+            "authorizers": [{
+                "ref": "[A] EVT5ve9Ezv9vLZKp1NmRzvB5ZoZ21YZ533BSB2Ai2jLzzMep6biU2",
+                "weight": 1
+              }
+            ]
+          },
+          "transfer": {
+            "name": "transfer",
+            "threshold": 1,
+            "authorizers": [{
+                "ref": "[G] .OWNER",
+                "weight": 1
+              }
+            ]
+          },
+          "manage": {
+            "name": "manage",
+            "threshold": 1,
+            "authorizers": [{
+                "ref": "[A] EVT5ve9Ezv9vLZKp1NmRzvB5ZoZ21YZ533BSB2Ai2jLzzMep6biU2",
+                "weight": 1
+              }
+            ]
+          }
+        }
+        )=====";
+
+    auto ndvar = fc::json::from_string(newdomain_data);
+    auto nd    = ndvar.as<newdomain>();
+    nd.creator = key;
+    to_variant(nd, ndvar);
+
+    // suspend transaction fails as the same domain is created before it's executed
+    auto strx = signed_transaction();
+    producer.set_transaction_headers(strx, payer, 999'999);
+    strx.actions.push_back(producer.get_action(N(newdomain), N128(trdomain), N128(.create), ndvar.get_object()));
+
+    auto ns     = newsuspend();
+    ns.name     = N128(trsuspend);
+    ns.proposer = key;
+    ns.trx      = strx;
+    to_variant(ns, var);
+    producer.push_action(N(newsuspend), N128(.suspend), N128(trsuspend), var.get_object(), { "evt" }, payer);
+
+    auto as       = aprvsuspend();
+    as.name       = N128(trsuspend);
+    as.signatures = { tester::get_private_key("evt").sign(ns.trx.sig_digest(producer.control->get_chain_id())) };
+    to_variant(as, var);
+    producer.push_action(N(aprvsuspend), N128(.suspend), N128(trsuspend), var.get_object(), { "evt" }, payer);
+    producer.produce_blocks();
+
+    producer.push_action(N(newdomain), N128(trdomain), N128(.create), ndvar.get_object(), { "evt" }, payer);
+
+    auto es     = execsuspend();
+    es.name     = N128(trsuspend);
+    es.executor = key;
+    to_variant(es, var);
+    producer.push_action(N(execsuspend), N128(.suspend), N128(trsuspend), var.get_object(), { "evt" }, payer);
+    producer.produce_blocks();
+
+    auto& tokendb = producer.control->token_db();
+    auto  suspend = suspend_def();
+    READ_TOKEN(suspend, N128(trsuspend), suspend);
+    REQUIRE(suspend.status == suspend_status::failed);
+
+    auto validator = tester(chain.make_config("validator"));
+    auto traces    = std::vector<block_traces_ptr>();
+    validator.control->applied_block_traces.connect([&](auto& bt) {
+        traces.emplace_back(bt);
+    });
+
+    auto main_id       = std::this_thread::get_id();
+    auto mutex         = std::mutex();
+    auto cv            = std::condition_variable();
+    auto async_nums    = std::vector<uint32_t>();
+    auto async_on_main = false;
+    validator.control->applied_block_traces_async.connect([&](auto& bt) {
+        auto lock = std::lock_guard<std::mutex>(mutex);
+        async_nums.emplace_back(bt->block->block_num);
+        async_on_main |= (std::this_thread::get_id() == main_id);
+        cv.notify_all();
+    });
+
+    auto start = validator.control->head_block_num() + 1;
+    chain.sync(validator);
+    REQUIRE(validator.control->head_block_id() == producer.control->head_block_id());
+
+    // traces are in the same order of the receipts in block, the failed ones included
+    auto failed = 0;
+    REQUIRE(traces.size() == producer.control->head_block_num() - start + 1);
+    for(auto& bt : traces) {
+        auto& receipts = bt->block->block->transactions;
+        REQUIRE(bt->traces.size() == receipts.size());
+        for(auto i = 0u; i < receipts.size(); i++) {
+            auto& trace = bt->traces[i];
+            CHECK(trace->id == receipts[i].trx.id());
+            REQUIRE(trace->receipt.has_value());
+            CHECK(trace->receipt->status == receipts[i].status);
+
+            if(receipts[i].status != transaction_receipt::executed) {
+                CHECK(receipts[i].type == transaction_receipt::suspend);
+                CHECK(trace->except.has_value());
+                failed++;
+                continue;
+            }
+
+            // details of actions are kept for the subscribers
+            REQUIRE(!trace->action_traces.empty());
+            CHECK(trace->action_traces[0].trx_id == trace->id);
+            CHECK(trace->action_traces[0].act.name != action_name());
+        }
+    }
+    CHECK(failed == 1);
+
+    // delivered on the traces thread, one by one in order
+    auto lock = std::unique_lock<std::mutex>(mutex);
+    REQUIRE(cv.wait_for(lock, std::chrono::seconds(5), [&] { return async_nums.size() == traces.size(); }));
+    CHECK(!async_on_main);
+    for(auto i = 0u; i < async_nums.size(); i++) {
+        CHECK(async_nums[i] == traces[i]->block->block_num);
+    }
+}
+
+TEST_CASE("lite_trace_test", "[chain]") {
+    auto  chain    = producer_chain("lite_trace_tests");
+    auto& producer = *chain.producer;
+
+    // transactions in pending blocks always get full traces
+    auto trace = chain.push_prodvote(N128(network-charge-factor), 2);
+    REQUIRE(!trace->action_traces.empty());
+    CHECK(trace->action_traces[0].act.name == N(prodvote));
+    producer.produce_blocks();
+
+    // returns whether transactions in blocks are applied with lite traces
+    auto validate = [&](const std::string& name, bool subscribed) {
+        auto validator = tester(chain.make_config(name));
+        auto lite      = std::vector<bool>();
+        auto traces    = std::vector<transaction_trace_ptr>();
+        validator.control->accepted_transaction.connect([&](auto&) {
+            lite.emplace_back(validator.control->lite_trace());
+        });
+        if(subscribed) {
+            validator.control->applied_transaction.connect([&](auto& trace) {
+                traces.emplace_back(trace);
+            });
+        }
+        chain.sync(validator);
+        CHECK(validator.control->head_block_id() == producer.control->head_block_id());
+        CHECK(validator.control->get_global_properties().configuration.base_network_charge_factor == 2);
+        CHECK(!validator.control->lite_trace());
+
+        for(auto& t : traces) {
+            REQUIRE(!t->action_traces.empty());
+            CHECK(t->action_traces[0].trx_id == t->id);
+            CHECK(t->action_traces[0].act.name == N(prodvote));
+        }
+
+        REQUIRE(!lite.empty());
+        return std::all_of(lite.cbegin(), lite.cend(), [](auto l) { return l; });
+    };
+
+    CHECK(validate("lite", false));
+    CHECK(!validate("full", true));
+}
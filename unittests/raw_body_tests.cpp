@@ -0,0 +1,51 @@
+#include <catch/catch.hpp>
+
+#include <evt/chain_plugin/raw_body.hpp>
+
+using namespace evt;
+using namespace evt::chain;
+using namespace evt::chain_apis;
+
+namespace {
+
+packed_transaction
+make_packed_transaction(uint32_t max_charge) {
+    auto trx       = signed_transaction();
+    trx.expiration = fc::time_point_sec(1000);
+    trx.max_charge = max_charge;
+    return packed_transaction(std::move(trx));
+}
+
+template <typename T>
+std::string
+pack_body(const T& v) {
+    auto bytes = fc::raw::pack(v);
+    return std::string(bytes.data(), bytes.size());
+}
+
+}  // namespace
+
+TEST_CASE("raw_body_test", "[chain_apis]") {
+    auto pt1 = make_packed_transaction(100);
+    auto pt2 = make_packed_transaction(200);
+
+    // body is required and not replaced by `{}`
+    CHECK_THROWS_AS(unpack_packed_transaction(""), packed_transaction_type_exception);
+    CHECK_THROWS_AS(unpack_packed_transactions(""), packed_transaction_type_exception);
+    CHECK_THROWS_AS(unpack_packed_transaction("{}"), packed_transaction_type_exception);
+    CHECK_THROWS_AS(unpack_packed_transactions("{}"), packed_transaction_type_exception);
+
+    auto body = pack_body(pt1);
+    CHECK(unpack_packed_transaction(body)->id() == pt1.id());
+    CHECK_THROWS_AS(unpack_packed_transaction(body + '\0'), packed_transaction_type_exception);
+    CHECK_THROWS_AS(unpack_packed_transaction(body.substr(0, body.size() - 1)), packed_transaction_type_exception);
+
+    auto trxs = unpack_packed_transactions(pack_body(fc::unsigned_int(2)) + pack_body(pt1) + pack_body(pt2));
+    REQUIRE(trxs.size() == 2);
+    CHECK(trxs[0]->id() == pt1.id());
+    CHECK(trxs[1]->id() == pt2.id());
+
+    CHECK(unpack_packed_transactions(pack_body(fc::unsigned_int(0))).empty());
+    CHECK_THROWS_AS(unpack_packed_transactions(pack_body(fc::unsigned_int(2)) + pack_body(pt1)), packed_transaction_type_exception);
+    CHECK_THROWS_AS(unpack_packed_transactions(pack_body(fc::unsigned_int(1001))), packed_transaction_type_exception);
+}
@@ -0,0 +1,55 @@
+#include <catch/catch.hpp>
+
+#include <evt/chain_plugin/response_cache.hpp>
+#include <fc/variant_object.hpp>
+
+using namespace evt::chain_apis;
+
+TEST_CASE("response_cache_test", "[cache]") {
+    auto cache = response_cache(1024 * 1024);
+    auto calls = 0;
+    auto value = 1;
+
+    auto render = [&](const std::string& key, uint32_t block_num, uint32_t lib) {
+        return cache.render(key, block_num, lib, [&] {
+            calls++;
+            return fc::mutable_variant_object("block_num", block_num)("value", value);
+        });
+    };
+
+    // blocks at or below lib are rendered once and then served by cache
+    CHECK(render("get_block:10", 10, 10) == R"({"block_num":10,"value":1})");
+    CHECK(calls == 1);
+    value = 2;
+    CHECK(render("get_block:10", 10, 20) == R"({"block_num":10,"value":1})");
+    CHECK(calls == 1);
+    CHECK(cache.get("get_block:10").has_value());
+
+    // ones above lib are rendered every time and not cached
+    CHECK(render("get_block:21", 21, 20) == R"({"block_num":21,"value":2})");
+    value = 3;
+    CHECK(render("get_block:21", 21, 20) == R"({"block_num":21,"value":3})");
+    CHECK(calls == 3);
+    CHECK(!cache.get("get_block:21").has_value());
+
+    // until they become irreversible
+    CHECK(render("get_block:21", 21, 21) == R"({"block_num":21,"value":3})");
+    CHECK(calls == 4);
+    value = 4;
+    CHECK(render("get_block:21", 21, 30) == R"({"block_num":21,"value":3})");
+    CHECK(calls == 4);
+
+    // errors are passed to caller and never cached
+    auto fail = [&] {
+        calls++;
+        FC_THROW("not found");
+        return fc::variant();
+    };
+    CHECK_THROWS_AS(cache.render("get_block:5", 5, 30, fail), fc::exception);
+    CHECK_THROWS_AS(cache.render("get_block:5", 5, 30, fail), fc::exception);
+    CHECK(calls == 6);
+    CHECK(!cache.get("get_block:5").has_value());
+
+    CHECK(render("get_block:5", 5, 30) == R"({"block_num":5,"value":4})");
+    CHECK(calls == 7);
+}
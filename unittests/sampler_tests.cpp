@@ -0,0 +1,90 @@
+#include <catch/catch.hpp>
+
+#include <chrono>
+#include <evt/utilities/sampler.hpp>
+#include <fc/exception/exception.hpp>
+
+using namespace evt::utilities;
+
+#if defined(__linux__)
+
+namespace {
+
+// keeps cpu busy so SIGPROF is delivered
+uint64_t
+burn(std::chrono::milliseconds duration) {
+    auto end = std::chrono::steady_clock::now() + duration;
+    auto x   = uint64_t(0);
+    while(std::chrono::steady_clock::now() < end) {
+        for(auto i = 0; i < 10000; i++) {
+            x = x * 6364136223846793005ull + 1442695040888963407ull;
+        }
+    }
+    return x;
+}
+
+}  // namespace
+
+TEST_CASE("sampler_options_test", "[sampler]") {
+    CHECK_THROWS_AS(sampler::start(0, 100), fc::assert_exception);
+    CHECK_THROWS_AS(sampler::start(1001, 100), fc::assert_exception);
+    CHECK_THROWS_AS(sampler::start(99, 0), fc::assert_exception);
+    CHECK_THROWS_AS(sampler::start(99, 200001), fc::assert_exception);
+    CHECK(!sampler::is_started());
+}
+
+TEST_CASE("sampler_profile_test", "[sampler]") {
+    sampler::start(1000, 100000);
+    CHECK(sampler::is_started());
+    burn(std::chrono::milliseconds(300));
+    sampler::stop();
+    CHECK(!sampler::is_started());
+
+    auto p = sampler::get_profile();
+    CHECK(p.samples > 0);
+    CHECK(p.dropped == 0);
+    CHECK(p.collapsed.find("main;") != std::string::npos);
+
+    // lines are `stack count` and counts add up to the samples
+    auto total = uint64_t(0);
+    auto lines = 0u;
+    auto pos   = size_t(0);
+    while(pos < p.collapsed.size()) {
+        auto end = p.collapsed.find('\n', pos);
+        REQUIRE(end != std::string::npos);
+        auto sp = p.collapsed.rfind(' ', end);
+        REQUIRE(sp != std::string::npos);
+        REQUIRE(sp > pos);
+        total += std::stoull(p.collapsed.substr(sp + 1, end - sp - 1));
+        lines++;
+        pos = end + 1;
+    }
+    CHECK(lines > 0);
+    CHECK(total == p.samples);
+
+    // symbols are cached, so the same profile is got again
+    auto p2 = sampler::get_profile();
+    CHECK(p2.samples == p.samples);
+    CHECK(p2.collapsed == p.collapsed);
+
+    auto p3 = sampler::get_profile({ "net" });
+    CHECK(p3.samples == 0);
+    CHECK(p3.collapsed.empty());
+}
+
+TEST_CASE("sampler_dropped_test", "[sampler]") {
+    sampler::start(1000, 1);
+    burn(std::chrono::milliseconds(100));
+    sampler::stop();
+
+    auto p = sampler::get_profile();
+    CHECK(p.samples == 1);
+    CHECK(p.dropped > 0);
+
+    // samples of previous runs are cleared
+    sampler::start(1000, 10);
+    sampler::stop();
+    CHECK(sampler::get_profile().dropped == 0);
+}
+
+#endif
@@ -0,0 +1,97 @@
+#include <catch/catch.hpp>
+
+#include <evt/net_plugin/snapshot_selection.hpp>
+
+using namespace evt;
+
+namespace {
+
+snapshot_info_message
+make_info(uint32_t block_num, uint64_t size, uint32_t chunk_size = 1024 * 1024) {
+    auto info       = snapshot_info_message();
+    info.block_id   = block_id_type(fc::sha256::hash(std::to_string(block_num)));
+    info.block_id._hash[0] &= 0xffffffff00000000;
+    info.block_id._hash[0] += fc::endian_reverse_u32(block_num);
+    info.size       = size;
+    info.chunk_size = chunk_size;
+    for(auto i = 0u; i < (size + chunk_size - 1) / chunk_size; i++) {
+        info.chunk_hashes.emplace_back(fc::sha256::hash(std::to_string(block_num) + ":" + std::to_string(i)));
+    }
+    return info;
+}
+
+}  // namespace
+
+TEST_CASE("snapshot_info_validate_test", "[snapshot]") {
+    auto info = make_info(100, 3 * 1024 * 1024 + 1);
+    CHECK(block_header::num_from_id(info.block_id) == 100);
+    CHECK(info.chunk_hashes.size() == 4);
+    CHECK(is_valid_snapshot_info(info));
+
+    auto bad = info;
+    bad.chunk_size = 0;
+    CHECK(!is_valid_snapshot_info(bad));
+
+    bad = info;
+    bad.chunk_size = max_snapshot_chunk_size + 1;
+    CHECK(!is_valid_snapshot_info(bad));
+
+    bad = info;
+    bad.size = max_snapshot_size + 1;
+    CHECK(!is_valid_snapshot_info(bad));
+
+    bad = info;
+    bad.size = 0;
+    CHECK(!is_valid_snapshot_info(bad));
+
+    // hashes don't cover the size
+    bad = info;
+    bad.size += 1024 * 1024;
+    CHECK(!is_valid_snapshot_info(bad));
+
+    bad = info;
+    bad.chunk_hashes.pop_back();
+    CHECK(!is_valid_snapshot_info(bad));
+
+    bad = info;
+    bad.block_id = block_id_type();
+    CHECK(!is_valid_snapshot_info(bad));
+}
+
+TEST_CASE("snapshot_select_test", "[snapshot]") {
+    auto old_info = make_info(100, 5 * 1024 * 1024);
+    auto new_info = make_info(200, 6 * 1024 * 1024);
+
+    // newer one advertised by a single peer doesn't reach quorum
+    auto infos = vector<snapshot_info_message>{ old_info, old_info, new_info };
+    auto best  = select_snapshot(infos, 2, block_id_type());
+    REQUIRE(best.has_value());
+    CHECK(best->block_id == old_info.block_id);
+
+    infos.emplace_back(new_info);
+    best = select_snapshot(infos, 2, block_id_type());
+    REQUIRE(best.has_value());
+    CHECK(best->block_id == new_info.block_id);
+
+    // only the trusted one is selected
+    best = select_snapshot(infos, 2, old_info.block_id);
+    REQUIRE(best.has_value());
+    CHECK(best->block_id == old_info.block_id);
+    CHECK(!select_snapshot(infos, 2, make_info(300, 1024).block_id).has_value());
+    CHECK(!select_snapshot(infos, 3, block_id_type()).has_value());
+
+    // peers lying about the hashes of the same block are counted apart
+    auto forged = new_info;
+    forged.chunk_hashes[0] = fc::sha256::hash(std::string("forged"));
+    infos = { new_info, forged, forged };
+    best  = select_snapshot(infos, 2, new_info.block_id);
+    REQUIRE(best.has_value());
+    CHECK(is_same_snapshot(*best, forged));
+    CHECK(!select_snapshot(infos, 3, new_info.block_id).has_value());
+
+    // invalid ones are never selected whatever the votes are
+    auto invalid = new_info;
+    invalid.size = max_snapshot_size + 1;
+    infos = { invalid, invalid, invalid };
+    CHECK(!select_snapshot(infos, 1, block_id_type()).has_value());
+}
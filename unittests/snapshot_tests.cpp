@@ -1,15 +1,20 @@
+#include <fstream>
+#include <map>
 #include <sstream>
 
 #include <catch/catch.hpp>
+#include <fmt/format.h>
 #include <fc/filesystem.hpp>
 
 #include <evt/chain/token_database.hpp>
 #include <evt/chain/token_database_snapshot.hpp>
 #include <evt/chain/contracts/types.hpp>
+#include <evt/testing/tester.hpp>
 
 using namespace evt;
 using namespace chain;
 using namespace contracts;
+using namespace evt::testing;
 
 extern std::string evt_unittests_dir;
 
@@ -113,3 +118,267 @@ TEST_CASE("snapshot_load_test", "[snapshot]") {
     CHECK(EXISTS_ASSET(addr, 3));
     CHECK(EXISTS_TOKEN(domain, "snapshot-domain"));
 }
+
+TEST_CASE("snapshot_zstd_test", "[snapshot]") {
+    auto tokendb = token_database(get_db_config());
+    tokendb.open();
+
+    auto ss     = std::stringstream();
+    auto writer = std::make_shared<zstd_snapshot_writer>(ss);
+    CHECK(writer->concurrent());
+
+    token_database_snapshot::add_to_snapshot(writer, tokendb);
+    writer->finalize();
+
+    tokendb.add_savepoint(tokendb.latest_savepoint_seq() + 1);
+
+    // old format is still read by the reader chosen by magic number
+    auto os = std::stringstream(token_db_snapshot_);
+    CHECK(!make_snapshot_reader(os)->concurrent());
+
+    auto rs     = std::stringstream(ss.str());
+    auto reader = make_snapshot_reader(rs);
+    REQUIRE(reader->concurrent());
+    reader->validate();
+
+    token_database_snapshot::read_from_snapshot(reader, tokendb);
+
+    REQUIRE(tokendb.savepoints_size() == 0);
+    CHECK(EXISTS_TOKEN(domain, "dm-tkdb-test"));
+    CHECK(EXISTS_TOKEN2(token, "dm-tkdb-test", "basic-1"));
+    CHECK(EXISTS_TOKEN2(token, "dm-tkdb-test", "basic-2"));
+    CHECK(EXISTS_TOKEN(domain, "snapshot-domain"));
+
+    auto addr = public_key_type(std::string("EVT8MGU4aKiVzqMtWi9zLpu8KuTHZWjQQrX475ycSxEkLd6aBpraX"));
+    CHECK(EXISTS_ASSET(addr, 3));
+}
+
+TEST_CASE("snapshot_zstd_instances_test", "[snapshot]") {
+    // sections of different snapshots are written and read by the same thread one inside another
+    const char rows[] = "abcdefgh";
+
+    auto ss1 = std::stringstream(), ss2 = std::stringstream();
+    auto w1  = std::make_shared<zstd_snapshot_writer>(ss1);
+    auto w2  = std::make_shared<zstd_snapshot_writer>(ss2);
+    w1->write_section("outer", [&](auto& section) {
+        section.add_row(rows, 4);
+        w2->write_section("inner", [&](auto& inner) {
+            inner.add_row(rows + 4, 4);
+        });
+        section.add_row(rows + 2, 4);
+    });
+    w1->finalize();
+    w2->finalize();
+
+    auto rs1 = std::stringstream(ss1.str()), rs2 = std::stringstream(ss2.str());
+    auto r1  = make_snapshot_reader(rs1);
+    auto r2  = make_snapshot_reader(rs2);
+    r1->read_section("outer", [&](auto& section) {
+        char buf[4];
+        CHECK(section.read_row(buf, sizeof(buf)));
+        CHECK(std::string(buf, 4) == "abcd");
+
+        r2->read_section("inner", [&](auto& inner) {
+            char ibuf[4];
+            CHECK(!inner.read_row(ibuf, sizeof(ibuf)));
+            CHECK(std::string(ibuf, 4) == "efgh");
+            CHECK(inner.eof());
+        });
+
+        CHECK(!section.eof());
+        CHECK(!section.read_row(buf, sizeof(buf)));
+        CHECK(std::string(buf, 4) == "cdef");
+    });
+}
+
+TEST_CASE("snapshot_sections_test", "[snapshot]") {
+    auto make_config = [](const std::string& name) {
+        auto c               = token_database::config();
+        c.db_path            = evt_unittests_dir + "/tokendb_tests/" + name;
+        c.enable_owner_index = true;
+        fc::remove_all(c.db_path);
+        return c;
+    };
+
+    // more domains and symbols than the sections in flight so the workers are reused
+    const auto kDomains = 40, kTokens = 8, kSymbols = 40;
+
+    auto tokendb = token_database(make_config("snapshot_sections_src"));
+    tokendb.open();
+
+    auto keys  = std::vector<public_key_type>{ tester::get_public_key(N(snapshot1)), tester::get_public_key(N(snapshot2)) };
+    auto addrs = std::vector<address>{ address(keys[0]), address(N(.domain), name128("snapshot"), 1), address() };
+
+    for(auto i = 0; i < kDomains; i++) {
+        auto d = domain_def();
+        d.name = fmt::format("sections-{}", i);
+        PUT_DB_TOKEN(domain, std::nullopt, d.name, d);
+
+        for(auto j = 0; j < kTokens; j++) {
+            auto t = token_def(d.name, fmt::format("t{}", j), { address(keys[j % 2]) });
+            PUT_DB_TOKEN(token, d.name, t.name, t);
+        }
+    }
+    for(auto i = 0; i < kSymbols; i++) {
+        auto id = (symbol_id_type)(1000 + i);
+        auto fg = fungible_def();
+        fg.sym  = symbol(5, id);
+        PUT_DB_TOKEN(fungible, std::nullopt, name128(id), fg);
+
+        // generated and reserved addresses are not public keys, their keys should be kept as they're
+        for(auto k = 0u; k < addrs.size(); k++) {
+            auto dv = make_db_value(asset(i * 10 + k, fg.sym));
+            tokendb.put_asset(addrs[k], id, dv.as_string_view());
+        }
+    }
+
+    auto dump = [&](auto& db) {
+        auto rows = std::map<std::string, std::string>();
+        for(auto i = 0; i < kDomains; i++) {
+            auto d = domain_name(fmt::format("sections-{}", i));
+            db.read_tokens_range(token_type::token, d, 0, [&](auto& key, auto&& v) {
+                rows.emplace(d.to_string() + std::string(key), std::move(v));
+                return true;
+            });
+        }
+        for(auto i = 0; i < kSymbols; i++) {
+            auto id = (symbol_id_type)(1000 + i);
+            db.read_assets_range(id, 0, [&](auto& key, auto&& v) {
+                rows.emplace(std::to_string(id) + std::string(key), std::move(v));
+                return true;
+            });
+        }
+        return rows;
+    };
+
+    auto expected = dump(tokendb);
+    REQUIRE(expected.size() == kDomains * kTokens + kSymbols * addrs.size());
+
+    auto check_restored = [&](auto& ss) {
+        auto db = token_database(make_config("snapshot_sections_dst"));
+        db.open();
+
+        auto rs     = std::stringstream(ss.str());
+        auto reader = make_snapshot_reader(rs);
+        reader->validate();
+        token_database_snapshot::read_from_snapshot(reader, db);
+
+        CHECK(dump(db) == expected);
+        for(auto& addr : addrs) {
+            auto n = db.read_assets_by_address(addr, [](auto) { return true; });
+            CHECK(n == kSymbols);
+        }
+        CHECK(db.read_tokens_by_owner(address(keys[0]), std::nullopt, [](auto&, auto&) { return true; }) == kDomains * kTokens / 2);
+    };
+
+    // sections written in order by the pipeline and read sequentially
+    auto ss      = std::stringstream();
+    auto owriter = std::make_shared<ostream_snapshot_writer>(ss);
+    token_database_snapshot::add_to_snapshot(owriter, tokendb);
+    owriter->finalize();
+    check_restored(ss);
+
+    // sections written and read concurrently
+    auto zs      = std::stringstream();
+    auto zwriter = std::make_shared<zstd_snapshot_writer>(zs);
+    token_database_snapshot::add_to_snapshot(zwriter, tokendb);
+    zwriter->finalize();
+    check_restored(zs);
+}
+
+TEST_CASE("snapshot_delta_test", "[snapshot]") {
+    auto tokendb = token_database(get_db_config());
+    tokendb.open();
+
+    REQUIRE(tokendb.savepoints_size() == 0);
+
+    auto dir = fc::path(evt_unittests_dir + "/snapshot_delta");
+    fc::remove_all(dir);
+    fc::create_directories(dir);
+
+    auto write_file = [&](const std::string& name, auto&& add) {
+        auto out    = std::ofstream((dir / name).generic_string(), (std::ios::out | std::ios::binary));
+        auto writer = std::make_shared<ostream_snapshot_writer>(out);
+        add(writer);
+        writer->finalize();
+    };
+    auto write_delta = [&](const std::string& name, const std::string& base_name) {
+        auto in   = std::ifstream((dir / base_name).generic_string(), (std::ios::in | std::ios::binary));
+        auto base = make_snapshot_reader(in);
+        write_file(name, [&](auto writer) {
+            token_database_snapshot::add_delta_to_snapshot(writer, tokendb, base, base_name);
+        });
+    };
+
+    write_file("snapshot-base.bin", [&](auto writer) {
+        token_database_snapshot::add_to_snapshot(writer, tokendb);
+    });
+
+    // written into db directly without savepoints
+    auto d = domain_def();
+    d.name = "delta-domain1";
+    PUT_DB_TOKEN(domain, std::nullopt, d.name, d);
+
+    write_delta("snapshot-delta1.bin", "snapshot-base.bin");
+
+    // only in write cache
+    tokendb.add_savepoint(tokendb.latest_savepoint_seq() + 1);
+    d.name = "delta-domain2";
+    PUT_DB_TOKEN(domain, std::nullopt, d.name, d);
+
+    write_delta("snapshot-delta2.bin", "snapshot-delta1.bin");
+
+    tokendb.rollback_to_latest_savepoint();
+    CHECK(EXISTS_TOKEN(domain, "delta-domain1"));
+    CHECK(!EXISTS_TOKEN(domain, "delta-domain2"));
+
+    // base and the chain of deltas are applied in order
+    auto in     = std::ifstream((dir / "snapshot-delta2.bin").generic_string(), (std::ios::in | std::ios::binary));
+    auto reader = make_snapshot_reader(in);
+    reader->validate();
+
+    token_database_snapshot::read_from_snapshot(reader, tokendb, dir);
+
+    REQUIRE(tokendb.savepoints_size() == 0);
+    CHECK(EXISTS_TOKEN(domain, "dm-tkdb-test"));
+    CHECK(EXISTS_TOKEN2(token, "dm-tkdb-test", "basic-1"));
+    CHECK(EXISTS_TOKEN(domain, "delta-domain1"));
+    CHECK(EXISTS_TOKEN(domain, "delta-domain2"));
+}
+
+TEST_CASE("snapshot_file_name_test", "[snapshot]") {
+    auto tokendb = token_database(get_db_config());
+    tokendb.open();
+
+    auto dir = fc::path(evt_unittests_dir + "/snapshot_names");
+    fc::remove_all(dir);
+    fc::create_directories(dir);
+
+    auto write_file = [&](const std::string& name, const char* section, const std::string& file_name) {
+        auto out    = std::ofstream((dir / name).generic_string(), (std::ios::out | std::ios::binary));
+        auto writer = std::make_shared<ostream_snapshot_writer>(out);
+        writer->write_section(section, [&](auto& w) {
+            w.add_row(file_name);
+            if(std::string(section) == ".tokendb-delta") {
+                w.add_row(uint64_t(0));
+            }
+        });
+        writer->finalize();
+    };
+    auto read_file = [&](const std::string& name) {
+        auto in     = std::ifstream((dir / name).generic_string(), (std::ios::in | std::ios::binary));
+        auto reader = make_snapshot_reader(in);
+        reader->validate();
+        token_database_snapshot::read_from_snapshot(reader, tokendb, dir);
+    };
+
+    // checkpoints and bases of deltas out of the snapshot dir are refused before anything is touched
+    for(auto& name : { std::string("../tokendb"), std::string("/tmp"), std::string(".."), std::string(), std::string("a/b") }) {
+        write_file("snapshot-checkpoint.bin", ".tokendb-checkpoint", name);
+        CHECK_THROWS_AS(read_file("snapshot-checkpoint.bin"), token_database_snapshot_exception);
+
+        write_file("snapshot-delta.bin", ".tokendb-delta", name);
+        CHECK_THROWS_AS(read_file("snapshot-delta.bin"), token_database_snapshot_exception);
+    }
+    CHECK(tokendb.exists_token(token_type::domain, std::nullopt, "dm-tkdb-test"));
+}
@@ -1,4 +1,5 @@
 #include "tokendb_tests.hpp"
+#include <set>
 
 const char* domain_data = R"=====(
     {
@@ -29,12 +30,7 @@ const char* domain_data = R"=====(
             "weight": 1
           }
         ]
-      },
-      "metas":[{
-      	"key": "key",
-      	"value": "value",
-      	"creator": "[A] EVT546WaW3zFAxEEEkYKjDiMvg3CHRjmWX2XdNxEhi69RpdKuQRSK"
-      }]
+      }
     }
     )=====";
 
@@ -44,12 +40,7 @@ const char* token_data = R"=====(
         "name": "t1",
         "owner": [
           "EVT546WaW3zFAxEEEkYKjDiMvg3CHRjmWX2XdNxEhi69RpdKuQRSK"
-        ],
-        "metas":[{
-      	"key": "key",
-      	"value": "value",
-      	"creator": "[A] EVT546WaW3zFAxEEEkYKjDiMvg3CHRjmWX2XdNxEhi69RpdKuQRSK"
-      }]
+        ]
     }
     )=====";
 
@@ -117,26 +108,24 @@ TEST_CASE_METHOD(tokendb_test, "upd_token_test", "[tokendb]") {
     // token_type : domain(non-token)
     CHECK(EXISTS_TOKEN(domain, "dm-tkdb-test"));
     READ_TOKEN(domain, "dm-tkdb-test", dom);
-    CHECK(dom.metas[0].key == "key");
-    dom.metas[0].key = "key-tkdb-test";
-    //dom.metas[0].key = "ky";
+    CHECK(dom.manage.threshold == 1);
+    dom.manage.threshold = 2;
     
     UPDATE_TOKEN(domain, "dm-tkdb-test", dom);
     
     READ_TOKEN(domain, "dm-tkdb-test", dom);
-    CHECK(dom.metas[0].key == "key-tkdb-test");
-    //CHECK(dom.metas[0].key == "ky");
+    CHECK(dom.manage.threshold == 2);
 
     // token_type : token
     CHECK(EXISTS_TOKEN2(token, "dm-tkdb-test", "t1"));
     READ_TOKEN2(token, "dm-tkdb-test", "t1", tk);
-    CHECK(tk.metas[0].key == "key");
-    tk.metas[0].key = "key-tkdb-test";
+    CHECK(tk.owner.size() == 1);
+    tk.owner.emplace_back(address());
     
     UPDATE_TOKEN2(token, "dm-tkdb-test", "t1", tk);
     
     READ_TOKEN2(token, "dm-tkdb-test", "t1", tk);
-    CHECK(tk.metas[0].key == "key-tkdb-test");
+    CHECK(tk.owner.size() == 2);
 }
 
 TEST_CASE_METHOD(tokendb_test, "put_token_test", "[tokendb]") {
@@ -169,20 +158,20 @@ TEST_CASE_METHOD(tokendb_test, "put_token_test", "[tokendb]") {
     // ** token_type : domain(non-token)
     auto _dom = domain_def();
     READ_TOKEN(domain, "dm-tkdb-test1", _dom);
-    CHECK(_dom.metas[0].key == "key");
-    _dom.metas[0].key = "key-tkdb-test1";
+    CHECK(_dom.manage.threshold == 1);
+    _dom.manage.threshold = 3;
     PUT_TOKEN(domain, "dm-tkdb-test1", _dom);
     READ_TOKEN(domain, "dm-tkdb-test1", _dom);
-    CHECK(_dom.metas[0].key == "key-tkdb-test1");
+    CHECK(_dom.manage.threshold == 3);
 
     // ** token_type : token
     auto _tk = token_def();
     READ_TOKEN2(token, "dm-tkdb-test1", "t2", _tk);
-    CHECK(_tk.metas[0].key == "key");
-    _tk.metas[0].key = "t2-meta";
+    CHECK(_tk.owner.size() == 1);
+    _tk.owner.emplace_back(address());
     PUT_TOKEN2(token, _tk.domain, _tk.name, _tk);
     READ_TOKEN2(token, "dm-tkdb-test1", "t2", _tk);
-    CHECK(_tk.metas[0].key == "t2-meta");
+    CHECK(_tk.owner.size() == 2);
 }
 
 TEST_CASE_METHOD(tokendb_test, "put_asset_test", "[tokendb]") {
@@ -221,9 +210,12 @@ TEST_CASE_METHOD(tokendb_test, "put_tokens_test", "[tokendb]") {
     tkeys.push_back(tk1.name);
     tkeys.push_back(tk2.name);
     
+    // views should not outlive values
+    auto v1   = evt::chain::make_db_value(tk1);
+    auto v2   = evt::chain::make_db_value(tk2);
     auto data = small_vector<std::string_view, 4>();
-    data.push_back(evt::chain::make_db_value(tk1).as_string_view());
-    data.push_back(evt::chain::make_db_value(tk2).as_string_view());
+    data.push_back(v1.as_string_view());
+    data.push_back(v2.as_string_view());
 
     tokendb.put_tokens(
             evt::chain::token_type::token,
@@ -235,3 +227,238 @@ TEST_CASE_METHOD(tokendb_test, "put_tokens_test", "[tokendb]") {
     CHECK(EXISTS_TOKEN2(token, "dm-tkdb-test", "basic-1"));
     CHECK(EXISTS_TOKEN2(token, "dm-tkdb-test", "basic-2"));
 }
+
+TEST_CASE_METHOD(tokendb_test, "read_tokens_range_test", "[tokendb]") {
+    auto& tokendb = my_tester->control->token_db();
+
+    auto get_name = [](auto& key) {
+        auto n = name128();
+        memcpy(&n, key.data(), sizeof(n));
+        return n;
+    };
+
+    // collect names through skip
+    auto names = std::vector<name128>();
+    tokendb.read_tokens_range(token_type::token, "dm-tkdb-test", 0, [&](auto& key, auto&& value) {
+        names.emplace_back(get_name(key));
+        return true;
+    });
+    CHECK(names.size() >= 3);
+
+    // page through cursor, one token per page
+    auto names2 = std::vector<name128>();
+    auto start  = std::optional<name128>();
+    while(true) {
+        auto c = tokendb.read_tokens_range(token_type::token, "dm-tkdb-test", start, [&](auto& key, auto&& value) {
+            start = get_name(key);
+            names2.emplace_back(*start);
+            return false;
+        });
+        if(c == 0) {
+            break;
+        }
+    }
+    CHECK(names == names2);
+}
+
+TEST_CASE_METHOD(tokendb_test, "metrics_test", "[tokendb]") {
+    auto& tokendb = my_tester->control->token_db();
+
+    auto m1 = tokendb.metrics();
+    REQUIRE(m1.types.size() == (int)token_type::max_value + 1);
+    CHECK(m1.types[(int)token_type::domain].type == "domain");
+
+    auto var = fc::json::from_string(domain_data);
+    auto dom = var.as<domain_def>();
+    dom.name = "domain-metrics";
+    PUT_TOKEN(domain, dom.name, dom);
+    CHECK(EXISTS_TOKEN(domain, dom.name));
+
+    auto str = std::string();
+    tokendb.read_token(token_type::domain, std::nullopt, dom.name, str);
+
+    auto m2  = tokendb.metrics();
+    auto& t1 = m1.types[(int)token_type::domain];
+    auto& t2 = m2.types[(int)token_type::domain];
+    CHECK(t2.writes == t1.writes + 1);
+    CHECK(t2.exists == t1.exists + 1);
+    CHECK(t2.reads == t1.reads + 1);
+    CHECK(t2.read_bytes == t1.read_bytes + str.size());
+}
+
+TEST_CASE_METHOD(tokendb_test, "prefetch_test", "[tokendb]") {
+    auto& tokendb = my_tester->control->token_db();
+
+    auto keys = prefetch_keys_t();
+    keys.tokens.emplace_back(token_type::domain, std::nullopt, "dm-tkdb-test");
+    keys.tokens.emplace_back(token_type::token, "dm-tkdb-test", "basic-1");
+    keys.tokens.emplace_back(token_type::domain, std::nullopt, "domain-not-existed");
+    keys.assets.emplace_back(key, EVT_SYM_ID);
+
+    // prefetch doesn't count as reads and missing keys are ignored
+    auto m1 = tokendb.metrics();
+    auto f  = std::async(std::launch::async, [&] { tokendb.prefetch(keys); });
+    CHECK_NOTHROW(f.get());
+    auto m2 = tokendb.metrics();
+    CHECK(m2.types[(int)token_type::domain].reads == m1.types[(int)token_type::domain].reads);
+
+    CHECK(EXISTS_TOKEN(domain, "dm-tkdb-test"));
+    CHECK(!EXISTS_TOKEN(domain, "domain-not-existed"));
+}
+
+TEST_CASE_METHOD(tokendb_test, "fast_writes_test", "[tokendb]") {
+    auto& tokendb = my_tester->control->token_db();
+
+    auto var = fc::json::from_string(domain_data);
+    auto dom = var.as<domain_def>();
+    dom.name = "dm-tkdb-fast";
+
+    tokendb.set_fast_writes(true);
+    PUT_TOKEN(domain, dom.name, dom);
+    CHECK(EXISTS_TOKEN(domain, dom.name));
+
+    // memtables are flushed when wal is back
+    CHECK_NOTHROW(tokendb.set_fast_writes(false));
+    CHECK(EXISTS_TOKEN(domain, dom.name));
+
+    auto dom2 = domain_def();
+    READ_TOKEN(domain, dom.name, dom2);
+    CHECK(dom2.name == dom.name);
+}
+
+TEST_CASE("format_test", "[tokendb]") {
+    auto cfg    = token_database::config();
+    cfg.db_path = fresh_db_path("tokendb_format");
+
+    auto dom = fc::json::from_string(domain_data).as<domain_def>();
+    dom.name = "domain-format";
+    {
+        auto tokendb = token_database(cfg);
+        tokendb.open();
+        PUT_TOKEN(domain, dom.name, dom);
+    }
+
+    auto format_file = cfg.db_path / config::token_database_format_filename;
+    REQUIRE(fc::exists(format_file));
+
+    auto write_format = [&](const char* version) {
+        auto fs = std::ofstream(format_file.to_native_ansi_path(), std::ios::out | std::ios::trunc);
+        fs << version;
+    };
+
+    // databases of older versions have no format file and they're refused
+    fc::remove(format_file);
+    {
+        auto tokendb = token_database(cfg);
+        CHECK_THROWS_AS(tokendb.open(), token_database_format_exception);
+    }
+
+    write_format("1");
+    {
+        auto tokendb = token_database(cfg);
+        CHECK_THROWS_AS(tokendb.open(), token_database_format_exception);
+    }
+
+    write_format("2");
+    {
+        auto tokendb = token_database(cfg);
+        tokendb.open();
+        CHECK(EXISTS_TOKEN(domain, dom.name));
+    }
+
+    // format is kept in checkpoints
+    auto cp_dir = fresh_db_path("tokendb_format_cp");
+    {
+        auto tokendb = token_database(cfg);
+        tokendb.open();
+        tokendb.create_checkpoint(cp_dir);
+        tokendb.restore_checkpoint(cp_dir);
+        CHECK(EXISTS_TOKEN(domain, dom.name));
+    }
+    CHECK(fc::exists(fc::path(cp_dir) / config::token_database_format_filename));
+}
+
+TEST_CASE("owner_index_test", "[tokendb]") {
+    auto cfg    = token_database::config();
+    cfg.db_path = fresh_db_path("tokendb_owners");
+
+    auto a1 = address(tester::get_public_key(N(owner1)));
+    auto a2 = address(tester::get_public_key(N(owner2)));
+
+    // pairs of domain and name
+    using tokens_t = std::set<std::pair<name128, name128>>;
+
+    auto make_token = [](const name128& domain, const name128& name, const address_list& owner) {
+        return token_def(domain, name, owner);
+    };
+    auto owned = [](auto& tokendb, const address& addr, const std::optional<name128>& domain) {
+        auto tokens = tokens_t();
+        tokendb.read_tokens_by_owner(addr, domain, [&](auto& d, auto& n) {
+            tokens.emplace(d, n);
+            return true;
+        });
+        return tokens;
+    };
+
+    // tokens put before the index is enabled
+    {
+        auto tokendb = token_database(cfg);
+        tokendb.open();
+        PUT_TOKEN2(token, N128(dom1), N128(t1), make_token(N128(dom1), N128(t1), { a1 }));
+        CHECK_THROWS_AS(owned(tokendb, a1, std::nullopt), token_database_exception);
+    }
+
+    // are indexed when it's enabled
+    cfg.enable_owner_index = true;
+    {
+        auto tokendb = token_database(cfg);
+        tokendb.open();
+        CHECK(owned(tokendb, a1, std::nullopt) == tokens_t{ { N128(dom1), N128(t1) } });
+        CHECK(owned(tokendb, a2, std::nullopt).empty());
+
+        // tokens of many owners and issued in batch
+        auto t2   = make_token(N128(dom2), N128(t2), { a1, a2 });
+        auto t3   = make_token(N128(dom2), N128(t3), { a2 });
+        auto v2   = make_db_value(t2);
+        auto v3   = make_db_value(t3);
+        auto keys = token_keys_t{ N128(t2), N128(t3) };
+        auto data = small_vector<std::string_view, 4>{ v2.as_string_view(), v3.as_string_view() };
+        tokendb.put_tokens(token_type::token, action_op::add, N128(dom2), std::move(keys), data);
+
+        CHECK(owned(tokendb, a1, std::nullopt) == tokens_t{ { N128(dom1), N128(t1) }, { N128(dom2), N128(t2) } });
+        CHECK(owned(tokendb, a1, N128(dom2)) == tokens_t{ { N128(dom2), N128(t2) } });
+        CHECK(owned(tokendb, a2, N128(dom2)) == tokens_t{ { N128(dom2), N128(t2) }, { N128(dom2), N128(t3) } });
+        CHECK(owned(tokendb, a2, N128(dom1)).empty());
+
+        // transfers only move the owners changed and they're restored by rollback
+        tokendb.add_savepoint(1);
+        UPDATE_TOKEN2(token, N128(dom1), N128(t1), make_token(N128(dom1), N128(t1), { a2 }));
+        UPDATE_TOKEN2(token, N128(dom2), N128(t2), make_token(N128(dom2), N128(t2), { a2 }));
+        CHECK(owned(tokendb, a1, std::nullopt).empty());
+        CHECK(owned(tokendb, a2, std::nullopt) == tokens_t{ { N128(dom1), N128(t1) }, { N128(dom2), N128(t2) }, { N128(dom2), N128(t3) } });
+
+        ROLLBACK();
+        CHECK(owned(tokendb, a1, std::nullopt) == tokens_t{ { N128(dom1), N128(t1) }, { N128(dom2), N128(t2) } });
+        CHECK(owned(tokendb, a2, std::nullopt) == tokens_t{ { N128(dom2), N128(t2) }, { N128(dom2), N128(t3) } });
+
+        // reading stops when func returns false
+        auto n = tokendb.read_tokens_by_owner(a2, std::nullopt, [](auto&, auto&) { return false; });
+        CHECK(n == 1);
+    }
+
+    // dropped when disabled, and rebuilt from tokens when enabled again
+    cfg.enable_owner_index = false;
+    {
+        auto tokendb = token_database(cfg);
+        tokendb.open();
+        PUT_TOKEN2(token, N128(dom1), N128(t1), make_token(N128(dom1), N128(t1), { a2 }));
+        CHECK_THROWS_AS(owned(tokendb, a2, std::nullopt), token_database_exception);
+    }
+    cfg.enable_owner_index = true;
+    {
+        auto tokendb = token_database(cfg);
+        tokendb.open();
+        CHECK(owned(tokendb, a1, std::nullopt) == tokens_t{ { N128(dom2), N128(t2) } });
+        CHECK(owned(tokendb, a2, N128(dom1)) == tokens_t{ { N128(dom1), N128(t1) } });
+    }
+}
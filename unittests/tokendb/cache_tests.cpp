@@ -29,10 +29,54 @@ TEST_CASE_METHOD(tokendb_test, "cache_test", "[tokendb]") {
         CHECK_EQUAL(dom, *dom2);
         CHECK_EQUAL(tk, *tk2);
 
+        auto dom3 = domain_def();
+        CHECK(tokendb.read_token(token_type::domain, std::nullopt, "dm-tkdb-test", [&](auto& v) { extract_db_value(v, dom3); }));
+        CHECK_EQUAL(dom, dom3);
+        CHECK(!tokendb.read_token(token_type::domain, std::nullopt, "dm-tkdb-test123", [](auto& v) {}, true));
+
         CHECK_THROWS_AS(cache.read_token<domain_def>(token_type::domain, std::nullopt, "dm-tkdb-test123"), unknown_token_database_key);
         CHECK(cache.read_token<domain_def>(token_type::domain, std::nullopt, "dm-tkdb-test123", true) == nullptr);
 
         CHECK_THROWS_AS(cache.read_token<token_def>(token_type::domain, std::nullopt, "dm-tkdb-test"), token_database_cache_exception);
+
+        CHECK(tokendb.try_read_token(token_type::domain, std::nullopt, "dm-tkdb-test", [](auto& v) {}) == read_status::found);
+        CHECK(tokendb.try_read_token(token_type::domain, std::nullopt, "dm-tkdb-test123", [](auto& v) {}) == read_status::not_found);
+
+        auto r1 = cache.try_read_token<domain_def>(token_type::domain, std::nullopt, "dm-tkdb-test");
+        CHECK(r1.found());
+        CHECK(r1.value.get() == dom2.get());
+
+        // the second lookup of miss is served by cache
+        for(auto i = 0; i < 2; i++) {
+            auto r2 = cache.try_read_token<domain_def>(token_type::domain, std::nullopt, "dm-tkdb-test123");
+            CHECK(!r2.found());
+            CHECK(r2.value == nullptr);
+        }
+    }
+
+    SECTION("batch_read_test") {
+        auto tk = token_def();
+        READ_TOKEN2(token, "dm-tkdb-test", "t1", tk);
+
+        auto keys = small_vector<name128, 4>{ "t1", "t-not-exists", "t1" };
+        auto strs = token_values_t();
+        CHECK(tokendb.read_tokens(token_type::token, "dm-tkdb-test", keys, strs, true) == 2);
+        REQUIRE(strs.size() == 3);
+        CHECK(!strs[0].empty());
+        CHECK(strs[1].empty());
+        CHECK(strs[0] == strs[2]);
+        CHECK_THROWS_AS(tokendb.read_tokens(token_type::token, "dm-tkdb-test", keys, strs), unknown_token_database_key);
+
+        auto tks = cache.read_tokens<token_def>(token_type::token, "dm-tkdb-test", keys, true);
+        REQUIRE(tks.size() == 3);
+        CHECK(tks[0] != nullptr);
+        CHECK(tks[1] == nullptr);
+        CHECK(tks[0].get() == tks[2].get());
+        CHECK_EQUAL(tk, *tks[0]);
+
+        auto tk2 = cache.lookup_token<token_def>(token_type::token, "dm-tkdb-test", "t1");
+        CHECK(tk2.get() == tks[0].get());
+        CHECK_THROWS_AS(cache.read_tokens<token_def>(token_type::token, "dm-tkdb-test", keys), unknown_token_database_key);
     }
 
     SECTION("write_test") {
@@ -87,4 +131,93 @@ TEST_CASE_METHOD(tokendb_test, "cache_test", "[tokendb]") {
         CHECK(cache.lookup_token<domain_def>(token_type::domain, std::nullopt, "dm-tkdb-cache-2") == nullptr);
         CHECK_THROWS_AS(cache.read_token<domain_def>(token_type::domain, std::nullopt, "dm-tkdb-cache-2") == nullptr, unknown_token_database_key);
     }
+
+    SECTION("miss_test") {
+        auto s = tokendb.new_savepoint_session();
+
+        auto var = fc::json::from_string(domain_data);
+        auto dom = var.as<domain_def>();
+
+        // miss is cached and cleared when token is put into db directly
+        CHECK(!cache.exists_token(token_type::domain, std::nullopt, "dm-tkdb-miss"));
+        CHECK(cache.read_token<domain_def>(token_type::domain, std::nullopt, "dm-tkdb-miss", true) == nullptr);
+        PUT_TOKEN(domain, "dm-tkdb-miss", dom);
+        CHECK(cache.exists_token(token_type::domain, std::nullopt, "dm-tkdb-miss"));
+        CHECK(cache.read_token<domain_def>(token_type::domain, std::nullopt, "dm-tkdb-miss", true) != nullptr);
+
+        // not existed anymore after rollback
+        s.undo();
+        CHECK(!cache.exists_token(token_type::domain, std::nullopt, "dm-tkdb-miss"));
+
+        auto keys = small_vector<name128, 4>{ "t1", "t-miss", "t1" };
+        auto rs   = cache.exists_tokens(token_type::token, "dm-tkdb-test", keys);
+        REQUIRE(rs.size() == 3);
+        CHECK(rs[0]);
+        CHECK(!rs[1]);
+        CHECK(rs[2]);
+        CHECK(!cache.exists_token(token_type::token, "dm-tkdb-test", "t-miss"));
+    }
+
+    SECTION("write_back_test") {
+        auto wb  = token_database_cache(tokendb, 1024 * 1024, true /* write back */);
+        auto var = fc::json::from_string(domain_data);
+
+        {
+            auto s = tokendb.new_savepoint_session();
+
+            auto dom = var.as<domain_def>();
+            wb.put_token(token_type::domain, action_op::add, std::nullopt, "dm-tkdb-wb", dom);
+            CHECK(!EXISTS_TOKEN(domain, "dm-tkdb-wb"));
+            CHECK(wb.exists_token(token_type::domain, std::nullopt, "dm-tkdb-wb"));
+
+            auto dom2 = wb.lookup_token<domain_def>(token_type::domain, std::nullopt, "dm-tkdb-wb");
+            REQUIRE(dom2 != nullptr);
+            dom2->creator = public_key_type();
+            wb.put_token(token_type::domain, action_op::update, std::nullopt, "dm-tkdb-wb", *dom2);
+            CHECK(wb.dirty_size() == 1);
+
+            // packed and written once when savepoint is squashed
+            s.squash();
+            CHECK(wb.dirty_size() == 0);
+
+            auto dom3 = domain_def();
+            READ_TOKEN(domain, "dm-tkdb-wb", dom3);
+            CHECK(dom3.creator == public_key_type());
+        }
+
+        {
+            auto s = tokendb.new_savepoint_session();
+
+            auto dom = var.as<domain_def>();
+            wb.put_token(token_type::domain, action_op::add, std::nullopt, "dm-tkdb-wb2", dom);
+            CHECK(wb.dirty_size() == 1);
+
+            // dropped without being written
+            s.undo();
+            CHECK(wb.dirty_size() == 0);
+            CHECK(wb.lookup_token<domain_def>(token_type::domain, std::nullopt, "dm-tkdb-wb2") == nullptr);
+            CHECK(!EXISTS_TOKEN(domain, "dm-tkdb-wb2"));
+        }
+    }
+
+    SECTION("hot_keys_test") {
+        auto hc = token_database_cache(tokendb, 1024 * 1024);
+
+        hc.read_token<domain_def>(token_type::domain, std::nullopt, "dm-tkdb-test");
+        hc.read_token<token_def>(token_type::token, "dm-tkdb-test", "t1");
+        for(auto i = 0; i < 3; i++) {
+            hc.read_token<token_def>(token_type::token, "dm-tkdb-test", "t1");
+        }
+
+        auto keys = hc.hot_keys(10);
+        REQUIRE(keys.size() == 2);
+        CHECK(keys[0].type == token_type::token);
+        CHECK(keys[0].hits == 3);
+        CHECK(keys[1].type == token_type::domain);
+        CHECK(keys[1].hits == 0);
+
+        keys = hc.hot_keys(1);
+        REQUIRE(keys.size() == 1);
+        CHECK(keys[0].type == token_type::token);
+    }
 }
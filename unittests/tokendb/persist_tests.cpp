@@ -1,4 +1,5 @@
 #include "tokendb_tests.hpp"
+#include <rocksdb/version.h>
 
 /*
  * Persist Tests: add token
@@ -90,22 +91,22 @@ TEST_CASE_METHOD(tokendb_test, "put_token_prst_test", "[tokendb]") {
     // ** token_type : domain(non-token)
     auto _dom = domain_def();
     READ_TOKEN(domain, "dm-tkdb-ps1", _dom);
-    CHECK(_dom.metas[0].key == "key");
-    _dom.metas[0].key = "key-tkdb-ps1";
+    CHECK(_dom.manage.threshold == 1);
+    _dom.manage.threshold = 4;
     PUT_TOKEN(domain, "dm-tkdb-ps1", _dom);
     READ_TOKEN(domain, "dm-tkdb-ps1", _dom);
-    CHECK(_dom.metas[0].key == "key-tkdb-ps1");
+    CHECK(_dom.manage.threshold == 4);
 
     ADD_SAVEPOINT();
 
     // ** token_type : token
     auto _tk = token_def();
     READ_TOKEN2(token, "dm-tkdb-ps1", "ps2", _tk);
-    CHECK(_tk.metas[0].key == "key");
-    _tk.metas[0].key = "ps2-meta";
+    CHECK(_tk.owner.size() == 1);
+    _tk.owner.emplace_back(address());
     PUT_TOKEN2(token, _tk.domain, _tk.name, _tk);
     READ_TOKEN2(token, "dm-tkdb-ps1", "ps2", _tk);
-    CHECK(_tk.metas[0].key == "ps2-meta");
+    CHECK(_tk.owner.size() == 2);
 
     ADD_SAVEPOINT();
 }
@@ -117,11 +118,11 @@ TEST_CASE_METHOD(tokendb_test, "put_token_prst_rlbk", "[tokendb]") {
 
     ROLLBACK();
     READ_TOKEN2(token, "dm-tkdb-ps1", "ps2", _tk);
-    CHECK(std::string(_tk.metas[0].key) == "key");
+    CHECK(_tk.owner.size() == 1);
     
     ROLLBACK();
     READ_TOKEN(domain, "dm-tkdb-ps1", _dom);
-    CHECK(std::string(_dom.metas[0].key) == "key");
+    CHECK(_dom.manage.threshold == 1);
 
     ROLLBACK();
     CHECK(!EXISTS_TOKEN2(token, "dm-tkdb-ps1", "ps2"));
@@ -157,9 +158,12 @@ TEST_CASE_METHOD(tokendb_test, "put_tokens_prst_test", "[tokendb]") {
     tkeys.push_back(tk1.name);
     tkeys.push_back(tk2.name);
 
+    // views should not outlive values
+    auto v1   = evt::chain::make_db_value(tk1);
+    auto v2   = evt::chain::make_db_value(tk2);
     auto data = small_vector<std::string_view, 4>();
-    data.push_back(evt::chain::make_db_value(tk1).as_string_view());
-    data.push_back(evt::chain::make_db_value(tk2).as_string_view());
+    data.push_back(v1.as_string_view());
+    data.push_back(v2.as_string_view());
 
     tokendb.put_tokens(
             evt::chain::token_type::token,
@@ -296,3 +300,359 @@ TEST_CASE_METHOD(tokendb_test, "squash_prst_rlbk", "[tokendb]") {
     CHECK(!EXISTS_TOKEN(domain, "domain-prst-sq"));
 }
 
+
+TEST_CASE("type_columns_prst_test", "[tokendb]") {
+    auto cfg    = token_database::config();
+    cfg.db_path = fresh_db_path("tokendb_columns");
+
+    auto dom = fc::json::from_string(domain_data).as<domain_def>();
+    dom.name = "domain-cols";
+    auto tk  = fc::json::from_string(token_data).as<token_def>();
+    tk.domain = dom.name;
+    tk.name   = "cols1";
+
+    {
+        auto tokendb = token_database(cfg);
+        tokendb.open();
+        PUT_TOKEN(domain, dom.name, dom);
+        PUT_TOKEN2(token, dom.name, tk.name, tk);
+    }
+
+    // existing tokens are moved into newly configured column families
+    cfg.columns.emplace_back(token_database::config::column_config { .type = token_type::token, .block_size = 16 * 1024, .compression = "zstd" });
+    cfg.columns.emplace_back(token_database::config::column_config { .type = token_type::domain, .high_priority = true });
+    {
+        auto tokendb = token_database(cfg);
+        tokendb.open();
+        CHECK(EXISTS_TOKEN(domain, dom.name));
+        CHECK(EXISTS_TOKEN2(token, dom.name, tk.name));
+
+        ADD_SAVEPOINT();
+        tk.name = "cols2";
+        ADD_TOKEN2(token, dom.name, tk.name, tk);
+        CHECK(tokendb.read_tokens_range(token_type::token, dom.name, 0, [](auto&, auto&&) { return true; }) == 2);
+        ROLLBACK();
+        CHECK(!EXISTS_TOKEN2(token, dom.name, tk.name));
+    }
+
+    // and moved back when they're not configured anymore
+    cfg.columns.clear();
+    {
+        auto tokendb = token_database(cfg);
+        tokendb.open();
+        CHECK(EXISTS_TOKEN(domain, dom.name));
+        CHECK(EXISTS_TOKEN2(token, dom.name, "cols1"));
+        CHECK(!EXISTS_TOKEN2(token, dom.name, "cols2"));
+    }
+}
+
+TEST_CASE("journal_replay_prst_test", "[tokendb]") {
+    auto cfg    = token_database::config();
+    cfg.db_path = fresh_db_path("tokendb_journal");
+    cfg.enable_owner_index = true;
+
+    auto dom = fc::json::from_string(domain_data).as<domain_def>();
+    dom.name = "domain-journal";
+    auto tk  = fc::json::from_string(token_data).as<token_def>();
+    tk.domain   = dom.name;
+    tk.owner[0] = address(tester::get_public_key(N(journal)));
+
+    auto owned = [&](auto& tokendb) {
+        auto n = 0;
+        tokendb.read_tokens_by_owner(tk.owner[0], dom.name, [&](auto&, auto&) { n++; return true; });
+        return n;
+    };
+
+    {
+        auto tokendb = token_database(cfg);
+        tokendb.open();
+        PUT_TOKEN(domain, dom.name, dom);
+
+        // the same owner index is written again after rolled back
+        tokendb.add_savepoint(1);
+        tk.name = "journal1";
+        ADD_TOKEN2(token, dom.name, tk.name, tk);
+        ROLLBACK();
+        CHECK(owned(tokendb) == 0);
+
+        tokendb.add_savepoint(1);
+        ADD_TOKEN2(token, dom.name, tk.name, tk);
+        CHECK(owned(tokendb) == 1);
+
+        tokendb.add_savepoint(2);
+        tk.name = "journal2";
+        ADD_TOKEN2(token, dom.name, tk.name, tk);
+        tokendb.add_savepoint(3);
+        tk.name = "journal3";
+        ADD_TOKEN2(token, dom.name, tk.name, tk);
+        tokendb.squash();
+        CHECK(owned(tokendb) == 3);
+    }
+
+    // savepoints are restored by replaying journal
+    {
+        auto tokendb = token_database(cfg);
+        tokendb.open();
+        CHECK(tokendb.savepoints_size() == 2);
+        CHECK(owned(tokendb) == 3);
+        CHECK(EXISTS_TOKEN2(token, dom.name, "journal1"));
+        CHECK(EXISTS_TOKEN2(token, dom.name, "journal3"));
+
+        // squashed one is rolled back as a whole
+        ROLLBACK();
+        CHECK(owned(tokendb) == 1);
+        CHECK(EXISTS_TOKEN2(token, dom.name, "journal1"));
+        CHECK(!EXISTS_TOKEN2(token, dom.name, "journal2"));
+        CHECK(!EXISTS_TOKEN2(token, dom.name, "journal3"));
+    }
+
+    // rollback above is journaled as well
+    {
+        auto tokendb = token_database(cfg);
+        tokendb.open();
+        CHECK(tokendb.savepoints_size() == 1);
+        CHECK(owned(tokendb) == 1);
+
+        ROLLBACK();
+        CHECK(owned(tokendb) == 0);
+        CHECK(!EXISTS_TOKEN2(token, dom.name, "journal1"));
+        CHECK(EXISTS_TOKEN(domain, dom.name));
+    }
+}
+
+TEST_CASE("state_digest_prst_test", "[tokendb]") {
+    auto cfg    = token_database::config();
+    cfg.db_path = fresh_db_path("tokendb_digest");
+
+    auto dom = fc::json::from_string(domain_data).as<domain_def>();
+    dom.name = "domain-digest";
+    auto tk  = fc::json::from_string(token_data).as<token_def>();
+    tk.domain = dom.name;
+
+    auto addr1 = address(tester::get_public_key(N(digest1)));
+    auto addr2 = address(tester::get_public_key(N(digest2)));
+
+    // maintained digest is always the same as the one built by a full scan
+    auto check_digest = [](auto& tokendb) {
+        auto digest = tokendb.state_digest();
+        CHECK(digest == tokendb.build_state_digest());
+        return digest;
+    };
+
+    auto d0 = fc::sha256();
+    auto d1 = fc::sha256();
+    auto d2 = fc::sha256();
+    {
+        auto tokendb = token_database(cfg);
+        tokendb.open();
+        PUT_TOKEN(domain, dom.name, dom);
+        PUT_ASSET(addr1, 5, asset::from_string("1.00000 S#5"));
+        d0 = check_digest(tokendb);
+
+        tokendb.add_savepoint(1);
+        tk.name = "digest1";
+        ADD_TOKEN2(token, dom.name, tk.name, tk);
+        PUT_ASSET(addr1, 5, asset::from_string("2.00000 S#5"));
+        d1 = check_digest(tokendb);
+        CHECK(d1 != d0);
+
+        tokendb.add_savepoint(2);
+        tk.name = "digest2";
+        ADD_TOKEN2(token, dom.name, tk.name, tk);
+        PUT_ASSET(addr1, 5, asset::from_string("3.00000 S#5"));
+        check_digest(tokendb);
+
+        ROLLBACK();
+        CHECK(check_digest(tokendb) == d1);
+
+        // nested savepoints squashed into one
+        tokendb.add_savepoint(2);
+        tk.name = "digest3";
+        ADD_TOKEN2(token, dom.name, tk.name, tk);
+        check_digest(tokendb);
+
+        tokendb.add_savepoint(3);
+        PUT_ASSET(addr2, 5, asset::from_string("4.00000 S#5"));
+        UPDATE_TOKEN2(token, dom.name, tk.name, tk);
+        check_digest(tokendb);
+
+        tokendb.squash();
+        d2 = check_digest(tokendb);
+    }
+
+    // built again after reopened and restored by rollback of replayed savepoints
+    {
+        auto tokendb = token_database(cfg);
+        tokendb.open();
+        CHECK(tokendb.savepoints_size() == 2);
+        CHECK(check_digest(tokendb) == d2);
+
+        ROLLBACK();
+        CHECK(check_digest(tokendb) == d1);
+        ROLLBACK();
+        CHECK(check_digest(tokendb) == d0);
+    }
+}
+
+TEST_CASE("expiry_index_prst_test", "[tokendb]") {
+    auto cfg    = token_database::config();
+    cfg.db_path = fresh_db_path("tokendb_expiry");
+
+    auto make_suspend = [](const name128& name, suspend_status status, uint32_t expiration) {
+        auto suspend = suspend_def();
+        suspend.name           = name;
+        suspend.status         = status;
+        suspend.trx.expiration = fc::time_point_sec(expiration);
+        return suspend;
+    };
+    auto expired = [](auto& tokendb, uint32_t until) {
+        auto names = std::vector<name128>();
+        tokendb.read_expiry_range(token_type::suspend, fc::time_point_sec(until), [&](auto&, auto& name) {
+            names.emplace_back(name);
+            return true;
+        });
+        return names;
+    };
+
+    auto s1 = std::vector<name128>{ N128(suspend1) };
+    auto s3 = std::vector<name128>{ N128(suspend3) };
+
+    {
+        cfg.enable_owner_index = false;
+        auto tokendb = token_database(cfg);
+        tokendb.open();
+        PUT_TOKEN(suspend, N128(suspend1), make_suspend(N128(suspend1), suspend_status::proposed, 100));
+        PUT_TOKEN(suspend, N128(suspend2), make_suspend(N128(suspend2), suspend_status::executed, 50));
+        CHECK_THROWS_AS(expired(tokendb, 1000), token_database_exception);
+    }
+
+    // backfilled when the index is enabled
+    {
+        cfg.enable_owner_index = true;
+        auto tokendb = token_database(cfg);
+        tokendb.open();
+        CHECK(expired(tokendb, 1000) == s1);
+        CHECK(expired(tokendb, 99).empty());
+
+        // only proposed ones are indexed and entries are restored by rollback
+        tokendb.add_savepoint(1);
+        PUT_TOKEN(suspend, N128(suspend3), make_suspend(N128(suspend3), suspend_status::proposed, 200));
+        PUT_TOKEN(suspend, N128(suspend1), make_suspend(N128(suspend1), suspend_status::executed, 100));
+        CHECK(expired(tokendb, 1000) == s3);
+        ROLLBACK();
+        CHECK(expired(tokendb, 1000) == s1);
+
+        PUT_TOKEN(suspend, N128(suspend3), make_suspend(N128(suspend3), suspend_status::proposed, 200));
+    }
+
+    // built only once, entries written after that are kept
+    {
+        auto tokendb = token_database(cfg);
+        tokendb.open();
+        auto names = expired(tokendb, 1000);
+        REQUIRE(names.size() == 2);
+        CHECK(names[0] == N128(suspend1));
+        CHECK(names[1] == N128(suspend3));
+        CHECK(expired(tokendb, 150) == s1);
+    }
+}
+
+#if ROCKSDB_MAJOR >= 6
+TEST_CASE("secondary_prst_test", "[tokendb]") {
+    auto cfg    = token_database::config();
+    cfg.db_path = fresh_db_path("tokendb_primary");
+    cfg.enable_owner_index = true;
+    cfg.columns.emplace_back(token_database::config::column_config { .type = token_type::token });
+
+    auto scfg = cfg;
+    scfg.secondary_path = fresh_db_path("tokendb_secondary");
+
+    auto dom = fc::json::from_string(domain_data).as<domain_def>();
+    dom.name = "domain-secondary";
+    auto tk  = fc::json::from_string(token_data).as<token_def>();
+    tk.domain   = dom.name;
+    tk.name     = "secondary1";
+    tk.owner[0] = address(tester::get_public_key(N(secondary)));
+
+    // only an existing database can be opened
+    CHECK_THROWS_AS(token_database(scfg).open(), token_database_exception);
+
+    auto tokendb = token_database(cfg);
+    tokendb.open();
+    CHECK(!tokendb.is_secondary());
+    PUT_TOKEN(domain, dom.name, dom);
+    PUT_TOKEN2(token, dom.name, tk.name, tk);
+
+    auto secondary = token_database(scfg);
+    secondary.open();
+    CHECK(secondary.is_secondary());
+    CHECK(secondary.exists_token(token_type::domain, std::nullopt, dom.name));
+    CHECK(secondary.exists_token(token_type::token, dom.name, tk.name));
+
+    // tokens are read from the column families and indexes of primary
+    auto owned = [&](auto& db) {
+        auto n = 0;
+        db.read_tokens_by_owner(tk.owner[0], dom.name, [&](auto&, auto&) { n++; return true; });
+        return n;
+    };
+    CHECK(owned(secondary) == 1);
+
+    // changes of primary are only seen after caught up
+    tk.name = "secondary2";
+    PUT_TOKEN2(token, dom.name, tk.name, tk);
+    CHECK(!secondary.exists_token(token_type::token, dom.name, tk.name));
+    secondary.catch_up_with_primary();
+    CHECK(secondary.exists_token(token_type::token, dom.name, tk.name));
+    CHECK(owned(secondary) == 2);
+
+    // and it's read-only
+    CHECK_THROWS_AS(secondary.add_savepoint(1), token_database_exception);
+    CHECK_THROWS_AS(tokendb.catch_up_with_primary(), token_database_exception);
+
+    // files of primary are kept after secondary is closed
+    secondary.close(false);
+    tokendb.close();
+
+    auto reopened = token_database(cfg);
+    reopened.open();
+    CHECK(reopened.exists_token(token_type::token, dom.name, "secondary1"));
+    CHECK(reopened.exists_token(token_type::token, dom.name, "secondary2"));
+}
+#endif
+
+TEST_CASE("asset_aggregate_prst_test", "[tokendb]") {
+    auto cfg    = token_database::config();
+    cfg.db_path = fresh_db_path("tokendb_aggregate");
+
+    auto addr1 = address(tester::get_public_key(N(aggregate1)));
+    auto addr2 = address(tester::get_public_key(N(aggregate2)));
+
+    {
+        auto tokendb = token_database(cfg);
+        tokendb.open();
+        PUT_ASSET(addr1, 5, asset::from_string("1.00000 S#5"));
+
+        tokendb.add_savepoint(1);
+        tokendb.add_asset_aggregate(5);
+        PUT_ASSET(addr2, 5, asset::from_string("3.00000 S#5"));
+        CHECK(tokendb.read_asset_aggregate(5)->holders == 2);
+    }
+
+    {
+        auto tokendb = token_database(cfg);
+        tokendb.open();
+        REQUIRE(tokendb.savepoints_size() == 1);
+
+        // registrations are in memory only
+        CHECK(!tokendb.read_asset_aggregate(5).has_value());
+        tokendb.add_asset_aggregate(5);
+        CHECK(tokendb.read_asset_aggregate(5)->holders == 2);
+        CHECK(tokendb.read_asset_aggregate(5)->total == 400000);
+
+        // savepoints replayed from journal keep no aggregates, they're built again when rolled back
+        ROLLBACK();
+        REQUIRE(tokendb.read_asset_aggregate(5).has_value());
+        CHECK(tokendb.read_asset_aggregate(5)->holders == 1);
+        CHECK(tokendb.read_asset_aggregate(5)->total == 100000);
+    }
+}
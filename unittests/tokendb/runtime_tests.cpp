@@ -74,30 +74,30 @@ TEST_CASE_METHOD(tokendb_test, "put_token_svpt_test", "[tokendb]") {
     // ** token_type : domain(non-token)
     auto _dom = domain_def();
     READ_TOKEN(domain, "dm-tkdb-rt1", _dom);
-    CHECK(_dom.metas[0].key == "key");
-    _dom.metas[0].key = "key-tkdb-rt1";
+    CHECK(_dom.manage.threshold == 1);
+    _dom.manage.threshold = 5;
     PUT_TOKEN(domain, "dm-tkdb-rt1", _dom);
     READ_TOKEN(domain, "dm-tkdb-rt1", _dom);
-    CHECK(_dom.metas[0].key == "key-tkdb-rt1");
+    CHECK(_dom.manage.threshold == 5);
 
     ADD_SAVEPOINT();
 
     // ** token_type : token
     auto _tk = token_def();
     READ_TOKEN2(token, "dm-tkdb-rt1", "rt2", _tk);
-    CHECK(_tk.metas[0].key == "key");
-    _tk.metas[0].key = "t2-meta";
+    CHECK(_tk.owner.size() == 1);
+    _tk.owner.emplace_back(address());
     PUT_TOKEN2(token, _tk.domain, _tk.name, _tk);
     READ_TOKEN2(token, "dm-tkdb-rt1", "rt2", _tk);
-    CHECK(_tk.metas[0].key == "t2-meta");
+    CHECK(_tk.owner.size() == 2);
 
     ROLLBACK();
     READ_TOKEN2(token, "dm-tkdb-rt1", "rt2", _tk);
-    CHECK(std::string(_tk.metas[0].key) == "key");
+    CHECK(_tk.owner.size() == 1);
     
     ROLLBACK();
     READ_TOKEN(domain, "dm-tkdb-rt1", _dom);
-    CHECK(std::string(_dom.metas[0].key) == "key");
+    CHECK(_dom.manage.threshold == 1);
     
     ROLLBACK();
     CHECK(!EXISTS_TOKEN2(token, "dm-tkdb-rt1", "t2"));
@@ -168,9 +168,12 @@ TEST_CASE_METHOD(tokendb_test, "put_tokens_svpt_test", "[tokendb]") {
     tkeys.push_back(tk1.name);
     tkeys.push_back(tk2.name);
 
+    // views should not outlive values
+    auto v1   = evt::chain::make_db_value(tk1);
+    auto v2   = evt::chain::make_db_value(tk2);
     auto data = small_vector<std::string_view, 4>();
-    data.push_back(evt::chain::make_db_value(tk1).as_string_view());
-    data.push_back(evt::chain::make_db_value(tk2).as_string_view());
+    data.push_back(v1.as_string_view());
+    data.push_back(v2.as_string_view());
 
     tokendb.put_tokens(
             evt::chain::token_type::token,
@@ -236,3 +239,335 @@ TEST_CASE_METHOD(tokendb_test, "squansh_test", "[tokendb]") {
 
     my_tester->produce_block();
 }
+
+TEST_CASE_METHOD(tokendb_test, "batch_write_svpt_test", "[tokendb]") {
+    auto& tokendb = my_tester->control->token_db();
+    my_tester->produce_block();
+    ADD_SAVEPOINT();
+
+    auto var = fc::json::from_string(domain_data);
+    auto dom = var.as<domain_def>();
+    dom.name = "domain-batch";
+    PUT_TOKEN(domain, dom.name, dom);
+
+    auto tk = fc::json::from_string(token_data).as<token_def>();
+    tk.domain = dom.name;
+    tk.name   = "tk-batch1";
+    ADD_TOKEN2(token, dom.name, tk.name, tk);
+
+    // pending writes are visible to reads
+    CHECK(EXISTS_TOKEN(domain, dom.name));
+    CHECK(EXISTS_TOKEN2(token, dom.name, tk.name));
+
+    auto keys = small_vector<name128, 4>{ tk.name };
+    auto strs = token_values_t();
+    CHECK(tokendb.read_tokens(token_type::token, dom.name, keys, strs) == 1);
+
+    // range read sees pending values without writing them into db
+    auto count = tokendb.read_tokens_range(token_type::token, dom.name, 0, [](auto& k, auto&& v) { return true; });
+    CHECK(count == 1);
+
+    tk.name = "tk-batch2";
+    ADD_TOKEN2(token, dom.name, tk.name, tk);
+    CHECK(EXISTS_TOKEN2(token, dom.name, tk.name));
+
+    // both written and pending values are rollbacked
+    ROLLBACK();
+    CHECK(!EXISTS_TOKEN(domain, dom.name));
+    CHECK(!EXISTS_TOKEN2(token, dom.name, "tk-batch1"));
+    CHECK(!EXISTS_TOKEN2(token, dom.name, "tk-batch2"));
+
+    my_tester->produce_block();
+}
+
+TEST_CASE("merged_reads_svpt_test", "[tokendb]") {
+    auto cfg    = token_database::config();
+    cfg.db_path = fresh_db_path("tokendb_merged");
+    cfg.enable_owner_index = true;
+
+    auto tokendb = token_database(cfg);
+    tokendb.open();
+
+    auto dom = fc::json::from_string(domain_data).as<domain_def>();
+    dom.name = "domain-merged";
+    PUT_TOKEN(domain, dom.name, dom);
+
+    auto tk = fc::json::from_string(token_data).as<token_def>();
+    tk.domain   = dom.name;
+    tk.owner[0] = address(tester::get_public_key(N(merged)));
+    tk.name     = "tk-merged1";
+    ADD_TOKEN2(token, dom.name, tk.name, tk);
+    tk.name = "tk-merged3";
+    ADD_TOKEN2(token, dom.name, tk.name, tk);
+
+    auto range = [&](int skip) {
+        auto names = std::vector<std::string>();
+        tokendb.read_tokens_range(token_type::token, dom.name, skip, [&](auto& k, auto&& v) {
+            auto t = token_def();
+            extract_db_value(v, t);
+            names.emplace_back((std::string)t.name);
+            return true;
+        });
+        std::sort(names.begin(), names.end());
+        return names;
+    };
+    auto owned = [&] {
+        auto n = 0;
+        tokendb.read_tokens_by_owner(tk.owner[0], dom.name, [&](auto&, auto&) { n++; return true; });
+        return n;
+    };
+
+    // values in write cache and batch are merged with the ones in db
+    tokendb.add_savepoint(1);
+    tk.name = "tk-merged2";
+    ADD_TOKEN2(token, dom.name, tk.name, tk);
+    tk.name = "tk-merged3";
+    UPDATE_TOKEN2(token, dom.name, tk.name, tk);
+
+    auto all = std::vector<std::string>{ "tk-merged1", "tk-merged2", "tk-merged3" };
+    CHECK(range(0) == all);
+    CHECK(range(1).size() == 2);
+    CHECK(owned() == 3);
+
+    ROLLBACK();
+    auto written = std::vector<std::string>{ "tk-merged1", "tk-merged3" };
+    CHECK(range(0) == written);
+    CHECK(owned() == 2);
+}
+
+TEST_CASE_METHOD(tokendb_test, "read_view_svpt_test", "[tokendb]") {
+    auto& tokendb = my_tester->control->token_db();
+    my_tester->produce_block();
+
+    auto addr1 = public_key_type(std::string("EVT8MGU4aKiVzqMtWi9zLpu8KuTHZWjQQrX475ycSxEkLd6aBpraX"));
+    auto addr2 = public_key_type(std::string("EVT6NPexVQjcb2FJZJohZHsQ22rRRtHziH8yPfyj2zwnJV74Ycp2p"));
+
+    auto var = fc::json::from_string(domain_data);
+    auto dom = var.as<domain_def>();
+    dom.creator = key;
+    dom.name = "dm-tkdb-view1";
+    dom.issue.authorizers[0].ref.set_account(key);
+    dom.manage.authorizers[0].ref.set_account(key);
+
+    ADD_SAVEPOINT();
+    PUT_TOKEN(domain, dom.name, dom);
+    PUT_ASSET(addr1, 6, asset::from_string("1.00000 S#6"));
+
+    auto view = tokendb.create_read_view();
+    CHECK(view->seq() == tokendb.latest_savepoint_seq());
+
+    // writes after the view is created are not visible in it
+    ADD_SAVEPOINT();
+    dom.manage.threshold = 6;
+    PUT_TOKEN(domain, dom.name, dom);
+    dom.name = "dm-tkdb-view2";
+    PUT_TOKEN(domain, dom.name, dom);
+    PUT_ASSET(addr1, 6, asset::from_string("2.00000 S#6"));
+    PUT_ASSET(addr2, 6, asset::from_string("3.00000 S#6"));
+
+    auto check_view = [&] {
+        auto str  = std::string();
+        auto _dom = domain_def();
+        REQUIRE(view->read_token(token_type::domain, std::nullopt, "dm-tkdb-view1", str));
+        extract_db_value(str, _dom);
+        CHECK(_dom.manage.threshold == 1);
+        CHECK(!view->read_token(token_type::domain, std::nullopt, "dm-tkdb-view2", str, true /* no throw */));
+        CHECK_THROWS_AS(view->read_token(token_type::domain, std::nullopt, "dm-tkdb-view2", str), unknown_token_database_key);
+
+        auto as = asset();
+        REQUIRE(view->read_asset(addr1, 6, str));
+        extract_db_value(str, as);
+        CHECK(as == asset::from_string("1.00000 S#6"));
+        CHECK(!view->read_asset(addr2, 6, str, true /* no throw */));
+
+        auto n = 0;
+        view->read_assets_range(6, 0, [&](auto& k, auto&& v) {
+            n++;
+            return true;
+        });
+        CHECK(n == 1);
+
+        auto names = std::vector<std::string>();
+        view->read_tokens_range(token_type::domain, std::nullopt, 0, [&](auto& k, auto&& v) {
+            auto d = domain_def();
+            extract_db_value(v, d);
+            names.emplace_back((std::string)d.name);
+            return true;
+        });
+        CHECK(std::count(names.begin(), names.end(), "dm-tkdb-view1") == 1);
+        CHECK(std::count(names.begin(), names.end(), "dm-tkdb-view2") == 0);
+
+        // range from the cursor excludes itself
+        auto after = std::vector<std::string>();
+        view->read_tokens_range(token_type::domain, std::nullopt, name128("dm-tkdb-view1"), [&](auto& k, auto&& v) {
+            auto d = domain_def();
+            extract_db_value(v, d);
+            after.emplace_back((std::string)d.name);
+            return true;
+        });
+        CHECK(std::count(after.begin(), after.end(), "dm-tkdb-view1") == 0);
+        CHECK(after.size() + 1 <= names.size());
+    };
+
+    check_view();
+    CHECK(EXISTS_TOKEN(domain, "dm-tkdb-view2"));
+    CHECK(EXISTS_ASSET(addr2, 6));
+
+    ROLLBACK();
+    check_view();
+
+    ROLLBACK();
+    CHECK(!EXISTS_TOKEN(domain, "dm-tkdb-view1"));
+    check_view();
+
+    view.reset();
+    my_tester->produce_block();
+}
+
+TEST_CASE_METHOD(tokendb_test, "read_view_until_test", "[tokendb]") {
+    auto& tokendb = my_tester->control->token_db();
+    my_tester->produce_block();
+
+    auto addr1 = public_key_type(std::string("EVT8MGU4aKiVzqMtWi9zLpu8KuTHZWjQQrX475ycSxEkLd6aBpraX"));
+
+    auto var = fc::json::from_string(domain_data);
+    auto dom = var.as<domain_def>();
+    dom.creator = key;
+    dom.name = "dm-tkdb-until1";
+    dom.issue.authorizers[0].ref.set_account(key);
+    dom.manage.authorizers[0].ref.set_account(key);
+
+    ADD_SAVEPOINT();
+    auto seq1 = tokendb.latest_savepoint_seq();
+    PUT_TOKEN(domain, dom.name, dom);
+    PUT_ASSET(addr1, 7, asset::from_string("1.00000 S#7"));
+
+    ADD_SAVEPOINT();
+    dom.manage.threshold = 7;
+    PUT_TOKEN(domain, dom.name, dom);
+    dom.name = "dm-tkdb-until2";
+    PUT_TOKEN(domain, dom.name, dom);
+    PUT_ASSET(addr1, 7, asset::from_string("2.00000 S#7"));
+
+    // writes in the savepoints after `until` are undone in the view
+    auto view = tokendb.create_read_view(seq1);
+    CHECK(view->seq() == seq1);
+
+    auto str  = std::string();
+    auto _dom = domain_def();
+    REQUIRE(view->read_token(token_type::domain, std::nullopt, "dm-tkdb-until1", str));
+    extract_db_value(str, _dom);
+    CHECK(_dom.manage.threshold == 1);
+    CHECK(!view->read_token(token_type::domain, std::nullopt, "dm-tkdb-until2", str, true /* no throw */));
+
+    auto as = asset();
+    REQUIRE(view->read_asset(addr1, 7, str));
+    extract_db_value(str, as);
+    CHECK(as == asset::from_string("1.00000 S#7"));
+
+    // none of the savepoints is seen
+    auto view0 = tokendb.create_read_view(seq1 - 1);
+    CHECK(view0->seq() < seq1);
+    CHECK(!view0->read_token(token_type::domain, std::nullopt, "dm-tkdb-until1", str, true /* no throw */));
+    CHECK(!view0->read_asset(addr1, 7, str, true /* no throw */));
+
+    // live database is not touched
+    CHECK(EXISTS_TOKEN(domain, "dm-tkdb-until2"));
+
+    view.reset();
+    view0.reset();
+    ROLLBACK();
+    ROLLBACK();
+    my_tester->produce_block();
+}
+
+TEST_CASE("spill_savepoints_test", "[tokendb]") {
+    auto cfg    = token_database::config();
+    cfg.db_path = fresh_db_path("tokendb_spill");
+    cfg.enable_owner_index     = true;
+    cfg.max_runtime_savepoints = 2;
+
+    auto tokendb = token_database(cfg);
+    tokendb.open();
+
+    auto dom = fc::json::from_string(domain_data).as<domain_def>();
+    dom.name = "domain-spill";
+    PUT_TOKEN(domain, dom.name, dom);
+
+    auto tk   = fc::json::from_string(token_data).as<token_def>();
+    tk.domain = dom.name;
+
+    auto names = std::vector<name128>{ "spill1", "spill2", "spill3", "spill4", "spill5" };
+
+    tokendb.add_savepoint(1);
+    for(auto& name : names) {
+        tk.name = name;
+        ADD_TOKEN2(token, dom.name, tk.name, tk);
+        ADD_SAVEPOINT();
+    }
+
+    // only the latest two savepoints hold snapshots, older ones are spilled
+    auto m = tokendb.memory_usage();
+    CHECK(tokendb.savepoints_size() == 6);
+    CHECK(m.savepoints_snapshots == 2);
+    CHECK(m.savepoints > 0);
+
+    // squash still works on the runtime ones
+    tokendb.squash();
+    CHECK(tokendb.memory_usage().savepoints_snapshots == 1);
+
+    // spilled savepoints are rolled back by their previous values
+    while(tokendb.savepoints_size() > 0) {
+        ROLLBACK();
+    }
+    CHECK(EXISTS_TOKEN(domain, dom.name));
+    for(auto& name : names) {
+        CHECK(!EXISTS_TOKEN2(token, dom.name, name));
+    }
+    CHECK(tokendb.memory_usage().savepoints_snapshots == 0);
+}
+
+TEST_CASE_METHOD(tokendb_test, "asset_aggregate_svpt_test", "[tokendb]") {
+    auto& tokendb = my_tester->control->token_db();
+    my_tester->produce_block();
+
+    auto addr1 = public_key_type(std::string("EVT8MGU4aKiVzqMtWi9zLpu8KuTHZWjQQrX475ycSxEkLd6aBpraX"));
+    auto addr2 = public_key_type(std::string("EVT6NPexVQjcb2FJZJohZHsQ22rRRtHziH8yPfyj2zwnJV74Ycp2p"));
+
+    ADD_SAVEPOINT();
+    tokendb.add_asset_aggregate(5);
+    tokendb.add_asset_aggregate(5, 200000);
+    CHECK(!tokendb.read_asset_aggregate(5, 100).has_value());
+    REQUIRE(tokendb.read_asset_aggregate(5).has_value());
+    CHECK(tokendb.read_asset_aggregate(5)->holders == 0);
+
+    PUT_ASSET(addr1, 5, asset::from_string("1.00000 S#5"));
+
+    auto agg = *tokendb.read_asset_aggregate(5);
+    CHECK(agg.holders == 1);
+    CHECK(agg.total == 100000);
+    CHECK(tokendb.read_asset_aggregate(5, 200000)->holders == 0);
+
+    ADD_SAVEPOINT();
+    PUT_ASSET(addr2, 5, asset::from_string("3.00000 S#5"));
+    PUT_ASSET(addr1, 5, asset::from_string("0.00000 S#5"));
+
+    agg = *tokendb.read_asset_aggregate(5);
+    CHECK(agg.holders == 1);
+    CHECK(agg.total == 300000);
+    CHECK(tokendb.read_asset_aggregate(5, 200000)->holders == 1);
+
+    // aggregates are restored by rollback
+    ROLLBACK();
+    agg = *tokendb.read_asset_aggregate(5);
+    CHECK(agg.holders == 1);
+    CHECK(agg.total == 100000);
+    CHECK(tokendb.read_asset_aggregate(5, 200000)->holders == 0);
+
+    // and so are the registrations
+    ROLLBACK();
+    CHECK(!tokendb.read_asset_aggregate(5).has_value());
+    CHECK(!tokendb.read_asset_aggregate(5, 200000).has_value());
+
+    my_tester->produce_block();
+}
@@ -1,6 +1,8 @@
 #include <stdlib.h>
 #include <time.h>
 #include <algorithm>
+#include <fstream>
+#include <future>
 #include <iterator>
 #include <vector>
 
@@ -59,6 +61,16 @@ protected:
     std::unique_ptr<tester>   my_tester;
 };
 
+// path of a standalone token database under the test dir, left by previous runs is removed
+inline std::string
+fresh_db_path(const std::string& name) {
+    auto path = evt_unittests_dir + "/tokendb_tests/" + name;
+    if(fc::exists(path)) {
+        fc::remove_all(path);
+    }
+    return path;
+}
+
 #define EXISTS_TOKEN(TYPE, NAME) \
     tokendb.exists_token(evt::chain::token_type::TYPE, std::nullopt, NAME)
 
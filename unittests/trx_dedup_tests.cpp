@@ -0,0 +1,44 @@
+#include <catch/catch.hpp>
+
+#include <evt/net_plugin/trx_dedup.hpp>
+
+using namespace evt;
+
+TEST_CASE("trx_dedup_test", "[net]") {
+    auto dedup = trx_dedup();
+    auto now   = trx_dedup::clock::now();
+    auto h1    = trx_dedup::hash(std::vector<char>{ 'a', 'b', 'c' });
+    auto h2    = trx_dedup::hash(std::vector<char>{ 'a', 'b', 'd' });
+    CHECK(h1 != h2);
+
+    // disabled by default
+    dedup.record(h1);
+    CHECK(!dedup.seen(h1, now));
+    CHECK(dedup.size() == 0);
+
+    dedup.set_window(std::chrono::milliseconds(100));
+    CHECK(dedup.enabled());
+
+    // only the recorded ones are seen, checking doesn't record
+    CHECK(!dedup.seen(h1, now));
+    CHECK(!dedup.seen(h1, now));
+    dedup.record(h1);
+    CHECK(dedup.seen(h1, now));
+    CHECK(!dedup.seen(h2, now));
+    CHECK(dedup.size() == 1);
+
+    // kept in previous window after one rotation
+    now += std::chrono::milliseconds(150);
+    CHECK(dedup.seen(h1, now));
+    dedup.record(h2);
+    CHECK(dedup.size() == 2);
+
+    // and forgotten after two
+    now += std::chrono::milliseconds(100);
+    CHECK(!dedup.seen(h1, now));
+    CHECK(dedup.seen(h2, now));
+
+    now += std::chrono::milliseconds(100);
+    CHECK(!dedup.seen(h2, now));
+    CHECK(dedup.size() == 0);
+}
@@ -1,7 +1,15 @@
 #include <catch/catch.hpp>
 
+#include <fc/variant_arena.hpp>
+#include <fc/io/json.hpp>
+
+#include <evt/chain/action_profiler.hpp>
 #include <evt/chain/address.hpp>
+#include <evt/chain/incremental_merkle.hpp>
+#include <evt/chain/merkle.hpp>
 #include <evt/chain/types.hpp>
+#include <evt/chain/recovered_keys_cache.hpp>
+#include <evt/chain/transaction_metadata.hpp>
 #include <evt/chain/token_database.hpp>
 #include <evt/chain/contracts/authorizer_ref.hpp>
 #include <evt/chain/contracts/evt_link.hpp>
@@ -102,6 +110,13 @@ TEST_CASE("test_link_1", "[types]") {
     CHECK(pkeys.size() == 1);
 
     CHECK(pkeys.find(public_key_type(std::string("EVT8HdQYD1xfKyD7Hyu2fpBUneamLMBXmP3qsYX6HoTw7yonpjWyC"))) != pkeys.end());
+
+    // restored keys are memoized until the link is changed
+    CHECK(&link.restore_keys() == &link.restore_keys());
+    CHECK(link.restore_keys() == pkeys);
+
+    link.clear_signatures();
+    CHECK(link.restore_keys().empty());
 }
 
 TEST_CASE("test_link_2", "[types]") {
@@ -224,6 +239,14 @@ TEST_CASE("test_name", "[types]") {
     CHECK_NOT_RESERVED("abc.1");
     CHECK_NOT_RESERVED("abc..12");
     CHECK_NOT_RESERVED("abc...12");
+
+    CHECK(name("transfer").to_string() == "transfer");
+    CHECK(name("everipay1234a").to_string() == "everipay1234a");
+    CHECK(name("everipay1234a").value == N(everipay1234a));
+    CHECK_THROWS_AS(name("abc."), name_type_exception);
+    CHECK_THROWS_AS(name("Abc"), name_type_exception);
+    CHECK_THROWS_AS(name("everipay1234z"), name_type_exception);
+    CHECK_THROWS_AS(name("everipay1234ab"), name_type_exception);
 }
 
 TEST_CASE("test_name128", "[types]") {
@@ -260,6 +283,11 @@ TEST_CASE("test_name128", "[types]") {
     CHECK_N128("1234567890ABCDEF", 16);
     CHECK_N128("1234567890ABCDEFGHIJK", 16);
 
+    CHECK_THROWS_AS(name128("abc."), name128_type_exception);
+    CHECK_THROWS_AS(name128("abc_d"), name128_type_exception);
+    CHECK_THROWS_AS(name128("1234567890ABCDEFGHIJKL"), name128_type_exception);
+    CHECK(name128(std::string("token.1A")).value == N128(token.1A));
+
     auto n1 = name128(N128(12345.67890));
     CHECK((std::string)n1 == "12345.67890");
 
@@ -411,6 +439,24 @@ TEST_CASE("test_percent_slim", "[types]") {
     CHECK_THROWS_AS(percent_slim::from_string("0.100a"), percent_type_exception);
 }
 
+TEST_CASE("test_percent_slim_floor_mul", "[types]") {
+    auto CHECK_FLOOR_MUL = [&](uint32_t v, int64_t amount) {
+        auto p = percent_slim(v);
+        INFO(v);
+        INFO(amount);
+        CHECK(p.floor_mul(amount) == (int64_t)boost::multiprecision::floor(p.value() * amount));
+        CHECK(p.floor_mul(amount) == (int64_t)boost::multiprecision::floor(p.value() * real_type(amount)));
+    };
+
+    auto amounts = std::vector<int64_t>{ 0, 1, 7, 99'999, 100'000, 100'001, 123'456'789, 1'000'000'000'000'000, std::numeric_limits<int64_t>::max() };
+    for(auto v : { 0u, 1u, 3u, 333u, 12'345u, 99'999u, 100'000u }) {
+        for(auto a : amounts) {
+            CHECK_FLOOR_MUL(v, a);
+            CHECK_FLOOR_MUL(v, -a);
+        }
+    }
+}
+
 
 TEST_CASE("test_make_db_value", "[types]") {
     auto CHECK_MAKE = [](auto sz) {
@@ -426,6 +472,53 @@ TEST_CASE("test_make_db_value", "[types]") {
     }
 }
 
+TEST_CASE("test_db_value_arena", "[types]") {
+    auto arena = db_value_arena();
+    auto small = std::string(100, 'a');
+    auto large = std::string(db_value_arena::kMaxValueSize + 1, 'b');
+
+    {
+        auto scope = db_value_arena::scope(arena);
+        CHECK(db_value_arena::current() == &arena);
+
+        auto v1 = make_db_value(small);
+        auto v2 = make_db_value(large);
+        CHECK(arena.blocks_size() == 1);
+
+        // copies and moves of values are still valid
+        auto v3 = v1;
+        auto v4 = std::move(v2);
+        CHECK(v3.as_string_view() == v1.as_string_view());
+        CHECK(v4.size() == fc::raw::pack_size(large));
+
+        auto s1 = std::string();
+        auto s4 = std::string();
+        extract_db_value(v3.as_string_view(), s1);
+        extract_db_value(v4.as_string_view(), s4);
+        CHECK(s1 == small);
+        CHECK(s4 == large);
+
+        // nested scope doesn't release values of outer ones
+        {
+            auto scope2 = db_value_arena::scope(arena);
+            for(auto i = 0u; i < db_value_arena::kBlockSize / small.size(); i++) {
+                make_db_value(small);
+            }
+        }
+        CHECK(arena.blocks_size() == 2);
+        extract_db_value(v1.as_string_view(), s1);
+        CHECK(s1 == small);
+    }
+    CHECK(db_value_arena::current() == nullptr);
+
+    // blocks are reused after outermost scope is exited
+    {
+        auto scope = db_value_arena::scope(arena);
+        make_db_value(small);
+        CHECK(arena.blocks_size() == 2);
+    }
+}
+
 TEST_CASE("test_reflector_init", "[types]") {
     auto strx = signed_transaction();
     strx.max_charge = 1000;
@@ -445,3 +538,299 @@ TEST_CASE("test_reflector_init", "[types]") {
     CHECK(trx2.max_charge == 1000);
     CHECK(trx2.actions.size() == 1);
 }
+
+TEST_CASE("test_zstd_packed_transaction", "[types]") {
+    auto strx = signed_transaction();
+    strx.max_charge = 1000;
+    for(auto i = 0; i < 100; i++) {
+        strx.actions.emplace_back(action(".test", ".test", ".test", bytes(64, 'a')));
+    }
+
+    auto ptrx = packed_transaction(strx, packed_transaction::zstd);
+    CHECK(ptrx.get_packed_transaction().size() < fc::raw::pack_size((const transaction&)strx));
+
+    auto b     = fc::raw::pack(ptrx);
+    auto ptrx2 = fc::raw::unpack<packed_transaction>(b);
+
+    auto& trx2 = ptrx2.get_signed_transaction();
+    CHECK(ptrx2.get_compression() == packed_transaction::zstd);
+    CHECK(trx2.max_charge == 1000);
+    CHECK(trx2.actions.size() == 100);
+    CHECK(trx2.id() == strx.id());
+
+    // corrupted frame is rejected
+    auto data = ptrx.get_packed_transaction();
+    data.resize(data.size() / 2);
+    CHECK_THROWS_AS(packed_transaction(std::move(data), signatures_type(strx.signatures), packed_transaction::zstd), fc::exception);
+}
+
+TEST_CASE("test_recovered_keys_cache", "[types]") {
+    auto strx = signed_transaction();
+    strx.max_charge = 1000;
+    strx.actions.emplace_back(action(".test", ".test", ".test", bytes()));
+
+    auto hash     = fc::sha256::hash(std::string("test"));
+    auto chain_id = *(chain_id_type*)&hash;
+    auto key      = private_key_type(std::string("5KQwrPbwdL6PhXujxW37FSSQZ1JiwsST4cqQzDeyXtP79zkvFD3"));
+    strx.sign(key, chain_id);
+
+    auto cache = recovered_keys_cache(16);
+    auto ptrx  = std::make_shared<packed_transaction>(strx);
+
+    auto mtrx1 = transaction_metadata(ptrx);
+    auto& keys = cache.recover(mtrx1, chain_id);
+    REQUIRE(keys.size() == 1);
+    CHECK(*keys.begin() == key.get_public_key());
+    CHECK(cache.size() == 1);
+
+    // keys of another metadata of the same transaction are filled by cache
+    auto mtrx2 = transaction_metadata(ptrx);
+    CHECK(!mtrx2.signing_keys.has_value());
+    CHECK(cache.recover(mtrx2, chain_id) == keys);
+    CHECK(cache.size() == 1);
+
+    // keys are not shared among chains
+    auto hash2     = fc::sha256::hash(std::string("test2"));
+    auto chain_id2 = *(chain_id_type*)&hash2;
+    auto mtrx3     = transaction_metadata(ptrx);
+    CHECK(cache.recover(mtrx3, chain_id2) != keys);
+}
+
+TEST_CASE("test_sha256_hash_pairs", "[types]") {
+    auto ids = std::vector<digest_type>();
+    for(auto i = 0; i < 23; i++) {
+        ids.emplace_back(digest_type::hash(std::to_string(i)));
+    }
+
+    for(auto n = 0u; n <= ids.size() / 2; n++) {
+        auto out = std::vector<digest_type>(n);
+        digest_type::hash_pairs(ids.data(), n, out.data());
+        for(auto i = 0u; i < n; i++) {
+            CHECK(out[i] == digest_type::hash(std::make_pair(ids[2 * i], ids[2 * i + 1])));
+        }
+
+        // in place
+        auto in = ids;
+        digest_type::hash_pairs(in.data(), n, in.data());
+        CHECK(std::equal(out.cbegin(), out.cend(), in.cbegin()));
+    }
+
+    // merkle root is the same as hashing canonical pairs one by one
+    auto level = ids;
+    while(level.size() > 1) {
+        if(level.size() % 2) {
+            level.push_back(level.back());
+        }
+        auto next = std::vector<digest_type>();
+        for(auto i = 0u; i < level.size() / 2; i++) {
+            next.emplace_back(digest_type::hash(make_canonical_pair(level[2 * i], level[2 * i + 1])));
+        }
+        level = std::move(next);
+    }
+    CHECK(merkle(ids) == level.front());
+}
+
+TEST_CASE("test_action_profiler", "[types]") {
+    auto profiler = action_profiler(true);
+    CHECK(profiler.get_profiles().empty());
+
+    auto counters  = db_op_counters();
+    counters.reads = 2;
+    counters.cache_hits = 1;
+    for(auto i = 1u; i <= 100; i++) {
+        profiler.record_exec(3, N(transfer), 1, i, counters, i == 100);
+    }
+    profiler.record_exec(3, N(transfer), 2, 1000, counters, false);
+    profiler.record_auth(3, N(transfer), 1, 10);
+
+    auto profiles = profiler.get_profiles();
+    REQUIRE(profiles.size() == 2);
+
+    auto& p1 = profiles[0];
+    CHECK(p1.act == N(transfer));
+    CHECK(p1.version == 1);
+    CHECK(p1.count == 100);
+    CHECK(p1.failed == 1);
+    CHECK(p1.total_time == 5050);
+    CHECK(p1.max_time == 100);
+    CHECK(p1.p50_time == 63);   // upper bound of [32, 64)
+    CHECK(p1.p99_time == 100);  // bounded by max
+    CHECK(p1.auth_count == 1);
+    CHECK(p1.auth_total_time == 10);
+    CHECK(p1.db_reads == 200);
+    CHECK(p1.cache_hits == 100);
+    CHECK(p1.cache_misses == 0);
+
+    CHECK(profiles[1].version == 2);
+    CHECK(profiles[1].count == 1);
+
+    // operations are only counted in scope
+    {
+        auto c     = db_op_counters();
+        auto scope = db_op_counters::scope(c);
+        CHECK(db_op_counters::current() == &c);
+    }
+    CHECK(db_op_counters::current() == nullptr);
+
+    profiler.reset();
+    CHECK(profiler.get_profiles().empty());
+}
+
+TEST_CASE("test_unpack_view", "[types]") {
+    auto str  = std::string("evt unpack view");
+    auto data = bytes{ 'a', 'b', '\0', 'c' };
+
+    auto buf = fc::raw::pack(str);
+    auto b2  = fc::raw::pack(data);
+    buf.insert(buf.end(), b2.begin(), b2.end());
+
+    auto ds  = fc::datastream<const char*>(buf.data(), buf.size());
+
+    auto sv = std::string_view();
+    auto bv = fc::bytes_view();
+    fc::raw::unpack_view(ds, sv);
+    fc::raw::unpack_view(ds, bv);
+    CHECK(ds.remaining() == 0);
+
+    CHECK(sv == str);
+    CHECK(bv.to_bytes() == data);
+    // views borrow from the buffer
+    CHECK(sv.data() >= buf.data());
+    CHECK(bv.end() == buf.data() + buf.size());
+
+    // views are packed the same as owning types
+    CHECK(fc::raw::pack(sv) == fc::raw::pack(str));
+    CHECK(fc::raw::pack(bv) == fc::raw::pack(data));
+
+    auto ds2 = fc::datastream<const char*>(buf.data(), 3);
+    CHECK_THROWS(fc::raw::unpack_view(ds2, sv));
+}
+
+TEST_CASE("test_variant_arena", "[types]") {
+    auto build = [] {
+        auto arr = fc::variants();
+        for(auto i = 0; i < 100; i++) {
+            auto obj = fc::mutable_variant_object();
+            obj("id", i)("name", std::string(40, 'x'))("sub", fc::variants{ fc::variant("a"), fc::variant(i) });
+            arr.emplace_back(std::move(obj));
+        }
+        return fc::variant(std::move(arr));
+    };
+
+    auto expected = fc::json::to_string(build());
+    auto escaped  = fc::variant("heap");
+    {
+        auto scope = fc::variant_arena_scope();
+        auto v     = build();
+        CHECK(scope.allocated() > 0);
+        CHECK(fc::json::to_string(v) == expected);
+
+        // nested scope
+        {
+            auto inner = fc::variant_arena_scope();
+            auto copy  = v;
+            CHECK(inner.allocated() > 0);
+        }
+        // node allocated before the scope is freed to the heap
+        escaped = v;
+    }
+    // variants can outlive the scope
+    CHECK(fc::json::to_string(escaped) == expected);
+}
+
+TEST_CASE("test_block_transaction_metadatas", "[types]") {
+    auto strx = signed_transaction();
+    strx.max_charge = 1000;
+    strx.actions.emplace_back(action(".test", ".test", ".test", bytes(64, 'a')));
+
+    auto b = std::make_shared<signed_block>();
+    b->transactions.emplace_back(packed_transaction(strx));
+    b->transactions.emplace_back(packed_transaction(strx));
+    b->transactions.back().type = transaction_receipt::suspend;
+
+    auto wb    = std::weak_ptr<signed_block>(b);
+    auto mtrxs = make_block_transaction_metadatas(b);
+    REQUIRE(mtrxs.size() == 2);
+    CHECK(mtrxs[1] == nullptr);
+
+    // transaction is not copied out of the block
+    CHECK(mtrxs[0]->packed_trx.get() == &b->transactions[0].trx);
+    CHECK(mtrxs[0]->id == strx.id());
+
+    // block is kept alive by the metadata
+    auto m = mtrxs[0];
+    b.reset();
+    mtrxs.clear();
+    CHECK(!wb.expired());
+    CHECK(m->packed_trx->get_signed_transaction().max_charge == 1000);
+
+    m.reset();
+    CHECK(wb.expired());
+}
+
+TEST_CASE("test_action_data_cache", "[types]") {
+    auto tf   = transferft();
+    tf.number = asset::from_string("1.00000 S#1");
+    tf.memo   = "memo";
+
+    auto act = action(transferft::get_action_name(), N128(.fungible), N128(1), fc::raw::pack(tf));
+    auto& d  = act.data_as<const transferft&>();
+    CHECK(d.number == tf.number);
+    CHECK(d.memo == tf.memo);
+    CHECK(&act.data_as<const transferft&>() == &d);
+
+    // copies share the decoded data
+    auto act2 = act;
+    CHECK(&act2.data_as<const transferft&>() == &d);
+
+    auto act3 = action();
+    act3 = act;
+    CHECK(&act3.data_as<const transferft&>() == &d);
+
+    // data set by new value is not the shared one
+    tf.memo = "memo2";
+    act2.set_data(tf);
+    CHECK(act2.data_as<const transferft&>().memo == "memo2");
+    CHECK(act.data_as<const transferft&>().memo == "memo");
+
+    CHECK_THROWS(act.data_as<const transfer&>());
+TEST_CASE("test_incremental_merkle_bulk_append", "[types]") {
+    auto m1 = incremental_merkle();
+    auto m2 = incremental_merkle();
+
+    auto n = 0;
+    for(auto k : { 1, 2, 3, 5, 8, 13, 1, 31, 64, 7 }) {
+        auto digests = std::vector<digest_type>();
+        for(auto i = 0; i < k; i++) {
+            digests.emplace_back(digest_type::hash(std::to_string(n++)));
+        }
+
+        for(auto& d : digests) {
+            m1.append(d);
+        }
+        CHECK(m2.append(digests) == m1.get_root());
+        CHECK(m2._node_count == m1._node_count);
+        CHECK(m2._active_nodes == m1._active_nodes);
+    }
+    CHECK_THROWS_AS(m2.append(std::vector<digest_type>()), fc::assert_exception);
+
+    // the same from every count of nodes, including the powers of 2
+    for(auto start = 0; start <= 17; start++) {
+        for(auto k = 1; k <= 17; k++) {
+            auto m3 = incremental_merkle();
+            auto m4 = incremental_merkle();
+            for(auto i = 0; i < start; i++) {
+                m3.append(digest_type::hash(std::to_string(i)));
+            }
+            m4 = m3;
+
+            auto digests = std::vector<digest_type>();
+            for(auto i = 0; i < k; i++) {
+                digests.emplace_back(digest_type::hash(std::to_string(start + i)));
+                m3.append(digests.back());
+            }
+            CHECK(m4.append(digests) == m3.get_root());
+            CHECK(m4._active_nodes == m3._active_nodes);
+        }
+    }
+}